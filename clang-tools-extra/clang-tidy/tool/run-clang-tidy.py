@@ -29,6 +29,10 @@ Example invocations.
     run-clang-tidy.py -fix -checks=-*,llvm-header-guard extra/clang-tidy \
                       -header-filter=extra/clang-tidy
 
+- Find the most expensive checks over the whole project, reusing the results
+  of translation units that did not change since the previous run.
+    run-clang-tidy.py -enable-check-profile -cache-dir=/tmp/tidy-cache
+
 Compilation database setup:
 http://clang.llvm.org/docs/HowToSetupToolingForLLVM.html
 """
@@ -37,6 +41,7 @@ from __future__ import print_function
 
 import argparse
 import glob
+import hashlib
 import json
 import multiprocessing
 import os
@@ -79,9 +84,12 @@ def make_absolute(f, directory):
 
 def get_tidy_invocation(f, clang_tidy_binary, checks, tmpdir, build_path,
                         header_filter, extra_arg, extra_arg_before, quiet,
-                        config):
+                        config, profile_dir=None):
   """Gets a command line for clang-tidy."""
   start = [clang_tidy_binary]
+  if profile_dir is not None:
+    start.append('-enable-check-profile')
+    start.append('-store-check-profile=' + profile_dir)
   if header_filter is not None:
     start.append('-header-filter=' + header_filter)
   if checks:
@@ -131,6 +139,165 @@ def merge_replacement_files(tmpdir, mergefile):
     open(mergefile, 'w').close()
 
 
+def aggregate_check_profiles(profile_dir):
+  """Sums up the per-check timings of all profiles stored in a directory.
+
+  Returns a dict mapping each check name to a dict of its accumulated 'wall',
+  'user' and 'sys' times.
+  """
+  prefix = 'time.clang-tidy.'
+  totals = {}
+  for profile_file in glob.iglob(os.path.join(profile_dir, '*.json')):
+    try:
+      with open(profile_file, 'r') as f:
+        profile = json.load(f).get('profile', {})
+    except ValueError:
+      continue # Skip profiles that were only partially written.
+    for key, value in profile.items():
+      if not key.startswith(prefix):
+        continue
+      # Check names may contain dots themselves, e.g.
+      # clang-analyzer-core.NullDereference.
+      check, kind = key[len(prefix):].rsplit('.', 1)
+      times = totals.setdefault(check, {'wall': 0.0, 'user': 0.0, 'sys': 0.0})
+      if kind in times:
+        times[kind] += value
+  return totals
+
+
+def print_check_profile(totals, out):
+  """Prints the aggregated check timings, most expensive checks first."""
+  total = dict((kind, sum(times[kind] for times in totals.values()))
+               for kind in ['wall', 'user', 'sys'])
+  def column(times, kind):
+    percent = 100.0 * times[kind] / total[kind] if total[kind] else 0.0
+    return '%8.4f (%5.1f%%)' % (times[kind], percent)
+
+  out.write('===' + '-' * 73 + '===\n')
+  out.write('Project-wide clang-tidy checks profiling\n')
+  out.write('===' + '-' * 73 + '===\n')
+  out.write('  Total Execution Time: %.4f seconds (wall clock)\n\n' %
+            total['wall'])
+  out.write('   ---User Time---   --System Time--   ---Wall Time---  '
+            '--- Name ---\n')
+  for check, times in sorted(totals.items(), key=lambda item: -item[1]['wall']):
+    out.write('  %s  %s  %s  %s\n' % (column(times, 'user'),
+                                     column(times, 'sys'),
+                                     column(times, 'wall'), check))
+
+
+def find_binary(binary):
+  """Returns the path of a binary, searching $PATH if needed."""
+  if os.path.dirname(binary):
+    return binary if os.path.isfile(binary) else None
+  for directory in os.environ.get('PATH', '').split(os.pathsep):
+    candidate = os.path.join(directory, binary)
+    if os.path.isfile(candidate):
+      return candidate
+  return None
+
+
+class ResultCache(object):
+  """Caches clang-tidy results keyed on everything a translation unit reads.
+
+  The key of an entry covers the clang-tidy invocation, the compile command of
+  the file and the effective configuration. On a miss, clang-tidy also writes
+  a dependency file, and the contents of all of those dependencies are folded
+  into the stored digest, such that an entry is only reused if neither the
+  source file nor any header it includes changed.
+  """
+
+  def __init__(self, cache_dir, database, clang_tidy_binary):
+    self.cache_dir = cache_dir
+    if not os.path.isdir(cache_dir):
+      os.makedirs(cache_dir)
+    self.commands = {}
+    for entry in database:
+      name = make_absolute(entry['file'], entry['directory'])
+      self.commands[name] = json.dumps(entry, sort_keys=True)
+    # Results of a different clang-tidy build must not be reused.
+    self.binary_id = ''
+    binary = find_binary(clang_tidy_binary)
+    if binary:
+      binary_stat = os.stat(binary)
+      self.binary_id = '%d:%d' % (binary_stat.st_size,
+                                  int(binary_stat.st_mtime))
+
+  def key(self, name, invocation, config):
+    hasher = hashlib.sha256()
+    for part in [self.binary_id, ' '.join(invocation),
+                 self.commands.get(name, ''), config]:
+      hasher.update(part.encode('utf-8'))
+      hasher.update(b'\0')
+    return hasher.hexdigest()
+
+  def _entry_path(self, key):
+    return os.path.join(self.cache_dir, key + '.json')
+
+  @staticmethod
+  def _digest(key, deps):
+    hasher = hashlib.sha256(key.encode('utf-8'))
+    for dep in deps:
+      hasher.update(dep.encode('utf-8'))
+      hasher.update(b'\0')
+      with open(dep, 'rb') as f:
+        hasher.update(f.read())
+    return hasher.hexdigest()
+
+  def lookup(self, key):
+    """Returns the cached (returncode, output, err), or None on a miss."""
+    try:
+      with open(self._entry_path(key), 'r') as f:
+        entry = json.load(f)
+      if entry['digest'] != self._digest(key, entry['deps']):
+        return None
+    except (IOError, OSError, ValueError, KeyError):
+      return None
+    return entry['returncode'], entry['output'], entry['err']
+
+  def store(self, key, dep_file, returncode, output, err):
+    try:
+      deps = parse_dependency_file(dep_file)
+      entry = {'deps': deps, 'digest': self._digest(key, deps),
+               'returncode': returncode, 'output': output, 'err': err}
+    except (IOError, OSError):
+      return # Do not cache results whose dependencies are unknown.
+    (handle, name) = tempfile.mkstemp(suffix='.json', dir=self.cache_dir)
+    with os.fdopen(handle, 'w') as f:
+      json.dump(entry, f)
+    # Renaming is atomic, concurrent runs never see a partial entry.
+    os.rename(name, self._entry_path(key))
+
+
+def parse_dependency_file(dep_file):
+  """Returns the list of files in a Makefile-style dependency file."""
+  with open(dep_file, 'r') as f:
+    content = f.read()
+  # Drop the target and join continued lines.
+  content = content.split(':', 1)[1] if ':' in content else ''
+  content = content.replace('\\\n', ' ')
+  deps = []
+  for dep in re.split(r'(?<!\\)\s+', content):
+    dep = dep.replace('\\ ', ' ')
+    if dep:
+      deps.append(dep)
+  return sorted(set(deps))
+
+
+def get_tidy_config(args, name, build_path):
+  """Returns the effective clang-tidy configuration for a file."""
+  invocation = [args.clang_tidy_binary, '-dump-config', '-p=' + build_path]
+  if args.checks:
+    invocation.append('-checks=' + args.checks)
+  if args.config:
+    invocation.append('-config=' + args.config)
+  invocation.append(name)
+  proc = subprocess.Popen(invocation, stdout=subprocess.PIPE,
+                          stderr=subprocess.PIPE)
+  output, _ = proc.communicate()
+  return output.decode('utf-8')
+
+
 def check_clang_apply_replacements_binary(args):
   """Checks if invoking supplied clang-apply-replacements binary works."""
   try:
@@ -153,24 +320,59 @@ def apply_fixes(args, tmpdir):
   subprocess.call(invocation)
 
 
-def run_tidy(args, tmpdir, build_path, queue, lock, failed_files):
+def run_tidy(args, tmpdir, build_path, queue, lock, failed_files,
+             profile_dir, cache):
   """Takes filenames out of queue and runs clang-tidy on them."""
   while True:
     name = queue.get()
+    extra_arg = args.extra_arg
+    cache_key = None
+    dep_file = None
+    if cache:
+      cache_key = cache.key(name,
+                            get_tidy_invocation(name, args.clang_tidy_binary,
+                                                args.checks, None, build_path,
+                                                args.header_filter,
+                                                args.extra_arg,
+                                                args.extra_arg_before,
+                                                args.quiet, args.config),
+                            get_tidy_config(args, name, build_path))
+      cached = cache.lookup(cache_key)
+      if cached:
+        returncode, output, err = cached
+        if returncode != 0:
+          failed_files.append(name)
+        with lock:
+          sys.stdout.write('Cached result for ' + name + '\n' + output)
+          if len(err) > 0:
+            sys.stdout.flush()
+            sys.stderr.write(err)
+        queue.task_done()
+        continue
+      # Let the compiler tell us which files the result depends on.
+      (handle, dep_file) = tempfile.mkstemp(suffix='.d')
+      os.close(handle)
+      extra_arg = extra_arg + ['-MD', '-MF' + dep_file]
+
     invocation = get_tidy_invocation(name, args.clang_tidy_binary, args.checks,
                                      tmpdir, build_path, args.header_filter,
-                                     args.extra_arg, args.extra_arg_before,
-                                     args.quiet, args.config)
+                                     extra_arg, args.extra_arg_before,
+                                     args.quiet, args.config, profile_dir)
 
     proc = subprocess.Popen(invocation, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
     output, err = proc.communicate()
+    output = output.decode('utf-8')
+    err = err.decode('utf-8')
     if proc.returncode != 0:
       failed_files.append(name)
+    if cache:
+      cache.store(cache_key, dep_file, proc.returncode, output, err)
+      os.remove(dep_file)
     with lock:
-      sys.stdout.write(' '.join(invocation) + '\n' + output.decode('utf-8'))
+      sys.stdout.write(' '.join(invocation) + '\n' + output)
       if len(err) > 0:
         sys.stdout.flush()
-        sys.stderr.write(err.decode('utf-8'))
+        sys.stderr.write(err)
     queue.task_done()
 
 
@@ -226,6 +428,21 @@ def main():
                       'command line.')
   parser.add_argument('-quiet', action='store_true',
                       help='Run clang-tidy in quiet mode')
+  parser.add_argument('-enable-check-profile', dest='enable_check_profile',
+                      action='store_true',
+                      help='Profile the checks over all processed files and '
+                      'print their accumulated timings, most expensive '
+                      'first.')
+  parser.add_argument('-store-check-profile', dest='store_check_profile',
+                      metavar='filename',
+                      help='With -enable-check-profile, also write the '
+                      'accumulated timings as JSON to this file.')
+  parser.add_argument('-cache-dir', dest='cache_dir', metavar='directory',
+                      help='Reuse the results of files for which neither the '
+                      'source, nor any included header, nor the compile '
+                      'command or configuration changed since a previous '
+                      'run with the same cache directory. Not supported '
+                      'together with -fix or -export-fixes.')
   args = parser.parse_args()
 
   db_path = 'compile_commands.json'
@@ -266,6 +483,19 @@ def main():
     check_clang_apply_replacements_binary(args)
     tmpdir = tempfile.mkdtemp()
 
+  cache = None
+  if args.cache_dir:
+    if tmpdir:
+      # Cached results carry no fixes that could be exported.
+      print('Error: -cache-dir cannot be combined with -fix or -export-fixes.',
+            file=sys.stderr)
+      sys.exit(1)
+    cache = ResultCache(args.cache_dir, database, args.clang_tidy_binary)
+
+  profile_dir = None
+  if args.enable_check_profile:
+    profile_dir = tempfile.mkdtemp()
+
   # Build up a big regexy filter from all command line arguments.
   file_name_re = re.compile('|'.join(args.files))
 
@@ -278,7 +508,8 @@ def main():
     lock = threading.Lock()
     for _ in range(max_task):
       t = threading.Thread(target=run_tidy,
-                           args=(args, tmpdir, build_path, task_queue, lock, failed_files))
+                           args=(args, tmpdir, build_path, task_queue, lock,
+                                 failed_files, profile_dir, cache))
       t.daemon = True
       t.start()
 
@@ -298,8 +529,18 @@ def main():
     print('\nCtrl-C detected, goodbye.')
     if tmpdir:
       shutil.rmtree(tmpdir)
+    if profile_dir:
+      shutil.rmtree(profile_dir)
     os.kill(0, 9)
 
+  if profile_dir:
+    totals = aggregate_check_profiles(profile_dir)
+    print_check_profile(totals, sys.stdout)
+    if args.store_check_profile:
+      with open(args.store_check_profile, 'w') as out:
+        json.dump(totals, out, indent=2, sort_keys=True)
+    shutil.rmtree(profile_dir)
+
   if yaml and args.export_fixes:
     print('Writing fixes to ' + args.export_fixes + ' ...')
     try:
@@ -113,6 +113,12 @@ public:
   bool onCall(llvm::StringRef Method, llvm::json::Value Params,
               llvm::json::Value ID) override {
     WithContext HandlerContext(handlerContext());
+    // A completion request obsoletes the previous one, if it's still running.
+    if (Method == "textDocument/completion") {
+      if (LastCompletionID)
+        cancelRequest(*LastCompletionID);
+      LastCompletionID = llvm::to_string(ID);
+    }
     // Calls can be canceled by the client. Add cancellation context.
     WithContext WithCancel(cancelableRequestContext(ID));
     trace::Span Tracer(Method);
@@ -250,6 +256,9 @@ private:
   mutable std::mutex RequestCancelersMutex;
   llvm::StringMap<std::pair<Canceler, /*Cookie*/ unsigned>> RequestCancelers;
   unsigned NextRequestCookie = 0; // To disambiguate reused IDs, see below.
+  // JSON-serialized ID of the last completion request. Only used on the main
+  // thread.
+  llvm::Optional<std::string> LastCompletionID;
   void onCancel(const llvm::json::Value &Params) {
     const llvm::json::Value *ID = nullptr;
     if (auto *O = Params.getAsObject())
@@ -258,7 +267,10 @@ private:
       elog("Bad cancellation request: {0}", Params);
       return;
     }
-    auto StrID = llvm::to_string(*ID);
+    cancelRequest(llvm::to_string(*ID));
+  }
+
+  void cancelRequest(llvm::StringRef StrID) {
     std::lock_guard<std::mutex> Lock(RequestCancelersMutex);
     auto It = RequestCancelers.find(StrID);
     if (It != RequestCancelers.end())
@@ -103,7 +103,8 @@ ClangdServer::ClangdServer(const GlobalCompilationDatabase &CDB,
       WorkScheduler(CDB, Opts.AsyncThreadsCount, Opts.StorePreamblesInMemory,
                     llvm::make_unique<UpdateIndexCallbacks>(DynamicIdx.get(),
                                                             DiagConsumer),
-                    Opts.UpdateDebounce, Opts.RetentionPolicy) {
+                    Opts.UpdateDebounce, Opts.RetentionPolicy,
+                    Opts.MaxInMemoryPreambleBytes) {
   // Adds an index to the stack, at higher priority than existing indexes.
   auto AddIndex = [&](SymbolIndex *Idx) {
     if (this->Index != nullptr) {
@@ -144,6 +145,8 @@ void ClangdServer::addDocument(PathRef File, llvm::StringRef Contents,
   Inputs.Opts = std::move(Opts);
   Inputs.Index = Index;
   WorkScheduler.update(File, Inputs, WantDiags);
+  if (BackgroundIdx)
+    BackgroundIdx->boostRelated(File);
 }
 
 void ClangdServer::removeDocument(PathRef File) { WorkScheduler.remove(File); }
@@ -170,15 +173,14 @@ void ClangdServer::codeComplete(PathRef File, Position Pos,
       // No speculation in Fallback mode, as it's supposed to be much faster
       // without compiling.
       vlog("Build for file {0} is not ready. Enter fallback mode.", File);
-    } else {
-      if (CodeCompleteOpts.Index && CodeCompleteOpts.SpeculativeIndexRequest) {
+    } else if (CodeCompleteOpts.Index) {
+      // SpecFuzzyFind also holds on to the index request if it's late.
+      if (CodeCompleteOpts.SpeculativeIndexRequest ||
+          CodeCompleteOpts.LatencyBudget.count())
         SpecFuzzyFind.emplace();
-        {
-          std::lock_guard<std::mutex> Lock(
-              CachedCompletionFuzzyFindRequestMutex);
-          SpecFuzzyFind->CachedReq =
-              CachedCompletionFuzzyFindRequestByFile[File];
-        }
+      if (CodeCompleteOpts.SpeculativeIndexRequest) {
+        std::lock_guard<std::mutex> Lock(CachedCompletionFuzzyFindRequestMutex);
+        SpecFuzzyFind->CachedReq = CachedCompletionFuzzyFindRequestByFile[File];
       }
     }
     // FIXME(ibiryukov): even if Preamble is non-null, we may want to check
@@ -186,6 +188,8 @@ void ClangdServer::codeComplete(PathRef File, Position Pos,
     CodeCompleteResult Result = clangd::codeComplete(
         File, IP->Command, IP->Preamble, IP->Contents, Pos, FS,
         CodeCompleteOpts, SpecFuzzyFind ? SpecFuzzyFind.getPointer() : nullptr);
+    if (isCancelled())
+      return CB(llvm::make_error<CancelledError>());
     {
       clang::clangd::trace::Span Tracer("Completion results callback");
       CB(std::move(Result));
@@ -32,6 +32,7 @@
 #include "llvm/ADT/StringRef.h"
 #include <functional>
 #include <future>
+#include <limits>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -83,6 +84,10 @@ public:
 
     /// Cached preambles are potentially large. If false, store them on disk.
     bool StorePreamblesInMemory = true;
+    /// With StorePreamblesInMemory, new preambles are stored on disk anyway
+    /// once the preambles in memory take this many bytes.
+    std::size_t MaxInMemoryPreambleBytes =
+        std::numeric_limits<std::size_t>::max();
 
     /// If true, ClangdServer builds a dynamic in-memory index for symbols in
     /// opened files and uses the index to augment code completion results.
@@ -61,8 +61,10 @@ template <class T> std::size_t getUsedBytes(const std::vector<T> &Vec) {
 
 class DeclTrackingASTConsumer : public ASTConsumer {
 public:
-  DeclTrackingASTConsumer(std::vector<Decl *> &TopLevelDecls)
-      : TopLevelDecls(TopLevelDecls) {}
+  DeclTrackingASTConsumer(
+      std::vector<Decl *> &TopLevelDecls,
+      llvm::Optional<std::pair<unsigned, unsigned>> KeepFunctionBodies)
+      : TopLevelDecls(TopLevelDecls), KeepFunctionBodies(KeepFunctionBodies) {}
 
   bool HandleTopLevelDecl(DeclGroupRef DG) override {
     for (Decl *D : DG) {
@@ -78,22 +80,42 @@ public:
     return true;
   }
 
+  // Only called when SkipFunctionBodies is set, see ParseOptions.
+  bool shouldSkipFunctionBody(Decl *D) override {
+    if (!KeepFunctionBodies)
+      return true;
+    const SourceManager &SM = D->getASTContext().getSourceManager();
+    SourceLocation Loc = SM.getFileLoc(D->getLocation());
+    if (!SM.isWrittenInMainFile(Loc))
+      return true;
+    unsigned Offset = SM.getFileOffset(Loc);
+    return Offset < KeepFunctionBodies->first ||
+           Offset > KeepFunctionBodies->second;
+  }
+
 private:
   std::vector<Decl *> &TopLevelDecls;
+  llvm::Optional<std::pair<unsigned, unsigned>> KeepFunctionBodies;
 };
 
 class ClangdFrontendAction : public SyntaxOnlyAction {
 public:
+  ClangdFrontendAction(
+      llvm::Optional<std::pair<unsigned, unsigned>> KeepFunctionBodies)
+      : KeepFunctionBodies(KeepFunctionBodies) {}
+
   std::vector<Decl *> takeTopLevelDecls() { return std::move(TopLevelDecls); }
 
 protected:
   std::unique_ptr<ASTConsumer>
   CreateASTConsumer(CompilerInstance &CI, llvm::StringRef InFile) override {
-    return llvm::make_unique<DeclTrackingASTConsumer>(/*ref*/ TopLevelDecls);
+    return llvm::make_unique<DeclTrackingASTConsumer>(/*ref*/ TopLevelDecls,
+                                                      KeepFunctionBodies);
   }
 
 private:
   std::vector<Decl *> TopLevelDecls;
+  llvm::Optional<std::pair<unsigned, unsigned>> KeepFunctionBodies;
 };
 
 class CollectMainFileMacros : public PPCallbacks {
@@ -291,6 +313,8 @@ ParsedAST::build(std::unique_ptr<CompilerInvocation> CI,
   // Command-line parsing sets DisableFree to true by default, but we don't want
   // to leak memory in clangd.
   CI->getFrontendOpts().DisableFree = false;
+  if (Opts.KeepFunctionBodies)
+    CI->getFrontendOpts().SkipFunctionBodies = true;
   const PrecompiledPreamble *PreamblePCH =
       Preamble ? &Preamble->Preamble : nullptr;
 
@@ -302,7 +326,8 @@ ParsedAST::build(std::unique_ptr<CompilerInvocation> CI,
   if (!Clang)
     return None;
 
-  auto Action = llvm::make_unique<ClangdFrontendAction>();
+  auto Action =
+      llvm::make_unique<ClangdFrontendAction>(Opts.KeepFunctionBodies);
   const FrontendInputFile &MainInput = Clang->getFrontendOpts().Inputs[0];
   if (!Action->BeginSourceFile(*Clang, MainInput)) {
     log("BeginSourceFile() failed when building AST for {0}",
@@ -19,6 +19,7 @@
 
 #include "CodeComplete.h"
 #include "AST.h"
+#include "Cancellation.h"
 #include "ClangdUnit.h"
 #include "CodeCompletionStrings.h"
 #include "Compiler.h"
@@ -31,6 +32,7 @@
 #include "Quality.h"
 #include "SourceCode.h"
 #include "TUScheduler.h"
+#include "Threading.h"
 #include "Trace.h"
 #include "URI.h"
 #include "index/Index.h"
@@ -1205,6 +1207,8 @@ class CodeCompleteFlow {
   IncludeStructure Includes;           // Complete once the compiler runs.
   SpeculativeFuzzyFind *SpecFuzzyFind; // Can be nullptr.
   const CodeCompleteOptions &Opts;
+  // When to stop waiting for the index, see CodeCompleteOptions::LatencyBudget.
+  Deadline IndexDeadline;
 
   // Sema takes ownership of Recorder. Recorder is valid until Sema cleanup.
   CompletionRecorder *Recorder = nullptr;
@@ -1238,7 +1242,11 @@ public:
                    SpeculativeFuzzyFind *SpecFuzzyFind,
                    const CodeCompleteOptions &Opts)
       : FileName(FileName), Includes(Includes), SpecFuzzyFind(SpecFuzzyFind),
-        Opts(Opts) {}
+        Opts(Opts),
+        IndexDeadline(Opts.LatencyBudget.count()
+                          ? Deadline(std::chrono::steady_clock::now() +
+                                     Opts.LatencyBudget)
+                          : Deadline::infinity()) {}
 
   CodeCompleteResult run(const SemaCompleteInput &SemaCCInput) && {
     trace::Span Tracer("CodeCompleteFlow");
@@ -1436,6 +1444,9 @@ private:
     PreferredType =
         OpaqueType::fromType(Recorder->CCSema->getASTContext(),
                              Recorder->CCContext.getPreferredType());
+    // Don't bother with the index and scoring if the client moved on.
+    if (isCancelled())
+      return CodeCompleteResult();
     // Sema provides the needed context to query the index.
     // FIXME: in addition to querying for extra/overlapping symbols, we should
     //        explicitly request symbols corresponding to Sema results.
@@ -1492,11 +1503,22 @@ private:
       SPAN_ATTACH(Tracer, "Speculative results", true);
 
       trace::Span WaitSpec("Wait speculative results");
+      if (!waitForIndex(SpecFuzzyFind->Result))
+        return SymbolSlab();
       return SpecFuzzyFind->Result.get();
     }
 
     SPAN_ATTACH(Tracer, "Speculative results", false);
 
+    // With a latency budget, SpecFuzzyFind holds on to the request if it's
+    // late, as waiting for it to finish is what we want to avoid.
+    if (SpecFuzzyFind && !(IndexDeadline == Deadline::infinity())) {
+      SpecFuzzyFind->LateResult = startAsyncFuzzyFind(*Opts.Index, Req);
+      if (!waitForIndex(SpecFuzzyFind->LateResult))
+        return SymbolSlab();
+      return SpecFuzzyFind->LateResult.get();
+    }
+
     // Run the query against the index.
     SymbolSlab::Builder ResultsBuilder;
     if (Opts.Index->fuzzyFind(
@@ -1505,6 +1527,17 @@ private:
     return std::move(ResultsBuilder).build();
   }
 
+  // Waits for \p Result until IndexDeadline. If it's not ready by then, the
+  // results are incomplete.
+  bool waitForIndex(const std::future<SymbolSlab> &Result) {
+    if (IndexDeadline == Deadline::infinity() ||
+        Result.wait_until(IndexDeadline.time()) == std::future_status::ready)
+      return true;
+    log("Code complete: index results are late, skipping them.");
+    Incomplete = true;
+    return false;
+  }
+
   // Merges Sema and Index results where possible, to form CompletionCandidates.
   // \p Identifiers is raw idenfiers that can also be completion condidates.
   // Identifiers are not merged with results from index or sema.
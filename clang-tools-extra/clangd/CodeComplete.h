@@ -31,6 +31,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
+#include <chrono>
 #include <future>
 
 namespace clang {
@@ -93,6 +94,13 @@ struct CodeCompleteOptions {
   /// this should be effective for a number of code completions.
   bool SpeculativeIndexRequest = false;
 
+  /// If non-zero, how long after the start of code completion to wait for the
+  /// index results at most. If the index is late, only the other results are
+  /// returned and CompletionList.isIncomplete is set, so that the client asks
+  /// again as the user types. This needs a SpeculativeFuzzyFind to hold on to
+  /// the late index request, completion waits for the index otherwise.
+  std::chrono::milliseconds LatencyBudget = std::chrono::milliseconds(0);
+
   // Populated internally by clangd, do not set.
   /// If `Index` is set, it is used to augment the code completion
   /// results.
@@ -233,6 +241,10 @@ struct SpeculativeFuzzyFind {
   /// The result is consumed by `codeComplete()` if speculation succeeded.
   /// NOTE: the destructor will wait for the async call to finish.
   std::future<SymbolSlab> Result;
+  /// The index request `codeComplete()` stopped waiting for, due to
+  /// CodeCompleteOptions::LatencyBudget.
+  /// NOTE: the destructor will wait for the async call to finish.
+  std::future<SymbolSlab> LateResult;
 };
 
 /// Gets code completions at a specified \p Pos in \p FileName.
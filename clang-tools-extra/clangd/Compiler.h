@@ -21,6 +21,7 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/PrecompiledPreamble.h"
 #include "clang/Tooling/CompilationDatabase.h"
+#include "llvm/ADT/Optional.h"
 
 namespace clang {
 namespace clangd {
@@ -38,6 +39,10 @@ public:
 struct ParseOptions {
   tidy::ClangTidyOptions ClangTidyOpts;
   bool SuggestMissingIncludes = false;
+  /// If set, only the bodies of the main file functions whose name is in this
+  /// range of offsets are parsed, other function bodies are skipped. Such ASTs
+  /// are incomplete, they are only useful for diagnostics in the kept bodies.
+  llvm::Optional<std::pair<unsigned, unsigned>> KeepFunctionBodies;
 };
 
 /// Information required to run clang, e.g. to parse AST or do code completion.
@@ -16,6 +16,16 @@
 // The processing thread of the ASTWorker is also responsible for building the
 // preamble. However, unlike AST, the same preamble can be read concurrently, so
 // we run each of async preamble reads on its own thread.
+// When an update leaves the preamble section of the main file unchanged, the
+// old preamble is still consistent with the main file, even if the headers it
+// includes have changed. In that case the worker carries on with the old
+// preamble, and checks or rebuilds it on a shared pool of threads. Once a new
+// preamble is ready, the worker rebuilds the AST and reports the diagnostics
+// again.
+//
+// Edits inside a single function body of a large file are diagnosed quickly by
+// parsing only that body, reusing the diagnostics of the last full build for
+// the rest of the file. The full AST is rebuilt once the edits settle down.
 //
 // To limit the concurrent load that clangd produces we maintain a semaphore
 // that keeps more than a fixed number of threads from running concurrently.
@@ -46,15 +56,20 @@
 #include "Compiler.h"
 #include "GlobalCompilationDatabase.h"
 #include "Logger.h"
+#include "SourceCode.h"
 #include "Trace.h"
 #include "index/CanonicalIncludes.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclTemplate.h"
 #include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/PrecompiledPreamble.h"
 #include "clang/Tooling/CompilationDatabase.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/ScopeExit.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/Path.h"
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <queue>
 #include <thread>
@@ -76,40 +91,48 @@ llvm::Optional<llvm::StringRef> TUScheduler::getFileBeingProcessedInContext() {
 }
 
 /// An LRU cache of idle ASTs.
-/// Because we want to limit the overall number of these we retain, the cache
-/// owns ASTs (and may evict them) while their workers are idle.
+/// Because we want to limit the overall memory used by these we retain, the
+/// cache owns ASTs (and may evict them) while their workers are idle.
 /// Workers borrow ASTs when active, and return them when done.
 class TUScheduler::ASTCache {
 public:
   using Key = const ASTWorker *;
 
-  ASTCache(unsigned MaxRetainedASTs) : MaxRetainedASTs(MaxRetainedASTs) {}
+  ASTCache(ASTRetentionPolicy Policy) : Policy(Policy) {}
 
-  /// Returns result of getUsedBytes() for the AST cached by \p K.
+  /// Returns result of getUsedBytes() for the AST cached by \p K, as of the
+  /// time it was put into the cache.
   /// If no AST is cached, 0 is returned.
   std::size_t getUsedBytes(Key K) {
     std::lock_guard<std::mutex> Lock(Mut);
     auto It = findByKey(K);
-    if (It == LRU.end() || !It->second)
+    if (It == LRU.end())
       return 0;
-    return It->second->getUsedBytes();
+    return It->Bytes;
   }
 
-  /// Store the value in the pool, possibly removing the last used AST.
+  /// Store the value in the pool, possibly removing the least recently used
+  /// ASTs to stay within the budget.
   /// The value should not be in the pool when this function is called.
   void put(Key K, std::unique_ptr<ParsedAST> V) {
+    // ASTs only grow when used, so measure them here rather than on each read.
+    std::size_t Bytes = V ? V->getUsedBytes() : 0;
+    std::vector<std::unique_ptr<ParsedAST>> ForCleanup;
     std::unique_lock<std::mutex> Lock(Mut);
     assert(findByKey(K) == LRU.end());
 
-    LRU.insert(LRU.begin(), {K, std::move(V)});
-    if (LRU.size() <= MaxRetainedASTs)
-      return;
-    // We're past the limit, remove the last element.
-    std::unique_ptr<ParsedAST> ForCleanup = std::move(LRU.back().second);
-    LRU.pop_back();
-    // Run the expensive destructor outside the lock.
+    LRU.insert(LRU.begin(), Entry{K, std::move(V), Bytes});
+    TotalBytes += Bytes;
+    // We're past the limit, remove the last elements. Keep the one just added.
+    while (LRU.size() > 1 && (LRU.size() > Policy.MaxRetainedASTs ||
+                              TotalBytes > Policy.MaxRetainedBytes)) {
+      TotalBytes -= LRU.back().Bytes;
+      ForCleanup.push_back(std::move(LRU.back().AST));
+      LRU.pop_back();
+    }
+    // Run the expensive destructors outside the lock.
     Lock.unlock();
-    ForCleanup.reset();
+    ForCleanup.clear();
   }
 
   /// Returns the cached value for \p K, or llvm::None if the value is not in
@@ -120,7 +143,8 @@ public:
     auto Existing = findByKey(K);
     if (Existing == LRU.end())
       return None;
-    std::unique_ptr<ParsedAST> V = std::move(Existing->second);
+    std::unique_ptr<ParsedAST> V = std::move(Existing->AST);
+    TotalBytes -= Existing->Bytes;
     LRU.erase(Existing);
     // GCC 4.8 fails to compile `return V;`, as it tries to call the copy
     // constructor of unique_ptr, so we call the move ctor explicitly to avoid
@@ -129,22 +153,196 @@ public:
   }
 
 private:
-  using KVPair = std::pair<Key, std::unique_ptr<ParsedAST>>;
+  struct Entry {
+    Key K;
+    std::unique_ptr<ParsedAST> AST;
+    std::size_t Bytes;
+  };
 
-  std::vector<KVPair>::iterator findByKey(Key K) {
-    return llvm::find_if(LRU, [K](const KVPair &P) { return P.first == K; });
+  std::vector<Entry>::iterator findByKey(Key K) {
+    return llvm::find_if(LRU, [K](const Entry &E) { return E.K == K; });
   }
 
   std::mutex Mut;
-  unsigned MaxRetainedASTs;
+  const ASTRetentionPolicy Policy;
   /// Items sorted in LRU order, i.e. first item is the most recently accessed
   /// one.
-  std::vector<KVPair> LRU; /* GUARDED_BY(Mut) */
+  std::vector<Entry> LRU; /* GUARDED_BY(Mut) */
+  std::size_t TotalBytes = 0; /* GUARDED_BY(Mut) */
+};
+
+/// Preamble builds are queued here by the ASTWorkers when they can keep using
+/// their stale preamble in the meantime, see ASTWorker::update().
+/// The most recently queued build runs first: it is usually for the file the
+/// user is editing, the older ones may well be obsolete by now.
+class TUScheduler::PreambleBuildQueue {
+public:
+  PreambleBuildQueue(unsigned ThreadCount) {
+    for (unsigned I = 0; I < ThreadCount; ++I)
+      Threads.runAsync("preamble-builder:" + llvm::Twine(I + 1),
+                       [this] { run(); });
+  }
+  /// Runs the pending builds before returning.
+  ~PreambleBuildQueue() {
+    {
+      std::lock_guard<std::mutex> Lock(Mut);
+      Done = true;
+    }
+    BuildsCV.notify_all();
+    Threads.wait();
+  }
+
+  void schedule(llvm::unique_function<void()> Build) {
+    {
+      std::lock_guard<std::mutex> Lock(Mut);
+      assert(!Done && "scheduling a build after shutdown");
+      Builds.push_back(std::move(Build));
+    }
+    BuildsCV.notify_one();
+  }
+
+private:
+  void run() {
+    while (true) {
+      llvm::unique_function<void()> Build;
+      {
+        std::unique_lock<std::mutex> Lock(Mut);
+        BuildsCV.wait(Lock, [&] { return Done || !Builds.empty(); });
+        if (Builds.empty())
+          return;
+        Build = std::move(Builds.back());
+        Builds.pop_back();
+      }
+      Build();
+    }
+  }
+
+  std::mutex Mut;
+  std::condition_variable BuildsCV;
+  bool Done = false;                                /* GUARDED_BY(Mut) */
+  std::vector<llvm::unique_function<void()>> Builds; /* GUARDED_BY(Mut) */
+  AsyncTaskRunner Threads;
+};
+
+/// Decides where the preambles of all files are stored. If requested, they are
+/// kept in memory until those in memory add up to the budget. New preambles
+/// are then stored in temporary files, until enough of the others are freed.
+class TUScheduler::PreambleStorage {
+public:
+  PreambleStorage(bool InMemory, std::size_t MaxInMemoryBytes)
+      : InMemory(InMemory), MaxInMemoryBytes(MaxInMemoryBytes),
+        InMemoryBytes(std::make_shared<std::atomic<std::size_t>>(0)) {}
+
+  /// Whether the next preamble should be built in memory.
+  bool storeInMemory() const {
+    if (!InMemory)
+      return false;
+    std::size_t Used = *InMemoryBytes;
+    if (Used < MaxInMemoryBytes)
+      return true;
+    vlog("Preambles in memory take {0} bytes, storing the next one on disk",
+         Used);
+    return false;
+  }
+
+  /// Counts a preamble that was built in memory against the budget, until all
+  /// the references to the returned pointer are gone.
+  std::shared_ptr<const PreambleData>
+  track(std::shared_ptr<const PreambleData> Preamble) {
+    if (!Preamble)
+      return nullptr;
+    std::size_t Size = Preamble->Preamble.getSize();
+    *InMemoryBytes += Size;
+    const PreambleData *Data = Preamble.get();
+    return std::shared_ptr<const PreambleData>(
+        Data, Release{std::move(Preamble), InMemoryBytes, Size});
+  }
+
+private:
+  // Owns the tracked preamble, frees it and its bytes in the budget when the
+  // last reference to the tracked pointer is gone. The counter is shared, as
+  // preambles may outlive the TUScheduler.
+  struct Release {
+    std::shared_ptr<const PreambleData> Preamble;
+    std::shared_ptr<std::atomic<std::size_t>> InMemoryBytes;
+    std::size_t Size;
+
+    void operator()(const PreambleData *) {
+      Preamble.reset();
+      *InMemoryBytes -= Size;
+    }
+  };
+
+  const bool InMemory;
+  const std::size_t MaxInMemoryBytes;
+  std::shared_ptr<std::atomic<std::size_t>> InMemoryBytes;
 };
 
 namespace {
 class ASTWorkerHandle;
 
+/// Whether a preamble built from \p Old can be used to build ASTs for \p New
+/// until it is rebuilt. The main file and the preamble must agree on the
+/// preamble section of the main file and on the compile command. Only the
+/// included files may have changed, the preamble then has outdated contents
+/// for some of them but it is still consistent with the main file.
+bool isPreambleCompatible(const ParseInputs &Old, const ParseInputs &New,
+                          const CompilerInvocation &CI) {
+  if (!(Old.CompileCommand == New.CompileCommand))
+    return false;
+  auto OldBuffer = llvm::MemoryBuffer::getMemBuffer(Old.Contents);
+  auto NewBuffer = llvm::MemoryBuffer::getMemBuffer(New.Contents);
+  PreambleBounds OldBounds =
+      ComputePreambleBounds(*CI.getLangOpts(), OldBuffer.get(), 0);
+  PreambleBounds NewBounds =
+      ComputePreambleBounds(*CI.getLangOpts(), NewBuffer.get(), 0);
+  return OldBounds.Size == NewBounds.Size &&
+         OldBounds.PreambleEndsAtStartOfLine ==
+             NewBounds.PreambleEndsAtStartOfLine &&
+         llvm::StringRef(Old.Contents).take_front(OldBounds.Size) ==
+             llvm::StringRef(New.Contents).take_front(NewBounds.Size);
+}
+
+/// Main files smaller than this are always parsed as a whole, this is fast
+/// enough and doesn't risk approximate diagnostics.
+constexpr std::size_t MinSizeToParseEditedBodies = 32 * 1024;
+
+/// The body of a function defined in the main file, as main file offsets.
+struct FunctionBody {
+  unsigned Name;  // The function name, see DeclTrackingASTConsumer.
+  unsigned Begin; // The opening brace.
+  unsigned End;   // The closing brace.
+};
+
+/// Collects bodies of the functions declared in \p D, without looking into
+/// other function bodies.
+void collectFunctionBodies(const Decl *D, const SourceManager &SM,
+                           std::vector<FunctionBody> &Bodies) {
+  if (const auto *TD = dyn_cast<TemplateDecl>(D))
+    if (TD->getTemplatedDecl())
+      D = TD->getTemplatedDecl();
+  if (const auto *FD = dyn_cast<FunctionDecl>(D)) {
+    const Stmt *Body =
+        FD->doesThisDeclarationHaveABody() ? FD->getBody() : nullptr;
+    if (!Body || FD->getLocation().isMacroID() ||
+        Body->getBeginLoc().isMacroID() || Body->getEndLoc().isMacroID() ||
+        !SM.isWrittenInMainFile(FD->getLocation()))
+      return;
+    Bodies.push_back({SM.getFileOffset(FD->getLocation()),
+                      SM.getFileOffset(Body->getBeginLoc()),
+                      SM.getFileOffset(Body->getEndLoc())});
+    return;
+  }
+  if (isa<NamespaceDecl>(D) || isa<LinkageSpecDecl>(D) ||
+      isa<CXXRecordDecl>(D))
+    for (const Decl *Child : cast<DeclContext>(D)->decls())
+      collectFunctionBodies(Child, SM, Bodies);
+}
+
+int braceBalance(llvm::StringRef Code) {
+  return Code.count('{') - Code.count('}');
+}
+
 /// Owns one instance of the AST, schedules updates and reads of it.
 /// Also responsible for building and providing access to the preamble.
 /// Each ASTWorker processes the async requests sent to it on a separate
@@ -158,8 +356,10 @@ class ASTWorkerHandle;
 class ASTWorker {
   friend class ASTWorkerHandle;
   ASTWorker(PathRef FileName, const GlobalCompilationDatabase &CDB,
-            TUScheduler::ASTCache &LRUCache, Semaphore &Barrier, bool RunSync,
-            steady_clock::duration UpdateDebounce, bool StorePreamblesInMemory,
+            TUScheduler::ASTCache &LRUCache,
+            TUScheduler::PreambleBuildQueue *PreambleBuilds, Semaphore &Barrier,
+            bool RunSync, steady_clock::duration UpdateDebounce,
+            TUScheduler::PreambleStorage &Preambles,
             ParsingCallbacks &Callbacks);
 
 public:
@@ -168,11 +368,15 @@ public:
   /// is null, all requests will be processed on the calling thread
   /// synchronously instead. \p Barrier is acquired when processing each
   /// request, it is used to limit the number of actively running threads.
+  /// Preambles are built on \p PreambleBuilds when possible, which must be
+  /// null iff \p Tasks is.
   static ASTWorkerHandle
   create(PathRef FileName, const GlobalCompilationDatabase &CDB,
-         TUScheduler::ASTCache &IdleASTs, AsyncTaskRunner *Tasks,
-         Semaphore &Barrier, steady_clock::duration UpdateDebounce,
-         bool StorePreamblesInMemory, ParsingCallbacks &Callbacks);
+         TUScheduler::ASTCache &IdleASTs,
+         TUScheduler::PreambleBuildQueue *PreambleBuilds,
+         AsyncTaskRunner *Tasks, Semaphore &Barrier,
+         steady_clock::duration UpdateDebounce,
+         TUScheduler::PreambleStorage &Preambles, ParsingCallbacks &Callbacks);
   ~ASTWorker();
 
   void update(ParseInputs Inputs, WantDiagnostics);
@@ -212,6 +416,31 @@ private:
   /// Updates the TUStatus and emits it. Only called in the worker thread.
   void emitTUStatus(TUAction FAction,
                     const TUStatus::BuildDetails *Detail = nullptr);
+  /// Builds the AST for \p Inputs, unless it is cached, and reports its
+  /// diagnostics. Only called in the worker thread.
+  void generateDiagnostics(std::unique_ptr<CompilerInvocation> Invocation,
+                           const ParseInputs &Inputs,
+                           std::shared_ptr<const PreambleData> Preamble,
+                           llvm::StringRef TaskName);
+  /// If \p Inputs only differ from LastFullAST inside a function body, reports
+  /// diagnostics from a build of that body only and schedules a full rebuild.
+  /// Returns false if the full AST must be built right away instead.
+  bool generateEditedBodyDiagnostics(
+      const CompilerInvocation &Invocation, const ParseInputs &Inputs,
+      const std::shared_ptr<const PreambleData> &Preamble,
+      llvm::StringRef TaskName);
+  /// Checks whether the preamble is up to date with \p Inputs on
+  /// PreambleBuilds. If it had to be rebuilt, the AST is rebuilt with it.
+  void schedulePreambleBuild(ParseInputs Inputs, WantDiagnostics WantDiags);
+  /// Runs on PreambleBuilds, see schedulePreambleBuild().
+  void buildPreambleAsync(ParseInputs Inputs, WantDiagnostics WantDiags,
+                          unsigned Epoch, unsigned Build);
+  /// Calls \p Callback with the preamble once no builds are pending, or
+  /// queues it until they are done.
+  void deliverPreambleLocked(
+      std::unique_lock<std::mutex> &Lock,
+      llvm::unique_function<void(std::shared_ptr<const PreambleData>)>
+          Callback);
 
   /// Determines the next action to perform.
   /// All actions that should never run are discarded.
@@ -235,6 +464,8 @@ private:
 
   /// Handles retention of ASTs.
   TUScheduler::ASTCache &IdleASTs;
+  /// Null when running synchronously.
+  TUScheduler::PreambleBuildQueue *PreambleBuilds;
   const bool RunSync;
   /// Time to wait after an update to see whether another update obsoletes it.
   const steady_clock::duration UpdateDebounce;
@@ -242,7 +473,7 @@ private:
   const Path FileName;
   const GlobalCompilationDatabase &CDB;
   /// Whether to keep the built preambles in memory or on disk.
-  const bool StorePreambleInMemory;
+  TUScheduler::PreambleStorage &Preambles;
   /// Callback invoked when preamble or main file AST is built.
   ParsingCallbacks &Callbacks;
   /// Only accessed by the worker thread.
@@ -252,6 +483,16 @@ private:
   /// Whether the diagnostics for the current FileInputs were reported to the
   /// users before.
   bool DiagsWereReported = false;
+  /// What the last AST built with all function bodies was built from, see
+  /// generateEditedBodyDiagnostics(). Only accessed by the worker thread.
+  struct FullASTSnapshot {
+    std::string Contents;
+    tooling::CompileCommand Command;
+    std::weak_ptr<const PreambleData> Preamble;
+    std::vector<Diag> Diags;
+    std::vector<FunctionBody> Bodies;
+  };
+  llvm::Optional<FullASTSnapshot> LastFullAST;
   /// Guards members used by both TUScheduler and the worker thread.
   mutable std::mutex Mutex;
   /// File inputs, currently being used by the worker.
@@ -259,6 +500,22 @@ private:
   /// be consumed by clients of ASTWorker.
   std::shared_ptr<const ParseInputs> FileInputs;         /* GUARDED_BY(Mutex) */
   std::shared_ptr<const PreambleData> LastBuiltPreamble; /* GUARDED_BY(Mutex) */
+  /// The inputs LastBuiltPreamble was built or last checked against.
+  std::shared_ptr<const ParseInputs> PreambleInputs; /* GUARDED_BY(Mutex) */
+  /// Incremented whenever the worker builds a preamble itself, as opposed to
+  /// on PreambleBuilds. The preamble section of the main file only changes
+  /// from one epoch to the next, so asynchronous builds that were scheduled in
+  /// an older epoch must be dropped.
+  unsigned PreambleEpoch = 0; /* GUARDED_BY(Mutex) */
+  /// Identifies the last build scheduled on PreambleBuilds. Older builds that
+  /// didn't start yet are obsolete.
+  unsigned LastScheduledBuild = 0; /* GUARDED_BY(Mutex) */
+  /// Number of builds scheduled on PreambleBuilds that didn't finish yet.
+  unsigned PreambleBuildsInFlight = 0; /* GUARDED_BY(Mutex) */
+  /// Waiting for the builds on PreambleBuilds to finish, see
+  /// getCurrentPreamble().
+  std::vector<llvm::unique_function<void(std::shared_ptr<const PreambleData>)>>
+      PreambleWaiters; /* GUARDED_BY(Mutex) */
   /// Becomes ready when the first preamble build finishes.
   Notification PreambleWasBuilt;
   /// Set to true to signal run() to finish processing.
@@ -320,12 +577,16 @@ private:
 
 ASTWorkerHandle
 ASTWorker::create(PathRef FileName, const GlobalCompilationDatabase &CDB,
-                  TUScheduler::ASTCache &IdleASTs, AsyncTaskRunner *Tasks,
-                  Semaphore &Barrier, steady_clock::duration UpdateDebounce,
-                  bool StorePreamblesInMemory, ParsingCallbacks &Callbacks) {
-  std::shared_ptr<ASTWorker> Worker(
-      new ASTWorker(FileName, CDB, IdleASTs, Barrier, /*RunSync=*/!Tasks,
-                    UpdateDebounce, StorePreamblesInMemory, Callbacks));
+                  TUScheduler::ASTCache &IdleASTs,
+                  TUScheduler::PreambleBuildQueue *PreambleBuilds,
+                  AsyncTaskRunner *Tasks, Semaphore &Barrier,
+                  steady_clock::duration UpdateDebounce,
+                  TUScheduler::PreambleStorage &Preambles,
+                  ParsingCallbacks &Callbacks) {
+  assert(!PreambleBuilds == !Tasks);
+  std::shared_ptr<ASTWorker> Worker(new ASTWorker(
+      FileName, CDB, IdleASTs, PreambleBuilds, Barrier, /*RunSync=*/!Tasks,
+      UpdateDebounce, Preambles, Callbacks));
   if (Tasks)
     Tasks->runAsync("worker:" + llvm::sys::path::filename(FileName),
                     [Worker]() { Worker->run(); });
@@ -334,13 +595,15 @@ ASTWorker::create(PathRef FileName, const GlobalCompilationDatabase &CDB,
 }
 
 ASTWorker::ASTWorker(PathRef FileName, const GlobalCompilationDatabase &CDB,
-                     TUScheduler::ASTCache &LRUCache, Semaphore &Barrier,
-                     bool RunSync, steady_clock::duration UpdateDebounce,
-                     bool StorePreamblesInMemory, ParsingCallbacks &Callbacks)
-    : IdleASTs(LRUCache), RunSync(RunSync), UpdateDebounce(UpdateDebounce),
-      FileName(FileName), CDB(CDB),
-      StorePreambleInMemory(StorePreamblesInMemory),
-      Callbacks(Callbacks), Status{TUAction(TUAction::Idle, ""),
+                     TUScheduler::ASTCache &LRUCache,
+                     TUScheduler::PreambleBuildQueue *PreambleBuilds,
+                     Semaphore &Barrier, bool RunSync,
+                     steady_clock::duration UpdateDebounce,
+                     TUScheduler::PreambleStorage &Preambles,
+                     ParsingCallbacks &Callbacks)
+    : IdleASTs(LRUCache), PreambleBuilds(PreambleBuilds), RunSync(RunSync),
+      UpdateDebounce(UpdateDebounce), FileName(FileName), CDB(CDB),
+      Preambles(Preambles), Callbacks(Callbacks), Status{TUAction(TUAction::Idle, ""),
                                    TUStatus::BuildDetails()},
       Barrier(Barrier), Done(false) {
   auto Inputs = std::make_shared<ParseInputs>();
@@ -358,6 +621,7 @@ ASTWorker::~ASTWorker() {
   std::lock_guard<std::mutex> Lock(Mutex);
   assert(Done && "handle was not destroyed");
   assert(Requests.empty() && "unprocessed requests when destroying ASTWorker");
+  assert(PreambleBuildsInFlight == 0 && "destroying ASTWorker while building");
 #endif
 }
 
@@ -408,21 +672,39 @@ void ASTWorker::update(ParseInputs Inputs, WantDiagnostics WantDiags) {
       return;
     }
 
-    std::shared_ptr<const PreambleData> OldPreamble =
-        getPossiblyStalePreamble();
-    std::shared_ptr<const PreambleData> NewPreamble = buildPreamble(
-        FileName, *Invocation, OldPreamble, OldCommand, Inputs,
-        StorePreambleInMemory,
-        [this](ASTContext &Ctx, std::shared_ptr<clang::Preprocessor> PP,
-               const CanonicalIncludes &CanonIncludes) {
-          Callbacks.onPreambleAST(FileName, Ctx, std::move(PP), CanonIncludes);
-        });
-
-    bool CanReuseAST = InputsAreTheSame && (OldPreamble == NewPreamble);
+    std::shared_ptr<const PreambleData> OldPreamble;
+    std::shared_ptr<const ParseInputs> OldPreambleInputs;
     {
       std::lock_guard<std::mutex> Lock(Mutex);
+      OldPreamble = LastBuiltPreamble;
+      OldPreambleInputs = PreambleInputs;
+    }
+    std::shared_ptr<const PreambleData> NewPreamble;
+    if (PreambleBuilds && OldPreamble &&
+        isPreambleCompatible(*OldPreambleInputs, Inputs, *Invocation)) {
+      // Only the included files may have changed. Checking that, and
+      // rebuilding the preamble if they did, can happen in the background.
+      schedulePreambleBuild(Inputs, WantDiags);
+      NewPreamble = OldPreamble;
+    } else {
+      bool InMemory = Preambles.storeInMemory();
+      NewPreamble = buildPreamble(
+          FileName, *Invocation, OldPreamble, OldCommand, Inputs, InMemory,
+          [this](ASTContext &Ctx, std::shared_ptr<clang::Preprocessor> PP,
+                 const CanonicalIncludes &CanonIncludes) {
+            Callbacks.onPreambleAST(FileName, Ctx, std::move(PP),
+                                    CanonIncludes);
+          });
+      if (InMemory && NewPreamble != OldPreamble)
+        NewPreamble = Preambles.track(std::move(NewPreamble));
+      std::lock_guard<std::mutex> Lock(Mutex);
+      if (NewPreamble != OldPreamble)
+        ++PreambleEpoch;
       LastBuiltPreamble = NewPreamble;
+      PreambleInputs = std::make_shared<ParseInputs>(Inputs);
     }
+
+    bool CanReuseAST = InputsAreTheSame && (OldPreamble == NewPreamble);
     // Before doing the expensive AST reparse, we want to release our reference
     // to the old preamble, so it can be freed if there are no other references
     // to it.
@@ -455,50 +737,276 @@ void ASTWorker::update(ParseInputs Inputs, WantDiagnostics WantDiags) {
     // We only need to build the AST if diagnostics were requested.
     if (WantDiags == WantDiagnostics::No)
       return;
+    if (!RunSync && generateEditedBodyDiagnostics(*Invocation, Inputs,
+                                                  NewPreamble, TaskName))
+      return;
+    generateDiagnostics(std::move(Invocation), Inputs, std::move(NewPreamble),
+                        TaskName);
+  };
+  startTask(TaskName, std::move(Task), WantDiags);
+}
+
+void ASTWorker::generateDiagnostics(
+    std::unique_ptr<CompilerInvocation> Invocation, const ParseInputs &Inputs,
+    std::shared_ptr<const PreambleData> Preamble, llvm::StringRef TaskName) {
+  {
+    std::lock_guard<std::mutex> Lock(DiagsMu);
+    // No need to rebuild the AST if we won't send the diagnotics. However,
+    // note that we don't prevent preamble rebuilds.
+    if (!ReportDiagnostics)
+      return;
+  }
 
+  std::weak_ptr<const PreambleData> PreambleRef = Preamble;
+  // Get the AST for diagnostics.
+  llvm::Optional<std::unique_ptr<ParsedAST>> AST = IdleASTs.take(this);
+  if (!AST) {
+    llvm::Optional<ParsedAST> NewAST =
+        buildAST(FileName, std::move(Invocation), Inputs, std::move(Preamble));
+    AST = NewAST ? llvm::make_unique<ParsedAST>(std::move(*NewAST)) : nullptr;
+    if (!(*AST)) { // buildAST fails.
+      TUStatus::BuildDetails Details;
+      Details.BuildFailed = true;
+      emitTUStatus({TUAction::BuildingFile, TaskName}, &Details);
+    }
+  } else {
+    // We are reusing the AST.
+    TUStatus::BuildDetails Details;
+    Details.ReuseAST = true;
+    emitTUStatus({TUAction::BuildingFile, TaskName}, &Details);
+  }
+  // We want to report the diagnostics even if this update was cancelled.
+  // It seems more useful than making the clients wait indefinitely if they
+  // spam us with updates.
+  // Note *AST can still be null if buildAST fails.
+  if (*AST) {
     {
       std::lock_guard<std::mutex> Lock(DiagsMu);
-      // No need to rebuild the AST if we won't send the diagnotics. However,
-      // note that we don't prevent preamble rebuilds.
-      if (!ReportDiagnostics)
-        return;
+      if (ReportDiagnostics)
+        Callbacks.onDiagnostics(FileName, (*AST)->getDiagnostics());
+    }
+    trace::Span Span("Running main AST callback");
+    Callbacks.onMainAST(FileName, **AST);
+    DiagsWereReported = true;
+    if (Inputs.Contents.size() < MinSizeToParseEditedBodies) {
+      LastFullAST.reset();
+    } else if (!(LastFullAST && LastFullAST->Contents == Inputs.Contents)) {
+      LastFullAST = FullASTSnapshot{Inputs.Contents, Inputs.CompileCommand,
+                                    PreambleRef, (*AST)->getDiagnostics(),
+                                    {}};
+      const SourceManager &SM = (*AST)->getSourceManager();
+      for (const Decl *D : (*AST)->getLocalTopLevelDecls())
+        collectFunctionBodies(D, SM, LastFullAST->Bodies);
     }
+  }
+  // Stash the AST in the cache for further use.
+  IdleASTs.put(this, std::move(*AST));
+}
 
-    // Get the AST for diagnostics.
-    llvm::Optional<std::unique_ptr<ParsedAST>> AST = IdleASTs.take(this);
-    if (!AST) {
-      llvm::Optional<ParsedAST> NewAST =
-          buildAST(FileName, std::move(Invocation), Inputs, NewPreamble);
-      AST = NewAST ? llvm::make_unique<ParsedAST>(std::move(*NewAST)) : nullptr;
-      if (!(*AST)) { // buildAST fails.
-        TUStatus::BuildDetails Details;
-        Details.BuildFailed = true;
-        emitTUStatus({TUAction::BuildingFile, TaskName}, &Details);
-      }
-    } else {
-      // We are reusing the AST.
-      TUStatus::BuildDetails Details;
-      Details.ReuseAST = true;
-      emitTUStatus({TUAction::BuildingFile, TaskName}, &Details);
+bool ASTWorker::generateEditedBodyDiagnostics(
+    const CompilerInvocation &Invocation, const ParseInputs &Inputs,
+    const std::shared_ptr<const PreambleData> &Preamble,
+    llvm::StringRef TaskName) {
+  if (!LastFullAST || LastFullAST->Preamble.lock() != Preamble ||
+      !(LastFullAST->Command == Inputs.CompileCommand))
+    return false;
+  {
+    std::lock_guard<std::mutex> Lock(DiagsMu);
+    if (!ReportDiagnostics)
+      return false;
+  }
+  // [Begin, OldEnd) of the old contents was replaced by [Begin, NewEnd).
+  llvm::StringRef Old = LastFullAST->Contents, New = Inputs.Contents;
+  std::size_t Common = std::min(Old.size(), New.size());
+  std::size_t Begin = 0;
+  while (Begin < Common && Old[Begin] == New[Begin])
+    ++Begin;
+  std::size_t SuffixSize = 0;
+  while (SuffixSize < Common - Begin &&
+         Old[Old.size() - SuffixSize - 1] == New[New.size() - SuffixSize - 1])
+    ++SuffixSize;
+  std::size_t OldEnd = Old.size() - SuffixSize;
+  std::size_t NewEnd = New.size() - SuffixSize;
+  auto Body = llvm::find_if(LastFullAST->Bodies, [&](const FunctionBody &B) {
+    return B.Begin < Begin && OldEnd <= B.End;
+  });
+  // The edit must not end the body early, or extend it.
+  if (Body == LastFullAST->Bodies.end() ||
+      braceBalance(Old.slice(Begin, OldEnd)) !=
+          braceBalance(New.slice(Begin, NewEnd)))
+    return false;
+  unsigned NewBodyEnd = Body->End - OldEnd + NewEnd;
+
+  ParseInputs BodyInputs = Inputs;
+  BodyInputs.Opts.KeepFunctionBodies = std::make_pair(Body->Name, NewBodyEnd);
+  llvm::Optional<ParsedAST> AST =
+      buildAST(FileName, llvm::make_unique<CompilerInvocation>(Invocation),
+               BodyInputs, Preamble);
+  if (!AST)
+    return false;
+
+  // Take the diagnostics inside the body from the new AST, and the others from
+  // the full one. Those after the edit move with the text.
+  Position BodyBeginPos = offsetToPosition(Old, Body->Begin);
+  Position OldBodyEndPos = offsetToPosition(Old, Body->End);
+  Position NewBodyEndPos = offsetToPosition(New, NewBodyEnd);
+  Position OldEditEnd = offsetToPosition(Old, OldEnd);
+  Position NewEditEnd = offsetToPosition(New, NewEnd);
+  auto Shift = [&](Position &P) {
+    if (P < OldEditEnd)
+      return;
+    if (P.line == OldEditEnd.line)
+      P.character += NewEditEnd.character - OldEditEnd.character;
+    P.line += NewEditEnd.line - OldEditEnd.line;
+  };
+  std::vector<Diag> Diags;
+  for (const Diag &D : LastFullAST->Diags) {
+    if (BodyBeginPos <= D.Range.start && D.Range.start <= OldBodyEndPos)
+      continue;
+    Diags.push_back(D);
+    Diag &Shifted = Diags.back();
+    Shift(Shifted.Range.start);
+    Shift(Shifted.Range.end);
+    for (Note &N : Shifted.Notes) {
+      if (!N.InsideMainFile)
+        continue;
+      Shift(N.Range.start);
+      Shift(N.Range.end);
     }
-    // We want to report the diagnostics even if this update was cancelled.
-    // It seems more useful than making the clients wait indefinitely if they
-    // spam us with updates.
-    // Note *AST can still be null if buildAST fails.
-    if (*AST) {
-      {
-        std::lock_guard<std::mutex> Lock(DiagsMu);
-        if (ReportDiagnostics)
-          Callbacks.onDiagnostics(FileName, (*AST)->getDiagnostics());
+    for (Fix &F : Shifted.Fixes)
+      for (TextEdit &E : F.Edits) {
+        Shift(E.range.start);
+        Shift(E.range.end);
+      }
+  }
+  for (const Diag &D : AST->getDiagnostics())
+    if (D.InsideMainFile && BodyBeginPos <= D.Range.start &&
+        D.Range.start <= NewBodyEndPos)
+      Diags.push_back(D);
+  std::stable_sort(Diags.begin(), Diags.end(),
+                   [](const Diag &L, const Diag &R) {
+                     return L.Range.start < R.Range.start;
+                   });
+  log("Parsed the edited function body of {0} only", FileName);
+  {
+    std::lock_guard<std::mutex> Lock(DiagsMu);
+    if (ReportDiagnostics)
+      Callbacks.onDiagnostics(FileName, std::move(Diags));
+  }
+
+  // The AST is incomplete, don't reuse it. Build the full one when no more
+  // edits come in, it refreshes the diagnostics too.
+  std::lock_guard<std::mutex> Lock(Mutex);
+  if (!Done)
+    Requests.push_back(Request{
+        [this] {
+          std::shared_ptr<const ParseInputs> Inputs = getCurrentFileInputs();
+          emitTUStatus({TUAction::BuildingFile, "Update"});
+          if (auto Invocation = buildCompilerInvocation(*Inputs))
+            generateDiagnostics(std::move(Invocation), *Inputs,
+                                getPossiblyStalePreamble(), "Update");
+        },
+        "RebuildEditedFile", steady_clock::now(), Context::current().clone(),
+        WantDiagnostics::Auto});
+  return true;
+}
+
+void ASTWorker::schedulePreambleBuild(ParseInputs Inputs,
+                                      WantDiagnostics WantDiags) {
+  unsigned Epoch, Build;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Epoch = PreambleEpoch;
+    Build = ++LastScheduledBuild;
+    ++PreambleBuildsInFlight;
+  }
+  PreambleBuilds->schedule(Bind(
+      [this, WantDiags, Epoch, Build](ParseInputs Inputs, Context Ctx) {
+        WithContext Guard(std::move(Ctx));
+        buildPreambleAsync(std::move(Inputs), WantDiags, Epoch, Build);
+      },
+      std::move(Inputs), Context::current().clone()));
+}
+
+void ASTWorker::buildPreambleAsync(ParseInputs Inputs,
+                                   WantDiagnostics WantDiags, unsigned Epoch,
+                                   unsigned Build) {
+  std::shared_ptr<const PreambleData> OldPreamble;
+  std::shared_ptr<const ParseInputs> OldPreambleInputs;
+  bool Obsolete;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Obsolete = Epoch != PreambleEpoch || Build != LastScheduledBuild;
+    OldPreamble = LastBuiltPreamble;
+    OldPreambleInputs = PreambleInputs;
+  }
+  bool Rebuilt = false;
+  if (!Obsolete) {
+    if (auto Invocation = buildCompilerInvocation(Inputs)) {
+      std::lock_guard<Semaphore> BarrierLock(Barrier);
+      bool InMemory = Preambles.storeInMemory();
+      std::shared_ptr<const PreambleData> NewPreamble = buildPreamble(
+          FileName, *Invocation, OldPreamble,
+          OldPreambleInputs->CompileCommand, Inputs, InMemory,
+          [this](ASTContext &Ctx, std::shared_ptr<clang::Preprocessor> PP,
+                 const CanonicalIncludes &CanonIncludes) {
+            Callbacks.onPreambleAST(FileName, Ctx, std::move(PP),
+                                    CanonIncludes);
+          });
+      if (InMemory && NewPreamble != OldPreamble)
+        NewPreamble = Preambles.track(std::move(NewPreamble));
+      std::lock_guard<std::mutex> Lock(Mutex);
+      if (NewPreamble != OldPreamble && Epoch == PreambleEpoch) {
+        LastBuiltPreamble = std::move(NewPreamble);
+        PreambleInputs = std::make_shared<ParseInputs>(std::move(Inputs));
+        Rebuilt = true;
       }
-      trace::Span Span("Running main AST callback");
-      Callbacks.onMainAST(FileName, **AST);
-      DiagsWereReported = true;
     }
-    // Stash the AST in the cache for further use.
-    IdleASTs.put(this, std::move(*AST));
-  };
-  startTask(TaskName, std::move(Task), WantDiags);
+  }
+  OldPreamble.reset();
+
+  std::vector<llvm::unique_function<void(std::shared_ptr<const PreambleData>)>>
+      Waiters;
+  std::shared_ptr<const PreambleData> Preamble;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    // The ASTs built since the update used the stale preamble, rebuild them.
+    // The current inputs are from this epoch too, so they are consistent with
+    // the new preamble.
+    if (Rebuilt && !Done)
+      Requests.push_back(Request{
+          [this, Epoch, WantDiags] {
+            std::shared_ptr<const ParseInputs> Inputs;
+            std::shared_ptr<const PreambleData> Preamble;
+            {
+              std::lock_guard<std::mutex> Lock(Mutex);
+              if (Epoch != PreambleEpoch)
+                return;
+              Inputs = FileInputs;
+              Preamble = LastBuiltPreamble;
+            }
+            IdleASTs.take(this);
+            DiagsWereReported = false;
+            if (WantDiags == WantDiagnostics::No)
+              return;
+            emitTUStatus({TUAction::BuildingFile, "Update"});
+            if (auto Invocation = buildCompilerInvocation(*Inputs))
+              generateDiagnostics(std::move(Invocation), *Inputs,
+                                  std::move(Preamble), "Update");
+          },
+          "RebuildWithPreamble", steady_clock::now(),
+          Context::current().derive(kFileBeingProcessed, FileName),
+          WantDiags});
+    if (--PreambleBuildsInFlight == 0) {
+      Waiters = std::move(PreambleWaiters);
+      PreambleWaiters.clear();
+      Preamble = LastBuiltPreamble;
+    }
+    // The worker may be destroyed as soon as we release the lock.
+    RequestsCV.notify_all();
+  }
+  for (auto &Waiter : Waiters)
+    Waiter(Preamble);
 }
 
 void ASTWorker::runWithAST(
@@ -550,15 +1058,15 @@ void ASTWorker::getCurrentPreamble(
       std::find_if(Requests.rbegin(), Requests.rend(),
                    [](const Request &R) { return R.UpdateType.hasValue(); });
   // If there were no writes in the queue, the preamble is ready now.
-  if (LastUpdate == Requests.rend()) {
-    Lock.unlock();
-    return Callback(getPossiblyStalePreamble());
-  }
+  if (LastUpdate == Requests.rend())
+    return deliverPreambleLocked(Lock, std::move(Callback));
   assert(!RunSync && "Running synchronously, but queue is non-empty!");
   Requests.insert(LastUpdate.base(),
                   Request{Bind(
                               [this](decltype(Callback) Callback) {
-                                Callback(getPossiblyStalePreamble());
+                                std::unique_lock<std::mutex> Lock(Mutex);
+                                deliverPreambleLocked(Lock,
+                                                      std::move(Callback));
                               },
                               std::move(Callback)),
                           "GetPreamble", steady_clock::now(),
@@ -568,6 +1076,18 @@ void ASTWorker::getCurrentPreamble(
   RequestsCV.notify_all();
 }
 
+void ASTWorker::deliverPreambleLocked(
+    std::unique_lock<std::mutex> &Lock,
+    llvm::unique_function<void(std::shared_ptr<const PreambleData>)>
+        Callback) {
+  // The updates so far may still be checking their preamble.
+  if (PreambleBuildsInFlight > 0)
+    return PreambleWaiters.push_back(std::move(Callback));
+  std::shared_ptr<const PreambleData> Preamble = LastBuiltPreamble;
+  Lock.unlock();
+  Callback(std::move(Preamble));
+}
+
 void ASTWorker::waitForFirstPreamble() const { PreambleWasBuilt.wait(); }
 
 std::shared_ptr<const ParseInputs> ASTWorker::getCurrentFileInputs() const {
@@ -645,10 +1165,15 @@ void ASTWorker::run() {
       for (auto Wait = scheduleLocked(); !Wait.expired();
            Wait = scheduleLocked()) {
         if (Done) {
-          if (Requests.empty())
-            return;
-          else     // Even though Done is set, finish pending requests.
-            break; // However, skip delays to shutdown fast.
+          if (Requests.empty()) {
+            if (PreambleBuildsInFlight == 0)
+              return;
+            // The builds on PreambleBuilds may still refer to this worker.
+            RequestsCV.wait(Lock);
+            continue;
+          }
+          break; // Even though Done is set, finish pending requests.
+                 // However, skip delays to shutdown fast.
         }
 
         // Tracing: we have a next request, attribute this sleep to it.
@@ -766,7 +1291,9 @@ bool ASTWorker::shouldSkipHeadLocked() const {
 
 bool ASTWorker::blockUntilIdle(Deadline Timeout) const {
   std::unique_lock<std::mutex> Lock(Mutex);
-  return wait(Lock, RequestsCV, Timeout, [&] { return Requests.empty(); });
+  return wait(Lock, RequestsCV, Timeout, [&] {
+    return Requests.empty() && PreambleBuildsInFlight == 0;
+  });
 }
 
 // Render a TUAction to a user-facing string representation.
@@ -826,14 +1353,17 @@ TUScheduler::TUScheduler(const GlobalCompilationDatabase &CDB,
                          bool StorePreamblesInMemory,
                          std::unique_ptr<ParsingCallbacks> Callbacks,
                          std::chrono::steady_clock::duration UpdateDebounce,
-                         ASTRetentionPolicy RetentionPolicy)
-    : CDB(CDB), StorePreamblesInMemory(StorePreamblesInMemory),
-      Callbacks(Callbacks ? move(Callbacks)
-                          : llvm::make_unique<ParsingCallbacks>()),
+                         ASTRetentionPolicy RetentionPolicy,
+                         std::size_t MaxInMemoryPreambleBytes)
+    : CDB(CDB), Callbacks(Callbacks ? move(Callbacks)
+                                    : llvm::make_unique<ParsingCallbacks>()),
       Barrier(AsyncThreadsCount),
-      IdleASTs(llvm::make_unique<ASTCache>(RetentionPolicy.MaxRetainedASTs)),
+      Preambles(llvm::make_unique<PreambleStorage>(StorePreamblesInMemory,
+                                                   MaxInMemoryPreambleBytes)),
+      IdleASTs(llvm::make_unique<ASTCache>(RetentionPolicy)),
       UpdateDebounce(UpdateDebounce) {
   if (0 < AsyncThreadsCount) {
+    PreambleBuilds = llvm::make_unique<PreambleBuildQueue>(AsyncThreadsCount);
     PreambleTasks.emplace();
     WorkerThreads.emplace();
   }
@@ -848,6 +1378,8 @@ TUScheduler::~TUScheduler() {
     PreambleTasks->wait();
   if (WorkerThreads)
     WorkerThreads->wait();
+  // The workers wait for their preamble builds, so this doesn't block.
+  PreambleBuilds.reset();
 }
 
 bool TUScheduler::blockUntilIdle(Deadline D) const {
@@ -866,9 +1398,9 @@ void TUScheduler::update(PathRef File, ParseInputs Inputs,
   if (!FD) {
     // Create a new worker to process the AST-related tasks.
     ASTWorkerHandle Worker = ASTWorker::create(
-        File, CDB, *IdleASTs,
+        File, CDB, *IdleASTs, PreambleBuilds.get(),
         WorkerThreads ? WorkerThreads.getPointer() : nullptr, Barrier,
-        UpdateDebounce, StorePreamblesInMemory, *Callbacks);
+        UpdateDebounce, *Preambles, *Callbacks);
     FD = std::unique_ptr<FileData>(
         new FileData{Inputs.Contents, std::move(Worker)});
   } else {
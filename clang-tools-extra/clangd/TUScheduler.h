@@ -18,6 +18,7 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include <future>
+#include <limits>
 
 namespace clang {
 namespace clangd {
@@ -51,9 +52,13 @@ enum class WantDiagnostics {
 /// *idle* ASTs. If queue has operations requiring the AST, they might be
 /// kept in memory.
 struct ASTRetentionPolicy {
+  /// Maximum estimated size (see ParsedAST::getUsedBytes()) of the ASTs to be
+  /// retained in memory when there are no pending requests for them. The most
+  /// recently used AST is retained even if it doesn't fit on its own.
+  std::size_t MaxRetainedBytes = 1024 * 1024 * 1024;
   /// Maximum number of ASTs to be retained in memory when there are no pending
   /// requests for them.
-  unsigned MaxRetainedASTs = 3;
+  unsigned MaxRetainedASTs = std::numeric_limits<unsigned>::max();
 };
 
 struct TUAction {
@@ -126,11 +131,15 @@ public:
 /// FIXME(sammccall): pull out a scheduler options struct.
 class TUScheduler {
 public:
+  /// With \p StorePreamblesInMemory, preambles are stored on disk anyway while
+  /// those in memory take \p MaxInMemoryPreambleBytes or more.
   TUScheduler(const GlobalCompilationDatabase &CDB, unsigned AsyncThreadsCount,
               bool StorePreamblesInMemory,
               std::unique_ptr<ParsingCallbacks> ASTCallbacks,
               std::chrono::steady_clock::duration UpdateDebounce,
-              ASTRetentionPolicy RetentionPolicy);
+              ASTRetentionPolicy RetentionPolicy,
+              std::size_t MaxInMemoryPreambleBytes =
+                  std::numeric_limits<std::size_t>::max());
   ~TUScheduler();
 
   /// Returns estimated memory usage for each of the currently open files.
@@ -211,6 +220,12 @@ public:
   /// Responsible for retaining and rebuilding idle ASTs. An implementation is
   /// an LRU cache.
   class ASTCache;
+  /// Runs the preamble builds that don't need to block their ASTWorker on a
+  /// shared pool of threads.
+  class PreambleBuildQueue;
+  /// Decides whether preambles are stored in memory or on disk, and accounts
+  /// for the memory used by all of them.
+  class PreambleStorage;
 
   // The file being built/processed in the current thread. This is a hack in
   // order to get the file name into the index implementations. Do not depend on
@@ -221,11 +236,13 @@ public:
 
 private:
   const GlobalCompilationDatabase &CDB;
-  const bool StorePreamblesInMemory;
   std::unique_ptr<ParsingCallbacks> Callbacks; // not nullptr
   Semaphore Barrier;
+  std::unique_ptr<PreambleStorage> Preambles;
   llvm::StringMap<std::unique_ptr<FileData>> Files;
   std::unique_ptr<ASTCache> IdleASTs;
+  // Null when running tasks synchronously.
+  std::unique_ptr<PreambleBuildQueue> PreambleBuilds;
   // None when running tasks synchronously and non-None when running tasks
   // asynchronously.
   llvm::Optional<AsyncTaskRunner> PreambleTasks;
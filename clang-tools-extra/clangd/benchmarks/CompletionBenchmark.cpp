@@ -0,0 +1,168 @@
+//===--- CompletionBenchmark.cpp - Clangd code completion benchmarks ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the latency of code completion in a large scope, with the symbols
+// coming from Sema, from an index, or from an index that is slow to answer.
+//
+//===----------------------------------------------------------------------===//
+
+#include "../ClangdUnit.h"
+#include "../CodeComplete.h"
+#include "../Compiler.h"
+#include "../SourceCode.h"
+#include "../index/MemIndex.h"
+#include "benchmark/benchmark.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace clang {
+namespace clangd {
+namespace {
+
+constexpr unsigned ScopeSize = 20000;
+const char MainFile[] = "/clangd-benchmark/main.cpp";
+const char MainContents[] = "#include \"scope.h\"\nint x = ns::func";
+
+// A header declaring ScopeSize functions in namespace ns.
+std::string scopeHeader() {
+  std::string Code = "namespace ns {\n";
+  for (unsigned I = 0; I < ScopeSize; ++I)
+    Code += "int function" + std::to_string(I) + "(int);\n";
+  return Code + "}\n";
+}
+
+// As many functions in namespace ns, as an index would have them.
+std::unique_ptr<SymbolIndex> buildIndex() {
+  SymbolSlab::Builder Symbols;
+  for (unsigned I = 0; I < ScopeSize; ++I) {
+    std::string Name = "indexedFunction" + std::to_string(I);
+    Symbol Sym;
+    Sym.ID = SymbolID("ns::" + Name);
+    Sym.Name = Name;
+    Sym.Scope = "ns::";
+    Sym.SymInfo.Kind = index::SymbolKind::Function;
+    Sym.SymInfo.Lang = index::SymbolLanguage::CXX;
+    Sym.Flags |= Symbol::IndexedForCodeCompletion;
+    Symbols.insert(Sym);
+  }
+  return MemIndex::build(std::move(Symbols).build(), RefSlab());
+}
+
+// Takes 100ms to answer fuzzyFind, like a remote index on a slow network.
+class SlowIndex : public SymbolIndex {
+public:
+  SlowIndex(const SymbolIndex &Index) : Index(Index) {}
+
+  bool
+  fuzzyFind(const FuzzyFindRequest &Req,
+            llvm::function_ref<void(const Symbol &)> Callback) const override {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    return Index.fuzzyFind(Req, Callback);
+  }
+
+  void lookup(const LookupRequest &Req,
+              llvm::function_ref<void(const Symbol &)> Callback) const override {
+    Index.lookup(Req, Callback);
+  }
+
+  void refs(const RefsRequest &Req,
+            llvm::function_ref<void(const Ref &)> Callback) const override {
+    Index.refs(Req, Callback);
+  }
+
+  size_t estimateMemoryUsage() const override { return 0; }
+
+private:
+  const SymbolIndex &Index;
+};
+
+class Completion {
+public:
+  Completion() {
+    llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> FS(
+        new llvm::vfs::InMemoryFileSystem);
+    FS->addFile(MainFile, 0, llvm::MemoryBuffer::getMemBuffer(MainContents));
+    FS->addFile("/clangd-benchmark/scope.h", 0,
+                llvm::MemoryBuffer::getMemBufferCopy(scopeHeader()));
+    Inputs.FS = FS;
+    Inputs.Contents = MainContents;
+    Inputs.CompileCommand = tooling::CompileCommand(
+        "/clangd-benchmark", MainFile, {"clang", MainFile}, "");
+    auto CI = buildCompilerInvocation(Inputs);
+    Preamble = buildPreamble(MainFile, *CI, /*OldPreamble=*/nullptr,
+                             tooling::CompileCommand(), Inputs,
+                             /*StoreInMemory=*/true, PreambleParsedCallback());
+  }
+
+  // Completes at the end of the main file.
+  CodeCompleteResult run(const CodeCompleteOptions &Opts,
+                         SpeculativeFuzzyFind *SpecFuzzyFind = nullptr) {
+    return codeComplete(MainFile, Inputs.CompileCommand, Preamble.get(),
+                        Inputs.Contents,
+                        offsetToPosition(Inputs.Contents,
+                                         Inputs.Contents.size()),
+                        Inputs.FS, Opts, SpecFuzzyFind);
+  }
+
+private:
+  ParseInputs Inputs;
+  std::shared_ptr<const PreambleData> Preamble;
+};
+
+static void SemaCompletion(benchmark::State &State) {
+  Completion C;
+  CodeCompleteOptions Opts;
+  Opts.Limit = 100;
+  for (auto _ : State)
+    benchmark::DoNotOptimize(C.run(Opts));
+}
+BENCHMARK(SemaCompletion)->Unit(benchmark::kMillisecond);
+
+static void SemaAndIndexCompletion(benchmark::State &State) {
+  Completion C;
+  auto Index = buildIndex();
+  CodeCompleteOptions Opts;
+  Opts.Limit = 100;
+  Opts.Index = Index.get();
+  for (auto _ : State)
+    benchmark::DoNotOptimize(C.run(Opts));
+}
+BENCHMARK(SemaAndIndexCompletion)->Unit(benchmark::kMillisecond);
+
+// The argument is CodeCompleteOptions::LatencyBudget, in milliseconds (0 means
+// waiting for the index). Only the time until the results are returned is
+// measured, not the time it takes for the late index request to finish.
+static void SlowIndexCompletion(benchmark::State &State) {
+  Completion C;
+  auto Index = buildIndex();
+  SlowIndex Slow(*Index);
+  CodeCompleteOptions Opts;
+  Opts.Limit = 100;
+  Opts.Index = &Slow;
+  Opts.LatencyBudget = std::chrono::milliseconds(State.range(0));
+  for (auto _ : State) {
+    SpeculativeFuzzyFind SpecFuzzyFind;
+    benchmark::DoNotOptimize(C.run(Opts, &SpecFuzzyFind));
+    State.PauseTiming();
+    if (SpecFuzzyFind.LateResult.valid())
+      SpecFuzzyFind.LateResult.wait();
+    State.ResumeTiming();
+  }
+}
+BENCHMARK(SlowIndexCompletion)
+    ->Arg(0)
+    ->Arg(20)
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace clangd
+} // namespace clang
+
+BENCHMARK_MAIN();
@@ -8,12 +8,16 @@
 
 #include "../index/Serialization.h"
 #include "../index/dex/Dex.h"
+#include "../index/dex/Iterator.h"
+#include "../index/dex/PostingList.h"
 #include "benchmark/benchmark.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Regex.h"
+#include <algorithm>
 #include <fstream>
+#include <random>
 #include <streambuf>
 #include <string>
 
@@ -72,7 +76,6 @@ static void MemQueries(benchmark::State &State) {
     for (const auto &Request : Requests)
       Mem->fuzzyFind(Request, [](const Symbol &S) {});
 }
-BENCHMARK(MemQueries);
 
 static void DexQueries(benchmark::State &State) {
   const auto Dex = buildDex();
@@ -81,7 +84,61 @@ static void DexQueries(benchmark::State &State) {
     for (const auto &Request : Requests)
       Dex->fuzzyFind(Request, [](const Symbol &S) {});
 }
-BENCHMARK(DexQueries);
+
+// Synthetic workloads, as for short trigrams in an index of 10M symbols: their
+// posting lists are long, and their intersection is much shorter.
+constexpr dex::DocID SyntheticIndexSize = 10000000;
+
+// Returns Size random DocIDs, with the given seed to make runs comparable.
+dex::PostingList syntheticPostingList(size_t Size, unsigned Seed) {
+  std::mt19937 Generator(Seed);
+  std::uniform_int_distribution<dex::DocID> Distribution(
+      0, SyntheticIndexSize - 1);
+  std::vector<dex::DocID> Docs(Size);
+  for (dex::DocID &Doc : Docs)
+    Doc = Distribution(Generator);
+  llvm::sort(Docs);
+  Docs.erase(std::unique(Docs.begin(), Docs.end()), Docs.end());
+  return dex::PostingList(Docs);
+}
+
+// The argument is the length of the shortest posting list, the others are 2
+// and 4 times longer.
+std::vector<dex::PostingList> syntheticPostingLists(benchmark::State &State) {
+  std::vector<dex::PostingList> Lists;
+  for (unsigned I = 0; I < 3; ++I)
+    Lists.push_back(syntheticPostingList(State.range(0) << I, I));
+  return Lists;
+}
+
+size_t countMatches(dex::Iterator &It) {
+  size_t Count = 0;
+  for (; !It.reachedEnd(); It.advance())
+    ++Count;
+  return Count;
+}
+
+static void DexIntersection(benchmark::State &State) {
+  const auto Lists = syntheticPostingLists(State);
+  dex::Corpus Corpus(SyntheticIndexSize);
+  for (auto _ : State) {
+    auto It = Corpus.intersect(Lists[0].iterator(), Lists[1].iterator(),
+                               Lists[2].iterator());
+    benchmark::DoNotOptimize(countMatches(*It));
+  }
+}
+BENCHMARK(DexIntersection)->Arg(100000)->Arg(1000000);
+
+static void DexUnion(benchmark::State &State) {
+  const auto Lists = syntheticPostingLists(State);
+  dex::Corpus Corpus(SyntheticIndexSize);
+  for (auto _ : State) {
+    auto It = Corpus.unionOf(Lists[0].iterator(), Lists[1].iterator(),
+                             Lists[2].iterator());
+    benchmark::DoNotOptimize(countMatches(*It));
+  }
+}
+BENCHMARK(DexUnion)->Arg(10000)->Arg(100000);
 
 } // namespace
 } // namespace clangd
@@ -91,20 +148,24 @@ BENCHMARK(DexQueries);
 // FIXME(kbobyrev): Add memory consumption "benchmarks" by manually measuring
 // in-memory index size and reporting it as time.
 // FIXME(kbobyrev): Create a logger wrapper to suppress debugging info printer.
+// The synthetic benchmarks always run, the others need an index and requests.
 int main(int argc, char *argv[]) {
-  if (argc < 3) {
+  if (argc >= 3 && argv[1][0] != '-') {
+    IndexFilename = argv[1];
+    RequestsFilename = argv[2];
+    // Trim first two arguments of the benchmark invocation and pretend no
+    // arguments were passed in the first place.
+    argv[2] = argv[0];
+    argv += 2;
+    argc -= 2;
+    ::benchmark::RegisterBenchmark("MemQueries", clang::clangd::MemQueries);
+    ::benchmark::RegisterBenchmark("DexQueries", clang::clangd::DexQueries);
+  } else {
     llvm::errs() << "Usage: " << argv[0]
-                 << " global-symbol-index.yaml requests.json "
-                    "BENCHMARK_OPTIONS...\n";
-    return -1;
+                 << " [global-symbol-index.yaml requests.json] "
+                    "BENCHMARK_OPTIONS...\n"
+                 << "Only running the synthetic benchmarks.\n";
   }
-  IndexFilename = argv[1];
-  RequestsFilename = argv[2];
-  // Trim first two arguments of the benchmark invocation and pretend no
-  // arguments were passed in the first place.
-  argv[2] = argv[0];
-  argv += 2;
-  argc -= 2;
   ::benchmark::Initialize(&argc, argv);
   ::benchmark::RunSpecifiedBenchmarks();
 }
@@ -17,6 +17,7 @@
 #include "URI.h"
 #include "index/IndexAction.h"
 #include "index/MemIndex.h"
+#include "index/Merge.h"
 #include "index/Serialization.h"
 #include "index/SymbolCollector.h"
 #include "clang/Basic/SourceLocation.h"
@@ -130,6 +131,25 @@ llvm::SmallString<128> getAbsolutePath(const tooling::CompileCommand &Cmd) {
   }
   return AbsolutePath;
 }
+
+// Serves the files updated since the last full build on top of it.
+class LayeredIndex : public MergedIndex {
+public:
+  LayeredIndex(std::unique_ptr<SymbolIndex> Recent,
+               std::shared_ptr<SymbolIndex> Full)
+      : MergedIndex(Recent.get(), Full.get()), RecentLayer(std::move(Recent)),
+        FullLayer(std::move(Full)) {}
+
+private:
+  std::unique_ptr<SymbolIndex> RecentLayer;
+  std::shared_ptr<SymbolIndex> FullLayer;
+};
+
+// We rebuild the full index once the recent files reach this fraction of all
+// files: rebuilding the smaller index for each TU is then no longer cheap.
+constexpr unsigned RecentFilesRatio = 8;
+// Number of files passed to boostRelated() that we prioritize.
+constexpr unsigned MaxFocusFiles = 8;
 } // namespace
 
 BackgroundIndex::BackgroundIndex(
@@ -177,8 +197,7 @@ void BackgroundIndex::stop() {
 void BackgroundIndex::run() {
   WithContext Background(BackgroundContext.clone());
   while (true) {
-    llvm::Optional<Task> Task;
-    llvm::ThreadPriority Priority;
+    Task T;
     {
       std::unique_lock<std::mutex> Lock(QueueMu);
       QueueCV.wait(Lock, [&] { return ShouldStop || !Queue.empty(); });
@@ -188,16 +207,29 @@ void BackgroundIndex::run() {
         return;
       }
       ++NumActiveTasks;
-      std::tie(Task, Priority) = std::move(Queue.front());
-      Queue.pop_front();
+      std::pop_heap(Queue.begin(), Queue.end(), runsLater);
+      T = std::move(Queue.back());
+      Queue.pop_back();
     }
 
+    llvm::ThreadPriority Priority = T.ThreadPri;
     if (Priority != llvm::ThreadPriority::Default && !PreventStarvation.load())
       llvm::set_thread_priority(Priority);
-    (*Task)();
+    T.Run();
     if (Priority != llvm::ThreadPriority::Default)
       llvm::set_thread_priority(llvm::ThreadPriority::Default);
 
+    bool Idle;
+    {
+      std::unique_lock<std::mutex> Lock(QueueMu);
+      Idle = Queue.empty() && NumActiveTasks == 1;
+    }
+    // Once we're out of work, fold the recently updated files into the full
+    // index. This drops the symbols they no longer define, which the recent
+    // index can't hide. Do it before becoming idle so that tests see it.
+    if (Idle && BuildIndexPeriodMs == 0 && IndexedSymbols.numRecentFiles() > 0)
+      publishIndex(/*Full=*/true);
+
     {
       std::unique_lock<std::mutex> Lock(QueueMu);
       assert(NumActiveTasks > 0 && "before decrementing");
@@ -215,53 +247,91 @@ bool BackgroundIndex::blockUntilIdleForTest(
 }
 
 void BackgroundIndex::enqueue(const std::vector<std::string> &ChangedFiles) {
-  enqueueTask(
-      [this, ChangedFiles] {
-        trace::Span Tracer("BackgroundIndexEnqueue");
-        // We're doing this asynchronously, because we'll read shards here too.
-        log("Enqueueing {0} commands for indexing", ChangedFiles.size());
-        SPAN_ATTACH(Tracer, "files", int64_t(ChangedFiles.size()));
-
-        auto NeedsReIndexing = loadShards(std::move(ChangedFiles));
-        // Run indexing for files that need to be updated.
-        std::shuffle(NeedsReIndexing.begin(), NeedsReIndexing.end(),
-                     std::mt19937(std::random_device{}()));
-        for (auto &Elem : NeedsReIndexing)
-          enqueue(std::move(Elem.first), Elem.second);
+  Task T;
+  T.Run = [this, ChangedFiles] {
+    trace::Span Tracer("BackgroundIndexEnqueue");
+    // We're doing this asynchronously, because we'll read shards here too.
+    log("Enqueueing {0} commands for indexing", ChangedFiles.size());
+    SPAN_ATTACH(Tracer, "files", int64_t(ChangedFiles.size()));
+
+    auto NeedsReIndexing = loadShards(std::move(ChangedFiles));
+    // Run indexing for files that need to be updated. Unless boostRelated()
+    // tells us which files matter, spread the work over the whole project.
+    std::shuffle(NeedsReIndexing.begin(), NeedsReIndexing.end(),
+                 std::mt19937(std::random_device{}()));
+    for (auto &TU : NeedsReIndexing)
+          enqueue(std::move(TU));
+  };
+  enqueueTask(std::move(T));
+}
+
+void BackgroundIndex::enqueue(TUToIndex TU) {
+  Task T;
+  T.File = getAbsolutePath(TU.Cmd).str();
+  T.Run = Bind(
+      [this](tooling::CompileCommand Cmd, BackgroundIndexStorage *Storage) {
+        // We can't use llvm::StringRef here since we are going to
+        // move from Cmd during the call below.
+        const std::string FileName = Cmd.Filename;
+        if (auto Error = index(std::move(Cmd), Storage))
+          elog("Indexing {0} failed: {1}", FileName, std::move(Error));
       },
-      llvm::ThreadPriority::Default);
+      std::move(TU.Cmd), TU.Storage);
+  T.ThreadPri = llvm::ThreadPriority::Background;
+  T.Dependencies = std::move(TU.Dependencies);
+  enqueueTask(std::move(T));
+}
+
+void BackgroundIndex::enqueueTask(Task T) {
+  {
+    std::lock_guard<std::mutex> Lock(QueueMu);
+    T.QueuePri = queuePriorityLocked(T);
+    T.Seq = NextSeq++;
+    Queue.push_back(std::move(T));
+    std::push_heap(Queue.begin(), Queue.end(), runsLater);
+  }
+  QueueCV.notify_all();
+}
+
+// Tasks with default thread priority come first (they are pretty rare, and
+// produce more work), then indexing of the TUs related to FocusFiles.
+unsigned BackgroundIndex::queuePriorityLocked(const Task &T) {
+  if (T.ThreadPri == llvm::ThreadPriority::Default)
+    return 0;
+  if (!FocusDistance)
+    return 1;
+  for (const std::string &Focus : FocusFiles)
+    if (T.File == Focus || llvm::is_contained(T.Dependencies, Focus))
+      return 1;
+  return std::min(FocusDistance->distance(T.File),
+                  FileDistance::Unreachable - 2) +
+         2;
 }
 
-void BackgroundIndex::enqueue(tooling::CompileCommand Cmd,
-                              BackgroundIndexStorage *Storage) {
-  enqueueTask(Bind(
-                  [this, Storage](tooling::CompileCommand Cmd) {
-                    // We can't use llvm::StringRef here since we are going to
-                    // move from Cmd during the call below.
-                    const std::string FileName = Cmd.Filename;
-                    if (auto Error = index(std::move(Cmd), Storage))
-                      elog("Indexing {0} failed: {1}", FileName,
-                           std::move(Error));
-                  },
-                  std::move(Cmd)),
-              llvm::ThreadPriority::Background);
+bool BackgroundIndex::runsLater(const Task &L, const Task &R) {
+  return std::tie(L.QueuePri, L.Seq) > std::tie(R.QueuePri, R.Seq);
 }
 
-void BackgroundIndex::enqueueTask(Task T, llvm::ThreadPriority Priority) {
+void BackgroundIndex::boostRelated(llvm::StringRef Path) {
   {
     std::lock_guard<std::mutex> Lock(QueueMu);
-    auto I = Queue.end();
-    // We first store the tasks with Normal priority in the front of the queue.
-    // Then we store low priority tasks. Normal priority tasks are pretty rare,
-    // they should not grow beyond single-digit numbers, so it is OK to do
-    // linear search and insert after that.
-    if (Priority == llvm::ThreadPriority::Default) {
-      I = llvm::find_if(
-          Queue, [](const std::pair<Task, llvm::ThreadPriority> &Elem) {
-            return Elem.second == llvm::ThreadPriority::Background;
-          });
-    }
-    Queue.insert(I, {std::move(T), Priority});
+    // Files are boosted on every edit, make that cheap.
+    if (!FocusFiles.empty() && FocusFiles.front() == Path)
+      return;
+    auto It = llvm::find(FocusFiles, Path);
+    if (It != FocusFiles.end())
+      FocusFiles.erase(It);
+    FocusFiles.insert(FocusFiles.begin(), Path.str());
+    if (FocusFiles.size() > MaxFocusFiles)
+      FocusFiles.pop_back();
+
+    llvm::StringMap<SourceParams> Sources;
+    for (const std::string &Focus : FocusFiles)
+      Sources[Focus] = SourceParams();
+    FocusDistance.emplace(std::move(Sources));
+    for (Task &T : Queue)
+      T.QueuePri = queuePriorityLocked(T);
+    std::make_heap(Queue.begin(), Queue.end(), runsLater);
   }
   QueueCV.notify_all();
 }
@@ -380,14 +450,40 @@ void BackgroundIndex::buildIndex() {
     // index is rebuilt below. The new index would contain the updated symbols
     // but the flag would still be true. This is fine as we would simply run an
     // extra index build.
-    reset(
-        IndexedSymbols.buildIndex(IndexType::Heavy, DuplicateHandling::Merge));
+    bool Idle;
+    {
+      std::lock_guard<std::mutex> Lock(QueueMu);
+      Idle = Queue.empty() && NumActiveTasks == 0;
+    }
+    publishIndex(/*Full=*/Idle);
     log("BackgroundIndex: rebuilt symbol index with estimated memory {0} "
         "bytes.",
         estimateMemoryUsage());
   }
 }
 
+void BackgroundIndex::publishIndex(bool Full) {
+  std::lock_guard<std::mutex> Lock(PublishMu);
+  size_t Recent = IndexedSymbols.numRecentFiles();
+  if (!FullIndex || Recent * RecentFilesRatio > IndexedSymbols.numFiles())
+    Full = true;
+  if (Full) {
+    trace::Span Tracer("BackgroundIndexFullBuild");
+    FullIndex =
+        IndexedSymbols.buildIndex(IndexType::Heavy, DuplicateHandling::Merge);
+    reset(llvm::make_unique<LayeredIndex>(llvm::make_unique<MemIndex>(),
+                                          FullIndex));
+    return;
+  }
+  // Symbols defined in both layers have their references counted twice, and
+  // symbols removed from the recent files linger until the next full build.
+  // Both are tolerable until then.
+  reset(llvm::make_unique<LayeredIndex>(
+      IndexedSymbols.buildRecentIndex(IndexType::Light,
+                                      DuplicateHandling::Merge),
+      FullIndex));
+}
+
 llvm::Error BackgroundIndex::index(tooling::CompileCommand Cmd,
                                    BackgroundIndexStorage *IndexStorage) {
   trace::Span Tracer("BackgroundIndex");
@@ -466,8 +562,7 @@ llvm::Error BackgroundIndex::index(tooling::CompileCommand Cmd,
   if (BuildIndexPeriodMs > 0)
     SymbolsUpdatedSinceLastIndex = true;
   else
-    reset(
-        IndexedSymbols.buildIndex(IndexType::Light, DuplicateHandling::Merge));
+    publishIndex(/*Full=*/false);
 
   return llvm::Error::success();
 }
@@ -581,10 +676,9 @@ BackgroundIndex::loadShard(const tooling::CompileCommand &Cmd,
 
 // Goes over each changed file and loads them from index. Returns the list of
 // TUs that had out-of-date/no shards.
-std::vector<std::pair<tooling::CompileCommand, BackgroundIndexStorage *>>
+std::vector<BackgroundIndex::TUToIndex>
 BackgroundIndex::loadShards(std::vector<std::string> ChangedFiles) {
-  std::vector<std::pair<tooling::CompileCommand, BackgroundIndexStorage *>>
-      NeedsReIndexing;
+  std::vector<TUToIndex> NeedsReIndexing;
   // Keeps track of the files that will be reindexed, to make sure we won't
   // re-index same dependencies more than once. Keys are AbsolutePaths.
   llvm::StringSet<> FilesToIndex;
@@ -606,16 +700,21 @@ BackgroundIndex::loadShards(std::vector<std::string> ChangedFiles) {
       // out a minimal set of TUs that will cover all the stale dependencies.
       vlog("Enqueueing TU {0} because its dependency {1} needs re-indexing.",
            Cmd->Filename, Dependency.Path);
-      NeedsReIndexing.push_back({std::move(*Cmd), IndexStorage});
+      TUToIndex TU;
+      TU.Cmd = std::move(*Cmd);
+      TU.Storage = IndexStorage;
       // Mark all of this TU's dependencies as to-be-indexed so that we won't
       // try to re-index those.
-      for (const auto &Dependency : Dependencies)
+      for (const auto &Dependency : Dependencies) {
         FilesToIndex.insert(Dependency.Path);
+        TU.Dependencies.push_back(Dependency.Path);
+      }
+      NeedsReIndexing.push_back(std::move(TU));
       break;
     }
   }
   vlog("Loaded all shards");
-  reset(IndexedSymbols.buildIndex(IndexType::Heavy, DuplicateHandling::Merge));
+  publishIndex(/*Full=*/true);
   vlog("BackgroundIndex: built symbol index with estimated memory {0} "
        "bytes.",
        estimateMemoryUsage());
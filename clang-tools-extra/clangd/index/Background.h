@@ -11,6 +11,7 @@
 
 #include "Context.h"
 #include "FSProvider.h"
+#include "FileDistance.h"
 #include "GlobalCompilationDatabase.h"
 #include "Threading.h"
 #include "index/FileIndex.h"
@@ -22,7 +23,6 @@
 #include "llvm/Support/Threading.h"
 #include <atomic>
 #include <condition_variable>
-#include <deque>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -67,6 +67,8 @@ public:
   /// If BuildIndexPeriodMs is greater than 0, the symbol index will only be
   /// rebuilt periodically (one per \p BuildIndexPeriodMs); otherwise, index is
   /// rebuilt for each indexed file.
+  /// Rebuilds only cover the files updated since the last full build, which
+  /// happens when those grow too many or indexing goes idle.
   BackgroundIndex(
       Context BackgroundContext, const FileSystemProvider &,
       const GlobalCompilationDatabase &CDB,
@@ -80,6 +82,11 @@ public:
   // available sometime later.
   void enqueue(const std::vector<std::string> &ChangedFiles);
 
+  // Index the TUs related to \p Path before the others: the ones including it
+  // first, then the ones closest to it in the directory tree. Typically called
+  // when the user opens \p Path, which should be an absolute path.
+  void boostRelated(llvm::StringRef Path);
+
   // Cause background threads to stop after ther current task, any remaining
   // tasks will be discarded.
   void stop();
@@ -109,10 +116,16 @@ private:
   llvm::Error index(tooling::CompileCommand,
                     BackgroundIndexStorage *IndexStorage);
   void buildIndex(); // Rebuild index periodically every BuildIndexPeriodMs.
+  // Makes the updates to IndexedSymbols visible. Unless \p Full is set, only
+  // the files updated since the last full build are indexed again, and served
+  // on top of that build.
+  void publishIndex(bool Full);
   const size_t BuildIndexPeriodMs;
   std::atomic<bool> SymbolsUpdatedSinceLastIndex;
   std::mutex IndexMu;
   std::condition_variable IndexCV;
+  std::mutex PublishMu; // Serializes publishIndex().
+  std::shared_ptr<SymbolIndex> FullIndex; // GUARDED_BY(PublishMu)
 
   FileSymbols IndexedSymbols;
   llvm::StringMap<FileDigest> IndexedFileDigests; // Key is absolute file path.
@@ -130,22 +143,41 @@ private:
   std::vector<Source> loadShard(const tooling::CompileCommand &Cmd,
                                 BackgroundIndexStorage *IndexStorage,
                                 llvm::StringSet<> &LoadedShards);
+  struct TUToIndex {
+    tooling::CompileCommand Cmd;
+    BackgroundIndexStorage *Storage;
+    // Files included by the TU, as far as its shards tell us.
+    std::vector<std::string> Dependencies;
+  };
   // Tries to load shards for the ChangedFiles.
-  std::vector<std::pair<tooling::CompileCommand, BackgroundIndexStorage *>>
-  loadShards(std::vector<std::string> ChangedFiles);
-  void enqueue(tooling::CompileCommand Cmd, BackgroundIndexStorage *Storage);
+  std::vector<TUToIndex> loadShards(std::vector<std::string> ChangedFiles);
+  void enqueue(TUToIndex TU);
 
   // queue management
-  using Task = std::function<void()>;
+  struct Task {
+    std::function<void()> Run;
+    llvm::ThreadPriority ThreadPri = llvm::ThreadPriority::Default;
+    // Tasks with lower QueuePri run first, ties are broken in FIFO order.
+    unsigned QueuePri = 0;
+    uint64_t Seq = 0;
+    // For indexing tasks, the TU and its dependencies. Used to recompute
+    // QueuePri when boostRelated() is called.
+    std::string File;
+    std::vector<std::string> Dependencies;
+  };
   void run(); // Main loop executed by Thread. Runs tasks from Queue.
-  void enqueueTask(Task T, llvm::ThreadPriority Prioirty);
-  void enqueueLocked(tooling::CompileCommand Cmd,
-                     BackgroundIndexStorage *IndexStorage);
+  void enqueueTask(Task T);
+  unsigned queuePriorityLocked(const Task &T);
+  static bool runsLater(const Task &L, const Task &R); // Heap order of Queue.
   std::mutex QueueMu;
   unsigned NumActiveTasks = 0; // Only idle when queue is empty *and* no tasks.
   std::condition_variable QueueCV;
   bool ShouldStop = false;
-  std::deque<std::pair<Task, llvm::ThreadPriority>> Queue;
+  std::vector<Task> Queue; // A heap, see Task::QueuePri.
+  uint64_t NextSeq = 0;
+  // The files passed to boostRelated(), most recent first.
+  std::vector<std::string> FocusFiles;
+  llvm::Optional<FileDistance> FocusDistance; // Distance from FocusFiles.
   AsyncTaskRunner ThreadPool;
   GlobalCompilationDatabase::CommandChanged::Subscription CommandsChanged;
 };
@@ -40,22 +40,37 @@ llvm::StringRef
 CanonicalIncludes::mapHeader(llvm::StringRef Header,
                              llvm::StringRef QualifiedName) const {
   assert(!Header.empty());
-  auto SE = SymbolMapping.find(QualifiedName);
-  if (SE != SymbolMapping.end())
-    return SE->second;
+  // Symbol mappings take precedence over all header mappings, and full path
+  // mappings over suffix mappings, whether they are shared or not.
+  for (const CanonicalIncludes *M : {this, SystemMapping}) {
+    if (!M)
+      continue;
+    auto SE = M->SymbolMapping.find(QualifiedName);
+    if (SE != M->SymbolMapping.end())
+      return SE->second;
+  }
 
-  auto MapIt = FullPathMapping.find(Header);
-  if (MapIt != FullPathMapping.end())
-    return MapIt->second;
+  for (const CanonicalIncludes *M : {this, SystemMapping}) {
+    if (!M)
+      continue;
+    auto MapIt = M->FullPathMapping.find(Header);
+    if (MapIt != M->FullPathMapping.end())
+      return MapIt->second;
+  }
 
-  int Components = 1;
-  for (auto It = llvm::sys::path::rbegin(Header),
-            End = llvm::sys::path::rend(Header);
-       It != End && Components <= MaxSuffixComponents; ++It, ++Components) {
-    auto SubPath = Header.substr(It->data() - Header.begin());
-    auto MappingIt = SuffixHeaderMapping.find(SubPath);
-    if (MappingIt != SuffixHeaderMapping.end())
-      return MappingIt->second;
+  for (const CanonicalIncludes *M : {this, SystemMapping}) {
+    if (!M)
+      continue;
+    int Components = 1;
+    for (auto It = llvm::sys::path::rbegin(Header),
+              End = llvm::sys::path::rend(Header);
+         It != End && Components <= M->MaxSuffixComponents;
+         ++It, ++Components) {
+      auto SubPath = Header.substr(It->data() - Header.begin());
+      auto MappingIt = M->SuffixHeaderMapping.find(SubPath);
+      if (MappingIt != M->SuffixHeaderMapping.end())
+        return MappingIt->second;
+    }
   }
   return Header;
 }
@@ -86,7 +101,8 @@ collectIWYUHeaderMaps(CanonicalIncludes *Includes) {
   return llvm::make_unique<PragmaCommentHandler>(Includes);
 }
 
-void addSystemHeadersMapping(CanonicalIncludes *Includes) {
+namespace {
+void addSystemHeadersMappingTo(CanonicalIncludes *Includes) {
   static const std::vector<std::pair<const char *, const char *>> SymbolMap = {
 #define SYMBOL(Name, NameSpace, Header) { #NameSpace#Name, #Header },
       #include "StdSymbolMap.inc"
@@ -756,6 +772,18 @@ void addSystemHeadersMapping(CanonicalIncludes *Includes) {
   for (const auto &Pair : SystemHeaderMap)
     Includes->addPathSuffixMapping(Pair.first, Pair.second);
 }
+} // namespace
+
+void addSystemHeadersMapping(CanonicalIncludes *Includes) {
+  // Every preamble and AST has its own CanonicalIncludes, copying the few
+  // thousand system mappings into each would add up with many open files.
+  static const CanonicalIncludes *SystemMapping = [] {
+    auto *Mapping = new CanonicalIncludes;
+    addSystemHeadersMappingTo(Mapping);
+    return Mapping;
+  }();
+  Includes->SystemMapping = SystemMapping;
+}
 
 } // namespace clangd
 } // namespace clang
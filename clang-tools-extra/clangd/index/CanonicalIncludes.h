@@ -56,6 +56,8 @@ public:
                             llvm::StringRef QualifiedName) const;
 
 private:
+  friend void addSystemHeadersMapping(CanonicalIncludes *Includes);
+
   /// A map from full include path to a canonical path.
   llvm::StringMap<std::string> FullPathMapping;
   /// A map from a suffix (one or components of a path) to a canonical path.
@@ -65,6 +67,9 @@ private:
   int MaxSuffixComponents = 0;
   /// A map from fully qualified symbol names to header names.
   llvm::StringMap<std::string> SymbolMapping;
+  /// The mappings for system headers, set by addSystemHeadersMapping(). They
+  /// are the same for every file, so all instances share one copy.
+  const CanonicalIncludes *SystemMapping = nullptr;
 };
 
 /// Returns a CommentHandler that parses pragma comment on include files to
@@ -92,6 +92,7 @@ SymbolSlab indexHeaderSymbols(ASTContext &AST, std::shared_ptr<Preprocessor> PP,
 void FileSymbols::update(PathRef Path, std::unique_ptr<SymbolSlab> Symbols,
                          std::unique_ptr<RefSlab> Refs, bool CountReferences) {
   std::lock_guard<std::mutex> Lock(Mutex);
+  RecentFiles.insert(Path);
   if (!Symbols)
     FileToSymbols.erase(Path);
   else
@@ -108,17 +109,58 @@ void FileSymbols::update(PathRef Path, std::unique_ptr<SymbolSlab> Symbols,
 
 std::unique_ptr<SymbolIndex>
 FileSymbols::buildIndex(IndexType Type, DuplicateHandling DuplicateHandle) {
+  return buildIndex(Type, DuplicateHandle, /*OnlyRecent=*/false);
+}
+
+std::unique_ptr<SymbolIndex>
+FileSymbols::buildRecentIndex(IndexType Type,
+                              DuplicateHandling DuplicateHandle) {
+  return buildIndex(Type, DuplicateHandle, /*OnlyRecent=*/true);
+}
+
+size_t FileSymbols::numFiles() const {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  size_t Count = FileToSymbols.size();
+  for (const auto &FileAndRefs : FileToRefs)
+    if (!FileToSymbols.count(FileAndRefs.getKey()))
+      ++Count;
+  return Count;
+}
+
+size_t FileSymbols::numRecentFiles() const {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return RecentFiles.size();
+}
+
+std::unique_ptr<SymbolIndex>
+FileSymbols::buildIndex(IndexType Type, DuplicateHandling DuplicateHandle,
+                        bool OnlyRecent) {
   std::vector<std::shared_ptr<SymbolSlab>> SymbolSlabs;
   std::vector<std::shared_ptr<RefSlab>> RefSlabs;
   std::vector<RefSlab *> MainFileRefs;
   {
     std::lock_guard<std::mutex> Lock(Mutex);
-    for (const auto &FileAndSymbols : FileToSymbols)
-      SymbolSlabs.push_back(FileAndSymbols.second);
-    for (const auto &FileAndRefs : FileToRefs) {
-      RefSlabs.push_back(FileAndRefs.second.Slab);
-      if (FileAndRefs.second.CountReferences)
-        MainFileRefs.push_back(RefSlabs.back().get());
+    if (OnlyRecent) {
+      for (const auto &File : RecentFiles) {
+        auto Symbols = FileToSymbols.find(File.getKey());
+        if (Symbols != FileToSymbols.end())
+          SymbolSlabs.push_back(Symbols->second);
+        auto Refs = FileToRefs.find(File.getKey());
+        if (Refs != FileToRefs.end()) {
+          RefSlabs.push_back(Refs->second.Slab);
+          if (Refs->second.CountReferences)
+            MainFileRefs.push_back(RefSlabs.back().get());
+        }
+      }
+    } else {
+      for (const auto &FileAndSymbols : FileToSymbols)
+        SymbolSlabs.push_back(FileAndSymbols.second);
+      for (const auto &FileAndRefs : FileToRefs) {
+        RefSlabs.push_back(FileAndRefs.second.Slab);
+        if (FileAndRefs.second.CountReferences)
+          MainFileRefs.push_back(RefSlabs.back().get());
+      }
+      RecentFiles.clear();
     }
   }
   std::vector<const Symbol *> AllSymbols;
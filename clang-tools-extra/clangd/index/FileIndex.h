@@ -22,6 +22,7 @@
 #include "index/CanonicalIncludes.h"
 #include "index/Symbol.h"
 #include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/StringSet.h"
 #include <memory>
 
 namespace clang {
@@ -72,7 +73,22 @@ public:
   buildIndex(IndexType,
              DuplicateHandling DuplicateHandle = DuplicateHandling::PickOne);
 
+  /// Like buildIndex(), but only covers the files updated since the last call
+  /// to buildIndex(). This is much cheaper when few files changed, and can be
+  /// served on top of that last index with a MergedIndex.
+  std::unique_ptr<SymbolIndex> buildRecentIndex(
+      IndexType, DuplicateHandling DuplicateHandle = DuplicateHandling::PickOne);
+
+  /// Number of files with symbols or refs.
+  size_t numFiles() const;
+  /// Number of files updated since the last call to buildIndex().
+  size_t numRecentFiles() const;
+
 private:
+  std::unique_ptr<SymbolIndex> buildIndex(IndexType,
+                                          DuplicateHandling DuplicateHandle,
+                                          bool OnlyRecent);
+
   struct RefSlabAndCountReferences {
     std::shared_ptr<RefSlab> Slab;
     bool CountReferences = false;
@@ -83,6 +99,8 @@ private:
   llvm::StringMap<std::shared_ptr<SymbolSlab>> FileToSymbols;
   /// Stores the latest ref snapshots for all active files.
   llvm::StringMap<RefSlabAndCountReferences> FileToRefs;
+  /// Files updated since the last call to buildIndex().
+  llvm::StringSet<> RecentFiles;
 };
 
 /// This manages symbols from files and an in-memory index on all symbols.
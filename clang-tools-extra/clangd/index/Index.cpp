@@ -33,27 +33,84 @@ std::shared_ptr<SymbolIndex> SwapIndex::snapshot() const {
 
 bool fromJSON(const llvm::json::Value &Parameters, FuzzyFindRequest &Request) {
   llvm::json::ObjectMapper O(Parameters);
-  int64_t Limit;
+  llvm::Optional<int64_t> Limit;
   bool OK =
       O && O.map("Query", Request.Query) && O.map("Scopes", Request.Scopes) &&
       O.map("AnyScope", Request.AnyScope) && O.map("Limit", Limit) &&
       O.map("RestrictForCodeCompletion", Request.RestrictForCodeCompletion) &&
       O.map("ProximityPaths", Request.ProximityPaths) &&
       O.map("PreferredTypes", Request.PreferredTypes);
-  if (OK && Limit <= std::numeric_limits<uint32_t>::max())
-    Request.Limit = Limit;
+  if (OK && Limit && *Limit <= std::numeric_limits<uint32_t>::max())
+    Request.Limit = *Limit;
   return OK;
 }
 
 llvm::json::Value toJSON(const FuzzyFindRequest &Request) {
   return llvm::json::Object{
       {"Query", Request.Query},
-      {"Scopes", llvm::json::Array{Request.Scopes}},
+      {"Scopes", llvm::json::Array(Request.Scopes)},
       {"AnyScope", Request.AnyScope},
       {"Limit", Request.Limit},
       {"RestrictForCodeCompletion", Request.RestrictForCodeCompletion},
-      {"ProximityPaths", llvm::json::Array{Request.ProximityPaths}},
-      {"PreferredTypes", llvm::json::Array{Request.PreferredTypes}},
+      {"ProximityPaths", llvm::json::Array(Request.ProximityPaths)},
+      {"PreferredTypes", llvm::json::Array(Request.PreferredTypes)},
+  };
+}
+
+static bool fromJSON(const llvm::json::Value &Value,
+                     llvm::DenseSet<SymbolID> &IDs) {
+  const llvm::json::Array *A = Value.getAsArray();
+  if (!A)
+    return false;
+  for (const llvm::json::Value &E : *A) {
+    llvm::Optional<llvm::StringRef> Str = E.getAsString();
+    if (!Str)
+      return false;
+    auto ID = SymbolID::fromStr(*Str);
+    if (!ID) {
+      llvm::consumeError(ID.takeError());
+      return false;
+    }
+    IDs.insert(*ID);
+  }
+  return true;
+}
+
+static llvm::json::Value toJSON(const llvm::DenseSet<SymbolID> &IDs) {
+  llvm::json::Array A;
+  for (const SymbolID &ID : IDs)
+    A.push_back(ID.str());
+  return std::move(A);
+}
+
+bool fromJSON(const llvm::json::Value &Parameters, LookupRequest &Request) {
+  llvm::json::ObjectMapper O(Parameters);
+  return O && O.map("IDs", Request.IDs);
+}
+
+llvm::json::Value toJSON(const LookupRequest &Request) {
+  return llvm::json::Object{{"IDs", toJSON(Request.IDs)}};
+}
+
+bool fromJSON(const llvm::json::Value &Parameters, RefsRequest &Request) {
+  llvm::json::ObjectMapper O(Parameters);
+  int64_t Filter;
+  llvm::Optional<int64_t> Limit;
+  bool OK = O && O.map("IDs", Request.IDs) && O.map("Filter", Filter) &&
+            O.map("Limit", Limit);
+  if (!OK || Filter < 0 || Filter > static_cast<uint8_t>(RefKind::All))
+    return false;
+  Request.Filter = static_cast<RefKind>(Filter);
+  if (Limit && *Limit <= std::numeric_limits<uint32_t>::max())
+    Request.Limit = *Limit;
+  return true;
+}
+
+llvm::json::Value toJSON(const RefsRequest &Request) {
+  return llvm::json::Object{
+      {"IDs", toJSON(Request.IDs)},
+      {"Filter", static_cast<int64_t>(Request.Filter)},
+      {"Limit", Request.Limit},
   };
 }
 
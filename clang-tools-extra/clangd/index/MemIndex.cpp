@@ -76,10 +76,13 @@ void MemIndex::refs(const RefsRequest &Req,
     if (SymRefs == Refs.end())
       continue;
     for (const auto &O : SymRefs->second) {
-      if (Remaining > 0 && static_cast<int>(Req.Filter & O.Kind)) {
-        --Remaining;
-        Callback(O);
-      }
+      if (!static_cast<int>(Req.Filter & O.Kind))
+        continue;
+      // Popular symbols have lots of refs, don't walk past the limit.
+      if (Remaining == 0)
+        return;
+      --Remaining;
+      Callback(O);
     }
   }
 }
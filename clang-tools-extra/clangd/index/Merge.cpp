@@ -112,8 +112,20 @@ void MergedIndex::refs(const RefsRequest &Req,
     return;
   // We return less than Req.Limit if static index returns more refs for dirty
   // files.
+  //
+  // Indexes return the refs of a symbol grouped by file, so the lookup is only
+  // needed when the file changes. The URI is copied, as the Ref's strings may
+  // not outlive the callback.
+  std::string LastFileURI;
+  bool LastFileIsDynamic = false;
   Static->refs(Req, [&](const Ref &O) {
-    if (Remaining > 0 && !DynamicIndexFileURIs.count(O.Location.FileURI)) {
+    if (Remaining == 0)
+      return;
+    if (LastFileURI != O.Location.FileURI) {
+      LastFileURI = O.Location.FileURI;
+      LastFileIsDynamic = DynamicIndexFileURIs.count(LastFileURI);
+    }
+    if (!LastFileIsDynamic) {
       --Remaining;
       Callback(O);
     }
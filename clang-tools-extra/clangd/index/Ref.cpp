@@ -32,26 +32,34 @@ llvm::raw_ostream &operator<<(llvm::raw_ostream &OS, const Ref &R) {
 }
 
 void RefSlab::Builder::insert(const SymbolID &ID, const Ref &S) {
-  auto &M = Refs[ID];
-  if (M.count(S))
-    return;
-  Ref R = S;
-  R.Location.FileURI =
-      UniqueStrings.save(R.Location.FileURI).data();
-  M.insert(std::move(R));
+  Entry E{ID, S};
+  E.Reference.Location.FileURI =
+      UniqueStrings.save(S.Location.FileURI).data();
+  Entries.insert(std::move(E));
 }
 
 RefSlab RefSlab::Builder::build() && {
   // We can reuse the arena, as it only has unique strings and we need them all.
+  // Sort the refs by symbol, then by location, so that each symbol's refs are
+  // contiguous, and grouped by file within them.
+  std::vector<Entry> Sorted(Entries.begin(), Entries.end());
+  llvm::DenseSet<Entry>().swap(Entries);
+  llvm::sort(Sorted, [](const Entry &L, const Entry &R) {
+    if (L.Symbol == R.Symbol)
+      return L.Reference < R.Reference;
+    return L.Symbol < R.Symbol;
+  });
   // Reallocate refs on the arena to reduce waste and indirections when reading.
   std::vector<std::pair<SymbolID, llvm::ArrayRef<Ref>>> Result;
-  Result.reserve(Refs.size());
-  size_t NumRefs = 0;
-  for (auto &Sym : Refs) {
-    std::vector<Ref> SymRefs(Sym.second.begin(), Sym.second.end());
-    NumRefs += SymRefs.size();
-    Result.emplace_back(Sym.first, llvm::ArrayRef<Ref>(SymRefs).copy(Arena));
+  std::vector<Ref> SymRefs;
+  for (size_t I = 0; I < Sorted.size();) {
+    const SymbolID &Sym = Sorted[I].Symbol;
+    SymRefs.clear();
+    for (; I < Sorted.size() && Sorted[I].Symbol == Sym; ++I)
+      SymRefs.push_back(Sorted[I].Reference);
+    Result.emplace_back(Sym, llvm::ArrayRef<Ref>(SymRefs).copy(Arena));
   }
+  size_t NumRefs = Sorted.size();
   return RefSlab(std::move(Result), std::move(Arena), NumRefs);
 }
 
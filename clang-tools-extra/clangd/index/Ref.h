@@ -13,10 +13,10 @@
 #include "SymbolLocation.h"
 #include "clang/Index/IndexSymbol.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdint>
-#include <set>
 #include <utility>
 
 namespace clang {
@@ -68,7 +68,7 @@ llvm::raw_ostream &operator<<(llvm::raw_ostream &, const Ref &);
 /// Filenames are deduplicated.
 class RefSlab {
 public:
-  // Refs are stored in order.
+  // Refs are stored in order, so the refs of a symbol are grouped by file.
   using value_type = std::pair<SymbolID, llvm::ArrayRef<Ref>>;
   using const_iterator = std::vector<value_type>::const_iterator;
   using iterator = const_iterator;
@@ -99,9 +99,19 @@ public:
     RefSlab build() &&;
 
   private:
+    // A ref stored with its symbol until build(). File URIs are interned, so
+    // entries can be compared and hashed by pointer.
+    struct Entry {
+      SymbolID Symbol;
+      Ref Reference;
+    };
+    friend struct llvm::DenseMapInfo<Entry>;
+
     llvm::BumpPtrAllocator Arena;
     llvm::UniqueStringSaver UniqueStrings; // Contents on the arena.
-    llvm::DenseMap<SymbolID, std::set<Ref>> Refs;
+    // A flat set costs a fraction of a tree node per ref, which matters when
+    // building the refs of a whole project.
+    llvm::DenseSet<Entry> Entries;
   };
 
 private:
@@ -118,4 +128,33 @@ private:
 } // namespace clangd
 } // namespace clang
 
+namespace llvm {
+template <> struct DenseMapInfo<clang::clangd::RefSlab::Builder::Entry> {
+  using Entry = clang::clangd::RefSlab::Builder::Entry;
+  static inline Entry getEmptyKey() {
+    static Entry E{DenseMapInfo<clang::clangd::SymbolID>::getEmptyKey(), {}};
+    return E;
+  }
+  static inline Entry getTombstoneKey() {
+    static Entry E{DenseMapInfo<clang::clangd::SymbolID>::getTombstoneKey(),
+                   {}};
+    return E;
+  }
+  static unsigned getHashValue(const Entry &Val) {
+    const auto &Loc = Val.Reference.Location;
+    return hash_combine(
+        Val.Symbol, reinterpret_cast<uintptr_t>(Loc.FileURI), Loc.Start.line(),
+        Loc.Start.column(), Loc.End.line(), Loc.End.column(),
+        static_cast<uint8_t>(Val.Reference.Kind));
+  }
+  static bool isEqual(const Entry &LHS, const Entry &RHS) {
+    const auto &L = LHS.Reference, &R = RHS.Reference;
+    return LHS.Symbol == RHS.Symbol && L.Kind == R.Kind &&
+           L.Location.FileURI == R.Location.FileURI &&
+           L.Location.Start == R.Location.Start &&
+           L.Location.End == R.Location.End;
+  }
+};
+} // namespace llvm
+
 #endif // LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_REF_H
@@ -16,6 +16,7 @@
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/Host.h"
 
 namespace clang {
 namespace clangd {
@@ -67,8 +68,8 @@ public:
     return Ret;
   }
 
-  llvm::StringRef consume(int N) {
-    if (LLVM_UNLIKELY(Begin + N > End)) {
+  llvm::StringRef consume(size_t N) {
+    if (LLVM_UNLIKELY(N > size_t(End - Begin))) {
       Err = true;
       return llvm::StringRef();
     }
@@ -358,10 +359,95 @@ readRefs(Reader &Data, llvm::ArrayRef<llvm::StringRef> Strings) {
   return Result;
 }
 
+// POSTINGS ENCODING
+// The posting lists of a Dex index, laid out so that their chunks can be used
+// in place from a mapped file:
+//  - NumChunks: uint32
+//  - Chunk[NumChunks]: Head (uint32), Payload (bytes). These are 4-byte
+//    aligned when the section is the first after "meta".
+//  - NumTokens: varint
+//  - Token[NumTokens]: Kind (uint8), DataSize (varint), Data (bytes),
+//    NumChunks (varint), using the next NumChunks chunks
+//  - NumSymbols: varint
+//  - SymbolID[NumSymbols]: the symbols in DocID order
+//
+// They are only as stable as the Chunk layout: changing it requires bumping
+// Version.
+
+void writePostings(const dex::Postings &P, llvm::raw_ostream &OS) {
+  size_t NumChunks = 0;
+  for (const auto &TokenToChunks : P.Lists)
+    NumChunks += TokenToChunks.second.size();
+  write32(NumChunks, OS);
+  for (const auto &TokenToChunks : P.Lists)
+    for (const dex::Chunk &C : TokenToChunks.second) {
+      write32(C.Head, OS);
+      OS.write(reinterpret_cast<const char *>(C.Payload.data()),
+               C.Payload.size());
+    }
+  writeVar(P.Lists.size(), OS);
+  for (const auto &TokenToChunks : P.Lists) {
+    const dex::Token &Tok = TokenToChunks.first;
+    OS.write(static_cast<uint8_t>(Tok.TokenKind));
+    writeVar(Tok.Data.size(), OS);
+    OS << Tok.Data;
+    writeVar(TokenToChunks.second.size(), OS);
+  }
+  writeVar(P.Order.size(), OS);
+  for (const SymbolID &ID : P.Order)
+    OS << ID.raw();
+}
+
+llvm::Expected<dex::Postings> readPostings(llvm::StringRef Data) {
+  Reader R(Data);
+  dex::Postings Result;
+  size_t NumChunks = R.consume32();
+  llvm::StringRef ChunkData = R.consume(NumChunks * sizeof(dex::Chunk));
+  if (R.err())
+    return makeError("Truncated posting lists");
+  llvm::ArrayRef<dex::Chunk> Chunks;
+  if (llvm::sys::IsLittleEndianHost &&
+      reinterpret_cast<uintptr_t>(ChunkData.data()) % alignof(dex::Chunk) ==
+          0) {
+    Chunks = llvm::makeArrayRef(
+        reinterpret_cast<const dex::Chunk *>(ChunkData.data()), NumChunks);
+  } else {
+    Reader ChunkReader(ChunkData);
+    Result.Storage.resize(NumChunks);
+    for (dex::Chunk &C : Result.Storage) {
+      C.Head = ChunkReader.consume32();
+      llvm::StringRef Payload = ChunkReader.consume(C.Payload.size());
+      std::copy(Payload.bytes_begin(), Payload.bytes_end(), C.Payload.begin());
+    }
+    Chunks = Result.Storage;
+  }
+
+  for (size_t I = 0, NumTokens = R.consumeVar(); I < NumTokens; ++I) {
+    uint8_t Kind = R.consume8();
+    if (Kind > static_cast<uint8_t>(dex::Token::Kind::Sentinel))
+      return makeError("Bad posting list token");
+    llvm::StringRef TokenData = R.consume(R.consumeVar());
+    size_t Size = R.consumeVar();
+    if (R.err() || Size > Chunks.size())
+      return makeError("Truncated posting lists");
+    Result.Lists.emplace_back(
+        dex::Token(static_cast<dex::Token::Kind>(Kind), TokenData),
+        Chunks.take_front(Size));
+    Chunks = Chunks.drop_front(Size);
+  }
+  Result.Order.resize(R.consumeVar());
+  for (SymbolID &ID : Result.Order)
+    ID = R.consumeID();
+  if (R.err())
+    return makeError("Truncated posting lists");
+  return std::move(Result);
+}
+
 // FILE ENCODING
 // A file is a RIFF chunk with type 'CdIx'.
 // It contains the sections:
 //   - meta: version number
+//   - post: Dex posting lists (optional)
 //   - srcs: information related to include graph
 //   - stri: string table
 //   - symb: symbols
@@ -434,6 +520,12 @@ llvm::Expected<IndexFileIn> readRIFF(llvm::StringRef Data) {
       return makeError("malformed or truncated refs");
     Result.Refs = std::move(Refs).build();
   }
+  if (Chunks.count("post")) {
+    auto Postings = readPostings(Chunks.lookup("post"));
+    if (!Postings)
+      return Postings.takeError();
+    Result.Postings = std::move(*Postings);
+  }
   return std::move(Result);
 }
 
@@ -456,6 +548,17 @@ void writeRIFF(const IndexFileOut &Data, llvm::raw_ostream &OS) {
   }
   RIFF.Chunks.push_back({riff::fourCC("meta"), Meta});
 
+  // Written right after "meta" so that the chunks are aligned in the file.
+  std::string PostingsSection;
+  if (Data.Postings) {
+    dex::Dex Index(*Data.Symbols, RefSlab());
+    {
+      llvm::raw_string_ostream PostingsOS(PostingsSection);
+      writePostings(Index.postings(), PostingsOS);
+    }
+    RIFF.Chunks.push_back({riff::fourCC("post"), PostingsSection});
+  }
+
   StringTableOut Strings;
   std::vector<Symbol> Symbols;
   for (const auto &Sym : *Data.Symbols) {
@@ -553,7 +656,9 @@ llvm::Expected<IndexFileIn> readIndexFile(llvm::StringRef Data) {
 std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef SymbolFilename,
                                        bool UseDex) {
   trace::Span OverallTracer("LoadIndex");
-  auto Buffer = llvm::MemoryBuffer::getFile(SymbolFilename);
+  // Posting lists are used in place, which is cheapest if the file is mapped.
+  auto Buffer = llvm::MemoryBuffer::getFile(SymbolFilename, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
   if (!Buffer) {
     llvm::errs() << "Can't open " << SymbolFilename << "\n";
     return nullptr;
@@ -561,6 +666,7 @@ std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef SymbolFilename,
 
   SymbolSlab Symbols;
   RefSlab Refs;
+  llvm::Optional<dex::Postings> Postings;
   {
     trace::Span Tracer("ParseIndex");
     if (auto I = readIndexFile(Buffer->get()->getBuffer())) {
@@ -568,6 +674,7 @@ std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef SymbolFilename,
         Symbols = std::move(*I->Symbols);
       if (I->Refs)
         Refs = std::move(*I->Refs);
+      Postings = std::move(I->Postings);
     } else {
       llvm::errs() << "Bad Index: " << llvm::toString(I.takeError()) << "\n";
       return nullptr;
@@ -578,8 +685,23 @@ std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef SymbolFilename,
   size_t NumRefs = Refs.numRefs();
 
   trace::Span Tracer("BuildIndex");
-  auto Index = UseDex ? dex::Dex::build(std::move(Symbols), std::move(Refs))
-                      : MemIndex::build(std::move(Symbols), std::move(Refs));
+  std::unique_ptr<SymbolIndex> Index;
+  if (UseDex && Postings) {
+    // The index keeps the file alive, as the posting lists point into it.
+    // Mapped pages are shared with other processes and don't count as ours.
+    size_t Size = Symbols.bytes() + Refs.bytes() +
+                  Postings->Storage.capacity() * sizeof(dex::Chunk);
+    if ((*Buffer)->getBufferKind() == llvm::MemoryBuffer::MemoryBuffer_Malloc)
+      Size += (*Buffer)->getBufferSize();
+    auto Data = std::make_tuple(std::move(Symbols), std::move(Refs),
+                                std::move(*Buffer), std::move(*Postings));
+    Index = llvm::make_unique<dex::Dex>(std::get<0>(Data), std::get<1>(Data),
+                                        std::move(Data), Size,
+                                        &std::get<3>(Data));
+  } else {
+    Index = UseDex ? dex::Dex::build(std::move(Symbols), std::move(Refs))
+                   : MemIndex::build(std::move(Symbols), std::move(Refs));
+  }
   vlog("Loaded {0} from {1} with estimated memory usage {2} bytes\n"
        "  - number of symbols: {3}\n"
        "  - number of refs: {4}\n",
@@ -12,6 +12,8 @@
 //  - metadata such as version info
 //  - a string table (which is compressed)
 //  - lists of encoded symbols
+//  - optionally, the posting lists of a Dex index built from the symbols,
+//    which are used in place when the file is loaded
 //
 // The format has a simple versioning scheme: the format version number is
 // written in the file and non-current versions are rejected when reading.
@@ -27,6 +29,7 @@
 #include "Headers.h"
 #include "Index.h"
 #include "index/Symbol.h"
+#include "index/dex/Dex.h"
 #include "llvm/Support/Error.h"
 
 namespace clang {
@@ -43,6 +46,9 @@ struct IndexFileIn {
   llvm::Optional<RefSlab> Refs;
   // Keys are URIs of the source files.
   llvm::Optional<IncludeGraph> Sources;
+  // Precomputed Dex posting lists. Unlike everything else, they refer to the
+  // data that was read, which must outlive them.
+  llvm::Optional<dex::Postings> Postings;
 };
 // Parse an index file. The input must be a RIFF or YAML file.
 llvm::Expected<IndexFileIn> readIndexFile(llvm::StringRef);
@@ -53,8 +59,10 @@ struct IndexFileOut {
   const RefSlab *Refs = nullptr;
   // Keys are URIs of the source files.
   const IncludeGraph *Sources = nullptr;
-  // TODO: Support serializing Dex posting lists.
   IndexFileFormat Format = IndexFileFormat::RIFF;
+  // Also store the posting lists of a Dex index of Symbols, so that loading
+  // the index doesn't need to compute them. Ignored by the YAML format.
+  bool Postings = false;
 
   IndexFileOut() = default;
   IndexFileOut(const IndexFileIn &I)
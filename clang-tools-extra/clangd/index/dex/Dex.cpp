@@ -14,6 +14,7 @@
 #include "Trace.h"
 #include "index/Index.h"
 #include "index/dex/Iterator.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/ScopedPrinter.h"
 #include <algorithm>
@@ -96,6 +97,51 @@ void Dex::buildIndex() {
         {TokenToPostingList.first, PostingList(TokenToPostingList.second)});
 }
 
+bool Dex::restoreIndex(const Postings &Precomputed) {
+  if (Precomputed.Order.size() != Symbols.size())
+    return false;
+  for (const Symbol *Sym : Symbols)
+    LookupTable[Sym->ID] = Sym;
+
+  // Symbols are ordered by DocID rather than sorted by quality. Each symbol
+  // must appear exactly once.
+  std::vector<const Symbol *> Ordered;
+  Ordered.reserve(Symbols.size());
+  llvm::DenseSet<SymbolID> Seen;
+  for (const SymbolID &ID : Precomputed.Order) {
+    const Symbol *Sym = LookupTable.lookup(ID);
+    if (!Sym || !Seen.insert(ID).second) {
+      vlog("Dex: precomputed postings don't match the symbols, rebuilding");
+      LookupTable.clear();
+      return false;
+    }
+    Ordered.push_back(Sym);
+  }
+  Symbols = std::move(Ordered);
+  SymbolQuality.reserve(Symbols.size());
+  for (const Symbol *Sym : Symbols)
+    SymbolQuality.push_back(quality(*Sym));
+  this->Corpus = dex::Corpus(Symbols.size());
+
+  InvertedIndex.reserve(Precomputed.Lists.size());
+  for (const auto &TokenToChunks : Precomputed.Lists)
+    InvertedIndex.insert(
+        {TokenToChunks.first, PostingList::fromChunks(TokenToChunks.second)});
+  return true;
+}
+
+Postings Dex::postings() const {
+  Postings Result;
+  Result.Order.reserve(Symbols.size());
+  for (const Symbol *Sym : Symbols)
+    Result.Order.push_back(Sym->ID);
+  Result.Lists.reserve(InvertedIndex.size());
+  for (const auto &TokenToPostingList : InvertedIndex)
+    Result.Lists.emplace_back(TokenToPostingList.first,
+                              TokenToPostingList.second.chunks());
+  return Result;
+}
+
 std::unique_ptr<Iterator> Dex::iterator(const Token &Tok) const {
   auto It = InvertedIndex.find(Tok);
   return It == InvertedIndex.end() ? Corpus.none()
@@ -252,10 +298,13 @@ void Dex::refs(const RefsRequest &Req,
       Req.Limit.getValueOr(std::numeric_limits<uint32_t>::max());
   for (const auto &ID : Req.IDs)
     for (const auto &Ref : Refs.lookup(ID)) {
-      if (Remaining > 0 && static_cast<int>(Req.Filter & Ref.Kind)) {
-        --Remaining;
-        Callback(Ref);
-      }
+      if (!static_cast<int>(Req.Filter & Ref.Kind))
+        continue;
+      // Popular symbols have lots of refs, don't walk past the limit.
+      if (Remaining == 0)
+        return;
+      --Remaining;
+      Callback(Ref);
     }
 }
 
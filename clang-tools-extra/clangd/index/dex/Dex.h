@@ -32,6 +32,19 @@ namespace clang {
 namespace clangd {
 namespace dex {
 
+/// The parts of a Dex index that only depend on its symbols: the order of the
+/// symbols (i.e. their DocIDs) and the posting lists. Computing them is most of
+/// the cost of building a Dex, so they can be stored in index files (see
+/// Serialization.h) and used in place when the file is mapped.
+struct Postings {
+  /// The symbol with DocID I is the one with ID Order[I].
+  std::vector<SymbolID> Order;
+  /// The encoded posting list of each token. Chunks are not owned.
+  std::vector<std::pair<Token, llvm::ArrayRef<Chunk>>> Lists;
+  /// Holds the chunks that couldn't be used in place, if any.
+  std::vector<Chunk> Storage;
+};
+
 /// In-memory Dex trigram-based index implementation.
 // FIXME(kbobyrev): Introduce serialization and deserialization of the symbol
 // index so that it can be loaded from the disk. Since static index is not
@@ -41,19 +54,25 @@ namespace dex {
 class Dex : public SymbolIndex {
 public:
   // All data must outlive this index.
+  // If Precomputed is given, it must have been computed for the same symbols,
+  // and its chunks must outlive the index as well.
   template <typename SymbolRange, typename RefsRange>
-  Dex(SymbolRange &&Symbols, RefsRange &&Refs) : Corpus(0) {
+  Dex(SymbolRange &&Symbols, RefsRange &&Refs,
+      const Postings *Precomputed = nullptr)
+      : Corpus(0) {
     for (auto &&Sym : Symbols)
       this->Symbols.push_back(&Sym);
     for (auto &&Ref : Refs)
       this->Refs.try_emplace(Ref.first, Ref.second);
-    buildIndex();
+    if (!Precomputed || !restoreIndex(*Precomputed))
+      buildIndex();
   }
   // Symbols and Refs are owned by BackingData, Index takes ownership.
   template <typename SymbolRange, typename RefsRange, typename Payload>
   Dex(SymbolRange &&Symbols, RefsRange &&Refs, Payload &&BackingData,
-      size_t BackingDataSize)
-      : Dex(std::forward<SymbolRange>(Symbols), std::forward<RefsRange>(Refs)) {
+      size_t BackingDataSize, const Postings *Precomputed = nullptr)
+      : Dex(std::forward<SymbolRange>(Symbols), std::forward<RefsRange>(Refs),
+            Precomputed) {
     KeepAlive = std::shared_ptr<void>(
         std::make_shared<Payload>(std::move(BackingData)), nullptr);
     this->BackingDataSize = BackingDataSize;
@@ -74,8 +93,15 @@ public:
 
   size_t estimateMemoryUsage() const override;
 
+  /// Returns the symbol order and posting lists of the index, which refer to
+  /// the index's storage.
+  Postings postings() const;
+
 private:
   void buildIndex();
+  /// Sets up the index from precomputed postings rather than computing them.
+  /// Returns false if they don't match the symbols.
+  bool restoreIndex(const Postings &Precomputed);
   std::unique_ptr<Iterator> iterator(const Token &Tok) const;
   std::unique_ptr<Iterator>
   createFileProximityIterator(llvm::ArrayRef<std::string> ProximityPaths) const;
@@ -93,11 +93,15 @@ private:
     if (ReachedEnd)
       return;
     auto SyncID = Children.front()->peek();
+    // The child SyncID comes from, it doesn't need to be advanced.
+    const Iterator *Leader = Children.front().get();
     // Indicates whether any child needs to be advanced to new SyncID.
     bool NeedsAdvance = false;
     do {
       NeedsAdvance = false;
       for (auto &Child : Children) {
+        if (Child.get() == Leader)
+          continue;
         Child->advanceTo(SyncID);
         ReachedEnd |= Child->reachedEnd();
         // If any child reaches end And iterator can not match any other items.
@@ -108,6 +112,7 @@ private:
         // all children should be advanced to the next common item.
         if (Child->peek() > SyncID) {
           SyncID = Child->peek();
+          Leader = Child.get();
           NeedsAdvance = true;
         }
       }
@@ -136,54 +141,46 @@ public:
   explicit OrIterator(std::vector<std::unique_ptr<Iterator>> AllChildren)
       : Iterator(Kind::Or), Children(std::move(AllChildren)) {
     assert(!Children.empty() && "OR iterator should have at least one child.");
+    sync();
   }
 
   /// Returns true if all children are exhausted.
-  bool reachedEnd() const override {
-    for (const auto &Child : Children)
-      if (!Child->reachedEnd())
-        return false;
-    return true;
-  }
+  bool reachedEnd() const override { return ReachedEnd; }
 
   /// Moves each child pointing to the smallest DocID to the next item.
   void advance() override {
     assert(!reachedEnd() && "OR iterator can't advance() at the end.");
-    const auto SmallestID = peek();
     for (const auto &Child : Children)
       if (!Child->reachedEnd() && Child->peek() == SmallestID)
         Child->advance();
+    sync();
   }
 
   /// Advances each child to the next existing element with DocumentID >= ID.
   void advanceTo(DocID ID) override {
     assert(!reachedEnd() && "OR iterator can't advanceTo() at the end.");
+    if (ID <= SmallestID)
+      return;
     for (const auto &Child : Children)
       if (!Child->reachedEnd())
         Child->advanceTo(ID);
+    sync();
   }
 
   /// Returns the element under cursor of the child with smallest Child->peek()
   /// value.
   DocID peek() const override {
     assert(!reachedEnd() && "OR iterator can't peek() at the end.");
-    DocID Result = std::numeric_limits<DocID>::max();
-
-    for (const auto &Child : Children)
-      if (!Child->reachedEnd())
-        Result = std::min(Result, Child->peek());
-
-    return Result;
+    return SmallestID;
   }
 
   // Returns the maximum boosting score among all Children when iterator
   // points to the current ID.
   float consume() override {
     assert(!reachedEnd() && "OR iterator can't consume() at the end.");
-    const DocID ID = peek();
     float Boost = 1;
     for (const auto &Child : Children)
-      if (!Child->reachedEnd() && Child->peek() == ID)
+      if (!Child->reachedEnd() && Child->peek() == SmallestID)
         Boost = std::max(Boost, Child->consume());
     return Boost;
   }
@@ -207,8 +204,23 @@ private:
     return OS;
   }
 
+  /// Updates ReachedEnd and SmallestID after the children moved, so that they
+  /// are looked at once per step rather than on each call.
+  void sync() {
+    ReachedEnd = true;
+    SmallestID = std::numeric_limits<DocID>::max();
+    for (const auto &Child : Children)
+      if (!Child->reachedEnd()) {
+        ReachedEnd = false;
+        SmallestID = std::min(SmallestID, Child->peek());
+      }
+  }
+
   // FIXME(kbobyrev): Would storing Children in min-heap be faster?
   std::vector<std::unique_ptr<Iterator>> Children;
+  bool ReachedEnd = false;
+  /// The smallest peek() among the children that aren't exhausted.
+  DocID SmallestID = 0;
   friend Corpus; // For optimizations.
 };
 
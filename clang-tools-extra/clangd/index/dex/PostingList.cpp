@@ -12,6 +12,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/MathExtras.h"
+#include <algorithm>
 
 namespace clang {
 namespace clangd {
@@ -25,10 +26,8 @@ class ChunkIterator : public Iterator {
 public:
   explicit ChunkIterator(const Token *Tok, llvm::ArrayRef<Chunk> Chunks)
       : Tok(Tok), Chunks(Chunks), CurrentChunk(Chunks.begin()) {
-    if (!Chunks.empty()) {
-      DecompressedChunk = CurrentChunk->decompress();
-      CurrentID = DecompressedChunk.begin();
-    }
+    if (!Chunks.empty())
+      decompressCurrentChunk();
   }
 
   bool reachedEnd() const override { return CurrentChunk == Chunks.end(); }
@@ -50,14 +49,15 @@ public:
       return;
     advanceToChunk(ID);
     // Try to find ID within current chunk.
-    CurrentID = llvm::bsearch(CurrentID, DecompressedChunk.end(),
-                              [&](const DocID D) { return D >= ID; });
+    CurrentID = std::lower_bound(Decompressed.begin() + CurrentID,
+                                 Decompressed.begin() + DecompressedSize, ID) -
+                Decompressed.begin();
     normalizeCursor();
   }
 
   DocID peek() const override {
     assert(!reachedEnd() && "Posting List iterator can't peek() at the end.");
-    return *CurrentID;
+    return Decompressed[CurrentID];
   }
 
   float consume() override {
@@ -88,39 +88,54 @@ private:
   /// chunk.
   void normalizeCursor() {
     // Invariant is already established if examined chunk is not exhausted.
-    if (CurrentID != std::end(DecompressedChunk))
+    if (CurrentID != DecompressedSize)
       return;
     // Advance to next chunk if current one is exhausted.
     ++CurrentChunk;
     if (CurrentChunk == Chunks.end()) // Reached the end of PostingList.
       return;
-    DecompressedChunk = CurrentChunk->decompress();
-    CurrentID = DecompressedChunk.begin();
+    decompressCurrentChunk();
   }
 
   /// Advances CurrentChunk to the chunk which might contain ID.
+  /// When intersecting posting lists, ID is usually close to the cursor. So
+  /// we first gallop forward, doubling the distance each time, and then only
+  /// search the chunks skipped by the last step.
   void advanceToChunk(DocID ID) {
-    if ((CurrentChunk != Chunks.end() - 1) &&
-        ((CurrentChunk + 1)->Head <= ID)) {
-      CurrentChunk =
-          llvm::bsearch(CurrentChunk + 1, Chunks.end(),
-                        [&](const Chunk &C) { return C.Head >= ID; });
-      --CurrentChunk;
-      DecompressedChunk = CurrentChunk->decompress();
-      CurrentID = DecompressedChunk.begin();
+    auto Low = CurrentChunk + 1;
+    if (Low == Chunks.end() || Low->Head > ID)
+      return;
+    // Low->Head <= ID, and High is the end or High->Head > ID.
+    auto High = Chunks.end();
+    for (size_t Step = 1; Step < static_cast<size_t>(Chunks.end() - Low);
+         Step *= 2) {
+      if ((Low + Step)->Head > ID) {
+        High = Low + Step;
+        break;
+      }
+      Low += Step;
     }
+    CurrentChunk = llvm::bsearch(Low + 1, High, [&](const Chunk &C) {
+                     return C.Head > ID;
+                   }) -
+                   1;
+    decompressCurrentChunk();
+  }
+
+  void decompressCurrentChunk() {
+    DecompressedSize = CurrentChunk->decompress(Decompressed);
+    CurrentID = 0;
   }
 
   const Token *Tok;
   llvm::ArrayRef<Chunk> Chunks;
   /// Iterator over chunks.
-  /// If CurrentChunk is valid, then DecompressedChunk is
-  /// CurrentChunk->decompress() and CurrentID is a valid (non-end) iterator
-  /// into it.
+  /// If CurrentChunk is valid, then Decompressed holds the DecompressedSize
+  /// DocIDs of CurrentChunk and CurrentID is a valid (non-end) index into it.
   decltype(Chunks)::const_iterator CurrentChunk;
-  llvm::SmallVector<DocID, Chunk::PayloadSize + 1> DecompressedChunk;
-  /// Iterator over DecompressedChunk.
-  decltype(DecompressedChunk)::iterator CurrentID;
+  std::array<DocID, Chunk::MaxDocs> Decompressed;
+  size_t DecompressedSize = 0;
+  size_t CurrentID = 0;
 
   static constexpr size_t ApproxEntriesPerChunk = 15;
 };
@@ -182,42 +197,40 @@ std::vector<Chunk> encodeStream(llvm::ArrayRef<DocID> Documents) {
   return std::vector<Chunk>(Result); // no move, shrink-to-fit
 }
 
-/// Reads variable length DocID from the buffer and updates the buffer size. If
-/// the stream is terminated, return None.
-llvm::Optional<DocID> readVByte(llvm::ArrayRef<uint8_t> &Bytes) {
-  if (Bytes.front() == 0 || Bytes.empty())
-    return None;
-  DocID Result = 0;
-  bool HasNextByte = true;
-  for (size_t Length = 0; HasNextByte && !Bytes.empty(); ++Length) {
-    assert(Length <= 5 && "Malformed VByte encoding sequence.");
-    // Write meaningful bits to the correct place in the document decoding.
-    Result |= (Bytes.front() & 0x7f) << (BitsPerEncodingByte * Length);
-    if ((Bytes.front() & 0x80) == 0)
-      HasNextByte = false;
-    Bytes = Bytes.drop_front();
-  }
-  return Result;
-}
-
 } // namespace
 
-llvm::SmallVector<DocID, Chunk::PayloadSize + 1> Chunk::decompress() const {
-  llvm::SmallVector<DocID, Chunk::PayloadSize + 1> Result{Head};
-  llvm::ArrayRef<uint8_t> Bytes(Payload);
-  DocID Delta;
-  for (DocID Current = Head; !Bytes.empty(); Current += Delta) {
-    auto MaybeDelta = readVByte(Bytes);
-    if (!MaybeDelta)
-      break;
-    Delta = *MaybeDelta;
-    Result.push_back(Current + Delta);
+llvm::SmallVector<DocID, Chunk::MaxDocs> Chunk::decompress() const {
+  std::array<DocID, MaxDocs> Docs;
+  size_t Size = decompress(Docs);
+  return llvm::SmallVector<DocID, MaxDocs>(Docs.begin(), Docs.begin() + Size);
+}
+
+/// Reads the VByte-encoded deltas, see encodeStream(). They are terminated by
+/// a 0 byte or the end of the payload: no encoding starts with 0, as deltas
+/// are never 0.
+size_t Chunk::decompress(std::array<DocID, MaxDocs> &Out) const {
+  size_t Size = 0;
+  DocID Current = Out[Size++] = Head;
+  size_t I = 0;
+  while (I < PayloadSize && Payload[I] != 0) {
+    DocID Delta = 0;
+    // Valid encodings take up to 5 bytes, don't overflow on corrupt ones.
+    for (unsigned Shift = 0; I < PayloadSize && Shift < 32;
+         Shift += BitsPerEncodingByte) {
+      uint8_t Byte = Payload[I++];
+      // Write meaningful bits to the correct place in the document decoding.
+      Delta |= DocID(Byte & 0x7f) << Shift;
+      if ((Byte & 0x80) == 0)
+        break;
+    }
+    Current += Delta;
+    Out[Size++] = Current;
   }
-  return llvm::SmallVector<DocID, Chunk::PayloadSize + 1>{Result};
+  return Size;
 }
 
 PostingList::PostingList(llvm::ArrayRef<DocID> Documents)
-    : Chunks(encodeStream(Documents)) {}
+    : Storage(encodeStream(Documents)), Chunks(Storage) {}
 
 std::unique_ptr<Iterator> PostingList::iterator(const Token *Tok) const {
   return llvm::make_unique<ChunkIterator>(Tok, Chunks);
@@ -26,6 +26,7 @@
 #include "Iterator.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
+#include <array>
 #include <cstdint>
 #include <vector>
 
@@ -42,8 +43,13 @@ struct Token;
 struct Chunk {
   /// Keep sizeof(Chunk) == 32.
   static constexpr size_t PayloadSize = 32 - sizeof(DocID);
+  /// Each delta takes at least one byte.
+  static constexpr size_t MaxDocs = PayloadSize + 1;
 
-  llvm::SmallVector<DocID, PayloadSize + 1> decompress() const;
+  llvm::SmallVector<DocID, MaxDocs> decompress() const;
+  /// Decompresses the chunk into \p Out, and returns the number of DocIDs.
+  /// This is the fast path used by iterators, it doesn't allocate.
+  size_t decompress(std::array<DocID, MaxDocs> &Out) const;
 
   /// The first element of decompressed Chunk.
   DocID Head;
@@ -59,17 +65,33 @@ static_assert(sizeof(Chunk) == 32, "Chunk should take 32 bytes of memory.");
 class PostingList {
 public:
   explicit PostingList(llvm::ArrayRef<DocID> Documents);
+  /// Creates a posting list that uses the encoded chunks of another one in
+  /// place, e.g. from a mapped index file. Chunks must outlive the list.
+  static PostingList fromChunks(llvm::ArrayRef<Chunk> Chunks) {
+    return PostingList(Chunks);
+  }
+
+  PostingList(PostingList &&) = default;
+  PostingList &operator=(PostingList &&) = default;
 
   /// Constructs DocumentIterator over given posting list. DocumentIterator will
   /// go through the chunks and decompress them on-the-fly when necessary.
   /// If given, Tok is only used for the string representation.
   std::unique_ptr<Iterator> iterator(const Token *Tok = nullptr) const;
 
-  /// Returns in-memory size of external storage.
-  size_t bytes() const { return Chunks.capacity() * sizeof(Chunk); }
+  /// Returns the encoded contents, e.g. for serialization.
+  llvm::ArrayRef<Chunk> chunks() const { return Chunks; }
+
+  /// Returns in-memory size of external storage. This doesn't include chunks
+  /// that aren't owned by the list.
+  size_t bytes() const { return Storage.capacity() * sizeof(Chunk); }
 
 private:
-  const std::vector<Chunk> Chunks;
+  explicit PostingList(llvm::ArrayRef<Chunk> Chunks) : Chunks(Chunks) {}
+
+  std::vector<Chunk> Storage;
+  /// Either refers to Storage or to external chunks.
+  llvm::ArrayRef<Chunk> Chunks;
 };
 
 } // namespace dex
@@ -14,6 +14,7 @@
 #include "SourceCode.h"
 #include "index/Serialization.h"
 #include "index/dex/Dex.h"
+#include "index/remote/Remote.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSwitch.h"
@@ -25,8 +26,10 @@ namespace clang {
 namespace clangd {
 namespace {
 
-llvm::cl::opt<std::string> IndexPath("index-path",
-                                     llvm::cl::desc("Path to the index"),
+llvm::cl::opt<std::string> IndexPath(
+    "index-path",
+    llvm::cl::desc("Path to the index, or remote:<address> to query a "
+                   "clangd-index-server"),
                                      llvm::cl::Positional, llvm::cl::Required);
 
 static const std::string Overview = R"(
@@ -265,6 +268,8 @@ struct {
 };
 
 std::unique_ptr<SymbolIndex> openIndex(llvm::StringRef Index) {
+  if (Index.consume_front("remote:"))
+    return getRemoteIndex(Index);
   return loadIndex(Index, /*UseDex=*/true);
 }
 
@@ -0,0 +1,566 @@
+//===--- Remote.cpp - Symbol index served over a socket ----------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "Remote.h"
+#include "Logger.h"
+#include "Trace.h"
+#include "index/Serialization.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace clang {
+namespace clangd {
+namespace {
+
+// Each frame starts with the payload size (4 bytes, little endian) followed by
+// one of these kinds.
+enum class FrameKind : char {
+  Query = 'Q',   // JSON: {"Method": ..., "Request": ...}
+  Data = 'D',    // An index file holding a batch of results.
+  End = 'E',     // "1" if there may be more results than returned, else "0".
+  Failure = 'X', // An error message; the connection stays usable.
+};
+
+// Bounds the memory a corrupted or hostile peer can make us allocate.
+constexpr uint32_t MaxFrameSize = 256 << 20;
+// Number of results sent in each data frame.
+constexpr size_t BatchSize = 256;
+// Number of idle connections a client keeps open.
+constexpr size_t MaxIdleConnections = 4;
+
+llvm::Error makeError(const llvm::Twine &Msg) {
+  return llvm::make_error<llvm::StringError>(Msg,
+                                             llvm::inconvertibleErrorCode());
+}
+
+#ifndef _WIN32
+
+llvm::Error makeErrnoError(const llvm::Twine &Msg) {
+  return makeError(Msg + ": " + std::strerror(errno));
+}
+
+void setCloseOnExec(int FD) { ::fcntl(FD, F_SETFD, FD_CLOEXEC); }
+
+bool writeAll(int FD, const char *Data, size_t Size) {
+#ifdef MSG_NOSIGNAL
+  const int Flags = MSG_NOSIGNAL; // A closed peer must not kill us.
+#else
+  const int Flags = 0;
+#endif
+  while (Size) {
+    ssize_t N = ::send(FD, Data, Size, Flags);
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N <= 0)
+      return false;
+    Data += N;
+    Size -= N;
+  }
+  return true;
+}
+
+bool readAll(int FD, char *Data, size_t Size) {
+  while (Size) {
+    ssize_t N = ::recv(FD, Data, Size, 0);
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N <= 0)
+      return false;
+    Data += N;
+    Size -= N;
+  }
+  return true;
+}
+
+bool writeFrame(int FD, FrameKind Kind, llvm::StringRef Payload) {
+  if (Payload.size() > MaxFrameSize)
+    return false;
+  char Header[5];
+  uint32_t Size = Payload.size();
+  for (unsigned I = 0; I < 4; ++I)
+    Header[I] = static_cast<char>(Size >> (8 * I));
+  Header[4] = static_cast<char>(Kind);
+  return writeAll(FD, Header, sizeof(Header)) &&
+         writeAll(FD, Payload.data(), Payload.size());
+}
+
+// Returns false if the connection was closed or is broken.
+bool readFrame(int FD, FrameKind &Kind, std::string &Payload) {
+  unsigned char Header[5];
+  if (!readAll(FD, reinterpret_cast<char *>(Header), sizeof(Header)))
+    return false;
+  uint32_t Size = 0;
+  for (unsigned I = 0; I < 4; ++I)
+    Size |= uint32_t(Header[I]) << (8 * I);
+  if (Size > MaxFrameSize)
+    return false;
+  Kind = static_cast<FrameKind>(Header[4]);
+  Payload.resize(Size);
+  return readAll(FD, &Payload[0], Size);
+}
+
+// Opens a socket bound to (if Listen) or connected to Address.
+llvm::Expected<int> openSocket(llvm::StringRef Address, bool Listen) {
+  if (Address.consume_front("unix:")) {
+    sockaddr_un Addr;
+    std::memset(&Addr, 0, sizeof(Addr));
+    Addr.sun_family = AF_UNIX;
+    if (Address.empty() || Address.size() >= sizeof(Addr.sun_path))
+      return makeError("invalid socket path: " + Address);
+    std::memcpy(Addr.sun_path, Address.data(), Address.size());
+
+    int FD = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (FD < 0)
+      return makeErrnoError("socket");
+    setCloseOnExec(FD);
+    auto *SA = reinterpret_cast<sockaddr *>(&Addr);
+    if (Listen) {
+      // A server that is gone leaves its socket file behind.
+      ::unlink(Addr.sun_path);
+      if (::bind(FD, SA, sizeof(Addr)) == 0 && ::listen(FD, SOMAXCONN) == 0)
+        return FD;
+    } else if (::connect(FD, SA, sizeof(Addr)) == 0) {
+      return FD;
+    }
+    llvm::Error Err = makeErrnoError("unix:" + Address);
+    ::close(FD);
+    return std::move(Err);
+  }
+
+  size_t Colon = Address.rfind(':');
+  if (Colon == llvm::StringRef::npos)
+    return makeError("expected unix:<path> or <host>:<port>, got " + Address);
+  std::string Host = Address.take_front(Colon).trim("[]").str();
+  std::string Port = Address.drop_front(Colon + 1).str();
+
+  addrinfo Hints;
+  std::memset(&Hints, 0, sizeof(Hints));
+  Hints.ai_family = AF_UNSPEC;
+  Hints.ai_socktype = SOCK_STREAM;
+  Hints.ai_flags = Listen ? AI_PASSIVE : 0;
+  addrinfo *Infos;
+  if (int Err = ::getaddrinfo(Host.empty() ? nullptr : Host.c_str(),
+                              Port.c_str(), &Hints, &Infos))
+    return makeError(llvm::Twine(Address) + ": " + ::gai_strerror(Err));
+
+  int FD = -1;
+  for (addrinfo *Info = Infos; Info && FD < 0; Info = Info->ai_next) {
+    FD = ::socket(Info->ai_family, Info->ai_socktype, Info->ai_protocol);
+    if (FD < 0)
+      continue;
+    setCloseOnExec(FD);
+    int One = 1;
+    bool OK;
+    if (Listen) {
+      ::setsockopt(FD, SOL_SOCKET, SO_REUSEADDR, &One, sizeof(One));
+      OK = ::bind(FD, Info->ai_addr, Info->ai_addrlen) == 0 &&
+           ::listen(FD, SOMAXCONN) == 0;
+    } else {
+      OK = ::connect(FD, Info->ai_addr, Info->ai_addrlen) == 0;
+      // Requests are small and latency-sensitive.
+      ::setsockopt(FD, IPPROTO_TCP, TCP_NODELAY, &One, sizeof(One));
+    }
+    if (!OK) {
+      int SavedErrno = errno;
+      ::close(FD);
+      errno = SavedErrno;
+      FD = -1;
+    }
+  }
+  ::freeaddrinfo(Infos);
+  if (FD < 0)
+    return makeErrnoError(Address);
+  return FD;
+}
+
+#else
+
+llvm::Expected<int> openSocket(llvm::StringRef Address, bool Listen) {
+  return makeError("remote index is not supported on this platform");
+}
+bool writeFrame(int FD, FrameKind Kind, llvm::StringRef Payload) {
+  return false;
+}
+bool readFrame(int FD, FrameKind &Kind, std::string &Payload) { return false; }
+
+#endif
+
+void closeSocket(int FD) {
+#ifndef _WIN32
+  ::close(FD);
+#endif
+}
+
+class RemoteIndex : public SymbolIndex {
+public:
+  RemoteIndex(llvm::StringRef Address, std::chrono::milliseconds Timeout)
+      : Address(Address), Timeout(Timeout) {}
+
+  ~RemoteIndex() override {
+    for (int FD : Idle)
+      closeSocket(FD);
+  }
+
+  bool fuzzyFind(const FuzzyFindRequest &Req,
+                 llvm::function_ref<void(const Symbol &)> Callback)
+      const override {
+    trace::Span Tracer("RemoteIndex fuzzyFind");
+    return request("fuzzyFind", toJSON(Req), [&](const IndexFileIn &Batch) {
+      if (Batch.Symbols)
+        for (const Symbol &S : *Batch.Symbols)
+          Callback(S);
+    });
+  }
+
+  void lookup(const LookupRequest &Req,
+              llvm::function_ref<void(const Symbol &)> Callback)
+      const override {
+    trace::Span Tracer("RemoteIndex lookup");
+    request("lookup", toJSON(Req), [&](const IndexFileIn &Batch) {
+      if (Batch.Symbols)
+        for (const Symbol &S : *Batch.Symbols)
+          Callback(S);
+    });
+  }
+
+  void refs(const RefsRequest &Req,
+            llvm::function_ref<void(const Ref &)> Callback) const override {
+    trace::Span Tracer("RemoteIndex refs");
+    request("refs", toJSON(Req), [&](const IndexFileIn &Batch) {
+      if (Batch.Refs)
+        for (const auto &Refs : *Batch.Refs)
+          for (const Ref &R : Refs.second)
+            Callback(R);
+    });
+  }
+
+  // The index data lives on the server.
+  size_t estimateMemoryUsage() const override { return 0; }
+
+private:
+  // Sends the request and feeds each batch of results to OnBatch as soon as it
+  // arrives. Returns true if the server reported there may be more results.
+  bool request(llvm::StringRef Method, llvm::json::Value Req,
+               llvm::function_ref<void(const IndexFileIn &)> OnBatch) const {
+    std::string Query;
+    {
+      llvm::raw_string_ostream OS(Query);
+      OS << llvm::json::Value(llvm::json::Object{
+          {"Method", Method},
+          {"Request", std::move(Req)},
+      });
+    }
+
+    // An idle connection may have been closed by the server in the meantime,
+    // so a request that fails before producing any result is retried once on
+    // a fresh connection.
+    for (bool Retry = true;; Retry = false) {
+      bool Reused;
+      llvm::Expected<int> FD = getConnection(Reused);
+      if (!FD) {
+        elog("Remote index at {0} is unavailable: {1}", Address,
+             FD.takeError());
+        return false;
+      }
+      bool ReceivedResults = false;
+      if (!writeFrame(*FD, FrameKind::Query, Query)) {
+        closeSocket(*FD);
+        if (Reused && Retry)
+          continue;
+        elog("Failed to send {0} request to remote index at {1}", Method,
+             Address);
+        return false;
+      }
+
+      FrameKind Kind;
+      std::string Payload;
+      while (readFrame(*FD, Kind, Payload)) {
+        switch (Kind) {
+        case FrameKind::Data: {
+          auto Batch = readIndexFile(Payload);
+          if (!Batch) {
+            elog("Bad results from remote index at {0}: {1}", Address,
+                 Batch.takeError());
+            closeSocket(*FD);
+            return false;
+          }
+          ReceivedResults = true;
+          OnBatch(*Batch);
+          continue;
+        }
+        case FrameKind::End:
+          releaseConnection(*FD);
+          return Payload == "1";
+        case FrameKind::Failure:
+          elog("Remote index at {0} failed {1} request: {2}", Address, Method,
+               Payload);
+          releaseConnection(*FD);
+          return false;
+        case FrameKind::Query:
+          break;
+        }
+        break;
+      }
+      closeSocket(*FD);
+      if (Reused && Retry && !ReceivedResults)
+        continue;
+      elog("Lost connection to remote index at {0} during {1} request",
+           Address, Method);
+      return false;
+    }
+  }
+
+  llvm::Expected<int> getConnection(bool &Reused) const {
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      if (!Idle.empty()) {
+        Reused = true;
+        int FD = Idle.back();
+        Idle.pop_back();
+        return FD;
+      }
+    }
+    Reused = false;
+    auto FD = openSocket(Address, /*Listen=*/false);
+#ifndef _WIN32
+    if (FD) {
+      // Don't let a stuck server block code completion forever.
+      timeval TV;
+      TV.tv_sec = Timeout.count() / 1000;
+      TV.tv_usec = (Timeout.count() % 1000) * 1000;
+      ::setsockopt(*FD, SOL_SOCKET, SO_RCVTIMEO, &TV, sizeof(TV));
+      ::setsockopt(*FD, SOL_SOCKET, SO_SNDTIMEO, &TV, sizeof(TV));
+    }
+#endif
+    return FD;
+  }
+
+  void releaseConnection(int FD) const {
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      if (Idle.size() < MaxIdleConnections) {
+        Idle.push_back(FD);
+        return;
+      }
+    }
+    closeSocket(FD);
+  }
+
+  std::string Address;
+  std::chrono::milliseconds Timeout;
+  mutable std::mutex Mutex;
+  mutable std::vector<int> Idle; // GUARDED_BY(Mutex)
+};
+
+// Accumulates results and sends them to the client in batches.
+class ResultWriter {
+public:
+  ResultWriter(int FD) : FD(FD) {}
+
+  void add(const Symbol &S) {
+    Symbols->insert(S);
+    if (++Pending == BatchSize)
+      flush();
+  }
+  void add(const SymbolID &ID, const Ref &R) {
+    Refs->insert(ID, R);
+    if (++Pending == BatchSize)
+      flush();
+  }
+
+  // Sends the remaining results and the end frame.
+  // Returns false if the connection is broken.
+  bool finish(bool HasMore) {
+    if (Pending)
+      flush();
+    return OK && writeFrame(FD, FrameKind::End, HasMore ? "1" : "0");
+  }
+
+private:
+  void flush() {
+    SymbolSlab SymbolBatch = std::move(*Symbols).build();
+    RefSlab RefBatch = std::move(*Refs).build();
+    Symbols = llvm::make_unique<SymbolSlab::Builder>();
+    Refs = llvm::make_unique<RefSlab::Builder>();
+    Pending = 0;
+    if (!OK)
+      return;
+    IndexFileOut Out;
+    Out.Symbols = &SymbolBatch;
+    Out.Refs = &RefBatch;
+    Out.Format = IndexFileFormat::RIFF;
+    std::string Data;
+    {
+      llvm::raw_string_ostream OS(Data);
+      OS << Out;
+    }
+    OK = writeFrame(FD, FrameKind::Data, Data);
+  }
+
+  int FD;
+  bool OK = true;
+  size_t Pending = 0;
+  // Builders can't be reset, so a new one is made for each batch.
+  std::unique_ptr<SymbolSlab::Builder> Symbols =
+      llvm::make_unique<SymbolSlab::Builder>();
+  std::unique_ptr<RefSlab::Builder> Refs =
+      llvm::make_unique<RefSlab::Builder>();
+};
+
+} // namespace
+
+std::unique_ptr<SymbolIndex> getRemoteIndex(llvm::StringRef Address,
+                                            std::chrono::milliseconds Timeout) {
+  return llvm::make_unique<RemoteIndex>(Address, Timeout);
+}
+
+RemoteIndexServer::~RemoteIndexServer() {
+  stop();
+  Workers.wait();
+  if (ListenFD >= 0)
+    closeSocket(ListenFD);
+#ifndef _WIN32
+  if (!SocketPath.empty())
+    ::unlink(SocketPath.c_str());
+#endif
+}
+
+llvm::Error RemoteIndexServer::listen(llvm::StringRef Address) {
+  assert(ListenFD < 0 && "listen() called twice");
+  auto FD = openSocket(Address, /*Listen=*/true);
+  if (!FD)
+    return FD.takeError();
+  ListenFD = *FD;
+  if (Address.startswith("unix:"))
+    SocketPath = Address.drop_front(5);
+  return llvm::Error::success();
+}
+
+void RemoteIndexServer::run() {
+  assert(ListenFD >= 0 && "listen() must be called first");
+#ifndef _WIN32
+  while (!Stopped) {
+    int FD = ::accept(ListenFD, nullptr, nullptr);
+    if (FD < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      if (!Stopped)
+        elog("Remote index server stopped accepting connections: {0}",
+             std::strerror(errno));
+      break;
+    }
+    setCloseOnExec(FD);
+    int One = 1;
+    ::setsockopt(FD, IPPROTO_TCP, TCP_NODELAY, &One, sizeof(One));
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      if (Stopped) {
+        ::close(FD);
+        break;
+      }
+      Connections.insert(FD);
+    }
+    Workers.runAsync("remote-index-connection", [this, FD] {
+      serve(FD);
+      {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Connections.erase(FD);
+      }
+      ::close(FD);
+    });
+  }
+#endif
+}
+
+void RemoteIndexServer::stop() {
+#ifndef _WIN32
+  std::lock_guard<std::mutex> Lock(Mutex);
+  if (Stopped.exchange(true))
+    return;
+  // Wakes up accept() and the reads of the connection threads.
+  if (ListenFD >= 0)
+    ::shutdown(ListenFD, SHUT_RDWR);
+  for (int FD : Connections)
+    ::shutdown(FD, SHUT_RDWR);
+#endif
+}
+
+void RemoteIndexServer::serve(int FD) {
+  FrameKind Kind;
+  std::string Payload;
+  while (readFrame(FD, Kind, Payload)) {
+    if (Kind != FrameKind::Query) {
+      elog("Remote index client sent an unexpected frame");
+      return;
+    }
+    auto Query = llvm::json::parse(Payload);
+    if (!Query) {
+      elog("Remote index client sent bad JSON: {0}", Query.takeError());
+      return;
+    }
+    const llvm::json::Object *Obj = Query->getAsObject();
+    llvm::Optional<llvm::StringRef> Method;
+    const llvm::json::Value *Req = nullptr;
+    if (Obj) {
+      Method = Obj->getString("Method");
+      Req = Obj->get("Request");
+    }
+
+    ResultWriter Results(FD);
+    bool HasMore = false;
+    FuzzyFindRequest FuzzyFind;
+    LookupRequest Lookup;
+    RefsRequest Refs;
+    if (!Method || !Req) {
+      elog("Remote index client sent a malformed request");
+      return;
+    } else if (*Method == "fuzzyFind" && fromJSON(*Req, FuzzyFind)) {
+      trace::Span Tracer("RemoteIndexServer fuzzyFind");
+      HasMore = Index.fuzzyFind(FuzzyFind,
+                                [&](const Symbol &S) { Results.add(S); });
+    } else if (*Method == "lookup" && fromJSON(*Req, Lookup)) {
+      trace::Span Tracer("RemoteIndexServer lookup");
+      Index.lookup(Lookup, [&](const Symbol &S) { Results.add(S); });
+    } else if (*Method == "refs" && fromJSON(*Req, Refs)) {
+      trace::Span Tracer("RemoteIndexServer refs");
+      // The callback doesn't tell which symbol a ref belongs to. Clients
+      // don't need it, but RefSlab is keyed by symbol, so the refs of all
+      // requested IDs are grouped under a single one.
+      SymbolID Key = Refs.IDs.empty() ? SymbolID() : *Refs.IDs.begin();
+      Index.refs(Refs, [&](const Ref &R) { Results.add(Key, R); });
+    } else {
+      if (!writeFrame(FD, FrameKind::Failure,
+                      llvm::formatv("bad {0} request", *Method).str()))
+        return;
+      continue;
+    }
+    if (!Results.finish(HasMore))
+      return;
+    vlog("Remote index served {0} request", *Method);
+  }
+}
+
+} // namespace clangd
+} // namespace clang
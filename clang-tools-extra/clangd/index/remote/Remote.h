@@ -0,0 +1,78 @@
+//===--- Remote.h - Symbol index served over a socket ------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// A remote index lets many clangd instances share one large static index
+// (typically a Dex built by clangd-indexer) served by clangd-index-server,
+// instead of every client loading or building it locally.
+//
+// Requests and results are exchanged as frames over a stream socket:
+//  - a request frame holds the JSON encoding of the method and its request;
+//  - the server answers with any number of data frames, each of them an index
+//    file (see Serialization.h) holding the next batch of results, followed by
+//    an end frame. Results are therefore streamed to the client's callbacks
+//    while the server is still producing them.
+//
+// Addresses are either "unix:<path>" or "<host>:<port>".
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_REMOTE_REMOTE_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_REMOTE_REMOTE_H
+
+#include "Threading.h"
+#include "index/Index.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/Support/Error.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace clang {
+namespace clangd {
+
+/// Returns an index that forwards all requests to the server at \p Address.
+///
+/// Connections are opened lazily and reused. If the server can't be reached or
+/// doesn't answer within \p Timeout, the request is logged and returns no
+/// results, so clangd keeps working from its dynamic index.
+std::unique_ptr<SymbolIndex>
+getRemoteIndex(llvm::StringRef Address,
+               std::chrono::milliseconds Timeout = std::chrono::seconds(5));
+
+/// Serves requests for an index to remote clients.
+class RemoteIndexServer {
+public:
+  /// \p Index must outlive the server.
+  RemoteIndexServer(const SymbolIndex &Index) : Index(Index) {}
+  /// Stops the server and waits for the open connections to be closed.
+  ~RemoteIndexServer();
+
+  /// Binds to \p Address. Must be called once, before run().
+  llvm::Error listen(llvm::StringRef Address);
+  /// Accepts connections until stop() is called. Each connection is handled on
+  /// its own thread.
+  void run();
+  /// Makes run() return and shuts down the open connections. Thread-safe.
+  void stop();
+
+private:
+  void serve(int FD);
+
+  const SymbolIndex &Index;
+  int ListenFD = -1;
+  std::string SocketPath; // Removed on destruction, for unix sockets.
+  std::atomic<bool> Stopped = {false};
+  std::mutex Mutex;
+  llvm::DenseSet<int> Connections; // GUARDED_BY(Mutex)
+  AsyncTaskRunner Workers;
+};
+
+} // namespace clangd
+} // namespace clang
+
+#endif
@@ -0,0 +1,75 @@
+//===--- IndexServerMain.cpp - Serve a clangd index to remote clients -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// clangd-index-server loads an index produced by clangd-indexer and serves it
+// to clangd instances started with -remote-index-address.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Logger.h"
+#include "index/Serialization.h"
+#include "index/remote/Remote.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Signals.h"
+
+namespace clang {
+namespace clangd {
+namespace {
+
+static const std::string Overview = R"(
+This is an **experimental** server for the symbol index produced by
+clangd-indexer. clangd instances connect to it with -remote-index-address and
+merge its results with their own dynamic index.
+)";
+
+llvm::cl::opt<std::string> IndexPath("index-path",
+                                     llvm::cl::desc("Path to the index"),
+                                     llvm::cl::Positional, llvm::cl::Required);
+
+llvm::cl::opt<std::string>
+    ServerAddress("server-address",
+                  llvm::cl::desc("Address to listen on: unix:<path> or "
+                                 "<host>:<port>"),
+                  llvm::cl::init("localhost:50051"));
+
+llvm::cl::opt<Logger::Level> LogLevel(
+    "log", llvm::cl::desc("Verbosity of log messages written to stderr"),
+    llvm::cl::values(clEnumValN(Logger::Error, "error", "Error messages only"),
+                     clEnumValN(Logger::Info, "info",
+                                "High level execution tracing"),
+                     clEnumValN(Logger::Debug, "verbose", "Low level details")),
+    llvm::cl::init(Logger::Info));
+
+} // namespace
+} // namespace clangd
+} // namespace clang
+
+int main(int argc, const char *argv[]) {
+  using namespace clang::clangd;
+
+  llvm::cl::ParseCommandLineOptions(argc, argv, Overview);
+  llvm::sys::PrintStackTraceOnErrorSignal(argv[0]);
+
+  StreamLogger Logger(llvm::errs(), LogLevel);
+  LoggingSession LoggingSession(Logger);
+
+  std::unique_ptr<SymbolIndex> Index = loadIndex(IndexPath, /*UseDex=*/true);
+  if (!Index) {
+    elog("Failed to open the index {0}", IndexPath);
+    return 1;
+  }
+
+  RemoteIndexServer Server(*Index);
+  if (llvm::Error Err = Server.listen(ServerAddress)) {
+    elog("Failed to listen on {0}: {1}", ServerAddress, std::move(Err));
+    return 1;
+  }
+  log("Serving {0} on {1}", IndexPath, ServerAddress);
+  Server.run();
+  return 0;
+}
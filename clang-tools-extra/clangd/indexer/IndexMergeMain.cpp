@@ -0,0 +1,105 @@
+//===--- IndexMergeMain.cpp --------------------------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// clangd-index-merge combines the partial indexes written by shards of
+// clangd-indexer into one index.
+//
+//===----------------------------------------------------------------------===//
+
+#include "index/Merge.h"
+#include "index/Ref.h"
+#include "index/Serialization.h"
+#include "index/Symbol.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Signals.h"
+
+namespace clang {
+namespace clangd {
+namespace {
+
+static llvm::cl::list<std::string> Shards(llvm::cl::Positional,
+                                          llvm::cl::desc("<shard files>"),
+                                          llvm::cl::OneOrMore);
+
+static llvm::cl::opt<IndexFileFormat>
+    Format("format", llvm::cl::desc("Format of the index to be written"),
+           llvm::cl::values(clEnumValN(IndexFileFormat::YAML, "yaml",
+                                       "human-readable YAML format"),
+                            clEnumValN(IndexFileFormat::RIFF, "binary",
+                                       "binary RIFF format")),
+           llvm::cl::init(IndexFileFormat::RIFF));
+
+// Adds the contents of one shard to the merged index. The shard is released
+// before the next one is read, so only the merged data and a single shard are
+// in memory at any time.
+bool mergeShard(llvm::StringRef Filename, SymbolSlab::Builder &Symbols,
+                RefSlab::Builder &Refs) {
+  auto Buffer = llvm::MemoryBuffer::getFile(Filename, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
+  if (!Buffer) {
+    llvm::errs() << "Can't open " << Filename << "\n";
+    return false;
+  }
+  auto Shard = readIndexFile(Buffer->get()->getBuffer());
+  if (!Shard) {
+    llvm::errs() << "Bad index " << Filename << ": "
+                 << llvm::toString(Shard.takeError()) << "\n";
+    return false;
+  }
+  // Translation units are indexed by exactly one shard, so the reference
+  // counts of a symbol add up across shards.
+  if (Shard->Symbols) {
+    for (const auto &Sym : *Shard->Symbols) {
+      if (const auto *Existing = Symbols.find(Sym.ID))
+        Symbols.insert(mergeSymbol(*Existing, Sym));
+      else
+        Symbols.insert(Sym);
+    }
+  }
+  if (Shard->Refs) {
+    // Deduplication happens during insertion.
+    for (const auto &Sym : *Shard->Refs)
+      for (const auto &Ref : Sym.second)
+        Refs.insert(Sym.first, Ref);
+  }
+  return true;
+}
+
+} // namespace
+} // namespace clangd
+} // namespace clang
+
+int main(int argc, const char **argv) {
+  llvm::sys::PrintStackTraceOnErrorSignal(argv[0]);
+
+  const char *Overview = R"(
+  Merges index files written by shards of clangd-indexer into one index.
+
+  Example usage:
+
+  $ clangd-index-merge shard0.dex shard1.dex ... shardN.dex > clangd.dex
+  )";
+  llvm::cl::ParseCommandLineOptions(argc, argv, Overview);
+
+  clang::clangd::SymbolSlab::Builder Symbols;
+  clang::clangd::RefSlab::Builder Refs;
+  for (const auto &Shard : clang::clangd::Shards)
+    if (!clang::clangd::mergeShard(Shard, Symbols, Refs))
+      return 1;
+
+  // Emit merged data.
+  clang::clangd::IndexFileIn Data;
+  Data.Symbols = std::move(Symbols).build();
+  Data.Refs = std::move(Refs).build();
+  clang::clangd::IndexFileOut Out(Data);
+  Out.Format = clang::clangd::Format;
+  Out.Postings = true;
+  llvm::outs() << Out;
+  return 0;
+}
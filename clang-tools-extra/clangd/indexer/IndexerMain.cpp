@@ -16,12 +16,14 @@
 #include "index/Serialization.h"
 #include "index/Symbol.h"
 #include "index/SymbolCollector.h"
+#include "clang/Frontend/CompilerInvocation.h"
 #include "clang/Tooling/ArgumentsAdjusters.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Execution.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/xxhash.h"
 
 namespace clang {
 namespace clangd {
@@ -35,6 +37,27 @@ static llvm::cl::opt<IndexFileFormat>
                                        "binary RIFF format")),
            llvm::cl::init(IndexFileFormat::RIFF));
 
+static llvm::cl::opt<unsigned> ShardCount(
+    "shard-count",
+    llvm::cl::desc("Split the translation units into this many shards and "
+                   "only index the one given by -shard-index. The partial "
+                   "indexes can be combined with clangd-index-merge."),
+    llvm::cl::init(1));
+
+static llvm::cl::opt<unsigned>
+    ShardIndex("shard-index",
+               llvm::cl::desc("The shard to index, from 0 to -shard-count "
+                              "minus one."),
+               llvm::cl::init(0));
+
+// Whether the translation unit of the main file belongs in the shard we index.
+// Files are assigned by a hash of their path as written in the compile
+// command, so that indexers on different machines agree on the shards without
+// having to coordinate.
+bool isInShard(llvm::StringRef MainFile) {
+  return ShardCount <= 1 || llvm::xxHash64(MainFile) % ShardCount == ShardIndex;
+}
+
 class IndexActionFactory : public tooling::FrontendActionFactory {
 public:
   IndexActionFactory(IndexFileIn &Result) : Result(Result) {}
@@ -66,6 +89,18 @@ public:
         .release();
   }
 
+  bool runInvocation(std::shared_ptr<CompilerInvocation> Invocation,
+                     FileManager *Files,
+                     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                     DiagnosticConsumer *DiagConsumer) override {
+    const auto &Inputs = Invocation->getFrontendOpts().Inputs;
+    if (!Inputs.empty() && !isInShard(Inputs.front().getFile()))
+      return true; // Another shard indexes this file.
+    return tooling::FrontendActionFactory::runInvocation(
+        std::move(Invocation), Files, std::move(PCHContainerOps),
+        DiagConsumer);
+  }
+
   // Awkward: we write the result in the destructor, because the executor
   // takes ownership so it's the easiest way to get our data back out.
   ~IndexActionFactory() {
@@ -98,6 +133,15 @@ int main(int argc, const char **argv) {
 
   $ clangd-indexer File1.cpp File2.cpp ... FileN.cpp > clangd.dex
 
+  Example usage for indexing a project in two shards, which can run on
+  different machines, and merging them:
+
+  $ clangd-indexer --executor=all-TUs --shard-count=2 --shard-index=0 \
+      compile_commands.json > shard0.dex
+  $ clangd-indexer --executor=all-TUs --shard-count=2 --shard-index=1 \
+      compile_commands.json > shard1.dex
+  $ clangd-index-merge shard0.dex shard1.dex > clangd.dex
+
   Note: only symbols from header files will be indexed.
   )";
 
@@ -108,6 +152,10 @@ int main(int argc, const char **argv) {
     llvm::errs() << llvm::toString(Executor.takeError()) << "\n";
     return 1;
   }
+  if (clang::clangd::ShardIndex >= clang::clangd::ShardCount) {
+    llvm::errs() << "--shard-index must be less than --shard-count\n";
+    return 1;
+  }
 
   // Collect symbols found in each translation unit, merging as we go.
   clang::clangd::IndexFileIn Data;
@@ -121,6 +169,7 @@ int main(int argc, const char **argv) {
   // Emit collected data.
   clang::clangd::IndexFileOut Out(Data);
   Out.Format = clang::clangd::Format;
+  Out.Postings = true;
   llvm::outs() << Out;
   return 0;
 }
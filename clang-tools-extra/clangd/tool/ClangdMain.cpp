@@ -15,6 +15,7 @@
 #include "Transport.h"
 #include "index/Background.h"
 #include "index/Serialization.h"
+#include "index/remote/Remote.h"
 #include "clang/Basic/Version.h"
 #include "clang/Format/Format.h"
 #include "llvm/ADT/Optional.h"
@@ -116,6 +117,13 @@ static llvm::cl::opt<PCHStorageFlag> PCHStorage(
         clEnumValN(PCHStorageFlag::Memory, "memory", "store PCHs in memory")),
     llvm::cl::init(PCHStorageFlag::Disk));
 
+static llvm::cl::opt<unsigned> PCHMemoryLimit(
+    "pch-memory-limit",
+    llvm::cl::desc("With --pch-storage=memory, the most memory in MB taken by "
+                   "PCHs in memory, new ones are stored on disk beyond that. "
+                   "0 means no limit"),
+    llvm::cl::init(0));
+
 static llvm::cl::opt<int> LimitResults(
     "limit-results",
     llvm::cl::desc("Limit the number of results returned by clangd. "
@@ -154,6 +162,12 @@ static llvm::cl::opt<bool> AllScopesCompletion(
         "can insert scope qualifiers"),
     llvm::cl::init(true));
 
+static llvm::cl::opt<unsigned> CompletionLatencyBudget(
+    "completion-latency-budget",
+    llvm::cl::desc("Milliseconds after which code completion stops waiting "
+                   "for index results, 0 means no limit"),
+    llvm::cl::init(0), llvm::cl::Hidden);
+
 static llvm::cl::opt<bool> ShowOrigins(
     "debug-origin", llvm::cl::desc("Show origins of completion items"),
     llvm::cl::init(CodeCompleteOptions().ShowOrigins), llvm::cl::Hidden);
@@ -188,6 +202,15 @@ static llvm::cl::opt<Path> IndexFile(
         "eventually. Don't rely on it"),
     llvm::cl::init(""), llvm::cl::Hidden);
 
+static llvm::cl::opt<std::string> RemoteIndexAddress(
+    "remote-index-address",
+    llvm::cl::desc(
+        "Address of a clangd-index-server to use as the static index, either "
+        "unix:<path> or <host>:<port>. Its results are merged with the "
+        "dynamic index. Takes precedence over -index-file.\n"
+        "WARNING: This option is experimental only"),
+    llvm::cl::init(""), llvm::cl::Hidden);
+
 static llvm::cl::opt<bool> EnableBackgroundIndex(
     "background-index",
     llvm::cl::desc(
@@ -439,6 +462,9 @@ int main(int argc, char *argv[]) {
   switch (PCHStorage) {
   case PCHStorageFlag::Memory:
     Opts.StorePreamblesInMemory = true;
+    if (PCHMemoryLimit)
+      Opts.MaxInMemoryPreambleBytes =
+          static_cast<std::size_t>(PCHMemoryLimit) * 1024 * 1024;
     break;
   case PCHStorageFlag::Disk:
     Opts.StorePreamblesInMemory = false;
@@ -452,7 +478,9 @@ int main(int argc, char *argv[]) {
   Opts.BackgroundIndexRebuildPeriodMs = BackgroundIndexRebuildPeriod;
   std::unique_ptr<SymbolIndex> StaticIdx;
   std::future<void> AsyncIndexLoad; // Block exit while loading the index.
-  if (EnableIndex && !IndexFile.empty()) {
+  if (EnableIndex && !RemoteIndexAddress.empty()) {
+    StaticIdx = getRemoteIndex(RemoteIndexAddress);
+  } else if (EnableIndex && !IndexFile.empty()) {
     // Load the index asynchronously. Meanwhile SwapIndex returns no results.
     SwapIndex *Placeholder;
     StaticIdx.reset(Placeholder = new SwapIndex(llvm::make_unique<MemIndex>()));
@@ -480,6 +508,7 @@ int main(int argc, char *argv[]) {
   CCOpts.EnableFunctionArgSnippets = EnableFunctionArgSnippets;
   CCOpts.AllScopes = AllScopesCompletion;
   CCOpts.RunParser = CodeCompletionParse;
+  CCOpts.LatencyBudget = std::chrono::milliseconds(CompletionLatencyBudget);
 
   RealFileSystemProvider FSProvider;
   // Initialize and run ClangdLSPServer.
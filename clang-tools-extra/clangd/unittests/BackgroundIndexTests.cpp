@@ -46,6 +46,7 @@ public:
                          IndexFileOut Shard) const override {
     std::lock_guard<std::mutex> Lock(StorageMu);
     AccessedPaths.insert(ShardIdentifier);
+    StoredPaths.push_back(ShardIdentifier);
     Storage[ShardIdentifier] = llvm::to_string(Shard);
     return llvm::Error::success();
   }
@@ -67,6 +68,7 @@ public:
   }
 
   mutable llvm::StringSet<> AccessedPaths;
+  mutable std::vector<std::string> StoredPaths; // In the order of storeShard().
 };
 
 class BackgroundIndexTest : public ::testing::Test {
@@ -473,5 +475,36 @@ TEST_F(BackgroundIndexTest, NoDotsInAbsPath) {
   }
 }
 
+TEST_F(BackgroundIndexTest, BoostRelated) {
+  MockFSProvider FS;
+  llvm::StringMap<std::string> Storage;
+  size_t CacheHits = 0;
+  MemoryShardStorage MSS(Storage, CacheHits);
+  OverlayCDB CDB(/*Base=*/nullptr);
+  std::vector<std::string> Files;
+  for (const char *Dir : {"a", "b", "c", "d"}) {
+    std::string File = testPath(std::string("root/") + Dir + "/X.cc");
+    FS.Files[File] = "";
+    tooling::CompileCommand Cmd;
+    Cmd.Filename = File;
+    Cmd.Directory = testPath("root");
+    Cmd.CommandLine = {"clang++", File};
+    CDB.setCompileCommand(File, Cmd);
+    Files.push_back(File);
+  }
+  // The commands were set before the index is watching the CDB.
+  BackgroundIndex Idx(Context::empty(), FS, CDB,
+                      [&](llvm::StringRef) { return &MSS; },
+                      /*BuildIndexPeriodMs=*/0, /*ThreadPoolSize=*/1);
+  ASSERT_TRUE(Idx.blockUntilIdleForTest());
+  EXPECT_THAT(MSS.StoredPaths, ElementsAre());
+
+  Idx.boostRelated(testPath("root/c/X.h"));
+  Idx.enqueue(Files);
+  ASSERT_TRUE(Idx.blockUntilIdleForTest());
+  ASSERT_EQ(MSS.StoredPaths.size(), Files.size());
+  EXPECT_EQ(MSS.StoredPaths.front(), testPath("root/c/X.cc"));
+}
+
 } // namespace clangd
 } // namespace clang
@@ -57,6 +57,20 @@ TEST(CanonicalIncludesTest, Precedence) {
   EXPECT_EQ("<symbol>", CI.mapHeader("some/path", "some::symbol"));
 }
 
+TEST(CanonicalIncludesTest, SystemMappingWithPathMapping) {
+  CanonicalIncludes CI, Other;
+  addSystemHeadersMapping(&CI);
+  addSystemHeadersMapping(&Other);
+  CI.addMapping("libstdc++/bits/move.h", "<move>");
+
+  // The system symbol mapping still beats path mappings, but the path mapping
+  // beats system suffix mappings.
+  EXPECT_EQ("<vector>", CI.mapHeader("libstdc++/bits/move.h", "std::vector"));
+  EXPECT_EQ("<move>", CI.mapHeader("libstdc++/bits/move.h", "std::move"));
+  // The system mappings are shared, but the path mapping isn't.
+  EXPECT_EQ("<utility>", Other.mapHeader("libstdc++/bits/move.h", "std::move"));
+}
+
 } // namespace
 } // namespace clangd
 } // namespace clang
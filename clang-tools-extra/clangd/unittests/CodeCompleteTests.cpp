@@ -18,6 +18,7 @@
 #include "TestFS.h"
 #include "TestIndex.h"
 #include "TestTU.h"
+#include "Threading.h"
 #include "index/Index.h"
 #include "index/MemIndex.h"
 #include "clang/Sema/CodeCompleteConsumer.h"
@@ -2090,6 +2091,54 @@ TEST(CompletionTest, EnableSpeculativeIndexRequest) {
   ASSERT_EQ(Reqs3.size(), 2u);
 }
 
+// An index that only answers once it's released.
+class BlockingIndex : public SymbolIndex {
+public:
+  BlockingIndex(std::unique_ptr<SymbolIndex> Index) : Index(std::move(Index)) {}
+
+  bool
+  fuzzyFind(const FuzzyFindRequest &Req,
+            llvm::function_ref<void(const Symbol &)> Callback) const override {
+    Released.wait();
+    return Index->fuzzyFind(Req, Callback);
+  }
+
+  void lookup(const LookupRequest &,
+              llvm::function_ref<void(const Symbol &)>) const override {}
+
+  void refs(const RefsRequest &,
+            llvm::function_ref<void(const Ref &)>) const override {}
+
+  size_t estimateMemoryUsage() const override { return 0; }
+
+  Notification Released;
+
+private:
+  std::unique_ptr<SymbolIndex> Index;
+};
+
+TEST(CompletionTest, LatencyBudget) {
+  // Outlives the server, which waits for the late request.
+  BlockingIndex Index(memIndex({var("ns::indexed")}));
+  MockFSProvider FS;
+  MockCompilationDatabase CDB;
+  IgnoreDiagnostics DiagConsumer;
+  ClangdServer Server(CDB, FS, DiagConsumer, ClangdServer::optsForTest());
+
+  clangd::CodeCompleteOptions Opts;
+  Opts.Index = &Index;
+  Opts.LatencyBudget = std::chrono::milliseconds(10);
+  auto Results = completions(Server, R"cpp(
+      namespace ns { int local; }
+      int x = ns::^
+  )cpp",
+                             {}, Opts);
+  // The index is late, the client is told to ask again.
+  EXPECT_THAT(Results.Completions, ElementsAre(Named("local")));
+  EXPECT_TRUE(Results.HasMore);
+  Index.Released.notify();
+}
+
 TEST(CompletionTest, InsertTheMostPopularHeader) {
   std::string DeclFile = URI::create(testPath("foo")).toString();
   Symbol sym = func("Func");
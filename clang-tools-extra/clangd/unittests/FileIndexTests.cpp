@@ -141,6 +141,27 @@ TEST(FileSymbolsTest, SnapshotAliveAfterRemove) {
   EXPECT_THAT(getRefs(*Symbols, ID), RefsAre({FileURI("f1.cc")}));
 }
 
+TEST(FileSymbolsTest, RecentIndex) {
+  FileSymbols FS;
+  FS.update("f1", numSlab(1, 2), nullptr, false);
+  FS.update("f2", numSlab(3, 4), nullptr, false);
+  EXPECT_EQ(FS.numFiles(), 2u);
+  EXPECT_EQ(FS.numRecentFiles(), 2u);
+  EXPECT_THAT(runFuzzyFind(*FS.buildRecentIndex(IndexType::Light), ""),
+              UnorderedElementsAre(QName("1"), QName("2"), QName("3"),
+                                   QName("4")));
+
+  FS.buildIndex(IndexType::Light);
+  EXPECT_EQ(FS.numRecentFiles(), 0u);
+  EXPECT_THAT(runFuzzyFind(*FS.buildRecentIndex(IndexType::Light), ""),
+              IsEmpty());
+
+  FS.update("f2", numSlab(5, 5), nullptr, false);
+  EXPECT_EQ(FS.numRecentFiles(), 1u);
+  EXPECT_THAT(runFuzzyFind(*FS.buildRecentIndex(IndexType::Light), ""),
+              UnorderedElementsAre(QName("5")));
+}
+
 // Adds Basename.cpp, which includes Basename.h, which contains Code.
 void update(FileIndex &M, llvm::StringRef Basename, llvm::StringRef Code) {
   TestTU File;
@@ -363,6 +363,37 @@ TEST(MergeIndexTest, Refs) {
                                        FileURI("unittest:///test2.cc"))))));
 }
 
+TEST(RefSlabTest, DeduplicatesAndGroupsByFile) {
+  SymbolID Foo("Foo"), Bar("Bar");
+  auto MakeRef = [](const char *FileURI, unsigned Line) {
+    Ref R;
+    R.Location.FileURI = FileURI;
+    R.Location.Start.setLine(Line);
+    R.Location.End.setLine(Line);
+    R.Kind = RefKind::Reference;
+    return R;
+  };
+  RefSlab::Builder Builder;
+  Builder.insert(Foo, MakeRef("unittest:///b.cc", 1));
+  Builder.insert(Foo, MakeRef("unittest:///a.cc", 2));
+  Builder.insert(Bar, MakeRef("unittest:///a.cc", 1));
+  // Copies of the URI string are deduplicated by content.
+  std::string URICopy = "unittest:///b.cc";
+  Builder.insert(Foo, MakeRef(URICopy.c_str(), 0));
+  Builder.insert(Foo, MakeRef(URICopy.c_str(), 1));
+  Builder.insert(Foo, MakeRef("unittest:///a.cc", 2));
+
+  RefSlab Slab = std::move(Builder).build();
+  EXPECT_EQ(Slab.numRefs(), 4u);
+  EXPECT_THAT(
+      Slab,
+      UnorderedElementsAre(
+          Pair(Bar, ElementsAre(FileURI("unittest:///a.cc"))),
+          Pair(Foo, ElementsAre(FileURI("unittest:///a.cc"),
+                                FileURI("unittest:///b.cc"),
+                                FileURI("unittest:///b.cc")))));
+}
+
 MATCHER_P2(IncludeHeaderWithRef, IncludeHeader, References, "") {
   return (arg.IncludeHeader == IncludeHeader) && (arg.References == References);
 }
@@ -0,0 +1,136 @@
+//===-- RemoteIndexTests.cpp  -------------------------------*- C++ -*-----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "TestIndex.h"
+#include "index/MemIndex.h"
+#include "index/Merge.h"
+#include "index/remote/Remote.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <thread>
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+namespace clang {
+namespace clangd {
+namespace {
+
+Ref ref(const char *FileURI, RefKind Kind) {
+  Ref R;
+  R.Location.FileURI = FileURI;
+  R.Kind = Kind;
+  return R;
+}
+
+#ifndef _WIN32
+class RemoteIndexTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    RefSlab::Builder Refs;
+    SymbolID Foo("ns::foo"), Bar("ns::bar");
+    Refs.insert(Foo, ref("unittest:///a.cc", RefKind::Reference));
+    Refs.insert(Foo, ref("unittest:///b.cc", RefKind::Definition));
+    Refs.insert(Bar, ref("unittest:///c.cc", RefKind::Reference));
+    Index =
+        MemIndex::build(generateSymbols({"ns::foo", "ns::bar", "other::foo"}),
+                        std::move(Refs).build());
+
+    ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("remote-index", Dir));
+    llvm::SmallString<128> Socket(Dir);
+    llvm::sys::path::append(Socket, "socket");
+    Address = ("unix:" + Socket).str();
+
+    Server = llvm::make_unique<RemoteIndexServer>(*Index);
+    ASSERT_THAT_ERROR(Server->listen(Address), llvm::Succeeded());
+    ServerThread = std::thread([this] { Server->run(); });
+  }
+
+  void TearDown() override {
+    if (Server)
+      Server->stop();
+    if (ServerThread.joinable())
+      ServerThread.join();
+    Server.reset();
+    llvm::sys::fs::remove_directories(Dir);
+  }
+
+  std::unique_ptr<SymbolIndex> Index;
+  llvm::SmallString<128> Dir;
+  std::string Address;
+  std::unique_ptr<RemoteIndexServer> Server;
+  std::thread ServerThread;
+};
+
+TEST_F(RemoteIndexTest, FuzzyFind) {
+  auto Remote = getRemoteIndex(Address);
+  FuzzyFindRequest Req;
+  Req.Query = "foo";
+  Req.Scopes = {"ns::"};
+  EXPECT_THAT(match(*Remote, Req), ElementsAre("ns::foo"));
+
+  Req.Scopes.clear();
+  Req.AnyScope = true;
+  Req.Limit = 1;
+  bool Incomplete;
+  EXPECT_EQ(match(*Remote, Req, &Incomplete).size(), 1u);
+  EXPECT_TRUE(Incomplete);
+}
+
+TEST_F(RemoteIndexTest, LookupAndRefs) {
+  auto Remote = getRemoteIndex(Address);
+  EXPECT_THAT(lookup(*Remote, {SymbolID("ns::foo"), SymbolID("other::foo")}),
+              UnorderedElementsAre("ns::foo", "other::foo"));
+
+  RefsRequest Req;
+  Req.IDs = {SymbolID("ns::foo")};
+  // The strings of the results only live until the callback returns.
+  std::vector<std::string> Files;
+  auto CollectFile = [&](const Ref &R) { Files.push_back(R.Location.FileURI); };
+  Remote->refs(Req, CollectFile);
+  EXPECT_THAT(Files,
+              UnorderedElementsAre("unittest:///a.cc", "unittest:///b.cc"));
+
+  Files.clear();
+  Req.Filter = RefKind::Definition;
+  Remote->refs(Req, CollectFile);
+  EXPECT_THAT(Files, ElementsAre("unittest:///b.cc"));
+}
+
+TEST_F(RemoteIndexTest, MergedWithDynamicIndex) {
+  auto Remote = getRemoteIndex(Address);
+  auto Dynamic = MemIndex::build(generateSymbols({"ns::foo_local"}), RefSlab());
+  MergedIndex Merged(Dynamic.get(), Remote.get());
+  FuzzyFindRequest Req;
+  Req.Query = "foo";
+  Req.Scopes = {"ns::"};
+  EXPECT_THAT(match(Merged, Req),
+              UnorderedElementsAre("ns::foo", "ns::foo_local"));
+}
+
+TEST_F(RemoteIndexTest, ServerUnavailable) {
+  auto Remote = getRemoteIndex(Address);
+  FuzzyFindRequest Req;
+  Req.AnyScope = true;
+  EXPECT_EQ(match(*Remote, Req).size(), 3u);
+
+  Server->stop();
+  ServerThread.join();
+  Server.reset();
+  EXPECT_THAT(match(*Remote, Req), IsEmpty());
+}
+#endif
+
+} // namespace
+} // namespace clangd
+} // namespace clang
@@ -6,8 +6,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "TestIndex.h"
 #include "index/Index.h"
 #include "index/Serialization.h"
+#include "index/dex/Dex.h"
 #include "llvm/Support/SHA1.h"
 #include "llvm/Support/ScopedPrinter.h"
 #include "gmock/gmock.h"
@@ -215,6 +217,43 @@ TEST(SerializationTest, SrcsTest) {
   }
 }
 
+TEST(SerializationTest, PostingsTest) {
+  SymbolSlab Symbols = generateSymbols(
+      {"ns::foo", "ns::foobar", "ns::bar", "other::foo", "baz"});
+  IndexFileOut Out;
+  Out.Symbols = &Symbols;
+  Out.Format = IndexFileFormat::RIFF;
+  Out.Postings = true;
+  std::string Serialized = llvm::to_string(Out);
+
+  auto In = readIndexFile(Serialized);
+  ASSERT_TRUE(bool(In)) << In.takeError();
+  ASSERT_TRUE(In->Symbols);
+  ASSERT_TRUE(In->Postings);
+  EXPECT_EQ(In->Postings->Order.size(), Symbols.size());
+
+  // An index using the stored posting lists matches one that computes them.
+  dex::Dex Built(*In->Symbols, RefSlab());
+  dex::Dex Restored(*In->Symbols, RefSlab(), In->Postings.getPointer());
+  EXPECT_EQ(Restored.postings().Lists.size(), Built.postings().Lists.size());
+  FuzzyFindRequest Req;
+  Req.AnyScope = true;
+  for (const char *Query : {"foo", "fb", "ba", ""}) {
+    Req.Query = Query;
+    EXPECT_THAT(match(Restored, Req),
+                UnorderedElementsAreArray(match(Built, Req)))
+        << Query;
+  }
+  EXPECT_THAT(lookup(Restored, SymbolID("ns::bar")),
+              UnorderedElementsAre("ns::bar"));
+
+  // Postings that don't match the symbols are ignored.
+  SymbolSlab Other = generateSymbols({"ns::foo", "qux"});
+  dex::Dex Rebuilt(Other, RefSlab(), In->Postings.getPointer());
+  Req.Query = "";
+  EXPECT_THAT(match(Rebuilt, Req), UnorderedElementsAre("ns::foo", "qux"));
+}
+
 } // namespace
 } // namespace clangd
 } // namespace clang
@@ -24,6 +24,7 @@ namespace {
 using ::testing::AnyOf;
 using ::testing::Each;
 using ::testing::ElementsAre;
+using ::testing::IsEmpty;
 using ::testing::Pointee;
 using ::testing::UnorderedElementsAre;
 
@@ -485,6 +486,27 @@ TEST_F(TUSchedulerTests, EvictedAST) {
               UnorderedElementsAre(Foo, AnyOf(Bar, Baz)));
 }
 
+TEST_F(TUSchedulerTests, EvictedASTByMemoryBudget) {
+  ASTRetentionPolicy Policy;
+  // Smaller than any AST, only the most recently used one is retained.
+  Policy.MaxRetainedBytes = 1;
+  TUScheduler S(CDB,
+                /*AsyncThreadsCount=*/1, /*StorePreambleInMemory=*/true,
+                /*ASTCallbacks=*/nullptr,
+                /*UpdateDebounce=*/std::chrono::steady_clock::duration::zero(),
+                Policy);
+
+  auto Foo = testPath("foo.cpp");
+  auto Bar = testPath("bar.cpp");
+  updateWithCallback(S, Foo, "int x;", WantDiagnostics::Yes, [] {});
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  EXPECT_THAT(S.getFilesWithCachedAST(), ElementsAre(Foo));
+
+  updateWithCallback(S, Bar, "int y;", WantDiagnostics::Yes, [] {});
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  EXPECT_THAT(S.getFilesWithCachedAST(), ElementsAre(Bar));
+}
+
 TEST_F(TUSchedulerTests, EmptyPreamble) {
   TUScheduler S(CDB,
                 /*AsyncThreadsCount=*/4, /*StorePreambleInMemory=*/true,
@@ -528,6 +550,33 @@ TEST_F(TUSchedulerTests, EmptyPreamble) {
       });
 }
 
+TEST_F(TUSchedulerTests, PreamblesOverMemoryBudget) {
+  // The first preamble exceeds the budget, the second one is stored on disk.
+  TUScheduler S(CDB,
+                /*AsyncThreadsCount=*/4, /*StorePreambleInMemory=*/true,
+                /*ASTCallbacks=*/nullptr,
+                /*UpdateDebounce=*/std::chrono::steady_clock::duration::zero(),
+                ASTRetentionPolicy(), /*MaxInMemoryPreambleBytes=*/1);
+
+  auto Header = testPath("foo.h");
+  Files[Header] = "int foo();";
+  Timestamps[Header] = time_t(0);
+  auto Code = R"cpp(
+    #include "foo.h"
+    int x = foo();
+  )cpp";
+  for (const char *Name : {"first.cpp", "second.cpp"}) {
+    auto File = testPath(Name);
+    S.update(File, getInputs(File, Code), WantDiagnostics::Auto);
+    ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+    S.runWithAST("CheckAST", File, [&](Expected<InputsAndAST> AST) {
+      ASSERT_TRUE(bool(AST));
+      EXPECT_THAT(AST->AST.getDiagnostics(), IsEmpty()) << Name;
+    });
+    ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  }
+}
+
 TEST_F(TUSchedulerTests, RunWaitsForPreamble) {
   // Testing strategy: we update the file and schedule a few preamble reads at
   // the same time. All reads should get the same non-null preamble.
@@ -615,6 +664,88 @@ TEST_F(TUSchedulerTests, NoopOnEmptyChanges) {
   ASSERT_FALSE(DoUpdate(OtherSourceContents));
 }
 
+TEST_F(TUSchedulerTests, DiagnosticsWithStalePreamble) {
+  TUScheduler S(CDB,
+                /*AsyncThreadsCount=*/getDefaultAsyncThreadsCount(),
+                /*StorePreambleInMemory=*/true, captureDiags(),
+                /*UpdateDebounce=*/std::chrono::steady_clock::duration::zero(),
+                ASTRetentionPolicy());
+
+  auto Source = testPath("foo.cpp");
+  auto Header = testPath("foo.h");
+  Files[Header] = "int a;";
+  Timestamps[Header] = time_t(0);
+
+  std::mutex Mut;
+  std::vector<size_t> DiagCounts;
+  auto DoUpdate = [&](std::string Contents) {
+    updateWithDiags(S, Source, Contents, WantDiagnostics::Yes,
+                    [&](std::vector<Diag> Diags) {
+                      std::lock_guard<std::mutex> Lock(Mut);
+                      DiagCounts.push_back(Diags.size());
+                    });
+    ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  };
+  DoUpdate("#include \"foo.h\"\nint b = a;");
+  EXPECT_THAT(DiagCounts, ElementsAre(0u));
+
+  // The header changed, but not the preamble section of the main file. The
+  // old preamble is used for diagnostics until the new one is built.
+  Files[Header] = "int c;";
+  Timestamps[Header] = time_t(1);
+  DiagCounts.clear();
+  DoUpdate("#include \"foo.h\"\nint b = a; ");
+  EXPECT_THAT(DiagCounts, ElementsAre(0u, 1u));
+
+  // Changing the preamble section waits for the preamble.
+  DiagCounts.clear();
+  DoUpdate("#define X\n#include \"foo.h\"\nint b = c;");
+  EXPECT_THAT(DiagCounts, ElementsAre(0u));
+}
+
+TEST_F(TUSchedulerTests, DiagnosticsOfEditedFunctionBody) {
+  TUScheduler S(CDB,
+                /*AsyncThreadsCount=*/getDefaultAsyncThreadsCount(),
+                /*StorePreambleInMemory=*/true, captureDiags(),
+                /*UpdateDebounce=*/std::chrono::steady_clock::duration::zero(),
+                ASTRetentionPolicy());
+
+  auto Source = testPath("foo.cpp");
+  // Only large files have their function bodies parsed separately.
+  std::string Padding = "//" + std::string(64 * 1024, ' ') + "\n";
+  std::mutex Mut;
+  std::vector<std::vector<std::pair<std::string, int>>> Reports;
+  auto DoUpdate = [&](std::string Contents) {
+    updateWithDiags(S, Source, Padding + Contents, WantDiagnostics::Yes,
+                    [&](std::vector<Diag> Diags) {
+                      std::lock_guard<std::mutex> Lock(Mut);
+                      Reports.emplace_back();
+                      for (const Diag &D : Diags)
+                        Reports.back().emplace_back(D.Message,
+                                                    D.Range.start.line);
+                    });
+    ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  };
+  DoUpdate("void f() {}\nvoid g() { int x = y; }");
+  EXPECT_THAT(Reports, ElementsAre(ElementsAre(
+                           std::make_pair("use of undeclared identifier 'y'",
+                                          2))));
+
+  // Only the body of f() is parsed first, the diagnostic in g() is moved from
+  // the previous build. The full build that follows agrees.
+  Reports.clear();
+  DoUpdate("void f() {\n  z;\n}\nvoid g() { int x = y; }");
+  auto Expected =
+      ElementsAre(std::make_pair("use of undeclared identifier 'z'", 2),
+                  std::make_pair("use of undeclared identifier 'y'", 4));
+  EXPECT_THAT(Reports, ElementsAre(Expected, Expected));
+
+  // Edits outside of function bodies need the full build.
+  Reports.clear();
+  DoUpdate("int a;\nvoid f() {\n  z;\n}\nvoid g() { int x = y; }");
+  EXPECT_EQ(Reports.size(), 1u);
+}
+
 TEST_F(TUSchedulerTests, NoChangeDiags) {
   TUScheduler S(CDB,
                 /*AsyncThreadsCount=*/getDefaultAsyncThreadsCount(),
@@ -139,6 +139,12 @@ class FullComment;
 
 } // namespace comments
 
+namespace interp {
+
+class Context;
+
+} // namespace interp
+
 struct TypeInfo {
   uint64_t Width = 0;
   unsigned Align = 0;
@@ -2248,6 +2254,10 @@ public:
 
   VTableContextBase *getVTableContext();
 
+  /// Returns the context of the experimental constant interpreter, enabled by
+  /// -fexperimental-new-constant-interpreter.
+  interp::Context &getInterpContext() const;
+
   /// If \p T is null pointer, assume the target in ASTContext.
   MangleContext *createMangleContext(const TargetInfo *T = nullptr);
 
@@ -2995,6 +3005,9 @@ private:
 
   std::unique_ptr<VTableContextBase> VTContext;
 
+  /// The bytecode interpreter for constant expressions, created on first use.
+  mutable std::unique_ptr<interp::Context> InterpContext;
+
   void ReleaseDeclContextMaps();
 
 public:
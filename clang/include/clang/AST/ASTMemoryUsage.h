@@ -0,0 +1,72 @@
+//===- ASTMemoryUsage.h - Account for the memory used by an AST -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the ASTMemoryUsage class, which estimates how much memory
+//  the AST of a translation unit occupies, broken down by the kind of node:
+//  each Decl, Stmt, Type and Attr class, the DeclContext lookup tables and the
+//  side tables of the ASTContext.
+//
+//  Unlike the statistics printed by -print-stats, which must be enabled before
+//  parsing starts, it walks an existing AST, so it can be used on the
+//  long-lived ASTs of an ASTUnit or a language server to find out where their
+//  memory goes.
+//
+//  The numbers are the sizes of the node classes and of the tables; objects
+//  allocated alongside a node (e.g. the arguments of a CallExpr or the
+//  parameters of a FunctionDecl) are not included, so they are a lower bound.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_AST_ASTMEMORYUSAGE_H
+#define LLVM_CLANG_AST_ASTMEMORYUSAGE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <cstdint>
+
+namespace clang {
+
+class ASTContext;
+class DeclContext;
+
+class ASTMemoryUsage {
+public:
+  struct Entry {
+    uint64_t Count = 0;
+    uint64_t Bytes = 0;
+  };
+
+  /// Account for the AST reachable from the translation unit of \p Ctx,
+  /// including template instantiations and implicit code, and for all types
+  /// created in \p Ctx.
+  explicit ASTMemoryUsage(const ASTContext &Ctx);
+
+  /// Return the entry for nodes of kind \p Kind, e.g. "FunctionDecl",
+  /// "CallExpr", "PointerType" or "DeclContext lookup table", which is empty
+  /// if there are none.
+  Entry lookup(StringRef Kind) const { return Entries.lookup(Kind); }
+
+  const llvm::StringMap<Entry> &getEntries() const { return Entries; }
+
+  uint64_t getTotalBytes() const;
+
+  /// Print a table of all entries, largest first.
+  void print(raw_ostream &OS) const;
+
+private:
+  void add(StringRef Kind, uint64_t Count, uint64_t Bytes);
+  void addLookupTable(const DeclContext &DC);
+
+  llvm::StringMap<Entry> Entries;
+  uint64_t ArenaBytes;
+};
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_AST_ASTMEMORYUSAGE_H
@@ -238,6 +238,10 @@ public:
   /// records.
   std::string OptRecordFile;
 
+  /// The format used for serializing the optimization records, or empty for
+  /// the default (YAML).
+  std::string OptRecordFormat;
+
   /// The regex that filters the passes that should be saved to the optimization
   /// records.
   std::string OptRecordPasses;
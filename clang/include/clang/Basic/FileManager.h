@@ -249,6 +249,14 @@ public:
   /// Remove the real file \p Entry from the cache.
   void invalidateCache(const FileEntry *Entry);
 
+  /// Check whether any file or directory looked up so far, including the
+  /// ones that were not found, is different on disk now.
+  ///
+  /// This lets a long-lived process reuse the FileManager, and the files it
+  /// has seen, for the next compilation. File managers holding virtual files
+  /// are always considered changed.
+  bool hasChangedOnDisk();
+
   /// If path is not absolute and FileSystemOptions set the working
   /// directory, the path is modified to be relative to the given
   /// working directory.
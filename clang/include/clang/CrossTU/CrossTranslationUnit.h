@@ -45,7 +45,8 @@ enum class index_error_code {
   failed_to_generate_usr,
   triple_mismatch,
   lang_mismatch,
-  lang_dialect_mismatch
+  lang_dialect_mismatch,
+  load_threshold_reached
 };
 
 class IndexError : public llvm::ErrorInfo<IndexError> {
@@ -100,7 +101,11 @@ bool containsConst(const VarDecl *VD, const ASTContext &ACtx);
 /// In order to use this class, an index file is required that describes
 /// the locations of the AST files for each definition.
 ///
-/// Note that this class also implements caching.
+/// Note that this class also implements caching. Loaded AST files are kept for
+/// the lifetime of the context and the definitions of each of them are indexed
+/// by lookup name once, so later lookups in an already loaded AST file do not
+/// need to traverse it again. The number of loaded AST files is bounded by the
+/// ctu-import-threshold analyzer option.
 class CrossTranslationUnitContext {
 public:
   CrossTranslationUnitContext(CompilerInstance &CI);
@@ -169,8 +174,7 @@ private:
                                                      StringRef IndexName,
                                                      bool DisplayCTUProgress);
   template <typename T>
-  const T *findDefInDeclContext(const DeclContext *DC,
-                                StringRef LookupName);
+  const T *findDefInTU(TranslationUnitDecl *TU, StringRef LookupName);
   template <typename T>
   llvm::Expected<const T *> importDefinitionImpl(const T *D);
 
@@ -179,9 +183,15 @@ private:
   llvm::StringMap<std::string> NameFileMap;
   llvm::DenseMap<TranslationUnitDecl *, std::unique_ptr<ASTImporter>>
       ASTUnitImporterMap;
+  /// The definitions of each loaded AST file indexed by lookup name.
+  llvm::DenseMap<TranslationUnitDecl *, llvm::StringMap<const Decl *>>
+      TUDefinitionMap;
   CompilerInstance &CI;
   ASTContext &Context;
   std::unique_ptr<ASTImporterLookupTable> LookupTable;
+  /// The maximal number of AST files to load, see ctu-import-threshold.
+  unsigned CTULoadThreshold;
+  unsigned NumASTLoaded{0u};
 };
 
 } // namespace cross_tu
@@ -164,6 +164,14 @@ public:
   /// The file to log CC_LOG_DIAGNOSTICS output to, if enabled.
   const char *CCLogDiagnosticsFilename;
 
+  /// A function running -cc1 jobs in this process, which is passed the
+  /// command line of the job, starting with the clang executable.
+  typedef int (*CC1ToolFunc)(ArrayRef<const char *> Argv);
+
+  /// If set, -cc1 jobs of the clang executable are run in this process by
+  /// calling this function instead of in a new process.
+  CC1ToolFunc CC1Main = nullptr;
+
   /// A list of inputs and their types for the given arguments.
   typedef SmallVector<std::pair<types::ID, const llvm::opt::Arg *>, 16>
       InputList;
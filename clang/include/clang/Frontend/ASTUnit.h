@@ -42,6 +42,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -74,6 +75,7 @@ class InputKind;
 class InMemoryModuleCache;
 class PCHContainerOperations;
 class PCHContainerReader;
+class PreambleStore;
 class Preprocessor;
 class PreprocessorOptions;
 class Sema;
@@ -219,7 +221,11 @@ private:
   llvm::StringMap<SourceLocation> PreambleSrcLocCache;
 
   /// The contents of the preamble.
-  llvm::Optional<PrecompiledPreamble> Preamble;
+  std::shared_ptr<const PrecompiledPreamble> Preamble;
+
+  /// If non-null, the store used to share the preamble with the ASTUnits of
+  /// other main files.
+  std::shared_ptr<PreambleStore> Preambles;
 
   /// When non-NULL, this is the buffer used to store the contents of
   /// the main file when it has been padded for use with the precompiled
@@ -778,7 +784,8 @@ public:
       TranslationUnitKind TUKind = TU_Complete,
       bool CacheCodeCompletionResults = false,
       bool IncludeBriefCommentsInCodeCompletion = false,
-      bool UserFilesAreVolatile = false);
+      bool UserFilesAreVolatile = false,
+      std::shared_ptr<PreambleStore> Preambles = nullptr);
 
   /// LoadFromCommandLine - Create an ASTUnit from a vector of command line
   /// arguments, which must specify exactly one source file.
@@ -807,6 +814,9 @@ public:
   /// it(i.e., be an overlay over RealFileSystem). RealFileSystem will be used
   /// if \p VFS is nullptr.
   ///
+  /// \param Preambles - If non-null, a store of the preambles shared with the
+  /// other translation units of the same client.
+  ///
   // FIXME: Move OnlyLocalDecls, UseBumpAllocator to setters on the ASTUnit, we
   // shouldn't need to specify them at construction time.
   static ASTUnit *LoadFromCommandLine(
@@ -827,7 +837,8 @@ public:
       bool ForSerialization = false,
       llvm::Optional<StringRef> ModuleFormat = llvm::None,
       std::unique_ptr<ASTUnit> *ErrAST = nullptr,
-      IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS = nullptr);
+      IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS = nullptr,
+      std::shared_ptr<PreambleStore> Preambles = nullptr);
 
   /// Reparse the source files using the same command-line options that
   /// were originally used to produce this translation unit.
@@ -891,6 +902,56 @@ public:
   bool serialize(raw_ostream &OS);
 };
 
+/// Shares the precompiled preambles of ASTUnits between main files that start
+/// with the same preamble, such as sibling files with the same includes.
+///
+/// A preamble is only shared between main files in the same directory, so
+/// that quoted includes are found in the same places, whose preambles and
+/// options agree. The main file part of a shared preamble keeps the source
+/// locations of the file it was built from; ASTUnit maps them to its own main
+/// file, as it does for the preambles it builds itself.
+///
+/// The store keeps the most recently used preambles alive. It can be used
+/// from several threads.
+class PreambleStore {
+public:
+  /// A preamble along with what ASTUnit recorded while building it.
+  struct Entry {
+    std::shared_ptr<const PrecompiledPreamble> Preamble;
+
+    /// The name of the main file that the preamble was built from.
+    std::string MainFileName;
+
+    std::vector<serialization::DeclID> TopLevelDecls;
+    unsigned TopLevelHashValue = 0;
+    unsigned NumWarnings = 0;
+    SmallVector<ASTUnit::StandaloneDiagnostic, 4> Diagnostics;
+  };
+
+  explicit PreambleStore(unsigned MaxEntries = 16) : MaxEntries(MaxEntries) {}
+
+  /// Find the preamble stored under \p Key, if it can still be used for the
+  /// main file \p MainFileBuffer.
+  std::shared_ptr<const Entry>
+  lookup(StringRef Key, const CompilerInvocation &Invocation,
+         const llvm::MemoryBuffer *MainFileBuffer, PreambleBounds Bounds,
+         llvm::vfs::FileSystem *VFS);
+
+  /// Store \p E under \p Key, replacing the preamble stored for it, if any.
+  void insert(StringRef Key, std::shared_ptr<const Entry> E);
+
+private:
+  struct Slot {
+    std::shared_ptr<const Entry> E;
+    uint64_t LastUse;
+  };
+
+  std::mutex Mutex;
+  llvm::StringMap<Slot> Slots;
+  uint64_t UseCount = 0;
+  unsigned MaxEntries;
+};
+
 } // namespace clang
 
 #endif // LLVM_CLANG_FRONTEND_ASTUNIT_H
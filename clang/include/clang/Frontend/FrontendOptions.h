@@ -260,6 +260,10 @@ public:
   /// Output time trace profile.
   unsigned TimeTrace : 1;
 
+  /// Trace template argument substitutions and instantiation stacks in the
+  /// time trace profile.
+  unsigned TimeTraceTemplates : 1;
+
   /// Show the -version text.
   unsigned ShowVersion : 1;
 
@@ -372,6 +376,9 @@ public:
                          ObjCMT_MigrateDecls | ObjCMT_PropertyDotSyntax)
   };
   unsigned ObjCMTAction = ObjCMT_None;
+
+  /// Minimum time granularity (in microseconds) traced by the time profiler.
+  unsigned TimeTraceGranularity = 500;
   std::string ObjCMTWhiteListPath;
 
   std::string MTMigrateDir;
@@ -445,8 +452,8 @@ public:
   FrontendOptions()
       : DisableFree(false), RelocatablePCH(false), ShowHelp(false),
         ShowStats(false), ShowTimers(false), TimeTrace(false),
-        ShowVersion(false), FixWhatYouCan(false), FixOnlyWarnings(false),
-        FixAndRecompile(false), FixToTemporaries(false),
+        TimeTraceTemplates(false), ShowVersion(false), FixWhatYouCan(false),
+        FixOnlyWarnings(false), FixAndRecompile(false), FixToTemporaries(false),
         ARCMTMigrateEmitARCErrors(false), SkipFunctionBodies(false),
         UseGlobalModuleIndex(true), GenerateGlobalModuleIndex(true),
         ASTDumpDecls(false), ASTDumpLookups(false),
@@ -0,0 +1,44 @@
+//===- DependencyDirectivesSourceMinimizer.h --------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file defines the minimizeSourceToDependencyDirectives function, which
+/// reduces a source file to the preprocessor directives that can affect its
+/// dependencies, so that it can be preprocessed much faster. This is used by
+/// the fast dependency scanning mode.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_DEPENDENCYDIRECTIVESSOURCEMINIMIZER_H
+#define LLVM_CLANG_LEX_DEPENDENCYDIRECTIVESSOURCEMINIMIZER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace clang {
+
+/// Minimize the input down to the preprocessor directives that might have an
+/// effect on the dependencies of a compilation unit.
+///
+/// This function deletes all non-preprocessor code, and strips anything that
+/// can't affect what gets included. It keeps the #include-like directives,
+/// macro definitions, conditional directives, \c \@import declarations and the
+/// pragmas that affect inclusion (\c once, \c push_macro, \c pop_macro,
+/// \c include_alias and \c clang \c module \c import). Comments are replaced by
+/// a space and line continuations are joined, so that every kept directive
+/// ends up on a line of its own.
+///
+/// \returns false on success, true on error. The output is still usable on
+/// error, but the caller should prefer the original input.
+bool minimizeSourceToDependencyDirectives(StringRef Input,
+                                          SmallVectorImpl<char> &Output);
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_LEX_DEPENDENCYDIRECTIVESSOURCEMINIMIZER_H
@@ -18,6 +18,7 @@
 #include "clang/Lex/DirectoryLookup.h"
 #include "clang/Lex/HeaderMap.h"
 #include "clang/Lex/ModuleMap.h"
+#include "clang/Lex/PersistentLookupFileCache.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
@@ -214,6 +215,12 @@ class HeaderSearch {
   };
   llvm::StringMap<LookupFileCacheInfo, llvm::BumpPtrAllocator> LookupFileCache;
 
+  /// The cache of lookups that persists across compilations, if one was
+  /// requested with HeaderSearchOptions::LookupFileCachePath. It is created
+  /// by the first lookup, as the search directories are final by then.
+  std::unique_ptr<PersistentLookupFileCache> PersistentCache;
+  bool PersistentCacheLoaded = false;
+
   /// Collection mapping a framework or subframework
   /// name like "Carbon" to the Carbon.framework directory.
   llvm::StringMap<FrameworkCacheEntry, llvm::BumpPtrAllocator> FrameworkMap;
@@ -282,6 +289,7 @@ public:
     SystemDirIdx = systemDirIdx;
     NoCurDirSearch = noCurDirSearch;
     //LookupFileCache.clear();
+    resetPersistentLookupFileCache();
   }
 
   /// Add an additional search path.
@@ -291,6 +299,7 @@ public:
     if (!isAngled)
       AngledDirIdx++;
     SystemDirIdx++;
+    resetPersistentLookupFileCache();
   }
 
   /// Set the list of system header prefixes.
@@ -647,6 +656,17 @@ private:
       const FileEntry *File, StringRef FrameworkName, Module *RequestingModule,
       ModuleMap::KnownHeader *SuggestedModule, bool IsSystemFramework);
 
+  /// Returns the persistent lookup file cache for the current search
+  /// directories, or null if there is none.
+  PersistentLookupFileCache *getPersistentLookupFileCache();
+
+  /// Drops the persistent lookup file cache after the search directories
+  /// changed, as its entries refer to them by index.
+  void resetPersistentLookupFileCache() {
+    PersistentCache.reset();
+    PersistentCacheLoaded = false;
+  }
+
   /// Look up the file with the specified name and determine its owning
   /// module.
   const FileEntry *
@@ -726,6 +746,10 @@ public:
                                               llvm::StringRef WorkingDir,
                                               bool *IsSystem = nullptr);
 
+  /// Writes the lookups of this compilation to the persistent lookup file
+  /// cache, if there is one.
+  void savePersistentLookupFileCache();
+
   void PrintStats();
 
   size_t getTotalMemory() const;
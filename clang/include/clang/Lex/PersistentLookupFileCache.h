@@ -0,0 +1,118 @@
+//===- PersistentLookupFileCache.h - Header search across TUs ---*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the PersistentLookupFileCache interface, an on-disk cache
+// of the search directories that #include lookups were satisfied by.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_PERSISTENTLOOKUPFILECACHE_H
+#define LLVM_CLANG_LEX_PERSISTENTLOOKUPFILECACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace llvm {
+namespace vfs {
+class FileSystem;
+} // end namespace vfs
+} // end namespace llvm
+
+namespace clang {
+
+/// A cache of the results of header search that persists across
+/// compilations, so that a lookup in a long list of search directories only
+/// needs to probe the directory that had the file the last time.
+///
+/// The cache is keyed by the spelling of the include, the index in the search
+/// list that the search started at, and a hash of the search list. An entry is
+/// only used if none of the directories from the start to the hit changed
+/// their modification time since the entry was recorded, so a file added to
+/// one of those directories is found. Files added to subdirectories of search
+/// directories for includes like "dir/file.h" aren't noticed, as the cache
+/// only checks the search directories themselves. Only plain directories are
+/// cached; a search through a header map or a framework isn't.
+///
+/// The file holds the entries of several search lists, so compilations with
+/// different include paths can share it. It is written with an atomic rename,
+/// after merging with the entries other compilations saved in the meantime.
+class PersistentLookupFileCache {
+public:
+  /// A directory in the search list.
+  struct SearchDir {
+    /// A name that identifies the directory and the way it is searched.
+    std::string Name;
+
+    /// Whether lookups through this directory can be cached. For these, Name
+    /// must be the path of the directory.
+    bool IsCacheable;
+  };
+
+  /// Creates the cache for the search list \p Dirs and loads the entries
+  /// recorded for that list from \p Path, if it exists. Modification times of
+  /// directories are queried from \p FS.
+  PersistentLookupFileCache(StringRef Path, ArrayRef<SearchDir> Dirs,
+                            llvm::vfs::FileSystem &FS);
+
+  /// Returns the index of the directory that had \p Filename when it was last
+  /// searched for from \p StartIdx, if that result is still valid.
+  Optional<unsigned> lookup(StringRef Filename, unsigned StartIdx);
+
+  /// Records that a search for \p Filename that started at \p StartIdx found
+  /// it in the directory at \p HitIdx.
+  void insert(StringRef Filename, unsigned StartIdx, unsigned HitIdx);
+
+  /// Writes the cache back to its file if any entries were added.
+  ///
+  /// \returns true on error.
+  bool save();
+
+  unsigned getNumHits() const { return NumHits; }
+  unsigned getNumMisses() const { return NumMisses; }
+
+  /// The result of a directory stat: a modification time in nanoseconds, or
+  /// None if the directory doesn't exist.
+  typedef Optional<int64_t> DirState;
+
+private:
+  /// Returns true if the directories in [Begin, End] are cacheable and their
+  /// state matches RecordedStates.
+  bool isUnchanged(unsigned Begin, unsigned End);
+
+  /// Returns the current state of the directory at \p Idx, which is queried
+  /// once.
+  DirState getCurrentState(unsigned Idx);
+
+  std::string Path;
+  std::vector<SearchDir> Dirs;
+  llvm::vfs::FileSystem &FS;
+  uint64_t ListHash;
+
+  /// The states of the directories when the loaded entries were recorded.
+  std::vector<DirState> RecordedStates;
+  std::vector<Optional<DirState>> CurrentStates;
+
+  /// The entries for this search list that were loaded, which are valid for
+  /// RecordedStates, and those that were inserted, which are valid for the
+  /// current states. Both are keyed by the start index and the spelling, and
+  /// map to the hit index.
+  llvm::StringMap<unsigned> LoadedEntries;
+  llvm::StringMap<unsigned> NewEntries;
+
+  unsigned NumHits = 0;
+  unsigned NumMisses = 0;
+};
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_LEX_PERSISTENTLOOKUPFILECACHE_H
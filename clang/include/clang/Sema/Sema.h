@@ -48,6 +48,7 @@
 #include "clang/Sema/TypoCorrection.h"
 #include "clang/Sema/Weak.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallBitVector.h"
@@ -7554,6 +7555,43 @@ public:
     SuppressedDiagnosticsMap;
   SuppressedDiagnosticsMap SuppressedDiagnostics;
 
+  /// A failed substitution of deduced template arguments into a function
+  /// template, memoized by FinishTemplateArgumentDeduction.
+  ///
+  /// Overload resolution repeats the same deduction for every call that
+  /// names the template, and substitution failures (unlike successful
+  /// substitutions, which produce a specialization) leave nothing behind
+  /// that would allow the next attempt to stop early.
+  struct MemoizedSubstitutionFailure : llvm::FoldingSetNode {
+    explicit MemoizedSubstitutionFailure(const llvm::FoldingSetNodeID &Key)
+        : Key(Key) {}
+
+    void Profile(llvm::FoldingSetNodeID &ID) const { ID = Key; }
+
+    /// The function template and the canonical deduced arguments.
+    llvm::FoldingSetNodeID Key;
+    /// The value of SubstitutionFailureGeneration when the substitution
+    /// started.
+    unsigned Generation = 0;
+    /// The invalid specialization, if one was formed.
+    FunctionDecl *Specialization = nullptr;
+    /// The diagnostic that caused the failure, if any.
+    Optional<PartialDiagnosticAt> Diagnostic;
+  };
+
+  llvm::FoldingSet<MemoizedSubstitutionFailure> SubstitutionFailures;
+  std::deque<MemoizedSubstitutionFailure> SubstitutionFailureStorage;
+
+  /// Incremented whenever a declaration or definition that a substitution
+  /// could depend on becomes available, which invalidates all memoized
+  /// substitution failures.
+  ///
+  /// Implicit instantiations don't need to invalidate them: a substitution
+  /// that depends on an instantiation performs it itself.
+  unsigned SubstitutionFailureGeneration = 0;
+
+  void invalidateSubstitutionFailures() { ++SubstitutionFailureGeneration; }
+
   /// A stack object to be created when performing template
   /// instantiation.
   ///
@@ -7706,6 +7744,15 @@ public:
   }
   void PrintInstantiationStack();
 
+  /// Whether -ftime-trace events for template instantiations should include
+  /// the stack of instantiations that required them.
+  bool TimeTraceTemplates = false;
+
+  /// Describe the synthesis of Entity (with template arguments Args, if
+  /// Entity is a template) for a -ftime-trace event.
+  std::string getTimeTraceDetail(const NamedDecl *Entity,
+                                 ArrayRef<TemplateArgument> Args = None);
+
   void PrintPragmaAttributeInstantiationPoint();
 
   /// Determines whether we are currently in a context where
@@ -73,6 +73,12 @@
 #include <utility>
 #include <vector>
 
+namespace llvm {
+
+class ThreadPool;
+
+} // namespace llvm
+
 namespace clang {
 
 class ASTConsumer;
@@ -930,6 +936,10 @@ private:
   /// Whether validate system input files.
   bool ValidateSystemInputs;
 
+  /// The threads checking the input files of module files concurrently,
+  /// created on first use.
+  std::unique_ptr<llvm::ThreadPool> InputFileValidationPool;
+
   /// Whether we are allowed to use the global module index.
   bool UseGlobalIndex;
 
@@ -1213,6 +1223,14 @@ private:
   /// Reads the stored information about an input file.
   InputFileInfo readInputFileInfo(ModuleFile &F, unsigned ID);
 
+  /// Determine whether the first \p NumInputs input files of \p F are known
+  /// to be unmodified, by checking them concurrently without creating file
+  /// entries.
+  ///
+  /// \returns false if any of them might be modified or if they can't be
+  /// checked this way, in which case getInputFile has to validate them.
+  bool haveUnmodifiedInputFiles(ModuleFile &F, unsigned NumInputs);
+
   /// Retrieve the file entry and 'overridden' bit for an input
   /// file in the given module file.
   serialization::InputFile getInputFile(ModuleFile &F, unsigned ID,
@@ -96,6 +96,10 @@ private:
   /// (This data is owned by AnalysisConsumer.)
   FunctionSummariesTy *FunctionSummaries;
 
+  /// The number of bytes the graph may allocate before the worklist algorithm
+  /// gives up, or 0 if there is no limit (see the max-memory option).
+  size_t MaxMemory;
+
   /// Add path note tags along the path when we see that something interesting
   /// is happening. This field is the allocator for such tags.
   NoteTag::Factory NoteTags;
@@ -0,0 +1,118 @@
+//===- CachingFileSystem.h - Shared file system cache for tools -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a file system layer that caches the status and the
+// contents of files in a cache shared by all the tool runs of a batch, so that
+// every header is only stat'ed and read once, no matter how many translation
+// units include it.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLING_CACHINGFILESYSTEM_H
+#define LLVM_CLANG_TOOLING_CACHINGFILESYSTEM_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/Support/ConcurrentStringMap.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace clang {
+namespace tooling {
+
+/// A cache of the status and the contents of files that is shared by the
+/// CachingFileSystems of many threads.
+///
+/// Entries are keyed by absolute path. Failed lookups are cached too, as most
+/// lookups during header search are probes of files that don't exist.
+class SharedFileSystemCache {
+public:
+  struct Statistics {
+    std::atomic<unsigned> StatusHits{0};
+    std::atomic<unsigned> StatusMisses{0};
+    std::atomic<unsigned> ContentsHits{0};
+    std::atomic<unsigned> ContentsMisses{0};
+  };
+
+  /// \param ValidateContents If true, the cached contents of a file are only
+  /// used after a fresh status of the file shows that its modification time
+  /// and size haven't changed. This costs one stat per open instead of the
+  /// open, read and close of a cache miss.
+  explicit SharedFileSystemCache(bool ValidateContents = true)
+      : ValidateContents(ValidateContents) {}
+
+  /// Re-stats every cached path through \p FS and drops the entries whose
+  /// status changed since they were cached, including paths that were missing
+  /// and that exist now.
+  ///
+  /// This must not be called while CachingFileSystems of this cache are used
+  /// on other threads.
+  ///
+  /// \returns The number of dropped entries.
+  unsigned invalidateChangedFiles(llvm::vfs::FileSystem &FS);
+
+  const Statistics &getStatistics() const { return Stats; }
+
+private:
+  friend class CachingFileSystem;
+
+  struct Entry {
+    std::mutex Lock;
+    /// Whether Status holds the result of a status call.
+    bool HasStatus = false;
+    llvm::ErrorOr<llvm::vfs::Status> Status = std::error_code();
+    /// The contents of the file if it was read, which were read when the file
+    /// had the modification time and size of Status. They are shared with the
+    /// buffers handed out by CachingFileSystem, so that dropping or replacing
+    /// them doesn't invalidate buffers that are still in use.
+    std::shared_ptr<llvm::MemoryBuffer> Contents;
+  };
+
+  llvm::ConcurrentStringMap<Entry> Entries;
+  Statistics Stats;
+  bool ValidateContents;
+};
+
+/// A file system that serves status and open requests from a
+/// SharedFileSystemCache, and forwards the misses to the underlying file
+/// system.
+///
+/// Each thread should use its own CachingFileSystem over its own underlying
+/// file system, so that threads can have different working directories. The
+/// underlying file systems of all CachingFileSystems that share a cache must
+/// agree on the contents of absolute paths.
+///
+/// Directory iteration and real path lookups aren't cached.
+class CachingFileSystem : public llvm::vfs::ProxyFileSystem {
+public:
+  CachingFileSystem(SharedFileSystemCache &Cache,
+                    IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS)
+      : ProxyFileSystem(std::move(FS)), Cache(Cache) {}
+
+  llvm::ErrorOr<llvm::vfs::Status> status(const Twine &Path) override;
+  llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+  openFileForRead(const Twine &Path) override;
+
+private:
+  /// Returns the entry of \p Path, which is made absolute and cleaned of dots
+  /// to form the key.
+  llvm::ErrorOr<SharedFileSystemCache::Entry *> getEntry(StringRef Path);
+
+  /// Stats \p Path with the underlying file system and records the result in
+  /// \p E, dropping its contents if the file changed.
+  void updateStatus(SharedFileSystemCache::Entry &E, StringRef Path);
+
+  SharedFileSystemCache &Cache;
+};
+
+} // end namespace tooling
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLING_CACHINGFILESYSTEM_H
@@ -0,0 +1,78 @@
+//===- DependencyScanningWorker.h - clang-scan-deps worker ------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_WORKER_H
+#define LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_WORKER_H
+
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/LLVM.h"
+#include "clang/Frontend/PCHContainerOperations.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/DependencyScanning/DependencyScanningService.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace tooling {
+namespace dependencies {
+
+/// The dependencies of the translation unit of a compile command.
+struct TranslationUnitDeps {
+  /// The main source file of the command.
+  std::string File;
+
+  /// The targets of the make rule. These are the -MT and -MQ targets of the
+  /// command, or else its output file.
+  std::vector<std::string> Targets;
+
+  /// The files that the translation unit depends on, in the order they were
+  /// first seen, starting with the main source file.
+  ///
+  /// System headers are only included if the command asks for them with -MD
+  /// or -M, or doesn't ask for a dependency file at all.
+  std::vector<std::string> Dependencies;
+};
+
+/// An individual dependency scanning worker that is able to run on its own
+/// thread.
+///
+/// The worker computes the dependencies for the input files by preprocessing
+/// sources either using a fast mode where the source files are minimized, or
+/// using the regular processing run. File system accesses of all workers of a
+/// service go through the service's shared cache.
+class DependencyScanningWorker {
+public:
+  DependencyScanningWorker(DependencyScanningService &Service);
+
+  /// Computes the dependencies of the translation unit of \p Command.
+  ///
+  /// \returns The dependencies, or an error with the diagnostics of the
+  /// command if it fails.
+  llvm::Expected<TranslationUnitDeps>
+  computeDependencies(const CompileCommand &Command);
+
+private:
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts;
+  std::shared_ptr<PCHContainerOperations> PCHContainerOps;
+
+  /// The physical filesystem under the caching one. It has its own working
+  /// directory, so workers on other threads aren't affected when it changes.
+  llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> RealFS;
+  /// The file system that is used by each worker when scanning for
+  /// dependencies. This filesystem persists across multiple compiler
+  /// invocations.
+  llvm::IntrusiveRefCntPtr<DependencyScanningWorkerFilesystem> DepFS;
+};
+
+} // end namespace dependencies
+} // end namespace tooling
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_WORKER_H
@@ -12,6 +12,7 @@
 
 #include "clang/AST/ASTContext.h"
 #include "CXXABI.h"
+#include "Interp/Context.h"
 #include "clang/AST/APValue.h"
 #include "clang/AST/ASTMutationListener.h"
 #include "clang/AST/ASTTypeTraits.h"
@@ -10024,6 +10025,12 @@ VTableContextBase *ASTContext::getVTableContext() {
   return VTContext.get();
 }
 
+interp::Context &ASTContext::getInterpContext() const {
+  if (!InterpContext)
+    InterpContext.reset(new interp::Context(const_cast<ASTContext &>(*this)));
+  return *InterpContext;
+}
+
 MangleContext *ASTContext::createMangleContext(const TargetInfo *T) {
   if (!T)
     T = Target;
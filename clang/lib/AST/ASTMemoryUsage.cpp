@@ -0,0 +1,185 @@
+//===- ASTMemoryUsage.cpp - Account for the memory used by an AST ---------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the ASTMemoryUsage class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ASTMemoryUsage.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Attr.h"
+#include "clang/AST/DeclContextInternals.h"
+#include "clang/AST/DeclFriend.h"
+#include "clang/AST/DeclObjC.h"
+#include "clang/AST/DeclOpenMP.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/AST/StmtCXX.h"
+#include "clang/AST/StmtObjC.h"
+#include "clang/AST/StmtOpenMP.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <vector>
+
+using namespace clang;
+
+namespace {
+
+/// Collects every Decl and Stmt reachable from the translation unit, once.
+struct NodeCollector : RecursiveASTVisitor<NodeCollector> {
+  llvm::DenseSet<const Decl *> Decls;
+  llvm::DenseSet<const Stmt *> Stmts;
+
+  bool shouldVisitTemplateInstantiations() const { return true; }
+  bool shouldVisitImplicitCode() const { return true; }
+
+  bool VisitDecl(Decl *D) {
+    Decls.insert(D);
+    return true;
+  }
+  bool VisitStmt(Stmt *S) {
+    Stmts.insert(S);
+    return true;
+  }
+};
+
+} // end anonymous namespace
+
+/// Return the name and size of the concrete class of \p D.
+static std::pair<StringRef, size_t> getDeclClass(const Decl &D) {
+  switch (D.getKind()) {
+#define DECL(DERIVED, BASE)                                                    \
+  case Decl::DERIVED:                                                          \
+    return {#DERIVED "Decl", sizeof(DERIVED##Decl)};
+#define ABSTRACT_DECL(DECL)
+#include "clang/AST/DeclNodes.inc"
+  }
+  llvm_unreachable("Unknown decl kind");
+}
+
+/// Return the name and size of the concrete class of \p S.
+static std::pair<StringRef, size_t> getStmtClass(const Stmt &S) {
+  switch (S.getStmtClass()) {
+  case Stmt::NoStmtClass:
+    break;
+#define STMT(CLASS, PARENT)                                                    \
+  case Stmt::CLASS##Class:                                                     \
+    return {#CLASS, sizeof(CLASS)};
+#define ABSTRACT_STMT(STMT)
+#include "clang/AST/StmtNodes.inc"
+  }
+  llvm_unreachable("Unknown stmt class");
+}
+
+/// Return the name and size of the concrete class of \p T.
+static std::pair<StringRef, size_t> getTypeClass(const Type &T) {
+  switch (T.getTypeClass()) {
+#define TYPE(Class, Base)                                                      \
+  case Type::Class:                                                            \
+    return {#Class "Type", sizeof(Class##Type)};
+#define ABSTRACT_TYPE(Class, Base)
+#include "clang/AST/TypeNodes.def"
+  }
+  llvm_unreachable("Unknown type class");
+}
+
+/// Return the name and size of the concrete class of \p A.
+static std::pair<StringRef, size_t> getAttrClass(const Attr &A) {
+  switch (A.getKind()) {
+#define ATTR(X)                                                                \
+  case attr::X:                                                                \
+    return {#X "Attr", sizeof(X##Attr)};
+#include "clang/Basic/AttrList.inc"
+  }
+  llvm_unreachable("Unknown attribute kind");
+}
+
+ASTMemoryUsage::ASTMemoryUsage(const ASTContext &Ctx)
+    : ArenaBytes(Ctx.getASTAllocatedMemory()) {
+  NodeCollector Collector;
+  Collector.TraverseDecl(Ctx.getTranslationUnitDecl());
+
+  for (const Decl *D : Collector.Decls) {
+    std::pair<StringRef, size_t> Class = getDeclClass(*D);
+    add(Class.first, 1, Class.second);
+    if (D->hasAttrs())
+      for (const Attr *A : D->getAttrs()) {
+        std::pair<StringRef, size_t> AttrClass = getAttrClass(*A);
+        add(AttrClass.first, 1, AttrClass.second);
+      }
+    if (const auto *DC = dyn_cast<DeclContext>(D))
+      addLookupTable(*DC);
+  }
+
+  for (const Stmt *S : Collector.Stmts) {
+    std::pair<StringRef, size_t> Class = getStmtClass(*S);
+    add(Class.first, 1, Class.second);
+  }
+
+  for (const Type *T : Ctx.getTypes()) {
+    std::pair<StringRef, size_t> Class = getTypeClass(*T);
+    add(Class.first, 1, Class.second);
+  }
+
+  add("ASTContext side tables", 1, Ctx.getSideTableAllocatedMemory());
+}
+
+void ASTMemoryUsage::add(StringRef Kind, uint64_t Count, uint64_t Bytes) {
+  Entry &E = Entries[Kind];
+  E.Count += Count;
+  E.Bytes += Bytes;
+}
+
+void ASTMemoryUsage::addLookupTable(const DeclContext &DC) {
+  // All redeclarations of a context share the table of the primary one.
+  if (DC.getPrimaryContext() != &DC)
+    return;
+  const StoredDeclsMap *Map = DC.getLookupPtr();
+  if (!Map)
+    return;
+
+  uint64_t Bytes = sizeof(StoredDeclsMap) + Map->getMemorySize();
+  for (const auto &Lookup : *Map)
+    if (const StoredDeclsList::DeclsTy *Vec = Lookup.second.getAsVector())
+      Bytes += sizeof(*Vec) + (Vec->capacity() > 4 ? capacity_in_bytes(*Vec)
+                                                   : 0);
+  add("DeclContext lookup table", 1, Bytes);
+  add("DeclContext lookup table entry", Map->size(), 0);
+}
+
+uint64_t ASTMemoryUsage::getTotalBytes() const {
+  uint64_t Total = 0;
+  for (const auto &E : Entries)
+    Total += E.second.Bytes;
+  return Total;
+}
+
+void ASTMemoryUsage::print(raw_ostream &OS) const {
+  std::vector<std::pair<StringRef, Entry>> Sorted;
+  for (const auto &E : Entries)
+    Sorted.push_back({E.first(), E.second});
+  llvm::sort(Sorted, [](const std::pair<StringRef, Entry> &LHS,
+                        const std::pair<StringRef, Entry> &RHS) {
+    if (LHS.second.Bytes != RHS.second.Bytes)
+      return LHS.second.Bytes > RHS.second.Bytes;
+    return LHS.first < RHS.first;
+  });
+
+  OS << "\n*** AST Memory Usage:\n"
+     << "       Count        Bytes  Kind\n";
+  for (const auto &E : Sorted)
+    OS << llvm::format("%12" PRIu64 " %12" PRIu64 "  ", E.second.Count,
+                       E.second.Bytes)
+       << E.first << '\n';
+  OS << std::string(12, ' ')
+     << llvm::format(" %12" PRIu64 "  ", getTotalBytes()) << "Total\n"
+     << std::string(12, ' ') << llvm::format(" %12" PRIu64 "  ", ArenaBytes)
+     << "Allocated by the ASTContext arena\n";
+}
@@ -32,6 +32,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "Interp/Context.h"
 #include "clang/AST/APValue.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTDiagnostic.h"
@@ -11801,12 +11802,27 @@ static bool hasUnacceptableSideEffect(Expr::EvalStatus &Result,
          (SEK < Expr::SE_AllowUndefinedBehavior && Result.HasUndefinedBehavior);
 }
 
+/// Try to evaluate the prvalue E with the bytecode interpreter enabled by
+/// -fexperimental-new-constant-interpreter. If this fails, either because E
+/// uses a construct the interpreter does not support or because its
+/// evaluation fails, the tree walker must be used instead; it also produces
+/// the diagnostics.
+static bool EvaluateWithInterpreter(const ASTContext &Ctx, const Expr *E,
+                                    APValue &Result) {
+  if (!Ctx.getLangOpts().EnableNewConstInterp || !E->isRValue())
+    return false;
+  return Ctx.getInterpContext().evaluateAsRValue(E, Result);
+}
+
 static bool EvaluateAsRValue(const Expr *E, Expr::EvalResult &Result,
                              const ASTContext &Ctx, EvalInfo &Info) {
   bool IsConst;
   if (FastEvaluateAsRValue(E, Result, Ctx, IsConst))
     return IsConst;
 
+  if (EvaluateWithInterpreter(Ctx, E, Result.Val))
+    return true;
+
   return EvaluateAsRValue(Info, E, Result.Val);
 }
 
@@ -11920,6 +11936,9 @@ bool Expr::EvaluateAsConstantExpr(EvalResult &Result, ConstExprUsage Usage,
   assert(!isValueDependent() &&
          "Expression evaluator can't be called on a dependent expression.");
 
+  if (EvaluateWithInterpreter(Ctx, this, Result.Val))
+    return true;
+
   EvalInfo::EvaluationMode EM = EvalInfo::EM_ConstantExpression;
   EvalInfo Info(Ctx, Result, EM);
   Info.InConstantContext = true;
@@ -11943,6 +11962,10 @@ bool Expr::EvaluateAsInitializer(APValue &Value, const ASTContext &Ctx,
       !Ctx.getLangOpts().CPlusPlus11)
     return false;
 
+  if (Ctx.hasSameUnqualifiedType(getType(), VD->getType()) &&
+      EvaluateWithInterpreter(Ctx, this, Value))
+    return true;
+
   Expr::EvalStatus EStatus;
   EStatus.Diag = &Notes;
 
@@ -12565,13 +12588,16 @@ bool Expr::isCXX11ConstantExpr(const ASTContext &Ctx, APValue *Result,
   // issues.
   assert(Ctx.getLangOpts().CPlusPlus);
 
+  APValue Scratch;
+  if (EvaluateWithInterpreter(Ctx, this, Result ? *Result : Scratch))
+    return true;
+
   // Build evaluation settings.
   Expr::EvalStatus Status;
   SmallVector<PartialDiagnosticAt, 8> Diags;
   Status.Diag = &Diags;
   EvalInfo Info(Ctx, Status, EvalInfo::EM_ConstantExpression);
 
-  APValue Scratch;
   bool IsConstExpr = ::EvaluateAsRValue(Info, this, Result ? *Result : Scratch);
 
   if (!Diags.empty()) {
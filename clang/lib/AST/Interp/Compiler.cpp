@@ -0,0 +1,649 @@
+//===--- Compiler.cpp - Bytecode compiler of the constant interpreter -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "Compiler.h"
+#include "Context.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/StmtCXX.h"
+#include "llvm/ADT/APSInt.h"
+
+using namespace clang;
+using namespace clang::interp;
+
+bool Compiler::compileFunction(const FunctionDecl *FD, const Stmt *Body) {
+  for (unsigned I = 0, N = FD->getNumParams(); I != N; ++I) {
+    const ParmVarDecl *PVD = FD->getParamDecl(I);
+    IntType T;
+    if (!getType(PVD->getType(), T))
+      return false;
+    Locals[PVD] = I;
+  }
+  if (!visitStmt(Body))
+    return false;
+  // Flowing off the end of a constexpr function is not a constant
+  // expression; let the tree walker diagnose it.
+  emitOp(Opcode::NoReturn);
+  return true;
+}
+
+bool Compiler::compileExpr(const Expr *E) {
+  if (!visitExpr(E))
+    return false;
+  emitOp(Opcode::Ret);
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Statements
+//===----------------------------------------------------------------------===//
+
+bool Compiler::visitStmt(const Stmt *S) {
+  // Like the tree walker, charge one step for each evaluated statement.
+  ++PendingSteps;
+
+  if (const auto *E = dyn_cast<Expr>(S))
+    return visitDiscarded(E);
+
+  switch (S->getStmtClass()) {
+  case Stmt::NullStmtClass:
+    return true;
+
+  case Stmt::CompoundStmtClass:
+    for (const Stmt *Child : cast<CompoundStmt>(S)->body())
+      if (!visitStmt(Child))
+        return false;
+    return true;
+
+  case Stmt::AttributedStmtClass:
+    return visitStmt(cast<AttributedStmt>(S)->getSubStmt());
+
+  case Stmt::DeclStmtClass:
+    for (const Decl *D : cast<DeclStmt>(S)->decls()) {
+      // Declarations other than variables have no effect on evaluation.
+      if (const auto *VD = dyn_cast<VarDecl>(D))
+        if (!visitVarDecl(VD))
+          return false;
+    }
+    return true;
+
+  case Stmt::ReturnStmtClass: {
+    const Expr *RetValue = cast<ReturnStmt>(S)->getRetValue();
+    if (!RetValue || !visitExpr(RetValue))
+      return false;
+    emitOp(Opcode::Ret);
+    return true;
+  }
+
+  case Stmt::IfStmtClass: {
+    const auto *IS = cast<IfStmt>(S);
+    if (IS->getInit() || IS->getConditionVariable() ||
+        !visitExpr(IS->getCond()))
+      return false;
+    size_t ToElse = emitJump(Opcode::Jf);
+    if (IS->getThen() && !visitStmt(IS->getThen()))
+      return false;
+    if (const Stmt *Else = IS->getElse()) {
+      size_t ToEnd = emitJump(Opcode::Jmp);
+      patchJump(ToElse);
+      if (!visitStmt(Else))
+        return false;
+      patchJump(ToEnd);
+    } else {
+      patchJump(ToElse);
+    }
+    return true;
+  }
+
+  case Stmt::WhileStmtClass: {
+    const auto *WS = cast<WhileStmt>(S);
+    if (WS->getConditionVariable())
+      return false;
+    size_t Cond = bindLabel();
+    if (!visitExpr(WS->getCond()))
+      return false;
+    size_t ToEnd = emitJump(Opcode::Jf);
+    LoopScope Scope;
+    if (!visitLoopBody(WS->getBody(), Scope))
+      return false;
+    emitJump(Opcode::Jmp, Cond);
+    patchJump(ToEnd);
+    for (size_t Pos : Scope.Breaks)
+      patchJump(Pos);
+    for (size_t Pos : Scope.Continues)
+      patchJump(Pos, Cond);
+    return true;
+  }
+
+  case Stmt::DoStmtClass: {
+    const auto *DS = cast<DoStmt>(S);
+    size_t Body = bindLabel();
+    LoopScope Scope;
+    if (!visitLoopBody(DS->getBody(), Scope))
+      return false;
+    for (size_t Pos : Scope.Continues)
+      patchJump(Pos);
+    if (!visitExpr(DS->getCond()))
+      return false;
+    emitJump(Opcode::Jt, Body);
+    for (size_t Pos : Scope.Breaks)
+      patchJump(Pos);
+    return true;
+  }
+
+  case Stmt::ForStmtClass: {
+    const auto *FS = cast<ForStmt>(S);
+    if (FS->getConditionVariable())
+      return false;
+    if (FS->getInit() && !visitStmt(FS->getInit()))
+      return false;
+    size_t Cond = bindLabel();
+    size_t ToEnd = 0;
+    if (const Expr *CondExpr = FS->getCond()) {
+      if (!visitExpr(CondExpr))
+        return false;
+      ToEnd = emitJump(Opcode::Jf);
+    }
+    LoopScope Scope;
+    if (!visitLoopBody(FS->getBody(), Scope))
+      return false;
+    for (size_t Pos : Scope.Continues)
+      patchJump(Pos);
+    if (FS->getInc() && !visitDiscarded(FS->getInc()))
+      return false;
+    emitJump(Opcode::Jmp, Cond);
+    if (FS->getCond())
+      patchJump(ToEnd);
+    for (size_t Pos : Scope.Breaks)
+      patchJump(Pos);
+    return true;
+  }
+
+  case Stmt::BreakStmtClass:
+    if (!CurLoop)
+      return false;
+    CurLoop->Breaks.push_back(emitJump(Opcode::Jmp));
+    return true;
+
+  case Stmt::ContinueStmtClass:
+    if (!CurLoop)
+      return false;
+    CurLoop->Continues.push_back(emitJump(Opcode::Jmp));
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+bool Compiler::visitLoopBody(const Stmt *Body, LoopScope &Scope) {
+  LoopScope *Outer = CurLoop;
+  CurLoop = &Scope;
+  bool Result = visitStmt(Body);
+  CurLoop = Outer;
+  return Result;
+}
+
+bool Compiler::visitVarDecl(const VarDecl *VD) {
+  IntType T;
+  if (!VD->hasLocalStorage() || VD->isInvalidDecl() ||
+      VD->getType().isVolatileQualified() || !getType(VD->getType(), T))
+    return false;
+
+  // The variable is only added to the scope after its initializer, so that
+  // an initializer referring to the variable itself is left to the tree
+  // walker.
+  unsigned Slot = F.NumLocals++;
+  if (const Expr *Init = VD->getInit()) {
+    if (!visitExpr(Init))
+      return false;
+    emitOp(Opcode::SetLocal);
+  } else {
+    emitOp(Opcode::ClearLocal);
+  }
+  emitImm<uint32_t>(Slot);
+  Locals[VD] = Slot;
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Expressions
+//===----------------------------------------------------------------------===//
+
+bool Compiler::visitExpr(const Expr *E) {
+  IntType T;
+  if (E->isValueDependent() || !getType(E->getType(), T))
+    return false;
+
+  switch (E->getStmtClass()) {
+  case Stmt::IntegerLiteralClass:
+    emitConst(cast<IntegerLiteral>(E)->getValue(), T);
+    return true;
+  case Stmt::CharacterLiteralClass:
+    emitConst(T.normalize(cast<CharacterLiteral>(E)->getValue()));
+    return true;
+  case Stmt::CXXBoolLiteralExprClass:
+    emitConst(cast<CXXBoolLiteralExpr>(E)->getValue());
+    return true;
+  case Stmt::CXXNoexceptExprClass:
+    emitConst(cast<CXXNoexceptExpr>(E)->getValue());
+    return true;
+  case Stmt::TypeTraitExprClass:
+    emitConst(cast<TypeTraitExpr>(E)->getValue());
+    return true;
+  case Stmt::ImplicitValueInitExprClass:
+  case Stmt::CXXScalarValueInitExprClass:
+    emitConst(0);
+    return true;
+
+  case Stmt::ParenExprClass:
+    return visitExpr(cast<ParenExpr>(E)->getSubExpr());
+  case Stmt::ConstantExprClass:
+    return visitExpr(cast<ConstantExpr>(E)->getSubExpr());
+  case Stmt::ExprWithCleanupsClass:
+    return visitExpr(cast<ExprWithCleanups>(E)->getSubExpr());
+  case Stmt::SubstNonTypeTemplateParmExprClass:
+    return visitExpr(cast<SubstNonTypeTemplateParmExpr>(E)->getReplacement());
+  case Stmt::CXXDefaultArgExprClass:
+    return visitExpr(cast<CXXDefaultArgExpr>(E)->getExpr());
+
+  case Stmt::InitListExprClass: {
+    const auto *ILE = cast<InitListExpr>(E);
+    if (ILE->getNumInits() == 0) {
+      emitConst(0);
+      return true;
+    }
+    return ILE->getNumInits() == 1 && visitExpr(ILE->getInit(0));
+  }
+
+  case Stmt::DeclRefExprClass: {
+    const ValueDecl *D = cast<DeclRefExpr>(E)->getDecl();
+    if (const auto *ECD = dyn_cast<EnumConstantDecl>(D)) {
+      // Reinterpret the value in the type of the expression, as the tree
+      // walker does.
+      llvm::APSInt Value = ECD->getInitVal();
+      Value.setIsSigned(T.Signed);
+      emitConst(Value.extOrTrunc(T.Width), T);
+      return true;
+    }
+    const auto *VD = dyn_cast<VarDecl>(D);
+    if (!VD)
+      return false;
+    unsigned Slot;
+    IntType LocalT;
+    if (getLocal(E, Slot, LocalT)) {
+      emitOp(Opcode::GetLocal);
+      emitImm<uint32_t>(Slot);
+      return true;
+    }
+    // Locals of other frames, such as those of a call the tree walker is
+    // evaluating, are not accessible.
+    IntType VarT;
+    if (VD->hasLocalStorage() || !getType(VD->getType(), VarT))
+      return false;
+    emitOp(Opcode::GetGlobal);
+    emitImm<const void *>(VD);
+    return true;
+  }
+
+  case Stmt::UnaryExprOrTypeTraitExprClass: {
+    const auto *UE = cast<UnaryExprOrTypeTraitExpr>(E);
+    if (UE->getKind() != UETT_SizeOf)
+      return false;
+    QualType ArgTy = UE->getTypeOfArgument();
+    if (const auto *Ref = ArgTy->getAs<ReferenceType>())
+      ArgTy = Ref->getPointeeType();
+    // sizeof(void) and sizeof of a function are extensions, and variably
+    // modified types have no constant size.
+    if (ArgTy->isVoidType() || ArgTy->isFunctionType() ||
+        ArgTy->isDependentType() || ArgTy->isIncompleteType() ||
+        !ArgTy->isConstantSizeType())
+      return false;
+    emitConst(T.normalize(
+        Ctx.getASTContext().getTypeSizeInChars(ArgTy).getQuantity()));
+    return true;
+  }
+
+  case Stmt::ConditionalOperatorClass: {
+    const auto *CO = cast<ConditionalOperator>(E);
+    if (!visitExpr(CO->getCond()))
+      return false;
+    size_t ToFalse = emitJump(Opcode::Jf);
+    if (!visitExpr(CO->getTrueExpr()))
+      return false;
+    size_t ToEnd = emitJump(Opcode::Jmp);
+    patchJump(ToFalse);
+    if (!visitExpr(CO->getFalseExpr()))
+      return false;
+    patchJump(ToEnd);
+    return true;
+  }
+
+  case Stmt::CallExprClass:
+    return visitCall(cast<CallExpr>(E));
+
+  case Stmt::UnaryOperatorClass:
+    return visitUnaryOperator(cast<UnaryOperator>(E), T);
+  case Stmt::BinaryOperatorClass:
+    return visitBinaryOperator(cast<BinaryOperator>(E), T);
+  case Stmt::CompoundAssignOperatorClass:
+    return visitCompoundAssign(cast<CompoundAssignOperator>(E));
+
+  case Stmt::ImplicitCastExprClass:
+  case Stmt::CStyleCastExprClass:
+  case Stmt::CXXFunctionalCastExprClass:
+  case Stmt::CXXStaticCastExprClass:
+    return visitCast(cast<CastExpr>(E), T);
+
+  default:
+    return false;
+  }
+}
+
+bool Compiler::visitDiscarded(const Expr *E) {
+  if (E->getType()->isVoidType()) {
+    const auto *CE = dyn_cast<CastExpr>(E->IgnoreParens());
+    return CE && CE->getCastKind() == CK_ToVoid &&
+           visitDiscarded(CE->getSubExpr());
+  }
+  if (!visitExpr(E))
+    return false;
+  emitOp(Opcode::Pop);
+  return true;
+}
+
+bool Compiler::visitCast(const CastExpr *E, IntType T) {
+  const Expr *SubExpr = E->getSubExpr();
+  switch (E->getCastKind()) {
+  case CK_LValueToRValue:
+  case CK_NoOp:
+    return visitExpr(SubExpr);
+
+  case CK_IntegralCast:
+  case CK_IntegralToBoolean:
+    if (!visitExpr(SubExpr))
+      return false;
+    emitConversion(E->getType(), T);
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+bool Compiler::visitUnaryOperator(const UnaryOperator *E, IntType T) {
+  const Expr *SubExpr = E->getSubExpr();
+  switch (E->getOpcode()) {
+  case UO_Plus:
+  case UO_Extension:
+    return visitExpr(SubExpr);
+  case UO_Minus:
+    if (!visitExpr(SubExpr))
+      return false;
+    emitOp(Opcode::Neg, T);
+    return true;
+  case UO_Not:
+    if (!visitExpr(SubExpr))
+      return false;
+    emitOp(Opcode::Comp, T);
+    return true;
+  case UO_LNot:
+    if (!visitExpr(SubExpr))
+      return false;
+    emitOp(Opcode::LNot);
+    return true;
+
+  case UO_PreInc:
+  case UO_PreDec:
+  case UO_PostInc:
+  case UO_PostDec: {
+    unsigned Slot;
+    IntType LocalT;
+    if (!getLocal(SubExpr, Slot, LocalT) ||
+        SubExpr->getType()->isBooleanType())
+      return false;
+    bool IsPrefix = E->isPrefix();
+    emitOp(Opcode::GetLocal);
+    emitImm<uint32_t>(Slot);
+    // The result of a postfix operator is the old value.
+    if (!IsPrefix)
+      emitOp(Opcode::Dup);
+    emitConst(1);
+    emitOp(E->isIncrementOp() ? Opcode::Add : Opcode::Sub, LocalT);
+    if (IsPrefix)
+      emitOp(Opcode::Dup);
+    emitOp(Opcode::SetLocal);
+    emitImm<uint32_t>(Slot);
+    return true;
+  }
+
+  default:
+    return false;
+  }
+}
+
+bool Compiler::visitBinaryOperator(const BinaryOperator *E, IntType T) {
+  const Expr *LHS = E->getLHS();
+  const Expr *RHS = E->getRHS();
+  BinaryOperatorKind Opc = E->getOpcode();
+
+  switch (Opc) {
+  case BO_Comma:
+    return visitDiscarded(LHS) && visitExpr(RHS);
+
+  case BO_Assign: {
+    unsigned Slot;
+    IntType LocalT;
+    if (!getLocal(LHS, Slot, LocalT) || !visitExpr(RHS))
+      return false;
+    emitOp(Opcode::Dup);
+    emitOp(Opcode::SetLocal);
+    emitImm<uint32_t>(Slot);
+    return true;
+  }
+
+  case BO_LAnd:
+  case BO_LOr: {
+    // Short-circuit: if the normalized LHS decides the result, leave it on
+    // the stack, otherwise replace it with the normalized RHS.
+    if (!visitExpr(LHS))
+      return false;
+    emitOp(Opcode::ToBool);
+    emitOp(Opcode::Dup);
+    size_t ToEnd = emitJump(Opc == BO_LAnd ? Opcode::Jf : Opcode::Jt);
+    emitOp(Opcode::Pop);
+    if (!visitExpr(RHS))
+      return false;
+    emitOp(Opcode::ToBool);
+    patchJump(ToEnd);
+    return true;
+  }
+
+  case BO_EQ:
+  case BO_NE:
+  case BO_LT:
+  case BO_LE:
+  case BO_GT:
+  case BO_GE: {
+    IntType OperandT;
+    if (!getType(LHS->getType(), OperandT) || !visitExpr(LHS) ||
+        !visitExpr(RHS))
+      return false;
+    static const Opcode Ops[] = {Opcode::LT, Opcode::GT, Opcode::LE,
+                                 Opcode::GE, Opcode::EQ, Opcode::NE};
+    emitOp(Ops[Opc - BO_LT], OperandT);
+    return true;
+  }
+
+  default:
+    if (!visitExpr(LHS) || !visitExpr(RHS))
+      return false;
+    return emitBinaryOp(Opc, T);
+  }
+}
+
+bool Compiler::visitCompoundAssign(const CompoundAssignOperator *E) {
+  unsigned Slot;
+  IntType LocalT, ComputationT;
+  if (!getLocal(E->getLHS(), Slot, LocalT) ||
+      !getType(E->getComputationLHSType(), ComputationT) ||
+      !getType(E->getComputationResultType(), ComputationT))
+    return false;
+
+  emitOp(Opcode::GetLocal);
+  emitImm<uint32_t>(Slot);
+  emitConversion(E->getComputationLHSType(), ComputationT);
+  if (!visitExpr(E->getRHS()) ||
+      !emitBinaryOp(BinaryOperator::getOpForCompoundAssignment(E->getOpcode()),
+                    ComputationT))
+    return false;
+  emitConversion(E->getLHS()->getType(), LocalT);
+  emitOp(Opcode::Dup);
+  emitOp(Opcode::SetLocal);
+  emitImm<uint32_t>(Slot);
+  return true;
+}
+
+bool Compiler::visitCall(const CallExpr *E) {
+  // Only direct calls of constexpr functions taking and returning integers
+  // are supported; the callee is compiled on first execution.
+  const FunctionDecl *FD = E->getDirectCallee();
+  if (!FD || !isa<DeclRefExpr>(E->getCallee()->IgnoreParenImpCasts()) ||
+      !FD->isConstexpr() || FD->getBuiltinID() || FD->isVariadic() ||
+      E->getNumArgs() != FD->getNumParams())
+    return false;
+  if (const auto *MD = dyn_cast<CXXMethodDecl>(FD))
+    if (!MD->isStatic())
+      return false;
+
+  IntType ReturnT;
+  if (!getType(FD->getReturnType(), ReturnT))
+    return false;
+  for (unsigned I = 0, N = E->getNumArgs(); I != N; ++I) {
+    IntType ParamT;
+    if (!getType(FD->getParamDecl(I)->getType(), ParamT) ||
+        !visitExpr(E->getArg(I)))
+      return false;
+  }
+  emitOp(Opcode::Call);
+  emitImm<const void *>(FD);
+  return true;
+}
+
+bool Compiler::getLocal(const Expr *E, unsigned &Slot, IntType &T) {
+  const auto *DRE = dyn_cast<DeclRefExpr>(E->IgnoreParens());
+  if (!DRE)
+    return false;
+  const auto *VD = dyn_cast<VarDecl>(DRE->getDecl());
+  if (!VD)
+    return false;
+  auto It = Locals.find(VD);
+  if (It == Locals.end())
+    return false;
+  Slot = It->second;
+  return getType(VD->getType(), T);
+}
+
+bool Compiler::getType(QualType Ty, IntType &T) {
+  return Ctx.getIntType(Ty, T);
+}
+
+//===----------------------------------------------------------------------===//
+// Code emission
+//===----------------------------------------------------------------------===//
+
+void Compiler::flushSteps() {
+  if (!PendingSteps)
+    return;
+  F.Code.push_back(char(Opcode::Step));
+  emitImm<uint32_t>(PendingSteps);
+  PendingSteps = 0;
+}
+
+void Compiler::emitOp(Opcode Op) {
+  // The steps of the statements starting here are charged before their
+  // first instruction.
+  flushSteps();
+  F.Code.push_back(char(Op));
+}
+
+void Compiler::emitOp(Opcode Op, IntType T) {
+  emitOp(Op);
+  emitImm<uint8_t>(T.encode());
+}
+
+void Compiler::emitConst(int64_t Value) {
+  emitOp(Opcode::Const);
+  emitImm<int64_t>(Value);
+}
+
+void Compiler::emitConst(const llvm::APInt &Value, IntType T) {
+  emitConst(T.Signed ? Value.getSExtValue() : int64_t(Value.getZExtValue()));
+}
+
+void Compiler::emitConversion(QualType To, IntType T) {
+  if (To->isBooleanType())
+    emitOp(Opcode::ToBool);
+  else
+    emitOp(Opcode::Cast, T);
+}
+
+bool Compiler::emitBinaryOp(BinaryOperatorKind Opc, IntType T) {
+  Opcode Op;
+  switch (Opc) {
+  case BO_Mul: Op = Opcode::Mul; break;
+  case BO_Div: Op = Opcode::Div; break;
+  case BO_Rem: Op = Opcode::Rem; break;
+  case BO_Add: Op = Opcode::Add; break;
+  case BO_Sub: Op = Opcode::Sub; break;
+  case BO_Shl: Op = Opcode::Shl; break;
+  case BO_Shr: Op = Opcode::Shr; break;
+  case BO_And: Op = Opcode::And; break;
+  case BO_Xor: Op = Opcode::Xor; break;
+  case BO_Or: Op = Opcode::Or; break;
+  default:
+    return false;
+  }
+  emitOp(Op, T);
+  return true;
+}
+
+template <typename T> void Compiler::emitImm(T Value) {
+  const char *Bytes = reinterpret_cast<const char *>(&Value);
+  F.Code.insert(F.Code.end(), Bytes, Bytes + sizeof(T));
+}
+
+size_t Compiler::emitJump(Opcode Op) {
+  emitOp(Op);
+  size_t Pos = F.Code.size();
+  emitImm<int32_t>(0);
+  return Pos;
+}
+
+void Compiler::emitJump(Opcode Op, size_t Target) {
+  emitOp(Op);
+  emitImm<int32_t>(int32_t(Target - (F.Code.size() + sizeof(int32_t))));
+}
+
+void Compiler::patchJump(size_t Pos) {
+  // A label must not absorb the steps of a statement preceding it.
+  flushSteps();
+  patchJump(Pos, F.Code.size());
+}
+
+void Compiler::patchJump(size_t Pos, size_t Target) {
+  int32_t Rel = int32_t(Target - (Pos + sizeof(int32_t)));
+  std::memcpy(&F.Code[Pos], &Rel, sizeof(Rel));
+}
+
+size_t Compiler::bindLabel() {
+  flushSteps();
+  return F.Code.size();
+}
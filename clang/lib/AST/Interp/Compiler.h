@@ -0,0 +1,119 @@
+//===--- Compiler.h - Bytecode compiler for the interpreter -----*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Defines the compiler from the AST of constexpr functions and expressions to
+// the bytecode executed by the constant interpreter.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_AST_INTERP_COMPILER_H
+#define LLVM_CLANG_AST_INTERP_COMPILER_H
+
+#include "Function.h"
+#include "clang/AST/OperationKinds.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace llvm {
+class APInt;
+}
+
+namespace clang {
+class BinaryOperator;
+class CallExpr;
+class CastExpr;
+class CompoundAssignOperator;
+class Expr;
+class QualType;
+class Stmt;
+class UnaryOperator;
+class VarDecl;
+
+namespace interp {
+class Context;
+
+/// Compiles a single function body or expression into a Function.
+///
+/// All visit methods return false if they encounter a construct that the
+/// interpreter does not support, in which case the partially emitted code
+/// must be discarded.
+class Compiler {
+public:
+  Compiler(Context &Ctx, Function &F) : Ctx(Ctx), F(F) {}
+
+  /// Compile the body of the definition FD. The parameters of FD occupy the
+  /// first local slots.
+  bool compileFunction(const FunctionDecl *FD, const Stmt *Body);
+
+  /// Compile the prvalue E into code returning its value.
+  bool compileExpr(const Expr *E);
+
+private:
+  struct LoopScope {
+    llvm::SmallVector<size_t, 4> Breaks;
+    llvm::SmallVector<size_t, 4> Continues;
+  };
+
+  bool visitStmt(const Stmt *S);
+  bool visitVarDecl(const VarDecl *VD);
+  bool visitLoopBody(const Stmt *Body, LoopScope &Scope);
+
+  /// Emit code pushing the value of E. Glvalues are only supported if they
+  /// designate a local or a constant global variable, in which case the value
+  /// of the variable is pushed after evaluating E.
+  bool visitExpr(const Expr *E);
+  /// Emit code evaluating E for its side effects only.
+  bool visitDiscarded(const Expr *E);
+  bool visitCast(const CastExpr *E, IntType T);
+  bool visitUnaryOperator(const UnaryOperator *E, IntType T);
+  bool visitBinaryOperator(const BinaryOperator *E, IntType T);
+  bool visitCompoundAssign(const CompoundAssignOperator *E);
+  bool visitCall(const CallExpr *E);
+
+  /// If E designates a local variable, return its slot and type.
+  bool getLocal(const Expr *E, unsigned &Slot, IntType &T);
+  bool getType(QualType Ty, IntType &T);
+
+  void emitOp(Opcode Op);
+  void emitOp(Opcode Op, IntType T);
+  void emitConst(int64_t Value);
+  void emitConst(const llvm::APInt &Value, IntType T);
+  /// Emit a conversion of the value on top of the stack to type To.
+  void emitConversion(QualType To, IntType T);
+  /// Emit a binary arithmetic instruction in type T.
+  bool emitBinaryOp(BinaryOperatorKind Opc, IntType T);
+  template <typename T> void emitImm(T Value);
+
+  /// Emit a forward jump and return the position of its displacement.
+  size_t emitJump(Opcode Op);
+  /// Emit a jump to the already bound label Target.
+  void emitJump(Opcode Op, size_t Target);
+  /// Bind the forward jump at Pos to the current position.
+  void patchJump(size_t Pos);
+  /// Bind the forward jump at Pos to the label Target.
+  void patchJump(size_t Pos, size_t Target);
+  /// Return the current position as a jump target.
+  size_t bindLabel();
+  void flushSteps();
+
+  Context &Ctx;
+  Function &F;
+
+  /// The slots of the parameters and local variables in scope.
+  llvm::DenseMap<const VarDecl *, unsigned> Locals;
+  /// The innermost enclosing loop, if any.
+  LoopScope *CurLoop = nullptr;
+  /// The number of statements whose evaluation starts at the current
+  /// position, not yet accounted for by a Step instruction.
+  unsigned PendingSteps = 0;
+};
+
+} // namespace interp
+} // namespace clang
+
+#endif
@@ -0,0 +1,76 @@
+//===--- Context.cpp - Context of the constant interpreter ----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "Context.h"
+#include "Compiler.h"
+#include "Interp.h"
+#include "clang/AST/APValue.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/Expr.h"
+#include "llvm/ADT/APSInt.h"
+
+using namespace clang;
+using namespace clang::interp;
+
+Context::Context(ASTContext &Ctx) : Ctx(Ctx) {}
+
+Context::~Context() {}
+
+bool Context::evaluateAsRValue(const Expr *E, APValue &Result) {
+  IntType T;
+  // OpenCL gives shifts different semantics.
+  if (Ctx.getLangOpts().OpenCL || !E->isRValue() ||
+      !getIntType(E->getType(), T))
+    return false;
+
+  Function Entry(/*Decl=*/nullptr, /*NumParams=*/0);
+  int64_t Value;
+  if (!Compiler(*this, Entry).compileExpr(E) ||
+      !interpret(*this, Entry, Value))
+    return false;
+
+  Result = APValue(llvm::APSInt(
+      llvm::APInt(T.Width, uint64_t(Value), T.Signed), !T.Signed));
+  return true;
+}
+
+const Function *Context::getFunction(const FunctionDecl *FD) {
+  FD = FD->getCanonicalDecl();
+  auto It = Functions.find(FD);
+  if (It != Functions.end())
+    return It->second.get();
+
+  // The definition may still be provided (or instantiated) later, so a
+  // missing body is not cached.
+  const FunctionDecl *Definition = nullptr;
+  const Stmt *Body = FD->getBody(Definition);
+  if (!Body)
+    return nullptr;
+
+  std::unique_ptr<Function> Func;
+  if (Definition->isConstexpr() && !Definition->isInvalidDecl() &&
+      !isa<CXXConstructorDecl>(Definition) &&
+      !isa<CXXDestructorDecl>(Definition)) {
+    Func = llvm::make_unique<Function>(Definition, Definition->getNumParams());
+    if (!Compiler(*this, *Func).compileFunction(Definition, Body))
+      Func.reset();
+  }
+  return (Functions[FD] = std::move(Func)).get();
+}
+
+bool Context::getIntType(QualType T, IntType &Result) const {
+  if (!T->isIntegralOrEnumerationType())
+    return false;
+  unsigned Width = Ctx.getIntWidth(T);
+  if (Width == 0 || Width > 64)
+    return false;
+  Result.Width = Width;
+  Result.Signed = T->isSignedIntegerOrEnumerationType();
+  return true;
+}
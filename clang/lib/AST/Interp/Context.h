@@ -0,0 +1,75 @@
+//===--- Context.h - Context of the constant interpreter --------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Defines the entry point of the experimental constant interpreter, enabled by
+// -fexperimental-new-constant-interpreter.
+//
+// Instead of walking the AST of a constexpr function body on every call, the
+// interpreter compiles the body to bytecode once, caches it per function, and
+// runs it on a stack machine. Only a subset of the language is supported:
+// integer, enumeration and boolean arithmetic, local variables, the usual
+// structured control flow, and calls to constexpr functions taking and
+// returning such values. Any construct outside of that subset, as well as any
+// evaluation that fails, is rejected so that the caller falls back to the
+// tree-walking evaluator in ExprConstant.cpp, which produces the diagnostics.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_AST_INTERP_CONTEXT_H
+#define LLVM_CLANG_AST_INTERP_CONTEXT_H
+
+#include "Function.h"
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include <memory>
+
+namespace clang {
+class APValue;
+class ASTContext;
+class Expr;
+class FunctionDecl;
+class QualType;
+
+namespace interp {
+
+/// Holds the bytecode compiled for the functions of a translation unit.
+class Context {
+public:
+  Context(ASTContext &Ctx);
+  ~Context();
+
+  /// Evaluate the prvalue E of integral or enumeration type.
+  ///
+  /// \returns true and sets \p Result on success. Returns false, leaving
+  /// \p Result untouched, both if E uses a construct which the interpreter
+  /// does not support and if its evaluation fails; the caller should then
+  /// evaluate E with the tree-walking evaluator.
+  bool evaluateAsRValue(const Expr *E, APValue &Result);
+
+  /// Return the bytecode of FD, compiling it on first use, or null if FD
+  /// cannot be run by the interpreter.
+  const Function *getFunction(const FunctionDecl *FD);
+
+  /// Return the representation of values of type T, or false if T is not
+  /// supported by the interpreter.
+  bool getIntType(QualType T, IntType &Result) const;
+
+  ASTContext &getASTContext() const { return Ctx; }
+
+private:
+  ASTContext &Ctx;
+
+  /// The compiled functions, keyed by canonical declaration. Functions whose
+  /// definition cannot be compiled map to null.
+  llvm::DenseMap<const FunctionDecl *, std::unique_ptr<Function>> Functions;
+};
+
+} // namespace interp
+} // namespace clang
+
+#endif
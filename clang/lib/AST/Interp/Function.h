@@ -0,0 +1,103 @@
+//===--- Function.h - Bytecode of the constant interpreter ------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Defines the bytecode representation of a compiled constexpr function or
+// expression.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_AST_INTERP_FUNCTION_H
+#define LLVM_CLANG_AST_INTERP_FUNCTION_H
+
+#include "clang/Basic/LLVM.h"
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace clang {
+class FunctionDecl;
+
+namespace interp {
+
+enum class Opcode : uint8_t {
+#define OPCODE(Name, Immediates) Name,
+#include "Opcodes.def"
+};
+
+/// The integer type an arithmetic instruction operates in. Values of integral
+/// type are held in 64 bits, sign-extended if the type is signed and
+/// zero-extended otherwise.
+struct IntType {
+  unsigned Width : 7;
+  unsigned Signed : 1;
+
+  /// Truncate V to this type and extend it back to 64 bits.
+  int64_t normalize(uint64_t V) const {
+    if (Width == 64)
+      return int64_t(V);
+    uint64_t Mask = (uint64_t(1) << Width) - 1;
+    V &= Mask;
+    if (Signed && (V >> (Width - 1)))
+      V |= ~Mask;
+    return int64_t(V);
+  }
+
+  /// The smallest value of this type if it is signed.
+  int64_t getSignedMin() const {
+    return int64_t(uint64_t(-1) << (Width - 1));
+  }
+
+  uint8_t encode() const { return uint8_t(Width | (Signed << 7)); }
+  static IntType decode(uint8_t Byte) {
+    IntType T;
+    T.Width = Byte & 0x7f;
+    T.Signed = Byte >> 7;
+    return T;
+  }
+};
+
+/// The bytecode of a constexpr function, or of a top-level expression.
+///
+/// Parameters occupy the first local slots of a frame, followed by the local
+/// variables declared in the body.
+class Function {
+public:
+  Function(const FunctionDecl *Decl, unsigned NumParams)
+      : Decl(Decl), NumParams(NumParams), NumLocals(NumParams) {}
+
+  /// The declaration this function was compiled from, or null for a
+  /// top-level expression.
+  const FunctionDecl *getDecl() const { return Decl; }
+
+  unsigned getNumParams() const { return NumParams; }
+  unsigned getNumLocals() const { return NumLocals; }
+  const char *getCodeBegin() const { return Code.data(); }
+  size_t getCodeSize() const { return Code.size(); }
+
+private:
+  friend class Compiler;
+
+  const FunctionDecl *Decl;
+  unsigned NumParams;
+  unsigned NumLocals;
+  std::vector<char> Code;
+};
+
+/// Read an immediate operand of type T at PC and advance PC past it.
+template <typename T> T readImm(const char *&PC) {
+  T Value;
+  std::memcpy(&Value, PC, sizeof(T));
+  PC += sizeof(T);
+  return Value;
+}
+
+} // namespace interp
+} // namespace clang
+
+#endif
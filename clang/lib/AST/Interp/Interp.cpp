@@ -0,0 +1,340 @@
+//===--- Interp.cpp - Interpreter loop of the constant interpreter --------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "Interp.h"
+#include "Context.h"
+#include "Function.h"
+#include "clang/AST/APValue.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/SmallVector.h"
+#include <vector>
+
+using namespace clang;
+using namespace clang::interp;
+
+namespace {
+
+struct Local {
+  int64_t Value;
+  bool Initialized;
+};
+
+struct Frame {
+  const Function *Func;
+  const char *PC;
+  size_t LocalsBase;
+};
+
+} // end anonymous namespace
+
+/// Perform an arithmetic operation which might overflow in the signed type T
+/// through APInt.
+static bool handleSignedOverflowOp(Opcode Op, int64_t L, int64_t R, IntType T,
+                                   int64_t &Result) {
+  llvm::APInt LHS(T.Width, uint64_t(L), /*isSigned=*/true);
+  llvm::APInt RHS(T.Width, uint64_t(R), /*isSigned=*/true);
+  bool Overflow = false;
+  llvm::APInt Value;
+  switch (Op) {
+  case Opcode::Add: Value = LHS.sadd_ov(RHS, Overflow); break;
+  case Opcode::Sub: Value = LHS.ssub_ov(RHS, Overflow); break;
+  case Opcode::Mul: Value = LHS.smul_ov(RHS, Overflow); break;
+  default: llvm_unreachable("not an overflowing operation");
+  }
+  Result = Value.getSExtValue();
+  return !Overflow;
+}
+
+/// Perform the integer operation Op on values of type T. Returns false if the
+/// result is undefined.
+static bool handleIntOp(Opcode Op, int64_t L, int64_t R, IntType T,
+                        bool CPlusPlus2a, int64_t &Result) {
+  uint64_t UL = uint64_t(L), UR = uint64_t(R);
+  switch (Op) {
+  case Opcode::Add:
+  case Opcode::Sub:
+  case Opcode::Mul:
+    if (!T.Signed) {
+      uint64_t Value = Op == Opcode::Add   ? UL + UR
+                       : Op == Opcode::Sub ? UL - UR
+                                           : UL * UR;
+      Result = T.normalize(Value);
+      return true;
+    }
+    // Values of at most 32 bits can't overflow 64-bit arithmetic.
+    if (T.Width > 32)
+      return handleSignedOverflowOp(Op, L, R, T, Result);
+    Result = Op == Opcode::Add ? L + R : Op == Opcode::Sub ? L - R : L * R;
+    return T.normalize(Result) == Result;
+
+  case Opcode::Div:
+  case Opcode::Rem:
+    if (R == 0)
+      return false;
+    if (!T.Signed) {
+      Result = int64_t(Op == Opcode::Div ? UL / UR : UL % UR);
+      return true;
+    }
+    // The tree walker treats both INT_MIN / -1 and INT_MIN % -1 as overflow.
+    if (R == -1 && L == T.getSignedMin())
+      return false;
+    Result = Op == Opcode::Div ? L / R : L % R;
+    return true;
+
+  case Opcode::Shl:
+  case Opcode::Shr: {
+    // Negative and oversized shifts are not constant expressions.
+    if (R < 0 || R >= T.Width)
+      return false;
+    unsigned Amount = unsigned(R);
+    if (Op == Opcode::Shr) {
+      Result = T.Signed ? (L < 0 ? ~(~L >> Amount) : L >> Amount)
+                        : int64_t(UL >> Amount);
+      return true;
+    }
+    // Before C++2a, a signed left shift must have a non-negative operand and
+    // must not shift set bits out of the corresponding unsigned type.
+    if (T.Signed && !CPlusPlus2a &&
+        (L < 0 || (Amount != 0 && (UL >> (T.Width - Amount)) != 0)))
+      return false;
+    Result = T.normalize(UL << Amount);
+    return true;
+  }
+
+  case Opcode::And:
+    Result = L & R;
+    return true;
+  case Opcode::Or:
+    Result = L | R;
+    return true;
+  case Opcode::Xor:
+    Result = L ^ R;
+    return true;
+
+  default:
+    llvm_unreachable("not a binary integer operation");
+  }
+}
+
+static bool compare(Opcode Op, int64_t L, int64_t R, IntType T) {
+  if (!T.Signed) {
+    uint64_t UL = uint64_t(L), UR = uint64_t(R);
+    switch (Op) {
+    case Opcode::LT: return UL < UR;
+    case Opcode::LE: return UL <= UR;
+    case Opcode::GT: return UL > UR;
+    case Opcode::GE: return UL >= UR;
+    default: break;
+    }
+  }
+  switch (Op) {
+  case Opcode::EQ: return L == R;
+  case Opcode::NE: return L != R;
+  case Opcode::LT: return L < R;
+  case Opcode::LE: return L <= R;
+  case Opcode::GT: return L > R;
+  case Opcode::GE: return L >= R;
+  default: llvm_unreachable("not a comparison");
+  }
+}
+
+/// Read the value of a global variable that is usable in constant expressions,
+/// following the rules of the tree walker.
+static bool readGlobal(const VarDecl *VD, int64_t &Result) {
+  QualType Ty = VD->getType();
+  if (Ty.isVolatileQualified() || !(VD->isConstexpr() || Ty.isConstQualified()))
+    return false;
+
+  const VarDecl *InitDecl;
+  const Expr *Init = VD->getAnyInitializer(InitDecl);
+  if (!Init || Init->isValueDependent() || InitDecl->isInvalidDecl() ||
+      InitDecl->isWeak())
+    return false;
+
+  // evaluateValue returns null for a variable whose initializer is being
+  // evaluated, so a recursive reference fails here.
+  const APValue *Value = InitDecl->evaluateValue();
+  if (!Value || !Value->isInt() || !InitDecl->checkInitIsICE())
+    return false;
+  const llvm::APSInt &Int = Value->getInt();
+  if (Int.getBitWidth() > 64)
+    return false;
+  Result = Int.isSigned() ? Int.getSExtValue() : int64_t(Int.getZExtValue());
+  return true;
+}
+
+bool clang::interp::interpret(Context &Ctx, const Function &Entry,
+                              int64_t &Result) {
+  const LangOptions &LangOpts = Ctx.getASTContext().getLangOpts();
+  std::vector<int64_t> Stack;
+  std::vector<Local> Locals(Entry.getNumLocals(), Local{0, false});
+  llvm::SmallVector<Frame, 16> Frames;
+  uint64_t Steps = 0;
+
+  const Function *Func = &Entry;
+  const char *PC = Func->getCodeBegin();
+  size_t LocalsBase = 0;
+
+  auto Pop = [&Stack]() {
+    int64_t Value = Stack.back();
+    Stack.pop_back();
+    return Value;
+  };
+
+  while (true) {
+    Opcode Op = Opcode(*PC++);
+    switch (Op) {
+    case Opcode::Const:
+      Stack.push_back(readImm<int64_t>(PC));
+      break;
+    case Opcode::Pop:
+      Stack.pop_back();
+      break;
+    case Opcode::Dup:
+      Stack.push_back(Stack.back());
+      break;
+
+    case Opcode::GetLocal: {
+      const Local &L = Locals[LocalsBase + readImm<uint32_t>(PC)];
+      if (!L.Initialized)
+        return false;
+      Stack.push_back(L.Value);
+      break;
+    }
+    case Opcode::SetLocal:
+      Locals[LocalsBase + readImm<uint32_t>(PC)] = Local{Pop(), true};
+      break;
+    case Opcode::ClearLocal:
+      Locals[LocalsBase + readImm<uint32_t>(PC)].Initialized = false;
+      break;
+    case Opcode::GetGlobal: {
+      int64_t Value;
+      if (!readGlobal(static_cast<const VarDecl *>(readImm<const void *>(PC)),
+                      Value))
+        return false;
+      Stack.push_back(Value);
+      break;
+    }
+
+    case Opcode::Step:
+      Steps += readImm<uint32_t>(PC);
+      if (Steps > LangOpts.ConstexprStepLimit)
+        return false;
+      break;
+
+    case Opcode::Add:
+    case Opcode::Sub:
+    case Opcode::Mul:
+    case Opcode::Div:
+    case Opcode::Rem:
+    case Opcode::Shl:
+    case Opcode::Shr:
+    case Opcode::And:
+    case Opcode::Or:
+    case Opcode::Xor: {
+      IntType T = IntType::decode(readImm<uint8_t>(PC));
+      int64_t R = Pop();
+      int64_t L = Pop();
+      int64_t Value;
+      if (!handleIntOp(Op, L, R, T, LangOpts.CPlusPlus2a, Value))
+        return false;
+      Stack.push_back(Value);
+      break;
+    }
+    case Opcode::Neg: {
+      IntType T = IntType::decode(readImm<uint8_t>(PC));
+      int64_t &V = Stack.back();
+      if (T.Signed && V == T.getSignedMin())
+        return false;
+      V = T.normalize(0 - uint64_t(V));
+      break;
+    }
+    case Opcode::Comp: {
+      IntType T = IntType::decode(readImm<uint8_t>(PC));
+      Stack.back() = T.normalize(~uint64_t(Stack.back()));
+      break;
+    }
+    case Opcode::Cast: {
+      IntType T = IntType::decode(readImm<uint8_t>(PC));
+      Stack.back() = T.normalize(uint64_t(Stack.back()));
+      break;
+    }
+    case Opcode::ToBool:
+      Stack.back() = Stack.back() != 0;
+      break;
+    case Opcode::LNot:
+      Stack.back() = Stack.back() == 0;
+      break;
+
+    case Opcode::EQ:
+    case Opcode::NE:
+    case Opcode::LT:
+    case Opcode::LE:
+    case Opcode::GT:
+    case Opcode::GE: {
+      IntType T = IntType::decode(readImm<uint8_t>(PC));
+      int64_t R = Pop();
+      Stack.back() = compare(Op, Stack.back(), R, T);
+      break;
+    }
+
+    case Opcode::Jmp: {
+      int32_t Rel = readImm<int32_t>(PC);
+      PC += Rel;
+      break;
+    }
+    case Opcode::Jt:
+    case Opcode::Jf: {
+      int32_t Rel = readImm<int32_t>(PC);
+      if ((Pop() != 0) == (Op == Opcode::Jt))
+        PC += Rel;
+      break;
+    }
+
+    case Opcode::Call: {
+      const auto *FD =
+          static_cast<const FunctionDecl *>(readImm<const void *>(PC));
+      const Function *Callee = Ctx.getFunction(FD);
+      if (!Callee || Frames.size() + 1 >= LangOpts.ConstexprCallDepth)
+        return false;
+      Frames.push_back(Frame{Func, PC, LocalsBase});
+
+      // Move the arguments into the parameter slots of the new frame.
+      LocalsBase = Locals.size();
+      Locals.resize(LocalsBase + Callee->getNumLocals(), Local{0, false});
+      unsigned NumParams = Callee->getNumParams();
+      size_t ArgsBase = Stack.size() - NumParams;
+      for (unsigned I = 0; I != NumParams; ++I)
+        Locals[LocalsBase + I] = Local{Stack[ArgsBase + I], true};
+      Stack.resize(ArgsBase);
+
+      Func = Callee;
+      PC = Func->getCodeBegin();
+      break;
+    }
+    case Opcode::Ret: {
+      if (Frames.empty()) {
+        Result = Pop();
+        return true;
+      }
+      // The return value stays on top of the stack.
+      Locals.resize(LocalsBase);
+      const Frame &Caller = Frames.back();
+      Func = Caller.Func;
+      PC = Caller.PC;
+      LocalsBase = Caller.LocalsBase;
+      Frames.pop_back();
+      break;
+    }
+    case Opcode::NoReturn:
+      return false;
+    }
+  }
+}
@@ -0,0 +1,34 @@
+//===--- Interp.h - Interpreter loop of the constant interpreter -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_AST_INTERP_INTERP_H
+#define LLVM_CLANG_AST_INTERP_INTERP_H
+
+#include <cstdint>
+
+namespace clang {
+namespace interp {
+class Context;
+class Function;
+
+/// Run the top-level function Entry, which takes no parameters.
+///
+/// Calls are executed on an explicit stack of frames, so the depth of the
+/// evaluated call tree is bounded by -fconstexpr-depth rather than by the
+/// native stack.
+///
+/// \returns false if the evaluation failed: on undefined behavior, when
+/// reading an uninitialized or non-constant variable, calling a function
+/// that cannot be compiled, or exceeding the -fconstexpr-depth or
+/// -fconstexpr-steps limits.
+bool interpret(Context &Ctx, const Function &Entry, int64_t &Result);
+
+} // namespace interp
+} // namespace clang
+
+#endif
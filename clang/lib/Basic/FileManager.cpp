@@ -465,6 +465,33 @@ void FileManager::invalidateCache(const FileEntry *Entry) {
   UniqueRealFiles.erase(Entry->getUniqueID());
 }
 
+bool FileManager::hasChangedOnDisk() {
+  if (!VirtualFileEntries.empty())
+    return true;
+
+  llvm::vfs::Status Status;
+  for (const auto &Entry : SeenDirEntries) {
+    bool Exists = !getNoncachedStatValue(Entry.getKey(), Status) &&
+                  Status.isDirectory();
+    if (Exists != (Entry.getValue() != nullptr))
+      return true;
+  }
+
+  for (const auto &Entry : SeenFileEntries) {
+    const FileEntry *FE = Entry.getValue();
+    bool Exists = !getNoncachedStatValue(Entry.getKey(), Status) &&
+                  !Status.isDirectory();
+    if (Exists != (FE != nullptr))
+      return true;
+    if (FE && (Status.getUniqueID() != FE->getUniqueID() ||
+               off_t(Status.getSize()) != FE->getSize() ||
+               llvm::sys::toTimeT(Status.getLastModificationTime()) !=
+                   FE->getModificationTime()))
+      return true;
+  }
+  return false;
+}
+
 void FileManager::GetUniqueIDMapping(
                    SmallVectorImpl<const FileEntry *> &UIDToFiles) const {
   UIDToFiles.clear();
@@ -278,8 +278,17 @@ namespace clang {
           return;
         }
 
+        Expected<remarks::Format> Format =
+            remarks::parseFormat(CodeGenOpts.OptRecordFormat);
+        if (Error E = Format.takeError()) {
+          consumeError(std::move(E));
+          Diags.Report(diag::err_drv_invalid_value)
+              << "-opt-record-format" << CodeGenOpts.OptRecordFormat;
+          return;
+        }
+
         Ctx.setRemarkStreamer(llvm::make_unique<RemarkStreamer>(
-            CodeGenOpts.OptRecordFile, OptRecordFile->os()));
+            CodeGenOpts.OptRecordFile, OptRecordFile->os(), *Format));
 
         if (!CodeGenOpts.OptRecordPasses.empty())
           if (Error E = Ctx.getRemarkStreamer()->setFilter(
@@ -43,6 +43,10 @@ STATISTIC(NumGetCTUSuccess,
 STATISTIC(NumTripleMismatch, "The # of triple mismatches");
 STATISTIC(NumLangMismatch, "The # of language mismatches");
 STATISTIC(NumLangDialectMismatch, "The # of language dialect mismatches");
+STATISTIC(NumASTLoadThresholdReached,
+          "The # of ASTs not loaded because of threshold");
+STATISTIC(NumDefinitionIndexHits,
+          "The # of definitions found in an already indexed AST");
 
 // Same as Triple's equality operator, but we check a field only if that is
 // known in both instances.
@@ -102,6 +106,8 @@ public:
       return "Language mismatch";
     case index_error_code::lang_dialect_mismatch:
       return "Language dialect mismatch";
+    case index_error_code::load_threshold_reached:
+      return "Load threshold reached";
     }
     llvm_unreachable("Unrecognized index_error_code.");
   }
@@ -180,7 +186,8 @@ template <typename T> static bool hasBodyOrInit(const T *D) {
 }
 
 CrossTranslationUnitContext::CrossTranslationUnitContext(CompilerInstance &CI)
-    : CI(CI), Context(CI.getASTContext()) {}
+    : CI(CI), Context(CI.getASTContext()),
+      CTULoadThreshold(CI.getAnalyzerOpts()->CTUImportThreshold) {}
 
 CrossTranslationUnitContext::~CrossTranslationUnitContext() {}
 
@@ -192,28 +199,52 @@ std::string CrossTranslationUnitContext::getLookupName(const NamedDecl *ND) {
   return DeclUSR.str();
 }
 
-/// Recursively visits the decls of a DeclContext, and returns one with the
-/// given USR.
-template <typename T>
-const T *
-CrossTranslationUnitContext::findDefInDeclContext(const DeclContext *DC,
-                                                  StringRef LookupName) {
+/// Recursively visits the decls of a DeclContext, and records the definition
+/// of each function or variable with their USR. When multiple decls have the
+/// same USR, the first one visited wins.
+static void collectDefsInDeclContext(const DeclContext *DC,
+                                     llvm::StringMap<const Decl *> &Defs) {
   assert(DC && "Declaration Context must not be null");
   for (const Decl *D : DC->decls()) {
     const auto *SubDC = dyn_cast<DeclContext>(D);
     if (SubDC)
-      if (const auto *ND = findDefInDeclContext<T>(SubDC, LookupName))
-        return ND;
-
-    const auto *ND = dyn_cast<T>(D);
-    const T *ResultDecl;
-    if (!ND || !hasBodyOrInit(ND, ResultDecl))
-      continue;
-    if (getLookupName(ResultDecl) != LookupName)
+      collectDefsInDeclContext(SubDC, Defs);
+
+    const NamedDecl *ResultDecl = nullptr;
+    if (const auto *FD = dyn_cast<FunctionDecl>(D)) {
+      const FunctionDecl *Def;
+      if (hasBodyOrInit(FD, Def))
+        ResultDecl = Def;
+    } else if (const auto *VD = dyn_cast<VarDecl>(D)) {
+      const VarDecl *Def;
+      if (hasBodyOrInit(VD, Def))
+        ResultDecl = Def;
+    }
+    if (!ResultDecl)
       continue;
-    return ResultDecl;
+    Defs.insert(std::make_pair(
+        CrossTranslationUnitContext::getLookupName(ResultDecl), ResultDecl));
+  }
+}
+
+/// Returns the definition with the given USR in \p TU. The definitions of a
+/// TU are indexed the first time it is searched, which makes lookups of
+/// further definitions in the same TU cheap.
+template <typename T>
+const T *CrossTranslationUnitContext::findDefInTU(TranslationUnitDecl *TU,
+                                                  StringRef LookupName) {
+  auto DefsIt = TUDefinitionMap.find(TU);
+  if (DefsIt == TUDefinitionMap.end()) {
+    DefsIt = TUDefinitionMap.insert({TU, llvm::StringMap<const Decl *>()})
+                 .first;
+    collectDefsInDeclContext(TU, DefsIt->second);
+  } else {
+    ++NumDefinitionIndexHits;
   }
-  return nullptr;
+  auto It = DefsIt->second.find(LookupName);
+  if (It == DefsIt->second.end())
+    return nullptr;
+  return dyn_cast<T>(It->second);
 }
 
 template <typename T>
@@ -285,7 +316,7 @@ llvm::Expected<const T *> CrossTranslationUnitContext::getCrossTUDefinitionImpl(
   }
 
   TranslationUnitDecl *TU = Unit->getASTContext().getTranslationUnitDecl();
-  if (const T *ResultDecl = findDefInDeclContext<T>(TU, LookupName))
+  if (const T *ResultDecl = findDefInTU<T>(TU, LookupName))
     return importDefinition(ResultDecl);
   return llvm::make_error<IndexError>(index_error_code::failed_import);
 }
@@ -363,6 +394,14 @@ llvm::Expected<ASTUnit *> CrossTranslationUnitContext::loadExternalAST(
     StringRef ASTFileName = It->second;
     auto ASTCacheEntry = FileASTUnitMap.find(ASTFileName);
     if (ASTCacheEntry == FileASTUnitMap.end()) {
+      // Every loaded AST file stays in memory until the end of the analysis,
+      // so bound their number.
+      if (NumASTLoaded >= CTULoadThreshold) {
+        ++NumASTLoadThresholdReached;
+        return llvm::make_error<IndexError>(
+            index_error_code::load_threshold_reached);
+      }
+
       IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
       TextDiagnosticPrinter *DiagClient =
           new TextDiagnosticPrinter(llvm::errs(), &*DiagOpts);
@@ -375,6 +414,7 @@ llvm::Expected<ASTUnit *> CrossTranslationUnitContext::loadExternalAST(
           ASTUnit::LoadEverything, Diags, CI.getFileSystemOpts()));
       Unit = LoadedUnit.get();
       FileASTUnitMap[ASTFileName] = std::move(LoadedUnit);
+      ++NumASTLoaded;
       if (DisplayCTUProgress) {
         llvm::errs() << "CTU loaded AST file: "
                      << ASTFileName << "\n";
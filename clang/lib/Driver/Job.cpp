@@ -14,6 +14,7 @@
 #include "clang/Driver/Tool.h"
 #include "clang/Driver/ToolChain.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
@@ -323,6 +324,19 @@ int Command::Execute(ArrayRef<llvm::Optional<StringRef>> Redirects,
 
   SmallVector<const char*, 128> Argv;
 
+  // A job run in this process can't have its own environment or
+  // redirections.
+  const Driver &D = Creator.getToolChain().getDriver();
+  if (D.CC1Main && Environment.empty() && !Arguments.empty() &&
+      StringRef(Arguments[0]) == "-cc1" &&
+      StringRef(Executable) == D.getClangProgramPath() &&
+      llvm::all_of(Redirects,
+                   [](const Optional<StringRef> &R) { return !R; })) {
+    Argv.push_back(Executable);
+    Argv.append(Arguments.begin(), Arguments.end());
+    return D.CC1Main(Argv);
+  }
+
   Optional<ArrayRef<StringRef>> Env;
   std::vector<StringRef> ArgvVectorStorage;
   if (!Environment.empty()) {
@@ -62,8 +62,10 @@ bool AffectedRangeManager::affectsCharSourceRange(
   for (SmallVectorImpl<CharSourceRange>::const_iterator I = Ranges.begin(),
                                                         E = Ranges.end();
        I != E; ++I) {
-    if (!SourceMgr.isBeforeInTranslationUnit(Range.getEnd(), I->getBegin()) &&
-        !SourceMgr.isBeforeInTranslationUnit(I->getEnd(), Range.getBegin()))
+    // This is called for every token; all ranges are in the same file, so
+    // comparing offsets is enough.
+    if (!SourceMgr.isBeforeInSLocAddrSpace(Range.getEnd(), I->getBegin()) &&
+        !SourceMgr.isBeforeInSLocAddrSpace(I->getEnd(), Range.getBegin()))
       return true;
   }
   return false;
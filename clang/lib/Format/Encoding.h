@@ -15,7 +15,9 @@
 #ifndef LLVM_CLANG_LIB_FORMAT_ENCODING_H
 #define LLVM_CLANG_LIB_FORMAT_ENCODING_H
 
+#include "clang/Basic/CharInfo.h"
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/ConvertUTF.h"
 #include "llvm/Support/Unicode.h"
@@ -43,6 +45,11 @@ inline Encoding detectEncoding(StringRef Text) {
 /// generic Unicode-capable terminal. Text is assumed to use the specified
 /// \p Encoding.
 inline unsigned columnWidth(StringRef Text, Encoding Encoding) {
+  // Every ASCII character is either one column wide or unprintable, and we
+  // count unprintable text by its bytes anyway, so the common case of pure
+  // ASCII text doesn't need to consult the Unicode tables.
+  if (llvm::all_of(Text, [](char C) { return isASCII(C); }))
+    return Text.size();
   if (Encoding == Encoding_UTF8) {
     int ContentWidth = llvm::sys::unicode::columnWidthUTF8(Text);
     // FIXME: Figure out the correct way to handle this in the presence of both
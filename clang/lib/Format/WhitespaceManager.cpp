@@ -19,7 +19,9 @@ namespace format {
 
 bool WhitespaceManager::Change::IsBeforeInFile::
 operator()(const Change &C1, const Change &C2) const {
-  return SourceMgr.isBeforeInTranslationUnit(
+  // All changes are in the one file being formatted, where the order of
+  // locations is that of their offsets.
+  return SourceMgr.isBeforeInSLocAddrSpace(
       C1.OriginalWhitespaceRange.getBegin(),
       C2.OriginalWhitespaceRange.getBegin());
 }
@@ -83,6 +83,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/Timer.h"
@@ -1252,6 +1253,71 @@ makeStandaloneDiagnostic(const LangOptions &LangOpts,
   return OutDiag;
 }
 
+/// Compute the key under which the preamble of the main file \p MainFileBuffer
+/// is shared in a PreambleStore. It covers the directory of the main file,
+/// the contents of the preamble, and the options that can change the way the
+/// preamble is parsed.
+static std::string getPreambleStoreKey(const CompilerInvocation &Invocation,
+                                       const llvm::MemoryBuffer *MainFileBuffer,
+                                       PreambleBounds Bounds,
+                                       llvm::vfs::FileSystem &VFS,
+                                       bool CaptureDiagnostics,
+                                       bool SkipFunctionBodies) {
+  llvm::MD5 Hash;
+  auto AddString = [&Hash](StringRef S) {
+    Hash.update(S);
+    Hash.update(StringRef("", 1));
+  };
+  auto AddInt = [&AddString](uint64_t V) { AddString(llvm::utostr(V)); };
+
+  AddString(Invocation.getModuleHash());
+  AddInt(CaptureDiagnostics);
+  AddInt(SkipFunctionBodies);
+
+  SmallString<128> MainFileDir(
+      Invocation.getFrontendOpts().Inputs[0].getFile());
+  VFS.makeAbsolute(MainFileDir);
+  llvm::sys::path::remove_filename(MainFileDir);
+  AddString(MainFileDir);
+  AddString(Invocation.getFileSystemOpts().WorkingDir);
+
+  const HeaderSearchOptions &HSOpts = Invocation.getHeaderSearchOpts();
+  for (const auto &Entry : HSOpts.UserEntries) {
+    AddString(Entry.Path);
+    AddInt(Entry.Group);
+    AddInt(Entry.IsFramework);
+    AddInt(Entry.IgnoreSysRoot);
+  }
+  for (const auto &Prefix : HSOpts.SystemHeaderPrefixes) {
+    AddString(Prefix.Prefix);
+    AddInt(Prefix.IsSystemHeader);
+  }
+  for (const std::string &Overlay : HSOpts.VFSOverlayFiles)
+    AddString(Overlay);
+  AddString(HSOpts.ModuleCachePath);
+
+  const PreprocessorOptions &PPOpts = Invocation.getPreprocessorOpts();
+  for (const std::string &Include : PPOpts.Includes)
+    AddString(Include);
+  for (const std::string &Include : PPOpts.MacroIncludes)
+    AddString(Include);
+  AddString(PPOpts.ImplicitPCHInclude);
+
+  const DiagnosticOptions &DiagOpts = Invocation.getDiagnosticOpts();
+  AddInt(DiagOpts.IgnoreWarnings);
+  for (const std::string &Warning : DiagOpts.Warnings)
+    AddString(Warning);
+  for (const std::string &Remark : DiagOpts.Remarks)
+    AddString(Remark);
+
+  AddInt(Bounds.PreambleEndsAtStartOfLine);
+  AddString(MainFileBuffer->getBuffer().substr(0, Bounds.Size));
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  return Result.digest().str();
+}
+
 /// Attempt to build or re-use a precompiled preamble when (re-)parsing
 /// the source file.
 ///
@@ -1315,6 +1381,44 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     }
   }
 
+  // Another main file with the same preamble may have built it already.
+  std::string PreambleKey;
+  if (Preambles) {
+    PreambleKey = getPreambleStoreKey(
+        PreambleInvocationIn, MainFileBuffer.get(), Bounds, *VFS,
+        CaptureDiagnostics,
+        SkipFunctionBodies == SkipFunctionBodiesScope::Preamble);
+    if (std::shared_ptr<const PreambleStore::Entry> Shared =
+            Preambles->lookup(PreambleKey, PreambleInvocationIn,
+                              MainFileBuffer.get(), Bounds, VFS.get())) {
+      Preamble = Shared->Preamble;
+      TopLevelDecls.clear();
+      TopLevelDeclsInPreamble = Shared->TopLevelDecls;
+      NumWarningsInPreamble = Shared->NumWarnings;
+
+      // The diagnostics in the main file refer to the file the preamble was
+      // built from, at the same offsets as in this one.
+      checkAndRemoveNonDriverDiags(StoredDiagnostics);
+      PreambleDiagnostics = Shared->Diagnostics;
+      for (StandaloneDiagnostic &SD : PreambleDiagnostics)
+        if (SD.Filename == Shared->MainFileName)
+          SD.Filename = MainFilePath;
+
+      getDiagnostics().Reset();
+      ProcessWarningOptions(getDiagnostics(),
+                            PreambleInvocationIn.getDiagnosticOpts());
+      getDiagnostics().setNumWarnings(NumWarningsInPreamble);
+
+      PreambleTopLevelHashValue = Shared->TopLevelHashValue;
+      if (CurrentTopLevelHashValue != PreambleTopLevelHashValue) {
+        CompletionCacheTopLevelHashValue = 0;
+        PreambleTopLevelHashValue = CurrentTopLevelHashValue;
+      }
+      PreambleRebuildCountdown = 1;
+      return MainFileBuffer;
+    }
+  }
+
   // If the preamble rebuild counter > 1, it's because we previously
   // failed to build a preamble and we're not yet ready to try
   // again. Decrement the counter and return a failure.
@@ -1357,7 +1461,7 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
         PreviousSkipFunctionBodies;
 
     if (NewPreamble) {
-      Preamble = std::move(*NewPreamble);
+      Preamble = std::make_shared<PrecompiledPreamble>(std::move(*NewPreamble));
       PreambleRebuildCountdown = 1;
     } else {
       switch (static_cast<BuildPreambleError>(NewPreamble.getError().value())) {
@@ -1389,6 +1493,17 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
   StoredDiagnostics = std::move(NewPreambleDiags);
   PreambleDiagnostics = std::move(NewPreambleDiagsStandalone);
 
+  if (Preambles) {
+    auto Shared = std::make_shared<PreambleStore::Entry>();
+    Shared->Preamble = Preamble;
+    Shared->MainFileName = MainFilePath;
+    Shared->TopLevelDecls = TopLevelDeclsInPreamble;
+    Shared->TopLevelHashValue = PreambleTopLevelHashValue;
+    Shared->NumWarnings = NumWarningsInPreamble;
+    Shared->Diagnostics = PreambleDiagnostics;
+    Preambles->insert(PreambleKey, std::move(Shared));
+  }
+
   // If the hash of top-level entities differs from the hash of the top-level
   // entities the last time we rebuilt the preamble, clear out the completion
   // cache.
@@ -1668,7 +1783,7 @@ std::unique_ptr<ASTUnit> ASTUnit::LoadFromCompilerInvocation(
     bool OnlyLocalDecls, bool CaptureDiagnostics,
     unsigned PrecompilePreambleAfterNParses, TranslationUnitKind TUKind,
     bool CacheCodeCompletionResults, bool IncludeBriefCommentsInCodeCompletion,
-    bool UserFilesAreVolatile) {
+    bool UserFilesAreVolatile, std::shared_ptr<PreambleStore> Preambles) {
   // Create the AST unit.
   std::unique_ptr<ASTUnit> AST(new ASTUnit(false));
   ConfigureDiags(Diags, *AST, CaptureDiagnostics);
@@ -1683,6 +1798,7 @@ std::unique_ptr<ASTUnit> ASTUnit::LoadFromCompilerInvocation(
   AST->FileSystemOpts = FileMgr->getFileSystemOpts();
   AST->FileMgr = FileMgr;
   AST->UserFilesAreVolatile = UserFilesAreVolatile;
+  AST->Preambles = std::move(Preambles);
 
   // Recover resources if we crash before exiting this method.
   llvm::CrashRecoveryContextCleanupRegistrar<ASTUnit>
@@ -1709,7 +1825,8 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
     bool AllowPCHWithCompilerErrors, SkipFunctionBodiesScope SkipFunctionBodies,
     bool SingleFileParse, bool UserFilesAreVolatile, bool ForSerialization,
     llvm::Optional<StringRef> ModuleFormat, std::unique_ptr<ASTUnit> *ErrAST,
-    IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS) {
+    IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS,
+    std::shared_ptr<PreambleStore> Preambles) {
   assert(Diags.get() && "no DiagnosticsEngine was provided");
 
   SmallVector<StoredDiagnostic, 4> StoredDiagnostics;
@@ -1767,6 +1884,7 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
   AST->UserFilesAreVolatile = UserFilesAreVolatile;
   AST->Invocation = CI;
   AST->SkipFunctionBodies = SkipFunctionBodies;
+  AST->Preambles = std::move(Preambles);
   if (ForSerialization)
     AST->WriterData.reset(new ASTWriterData(*AST->ModuleCache));
   // Zero out now to ease cleanup during crash recovery.
@@ -2687,3 +2805,43 @@ void ASTUnit::ConcurrencyState::start() {}
 void ASTUnit::ConcurrencyState::finish() {}
 
 #endif // NDEBUG
+
+std::shared_ptr<const PreambleStore::Entry>
+PreambleStore::lookup(StringRef Key, const CompilerInvocation &Invocation,
+                      const llvm::MemoryBuffer *MainFileBuffer,
+                      PreambleBounds Bounds, llvm::vfs::FileSystem *VFS) {
+  std::shared_ptr<const Entry> E;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto It = Slots.find(Key);
+    if (It == Slots.end())
+      return nullptr;
+    E = It->second.E;
+    It->second.LastUse = ++UseCount;
+  }
+
+  // Checking the files of the preamble doesn't need the lock.
+  if (E->Preamble->CanReuse(Invocation, MainFileBuffer, Bounds, VFS))
+    return E;
+
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto It = Slots.find(Key);
+  if (It != Slots.end() && It->second.E == E)
+    Slots.erase(It);
+  return nullptr;
+}
+
+void PreambleStore::insert(StringRef Key, std::shared_ptr<const Entry> E) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Slot &S = Slots[Key];
+  S.E = std::move(E);
+  S.LastUse = ++UseCount;
+
+  if (Slots.size() <= MaxEntries)
+    return;
+  auto Oldest = Slots.begin();
+  for (auto It = Slots.begin(), End = Slots.end(); It != End; ++It)
+    if (It->second.LastUse < Oldest->second.LastUse)
+      Oldest = It;
+  Slots.erase(Oldest);
+}
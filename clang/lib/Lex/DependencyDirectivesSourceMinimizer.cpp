@@ -0,0 +1,433 @@
+//===- DependencyDirectivesSourceMinimizer.cpp ----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This is the implementation for minimizing header and source files to the
+/// minimum necessary preprocessor directives for evaluating includes. It
+/// reduces the source down to the directives that survive the scan, and
+/// throws away everything else. The lexing here is deliberately simpler than
+/// clang's Lexer: it only has to find the start of every logical line that
+/// isn't inside a comment or a literal, and copy the directives it cares
+/// about.
+///
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "clang/Basic/CharInfo.h"
+#include "llvm/ADT/StringSwitch.h"
+#include <algorithm>
+
+using namespace clang;
+
+namespace {
+
+class Minimizer {
+public:
+  explicit Minimizer(SmallVectorImpl<char> &Out) : Out(Out) {}
+
+  /// Minimizes Input into Out. Returns true on error.
+  bool minimize(StringRef Input);
+
+private:
+  SmallVectorImpl<char> &Out;
+  bool HadError = false;
+
+  void minimizeLine(const char *&First, const char *const End);
+  void lexDirective(const char *&First, const char *const End);
+  void lexPragma(const char *&First, const char *const End);
+  void lexAtImport(const char *&First, const char *const End);
+  void printDirectiveBody(const char *&First, const char *const End,
+                          bool IsIncludeLike);
+
+  void append(StringRef S) { Out.append(S.begin(), S.end()); }
+};
+
+} // end anonymous namespace
+
+/// Returns the length of the escaped newline at \p First, or 0 if there isn't
+/// one. Like clang, this allows horizontal whitespace between the backslash
+/// and the newline.
+static unsigned isEscapedNewline(const char *First, const char *const End) {
+  if (First == End || *First != '\\')
+    return 0;
+  const char *Cur = First + 1;
+  while (Cur != End && isHorizontalWhitespace(*Cur))
+    ++Cur;
+  if (Cur == End || !isVerticalWhitespace(*Cur))
+    return 0;
+  char C = *Cur++;
+  // Treat "\r\n" and "\n\r" as a single newline.
+  if (Cur != End && isVerticalWhitespace(*Cur) && *Cur != C)
+    ++Cur;
+  return Cur - First;
+}
+
+static void skipNewline(const char *&First, const char *const End) {
+  if (First == End || !isVerticalWhitespace(*First))
+    return;
+  char C = *First++;
+  if (First != End && isVerticalWhitespace(*First) && *First != C)
+    ++First;
+}
+
+/// Skips a block comment. Returns false if it isn't terminated.
+static bool skipBlockComment(const char *&First, const char *const End) {
+  assert(First[0] == '/' && First[1] == '*');
+  First += 2;
+  for (; First + 1 < End; ++First)
+    if (First[0] == '*' && First[1] == '/') {
+      First += 2;
+      return true;
+    }
+  First = End;
+  return false;
+}
+
+/// Skips a line comment up to, but not including, the newline that ends it.
+/// An escaped newline continues the comment on the next line.
+static void skipLineComment(const char *&First, const char *const End) {
+  assert(First[0] == '/' && First[1] == '/');
+  First += 2;
+  while (First != End && !isVerticalWhitespace(*First)) {
+    if (unsigned Len = isEscapedNewline(First, End))
+      First += Len;
+    else
+      ++First;
+  }
+}
+
+/// Skips a string or character literal starting at the quote \p First points
+/// to. An unterminated literal ends at the end of the line.
+static void skipQuoted(const char *&First, const char *const End) {
+  const char Quote = *First++;
+  while (First != End && *First != Quote && !isVerticalWhitespace(*First)) {
+    if (*First == '\\') {
+      if (unsigned Len = isEscapedNewline(First, End)) {
+        First += Len;
+        continue;
+      }
+      // Skip the escaped character.
+      if (++First == End)
+        return;
+    }
+    ++First;
+  }
+  if (First != End && *First == Quote)
+    ++First;
+}
+
+/// Skips a raw string literal starting at the quote \p First points to.
+/// Returns false, without moving \p First, if it isn't a valid raw string.
+static bool skipRawString(const char *&First, const char *const End) {
+  assert(*First == '"');
+  const char *Cur = First + 1;
+  const char *DelimStart = Cur;
+  while (Cur != End && *Cur != '(' && Cur - DelimStart <= 16) {
+    if (isWhitespace(*Cur) || *Cur == '\\' || *Cur == ')' || *Cur == '"')
+      return false;
+    ++Cur;
+  }
+  if (Cur == End || *Cur != '(')
+    return false;
+  StringRef Delim(DelimStart, Cur - DelimStart);
+
+  for (++Cur; Cur != End; ++Cur) {
+    if (*Cur != ')')
+      continue;
+    StringRef Rest(Cur + 1, End - Cur - 1);
+    if (Rest.startswith(Delim) &&
+        Rest.drop_front(Delim.size()).startswith("\"")) {
+      First = Cur + 1 + Delim.size() + 1;
+      return true;
+    }
+  }
+  // An unterminated raw string swallows the rest of the file.
+  First = End;
+  return true;
+}
+
+/// Returns true if the identifier that ends just before \p Quote is a valid
+/// prefix of a raw string literal.
+static bool isRawStringPrefix(const char *const Start, const char *Quote) {
+  if (Quote == Start || Quote[-1] != 'R')
+    return false;
+  const char *Prefix = Quote - 1;
+  while (Prefix != Start && isIdentifierBody(Prefix[-1]))
+    --Prefix;
+  return llvm::StringSwitch<bool>(StringRef(Prefix, Quote - Prefix))
+      .Cases("R", "u8R", "uR", "UR", "LR", true)
+      .Default(false);
+}
+
+/// Returns true if the quote at \p Quote is a C++14 digit separator rather
+/// than the start of a character literal.
+static bool isDigitSeparator(const char *const Start, const char *Quote) {
+  if (Quote == Start || !isIdentifierBody(Quote[-1]))
+    return false;
+  // Character literals can have an encoding prefix.
+  const char *Prefix = Quote - 1;
+  while (Prefix != Start && isIdentifierBody(Prefix[-1]))
+    --Prefix;
+  StringRef Token(Prefix, Quote - Prefix);
+  if (Token == "u8" || Token == "u" || Token == "U" || Token == "L")
+    return false;
+  // Only numbers have digit separators.
+  return isDigit(*Prefix);
+}
+
+/// Skips the rest of the current logical line, including the newline that
+/// ends it. This skips over comments and literals, which may span lines.
+static void skipLine(const char *const Start, const char *&First,
+                     const char *const End, bool &HadError) {
+  while (First != End) {
+    char C = *First;
+    if (isVerticalWhitespace(C)) {
+      skipNewline(First, End);
+      return;
+    }
+    if (C == '/' && First + 1 != End && First[1] == '/') {
+      skipLineComment(First, End);
+      continue;
+    }
+    if (C == '/' && First + 1 != End && First[1] == '*') {
+      if (!skipBlockComment(First, End))
+        HadError = true;
+      continue;
+    }
+    if (C == '"') {
+      if (!isRawStringPrefix(Start, First) || !skipRawString(First, End))
+        skipQuoted(First, End);
+      continue;
+    }
+    if (C == '\'') {
+      if (isDigitSeparator(Start, First))
+        ++First;
+      else
+        skipQuoted(First, End);
+      continue;
+    }
+    if (unsigned Len = isEscapedNewline(First, End)) {
+      First += Len;
+      continue;
+    }
+    ++First;
+  }
+}
+
+/// Skips horizontal whitespace, escaped newlines and block comments within a
+/// directive. Returns true if anything was skipped.
+static bool skipSpaceInLine(const char *&First, const char *const End) {
+  const char *Begin = First;
+  while (First != End) {
+    if (isHorizontalWhitespace(*First)) {
+      ++First;
+    } else if (unsigned Len = isEscapedNewline(First, End)) {
+      First += Len;
+    } else if (First[0] == '/' && First + 1 != End && First[1] == '*') {
+      // Comments within a directive continue the directive even if they span
+      // lines, so the caller doesn't care about newlines in them.
+      skipBlockComment(First, End);
+    } else {
+      break;
+    }
+  }
+  return First != Begin;
+}
+
+/// Lexes an identifier at \p First, which may be empty.
+static StringRef lexIdentifier(const char *&First, const char *const End) {
+  const char *Begin = First;
+  while (First != End && isIdentifierBody(*First))
+    ++First;
+  return StringRef(Begin, First - Begin);
+}
+
+static bool isAtEndOfLine(const char *First, const char *const End) {
+  return First == End || isVerticalWhitespace(*First) ||
+         (First[0] == '/' && First + 1 != End && First[1] == '/');
+}
+
+void Minimizer::printDirectiveBody(const char *&First, const char *const End,
+                                   bool IsIncludeLike) {
+  bool NeedSpace = skipSpaceInLine(First, End);
+  // Header names aren't tokenized, so copy them verbatim.
+  if (IsIncludeLike && First != End && *First == '<') {
+    Out.push_back(' ');
+    const char *Begin = First;
+    while (First != End && *First != '>' && !isVerticalWhitespace(*First))
+      ++First;
+    if (First != End && *First == '>')
+      ++First;
+    append(StringRef(Begin, First - Begin));
+    NeedSpace = skipSpaceInLine(First, End);
+  }
+
+  while (!isAtEndOfLine(First, End)) {
+    if (NeedSpace)
+      Out.push_back(' ');
+    const char *Begin = First;
+    if (*First == '"' || *First == '\'')
+      skipQuoted(First, End);
+    else
+      ++First;
+    append(StringRef(Begin, First - Begin));
+    NeedSpace = skipSpaceInLine(First, End);
+  }
+  Out.push_back('\n');
+
+  const char *const Start = First;
+  skipLine(Start, First, End, HadError);
+}
+
+void Minimizer::lexPragma(const char *&First, const char *const End) {
+  const char *const Begin = First;
+  skipSpaceInLine(First, End);
+  StringRef Name = lexIdentifier(First, End);
+  bool Keep = llvm::StringSwitch<bool>(Name)
+                  .Cases("once", "push_macro", "pop_macro", "include_alias",
+                         true)
+                  .Default(false);
+  if (Name == "clang") {
+    skipSpaceInLine(First, End);
+    if (lexIdentifier(First, End) == "module") {
+      skipSpaceInLine(First, End);
+      Keep = lexIdentifier(First, End) == "import";
+    }
+  }
+  if (!Keep) {
+    skipLine(Begin, First, End, HadError);
+    return;
+  }
+  append("#pragma");
+  First = Begin;
+  printDirectiveBody(First, End, /*IsIncludeLike=*/false);
+}
+
+void Minimizer::lexDirective(const char *&First, const char *const End) {
+  const char *const LineStart = First;
+  assert(*First == '#');
+  ++First;
+  skipSpaceInLine(First, End);
+  StringRef Name = lexIdentifier(First, End);
+
+  enum { Skip, Keep, Include, Pragma } Kind =
+      llvm::StringSwitch<decltype(Kind)>(Name)
+          .Cases("include", "include_next", "import", "__include_macros",
+                 Include)
+          .Cases("define", "undef", Keep)
+          .Cases("if", "ifdef", "ifndef", "elif", "else", "endif", Keep)
+          .Case("pragma", Pragma)
+          .Default(Skip);
+
+  switch (Kind) {
+  case Skip:
+    skipLine(LineStart, First, End, HadError);
+    return;
+  case Pragma:
+    lexPragma(First, End);
+    return;
+  case Keep:
+  case Include:
+    Out.push_back('#');
+    append(Name);
+    printDirectiveBody(First, End, Kind == Include);
+    return;
+  }
+}
+
+void Minimizer::lexAtImport(const char *&First, const char *const End) {
+  const char *const LineStart = First;
+  // An @import declaration ends at the semicolon and may span lines.
+  const StringRef AtImport = "@import";
+  append(AtImport);
+  First += AtImport.size();
+  bool NeedSpace = true;
+  while (First != End && *First != ';') {
+    if (isWhitespace(*First) || isEscapedNewline(First, End) ||
+        (First[0] == '/' && First + 1 != End &&
+         (First[1] == '*' || First[1] == '/'))) {
+      if (First[0] == '/' && First[1] == '/')
+        skipLineComment(First, End);
+      else if (First[0] == '/')
+        skipBlockComment(First, End);
+      else
+        ++First;
+      NeedSpace = true;
+      continue;
+    }
+    if (NeedSpace)
+      Out.push_back(' ');
+    NeedSpace = false;
+    Out.push_back(*First++);
+  }
+  if (First == End) {
+    HadError = true;
+    Out.push_back('\n');
+    return;
+  }
+  append(";\n");
+  ++First;
+  skipLine(LineStart, First, End, HadError);
+}
+
+void Minimizer::minimizeLine(const char *&First, const char *const End) {
+  const char *const LineStart = First;
+  while (First != End) {
+    if (isHorizontalWhitespace(*First)) {
+      ++First;
+      continue;
+    }
+    if (unsigned Len = isEscapedNewline(First, End)) {
+      First += Len;
+      continue;
+    }
+    if (First[0] == '/' && First + 1 != End && First[1] == '*') {
+      const char *Begin = First;
+      if (!skipBlockComment(First, End))
+        HadError = true;
+      // A directive can't follow a comment that spans lines.
+      if (std::any_of(Begin, First, isVerticalWhitespace)) {
+        skipLine(LineStart, First, End, HadError);
+        return;
+      }
+      continue;
+    }
+    break;
+  }
+
+  if (First == End)
+    return;
+  if (*First == '#') {
+    lexDirective(First, End);
+    return;
+  }
+  StringRef Rest(First, End - First);
+  if (Rest.startswith("@import") &&
+      (Rest.size() == 7 || !isIdentifierBody(Rest[7]))) {
+    lexAtImport(First, End);
+    return;
+  }
+  skipLine(LineStart, First, End, HadError);
+}
+
+bool Minimizer::minimize(StringRef Input) {
+  const char *First = Input.begin();
+  const char *const End = Input.end();
+  // Skip a UTF-8 byte order mark.
+  if (Input.startswith("\xEF\xBB\xBF"))
+    First += 3;
+  while (First != End)
+    minimizeLine(First, End);
+  return HadError;
+}
+
+bool clang::minimizeSourceToDependencyDirectives(
+    StringRef Input, SmallVectorImpl<char> &Output) {
+  Output.clear();
+  return Minimizer(Output).minimize(Input);
+}
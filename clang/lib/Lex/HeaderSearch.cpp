@@ -94,6 +94,40 @@ void HeaderSearch::PrintStats() {
 
   fprintf(stderr, "%d framework lookups.\n", NumFrameworkLookups);
   fprintf(stderr, "%d subframework lookups.\n", NumSubFrameworkLookups);
+  if (PersistentCache)
+    fprintf(stderr, "%d persistent lookup cache hits, %d misses.\n",
+            PersistentCache->getNumHits(), PersistentCache->getNumMisses());
+}
+
+PersistentLookupFileCache *HeaderSearch::getPersistentLookupFileCache() {
+  if (PersistentCacheLoaded)
+    return PersistentCache.get();
+  PersistentCacheLoaded = true;
+  if (HSOpts->LookupFileCachePath.empty())
+    return nullptr;
+
+  // Identify the directories by absolute path, as compilations that share the
+  // cache may run in different working directories.
+  llvm::vfs::FileSystem &FS = FileMgr.getVirtualFileSystem();
+  std::vector<PersistentLookupFileCache::SearchDir> Dirs;
+  for (const DirectoryLookup &DL : SearchDirs) {
+    SmallString<256> Name(DL.getName());
+    FS.makeAbsolute(Name);
+    if (DL.isFramework())
+      Name.insert(Name.begin(), 'F');
+    else if (DL.isHeaderMap())
+      Name.insert(Name.begin(), 'H');
+    Dirs.push_back({Name.str(), DL.isNormalDir()});
+  }
+  PersistentCache = llvm::make_unique<PersistentLookupFileCache>(
+      HSOpts->LookupFileCachePath, Dirs, FS);
+  return PersistentCache.get();
+}
+
+void HeaderSearch::savePersistentLookupFileCache() {
+  // The cache is only an optimization, so failing to write it isn't an error.
+  if (PersistentCache)
+    PersistentCache->save();
 }
 
 /// CreateHeaderMap - This method returns a HeaderMap for the specified
@@ -849,6 +883,19 @@ const FileEntry *HeaderSearch::LookupFile(
     // our search start.  We will fill in our found location below, so prime the
     // start point value.
     CacheLookup.reset(/*StartIdx=*/i+1);
+
+    // Previous compilations with the same search directories may know where
+    // the file is. Only trust them if the file is still there.
+    PersistentLookupFileCache *PersistentCache =
+        SkipCache ? nullptr : getPersistentLookupFileCache();
+    if (PersistentCache) {
+      if (Optional<unsigned> HitIdx = PersistentCache->lookup(Filename, i)) {
+        SmallString<256> Path(SearchDirs[*HitIdx].getDir()->getName());
+        llvm::sys::path::append(Path, Filename);
+        if (FileMgr.getFile(Path))
+          i = *HitIdx;
+      }
+    }
   }
 
   SmallString<64> MappedName;
@@ -922,6 +969,10 @@ const FileEntry *HeaderSearch::LookupFile(
 
     // Remember this location for the next lookup we do.
     CacheLookup.HitIdx = i;
+    if (!SkipCache && !CacheLookup.MappedName)
+      if (PersistentLookupFileCache *PersistentCache =
+              getPersistentLookupFileCache())
+        PersistentCache->insert(Filename, CacheLookup.StartIdx - 1, i);
     return FE;
   }
 
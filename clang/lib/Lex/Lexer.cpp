@@ -47,8 +47,115 @@
 #include <tuple>
 #include <utility>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif __ALTIVEC__
+#include <altivec.h>
+#undef bool
+#endif
+
 using namespace clang;
 
+//===----------------------------------------------------------------------===//
+// Vectorized Scanning Helpers
+//===----------------------------------------------------------------------===//
+//
+// These skip 16 characters at a time over the runs that the lexer would
+// otherwise scan one character at a time. Each returns a pointer at or before
+// the first character that is not part of the run, so the caller always
+// finishes the run with its usual character-at-a-time loop. They never read
+// past End, which is the position of the buffer's nul terminator, and return
+// Ptr unchanged when there isn't a full block left or when the target has no
+// vector support.
+
+#ifdef __SSE2__
+/// Advances \p Ptr over whole blocks for which \p InRun returns a mask with
+/// all 16 bits set, and then to the first character of the next block whose
+/// bit is clear.
+template <typename MaskFn>
+static inline const char *skipRunSSE2(const char *Ptr, const char *End,
+                                      MaskFn InRun) {
+  while (Ptr + 16 <= End) {
+    unsigned Mask = InRun(_mm_loadu_si128((const __m128i *)Ptr));
+    if (Mask != 0xFFFF)
+      return Ptr + llvm::countTrailingZeros(~Mask);
+    Ptr += 16;
+  }
+  return Ptr;
+}
+
+/// Returns a mask of the bytes of \p V in the range [Lo, Hi]. Both bounds
+/// must be ASCII, so that bytes with the top bit set are excluded.
+static inline __m128i inRangeSSE2(__m128i V, char Lo, char Hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(V, _mm_set1_epi8(Lo - 1)),
+                       _mm_cmplt_epi8(V, _mm_set1_epi8(Hi + 1)));
+}
+#endif
+
+/// Skips over the characters that match [_A-Za-z0-9].
+static inline const char *skipIdentifierBodyFast(const char *Ptr,
+                                                 const char *End) {
+#ifdef __SSE2__
+  return skipRunSSE2(Ptr, End, [](__m128i V) {
+    // Setting bit 5 maps 'A'-'Z' to 'a'-'z' and leaves no other character in
+    // that range.
+    __m128i Lower = _mm_or_si128(V, _mm_set1_epi8(0x20));
+    __m128i Match = _mm_or_si128(inRangeSSE2(Lower, 'a', 'z'),
+                                 inRangeSSE2(V, '0', '9'));
+    Match = _mm_or_si128(Match, _mm_cmpeq_epi8(V, _mm_set1_epi8('_')));
+    return (unsigned)_mm_movemask_epi8(Match);
+  });
+#else
+  return Ptr;
+#endif
+}
+
+/// Skips over the characters that match [ \t\f\v].
+static inline const char *skipHorizontalWhitespaceFast(const char *Ptr,
+                                                       const char *End) {
+#ifdef __SSE2__
+  return skipRunSSE2(Ptr, End, [](__m128i V) {
+    __m128i Match = _mm_or_si128(_mm_cmpeq_epi8(V, _mm_set1_epi8(' ')),
+                                 _mm_cmpeq_epi8(V, _mm_set1_epi8('\t')));
+    Match = _mm_or_si128(Match, inRangeSSE2(V, '\v', '\f'));
+    return (unsigned)_mm_movemask_epi8(Match);
+  });
+#else
+  return Ptr;
+#endif
+}
+
+/// Skips over the characters that can't end a line comment, which are all but
+/// '\n', '\r' and '\0'.
+static inline const char *skipLineCommentBodyFast(const char *Ptr,
+                                                  const char *End) {
+#ifdef __SSE2__
+  return skipRunSSE2(Ptr, End, [](__m128i V) {
+    __m128i Stop = _mm_or_si128(_mm_cmpeq_epi8(V, _mm_set1_epi8('\n')),
+                                _mm_cmpeq_epi8(V, _mm_set1_epi8('\r')));
+    Stop = _mm_or_si128(Stop, _mm_cmpeq_epi8(V, _mm_setzero_si128()));
+    return ~(unsigned)_mm_movemask_epi8(Stop) & 0xFFFF;
+  });
+#else
+  return Ptr;
+#endif
+}
+
+/// Skips over the characters that can't end a raw string literal, which are
+/// all but ')' and '\0'.
+static inline const char *skipRawStringBodyFast(const char *Ptr,
+                                                const char *End) {
+#ifdef __SSE2__
+  return skipRunSSE2(Ptr, End, [](__m128i V) {
+    __m128i Stop = _mm_or_si128(_mm_cmpeq_epi8(V, _mm_set1_epi8(')')),
+                                _mm_cmpeq_epi8(V, _mm_setzero_si128()));
+    return ~(unsigned)_mm_movemask_epi8(Stop) & 0xFFFF;
+  });
+#else
+  return Ptr;
+#endif
+}
+
 //===----------------------------------------------------------------------===//
 // Token Class Implementation
 //===----------------------------------------------------------------------===//
@@ -1629,6 +1736,7 @@ bool Lexer::tryConsumeIdentifierUTF8Char(const char *&CurPtr) {
 bool Lexer::LexIdentifier(Token &Result, const char *CurPtr) {
   // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]
   unsigned Size;
+  CurPtr = skipIdentifierBodyFast(CurPtr, BufferEnd);
   unsigned char C = *CurPtr++;
   while (isIdentifierBody(C))
     C = *CurPtr++;
@@ -2005,6 +2113,7 @@ bool Lexer::LexRawStringLiteral(Token &Result, const char *CurPtr,
   CurPtr += PrefixLen + 1; // skip over prefix and '('
 
   while (true) {
+    CurPtr = skipRawStringBodyFast(CurPtr, BufferEnd);
     char C = *CurPtr++;
 
     if (C == ')') {
@@ -2184,6 +2293,10 @@ bool Lexer::SkipWhitespace(Token &Result, const char *CurPtr,
   // Skip consecutive spaces efficiently.
   while (true) {
     // Skip horizontal whitespace very aggressively.
+    if (isHorizontalWhitespace(Char)) {
+      CurPtr = skipHorizontalWhitespaceFast(CurPtr, BufferEnd);
+      Char = *CurPtr;
+    }
     while (isHorizontalWhitespace(Char))
       Char = *++CurPtr;
 
@@ -2253,6 +2366,7 @@ bool Lexer::SkipLineComment(Token &Result, const char *CurPtr,
   // character that ends the line comment.
   char C;
   while (true) {
+    CurPtr = skipLineCommentBodyFast(CurPtr, BufferEnd);
     C = *CurPtr;
     // Skip over characters in the fast loop.
     while (C != 0 &&                // Potentially EOF.
@@ -2460,13 +2574,6 @@ static bool isEndOfBlockCommentWithEscapedNewLine(const char *CurPtr,
   return true;
 }
 
-#ifdef __SSE2__
-#include <emmintrin.h>
-#elif __ALTIVEC__
-#include <altivec.h>
-#undef bool
-#endif
-
 /// We have just read from input the / and * characters that started a comment.
 /// Read until we find the * and / characters that terminate the comment.
 /// Note that we don't bother decoding trigraphs or escaped newlines in block
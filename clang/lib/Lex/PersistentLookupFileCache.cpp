@@ -0,0 +1,259 @@
+//===- PersistentLookupFileCache.cpp - Header search across TUs -----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the PersistentLookupFileCache class.
+//
+// The cache file is a text file that starts with a version line, followed by
+// a section for each search list:
+//
+//   list <hash> <number of directories> <number of entries>
+//   <state of each directory, one per line>
+//   <start index> <hit index> <spelling>, one line per entry
+//
+// The state of a directory is its modification time in nanoseconds, or '-' if
+// it doesn't exist or isn't cacheable.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/PersistentLookupFileCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+using namespace clang;
+
+static const char CacheVersion[] = "clang-lookup-file-cache 1";
+
+/// The number of search lists that are kept in a cache file. Lists that
+/// weren't used by the last compilations are dropped first.
+static const unsigned MaxSearchLists = 32;
+
+namespace {
+
+/// The contents of a cache file.
+struct CacheFileContents {
+  std::vector<PersistentLookupFileCache::DirState> States;
+  std::vector<std::pair<std::string, unsigned>> Entries;
+  /// The text of the sections of other search lists.
+  std::vector<std::string> OtherLists;
+};
+
+} // end anonymous namespace
+
+static std::string getEntryKey(StringRef Filename, unsigned StartIdx) {
+  return (Twine(StartIdx) + ":" + Filename).str();
+}
+
+/// Reads the text of the cache file at \p Path, taking the section of the
+/// search list \p ListHash with \p NumDirs directories apart. A file that
+/// doesn't exist or can't be parsed reads as an empty cache.
+static CacheFileContents readCacheFile(StringRef Path, uint64_t ListHash,
+                                       unsigned NumDirs) {
+  CacheFileContents Contents;
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return Contents;
+
+  SmallVector<StringRef, 0> Lines;
+  (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/false);
+  if (Lines.empty() || Lines[0] != CacheVersion)
+    return Contents;
+
+  for (size_t I = 1, E = Lines.size(); I != E;) {
+    SmallVector<StringRef, 4> Header;
+    Lines[I].split(Header, ' ');
+    uint64_t Hash;
+    unsigned SectionDirs, SectionEntries;
+    if (Header.size() != 4 || Header[0] != "list" ||
+        Header[1].getAsInteger(16, Hash) ||
+        Header[2].getAsInteger(10, SectionDirs) ||
+        Header[3].getAsInteger(10, SectionEntries) ||
+        E - I - 1 < (size_t)SectionDirs + SectionEntries)
+      return CacheFileContents();
+    size_t End = I + 1 + SectionDirs + SectionEntries;
+
+    if (Hash != ListHash || SectionDirs != NumDirs) {
+      std::string Text;
+      for (; I != End; ++I)
+        Text += (Lines[I] + "\n").str();
+      Contents.OtherLists.push_back(std::move(Text));
+      continue;
+    }
+
+    ++I;
+    for (unsigned D = 0; D != SectionDirs; ++D, ++I) {
+      int64_t MTime;
+      if (Lines[I] == "-")
+        Contents.States.push_back(None);
+      else if (!Lines[I].getAsInteger(10, MTime))
+        Contents.States.push_back(MTime);
+      else
+        return CacheFileContents();
+    }
+    for (; I != End; ++I) {
+      StringRef Start, Hit, Filename;
+      std::tie(Start, Filename) = Lines[I].split(' ');
+      std::tie(Hit, Filename) = Filename.split(' ');
+      unsigned StartIdx, HitIdx;
+      if (Start.getAsInteger(10, StartIdx) || Hit.getAsInteger(10, HitIdx) ||
+          StartIdx > HitIdx || HitIdx >= NumDirs || Filename.empty())
+        return CacheFileContents();
+      Contents.Entries.emplace_back(getEntryKey(Filename, StartIdx), HitIdx);
+    }
+  }
+  return Contents;
+}
+
+PersistentLookupFileCache::PersistentLookupFileCache(StringRef Path,
+                                                     ArrayRef<SearchDir> Dirs,
+                                                     llvm::vfs::FileSystem &FS)
+    : Path(Path), Dirs(Dirs.begin(), Dirs.end()), FS(FS),
+      CurrentStates(Dirs.size()) {
+  std::string HashInput;
+  for (const SearchDir &Dir : Dirs) {
+    HashInput += Dir.IsCacheable ? 'd' : 'x';
+    HashInput += Dir.Name;
+    HashInput += '\0';
+  }
+  ListHash = llvm::xxHash64(HashInput);
+
+  CacheFileContents Contents = readCacheFile(Path, ListHash, Dirs.size());
+  RecordedStates = std::move(Contents.States);
+  for (auto &Entry : Contents.Entries)
+    LoadedEntries[Entry.first] = Entry.second;
+}
+
+PersistentLookupFileCache::DirState
+PersistentLookupFileCache::getCurrentState(unsigned Idx) {
+  Optional<DirState> &State = CurrentStates[Idx];
+  if (!State) {
+    State = DirState();
+    if (Dirs[Idx].IsCacheable) {
+      llvm::ErrorOr<llvm::vfs::Status> Status = FS.status(Dirs[Idx].Name);
+      if (Status && Status->isDirectory())
+        *State = Status->getLastModificationTime().time_since_epoch().count();
+    }
+  }
+  return *State;
+}
+
+bool PersistentLookupFileCache::isUnchanged(unsigned Begin, unsigned End) {
+  if (RecordedStates.size() != Dirs.size())
+    return false;
+  for (unsigned Idx = Begin; Idx <= End; ++Idx)
+    if (!Dirs[Idx].IsCacheable || getCurrentState(Idx) != RecordedStates[Idx])
+      return false;
+  return true;
+}
+
+Optional<unsigned> PersistentLookupFileCache::lookup(StringRef Filename,
+                                                     unsigned StartIdx) {
+  std::string Key = getEntryKey(Filename, StartIdx);
+  auto It = NewEntries.find(Key);
+  if (It != NewEntries.end()) {
+    ++NumHits;
+    return It->second;
+  }
+  It = LoadedEntries.find(Key);
+  if (It != LoadedEntries.end() && isUnchanged(StartIdx, It->second)) {
+    ++NumHits;
+    return It->second;
+  }
+  ++NumMisses;
+  return None;
+}
+
+void PersistentLookupFileCache::insert(StringRef Filename, unsigned StartIdx,
+                                       unsigned HitIdx) {
+  assert(StartIdx <= HitIdx && HitIdx < Dirs.size() && "Invalid entry");
+  for (unsigned Idx = StartIdx; Idx <= HitIdx; ++Idx)
+    if (!Dirs[Idx].IsCacheable)
+      return;
+  NewEntries[getEntryKey(Filename, StartIdx)] = HitIdx;
+}
+
+bool PersistentLookupFileCache::save() {
+  if (NewEntries.empty())
+    return false;
+
+  // Merge with the entries that other compilations saved since this one
+  // loaded the file. All entries that are kept must be valid for the current
+  // states of the directories, which is what the file will record.
+  CacheFileContents Contents = readCacheFile(Path, ListHash, Dirs.size());
+  std::vector<std::pair<StringRef, unsigned>> Entries;
+  auto IsValid = [&](StringRef Key, unsigned HitIdx,
+                     ArrayRef<DirState> States) {
+    unsigned StartIdx;
+    if (Key.split(':').first.getAsInteger(10, StartIdx) ||
+        States.size() != Dirs.size())
+      return false;
+    for (unsigned Idx = StartIdx; Idx <= HitIdx; ++Idx)
+      if (!Dirs[Idx].IsCacheable || getCurrentState(Idx) != States[Idx])
+        return false;
+    return true;
+  };
+  llvm::StringMap<unsigned> Merged = NewEntries;
+  for (auto &Entry : LoadedEntries)
+    if (IsValid(Entry.getKey(), Entry.getValue(), RecordedStates))
+      Merged.insert({Entry.getKey(), Entry.getValue()});
+  for (auto &Entry : Contents.Entries)
+    if (IsValid(Entry.first, Entry.second, Contents.States))
+      Merged.insert({Entry.first, Entry.second});
+
+  std::string Text;
+  llvm::raw_string_ostream OS(Text);
+  OS << CacheVersion << '\n';
+  OS << "list " << llvm::utohexstr(ListHash) << ' ' << Dirs.size() << ' '
+     << Merged.size() << '\n';
+  for (unsigned Idx = 0, E = Dirs.size(); Idx != E; ++Idx) {
+    if (DirState State = getCurrentState(Idx))
+      OS << *State << '\n';
+    else
+      OS << "-\n";
+  }
+  for (auto &Entry : Merged) {
+    StringRef Start, Filename;
+    std::tie(Start, Filename) = Entry.getKey().split(':');
+    OS << Start << ' ' << Entry.getValue() << ' ' << Filename << '\n';
+  }
+  for (unsigned I = 0, E = std::min<size_t>(Contents.OtherLists.size(),
+                                            MaxSearchLists - 1);
+       I != E; ++I)
+    OS << Contents.OtherLists[I];
+  OS.flush();
+
+  // Write to a temporary file and rename it over the cache, so that readers
+  // never see a partially written file.
+  int FD;
+  SmallString<128> TempPath;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD, TempPath))
+    return true;
+  {
+    llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+    Out << Text;
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return true;
+    }
+  }
+  if (llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return true;
+  }
+  NewEntries.clear();
+  return false;
+}
@@ -13,6 +13,7 @@
 #include "clang/Parse/ParseAST.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/AST/ASTMemoryUsage.h"
 #include "clang/AST/ExternalASTSource.h"
 #include "clang/AST/Stmt.h"
 #include "clang/Parse/ParseDiagnostic.h"
@@ -182,6 +183,7 @@ void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
     llvm::errs() << "\nSTATISTICS:\n";
     if (HaveLexer) P.getActions().PrintStats();
     S.getASTContext().PrintStats();
+    ASTMemoryUsage(S.getASTContext()).print(llvm::errs());
     Decl::PrintStats();
     Stmt::PrintStats();
     Consumer->PrintStats();
@@ -1371,6 +1371,10 @@ void Sema::PushOnScopeChains(NamedDecl *D, Scope *S, bool AddToContext) {
   while (S->getEntity() && S->getEntity()->isTransparentContext())
     S = S->getParent();
 
+  // A substitution can find any non-local declaration.
+  if (!D->getLexicalDeclContext()->isFunctionOrMethod())
+    invalidateSubstitutionFailures();
+
   // Add scoped declarations into their context, so that they can be
   // found later. Declarations without a context won't be inserted
   // into any context.
@@ -11084,6 +11088,10 @@ void Sema::AddInitializerToDecl(Decl *RealDecl, Expr *Init, bool DirectInit) {
     return;
   }
 
+  // A substitution can use the value of a non-local constant.
+  if (!VDecl->isLocalVarDeclOrParm())
+    invalidateSubstitutionFailures();
+
   // C++11 [decl.spec.auto]p6. Deduce the type which 'auto' stands in for.
   if (VDecl->getType()->isUndeducedType()) {
     // Attempt typo correction early so that the type of the init expression can
@@ -13245,6 +13253,12 @@ Decl *Sema::ActOnFinishFunctionBody(Decl *dcl, Stmt *Body,
     FD->setBody(Body);
     FD->setWillHaveBody(false);
 
+    // A substitution can call a constexpr function or use the deduced return
+    // type of a function, which require the body.
+    if (FD->isConstexpr() ||
+        FD->getDeclaredReturnType()->getContainedDeducedType())
+      invalidateSubstitutionFailures();
+
     if (getLangOpts().CPlusPlus14) {
       if (!FD->isInvalidDecl() && Body && !FD->isDependentContext() &&
           FD->getReturnType()->isUndeducedType()) {
@@ -15168,6 +15182,9 @@ void Sema::ActOnTagFinishDefinition(Scope *S, Decl *TagD,
   TagDecl *Tag = cast<TagDecl>(TagD);
   Tag->setBraceRange(BraceRange);
 
+  // A substitution can depend on the completeness of any type.
+  invalidateSubstitutionFailures();
+
   // Make sure we "complete" the definition even it is invalid.
   if (Tag->isBeingDefined()) {
     assert(Tag->isInvalidDecl() && "We should already have completed it");
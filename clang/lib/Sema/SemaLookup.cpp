@@ -1342,6 +1342,8 @@ bool Sema::CppLookupName(LookupResult &R, Scope *S) {
 }
 
 void Sema::makeMergedDefinitionVisible(NamedDecl *ND) {
+  invalidateSubstitutionFailures();
+
   if (auto *M = getCurrentModule())
     Context.mergeDefinitionIntoModule(ND, M);
   else
@@ -343,6 +343,7 @@ DeclResult Sema::ActOnModuleImport(SourceLocation StartLoc,
                                    SourceLocation ImportLoc,
                                    Module *Mod, ModuleIdPath Path) {
   VisibleModules.setVisible(Mod, ImportLoc);
+  invalidateSubstitutionFailures();
 
   checkModuleImportContext(*this, Mod, ImportLoc, CurContext);
 
@@ -433,6 +434,7 @@ void Sema::BuildModuleInclude(SourceLocation DirectiveLoc, Module *Mod) {
 
   getModuleLoader().makeModuleVisible(Mod, Module::AllVisible, DirectiveLoc);
   VisibleModules.setVisible(Mod, DirectiveLoc);
+  invalidateSubstitutionFailures();
 }
 
 void Sema::ActOnModuleBegin(SourceLocation DirectiveLoc, Module *Mod) {
@@ -444,6 +446,7 @@ void Sema::ActOnModuleBegin(SourceLocation DirectiveLoc, Module *Mod) {
     ModuleScopes.back().OuterVisibleModules = std::move(VisibleModules);
 
   VisibleModules.setVisible(Mod, DirectiveLoc);
+  invalidateSubstitutionFailures();
 
   // The enclosing context is now part of this module.
   // FIXME: Consider creating a child DeclContext to hold the entities
@@ -516,6 +519,7 @@ void Sema::createImplicitModuleImportForErrorRecovery(SourceLocation Loc,
   // Make the module visible.
   getModuleLoader().makeModuleVisible(Mod, Module::AllVisible, Loc);
   VisibleModules.setVisible(Mod, Loc);
+  invalidateSubstitutionFailures();
 }
 
 /// We have parsed the start of an export declaration, including the '{'
@@ -51,6 +51,7 @@
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/TimeProfiler.h"
 #include <algorithm>
 #include <cassert>
 #include <tuple>
@@ -3350,6 +3351,60 @@ Sema::TemplateDeductionResult Sema::FinishTemplateArgumentDeduction(
     = TemplateArgumentList::CreateCopy(Context, Builder);
   Info.reset(DeducedArgumentList);
 
+  // Substitutions are too frequent to be traced by default.
+  Optional<llvm::TimeTraceScope> TimeScope;
+  if (TimeTraceTemplates)
+    TimeScope.emplace("SubstituteDeducedTemplateArguments", [&]() {
+      return getTimeTraceDetail(FunctionTemplate, Builder);
+    });
+
+  // If substituting these arguments already failed, and nothing that the
+  // substitution could depend on has been declared since, replay the
+  // failure. The converted arguments are canonical, so the key is too.
+  bool Memoize = getLangOpts().MemoizeSubstitutionFailures &&
+                 !PartialOverloading && ArgumentPackSubstitutionIndex == -1;
+  llvm::FoldingSetNodeID FailureKey;
+  if (Memoize) {
+    FailureKey.AddPointer(FunctionTemplate);
+    for (const TemplateArgument &Arg : Builder)
+      Arg.Profile(FailureKey, Context);
+    void *InsertPos;
+    MemoizedSubstitutionFailure *Failure =
+        SubstitutionFailures.FindNodeOrInsertPos(FailureKey, InsertPos);
+    if (Failure && Failure->Generation == SubstitutionFailureGeneration) {
+      if (Failure->Diagnostic)
+        Info.addSFINAEDiagnostic(Failure->Diagnostic->first,
+                                 Failure->Diagnostic->second);
+      Specialization = Failure->Specialization;
+      return TDK_SubstitutionFailure;
+    }
+  }
+
+  // Only failures that are due to SFINAE are memoized; hard errors, such as
+  // exceeding the instantiation depth, depend on where we are.
+  unsigned Generation = SubstitutionFailureGeneration;
+  DiagnosticErrorTrap HardErrors(getDiagnostics());
+  auto SubstitutionFailed = [&]() -> TemplateDeductionResult {
+    if (!Memoize || HardErrors.hasErrorOccurred())
+      return TDK_SubstitutionFailure;
+    // The substitution may have memoized failures of its own, so the
+    // insertion position has to be recomputed.
+    void *InsertPos;
+    MemoizedSubstitutionFailure *Failure =
+        SubstitutionFailures.FindNodeOrInsertPos(FailureKey, InsertPos);
+    if (!Failure) {
+      SubstitutionFailureStorage.emplace_back(FailureKey);
+      Failure = &SubstitutionFailureStorage.back();
+      SubstitutionFailures.InsertNode(Failure, InsertPos);
+    }
+    Failure->Generation = Generation;
+    Failure->Specialization = Specialization;
+    Failure->Diagnostic.reset();
+    if (Info.hasSFINAEDiagnostic())
+      Failure->Diagnostic = Info.peekSFINAEDiagnostic();
+    return TDK_SubstitutionFailure;
+  };
+
   // Substitute the deduced template arguments into the function template
   // declaration to produce the function template specialization.
   DeclContext *Owner = FunctionTemplate->getDeclContext();
@@ -3359,7 +3414,7 @@ Sema::TemplateDeductionResult Sema::FinishTemplateArgumentDeduction(
   Specialization = cast_or_null<FunctionDecl>(
       SubstDecl(FunctionTemplate->getTemplatedDecl(), Owner, SubstArgs));
   if (!Specialization || Specialization->isInvalidDecl())
-    return TDK_SubstitutionFailure;
+    return SubstitutionFailed();
 
   assert(Specialization->getPrimaryTemplate()->getCanonicalDecl() ==
          FunctionTemplate->getCanonicalDecl());
@@ -3375,7 +3430,7 @@ Sema::TemplateDeductionResult Sema::FinishTemplateArgumentDeduction(
   // failure.
   if (Trap.hasErrorOccurred()) {
     Specialization->setInvalidDecl(true);
-    return TDK_SubstitutionFailure;
+    return SubstitutionFailed();
   }
 
   if (OriginalCallArgs) {
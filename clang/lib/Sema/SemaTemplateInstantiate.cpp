@@ -662,6 +662,48 @@ void Sema::PrintInstantiationStack() {
   }
 }
 
+static void printSynthesizedEntity(raw_ostream &OS, const NamedDecl *D,
+                                   ArrayRef<TemplateArgument> Args,
+                                   const PrintingPolicy &Policy) {
+  D->getNameForDiagnostic(OS, Policy, /*Qualified=*/true);
+  if (isa<TemplateDecl>(D) && !Args.empty())
+    printTemplateArgumentList(OS, Args, Policy);
+}
+
+std::string Sema::getTimeTraceDetail(const NamedDecl *Entity,
+                                     ArrayRef<TemplateArgument> Args) {
+  std::string Detail;
+  llvm::raw_string_ostream OS(Detail);
+  const PrintingPolicy &Policy = getPrintingPolicy();
+  printSynthesizedEntity(OS, Entity, Args, Policy);
+  if (!TimeTraceTemplates)
+    return OS.str();
+
+  // Append the entities that required this one, innermost first, with the
+  // same limit as the instantiation stack of diagnostics.
+  unsigned Limit = Diags.getTemplateBacktraceLimit();
+  unsigned Printed = 0;
+  for (const CodeSynthesisContext &Active :
+       llvm::reverse(CodeSynthesisContexts)) {
+    const auto *D = dyn_cast_or_null<NamedDecl>(Active.Entity);
+    // The context of Entity itself may already have been entered.
+    if (!D || (D == Entity && Printed == 0))
+      continue;
+    if (Limit && Printed++ == Limit) {
+      OS << " <- ...";
+      break;
+    }
+    OS << " <- ";
+    printSynthesizedEntity(
+        OS, D,
+        Active.Kind == CodeSynthesisContext::DeclaringSpecialMember
+            ? ArrayRef<TemplateArgument>()
+            : Active.template_arguments(),
+        Policy);
+  }
+  return OS.str();
+}
+
 Optional<TemplateDeductionInfo *> Sema::isSFINAEContext() const {
   if (InNonInstantiationSFINAEContext)
     return Optional<TemplateDeductionInfo *>(nullptr);
@@ -2022,11 +2064,7 @@ Sema::InstantiateClass(SourceLocation PointOfInstantiation,
     return true;
 
   llvm::TimeTraceScope TimeScope("InstantiateClass", [&]() {
-    std::string Name;
-    llvm::raw_string_ostream OS(Name);
-    Instantiation->getNameForDiagnostic(OS, getPrintingPolicy(),
-                                        /*Qualified=*/true);
-    return Name;
+    return getTimeTraceDetail(Instantiation);
   });
 
   Pattern = PatternDef;
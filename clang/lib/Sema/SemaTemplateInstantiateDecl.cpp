@@ -4156,11 +4156,7 @@ void Sema::InstantiateFunctionDefinition(SourceLocation PointOfInstantiation,
   }
 
   llvm::TimeTraceScope TimeScope("InstantiateFunction", [&]() {
-    std::string Name;
-    llvm::raw_string_ostream OS(Name);
-    Function->getNameForDiagnostic(OS, getPrintingPolicy(),
-                                   /*Qualified=*/true);
-    return Name;
+    return getTimeTraceDetail(Function);
   });
 
   // If we're performing recursive template instantiation, create our own
@@ -113,10 +113,13 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/VersionTuple.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -2093,6 +2096,70 @@ ASTReader::readInputFileInfo(ModuleFile &F, unsigned ID) {
   return R;
 }
 
+bool ASTReader::haveUnmodifiedInputFiles(ModuleFile &F, unsigned NumInputs) {
+  // With fewer inputs, handing the stats to other threads doesn't pay off.
+  const unsigned MinInputs = 32;
+  const unsigned InputsPerTask = 16;
+  const unsigned MaxThreads = 8;
+  if (NumInputs < MinInputs || !llvm::llvm_is_multithreaded())
+    return false;
+
+  // Only the real file system is known to be safe to use from several
+  // threads. Remapped files may override inputs, which getInputFile
+  // diagnoses.
+  const PreprocessorOptions &PPOpts = PP.getPreprocessorOpts();
+  llvm::vfs::FileSystem &FS = FileMgr.getVirtualFileSystem();
+  if (&FS != llvm::vfs::getRealFileSystem().get() ||
+      !PPOpts.RemappedFiles.empty() || !PPOpts.RemappedFileBuffers.empty())
+    return false;
+
+  struct PendingInput {
+    std::string Filename;
+    off_t StoredSize;
+    time_t StoredTime;
+  };
+  std::vector<PendingInput> Pending;
+  for (unsigned I = 0; I < NumInputs; ++I) {
+    const InputFile &IF = F.InputFilesLoaded[I];
+    if (IF.isNotFound() || IF.isOutOfDate())
+      return false;
+    if (IF.getFile())
+      continue;
+
+    // Overridden and transient files have no contents to check, and the
+    // stored name of a file that moved has to be resolved by getInputFile.
+    InputFileInfo FI = readInputFileInfo(F, I + 1);
+    if (FI.Overridden || FI.Transient)
+      return false;
+    SmallString<256> Filename(FI.Filename);
+    FileMgr.FixupRelativePath(Filename);
+    Pending.push_back({Filename.str(), FI.StoredSize, FI.StoredTime});
+  }
+
+  if (!InputFileValidationPool)
+    InputFileValidationPool = llvm::make_unique<llvm::ThreadPool>(
+        std::min(llvm::hardware_concurrency(), MaxThreads));
+
+  std::atomic<bool> Unmodified(true);
+  for (size_t Begin = 0; Begin < Pending.size(); Begin += InputsPerTask) {
+    size_t End = std::min<size_t>(Begin + InputsPerTask, Pending.size());
+    InputFileValidationPool->async([&, Begin, End] {
+      for (size_t I = Begin; I != End && Unmodified; ++I) {
+        const PendingInput &Input = Pending[I];
+        llvm::ErrorOr<llvm::vfs::Status> Status = FS.status(Input.Filename);
+        if (!Status || Status->isDirectory() ||
+            off_t(Status->getSize()) != Input.StoredSize ||
+            (Input.StoredTime &&
+             llvm::sys::toTimeT(Status->getLastModificationTime()) !=
+                 Input.StoredTime))
+          Unmodified = false;
+      }
+    });
+  }
+  InputFileValidationPool->wait();
+  return Unmodified;
+}
+
 static unsigned moduleKindForDiagnostic(ModuleKind Kind);
 InputFile ASTReader::getInputFile(ModuleFile &F, unsigned ID, bool Complain) {
   // If this ID is bogus, just return an empty input file.
@@ -2396,10 +2463,22 @@ ASTReader::ReadControlBlock(ModuleFile &F,
              F.Kind == MK_ImplicitModule))
           N = NumInputs;
 
-        for (unsigned I = 0; I < N; ++I) {
-          InputFile IF = getInputFile(F, I+1, Complain);
-          if (!IF.getFile() || IF.isOutOfDate())
-            return OutOfDate;
+        // A module that was built or validated during this build session
+        // can be trusted not to have changed since.
+        if (HSOpts.ModulesValidateOncePerBuildSession &&
+            HSOpts.ModulesTrustBuildSession &&
+            F.InputFilesValidationTimestamp > HSOpts.BuildSessionTimestamp &&
+            F.Kind == MK_ImplicitModule)
+          N = 0;
+
+        // Input files that are known to be unmodified are loaded lazily.
+        // Otherwise, load them now to diagnose the modified ones.
+        if (!haveUnmodifiedInputFiles(F, N)) {
+          for (unsigned I = 0; I < N; ++I) {
+            InputFile IF = getInputFile(F, I+1, Complain);
+            if (!IF.getFile() || IF.isOutOfDate())
+              return OutOfDate;
+          }
         }
       }
 
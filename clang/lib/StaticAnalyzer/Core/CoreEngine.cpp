@@ -45,6 +45,8 @@ STATISTIC(NumSteps,
             "The # of steps executed.");
 STATISTIC(NumReachedMaxSteps,
             "The # of times we reached the max number of steps.");
+STATISTIC(NumReachedMaxMemory,
+            "The # of times we reached the max amount of memory.");
 STATISTIC(NumPathsExplored,
             "The # of paths explored by the analyzer.");
 
@@ -74,7 +76,8 @@ static std::unique_ptr<WorkList> generateWorkList(AnalyzerOptions &Opts,
 CoreEngine::CoreEngine(SubEngine &subengine, FunctionSummariesTy *FS,
                        AnalyzerOptions &Opts)
     : SubEng(subengine), WList(generateWorkList(Opts, subengine)),
-      BCounterFactory(G.getAllocator()), FunctionSummaries(FS) {}
+      BCounterFactory(G.getAllocator()), FunctionSummaries(FS),
+      MaxMemory(size_t(Opts.MaxMemoryPerTopLevelFunction) << 20) {}
 
 /// ExecuteWorkList - Run the worklist algorithm for a maximum number of steps.
 bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
@@ -126,6 +129,11 @@ bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
   if(!UnlimitedSteps)
     G.reserve(std::min(Steps,PreReservationCap));
 
+  // Computing the allocated memory walks all slabs of the allocator, so only
+  // check the memory limit every so often.
+  const unsigned MemoryCheckInterval = 1024;
+  unsigned StepsUntilMemoryCheck = MemoryCheckInterval;
+
   while (WList->hasWork()) {
     if (!UnlimitedSteps) {
       if (Steps == 0) {
@@ -135,6 +143,16 @@ bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
       --Steps;
     }
 
+    if (MaxMemory != 0 && --StepsUntilMemoryCheck == 0) {
+      StepsUntilMemoryCheck = MemoryCheckInterval;
+      // The program states, the environment and the store are allocated with
+      // the allocator of the graph as well.
+      if (G.getAllocator().getTotalMemory() > MaxMemory) {
+        NumReachedMaxMemory++;
+        break;
+      }
+    }
+
     NumSteps++;
 
     const WorkListUnit& WU = WList->dequeue();
@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Tooling/AllTUsExecution.h"
+#include "clang/Tooling/CachingFileSystem.h"
 #include "clang/Tooling/ToolExecutorPluginRegistry.h"
 #include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/VirtualFileSystem.h"
@@ -59,6 +60,13 @@ llvm::cl::opt<std::string>
                           "This flag only applies to all-TUs."),
            llvm::cl::init(".*"));
 
+static llvm::cl::opt<bool> ExecutorFileCache(
+    "execute-file-cache",
+    llvm::cl::desc("Share the status and the contents of the files that are "
+                   "read between all files processed in parallel. "
+                   "This flag only applies to all-TUs."),
+    llvm::cl::init(true));
+
 AllTUsToolExecutor::AllTUsToolExecutor(
     const CompilationDatabase &Compilations, unsigned ThreadCount,
     std::shared_ptr<PCHContainerOperations> PCHContainerOps)
@@ -112,6 +120,11 @@ llvm::Error AllTUsToolExecutor::execute(
 
   auto &Action = Actions.front();
 
+  // Most headers are included by many TUs, so the threads share the status
+  // and the contents of the files they read instead of reading each header
+  // again for every TU. Files that change during the run are read again.
+  SharedFileSystemCache FileCache;
+
   {
     llvm::ThreadPool Pool(ThreadCount == 0 ? llvm::hardware_concurrency()
                                            : ThreadCount);
@@ -124,6 +137,8 @@ llvm::Error AllTUsToolExecutor::execute(
             // concurrent working directories.
             IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS =
                 llvm::vfs::createPhysicalFileSystem().release();
+            if (ExecutorFileCache)
+              FS = new CachingFileSystem(FileCache, std::move(FS));
             ClangTool Tool(Compilations, {Path},
                            std::make_shared<PCHContainerOperations>(), FS);
             Tool.appendArgumentsAdjuster(Action.second);
@@ -0,0 +1,182 @@
+//===- CachingFileSystem.cpp - Shared file system cache for tools ---------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/CachingFileSystem.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Path.h"
+
+using namespace clang;
+using namespace tooling;
+
+/// Returns true if \p A and \p B describe the same version of a file, or the
+/// same failure to find one. Like make, this trusts the modification time and
+/// the size of a file to tell whether it changed.
+static bool isSameStatus(const llvm::ErrorOr<llvm::vfs::Status> &A,
+                         const llvm::ErrorOr<llvm::vfs::Status> &B) {
+  if (!A || !B)
+    return !A && !B && A.getError() == B.getError();
+  return A->getType() == B->getType() &&
+         A->getLastModificationTime() == B->getLastModificationTime() &&
+         A->getSize() == B->getSize();
+}
+
+unsigned SharedFileSystemCache::invalidateChangedFiles(
+    llvm::vfs::FileSystem &FS) {
+  unsigned Dropped = 0;
+  Entries.forEach([&](llvm::StringMapEntry<Entry> &KV) {
+    Entry &E = KV.getValue();
+    std::lock_guard<std::mutex> LockGuard(E.Lock);
+    if (!E.HasStatus || isSameStatus(E.Status, FS.status(KV.getKey())))
+      return;
+    E.HasStatus = false;
+    E.Status = std::error_code();
+    E.Contents.reset();
+    ++Dropped;
+  });
+  return Dropped;
+}
+
+llvm::ErrorOr<SharedFileSystemCache::Entry *>
+CachingFileSystem::getEntry(StringRef Path) {
+  SmallString<256> Key(Path);
+  // The working directory differs between the threads that share the cache.
+  if (std::error_code EC = makeAbsolute(Key))
+    return EC;
+  llvm::sys::path::remove_dots(Key);
+  return &Cache.Entries.insert(Key).first->getValue();
+}
+
+void CachingFileSystem::updateStatus(SharedFileSystemCache::Entry &E,
+                                     StringRef Path) {
+  llvm::ErrorOr<llvm::vfs::Status> Status = getUnderlyingFS().status(Path);
+  if (E.HasStatus && !isSameStatus(E.Status, Status))
+    E.Contents.reset();
+  E.HasStatus = true;
+  E.Status = std::move(Status);
+}
+
+llvm::ErrorOr<llvm::vfs::Status>
+CachingFileSystem::status(const Twine &Path) {
+  SmallString<256> OwnedPath;
+  StringRef Filename = Path.toStringRef(OwnedPath);
+  llvm::ErrorOr<SharedFileSystemCache::Entry *> MaybeEntry =
+      getEntry(Filename);
+  if (!MaybeEntry)
+    return MaybeEntry.getError();
+
+  SharedFileSystemCache::Entry &E = **MaybeEntry;
+  std::lock_guard<std::mutex> LockGuard(E.Lock);
+  if (E.HasStatus) {
+    ++Cache.Stats.StatusHits;
+  } else {
+    ++Cache.Stats.StatusMisses;
+    updateStatus(E, Filename);
+  }
+  if (!E.Status)
+    return E.Status.getError();
+  return llvm::vfs::Status::copyWithNewName(*E.Status, Filename);
+}
+
+namespace {
+
+/// A MemoryBuffer that views the contents of a cache entry and keeps them
+/// alive.
+class SharedMemoryBuffer final : public llvm::MemoryBuffer {
+public:
+  SharedMemoryBuffer(std::shared_ptr<llvm::MemoryBuffer> Contents,
+                     std::string Name)
+      : Contents(std::move(Contents)), Name(std::move(Name)) {
+    // The cached contents are always read with a null terminator.
+    init(this->Contents->getBufferStart(), this->Contents->getBufferEnd(),
+         /*RequiresNullTerminator=*/true);
+  }
+
+  StringRef getBufferIdentifier() const override { return Name; }
+
+  BufferKind getBufferKind() const override {
+    return Contents->getBufferKind();
+  }
+
+private:
+  std::shared_ptr<llvm::MemoryBuffer> Contents;
+  std::string Name;
+};
+
+/// The file that is returned by openFileForRead for a cached file.
+class CachedFile final : public llvm::vfs::File {
+public:
+  CachedFile(std::shared_ptr<llvm::MemoryBuffer> Contents,
+             llvm::vfs::Status Status)
+      : Contents(std::move(Contents)), Status(std::move(Status)) {}
+
+  llvm::ErrorOr<llvm::vfs::Status> status() override { return Status; }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+  getBuffer(const Twine &Name, int64_t FileSize, bool RequiresNullTerminator,
+            bool IsVolatile) override {
+    return llvm::make_unique<SharedMemoryBuffer>(Contents, Name.str());
+  }
+
+  std::error_code close() override { return {}; }
+
+private:
+  std::shared_ptr<llvm::MemoryBuffer> Contents;
+  llvm::vfs::Status Status;
+};
+
+} // end anonymous namespace
+
+llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+CachingFileSystem::openFileForRead(const Twine &Path) {
+  SmallString<256> OwnedPath;
+  StringRef Filename = Path.toStringRef(OwnedPath);
+  llvm::ErrorOr<SharedFileSystemCache::Entry *> MaybeEntry =
+      getEntry(Filename);
+  if (!MaybeEntry)
+    return MaybeEntry.getError();
+
+  SharedFileSystemCache::Entry &E = **MaybeEntry;
+  std::lock_guard<std::mutex> LockGuard(E.Lock);
+  // A fresh status drops the contents if the file changed since they were
+  // read.
+  if (!E.HasStatus || (E.Contents && Cache.ValidateContents))
+    updateStatus(E, Filename);
+  if (!E.Status)
+    return E.Status.getError();
+  if (E.Status->isDirectory())
+    return std::make_error_code(std::errc::is_a_directory);
+
+  if (E.Contents) {
+    ++Cache.Stats.ContentsHits;
+  } else {
+    ++Cache.Stats.ContentsMisses;
+    llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> MaybeFile =
+        getUnderlyingFS().openFileForRead(Filename);
+    if (!MaybeFile)
+      return MaybeFile.getError();
+    llvm::vfs::File &F = **MaybeFile;
+    // The status of the opened file describes the contents that are read.
+    llvm::ErrorOr<llvm::vfs::Status> Status = F.status();
+    if (!Status)
+      return Status.getError();
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+        F.getBuffer(Filename, Status->getSize(),
+                    /*RequiresNullTerminator=*/false, /*IsVolatile=*/false);
+    if (!Buffer)
+      return Buffer.getError();
+    // Keep a copy of the contents, so that the cache doesn't hold a mapping
+    // for every file, and doesn't depend on the lifetime of the buffers of
+    // the underlying file system, which may only be views of its own storage.
+    E.Status = std::move(*Status);
+    E.Contents = llvm::MemoryBuffer::getMemBufferCopy((*Buffer)->getBuffer(),
+                                                      Filename);
+  }
+
+  return llvm::make_unique<CachedFile>(
+      E.Contents, llvm::vfs::Status::copyWithNewName(*E.Status, Filename));
+}
@@ -0,0 +1,174 @@
+//===- DependencyScanningFilesystem.cpp - Caching scanner VFS -------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/DependencyScanning/DependencyScanningFilesystem.h"
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+
+using namespace clang;
+using namespace tooling;
+using namespace dependencies;
+
+CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
+    StringRef Filename, llvm::vfs::FileSystem &FS, bool Minimize) {
+  // Load the file and its content from the file system.
+  llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> MaybeFile =
+      FS.openFileForRead(Filename);
+  if (!MaybeFile)
+    return MaybeFile.getError();
+  llvm::ErrorOr<llvm::vfs::Status> Stat = (*MaybeFile)->status();
+  if (!Stat)
+    return Stat.getError();
+
+  llvm::vfs::File &F = **MaybeFile;
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> MaybeBuffer =
+      F.getBuffer(Stat->getName());
+  if (!MaybeBuffer)
+    return MaybeBuffer.getError();
+  StringRef Buffer = (*MaybeBuffer)->getBuffer();
+
+  CachedFileSystemEntry Result;
+  // Fall back to the original contents if the file can't be minimized.
+  if (!Minimize ||
+      minimizeSourceToDependencyDirectives(Buffer, Result.Contents))
+    Result.Contents = Buffer;
+  // Null terminate the contents without changing their size.
+  Result.Contents.push_back('\0');
+  Result.Contents.pop_back();
+
+  // The stat value must report the size of the contents that are served.
+  Result.MaybeStat = llvm::vfs::Status(
+      Stat->getName(), Stat->getUniqueID(), Stat->getLastModificationTime(),
+      Stat->getUser(), Stat->getGroup(), Result.Contents.size(),
+      Stat->getType(), Stat->getPermissions());
+  return Result;
+}
+
+CachedFileSystemEntry
+CachedFileSystemEntry::createDirectoryEntry(llvm::vfs::Status &&Stat) {
+  assert(Stat.isDirectory() && "not a directory!");
+  CachedFileSystemEntry Result;
+  Result.MaybeStat = std::move(Stat);
+  return Result;
+}
+
+/// Returns true if the file is a source file that can be minimized. Other
+/// files that are read through the file system, such as module maps, header
+/// maps, precompiled headers and sanitizer blacklists, must be read as they
+/// are.
+static bool shouldMinimize(StringRef Filename) {
+  StringRef Ext = llvm::sys::path::extension(Filename);
+  // Standard library headers usually don't have an extension.
+  if (Ext.empty())
+    return true;
+  return llvm::StringSwitch<bool>(Ext.drop_front())
+      .Cases("h", "hh", "hpp", "hxx", "h++", "inc", "def", "inl", "ipp", true)
+      .Cases("tcc", "c", "cc", "cpp", "cxx", "c++", "C", "i", "ii", true)
+      .Cases("m", "mm", "cu", "cuh", "cl", true)
+      .Default(false);
+}
+
+llvm::ErrorOr<const CachedFileSystemEntry *>
+DependencyScanningWorkerFilesystem::getOrCreateFileSystemEntry(
+    const StringRef Filename) {
+  SmallString<256> Path(Filename);
+  // Key the caches by absolute paths, as the working directory changes between
+  // compile commands and the shared cache is used by all workers.
+  if (std::error_code EC = getUnderlyingFS().makeAbsolute(Path))
+    return EC;
+  llvm::sys::path::remove_dots(Path);
+
+  const CachedFileSystemEntry *&LocalEntry = Cache[Path];
+  if (LocalEntry)
+    return LocalEntry;
+
+  DependencyScanningFilesystemSharedCache::SharedFileSystemEntry
+      &SharedCacheEntry = SharedCache.get(Path);
+  {
+    std::lock_guard<std::mutex> LockGuard(SharedCacheEntry.ValueLock);
+    CachedFileSystemEntry &CacheEntry = SharedCacheEntry.Value;
+
+    if (!CacheEntry.isValid()) {
+      llvm::vfs::FileSystem &FS = getUnderlyingFS();
+      llvm::ErrorOr<llvm::vfs::Status> MaybeStatus = FS.status(Path);
+      if (!MaybeStatus)
+        CacheEntry = CachedFileSystemEntry(MaybeStatus.getError());
+      else if (MaybeStatus->isDirectory())
+        CacheEntry = CachedFileSystemEntry::createDirectoryEntry(
+            std::move(*MaybeStatus));
+      else
+        CacheEntry = CachedFileSystemEntry::createFileEntry(
+            Path, FS, Minimize && shouldMinimize(Path));
+    }
+    LocalEntry = &CacheEntry;
+  }
+  return LocalEntry;
+}
+
+llvm::ErrorOr<llvm::vfs::Status>
+DependencyScanningWorkerFilesystem::status(const Twine &Path) {
+  SmallString<256> OwnedFilename;
+  StringRef Filename = Path.toStringRef(OwnedFilename);
+  llvm::ErrorOr<const CachedFileSystemEntry *> Result =
+      getOrCreateFileSystemEntry(Filename);
+  if (!Result)
+    return Result.getError();
+  llvm::ErrorOr<llvm::vfs::Status> Stat = (*Result)->getStatus();
+  if (!Stat)
+    return Stat.getError();
+  return llvm::vfs::Status::copyWithNewName(*Stat, Filename);
+}
+
+namespace {
+
+/// The VFS that is returned by openFileForRead for a file in the cache. The
+/// contents are owned by the shared cache.
+class MinimizedVFSFile final : public llvm::vfs::File {
+public:
+  MinimizedVFSFile(StringRef Contents, llvm::vfs::Status Stat)
+      : Contents(Contents), Stat(std::move(Stat)) {}
+
+  llvm::ErrorOr<llvm::vfs::Status> status() override { return Stat; }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+  getBuffer(const Twine &Name, int64_t FileSize, bool RequiresNullTerminator,
+            bool IsVolatile) override {
+    return llvm::MemoryBuffer::getMemBuffer(Contents, Name.str(),
+                                            RequiresNullTerminator);
+  }
+
+  std::error_code close() override { return {}; }
+
+private:
+  StringRef Contents;
+  llvm::vfs::Status Stat;
+};
+
+} // end anonymous namespace
+
+llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+DependencyScanningWorkerFilesystem::openFileForRead(const Twine &Path) {
+  SmallString<256> OwnedFilename;
+  StringRef Filename = Path.toStringRef(OwnedFilename);
+  llvm::ErrorOr<const CachedFileSystemEntry *> Result =
+      getOrCreateFileSystemEntry(Filename);
+  if (!Result)
+    return Result.getError();
+
+  const CachedFileSystemEntry *Entry = *Result;
+  if (Entry->isDirectory())
+    return std::make_error_code(std::errc::is_a_directory);
+  llvm::ErrorOr<StringRef> Contents = Entry->getContents();
+  if (!Contents)
+    return Contents.getError();
+  return llvm::make_unique<MinimizedVFSFile>(
+      *Contents,
+      llvm::vfs::Status::copyWithNewName(*Entry->getStatus(), Filename));
+}
@@ -0,0 +1,135 @@
+//===- DependencyScanningWorker.cpp - clang-scan-deps worker --------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/DependencyScanning/DependencyScanningWorker.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/Support/Path.h"
+
+using namespace clang;
+using namespace tooling;
+using namespace dependencies;
+
+namespace {
+
+/// Records the files that a translation unit depends on.
+class DependencyConsumer : public DependencyCollector {
+public:
+  DependencyConsumer(bool IncludeSystemHeaders)
+      : IncludeSystemHeaders(IncludeSystemHeaders) {}
+
+  bool needSystemDependencies() override { return IncludeSystemHeaders; }
+
+private:
+  bool IncludeSystemHeaders;
+};
+
+/// A clang tool that runs the preprocessor only for the given compiler
+/// invocation and collects its dependencies.
+class DependencyScanningAction : public tooling::ToolAction {
+public:
+  DependencyScanningAction(TranslationUnitDeps &Result) : Result(Result) {}
+
+  bool runInvocation(std::shared_ptr<CompilerInvocation> Invocation,
+                     FileManager *FileMgr,
+                     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                     DiagnosticConsumer *DiagConsumer) override {
+    // Create a compiler instance to handle the actual work.
+    CompilerInstance Compiler(std::move(PCHContainerOps));
+    Compiler.setInvocation(std::move(Invocation));
+
+    // Take the dependency options of the command, and make sure that the
+    // scan doesn't write a dependency file or any other output itself. A
+    // command that doesn't ask for dependencies gets those of -M.
+    DependencyOutputOptions &DepOpts = Compiler.getDependencyOutputOpts();
+    bool IncludeSystemHeaders =
+        DepOpts.OutputFile.empty() || DepOpts.IncludeSystemHeaders;
+    Result.Targets = DepOpts.Targets;
+    if (Result.Targets.empty())
+      Result.Targets.push_back(getDefaultTarget(Compiler.getFrontendOpts()));
+    DepOpts = DependencyOutputOptions();
+
+    // Don't print 'X warnings and Y errors generated'.
+    Compiler.getDiagnosticOpts().ShowCarets = false;
+    // Create the compiler's actual diagnostics engine.
+    Compiler.createDiagnostics(DiagConsumer, /*ShouldOwnClient=*/false);
+    if (!Compiler.hasDiagnostics())
+      return false;
+
+    Compiler.setFileManager(FileMgr);
+    Compiler.createSourceManager(*FileMgr);
+
+    auto Consumer = std::make_shared<DependencyConsumer>(IncludeSystemHeaders);
+    Compiler.addDependencyCollector(Consumer);
+
+    PreprocessOnlyAction Action;
+    const bool Success = Compiler.ExecuteAction(Action);
+    Result.Dependencies.assign(Consumer->getDependencies().begin(),
+                               Consumer->getDependencies().end());
+    return Success;
+  }
+
+private:
+  /// Returns the target that the driver would use for -MD: the output file,
+  /// or the object file of the input if there is none.
+  static std::string getDefaultTarget(const FrontendOptions &Opts) {
+    if (!Opts.OutputFile.empty() && Opts.OutputFile != "-")
+      return Opts.OutputFile;
+    if (Opts.Inputs.empty() || !Opts.Inputs[0].isFile())
+      return "-";
+    return (llvm::sys::path::stem(Opts.Inputs[0].getFile()) + ".o").str();
+  }
+
+  TranslationUnitDeps &Result;
+};
+
+} // end anonymous namespace
+
+DependencyScanningWorker::DependencyScanningWorker(
+    DependencyScanningService &Service) {
+  DiagOpts = new DiagnosticOptions();
+  PCHContainerOps = std::make_shared<PCHContainerOperations>();
+  RealFS = llvm::vfs::createPhysicalFileSystem().release();
+  DepFS = new DependencyScanningWorkerFilesystem(
+      Service.getSharedCache(), RealFS,
+      Service.getMode() == ScanningMode::MinimizedSourcePreprocessing);
+}
+
+llvm::Expected<TranslationUnitDeps>
+DependencyScanningWorker::computeDependencies(const CompileCommand &Command) {
+  if (std::error_code EC =
+          RealFS->setCurrentWorkingDirectory(Command.Directory))
+    return llvm::createStringError(EC, "cannot change to directory '%s': %s",
+                                   Command.Directory.c_str(),
+                                   EC.message().c_str());
+
+  std::string DiagnosticOutput;
+  llvm::raw_string_ostream DiagnosticsOS(DiagnosticOutput);
+  TextDiagnosticPrinter DiagPrinter(DiagnosticsOS, DiagOpts.get());
+
+  // The file manager caches entries by the paths they were looked up with,
+  // which may be relative to the working directory of the command, so it
+  // isn't reused across commands. The file system under it caches by
+  // absolute path and is shared by all of them.
+  llvm::IntrusiveRefCntPtr<FileManager> Files(
+      new FileManager(FileSystemOptions(), DepFS));
+
+  TranslationUnitDeps Result;
+  Result.File = Command.Filename;
+  DependencyScanningAction Action(Result);
+  ToolInvocation Invocation(Command.CommandLine, &Action, Files.get(),
+                            PCHContainerOps);
+  Invocation.setDiagnosticConsumer(&DiagPrinter);
+  if (!Invocation.run())
+    return llvm::make_error<llvm::StringError>(DiagnosticsOS.str(),
+                                               llvm::inconvertibleErrorCode());
+  return std::move(Result);
+}
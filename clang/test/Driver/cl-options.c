@@ -650,6 +650,8 @@
 // RUN:     -fcs-profile-generate \
 // RUN:     -fcs-profile-generate=dir \
 // RUN:     -ftime-trace \
+// RUN:     -ftime-trace-templates \
+// RUN:     -ftime-trace-granularity=1 \
 // RUN:     --version \
 // RUN:     -Werror /Zs -- %s 2>&1
 
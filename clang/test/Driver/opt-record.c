@@ -15,6 +15,7 @@
 // RUN: %clang -### -S -o FOO -fsave-optimization-record -foptimization-record-passes=inline %s 2>&1 | FileCheck %s -check-prefix=CHECK-EQ-PASSES
 // RUN: %clang -### -S -o FOO -foptimization-record-passes=inline %s 2>&1 | FileCheck %s -check-prefix=CHECK-EQ-PASSES
 // RUN: %clang -### -S -o FOO -foptimization-record-passes=inline -fno-save-optimization-record %s 2>&1 | FileCheck %s --check-prefix=CHECK-FOPT-DISABLE-PASSES
+// RUN: %clang -### -S -o FOO -fsave-optimization-record -foptimization-record-format=binary %s 2>&1 | FileCheck %s -check-prefix=CHECK-FORMAT
 //
 // CHECK: "-cc1"
 // CHECK: "-opt-record-file" "FOO.opt.yaml"
@@ -32,3 +33,7 @@
 // CHECK-EQ-PASSES: "-opt-record-passes" "inline"
 
 // CHECK-FOPT-DISABLE-PASSES-NOT: "-fno-save-optimization-record"
+
+// CHECK-FORMAT: "-cc1"
+// CHECK-FORMAT: "-opt-record-file" "FOO.opt.binary"
+// CHECK-FORMAT: "-opt-record-format" "binary"
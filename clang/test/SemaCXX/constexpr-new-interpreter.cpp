@@ -0,0 +1,89 @@
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s -fexperimental-new-constant-interpreter
+// RUN: %clang -std=c++14 -fsyntax-only -Xclang -verify %s -fexperimental-new-constant-interpreter
+
+// The new constant interpreter must agree with the tree walker on both the
+// values it computes and, by falling back to the tree walker, on the
+// diagnostics of expressions that are not constant.
+
+constexpr int fib(int n) {
+  int a = 0, b = 1;
+  for (int i = 0; i < n; ++i) {
+    int t = a + b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+static_assert(fib(0) == 0, "");
+static_assert(fib(10) == 55, "");
+static_assert(fib(45) == 1134903170, "");
+
+constexpr int rfib(int n) { return n < 2 ? n : rfib(n - 1) + rfib(n - 2); }
+static_assert(rfib(20) == 6765, "");
+
+constexpr unsigned hash(unsigned h, int n) {
+  while (n--) {
+    h ^= h << 5;
+    h += h >> 2;
+    if (n % 3 == 0)
+      continue;
+    h *= 31u;
+    if (h == 0)
+      break;
+  }
+  return h;
+}
+static_assert(hash(5381, 100) == hash(5381, 100), "");
+static_assert(hash(1, 0) == 1, "");
+static_assert(hash(0xffffffff, 1) == 38u, "");
+
+constexpr int collatz(long long n) {
+  int steps = 0;
+  do {
+    n = n % 2 ? 3 * n + 1 : n / 2;
+    ++steps;
+  } while (n != 1);
+  return steps;
+}
+static_assert(collatz(27) == 111, "");
+
+enum E : unsigned char { A = 1, B = 200 };
+enum class F : short { X = -3 };
+constexpr int conv(E e, F f) { return e + (int)f; }
+static_assert(conv(B, F::X) == 197, "");
+static_assert((unsigned char)(B + B) == 144, "");
+static_assert((signed char)B == -56, "");
+static_assert(sizeof(long long) + sizeof(char) == 9, "");
+
+constexpr int kGlobal = fib(12);
+const int kConst = kGlobal * 2;
+constexpr int useGlobals(int n) { return n + kGlobal + kConst; }
+static_assert(useGlobals(1) == 1 + 144 + 288, "");
+
+constexpr bool logic(int a, int b) { return (a && !b) || (a > b && b >= 0); }
+static_assert(logic(1, 0) && !logic(0, 0) && logic(3, 2), "");
+
+constexpr int shifts(int a, unsigned b) { return (a << 3) + (int)(b >> 1) + (-a >> 1); }
+static_assert(shifts(4, 7u) == 32 + 3 - 2, "");
+
+template <int N> struct Fixed { static constexpr int value = fib(N); };
+static_assert(Fixed<15>::value == 610, "");
+
+int arr[fib(6)];
+static_assert(sizeof(arr) == 8 * sizeof(int), "");
+
+// Undefined behavior and other failures are diagnosed by the tree walker.
+constexpr int overflow(int n) { return n + 1; } // expected-note {{value 2147483648 is outside the range}}
+static_assert(overflow(2147483647) > 0, ""); // expected-error {{constant expression}} expected-note {{in call to 'overflow(2147483647)'}}
+
+constexpr int divide(int a, int b) { return a / b; } // expected-note {{division by zero}}
+static_assert(divide(1, 0), ""); // expected-error {{constant expression}} expected-note {{in call to 'divide(1, 0)'}}
+
+// Constructs outside the subset supported by the interpreter still work.
+constexpr int sum(const int *p, int n) { return n ? *p + sum(p + 1, n - 1) : 0; }
+constexpr int data[] = {1, 2, 3, 4};
+static_assert(sum(data, 4) == 10, "");
+
+struct S { int v; constexpr int get() const { return v * 2; } };
+static_assert(S{21}.get() == 42, "");
@@ -0,0 +1,44 @@
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s -fno-memoize-substitution-failures
+
+// Repeated substitution failures are memoized. A replayed failure must be
+// diagnosed like the original one, and declarations that could change the
+// outcome of the substitution must invalidate it.
+
+namespace adl {
+  struct S {};
+  template <typename T> auto f(T t) -> decltype(g(t)); // expected-note 2{{candidate template ignored: substitution failure [with T = adl::S]}}
+  void test1() { f(S()); } // expected-error {{no matching function for call to 'f'}}
+  void test2() { f(S()); } // expected-error {{no matching function for call to 'f'}}
+  void g(S);
+  void test3() { f(S()); }
+}
+
+namespace complete {
+  struct Incomplete;
+  template <typename T> auto h(T *p) -> decltype(sizeof(T)); // expected-note 2{{candidate template ignored: substitution failure [with T = complete::Incomplete]}}
+  void test1(Incomplete *p) { h(p); } // expected-error {{no matching function for call to 'h'}}
+  void test2(Incomplete *p) { h(p); } // expected-error {{no matching function for call to 'h'}}
+  struct Incomplete {};
+  void test3(Incomplete *p) { h(p); }
+}
+
+namespace constant {
+  constexpr int k();
+  template <int N> struct Int {};
+  template <typename T> auto c(T) -> Int<sizeof(T) + k()>; // expected-note 2{{candidate template ignored: substitution failure [with T = int]}}
+  void test1() { c(0); } // expected-error {{no matching function for call to 'c'}}
+  void test2() { c(0); } // expected-error {{no matching function for call to 'c'}}
+  constexpr int k() { return 1; }
+  void test3() { c(0); }
+}
+
+namespace overloads {
+  template <typename T> typename T::type p(T); // expected-note 3{{candidate template ignored: substitution failure [with T = int]: type 'int' cannot be used prior to '::'}}
+  template <typename T> typename T::other p(T); // expected-note 3{{candidate template ignored: substitution failure [with T = int]: type 'int' cannot be used prior to '::'}}
+  void test() {
+    p(0); // expected-error {{no matching function for call to 'p'}}
+    p(0); // expected-error {{no matching function for call to 'p'}}
+    p(0); // expected-error {{no matching function for call to 'p'}}
+  }
+}
@@ -0,0 +1,201 @@
+//===- ClangScanDeps.cpp - Implementation of clang-scan-deps --------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements the clang-scan-deps tool, which computes the
+/// dependencies of every translation unit of a compilation database in
+/// parallel, without running the compiler itself.
+///
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/DependencyScanning/DependencyScanningService.h"
+#include "clang/Tooling/DependencyScanning/DependencyScanningWorker.h"
+#include "clang/Tooling/JSONCompilationDatabase.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+#include <atomic>
+#include <thread>
+
+using namespace clang;
+using namespace tooling;
+using namespace tooling::dependencies;
+
+namespace {
+
+enum class OutputFormat { Make, JSON };
+
+llvm::cl::OptionCategory ScanDepsOptions("clang-scan-deps options");
+
+llvm::cl::opt<ScanningMode> ScanMode(
+    "mode",
+    llvm::cl::desc("The preprocessing mode used to compute the dependencies"),
+    llvm::cl::values(
+        clEnumValN(ScanningMode::MinimizedSourcePreprocessing,
+                   "preprocess-minimized-sources",
+                   "The set of dependencies is computed by preprocessing the "
+                   "source files that were minimized to only include the "
+                   "contents that might affect the dependencies"),
+        clEnumValN(ScanningMode::CanonicalPreprocessing, "preprocess",
+                   "The set of dependencies is computed by preprocessing the "
+                   "unmodified source files")),
+    llvm::cl::init(ScanningMode::MinimizedSourcePreprocessing),
+    llvm::cl::cat(ScanDepsOptions));
+
+llvm::cl::opt<OutputFormat> Format(
+    "format", llvm::cl::desc("The format of the output"),
+    llvm::cl::values(clEnumValN(OutputFormat::Make, "make",
+                                "Makefile rules, like those written by -MD"),
+                     clEnumValN(OutputFormat::JSON, "json",
+                                "A JSON array with an object per "
+                                "translation unit")),
+    llvm::cl::init(OutputFormat::Make), llvm::cl::cat(ScanDepsOptions));
+
+llvm::cl::opt<unsigned>
+    NumThreads("j", llvm::cl::Optional,
+               llvm::cl::desc("Number of worker threads to use (default: use "
+                              "all concurrent threads)"),
+               llvm::cl::init(0), llvm::cl::cat(ScanDepsOptions));
+
+llvm::cl::opt<std::string>
+    CompilationDB("compilation-database",
+                  llvm::cl::desc("Compilation database"), llvm::cl::Required,
+                  llvm::cl::cat(ScanDepsOptions));
+
+/// Escapes \p Filename the way the dependency file writer does, so that make
+/// reads it back as a single word.
+void printMakeFilename(StringRef Filename, llvm::raw_ostream &OS) {
+  for (unsigned I = 0, E = Filename.size(); I != E; ++I) {
+    if (Filename[I] == ' ' || Filename[I] == '#')
+      OS << '\\';
+    else if (Filename[I] == '$')
+      OS << '$';
+    OS << Filename[I];
+  }
+}
+
+void printMakeRule(const TranslationUnitDeps &Deps, llvm::raw_ostream &OS) {
+  bool First = true;
+  for (const std::string &Target : Deps.Targets) {
+    if (!First)
+      OS << ' ';
+    First = false;
+    printMakeFilename(Target, OS);
+  }
+  OS << ':';
+  for (const std::string &Dep : Deps.Dependencies) {
+    OS << " \\\n  ";
+    printMakeFilename(Dep, OS);
+  }
+  OS << '\n';
+}
+
+void printJSON(ArrayRef<TranslationUnitDeps> AllDeps, llvm::raw_ostream &OS) {
+  llvm::json::OStream J(OS, /*IndentSize=*/2);
+  J.array([&] {
+    for (const TranslationUnitDeps &Deps : AllDeps)
+      J.object([&] {
+        J.attribute("file", Deps.File);
+        J.attributeArray("targets", [&] {
+          for (const std::string &Target : Deps.Targets)
+            J.value(Target);
+        });
+        J.attributeArray("dependencies", [&] {
+          for (const std::string &Dep : Deps.Dependencies)
+            J.value(Dep);
+        });
+      });
+  });
+  OS << '\n';
+}
+
+} // end anonymous namespace
+
+int main(int argc, const char **argv) {
+  llvm::InitLLVM X(argc, argv);
+  llvm::cl::HideUnrelatedOptions(ScanDepsOptions);
+  if (!llvm::cl::ParseCommandLineOptions(argc, argv, "clang-scan-deps tool\n"))
+    return 1;
+
+  std::string ErrorMessage;
+  std::unique_ptr<JSONCompilationDatabase> Compilations =
+      JSONCompilationDatabase::loadFromFile(CompilationDB, ErrorMessage,
+                                            JSONCommandLineSyntax::AutoDetect);
+  if (!Compilations) {
+    llvm::errs() << "error: " << ErrorMessage << "\n";
+    return 1;
+  }
+
+  // The commands of the database usually name another compiler, so the
+  // headers of this one are found relative to the tool.
+  static int StaticSymbol;
+  std::string ResourceDir =
+      CompilerInvocation::GetResourcesPath(argv[0], &StaticSymbol);
+  std::vector<CompileCommand> Commands = Compilations->getAllCompileCommands();
+  for (CompileCommand &Command : Commands) {
+    bool HasResourceDir = llvm::any_of(Command.CommandLine, [](StringRef Arg) {
+      return Arg == "-resource-dir" || Arg.startswith("-resource-dir=");
+    });
+    if (!HasResourceDir)
+      Command.CommandLine.push_back("-resource-dir=" + ResourceDir);
+  }
+
+  unsigned NumWorkers =
+      NumThreads == 0 ? llvm::hardware_concurrency() : NumThreads;
+  NumWorkers = std::max(1u, std::min<unsigned>(NumWorkers, Commands.size()));
+
+  // The workers share the file system cache of the service, and take the
+  // commands in order from a shared index. The results are kept by index so
+  // that the output doesn't depend on the scheduling.
+  DependencyScanningService Service(ScanMode);
+  std::vector<llvm::Optional<TranslationUnitDeps>> Results(Commands.size());
+  std::vector<std::string> Errors(Commands.size());
+  std::atomic<size_t> NextIndex(0);
+  auto Work = [&]() {
+    DependencyScanningWorker Worker(Service);
+    for (size_t I = NextIndex++; I < Commands.size(); I = NextIndex++) {
+      llvm::Expected<TranslationUnitDeps> Deps =
+          Worker.computeDependencies(Commands[I]);
+      if (Deps)
+        Results[I] = std::move(*Deps);
+      else
+        Errors[I] = llvm::toString(Deps.takeError());
+    }
+  };
+
+  std::vector<std::thread> Threads;
+  for (unsigned I = 1; I < NumWorkers; ++I)
+    Threads.emplace_back(Work);
+  Work();
+  for (std::thread &T : Threads)
+    T.join();
+
+  bool HadErrors = false;
+  std::vector<TranslationUnitDeps> AllDeps;
+  for (size_t I = 0, E = Commands.size(); I != E; ++I) {
+    if (!Results[I]) {
+      llvm::errs() << "error: failed to compute the dependencies of '"
+                   << Commands[I].Filename << "':\n"
+                   << Errors[I];
+      HadErrors = true;
+      continue;
+    }
+    AllDeps.push_back(std::move(*Results[I]));
+  }
+
+  if (Format == OutputFormat::JSON)
+    printJSON(AllDeps, llvm::outs());
+  else
+    for (const TranslationUnitDeps &Deps : AllDeps)
+      printMakeRule(Deps, llvm::outs());
+  return HadErrors ? 1 : 0;
+}
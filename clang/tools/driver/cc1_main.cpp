@@ -197,7 +197,8 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
       Clang->getInvocation(), Argv.begin(), Argv.end(), Diags);
 
   if (Clang->getFrontendOpts().TimeTrace)
-    llvm::timeTraceProfilerInitialize();
+    llvm::timeTraceProfilerInitialize(
+        Clang->getFrontendOpts().TimeTraceGranularity, "clang");
 
   // Infer the builtin include path if unspecified.
   if (Clang->getHeaderSearchOpts().UseBuiltinIncludes &&
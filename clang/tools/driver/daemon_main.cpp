@@ -0,0 +1,489 @@
+//===-- daemon_main.cpp - Clang compile server ----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This is the entry point to 'clang --daemon=<socket>', which runs the
+// compilations sent by 'clang --daemon-connect=<socket> ...' in a single
+// long-lived process, and to the client side of that protocol.
+//
+// The server runs the driver for each request and executes its -cc1 jobs in
+// process. The file manager and the in-memory module cache are kept between
+// jobs, so that the precompiled headers and modules built or loaded by one
+// compilation are not read from disk again by the next one, as long as none
+// of the files seen by the earlier compilations have changed.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/CodeGen/ObjectFilePCHContainerOperations.h"
+#include "clang/Driver/Compilation.h"
+#include "clang/Driver/Driver.h"
+#include "clang/Driver/Options.h"
+#include "clang/Driver/ToolChain.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/TextDiagnosticBuffer.h"
+#include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/FrontendTool/Utils.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "clang/Serialization/InMemoryModuleCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Option/ArgList.h"
+#include "llvm/Option/OptTable.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/StringSaver.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef LLVM_ON_UNIX
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace clang;
+using namespace clang::driver;
+using namespace llvm::opt;
+
+#ifdef LLVM_ON_UNIX
+
+//===----------------------------------------------------------------------===//
+// Protocol
+//===----------------------------------------------------------------------===//
+
+// A request is the number of strings followed by the strings, the working
+// directory of the client first and the command line second. A reply is the
+// exit code of the compilation followed by the output it wrote to stdout and
+// to stderr. Integers are sent as 32 bits in host order and strings are
+// prefixed by their length.
+
+static bool writeAll(int FD, const void *Data, size_t Size) {
+  const char *Ptr = static_cast<const char *>(Data);
+  while (Size) {
+    ssize_t Written = ::write(FD, Ptr, Size);
+    if (Written < 0 && errno == EINTR)
+      continue;
+    if (Written <= 0)
+      return false;
+    Ptr += Written;
+    Size -= Written;
+  }
+  return true;
+}
+
+static bool readAll(int FD, void *Data, size_t Size) {
+  char *Ptr = static_cast<char *>(Data);
+  while (Size) {
+    ssize_t Read = ::read(FD, Ptr, Size);
+    if (Read < 0 && errno == EINTR)
+      continue;
+    if (Read <= 0)
+      return false;
+    Ptr += Read;
+    Size -= Read;
+  }
+  return true;
+}
+
+static bool writeInt(int FD, uint32_t Value) {
+  return writeAll(FD, &Value, sizeof(Value));
+}
+
+static bool readInt(int FD, uint32_t &Value) {
+  return readAll(FD, &Value, sizeof(Value));
+}
+
+static bool writeString(int FD, StringRef S) {
+  return writeInt(FD, S.size()) && writeAll(FD, S.data(), S.size());
+}
+
+static bool readString(int FD, std::string &S) {
+  uint32_t Size;
+  if (!readInt(FD, Size))
+    return false;
+  S.resize(Size);
+  return readAll(FD, &S[0], Size);
+}
+
+static bool getSocketAddress(StringRef Path, sockaddr_un &Addr) {
+  memset(&Addr, 0, sizeof(Addr));
+  Addr.sun_family = AF_UNIX;
+  if (Path.empty() || Path.size() >= sizeof(Addr.sun_path))
+    return false;
+  memcpy(Addr.sun_path, Path.data(), Path.size());
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// In-process -cc1 jobs
+//===----------------------------------------------------------------------===//
+
+static const char *DaemonArgv0;
+static void *DaemonMainAddr;
+
+namespace {
+/// The state kept between the compilations that can share it.
+struct SharedCompilerState {
+  IntrusiveRefCntPtr<FileManager> FileMgr;
+  IntrusiveRefCntPtr<InMemoryModuleCache> ModuleCache;
+};
+} // end anonymous namespace
+
+/// The shared state, keyed by the options that affect the way files are
+/// looked up.
+static llvm::StringMap<SharedCompilerState> SharedStates;
+
+/// The maximum number of distinct file system configurations to keep the
+/// state of.
+static const unsigned MaxSharedStates = 4;
+
+static SharedCompilerState *
+getSharedState(const CompilerInvocation &Invocation) {
+  // Remapped files are entered into the file manager as virtual files, which
+  // would leak into later compilations.
+  const PreprocessorOptions &PPOpts = Invocation.getPreprocessorOpts();
+  if (!PPOpts.RemappedFiles.empty() || !PPOpts.RemappedFileBuffers.empty())
+    return nullptr;
+
+  std::string Key = Invocation.getFileSystemOpts().WorkingDir;
+  for (const std::string &Overlay :
+       Invocation.getHeaderSearchOpts().VFSOverlayFiles) {
+    Key += '\0';
+    Key += Overlay;
+  }
+
+  auto It = SharedStates.find(Key);
+  if (It == SharedStates.end()) {
+    if (SharedStates.size() >= MaxSharedStates)
+      SharedStates.clear();
+    It = SharedStates.insert({Key, SharedCompilerState()}).first;
+  }
+
+  SharedCompilerState &State = It->second;
+  if (State.FileMgr && State.FileMgr->hasChangedOnDisk())
+    State = SharedCompilerState();
+  if (!State.ModuleCache)
+    State.ModuleCache = new InMemoryModuleCache;
+  return &State;
+}
+
+/// Whether the job uses a feature with process-wide state, which requires a
+/// process of its own.
+static bool needsOwnProcess(const CompilerInvocation &Invocation) {
+  const FrontendOptions &FEOpts = Invocation.getFrontendOpts();
+  return FEOpts.TimeTrace || FEOpts.ShowStats || FEOpts.ShowTimers ||
+         !FEOpts.Plugins.empty() || !FEOpts.AddPluginActions.empty() ||
+         !FEOpts.LLVMArgs.empty();
+}
+
+static int runOutOfProcess(ArrayRef<const char *> Argv) {
+  SmallVector<StringRef, 128> Args(Argv.begin(), Argv.end());
+  std::string ErrMsg;
+  int Res = llvm::sys::ExecuteAndWait(Argv[0], Args, /*Env=*/None,
+                                      /*Redirects=*/{}, /*SecondsToWait=*/0,
+                                      /*MemoryLimit=*/0, &ErrMsg);
+  if (Res < 0)
+    llvm::errs() << "error: unable to execute command: " << ErrMsg << '\n';
+  return Res;
+}
+
+/// Run the -cc1 job Argv, which starts with the clang executable.
+static int runCC1InProcess(ArrayRef<const char *> Argv) {
+  auto PCHOps = std::make_shared<PCHContainerOperations>();
+  PCHOps->registerWriter(llvm::make_unique<ObjectFilePCHContainerWriter>());
+  PCHOps->registerReader(llvm::make_unique<ObjectFilePCHContainerReader>());
+
+  // Parse the options before creating the compiler instance, which needs
+  // the module cache to use.
+  auto Invocation = std::make_shared<CompilerInvocation>();
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  TextDiagnosticBuffer *DiagsBuffer = new TextDiagnosticBuffer;
+  DiagnosticsEngine Diags(DiagID, &*DiagOpts, DiagsBuffer);
+  ArrayRef<const char *> CC1Args = Argv.slice(2);
+  bool Success = CompilerInvocation::CreateFromArgs(
+      *Invocation, CC1Args.begin(), CC1Args.end(), Diags);
+  if (Success && needsOwnProcess(*Invocation))
+    return runOutOfProcess(Argv);
+
+  // The compiler has to clean up after itself in a long-lived process.
+  Invocation->getFrontendOpts().DisableFree = false;
+  Invocation->getCodeGenOpts().DisableFree = false;
+
+  if (Invocation->getHeaderSearchOpts().UseBuiltinIncludes &&
+      Invocation->getHeaderSearchOpts().ResourceDir.empty())
+    Invocation->getHeaderSearchOpts().ResourceDir =
+        CompilerInvocation::GetResourcesPath(DaemonArgv0, DaemonMainAddr);
+
+  SharedCompilerState *State = Success ? getSharedState(*Invocation) : nullptr;
+  CompilerInstance Clang(PCHOps, State ? State->ModuleCache.get() : nullptr);
+  Clang.setInvocation(std::move(Invocation));
+
+  Clang.createDiagnostics();
+  if (!Clang.hasDiagnostics())
+    return 1;
+  DiagsBuffer->FlushDiagnostics(Clang.getDiagnostics());
+  if (!Success)
+    return 1;
+
+  if (State) {
+    if (State->FileMgr)
+      Clang.setFileManager(State->FileMgr.get());
+    else
+      State->FileMgr = Clang.createFileManager();
+  }
+
+  Success = ExecuteCompilerInvocation(&Clang);
+  llvm::outs().flush();
+  return !Success;
+}
+
+//===----------------------------------------------------------------------===//
+// Server
+//===----------------------------------------------------------------------===//
+
+/// Run the driver on the command line Args of a client.
+static int runDriver(ArrayRef<std::string> Args) {
+  llvm::BumpPtrAllocator A;
+  llvm::StringSaver Saver(A);
+  SmallVector<const char *, 256> Argv;
+  for (const std::string &Arg : Args)
+    Argv.push_back(Saver.save(Arg).data());
+  llvm::cl::ExpandResponseFiles(Saver, &llvm::cl::TokenizeGNUCommandLine,
+                                Argv);
+
+  // The jobs only run in this process if the driver believes it is this
+  // executable, but the driver mode still comes from the name the client
+  // was invoked as.
+  std::string Path = llvm::sys::fs::getMainExecutable(DaemonArgv0,
+                                                      DaemonMainAddr);
+  auto TargetAndMode = ToolChain::getTargetAndModeFromProgramName(Argv[0]);
+  Argv[0] = Saver.save(Path).data();
+  int InsertionPoint = 1;
+  if (TargetAndMode.DriverMode)
+    Argv.insert(Argv.begin() + InsertionPoint++, TargetAndMode.DriverMode);
+  if (TargetAndMode.TargetIsValid) {
+    Argv.insert(Argv.begin() + InsertionPoint++, "-target");
+    Argv.insert(Argv.begin() + InsertionPoint,
+                Saver.save(TargetAndMode.TargetPrefix).data());
+  }
+
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions;
+  {
+    std::unique_ptr<OptTable> Opts(createDriverOptTable());
+    unsigned MissingArgIndex, MissingArgCount;
+    InputArgList ParsedArgs = Opts->ParseArgs(
+        llvm::makeArrayRef(Argv).slice(1), MissingArgIndex, MissingArgCount);
+    (void)ParseDiagnosticArgs(*DiagOpts, ParsedArgs);
+  }
+  TextDiagnosticPrinter *DiagClient =
+      new TextDiagnosticPrinter(llvm::errs(), &*DiagOpts);
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+  DiagnosticsEngine Diags(DiagID, &*DiagOpts, DiagClient);
+  ProcessWarningOptions(Diags, *DiagOpts, /*ReportDiags=*/false);
+
+  Driver TheDriver(Path, llvm::sys::getDefaultTargetTriple(), Diags);
+  TheDriver.setTargetAndMode(TargetAndMode);
+  TheDriver.CC1Main = runCC1InProcess;
+
+  std::unique_ptr<Compilation> C(TheDriver.BuildCompilation(Argv));
+  int Res = 1;
+  if (C && !C->containsError()) {
+    SmallVector<std::pair<int, const Command *>, 4> FailingCommands;
+    Res = TheDriver.ExecuteCompilation(*C, FailingCommands);
+    for (const auto &P : FailingCommands)
+      if (!Res)
+        Res = P.first;
+  }
+  Diags.getClient()->finish();
+  llvm::outs().flush();
+  return Res;
+}
+
+namespace {
+/// Redirects a standard file descriptor to a temporary file and returns
+/// what was written to it.
+class OutputCapture {
+  int FD;
+  int SavedFD = -1;
+  int TempFD = -1;
+  SmallString<128> TempPath;
+
+public:
+  explicit OutputCapture(int FD) : FD(FD) {
+    if (llvm::sys::fs::createTemporaryFile("clang-daemon", "out", TempFD,
+                                           TempPath))
+      return;
+    SavedFD = ::dup(FD);
+    ::dup2(TempFD, FD);
+  }
+
+  std::string finish() {
+    std::string Output;
+    if (TempFD < 0)
+      return Output;
+    ::dup2(SavedFD, FD);
+    ::close(SavedFD);
+    ::lseek(TempFD, 0, SEEK_SET);
+    char Buffer[4096];
+    ssize_t Read;
+    while ((Read = ::read(TempFD, Buffer, sizeof(Buffer))) > 0)
+      Output.append(Buffer, Read);
+    ::close(TempFD);
+    llvm::sys::fs::remove(TempPath);
+    TempFD = -1;
+    return Output;
+  }
+
+  ~OutputCapture() { finish(); }
+};
+} // end anonymous namespace
+
+static void handleClient(int Conn) {
+  uint32_t NumStrings;
+  if (!readInt(Conn, NumStrings) || NumStrings < 2)
+    return;
+  std::vector<std::string> Strings(NumStrings);
+  for (std::string &S : Strings)
+    if (!readString(Conn, S))
+      return;
+
+  // Compilations are handled one at a time, so the process-wide working
+  // directory can be the one of the client.
+  SmallString<128> SavedCWD;
+  llvm::sys::fs::current_path(SavedCWD);
+  if (llvm::sys::fs::set_current_path(Strings[0]))
+    return;
+
+  std::string Out, Err;
+  int Res;
+  {
+    OutputCapture OutCapture(STDOUT_FILENO), ErrCapture(STDERR_FILENO);
+    Res = runDriver(llvm::makeArrayRef(Strings).slice(1));
+    Out = OutCapture.finish();
+    Err = ErrCapture.finish();
+  }
+  llvm::sys::fs::set_current_path(SavedCWD);
+
+  (void)(writeInt(Conn, uint32_t(Res)) && writeString(Conn, Out) &&
+         writeString(Conn, Err));
+}
+
+int daemon_main(StringRef SocketPath, const char *Argv0, void *MainAddr) {
+  DaemonArgv0 = Argv0;
+  DaemonMainAddr = MainAddr;
+
+  llvm::InitializeAllTargets();
+  llvm::InitializeAllTargetMCs();
+  llvm::InitializeAllAsmPrinters();
+  llvm::InitializeAllAsmParsers();
+
+  sockaddr_un Addr;
+  if (!getSocketAddress(SocketPath, Addr)) {
+    llvm::errs() << "error: invalid socket path '" << SocketPath << "'\n";
+    return 1;
+  }
+
+  int Socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (Socket < 0) {
+    llvm::errs() << "error: unable to create socket: " << strerror(errno)
+                 << '\n';
+    return 1;
+  }
+  // Don't leak the socket into the tools run by the driver.
+  ::fcntl(Socket, F_SETFD, FD_CLOEXEC);
+  ::unlink(Addr.sun_path);
+  if (::bind(Socket, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr)) ||
+      ::listen(Socket, SOMAXCONN)) {
+    llvm::errs() << "error: unable to listen on '" << SocketPath
+                 << "': " << strerror(errno) << '\n';
+    ::close(Socket);
+    return 1;
+  }
+
+  while (true) {
+    int Conn = ::accept(Socket, nullptr, nullptr);
+    if (Conn < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    ::fcntl(Conn, F_SETFD, FD_CLOEXEC);
+    handleClient(Conn);
+    ::close(Conn);
+  }
+  ::close(Socket);
+  return 1;
+}
+
+//===----------------------------------------------------------------------===//
+// Client
+//===----------------------------------------------------------------------===//
+
+bool daemon_connect_main(StringRef SocketPath, ArrayRef<const char *> Argv,
+                         int &Result) {
+  sockaddr_un Addr;
+  if (!getSocketAddress(SocketPath, Addr))
+    return false;
+  SmallString<128> CWD;
+  if (llvm::sys::fs::current_path(CWD))
+    return false;
+
+  int Conn = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (Conn < 0)
+    return false;
+  if (::connect(Conn, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr))) {
+    ::close(Conn);
+    return false;
+  }
+
+  bool Sent = writeInt(Conn, Argv.size() + 1) && writeString(Conn, CWD);
+  for (const char *Arg : Argv)
+    Sent = Sent && writeString(Conn, Arg);
+
+  // Nothing is printed unless the whole reply arrived, so that the caller
+  // can still compile locally if the server went away.
+  uint32_t Res;
+  std::string Out, Err;
+  bool Received = Sent && readInt(Conn, Res) && readString(Conn, Out) &&
+                  readString(Conn, Err);
+  ::close(Conn);
+  if (!Received)
+    return false;
+
+  llvm::outs() << Out;
+  llvm::outs().flush();
+  llvm::errs() << Err;
+  Result = int(Res);
+  return true;
+}
+
+#else
+
+int daemon_main(StringRef SocketPath, const char *Argv0, void *MainAddr) {
+  llvm::errs() << "error: --daemon is not supported on this platform\n";
+  return 1;
+}
+
+bool daemon_connect_main(StringRef SocketPath, ArrayRef<const char *> Argv,
+                         int &Result) {
+  return false;
+}
+
+#endif
@@ -204,6 +204,10 @@ extern int cc1as_main(ArrayRef<const char *> Argv, const char *Argv0,
                       void *MainAddr);
 extern int cc1gen_reproducer_main(ArrayRef<const char *> Argv,
                                   const char *Argv0, void *MainAddr);
+extern int daemon_main(StringRef SocketPath, const char *Argv0,
+                       void *MainAddr);
+extern bool daemon_connect_main(StringRef SocketPath,
+                                ArrayRef<const char *> Argv, int &Result);
 
 static void insertTargetAndModeArgs(const ParsedClangName &NameParts,
                                     SmallVectorImpl<const char *> &ArgVector,
@@ -368,6 +372,21 @@ int main(int argc_, const char **argv_) {
     MarkEOLs = false;
   llvm::cl::ExpandResponseFiles(Saver, Tokenizer, argv, MarkEOLs);
 
+  // Handle the compile server, and forward the compilation to it if asked to.
+  // If the server can't be reached, compile locally.
+  if (argv.size() > 1 && StringRef(argv[1]).startswith("--daemon="))
+    return daemon_main(StringRef(argv[1]).substr(strlen("--daemon=")),
+                       argv[0], (void *)(intptr_t)GetExecutablePath);
+  if (argv.size() > 1 && StringRef(argv[1]).startswith("--daemon-connect=")) {
+    StringRef SocketPath =
+        StringRef(argv[1]).substr(strlen("--daemon-connect="));
+    argv.erase(argv.begin() + 1);
+    int Res;
+    if (llvm::find(argv, nullptr) == argv.end() &&
+        daemon_connect_main(SocketPath, argv, Res))
+      return Res;
+  }
+
   // Handle -cc1 integrated tools, even if -cc1 was expanded from a response
   // file.
   auto FirstArg = std::find_if(argv.begin() + 1, argv.end(),
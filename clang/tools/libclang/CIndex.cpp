@@ -3289,6 +3289,8 @@ CXIndex clang_createIndex(int excludeDeclarationsFromPCH,
   if (getenv("LIBCLANG_BGPRIO_EDIT"))
     CIdxr->setCXGlobalOptFlags(CIdxr->getCXGlobalOptFlags() |
                                CXGlobalOpt_ThreadBackgroundPriorityForEditing);
+  if (getenv("LIBCLANG_SHARE_PREAMBLES"))
+    CIdxr->setPreambleStore(std::make_shared<PreambleStore>());
 
   return CIdxr;
 }
@@ -3512,7 +3514,7 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
       /*AllowPCHWithCompilerErrors=*/true, SkipFunctionBodies, SingleFileParse,
       /*UserFilesAreVolatile=*/true, ForSerialization,
       CXXIdx->getPCHContainerOperations()->getRawReader().getFormat(),
-      &ErrUnit));
+      &ErrUnit, /*VFS=*/nullptr, CXXIdx->getPreambleStore()));
 
   // Early failures in LoadFromCommandLine may return with ErrUnit unset.
   if (!Unit && !ErrUnit)
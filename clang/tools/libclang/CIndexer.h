@@ -28,6 +28,7 @@ namespace clang {
 class ASTUnit;
 class MacroInfo;
 class MacroDefinitionRecord;
+class PreambleStore;
 class SourceLocation;
 class Token;
 class IdentifierInfo;
@@ -44,6 +45,8 @@ class CIndexer {
 
   std::string InvocationEmissionPath;
 
+  std::shared_ptr<PreambleStore> Preambles;
+
 public:
   CIndexer(std::shared_ptr<PCHContainerOperations> PCHContainerOps =
                std::make_shared<PCHContainerOperations>())
@@ -83,6 +86,13 @@ public:
   }
 
   StringRef getInvocationEmissionPath() const { return InvocationEmissionPath; }
+
+  /// The store that shares preambles between the translation units of this
+  /// index, if enabled.
+  std::shared_ptr<PreambleStore> getPreambleStore() const { return Preambles; }
+  void setPreambleStore(std::shared_ptr<PreambleStore> Store) {
+    Preambles = std::move(Store);
+  }
 };
 
 /// Logs information about a particular libclang operation like parsing to
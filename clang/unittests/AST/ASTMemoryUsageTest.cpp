@@ -0,0 +1,55 @@
+//===- unittests/AST/ASTMemoryUsageTest.cpp - ASTMemoryUsage tests --------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ASTMemoryUsage.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace clang;
+
+namespace {
+
+TEST(ASTMemoryUsage, CountsNodesByKind) {
+  std::unique_ptr<ASTUnit> AST = tooling::buildASTFromCodeWithArgs(
+      "struct [[deprecated]] A { int x; int f(int y) { return x + y; } };\n"
+      "template <typename T> T add(T a, T b) { return a + b; }\n"
+      "int g(A *p) { return add(p->f(1), 2) + add<long>(3, 4); }\n"
+      "namespace N { int h(); int h(int); }\n",
+      {"-std=c++11", "-Wno-deprecated-declarations"});
+  ASSERT_TRUE(AST);
+
+  ASTMemoryUsage Usage(AST->getASTContext());
+  // The template pattern and its two instantiations, g and both h.
+  EXPECT_EQ(6u, Usage.lookup("FunctionDecl").Count);
+  EXPECT_EQ(6u * sizeof(FunctionDecl), Usage.lookup("FunctionDecl").Bytes);
+  EXPECT_EQ(1u, Usage.lookup("CXXMethodDecl").Count);
+  EXPECT_EQ(9u, Usage.lookup("ParmVarDecl").Count);
+  EXPECT_EQ(1u, Usage.lookup("FieldDecl").Count);
+  EXPECT_EQ(1u, Usage.lookup("DeprecatedAttr").Count);
+  EXPECT_EQ(2u, Usage.lookup("CallExpr").Count);
+  EXPECT_EQ(1u, Usage.lookup("CXXMemberCallExpr").Count);
+  EXPECT_EQ(0u, Usage.lookup("CXXConstructExpr").Count);
+  EXPECT_LE(1u, Usage.lookup("DeclContext lookup table").Count);
+  EXPECT_LE(1u, Usage.lookup("PointerType").Count);
+
+  uint64_t Total = 0;
+  for (const auto &E : Usage.getEntries())
+    Total += E.second.Bytes;
+  EXPECT_EQ(Total, Usage.getTotalBytes());
+
+  std::string S;
+  llvm::raw_string_ostream OS(S);
+  Usage.print(OS);
+  EXPECT_NE(std::string::npos, OS.str().find("CXXMethodDecl"));
+}
+
+} // end anonymous namespace
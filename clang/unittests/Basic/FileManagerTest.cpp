@@ -379,4 +379,32 @@ TEST_F(FileManagerTest, getFileDontOpenRealPath) {
   EXPECT_EQ(file->tryGetRealPathName(), ExpectedResult);
 }
 
+TEST_F(FileManagerTest, hasChangedOnDisk) {
+  auto FS = IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem>(
+      new llvm::vfs::InMemoryFileSystem);
+  FS->addFile("/dir/a.h", 0, llvm::MemoryBuffer::getMemBuffer("a"));
+
+  FileSystemOptions Opts;
+  FileManager Manager(Opts, FS);
+  EXPECT_TRUE(Manager.getFile("/dir/a.h") != nullptr);
+  EXPECT_TRUE(Manager.getFile("/dir/b.h") == nullptr);
+  EXPECT_TRUE(Manager.getDirectory("/other") == nullptr);
+  EXPECT_FALSE(Manager.hasChangedOnDisk());
+
+  // A file that was not found before now exists.
+  FS->addFile("/dir/b.h", 0, llvm::MemoryBuffer::getMemBuffer("b"));
+  EXPECT_TRUE(Manager.hasChangedOnDisk());
+
+  FileManager OtherManager(Opts, FS);
+  EXPECT_TRUE(OtherManager.getDirectory("/other") == nullptr);
+  EXPECT_FALSE(OtherManager.hasChangedOnDisk());
+  FS->addFile("/other/c.h", 0, llvm::MemoryBuffer::getMemBuffer("c"));
+  EXPECT_TRUE(OtherManager.hasChangedOnDisk());
+
+  // Virtual files don't exist on disk at all.
+  FileManager VirtualManager(Opts, FS);
+  VirtualManager.getVirtualFile("/virtual.h", 1, 0);
+  EXPECT_TRUE(VirtualManager.hasChangedOnDisk());
+}
+
 } // anonymous namespace
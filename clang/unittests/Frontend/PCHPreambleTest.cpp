@@ -76,7 +76,9 @@ public:
     RemappedFiles[Filename] = Contents;
   }
 
-  std::unique_ptr<ASTUnit> ParseAST(const std::string &EntryFile) {
+  std::unique_ptr<ASTUnit>
+  ParseAST(const std::string &EntryFile,
+           std::shared_ptr<PreambleStore> Preambles = nullptr) {
     PCHContainerOpts = std::make_shared<PCHContainerOperations>();
     std::shared_ptr<CompilerInvocation> CI(new CompilerInvocation);
     CI->getFrontendOpts().Inputs.push_back(
@@ -97,7 +99,8 @@ public:
 
     std::unique_ptr<ASTUnit> AST = ASTUnit::LoadFromCompilerInvocation(
       CI, PCHContainerOpts, Diags, FileMgr, false, false,
-      /*PrecompilePreambleAfterNParses=*/1);
+      /*PrecompilePreambleAfterNParses=*/1, TU_Complete, false, false, false,
+      std::move(Preambles));
     return AST;
   }
 
@@ -262,4 +265,40 @@ TEST_F(PCHPreambleTest, ParseWithBom) {
   ASSERT_LE(HeaderReadCount, GetFileReadCount(Header));
 }
 
+TEST_F(PCHPreambleTest, PreambleIsSharedBetweenMainFiles) {
+  std::string Header = "//./header.h";
+  std::string Main1 = "//./main1.cpp";
+  std::string Main2 = "//./main2.cpp";
+  std::string Main3 = "//./other/main3.cpp";
+  AddFile(Header, "int random() { return 4; }");
+  AddFile(Main1, "#include \"//./header.h\"\n"
+                 "int one() { return random(); }");
+  AddFile(Main2, "#include \"//./header.h\"\n"
+                 "int two() { return random() + 1; }");
+  AddFile(Main3, "#include \"//./header.h\"\n"
+                 "int three() { return random() + 2; }");
+
+  auto Preambles = std::make_shared<PreambleStore>();
+  std::unique_ptr<ASTUnit> AST1(ParseAST(Main1, Preambles));
+  ASSERT_TRUE(AST1.get());
+  ASSERT_FALSE(AST1->getDiagnostics().hasErrorOccurred());
+  ASSERT_EQ(AST1->getPreambleCounterForTests(), 1U);
+
+  unsigned HeaderReadCount = GetFileReadCount(Header);
+
+  // A main file with the same preamble in the same directory uses the
+  // preamble of the first one.
+  std::unique_ptr<ASTUnit> AST2(ParseAST(Main2, Preambles));
+  ASSERT_TRUE(AST2.get());
+  ASSERT_FALSE(AST2->getDiagnostics().hasErrorOccurred());
+  ASSERT_EQ(AST2->getPreambleCounterForTests(), 0U);
+  ASSERT_EQ(HeaderReadCount, GetFileReadCount(Header));
+
+  // Quoted includes may resolve differently in another directory.
+  std::unique_ptr<ASTUnit> AST3(ParseAST(Main3, Preambles));
+  ASSERT_TRUE(AST3.get());
+  ASSERT_FALSE(AST3->getDiagnostics().hasErrorOccurred());
+  ASSERT_EQ(AST3->getPreambleCounterForTests(), 1U);
+}
+
 } // anonymous namespace
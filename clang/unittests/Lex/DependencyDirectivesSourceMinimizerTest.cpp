@@ -0,0 +1,125 @@
+//===- unittests/Lex/DependencyDirectivesSourceMinimizerTest.cpp ----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "llvm/ADT/SmallString.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+std::string minimize(StringRef Input, bool ExpectError = false) {
+  SmallString<128> Out;
+  EXPECT_EQ(ExpectError, minimizeSourceToDependencyDirectives(Input, Out));
+  return Out.str();
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, Empty) {
+  EXPECT_EQ("", minimize(""));
+  EXPECT_EQ("", minimize("abc def\nxyz"));
+  EXPECT_EQ("", minimize("\xEF\xBB\xBF int x;"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, KeptDirectives) {
+  EXPECT_EQ("#include \"a.h\"\n"
+            "#include_next <b.h>\n"
+            "#import <c/d.h>\n"
+            "#define MACRO(x) x + 1\n"
+            "#undef MACRO\n"
+            "#if FOO && defined(BAR)\n"
+            "#elif __has_include(<e.h>)\n"
+            "#else\n"
+            "#endif\n",
+            minimize("#include \"a.h\"\n"
+                     "int x;\n"
+                     "#include_next <b.h>\n"
+                     "#import <c/d.h>\n"
+                     "#define MACRO(x) x + 1\n"
+                     "#undef MACRO\n"
+                     "#if FOO && defined(BAR)\n"
+                     "void f();\n"
+                     "#elif __has_include(<e.h>)\n"
+                     "#else\n"
+                     "#endif\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, SkippedDirectives) {
+  EXPECT_EQ("", minimize("#error nope\n"
+                         "#warning nope\n"
+                         "#line 10\n"
+                         "# 10 \"file.c\"\n"
+                         "#\n"
+                         "#pragma GCC diagnostic push\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, Whitespace) {
+  EXPECT_EQ("#define A\n#define B(x) x\n#define C (x) x\n",
+            minimize("  #   define   A   \n"
+                     "\t#define\tB(x)\t\tx\n"
+                     "#define C (x) x\n"));
+  // A function-like macro must stay function-like, and vice versa.
+  EXPECT_EQ("#define F(x) x\n", minimize("#define F(x) \\\n  x\n"));
+  EXPECT_EQ("#define A B\n", minimize("#define A \\  \n B\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, Comments) {
+  EXPECT_EQ("#include <a.h>\n#define A B\n#define C\n",
+            minimize("/* comment */ #include <a.h> // trailing\n"
+                     "#define A/* x */B\n"
+                     "#define C /* multi\n line */\n"));
+  // A directive can't follow a comment that spans lines.
+  EXPECT_EQ("", minimize("/* multi\n line */ #include <a.h>\n"));
+  // Line comments continue over escaped newlines.
+  EXPECT_EQ("", minimize("// comment \\\n#include <a.h>\n"));
+  EXPECT_EQ("", minimize("/* #include <a.h>\n#define A */\n"));
+  EXPECT_EQ("", minimize("/* unterminated\n#include <a.h>\n",
+                         /*ExpectError=*/true));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, Literals) {
+  EXPECT_EQ("#include \"a.h\"\n",
+            minimize("const char *S = \"#include <b.h>\";\n"
+                     "#include \"a.h\"\n"));
+  EXPECT_EQ("#include <c.h>\n",
+            minimize("const char *S = R\"x(\n#include <a.h>\n)x\";\n"
+                     "auto T = u8R\"(\n#include <b.h>\n)\";\n"
+                     "#include <c.h>\n"));
+  // Digit separators aren't character literals, and an unterminated literal
+  // ends at the end of the line.
+  EXPECT_EQ("#include <a.h>\n",
+            minimize("int x = 0x1'000'000;\n#include <a.h>\n"));
+  EXPECT_EQ("#if 0\n#endif\n#include <b.h>\n",
+            minimize("#if 0\ndon't\n#endif\n#include <b.h>\n"));
+  EXPECT_EQ("#define Q \"a // b\"\n", minimize("#define Q \"a // b\"\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, Pragmas) {
+  EXPECT_EQ("#pragma once\n"
+            "#pragma push_macro(\"A\")\n"
+            "#pragma pop_macro(\"A\")\n"
+            "#pragma include_alias(<a.h>, \"b.h\")\n"
+            "#pragma clang module import Mod\n",
+            minimize("#pragma once\n"
+                     "#pragma push_macro(\"A\")\n"
+                     "#pragma pop_macro(\"A\")\n"
+                     "#pragma include_alias(<a.h>, \"b.h\")\n"
+                     "#pragma clang module import Mod\n"
+                     "#pragma clang diagnostic ignored \"-Wfoo\"\n"
+                     "#pragma omp parallel\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, AtImport) {
+  EXPECT_EQ("@import A;\n@import B . C;\n",
+            minimize("@import A;\n@import B /* x */ .\n C; int x;\n"));
+  EXPECT_EQ("", minimize("@importer;\n"));
+  EXPECT_EQ("@import A\n", minimize("@import A", /*ExpectError=*/true));
+}
+
+} // end anonymous namespace
@@ -17,6 +17,8 @@
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/HeaderSearchOptions.h"
 #include "clang/Serialization/InMemoryModuleCache.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
 #include "gtest/gtest.h"
 
 namespace clang {
@@ -107,5 +109,46 @@ TEST_F(HeaderSearchTest, DotDotsWithAbsPath) {
             "z");
 }
 
+TEST_F(HeaderSearchTest, PersistentLookupFileCache) {
+  SmallString<128> TempDir, CachePath;
+  ASSERT_FALSE(
+      llvm::sys::fs::createUniqueDirectory("lookup-file-cache", TempDir));
+  CachePath = TempDir;
+  llvm::sys::path::append(CachePath, "cache");
+
+  auto HSOpts = std::make_shared<HeaderSearchOptions>();
+  HSOpts->LookupFileCachePath = CachePath.str();
+  auto Lookup = [&]() -> const FileEntry * {
+    HeaderSearch HS(HSOpts, SourceMgr, Diags, LangOpts, Target.get());
+    for (StringRef Dir : {"/a", "/b"})
+      HS.AddSearchPath(DirectoryLookup(FileMgr.getDirectory(Dir),
+                                       SrcMgr::C_User, /*isFramework=*/false),
+                       /*isAngled=*/false);
+    const DirectoryLookup *CurDir;
+    const FileEntry *FE = HS.LookupFile(
+        "x.h", SourceLocation(), /*isAngled=*/false, /*FromDir=*/nullptr,
+        CurDir, /*Includers=*/None, /*SearchPath=*/nullptr,
+        /*RelativePath=*/nullptr, /*RequestingModule=*/nullptr,
+        /*SuggestedModule=*/nullptr, /*IsMapped=*/nullptr,
+        /*IsFrameworkFound=*/nullptr);
+    HS.savePersistentLookupFileCache();
+    return FE;
+  };
+
+  addSearchDir("/a");
+  addSearchDir("/b");
+  VFS->addFile("/b/x.h", 0, llvm::MemoryBuffer::getMemBuffer(""));
+  EXPECT_EQ(FileMgr.getFile("/b/x.h"), Lookup());
+  EXPECT_TRUE(llvm::sys::fs::exists(CachePath));
+
+  // The in-memory file system doesn't update the modification time of /a, so
+  // the next search trusts the cache and only looks in /b.
+  VFS->addFile("/a/x.h", 0, llvm::MemoryBuffer::getMemBuffer(""));
+  EXPECT_EQ(FileMgr.getFile("/b/x.h"), Lookup());
+
+  llvm::sys::fs::remove(CachePath);
+  llvm::sys::fs::remove(TempDir);
+}
+
 } // namespace
 } // namespace clang
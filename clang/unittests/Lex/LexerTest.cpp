@@ -475,6 +475,37 @@ TEST_F(LexerTest, AvoidPastEndOfStringDereference) {
   EXPECT_TRUE(Lex("#include <\\\\\n").empty());
 }
 
+TEST_F(LexerTest, LongRuns) {
+  // The runs below are longer than the blocks the lexer scans them in, and
+  // end at every offset within a block.
+  LangOpts.CPlusPlus = true;
+  LangOpts.CPlusPlus11 = true;
+  for (unsigned Len = 1; Len != 40; ++Len) {
+    std::string Ident(Len, 'a');
+    Ident.back() = '_';
+    std::string Space(Len, ' ');
+    Space[Len / 2] = '\t';
+    std::string Body(Len, 'x');
+
+    // The source manager refers to the source, so it must outlive the tokens.
+    std::string Source = Ident + Space + "b" + Space + "// " + Body + "\n" +
+                         Ident + "9+" + "R\"(" + Body + ")\"" + Space +
+                         "std::string" + "//" + Body;
+    std::vector<Token> Toks = CheckLex(
+        Source,
+        {tok::identifier, tok::identifier, tok::identifier, tok::plus,
+         tok::string_literal, tok::identifier, tok::coloncolon,
+         tok::identifier});
+    if (Toks.size() != 8)
+      continue;
+    EXPECT_EQ(Ident, getSourceText(Toks[0], Toks[0]));
+    EXPECT_TRUE(Toks[1].hasLeadingSpace());
+    EXPECT_TRUE(Toks[2].isAtStartOfLine());
+    EXPECT_EQ(Ident + "9", getSourceText(Toks[2], Toks[2]));
+    EXPECT_EQ("R\"(" + Body + ")\"", getSourceText(Toks[4], Toks[4]));
+  }
+}
+
 TEST_F(LexerTest, StringizingRasString) {
   // For "std::string Lexer::Stringify(StringRef Str, bool Charify)".
   std::string String1 = R"(foo
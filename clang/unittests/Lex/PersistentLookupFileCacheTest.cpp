@@ -0,0 +1,163 @@
+//===- unittests/Lex/PersistentLookupFileCacheTest.cpp --------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/PersistentLookupFileCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+class PersistentLookupFileCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(sys::fs::createUniqueDirectory("lookup-file-cache", TempDir));
+    CachePath = TempDir;
+    sys::path::append(CachePath, "cache");
+  }
+
+  void TearDown() override {
+    sys::fs::remove(CachePath);
+    sys::fs::remove(TempDir);
+  }
+
+  /// Returns a file system with the directories \p Dirs, which have the
+  /// modification times in \p MTimes.
+  IntrusiveRefCntPtr<vfs::FileSystem> createFS(ArrayRef<StringRef> Dirs,
+                                               ArrayRef<time_t> MTimes) {
+    IntrusiveRefCntPtr<vfs::InMemoryFileSystem> FS(
+        new vfs::InMemoryFileSystem());
+    for (unsigned I = 0, E = Dirs.size(); I != E; ++I)
+      FS->addFile(Dirs[I], MTimes[I], MemoryBuffer::getMemBuffer(""),
+                  /*User=*/None, /*Group=*/None,
+                  sys::fs::file_type::directory_file);
+    return FS;
+  }
+
+  std::unique_ptr<PersistentLookupFileCache>
+  createCache(ArrayRef<PersistentLookupFileCache::SearchDir> Dirs,
+              vfs::FileSystem &FS) {
+    return llvm::make_unique<PersistentLookupFileCache>(CachePath, Dirs, FS);
+  }
+
+  SmallString<128> TempDir;
+  SmallString<128> CachePath;
+};
+
+const PersistentLookupFileCache::SearchDir ABC[] = {
+    {"/a", true}, {"/b", true}, {"/c", true}};
+
+TEST_F(PersistentLookupFileCacheTest, Persists) {
+  auto FS = createFS({"/a", "/b", "/c"}, {1, 1, 1});
+  auto Cache = createCache(ABC, *FS);
+  EXPECT_EQ(None, Cache->lookup("x.h", 0));
+  Cache->insert("x.h", 0, 2);
+  Cache->insert("dir/y h.h", 1, 1);
+  EXPECT_EQ(2u, Cache->lookup("x.h", 0));
+  EXPECT_FALSE(Cache->save());
+
+  Cache = createCache(ABC, *FS);
+  EXPECT_EQ(2u, Cache->lookup("x.h", 0));
+  EXPECT_EQ(1u, Cache->lookup("dir/y h.h", 1));
+  // The start of the search is part of the key.
+  EXPECT_EQ(None, Cache->lookup("x.h", 1));
+  EXPECT_EQ(None, Cache->lookup("dir/y h.h", 0));
+  EXPECT_EQ(2u, Cache->getNumHits());
+  EXPECT_EQ(2u, Cache->getNumMisses());
+}
+
+TEST_F(PersistentLookupFileCacheTest, ChangedDirectories) {
+  auto FS = createFS({"/a", "/b", "/c"}, {1, 1, 1});
+  auto Cache = createCache(ABC, *FS);
+  Cache->insert("x.h", 0, 2);
+  Cache->insert("y.h", 2, 2);
+  EXPECT_FALSE(Cache->save());
+
+  // A file may have been added to /b, which would now be found first.
+  FS = createFS({"/a", "/b", "/c"}, {1, 2, 1});
+  Cache = createCache(ABC, *FS);
+  EXPECT_EQ(None, Cache->lookup("x.h", 0));
+  EXPECT_EQ(2u, Cache->lookup("y.h", 2));
+
+  // Directories that appear count as changed too.
+  FS = createFS({"/b", "/c"}, {1, 1});
+  Cache = createCache(ABC, *FS);
+  Cache->insert("z.h", 1, 2);
+  EXPECT_FALSE(Cache->save());
+  FS = createFS({"/a", "/b", "/c"}, {1, 1, 1});
+  Cache = createCache(ABC, *FS);
+  EXPECT_EQ(None, Cache->lookup("x.h", 0));
+  EXPECT_EQ(2u, Cache->lookup("z.h", 1));
+}
+
+TEST_F(PersistentLookupFileCacheTest, SearchLists) {
+  const PersistentLookupFileCache::SearchDir AC[] = {{"/a", true},
+                                                     {"/c", true}};
+  auto FS = createFS({"/a", "/b", "/c"}, {1, 1, 1});
+  auto Cache = createCache(ABC, *FS);
+  Cache->insert("x.h", 0, 2);
+  EXPECT_FALSE(Cache->save());
+  Cache = createCache(AC, *FS);
+  EXPECT_EQ(None, Cache->lookup("x.h", 0));
+  Cache->insert("x.h", 0, 1);
+  EXPECT_FALSE(Cache->save());
+
+  EXPECT_EQ(2u, createCache(ABC, *FS)->lookup("x.h", 0));
+  EXPECT_EQ(1u, createCache(AC, *FS)->lookup("x.h", 0));
+}
+
+TEST_F(PersistentLookupFileCacheTest, UncacheableDirectories) {
+  const PersistentLookupFileCache::SearchDir Dirs[] = {
+      {"/a", true}, {"H/a.hmap", false}, {"/c", true}};
+  auto FS = createFS({"/a", "/c"}, {1, 1});
+  auto Cache = createCache(Dirs, *FS);
+  Cache->insert("x.h", 0, 2);
+  Cache->insert("y.h", 2, 2);
+  EXPECT_EQ(None, Cache->lookup("x.h", 0));
+  EXPECT_FALSE(Cache->save());
+  Cache = createCache(Dirs, *FS);
+  EXPECT_EQ(None, Cache->lookup("x.h", 0));
+  EXPECT_EQ(2u, Cache->lookup("y.h", 2));
+}
+
+TEST_F(PersistentLookupFileCacheTest, MergesConcurrentSaves) {
+  auto FS = createFS({"/a", "/b", "/c"}, {1, 1, 1});
+  auto Cache1 = createCache(ABC, *FS);
+  auto Cache2 = createCache(ABC, *FS);
+  Cache1->insert("x.h", 0, 1);
+  Cache2->insert("y.h", 0, 2);
+  EXPECT_FALSE(Cache1->save());
+  EXPECT_FALSE(Cache2->save());
+
+  auto Cache = createCache(ABC, *FS);
+  EXPECT_EQ(1u, Cache->lookup("x.h", 0));
+  EXPECT_EQ(2u, Cache->lookup("y.h", 0));
+}
+
+TEST_F(PersistentLookupFileCacheTest, IgnoresInvalidFiles) {
+  {
+    std::error_code EC;
+    raw_fd_ostream OS(CachePath, EC);
+    ASSERT_FALSE(EC);
+    // A truncated section.
+    OS << "clang-lookup-file-cache 1\nlist 1234 3 2\n1\n1\n";
+  }
+  auto FS = createFS({"/a", "/b", "/c"}, {1, 1, 1});
+  auto Cache = createCache(ABC, *FS);
+  EXPECT_EQ(None, Cache->lookup("x.h", 0));
+  Cache->insert("x.h", 0, 2);
+  EXPECT_FALSE(Cache->save());
+  EXPECT_EQ(2u, createCache(ABC, *FS)->lookup("x.h", 0));
+}
+
+} // end anonymous namespace
@@ -0,0 +1,172 @@
+//===- unittest/Tooling/CachingFileSystemTest.cpp -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/CachingFileSystem.h"
+#include "gtest/gtest.h"
+
+using namespace clang;
+using namespace tooling;
+
+namespace {
+
+/// An in-memory file system that counts the requests that reach it, and whose
+/// contents can be replaced to simulate changes on disk.
+class CountingFileSystem : public llvm::vfs::FileSystem {
+public:
+  CountingFileSystem() { reset(); }
+
+  /// Replaces all files with an empty file system.
+  void reset() {
+    FS = new llvm::vfs::InMemoryFileSystem();
+    FS->setCurrentWorkingDirectory("/");
+  }
+
+  void addFile(StringRef Path, time_t MTime, StringRef Contents) {
+    FS->addFile(Path, MTime, llvm::MemoryBuffer::getMemBufferCopy(Contents));
+  }
+
+  llvm::ErrorOr<llvm::vfs::Status> status(const Twine &Path) override {
+    ++NumStatus;
+    return FS->status(Path);
+  }
+  llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+  openFileForRead(const Twine &Path) override {
+    ++NumOpen;
+    return FS->openFileForRead(Path);
+  }
+  llvm::vfs::directory_iterator dir_begin(const Twine &Dir,
+                                          std::error_code &EC) override {
+    return FS->dir_begin(Dir, EC);
+  }
+  llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override {
+    return CWD;
+  }
+  std::error_code setCurrentWorkingDirectory(const Twine &Path) override {
+    CWD = Path.str();
+    return {};
+  }
+
+  unsigned NumStatus = 0;
+  unsigned NumOpen = 0;
+
+private:
+  IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> FS;
+  std::string CWD = "/";
+};
+
+std::string readFile(llvm::vfs::FileSystem &FS, StringRef Path) {
+  auto File = FS.openFileForRead(Path);
+  if (!File)
+    return "<error>";
+  auto Buffer = (*File)->getBuffer(Path);
+  if (!Buffer)
+    return "<error>";
+  EXPECT_EQ(Path, (*Buffer)->getBufferIdentifier());
+  return (*Buffer)->getBuffer();
+}
+
+TEST(CachingFileSystemTest, SharesEntriesBetweenFileSystems) {
+  IntrusiveRefCntPtr<CountingFileSystem> Real(new CountingFileSystem());
+  Real->addFile("/dir/a.h", 1, "a");
+  SharedFileSystemCache Cache(/*ValidateContents=*/false);
+  CachingFileSystem FS1(Cache, Real), FS2(Cache, Real);
+
+  auto Status = FS1.status("/dir/a.h");
+  ASSERT_TRUE(bool(Status));
+  EXPECT_EQ("/dir/a.h", Status->getName());
+  EXPECT_EQ("a", readFile(FS1, "/dir/a.h"));
+  EXPECT_EQ(1u, Real->NumStatus);
+  EXPECT_EQ(1u, Real->NumOpen);
+
+  // The other file system finds the entry under a relative path too.
+  FS2.setCurrentWorkingDirectory("/dir");
+  Status = FS2.status("a.h");
+  ASSERT_TRUE(bool(Status));
+  EXPECT_EQ("a.h", Status->getName());
+  EXPECT_EQ("a", readFile(FS2, "./a.h"));
+  EXPECT_EQ(1u, Real->NumStatus);
+  EXPECT_EQ(1u, Real->NumOpen);
+
+  const SharedFileSystemCache::Statistics &Stats = Cache.getStatistics();
+  EXPECT_EQ(1u, Stats.StatusHits);
+  EXPECT_EQ(1u, Stats.StatusMisses);
+  EXPECT_EQ(1u, Stats.ContentsHits);
+  EXPECT_EQ(1u, Stats.ContentsMisses);
+}
+
+TEST(CachingFileSystemTest, CachesMissingFiles) {
+  IntrusiveRefCntPtr<CountingFileSystem> Real(new CountingFileSystem());
+  SharedFileSystemCache Cache;
+  CachingFileSystem FS(Cache, Real);
+
+  EXPECT_FALSE(FS.status("/missing.h"));
+  EXPECT_FALSE(FS.status("/missing.h"));
+  EXPECT_FALSE(FS.openFileForRead("/missing.h"));
+  EXPECT_EQ(1u, Real->NumStatus);
+  EXPECT_EQ(0u, Real->NumOpen);
+}
+
+TEST(CachingFileSystemTest, RereadsChangedFiles) {
+  IntrusiveRefCntPtr<CountingFileSystem> Real(new CountingFileSystem());
+  Real->addFile("/a.h", 1, "old");
+  SharedFileSystemCache Cache;
+  CachingFileSystem FS(Cache, Real);
+
+  EXPECT_EQ("old", readFile(FS, "/a.h"));
+  // An unchanged file is validated with a stat, but not read again.
+  EXPECT_EQ("old", readFile(FS, "/a.h"));
+  EXPECT_EQ(2u, Real->NumStatus);
+  EXPECT_EQ(1u, Real->NumOpen);
+
+  Real->reset();
+  Real->addFile("/a.h", 2, "new");
+  EXPECT_EQ("new", readFile(FS, "/a.h"));
+  EXPECT_EQ(2u, Real->NumOpen);
+}
+
+TEST(CachingFileSystemTest, BuffersOutliveTheirEntries) {
+  IntrusiveRefCntPtr<CountingFileSystem> Real(new CountingFileSystem());
+  Real->addFile("/a.h", 1, "old");
+  SharedFileSystemCache Cache;
+  CachingFileSystem FS(Cache, Real);
+
+  auto File = FS.openFileForRead("/a.h");
+  ASSERT_TRUE(bool(File));
+  auto Buffer = (*File)->getBuffer("/a.h");
+  ASSERT_TRUE(bool(Buffer));
+
+  Real->reset();
+  Real->addFile("/a.h", 2, "new");
+  EXPECT_EQ("new", readFile(FS, "/a.h"));
+  EXPECT_EQ("old", (*Buffer)->getBuffer());
+  EXPECT_EQ('\0', *(*Buffer)->getBufferEnd());
+}
+
+TEST(CachingFileSystemTest, InvalidateChangedFiles) {
+  IntrusiveRefCntPtr<CountingFileSystem> Real(new CountingFileSystem());
+  Real->addFile("/a.h", 1, "a");
+  Real->addFile("/b.h", 1, "b");
+  SharedFileSystemCache Cache(/*ValidateContents=*/false);
+  CachingFileSystem FS(Cache, Real);
+
+  EXPECT_EQ("a", readFile(FS, "/a.h"));
+  EXPECT_EQ("b", readFile(FS, "/b.h"));
+  EXPECT_FALSE(FS.status("/c.h"));
+  EXPECT_EQ(0u, Cache.invalidateChangedFiles(*Real));
+
+  Real->reset();
+  Real->addFile("/a.h", 2, "aa");
+  Real->addFile("/b.h", 1, "b");
+  Real->addFile("/c.h", 1, "c");
+  EXPECT_EQ(2u, Cache.invalidateChangedFiles(*Real));
+  EXPECT_EQ("aa", readFile(FS, "/a.h"));
+  EXPECT_EQ("b", readFile(FS, "/b.h"));
+  EXPECT_EQ("c", readFile(FS, "/c.h"));
+}
+
+} // end anonymous namespace
@@ -13,6 +13,8 @@
 
 #include "asan_test_utils.h"
 
+#include <chrono>
+
 template<class T>
 __attribute__((noinline))
 static void ManyAccessFunc(T *x, size_t n_elements, size_t n_iter) {
@@ -78,6 +80,43 @@ TEST(AddressSanitizer, FakeStackBenchmark) {
     Ident(&FunctionWithLargeStack)();
 }
 
+// Each thread keeps a small window of live allocations of mixed sizes, so that
+// frees go through the quarantine while mallocs keep hitting the primary.
+static void *MallocFreeThread(void *arg) {
+  const size_t kNumIterations = *reinterpret_cast<size_t *>(arg);
+  const size_t kWindow = 64;
+  void *live[kWindow] = {};
+  for (size_t i = 0; i < kNumIterations; i++) {
+    size_t slot = i % kWindow;
+    free(live[slot]);
+    live[slot] = malloc(16 + (i * 24) % 1024);
+    break_optimization(live[slot]);
+  }
+  for (size_t i = 0; i < kWindow; i++)
+    free(live[i]);
+  return nullptr;
+}
+
+// Reports the malloc/free throughput of the allocator for a growing number of
+// threads.
+TEST(AddressSanitizer, MallocFreeThroughputBenchmark) {
+  const size_t kNumIterations = 1 << 20;
+  const int kMaxThreads = 16;
+  for (int num_threads = 1; num_threads <= kMaxThreads; num_threads *= 2) {
+    pthread_t threads[kMaxThreads];
+    size_t iterations = kNumIterations;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_threads; i++)
+      PTHREAD_CREATE(&threads[i], 0, MallocFreeThread, &iterations);
+    for (int i = 0; i < num_threads; i++)
+      PTHREAD_JOIN(threads[i], 0);
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    fprintf(stderr, "%2d thread(s): %.2f M malloc+free pairs/s\n", num_threads,
+            num_threads * kNumIterations / seconds / 1e6);
+  }
+}
+
 int main(int argc, char **argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,162 @@
+//===-- mem.c - Implement memcpy, memmove, memset and bcmp ----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements memcpy, memmove, memset and bcmp for the clang_rt.mem
+// library, for freestanding and sanitizer runtimes that cannot rely on the
+// quality of the libc ones. It must be compiled with -fno-builtin so that the
+// compiler does not turn these functions into calls to themselves.
+//
+// The bodies are instantiated from mem_impl.inc for 16-byte vectors, which
+// SSE2 and NEON provide on x86_64 and AArch64. On x86_64 ELF targets AVX2 and
+// AVX-512 versions are instantiated as well and picked once, at relocation
+// time, through an ifunc resolver.
+//
+//===----------------------------------------------------------------------===//
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint16_t mem_u16 __attribute__((__aligned__(1), __may_alias__));
+typedef uint32_t mem_u32 __attribute__((__aligned__(1), __may_alias__));
+typedef uint64_t mem_u64 __attribute__((__aligned__(1), __may_alias__));
+typedef char mem_v16
+    __attribute__((__vector_size__(16), __aligned__(1), __may_alias__));
+typedef uint64_t mem_w16
+    __attribute__((__vector_size__(16), __aligned__(1), __may_alias__));
+
+#define MEM_LOAD16(p) (*(const mem_v16 *)(p))
+#define MEM_STORE16(p, v) (*(mem_v16 *)(p) = (v))
+
+// Copies at most 16 bytes with two possibly overlapping accesses.
+static inline void mem_copy_16(unsigned char *d, const unsigned char *s,
+                               size_t n) {
+  if (n >= 8) {
+    uint64_t a = *(const mem_u64 *)s, b = *(const mem_u64 *)(s + n - 8);
+    *(mem_u64 *)d = a;
+    *(mem_u64 *)(d + n - 8) = b;
+  } else if (n >= 4) {
+    uint32_t a = *(const mem_u32 *)s, b = *(const mem_u32 *)(s + n - 4);
+    *(mem_u32 *)d = a;
+    *(mem_u32 *)(d + n - 4) = b;
+  } else if (n >= 2) {
+    uint16_t a = *(const mem_u16 *)s, b = *(const mem_u16 *)(s + n - 2);
+    *(mem_u16 *)d = a;
+    *(mem_u16 *)(d + n - 2) = b;
+  } else if (n) {
+    *d = *s;
+  }
+}
+
+// Sets at most 16 bytes to the byte repeated in `pattern`.
+static inline void mem_set_16(unsigned char *d, uint64_t pattern, size_t n) {
+  if (n >= 8) {
+    *(mem_u64 *)d = pattern;
+    *(mem_u64 *)(d + n - 8) = pattern;
+  } else if (n >= 4) {
+    *(mem_u32 *)d = (uint32_t)pattern;
+    *(mem_u32 *)(d + n - 4) = (uint32_t)pattern;
+  } else if (n >= 2) {
+    *(mem_u16 *)d = (uint16_t)pattern;
+    *(mem_u16 *)(d + n - 2) = (uint16_t)pattern;
+  } else if (n) {
+    *d = (unsigned char)pattern;
+  }
+}
+
+// Compares at most 32 bytes; returns nonzero if they differ.
+static inline int mem_bcmp_32(const unsigned char *a, const unsigned char *b,
+                              size_t n) {
+  if (n > 16) {
+    mem_w16 x = (mem_w16)((MEM_LOAD16(a) ^ MEM_LOAD16(b)) |
+                          (MEM_LOAD16(a + n - 16) ^ MEM_LOAD16(b + n - 16)));
+    return (x[0] | x[1]) != 0;
+  }
+  if (n >= 8)
+    return ((*(const mem_u64 *)a ^ *(const mem_u64 *)b) |
+            (*(const mem_u64 *)(a + n - 8) ^
+             *(const mem_u64 *)(b + n - 8))) != 0;
+  if (n >= 4)
+    return ((*(const mem_u32 *)a ^ *(const mem_u32 *)b) |
+            (*(const mem_u32 *)(a + n - 4) ^
+             *(const mem_u32 *)(b + n - 4))) != 0;
+  if (n >= 2)
+    return ((*(const mem_u16 *)a ^ *(const mem_u16 *)b) |
+            (*(const mem_u16 *)(a + n - 2) ^
+             *(const mem_u16 *)(b + n - 2))) != 0;
+  return n ? *a != *b : 0;
+}
+
+#define MEM_VEC_BYTES 16
+#define MEM_NAME(fn) mem_##fn##_16
+#define MEM_TARGET
+#include "mem_impl.inc"
+#undef MEM_TARGET
+#undef MEM_NAME
+#undef MEM_VEC_BYTES
+
+#if defined(__x86_64__) && defined(__ELF__) && !defined(__ANDROID__)
+#define MEM_USE_IFUNC 1
+
+#define MEM_VEC_BYTES 32
+#define MEM_NAME(fn) mem_##fn##_avx2
+#define MEM_TARGET __attribute__((__target__("avx2")))
+#include "mem_impl.inc"
+#undef MEM_TARGET
+#undef MEM_NAME
+#undef MEM_VEC_BYTES
+
+#define MEM_VEC_BYTES 64
+#define MEM_NAME(fn) mem_##fn##_avx512
+#define MEM_TARGET __attribute__((__target__("avx512f")))
+#include "mem_impl.inc"
+#undef MEM_TARGET
+#undef MEM_NAME
+#undef MEM_VEC_BYTES
+
+// Resolvers run while relocations are processed, before any constructor, so
+// __builtin_cpu_init() has to be called explicitly.
+#define MEM_RESOLVER(fn)                                                       \
+  static __typeof(mem_##fn##_16) *mem_resolve_##fn(void) {                     \
+    __builtin_cpu_init();                                                      \
+    if (__builtin_cpu_supports("avx512f"))                                     \
+      return mem_##fn##_avx512;                                                \
+    if (__builtin_cpu_supports("avx2"))                                        \
+      return mem_##fn##_avx2;                                                  \
+    return mem_##fn##_16;                                                      \
+  }
+
+MEM_RESOLVER(memcpy)
+MEM_RESOLVER(memmove)
+MEM_RESOLVER(memset)
+MEM_RESOLVER(bcmp)
+
+void *memcpy(void *dst, const void *src, size_t n)
+    __attribute__((__ifunc__("mem_resolve_memcpy")));
+void *memmove(void *dst, const void *src, size_t n)
+    __attribute__((__ifunc__("mem_resolve_memmove")));
+void *memset(void *dst, int c, size_t n)
+    __attribute__((__ifunc__("mem_resolve_memset")));
+int bcmp(const void *lhs, const void *rhs, size_t n)
+    __attribute__((__ifunc__("mem_resolve_bcmp")));
+#endif
+
+#ifndef MEM_USE_IFUNC
+void *memcpy(void *dst, const void *src, size_t n) {
+  return mem_memcpy_16(dst, src, n);
+}
+
+void *memmove(void *dst, const void *src, size_t n) {
+  return mem_memmove_16(dst, src, n);
+}
+
+void *memset(void *dst, int c, size_t n) { return mem_memset_16(dst, c, n); }
+
+int bcmp(const void *lhs, const void *rhs, size_t n) {
+  return mem_bcmp_16(lhs, rhs, n);
+}
+#endif
@@ -18,6 +18,7 @@
 #include "FuzzerSHA1.h"
 #include "FuzzerTracePC.h"
 #include <algorithm>
+#include <atomic>
 #include <numeric>
 #include <random>
 #include <unordered_set>
@@ -214,10 +215,31 @@ class InputCorpus {
       Printf("EVICTED %zd\n", Idx);
   }
 
+  // Bytes needed for a bitmap with one bit per feature.
+  static const size_t kSharedFeaturesSize = kFeatureSetSize / 8;
+
+  // With -fork=N -fork_share_features=1 all the workers share a bitmap of the
+  // features found so far. A feature already found by another worker is never
+  // new, so we don't save (and the parent doesn't re-merge) inputs for it.
+  void SetSharedFeatures(uint8_t *Bitmap) { SharedFeatures = Bitmap; }
+
+  // Marks the feature as found in a shared bitmap, and returns false if some
+  // worker had already marked it.
+  static bool MarkSharedFeature(uint8_t *Bitmap, size_t Idx) {
+    static_assert(sizeof(std::atomic<uint8_t>) == 1, "Unexpected atomic size");
+    Idx = Idx % kFeatureSetSize;
+    auto *Byte = reinterpret_cast<std::atomic<uint8_t> *>(&Bitmap[Idx / 8]);
+    uint8_t Bit = 1 << (Idx % 8);
+    return !(Byte->fetch_or(Bit, std::memory_order_relaxed) & Bit);
+  }
+
   bool AddFeature(size_t Idx, uint32_t NewSize, bool Shrink) {
     assert(NewSize);
     Idx = Idx % kFeatureSetSize;
     uint32_t OldSize = GetFeature(Idx);
+    if (OldSize == 0 && SharedFeatures &&
+        !MarkSharedFeature(SharedFeatures, Idx))
+      return false;
     if (OldSize == 0 || (Shrink && OldSize > NewSize)) {
       if (OldSize > 0) {
         size_t OldIdx = SmallestElementPerFeature[Idx];
@@ -301,6 +323,7 @@ private:
   size_t NumUpdatedFeatures = 0;
   uint32_t InputSizesPerFeature[kFeatureSetSize];
   uint32_t SmallestElementPerFeature[kFeatureSetSize];
+  uint8_t *SharedFeatures = nullptr;
 
   std::string OutputCorpus;
 };
@@ -9,6 +9,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "FuzzerCommand.h"
+#include "FuzzerCorpus.h"
 #include "FuzzerFork.h"
 #include "FuzzerIO.h"
 #include "FuzzerInternal.h"
@@ -88,6 +89,8 @@ struct GlobalEnv {
   std::string TempDir;
   std::string DFTDir;
   std::string DataFlowBinary;
+  std::string SharedFeaturesPath;
+  uint8_t *SharedFeatures = nullptr;
   Set<uint32_t> Features, Cov;
   Vector<std::string> Files;
   Random *Rand;
@@ -118,6 +121,8 @@ struct GlobalEnv {
     Cmd.addFlag("print_final_stats", "1");
     Cmd.addFlag("print_funcs", "0");  // no need to spend time symbolizing.
     Cmd.addFlag("max_total_time", std::to_string(std::min((size_t)300, JobId)));
+    if (SharedFeatures)
+      Cmd.addFlag("shared_features", SharedFeaturesPath);
     if (!DataFlowBinary.empty()) {
       Cmd.addFlag("data_flow_trace", DFTDir);
       if (!Cmd.hasFlag("focus_function"))
@@ -199,6 +204,7 @@ struct GlobalEnv {
       CollectDFT(NewPath);
     }
     Features.insert(NewFeatures.begin(), NewFeatures.end());
+    ShareFeatures(NewFeatures);
     Cov.insert(NewCov.begin(), NewCov.end());
     for (auto Idx : NewCov)
       if (auto *TE = TPC.PCTableEntryByIdx(Idx))
@@ -215,6 +221,14 @@ struct GlobalEnv {
   }
 
 
+  // Publishes features to the jobs, which will then ignore inputs that only
+  // find these features.
+  void ShareFeatures(const Set<uint32_t> &Fts) {
+    if (!SharedFeatures) return;
+    for (auto Ft : Fts)
+      InputCorpus::MarkSharedFeature(SharedFeatures, Ft);
+  }
+
   void CollectDFT(const std::string &InputPath) {
     if (DataFlowBinary.empty()) return;
     Command Cmd(Args);
@@ -300,6 +314,18 @@ void FuzzWithFork(Random &Rand, const FuzzingOptions &Options,
     Env.CollectDFT(F);
 
   RemoveFile(CFPath);
+
+  if (Options.ForkShareFeatures) {
+    Env.SharedFeaturesPath = DirPlusFile(Env.TempDir, "features.bitmap");
+    Env.SharedFeatures = MapSharedFile(Env.SharedFeaturesPath,
+                                       InputCorpus::kSharedFeaturesSize);
+    if (Env.SharedFeatures)
+      Env.ShareFeatures(Env.Features);
+    else
+      Printf("WARNING: -fork_share_features=1: failed to map %s; "
+             "not sharing features\n", Env.SharedFeaturesPath.c_str());
+  }
+
   Printf("INFO: -fork=%d: %zd seed inputs, starting to fuzz in %s\n", NumJobs,
          Env.Files.size(), Env.TempDir.c_str());
 
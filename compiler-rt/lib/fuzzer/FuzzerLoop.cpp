@@ -792,6 +792,16 @@ void Fuzzer::Loop(Vector<SizedFile> &CorporaFiles) {
   TPC.SetFocusFunction(FocusFunctionOrAuto);
   ReadAndExecuteSeedCorpora(CorporaFiles);
   DFT.Clear();  // No need for DFT any more.
+  // Only share features once the seeds are in, so that we don't drop seeds
+  // with features some other worker found already.
+  if (!Options.SharedFeatures.empty()) {
+    if (auto *Bitmap = MapSharedFile(Options.SharedFeatures,
+                                     InputCorpus::kSharedFeaturesSize))
+      Corpus.SetSharedFeatures(Bitmap);
+    else
+      Printf("WARNING: failed to map the shared features from %s\n",
+             Options.SharedFeatures.c_str());
+  }
   TPC.SetPrintNewPCs(Options.PrintNewCovPcs);
   TPC.SetPrintNewFuncs(Options.PrintNewCovFuncs);
   system_clock::time_point LastCorpusReload = system_clock::now();
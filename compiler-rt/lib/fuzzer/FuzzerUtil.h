@@ -54,6 +54,10 @@ void SleepSeconds(int Seconds);
 
 bool Mprotect(void *Ptr, size_t Size, bool AllowReadWrite);
 
+// Maps Size bytes of the file at Path, creating it if needed, as memory shared
+// with every other process mapping the same file. Returns nullptr on failure.
+uint8_t *MapSharedFile(const std::string &Path, size_t Size);
+
 unsigned long GetPid();
 
 size_t GetPeakRSSMb();
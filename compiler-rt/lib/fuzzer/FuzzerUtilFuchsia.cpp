@@ -307,6 +307,10 @@ bool Mprotect(void *Ptr, size_t Size, bool AllowReadWrite) {
   return false;  // UNIMPLEMENTED
 }
 
+uint8_t *MapSharedFile(const std::string &Path, size_t Size) {
+  return nullptr;  // UNIMPLEMENTED
+}
+
 // Platform specific functions.
 void SetSignalHandler(const FuzzingOptions &Options) {
   // Set up alarm handler if needed.
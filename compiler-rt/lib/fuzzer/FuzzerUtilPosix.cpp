@@ -16,6 +16,7 @@
 #include <chrono>
 #include <cstring>
 #include <errno.h>
+#include <fcntl.h>
 #include <iomanip>
 #include <signal.h>
 #include <stdio.h>
@@ -103,6 +104,17 @@ bool Mprotect(void *Ptr, size_t Size, bool AllowReadWrite) {
                        AllowReadWrite ? (PROT_READ | PROT_WRITE) : PROT_NONE);
 }
 
+uint8_t *MapSharedFile(const std::string &Path, size_t Size) {
+  int Fd = open(Path.c_str(), O_RDWR | O_CREAT, 0600);
+  if (Fd < 0)
+    return nullptr;
+  void *Ptr = MAP_FAILED;
+  if (ftruncate(Fd, Size) == 0)
+    Ptr = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+  close(Fd);
+  return Ptr == MAP_FAILED ? nullptr : reinterpret_cast<uint8_t *>(Ptr);
+}
+
 void SetSignalHandler(const FuzzingOptions& Options) {
   if (Options.UnitTimeoutSec > 0)
     SetTimer(Options.UnitTimeoutSec / 2 + 1);
@@ -115,6 +115,10 @@ bool Mprotect(void *Ptr, size_t Size, bool AllowReadWrite) {
   return false;  // UNIMPLEMENTED
 }
 
+uint8_t *MapSharedFile(const std::string &Path, size_t Size) {
+  return nullptr;  // UNIMPLEMENTED
+}
+
 void SetSignalHandler(const FuzzingOptions& Options) {
   HandlerOpt = &Options;
 
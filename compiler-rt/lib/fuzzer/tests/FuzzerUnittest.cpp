@@ -609,6 +609,22 @@ TEST(Corpus, Distribution) {
   }
 }
 
+TEST(Corpus, SharedFeatures) {
+  Vector<uint8_t> Bitmap(InputCorpus::kSharedFeaturesSize);
+  std::unique_ptr<InputCorpus> C(new InputCorpus(""));
+  // Before sharing, every feature is new to this corpus.
+  EXPECT_TRUE(C->AddFeature(1, 10, false));
+  C->SetSharedFeatures(Bitmap.data());
+  // Some other worker found feature 2 already.
+  EXPECT_TRUE(InputCorpus::MarkSharedFeature(Bitmap.data(), 2));
+  EXPECT_FALSE(InputCorpus::MarkSharedFeature(Bitmap.data(), 2));
+  EXPECT_FALSE(C->AddFeature(2, 10, false));
+  // Feature 3 is new everywhere, and is now marked for everyone else.
+  EXPECT_TRUE(C->AddFeature(3, 10, false));
+  EXPECT_FALSE(InputCorpus::MarkSharedFeature(Bitmap.data(), 3));
+  EXPECT_EQ(C->NumFeatures(), 2U);
+}
+
 TEST(Merge, Bad) {
   const char *kInvalidInputs[] = {
     "",
@@ -0,0 +1,49 @@
+//===-- alignment.cpp -------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "gwp_asan/tests/harness.h"
+
+// Allocations are either left-aligned at the start of their slot (and so page
+// aligned), or right-aligned against the trailing guard page with their size
+// rounded up to a power of two, to a maximum of 16 bytes.
+static uintptr_t expectedAlignment(size_t Size) {
+  uintptr_t Alignment = 1;
+  while (Alignment < Size && Alignment < 16)
+    Alignment <<= 1;
+  return Alignment;
+}
+
+TEST_F(CustomGuardedPoolAllocator, AllocationsAreAligned) {
+  InitNumSlots(1);
+  for (size_t Size = 1; Size <= 64; ++Size) {
+    // Allocate several times to see both left and right alignments.
+    for (unsigned i = 0; i < 16; ++i) {
+      void *Ptr = GPA.allocate(Size);
+      ASSERT_NE(nullptr, Ptr);
+      EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(Ptr) % expectedAlignment(Size))
+          << "Size " << Size;
+      GPA.deallocate(Ptr);
+    }
+  }
+}
+
+TEST_F(CustomGuardedPoolAllocator, RightAlignedAllocationsEndBeforeGuard) {
+  InitNumSlots(1);
+  const uintptr_t PageSize = GPA.maximumAllocationSize();
+  for (size_t Size = 1; Size <= 64; ++Size) {
+    for (unsigned i = 0; i < 16; ++i) {
+      uintptr_t Ptr = reinterpret_cast<uintptr_t>(GPA.allocate(Size));
+      ASSERT_NE(0u, Ptr);
+      // Whatever the alignment, the allocation never crosses into the guard
+      // page that follows its slot.
+      uintptr_t SlotStart = Ptr & ~(PageSize - 1);
+      EXPECT_LE(Ptr + Size, SlotStart + PageSize);
+      GPA.deallocate(reinterpret_cast<void *>(Ptr));
+    }
+  }
+}
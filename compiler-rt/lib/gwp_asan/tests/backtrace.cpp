@@ -0,0 +1,52 @@
+//===-- backtrace.cpp -------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+
+#include "gwp_asan/tests/harness.h"
+
+TEST_F(BacktraceGuardedPoolAllocator, DoubleFree) {
+  void *Ptr = GPA.allocate(1);
+  GPA.deallocate(Ptr);
+
+  std::string DeathRegex = "Double free.*";
+  DeathRegex.append("was deallocated.*");
+  DeathRegex.append("was allocated.*");
+  ASSERT_DEATH(GPA.deallocate(Ptr), DeathRegex);
+}
+
+TEST_F(BacktraceGuardedPoolAllocator, InvalidFree) {
+  char *Ptr = reinterpret_cast<char *>(GPA.allocate(1));
+  ASSERT_DEATH(GPA.deallocate(Ptr + 1), "Invalid \\(wild\\) free");
+}
+
+TEST_F(BacktraceGuardedPoolAllocator, UseAfterFree) {
+  char *Ptr = reinterpret_cast<char *>(GPA.allocate(1));
+  GPA.deallocate(Ptr);
+
+  std::string DeathRegex = "Use after free.*";
+  DeathRegex.append("was deallocated.*");
+  DeathRegex.append("was allocated.*");
+  ASSERT_DEATH({ *Ptr = 7; }, DeathRegex);
+}
+
+TEST_F(BacktraceGuardedPoolAllocator, BufferOverflow) {
+  // Force the allocation flush against the trailing guard page by retrying
+  // until it is right-aligned.
+  char *Ptr = nullptr;
+  const uintptr_t PageSize = GPA.maximumAllocationSize();
+  for (unsigned i = 0; i < 64 && !Ptr; ++i) {
+    char *P = reinterpret_cast<char *>(GPA.allocate(16));
+    if ((reinterpret_cast<uintptr_t>(P) & (PageSize - 1)) == PageSize - 16)
+      Ptr = P;
+    else
+      GPA.deallocate(P);
+  }
+  ASSERT_NE(nullptr, Ptr);
+  ASSERT_DEATH({ Ptr[16] = 7; }, "Buffer overflow.*was allocated.*");
+}
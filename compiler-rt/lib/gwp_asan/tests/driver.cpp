@@ -0,0 +1,32 @@
+//===-- driver.cpp ----------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "gwp_asan/tests/harness.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+namespace gwp_asan {
+namespace test {
+namespace {
+void testPrintf(const char *Format, ...) {
+  va_list Args;
+  va_start(Args, Format);
+  vfprintf(stderr, Format, Args);
+  va_end(Args);
+}
+} // anonymous namespace
+
+options::Printf_t getPrintfFunction() { return testPrintf; }
+} // namespace test
+} // namespace gwp_asan
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
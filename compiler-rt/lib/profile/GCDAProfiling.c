@@ -79,14 +79,20 @@ static char *filename = NULL;
 static FILE *output_file = NULL;
 
 /*
- * Buffer that we write things into.
+ * Buffer that we write things into. For an existing file this is a shared
+ * mapping of the file, which the counters are merged into in place; otherwise
+ * it is a heap buffer written out in one go by llvm_gcda_end_file.
  */
 #define WRITE_BUFFER_SIZE (128 * 1024)
 static unsigned char *write_buffer = NULL;
 static uint64_t cur_buffer_size = 0;
 static uint64_t cur_pos = 0;
+/* The size of the previous contents of the file, which the reads are bounded
+ * by. */
 static uint64_t file_size = 0;
 static int new_file = 0;
+/* Whether write_buffer is a mapping of the file. */
+static int mapped = 0;
 #if defined(_WIN32)
 static HANDLE mmap_handle = NULL;
 #endif
@@ -163,13 +169,26 @@ static void fn_list_remove(struct fn_list* list) {
   }
 }
 
+static void unmap_file();
+
 static void resize_write_buffer(uint64_t size) {
-  if (!new_file) return;
   size += cur_pos;
   if (size <= cur_buffer_size) return;
   size = (size - 1) / WRITE_BUFFER_SIZE + 1;
   size *= WRITE_BUFFER_SIZE;
-  write_buffer = realloc(write_buffer, size);
+  if (mapped) {
+    /* The new data outgrows the file. Carry on in a heap copy of the mapping
+     * so that the rest of the old counters can still be merged, and write the
+     * whole buffer out at the end. */
+    unsigned char *buffer = malloc(size);
+    memcpy(buffer, write_buffer, file_size);
+    uint64_t old_size = file_size;
+    unmap_file();
+    file_size = old_size;
+    write_buffer = buffer;
+  } else {
+    write_buffer = realloc(write_buffer, size);
+  }
   cur_buffer_size = size;
 }
 
@@ -206,7 +225,7 @@ static void write_string(const char *s) {
 static uint32_t read_32bit_value() {
   uint32_t val;
 
-  if (new_file)
+  if (new_file || cur_pos + 4 > file_size)
     return (uint32_t)-1;
 
   val = *(uint32_t*)&write_buffer[cur_pos];
@@ -218,7 +237,7 @@ static uint32_t read_le_32bit_value() {
   uint32_t val = 0;
   int i;
 
-  if (new_file)
+  if (new_file || cur_pos + 4 > file_size)
     return (uint32_t)-1;
 
   for (i = 0; i < 4; i++)
@@ -291,6 +310,8 @@ static int map_file() {
   }
 #endif
 
+  mapped = 1;
+  cur_buffer_size = file_size;
   return 0;
 }
 
@@ -313,13 +334,12 @@ static void unmap_file() {
 
   mmap_handle = NULL;
 #else
-  if (msync(write_buffer, file_size, MS_SYNC) == -1) {
-    int errnum = errno;
-    fprintf(stderr, "profiling: %s: cannot msync: %s\n", filename,
-            strerror(errnum));
-  }
-
-  /* We explicitly ignore errors from unmapping because at this point the data
+  /* There is no msync() here: the mapping is shared, so the page cache already
+   * holds the merged counters for the next process that opens the file.
+   * Waiting for them to reach the disk made exit time proportional to the
+   * number of instrumented translation units.
+   *
+   * We explicitly ignore errors from unmapping because at this point the data
    * is written and we don't care.
    */
   (void)munmap(write_buffer, file_size);
@@ -327,6 +347,8 @@ static void unmap_file() {
 
   write_buffer = NULL;
   file_size = 0;
+  cur_buffer_size = 0;
+  mapped = 0;
 }
 
 /*
@@ -377,18 +399,19 @@ void llvm_gcda_start_file(const char *orig_filename, const char version[4],
   write_buffer = NULL;
   cur_buffer_size = 0;
   cur_pos = 0;
+  file_size = 0;
+  mapped = 0;
 
   if (new_file) {
     resize_write_buffer(WRITE_BUFFER_SIZE);
-    memset(write_buffer, 0, WRITE_BUFFER_SIZE);
   } else {
     if (map_file() == -1) {
       /* mmap failed, try to recover by clobbering */
       new_file = 1;
       write_buffer = NULL;
       cur_buffer_size = 0;
+      file_size = 0;
       resize_write_buffer(WRITE_BUFFER_SIZE);
-      memset(write_buffer, 0, WRITE_BUFFER_SIZE);
     }
   }
 
@@ -458,7 +481,7 @@ void llvm_gcda_emit_function(uint32_t ident, const char *function_name,
 COMPILER_RT_VISIBILITY
 void llvm_gcda_emit_arcs(uint32_t num_counters, uint64_t *counters) {
   uint32_t i;
-  uint64_t *old_ctrs = NULL;
+  int merge = 0;
   uint32_t val = 0;
   uint64_t save_cur_pos = cur_pos;
 
@@ -483,9 +506,14 @@ void llvm_gcda_emit_arcs(uint32_t num_counters, uint64_t *counters) {
       return;
     }
 
-    old_ctrs = malloc(sizeof(uint64_t) * num_counters);
-    for (i = 0; i < num_counters; ++i)
-      old_ctrs[i] = read_64bit_value();
+    if (cur_pos + (uint64_t)num_counters * 8 > file_size) {
+      fprintf(stderr, "profiling: %s: cannot merge previous GCDA file: "
+                      "truncated arc counters\n",
+              filename);
+      return;
+    }
+
+    merge = 1;
   }
 
   cur_pos = save_cur_pos;
@@ -494,12 +522,14 @@ void llvm_gcda_emit_arcs(uint32_t num_counters, uint64_t *counters) {
   write_bytes("\0\0\xa1\1", 4);
   write_32bit_value(num_counters * 2);
   for (i = 0; i < num_counters; ++i) {
-    counters[i] += (old_ctrs ? old_ctrs[i] : 0);
+    /* Merge each counter in place: read the old value, then overwrite it. */
+    if (merge) {
+      counters[i] += read_64bit_value();
+      cur_pos -= 8;
+    }
     write_64bit_value(counters[i]);
   }
 
-  free(old_ctrs);
-
 #ifdef DEBUG_GCDAPROFILING
   fprintf(stderr, "llvmgcda:   %u arcs\n", num_counters);
   for (i = 0; i < num_counters; ++i)
@@ -572,7 +602,9 @@ void llvm_gcda_end_file() {
   if (output_file) {
     write_bytes("\0\0\0\0\0\0\0\0", 8);
 
-    if (new_file) {
+    if (!mapped) {
+      /* Rewind in case this is a merge that outgrew the mapping. */
+      fseek(output_file, 0L, SEEK_SET);
       fwrite(write_buffer, cur_pos, 1, output_file);
       free(write_buffer);
     } else {
@@ -51,11 +51,21 @@ COMPILER_RT_VISIBILITY uint64_t __llvm_profile_get_version(void) {
   return __llvm_profile_raw_version;
 }
 
+/* Kept apart from their allocation, so that writing the profile to a buffer
+ * doesn't depend on libc. */
+COMPILER_RT_VISIBILITY CounterShard *lprofCounterShards = NULL;
+COMPILER_RT_VISIBILITY uint64_t *lprofMappedCounters = NULL;
+
 COMPILER_RT_VISIBILITY void __llvm_profile_reset_counters(void) {
   uint64_t *I = __llvm_profile_begin_counters();
   uint64_t *E = __llvm_profile_end_counters();
+  CounterShard *Shard;
 
   memset(I, 0, sizeof(uint64_t) * (E - I));
+  for (Shard = lprofCounterShards; Shard; Shard = Shard->Next)
+    memset(Shard->Counters, 0, sizeof(uint64_t) * (E - I));
+  if (lprofMappedCounters)
+    memset(lprofMappedCounters, 0, sizeof(uint64_t) * (E - I));
 
   const __llvm_profile_data *DataBegin = __llvm_profile_begin_data();
   const __llvm_profile_data *DataEnd = __llvm_profile_end_data();
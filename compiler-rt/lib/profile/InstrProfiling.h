@@ -110,6 +110,17 @@ void __llvm_profile_instrument_target_value(uint64_t TargetValue, void *Data,
                                             uint32_t CounterIndex,
                                             uint64_t CounterValue);
 
+/*!
+ * \brief Allocate the calling thread's copy of the counters.
+ *
+ * Code built with -instrprof-sharded-counters updates the counters at
+ * INSTR_PROF_COUNTER_SHARD_OFFSET_VAR bytes from the counters section, which
+ * this sets on the first call in a thread and returns. The copies are summed
+ * up when the profile is written. Returns 0, so that the thread updates the
+ * counters section itself, if the copy cannot be allocated.
+ */
+uint64_t INSTR_PROF_COUNTER_SHARD_FUNC(void);
+
 /*!
  * \brief Write instrumentation data to the current file.
  *
@@ -118,6 +129,9 @@ void __llvm_profile_instrument_target_value(uint64_t TargetValue, void *Data,
  * or if it hasn't been called, the \c LLVM_PROFILE_FILE environment variable,
  * or if that's not set, the last name set to INSTR_PROF_PROFILE_NAME_VAR,
  * or if that's not set,  \c "default.profraw".
+ *
+ * In continuous mode, the counters are already kept in the file, and this
+ * only waits for the system to write them back to disk.
  */
 int __llvm_profile_write_file(void);
 
@@ -141,6 +155,10 @@ int __llvm_orderfile_write_file(void);
  *  used in profile filename . If merging is  not turned on, user is expected
  *  to invoke __llvm_profile_set_filename  to specify different profile names
  *  for different regions before dumping to avoid profile write clobbering.
+ *
+ *  In continuous mode, this is just a cheap \c __llvm_profile_write_file()
+ *  and can be called any number of times, e.g. to take periodic snapshots of
+ *  a long running process.
  */
 int __llvm_profile_dump(void);
 
@@ -154,6 +172,13 @@ int __llvm_orderfile_dump(void);
  *
  * \c Name is not copied, so it must remain valid.  Passing NULL resets the
  * filename logic to the default behaviour.
+ *
+ * If \c Name contains \c %c, the profile is written right away and then
+ * mapped into memory, so that the counters in the file are kept up to date
+ * while the program runs (continuous mode). This needs code compiled with
+ * \c -mllvm \c -runtime-counter-relocation and is only supported on ELF
+ * targets. Value profile data is only written when the file is mapped. Once
+ * the file is mapped, the profile stays in it.
  */
 void __llvm_profile_set_filename(const char *Name);
 
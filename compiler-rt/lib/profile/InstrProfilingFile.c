@@ -83,11 +83,25 @@ typedef struct lprofFilename {
    * 2 profile data files. %1m is equivalent to %m. Also %m specifier
    * can only appear once at the end of the name pattern. */
   unsigned MergePoolSize;
+  /* Set by the %c specifier, which maps the profile file into memory so that
+   * the counters in it are updated in place. */
+  unsigned ContinuousMode;
   ProfileNameSpecifier PNS;
 } lprofFilename;
 
-COMPILER_RT_WEAK lprofFilename lprofCurFilename = {0,   0, 0, 0, {0},
-                                                   {0}, 0, 0, 0, PNS_unknown};
+COMPILER_RT_WEAK lprofFilename lprofCurFilename = {
+    0, 0, 0, 0, {0}, {0}, 0, 0, 0, 0, PNS_unknown};
+
+#if defined(__ELF__)
+/* Defined by code compiled with -runtime-counter-relocation, which is needed
+ * for continuous mode. */
+COMPILER_RT_VISIBILITY extern int64_t INSTR_PROF_PROFILE_COUNTER_BIAS_VAR
+    COMPILER_RT_WEAK;
+#endif
+
+/* The profile file mapped in continuous mode. */
+static char *MappedProfile = NULL;
+static uint64_t MappedProfileSize = 0;
 
 static int getCurFilenameLength();
 static const char *getCurFilename(char *FilenameBuf, int ForceUseBuf);
@@ -316,6 +330,124 @@ static void truncateCurrentFile(void) {
   fclose(File);
 }
 
+#if defined(__ELF__)
+/* Returns the profile in \p File mapped for reading and writing, or NULL on
+ * failure. If merging is on and the file has a compatible profile, the
+ * in-memory counters are added to the counters in it. Otherwise the profile is
+ * written to the file first. */
+static char *mapProfileForContinuousMode(FILE *File, uint64_t CountersOffset,
+                                         uint64_t *ProfileSize) {
+  const uint64_t *CountersBegin = __llvm_profile_begin_counters();
+  const uint64_t *CountersEnd = __llvm_profile_end_counters();
+  uint64_t NumCounters = CountersEnd - CountersBegin;
+  uint64_t FileSize, I;
+  uint64_t *FileCounters;
+  ProfDataWriter FileWriter;
+  char *Profile;
+
+  if (fseek(File, 0L, SEEK_END) == -1)
+    return NULL;
+  FileSize = ftell(File);
+
+  if (doMerging() && FileSize) {
+    Profile = mmap(NULL, FileSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   fileno(File), 0);
+    if (Profile == MAP_FAILED)
+      return NULL;
+    if (FileSize >= CountersOffset + NumCounters * sizeof(uint64_t) &&
+        !__llvm_profile_check_compatibility(Profile, FileSize)) {
+      FileCounters = (uint64_t *)(Profile + CountersOffset);
+      for (I = 0; I < NumCounters; ++I)
+        FileCounters[I] += CountersBegin[I];
+      *ProfileSize = FileSize;
+      return Profile;
+    }
+    PROF_WARN("Unable to merge profile data: %s\n",
+              "source profile file is not compatible.");
+    (void)munmap(Profile, FileSize);
+  }
+
+  if (COMPILER_RT_FTRUNCATE(File, 0L) || fseek(File, 0L, SEEK_SET) == -1)
+    return NULL;
+  FreeHook = &free;
+  initFileWriter(&FileWriter, File);
+  if (lprofWriteData(&FileWriter, lprofGetVPDataReader(), 0) || fflush(File))
+    return NULL;
+  FileSize = ftell(File);
+
+  Profile = mmap(NULL, FileSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                 fileno(File), 0);
+  if (Profile == MAP_FAILED)
+    return NULL;
+  *ProfileSize = FileSize;
+  return Profile;
+}
+#endif
+
+/* Map the profile file for continuous mode, so that the instrumented code
+ * updates the counters in the file from now on. With online merging, all the
+ * processes using the same file update the same counters. If anything fails,
+ * the profile is written at exit as usual. */
+static void initializeProfileForContinuousMode(void) {
+#if defined(__ELF__)
+  const uint64_t *CountersBegin = __llvm_profile_begin_counters();
+  const uint64_t *CountersEnd = __llvm_profile_end_counters();
+  uint64_t CountersOffset =
+      sizeof(__llvm_profile_header) +
+      __llvm_profile_get_data_size(__llvm_profile_begin_data(),
+                                   __llvm_profile_end_data()) *
+          sizeof(__llvm_profile_data);
+  uint64_t ProfileSize = 0;
+  const char *Filename;
+  char *FilenameBuf, *Profile;
+  FILE *File;
+  int Length;
+
+  if (!&INSTR_PROF_PROFILE_COUNTER_BIAS_VAR) {
+    PROF_WARN("Continuous mode is off: %s.\n",
+              "the code is not compiled with -runtime-counter-relocation");
+    return;
+  }
+  if (CountersBegin == CountersEnd)
+    return;
+
+  Length = getCurFilenameLength();
+  FilenameBuf = (char *)COMPILER_RT_ALLOCA(Length + 1);
+  Filename = getCurFilename(FilenameBuf, 0);
+  if (!Filename)
+    return;
+
+  createProfileDir(Filename);
+  if (doMerging())
+    File = lprofOpenFileEx(Filename);
+  else
+    File = fopen(Filename, "w+b");
+  if (!File) {
+    PROF_ERR("Failed to open \"%s\" for continuous mode: %s\n", Filename,
+             strerror(errno));
+    return;
+  }
+
+  Profile = mapProfileForContinuousMode(File, CountersOffset, &ProfileSize);
+  if (!Profile)
+    PROF_ERR("Failed to map \"%s\" for continuous mode: %s\n", Filename,
+             strerror(errno));
+  /* Closing the file releases the lock, but keeps the mapping. */
+  fclose(File);
+  if (!Profile)
+    return;
+
+  MappedProfile = Profile;
+  MappedProfileSize = ProfileSize;
+  lprofMappedCounters = (uint64_t *)(Profile + CountersOffset);
+  INSTR_PROF_PROFILE_COUNTER_BIAS_VAR =
+      (char *)lprofMappedCounters - (const char *)CountersBegin;
+#else
+  PROF_WARN("Continuous mode is off: %s.\n",
+            "it is only supported on ELF targets");
+#endif
+}
+
 static const char *DefaultProfileName = "default.profraw";
 static void resetFilenameToDefault(void) {
   if (lprofCurFilename.FilenamePat && lprofCurFilename.OwnsFilenamePat) {
@@ -381,6 +513,8 @@ static int parseFilenamePattern(const char *FilenamePat,
                       FilenamePat);
             return -1;
           }
+      } else if (FilenamePat[I] == 'c') {
+        lprofCurFilename.ContinuousMode = 1;
       } else if (containsMergeSpecifier(FilenamePat, I)) {
         if (MergingEnabled) {
           PROF_WARN("%%m specifier can only be specified once in %s.\n",
@@ -412,6 +546,13 @@ static void parseAndSetFilename(const char *FilenamePat,
   if (PNS < OldPNS)
     return;
 
+  if (MappedProfile) {
+    PROF_WARN("Profile path not changed to \"%s\": %s.\n",
+              FilenamePat ? FilenamePat : DefaultProfileName,
+              "the profile is mapped in continuous mode");
+    return;
+  }
+
   if (!FilenamePat)
     FilenamePat = DefaultProfileName;
 
@@ -437,6 +578,8 @@ static void parseAndSetFilename(const char *FilenamePat,
   }
 
   truncateCurrentFile();
+  if (lprofCurFilename.ContinuousMode)
+    initializeProfileForContinuousMode();
 }
 
 /* Return buffer length that is required to store the current profile
@@ -449,7 +592,7 @@ static int getCurFilenameLength() {
     return 0;
 
   if (!(lprofCurFilename.NumPids || lprofCurFilename.NumHosts ||
-        lprofCurFilename.MergePoolSize))
+        lprofCurFilename.MergePoolSize || lprofCurFilename.ContinuousMode))
     return strlen(lprofCurFilename.FilenamePat);
 
   Len = strlen(lprofCurFilename.FilenamePat) +
@@ -473,7 +616,7 @@ static const char *getCurFilename(char *FilenameBuf, int ForceUseBuf) {
     return 0;
 
   if (!(lprofCurFilename.NumPids || lprofCurFilename.NumHosts ||
-        lprofCurFilename.MergePoolSize)) {
+        lprofCurFilename.MergePoolSize || lprofCurFilename.ContinuousMode)) {
     if (!ForceUseBuf)
       return lprofCurFilename.FilenamePat;
 
@@ -632,6 +775,15 @@ int __llvm_profile_write_file(void) {
     return 0;
   }
 
+  /* The counters are already in the file. */
+  if (MappedProfile) {
+    if (msync(MappedProfile, MappedProfileSize, MS_SYNC)) {
+      PROF_ERR("Failed to sync the mapped profile: %s\n", strerror(errno));
+      return -1;
+    }
+    return 0;
+  }
+
   Length = getCurFilenameLength();
   FilenameBuf = (char *)COMPILER_RT_ALLOCA(Length + 1);
   Filename = getCurFilename(FilenameBuf, 0);
@@ -668,6 +820,9 @@ int __llvm_profile_write_file(void) {
 
 COMPILER_RT_VISIBILITY
 int __llvm_profile_dump(void) {
+  /* Nothing is overwritten, so there can be any number of dumps. */
+  if (MappedProfile)
+    return __llvm_profile_write_file();
   if (!doMerging())
     PROF_WARN("Later invocation of __llvm_profile_dump can lead to clobbering "
               " of previously dumped profile data : %s. Either use %%m "
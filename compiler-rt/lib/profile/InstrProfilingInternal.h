@@ -177,6 +177,19 @@ uint64_t lprofGetLoadModuleSignature();
 unsigned lprofProfileDumped();
 void lprofSetProfileDumped();
 
+/* A thread's copy of the counters section, see
+ * INSTR_PROF_COUNTER_SHARD_FUNC. */
+typedef struct CounterShard {
+  struct CounterShard *Next;
+  uint64_t *Counters;
+} CounterShard;
+
+COMPILER_RT_VISIBILITY extern CounterShard *lprofCounterShards;
+
+/* The counters in the mapped profile file, which the instrumented code updates
+ * instead of the counters section in continuous mode. */
+COMPILER_RT_VISIBILITY extern uint64_t *lprofMappedCounters;
+
 COMPILER_RT_VISIBILITY extern void (*FreeHook)(void *);
 COMPILER_RT_VISIBILITY extern uint8_t *DynamicBufferIOBuffer;
 COMPILER_RT_VISIBILITY extern uint32_t VPBufferSize;
@@ -0,0 +1,51 @@
+/*===- InstrProfilingShard.c - Per-thread copies of the profile counters --===*\
+|*
+|* Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+|* See https://llvm.org/LICENSE.txt for license information.
+|* SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+|*
+\*===----------------------------------------------------------------------===*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "InstrProfiling.h"
+#include "InstrProfilingInternal.h"
+
+/* Code built with -instrprof-sharded-counters updates the counters at this
+ * distance in bytes from the counters section, so that threads don't share
+ * the cache lines of hot counters. */
+COMPILER_RT_VISIBILITY COMPILER_RT_THREAD_LOCAL uint64_t
+    INSTR_PROF_COUNTER_SHARD_OFFSET_VAR = 0;
+
+COMPILER_RT_VISIBILITY uint64_t INSTR_PROF_COUNTER_SHARD_FUNC(void) {
+  uint64_t *CountersBegin = __llvm_profile_begin_counters();
+  uint64_t *CountersEnd = __llvm_profile_end_counters();
+  CounterShard *Shard;
+
+  if (INSTR_PROF_COUNTER_SHARD_OFFSET_VAR || CountersBegin == CountersEnd)
+    return INSTR_PROF_COUNTER_SHARD_OFFSET_VAR;
+
+  Shard = (CounterShard *)calloc(1, sizeof(CounterShard) +
+                                        sizeof(uint64_t) *
+                                            (CountersEnd - CountersBegin));
+  if (!Shard) {
+    static int Warned = 0;
+    if (!Warned) {
+      PROF_WARN("%s", "Unable to allocate the counter shard of a thread, its "
+                      "counter updates may be lost.\n");
+      Warned = 1;
+    }
+    return 0;
+  }
+  Shard->Counters = (uint64_t *)(Shard + 1);
+
+  /* Publish the shard, so that it is added up when writing the profile. */
+  do {
+    Shard->Next = lprofCounterShards;
+  } while (!COMPILER_RT_BOOL_CMPXCHG(&lprofCounterShards, Shard->Next, Shard));
+
+  INSTR_PROF_COUNTER_SHARD_OFFSET_VAR =
+      (uint64_t)((uintptr_t)Shard->Counters - (uintptr_t)CountersBegin);
+  return INSTR_PROF_COUNTER_SHARD_OFFSET_VAR;
+}
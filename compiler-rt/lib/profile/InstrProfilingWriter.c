@@ -246,6 +246,37 @@ COMPILER_RT_VISIBILITY int lprofWriteData(ProfDataWriter *Writer,
                             SkipNameDataWrite);
 }
 
+/* Write the counters in [CountersBegin, CountersEnd) with the counter shards
+ * of the threads added up. This goes a chunk at a time, so that it needs no
+ * memory allocation.
+ */
+static int writeReducedCounters(ProfDataWriter *Writer,
+                                const uint64_t *CountersBegin,
+                                const uint64_t *CountersEnd) {
+  uint64_t Chunk[256];
+  const uint64_t ChunkSize = sizeof(Chunk) / sizeof(*Chunk);
+  const uint64_t NumCounters = CountersEnd - CountersBegin;
+  uint64_t Start;
+
+  for (Start = 0; Start < NumCounters; Start += ChunkSize) {
+    const uint64_t N =
+        NumCounters - Start < ChunkSize ? NumCounters - Start : ChunkSize;
+    const CounterShard *Shard;
+    uint64_t I;
+    ProfDataIOVec IOVec[] = {{Chunk, sizeof(uint64_t), 0}};
+
+    for (I = 0; I < N; ++I)
+      Chunk[I] = CountersBegin[Start + I];
+    for (Shard = lprofCounterShards; Shard; Shard = Shard->Next)
+      for (I = 0; I < N; ++I)
+        Chunk[I] += Shard->Counters[Start + I];
+    IOVec[0].NumElm = N;
+    if (Writer->Write(Writer, IOVec, 1))
+      return -1;
+  }
+  return 0;
+}
+
 COMPILER_RT_VISIBILITY int
 lprofWriteDataImpl(ProfDataWriter *Writer, const __llvm_profile_data *DataBegin,
                    const __llvm_profile_data *DataEnd,
@@ -272,6 +303,27 @@ lprofWriteDataImpl(ProfDataWriter *Writer, const __llvm_profile_data *DataBegin,
 #define INSTR_PROF_RAW_HEADER(Type, Name, Init) Header.Name = Init;
 #include "InstrProfData.inc"
 
+  /* The counter shards mirror the counters section of this module. Their
+   * counts are added up to the counters when writing them. */
+  if (lprofCounterShards && CountersBegin == __llvm_profile_begin_counters() &&
+      CountersEnd == __llvm_profile_end_counters()) {
+    ProfDataIOVec HeadIOVec[] = {
+        {&Header, sizeof(__llvm_profile_header), 1},
+        {DataBegin, sizeof(__llvm_profile_data), DataSize}};
+    ProfDataIOVec TailIOVec[] = {
+        {SkipNameDataWrite ? NULL : NamesBegin, sizeof(uint8_t), NamesSize},
+        {Zeroes, sizeof(uint8_t), Padding}};
+    if (Writer->Write(Writer, HeadIOVec,
+                      sizeof(HeadIOVec) / sizeof(*HeadIOVec)))
+      return -1;
+    if (writeReducedCounters(Writer, CountersBegin, CountersEnd))
+      return -1;
+    if (Writer->Write(Writer, TailIOVec,
+                      sizeof(TailIOVec) / sizeof(*TailIOVec)))
+      return -1;
+    return writeValueProfData(Writer, VPDataReader, DataBegin, DataEnd);
+  }
+
   /* Write the data. */
   ProfDataIOVec IOVec[] = {
       {&Header, sizeof(__llvm_profile_header), 1},
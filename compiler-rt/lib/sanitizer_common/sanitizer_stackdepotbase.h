@@ -13,6 +13,7 @@
 #ifndef SANITIZER_STACKDEPOTBASE_H
 #define SANITIZER_STACKDEPOTBASE_H
 
+#include "sanitizer_common.h"
 #include "sanitizer_internal_defs.h"
 #include "sanitizer_mutex.h"
 #include "sanitizer_atomic.h"
@@ -39,6 +40,7 @@ class StackDepotBase {
   static Node *find(Node *s, args_type args, u32 hash);
   static Node *lock(atomic_uintptr_t *p);
   static void unlock(atomic_uintptr_t *p, Node *s);
+  atomic_uintptr_t *id_map_slot(u32 id, bool create);
 
   static const int kTabSize = 1 << kTabSizeLog;  // Hash table size.
   static const int kPartBits = 8;
@@ -48,8 +50,15 @@ class StackDepotBase {
   static const int kPartSize = kTabSize / kPartCount;
   static const int kMaxId = 1 << kPartShift;
 
+  // Ids are dense within each part, so we map them back to their nodes with a
+  // two-level table whose chunks are only allocated when first used.
+  static const int kIdChunkLog = 12;
+  static const uptr kIdChunkSize = 1 << kIdChunkLog;
+  static const uptr kIdMapSize = 1ULL << (32 - kReservedBits - kIdChunkLog);
+
   atomic_uintptr_t tab[kTabSize];   // Hash table of Node's.
   atomic_uint32_t seq[kPartCount];  // Unique id generators.
+  atomic_uintptr_t id_map[kIdMapSize];  // Chunks of Node's, indexed by id.
 
   StackDepotStats stats;
 
@@ -92,6 +101,27 @@ void StackDepotBase<Node, kReservedBits, kTabSizeLog>::unlock(
   atomic_store(p, (uptr)s, memory_order_release);
 }
 
+template <class Node, int kReservedBits, int kTabSizeLog>
+atomic_uintptr_t *
+StackDepotBase<Node, kReservedBits, kTabSizeLog>::id_map_slot(u32 id,
+                                                              bool create) {
+  atomic_uintptr_t *chunk_p = &id_map[id >> kIdChunkLog];
+  uptr chunk = atomic_load(chunk_p, memory_order_acquire);
+  if (!chunk) {
+    if (!create) return nullptr;
+    // Several parts never share a chunk, but several buckets in one part may
+    // race to create it.
+    uptr size = kIdChunkSize * sizeof(atomic_uintptr_t);
+    uptr new_chunk = (uptr)MmapOrDie(size, "StackDepot id map");
+    if (atomic_compare_exchange_strong(chunk_p, &chunk, new_chunk,
+                                       memory_order_acq_rel))
+      chunk = new_chunk;
+    else
+      UnmapOrDie((void *)new_chunk, size);
+  }
+  return &((atomic_uintptr_t *)chunk)[id & (kIdChunkSize - 1)];
+}
+
 template <class Node, int kReservedBits, int kTabSizeLog>
 typename StackDepotBase<Node, kReservedBits, kTabSizeLog>::handle_type
 StackDepotBase<Node, kReservedBits, kTabSizeLog>::Put(args_type args,
@@ -127,6 +157,8 @@ StackDepotBase<Node, kReservedBits, kTabSizeLog>::Put(args_type args,
   s->id = id;
   s->store(args, h);
   s->link = s2;
+  // Publish the node by id before anyone can find it through the table.
+  atomic_store(id_map_slot(id, true), (uptr)s, memory_order_release);
   unlock(p, s);
   if (inserted) *inserted = true;
   return s->get_handle();
@@ -139,21 +171,11 @@ StackDepotBase<Node, kReservedBits, kTabSizeLog>::Get(u32 id) {
     return args_type();
   }
   CHECK_EQ(id & (((u32)-1) >> kReservedBits), id);
-  // High kPartBits contain part id, so we need to scan at most kPartSize lists.
-  uptr part = id >> kPartShift;
-  for (int i = 0; i != kPartSize; i++) {
-    uptr idx = part * kPartSize + i;
-    CHECK_LT(idx, kTabSize);
-    atomic_uintptr_t *p = &tab[idx];
-    uptr v = atomic_load(p, memory_order_consume);
-    Node *s = (Node *)(v & ~1);
-    for (; s; s = s->link) {
-      if (s->id == id) {
-        return s->load();
-      }
-    }
-  }
-  return args_type();
+  atomic_uintptr_t *slot = id_map_slot(id, false);
+  if (!slot) return args_type();
+  Node *s = (Node *)atomic_load(slot, memory_order_acquire);
+  if (!s) return args_type();
+  return s->load();
 }
 
 template <class Node, int kReservedBits, int kTabSizeLog>
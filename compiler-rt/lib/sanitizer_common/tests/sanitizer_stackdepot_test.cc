@@ -64,6 +64,24 @@ TEST(SanitizerCommon, StackDepotSeveral) {
   EXPECT_NE(i1, i2);
 }
 
+TEST(SanitizerCommon, StackDepotMany) {
+  // Enough stacks to fill several id map chunks in some parts.
+  const uptr kNumStacks = 1 << 16;
+  InternalMmapVector<u32> ids(kNumStacks);
+  for (uptr i = 0; i < kNumStacks; i++) {
+    uptr array[] = {0x1000, 0x2000 + i, 0x3000};
+    ids[i] = StackDepotPut(StackTrace(array, ARRAY_SIZE(array)));
+    EXPECT_NE(ids[i], 0U);
+  }
+  for (uptr i = 0; i < kNumStacks; i++) {
+    StackTrace stack = StackDepotGet(ids[i]);
+    ASSERT_EQ(stack.size, 3U);
+    EXPECT_EQ(stack.trace[0], 0x1000U);
+    EXPECT_EQ(stack.trace[1], 0x2000U + i);
+    EXPECT_EQ(stack.trace[2], 0x3000U);
+  }
+}
+
 TEST(SanitizerCommon, StackDepotReverseMap) {
   uptr array1[] = {1, 2, 3, 4, 5};
   uptr array2[] = {7, 1, 3, 0};
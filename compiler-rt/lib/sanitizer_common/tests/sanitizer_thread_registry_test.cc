@@ -223,6 +223,27 @@ static void ThreadedTestRegistry(ThreadRegistry *registry) {
   }
 }
 
+TEST(SanitizerCommon, ThreadRegistryReusesLowestTid) {
+  ThreadRegistry registry(GetThreadContext<ThreadContextBase>,
+                          kMaxRegistryThreads, 0);
+  for (u32 i = 0; i < 10; i++) {
+    EXPECT_EQ(i, registry.CreateThread(get_uid(i), true, 0, 0));
+    registry.StartThread(i, 0, ThreadType::Regular, 0);
+  }
+  // Retire the threads out of tid order.
+  const u32 kFinished[] = {7, 3, 9, 5};
+  for (u32 tid : kFinished)
+    registry.FinishThread(tid);
+  // New threads get the freed tids back in increasing order, and only then
+  // fresh ones.
+  EXPECT_EQ(3U, registry.CreateThread(get_uid(3), true, 0, 0));
+  EXPECT_EQ(5U, registry.CreateThread(get_uid(5), true, 0, 0));
+  EXPECT_EQ(7U, registry.CreateThread(get_uid(7), true, 0, 0));
+  EXPECT_EQ(9U, registry.CreateThread(get_uid(9), true, 0, 0));
+  EXPECT_EQ(10U, registry.CreateThread(get_uid(10), true, 0, 0));
+  CheckThreadQuantity(&registry, 11, 6, 11);
+}
+
 TEST(SanitizerCommon, ThreadRegistryThreadedTest) {
   memset(&num_created, 0, sizeof(num_created));
   memset(&num_started, 0, sizeof(num_created));
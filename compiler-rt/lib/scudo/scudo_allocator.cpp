@@ -25,6 +25,12 @@
 #include "sanitizer_common/sanitizer_allocator_interface.h"
 #include "sanitizer_common/sanitizer_quarantine.h"
 
+#ifdef GWP_ASAN_HOOKS
+# include "gwp_asan/guarded_pool_allocator.h"
+# include "gwp_asan/optional/backtrace.h"
+# include "gwp_asan/optional/options_parser.h"
+#endif // GWP_ASAN_HOOKS
+
 #include <errno.h>
 #include <string.h>
 
@@ -33,6 +39,12 @@ namespace __scudo {
 // Global static cookie, initialized at start-up.
 static u32 Cookie;
 
+#ifdef GWP_ASAN_HOOKS
+// The sampling guarded allocator. It is constant-initialized so that it never
+// samples nor claims a pointer until init() sets it up.
+static gwp_asan::GuardedPoolAllocator GuardedAlloc;
+#endif // GWP_ASAN_HOOKS
+
 // We default to software CRC32 if the alternatives are not supported, either
 // at compilation or at runtime.
 static atomic_uint8_t HashAlgorithm = { CRC32Software };
@@ -273,6 +285,14 @@ struct Allocator {
     CheckRssLimit = HardRssLimitMb || SoftRssLimitMb;
     if (CheckRssLimit)
       atomic_store_relaxed(&RssLastCheckedAtNS, MonotonicNanoTime());
+
+#ifdef GWP_ASAN_HOOKS
+    gwp_asan::options::initOptions();
+    gwp_asan::options::Options &Opts = gwp_asan::options::getOptions();
+    Opts.Backtrace = gwp_asan::options::getBacktraceFunction();
+    Opts.PrintBacktrace = gwp_asan::options::getPrintBacktraceFunction();
+    GuardedAlloc.init(Opts);
+#endif // GWP_ASAN_HOOKS
   }
 
   // Helper function that checks for a valid Scudo chunk. nullptr isn't.
@@ -280,6 +300,10 @@ struct Allocator {
     initThreadMaybe();
     if (UNLIKELY(!Ptr))
       return false;
+#ifdef GWP_ASAN_HOOKS
+    if (UNLIKELY(GuardedAlloc.pointerIsMine(Ptr)))
+      return true;
+#endif // GWP_ASAN_HOOKS
     if (!Chunk::isAligned(Ptr))
       return false;
     return Chunk::isValid(Ptr);
@@ -299,6 +323,18 @@ struct Allocator {
     if (UNLIKELY(Alignment < MinAlignment))
       Alignment = MinAlignment;
 
+#ifdef GWP_ASAN_HOOKS
+    // Guarded allocations are either page aligned or right-aligned to at most
+    // MinAlignment, so only sample the requests that do not need more.
+    if (UNLIKELY(GuardedAlloc.shouldSample()) && Alignment <= MinAlignment) {
+      if (void *Ptr = GuardedAlloc.allocate(Size)) {
+        if (SCUDO_CAN_USE_HOOKS && &__sanitizer_malloc_hook)
+          __sanitizer_malloc_hook(Ptr, Size);
+        return Ptr;
+      }
+    }
+#endif // GWP_ASAN_HOOKS
+
     const uptr NeededSize = RoundUpTo(Size ? Size : 1, MinAlignment) +
         Chunk::getHeaderSize();
     const uptr AlignedSize = (Alignment > MinAlignment) ?
@@ -434,6 +470,14 @@ struct Allocator {
       __sanitizer_free_hook(Ptr);
     if (UNLIKELY(!Ptr))
       return;
+
+#ifdef GWP_ASAN_HOOKS
+    if (UNLIKELY(GuardedAlloc.pointerIsMine(Ptr))) {
+      GuardedAlloc.deallocate(Ptr);
+      return;
+    }
+#endif // GWP_ASAN_HOOKS
+
     if (UNLIKELY(!Chunk::isAligned(Ptr)))
       dieWithMessage("misaligned pointer when deallocating address %p\n", Ptr);
     UnpackedHeader Header;
@@ -463,6 +507,19 @@ struct Allocator {
   // size still fits in the chunk.
   void *reallocate(void *OldPtr, uptr NewSize) {
     initThreadMaybe();
+
+#ifdef GWP_ASAN_HOOKS
+    if (UNLIKELY(GuardedAlloc.pointerIsMine(OldPtr))) {
+      const uptr OldSize = GuardedAlloc.getSize(OldPtr);
+      void *NewPtr = allocate(NewSize, MinAlignment, FromMalloc);
+      if (NewPtr) {
+        memcpy(NewPtr, OldPtr, Min(NewSize, OldSize));
+        GuardedAlloc.deallocate(OldPtr);
+      }
+      return NewPtr;
+    }
+#endif // GWP_ASAN_HOOKS
+
     if (UNLIKELY(!Chunk::isAligned(OldPtr)))
       dieWithMessage("misaligned address when reallocating address %p\n",
                      OldPtr);
@@ -504,6 +561,12 @@ struct Allocator {
     initThreadMaybe();
     if (UNLIKELY(!Ptr))
       return 0;
+
+#ifdef GWP_ASAN_HOOKS
+    if (UNLIKELY(GuardedAlloc.pointerIsMine(Ptr)))
+      return GuardedAlloc.getSize(Ptr);
+#endif // GWP_ASAN_HOOKS
+
     UnpackedHeader Header;
     Chunk::loadHeader(Ptr, &Header);
     // Getting the usable size of a chunk only makes sense if it's allocated.
@@ -36,6 +36,7 @@ void *MapAllocator::allocate(uptr Size, uptr AlignmentHint, uptr *BlockEnd) {
     return nullptr;
   uptr CommitBase = MapBase + PageSize;
   uptr MapEnd = MapBase + MapSize;
+  uptr CommitEnd = MapEnd - PageSize;
 
   // In the unlikely event of alignments larger than a page, adjust the amount
   // of memory we want to commit, and trim the extra memory.
@@ -60,9 +61,14 @@ void *MapAllocator::allocate(uptr Size, uptr AlignmentHint, uptr *BlockEnd) {
       unmap(reinterpret_cast<void *>(NewMapEnd), MapEnd - NewMapEnd, 0, &Data);
       MapEnd = NewMapEnd;
     }
+    // Regardless of the trimming, only commit up to the trailing guard page
+    // that would follow the trimmed mapping. This keeps the distance between
+    // the end of the user chunk and the end of the block under a page, which
+    // the combined allocator relies on to store it in the chunk header.
+    CommitEnd = NewMapEnd - PageSize;
   }
 
-  const uptr CommitSize = MapEnd - PageSize - CommitBase;
+  const uptr CommitSize = CommitEnd - CommitBase;
   const uptr Ptr =
       reinterpret_cast<uptr>(map(reinterpret_cast<void *>(CommitBase),
                                  CommitSize, "scudo:secondary", 0, &Data));
@@ -66,6 +66,12 @@ struct XRAY_TLS_ALIGNAS(64) ThreadLocalData {
                                     alignof(FDRController<>)>::type;
   ControllerStorage CStorage;
   FDRController<> *Controller = nullptr;
+
+  // When sampling, the number of function entries left before the next one is
+  // recorded, and the call depth within the sampled function being recorded
+  // (zero when no sampled function is active).
+  uint32_t SampleCountdown = 0;
+  uint32_t SampledDepth = 0;
 };
 
 } // namespace
@@ -86,6 +92,9 @@ static atomic_uint64_t ThresholdTicks{0};
 // Global for ticks per second.
 static atomic_uint64_t TicksPerSec{0};
 
+// Global sampling rate for function entries; 1 records all of them.
+static atomic_uint32_t SamplingRate{1};
+
 static atomic_sint32_t LogFlushStatus = {
     XRayLogFlushStatus::XRAY_LOG_NOT_FLUSHING};
 
@@ -492,6 +501,43 @@ static bool setupTLD(ThreadLocalData &TLD) XRAY_NEVER_INSTRUMENT {
   return true;
 }
 
+// Returns true when the function event should be left out of the trace. With a
+// sampling rate of N, one in N function entries outside of a sampled function
+// is recorded, together with everything up to its matching exit. Skipping both
+// the entry and exit of unsampled functions keeps the trace well formed, so
+// that the tools reconstruct sampled call trees as they would full ones.
+static bool skipUnsampled(ThreadLocalData &TLD,
+                          XRayEntryType Entry) XRAY_NEVER_INSTRUMENT {
+  auto Rate = atomic_load_relaxed(&SamplingRate);
+  if (LIKELY(Rate <= 1))
+    return false;
+
+  switch (Entry) {
+  case XRayEntryType::ENTRY:
+  case XRayEntryType::LOG_ARGS_ENTRY:
+    if (TLD.SampledDepth > 0) {
+      ++TLD.SampledDepth;
+      return false;
+    }
+    if (TLD.SampleCountdown == 0 || TLD.SampleCountdown > Rate)
+      TLD.SampleCountdown = Rate;
+    if (--TLD.SampleCountdown > 0)
+      return true;
+    TLD.SampledDepth = 1;
+    return false;
+  case XRayEntryType::EXIT:
+  case XRayEntryType::TAIL:
+    if (TLD.SampledDepth == 0)
+      return true;
+    --TLD.SampledDepth;
+    return false;
+  case XRayEntryType::CUSTOM_EVENT:
+  case XRayEntryType::TYPED_EVENT:
+    break;
+  }
+  return false;
+}
+
 void fdrLoggingHandleArg0(int32_t FuncId,
                           XRayEntryType Entry) XRAY_NEVER_INSTRUMENT {
   auto TC = getTimestamp();
@@ -502,6 +548,8 @@ void fdrLoggingHandleArg0(int32_t FuncId,
     return;
 
   auto &TLD = getThreadLocalData();
+  if (skipUnsampled(TLD, Entry))
+    return;
   if (!setupTLD(TLD))
     return;
 
@@ -532,6 +580,8 @@ void fdrLoggingHandleArg1(int32_t FuncId, XRayEntryType Entry,
     return;
 
   auto &TLD = getThreadLocalData();
+  if (skipUnsampled(TLD, Entry))
+    return;
   if (!setupTLD(TLD))
     return;
 
@@ -705,6 +755,9 @@ XRayLogInitStatus fdrLoggingInit(size_t, size_t, void *Options,
                atomic_load_relaxed(&TicksPerSec) *
                    fdrFlags()->func_duration_threshold_us / 1000000,
                memory_order_release);
+  atomic_store(&SamplingRate,
+               fdrFlags()->sampling_rate > 1 ? fdrFlags()->sampling_rate : 1,
+               memory_order_release);
   // Arg1 handler should go in first to avoid concurrent code accidentally
   // falling back to arg0 when it should have ran arg1.
   __xray_set_handler_arg1(fdrLoggingHandleArg1);
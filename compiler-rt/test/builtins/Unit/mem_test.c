@@ -0,0 +1,100 @@
+// REQUIRES: mem-builtins
+// RUN: %clang_builtins %s %libmem %librt -o %t && %run %t
+//===-- mem_test.c - Test the clang_rt.mem routines -----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file tests memcpy, memmove, memset and bcmp from clang_rt.mem against
+// byte loops, for every size class and for misaligned and overlapping
+// buffers.
+//
+//===----------------------------------------------------------------------===//
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+extern int bcmp(const void *, const void *, size_t);
+
+#define BUF_SIZE 4096
+
+static unsigned char buf[BUF_SIZE], ref[BUF_SIZE];
+
+static void fill(void) {
+  for (int i = 0; i < BUF_SIZE; ++i)
+    buf[i] = ref[i] = (unsigned char)(i * 7 + 3);
+}
+
+static void ref_move(unsigned char *d, const unsigned char *s, size_t n) {
+  if (d < s)
+    for (size_t i = 0; i < n; ++i)
+      d[i] = s[i];
+  else
+    for (size_t i = n; i; --i)
+      d[i - 1] = s[i - 1];
+}
+
+static int same(void) {
+  for (int i = 0; i < BUF_SIZE; ++i)
+    if (buf[i] != ref[i])
+      return 0;
+  return 1;
+}
+
+static int test(size_t n, size_t a, size_t b) {
+  fill();
+  if (memcpy(buf + 2048 + a, buf + b, n) != buf + 2048 + a)
+    return 1;
+  ref_move(ref + 2048 + a, ref + b, n);
+  if (!same()) {
+    printf("error in memcpy(+%zu, +%zu, %zu)\n", a, b, n);
+    return 1;
+  }
+
+  fill();
+  memmove(buf + 512 + a, buf + 512 + b, n);
+  ref_move(ref + 512 + a, ref + 512 + b, n);
+  if (!same()) {
+    printf("error in memmove(+%zu, +%zu, %zu)\n", a, b, n);
+    return 1;
+  }
+
+  fill();
+  memset(buf + a, (int)(0x100 + b), n);
+  for (size_t i = 0; i < n; ++i)
+    ref[a + i] = (unsigned char)b;
+  if (!same()) {
+    printf("error in memset(+%zu, %zu, %zu)\n", a, b, n);
+    return 1;
+  }
+
+  fill();
+  ref_move(buf + 2048 + a, buf + b, n);
+  if (bcmp(buf + 2048 + a, buf + b, n)) {
+    printf("error in bcmp(+%zu, +%zu, %zu) of equal buffers\n", a, b, n);
+    return 1;
+  }
+  for (size_t i = 0; i < n; i += n / 4 + 1) {
+    buf[2048 + a + i] ^= 0x80;
+    int r = bcmp(buf + 2048 + a, buf + b, n);
+    buf[2048 + a + i] ^= 0x80;
+    if (!r) {
+      printf("error in bcmp(+%zu, +%zu, %zu) differing at %zu\n", a, b, n, i);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int main() {
+  for (size_t n = 0; n <= 1100; n += n < 300 ? 1 : 13)
+    for (size_t a = 0; a < 64; a += 5)
+      for (size_t b = 0; b < 64; b += 9)
+        if (test(n, a, b))
+          return 1;
+  return 0;
+}
@@ -0,0 +1,32 @@
+// RUN: %clang_profgen -o %t -O2 -mllvm -runtime-counter-relocation %s
+// RUN: rm -rf %t.dir && mkdir -p %t.dir
+// RUN: env LLVM_PROFILE_FILE=%t.dir/once-%c.profraw %run %t
+// RUN: llvm-profdata show --function=work --counts %t.dir/once-.profraw | FileCheck %s --check-prefix=ONCE
+// RUN: env LLVM_PROFILE_FILE=%t.dir/merged-%m%c.profraw %run %t
+// RUN: env LLVM_PROFILE_FILE=%t.dir/merged-%m%c.profraw %run %t
+// RUN: llvm-profdata show --function=work --counts %t.dir/merged-*.profraw | FileCheck %s --check-prefix=TWICE
+
+// In continuous mode, the counters are updated in the mapped profile file, so
+// the profile is complete even though the program exits without writing it.
+
+#include <unistd.h>
+
+volatile int Sink;
+
+__attribute__((noinline)) void work(int I) {
+  if (I % 2)
+    Sink += I;
+}
+
+int main() {
+  int I;
+  for (I = 0; I < 100; ++I)
+    work(I);
+  _exit(0);
+}
+
+// ONCE: Function count: 100
+// ONCE: Block counts: [50]
+
+// TWICE: Function count: 200
+// TWICE: Block counts: [100]
@@ -0,0 +1,45 @@
+// RUN: %clang_profgen -o %t -O2 -mllvm -instrprof-sharded-counters %s -pthread
+// RUN: env LLVM_PROFILE_FILE=%t.profraw %run %t
+// RUN: llvm-profdata show --function=work --counts %t.profraw | FileCheck %s --check-prefix=WORK
+// RUN: llvm-profdata show --function=run --counts %t.profraw | FileCheck %s --check-prefix=LOOP
+
+// Threads update their own copies of the counters, none of the updates is
+// lost.
+// UNSUPPORTED: windows
+
+#include <pthread.h>
+
+#define NUM_THREADS 8
+#define NUM_CALLS 100000
+
+volatile int Sink;
+
+__attribute__((noinline)) void work(int I) {
+  if (I % 2)
+    Sink += I;
+}
+
+void *run(void *Arg) {
+  int I;
+  for (I = 0; I < NUM_CALLS; ++I)
+    work(I);
+  return 0;
+}
+
+int main(void) {
+  pthread_t Threads[NUM_THREADS];
+  int I;
+  for (I = 0; I < NUM_THREADS; ++I)
+    pthread_create(&Threads[I], 0, run, 0);
+  for (I = 0; I < NUM_THREADS; ++I)
+    pthread_join(Threads[I], 0);
+  return 0;
+}
+
+// WORK-LABEL: work:
+// WORK:         Function count: 800000
+// WORK-NEXT:    Block counts: [400000]
+
+// LOOP-LABEL: run:
+// LOOP:         Function count: 8
+// LOOP-NEXT:    Block counts: [800000]
@@ -0,0 +1,56 @@
+// Check that FDR mode with sampling_rate=N records one in N function entries,
+// together with the calls made under a sampled function, and leaves unsampled
+// functions out of the trace entirely.
+//
+// RUN: %clangxx_xray -g -std=c++11 %s -o %t
+// RUN: rm -f fdr-sampling-logging-*
+// RUN: XRAY_OPTIONS="patch_premain=false verbosity=1 \
+// RUN:     xray_logfile_base=fdr-sampling-logging-" \
+// RUN: XRAY_FDR_OPTIONS="func_duration_threshold_us=0 sampling_rate=3" \
+// RUN:     %run %t 2>&1
+// RUN: %llvm_xray convert --output-format=yaml --symbolize --instr_map=%t \
+// RUN:     "`ls fdr-sampling-logging-* | head -n1`" | FileCheck %s
+// RUN: rm fdr-sampling-logging-*
+//
+// REQUIRES: x86_64-target-arch
+
+#include "xray/xray_log_interface.h"
+#include <cassert>
+
+[[clang::xray_always_instrument]] void __attribute__((noinline)) leaf() {}
+
+[[clang::xray_always_instrument]] void __attribute__((noinline)) outer() {
+  leaf();
+}
+
+int main(int argc, char *argv[]) {
+  auto status = __xray_log_init_mode("xray-fdr", "");
+  assert(status == XRayLogInitStatus::XRAY_LOG_INITIALIZED);
+
+  __xray_patch();
+  // Sampling decisions are taken on entries outside of a sampled function:
+  // outer() and leaf() of the first call are the first two, so the outer() of
+  // the second call is the third and gets recorded with its leaf(). The
+  // pattern repeats, recording the whole of every second call.
+  for (int i = 0; i < 6; ++i)
+    outer();
+  __xray_unpatch();
+  assert(__xray_log_finalize() == XRAY_LOG_FINALIZED);
+  assert(__xray_log_flushLog() == XRAY_LOG_FLUSHED);
+  return 0;
+}
+
+// CHECK:      records:
+// CHECK-NEXT: - { type: 0, func-id: [[OUTER:[0-9]+]], function: {{.*outer.*}}, {{.*}}kind: function-enter,
+// CHECK-NEXT: - { type: 0, func-id: [[LEAF:[0-9]+]], function: {{.*leaf.*}}, {{.*}}kind: function-enter,
+// CHECK-NEXT: - { type: 0, func-id: [[LEAF]], function: {{.*leaf.*}}, {{.*}}kind: function-exit,
+// CHECK-NEXT: - { type: 0, func-id: [[OUTER]], function: {{.*outer.*}}, {{.*}}kind: function-exit,
+// CHECK-NEXT: - { type: 0, func-id: [[OUTER]], function: {{.*outer.*}}, {{.*}}kind: function-enter,
+// CHECK-NEXT: - { type: 0, func-id: [[LEAF]], function: {{.*leaf.*}}, {{.*}}kind: function-enter,
+// CHECK-NEXT: - { type: 0, func-id: [[LEAF]], function: {{.*leaf.*}}, {{.*}}kind: function-exit,
+// CHECK-NEXT: - { type: 0, func-id: [[OUTER]], function: {{.*outer.*}}, {{.*}}kind: function-exit,
+// CHECK-NEXT: - { type: 0, func-id: [[OUTER]], function: {{.*outer.*}}, {{.*}}kind: function-enter,
+// CHECK-NEXT: - { type: 0, func-id: [[LEAF]], function: {{.*leaf.*}}, {{.*}}kind: function-enter,
+// CHECK-NEXT: - { type: 0, func-id: [[LEAF]], function: {{.*leaf.*}}, {{.*}}kind: function-exit,
+// CHECK-NEXT: - { type: 0, func-id: [[OUTER]], function: {{.*outer.*}}, {{.*}}kind: function-exit,
+// CHECK-NOT:  function-enter
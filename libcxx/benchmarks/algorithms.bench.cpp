@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <map>
+#include <numeric>
 #include <random>
 #include <string>
 #include <utility>
@@ -29,14 +30,47 @@ enum class Order {
   Descending,
   SingleElement,
   PipeOrgan,
-  Heap
+  Heap,
+  QuickSortAdversary
 };
-struct AllOrders : EnumValuesAsTuple<AllOrders, Order, 6> {
+struct AllOrders : EnumValuesAsTuple<AllOrders, Order, 7> {
   static constexpr const char* Names[] = {"Random",     "Ascending",
                                           "Descending", "SingleElement",
-                                          "PipeOrgan",  "Heap"};
+                                          "PipeOrgan",  "Heap",
+                                          "QuickSortAdversary"};
 };
 
+// Returns the ranks of an input that makes std::sort do as much work as it
+// can, using McIlroy's "A Killer Adversary for Quicksort": the comparator
+// decides the values of the elements only as the sort looks at them.
+std::vector<size_t> getQuickSortAdversaryRanks(size_t N) {
+  // Elements still equal to Gas have no value yet.
+  const size_t Gas = N;
+  std::vector<size_t> Ranks(N, Gas);
+  std::vector<size_t> Indices(N);
+  std::iota(Indices.begin(), Indices.end(), 0);
+  size_t Candidate = 0;
+  size_t NumSolid = 0;
+  std::sort(Indices.begin(), Indices.end(), [&](size_t X, size_t Y) {
+    if (Ranks[X] == Gas && Ranks[Y] == Gas) {
+      if (X == Candidate)
+        Ranks[X] = NumSolid++;
+      else
+        Ranks[Y] = NumSolid++;
+    }
+    if (Ranks[X] == Gas)
+      Candidate = X;
+    else if (Ranks[Y] == Gas)
+      Candidate = Y;
+    return Ranks[X] < Ranks[Y];
+  });
+  // Elements the sort never compared can take any of the remaining ranks.
+  for (size_t& R : Ranks)
+    if (R == Gas)
+      R = NumSolid++;
+  return Ranks;
+}
+
 void fillValues(std::vector<uint32_t>& V, size_t N, Order O) {
   if (O == Order::SingleElement) {
     V.resize(N, 0);
@@ -82,6 +116,13 @@ void sortValues(T& V, Order O) {
   case Order::Heap:
     std::make_heap(V.begin(), V.end());
     break;
+  case Order::QuickSortAdversary: {
+    const T Sorted = V;
+    const std::vector<size_t> Ranks = getQuickSortAdversaryRanks(V.size());
+    for (size_t I = 0; I < V.size(); ++I)
+      V[I] = Sorted[Ranks[I]];
+    break;
+  }
   }
 }
 
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+// Searches for a value that is only at the end of the range.
+template <class T>
+static void BM_FindLast(benchmark::State& state) {
+  std::vector<T> V(state.range(0), T(1));
+  V.back() = T(2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(V.data());
+    benchmark::DoNotOptimize(std::find(V.begin(), V.end(), T(2)));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(T));
+}
+BENCHMARK_TEMPLATE(BM_FindLast, char)->Range(8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_FindLast, uint16_t)->Range(8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_FindLast, int)->Range(8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_FindLast, int64_t)->Range(8, 1 << 16);
+
+// Counts a value that is every third element.
+template <class T>
+static void BM_Count(benchmark::State& state) {
+  std::vector<T> V(state.range(0));
+  for (std::size_t I = 0; I < V.size(); ++I)
+    V[I] = T(I % 3);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(V.data());
+    benchmark::DoNotOptimize(std::count(V.begin(), V.end(), T(0)));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(T));
+}
+BENCHMARK_TEMPLATE(BM_Count, char)->Range(8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_Count, int)->Range(8, 1 << 16);
+
+// Compares two ranges that differ in their last element.
+template <class T>
+static void BM_MismatchLast(benchmark::State& state) {
+  std::vector<T> V1(state.range(0), T(1)), V2 = V1;
+  V2.back() = T(2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(V1.data());
+    benchmark::DoNotOptimize(std::mismatch(V1.begin(), V1.end(), V2.begin()));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(T));
+}
+BENCHMARK_TEMPLATE(BM_MismatchLast, char)->Range(8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_MismatchLast, int)->Range(8, 1 << 16);
+
+// char_traits<char16_t> has no library routine to fall back to.
+static void BM_U16StringFindChar(benchmark::State& state) {
+  std::u16string S(state.range(0), u'a');
+  S.back() = u'b';
+  for (auto _ : state)
+    benchmark::DoNotOptimize(S.find(u'b'));
+  state.SetBytesProcessed(state.iterations() * state.range(0) * 2);
+}
+BENCHMARK(BM_U16StringFindChar)->Range(8, 1 << 16);
+
+static void BM_U16StringCompare(benchmark::State& state) {
+  std::u16string S1(state.range(0), u'a'), S2 = S1;
+  S2.back() = u'b';
+  for (auto _ : state)
+    benchmark::DoNotOptimize(S1.compare(S2));
+  state.SetBytesProcessed(state.iterations() * state.range(0) * 2);
+}
+BENCHMARK(BM_U16StringCompare)->Range(8, 1 << 16);
+
+BENCHMARK_MAIN();
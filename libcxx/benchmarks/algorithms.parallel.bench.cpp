@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cstdint>
+#include <execution>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "CartesianBenchmarks.hpp"
+#include "GenerateInput.hpp"
+#include "benchmark/benchmark.h"
+#include "test_macros.h"
+
+namespace {
+
+enum class Policy { Seq, Par };
+struct AllPolicies : EnumValuesAsTuple<AllPolicies, Policy, 2> {
+  static constexpr const char* Names[] = {"Seq", "Par"};
+};
+
+// Calls F with the execution policy selected by P.
+template <class P, class F>
+void withPolicy(F f) {
+  if constexpr (P() == Policy::Seq)
+    f(std::execution::seq);
+  else
+    f(std::execution::par);
+}
+
+std::vector<uint32_t> randomValues(size_t N) {
+  std::vector<uint32_t> V(N);
+  std::generate(V.begin(), V.end(), [] { return getRandomInteger<uint32_t>(); });
+  return V;
+}
+
+template <class P>
+struct Sort {
+  size_t Quantity;
+
+  void run(benchmark::State& state) const {
+    const std::vector<uint32_t> Orig = randomValues(Quantity);
+    std::vector<uint32_t> Copy;
+    for (auto _ : state) {
+      state.PauseTiming();
+      Copy = Orig;
+      state.ResumeTiming();
+      withPolicy<P>([&](auto& Exec) { std::sort(Exec, Copy.begin(), Copy.end()); });
+      benchmark::DoNotOptimize(Copy.data());
+    }
+    state.SetItemsProcessed(state.iterations() * Quantity);
+  }
+
+  std::string name() const {
+    return "BM_Sort" + P::name() + "_" + std::to_string(Quantity);
+  }
+};
+
+template <class P>
+struct StableSort {
+  size_t Quantity;
+
+  void run(benchmark::State& state) const {
+    const std::vector<uint32_t> Orig = randomValues(Quantity);
+    std::vector<uint32_t> Copy;
+    for (auto _ : state) {
+      state.PauseTiming();
+      Copy = Orig;
+      state.ResumeTiming();
+      withPolicy<P>(
+          [&](auto& Exec) { std::stable_sort(Exec, Copy.begin(), Copy.end()); });
+      benchmark::DoNotOptimize(Copy.data());
+    }
+    state.SetItemsProcessed(state.iterations() * Quantity);
+  }
+
+  std::string name() const {
+    return "BM_StableSort" + P::name() + "_" + std::to_string(Quantity);
+  }
+};
+
+template <class P>
+struct Transform {
+  size_t Quantity;
+
+  void run(benchmark::State& state) const {
+    const std::vector<uint32_t> In = randomValues(Quantity);
+    std::vector<uint32_t> Out(Quantity);
+    for (auto _ : state) {
+      withPolicy<P>([&](auto& Exec) {
+        std::transform(Exec, In.begin(), In.end(), Out.begin(),
+                       [](uint32_t X) { return X * 3 + 1; });
+      });
+      benchmark::DoNotOptimize(Out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * Quantity);
+  }
+
+  std::string name() const {
+    return "BM_Transform" + P::name() + "_" + std::to_string(Quantity);
+  }
+};
+
+template <class P>
+struct TransformReduce {
+  size_t Quantity;
+
+  void run(benchmark::State& state) const {
+    const std::vector<uint32_t> A = randomValues(Quantity);
+    const std::vector<uint32_t> B = randomValues(Quantity);
+    for (auto _ : state) {
+      uint64_t R;
+      withPolicy<P>([&](auto& Exec) {
+        R = std::transform_reduce(Exec, A.begin(), A.end(), B.begin(),
+                                  uint64_t(0));
+      });
+      benchmark::DoNotOptimize(R);
+    }
+    state.SetItemsProcessed(state.iterations() * Quantity);
+  }
+
+  std::string name() const {
+    return "BM_TransformReduce" + P::name() + "_" + std::to_string(Quantity);
+  }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+
+  const std::vector<size_t> Quantities = {1 << 10, 1 << 14, 1 << 18, 1 << 22};
+  makeCartesianProductBenchmark<Sort, AllPolicies>(Quantities);
+  makeCartesianProductBenchmark<StableSort, AllPolicies>(Quantities);
+  makeCartesianProductBenchmark<Transform, AllPolicies>(Quantities);
+  makeCartesianProductBenchmark<TransformReduce, AllPolicies>(Quantities);
+  benchmark::RunSpecifiedBenchmarks();
+}
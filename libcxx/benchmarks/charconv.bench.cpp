@@ -0,0 +1,94 @@
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "test_macros.h"
+
+namespace {
+
+constexpr size_t Quantity = 1 << 12;
+
+// Doubles of mixed magnitude, as a metrics or JSON writer sees them.
+std::vector<double> randomDoubles() {
+  std::mt19937_64 Gen(42);
+  std::uniform_real_distribution<double> Mantissa(1.0, 10.0);
+  std::uniform_int_distribution<int> Exponent(-20, 20);
+  std::vector<double> V(Quantity);
+  for (double& D : V)
+    D = Mantissa(Gen) * std::pow(10.0, Exponent(Gen));
+  return V;
+}
+
+std::vector<std::string> shortestStrings(const std::vector<double>& V) {
+  std::vector<std::string> S;
+  for (double D : V) {
+    char Buf[32];
+    S.emplace_back(Buf, std::to_chars(Buf, Buf + sizeof(Buf), D).ptr);
+  }
+  return S;
+}
+
+void BM_ToCharsShortest(benchmark::State& state) {
+  const std::vector<double> V = randomDoubles();
+  char Buf[32];
+  for (auto _ : state)
+    for (double D : V)
+      benchmark::DoNotOptimize(std::to_chars(Buf, Buf + sizeof(Buf), D).ptr);
+  state.SetItemsProcessed(state.iterations() * Quantity);
+}
+BENCHMARK(BM_ToCharsShortest);
+
+void BM_ToCharsPrecision(benchmark::State& state) {
+  const std::vector<double> V = randomDoubles();
+  char Buf[32];
+  for (auto _ : state)
+    for (double D : V)
+      benchmark::DoNotOptimize(
+          std::to_chars(Buf, Buf + sizeof(Buf), D, std::chars_format::general,
+                        17)
+              .ptr);
+  state.SetItemsProcessed(state.iterations() * Quantity);
+}
+BENCHMARK(BM_ToCharsPrecision);
+
+void BM_Snprintf(benchmark::State& state) {
+  const std::vector<double> V = randomDoubles();
+  char Buf[32];
+  for (auto _ : state)
+    for (double D : V)
+      benchmark::DoNotOptimize(snprintf(Buf, sizeof(Buf), "%.17g", D));
+  state.SetItemsProcessed(state.iterations() * Quantity);
+}
+BENCHMARK(BM_Snprintf);
+
+void BM_FromChars(benchmark::State& state) {
+  const std::vector<std::string> S = shortestStrings(randomDoubles());
+  for (auto _ : state)
+    for (const std::string& Str : S) {
+      double D;
+      std::from_chars(Str.data(), Str.data() + Str.size(), D);
+      benchmark::DoNotOptimize(D);
+    }
+  state.SetItemsProcessed(state.iterations() * Quantity);
+}
+BENCHMARK(BM_FromChars);
+
+void BM_Strtod(benchmark::State& state) {
+  const std::vector<std::string> S = shortestStrings(randomDoubles());
+  for (auto _ : state)
+    for (const std::string& Str : S)
+      benchmark::DoNotOptimize(strtod(Str.c_str(), nullptr));
+  state.SetItemsProcessed(state.iterations() * Quantity);
+}
+BENCHMARK(BM_Strtod);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,100 @@
+#include <cstdint>
+#include <experimental/flat_hash_map>
+#include <experimental/flat_hash_set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "ContainerBenchmarks.hpp"
+#include "GenerateInput.hpp"
+
+using namespace ContainerBenchmarks;
+
+constexpr std::size_t TestNumInputs = 1024;
+
+// Looks up keys that are not in the container.
+template <class Container, class GenInputs>
+static void BM_FindMiss(benchmark::State& st, Container c, GenInputs gen) {
+  auto in = gen(st.range(0) * 2);
+  const auto mid = in.begin() + in.size() / 2;
+  c.insert(in.begin(), mid);
+  const auto end = in.end();
+  while (st.KeepRunning()) {
+    for (auto it = mid; it != end; ++it)
+      benchmark::DoNotOptimize(c.find(*it) == c.end());
+    benchmark::ClobberMemory();
+  }
+}
+
+// Erases every element and inserts it back.
+template <class Container, class GenInputs>
+static void BM_EraseInsert(benchmark::State& st, Container c, GenInputs gen) {
+  auto in = gen(st.range(0));
+  c.insert(in.begin(), in.end());
+  const auto end = in.end();
+  while (st.KeepRunning()) {
+    for (auto it = in.begin(); it != end; ++it)
+      benchmark::DoNotOptimize(c.erase(*it));
+    for (auto it = in.begin(); it != end; ++it)
+      benchmark::DoNotOptimize(&(*c.insert(*it).first));
+    benchmark::ClobberMemory();
+  }
+}
+
+// Inserts, looks up and removes key/value pairs through operator[].
+template <class Map, class GenInputs>
+static void BM_MapSubscript(benchmark::State& st, Map m, GenInputs gen) {
+  auto in = gen(st.range(0));
+  const auto end = in.end();
+  while (st.KeepRunning()) {
+    for (auto it = in.begin(); it != end; ++it)
+      ++m[*it];
+    for (auto it = in.begin(); it != end; ++it)
+      benchmark::DoNotOptimize(m[*it]);
+    m.clear();
+    benchmark::ClobberMemory();
+  }
+}
+
+#define FLAT_HASH_BENCHMARKS(Name, Container, Gen)                             \
+  BENCHMARK_CAPTURE(BM_InsertValue, Name, Container{}, Gen)                    \
+      ->Arg(TestNumInputs)->Arg(TestNumInputs * 64);                           \
+  BENCHMARK_CAPTURE(BM_Find, Name, Container{}, Gen)                           \
+      ->Arg(TestNumInputs)->Arg(TestNumInputs * 64);                           \
+  BENCHMARK_CAPTURE(BM_FindMiss, Name, Container{}, Gen)                       \
+      ->Arg(TestNumInputs)->Arg(TestNumInputs * 64);                           \
+  BENCHMARK_CAPTURE(BM_EraseInsert, Name, Container{}, Gen)                    \
+      ->Arg(TestNumInputs)->Arg(TestNumInputs * 64)
+
+FLAT_HASH_BENCHMARKS(unordered_set_uint64, std::unordered_set<uint64_t>,
+                     getRandomIntegerInputs<uint64_t>);
+FLAT_HASH_BENCHMARKS(flat_hash_set_uint64,
+                     std::experimental::flat_hash_set<uint64_t>,
+                     getRandomIntegerInputs<uint64_t>);
+
+FLAT_HASH_BENCHMARKS(unordered_set_sorted_uint64,
+                     std::unordered_set<uint64_t>,
+                     getSortedIntegerInputs<uint64_t>);
+FLAT_HASH_BENCHMARKS(flat_hash_set_sorted_uint64,
+                     std::experimental::flat_hash_set<uint64_t>,
+                     getSortedIntegerInputs<uint64_t>);
+
+FLAT_HASH_BENCHMARKS(unordered_set_string, std::unordered_set<std::string>,
+                     getRandomStringInputs);
+FLAT_HASH_BENCHMARKS(flat_hash_set_string,
+                     std::experimental::flat_hash_set<std::string>,
+                     getRandomStringInputs);
+
+BENCHMARK_CAPTURE(BM_MapSubscript, unordered_map_uint64,
+                  std::unordered_map<uint64_t, uint64_t>{},
+                  getRandomIntegerInputs<uint64_t>)
+    ->Arg(TestNumInputs)->Arg(TestNumInputs * 64);
+BENCHMARK_CAPTURE(BM_MapSubscript, flat_hash_map_uint64,
+                  std::experimental::flat_hash_map<uint64_t, uint64_t>{},
+                  getRandomIntegerInputs<uint64_t>)
+    ->Arg(TestNumInputs)->Arg(TestNumInputs * 64);
+
+BENCHMARK_MAIN();
@@ -24,17 +24,19 @@ enum class FunctionType {
   MemberPointer,
   SmallTrivialFunctor,
   SmallNonTrivialFunctor,
+  MediumTrivialFunctor,
   LargeTrivialFunctor,
   LargeNonTrivialFunctor
 };
 
-struct AllFunctionTypes : EnumValuesAsTuple<AllFunctionTypes, FunctionType, 8> {
+struct AllFunctionTypes : EnumValuesAsTuple<AllFunctionTypes, FunctionType, 9> {
   static constexpr const char* Names[] = {"Null",
                                           "FuncPtr",
                                           "MemFuncPtr",
                                           "MemPtr",
                                           "SmallTrivialFunctor",
                                           "SmallNonTrivialFunctor",
+                                          "MediumTrivialFunctor",
                                           "LargeTrivialFunctor",
                                           "LargeNonTrivialFunctor"};
 };
@@ -61,6 +63,14 @@ struct SmallNonTrivialFunctor {
   ~SmallNonTrivialFunctor() {}
   int operator()(const S*) const { return 0; }
 };
+// The size of a lambda capturing five pointers by copy.
+struct MediumTrivialFunctor {
+  MediumTrivialFunctor() {
+      // Do not spend time initializing the captures.
+  }
+  void* captures[5];
+  int operator()(const S*) const { return 0; }
+};
 struct LargeTrivialFunctor {
   LargeTrivialFunctor() {
       // Do not spend time initializing the padding.
@@ -95,6 +105,8 @@ inline Function MakeFunction(FunctionType type, bool opaque = false) {
       return maybeOpaque(SmallTrivialFunctor{}, opaque);
     case FunctionType::SmallNonTrivialFunctor:
       return maybeOpaque(SmallNonTrivialFunctor{}, opaque);
+    case FunctionType::MediumTrivialFunctor:
+      return maybeOpaque(MediumTrivialFunctor{}, opaque);
     case FunctionType::LargeTrivialFunctor:
       return maybeOpaque(LargeTrivialFunctor{}, opaque);
     case FunctionType::LargeNonTrivialFunctor:
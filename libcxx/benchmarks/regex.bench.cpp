@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <regex>
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+// A log file of state.range(0) lines, one in eight of which is an error.
+static std::string makeLog(std::size_t Lines) {
+  std::string Log;
+  for (std::size_t I = 0; I < Lines; ++I) {
+    Log += "2019-07-";
+    Log += char('0' + I % 3);
+    Log += char('0' + I % 10);
+    Log += " 12:34:56 ";
+    if (I % 8 == 7)
+      Log += "ERROR 42: disk_full on /dev/sda1\n";
+    else
+      Log += "INFO request served in 17 ms from cache\n";
+  }
+  return Log;
+}
+
+// Searches a whole log for a pattern that never matches.
+static void BM_RegexSearchNoMatch(benchmark::State& state) {
+  const std::string Log = makeLog(state.range(0));
+  const std::regex Re("FATAL [0-9]+: (\\w+)");
+  std::smatch M;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(std::regex_search(Log, M, Re));
+}
+BENCHMARK(BM_RegexSearchNoMatch)->Range(8, 8 << 10);
+
+// Finds every error line, reusing the same match_results.
+static void BM_RegexIterateErrors(benchmark::State& state) {
+  const std::string Log = makeLog(state.range(0));
+  const std::regex Re("ERROR ([0-9]+): (\\w+) on (/[a-z0-9/]+)");
+  for (auto _ : state) {
+    std::sregex_iterator It(Log.begin(), Log.end(), Re), End;
+    benchmark::DoNotOptimize(std::distance(It, End));
+  }
+}
+BENCHMARK(BM_RegexIterateErrors)->Range(8, 8 << 10);
+
+// Matches each line of a log against a pattern with several captures.
+static void BM_RegexMatchLines(benchmark::State& state) {
+  const std::string Log = makeLog(state.range(0));
+  const std::regex Re("([0-9-]+) ([0-9:]+) (INFO|WARN|ERROR) (.*)");
+  std::smatch M;
+  for (auto _ : state) {
+    std::size_t Matched = 0;
+    for (std::string::const_iterator B = Log.begin(), E; B != Log.end();
+         B = E + 1) {
+      E = std::find(B, Log.end(), '\n');
+      Matched += std::regex_match(B, E, M, Re);
+    }
+    benchmark::DoNotOptimize(Matched);
+  }
+}
+BENCHMARK(BM_RegexMatchLines)->Range(8, 8 << 10);
+
+// Matches (a|aa)*b against a run of a's, which backtracking explores in
+// exponential time.
+static void BM_RegexAlternationRun(benchmark::State& state) {
+  const std::string S(state.range(0), 'a');
+  const std::regex Re("(a|aa)*b");
+  std::smatch M;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(std::regex_search(S, M, Re));
+}
+BENCHMARK(BM_RegexAlternationRun)->DenseRange(4, 16, 4);
+
+BENCHMARK_MAIN();
@@ -7,8 +7,16 @@
 //===----------------------------------------------------------------------===//
 
 #include "charconv"
+#include "cmath"
+#include "locale"
+#include "memory"
+#include <errno.h>
+#include <float.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "include/charconv_tables.h"
+
 _LIBCPP_BEGIN_NAMESPACE_STD
 
 namespace __itoa
@@ -173,25 +181,8 @@ __u64toa(uint64_t value, char* buffer)
         const uint32_t v0 = static_cast<uint32_t>(value / 100000000);
         const uint32_t v1 = static_cast<uint32_t>(value % 100000000);
 
-        const uint32_t b0 = v0 / 10000;
-        const uint32_t c0 = v0 % 10000;
-
-        if (v0 < 1000000)
-        {
-            if (v0 < 100000)
-                buffer = append1(buffer, b0);
-            else
-                buffer = append2(buffer, b0);
-        }
-        else
-        {
-            if (v0 < 10000000)
-                buffer = append3(buffer, b0);
-            else
-                buffer = append4(buffer, b0);
-        }
-
-        buffer = append4(buffer, c0);
+        // v0 is 1 to 99999999; only its significant digits are printed.
+        buffer = __u32toa(v0, buffer);
         buffer = append4(buffer, v1 / 10000);
         buffer = append4(buffer, v1 % 10000);
     }
@@ -229,4 +220,1272 @@ __u64toa(uint64_t value, char* buffer)
 
 }  // namespace __itoa
 
+namespace __ryu
+{
+
+// value == mantissa * 10^exponent
+struct decimal
+{
+    uint64_t mantissa;
+    int32_t exponent;
+};
+
+// The digits of a finite, non-negative value in scientific notation:
+// value == buf[0].buf[1]...buf[count - 1] * 10^exponent.
+struct digits
+{
+    char buf[48];
+    int count;
+    int exponent;
+};
+
+// Bit length of 5^e, for 0 <= e <= 3528.
+inline int32_t
+pow5bits(int32_t e)
+{
+    return static_cast<int32_t>((static_cast<uint32_t>(e) * 1217359) >> 19) + 1;
+}
+
+// floor(log10(2^e)), for 0 <= e <= 1650.
+inline uint32_t
+log10_pow2(int32_t e)
+{
+    return (static_cast<uint32_t>(e) * 78913) >> 18;
+}
+
+// floor(log10(5^e)), for 0 <= e <= 2620.
+inline uint32_t
+log10_pow5(int32_t e)
+{
+    return (static_cast<uint32_t>(e) * 732923) >> 20;
+}
+
+inline bool
+multiple_of_pow5(uint64_t value, uint32_t p)
+{
+    uint32_t count = 0;
+    for (; value % 5 == 0; value /= 5)
+        ++count;
+    return count >= p;
+}
+
+inline bool
+multiple_of_pow2(uint64_t value, uint32_t p)
+{
+    return (value & ((uint64_t(1) << p) - 1)) == 0;
+}
+
+// (m * mul) >> j, where mul is a 128-bit {low, high} table entry, j >= 64
+// and the result fits in 64 bits.
+inline uint64_t
+mul_shift64(uint64_t m, const uint64_t* mul, int32_t j)
+{
+#ifndef _LIBCPP_HAS_NO_INT128
+    const __uint128_t b0 = static_cast<__uint128_t>(m) * mul[0];
+    const __uint128_t b2 = static_cast<__uint128_t>(m) * mul[1];
+    return static_cast<uint64_t>(((b0 >> 64) + b2) >> (j - 64));
+#else
+    struct wide
+    {
+        uint64_t lo, hi;
+    };
+    auto umul128 = [](uint64_t a, uint64_t b) -> wide {
+        const uint64_t a_lo = a & 0xffffffff, a_hi = a >> 32;
+        const uint64_t b_lo = b & 0xffffffff, b_hi = b >> 32;
+        const uint64_t b00 = a_lo * b_lo, b01 = a_lo * b_hi;
+        const uint64_t b10 = a_hi * b_lo, b11 = a_hi * b_hi;
+        const uint64_t mid1 = b10 + (b00 >> 32);
+        const uint64_t mid2 = b01 + (mid1 & 0xffffffff);
+        return {(mid2 << 32) | (b00 & 0xffffffff),
+                b11 + (mid1 >> 32) + (mid2 >> 32)};
+    };
+    const wide b0 = umul128(m, mul[0]);
+    const wide b2 = umul128(m, mul[1]);
+    const uint64_t lo = b0.hi + b2.lo;
+    const uint64_t hi = b2.hi + (lo < b0.hi);
+    const int32_t dist = j - 64;
+    return (hi << (64 - dist)) | (lo >> dist);
+#endif
+}
+
+// The shortest decimal in the rounding interval of a positive double,
+// picking the one closest to the exact value (Ryu, section 3).
+decimal
+d2d(uint64_t ieee_mantissa, uint32_t ieee_exponent)
+{
+    const int mantissa_bits = 52;
+    const int bias = 1023;
+    const int32_t pow5_inv_bitcount = 125;
+    const int32_t pow5_bitcount = 125;
+
+    int32_t e2;
+    uint64_t m2;
+    if (ieee_exponent == 0)
+    {
+        e2 = 1 - bias - mantissa_bits - 2;
+        m2 = ieee_mantissa;
+    }
+    else
+    {
+        e2 = static_cast<int32_t>(ieee_exponent) - bias - mantissa_bits - 2;
+        m2 = (uint64_t(1) << mantissa_bits) | ieee_mantissa;
+    }
+    const bool accept_bounds = (m2 & 1) == 0;
+
+    // The interval of values that round to this double is (mm, mp) in units
+    // of 2^e2; the lower boundary is closer when m2 is a power of two.
+    const uint64_t mv = 4 * m2;
+    const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+    uint64_t vr, vp, vm;
+    int32_t e10;
+    bool vm_is_trailing_zeros = false;
+    bool vr_is_trailing_zeros = false;
+    if (e2 >= 0)
+    {
+        const uint32_t q = log10_pow2(e2) - (e2 > 3);
+        e10 = static_cast<int32_t>(q);
+        const int32_t k =
+            pow5_inv_bitcount + pow5bits(static_cast<int32_t>(q)) - 1;
+        const int32_t i = -e2 + static_cast<int32_t>(q) + k;
+        const uint64_t* mul = __double_pow5_inv_split[q];
+        vr = mul_shift64(4 * m2, mul, i);
+        vp = mul_shift64(4 * m2 + 2, mul, i);
+        vm = mul_shift64(4 * m2 - 1 - mm_shift, mul, i);
+        if (q <= 21)
+        {
+            // At most one of mp, mv and mm is a multiple of 5.
+            if (mv % 5 == 0)
+                vr_is_trailing_zeros = multiple_of_pow5(mv, q);
+            else if (accept_bounds)
+                vm_is_trailing_zeros = multiple_of_pow5(mv - 1 - mm_shift, q);
+            else
+                vp -= multiple_of_pow5(mv + 2, q);
+        }
+    }
+    else
+    {
+        const uint32_t q = log10_pow5(-e2) - (-e2 > 1);
+        e10 = static_cast<int32_t>(q) + e2;
+        const int32_t i = -e2 - static_cast<int32_t>(q);
+        const int32_t k = pow5bits(i) - pow5_bitcount;
+        const int32_t j = static_cast<int32_t>(q) - k;
+        const uint64_t* mul = __double_pow5_split[i];
+        vr = mul_shift64(4 * m2, mul, j);
+        vp = mul_shift64(4 * m2 + 2, mul, j);
+        vm = mul_shift64(4 * m2 - 1 - mm_shift, mul, j);
+        if (q <= 1)
+        {
+            // mv has at least two trailing zero bits; mp has one and mm has
+            // one exactly when mm_shift is set.
+            vr_is_trailing_zeros = true;
+            if (accept_bounds)
+                vm_is_trailing_zeros = mm_shift == 1;
+            else
+                --vp;
+        }
+        else if (q < 63)
+            vr_is_trailing_zeros = multiple_of_pow2(mv, q);
+    }
+
+    // Remove digits while the interval still holds a shorter decimal.
+    int32_t removed = 0;
+    uint8_t last_removed_digit = 0;
+    uint64_t output;
+    if (vm_is_trailing_zeros || vr_is_trailing_zeros)
+    {
+        // Rare: the shortest decimal may lie on a boundary or the exact value
+        // may be a tie.
+        for (; vp / 10 > vm / 10; ++removed)
+        {
+            vm_is_trailing_zeros &= vm % 10 == 0;
+            vr_is_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = static_cast<uint8_t>(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+        }
+        if (vm_is_trailing_zeros)
+        {
+            for (; vm % 10 == 0; ++removed)
+            {
+                vr_is_trailing_zeros &= last_removed_digit == 0;
+                last_removed_digit = static_cast<uint8_t>(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+            }
+        }
+        // Round half to even.
+        if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+            last_removed_digit = 4;
+        output = vr + ((vr == vm &&
+                        (!accept_bounds || !vm_is_trailing_zeros)) ||
+                       last_removed_digit >= 5);
+    }
+    else
+    {
+        bool round_up = false;
+        if (vp / 100 > vm / 100)
+        {
+            // Most values lose at least two digits; strip them in one step.
+            round_up = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        for (; vp / 10 > vm / 10; ++removed)
+        {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+        }
+        output = vr + (vr == vm || round_up);
+    }
+    return {output, e10 + removed};
+}
+
+// (m * factor) >> shift, for shift >= 32.
+inline uint32_t
+mul_shift32(uint32_t m, uint64_t factor, int32_t shift)
+{
+    const uint64_t bits0 = uint64_t(m) * static_cast<uint32_t>(factor);
+    const uint64_t bits1 = uint64_t(m) * static_cast<uint32_t>(factor >> 32);
+    return static_cast<uint32_t>(((bits0 >> 32) + bits1) >> (shift - 32));
+}
+
+// The float counterpart of d2d, on 32-bit arithmetic.
+decimal
+f2d(uint32_t ieee_mantissa, uint32_t ieee_exponent)
+{
+    const int mantissa_bits = 23;
+    const int bias = 127;
+    const int32_t pow5_inv_bitcount = 59;
+    const int32_t pow5_bitcount = 61;
+
+    int32_t e2;
+    uint32_t m2;
+    if (ieee_exponent == 0)
+    {
+        e2 = 1 - bias - mantissa_bits - 2;
+        m2 = ieee_mantissa;
+    }
+    else
+    {
+        e2 = static_cast<int32_t>(ieee_exponent) - bias - mantissa_bits - 2;
+        m2 = (uint32_t(1) << mantissa_bits) | ieee_mantissa;
+    }
+    const bool accept_bounds = (m2 & 1) == 0;
+
+    const uint32_t mv = 4 * m2;
+    const uint32_t mp = 4 * m2 + 2;
+    const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+    const uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+    uint32_t vr, vp, vm;
+    int32_t e10;
+    bool vm_is_trailing_zeros = false;
+    bool vr_is_trailing_zeros = false;
+    uint8_t last_removed_digit = 0;
+    if (e2 >= 0)
+    {
+        const uint32_t q = log10_pow2(e2);
+        e10 = static_cast<int32_t>(q);
+        const int32_t k =
+            pow5_inv_bitcount + pow5bits(static_cast<int32_t>(q)) - 1;
+        const int32_t i = -e2 + static_cast<int32_t>(q) + k;
+        const uint64_t mul = __float_pow5_inv_split[q];
+        vr = mul_shift32(mv, mul, i);
+        vp = mul_shift32(mp, mul, i);
+        vm = mul_shift32(mm, mul, i);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10)
+        {
+            // The loop below removes no digit, but the rounding still needs
+            // the first digit that q removed.
+            const int32_t l =
+                pow5_inv_bitcount + pow5bits(static_cast<int32_t>(q - 1)) - 1;
+            last_removed_digit = static_cast<uint8_t>(
+                mul_shift32(mv, __float_pow5_inv_split[q - 1],
+                            -e2 + static_cast<int32_t>(q) - 1 + l) % 10);
+        }
+        if (q <= 9)
+        {
+            if (mv % 5 == 0)
+                vr_is_trailing_zeros = multiple_of_pow5(mv, q);
+            else if (accept_bounds)
+                vm_is_trailing_zeros = multiple_of_pow5(mm, q);
+            else
+                vp -= multiple_of_pow5(mp, q);
+        }
+    }
+    else
+    {
+        const uint32_t q = log10_pow5(-e2);
+        e10 = static_cast<int32_t>(q) + e2;
+        const int32_t i = -e2 - static_cast<int32_t>(q);
+        const int32_t k = pow5bits(i) - pow5_bitcount;
+        int32_t j = static_cast<int32_t>(q) - k;
+        const uint64_t mul = __float_pow5_split[i];
+        vr = mul_shift32(mv, mul, j);
+        vp = mul_shift32(mp, mul, j);
+        vm = mul_shift32(mm, mul, j);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10)
+        {
+            j = static_cast<int32_t>(q) - 1 - (pow5bits(i + 1) - pow5_bitcount);
+            last_removed_digit = static_cast<uint8_t>(
+                mul_shift32(mv, __float_pow5_split[i + 1], j) % 10);
+        }
+        if (q <= 1)
+        {
+            vr_is_trailing_zeros = true;
+            if (accept_bounds)
+                vm_is_trailing_zeros = mm_shift == 1;
+            else
+                --vp;
+        }
+        else if (q < 31)
+            vr_is_trailing_zeros = multiple_of_pow2(mv, q - 1);
+    }
+
+    int32_t removed = 0;
+    uint32_t output;
+    if (vm_is_trailing_zeros || vr_is_trailing_zeros)
+    {
+        for (; vp / 10 > vm / 10; ++removed)
+        {
+            vm_is_trailing_zeros &= vm % 10 == 0;
+            vr_is_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = static_cast<uint8_t>(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+        }
+        if (vm_is_trailing_zeros)
+        {
+            for (; vm % 10 == 0; ++removed)
+            {
+                vr_is_trailing_zeros &= last_removed_digit == 0;
+                last_removed_digit = static_cast<uint8_t>(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+            }
+        }
+        if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+            last_removed_digit = 4;
+        output = vr + ((vr == vm &&
+                        (!accept_bounds || !vm_is_trailing_zeros)) ||
+                       last_removed_digit >= 5);
+    }
+    else
+    {
+        for (; vp / 10 > vm / 10; ++removed)
+        {
+            last_removed_digit = static_cast<uint8_t>(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+        }
+        output = vr + (vr == vm || last_removed_digit >= 5);
+    }
+    return {output, e10 + removed};
+}
+
+void
+to_digits(decimal d, digits& out)
+{
+    out.count =
+        static_cast<int>(__itoa::__u64toa(d.mantissa, out.buf) - out.buf);
+    out.exponent = d.exponent + out.count - 1;
+}
+
+// Appends the nine decimal digits of value < 10^9, with leading zeros.
+inline char*
+append9(char* buffer, uint32_t value)
+{
+    for (int i = 8; i >= 0; --i, value /= 10)
+        buffer[i] = static_cast<char>('0' + value % 10);
+    return buffer + 9;
+}
+
+inline int
+exponent_width(int exponent)
+{
+    unsigned e = exponent < 0 ? -exponent : exponent;
+    return e >= 1000 ? 4 : e >= 100 ? 3 : 2;
+}
+
+// Lengths without the sign; fixed_length assumes zero fill for exponents
+// past the last digit.
+inline int
+fixed_length(const digits& d)
+{
+    if (d.exponent >= d.count - 1)
+        return d.exponent + 1;
+    if (d.exponent >= 0)
+        return d.count + 1;
+    return d.count + 1 - d.exponent;
+}
+
+inline int
+scientific_length(const digits& d)
+{
+    return d.count + (d.count > 1) + 2 + exponent_width(d.exponent);
+}
+
+to_chars_result
+write_string(char* first, char* last, bool negative, const char* s, size_t n)
+{
+    if (static_cast<size_t>(last - first) < negative + n)
+        return {last, errc::value_too_large};
+    if (negative)
+        *first++ = '-';
+    memcpy(first, s, n);
+    return {first + n, errc()};
+}
+
+to_chars_result
+write_scientific(char* first, char* last, bool negative, const digits& d)
+{
+    if (last - first < negative + scientific_length(d))
+        return {last, errc::value_too_large};
+    if (negative)
+        *first++ = '-';
+    *first++ = d.buf[0];
+    if (d.count > 1)
+    {
+        *first++ = '.';
+        memcpy(first, d.buf + 1, d.count - 1);
+        first += d.count - 1;
+    }
+    *first++ = 'e';
+    *first++ = d.exponent < 0 ? '-' : '+';
+    unsigned e = d.exponent < 0 ? -d.exponent : d.exponent;
+    if (e < 10)
+        *first++ = '0';
+    return {__itoa::__u32toa(e, first), errc()};
+}
+
+// Fixed notation for values whose digits reach the units position, that
+// is d.exponent < d.count.
+to_chars_result
+write_fixed(char* first, char* last, bool negative, const digits& d)
+{
+    if (last - first < negative + fixed_length(d))
+        return {last, errc::value_too_large};
+    if (negative)
+        *first++ = '-';
+    if (d.exponent < 0)
+    {
+        *first++ = '0';
+        *first++ = '.';
+        memset(first, '0', -d.exponent - 1);
+        first += -d.exponent - 1;
+        memcpy(first, d.buf, d.count);
+        return {first + d.count, errc()};
+    }
+    memcpy(first, d.buf, d.exponent + 1);
+    first += d.exponent + 1;
+    if (d.exponent + 1 < d.count)
+    {
+        *first++ = '.';
+        memcpy(first, d.buf + d.exponent + 1, d.count - d.exponent - 1);
+        first += d.count - d.exponent - 1;
+    }
+    return {first, errc()};
+}
+
+// The exact decimal value of an integral double. The shortest digits of a
+// large value followed by zeros round-trip as well, but the exact value is
+// never longer and is closer, so fixed notation prefers it when the shortest
+// digits end left of the units position.
+to_chars_result
+write_integer(char* first, char* last, bool negative, double value)
+{
+    char buf[320];
+    char* end;
+    if (value < 18446744073709551616.0)
+        end = __itoa::__u64toa(static_cast<uint64_t>(value), buf);
+    else
+    {
+        // value = m * 2^e with e > 0; shift it into base 10^9 limbs.
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        uint64_t m = (bits & ((uint64_t(1) << 52) - 1)) | (uint64_t(1) << 52);
+        int e = static_cast<int>(bits >> 52) - 1023 - 52;
+        uint32_t limbs[40];
+        int n = 0;
+        for (; m != 0; m /= 1000000000)
+            limbs[n++] = static_cast<uint32_t>(m % 1000000000);
+        for (; e > 0; e -= 32)
+        {
+            const int s = e < 32 ? e : 32;
+            uint64_t carry = 0;
+            for (int i = 0; i < n; ++i)
+            {
+                const uint64_t x = (uint64_t(limbs[i]) << s) + carry;
+                limbs[i] = static_cast<uint32_t>(x % 1000000000);
+                carry = x / 1000000000;
+            }
+            for (; carry != 0; carry /= 1000000000)
+                limbs[n++] = static_cast<uint32_t>(carry % 1000000000);
+        }
+        end = __itoa::__u32toa(limbs[n - 1], buf);
+        for (int i = n - 2; i >= 0; --i)
+            end = append9(end, limbs[i]);
+    }
+    return write_string(first, last, negative, buf, end - buf);
+}
+
+// printf in the "C" locale into [first, last), without the terminating NUL
+// or the "0x" of hex output; precision < 0 means the format has none.
+template <class T>
+to_chars_result
+write_printf(char* first, char* last, const char* format, int precision,
+             T value)
+{
+    char stack[256];
+    unique_ptr<char[]> heap;
+    char* buf = stack;
+    size_t size = sizeof(stack);
+    int n;
+    for (;;)
+    {
+        n = precision < 0
+                ? __libcpp_snprintf_l(buf, size, _LIBCPP_GET_C_LOCALE, format,
+                                      value)
+                : __libcpp_snprintf_l(buf, size, _LIBCPP_GET_C_LOCALE, format,
+                                      precision, value);
+        if (n < 0)
+            return {last, errc::value_too_large};
+        if (static_cast<size_t>(n) < size)
+            break;
+        size = static_cast<size_t>(n) + 1;
+        heap.reset(new char[size]);
+        buf = heap.get();
+    }
+    const bool negative = buf[0] == '-';
+    if (n > negative + 1 && buf[negative + 1] == 'x')
+        return write_string(first, last, negative, buf + negative + 2,
+                            n - negative - 2);
+    return write_string(first, last, false, buf, n);
+}
+
+// The IEEE binary formats handled without printf and strtod. The powers
+// bound the decimal exponents for which Eisel-Lemire can produce a nonzero
+// finite value, and the round to even ones those for which it can see an
+// exact tie.
+template <class T>
+struct traits;
+
+template <>
+struct traits<float>
+{
+    typedef uint32_t bits_type;
+    static const int mantissa_bits = 23;
+    static const int exponent_bits = 8;
+    static const int bias = 127;
+    static const int hex_digits = 6;
+    static const int smallest_power = -65;
+    static const int largest_power = 38;
+    static const int min_round_to_even = -17;
+    static const int max_round_to_even = 10;
+
+    static decimal shortest(uint32_t m, uint32_t e) { return f2d(m, e); }
+};
+
+template <>
+struct traits<double>
+{
+    typedef uint64_t bits_type;
+    static const int mantissa_bits = 52;
+    static const int exponent_bits = 11;
+    static const int bias = 1023;
+    static const int hex_digits = 13;
+    static const int smallest_power = -342;
+    static const int largest_power = 308;
+    static const int min_round_to_even = -4;
+    static const int max_round_to_even = 23;
+
+    static decimal shortest(uint64_t m, uint32_t e) { return d2d(m, e); }
+};
+
+template <class T>
+to_chars_result
+write_special(char* first, char* last, T value)
+{
+    const bool negative = _VSTD::signbit(value);
+    if (_VSTD::isinf(value))
+        return write_string(first, last, negative, "inf", 3);
+    return write_string(first, last, negative, "nan", 3);
+}
+
+// Hex notation of lead.frac * 2^exponent, where frac holds digit_count hex
+// digits; precision < 0 asks for the shortest form.
+to_chars_result
+write_hex(char* first, char* last, bool negative, uint32_t lead,
+          uint64_t frac, int digit_count, int exponent, int precision)
+{
+    if (precision < 0)
+    {
+        for (; digit_count > 0 && (frac & 0xf) == 0; --digit_count)
+            frac >>= 4;
+        precision = digit_count;
+    }
+    else if (precision < digit_count)
+    {
+        // Round half to even; a carry may turn the lead digit into 2.
+        const int shift = 4 * (digit_count - precision);
+        uint64_t v = (uint64_t(lead) << (4 * digit_count)) | frac;
+        const uint64_t rem = v & ((uint64_t(1) << shift) - 1);
+        const uint64_t half = uint64_t(1) << (shift - 1);
+        v >>= shift;
+        if (rem > half || (rem == half && (v & 1)))
+            ++v;
+        digit_count = precision;
+        lead = static_cast<uint32_t>(v >> (4 * digit_count));
+        frac = v & ((uint64_t(1) << (4 * digit_count)) - 1);
+    }
+    const unsigned e = exponent < 0 ? -exponent : exponent;
+    const int e_width = e >= 1000 ? 4 : e >= 100 ? 3 : e >= 10 ? 2 : 1;
+    if (last - first < negative + 1 + (precision > 0) + precision + 2 + e_width)
+        return {last, errc::value_too_large};
+    if (negative)
+        *first++ = '-';
+    *first++ = static_cast<char>('0' + lead);
+    if (precision > 0)
+    {
+        *first++ = '.';
+        for (int i = digit_count - 1; i >= 0; --i)
+            *first++ = "0123456789abcdef"[(frac >> (4 * i)) & 0xf];
+        memset(first, '0', precision - digit_count);
+        first += precision - digit_count;
+    }
+    *first++ = 'p';
+    *first++ = exponent < 0 ? '-' : '+';
+    return {__itoa::__u32toa(e, first), errc()};
+}
+
+template <class T>
+to_chars_result
+to_chars_hex(char* first, char* last, T value, int precision)
+{
+    typedef traits<T> tr;
+    typename tr::bits_type bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const bool negative =
+        (bits >> (tr::mantissa_bits + tr::exponent_bits)) != 0;
+    const uint32_t ieee_exponent = static_cast<uint32_t>(
+        (bits >> tr::mantissa_bits) & ((1u << tr::exponent_bits) - 1));
+    uint64_t frac =
+        bits & ((typename tr::bits_type(1) << tr::mantissa_bits) - 1);
+    frac <<= 4 * tr::hex_digits - tr::mantissa_bits;
+    if (ieee_exponent == 0)
+        return write_hex(first, last, negative, 0, frac, tr::hex_digits,
+                         frac == 0 ? 0 : 1 - tr::bias, precision);
+    return write_hex(first, last, negative, 1, frac, tr::hex_digits,
+                     static_cast<int>(ieee_exponent) - tr::bias, precision);
+}
+
+// fmt == chars_format() selects the plain overload, which picks the shorter
+// of fixed and scientific notation and prefers fixed on a tie.
+template <class T>
+to_chars_result
+to_chars_shortest(char* first, char* last, T value, chars_format fmt)
+{
+    if (!_VSTD::isfinite(value))
+        return write_special(first, last, value);
+    if (fmt == chars_format::hex)
+        return to_chars_hex(first, last, value, -1);
+
+    typedef traits<T> tr;
+    typename tr::bits_type bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const bool negative =
+        (bits >> (tr::mantissa_bits + tr::exponent_bits)) != 0;
+    const uint32_t ieee_exponent = static_cast<uint32_t>(
+        (bits >> tr::mantissa_bits) & ((1u << tr::exponent_bits) - 1));
+    const typename tr::bits_type ieee_mantissa =
+        bits & ((typename tr::bits_type(1) << tr::mantissa_bits) - 1);
+
+    digits d;
+    if (ieee_exponent == 0 && ieee_mantissa == 0)
+    {
+        d.buf[0] = '0';
+        d.count = 1;
+        d.exponent = 0;
+    }
+    else
+        to_digits(tr::shortest(ieee_mantissa, ieee_exponent), d);
+
+    if (fmt == chars_format())
+        fmt = fixed_length(d) <= scientific_length(d)
+                  ? chars_format::fixed
+                  : chars_format::scientific;
+    else if (fmt == chars_format::general)
+        // As %g with its default precision of 6.
+        fmt = -4 <= d.exponent && d.exponent < 6 ? chars_format::fixed
+                                                 : chars_format::scientific;
+
+    if (fmt == chars_format::scientific)
+        return write_scientific(first, last, negative, d);
+    if (d.exponent >= d.count)
+        return write_integer(first, last, negative,
+                             _VSTD::fabs(static_cast<double>(value)));
+    return write_fixed(first, last, negative, d);
+}
+
+template <class T>
+to_chars_result
+to_chars_precision(char* first, char* last, T value, chars_format fmt,
+                   int precision)
+{
+    if (!_VSTD::isfinite(value))
+        return write_special(first, last, value);
+    if (precision < 0)
+        precision = 6;
+    if (fmt == chars_format::hex)
+        return to_chars_hex(first, last, value, precision);
+    const char* format = fmt == chars_format::fixed        ? "%.*f"
+                         : fmt == chars_format::scientific ? "%.*e"
+                                                           : "%.*g";
+    return write_printf(first, last, format, precision,
+                        static_cast<double>(value));
+}
+
+// long double goes through the double code when the two share a format and
+// through printf otherwise, searching for the shortest precision that
+// reads back as the same value.
+struct long_double_is_double
+    : integral_constant<bool, LDBL_MANT_DIG == DBL_MANT_DIG &&
+                                  LDBL_MAX_EXP == DBL_MAX_EXP>
+{
+};
+
+to_chars_result
+to_chars_shortest(char* first, char* last, long double value,
+                  chars_format fmt)
+{
+    if (long_double_is_double::value)
+        return to_chars_shortest(first, last, static_cast<double>(value), fmt);
+    if (!_VSTD::isfinite(value))
+        return write_special(first, last, value);
+    if (fmt == chars_format::hex)
+        return write_printf(first, last, "%La", -1, value);
+
+    const bool negative = _VSTD::signbit(value);
+    const long double magnitude = _VSTD::fabs(value);
+    digits d;
+    if (magnitude == 0)
+    {
+        d.buf[0] = '0';
+        d.count = 1;
+        d.exponent = 0;
+    }
+    else
+    {
+        // Round-tripping is monotonic in the precision, so binary search it.
+        char buf[64];
+        int lo = 0, hi = LDBL_DIG + 3;
+        while (lo < hi)
+        {
+            const int mid = (lo + hi) / 2;
+            __libcpp_snprintf_l(buf, sizeof(buf), _LIBCPP_GET_C_LOCALE,
+                                "%.*Le", mid, magnitude);
+            if (strtold_l(buf, nullptr, _LIBCPP_GET_C_LOCALE) == magnitude)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        __libcpp_snprintf_l(buf, sizeof(buf), _LIBCPP_GET_C_LOCALE, "%.*Le",
+                            lo, magnitude);
+        // buf is "d.ddde[+-]xx", or "de[+-]xx" when lo == 0.
+        const char* p = buf;
+        d.count = 0;
+        for (; *p != 'e'; ++p)
+            if (*p != '.')
+                d.buf[d.count++] = *p;
+        d.exponent = atoi(p + 1);
+    }
+
+    if (fmt == chars_format())
+        fmt = fixed_length(d) <= scientific_length(d)
+                  ? chars_format::fixed
+                  : chars_format::scientific;
+    else if (fmt == chars_format::general)
+        fmt = -4 <= d.exponent && d.exponent < 6 ? chars_format::fixed
+                                                 : chars_format::scientific;
+
+    if (fmt == chars_format::scientific)
+        return write_scientific(first, last, negative, d);
+    if (d.exponent >= d.count)
+        return write_printf(first, last, "%.0Lf", -1, value);
+    return write_fixed(first, last, negative, d);
+}
+
+to_chars_result
+to_chars_precision(char* first, char* last, long double value,
+                   chars_format fmt, int precision)
+{
+    if (long_double_is_double::value)
+        return to_chars_precision(first, last, static_cast<double>(value), fmt,
+                                  precision);
+    if (!_VSTD::isfinite(value))
+        return write_special(first, last, value);
+    if (precision < 0)
+        precision = 6;
+    const char* format = fmt == chars_format::fixed        ? "%.*Lf"
+                         : fmt == chars_format::scientific ? "%.*Le"
+                         : fmt == chars_format::general    ? "%.*Lg"
+                                                           : "%.*La";
+    return write_printf(first, last, format, precision, value);
+}
+
+inline bool
+is_decimal_digit(char c)
+{
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+inline bool
+is_hex_digit(char c)
+{
+    return is_decimal_digit(c) ||
+           static_cast<unsigned char>((c | 0x20) - 'a') < 6;
+}
+
+// Matches the lower case word at [p, last), ignoring case.
+inline bool
+match_word(const char* p, const char* last, const char* word)
+{
+    for (; *word != '\0'; ++p, ++word)
+        if (p == last || (*p | 0x20) != *word)
+            return false;
+    return true;
+}
+
+template <class T>
+from_chars_result
+from_chars_special(const char* first, const char* p, const char* last,
+                   bool negative, T& value)
+{
+    if (match_word(p, last, "inf"))
+    {
+        p += 3;
+        if (match_word(p, last, "inity"))
+            p += 5;
+        value = negative ? -numeric_limits<T>::infinity()
+                         : numeric_limits<T>::infinity();
+        return {p, errc()};
+    }
+    if (match_word(p, last, "nan"))
+    {
+        p += 3;
+        if (p != last && *p == '(')
+        {
+            const char* q = p + 1;
+            while (q != last &&
+                   (is_decimal_digit(*q) || *q == '_' ||
+                    static_cast<unsigned char>((*q | 0x20) - 'a') < 26))
+                ++q;
+            if (q != last && *q == ')')
+                p = q + 1;
+        }
+        value = negative ? -numeric_limits<T>::quiet_NaN()
+                         : numeric_limits<T>::quiet_NaN();
+        return {p, errc()};
+    }
+    return {first, errc::invalid_argument};
+}
+
+// m * 10^e computed with a single rounding (Clinger's fast path) when m and
+// 10^e are both exact; false otherwise. It needs arithmetic in the precision
+// of the type, without the excess precision of an x87 FPU.
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+inline bool
+fast_path(uint64_t m, long e, double& value)
+{
+    static const double pow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    if (m > (uint64_t(1) << 53) || e < -22 || e > 22)
+        return false;
+    value = e < 0 ? static_cast<double>(m) / pow10[-e]
+                  : static_cast<double>(m) * pow10[e];
+    return true;
+}
+
+inline bool
+fast_path(uint64_t m, long e, float& value)
+{
+    static const float pow10[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+                                  1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+    if (m > (uint64_t(1) << 24) || e < -10 || e > 10)
+        return false;
+    value = e < 0 ? static_cast<float>(m) / pow10[-e]
+                  : static_cast<float>(m) * pow10[e];
+    return true;
+}
+#else
+template <class T>
+inline bool
+fast_path(uint64_t, long, T&)
+{
+    return false;
+}
+#endif
+
+inline bool
+fast_path(uint64_t, long, long double&)
+{
+    return false;
+}
+
+// The Eisel-Lemire conversion of m * 10^q (m != 0) to the nearest binary
+// value, using a 128-bit approximation of 5^q. Returns false when the
+// approximation cannot decide the rounding; the caller then falls back to
+// strtod. Sets out_of_range instead of value on overflow and underflow.
+inline void
+full_multiply(uint64_t a, uint64_t b, uint64_t& lo, uint64_t& hi)
+{
+#ifndef _LIBCPP_HAS_NO_INT128
+    const __uint128_t r = static_cast<__uint128_t>(a) * b;
+    lo = static_cast<uint64_t>(r);
+    hi = static_cast<uint64_t>(r >> 64);
+#else
+    const uint64_t a_lo = a & 0xffffffff, a_hi = a >> 32;
+    const uint64_t b_lo = b & 0xffffffff, b_hi = b >> 32;
+    const uint64_t b00 = a_lo * b_lo, b01 = a_lo * b_hi;
+    const uint64_t b10 = a_hi * b_lo, b11 = a_hi * b_hi;
+    const uint64_t mid1 = b10 + (b00 >> 32);
+    const uint64_t mid2 = b01 + (mid1 & 0xffffffff);
+    lo = (mid2 << 32) | (b00 & 0xffffffff);
+    hi = b11 + (mid1 >> 32) + (mid2 >> 32);
+#endif
+}
+
+template <class T>
+bool
+eisel_lemire(uint64_t m, long q, T& value, bool& out_of_range)
+{
+    typedef traits<T> fmt;
+    out_of_range = false;
+    if (q < fmt::smallest_power || q > fmt::largest_power)
+    {
+        out_of_range = true;
+        return true;
+    }
+    const int lz = __builtin_clzll(m);
+    m <<= lz;
+
+    const uint64_t* pow5 = __pow5_128[q + 342];
+    uint64_t lo, hi;
+    full_multiply(m, pow5[0], lo, hi);
+    // Only refine with the low half of 5^q when the bits below the rounding
+    // position are all ones.
+    const uint64_t precision_mask = ~uint64_t(0) >> (fmt::mantissa_bits + 3);
+    if ((hi & precision_mask) == precision_mask)
+    {
+        uint64_t lo2, hi2;
+        full_multiply(m, pow5[1], lo2, hi2);
+        lo += hi2;
+        hi += lo < hi2;
+    }
+    if (lo == ~uint64_t(0) && (q < -27 || q > 55))
+        return false;
+
+    const int upper_bit = static_cast<int>(hi >> 63);
+    const int shift = upper_bit + 64 - fmt::mantissa_bits - 3;
+    uint64_t mantissa = hi >> shift;
+    // floor(log2(10^q)) + 63, then normalized by the shifts above.
+    int power2 =
+        static_cast<int>(((152170 + 65536) * static_cast<int32_t>(q)) >> 16) +
+        63 + upper_bit - lz + fmt::bias;
+    if (power2 <= 0)
+    {
+        // Subnormal, or zero after rounding.
+        if (-power2 + 1 >= 64)
+        {
+            out_of_range = true;
+            return true;
+        }
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        power2 = mantissa < (uint64_t(1) << fmt::mantissa_bits) ? 0 : 1;
+        if (mantissa == 0)
+        {
+            out_of_range = true;
+            return true;
+        }
+    }
+    else
+    {
+        // An exact product halfway between two values rounds to even.
+        if (lo <= 1 && q >= fmt::min_round_to_even &&
+            q <= fmt::max_round_to_even && (mantissa & 3) == 1 &&
+            (mantissa << shift) == hi)
+            mantissa &= ~uint64_t(1);
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        if (mantissa >= (uint64_t(2) << fmt::mantissa_bits))
+        {
+            mantissa = uint64_t(1) << fmt::mantissa_bits;
+            ++power2;
+        }
+        mantissa &= ~(uint64_t(1) << fmt::mantissa_bits);
+        if (power2 >= (1 << fmt::exponent_bits) - 1)
+        {
+            out_of_range = true;
+            return true;
+        }
+    }
+    const typename fmt::bits_type bits = static_cast<typename fmt::bits_type>(
+        mantissa | (uint64_t(power2) << fmt::mantissa_bits));
+    memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+inline bool
+eisel_lemire(uint64_t, long, long double&, bool&)
+{
+    return false;
+}
+
+inline float
+strto(const char* s, float*)
+{
+    return strtof_l(s, nullptr, _LIBCPP_GET_C_LOCALE);
+}
+
+inline double
+strto(const char* s, double*)
+{
+    return strtod_l(s, nullptr, _LIBCPP_GET_C_LOCALE);
+}
+
+inline long double
+strto(const char* s, long double*)
+{
+    return strtold_l(s, nullptr, _LIBCPP_GET_C_LOCALE);
+}
+
+// Matches the pattern of strtod in the "C" locale, minus the leading
+// whitespace, the plus sign and the "0x" of hex input, with an exponent
+// required by scientific and not recognized by fixed. Short decimal inputs
+// are converted in place, up to 19 significant digits with Eisel-Lemire;
+// the rest goes to strtod on a terminated copy.
+template <class T>
+from_chars_result
+from_chars_floating(const char* first, const char* last, T& value,
+                    chars_format fmt)
+{
+    const char* p = first;
+    const bool negative = p != last && *p == '-';
+    if (negative)
+        ++p;
+    if (p != last && ((*p | 0x20) == 'i' || (*p | 0x20) == 'n'))
+        return from_chars_special(first, p, last, negative, value);
+
+    const bool hex = (fmt & chars_format::hex) == chars_format::hex;
+    const char* const number = p;
+    bool any_digit = false;
+    bool seen_point = false;
+    // The first 19 significant decimal digits, and whether any nonzero digit
+    // followed them.
+    uint64_t mantissa = 0;
+    int significant = 0;
+    bool truncated = false;
+    long exponent = 0;
+    for (; p != last; ++p)
+    {
+        if (*p == '.' && !seen_point)
+        {
+            seen_point = true;
+            continue;
+        }
+        if (hex ? !is_hex_digit(*p) : !is_decimal_digit(*p))
+            break;
+        any_digit = true;
+        if (hex)
+            continue;
+        const unsigned d = static_cast<unsigned>(*p - '0');
+        if (significant < 19 && (d != 0 || significant != 0))
+        {
+            mantissa = mantissa * 10 + d;
+            ++significant;
+            exponent -= seen_point;
+        }
+        else if (significant < 19)
+            exponent -= seen_point;
+        else
+        {
+            truncated |= d != 0;
+            exponent += !seen_point;
+        }
+    }
+    if (!any_digit)
+        return {first, errc::invalid_argument};
+
+    const char* end = p;
+    bool has_exponent = false;
+    if (hex || (fmt & chars_format::scientific) == chars_format::scientific)
+    {
+        if (p != last && (*p | 0x20) == (hex ? 'p' : 'e'))
+        {
+            const char* q = p + 1;
+            const bool exponent_negative = q != last && *q == '-';
+            if (q != last && (*q == '+' || *q == '-'))
+                ++q;
+            if (q != last && is_decimal_digit(*q))
+            {
+                long e = 0;
+                for (; q != last && is_decimal_digit(*q); ++q)
+                    if (e < 100000)
+                        e = e * 10 + (*q - '0');
+                exponent += exponent_negative ? -e : e;
+                has_exponent = true;
+                end = q;
+            }
+        }
+    }
+    if (fmt == chars_format::scientific && !has_exponent)
+        return {first, errc::invalid_argument};
+
+    if (!hex && !truncated)
+    {
+        if (mantissa == 0)
+        {
+            value = negative ? -T(0) : T(0);
+            return {end, errc()};
+        }
+        T r;
+        bool out_of_range;
+        if (fast_path(mantissa, exponent, r))
+        {
+            value = negative ? -r : r;
+            return {end, errc()};
+        }
+        if (eisel_lemire(mantissa, exponent, r, out_of_range))
+        {
+            if (out_of_range)
+                return {end, errc::result_out_of_range};
+            value = negative ? -r : r;
+            return {end, errc()};
+        }
+    }
+
+    char stack[128];
+    unique_ptr<char[]> heap;
+    char* buf = stack;
+    const size_t size = static_cast<size_t>(end - number) + 4;
+    if (size > sizeof(stack))
+    {
+        heap.reset(new char[size]);
+        buf = heap.get();
+    }
+    char* out = buf;
+    if (negative)
+        *out++ = '-';
+    if (hex)
+    {
+        *out++ = '0';
+        *out++ = 'x';
+    }
+    memcpy(out, number, end - number);
+    out[end - number] = '\0';
+    const int saved_errno = errno;
+    errno = 0;
+    const T r = strto(buf, static_cast<T*>(nullptr));
+    const bool range_error = errno == ERANGE;
+    errno = saved_errno;
+    // Underflow to a subnormal is still in range.
+    if (range_error && (r == 0 || _VSTD::isinf(r)))
+        return {end, errc::result_out_of_range};
+    value = r;
+    return {end, errc()};
+}
+
+}  // namespace __ryu
+
+to_chars_result
+to_chars(char* first, char* last, float value)
+{
+    return __ryu::to_chars_shortest(first, last, value, chars_format());
+}
+
+to_chars_result
+to_chars(char* first, char* last, double value)
+{
+    return __ryu::to_chars_shortest(first, last, value, chars_format());
+}
+
+to_chars_result
+to_chars(char* first, char* last, long double value)
+{
+    return __ryu::to_chars_shortest(first, last, value, chars_format());
+}
+
+to_chars_result
+to_chars(char* first, char* last, float value, chars_format fmt)
+{
+    return __ryu::to_chars_shortest(first, last, value, fmt);
+}
+
+to_chars_result
+to_chars(char* first, char* last, double value, chars_format fmt)
+{
+    return __ryu::to_chars_shortest(first, last, value, fmt);
+}
+
+to_chars_result
+to_chars(char* first, char* last, long double value, chars_format fmt)
+{
+    return __ryu::to_chars_shortest(first, last, value, fmt);
+}
+
+to_chars_result
+to_chars(char* first, char* last, float value, chars_format fmt,
+         int precision)
+{
+    return __ryu::to_chars_precision(first, last, value, fmt, precision);
+}
+
+to_chars_result
+to_chars(char* first, char* last, double value, chars_format fmt,
+         int precision)
+{
+    return __ryu::to_chars_precision(first, last, value, fmt, precision);
+}
+
+to_chars_result
+to_chars(char* first, char* last, long double value, chars_format fmt,
+         int precision)
+{
+    return __ryu::to_chars_precision(first, last, value, fmt, precision);
+}
+
+from_chars_result
+from_chars(const char* first, const char* last, float& value,
+           chars_format fmt)
+{
+    return __ryu::from_chars_floating(first, last, value, fmt);
+}
+
+from_chars_result
+from_chars(const char* first, const char* last, double& value,
+           chars_format fmt)
+{
+    return __ryu::from_chars_floating(first, last, value, fmt);
+}
+
+from_chars_result
+from_chars(const char* first, const char* last, long double& value,
+           chars_format fmt)
+{
+    return __ryu::from_chars_floating(first, last, value, fmt);
+}
+
 _LIBCPP_END_NAMESPACE_STD
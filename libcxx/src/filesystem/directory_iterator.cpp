@@ -13,6 +13,9 @@
 #include <Windows.h>
 #else
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 #include <errno.h>
 
@@ -71,6 +74,33 @@ static pair<string_view, file_type> posix_readdir(DIR* dir_stream,
     return {dir_entry_ptr->d_name, get_file_type(dir_entry_ptr, 0)};
   }
 }
+
+// Used when readdir didn't report a type. The entry is named relative to the
+// directory being read, so the rest of its path isn't resolved again.
+static file_type posix_fstatat_type(int dir_fd, const char* name,
+                                    error_code& ec) {
+  struct ::stat st;
+  if (::fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) == -1) {
+    ec = capture_errno();
+    return file_type::none;
+  }
+  ec.clear();
+  if (S_ISLNK(st.st_mode))
+    return file_type::symlink;
+  if (S_ISDIR(st.st_mode))
+    return file_type::directory;
+  if (S_ISREG(st.st_mode))
+    return file_type::regular;
+  if (S_ISBLK(st.st_mode))
+    return file_type::block;
+  if (S_ISCHR(st.st_mode))
+    return file_type::character;
+  if (S_ISFIFO(st.st_mode))
+    return file_type::fifo;
+  if (S_ISSOCK(st.st_mode))
+    return file_type::socket;
+  return file_type::unknown;
+}
 #else
 
 static file_type get_file_type(const WIN32_FIND_DATA& data) {
@@ -171,6 +201,7 @@ public:
   __dir_stream& operator=(const __dir_stream&) = delete;
 
   __dir_stream(__dir_stream&& other) noexcept : __stream_(other.__stream_),
+                                                __name_size_(other.__name_size_),
                                                 __root_(move(other.__root_)),
                                                 __entry_(move(other.__entry_)) {
     other.__stream_ = nullptr;
@@ -179,11 +210,26 @@ public:
   __dir_stream(const path& root, directory_options opts, error_code& ec)
       : __stream_(nullptr), __root_(root) {
     if ((__stream_ = ::opendir(root.c_str())) == nullptr) {
-      ec = detail::capture_errno();
-      const bool allow_eacess =
-          bool(opts & directory_options::skip_permission_denied);
-      if (allow_eacess && ec.value() == EACCES)
-        ec.clear();
+      open_failed(opts, ec);
+      return;
+    }
+    advance(ec);
+  }
+
+  // Opens the directory named by the current entry of parent relative to
+  // parent's descriptor, rather than looking up its whole path again.
+  __dir_stream(const __dir_stream& parent, directory_options opts,
+               error_code& ec)
+      : __stream_(nullptr), __root_(parent.__entry_.__p_) {
+    int fd = ::openat(::dirfd(parent.__stream_), parent.entry_name(),
+                      O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1) {
+      open_failed(opts, ec);
+      return;
+    }
+    if ((__stream_ = ::fdopendir(fd)) == nullptr) {
+      open_failed(opts, ec);
+      ::close(fd);
       return;
     }
     advance(ec);
@@ -206,15 +252,43 @@ public:
         close();
         return false;
       } else {
-        __entry_.__assign_iter_entry(
-            __root_ / str,
-            directory_entry::__create_iter_result(str_type_pair.second));
+        // Build the path in place, so that its buffer is reused from one
+        // entry to the next.
+        __entry_.__p_ = __root_;
+        __entry_.__p_ /= str;
+        __entry_.__data_ =
+            directory_entry::__create_iter_result(str_type_pair.second);
+        __name_size_ = str.size();
         return true;
       }
     }
   }
 
+  // Fills in the type of the current entry if readdir didn't report it.
+  void resolve_entry_type() {
+    if (__entry_.__data_.__cache_type_ != directory_entry::_Empty)
+      return;
+    error_code m_ec;
+    file_type ft =
+        detail::posix_fstatat_type(::dirfd(__stream_), entry_name(), m_ec);
+    if (!m_ec)
+      __entry_.__data_ = directory_entry::__create_iter_result(ft);
+  }
+
 private:
+  const char* entry_name() const {
+    const string& p = __entry_.__p_.native();
+    return p.c_str() + (p.size() - __name_size_);
+  }
+
+  void open_failed(directory_options opts, error_code& ec) {
+    ec = detail::capture_errno();
+    const bool allow_eacess =
+        bool(opts & directory_options::skip_permission_denied);
+    if (allow_eacess && ec.value() == EACCES)
+      ec.clear();
+  }
+
   error_code close() noexcept {
     error_code m_ec;
     if (::closedir(__stream_) == -1)
@@ -224,6 +298,7 @@ private:
   }
 
   DIR* __stream_{nullptr};
+  size_t __name_size_{0};
 
 public:
   path __root_;
@@ -356,6 +431,9 @@ bool recursive_directory_iterator::__try_recursion(error_code* ec) {
   bool rec_sym = bool(options() & directory_options::follow_directory_symlink);
 
   auto& curr_it = __imp_->__stack_.top();
+#if !defined(_LIBCPP_WIN32API)
+  curr_it.resolve_entry_type();
+#endif
 
   bool skip_rec = false;
   error_code m_ec;
@@ -374,7 +452,11 @@ bool recursive_directory_iterator::__try_recursion(error_code* ec) {
   }
 
   if (!skip_rec) {
+#if defined(_LIBCPP_WIN32API)
     __dir_stream new_it(curr_it.__entry_.path(), __imp_->__options_, m_ec);
+#else
+    __dir_stream new_it(curr_it, __imp_->__options_, m_ec);
+#endif
     if (new_it.good()) {
       __imp_->__stack_.push(move(new_it));
       return true;
@@ -0,0 +1,107 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+
+// <algorithm>
+
+// std::sort does O(N log N) comparisons even on inputs built to defeat its
+// pivot selection (McIlroy, "A Killer Adversary for Quicksort"), and sorts
+// correctly through both its branchless and its generic partitioning.
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "test_macros.h"
+
+struct Adversary {
+    std::vector<std::size_t>* values;
+    std::size_t gas;
+    std::size_t* solid;
+    std::size_t* candidate;
+    long* comparisons;
+
+    bool operator()(std::size_t x, std::size_t y) const {
+        std::vector<std::size_t>& v = *values;
+        ++*comparisons;
+        if (v[x] == gas && v[y] == gas) {
+            if (x == *candidate)
+                v[x] = (*solid)++;
+            else
+                v[y] = (*solid)++;
+        }
+        if (v[x] == gas)
+            *candidate = x;
+        else if (v[y] == gas)
+            *candidate = y;
+        return v[x] < v[y];
+    }
+};
+
+void test_adversary(std::size_t n) {
+    std::vector<std::size_t> values(n, n);
+    std::vector<std::size_t> indices(n);
+    for (std::size_t i = 0; i < n; ++i)
+        indices[i] = i;
+    std::size_t solid = 0;
+    std::size_t candidate = 0;
+    long comparisons = 0;
+    Adversary adv = {&values, n, &solid, &candidate, &comparisons};
+    std::sort(indices.begin(), indices.end(), adv);
+    long log2n = 0;
+    for (std::size_t m = n; m > 1; m >>= 1)
+        ++log2n;
+    assert(comparisons <= 8 * static_cast<long>(n) * log2n);
+    for (std::size_t i = 1; i < n; ++i)
+        assert(values[indices[i - 1]] < values[indices[i]]);
+}
+
+template <class T, class Compare>
+void test_pattern(std::size_t n, Compare comp) {
+    std::vector<T> patterns[5];
+    for (std::size_t i = 0; i < n; ++i) {
+        patterns[0].push_back(T((i * 2654435761u) % 1000003));
+        patterns[1].push_back(T(i < n / 2 ? i : n - i));
+        patterns[2].push_back(T(i % 3));
+        patterns[3].push_back(T(n - i));
+        patterns[4].push_back(T(i % 64 == 0 ? n - i : i));
+    }
+    for (std::vector<T>& v : patterns) {
+        std::vector<T> expected = v;
+        std::stable_sort(expected.begin(), expected.end(), comp);
+        std::sort(v.begin(), v.end(), comp);
+        assert(v == expected);
+    }
+}
+
+struct Wrapped {
+    long value;
+    Wrapped(long v = 0) : value(v) {}
+    bool operator<(const Wrapped& other) const { return value < other.value; }
+    bool operator==(const Wrapped& other) const { return value == other.value; }
+};
+
+int main(int, char**) {
+    test_adversary(1000);
+    test_adversary(50000);
+
+    const std::size_t sizes[] = {0, 1, 7, 64, 129, 1000, 10000};
+    for (std::size_t n : sizes) {
+        test_pattern<int>(n, std::less<int>());
+        test_pattern<int>(n, std::greater<int>());
+        test_pattern<unsigned char>(n, std::less<unsigned char>());
+        test_pattern<double>(n, std::less<double>());
+        test_pattern<long>(n, [](long a, long b) { return a < b; });
+        test_pattern<Wrapped>(n, std::less<Wrapped>());
+    }
+
+  return 0;
+}
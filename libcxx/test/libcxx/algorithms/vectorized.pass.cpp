@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <algorithm>
+
+// find, count and mismatch compare contiguous ranges of integers and pointers
+// a vector at a time.  Check every length and alignment around the vector
+// size against the obvious loops.
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "test_macros.h"
+
+template <class T>
+void test() {
+  std::vector<T> buf(200);
+  for (int len = 0; len < 150; ++len) {
+    for (int off = 0; off < 8; ++off) {
+      T* first = buf.data() + off;
+      T* last = first + len;
+      for (int i = 0; i < len; ++i)
+        first[i] = T(i % 7 + 1);
+      for (int v = 0; v < 9; ++v) {
+        T* found = first;
+        std::ptrdiff_t count = 0;
+        for (T* p = first; p != last; ++p) {
+          if (found == p && !(*p == T(v)))
+            ++found;
+          count += *p == T(v);
+        }
+        assert(std::find(first, last, T(v)) == found);
+        const T* cfirst = first;
+        assert(std::find(cfirst, cfirst + len, v) == found);
+        assert(std::count(first, last, T(v)) == count);
+      }
+      std::vector<T> a(first, last);
+      for (int j = 0; j <= len; ++j) {
+        std::vector<T> b = a;
+        if (j < len)
+          b[j] = T(100);
+        assert(std::mismatch(a.begin(), a.end(), b.begin()).first - a.begin() == j);
+#if TEST_STD_VER > 11
+        assert(std::mismatch(a.begin(), a.end(), b.begin(), b.end()).second - b.begin() == j);
+        if (j < len)
+          assert(std::mismatch(a.begin(), a.end(), b.begin(), b.begin() + j).first - a.begin() == j);
+#endif
+      }
+    }
+  }
+}
+
+int main(int, char**) {
+  test<char>();
+  test<signed char>();
+  test<unsigned short>();
+  test<int>();
+  test<long long>();
+  test<wchar_t>();
+#ifndef _LIBCPP_HAS_NO_UNICODE_CHARS
+  test<char16_t>();
+  test<char32_t>();
+#endif
+
+  // A value that doesn't fit the element type is never found.
+  {
+    std::vector<unsigned char> v(100, 3);
+    assert(std::find(v.begin(), v.end(), 259) == v.end());
+    assert(std::count(v.begin(), v.end(), 259) == 0);
+    std::vector<signed char> s(100, -1);
+    assert(std::find(s.begin(), s.end(), -1) == s.begin());
+    assert(std::count(s.begin(), s.end(), 255) == 0);
+  }
+  // Per-lane counts are added up before they overflow.
+  {
+    std::vector<char> v(100000, 'x');
+    assert(std::count(v.begin(), v.end(), 'x') == 100000);
+  }
+  {
+    int x = 0;
+    int* p[] = {nullptr, nullptr, &x, nullptr, &x};
+    assert(std::find(p, p + 5, &x) == p + 2);
+    assert(std::count(p, p + 5, nullptr) == 3);
+  }
+#ifndef _LIBCPP_HAS_NO_UNICODE_CHARS
+  {
+    std::u16string s(100, u'a');
+    std::u16string t = s;
+    t[70] = u'\xff00';
+    assert(s.compare(t) < 0 && t.compare(s) > 0);
+    assert(t.find(u'\xff00') == 70);
+    std::u32string u(100, U'a');
+    u[99] = U'\x10000';
+    assert(u.find(U'\x10000') == 99);
+    assert(u.compare(std::u32string(100, U'a')) > 0);
+  }
+#endif
+
+  return 0;
+}
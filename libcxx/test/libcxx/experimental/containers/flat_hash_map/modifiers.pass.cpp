@@ -0,0 +1,201 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// UNSUPPORTED: c++98, c++03
+
+// <experimental/flat_hash_map>
+
+// Insertion, lookup and erasure, including keys that collide in H2 and
+// tables that fill up with deleted markers.
+
+#include <experimental/flat_hash_map>
+#include <cassert>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "test_macros.h"
+#include "min_allocator.h"
+
+struct BadHash
+{
+    std::size_t operator()(int x) const { return x % 4; }
+};
+
+template <class Map>
+void test_basic()
+{
+    Map m;
+    assert(m.empty());
+    assert(m.bucket_count() == 0);
+    assert(m.find(1) == m.end());
+    assert(m.erase(1) == 0);
+
+    auto r = m.insert({1, 10});
+    assert(r.second);
+    assert(r.first->first == 1 && r.first->second == 10);
+    r = m.insert({1, 11});
+    assert(!r.second);
+    assert(r.first->second == 10);
+    assert(m.size() == 1);
+
+    m[2] = 20;
+    assert(m.at(2) == 20);
+    assert(m.count(2) == 1);
+    assert(m.contains(2));
+    assert(!m.contains(3));
+
+    r = m.insert_or_assign(2, 21);
+    assert(!r.second);
+    assert(m[2] == 21);
+    r = m.try_emplace(3, 30);
+    assert(r.second);
+    r = m.try_emplace(3, 31);
+    assert(!r.second && r.first->second == 30);
+    r = m.emplace(4, 40);
+    assert(r.second);
+    assert(m.size() == 4);
+
+    auto er = m.equal_range(4);
+    assert(er.first != er.second && er.first->second == 40);
+    er = m.equal_range(5);
+    assert(er.first == er.second);
+
+    assert(m.erase(2) == 1);
+    assert(m.erase(2) == 0);
+    assert(m.size() == 3);
+    assert(m.find(2) == m.end());
+
+#ifndef TEST_HAS_NO_EXCEPTIONS
+    try {
+        (void)m.at(2);
+        assert(false);
+    } catch (const std::out_of_range&) {
+    }
+#endif
+
+    int sum = 0;
+    for (auto& kv : m)
+        sum += kv.second;
+    assert(sum == 10 + 30 + 40);
+
+    m.clear();
+    assert(m.empty());
+    assert(m.begin() == m.end());
+    assert(m.bucket_count() != 0);
+}
+
+void test_grow_and_erase()
+{
+    std::experimental::flat_hash_map<int, int> m;
+    for (int i = 0; i < 10000; ++i)
+        m[i] = -i;
+    assert(m.size() == 10000);
+    assert(m.load_factor() <= m.max_load_factor());
+    for (int i = 0; i < 10000; ++i)
+        assert(m.at(i) == -i);
+    for (int i = 0; i < 10000; i += 2)
+        assert(m.erase(i) == 1);
+    assert(m.size() == 5000);
+    for (int i = 0; i < 10000; ++i)
+        assert(m.count(i) == (i % 2 ? 1u : 0u));
+
+    // Erasing through iterators visits each element once.
+    std::size_t n = 0;
+    for (auto it = m.begin(); it != m.end();) {
+        assert(it->first % 2 == 1);
+        it = m.erase(it);
+        ++n;
+    }
+    assert(n == 5000);
+    assert(m.empty());
+}
+
+void test_churn()
+{
+    // Inserting and erasing at a constant size leaves deleted markers
+    // behind; they must be reclaimed without growing the table forever.
+    std::experimental::flat_hash_map<int, int> m;
+    for (int i = 0; i < 100; ++i)
+        m[i] = i;
+    for (int i = 100; i < 100000; ++i) {
+        m[i] = i;
+        assert(m.erase(i - 100) == 1);
+    }
+    assert(m.size() == 100);
+    assert(m.bucket_count() <= 512);
+    for (int i = 99900; i < 100000; ++i)
+        assert(m.at(i) == i);
+}
+
+void test_collisions()
+{
+    std::experimental::flat_hash_map<int, int, BadHash> m;
+    for (int i = 0; i < 500; ++i)
+        assert(m.emplace(i, i).second);
+    for (int i = 0; i < 500; ++i)
+        assert(m.at(i) == i);
+    for (int i = 0; i < 500; i += 3)
+        m.erase(i);
+    for (int i = 0; i < 500; ++i)
+        assert(m.count(i) == (i % 3 ? 1u : 0u));
+}
+
+void test_move_only()
+{
+    std::experimental::flat_hash_map<std::string, std::unique_ptr<int> > m;
+    for (int i = 0; i < 1000; ++i)
+        m.try_emplace(std::to_string(i), new int(i));
+    for (int i = 0; i < 1000; ++i)
+        assert(*m.at(std::to_string(i)) == i);
+    auto m2 = std::move(m);
+    assert(m.empty());
+    assert(m2.size() == 1000);
+    m2.erase(m2.begin(), m2.end());
+    assert(m2.empty());
+}
+
+void test_copy()
+{
+    typedef std::experimental::flat_hash_map<int, std::string> Map;
+    Map a = {{1, "one"}, {2, "two"}, {3, "three"}};
+    Map b = a;
+    assert(a == b);
+    b[4] = "four";
+    assert(a != b);
+    b.erase(4);
+    assert(a == b);
+    b[3] = "drei";
+    assert(a != b);
+    b = a;
+    assert(a == b);
+    Map c;
+    swap(b, c);
+    assert(b.empty());
+    assert(a == c);
+    c.rehash(1000);
+    assert(c.bucket_count() >= 1000);
+    assert(a == c);
+    c.reserve(10000);
+    assert(c.bucket_count() * 7 / 8 >= 10000);
+    assert(a == c);
+}
+
+int main(int, char**)
+{
+    test_basic<std::experimental::flat_hash_map<int, int> >();
+    test_basic<std::experimental::flat_hash_map<int, int, std::hash<int>,
+        std::equal_to<int>, min_allocator<std::pair<const int, int> > > >();
+    test_grow_and_erase();
+    test_churn();
+    test_collisions();
+    test_move_only();
+    test_copy();
+
+  return 0;
+}
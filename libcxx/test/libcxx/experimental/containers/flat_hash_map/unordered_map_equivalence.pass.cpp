@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// UNSUPPORTED: c++98, c++03
+
+// <experimental/flat_hash_map>
+
+// A random sequence of operations gives the same results as on an
+// unordered_map.
+
+#include <experimental/flat_hash_map>
+#include <cassert>
+#include <cstdint>
+#include <unordered_map>
+
+#include "test_macros.h"
+
+int main(int, char**)
+{
+    std::experimental::flat_hash_map<std::uint32_t, std::uint32_t> m;
+    std::unordered_map<std::uint32_t, std::uint32_t> ref;
+    std::uint64_t state = 1;
+    for (int i = 0; i < 200000; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        std::uint32_t r = static_cast<std::uint32_t>(state >> 33);
+        std::uint32_t key = r % 4096;
+        switch ((r >> 12) % 4) {
+        case 0:
+        case 1:
+            assert(m.insert({key, r}).second == ref.insert({key, r}).second);
+            break;
+        case 2:
+            assert(m.erase(key) == ref.erase(key));
+            break;
+        case 3: {
+            auto it = m.find(key);
+            auto rit = ref.find(key);
+            assert((it == m.end()) == (rit == ref.end()));
+            if (it != m.end())
+                assert(it->second == rit->second);
+            break;
+        }
+        }
+        assert(m.size() == ref.size());
+    }
+    std::size_t n = 0;
+    for (auto& kv : m) {
+        assert(ref.at(kv.first) == kv.second);
+        ++n;
+    }
+    assert(n == ref.size());
+
+  return 0;
+}
@@ -0,0 +1,47 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// UNSUPPORTED: c++98, c++03
+
+// <experimental/flat_hash_set>
+
+#include <experimental/flat_hash_set>
+#include <cassert>
+#include <string>
+
+#include "test_macros.h"
+
+int main(int, char**)
+{
+    typedef std::experimental::flat_hash_set<std::string> Set;
+    Set s = {"a", "b", "c"};
+    assert(s.size() == 3);
+    assert(!s.insert("a").second);
+    assert(s.insert("d").second);
+    assert(s.emplace(3, 'e').second);
+    assert(s.contains("eee"));
+    assert(s.count("z") == 0);
+    assert(s.erase("b") == 1);
+    assert(s.find("b") == s.end());
+    assert(s.size() == 4);
+
+    Set t(s.begin(), s.end());
+    assert(s == t);
+    t.erase(t.find("a"));
+    assert(s != t);
+
+    for (int i = 0; i < 5000; ++i)
+        s.insert(std::to_string(i));
+    assert(s.size() == 5004);
+    for (int i = 0; i < 5000; ++i)
+        assert(*s.find(std::to_string(i)) == std::to_string(i));
+    s.erase(s.begin(), s.end());
+    assert(s.empty());
+
+  return 0;
+}
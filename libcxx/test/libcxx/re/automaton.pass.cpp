@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <regex>
+
+// ECMAScript patterns without back references or lookahead are matched by an
+// automaton instead of by backtracking.  Check that it finds the same matches
+// and sub-expressions, and that it does not give up on inputs backtracking
+// takes exponential time for, or allocate once the match_results is sized.
+
+#include <regex>
+#include <string>
+#include <cassert>
+
+#include "test_macros.h"
+#include "count_new.hpp"
+
+template <class CharT>
+void check(const CharT* pattern, const CharT* s, bool found, int pos = 0,
+           int len = 0) {
+  std::basic_regex<CharT> re(pattern);
+  std::match_results<const CharT*> m;
+  assert(std::regex_search(s, m, re) == found);
+  if (found) {
+    assert(m.position(0) == pos);
+    assert(m.length(0) == len);
+  } else
+    assert(m.empty());
+}
+
+int main(int, char**) {
+  // Backtracking explores every way of splitting the run of a's.
+  {
+    std::string s(30, 'a');
+    assert(!std::regex_search(s, std::regex("(a|aa)*b")));
+    s += 'b';
+    std::smatch m;
+    assert(std::regex_match(s, m, std::regex("(a|aa)*b")));
+    assert(m.length(1) == 1);
+  }
+  // Leftmost, then first alternative in priority order.
+  check("a|ab", "xab", true, 1, 1);
+  check("ab|a", "xab", true, 1, 2);
+  check("a+?b", "caaab", true, 1, 4);
+  check("a{2,3}", "aaaa", true, 0, 3);
+  check("a{2,3}?", "aaaa", true, 0, 2);
+  check("(?:ab){2}", "abacabab", true, 4, 4);
+  // Sub-expressions inside a loop only report the last iteration.
+  {
+    std::cmatch m;
+    assert(std::regex_search("abab cd", m, std::regex("(?:(a)|(b))+")));
+    assert(m.length(0) == 4);
+    assert(!m[1].matched);
+    assert(m[2].matched && m.position(2) == 3);
+  }
+  // Assertions see the same context as they do when backtracking.
+  check("\\bb", "ab b", true, 3, 1);
+  check("^b", "ab", false);
+  check("a$", "aab", false);
+  {
+    std::cmatch m;
+    const char s[] = "ab";
+    assert(std::regex_search(s + 1, s + 2, m, std::regex("\\bb")));
+    assert(!std::regex_search(s + 1, s + 2, m, std::regex("\\bb"),
+                              std::regex_constants::match_prev_avail));
+    assert(std::regex_search(s + 1, s + 2, m, std::regex("\\Bb"),
+                             std::regex_constants::match_prev_avail));
+  }
+  // Flags that reject candidate matches.
+  {
+    std::cmatch m;
+    assert(std::regex_search("ba", m, std::regex("a*"),
+                             std::regex_constants::match_not_null));
+    assert(m.position(0) == 1 && m.length(0) == 1);
+    assert(!std::regex_search("ba", m, std::regex("a"),
+                              std::regex_constants::match_continuous));
+  }
+  // Characters outside the precomputed tables.
+  check(L"\u0100+", L"a\u0100\u0100b", true, 1, 2);
+  check(L"[^a]b", L"ab\u0100b", true, 2, 2);
+  check(L".\u0101", L"\u0100\u0100", false);
+  {
+    std::regex re("([0-9]+): (\\w+) on (/[a-z/]+)");
+    const std::string s = "2019-07-12 42: disk_full on /dev/sda";
+    std::smatch m;
+    assert(std::regex_search(s, m, re));
+    globalMemCounter.reset();
+    assert(std::regex_search(s, m, re));
+    assert(m.position(1) == 11 && m.length(3) == 8);
+    assert(globalMemCounter.checkNewCalledEq(0));
+  }
+  // Back references are still supported.
+  check("(a+)b\\1", "aabaab", true, 0, 5);
+
+  return 0;
+}
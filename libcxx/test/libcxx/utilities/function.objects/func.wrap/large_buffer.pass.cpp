@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+
+// <functional>
+
+// Test that _LIBCPP_ABI_LARGE_FUNCTION_BUFFER keeps trivially copyable
+// functors of up to six pointers inline, and that copies, moves and swaps of
+// inline and heap allocated functors keep their values.
+
+#define _LIBCPP_ABI_LARGE_FUNCTION_BUFFER
+
+#include <functional>
+#include <cassert>
+
+#include "test_macros.h"
+#include "count_new.hpp"
+
+struct Six {
+  long v[6];
+  long operator()() const { return v[0] + v[1] + v[2] + v[3] + v[4] + v[5]; }
+};
+
+struct Seven {
+  long v[7];
+  long operator()() const {
+    return v[0] + v[1] + v[2] + v[3] + v[4] + v[5] + v[6];
+  }
+};
+
+struct NonTrivial {
+  long v;
+  NonTrivial(long x) : v(x) {}
+  NonTrivial(const NonTrivial& o) : v(o.v) {}
+  long operator()() const { return v; }
+};
+
+int main(int, char**) {
+  static_assert(sizeof(std::function<long()>) == 8 * sizeof(void*), "");
+  {
+    std::function<long()> f = Six{{1, 2, 3, 4, 5, 6}};
+    assert(globalMemCounter.checkOutstandingNewEq(0));
+    assert(f() == 21);
+    std::function<long()> g = f;
+    std::function<long()> h = std::move(f);
+    assert(globalMemCounter.checkOutstandingNewEq(0));
+    assert(g() == 21 && h() == 21);
+    assert(h.target<Six>() && h.target<Six>()->v[5] == 6);
+  }
+  {
+    const long a = 1, b = 2, c = 3, d = 4, e = 5, g = 6;
+    std::function<long()> f = [a, b, c, d, e, g] {
+      return a + b + c + d + e + g;
+    };
+    assert(globalMemCounter.checkOutstandingNewEq(0));
+    assert(f() == 21);
+  }
+  {
+    std::function<long()> f = Seven{{1, 2, 3, 4, 5, 6, 7}};
+    assert(globalMemCounter.checkOutstandingNewEq(1));
+    std::function<long()> g = f;
+    assert(globalMemCounter.checkOutstandingNewEq(2));
+    std::function<long()> h = std::move(f);
+    assert(globalMemCounter.checkOutstandingNewEq(2));
+    assert(g() == 28 && h() == 28);
+  }
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+  {
+    std::function<long()> f = NonTrivial(7);
+    assert(globalMemCounter.checkOutstandingNewEq(1));
+    assert(f() == 7);
+  }
+  assert(globalMemCounter.checkOutstandingNewEq(0));
+  {
+    std::function<long()> small = Six{{1, 1, 1, 1, 1, 1}};
+    std::function<long()> large = Seven{{2, 2, 2, 2, 2, 2, 2}};
+    small.swap(large);
+    assert(small() == 14 && large() == 6);
+    large = std::move(small);
+    assert(large() == 14);
+    assert(globalMemCounter.checkOutstandingNewEq(1));
+    large = nullptr;
+    assert(globalMemCounter.checkOutstandingNewEq(0));
+    assert(!large);
+  }
+
+  return 0;
+}
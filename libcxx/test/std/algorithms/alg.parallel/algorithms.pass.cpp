@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+
+// <execution>
+
+// The <algorithm> overloads taking an execution policy give the same results
+// as the serial algorithms, both for random access iterators, which run in
+// parallel, and for forward iterators, which don't.
+
+#include <execution>
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "test_macros.h"
+#include "test_iterators.h"
+
+std::vector<int> makeInput(int n) {
+  std::vector<int> v(n);
+  for (int i = 0; i < n; ++i)
+    v[i] = static_cast<int>((i * 2654435761u) % 1000);
+  return v;
+}
+
+template <class Policy, template <class> class Iter>
+void test(const Policy& exec, int n) {
+  typedef Iter<int*> I;
+  std::vector<int> v = makeInput(n);
+  std::vector<int> out(n), ref(n);
+  int* f = v.data();
+  int* l = v.data() + n;
+
+  assert(std::find(exec, I(f), I(l), 500).base() == std::find(f, l, 500));
+  assert(std::find(exec, I(f), I(l), -1).base() == l);
+  assert(std::find_if(exec, I(f), I(l), [](int x) { return x > 990; }).base() ==
+         std::find_if(f, l, [](int x) { return x > 990; }));
+  assert(std::find_if_not(exec, I(f), I(l), [](int x) { return x < 990; })
+             .base() == std::find_if_not(f, l, [](int x) { return x < 990; }));
+  assert(std::count(exec, I(f), I(l), 7) == std::count(f, l, 7));
+  assert(std::count_if(exec, I(f), I(l), [](int x) { return x % 3 == 0; }) ==
+         std::count_if(f, l, [](int x) { return x % 3 == 0; }));
+  assert(std::all_of(exec, I(f), I(l), [](int x) { return x >= 0; }));
+  assert(std::any_of(exec, I(f), I(l), [](int x) { return x >= 0; }) == (n > 0));
+  assert(std::none_of(exec, I(f), I(l), [](int x) { return x >= 1000; }));
+
+  int* o = out.data();
+  assert(std::copy(exec, I(f), I(l), I(o)).base() == o + n);
+  assert(out == v);
+  assert(std::copy_n(exec, I(f), n, I(o)).base() == o + n);
+  assert(out == v);
+
+  assert(std::transform(exec, I(f), I(l), I(o), [](int x) { return x + 1; })
+             .base() == o + n);
+  std::transform(f, l, ref.begin(), [](int x) { return x + 1; });
+  assert(out == ref);
+  assert(std::transform(exec, I(f), I(l), I(o), I(o), std::plus<int>())
+             .base() == o + n);
+  std::transform(f, l, ref.begin(), ref.begin(), std::plus<int>());
+  assert(out == ref);
+
+  std::fill(exec, I(o), I(o + n), 3);
+  assert(std::count(out.begin(), out.end(), 3) == n);
+  assert(std::fill_n(exec, I(o), n, 4).base() == o + n);
+  assert(std::count(out.begin(), out.end(), 4) == n);
+  std::generate(exec, I(o), I(o + n), [] { return 5; });
+  assert(std::count(out.begin(), out.end(), 5) == n);
+  std::for_each(exec, I(o), I(o + n), [](int& x) { ++x; });
+  assert(std::count(out.begin(), out.end(), 6) == n);
+  assert(std::for_each_n(exec, I(o), n, [](int& x) { ++x; }).base() == o + n);
+  assert(std::count(out.begin(), out.end(), 7) == n);
+}
+
+template <class Policy>
+void testSort(const Policy& exec, int n) {
+  std::vector<int> v = makeInput(n), ref = v;
+  std::sort(exec, v.begin(), v.end());
+  std::sort(ref.begin(), ref.end());
+  assert(v == ref);
+  std::sort(exec, v.begin(), v.end(), std::greater<int>());
+  std::sort(ref.begin(), ref.end(), std::greater<int>());
+  assert(v == ref);
+
+  // Equal keys keep their original order.
+  std::vector<std::pair<int, int> > p(n), pref;
+  for (int i = 0; i < n; ++i)
+    p[i] = std::make_pair(static_cast<int>((i * 2654435761u) % 17), i);
+  pref = p;
+  auto less_first = [](const std::pair<int, int>& x,
+                       const std::pair<int, int>& y) {
+    return x.first < y.first;
+  };
+  std::stable_sort(exec, p.begin(), p.end(), less_first);
+  std::stable_sort(pref.begin(), pref.end(), less_first);
+  assert(p == pref);
+  std::stable_sort(exec, p.begin(), p.end());
+  assert(std::is_sorted(p.begin(), p.end()));
+}
+
+template <class Policy>
+void testPolicy(const Policy& exec) {
+  const int sizes[] = {0, 1, 2, 100, 1023, 1024, 1025, 5000, 100003};
+  for (int n : sizes) {
+    test<Policy, random_access_iterator>(exec, n);
+    test<Policy, forward_iterator>(exec, n);
+    testSort(exec, n);
+  }
+}
+
+int main(int, char**) {
+  testPolicy(std::execution::seq);
+  testPolicy(std::execution::par);
+  testPolicy(std::execution::par_unseq);
+
+  return 0;
+}
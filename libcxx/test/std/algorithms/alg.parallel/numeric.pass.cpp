@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+
+// <execution>
+
+// The reduce and transform_reduce overloads taking an execution policy.
+
+#include <execution>
+#include <cassert>
+#include <numeric>
+#include <vector>
+
+#include "test_macros.h"
+#include "test_iterators.h"
+
+template <class Policy, template <class> class Iter>
+void test(const Policy& exec, int n) {
+  typedef Iter<const long long*> I;
+  std::vector<long long> a(n), b(n);
+  for (int i = 0; i < n; ++i) {
+    a[i] = i % 100;
+    b[i] = (i * 7) % 13;
+  }
+  const long long* fa = a.data();
+  const long long* la = a.data() + n;
+  const long long* fb = b.data();
+
+  long long sum = std::accumulate(fa, la, 0LL);
+  long long dot = std::inner_product(fa, la, fb, 0LL);
+  long long squares = 0;
+  for (int i = 0; i < n; ++i)
+    squares += a[i] * a[i];
+
+  assert(std::reduce(exec, I(fa), I(la)) == sum);
+  assert(std::reduce(exec, I(fa), I(la), 5LL) == sum + 5);
+  assert(std::reduce(exec, I(fa), I(la), 5LL, std::plus<>()) == sum + 5);
+  assert(std::transform_reduce(exec, I(fa), I(la), I(fb), 1LL) == dot + 1);
+  assert(std::transform_reduce(exec, I(fa), I(la), I(fb), 1LL, std::plus<>(),
+                               std::multiplies<>()) == dot + 1);
+  assert(std::transform_reduce(exec, I(fa), I(la), 2LL, std::plus<>(),
+                               [](long long x) { return x * x; }) ==
+         squares + 2);
+
+  // The result type is the type of the initial value.
+  ASSERT_SAME_TYPE(decltype(std::reduce(exec, I(fa), I(la), 0.0)), double);
+}
+
+template <class Policy>
+void testPolicy(const Policy& exec) {
+  const int sizes[] = {0, 1, 2, 100, 1023, 1024, 1025, 5000, 100003};
+  for (int n : sizes) {
+    test<Policy, random_access_iterator>(exec, n);
+    test<Policy, forward_iterator>(exec, n);
+  }
+}
+
+int main(int, char**) {
+  testPolicy(std::execution::seq);
+  testPolicy(std::execution::par);
+  testPolicy(std::execution::par_unseq);
+
+  return 0;
+}
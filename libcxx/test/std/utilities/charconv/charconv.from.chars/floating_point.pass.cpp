@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+// UNSUPPORTED: !libc++ && c++11
+// UNSUPPORTED: !libc++ && c++14
+
+// XFAIL: with_system_cxx_lib=macosx10.14
+// XFAIL: with_system_cxx_lib=macosx10.13
+// XFAIL: with_system_cxx_lib=macosx10.12
+// XFAIL: with_system_cxx_lib=macosx10.11
+// XFAIL: with_system_cxx_lib=macosx10.10
+// XFAIL: with_system_cxx_lib=macosx10.9
+// XFAIL: with_system_cxx_lib=macosx10.8
+// XFAIL: with_system_cxx_lib=macosx10.7
+
+// <charconv>
+
+// from_chars_result from_chars(const char* first, const char* last,
+//                              Floating& value,
+//                              chars_format fmt = chars_format::general)
+
+#include <charconv>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <string.h>
+
+#include "test_macros.h"
+
+template <typename T>
+void test(const char* s, std::chars_format fmt, T expected, size_t used)
+{
+    T value = T(-42);
+    std::from_chars_result r = std::from_chars(s, s + strlen(s), value, fmt);
+    assert(r.ec == std::errc());
+    assert(r.ptr == s + used);
+    if (std::isnan(expected))
+        assert(std::isnan(value));
+    else
+    {
+        assert(value == expected);
+        assert(std::signbit(value) == std::signbit(expected));
+    }
+}
+
+template <typename T>
+void test(const char* s, T expected)
+{
+    test(s, std::chars_format::general, expected, strlen(s));
+}
+
+template <typename T>
+void test_error(const char* s, std::chars_format fmt, std::errc ec,
+                size_t used)
+{
+    T value = T(-42);
+    std::from_chars_result r = std::from_chars(s, s + strlen(s), value, fmt);
+    assert(r.ec == ec);
+    assert(r.ptr == s + used);
+    assert(value == T(-42));
+}
+
+template <typename T>
+void test_all()
+{
+    using std::chars_format;
+    const std::errc invalid = std::errc::invalid_argument;
+    const std::errc range = std::errc::result_out_of_range;
+
+    test("0", T(0));
+    test("-0", -T(0));
+    test("1.5", T(1.5));
+    test("-1.5e3", T(-1500));
+    test(".25", T(0.25));
+    test("4.", T(4));
+    test("1E2", T(100));
+    test("0000000000000000000000000000001.5", T(1.5));
+    test("inf", std::numeric_limits<T>::infinity());
+    test("-INFINITY", -std::numeric_limits<T>::infinity());
+    test("nan", std::numeric_limits<T>::quiet_NaN());
+    test("nan(0x_1)", std::numeric_limits<T>::quiet_NaN());
+
+    // Only the matched prefix is consumed.
+    test("1e", chars_format::general, T(1), 1);
+    test("1e+", chars_format::general, T(1), 1);
+    test("2.5x", chars_format::general, T(2.5), 3);
+    test("infinit", chars_format::general,
+         std::numeric_limits<T>::infinity(), 3);
+    test("nan(12", chars_format::general,
+         std::numeric_limits<T>::quiet_NaN(), 3);
+    test("1e5", chars_format::fixed, T(1), 1);
+    test("1.5e2", chars_format::scientific, T(150), 5);
+    test("1.8p1", chars_format::hex, T(3), 5);
+    test("ff.8", chars_format::hex, T(255.5), 4);
+    test("0x1", chars_format::hex, T(0), 1);
+    test("1p", chars_format::hex, T(1), 1);
+
+    test_error<T>("", chars_format::general, invalid, 0);
+    test_error<T>("-", chars_format::general, invalid, 0);
+    test_error<T>(".", chars_format::general, invalid, 0);
+    test_error<T>("+1", chars_format::general, invalid, 0);
+    test_error<T>(" 1", chars_format::general, invalid, 0);
+    test_error<T>("e5", chars_format::general, invalid, 0);
+    test_error<T>("1.5", chars_format::scientific, invalid, 0);
+    test_error<T>("1e99999", chars_format::general, range, 7);
+    test_error<T>("-1e99999", chars_format::general, range, 8);
+    test_error<T>("1e-99999", chars_format::general, range, 8);
+}
+
+int main(int, char**)
+{
+    test_all<float>();
+    test_all<double>();
+    test_all<long double>();
+
+    // Exact halfway cases round to even.
+    test("9007199254740993", 9007199254740992.0);
+    test("9007199254740995", 9007199254740996.0);
+    test("1.00000000000000011102230246251565404236316680908203125", 1.0);
+    test("1.00000000000000011102230246251565404236316680908203126",
+         1.0000000000000002);
+    test("2.2250738585072011e-308", 2.2250738585072009e-308);
+    test("4.9406564584124654e-324", 5e-324);
+    test("16777217", 16777216.0f);
+    test("3.4028235e38", 3.4028235e38f);
+
+    // Every shortest output reads back as the same value.
+    for (double d = 1e-300; d < 1e300; d *= 1.37)
+    {
+        char buf[32];
+        std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), d);
+        double back;
+        std::from_chars_result f = std::from_chars(buf, r.ptr, back);
+        assert(f.ec == std::errc() && f.ptr == r.ptr && back == d);
+    }
+
+    return 0;
+}
@@ -0,0 +1,198 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+// UNSUPPORTED: !libc++ && c++11
+// UNSUPPORTED: !libc++ && c++14
+
+// XFAIL: with_system_cxx_lib=macosx10.14
+// XFAIL: with_system_cxx_lib=macosx10.13
+// XFAIL: with_system_cxx_lib=macosx10.12
+// XFAIL: with_system_cxx_lib=macosx10.11
+// XFAIL: with_system_cxx_lib=macosx10.10
+// XFAIL: with_system_cxx_lib=macosx10.9
+// XFAIL: with_system_cxx_lib=macosx10.8
+// XFAIL: with_system_cxx_lib=macosx10.7
+
+// <charconv>
+
+// to_chars_result to_chars(char* first, char* last, Floating value);
+// to_chars_result to_chars(char* first, char* last, Floating value,
+//                          chars_format fmt);
+// to_chars_result to_chars(char* first, char* last, Floating value,
+//                          chars_format fmt, int precision);
+
+#include <charconv>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_macros.h"
+
+bool equal(const char* first, const char* last, const char* expected)
+{
+    return static_cast<size_t>(last - first) == strlen(expected) &&
+           memcmp(first, expected, last - first) == 0;
+}
+
+template <typename T>
+void test(T value, const char* expected)
+{
+    char buf[400];
+    std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), value);
+    assert(r.ec == std::errc());
+    assert(equal(buf, r.ptr, expected));
+}
+
+template <typename T>
+void test(T value, std::chars_format fmt, const char* expected)
+{
+    char buf[400];
+    std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), value, fmt);
+    assert(r.ec == std::errc());
+    assert(equal(buf, r.ptr, expected));
+
+    // Every shorter buffer is too small.
+    size_t n = strlen(expected);
+    r = std::to_chars(buf, buf + n - 1, value, fmt);
+    assert(r.ec == std::errc::value_too_large);
+    assert(r.ptr == buf + n - 1);
+}
+
+template <typename T>
+void test(T value, std::chars_format fmt, int precision, const char* expected)
+{
+    char buf[400];
+    std::to_chars_result r =
+        std::to_chars(buf, buf + sizeof(buf), value, fmt, precision);
+    assert(r.ec == std::errc());
+    assert(equal(buf, r.ptr, expected));
+}
+
+// The shortest output reads back as the same value and no shorter
+// scientific string does.
+template <typename T>
+void test_roundtrip(T value)
+{
+    value = std::fabs(value);
+    char buf[64];
+    std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), value,
+                                           std::chars_format::scientific);
+    assert(r.ec == std::errc());
+    *r.ptr = '\0';
+    T back = sizeof(T) == sizeof(float) ? strtof(buf, nullptr)
+                                        : strtod(buf, nullptr);
+    assert(back == value);
+
+    const char* e = strchr(buf, 'e');
+    int digits = static_cast<int>(e - buf) - (e - buf > 1);
+    if (digits > 1)
+    {
+        char shorter[64];
+        snprintf(shorter, sizeof(shorter), "%.*e", digits - 2,
+                 static_cast<double>(value));
+        T other = sizeof(T) == sizeof(float) ? strtof(shorter, nullptr)
+                                             : strtod(shorter, nullptr);
+        assert(other != value);
+    }
+}
+
+int main(int, char**)
+{
+    using std::chars_format;
+
+    // Plain: the shorter of fixed and scientific, fixed on a tie.
+    test(0.0, "0");
+    test(-0.0, "-0");
+    test(1.0, "1");
+    test(0.1, "0.1");
+    test(0.3, "0.3");
+    test(1234.5, "1234.5");
+    test(1e4, "10000");
+    test(1e10, "1e+10");
+    test(1e16, "1e+16");
+    test(123456789012.0, "123456789012");
+    test(0.001, "0.001");
+    test(0.0001, "1e-04");
+    test(1e100, "1e+100");
+    test(5e-324, "5e-324");
+    test(1.7976931348623157e308, "1.7976931348623157e+308");
+    test(2.2250738585072014e-308, "2.2250738585072014e-308");
+    test(0.1f, "0.1");
+    test(16777216.0f, "16777216");
+    test(3.4028235e38f, "3.4028235e+38");
+    test(1e-45f, "1e-45");
+    test(std::numeric_limits<double>::infinity(), "inf");
+    test(-std::numeric_limits<float>::infinity(), "-inf");
+    test(std::numeric_limits<double>::quiet_NaN(), "nan");
+
+    test(1e23, chars_format::scientific, "1e+23");
+    test(-1.5, chars_format::scientific, "-1.5e+00");
+    test(0.0, chars_format::scientific, "0e+00");
+    test(123.0f, chars_format::scientific, "1.23e+02");
+
+    // Large values print their exact integer value.
+    test(1e23, chars_format::fixed, "99999999999999991611392");
+    test(1e15, chars_format::fixed, "1000000000000000");
+    test(0.000123, chars_format::fixed, "0.000123");
+    test(-2.5, chars_format::fixed, "-2.5");
+    test(1e10f, chars_format::fixed, "10000000000");
+    test(3.4028235e38f, chars_format::fixed,
+         "340282346638528859811704183484516925440");
+
+    // General switches to scientific outside [1e-4, 1e6).
+    test(123456.0, chars_format::general, "123456");
+    test(1e6, chars_format::general, "1e+06");
+    test(0.0001, chars_format::general, "0.0001");
+    test(0.00001, chars_format::general, "1e-05");
+
+    test(1.0, chars_format::hex, "1p+0");
+    test(-3.0, chars_format::hex, "-1.8p+1");
+    test(0.0, chars_format::hex, "0p+0");
+    test(0.1, chars_format::hex, "1.999999999999ap-4");
+    test(5e-324, chars_format::hex, "0.0000000000001p-1022");
+    test(0.1f, chars_format::hex, "1.99999ap-4");
+    test(1e-45f, chars_format::hex, "0.000002p-126");
+
+    test(3.14159, chars_format::fixed, 2, "3.14");
+    test(3.14159, chars_format::scientific, 3, "3.142e+00");
+    test(3.14159, chars_format::general, 3, "3.14");
+    test(0.5, chars_format::fixed, 0, "0");
+    test(1.5, chars_format::fixed, 0, "2");
+    test(1e20, chars_format::fixed, 1, "100000000000000000000.0");
+    test(2.5f, chars_format::scientific, -1, "2.500000e+00");
+    test(1.0, chars_format::hex, 3, "1.000p+0");
+    test(1.5, chars_format::hex, 0, "2p+0");
+    test(2.5, chars_format::hex, 0, "1p+1");
+    test(0.1, chars_format::hex, 4, "1.999ap-4");
+
+    test(1.0L, "1");
+    test(0.5L, chars_format::scientific, "5e-01");
+    test(0.25L, chars_format::fixed, 3, "0.250");
+
+    srand(1);
+    for (int i = 0; i < 100000; ++i)
+    {
+        uint64_t bits = (uint64_t(rand()) << 40) ^ (uint64_t(rand()) << 20) ^
+                        uint64_t(rand());
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        if (std::isfinite(d))
+            test_roundtrip(d);
+        uint32_t fbits = static_cast<uint32_t>(bits);
+        float f;
+        memcpy(&f, &fbits, sizeof(f));
+        if (std::isfinite(f))
+            test_roundtrip(f);
+    }
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+
+// <execution>
+
+// template<class T> struct is_execution_policy;
+// template<class T> inline constexpr bool is_execution_policy_v;
+// inline constexpr sequenced_policy seq;
+// inline constexpr parallel_policy par;
+// inline constexpr parallel_unsequenced_policy par_unseq;
+
+#include <execution>
+#include <type_traits>
+
+#include "test_macros.h"
+
+template <class T, bool Expected>
+void test() {
+  static_assert(std::is_execution_policy<T>::value == Expected, "");
+  static_assert(std::is_execution_policy_v<T> == Expected, "");
+  static_assert(std::is_base_of<std::integral_constant<bool, Expected>,
+                                std::is_execution_policy<T> >::value, "");
+}
+
+int main(int, char**) {
+  test<std::execution::sequenced_policy, true>();
+  test<std::execution::parallel_policy, true>();
+  test<std::execution::parallel_unsequenced_policy, true>();
+  test<int, false>();
+  test<const std::execution::parallel_policy, false>();
+  test<std::execution::parallel_policy&, false>();
+
+  static_assert(std::is_same<decltype(std::execution::seq),
+                             const std::execution::sequenced_policy>::value, "");
+  static_assert(std::is_same<decltype(std::execution::par),
+                             const std::execution::parallel_policy>::value, "");
+  static_assert(
+      std::is_same<decltype(std::execution::par_unseq),
+                   const std::execution::parallel_unsequenced_policy>::value,
+      "");
+
+  return 0;
+}
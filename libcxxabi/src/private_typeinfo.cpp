@@ -214,6 +214,50 @@ __enum_type_info::can_catch(const __shim_type_info* thrown_type,
 #pragma clang diagnostic ignored "-Wmissing-field-initializers"
 #endif
 
+// Cache of bullet 2 results for class handlers.
+//
+// A thrown object's type is its complete type, so whether a class handler
+// matches and how far the object pointer moves to reach the handler's base
+// subobject depend only on the two type_infos.  Throwing the same exception
+// types through the same handlers then only pays for the base class search
+// once per thread.  Entries also remember the type names, so that an entry
+// is not reused for a different type whose type_info happens to be loaded at
+// the same address after a dlclose().
+namespace
+{
+
+struct can_catch_cache_entry
+{
+    const __class_type_info* catch_type;
+    const __shim_type_info* thrown_type;
+    const char* catch_name;
+    const char* thrown_name;
+    std::ptrdiff_t offset_to_base;
+    bool matches;
+};
+
+const std::size_t can_catch_cache_size = 16;
+
+#if defined(_LIBCXXABI_HAS_NO_THREADS)
+can_catch_cache_entry can_catch_cache[can_catch_cache_size];
+#else
+__thread can_catch_cache_entry can_catch_cache[can_catch_cache_size];
+#endif
+
+inline
+can_catch_cache_entry&
+can_catch_cache_slot(const __class_type_info* catch_type,
+                     const __shim_type_info* thrown_type)
+{
+    std::size_t h = reinterpret_cast<std::size_t>(catch_type) ^
+                    (reinterpret_cast<std::size_t>(thrown_type) >> 3);
+    h ^= h >> 4;
+    h ^= h >> 8;
+    return can_catch_cache[(h >> 3) % can_catch_cache_size];
+}
+
+}  // unnamed namespace
+
 // Handles bullets 1 and 2
 bool
 __class_type_info::can_catch(const __shim_type_info* thrown_type,
@@ -222,6 +266,14 @@ __class_type_info::can_catch(const __shim_type_info* thrown_type,
     // bullet 1
     if (is_equal(this, thrown_type, false))
         return true;
+    can_catch_cache_entry& entry = can_catch_cache_slot(this, thrown_type);
+    if (entry.catch_type == this && entry.thrown_type == thrown_type &&
+        entry.catch_name == name() && entry.thrown_name == thrown_type->name())
+    {
+        if (entry.matches && adjustedPtr != nullptr)
+            adjustedPtr = static_cast<char*>(adjustedPtr) + entry.offset_to_base;
+        return entry.matches;
+    }
     const __class_type_info* thrown_class_type =
         dynamic_cast<const __class_type_info*>(thrown_type);
     if (thrown_class_type == 0)
@@ -230,7 +282,21 @@ __class_type_info::can_catch(const __shim_type_info* thrown_type,
     __dynamic_cast_info info = {thrown_class_type, 0, this, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,};
     info.number_of_dst_type = 1;
     thrown_class_type->has_unambiguous_public_base(&info, adjustedPtr, public_path);
-    if (info.path_dst_ptr_to_static_ptr == public_path)
+    bool matches = info.path_dst_ptr_to_static_ptr == public_path;
+    // Without an object there is no offset to remember.
+    if (adjustedPtr != nullptr)
+    {
+        entry.catch_type = this;
+        entry.thrown_type = thrown_type;
+        entry.catch_name = name();
+        entry.thrown_name = thrown_type->name();
+        entry.matches = matches;
+        entry.offset_to_base =
+            matches ? static_cast<const char*>(info.dst_ptr_leading_to_static_ptr) -
+                      static_cast<char*>(adjustedPtr)
+                    : 0;
+    }
+    if (matches)
     {
         adjustedPtr = const_cast<void*>(info.dst_ptr_leading_to_static_ptr);
         return true;
@@ -613,12 +679,42 @@ bool __pointer_to_member_type_info::can_catch_nested(
 //    (static_ptr, static_type), then return dynamic_ptr.
 // Else return nullptr.
 
+// When src2dst_offset >= 0 the only dst_type that can have (static_ptr,
+// static_type) above it with a public path is the one at
+// static_ptr - src2dst_offset.  If that object exists in the complete object
+// it is the answer, and finding it takes a single upward search from
+// (dynamic_ptr, dynamic_type) that stops as soon as it is reached, instead of
+// the full search_below_dst walk of the hierarchy.  Returns nullptr if the
+// hint does not apply or the object does not exist, in which case the caller
+// falls back to the full search.
+static
+const void*
+dyn_cast_try_downcast(const void* static_ptr, const void* dynamic_ptr,
+                      const __class_type_info* dst_type,
+                      const __class_type_info* dynamic_type,
+                      std::ptrdiff_t src2dst_offset)
+{
+    if (src2dst_offset < 0)
+        return nullptr;
+    const void* dst_ptr_to_static =
+        static_cast<const char*>(static_ptr) - src2dst_offset;
+    if (reinterpret_cast<std::intptr_t>(dst_ptr_to_static) <
+        reinterpret_cast<std::intptr_t>(dynamic_ptr))
+        return nullptr;
+    // Search above dynamic_type for (dst_ptr_to_static, dst_type), as if
+    //   casting from it to dynamic_type.
+    __dynamic_cast_info info = {dynamic_type, dst_ptr_to_static, dst_type, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,};
+    info.number_of_dst_type = 1;
+    dynamic_type->search_above_dst(&info, dynamic_ptr, dynamic_ptr, public_path, false);
+    if (info.path_dst_ptr_to_static_ptr == unknown)
+        return nullptr;
+    return dst_ptr_to_static;
+}
+
 extern "C" _LIBCXXABI_FUNC_VIS void *
 __dynamic_cast(const void *static_ptr, const __class_type_info *static_type,
                const __class_type_info *dst_type,
                std::ptrdiff_t src2dst_offset) {
-    // Possible future optimization:  Take advantage of src2dst_offset
-    // Currently clang always sets src2dst_offset to -1 (no hint).
 
     // Get (dynamic_ptr, dynamic_type) from static_ptr
     void **vtable = *static_cast<void ** const *>(static_ptr);
@@ -636,6 +732,14 @@ __dynamic_cast(const void *static_ptr, const __class_type_info *static_type,
     // Find out if we can use a giant short cut in the search
     if (is_equal(dynamic_type, dst_type, false))
     {
+        // static_type is a unique public nonvirtual base of dst_type, so the
+        //   cast succeeds exactly when static_ptr is that base.
+        if (src2dst_offset >= 0)
+            return offset_to_derived == -src2dst_offset ?
+                   const_cast<void*>(dynamic_ptr) : nullptr;
+        // static_type is not a public base of dst_type.
+        if (src2dst_offset == -2)
+            return nullptr;
         // Using giant short cut.  Add that information to info.
         info.number_of_dst_type = 1;
         // Do the  search
@@ -662,6 +766,10 @@ __dynamic_cast(const void *static_ptr, const __class_type_info *static_type,
     }
     else
     {
+        dst_ptr = dyn_cast_try_downcast(static_ptr, dynamic_ptr, dst_type,
+                                        dynamic_type, src2dst_offset);
+        if (dst_ptr != nullptr)
+            return const_cast<void*>(dst_ptr);
         // Not using giant short cut.  Do the search
         dynamic_type->search_below_dst(&info, dynamic_ptr, public_path, false);
  #ifdef _LIBCXX_DYNAMIC_FALLBACK
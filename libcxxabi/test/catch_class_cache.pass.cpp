@@ -0,0 +1,97 @@
+//===--------------------- catch_class_cache.pass.cpp ---------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+/*
+    Class handlers remember whether they matched a thrown type, and where the
+    handler's base subobject lives.  This test throws the same types through
+    the same handlers repeatedly and checks that adjustedPtr, ambiguity and
+    access are still honored once those results are reused.
+*/
+
+// UNSUPPORTED: libcxxabi-no-exceptions
+
+#include <assert.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wexceptions"
+#pragma clang diagnostic ignored "-Winaccessible-base"
+#endif
+
+struct A { int id_; explicit A(int id) : id_(id) {} };
+struct B { int id_; explicit B(int id) : id_(id) {} };
+struct V { int id_; explicit V(int id) : id_(id) {} };
+
+struct C1 : A, virtual V { int id_; C1() : A(1), V(3), id_(10) {} };
+struct C2 : B, virtual V { int id_; C2() : B(2), V(3), id_(20) {} };
+struct D : C1, C2 { int id_; D() : V(3), id_(30) {} };
+
+// Two A subobjects: catching A is ambiguous.
+struct E : C1, A { E() : V(3), A(4) {} };
+
+// A is a private base.
+struct F : private A { F() : A(5) {} };
+
+int catch_d_as_v() {
+  try {
+    throw D();
+  } catch (E&) {
+    assert(false);
+  } catch (V& v) {
+    return v.id_;
+  }
+  return -1;
+}
+
+int catch_d_as_b() {
+  try {
+    throw D();
+  } catch (B& b) {
+    return b.id_;
+  }
+  return -1;
+}
+
+int catch_d_as_c2() {
+  try {
+    throw D();
+  } catch (const C2& c2) {
+    return c2.id_ + c2.B::id_;
+  }
+  return -1;
+}
+
+int catch_e() {
+  try {
+    throw E();
+  } catch (A&) {
+    return -1;
+  } catch (C1& c1) {
+    return c1.id_;
+  }
+}
+
+int catch_f() {
+  try {
+    throw F();
+  } catch (A&) {
+    return -1;
+  } catch (...) {
+    return 5;
+  }
+}
+
+int main() {
+  for (int i = 0; i < 3; ++i) {
+    assert(catch_d_as_v() == 3);
+    assert(catch_d_as_b() == 2);
+    assert(catch_d_as_c2() == 22);
+    assert(catch_e() == 10);
+    assert(catch_f() == 5);
+  }
+  return 0;
+}
@@ -0,0 +1,81 @@
+//===---------------------- dynamic_cast_hint.pass.cpp --------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// Downcasts for which the compiler can pass a src2dst_offset hint, i.e. the
+// source type is a unique public nonvirtual base of the destination type,
+// including the cases where the hint alone does not decide the answer.
+
+#include <cassert>
+
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Winaccessible-base"
+#endif
+
+struct Base { virtual ~Base() {} int b; };
+struct Pad { virtual ~Pad() {} int p; };
+
+// Base is a unique public nonvirtual base of Derived at a nonzero offset.
+struct Derived : Pad, Base { int d; };
+struct MostDerived : Derived { int m; };
+
+// Two Derived subobjects, each with its own Base.
+struct Left : Derived {};
+struct Right : Derived {};
+struct Both : Left, Right {};
+
+// A Base that is not part of any Derived.
+struct Sibling : Pad, Base {};
+struct Mixed : Derived, Sibling {};
+
+// A Base reached through a private inheritance path next to a public
+// Derived.
+struct Hidden : private Base { Base* base() { return this; } };
+struct WithHidden : Derived, Hidden {};
+
+int main() {
+  {
+    Derived d;
+    Base* b = &d;
+    assert(dynamic_cast<Derived*>(b) == &d);
+  }
+  {
+    MostDerived md;
+    Base* b = &md;
+    assert(dynamic_cast<Derived*>(b) == static_cast<Derived*>(&md));
+    assert(dynamic_cast<MostDerived*>(b) == &md);
+  }
+  {
+    Both both;
+    Base* left = static_cast<Left*>(&both);
+    Base* right = static_cast<Right*>(&both);
+    assert(dynamic_cast<Derived*>(left) ==
+           static_cast<Derived*>(static_cast<Left*>(&both)));
+    assert(dynamic_cast<Derived*>(right) ==
+           static_cast<Derived*>(static_cast<Right*>(&both)));
+  }
+  {
+    Mixed mixed;
+    Base* from_derived = static_cast<Derived*>(&mixed);
+    Base* from_sibling = static_cast<Sibling*>(&mixed);
+    assert(dynamic_cast<Derived*>(from_derived) ==
+           static_cast<Derived*>(&mixed));
+    // Cross cast: the only Derived is not below this Base, but it is
+    // reachable publicly from the complete object.
+    assert(dynamic_cast<Derived*>(from_sibling) ==
+           static_cast<Derived*>(&mixed));
+  }
+  {
+    WithHidden wh;
+    Base* hidden = wh.base();
+    assert(dynamic_cast<Derived*>(hidden) == nullptr);
+    assert(dynamic_cast<WithHidden*>(hidden) == nullptr);
+    Base* visible = static_cast<Derived*>(&wh);
+    assert(dynamic_cast<WithHidden*>(visible) == &wh);
+  }
+  return 0;
+}
@@ -151,6 +151,27 @@ extern char __exidx_end;
 
 #endif
 
+// glibc holds its load lock for the whole of a dl_iterate_phdr() walk, which
+// is what FrameHeaderCache relies on for synchronization.
+#ifndef _LIBUNWIND_USE_FRAME_HEADER_CACHE
+  #if defined(_LIBUNWIND_SUPPORT_DWARF_UNWIND) && defined(__GLIBC__) &&        \
+      !defined(_LIBUNWIND_IS_BAREMETAL)
+    #define _LIBUNWIND_USE_FRAME_HEADER_CACHE 1
+  #else
+    #define _LIBUNWIND_USE_FRAME_HEADER_CACHE 0
+  #endif
+#endif
+
+// glibc 2.35 and later can find the object containing an address, and its
+// PT_GNU_EH_FRAME segment, without taking the load lock at all.
+#ifndef _LIBUNWIND_USE_DL_FIND_OBJECT
+  #if _LIBUNWIND_USE_FRAME_HEADER_CACHE && defined(DLFO_EH_SEGMENT_TYPE)
+    #define _LIBUNWIND_USE_DL_FIND_OBJECT (DLFO_EH_SEGMENT_TYPE == PT_GNU_EH_FRAME)
+  #else
+    #define _LIBUNWIND_USE_DL_FIND_OBJECT 0
+  #endif
+#endif
+
 namespace libunwind {
 
 /// Used by findUnwindSections() to return info about needed sections.
@@ -178,6 +199,14 @@ struct UnwindInfoSections {
 #endif
 };
 
+} // namespace libunwind
+
+#if _LIBUNWIND_USE_FRAME_HEADER_CACHE
+#include "FrameHeaderCache.hpp"
+#endif
+
+namespace libunwind {
+
 
 /// LocalAddressSpace is used as a template parameter to UnwindCursor when
 /// unwinding a thread in the same process.  The wrappers compile away,
@@ -471,21 +500,59 @@ inline bool LocalAddressSpace::findUnwindSections(pint_t targetAddr,
   if (info.arm_section && info.arm_section_length)
     return true;
 #elif defined(_LIBUNWIND_ARM_EHABI) || defined(_LIBUNWIND_SUPPORT_DWARF_UNWIND)
+#if _LIBUNWIND_USE_DL_FIND_OBJECT
+  // Unlike dl_iterate_phdr(), this does not serialize concurrent unwinders on
+  // the load lock. Fall back to the walk below only if the loader does not
+  // know the address at all.
+  struct dl_find_object dlfo;
+  if (_dl_find_object((void *)targetAddr, &dlfo) == 0) {
+    if (dlfo.dlfo_eh_frame == NULL)
+      return false;
+    uintptr_t map_end = (uintptr_t)dlfo.dlfo_map_end;
+    uintptr_t eh_frame_hdr_start = (uintptr_t)dlfo.dlfo_eh_frame;
+    EHHeaderParser<LocalAddressSpace>::EHHeaderInfo hdrInfo;
+    if (!EHHeaderParser<LocalAddressSpace>::decodeEHHdr(
+            *this, eh_frame_hdr_start, map_end - eh_frame_hdr_start, hdrInfo) ||
+        hdrInfo.eh_frame_ptr >= map_end)
+      return false;
+    info.dso_base = (uintptr_t)dlfo.dlfo_map_start;
+    info.dwarf_index_section = eh_frame_hdr_start;
+    info.dwarf_index_section_length = map_end - eh_frame_hdr_start;
+    info.dwarf_section = hdrInfo.eh_frame_ptr;
+    info.dwarf_section_length = map_end - hdrInfo.eh_frame_ptr;
+    return true;
+  }
+#endif
+
   struct dl_iterate_cb_data {
     LocalAddressSpace *addressSpace;
     UnwindInfoSections *sects;
     uintptr_t targetAddr;
+    bool checkedCache;
   };
 
-  dl_iterate_cb_data cb_data = {this, &info, targetAddr};
+  dl_iterate_cb_data cb_data = {this, &info, targetAddr, false};
   int found = dl_iterate_phdr(
-      [](struct dl_phdr_info *pinfo, size_t, void *data) -> int {
+      [](struct dl_phdr_info *pinfo, size_t pinfo_size, void *data) -> int {
         auto cbdata = static_cast<dl_iterate_cb_data *>(data);
         bool found_obj = false;
         bool found_hdr = false;
 
         assert(cbdata);
         assert(cbdata->sects);
+        (void)pinfo_size;
+
+#if _LIBUNWIND_USE_FRAME_HEADER_CACHE
+        // The load and unload counters are the same for every object of one
+        // walk, so the cache only needs consulting on the first callback.
+        static FrameHeaderCache ProcessFrameHeaderCache;
+        if (!cbdata->checkedCache) {
+          cbdata->checkedCache = true;
+          if (ProcessFrameHeaderCache.find(pinfo, pinfo_size,
+                                           cbdata->targetAddr, cbdata->sects))
+            return true;
+        }
+#endif
 
         if (cbdata->targetAddr < pinfo->dlpi_addr) {
           return false;
@@ -505,7 +572,7 @@ inline bool LocalAddressSpace::findUnwindSections(pint_t targetAddr,
   #if !defined(_LIBUNWIND_SUPPORT_DWARF_INDEX)
    #error "_LIBUNWIND_SUPPORT_DWARF_UNWIND requires _LIBUNWIND_SUPPORT_DWARF_INDEX on this platform."
   #endif
-        size_t object_length;
+        size_t object_length = 0;
 #if defined(__ANDROID__)
         Elf_Addr image_base =
             pinfo->dlpi_phnum
@@ -548,6 +615,11 @@ inline bool LocalAddressSpace::findUnwindSections(pint_t targetAddr,
 
         if (found_obj && found_hdr) {
           cbdata->sects->dwarf_section_length = object_length;
+#if _LIBUNWIND_USE_FRAME_HEADER_CACHE
+          ProcessFrameHeaderCache.add(cbdata->sects->dso_base,
+                                      cbdata->sects->dso_base + object_length,
+                                      cbdata->sects);
+#endif
           return true;
         } else {
           return false;
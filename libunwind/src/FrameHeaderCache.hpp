@@ -0,0 +1,158 @@
+//===-------------------------- FrameHeaderCache.hpp ----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//
+// Cache the elf program headers necessary to unwind the stack more efficiently
+// in the presence of many dsos.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef __FRAMEHEADER_CACHE_HPP__
+#define __FRAMEHEADER_CACHE_HPP__
+
+#include "config.h"
+#include <stddef.h>
+
+#ifdef _LIBUNWIND_DEBUG_FRAMEHEADER_CACHE
+#define _LIBUNWIND_FRAMEHEADERCACHE_TRACE0(x) _LIBUNWIND_LOG0(x)
+#define _LIBUNWIND_FRAMEHEADERCACHE_TRACE(msg, ...)                            \
+  _LIBUNWIND_LOG(msg, __VA_ARGS__)
+#else
+#define _LIBUNWIND_FRAMEHEADERCACHE_TRACE0(x)
+#define _LIBUNWIND_FRAMEHEADERCACHE_TRACE(msg, ...)
+#endif
+
+// This cache should only be be used from within a dl_iterate_phdr callback.
+// dl_iterate_phdr does the necessary synchronization to prevent problems
+// with concurrent access via the libc load lock. Adding synchronization
+// for other uses is possible, but not currently done.
+
+namespace libunwind {
+
+class _LIBUNWIND_HIDDEN FrameHeaderCache {
+  struct CacheEntry {
+    uintptr_t LowPC;
+    uintptr_t HighPC;
+    UnwindInfoSections Info;
+    CacheEntry *Next;
+  };
+
+  static const size_t kCacheEntryCount = 8;
+
+  // Can't depend on the C++ standard library in libunwind, so use an array to
+  // allocate the entries, and two linked lists for ordering unused and recently
+  // used entries.  FIXME: Would the the extra memory for a doubly-linked list
+  // be better than the runtime cost of traversing a very short singly-linked
+  // list on a cache miss? The entries themselves are all small and consecutive,
+  // so unlikely to cause page faults when following the pointers. The memory
+  // spent on additional pointers could also be spent on more entries.
+
+  CacheEntry Entries[kCacheEntryCount];
+  CacheEntry *MostRecentlyUsed;
+  CacheEntry *Unused;
+  unsigned long long LastAdds;
+  unsigned long long LastSubs;
+
+  void resetCache() {
+    _LIBUNWIND_FRAMEHEADERCACHE_TRACE0("FrameHeaderCache reset");
+    MostRecentlyUsed = nullptr;
+    Unused = &Entries[0];
+    for (size_t i = 0; i < kCacheEntryCount - 1; i++) {
+      Entries[i].Next = &Entries[i + 1];
+    }
+    Entries[kCacheEntryCount - 1].Next = nullptr;
+  }
+
+  // The C library bumps dlpi_adds and dlpi_subs whenever an object is loaded
+  // or unloaded, so any change means a cached range may now be stale.
+  bool cacheNeedsReset(dl_phdr_info *PInfo, size_t PInfoSize) {
+    if (PInfoSize <
+        offsetof(dl_phdr_info, dlpi_subs) + sizeof(PInfo->dlpi_subs))
+      return true;
+    if (PInfo->dlpi_adds != LastAdds || PInfo->dlpi_subs != LastSubs) {
+      LastAdds = PInfo->dlpi_adds;
+      LastSubs = PInfo->dlpi_subs;
+      return true;
+    }
+    return false;
+  }
+
+public:
+  // No constructor: the single instance lives in zero-initialized static
+  // storage, and the first lookup finds both lists empty and resets it.
+  bool find(dl_phdr_info *PInfo, size_t PInfoSize, uintptr_t TargetAddr,
+            UnwindInfoSections *Sects) {
+    if (cacheNeedsReset(PInfo, PInfoSize) ||
+        (MostRecentlyUsed == nullptr && Unused == nullptr)) {
+      resetCache();
+      return false;
+    }
+    CacheEntry *Current = MostRecentlyUsed;
+    CacheEntry *Previous = nullptr;
+    while (Current != nullptr) {
+      _LIBUNWIND_FRAMEHEADERCACHE_TRACE(
+          "FrameHeaderCache check %lx in [%lx - %lx)", TargetAddr,
+          Current->LowPC, Current->HighPC);
+      if (Current->LowPC <= TargetAddr && TargetAddr < Current->HighPC) {
+        _LIBUNWIND_FRAMEHEADERCACHE_TRACE(
+            "FrameHeaderCache hit %lx in [%lx - %lx)", TargetAddr,
+            Current->LowPC, Current->HighPC);
+        if (Previous) {
+          // If there is no Previous, then Current is already the
+          // MostRecentlyUsed, and no need to move it up.
+          Previous->Next = Current->Next;
+          Current->Next = MostRecentlyUsed;
+          MostRecentlyUsed = Current;
+        }
+        *Sects = Current->Info;
+        return true;
+      }
+      Previous = Current;
+      Current = Current->Next;
+    }
+    _LIBUNWIND_FRAMEHEADERCACHE_TRACE("FrameHeaderCache miss for address %lx",
+                                      TargetAddr);
+    return false;
+  }
+
+  void add(uintptr_t LowPC, uintptr_t HighPC, const UnwindInfoSections *Sects) {
+    CacheEntry *Current = nullptr;
+    if (Unused != nullptr) {
+      Current = Unused;
+      Unused = Unused->Next;
+    } else if (MostRecentlyUsed != nullptr) {
+      // Cache is full; evict the least recently used entry.
+      Current = MostRecentlyUsed;
+      CacheEntry *Previous = nullptr;
+      while (Current->Next != nullptr) {
+        Previous = Current;
+        Current = Current->Next;
+      }
+      if (Previous != nullptr)
+        Previous->Next = nullptr;
+      else
+        MostRecentlyUsed = nullptr;
+      _LIBUNWIND_FRAMEHEADERCACHE_TRACE("FrameHeaderCache evict [%lx - %lx)",
+                                        Current->LowPC, Current->HighPC);
+    } else {
+      // The cache has never been reset, so there is nothing to invalidate it
+      // against yet.
+      return;
+    }
+
+    Current->LowPC = LowPC;
+    Current->HighPC = HighPC;
+    Current->Info = *Sects;
+    Current->Next = MostRecentlyUsed;
+    MostRecentlyUsed = Current;
+    _LIBUNWIND_FRAMEHEADERCACHE_TRACE("FrameHeaderCache add [%lx - %lx)",
+                                      Current->LowPC, Current->HighPC);
+  }
+};
+
+} // namespace libunwind
+
+#endif // __FRAMEHEADER_CACHE_HPP__
@@ -47,20 +47,6 @@ struct _Unwind_FunctionContext {
   void                           *jbuf[];
 };
 
-#if defined(_LIBUNWIND_HAS_NO_THREADS)
-# define _LIBUNWIND_THREAD_LOCAL
-#else
-# if __STDC_VERSION__ >= 201112L
-#  define _LIBUNWIND_THREAD_LOCAL _Thread_local
-# elif defined(_MSC_VER)
-#  define _LIBUNWIND_THREAD_LOCAL __declspec(thread)
-# elif defined(__GNUC__) || defined(__clang__)
-#  define _LIBUNWIND_THREAD_LOCAL __thread
-# else
-#  error Unable to create thread local storage
-# endif
-#endif
-
 
 #if !defined(FOR_DYLD)
 
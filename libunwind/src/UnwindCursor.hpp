@@ -77,6 +77,12 @@ namespace libunwind {
 
 #if defined(_LIBUNWIND_SUPPORT_DWARF_UNWIND)
 /// Cache of recently found FDEs.
+///
+/// The shared buffer is guarded by a reader/writer lock. Each thread keeps a
+/// few of its most recent hits in front of it, so that a thread repeatedly
+/// unwinding through the same frames does not touch the lock at all. The
+/// per-thread entries are discarded whenever anything is removed from the
+/// shared buffer, which is tracked by a generation counter.
 template <typename A>
 class _LIBUNWIND_HIDDEN DwarfFDECache {
   typedef typename A::pint_t pint_t;
@@ -97,6 +103,18 @@ private:
     pint_t fde;
   };
 
+  static const unsigned kThreadCacheSize = 4;
+  struct thread_cache {
+    uintptr_t generation;
+    unsigned next;
+    entry entries[kThreadCacheSize];
+  };
+
+  static bool matches(const entry &e, pint_t mh, pint_t pc) {
+    return ((mh == e.mh) || (mh == 0)) && (e.ip_start <= pc) &&
+           (pc < e.ip_end);
+  }
+
   // These fields are all static to avoid needing an initializer.
   // There is only one instance of this class per process.
   static RWMutex _lock;
@@ -108,6 +126,8 @@ private:
   static entry *_bufferUsed;
   static entry *_bufferEnd;
   static entry _initialBuffer[64];
+  static uintptr_t _generation;
+  static _LIBUNWIND_THREAD_LOCAL thread_cache _threadCache;
 };
 
 template <typename A>
@@ -128,6 +148,13 @@ typename DwarfFDECache<A>::entry DwarfFDECache<A>::_initialBuffer[64];
 template <typename A>
 RWMutex DwarfFDECache<A>::_lock;
 
+template <typename A>
+uintptr_t DwarfFDECache<A>::_generation = 0;
+
+template <typename A>
+_LIBUNWIND_THREAD_LOCAL typename DwarfFDECache<A>::thread_cache
+    DwarfFDECache<A>::_threadCache;
+
 #ifdef __APPLE__
 template <typename A>
 bool DwarfFDECache<A>::_registeredForDyldUnloads = false;
@@ -135,17 +162,37 @@ bool DwarfFDECache<A>::_registeredForDyldUnloads = false;
 
 template <typename A>
 typename A::pint_t DwarfFDECache<A>::findFDE(pint_t mh, pint_t pc) {
+  thread_cache &local = _threadCache;
+  if (local.generation == __atomic_load_n(&_generation, __ATOMIC_ACQUIRE)) {
+    for (unsigned i = 0; i < kThreadCacheSize; ++i) {
+      if (matches(local.entries[i], mh, pc))
+        return local.entries[i].fde;
+    }
+  }
+
   pint_t result = 0;
+  entry found = {0, 0, 0, 0};
   _LIBUNWIND_LOG_IF_FALSE(_lock.lock_shared());
   for (entry *p = _buffer; p < _bufferUsed; ++p) {
-    if ((mh == p->mh) || (mh == 0)) {
-      if ((p->ip_start <= pc) && (pc < p->ip_end)) {
-        result = p->fde;
-        break;
-      }
+    if (matches(*p, mh, pc)) {
+      found = *p;
+      result = p->fde;
+      break;
     }
   }
+  // Entries are only removed while holding the exclusive lock, so the
+  // generation read here is the one the search above observed.
+  uintptr_t generation = __atomic_load_n(&_generation, __ATOMIC_RELAXED);
   _LIBUNWIND_LOG_IF_FALSE(_lock.unlock_shared());
+
+  if (result != 0) {
+    if (local.generation != generation) {
+      memset(&local, 0, sizeof(local));
+      local.generation = generation;
+    }
+    local.entries[local.next] = found;
+    local.next = (local.next + 1) % kThreadCacheSize;
+  }
   return result;
 }
 
@@ -193,6 +240,7 @@ void DwarfFDECache<A>::removeAllIn(pint_t mh) {
     }
   }
   _bufferUsed = d;
+  __atomic_fetch_add(&_generation, 1, __ATOMIC_RELEASE);
   _LIBUNWIND_LOG_IF_FALSE(_lock.unlock());
 }
 
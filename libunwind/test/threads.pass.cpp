@@ -0,0 +1,86 @@
+// -*- C++ -*-
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: libunwind-no-threads
+
+// Unwind from several threads at once, so that the per-thread FDE cache and
+// the shared frame header cache are exercised concurrently.
+
+#include <dlfcn.h>
+#include <stdlib.h>
+#include <thread>
+#include <unwind.h>
+
+#define NUM_THREADS 8
+#define NUM_ITERATIONS 1000
+#define DEPTH 20
+
+_Unwind_Reason_Code callback(_Unwind_Context *context, void *cnt) {
+  (void)context;
+  int *i = (int *)cnt;
+  ++*i;
+  if (*i > 100) {
+    abort();
+  }
+  return _URC_NO_REASON;
+}
+
+__attribute__((noinline)) int count_frames() {
+  int n = 0;
+  _Unwind_Backtrace(&callback, &n);
+  return n;
+}
+
+__attribute__((noinline)) int recurse(int i) {
+  if (i == 0)
+    return count_frames();
+  return recurse(i - 1);
+}
+
+__attribute__((noinline)) void thrower(int i) {
+  if (i == 0)
+    throw i;
+  thrower(i - 1);
+}
+
+void worker() {
+  // Every pass of the loop unwinds through the same frames, so it must see
+  // the same number of them.
+  int expected = recurse(DEPTH);
+  if (expected < 2)
+    abort();
+  for (int i = 0; i < NUM_ITERATIONS; ++i) {
+    if (recurse(DEPTH) != expected)
+      abort();
+    try {
+      thrower(DEPTH);
+      abort();
+    } catch (int) {
+    }
+  }
+}
+
+int main() {
+  std::thread threads[NUM_THREADS];
+  for (int i = 0; i < NUM_THREADS; ++i) {
+    threads[i] = std::thread(worker);
+#if defined(__linux__)
+    if (i == NUM_THREADS / 2) {
+      // Loading and unloading an object must drop any cached ranges while
+      // other threads are unwinding.
+      void *handle = dlopen("libm.so.6", RTLD_NOW);
+      if (handle)
+        dlclose(handle);
+    }
+#endif
+  }
+  for (int i = 0; i < NUM_THREADS; ++i)
+    threads[i].join();
+  return 0;
+}
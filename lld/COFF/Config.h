@@ -105,6 +105,7 @@ struct Configuration {
   bool DebugSymtab = false;
   bool ShowTiming = false;
   bool ShowSummary = false;
+  bool TimeTraceEnabled = false;
   unsigned DebugTypes = static_cast<unsigned>(DebugType::None);
   std::vector<std::string> NatvisFiles;
   llvm::SmallString<128> PDBAltPath;
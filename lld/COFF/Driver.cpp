@@ -38,6 +38,7 @@
 #include "llvm/Support/Process.h"
 #include "llvm/Support/TarWriter.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/ToolDrivers/llvm-lib/LibDriver.h"
 #include <algorithm>
@@ -1035,6 +1036,12 @@ void LinkerDriver::link(ArrayRef<const char *> ArgsArr) {
 
   Config->ShowSummary = Args.hasArg(OPT_summary);
 
+  // Handle --time-trace. This must be set up before any timer is started
+  // because scoped timers are also recorded as trace sections.
+  Config->TimeTraceEnabled = Args.hasArg(OPT_time_trace);
+  if (Config->TimeTraceEnabled)
+    timeTraceProfilerInitialize(args::getFilenameWithoutExe(ArgsArr[0]));
+
   ScopedTimer T(Timer::root());
   // Handle --version, which is an lld extension. This option is a bit odd
   // because it doesn't start with "/", but we deliberately chose "--" to
@@ -1788,9 +1795,16 @@ void LinkerDriver::link(ArrayRef<const char *> ArgsArr) {
   writeResult();
 
   // Stop early so we can print the results.
-  Timer::root().stop();
+  T.stop();
   if (Config->ShowTiming)
     Timer::root().print();
+
+  if (Config->TimeTraceEnabled) {
+    if (Error E = timeTraceProfilerWrite(
+            Args.getLastArgValue(OPT_time_trace_file_eq), Config->OutputFile))
+      error("--time-trace: " + toString(std::move(E)));
+    timeTraceProfilerCleanup();
+  }
 }
 
 } // namespace coff
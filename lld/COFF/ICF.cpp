@@ -127,15 +127,28 @@ void ICF::segregate(size_t Begin, size_t End, bool Constant) {
 
 // Returns true if two sections' associative children are equal.
 bool ICF::assocEquals(const SectionChunk *A, const SectionChunk *B) {
-  auto ChildClasses = [&](const SectionChunk *SC) {
-    std::vector<uint32_t> Classes;
-    for (const SectionChunk &C : SC->children())
-      if (!C.getSectionName().startswith(".debug") &&
-          C.getSectionName() != ".gfids$y" && C.getSectionName() != ".gljmp$y")
-        Classes.push_back(C.Class[Cnt % 2]);
-    return Classes;
+  // Debug info and control flow guard tables don't affect the code, so
+  // they are skipped. Walk both lists in lockstep instead of collecting the
+  // class IDs into temporary vectors; this is called for every comparison.
+  auto IsIgnored = [](const SectionChunk &C) {
+    StringRef Name = C.getSectionName();
+    return Name.startswith(".debug") || Name == ".gfids$y" ||
+           Name == ".gljmp$y";
   };
-  return ChildClasses(A) == ChildClasses(B);
+  auto I1 = A->children().begin(), E1 = A->children().end();
+  auto I2 = B->children().begin(), E2 = B->children().end();
+  for (;;) {
+    while (I1 != E1 && IsIgnored(*I1))
+      ++I1;
+    while (I2 != E2 && IsIgnored(*I2))
+      ++I2;
+    if (I1 == E1 || I2 == E2)
+      return I1 == E1 && I2 == E2;
+    if (I1->Class[Cnt % 2] != I2->Class[Cnt % 2])
+      return false;
+    ++I1;
+    ++I2;
+  }
 }
 
 // Compare "non-moving" part of two sections, namely everything
@@ -261,9 +274,14 @@ void ICF::run(ArrayRef<Chunk *> Vec) {
       for (SectionChunk *SC : MC->Sections)
         SC->Class[0] = NextId++;
 
-  // Initially, we use hash values to partition sections.
+  // Initially, we use hash values to partition sections. Mix in the
+  // attributes that equalsConstant() compares so that chunks which merely
+  // share contents (e.g. small thunks with different relocations) don't end
+  // up in one large class that segregate() has to split quadratically.
   parallelForEach(Chunks, [&](SectionChunk *SC) {
-    SC->Class[0] = xxHash64(SC->getContents());
+    SC->Class[0] = hash_combine(xxHash64(SC->getContents()),
+                                SC->getOutputCharacteristics(),
+                                SC->getSectionName(), SC->RelocsSize);
   });
 
   // Combine the hashes of the sections referenced by each section into its
@@ -281,9 +299,18 @@ void ICF::run(ArrayRef<Chunk *> Vec) {
 
   // From now on, sections in Chunks are ordered so that sections in
   // the same group are consecutive in the vector.
-  llvm::stable_sort(Chunks, [](const SectionChunk *A, const SectionChunk *B) {
-    return A->Class[0] < B->Class[0];
+  // Sort in parallel. The original position is used as a tie-breaker so
+  // that the result is the same as that of a stable sort.
+  std::vector<std::pair<uint64_t, SectionChunk *>> Keys(Chunks.size());
+  parallelForEachN(0, Chunks.size(), [&](size_t I) {
+    Keys[I] = {(uint64_t)Chunks[I]->Class[0] << 32 | I, Chunks[I]};
+  });
+  parallelSort(Keys, [](const std::pair<uint64_t, SectionChunk *> &A,
+                        const std::pair<uint64_t, SectionChunk *> &B) {
+    return A.first < B.first;
   });
+  for (size_t I = 0, E = Keys.size(); I != E; ++I)
+    Chunks[I] = Keys[I].second;
 
   // Compare static contents and assign unique IDs for each static content.
   forEachClass([&](size_t Begin, size_t End) { segregate(Begin, End, true); });
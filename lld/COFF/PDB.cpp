@@ -71,6 +71,7 @@ static ExitOnError ExitOnErr;
 static Timer TotalPdbLinkTimer("PDB Emission (Cumulative)", Timer::root());
 
 static Timer AddObjectsTimer("Add Objects", TotalPdbLinkTimer);
+static Timer GHashTimer("Global Type Hashing", AddObjectsTimer);
 static Timer TypeMergingTimer("Type Merging", AddObjectsTimer);
 static Timer SymbolMergingTimer("Symbol Merging", AddObjectsTimer);
 static Timer GlobalsLayoutTimer("Globals Stream Layout", TotalPdbLinkTimer);
@@ -101,6 +102,9 @@ public:
   /// Link CodeView from each object file in the symbol table into the PDB.
   void addObjectsToPDB();
 
+  /// Compute global type hashes for object files without .debug$H sections.
+  void computeGlobalHashes();
+
   /// Link info for each import file in the symbol table into the PDB.
   void addImportFilesToPDB(ArrayRef<OutputSection *> OutputSections);
 
@@ -394,9 +398,12 @@ PDBLinker::mergeDebugT(ObjFile *File, CVIndexMap *ObjectIndexMap) {
   if (Config->DebugGHashes) {
     ArrayRef<GloballyHashedType> Hashes;
     std::vector<GloballyHashedType> OwnedHashes;
-    if (Optional<ArrayRef<uint8_t>> DebugH = getDebugH(File))
+    if (Optional<ArrayRef<uint8_t>> DebugH = getDebugH(File)) {
       Hashes = getHashesFromDebugH(*DebugH);
-    else {
+    } else if (!File->GHashes.empty()) {
+      OwnedHashes = std::move(File->GHashes);
+      Hashes = OwnedHashes;
+    } else {
       OwnedHashes = GloballyHashedType::hashTypes(Types);
       Hashes = OwnedHashes;
     }
@@ -1282,11 +1289,37 @@ static PublicSym32 createPublic(Defined *Def) {
 
 // Add all object files to the PDB. Merge .debug$T sections into IpiData and
 // TpiData.
+// Type merging is inherently serial because type indices are assigned in
+// the order types are seen, but computing global hashes of an object file's
+// types only depends on that object file. If an object file doesn't have a
+// precomputed .debug$H section, hashing its types is as expensive as merging
+// them, so we do that for all files in parallel first.
+//
+// Objects using precompiled headers are excluded because their type streams
+// are rebased in mergeDebugT() before hashing.
+void PDBLinker::computeGlobalHashes() {
+  ScopedTimer T(GHashTimer);
+
+  parallelForEach(ObjFile::Instances, [](ObjFile *File) {
+    if (!File->DebugTypesObj)
+      return;
+    TpiSource::TpiKind Kind = File->DebugTypesObj->Kind;
+    if (Kind != TpiSource::Regular && Kind != TpiSource::PCH)
+      return;
+    if (getDebugH(File))
+      return;
+    File->GHashes = GloballyHashedType::hashTypes(*File->DebugTypes);
+  });
+}
+
 void PDBLinker::addObjectsToPDB() {
   ScopedTimer T1(AddObjectsTimer);
 
   createModuleDBI(Builder);
 
+  if (Config->DebugGHashes)
+    computeGlobalHashes();
+
   for (ObjFile *File : ObjFile::Instances)
     addObjFile(File);
 
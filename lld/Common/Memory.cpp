@@ -14,6 +14,7 @@ using namespace lld;
 BumpPtrAllocator lld::BAlloc;
 StringSaver lld::Saver{BAlloc};
 std::vector<SpecificAllocBase *> lld::SpecificAllocBase::Instances;
+std::mutex lld::SpecificAllocBase::Mu;
 
 void lld::freeArena() {
   for (SpecificAllocBase *Alloc : SpecificAllocBase::Instances)
@@ -9,15 +9,22 @@
 #include "lld/Common/Timer.h"
 #include "lld/Common/ErrorHandler.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/TimeProfiler.h"
 
 using namespace lld;
 using namespace llvm;
 
-ScopedTimer::ScopedTimer(Timer &T) : T(&T) { T.start(); }
+// Scoped timers double as --time-trace sections, so every phase that is
+// timed for /time also shows up in the trace.
+ScopedTimer::ScopedTimer(Timer &T) : T(&T) {
+  T.start();
+  timeTraceProfilerBegin(T.getName(), StringRef(""));
+}
 
 void ScopedTimer::stop() {
   if (!T)
     return;
+  timeTraceProfilerEnd();
   T->stop();
   T = nullptr;
 }
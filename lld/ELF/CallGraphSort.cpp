@@ -38,6 +38,10 @@
 ///   * If not, then combine the clusters.
 /// * Sort non-empty clusters by density
 ///
+/// Edges from code to data sections, which carry the number of accesses to the
+/// data, are not used to form clusters but add to the weight of the data
+/// sections, so that hot data is placed together as well.
+///
 //===----------------------------------------------------------------------===//
 
 #include "CallGraphSort.h"
@@ -46,6 +50,7 @@
 #include "Symbols.h"
 
 using namespace llvm;
+using namespace llvm::ELF;
 using namespace lld;
 using namespace lld::elf;
 
@@ -123,8 +128,16 @@ CallGraphSort::CallGraphSort() {
     // output.  This messes with the cluster size and density calculations.  We
     // would also end up moving input sections in other output sections without
     // moving them closer to what calls them.
-    if (FromSB->getOutputSection() != ToSB->getOutputSection())
+    //
+    // The exception is an edge from code to data, whose weight is the number
+    // of accesses to the data. It can't bring the data closer to the code, but
+    // it still counts towards the weight of the data section, so that hot data
+    // is grouped together, by density, at the start of its output section.
+    if (FromSB->getOutputSection() != ToSB->getOutputSection()) {
+      if ((FromSB->Flags & SHF_EXECINSTR) && !(ToSB->Flags & SHF_EXECINSTR))
+        Clusters[GetOrCreateNode(ToSB)].Weight += Weight;
       continue;
+    }
 
     int From = GetOrCreateNode(FromSB);
     int To = GetOrCreateNode(ToSB);
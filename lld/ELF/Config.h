@@ -11,11 +11,13 @@
 
 #include "lld/Common/ErrorHandler.h"
 #include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/BinaryFormat/ELF.h"
 #include "llvm/Support/CachePruning.h"
 #include "llvm/Support/CodeGen.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
 #include <atomic>
 #include <vector>
@@ -37,6 +39,9 @@ enum ELFKind {
 // For --build-id.
 enum class BuildIdKind { None, Fast, Md5, Sha1, Hexstring, Uuid };
 
+// For --compress-debug-sections.
+enum class DebugCompressionKind { None, Zlib, Zstd };
+
 // For --discard-{all,locals,none}.
 enum class DiscardPolicy { Default, All, Locals, None };
 
@@ -83,6 +88,7 @@ struct VersionDefinition {
 struct Configuration {
   uint8_t OSABI = 0;
   llvm::CachePruningPolicy ThinLTOCachePolicy;
+  llvm::Optional<llvm::compression::Format> ThinLTOCacheCompression;
   llvm::StringMap<uint64_t> SectionStartMap;
   llvm::StringRef Chroot;
   llvm::StringRef DynamicLinker;
@@ -105,7 +111,12 @@ struct Configuration {
   llvm::StringRef SoName;
   llvm::StringRef Sysroot;
   llvm::StringRef ThinLTOCacheDir;
+  llvm::StringRef ThinLTOCacheSharedDir;
+  llvm::StringRef ThinLTODistributor;
+  llvm::StringRef ThinLTODistributorStats;
+  llvm::StringRef ThinLTOImportState;
   llvm::StringRef ThinLTOIndexOnlyArg;
+  llvm::StringRef TimeTraceFile;
   std::pair<llvm::StringRef, llvm::StringRef> ThinLTOObjectSuffixReplace;
   std::pair<llvm::StringRef, llvm::StringRef> ThinLTOPrefixReplace;
   std::string Rpath;
@@ -114,6 +125,7 @@ struct Configuration {
   std::vector<llvm::StringRef> FilterList;
   std::vector<llvm::StringRef> SearchPaths;
   std::vector<llvm::StringRef> SymbolOrderingFile;
+  std::vector<llvm::StringRef> ThinLTODistributorArgs;
   std::vector<llvm::StringRef> Undefined;
   std::vector<SymbolVersion> DynamicList;
   std::vector<SymbolVersion> VersionScriptGlobals;
@@ -129,12 +141,13 @@ struct Configuration {
   bool ARMHasMovtMovw = false;
   bool ARMJ1J2BranchEncoding = false;
   bool AsNeeded = false;
+  bool AsyncWriteback;
   bool Bsymbolic;
   bool BsymbolicFunctions;
   bool CallGraphProfileSort;
   bool CheckSections;
-  bool CompressDebugSections;
   bool Cref;
+  bool DebugNames;
   bool DefineCommon;
   bool Demangle = true;
   bool DependentLibraries;
@@ -181,6 +194,7 @@ struct Configuration {
   bool Trace;
   bool ThinLTOEmitImportsFiles;
   bool ThinLTOIndexOnly;
+  bool TimeTraceEnabled;
   bool TocOptimize;
   bool UndefinedVersion;
   bool UseAndroidRelrTags = false;
@@ -209,6 +223,7 @@ struct Configuration {
   bool ZText;
   bool ZRetpolineplt;
   bool ZWxneeded;
+  DebugCompressionKind CompressDebugSections;
   DiscardPolicy Discard;
   ICFLevel ICF;
   OrphanHandlingPolicy OrphanHandling;
@@ -223,13 +238,17 @@ struct Configuration {
   uint16_t EMachine = llvm::ELF::EM_NONE;
   llvm::Optional<uint64_t> ImageBase;
   uint64_t CommonPageSize;
+  uint64_t HotTextAlign;
   uint64_t MaxPageSize;
   uint64_t MipsGotSize;
   uint64_t ZStackSize;
   unsigned LTOPartitions;
   unsigned LTOO;
   unsigned Optimize;
+  unsigned ThinLTODistributorRetries;
   unsigned ThinLTOJobs;
+  unsigned ThinLTOMemoryBudget;
+  unsigned ThinLTOSplitCodeGenThreshold;
   int32_t SplitStackAdjustSize;
 
   // The following config options do not directly correspond to any
@@ -36,6 +36,7 @@ template <class ELFT> LLDDwarfObj<ELFT>::LLDDwarfObj(ObjFile<ELFT> *Obj) {
                 .Case(".debug_gnu_pubnames", &GnuPubNamesSection)
                 .Case(".debug_gnu_pubtypes", &GnuPubTypesSection)
                 .Case(".debug_info", &InfoSection)
+                .Case(".debug_names", &NamesSection)
                 .Case(".debug_ranges", &RangeSection)
                 .Case(".debug_rnglists", &RngListsSection)
                 .Case(".debug_line", &LineSection)
@@ -56,6 +56,10 @@ public:
     return GnuPubTypesSection;
   }
 
+  const llvm::DWARFSection &getDebugNamesSection() const override {
+    return NamesSection;
+  }
+
   StringRef getFileName() const override { return ""; }
   StringRef getAbbrevSection() const override { return AbbrevSection; }
   StringRef getStringSection() const override { return StrSection; }
@@ -77,6 +81,7 @@ private:
   LLDDWARFSection GnuPubNamesSection;
   LLDDWARFSection GnuPubTypesSection;
   LLDDWARFSection InfoSection;
+  LLDDWARFSection NamesSection;
   LLDDWARFSection RangeSection;
   LLDDWARFSection RngListsSection;
   LLDDWARFSection LineSection;
@@ -54,6 +54,7 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TarWriter.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdlib>
 #include <utility>
@@ -299,6 +300,9 @@ static void checkOptions() {
   if (Config->TocOptimize && Config->EMachine != EM_PPC64)
     error("--toc-optimize is only supported on the PowerPC64 target");
 
+  if (!isPowerOf2_64(Config->HotTextAlign) && Config->HotTextAlign != 0)
+    error("--hot-text-align: value isn't a power of 2");
+
   if (Config->Pie && Config->Shared)
     error("-shared and -pie may not be used together");
 
@@ -321,6 +325,8 @@ static void checkOptions() {
       error("-r and --gc-sections may not be used together");
     if (Config->GdbIndex)
       error("-r and --gdb-index may not be used together");
+    if (Config->DebugNames)
+      error("-r and --debug-names may not be used together");
     if (Config->ICF != ICFLevel::None)
       error("-r and --icf may not be used together");
     if (Config->Pie)
@@ -436,37 +442,52 @@ void LinkerDriver::main(ArrayRef<const char *> ArgsArr) {
   if (Args.hasArg(OPT_version))
     return;
 
-  initLLVM();
-  createFiles(Args);
-  if (errorCount())
-    return;
+  if (Config->TimeTraceEnabled)
+    timeTraceProfilerInitialize(args::getFilenameWithoutExe(Config->ProgName));
 
-  inferMachineType();
-  setConfigs(Args);
-  checkOptions();
-  if (errorCount())
-    return;
+  {
+    llvm::TimeTraceScope TimeScope("Link", StringRef(""));
 
-  // The Target instance handles target-specific stuff, such as applying
-  // relocations or writing a PLT section. It also contains target-dependent
-  // values such as a default image base address.
-  Target = getTarget();
+    initLLVM();
+    createFiles(Args);
+    if (errorCount())
+      return;
 
-  switch (Config->EKind) {
-  case ELF32LEKind:
-    link<ELF32LE>(Args);
-    return;
-  case ELF32BEKind:
-    link<ELF32BE>(Args);
-    return;
-  case ELF64LEKind:
-    link<ELF64LE>(Args);
-    return;
-  case ELF64BEKind:
-    link<ELF64BE>(Args);
-    return;
-  default:
-    llvm_unreachable("unknown Config->EKind");
+    inferMachineType();
+    setConfigs(Args);
+    checkOptions();
+    if (errorCount())
+      return;
+
+    // The Target instance handles target-specific stuff, such as applying
+    // relocations or writing a PLT section. It also contains target-dependent
+    // values such as a default image base address.
+    Target = getTarget();
+
+    switch (Config->EKind) {
+    case ELF32LEKind:
+      link<ELF32LE>(Args);
+      break;
+    case ELF32BEKind:
+      link<ELF32BE>(Args);
+      break;
+    case ELF64LEKind:
+      link<ELF64LE>(Args);
+      break;
+    case ELF64BEKind:
+      link<ELF64BE>(Args);
+      break;
+    default:
+      llvm_unreachable("unknown Config->EKind");
+    }
+  }
+
+  // Handle --time-trace.
+  if (Config->TimeTraceEnabled) {
+    if (Error E =
+            timeTraceProfilerWrite(Config->TimeTraceFile, Config->OutputFile))
+      error("--time-trace: " + toString(std::move(E)));
+    timeTraceProfilerCleanup();
   }
 }
 
@@ -722,15 +743,40 @@ template <class ELFT> static void readCallGraphsFromObjectFiles() {
   }
 }
 
-static bool getCompressDebugSections(opt::InputArgList &Args) {
+static DebugCompressionKind getCompressDebugSections(opt::InputArgList &Args) {
   StringRef S = Args.getLastArgValue(OPT_compress_debug_sections, "none");
   if (S == "none")
-    return false;
-  if (S != "zlib")
-    error("unknown --compress-debug-sections value: " + S);
-  if (!zlib::isAvailable())
-    error("--compress-debug-sections: zlib is not available");
-  return true;
+    return DebugCompressionKind::None;
+  if (S == "zlib") {
+    if (!zlib::isAvailable())
+      error("--compress-debug-sections: zlib is not available");
+    return DebugCompressionKind::Zlib;
+  }
+  if (S == "zstd") {
+    if (!zstd::isAvailable())
+      error("--compress-debug-sections: zstd is not available");
+    return DebugCompressionKind::Zstd;
+  }
+  error("unknown --compress-debug-sections value: " + S);
+  return DebugCompressionKind::None;
+}
+
+static Optional<compression::Format>
+getThinLTOCacheCompression(opt::InputArgList &Args) {
+  StringRef S = Args.getLastArgValue(OPT_thinlto_cache_compression_eq, "none");
+  if (S == "none")
+    return None;
+  for (compression::Format F :
+       {compression::Format::Zlib, compression::Format::Zstd,
+        compression::Format::LZ4}) {
+    if (S != compression::getName(F))
+      continue;
+    if (!compression::isAvailable(F))
+      error("--thinlto-cache-compression: " + S + " is not available");
+    return F;
+  }
+  error("unknown --thinlto-cache-compression value: " + S);
+  return None;
 }
 
 static std::pair<StringRef, StringRef> getOldNewOptions(opt::InputArgList &Args,
@@ -781,6 +827,8 @@ static void readConfigs(opt::InputArgList &Args) {
   Config->AllowShlibUndefined =
       Args.hasFlag(OPT_allow_shlib_undefined, OPT_no_allow_shlib_undefined,
                    Args.hasArg(OPT_shared));
+  Config->AsyncWriteback =
+      Args.hasFlag(OPT_async_writeback, OPT_no_async_writeback, false);
   Config->AuxiliaryList = args::getStrings(Args, OPT_auxiliary);
   Config->Bsymbolic = Args.hasArg(OPT_Bsymbolic);
   Config->BsymbolicFunctions = Args.hasArg(OPT_Bsymbolic_functions);
@@ -789,6 +837,8 @@ static void readConfigs(opt::InputArgList &Args) {
   Config->Chroot = Args.getLastArgValue(OPT_chroot);
   Config->CompressDebugSections = getCompressDebugSections(Args);
   Config->Cref = Args.hasFlag(OPT_cref, OPT_no_cref, false);
+  Config->DebugNames =
+      Args.hasFlag(OPT_debug_names, OPT_no_debug_names, false);
   Config->DefineCommon = Args.hasFlag(OPT_define_common, OPT_no_define_common,
                                       !Args.hasArg(OPT_relocatable));
   Config->Demangle = Args.hasFlag(OPT_demangle, OPT_no_demangle, true);
@@ -816,6 +866,7 @@ static void readConfigs(opt::InputArgList &Args) {
   Config->GcSections = Args.hasFlag(OPT_gc_sections, OPT_no_gc_sections, false);
   Config->GnuUnique = Args.hasFlag(OPT_gnu_unique, OPT_no_gnu_unique, true);
   Config->GdbIndex = Args.hasFlag(OPT_gdb_index, OPT_no_gdb_index, false);
+  Config->HotTextAlign = args::getInteger(Args, OPT_hot_text_align, 0);
   Config->ICF = getICF(Args);
   Config->IgnoreDataAddressEquality =
       Args.hasArg(OPT_ignore_data_address_equality);
@@ -869,20 +920,38 @@ static void readConfigs(opt::InputArgList &Args) {
   Config->Target1Rel = Args.hasFlag(OPT_target1_rel, OPT_target1_abs, false);
   Config->Target2 = getTarget2(Args);
   Config->ThinLTOCacheDir = Args.getLastArgValue(OPT_thinlto_cache_dir);
+  Config->ThinLTOCacheCompression = getThinLTOCacheCompression(Args);
   Config->ThinLTOCachePolicy = CHECK(
       parseCachePruningPolicy(Args.getLastArgValue(OPT_thinlto_cache_policy)),
       "--thinlto-cache-policy: invalid cache policy");
+  Config->ThinLTOCacheSharedDir =
+      Args.getLastArgValue(OPT_thinlto_cache_shared_dir_eq);
+  Config->ThinLTODistributor = Args.getLastArgValue(OPT_thinlto_distributor_eq);
+  Config->ThinLTODistributorArgs =
+      args::getStrings(Args, OPT_thinlto_distributor_arg_eq);
+  Config->ThinLTODistributorRetries =
+      args::getInteger(Args, OPT_thinlto_distributor_retries_eq, 0);
+  Config->ThinLTODistributorStats =
+      Args.getLastArgValue(OPT_thinlto_distributor_stats_eq);
   Config->ThinLTOEmitImportsFiles =
       Args.hasArg(OPT_plugin_opt_thinlto_emit_imports_files);
   Config->ThinLTOIndexOnly = Args.hasArg(OPT_plugin_opt_thinlto_index_only) ||
                              Args.hasArg(OPT_plugin_opt_thinlto_index_only_eq);
   Config->ThinLTOIndexOnlyArg =
       Args.getLastArgValue(OPT_plugin_opt_thinlto_index_only_eq);
+  Config->ThinLTOImportState =
+      Args.getLastArgValue(OPT_thinlto_import_state_eq);
   Config->ThinLTOJobs = args::getInteger(Args, OPT_thinlto_jobs, -1u);
+  Config->ThinLTOMemoryBudget =
+      args::getInteger(Args, OPT_thinlto_memory_budget_eq, 0);
+  Config->ThinLTOSplitCodeGenThreshold =
+      args::getInteger(Args, OPT_thinlto_split_codegen_threshold_eq, 0);
   Config->ThinLTOObjectSuffixReplace =
       getOldNewOptions(Args, OPT_plugin_opt_thinlto_object_suffix_replace_eq);
   Config->ThinLTOPrefixReplace =
       getOldNewOptions(Args, OPT_plugin_opt_thinlto_prefix_replace_eq);
+  Config->TimeTraceEnabled = Args.hasArg(OPT_time_trace);
+  Config->TimeTraceFile = Args.getLastArgValue(OPT_time_trace_file_eq);
   Config->Trace = Args.hasArg(OPT_trace);
   Config->Undefined = args::getStrings(Args, OPT_undefined);
   Config->UndefinedVersion =
@@ -1093,6 +1162,19 @@ void LinkerDriver::createFiles(opt::InputArgList &Args) {
   // For --{push,pop}-state.
   std::vector<std::tuple<bool, bool, bool>> Stack;
 
+  // Input files are read one at a time below. Start reading all of them in
+  // the background first, so that we don't wait for each one in turn on slow
+  // or cold file systems.
+  std::vector<std::string> Prefetch;
+  for (auto *Arg : Args.filtered(OPT_INPUT)) {
+    StringRef Path = Arg->getValue();
+    if (!Config->Chroot.empty() && Path.startswith("/"))
+      Prefetch.push_back((Config->Chroot + Path).str());
+    else
+      Prefetch.push_back(Path);
+  }
+  sys::fs::prefetchFiles(Prefetch);
+
   // Iterate over argv to process input files and positional arguments.
   for (auto *Arg : Args) {
     switch (Arg->getOption().getUnaliasedOption().getID()) {
@@ -1496,6 +1578,7 @@ static Symbol *addUndefined(StringRef Name) {
 // Because all bitcode files that the program consists of are passed to
 // the compiler at once, it can do a whole-program optimization.
 template <class ELFT> void LinkerDriver::compileBitcodeFiles() {
+  llvm::TimeTraceScope TimeScope("LTO", StringRef(""));
   // Compile bitcode files and replace bitcode symbols.
   LTO.reset(new BitcodeCompiler);
   for (BitcodeFile *File : BitcodeFiles)
@@ -1628,12 +1711,20 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &Args) {
   for (auto *Arg : Args.filtered(OPT_trace_symbol))
     Symtab->insert(Arg->getValue())->Traced = true;
 
-  // Add all files to the symbol table. This will add almost all
-  // symbols that we need to the symbol table. This process might
-  // add files to the link, via autolinking, these files are always
-  // appended to the Files vector.
-  for (size_t I = 0; I < Files.size(); ++I)
-    parseFile(Files[I]);
+  {
+    llvm::TimeTraceScope TimeScope("Parse input files", StringRef(""));
+
+    // Hashing symbol names is a significant part of symbol resolution, but it
+    // doesn't depend on the symbol table, so we do that in parallel first.
+    parallelForEach(Files, precomputeSymbolKeys);
+
+    // Add all files to the symbol table. This will add almost all
+    // symbols that we need to the symbol table. This process might
+    // add files to the link, via autolinking, these files are always
+    // appended to the Files vector.
+    for (size_t I = 0; I < Files.size(); ++I)
+      parseFile(Files[I]);
+  }
 
   // Now that we have every file, we can decide if we will need a
   // dynamic symbol table.
@@ -82,6 +82,7 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/BinaryFormat/ELF.h"
 #include "llvm/Object/ELF.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/xxhash.h"
 #include <algorithm>
 #include <atomic>
@@ -502,7 +503,10 @@ template <class ELFT> void ICF<ELFT>::run() {
 }
 
 // ICF entry point function.
-template <class ELFT> void elf::doIcf() { ICF<ELFT>().run(); }
+template <class ELFT> void elf::doIcf() {
+  llvm::TimeTraceScope TimeScope("ICF", StringRef(""));
+  ICF<ELFT>().run();
+}
 
 template void elf::doIcf<ELF32LE>();
 template void elf::doIcf<ELF32BE>();
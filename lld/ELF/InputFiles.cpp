@@ -15,6 +15,7 @@
 #include "SyntheticSections.h"
 #include "lld/Common/ErrorHandler.h"
 #include "lld/Common/Memory.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/CodeGen/Analysis.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
@@ -48,6 +49,9 @@ std::vector<SharedFile *> elf::SharedFiles;
 
 std::unique_ptr<TarWriter> elf::Tar;
 
+// The buffers returned by readFile(), by their start address.
+static DenseMap<const char *, MemoryBuffer *> FileBuffers;
+
 static ELFKind getELFKind(MemoryBufferRef MB, StringRef ArchiveName) {
   unsigned char Size;
   unsigned char Endian;
@@ -101,7 +105,11 @@ Optional<MemoryBufferRef> elf::readFile(StringRef Path) {
   }
 
   std::unique_ptr<MemoryBuffer> &MB = *MBOrErr;
+  // We are going to read most of the file, so let the OS read it ahead
+  // rather than taking a page fault for each page we touch.
+  MB->adviseIfMmap(sys::fs::mapped_file_region::advice::willneed);
   MemoryBufferRef MBRef = MB->getMemBufferRef();
+  FileBuffers[MBRef.getBufferStart()] = MB.get();
   make<std::unique_ptr<MemoryBuffer>>(std::move(MB)); // take MB ownership
 
   if (Tar)
@@ -109,6 +117,13 @@ Optional<MemoryBufferRef> elf::readFile(StringRef Path) {
   return MBRef;
 }
 
+void elf::releaseFilePages(MemoryBufferRef MB) {
+  auto It = FileBuffers.find(MB.getBufferStart());
+  if (It != FileBuffers.end() &&
+      It->second->getBufferSize() == MB.getBufferSize())
+    It->second->adviseIfMmap(sys::fs::mapped_file_region::advice::dontneed);
+}
+
 // All input object files must be for the same architecture
 // (e.g. it does not make sense to link x86 object files with
 // MIPS object files.) This function checks for that error.
@@ -205,6 +220,29 @@ void elf::parseFile(InputFile *File) {
   }
 }
 
+void elf::precomputeSymbolKeys(InputFile *File) {
+  // Incompatible files are reported by parseFile.
+  if (File->kind() != InputFile::ObjKind || File->EKind != Config->EKind)
+    return;
+
+  switch (Config->EKind) {
+  case ELF32LEKind:
+    cast<ObjFile<ELF32LE>>(File)->precomputeSymbolKeys();
+    return;
+  case ELF32BEKind:
+    cast<ObjFile<ELF32BE>>(File)->precomputeSymbolKeys();
+    return;
+  case ELF64LEKind:
+    cast<ObjFile<ELF64LE>>(File)->precomputeSymbolKeys();
+    return;
+  case ELF64BEKind:
+    cast<ObjFile<ELF64BE>>(File)->precomputeSymbolKeys();
+    return;
+  default:
+    llvm_unreachable("unknown ELFT");
+  }
+}
+
 // Concatenates arguments to construct a string representing an error location.
 static std::string createFileLineMsg(StringRef Path, unsigned Line) {
   std::string Filename = path::filename(Path);
@@ -460,6 +498,26 @@ void ObjFile<ELFT>::parse(
   initializeSymbols();
 }
 
+// Reading symbol names and hashing them doesn't depend on the symbol table,
+// so we can do that for all files in parallel before resolving symbols.
+// Symbol resolution itself stays serial so that results are deterministic.
+// If we find anything unusual, we give up so that initializeSymbols() can
+// report an error.
+template <class ELFT> void ObjFile<ELFT>::precomputeSymbolKeys() {
+  ArrayRef<Elf_Sym> ESyms = this->getGlobalELFSyms<ELFT>();
+  SymbolKeys.reserve(ESyms.size());
+
+  for (const Elf_Sym &ESym : ESyms) {
+    Expected<StringRef> NameOrErr = ESym.getName(this->StringTable);
+    if (!NameOrErr) {
+      consumeError(NameOrErr.takeError());
+      SymbolKeys.clear();
+      return;
+    }
+    SymbolKeys.push_back(getSymbolTableKey(*NameOrErr));
+  }
+}
+
 // Sections with SHT_GROUP and comdat bits define comdat section groups.
 // They are identified and deduplicated by group name. This function
 // returns a group name.
@@ -963,10 +1021,18 @@ template <class ELFT> void ObjFile<ELFT>::initializeSymbols() {
 
   // Our symbol table may have already been partially initialized
   // because of LazyObjFile.
-  for (size_t I = 0, End = ESyms.size(); I != End; ++I)
-    if (!this->Symbols[I] && ESyms[I].getBinding() != STB_LOCAL)
+  for (size_t I = 0, End = ESyms.size(); I != End; ++I) {
+    if (this->Symbols[I] || ESyms[I].getBinding() == STB_LOCAL)
+      continue;
+    if (!SymbolKeys.empty() && I >= this->FirstGlobal)
+      this->Symbols[I] = Symtab->insert(SymbolKeys[I - this->FirstGlobal]);
+    else
       this->Symbols[I] =
           Symtab->insert(CHECK(ESyms[I].getName(this->StringTable), this));
+  }
+
+  // We no longer need the keys.
+  SymbolKeys = {};
 
   // Fill this->Symbols. A symbol is either local or global.
   for (size_t I = 0, End = ESyms.size(); I != End; ++I) {
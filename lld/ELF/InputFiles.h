@@ -54,9 +54,18 @@ extern std::unique_ptr<llvm::TarWriter> Tar;
 // Opens a given file.
 llvm::Optional<MemoryBufferRef> readFile(StringRef Path);
 
+// Tells the OS that the contents of a file returned by readFile() won't be
+// needed for a while, so that its pages can be dropped from memory. They are
+// read back from the file if they are accessed again.
+void releaseFilePages(MemoryBufferRef MB);
+
 // Add symbols in File to the symbol table.
 void parseFile(InputFile *File);
 
+// Compute symbol table keys of File's global symbols so that parseFile
+// doesn't have to. Unlike parseFile, this function is thread-safe.
+void precomputeSymbolKeys(InputFile *File);
+
 // The root class of input files.
 class InputFile {
 public:
@@ -204,6 +213,8 @@ public:
   void parse(llvm::DenseMap<llvm::CachedHashStringRef, const InputFile *>
                  &ComdatGroups);
 
+  void precomputeSymbolKeys();
+
   StringRef getShtGroupSignature(ArrayRef<Elf_Shdr> Sections,
                                  const Elf_Shdr &Sec);
 
@@ -276,6 +287,10 @@ private:
   // .shstrtab contents.
   StringRef SectionStringTable;
 
+  // Symbol table keys of global symbols, computed by precomputeSymbolKeys()
+  // ahead of symbol resolution. Empty if they were not precomputed.
+  std::vector<llvm::CachedHashStringRef> SymbolKeys;
+
   // Debugging information to retrieve source file and line for error
   // reporting. Linker may find reasonable number of errors in a
   // single object file, so we cache debugging information in order to
@@ -79,16 +79,12 @@ InputSectionBase::InputSectionBase(InputFile *File, uint64_t Flags,
     fatal(toString(this) + ": sh_addralign is not a power of 2");
   this->Alignment = V;
 
-  // In ELF, each section can be compressed by zlib, and if compressed,
-  // section name may be mangled by appending "z" (e.g. ".zdebug_info").
-  // If that's the case, demangle section name so that we can handle a
-  // section as if it weren't compressed.
-  if ((Flags & SHF_COMPRESSED) || Name.startswith(".zdebug")) {
-    if (!zlib::isAvailable())
-      error(toString(File) + ": contains a compressed section, " +
-            "but zlib is not available");
+  // In ELF, each section can be compressed by zlib or zstd, and if
+  // compressed, section name may be mangled by appending "z" (e.g.
+  // ".zdebug_info"). If that's the case, demangle section name so that we
+  // can handle a section as if it weren't compressed.
+  if ((Flags & SHF_COMPRESSED) || Name.startswith(".zdebug"))
     parseCompressedHeader();
-  }
 }
 
 // Drop SHF_GROUP bit unless we are producing a re-linkable object file.
@@ -151,13 +147,19 @@ void InputSectionBase::uncompress() const {
     UncompressedBuf = BAlloc.Allocate<char>(Size);
   }
 
-  if (Error E = zlib::uncompress(toStringRef(RawData), UncompressedBuf, Size))
-    fatal(toString(this) +
-          ": uncompress failed: " + llvm::toString(std::move(E)));
+  uncompressTo(UncompressedBuf, Size);
   RawData = makeArrayRef((uint8_t *)UncompressedBuf, Size);
   UncompressedSize = -1;
 }
 
+void InputSectionBase::uncompressTo(char *Buf, size_t &Size) const {
+  compression::Format F = CompressedWithZstd ? compression::Format::Zstd
+                                             : compression::Format::Zlib;
+  if (Error E = compression::uncompress(F, toStringRef(RawData), Buf, Size))
+    fatal(toString(this) +
+          ": uncompress failed: " + llvm::toString(std::move(E)));
+}
+
 uint64_t InputSectionBase::getOffsetInFile() const {
   const uint8_t *FileStart = (const uint8_t *)File->MB.getBufferStart();
   const uint8_t *SecStart = data().begin();
@@ -206,9 +208,34 @@ OutputSection *SectionBase::getOutputSection() {
   return Sec ? Sec->getParent() : nullptr;
 }
 
+// Records the compression format of a section given its ch_type, or reports
+// an error if we can't decompress it.
+bool InputSectionBase::setCompressionType(uint32_t Type) {
+  compression::Format F;
+  switch (Type) {
+  case ELFCOMPRESS_ZLIB:
+    F = compression::Format::Zlib;
+    break;
+  case ELFCOMPRESS_ZSTD:
+    F = compression::Format::Zstd;
+    break;
+  default:
+    error(toString(this) + ": unsupported compression type");
+    return false;
+  }
+
+  if (!compression::isAvailable(F)) {
+    error(toString(File) + ": contains a compressed section, but " +
+          compression::getName(F) + " is not available");
+    return false;
+  }
+  CompressedWithZstd = F == compression::Format::Zstd;
+  return true;
+}
+
 // When a section is compressed, `RawData` consists with a header followed
-// by zlib-compressed data. This function parses a header to initialize
-// `UncompressedSize` member and remove the header from `RawData`.
+// by zlib- or zstd-compressed data. This function parses a header to
+// initialize `UncompressedSize` member and remove the header from `RawData`.
 void InputSectionBase::parseCompressedHeader() {
   using Chdr64 = typename ELF64LE::Chdr;
   using Chdr32 = typename ELF32LE::Chdr;
@@ -226,6 +253,12 @@ void InputSectionBase::parseCompressedHeader() {
       return;
     }
 
+    if (!zlib::isAvailable()) {
+      error(toString(File) + ": contains a compressed section, " +
+            "but zlib is not available");
+      return;
+    }
+
     UncompressedSize = read64be(RawData.data());
     RawData = RawData.slice(8);
 
@@ -246,10 +279,8 @@ void InputSectionBase::parseCompressedHeader() {
     }
 
     auto *Hdr = reinterpret_cast<const Chdr64 *>(RawData.data());
-    if (Hdr->ch_type != ELFCOMPRESS_ZLIB) {
-      error(toString(this) + ": unsupported compression type");
+    if (!setCompressionType(Hdr->ch_type))
       return;
-    }
 
     UncompressedSize = Hdr->ch_size;
     Alignment = std::max<uint32_t>(Hdr->ch_addralign, 1);
@@ -264,10 +295,8 @@ void InputSectionBase::parseCompressedHeader() {
   }
 
   auto *Hdr = reinterpret_cast<const Chdr32 *>(RawData.data());
-  if (Hdr->ch_type != ELFCOMPRESS_ZLIB) {
-    error(toString(this) + ": unsupported compression type");
+  if (!setCompressionType(Hdr->ch_type))
     return;
-  }
 
   UncompressedSize = Hdr->ch_size;
   Alignment = std::max<uint32_t>(Hdr->ch_addralign, 1);
@@ -1081,10 +1110,7 @@ template <class ELFT> void InputSection::writeTo(uint8_t *Buf) {
   // to the buffer.
   if (UncompressedSize >= 0) {
     size_t Size = UncompressedSize;
-    if (Error E = zlib::uncompress(toStringRef(RawData),
-                                   (char *)(Buf + OutSecOff), Size))
-      fatal(toString(this) +
-            ": uncompress failed: " + llvm::toString(std::move(E)));
+    uncompressTo((char *)(Buf + OutSecOff), Size);
     uint8_t *BufEnd = Buf + OutSecOff + Size;
     relocate<ELFT>(Buf, BufEnd);
     return;
@@ -1195,7 +1221,7 @@ void MergeInputSection::splitStrings(ArrayRef<uint8_t> Data, size_t EntSize) {
       fatal(toString(this) + ": string is not null terminated");
     size_t Size = End + EntSize;
 
-    Pieces.emplace_back(Off, xxHash64(S.substr(0, Size)), !IsAlloc);
+    Pieces.emplace_back(Off, xxh3_64bits(S.substr(0, Size)), !IsAlloc);
     S = S.substr(Size);
     Off += Size;
   }
@@ -1210,7 +1236,7 @@ void MergeInputSection::splitNonStrings(ArrayRef<uint8_t> Data,
   bool IsAlloc = Flags & SHF_ALLOC;
 
   for (size_t I = 0; I != Size; I += EntSize)
-    Pieces.emplace_back(I, xxHash64(Data.slice(I, EntSize)), !IsAlloc);
+    Pieces.emplace_back(I, xxh3_64bits(Data.slice(I, EntSize)), !IsAlloc);
 }
 
 template <class ELFT>
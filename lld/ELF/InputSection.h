@@ -51,7 +51,7 @@ public:
 
   unsigned SectionKind : 3;
 
-  // The next three bit fields are only used by InputSectionBase, but we
+  // The next four bit fields are only used by InputSectionBase, but we
   // put them here so the struct packs better.
 
   // True if this section has already been placed to a linker script
@@ -72,6 +72,10 @@ public:
   // Set for sections that should not be folded by ICF.
   unsigned KeepUnique : 1;
 
+  // True if RawData is compressed with zstd rather than zlib. Only
+  // meaningful if the section is compressed.
+  unsigned CompressedWithZstd : 1;
+
   // The 1-indexed partition that this section is assigned to by the garbage
   // collector, or 0 if this section is dead. Normally there is only one
   // partition, so this will either be 0 or 1.
@@ -105,7 +109,8 @@ protected:
               uint64_t Entsize, uint64_t Alignment, uint32_t Type,
               uint32_t Info, uint32_t Link)
       : Name(Name), Repl(this), SectionKind(SectionKind), Assigned(false),
-        Bss(false), KeepUnique(false), Partition(0), Alignment(Alignment),
+        Bss(false), KeepUnique(false), CompressedWithZstd(false),
+        Partition(0), Alignment(Alignment),
         Flags(Flags), Entsize(Entsize), Type(Type), Link(Link), Info(Info) {}
 };
 
@@ -211,7 +216,9 @@ public:
 
 protected:
   void parseCompressedHeader();
+  bool setCompressionType(uint32_t Type);
   void uncompress() const;
+  void uncompressTo(char *Buf, size_t &Size) const;
 
   mutable ArrayRef<uint8_t> RawData;
 
@@ -31,6 +31,7 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Threading.h"
 #include <algorithm>
 #include <cstddef>
 #include <memory>
@@ -107,6 +108,8 @@ static lto::Config createConfig() {
 
   C.CSIRProfile = Config->LTOCSProfileFile;
   C.RunCSIRInstr = Config->LTOCSProfileGenerate;
+  C.ThinLTOImportStateFile = Config->ThinLTOImportState;
+  C.ThinLTOSplitCodeGenThreshold = Config->ThinLTOSplitCodeGenThreshold;
 
   if (Config->EmitLLVM) {
     C.PostInternalizeModuleHook = [](size_t Task, const Module &M) {
@@ -134,8 +137,25 @@ BitcodeCompiler::BitcodeCompiler() {
     Backend = lto::createWriteIndexesThinBackend(
         Config->ThinLTOPrefixReplace.first, Config->ThinLTOPrefixReplace.second,
         Config->ThinLTOEmitImportsFiles, IndexFile.get(), OnIndexWrite);
-  } else if (Config->ThinLTOJobs != -1U) {
-    Backend = lto::createInProcessThinBackend(Config->ThinLTOJobs);
+  } else if (!Config->ThinLTODistributor.empty()) {
+    // The jobs run elsewhere, so the local core count only matters as a
+    // default for how many are in flight at once.
+    unsigned Jobs = Config->ThinLTOJobs != -1U
+                        ? Config->ThinLTOJobs
+                        : llvm::heavyweight_hardware_concurrency();
+    Backend = lto::createExecutorThinBackend(
+        lto::createProcessThinBackendExecutor(
+            Config->ThinLTODistributor,
+            std::vector<std::string>(Config->ThinLTODistributorArgs.begin(),
+                                     Config->ThinLTODistributorArgs.end()),
+            Jobs, Config->ThinLTODistributorRetries,
+            Config->ThinLTODistributorStats));
+  } else if (Config->ThinLTOJobs != -1U || Config->ThinLTOMemoryBudget) {
+    unsigned Jobs = Config->ThinLTOJobs != -1U
+                        ? Config->ThinLTOJobs
+                        : llvm::heavyweight_hardware_concurrency();
+    Backend = lto::createInProcessThinBackend(
+        Jobs, uint64_t(Config->ThinLTOMemoryBudget) << 20);
   }
 
   LTOObj = llvm::make_unique<lto::LTO>(createConfig(), Backend,
@@ -205,6 +225,14 @@ void BitcodeCompiler::add(BitcodeFile &F) {
     R.LinkerRedefined = !Sym->CanInline;
   }
   checkError(LTOObj->add(std::move(F.Obj), Resols));
+
+  // LTO has now read the symbol table and the summary of the file, and it
+  // won't read the file again until it compiles the module, which happens
+  // after all inputs have been added. Let the OS drop the file from memory
+  // until then, so that links with many inputs don't keep all of them
+  // resident through the thin link. Archive members are left alone, as
+  // they share their pages with the rest of the archive.
+  releaseFilePages(F.MB);
 }
 
 // If LazyObjFile has not been added to link, emit empty index files.
@@ -237,13 +265,23 @@ std::vector<InputFile *> BitcodeCompiler::compile() {
   // The --thinlto-cache-dir option specifies the path to a directory in which
   // to cache native object files for ThinLTO incremental builds. If a path was
   // specified, configure LTO to use it as the cache directory.
+  // --thinlto-cache-shared-dir names a second cache directory, typically on
+  // a network file system, that is consulted on a local miss and that new
+  // objects are published to.
   lto::NativeObjectCache Cache;
-  if (!Config->ThinLTOCacheDir.empty())
+  if (!Config->ThinLTOCacheDir.empty()) {
+    lto::LocalCacheOptions Options;
+    Options.Compression = Config->ThinLTOCacheCompression;
+    if (!Config->ThinLTOCacheSharedDir.empty())
+      Options.SecondTier = check(
+          lto::createDirectoryCacheTier(Config->ThinLTOCacheSharedDir));
     Cache = check(
         lto::localCache(Config->ThinLTOCacheDir,
                         [&](size_t Task, std::unique_ptr<MemoryBuffer> MB) {
                           Files[Task] = std::move(MB);
-                        }));
+                        },
+                        std::move(Options)));
+  }
 
   if (!BitcodeFiles.empty())
     checkError(LTOObj->run(
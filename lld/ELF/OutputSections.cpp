@@ -179,22 +179,66 @@ template <class ELFT> void OutputSection::maybeCompress() {
   using Elf_Chdr = typename ELFT::Chdr;
 
   // Compress only DWARF debug sections.
-  if (!Config->CompressDebugSections || (Flags & SHF_ALLOC) ||
-      !Name.startswith(".debug_"))
+  if (Config->CompressDebugSections == DebugCompressionKind::None ||
+      (Flags & SHF_ALLOC) || !Name.startswith(".debug_"))
     return;
+  bool IsZstd = Config->CompressDebugSections == DebugCompressionKind::Zstd;
 
   // Create a section header.
   ZDebugHeader.resize(sizeof(Elf_Chdr));
   auto *Hdr = reinterpret_cast<Elf_Chdr *>(ZDebugHeader.data());
-  Hdr->ch_type = ELFCOMPRESS_ZLIB;
+  Hdr->ch_type = IsZstd ? ELFCOMPRESS_ZSTD : ELFCOMPRESS_ZLIB;
   Hdr->ch_size = Size;
   Hdr->ch_addralign = Alignment;
 
   // Write section contents to a temporary buffer and compress it.
   std::vector<uint8_t> Buf(Size);
   writeTo<ELFT>(Buf.data());
-  if (Error E = zlib::compress(toStringRef(Buf), CompressedData))
-    fatal("compress failed: " + llvm::toString(std::move(E)));
+
+  // Compressing a large section is slow, so we split it into shards and
+  // compress them in parallel.
+  constexpr size_t ShardSize = 1 << 20;
+  size_t NumShards = std::max<size_t>(1, divideCeil(Size, ShardSize));
+  std::vector<SmallVector<char, 0>> Shards(NumShards);
+
+  // A sequence of zstd frames decompresses to the concatenation of their
+  // contents, so each shard simply becomes a frame of its own.
+  if (IsZstd) {
+    parallelForEachN(0, NumShards, [&](size_t I) {
+      StringRef In = toStringRef(Buf).substr(I * ShardSize, ShardSize);
+      if (Error E = zstd::compress(In, Shards[I]))
+        fatal("compress failed: " + llvm::toString(std::move(E)));
+    });
+
+    for (size_t I = 0; I < NumShards; ++I) {
+      CompressedData.append(Shards[I].begin(), Shards[I].end());
+      Shards[I] = {};
+    }
+  } else {
+    // Shards other than the last one are flushed to a byte boundary, so
+    // their concatenation is a valid deflate stream. We then wrap it with a
+    // zlib header and an Adler-32 checksum.
+    std::vector<uint32_t> Checksums(NumShards);
+    parallelForEachN(0, NumShards, [&](size_t I) {
+      StringRef In = toStringRef(Buf).substr(I * ShardSize, ShardSize);
+      if (Error E = zlib::compressShard(In, Shards[I], I == NumShards - 1))
+        fatal("compress failed: " + llvm::toString(std::move(E)));
+      Checksums[I] = zlib::adler32(In);
+    });
+
+    // 0x78 0x01 is a zlib header for deflate with a 32 KiB window.
+    CompressedData = {0x78, 0x01};
+    uint32_t Checksum = 1;
+    for (size_t I = 0; I < NumShards; ++I) {
+      CompressedData.append(Shards[I].begin(), Shards[I].end());
+      Checksum = zlib::adler32Combine(
+          Checksum, Checksums[I],
+          std::min<size_t>(ShardSize, Size - I * ShardSize));
+      Shards[I] = {};
+    }
+    CompressedData.resize(CompressedData.size() + 4);
+    write32be(CompressedData.end() - 4, Checksum);
+  }
 
   // Update section headers.
   Size = sizeof(Elf_Chdr) + CompressedData.size();
@@ -52,6 +52,7 @@
 #include "lld/Common/ErrorHandler.h"
 #include "lld/Common/Memory.h"
 #include "lld/Common/Strings.h"
+#include "lld/Common/Threads.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/raw_ostream.h"
@@ -1289,15 +1290,88 @@ static void scanReloc(InputSectionBase &Sec, OffsetGetter &GetOffset, RelTy *&I,
   processRelocAux<ELFT>(Sec, Expr, Type, Offset, Sym, Rel, Addend);
 }
 
+// Most relocations refer to non-preemptible symbols and need neither GOT nor
+// PLT entries nor dynamic relocations, so scanning them only appends an entry
+// to Sec.Relocations. Classifying a relocation doesn't touch any global state,
+// so we do that for all sections in parallel before the serial scan. This
+// function returns true and fills R if Rel is such a relocation. R.Expr is
+// R_NONE if the relocation should be ignored. Everything else is left for
+// scanReloc().
 template <class ELFT, class RelTy>
-static void scanRelocs(InputSectionBase &Sec, ArrayRef<RelTy> Rels) {
+static bool prescanReloc(InputSectionBase &Sec, const RelTy &Rel,
+                         const RelTy *End, Relocation &R) {
+  // Invalid symbol indices are reported by scanReloc().
+  uint32_t SymIndex = Rel.getSymbol(Config->IsMips64EL);
+  ArrayRef<Symbol *> Syms = Sec.getFile<ELFT>()->getSymbols();
+  if (SymIndex >= Syms.size())
+    return false;
+
+  auto *Sym = dyn_cast<Defined>(Syms[SymIndex]);
+  if (!Sym || Sym->IsPreemptible || Sym->isGnuIFunc() || Sym->isTls())
+    return false;
+
+  RelType Type = Rel.getType(Config->IsMips64EL);
+  const uint8_t *RelocatedAddr = Sec.data().begin() + Rel.r_offset;
+  RelExpr Expr = Target->getRelExpr(Type, *Sym, RelocatedAddr);
+  if (oneof<R_HINT, R_NONE>(Expr)) {
+    R = {R_NONE, Type, Rel.r_offset, 0, Sym};
+    return true;
+  }
+
+  // This is the same relaxation as the one in scanReloc().
+  if (Expr == R_GOT_PC && !isAbsoluteValue(*Sym))
+    Expr = Target->adjustRelaxExpr(Type, RelocatedAddr, Expr);
+  else
+    Expr = fromPlt(Expr);
+
+  if (needsPlt(Expr) || needsGot(Expr) ||
+      oneof<R_GOTPLTONLY_PC, R_GOTPLTREL, R_GOTPLT, R_TLSGD_GOTPLT,
+            R_GOTONLY_PC, R_GOTREL, R_PPC_TOC, R_PPC64_RELAX_TOC>(Expr))
+    return false;
+
+  // Let scanReloc() report relative relocations to absolute symbols.
+  if (Config->Pic && isAbsoluteValue(*Sym) && isRelExpr(Expr))
+    return false;
+  if (!isStaticLinkTimeConstant(Expr, Type, *Sym, Sec, Rel.r_offset))
+    return false;
+
+  int64_t Addend = computeAddend<ELFT>(Rel, End, Sec, Expr, Sym->isLocal());
+  R = {Expr, Type, Rel.r_offset, Addend, Sym};
+  return true;
+}
+
+// Returns the results of prescanReloc() for each relocation in Rels. Symbol is
+// null for relocations that need to be handled by scanReloc().
+template <class ELFT, class RelTy>
+static std::vector<Relocation> prescanRelocs(InputSectionBase &Sec,
+                                             ArrayRef<RelTy> Rels) {
+  std::vector<Relocation> Ret(Rels.size());
+  for (size_t I = 0, E = Rels.size(); I != E; ++I)
+    if (!prescanReloc<ELFT>(Sec, Rels[I], Rels.end(), Ret[I]))
+      Ret[I].Sym = nullptr;
+  return Ret;
+}
+
+template <class ELFT, class RelTy>
+static void scanRelocs(InputSectionBase &Sec, ArrayRef<RelTy> Rels,
+                       ArrayRef<Relocation> Prescanned) {
   OffsetGetter GetOffset(Sec);
 
   // Not all relocations end up in Sec.Relocations, but a lot do.
   Sec.Relocations.reserve(Rels.size());
 
-  for (auto I = Rels.begin(), End = Rels.end(); I != End;)
+  for (auto I = Rels.begin(), End = Rels.end(); I != End;) {
+    if (!Prescanned.empty()) {
+      const Relocation &R = Prescanned[I - Rels.begin()];
+      if (R.Sym) {
+        if (R.Expr != R_NONE)
+          Sec.Relocations.push_back(R);
+        ++I;
+        continue;
+      }
+    }
     scanReloc<ELFT>(Sec, GetOffset, I, End);
+  }
 
   // Sort relocations by offset for more efficient searching for
   // R_RISCV_PCREL_HI20 and R_PPC64_ADDR64.
@@ -1309,11 +1383,40 @@ static void scanRelocs(InputSectionBase &Sec, ArrayRef<RelTy> Rels) {
                       });
 }
 
-template <class ELFT> void elf::scanRelocations(InputSectionBase &S) {
-  if (S.AreRelocsRela)
-    scanRelocs<ELFT>(S, S.relas<ELFT>());
-  else
-    scanRelocs<ELFT>(S, S.rels<ELFT>());
+template <class ELFT>
+void elf::scanRelocations(ArrayRef<InputSectionBase *> Sections) {
+  // Relocation scanning is done in two phases. First, we classify relocations
+  // in parallel. Then we visit all relocations in the original order and
+  // create GOT, PLT, copy relocations, etc. for those that need them, so the
+  // output doesn't depend on the number of threads.
+  //
+  // MIPS and PPC64 have relocations that depend on neighbouring ones or
+  // update per-file state, so we don't use the parallel phase for them.
+  // .eh_frame relocations are not worth it because they are few and their
+  // offsets need to be translated by OffsetGetter.
+  std::vector<std::vector<Relocation>> Prescanned(Sections.size());
+  if (Config->EMachine != EM_MIPS && Config->EMachine != EM_PPC64) {
+    parallelForEachN(0, Sections.size(), [&](size_t I) {
+      InputSectionBase &S = *Sections[I];
+      if (isa<EhInputSection>(S))
+        return;
+      if (S.AreRelocsRela)
+        Prescanned[I] = prescanRelocs<ELFT>(S, S.relas<ELFT>());
+      else
+        Prescanned[I] = prescanRelocs<ELFT>(S, S.rels<ELFT>());
+    });
+  }
+
+  for (size_t I = 0, E = Sections.size(); I != E; ++I) {
+    InputSectionBase &S = *Sections[I];
+    if (S.AreRelocsRela)
+      scanRelocs<ELFT>(S, S.relas<ELFT>(), Prescanned[I]);
+    else
+      scanRelocs<ELFT>(S, S.rels<ELFT>(), Prescanned[I]);
+
+    // Free memory as we go.
+    Prescanned[I] = {};
+  }
 }
 
 // Figure out which representation to use for any absolute relocs to
@@ -1697,15 +1800,46 @@ bool ThunkCreator::createThunks(ArrayRef<OutputSection *> OutputSections) {
   if (Pass == 10)
     fatal("thunk creation not converged");
 
+  // Find the relocations that may need work in this pass. Every pass has to
+  // look at every branch, but most of them are in range and never need a
+  // thunk. Deciding that only reads addresses, which don't change until the
+  // pass is over, so it is done in parallel. Relocations that already refer
+  // to a Thunk are always revisited since they may have to be redirected.
+  std::vector<InputSection *> Sections;
+  forEachInputSectionDescription(
+      OutputSections, [&](OutputSection *OS, InputSectionDescription *ISD) {
+        Sections.insert(Sections.end(), ISD->Sections.begin(),
+                        ISD->Sections.end());
+      });
+
+  std::vector<std::vector<bool>> Candidates(Sections.size());
+  parallelForEachN(0, Sections.size(), [&](size_t I) {
+    InputSection *IS = Sections[I];
+    Candidates[I].resize(IS->Relocations.size());
+    for (size_t J = 0, E = IS->Relocations.size(); J != E; ++J) {
+      const Relocation &Rel = IS->Relocations[J];
+      Candidates[I][J] =
+          (Pass > 0 && Thunks.count(Rel.Sym)) ||
+          Target->needsThunk(Rel.Expr, Rel.Type, IS->File,
+                             IS->getVA(Rel.Offset), *Rel.Sym);
+    }
+  });
+
   // Create all the Thunks and insert them into synthetic ThunkSections. The
   // ThunkSections are later inserted back into InputSectionDescriptions.
   // We separate the creation of ThunkSections from the insertion of the
   // ThunkSections as ThunkSections are not always inserted into the same
   // InputSectionDescription as the caller.
+  size_t SecIdx = 0;
   forEachInputSectionDescription(
       OutputSections, [&](OutputSection *OS, InputSectionDescription *ISD) {
-        for (InputSection *IS : ISD->Sections)
-          for (Relocation &Rel : IS->Relocations) {
+        for (InputSection *IS : ISD->Sections) {
+          const std::vector<bool> &MayNeedThunk = Candidates[SecIdx++];
+          for (size_t J = 0, E = IS->Relocations.size(); J != E; ++J) {
+            if (!MayNeedThunk[J])
+              continue;
+
+            Relocation &Rel = IS->Relocations[J];
             uint64_t Src = IS->getVA(Rel.Offset);
 
             // If we are a relocation to an existing Thunk, check if it is
@@ -1737,6 +1871,7 @@ bool ThunkCreator::createThunks(ArrayRef<OutputSection *> OutputSections) {
             Rel.Sym = T->getThunkTargetSym();
             Rel.Expr = fromPlt(Rel.Expr);
           }
+        }
 
         for (auto &P : ISD->ThunkSections)
           AddressesChanged |= P.first->assignOffsets();
@@ -1751,7 +1886,11 @@ bool ThunkCreator::createThunks(ArrayRef<OutputSection *> OutputSections) {
   return AddressesChanged;
 }
 
-template void elf::scanRelocations<ELF32LE>(InputSectionBase &);
-template void elf::scanRelocations<ELF32BE>(InputSectionBase &);
-template void elf::scanRelocations<ELF64LE>(InputSectionBase &);
-template void elf::scanRelocations<ELF64BE>(InputSectionBase &);
+template void
+elf::scanRelocations<ELF32LE>(ArrayRef<InputSectionBase *>);
+template void
+elf::scanRelocations<ELF32BE>(ArrayRef<InputSectionBase *>);
+template void
+elf::scanRelocations<ELF64LE>(ArrayRef<InputSectionBase *>);
+template void
+elf::scanRelocations<ELF64BE>(ArrayRef<InputSectionBase *>);
@@ -107,7 +107,7 @@ struct Relocation {
   Symbol *Sym;
 };
 
-template <class ELFT> void scanRelocations(InputSectionBase &);
+template <class ELFT> void scanRelocations(ArrayRef<InputSectionBase *>);
 
 void addIRelativeRelocs();
 
@@ -49,8 +49,7 @@ void SymbolTable::wrap(Symbol *Sym, Symbol *Real, Symbol *Wrap) {
   Real->setName(S);
 }
 
-// Find an existing symbol or create a new one.
-Symbol *SymbolTable::insert(StringRef Name) {
+CachedHashStringRef elf::getSymbolTableKey(StringRef Name) {
   // <name>@@<version> means the symbol is the default version. In that
   // case <name>@@<version> will be used to resolve references to <name>.
   //
@@ -60,8 +59,18 @@ Symbol *SymbolTable::insert(StringRef Name) {
   size_t Pos = Name.find('@');
   if (Pos != StringRef::npos && Pos + 1 < Name.size() && Name[Pos + 1] == '@')
     Name = Name.take_front(Pos);
+  return CachedHashStringRef(Name);
+}
+
+// Find an existing symbol or create a new one.
+Symbol *SymbolTable::insert(StringRef Name) {
+  return insert(getSymbolTableKey(Name));
+}
 
-  auto P = SymMap.insert({CachedHashStringRef(Name), (int)SymVector.size()});
+// Same as above, but the caller has already computed the key, possibly
+// in parallel with other files.
+Symbol *SymbolTable::insert(CachedHashStringRef Key) {
+  auto P = SymMap.insert({Key, (int)SymVector.size()});
   int &SymIndex = P.first->second;
   bool IsNew = P.second;
 
@@ -71,7 +80,7 @@ Symbol *SymbolTable::insert(StringRef Name) {
   Symbol *Sym = reinterpret_cast<Symbol *>(make<SymbolUnion>());
   SymVector.push_back(Sym);
 
-  Sym->setName(Name);
+  Sym->setName(Key.val());
   Sym->SymbolKind = Symbol::PlaceholderKind;
   Sym->VersionId = Config->DefaultSymbolVersion;
   Sym->Visibility = STV_DEFAULT;
@@ -42,6 +42,7 @@ public:
   }
 
   Symbol *insert(StringRef Name);
+  Symbol *insert(llvm::CachedHashStringRef Name);
 
   Symbol *addSymbol(const Symbol &New);
 
@@ -88,6 +89,11 @@ private:
 
 extern SymbolTable *Symtab;
 
+// Returns the key under which a symbol is stored in the symbol table. This
+// does not access the symbol table, so it is safe to call from multiple
+// threads.
+llvm::CachedHashStringRef getSymbolTableKey(StringRef Name);
+
 } // namespace elf
 } // namespace lld
 
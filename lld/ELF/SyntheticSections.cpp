@@ -30,12 +30,15 @@
 #include "llvm/ADT/SetOperations.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/BinaryFormat/Dwarf.h"
+#include "llvm/DebugInfo/DWARF/DWARFAcceleratorTable.h"
 #include "llvm/DebugInfo/DWARF/DWARFDebugPubTable.h"
 #include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Support/Compression.h"
+#include "llvm/Support/DJB.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/MD5.h"
+#include "llvm/Support/TimeProfiler.h"
 #include <cstdlib>
 #include <thread>
 
@@ -2417,7 +2420,7 @@ readPubNamesAndTypes(const LLDDwarfObj<ELFT> &Obj,
 // Create a list of symbols from a given list of symbol names and types
 // by uniquifying them by name.
 static std::vector<GdbIndexSection::GdbSymbol>
-createSymbols(ArrayRef<std::vector<GdbIndexSection::NameAttrEntry>> NameAttrs,
+createSymbols(std::vector<std::vector<GdbIndexSection::NameAttrEntry>> NameAttrs,
               const std::vector<GdbIndexSection::GdbChunk> &Chunks) {
   using GdbSymbol = GdbIndexSection::GdbSymbol;
   using NameAttrEntry = GdbIndexSection::NameAttrEntry;
@@ -2467,6 +2470,41 @@ createSymbols(ArrayRef<std::vector<GdbIndexSection::NameAttrEntry>> NameAttrs,
     }
   });
 
+  // The name entries and the maps are no longer needed. Free them before
+  // the symbols are flattened to keep the peak memory usage down; for large
+  // programs they take gigabytes.
+  NameAttrs.clear();
+  Map.clear();
+
+  // CU vectors and symbol names are adjacent in the output file, all CU
+  // vectors first. We can compute their offsets in the output file now.
+  // Compute the sizes each shard contributes first, so that the offsets
+  // within each shard can be assigned in parallel.
+  std::vector<size_t> CuVectorOffs(NumShards + 1);
+  std::vector<size_t> NameOffs(NumShards + 1);
+  parallelForEachN(0, NumShards, [&](size_t I) {
+    for (const GdbSymbol &Sym : Symbols[I]) {
+      CuVectorOffs[I + 1] += (Sym.CuVector.size() + 1) * 4;
+      NameOffs[I + 1] += Sym.Name.size() + 1;
+    }
+  });
+  for (size_t I = 1; I <= NumShards; ++I)
+    CuVectorOffs[I] += CuVectorOffs[I - 1];
+  NameOffs[0] = CuVectorOffs[NumShards];
+  for (size_t I = 1; I <= NumShards; ++I)
+    NameOffs[I] += NameOffs[I - 1];
+
+  parallelForEachN(0, NumShards, [&](size_t I) {
+    size_t CuVectorOff = CuVectorOffs[I];
+    size_t NameOff = NameOffs[I];
+    for (GdbSymbol &Sym : Symbols[I]) {
+      Sym.CuVectorOff = CuVectorOff;
+      Sym.NameOff = NameOff;
+      CuVectorOff += (Sym.CuVector.size() + 1) * 4;
+      NameOff += Sym.Name.size() + 1;
+    }
+  });
+
   size_t NumSymbols = 0;
   for (ArrayRef<GdbSymbol> V : Symbols)
     NumSymbols += V.size();
@@ -2475,27 +2513,17 @@ createSymbols(ArrayRef<std::vector<GdbIndexSection::NameAttrEntry>> NameAttrs,
   // contents to Ret.
   std::vector<GdbSymbol> Ret;
   Ret.reserve(NumSymbols);
-  for (std::vector<GdbSymbol> &Vec : Symbols)
+  for (std::vector<GdbSymbol> &Vec : Symbols) {
     for (GdbSymbol &Sym : Vec)
       Ret.push_back(std::move(Sym));
-
-  // CU vectors and symbol names are adjacent in the output file.
-  // We can compute their offsets in the output file now.
-  size_t Off = 0;
-  for (GdbSymbol &Sym : Ret) {
-    Sym.CuVectorOff = Off;
-    Off += (Sym.CuVector.size() + 1) * 4;
+    Vec = std::vector<GdbSymbol>();
   }
-  for (GdbSymbol &Sym : Ret) {
-    Sym.NameOff = Off;
-    Off += Sym.Name.size() + 1;
-  }
-
   return Ret;
 }
 
 // Returns a newly-created .gdb_index section.
 template <class ELFT> GdbIndexSection *GdbIndexSection::create() {
+  llvm::TimeTraceScope TimeScope("Create .gdb_index", StringRef(""));
   std::vector<InputSection *> Sections = getDebugInfoSections();
 
   // .debug_gnu_pub{names,types} are useless in executables.
@@ -2522,7 +2550,7 @@ template <class ELFT> GdbIndexSection *GdbIndexSection::create() {
 
   auto *Ret = make<GdbIndexSection>();
   Ret->Chunks = std::move(Chunks);
-  Ret->Symbols = createSymbols(NameAttrs, Ret->Chunks);
+  Ret->Symbols = createSymbols(std::move(NameAttrs), Ret->Chunks);
   Ret->initOutputSize();
   return Ret;
 }
@@ -2585,17 +2613,310 @@ void GdbIndexSection::writeTo(uint8_t *Buf) {
   });
 
   // Write the CU vectors.
-  for (GdbSymbol &Sym : Symbols) {
-    write32le(Buf, Sym.CuVector.size());
-    Buf += 4;
+  parallelForEach(Symbols, [&](GdbSymbol &Sym) {
+    uint8_t *P = Buf + Sym.CuVectorOff;
+    write32le(P, Sym.CuVector.size());
     for (uint32_t Val : Sym.CuVector) {
-      write32le(Buf, Val);
+      P += 4;
+      write32le(P, Val);
+    }
+  });
+}
+
+bool GdbIndexSection::isNeeded() const { return !Chunks.empty(); }
+
+DebugNamesSection::DebugNamesSection()
+    : SyntheticSection(0, SHT_PROGBITS, 4, ".debug_names") {}
+
+// Reads the .debug_names of a file. The CU indices of the returned entries
+// are local to the file; the number of compile units of the preceding files
+// is added when the names are merged.
+template <class ELFT>
+static std::vector<DebugNamesSection::NameEntry>
+readDebugNames(ObjFile<ELFT> *File, DebugNamesSection::NamesChunk &Chunk) {
+  using NameEntry = DebugNamesSection::NameEntry;
+
+  InputSectionBase *StrSec = nullptr;
+  for (InputSectionBase *Sec : File->getSections())
+    if (Sec && Sec->Name == ".debug_str")
+      StrSec = Sec;
+  if (!StrSec)
+    return {};
+
+  DWARFContext Dwarf(make_unique<LLDDwarfObj<ELFT>>(File));
+  const DWARFObject &Obj = Dwarf.getDWARFObj();
+  DWARFDataExtractor AccelData(Obj, Obj.getDebugNamesSection(), Config->IsLE,
+                               0);
+  DataExtractor StrData(Obj.getStringSection(), Config->IsLE, 0);
+  DWARFDebugNames Index(AccelData, StrData);
+  if (Error E = Index.extract()) {
+    warn(toString(File) + ": unable to read .debug_names: " +
+         toString(std::move(E)));
+    return {};
+  }
+
+  std::vector<NameEntry> Ret;
+  for (const DWARFDebugNames::NameIndex &NI : Index) {
+    uint32_t CuBase = Chunk.CuOffsets.size();
+    for (uint32_t I = 0, E = NI.getCUCount(); I != E; ++I)
+      Chunk.CuOffsets.push_back(NI.getCUOffset(I));
+
+    for (const DWARFDebugNames::NameTableEntry &NTE : NI) {
+      StringRef Name = NTE.getString();
+      NameEntry Ent = {CachedHashStringRef(Name), StrSec,
+                       NTE.getStringOffset(), 0, 0, {}};
+
+      uint32_t Off = NTE.getEntryOffset();
+      Expected<DWARFDebugNames::Entry> EntryOr = NI.getEntry(&Off);
+      for (; EntryOr; EntryOr = NI.getEntry(&Off)) {
+        // Type units are not carried over, nor are entries we cannot
+        // attribute to a DIE of a compile unit.
+        if (EntryOr->lookup(DW_IDX_type_unit))
+          continue;
+        Optional<uint64_t> CuIndex = EntryOr->getCUIndex();
+        Optional<uint64_t> DieOffset = EntryOr->getDIEUnitOffset();
+        if (!CuIndex || *CuIndex >= NI.getCUCount() || !DieOffset)
+          continue;
+        Ent.Entries.push_back({EntryOr->tag(), uint32_t(CuBase + *CuIndex),
+                               uint32_t(*DieOffset)});
+      }
+      handleAllErrors(EntryOr.takeError(),
+                      [](const DWARFDebugNames::SentinelError &) {},
+                      [&](const ErrorInfoBase &Info) {
+                        warn(toString(File) +
+                             ": unable to read .debug_names: " +
+                             Info.message());
+                      });
+
+      if (!Ent.Entries.empty())
+        Ret.push_back(std::move(Ent));
+    }
+  }
+  return Ret;
+}
+
+// Merges the names of all files by name, in the same sharded way that
+// createSymbols does for .gdb_index.
+static std::vector<DebugNamesSection::NameEntry>
+mergeDebugNames(std::vector<std::vector<DebugNamesSection::NameEntry>> Names,
+                const std::vector<DebugNamesSection::NamesChunk> &Chunks) {
+  using NameEntry = DebugNamesSection::NameEntry;
+
+  uint32_t CuIdx = 0;
+  std::vector<uint32_t> CuIdxs(Chunks.size());
+  for (uint32_t I = 0, E = Chunks.size(); I != E; ++I) {
+    CuIdxs[I] = CuIdx;
+    CuIdx += Chunks[I].CuOffsets.size();
+  }
+
+  size_t NumShards = 32;
+  size_t Concurrency = 1;
+  if (ThreadsEnabled)
+    Concurrency =
+        std::min<size_t>(PowerOf2Floor(hardware_concurrency()), NumShards);
+
+  std::vector<DenseMap<CachedHashStringRef, size_t>> Map(NumShards);
+  size_t Shift = 32 - countTrailingZeros(NumShards);
+
+  std::vector<std::vector<NameEntry>> Shards(NumShards);
+  parallelForEachN(0, Concurrency, [&](size_t ThreadId) {
+    for (size_t I = 0, E = Names.size(); I != E; ++I) {
+      for (NameEntry &Ent : Names[I]) {
+        size_t ShardId = Ent.Name.hash() >> Shift;
+        if ((ShardId & (Concurrency - 1)) != ThreadId)
+          continue;
+
+        for (DebugNamesSection::IndexEntry &IE : Ent.Entries)
+          IE.CuIndex += CuIdxs[I];
+
+        size_t &Idx = Map[ShardId][Ent.Name];
+        if (Idx) {
+          std::vector<DebugNamesSection::IndexEntry> &V =
+              Shards[ShardId][Idx - 1].Entries;
+          V.insert(V.end(), Ent.Entries.begin(), Ent.Entries.end());
+          continue;
+        }
+
+        Idx = Shards[ShardId].size() + 1;
+        Shards[ShardId].push_back(std::move(Ent));
+      }
+    }
+  });
+
+  Names.clear();
+  Map.clear();
+
+  size_t NumNames = 0;
+  for (ArrayRef<NameEntry> V : Shards)
+    NumNames += V.size();
+
+  std::vector<NameEntry> Ret;
+  Ret.reserve(NumNames);
+  for (std::vector<NameEntry> &Vec : Shards) {
+    for (NameEntry &Ent : Vec)
+      Ret.push_back(std::move(Ent));
+    Vec = std::vector<NameEntry>();
+  }
+  return Ret;
+}
+
+// Returns a newly-created .debug_names section.
+template <class ELFT> DebugNamesSection *DebugNamesSection::create() {
+  llvm::TimeTraceScope TimeScope("Create .debug_names", StringRef(""));
+
+  // The input indices are replaced by the merged one.
+  std::vector<InputSection *> Sections;
+  for (InputSectionBase *S : InputSections) {
+    if (S->Name != ".debug_names")
+      continue;
+    S->markDead();
+    if (InputSection *IS = dyn_cast<InputSection>(S))
+      Sections.push_back(IS);
+  }
+
+  std::vector<NamesChunk> Chunks(Sections.size());
+  std::vector<std::vector<NameEntry>> Names(Sections.size());
+
+  parallelForEachN(0, Sections.size(), [&](size_t I) {
+    ObjFile<ELFT> *File = Sections[I]->getFile<ELFT>();
+    for (InputSectionBase *Sec : File->getSections())
+      if (Sec && Sec->Name == ".debug_info")
+        Chunks[I].InfoSec = dyn_cast<InputSection>(Sec);
+    if (!Chunks[I].InfoSec)
+      return;
+    Names[I] = readDebugNames<ELFT>(File, Chunks[I]);
+  });
+
+  auto *Ret = make<DebugNamesSection>();
+  Ret->Names = mergeDebugNames(std::move(Names), Chunks);
+  Ret->Chunks = std::move(Chunks);
+  Ret->initOutputSize();
+  return Ret;
+}
+
+// Lays out the hash table and the entry pool.
+void DebugNamesSection::initOutputSize() {
+  parallelForEach(Names, [](NameEntry &Ent) {
+    Ent.HashValue = caseFoldingDjbHash(Ent.Name.val());
+  });
+  parallelSort(Names, [](const NameEntry &A, const NameEntry &B) {
+    if (A.HashValue != B.HashValue)
+      return A.HashValue < B.HashValue;
+    return A.Name.val() < B.Name.val();
+  });
+
+  // Use the same number of buckets as LLVM does for its own indices.
+  uint32_t UniqueHashCount = 0;
+  for (size_t I = 0, E = Names.size(); I != E; ++I)
+    if (I == 0 || Names[I].HashValue != Names[I - 1].HashValue)
+      ++UniqueHashCount;
+  if (UniqueHashCount > 1024)
+    BucketCount = UniqueHashCount / 4;
+  else if (UniqueHashCount > 16)
+    BucketCount = UniqueHashCount / 2;
+  else
+    BucketCount = std::max<uint32_t>(UniqueHashCount, 1);
+
+  // Names with the same hash value stay adjacent, as readers require.
+  std::stable_sort(Names.begin(), Names.end(),
+                   [&](const NameEntry &A, const NameEntry &B) {
+                     return A.HashValue % BucketCount <
+                            B.HashValue % BucketCount;
+                   });
+
+  // Every entry has a compile unit index and a DIE offset, so all we need
+  // is one abbreviation per tag.
+  for (const NameEntry &Ent : Names)
+    for (const IndexEntry &IE : Ent.Entries)
+      TagToAbbrev.insert({IE.Tag, TagToAbbrev.size() + 1});
+
+  AbbrevTableSize = 1;
+  for (const std::pair<uint32_t, uint32_t> &P : TagToAbbrev)
+    AbbrevTableSize += getULEB128Size(P.second) + getULEB128Size(P.first) +
+                       getULEB128Size(DW_IDX_compile_unit) +
+                       getULEB128Size(DW_FORM_data4) +
+                       getULEB128Size(DW_IDX_die_offset) +
+                       getULEB128Size(DW_FORM_ref4) + 2;
+
+  uint32_t EntryOff = 0;
+  for (NameEntry &Ent : Names) {
+    Ent.EntryOffset = EntryOff;
+    for (const IndexEntry &IE : Ent.Entries)
+      EntryOff += getULEB128Size(TagToAbbrev.lookup(IE.Tag)) + 8;
+    ++EntryOff;
+  }
+
+  size_t NumCus = 0;
+  for (const NamesChunk &Chunk : Chunks)
+    NumCus += Chunk.CuOffsets.size();
+
+  Size = 36 + NumCus * 4 + BucketCount * 4 + Names.size() * 12 +
+         AbbrevTableSize + EntryOff;
+}
+
+void DebugNamesSection::writeTo(uint8_t *Buf) {
+  size_t NumCus = 0;
+  for (const NamesChunk &Chunk : Chunks)
+    NumCus += Chunk.CuOffsets.size();
+
+  // Write the header.
+  write32(Buf, Size - 4);
+  write16(Buf + 4, 5);
+  write32(Buf + 8, NumCus);
+  write32(Buf + 20, BucketCount);
+  write32(Buf + 24, Names.size());
+  write32(Buf + 28, AbbrevTableSize);
+  Buf += 36;
+
+  // Write the CU list.
+  for (const NamesChunk &Chunk : Chunks) {
+    for (uint32_t Off : Chunk.CuOffsets) {
+      write32(Buf, Chunk.InfoSec->OutSecOff + Off);
       Buf += 4;
     }
   }
+
+  // Write the buckets. Each one holds the 1-based index of its first name.
+  for (size_t I = Names.size(); I != 0; --I)
+    write32(Buf + (Names[I - 1].HashValue % BucketCount) * 4, I);
+  Buf += BucketCount * 4;
+
+  uint8_t *Hashes = Buf;
+  uint8_t *StrOffs = Hashes + Names.size() * 4;
+  uint8_t *EntryOffs = StrOffs + Names.size() * 4;
+  uint8_t *Abbrevs = EntryOffs + Names.size() * 4;
+  uint8_t *Pool = Abbrevs + AbbrevTableSize;
+
+  // Write the abbreviation table. The buffer is zero-filled, so the
+  // terminators of the table and of the entry lists are already in place.
+  for (const std::pair<uint32_t, uint32_t> &P : TagToAbbrev) {
+    Abbrevs += encodeULEB128(P.second, Abbrevs);
+    Abbrevs += encodeULEB128(P.first, Abbrevs);
+    Abbrevs += encodeULEB128(DW_IDX_compile_unit, Abbrevs);
+    Abbrevs += encodeULEB128(DW_FORM_data4, Abbrevs);
+    Abbrevs += encodeULEB128(DW_IDX_die_offset, Abbrevs);
+    Abbrevs += encodeULEB128(DW_FORM_ref4, Abbrevs);
+    Abbrevs += 2;
+  }
+
+  // Write the name table and the entry pool.
+  parallelForEachN(0, Names.size(), [&](size_t I) {
+    const NameEntry &Ent = Names[I];
+    write32(Hashes + I * 4, Ent.HashValue);
+    write32(StrOffs + I * 4, Ent.StrSec->getVA(Ent.StrOffset));
+    write32(EntryOffs + I * 4, Ent.EntryOffset);
+
+    uint8_t *P = Pool + Ent.EntryOffset;
+    for (const IndexEntry &IE : Ent.Entries) {
+      P += encodeULEB128(TagToAbbrev.lookup(IE.Tag), P);
+      write32(P, IE.CuIndex);
+      write32(P + 4, IE.DieOffset);
+      P += 8;
+    }
+  });
 }
 
-bool GdbIndexSection::isNeeded() const { return !Chunks.empty(); }
+bool DebugNamesSection::isNeeded() const { return !Names.empty(); }
 
 EhFrameHeader::EhFrameHeader()
     : SyntheticSection(SHF_ALLOC, SHT_PROGBITS, 4, ".eh_frame_hdr") {}
@@ -2822,31 +3143,70 @@ void MergeSyntheticSection::addSection(MergeInputSection *MS) {
 
 MergeTailSection::MergeTailSection(StringRef Name, uint32_t Type,
                                    uint64_t Flags, uint32_t Alignment)
-    : MergeSyntheticSection(Name, Type, Flags, Alignment),
-      Builder(StringTableBuilder::RAW, Alignment) {}
-
-size_t MergeTailSection::getSize() const { return Builder.getSize(); }
+    : MergeSyntheticSection(Name, Type, Flags, Alignment) {}
 
-void MergeTailSection::writeTo(uint8_t *Buf) { Builder.write(Buf); }
+void MergeTailSection::writeTo(uint8_t *Buf) {
+  for (size_t I = 0; I < NumShards; ++I)
+    Shards[I].write(Buf + ShardOffsets[I]);
+}
 
+// Tail merging sorts all strings by their suffixes, which is slow if we
+// have millions of strings (e.g. .debug_str with -O2). Since only strings
+// ending with the same character can be merged, we split strings into
+// shards by the last character and tail-merge each shard in parallel. We
+// don't miss any merge opportunity other than the empty string.
 void MergeTailSection::finalizeContents() {
-  // Add all string pieces to the string table builder to create section
-  // contents.
-  for (MergeInputSection *Sec : Sections)
-    for (size_t I = 0, E = Sec->Pieces.size(); I != E; ++I)
-      if (Sec->Pieces[I].Live)
-        Builder.add(Sec->getData(I));
+  // Initializes string table builders.
+  for (size_t I = 0; I < NumShards; ++I)
+    Shards.emplace_back(StringTableBuilder::RAW, Alignment);
 
-  // Fix the string table content. After this, the contents will never change.
-  Builder.finalize();
+  // Concurrency level. Must be a power of 2 to avoid expensive modulo
+  // operations in the following tight loop.
+  size_t Concurrency = 1;
+  if (ThreadsEnabled)
+    Concurrency =
+        std::min<size_t>(PowerOf2Floor(hardware_concurrency()), NumShards);
+
+  // Add all string pieces to the string table builders and fix their
+  // contents. After this, the contents will never change.
+  parallelForEachN(0, Concurrency, [&](size_t ThreadId) {
+    for (MergeInputSection *Sec : Sections) {
+      for (size_t I = 0, E = Sec->Pieces.size(); I != E; ++I) {
+        if (!Sec->Pieces[I].Live)
+          continue;
+        CachedHashStringRef S = Sec->getData(I);
+        size_t ShardId = getShardId(S.val(), Sec->Entsize);
+        if ((ShardId & (Concurrency - 1)) == ThreadId)
+          Shards[ShardId].add(S);
+      }
+    }
+    for (size_t I = ThreadId; I < NumShards; I += Concurrency)
+      Shards[I].finalize();
+  });
+
+  // Compute an in-section offset for each shard.
+  size_t Off = 0;
+  for (size_t I = 0; I < NumShards; ++I) {
+    if (Shards[I].getSize() > 0)
+      Off = alignTo(Off, Alignment);
+    ShardOffsets[I] = Off;
+    Off += Shards[I].getSize();
+  }
+  Size = Off;
 
   // finalize() fixed tail-optimized strings, so we can now get
   // offsets of strings. Get an offset for each string and save it
   // to a corresponding StringPiece for easy access.
-  for (MergeInputSection *Sec : Sections)
-    for (size_t I = 0, E = Sec->Pieces.size(); I != E; ++I)
-      if (Sec->Pieces[I].Live)
-        Sec->Pieces[I].OutputOff = Builder.getOffset(Sec->getData(I));
+  parallelForEach(Sections, [&](MergeInputSection *Sec) {
+    for (size_t I = 0, E = Sec->Pieces.size(); I != E; ++I) {
+      if (!Sec->Pieces[I].Live)
+        continue;
+      CachedHashStringRef S = Sec->getData(I);
+      size_t ShardId = getShardId(S.val(), Sec->Entsize);
+      Sec->Pieces[I].OutputOff =
+          ShardOffsets[ShardId] + Shards[ShardId].getOffset(S);
+    }
+  });
 }
 
 void MergeNoTailSection::writeTo(uint8_t *Buf) {
@@ -2919,6 +3279,7 @@ static MergeSyntheticSection *createMergeSynthetic(StringRef Name,
 }
 
 template <class ELFT> void elf::splitSections() {
+  llvm::TimeTraceScope TimeScope("Split sections", StringRef(""));
   // splitIntoPieces needs to be called on each MergeInputSection
   // before calling finalizeContents().
   parallelForEach(InputSections, [](InputSectionBase *Sec) {
@@ -2937,6 +3298,7 @@ template <class ELFT> void elf::splitSections() {
 // that it replaces. It then finalizes each synthetic section in order
 // to compute an output offset for each piece of each input section.
 void elf::mergeSections() {
+  llvm::TimeTraceScope TimeScope("Merge sections", StringRef(""));
   std::vector<MergeSyntheticSection *> MergeSections;
   for (InputSectionBase *&S : InputSections) {
     MergeInputSection *MS = dyn_cast<MergeInputSection>(S);
@@ -3264,6 +3626,11 @@ template GdbIndexSection *GdbIndexSection::create<ELF32BE>();
 template GdbIndexSection *GdbIndexSection::create<ELF64LE>();
 template GdbIndexSection *GdbIndexSection::create<ELF64BE>();
 
+template DebugNamesSection *DebugNamesSection::create<ELF32LE>();
+template DebugNamesSection *DebugNamesSection::create<ELF32BE>();
+template DebugNamesSection *DebugNamesSection::create<ELF64LE>();
+template DebugNamesSection *DebugNamesSection::create<ELF64BE>();
+
 template void elf::splitSections<ELF32LE>();
 template void elf::splitSections<ELF32BE>();
 template void elf::splitSections<ELF64LE>();
@@ -733,6 +733,61 @@ private:
   size_t Size;
 };
 
+// --debug-names option tells the linker to merge the .debug_names sections of
+// the input files, which index one object file each, into a single name index
+// covering all of them. Debuggers can then look names up with one hash table
+// lookup instead of one per object file. The format is described in section
+// 6.1.1 of the DWARF v5 standard.
+class DebugNamesSection final : public SyntheticSection {
+public:
+  // A DIE that is indexed under a name. CuIndex is the index of its compile
+  // unit in the CU list of the output index.
+  struct IndexEntry {
+    uint32_t Tag;
+    uint32_t CuIndex;
+    uint32_t DieOffset;
+  };
+
+  // A name, together with the location of one of its copies in an input
+  // .debug_str, which tells us its offset in the output .debug_str.
+  struct NameEntry {
+    llvm::CachedHashStringRef Name;
+    InputSectionBase *StrSec;
+    uint32_t StrOffset;
+    uint32_t HashValue;
+    uint32_t EntryOffset;
+    std::vector<IndexEntry> Entries;
+  };
+
+  // The compile units indexed by the .debug_names of an input file, as
+  // offsets in its .debug_info.
+  struct NamesChunk {
+    InputSection *InfoSec;
+    std::vector<uint32_t> CuOffsets;
+  };
+
+  DebugNamesSection();
+  template <typename ELFT> static DebugNamesSection *create();
+  void writeTo(uint8_t *Buf) override;
+  size_t getSize() const override { return Size; }
+  bool isNeeded() const override;
+
+private:
+  void initOutputSize();
+
+  std::vector<NamesChunk> Chunks;
+
+  // The names in the order in which they are written, i.e. sorted by bucket.
+  std::vector<NameEntry> Names;
+
+  // The abbreviation codes, one per DIE tag, in the order they are defined.
+  llvm::MapVector<uint32_t, uint32_t> TagToAbbrev;
+
+  uint32_t BucketCount = 0;
+  uint32_t AbbrevTableSize = 0;
+  size_t Size;
+};
+
 // --eh-frame-hdr option tells linker to construct a header for all the
 // .eh_frame sections. This header is placed to a section named .eh_frame_hdr
 // and also to a PT_GNU_EH_FRAME segment.
@@ -839,12 +894,27 @@ public:
   MergeTailSection(StringRef Name, uint32_t Type, uint64_t Flags,
                    uint32_t Alignment);
 
-  size_t getSize() const override;
+  size_t getSize() const override { return Size; }
   void writeTo(uint8_t *Buf) override;
   void finalizeContents() override;
 
 private:
-  llvm::StringTableBuilder Builder;
+  // A string can be tail-merged only with strings ending with the same
+  // character, so we use the last character as a shard ID. The empty string
+  // is a suffix of any string, but it is not worth special handling.
+  size_t getShardId(StringRef S, size_t EntSize) {
+    if (S.size() <= EntSize)
+      return 0;
+    return (uint8_t)S[S.size() - 2 * EntSize] & (NumShards - 1);
+  }
+
+  // Section size
+  size_t Size;
+
+  // String table contents
+  constexpr static size_t NumShards = 32;
+  std::vector<llvm::StringTableBuilder> Shards;
+  size_t ShardOffsets[NumShards];
 };
 
 class MergeNoTailSection final : public MergeSyntheticSection {
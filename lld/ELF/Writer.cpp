@@ -26,6 +26,7 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/RandomNumberGenerator.h"
 #include "llvm/Support/SHA1.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/xxhash.h"
 #include <climits>
 
@@ -412,6 +413,9 @@ template <class ELFT> static void createSyntheticSections() {
   if (Config->GdbIndex)
     Add(GdbIndexSection::create<ELFT>());
 
+  if (Config->DebugNames)
+    Add(DebugNamesSection::create<ELFT>());
+
   // We always need to add rel[a].plt to output if it has entries.
   // Even for static linking it can contain R_[*]_IRELATIVE relocations.
   In.RelaPlt = make<RelocationSection<ELFT>>(
@@ -510,8 +514,11 @@ template <class ELFT> void Writer<ELFT>::run() {
   // If -compressed-debug-sections is specified, we need to compress
   // .debug_* sections. Do it right now because it changes the size of
   // output sections.
-  for (OutputSection *Sec : OutputSections)
-    Sec->maybeCompress<ELFT>();
+  {
+    llvm::TimeTraceScope TimeScope("Compress debug sections", StringRef(""));
+    for (OutputSection *Sec : OutputSections)
+      Sec->maybeCompress<ELFT>();
+  }
 
   Script->allocateHeaders(Phdrs);
 
@@ -542,17 +549,20 @@ template <class ELFT> void Writer<ELFT>::run() {
   if (errorCount())
     return;
 
-  if (!Config->OFormatBinary) {
-    writeTrapInstr();
-    writeHeader();
-    writeSections();
-  } else {
-    writeSectionsBinary();
-  }
+  {
+    llvm::TimeTraceScope TimeScope("Write sections", StringRef(""));
+    if (!Config->OFormatBinary) {
+      writeTrapInstr();
+      writeHeader();
+      writeSections();
+    } else {
+      writeSectionsBinary();
+    }
 
-  // Backfill .note.gnu.build-id section content. This is done at last
-  // because the content is usually a hash value of the entire output file.
-  writeBuildId();
+    // Backfill .note.gnu.build-id section content. This is done at last
+    // because the content is usually a hash value of the entire output file.
+    writeBuildId();
+  }
   if (errorCount())
     return;
 
@@ -562,6 +572,7 @@ template <class ELFT> void Writer<ELFT>::run() {
   if (errorCount())
     return;
 
+  llvm::TimeTraceScope TimeScope("Commit output file", StringRef(""));
   if (auto E = Buffer->commit())
     error("failed to write to the output file: " + toString(std::move(E)));
 }
@@ -1253,6 +1264,20 @@ sortISDBySectionOrder(InputSectionDescription *ISD,
     ISD->Sections.push_back(P.first);
   for (InputSection *IS : makeArrayRef(UnorderedSections).slice(InsPt))
     ISD->Sections.push_back(IS);
+
+  // With --hot-text-align, align the start of the ordered (hot) code so that
+  // it begins on a huge page boundary. The program can then back the hot code
+  // with huge pages at startup (e.g. by remapping it and using madvise), which
+  // cuts iTLB misses.
+  if (Config->HotTextAlign && !OrderedSections.empty()) {
+    InputSection *First = OrderedSections.front().first;
+    if (First->Flags & SHF_EXECINSTR) {
+      First->Alignment =
+          std::max<uint32_t>(First->Alignment, Config->HotTextAlign);
+      OutputSection *OS = First->getParent();
+      OS->Alignment = std::max(OS->Alignment, First->Alignment);
+    }
+  }
 }
 
 static void sortSection(OutputSection *Sec,
@@ -1473,6 +1498,7 @@ template <class ELFT> void Writer<ELFT>::resolveShfLinkOrder() {
 // addresses we must converge to a fixed point. We do that here. See the comment
 // in Writer<ELFT>::finalizeSections().
 template <class ELFT> void Writer<ELFT>::finalizeAddressDependentContent() {
+  llvm::TimeTraceScope TimeScope("Create thunks", StringRef(""));
   ThunkCreator TC;
   AArch64Err843419Patcher A64P;
 
@@ -1575,6 +1601,7 @@ static bool computeIsPreemptible(const Symbol &B) {
 
 // Create output section objects and add them to OutputSections.
 template <class ELFT> void Writer<ELFT>::finalizeSections() {
+  llvm::TimeTraceScope TimeScope("Finalize sections", StringRef(""));
   Out::PreinitArray = findSection(".preinit_array");
   Out::InitArray = findSection(".init_array");
   Out::FiniArray = findSection(".fini_array");
@@ -1639,8 +1666,12 @@ template <class ELFT> void Writer<ELFT>::finalizeSections() {
 
   // Scan relocations. This must be done after every symbol is declared so that
   // we can correctly decide if a dynamic relocation is needed.
-  if (!Config->Relocatable)
-    forEachRelSec(scanRelocations<ELFT>);
+  if (!Config->Relocatable) {
+    llvm::TimeTraceScope TimeScope("Scan relocations", StringRef(""));
+    std::vector<InputSectionBase *> Sections;
+    forEachRelSec([&](InputSectionBase &S) { Sections.push_back(&S); });
+    scanRelocations<ELFT>(Sections);
+  }
 
   addIRelativeRelocs();
 
@@ -2452,7 +2483,9 @@ template <class ELFT> void Writer<ELFT>::openFile() {
   unlinkAsync(Config->OutputFile);
   unsigned Flags = 0;
   if (!Config->Relocatable)
-    Flags = FileOutputBuffer::F_executable;
+    Flags |= FileOutputBuffer::F_executable;
+  if (Config->AsyncWriteback)
+    Flags |= FileOutputBuffer::F_async_writeback;
   Expected<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
       FileOutputBuffer::create(Config->OutputFile, FileSize, Flags);
 
@@ -2516,9 +2549,18 @@ template <class ELFT> void Writer<ELFT>::writeSections() {
     if (Sec->Type == SHT_REL || Sec->Type == SHT_RELA)
       Sec->writeTo<ELFT>(Out::BufferStart + Sec->Offset);
 
-  for (OutputSection *Sec : OutputSections)
-    if (Sec->Type != SHT_REL && Sec->Type != SHT_RELA)
-      Sec->writeTo<ELFT>(Out::BufferStart + Sec->Offset);
+  for (OutputSection *Sec : OutputSections) {
+    if (Sec->Type == SHT_REL || Sec->Type == SHT_RELA)
+      continue;
+    Sec->writeTo<ELFT>(Out::BufferStart + Sec->Offset);
+
+    // Let the output buffer start writing the section to disk while we are
+    // still writing the others. The section containing the build ID is
+    // backfilled later, so it is left for commit().
+    if (Sec->Type != SHT_NOBITS &&
+        !(In.BuildId && In.BuildId->getParent() == Sec))
+      Buffer->writeback(Sec->Offset, Sec->Size);
+  }
 }
 
 // Split one uint8 array into small pieces of uint8 arrays.
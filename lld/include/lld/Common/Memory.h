@@ -22,12 +22,15 @@
 #define LLD_COMMON_MEMORY_H
 
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/PerThreadBumpPtrAllocator.h"
 #include "llvm/Support/StringSaver.h"
+#include <mutex>
 #include <vector>
 
 namespace lld {
 
 // Use this arena if your object doesn't have a destructor.
+// It is not thread-safe.
 extern llvm::BumpPtrAllocator BAlloc;
 extern llvm::StringSaver Saver;
 
@@ -36,22 +39,28 @@ void freeArena();
 // These two classes are hack to keep track of all
 // SpecificBumpPtrAllocator instances.
 struct SpecificAllocBase {
-  SpecificAllocBase() { Instances.push_back(this); }
+  SpecificAllocBase() {
+    std::lock_guard<std::mutex> Lock(Mu);
+    Instances.push_back(this);
+  }
   virtual ~SpecificAllocBase() = default;
   virtual void reset() = 0;
   static std::vector<SpecificAllocBase *> Instances;
+  static std::mutex Mu;
 };
 
 template <class T> struct SpecificAlloc : public SpecificAllocBase {
   void reset() override { Alloc.DestroyAll(); }
-  llvm::SpecificBumpPtrAllocator<T> Alloc;
+  llvm::PerThreadSpecificBumpPtrAllocator<T> Alloc;
 };
 
 // Use this arena if your object has a destructor.
 // Your destructor will be invoked from freeArena().
+// make<T> may be called from multiple threads at once; each thread allocates
+// from its own arena.
 template <typename T, typename... U> T *make(U &&... Args) {
   static SpecificAlloc<T> Alloc;
-  return new (Alloc.Alloc.Allocate()) T(std::forward<U>(Args)...);
+  return new (Alloc.Alloc.get().Allocate()) T(std::forward<U>(Args)...);
 }
 
 } // namespace lld
@@ -41,6 +41,7 @@ public:
   void print();
 
   double millis() const;
+  llvm::StringRef getName() const { return Name; }
 
 private:
   explicit Timer(llvm::StringRef Name);
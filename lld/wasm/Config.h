@@ -44,6 +44,7 @@ struct Configuration {
   bool StripAll;
   bool StripDebug;
   bool StackFirst;
+  bool TimeTraceEnabled;
   bool Trace;
   uint32_t GlobalBase;
   uint32_t InitialMemory;
@@ -57,6 +58,7 @@ struct Configuration {
   llvm::StringRef Entry;
   llvm::StringRef OutputFile;
   llvm::StringRef ThinLTOCacheDir;
+  llvm::StringRef TimeTraceFile;
 
   llvm::StringSet<> AllowUndefinedSymbols;
   std::vector<llvm::StringRef> SearchPaths;
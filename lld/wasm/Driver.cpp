@@ -29,6 +29,7 @@
 #include "llvm/Support/Process.h"
 #include "llvm/Support/TarWriter.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
 
 #define DEBUG_TYPE "lld"
 
@@ -332,6 +333,8 @@ static void readConfigs(opt::InputArgList &Args) {
   Config->StripAll = Args.hasArg(OPT_strip_all);
   Config->StripDebug = Args.hasArg(OPT_strip_debug);
   Config->StackFirst = Args.hasArg(OPT_stack_first);
+  Config->TimeTraceEnabled = Args.hasArg(OPT_time_trace);
+  Config->TimeTraceFile = Args.getLastArgValue(OPT_time_trace_file_eq);
   Config->Trace = Args.hasArg(OPT_trace);
   Config->ThinLTOCacheDir = Args.getLastArgValue(OPT_thinlto_cache_dir);
   Config->ThinLTOCachePolicy = CHECK(
@@ -666,6 +669,9 @@ void LinkerDriver::link(ArrayRef<const char *> ArgsArr) {
     return;
   }
 
+  if (Config->TimeTraceEnabled)
+    timeTraceProfilerInitialize(args::getFilenameWithoutExe(ArgsArr[0]));
+
   // Handle --trace-symbol.
   for (auto *Arg : Args.filtered(OPT_trace_symbol))
     Symtab->trace(Arg->getValue());
@@ -673,16 +679,19 @@ void LinkerDriver::link(ArrayRef<const char *> ArgsArr) {
   if (!Config->Relocatable)
     createSyntheticSymbols();
 
-  createFiles(Args);
-  if (errorCount())
-    return;
+  {
+    llvm::TimeTraceScope TimeScope("Parse input files", StringRef(""));
+    createFiles(Args);
+    if (errorCount())
+      return;
 
-  // Add all files to the symbol table. This will add almost all
-  // symbols that we need to the symbol table.
-  for (InputFile *F : Files)
-    Symtab->addFile(F);
-  if (errorCount())
-    return;
+    // Add all files to the symbol table. This will add almost all
+    // symbols that we need to the symbol table.
+    for (InputFile *F : Files)
+      Symtab->addFile(F);
+    if (errorCount())
+      return;
+  }
 
   // Handle the `--undefined <sym>` options.
   for (auto *Arg : Args.filtered(OPT_undefined))
@@ -751,4 +760,12 @@ void LinkerDriver::link(ArrayRef<const char *> ArgsArr) {
 
   // Write the result to the file.
   writeResult();
+
+  // Handle --time-trace.
+  if (Config->TimeTraceEnabled) {
+    if (Error E =
+            timeTraceProfilerWrite(Config->TimeTraceFile, Config->OutputFile))
+      error("--time-trace: " + toString(std::move(E)));
+    timeTraceProfilerCleanup();
+  }
 }
@@ -25,6 +25,7 @@
 #include "InputGlobal.h"
 #include "SymbolTable.h"
 #include "Symbols.h"
+#include "llvm/Support/TimeProfiler.h"
 
 #define DEBUG_TYPE "lld"
 
@@ -35,6 +36,8 @@ void lld::wasm::markLive() {
   if (!Config->GcSections)
     return;
 
+  llvm::TimeTraceScope TimeScope("GC", StringRef(""));
+
   LLVM_DEBUG(dbgs() << "markLive\n");
   SmallVector<InputChunk *, 256> Q;
 
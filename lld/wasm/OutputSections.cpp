@@ -109,8 +109,8 @@ void CodeSection::writeTo(uint8_t *Buf) {
   memcpy(Buf, CodeSectionHeader.data(), CodeSectionHeader.size());
 
   // Write code section bodies
-  for (const InputChunk *Chunk : Functions)
-    Chunk->writeTo(Buf);
+  parallelForEach(Functions,
+                  [&](const InputChunk *Chunk) { Chunk->writeTo(Buf); });
 }
 
 uint32_t CodeSection::numRelocations() const {
@@ -179,8 +179,8 @@ void DataSection::writeTo(uint8_t *Buf) {
     memcpy(SegStart, Segment->Header.data(), Segment->Header.size());
 
     // Write segment data payload
-    for (const InputChunk *Chunk : Segment->InputSegments)
-      Chunk->writeTo(Buf);
+    parallelForEach(Segment->InputSegments,
+                    [&](const InputChunk *Chunk) { Chunk->writeTo(Buf); });
   }
 }
 
@@ -227,8 +227,8 @@ void CustomSection::writeTo(uint8_t *Buf) {
   Buf += NameData.size();
 
   // Write custom sections payload
-  for (const InputSection *Section : InputSections)
-    Section->writeTo(Buf);
+  parallelForEach(InputSections,
+                  [&](const InputSection *Section) { Section->writeTo(Buf); });
 }
 
 uint32_t CustomSection::numRelocations() const {
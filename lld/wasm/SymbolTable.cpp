@@ -15,6 +15,7 @@
 #include "lld/Common/ErrorHandler.h"
 #include "lld/Common/Memory.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/Support/TimeProfiler.h"
 
 #define DEBUG_TYPE "lld"
 
@@ -52,6 +53,8 @@ void SymbolTable::addCombinedLTOObject() {
   if (BitcodeFiles.empty())
     return;
 
+  llvm::TimeTraceScope TimeScope("LTO", StringRef(""));
+
   // Compile bitcode files and replace bitcode symbols.
   LTO.reset(new BitcodeCompiler);
   for (BitcodeFile *F : BitcodeFiles)
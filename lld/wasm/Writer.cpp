@@ -20,7 +20,6 @@
 #include "lld/Common/ErrorHandler.h"
 #include "lld/Common/Memory.h"
 #include "lld/Common/Strings.h"
-#include "lld/Common/Threads.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallVector.h"
@@ -31,6 +30,7 @@
 #include "llvm/Support/Format.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/LEB128.h"
+#include "llvm/Support/TimeProfiler.h"
 
 #include <cstdarg>
 #include <map>
@@ -180,11 +180,15 @@ void Writer::writeHeader() {
 }
 
 void Writer::writeSections() {
+  // Sections are written one at a time. Each section copies its input chunks
+  // and applies their relocations in parallel, which spreads the work better
+  // than one thread per section because the code and data sections are
+  // usually far larger than the others.
   uint8_t *Buf = Buffer->getBufferStart();
-  parallelForEach(OutputSections, [Buf](OutputSection *S) {
+  for (OutputSection *S : OutputSections) {
     assert(S->isNeeded());
     S->writeTo(Buf);
-  });
+  }
 }
 
 // Fix the memory layout of the output binary.  This assigns memory offsets
@@ -754,7 +758,10 @@ void Writer::run() {
   }
 
   log("-- scanRelocations");
-  scanRelocations();
+  {
+    llvm::TimeTraceScope TimeScope("Scan relocations", StringRef(""));
+    scanRelocations();
+  }
   log("-- assignIndexes");
   assignIndexes();
   log("-- calculateInitFunctions");
@@ -798,7 +805,10 @@ void Writer::run() {
 
   createHeader();
   log("-- finalizeSections");
-  finalizeSections();
+  {
+    llvm::TimeTraceScope TimeScope("Finalize sections", StringRef(""));
+    finalizeSections();
+  }
 
   log("-- openFile");
   openFile();
@@ -808,10 +818,14 @@ void Writer::run() {
   writeHeader();
 
   log("-- writeSections");
-  writeSections();
+  {
+    llvm::TimeTraceScope TimeScope("Write sections", StringRef(""));
+    writeSections();
+  }
   if (errorCount())
     return;
 
+  llvm::TimeTraceScope TimeScope("Commit output file", StringRef(""));
   if (Error E = Buffer->commit())
     fatal("failed to write the output file: " + toString(std::move(E)));
 }
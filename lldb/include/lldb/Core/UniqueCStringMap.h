@@ -51,6 +51,11 @@ public:
 
   void Append(const Entry &e) { m_map.push_back(e); }
 
+  // Add all the entries of another map, which has to be sorted again too.
+  void Append(const UniqueCStringMap &rhs) {
+    m_map.insert(m_map.end(), rhs.m_map.begin(), rhs.m_map.end());
+  }
+
   void Clear() { m_map.clear(); }
 
   // Call this function to always keep the map sorted when putting entries into
@@ -10,11 +10,11 @@
 #ifndef lldb_FormatCache_h_
 #define lldb_FormatCache_h_
 
-#include <map>
 #include <mutex>
 
 #include "lldb/Utility/ConstString.h"
 #include "lldb/lldb-public.h"
+#include "llvm/ADT/DenseMap.h"
 
 namespace lldb_private {
 class FormatCache {
@@ -64,7 +64,9 @@ private:
 
     void SetValidator(lldb::TypeValidatorImplSP);
   };
-  typedef std::map<ConstString, Entry> CacheMap;
+  // Type names are uniqued ConstStrings, so the cache is keyed on the string
+  // pointer and a lookup never has to compare the names themselves.
+  typedef llvm::DenseMap<const char *, Entry> CacheMap;
   CacheMap m_map;
   std::recursive_mutex m_mutex;
 
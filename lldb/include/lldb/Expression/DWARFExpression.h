@@ -297,6 +297,20 @@ private:
   bool GetOpAndEndOffsets(StackFrame &frame, lldb::offset_t &op_offset,
                           lldb::offset_t &end_offset);
 
+  /// An entry of a location list, decoded from m_data.
+  struct LocationListEntry {
+    /// The range of the entry, before it is slid.
+    lldb::addr_t lo_pc;
+    lldb::addr_t hi_pc;
+    /// The offset and length of the entry's expression in m_data.
+    lldb::offset_t offset;
+    uint16_t length;
+  };
+
+  /// Decode the entries of the location list in m_data into
+  /// m_loclist_entries.
+  void DecodeLocationList();
+
   /// Module which defined this expression.
   lldb::ModuleWP m_module_wp;
 
@@ -315,6 +329,12 @@ private:
   /// relative to the object that owns the location list (the function for
   /// frame base and variable location lists)
   lldb::addr_t m_loclist_slide;
+
+  /// The entries of the location list, decoded once when this expression
+  /// becomes a location list. Variables are evaluated again on every stop,
+  /// and this saves decoding the list (and reading .debug_addr for split
+  /// DWARF) each time.
+  std::vector<LocationListEntry> m_loclist_entries;
 };
 
 } // namespace lldb_private
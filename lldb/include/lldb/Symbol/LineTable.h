@@ -14,6 +14,8 @@
 #include "lldb/Symbol/LineEntry.h"
 #include "lldb/Utility/RangeMap.h"
 #include "lldb/lldb-private.h"
+#include "llvm/ADT/DenseMap.h"
+#include <mutex>
 #include <vector>
 
 namespace lldb_private {
@@ -321,6 +323,12 @@ protected:
       *m_comp_unit; ///< The compile unit that this line table belongs to.
   entry_collection
       m_entries; ///< The collection of line entries in this line table.
+  /// The indexes of the line entries of each support file, in the order of
+  /// the entries. Built on first use, so that searching for a line in a file
+  /// that only contributes a few entries to the line table is cheap.
+  llvm::DenseMap<uint32_t, std::vector<uint32_t>> m_file_idx_to_entries;
+  bool m_file_idx_to_entries_valid = false;
+  std::mutex m_file_idx_to_entries_mutex;
 
   // Helper class
   class LineSequenceImpl : public LineSequence {
@@ -337,6 +345,12 @@ protected:
 
   bool ConvertEntryAtIndexToLineEntry(uint32_t idx, LineEntry &line_entry);
 
+  /// Get the indexes of the entries for \a file_idx, or nullptr if no entry
+  /// refers to that file. Terminal entries are not included.
+  const std::vector<uint32_t> *GetEntryIndexesForFileIndex(uint32_t file_idx);
+
+  void InvalidateFileIndexMap();
+
 private:
   DISALLOW_COPY_AND_ASSIGN(LineTable);
 };
@@ -1446,6 +1446,33 @@ public:
   virtual size_t ReadMemory(lldb::addr_t vm_addr, void *buf, size_t size,
                             Status &error);
 
+  /// Get a view of the memory of a process without copying it.
+  ///
+  /// Post-mortem processes hold the memory of the process in their core
+  /// file, which is mapped into the address space of the debugger, so they
+  /// can return the bytes in place instead of copying them out in
+  /// ReadMemory. Tools that scan large parts of a core file (every thread's
+  /// stack, say) should try this first and fall back to ReadMemory. The
+  /// memory of a core file never changes, so this is safe to call from
+  /// multiple threads.
+  ///
+  /// \param[in] vm_addr
+  ///     A virtual load address that indicates where to start viewing
+  ///     memory from.
+  ///
+  /// \param[in] size
+  ///     The number of bytes to view.
+  ///
+  /// \return
+  ///     The bytes at \a vm_addr, valid for as long as this process exists.
+  ///     This can be fewer than \a size bytes if the core file doesn't
+  ///     contain all of them. An empty array is returned if the memory can't
+  ///     be viewed in place.
+  virtual llvm::ArrayRef<uint8_t> PeekMemory(lldb::addr_t vm_addr,
+                                             size_t size) {
+    return llvm::ArrayRef<uint8_t>();
+  }
+
   /// Read of memory from a process.
   ///
   /// This function has the same semantics of ReadMemory except that it
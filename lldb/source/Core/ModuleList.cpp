@@ -80,9 +80,18 @@ static constexpr PropertyDefinition g_properties[] = {
     },
     {"clang-modules-cache-path", OptionValue::eTypeFileSpec, true, 0, nullptr,
      {},
-     "The path to the clang modules cache directory (-fmodules-cache-path)."}};
-
-enum { ePropertyEnableExternalLookup, ePropertyClangModulesCachePath };
+     "The path to the clang modules cache directory (-fmodules-cache-path)."},
+    {"dwarf-index-cache-path", OptionValue::eTypeFileSpec, true, 0, nullptr,
+     {},
+     "The path to a directory in which to cache the indexes built for DWARF "
+     "without accelerator tables, so that they are not built again the next "
+     "time the same module is loaded. Empty disables the cache."}};
+
+enum {
+  ePropertyEnableExternalLookup,
+  ePropertyClangModulesCachePath,
+  ePropertyDWARFIndexCachePath
+};
 
 } // namespace
 
@@ -114,6 +123,18 @@ bool ModuleListProperties::SetClangModulesCachePath(llvm::StringRef path) {
       nullptr, ePropertyClangModulesCachePath, path);
 }
 
+FileSpec ModuleListProperties::GetDWARFIndexCachePath() const {
+  return m_collection_sp
+      ->GetPropertyAtIndexAsOptionValueFileSpec(nullptr, false,
+                                                ePropertyDWARFIndexCachePath)
+      ->GetCurrentValue();
+}
+
+bool ModuleListProperties::SetDWARFIndexCachePath(llvm::StringRef path) {
+  return m_collection_sp->SetPropertyAtIndexAsString(
+      nullptr, ePropertyDWARFIndexCachePath, path);
+}
+
 ModuleList::ModuleList()
     : m_modules(), m_modules_mutex(), m_notifier(nullptr) {}
 
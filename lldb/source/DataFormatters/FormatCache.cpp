@@ -110,17 +110,13 @@ FormatCache::FormatCache()
 }
 
 FormatCache::Entry &FormatCache::GetEntry(ConstString type) {
-  auto i = m_map.find(type), e = m_map.end();
-  if (i != e)
-    return i->second;
-  m_map[type] = FormatCache::Entry();
-  return m_map[type];
+  return m_map[type.GetCString()];
 }
 
 bool FormatCache::GetFormat(ConstString type,
                             lldb::TypeFormatImplSP &format_sp) {
   std::lock_guard<std::recursive_mutex> guard(m_mutex);
-  auto entry = GetEntry(type);
+  auto &entry = GetEntry(type);
   if (entry.IsFormatCached()) {
 #ifdef LLDB_CONFIGURATION_DEBUG
     m_cache_hits++;
@@ -138,7 +134,7 @@ bool FormatCache::GetFormat(ConstString type,
 bool FormatCache::GetSummary(ConstString type,
                              lldb::TypeSummaryImplSP &summary_sp) {
   std::lock_guard<std::recursive_mutex> guard(m_mutex);
-  auto entry = GetEntry(type);
+  auto &entry = GetEntry(type);
   if (entry.IsSummaryCached()) {
 #ifdef LLDB_CONFIGURATION_DEBUG
     m_cache_hits++;
@@ -156,7 +152,7 @@ bool FormatCache::GetSummary(ConstString type,
 bool FormatCache::GetSynthetic(ConstString type,
                                lldb::SyntheticChildrenSP &synthetic_sp) {
   std::lock_guard<std::recursive_mutex> guard(m_mutex);
-  auto entry = GetEntry(type);
+  auto &entry = GetEntry(type);
   if (entry.IsSyntheticCached()) {
 #ifdef LLDB_CONFIGURATION_DEBUG
     m_cache_hits++;
@@ -174,7 +170,7 @@ bool FormatCache::GetSynthetic(ConstString type,
 bool FormatCache::GetValidator(ConstString type,
                                lldb::TypeValidatorImplSP &validator_sp) {
   std::lock_guard<std::recursive_mutex> guard(m_mutex);
-  auto entry = GetEntry(type);
+  auto &entry = GetEntry(type);
   if (entry.IsValidatorCached()) {
 #ifdef LLDB_CONFIGURATION_DEBUG
     m_cache_hits++;
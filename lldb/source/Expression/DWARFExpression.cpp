@@ -477,6 +477,31 @@ void DWARFExpression::DumpLocation(Stream *s, lldb::offset_t offset,
 
 void DWARFExpression::SetLocationListSlide(addr_t slide) {
   m_loclist_slide = slide;
+  DecodeLocationList();
+}
+
+void DWARFExpression::DecodeLocationList() {
+  m_loclist_entries.clear();
+  if (!m_dwarf_cu)
+    return;
+
+  lldb::offset_t offset = 0;
+  while (m_data.ValidOffset(offset)) {
+    LocationListEntry entry;
+    entry.lo_pc = LLDB_INVALID_ADDRESS;
+    entry.hi_pc = LLDB_INVALID_ADDRESS;
+    if (!AddressRangeForLocationListEntry(m_dwarf_cu, m_data, &offset,
+                                          entry.lo_pc, entry.hi_pc))
+      break;
+
+    if (entry.lo_pc == 0 && entry.hi_pc == 0)
+      break;
+
+    entry.length = m_data.GetU16(&offset);
+    entry.offset = offset;
+    m_loclist_entries.push_back(entry);
+    offset += entry.length;
+  }
 }
 
 int DWARFExpression::GetRegisterKind() { return m_reg_kind; }
@@ -993,29 +1018,15 @@ bool DWARFExpression::LocationListContainsAddress(
     return false;
 
   if (IsLocationList()) {
-    lldb::offset_t offset = 0;
-
     if (loclist_base_addr == LLDB_INVALID_ADDRESS)
       return false;
 
-    while (m_data.ValidOffset(offset)) {
-      // We need to figure out what the value is for the location.
-      addr_t lo_pc = LLDB_INVALID_ADDRESS;
-      addr_t hi_pc = LLDB_INVALID_ADDRESS;
-      if (!AddressRangeForLocationListEntry(m_dwarf_cu, m_data, &offset, lo_pc,
-                                            hi_pc))
-        break;
-
-      if (lo_pc == 0 && hi_pc == 0)
-        break;
-
-      lo_pc += loclist_base_addr - m_loclist_slide;
-      hi_pc += loclist_base_addr - m_loclist_slide;
+    for (const LocationListEntry &entry : m_loclist_entries) {
+      addr_t lo_pc = entry.lo_pc + loclist_base_addr - m_loclist_slide;
+      addr_t hi_pc = entry.hi_pc + loclist_base_addr - m_loclist_slide;
 
       if (lo_pc <= addr && addr < hi_pc)
         return true;
-
-      offset += m_data.GetU16(&offset);
     }
   }
   return false;
@@ -1031,28 +1042,15 @@ bool DWARFExpression::GetLocation(addr_t base_addr, addr_t pc,
   }
 
   if (base_addr != LLDB_INVALID_ADDRESS && pc != LLDB_INVALID_ADDRESS) {
-    addr_t curr_base_addr = base_addr;
+    for (const LocationListEntry &entry : m_loclist_entries) {
+      addr_t lo_pc = entry.lo_pc + base_addr - m_loclist_slide;
+      addr_t hi_pc = entry.hi_pc + base_addr - m_loclist_slide;
 
-    while (m_data.ValidOffset(offset)) {
-      // We need to figure out what the value is for the location.
-      addr_t lo_pc = LLDB_INVALID_ADDRESS;
-      addr_t hi_pc = LLDB_INVALID_ADDRESS;
-      if (!AddressRangeForLocationListEntry(m_dwarf_cu, m_data, &offset, lo_pc,
-                                            hi_pc))
-        break;
-
-      if (lo_pc == 0 && hi_pc == 0)
-        break;
-
-      lo_pc += curr_base_addr - m_loclist_slide;
-      hi_pc += curr_base_addr - m_loclist_slide;
-
-      length = m_data.GetU16(&offset);
-
-      if (length > 0 && lo_pc <= pc && pc < hi_pc)
+      if (entry.length > 0 && lo_pc <= pc && pc < hi_pc) {
+        offset = entry.offset;
+        length = entry.length;
         return true;
-
-      offset += length;
+      }
     }
   }
   offset = LLDB_INVALID_OFFSET;
@@ -1097,7 +1095,6 @@ bool DWARFExpression::Evaluate(ExecutionContext *exe_ctx,
   ModuleSP module_sp = m_module_wp.lock();
 
   if (IsLocationList()) {
-    lldb::offset_t offset = 0;
     addr_t pc;
     StackFrame *frame = nullptr;
     if (reg_ctx)
@@ -1119,31 +1116,18 @@ bool DWARFExpression::Evaluate(ExecutionContext *exe_ctx,
         return false;
       }
 
-      addr_t curr_loclist_base_load_addr = loclist_base_load_addr;
-
-      while (m_data.ValidOffset(offset)) {
-        // We need to figure out what the value is for the location.
-        addr_t lo_pc = LLDB_INVALID_ADDRESS;
-        addr_t hi_pc = LLDB_INVALID_ADDRESS;
-        if (!AddressRangeForLocationListEntry(m_dwarf_cu, m_data, &offset,
-                                              lo_pc, hi_pc))
-          break;
-
-        if (lo_pc == 0 && hi_pc == 0)
-          break;
-
-        lo_pc += curr_loclist_base_load_addr - m_loclist_slide;
-        hi_pc += curr_loclist_base_load_addr - m_loclist_slide;
-
-        uint16_t length = m_data.GetU16(&offset);
+      for (const LocationListEntry &entry : m_loclist_entries) {
+        addr_t lo_pc =
+            entry.lo_pc + loclist_base_load_addr - m_loclist_slide;
+        addr_t hi_pc =
+            entry.hi_pc + loclist_base_load_addr - m_loclist_slide;
 
-        if (length > 0 && lo_pc <= pc && pc < hi_pc) {
+        if (entry.length > 0 && lo_pc <= pc && pc < hi_pc) {
           return DWARFExpression::Evaluate(
-              exe_ctx, reg_ctx, module_sp, m_data, m_dwarf_cu, offset, length,
-              m_reg_kind, initial_value_ptr, object_address_ptr,
+              exe_ctx, reg_ctx, module_sp, m_data, m_dwarf_cu, entry.offset,
+              entry.length, m_reg_kind, initial_value_ptr, object_address_ptr,
               byte_size, result, error_ptr);
         }
-        offset += length;
       }
     }
     if (error_ptr)
@@ -196,6 +196,26 @@ public:
     return false;
   }
 
+  // Floating-point values are kept as their bit patterns, like integers.
+  bool EvaluateFPValue(APFloat &fp_value, const Value *value, Module &module) {
+    lldb_private::Scalar scalar;
+
+    if (!EvaluateValue(scalar, value, module))
+      return false;
+
+    const fltSemantics &semantics = value->getType()->getFltSemantics();
+    fp_value = APFloat(semantics, APInt(APFloat::getSizeInBits(semantics),
+                                        scalar.ULongLong()));
+    return true;
+  }
+
+  bool AssignFPValue(const Value *value, const APFloat &fp_value,
+                     Module &module) {
+    lldb_private::Scalar scalar(
+        (unsigned long long)fp_value.bitcastToAPInt().getZExtValue());
+    return AssignValue(value, scalar, module);
+  }
+
   bool AssignValue(const Value *value, lldb_private::Scalar &scalar,
                    Module &module) {
     lldb::addr_t process_address = ResolveValue(value, module);
@@ -573,8 +593,30 @@ bool IRInterpreter::CanInterpret(llvm::Module &module, llvm::Function &function,
           break;
         }
       } break;
+      case Instruction::FPExt:
+      case Instruction::FPToSI:
+      case Instruction::FPToUI:
+      case Instruction::SIToFP:
+      case Instruction::UIToFP:
+        // The operands are checked below, but the result of a conversion can
+        // be wider than they are.
+        if (ii->getType()->getPrimitiveSizeInBits() > 64) {
+          if (log)
+            log->Printf("Unsupported result type: %s",
+                        PrintType(ii->getType()).c_str());
+          error.SetErrorString(unsupported_operand_error);
+          return false;
+        }
+        break;
       case Instruction::And:
       case Instruction::AShr:
+      case Instruction::FAdd:
+      case Instruction::FCmp:
+      case Instruction::FDiv:
+      case Instruction::FMul:
+      case Instruction::FNeg:
+      case Instruction::FPTrunc:
+      case Instruction::FSub:
       case Instruction::IntToPtr:
       case Instruction::PtrToInt:
       case Instruction::Load:
@@ -583,6 +625,7 @@ bool IRInterpreter::CanInterpret(llvm::Module &module, llvm::Function &function,
       case Instruction::Or:
       case Instruction::Ret:
       case Instruction::SDiv:
+      case Instruction::Select:
       case Instruction::SExt:
       case Instruction::Shl:
       case Instruction::SRem:
@@ -1197,6 +1240,238 @@ bool IRInterpreter::Interpret(llvm::Module &module, llvm::Function &function,
         log->Printf("  = : %s", frame.SummarizeValue(inst).c_str());
       }
     } break;
+    case Instruction::FAdd:
+    case Instruction::FSub:
+    case Instruction::FMul:
+    case Instruction::FDiv:
+    case Instruction::FNeg: {
+      Value *lhs = inst->getOperand(0);
+
+      APFloat L(0.0);
+
+      if (!frame.EvaluateFPValue(L, lhs, module)) {
+        if (log)
+          log->Printf("Couldn't evaluate %s", PrintValue(lhs).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(bad_value_error);
+        return false;
+      }
+
+      APFloat R(0.0);
+
+      if (inst->getOpcode() != Instruction::FNeg &&
+          !frame.EvaluateFPValue(R, inst->getOperand(1), module)) {
+        if (log)
+          log->Printf("Couldn't evaluate %s",
+                      PrintValue(inst->getOperand(1)).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(bad_value_error);
+        return false;
+      }
+
+      const APFloat::roundingMode rounding = APFloat::rmNearestTiesToEven;
+
+      switch (inst->getOpcode()) {
+      default:
+        break;
+      case Instruction::FAdd:
+        L.add(R, rounding);
+        break;
+      case Instruction::FSub:
+        L.subtract(R, rounding);
+        break;
+      case Instruction::FMul:
+        L.multiply(R, rounding);
+        break;
+      case Instruction::FDiv:
+        L.divide(R, rounding);
+        break;
+      case Instruction::FNeg:
+        L.changeSign();
+        break;
+      }
+
+      if (!frame.AssignFPValue(inst, L, module)) {
+        error.SetErrorToGenericError();
+        error.SetErrorString(memory_write_error);
+        return false;
+      }
+
+      if (log) {
+        log->Printf("Interpreted a %s", inst->getOpcodeName());
+        log->Printf("  L : %s", frame.SummarizeValue(lhs).c_str());
+        log->Printf("  = : %s", frame.SummarizeValue(inst).c_str());
+      }
+    } break;
+    case Instruction::FCmp: {
+      const FCmpInst *fcmp_inst = dyn_cast<FCmpInst>(inst);
+
+      if (!fcmp_inst) {
+        if (log)
+          log->Printf(
+              "getOpcode() returns FCmp, but instruction is not an FCmpInst");
+        error.SetErrorToGenericError();
+        error.SetErrorString(interpreter_internal_error);
+        return false;
+      }
+
+      Value *lhs = inst->getOperand(0);
+      Value *rhs = inst->getOperand(1);
+
+      APFloat L(0.0);
+      APFloat R(0.0);
+
+      if (!frame.EvaluateFPValue(L, lhs, module)) {
+        if (log)
+          log->Printf("Couldn't evaluate %s", PrintValue(lhs).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(bad_value_error);
+        return false;
+      }
+
+      if (!frame.EvaluateFPValue(R, rhs, module)) {
+        if (log)
+          log->Printf("Couldn't evaluate %s", PrintValue(rhs).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(bad_value_error);
+        return false;
+      }
+
+      // The bits of an FCmp predicate say which outcomes of the comparison
+      // make it true: 1 for equal, 2 for greater, 4 for less and 8 for
+      // unordered.
+      unsigned outcome = 0;
+      switch (L.compare(R)) {
+      case APFloat::cmpEqual:
+        outcome = 1;
+        break;
+      case APFloat::cmpGreaterThan:
+        outcome = 2;
+        break;
+      case APFloat::cmpLessThan:
+        outcome = 4;
+        break;
+      case APFloat::cmpUnordered:
+        outcome = 8;
+        break;
+      }
+
+      lldb_private::Scalar result = (fcmp_inst->getPredicate() & outcome) != 0;
+
+      frame.AssignValue(inst, result, module);
+
+      if (log) {
+        log->Printf("Interpreted an FCmpInst");
+        log->Printf("  L : %s", frame.SummarizeValue(lhs).c_str());
+        log->Printf("  R : %s", frame.SummarizeValue(rhs).c_str());
+        log->Printf("  = : %s", frame.SummarizeValue(inst).c_str());
+      }
+    } break;
+    case Instruction::FPExt:
+    case Instruction::FPTrunc:
+    case Instruction::FPToSI:
+    case Instruction::FPToUI:
+    case Instruction::SIToFP:
+    case Instruction::UIToFP: {
+      Value *src_operand = inst->getOperand(0);
+      Type *src_type = src_operand->getType();
+      Type *dst_type = inst->getType();
+
+      lldb_private::Scalar I;
+
+      if (!frame.EvaluateValue(I, src_operand, module)) {
+        if (log)
+          log->Printf("Couldn't evaluate %s", PrintValue(src_operand).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(bad_value_error);
+        return false;
+      }
+
+      const APFloat::roundingMode rounding = APFloat::rmNearestTiesToEven;
+      bool assigned = false;
+
+      if (src_type->isFloatingPointTy()) {
+        const fltSemantics &src_semantics = src_type->getFltSemantics();
+        APFloat F(src_semantics,
+                  APInt(APFloat::getSizeInBits(src_semantics), I.ULongLong()));
+
+        if (dst_type->isFloatingPointTy()) {
+          bool loses_info;
+          F.convert(dst_type->getFltSemantics(), rounding, &loses_info);
+          assigned = frame.AssignFPValue(inst, F, module);
+        } else {
+          APSInt result(dst_type->getIntegerBitWidth(),
+                        inst->getOpcode() == Instruction::FPToUI);
+          bool is_exact;
+          F.convertToInteger(result, APFloat::rmTowardZero, &is_exact);
+          lldb_private::Scalar R((unsigned long long)result.getZExtValue());
+          assigned = frame.AssignValue(inst, R, module);
+        }
+      } else {
+        APFloat F(dst_type->getFltSemantics());
+        F.convertFromAPInt(APInt(src_type->getIntegerBitWidth(), I.ULongLong()),
+                           inst->getOpcode() == Instruction::SIToFP, rounding);
+        assigned = frame.AssignFPValue(inst, F, module);
+      }
+
+      if (!assigned) {
+        error.SetErrorToGenericError();
+        error.SetErrorString(memory_write_error);
+        return false;
+      }
+
+      if (log) {
+        log->Printf("Interpreted a %s", inst->getOpcodeName());
+        log->Printf("  Src : %s", frame.SummarizeValue(src_operand).c_str());
+        log->Printf("  =   : %s", frame.SummarizeValue(inst).c_str());
+      }
+    } break;
+    case Instruction::Select: {
+      const SelectInst *select_inst = dyn_cast<SelectInst>(inst);
+
+      if (!select_inst) {
+        if (log)
+          log->Printf(
+              "getOpcode() returns Select, but instruction is not a "
+              "SelectInst");
+        error.SetErrorToGenericError();
+        error.SetErrorString(interpreter_internal_error);
+        return false;
+      }
+
+      lldb_private::Scalar C;
+
+      if (!frame.EvaluateValue(C, select_inst->getCondition(), module)) {
+        if (log)
+          log->Printf("Couldn't evaluate %s",
+                      PrintValue(select_inst->getCondition()).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(bad_value_error);
+        return false;
+      }
+
+      const Value *selected = C.ULongLong() & 1 ? select_inst->getTrueValue()
+                                          : select_inst->getFalseValue();
+
+      lldb_private::Scalar S;
+
+      if (!frame.EvaluateValue(S, selected, module)) {
+        if (log)
+          log->Printf("Couldn't evaluate %s", PrintValue(selected).c_str());
+        error.SetErrorToGenericError();
+        error.SetErrorString(bad_value_error);
+        return false;
+      }
+
+      frame.AssignValue(inst, S, module);
+
+      if (log) {
+        log->Printf("Interpreted a SelectInst");
+        log->Printf("  C : %s",
+                    frame.SummarizeValue(select_inst->getCondition()).c_str());
+        log->Printf("  = : %s", frame.SummarizeValue(inst).c_str());
+      }
+    } break;
     case Instruction::IntToPtr: {
       const IntToPtrInst *int_to_ptr_inst = dyn_cast<IntToPtrInst>(inst);
 
@@ -25,6 +25,7 @@
 #include "lldb/Target/ThreadPlanRunToAddress.h"
 #include "lldb/Utility/Log.h"
 #include "lldb/Utility/ProcessInfo.h"
+#include "llvm/Support/ThreadPool.h"
 
 #include <memory>
 
@@ -578,6 +579,7 @@ void DynamicLoaderPOSIXDYLD::LoadAllCurrentModules() {
     module_names.push_back(I->file_spec);
   m_process->PrefetchModuleSpecs(
       module_names, m_process->GetTarget().GetArchitecture().GetTriple());
+  std::vector<ModuleSP> preloaded_modules = PreloadModules(module_names);
 
   for (I = m_rendezvous.begin(), E = m_rendezvous.end(); I != E; ++I) {
     ModuleSP module_sp =
@@ -598,6 +600,42 @@ void DynamicLoaderPOSIXDYLD::LoadAllCurrentModules() {
   m_process->GetTarget().ModulesDidLoad(module_list);
 }
 
+std::vector<ModuleSP>
+DynamicLoaderPOSIXDYLD::PreloadModules(const std::vector<FileSpec> &files) {
+  // Loading the modules one at a time means indexing the symbols of each in
+  // turn, which dominates the time it takes to attach to a process with many
+  // shared libraries. Only do this ahead of time for the host platform,
+  // where the module found for a file doesn't depend on a platform cache.
+  Target &target = m_process->GetTarget();
+  PlatformSP platform_sp = target.GetPlatform();
+  if (!target.GetPreloadSymbols() || !platform_sp || !platform_sp->IsHost() ||
+      files.size() < 2)
+    return {};
+
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_DYNAMIC_LOADER));
+  const ArchSpec &arch = target.GetArchitecture();
+  const FileSpecList search_paths = target.GetExecutableSearchPaths();
+  std::vector<ModuleSP> modules(files.size());
+
+  // Symbol preloading uses the TaskPool itself, so the modules are loaded on
+  // threads of their own rather than with TaskMapOverInt.
+  llvm::ThreadPool pool;
+  for (size_t i = 0; i < files.size(); ++i) {
+    pool.async([&, i] {
+      ModuleSpec module_spec(files[i], arch);
+      Status error = platform_sp->GetSharedModule(
+          module_spec, m_process, modules[i], &search_paths, nullptr, nullptr);
+      if (modules[i])
+        modules[i]->PreloadSymbols();
+      else
+        LLDB_LOG(log, "PreloadModules failed to load {0}: {1}", files[i],
+                 error);
+    });
+  }
+  pool.wait();
+  return modules;
+}
+
 addr_t DynamicLoaderPOSIXDYLD::ComputeLoadOffset() {
   addr_t virt_entry;
 
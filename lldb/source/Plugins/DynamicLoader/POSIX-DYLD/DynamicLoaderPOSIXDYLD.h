@@ -133,6 +133,12 @@ protected:
   /// of all dependent modules.
   virtual void LoadAllCurrentModules();
 
+  /// Creates the modules of the given files and preloads their symbols in
+  /// parallel, so that adding them to the target afterwards is quick. The
+  /// returned modules have to be kept until then.
+  std::vector<lldb::ModuleSP>
+  PreloadModules(const std::vector<lldb_private::FileSpec> &files);
+
   void LoadVDSO();
 
   // Loading an interpreter module (if present) assumming m_interpreter_base
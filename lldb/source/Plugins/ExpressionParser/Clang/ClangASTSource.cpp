@@ -265,6 +265,19 @@ bool ClangASTSource::FindExternalVisibleDeclsByName(
   return (name_decls.size() != 0);
 }
 
+static bool IsEquivalentTagType(TagDecl *tag_decl,
+                                const CompilerType &candidate_type) {
+  if (!ClangUtil::IsClangType(candidate_type))
+    return false;
+
+  const TagType *tag_type =
+      ClangUtil::GetQualType(candidate_type)->getAs<TagType>();
+  if (!tag_type)
+    return false;
+
+  return ClangASTContext::DeclsAreEquivalent(tag_decl, tag_type->getDecl());
+}
+
 void ClangASTSource::CompleteType(TagDecl *tag_decl) {
   Log *log(lldb_private::GetLogIfAllCategoriesSet(LIBLLDB_LOG_EXPRESSIONS));
 
@@ -362,8 +375,6 @@ void ClangASTSource::CompleteType(TagDecl *tag_decl) {
         }
       }
     } else {
-      TypeList types;
-
       ConstString name(tag_decl->getName().str().c_str());
       CompilerDeclContext namespace_decl;
 
@@ -371,39 +382,50 @@ void ClangASTSource::CompleteType(TagDecl *tag_decl) {
 
       bool exact_match = false;
       llvm::DenseSet<SymbolFile *> searched_symbol_files;
-      module_list.FindTypes(nullptr, name, exact_match, UINT32_MAX,
-                            searched_symbol_files, types);
 
-      for (uint32_t ti = 0, te = types.GetSize(); ti != te && !found; ++ti) {
-        lldb::TypeSP type = types.GetTypeAtIndex(ti);
+      // The same type is often defined in many of the loaded modules (think
+      // of the standard library types in every shared library). Search the
+      // modules one at a time and stop at the first one that can complete the
+      // type, so we don't parse the type from the DWARF of every module.
+      module_list.ForEach([&](const ModuleSP &module_sp) {
+        TypeList types;
+        module_sp->FindTypes(name, exact_match, UINT32_MAX,
+                             searched_symbol_files, types);
 
-        if (!type)
-          continue;
+        for (uint32_t ti = 0, te = types.GetSize(); ti != te && !found;
+             ++ti) {
+          lldb::TypeSP type = types.GetTypeAtIndex(ti);
 
-        CompilerType clang_type(type->GetFullCompilerType());
+          if (!type)
+            continue;
 
-        if (!ClangUtil::IsClangType(clang_type))
-          continue;
+          // We have found a type by basename and we need to make sure the
+          // decl contexts are the same before we can try to complete this
+          // type with another. The forward type is enough to check that, so
+          // only complete the candidates that match.
+          if (!IsEquivalentTagType(tag_decl, type->GetForwardCompilerType()))
+            continue;
 
-        const TagType *tag_type =
-            ClangUtil::GetQualType(clang_type)->getAs<TagType>();
+          CompilerType clang_type(type->GetFullCompilerType());
 
-        if (!tag_type)
-          continue;
+          if (!ClangUtil::IsClangType(clang_type))
+            continue;
 
-        TagDecl *candidate_tag_decl =
-            const_cast<TagDecl *>(tag_type->getDecl());
+          const TagType *tag_type =
+              ClangUtil::GetQualType(clang_type)->getAs<TagType>();
 
-        // We have found a type by basename and we need to make sure the decl
-        // contexts are the same before we can try to complete this type with
-        // another
-        if (!ClangASTContext::DeclsAreEquivalent(tag_decl, candidate_tag_decl))
-          continue;
+          if (!tag_type)
+            continue;
 
-        if (m_ast_importer_sp->CompleteTagDeclWithOrigin(tag_decl,
-                                                         candidate_tag_decl))
-          found = true;
-      }
+          TagDecl *candidate_tag_decl =
+              const_cast<TagDecl *>(tag_type->getDecl());
+
+          if (m_ast_importer_sp->CompleteTagDeclWithOrigin(tag_decl,
+                                                           candidate_tag_decl))
+            found = true;
+        }
+        return !found;
+      });
     }
   }
 
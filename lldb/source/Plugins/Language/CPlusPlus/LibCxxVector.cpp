@@ -10,12 +10,40 @@
 
 #include "lldb/Core/ValueObject.h"
 #include "lldb/DataFormatters/FormattersHelpers.h"
+#include "lldb/Target/Process.h"
 #include "lldb/Utility/ConstString.h"
 
 using namespace lldb;
 using namespace lldb_private;
 using namespace lldb_private::formatters;
 
+// The number of bytes of element storage read from the inferior at a time.
+// Displaying a large vector creates its children one after the other, and
+// without this every child would be read from the inferior on its own.
+static const lldb::addr_t g_vector_page_size = 64 * 1024;
+
+// Read the page of [base, base + size) that contains addr in a single memory
+// read. Reads larger than a cache line are kept in the process memory cache,
+// so the children that live in that page are then read from the cache.
+static void PrefetchVectorPage(Process &process, lldb::addr_t base,
+                               lldb::addr_t size, lldb::addr_t addr,
+                               lldb::addr_t &page_base,
+                               lldb::addr_t &page_end) {
+  if (addr >= page_base && addr < page_end)
+    return;
+  if (process.GetDisableMemoryCache())
+    return;
+  lldb::addr_t offset = addr - base;
+  page_base = base + offset - offset % g_vector_page_size;
+  page_end = std::min(page_base + g_vector_page_size, base + size);
+  // Reads that fit in a cache line are already cached a line at a time.
+  if (page_end - page_base <= process.GetMemoryCacheLineSize())
+    return;
+  std::vector<uint8_t> buffer(page_end - page_base);
+  Status error;
+  process.ReadMemory(page_base, buffer.data(), buffer.size(), error);
+}
+
 namespace lldb_private {
 namespace formatters {
 class LibcxxStdVectorSyntheticFrontEnd : public SyntheticChildrenFrontEnd {
@@ -39,6 +67,8 @@ private:
   ValueObject *m_finish;
   CompilerType m_element_type;
   uint32_t m_element_size;
+  lldb::addr_t m_page_base;
+  lldb::addr_t m_page_end;
 };
 
 class LibcxxVectorBoolSyntheticFrontEnd : public SyntheticChildrenFrontEnd {
@@ -60,6 +90,8 @@ private:
   ExecutionContextRef m_exe_ctx_ref;
   uint64_t m_count;
   lldb::addr_t m_base_data_address;
+  lldb::addr_t m_page_base;
+  lldb::addr_t m_page_end;
   std::map<size_t, lldb::ValueObjectSP> m_children;
 };
 
@@ -69,7 +101,8 @@ private:
 lldb_private::formatters::LibcxxStdVectorSyntheticFrontEnd::
     LibcxxStdVectorSyntheticFrontEnd(lldb::ValueObjectSP valobj_sp)
     : SyntheticChildrenFrontEnd(*valobj_sp), m_start(nullptr),
-      m_finish(nullptr), m_element_type(), m_element_size(0) {
+      m_finish(nullptr), m_element_type(), m_element_size(0), m_page_base(0),
+      m_page_end(0) {
   if (valobj_sp)
     Update();
 }
@@ -107,8 +140,15 @@ lldb_private::formatters::LibcxxStdVectorSyntheticFrontEnd::GetChildAtIndex(
   if (!m_start || !m_finish)
     return lldb::ValueObjectSP();
 
+  uint64_t start_val = m_start->GetValueAsUnsigned(0);
   uint64_t offset = idx * m_element_size;
-  offset = offset + m_start->GetValueAsUnsigned(0);
+  offset = offset + start_val;
+  if (ProcessSP process_sp = m_backend.GetProcessSP()) {
+    uint64_t finish_val = m_finish->GetValueAsUnsigned(0);
+    if (start_val != 0 && offset + m_element_size <= finish_val)
+      PrefetchVectorPage(*process_sp, start_val, finish_val - start_val,
+                         offset, m_page_base, m_page_end);
+  }
   StreamString name;
   name.Printf("[%" PRIu64 "]", (uint64_t)idx);
   return CreateValueObjectFromAddress(name.GetString(), offset,
@@ -118,6 +158,7 @@ lldb_private::formatters::LibcxxStdVectorSyntheticFrontEnd::GetChildAtIndex(
 
 bool lldb_private::formatters::LibcxxStdVectorSyntheticFrontEnd::Update() {
   m_start = m_finish = nullptr;
+  m_page_base = m_page_end = 0;
   ValueObjectSP data_type_finder_sp(
       m_backend.GetChildMemberWithName(ConstString("__end_cap_"), true));
   if (!data_type_finder_sp)
@@ -173,7 +214,8 @@ size_t lldb_private::formatters::LibcxxStdVectorSyntheticFrontEnd::
 lldb_private::formatters::LibcxxVectorBoolSyntheticFrontEnd::
     LibcxxVectorBoolSyntheticFrontEnd(lldb::ValueObjectSP valobj_sp)
     : SyntheticChildrenFrontEnd(*valobj_sp), m_bool_type(), m_exe_ctx_ref(),
-      m_count(0), m_base_data_address(0), m_children() {
+      m_count(0), m_base_data_address(0), m_page_base(0), m_page_end(0),
+      m_children() {
   if (valobj_sp) {
     Update();
     m_bool_type =
@@ -207,6 +249,8 @@ lldb_private::formatters::LibcxxVectorBoolSyntheticFrontEnd::GetChildAtIndex(
   uint8_t byte = 0;
   uint8_t mask = 0;
   Status err;
+  PrefetchVectorPage(*process_sp, m_base_data_address, (m_count + 7) >> 3,
+                     byte_location, m_page_base, m_page_end);
   size_t bytes_read = process_sp->ReadMemory(byte_location, &byte, 1, err);
   if (err.Fail() || bytes_read == 0)
     return {};
@@ -245,6 +289,7 @@ lldb_private::formatters::LibcxxVectorBoolSyntheticFrontEnd::GetChildAtIndex(
 
 bool lldb_private::formatters::LibcxxVectorBoolSyntheticFrontEnd::Update() {
   m_children.clear();
+  m_page_base = m_page_end = 0;
   ValueObjectSP valobj_sp = m_backend.GetSP();
   if (!valobj_sp)
     return false;
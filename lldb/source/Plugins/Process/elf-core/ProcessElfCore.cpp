@@ -283,6 +283,35 @@ size_t ProcessElfCore::ReadMemory(lldb::addr_t addr, void *buf, size_t size,
   return DoReadMemory(addr, buf, size, error);
 }
 
+llvm::ArrayRef<uint8_t> ProcessElfCore::PeekMemory(lldb::addr_t addr,
+                                                   size_t size) {
+  ObjectFile *core_objfile = m_core_module_sp->GetObjectFile();
+  if (core_objfile == nullptr)
+    return llvm::ArrayRef<uint8_t>();
+
+  const VMRangeToFileOffset::Entry *address_range =
+      m_core_aranges.FindEntryThatContains(addr);
+  if (address_range == nullptr)
+    return llvm::ArrayRef<uint8_t>();
+
+  // Only the part of the segment that is on disk can be viewed in place, the
+  // rest of it reads as zeros.
+  const lldb::addr_t file_offset = address_range->data.GetRangeBase() +
+                                   (addr - address_range->GetRangeBase());
+  const lldb::addr_t file_end = address_range->data.GetRangeEnd();
+  if (file_offset >= file_end)
+    return llvm::ArrayRef<uint8_t>();
+  const size_t bytes_to_view =
+      std::min<lldb::addr_t>(size, file_end - file_offset);
+
+  // The core file is mapped in its entirety, so the extractor shares its
+  // buffer and no data is copied.
+  DataExtractor data;
+  if (core_objfile->GetData(file_offset, bytes_to_view, data) != bytes_to_view)
+    return llvm::ArrayRef<uint8_t>();
+  return llvm::makeArrayRef(data.GetDataStart(), bytes_to_view);
+}
+
 Status ProcessElfCore::GetMemoryRegionInfo(lldb::addr_t load_addr,
                                            MemoryRegionInfo &region_info) {
   region_info.Clear();
@@ -88,6 +88,8 @@ public:
   size_t DoReadMemory(lldb::addr_t addr, void *buf, size_t size,
                       lldb_private::Status &error) override;
 
+  llvm::ArrayRef<uint8_t> PeekMemory(lldb::addr_t addr, size_t size) override;
+
   lldb_private::Status
   GetMemoryRegionInfo(lldb::addr_t load_addr,
                       lldb_private::MemoryRegionInfo &region_info) override;
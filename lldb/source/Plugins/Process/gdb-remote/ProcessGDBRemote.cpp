@@ -120,9 +120,18 @@ static constexpr PropertyDefinition g_properties[] = {
      , nullptr, {},
      "Specify the default packet timeout in seconds."},
     {"target-definition-file", OptionValue::eTypeFileSpec, true, 0, nullptr, {},
-     "The file that provides the description for remote target registers."}};
-
-enum { ePropertyPacketTimeout, ePropertyTargetDefinitionFile };
+     "The file that provides the description for remote target registers."},
+    {"stack-prefetch-size", OptionValue::eTypeUInt64, true, 0, nullptr, {},
+     "The number of bytes of stack, starting at the stack pointer of the "
+     "thread that stopped, to read with a single packet each time the "
+     "process stops, so that unwinding doesn't need a round trip for each "
+     "frame. 0 disables the prefetch."}};
+
+enum {
+  ePropertyPacketTimeout,
+  ePropertyTargetDefinitionFile,
+  ePropertyStackPrefetchSize
+};
 
 class PluginProperties : public Properties {
 public:
@@ -152,6 +161,12 @@ public:
     const uint32_t idx = ePropertyTargetDefinitionFile;
     return m_collection_sp->GetPropertyAtIndexAsFileSpec(nullptr, idx);
   }
+
+  uint64_t GetStackPrefetchSize() const {
+    const uint32_t idx = ePropertyStackPrefetchSize;
+    return m_collection_sp->GetPropertyAtIndexAsUInt64(
+        nullptr, idx, g_properties[idx].default_uint_value);
+  }
 };
 
 typedef std::shared_ptr<PluginProperties> ProcessKDPPropertiesSP;
@@ -2401,6 +2416,8 @@ StateType ProcessGDBRemote::SetThreadStopInfo(StringExtractor &stop_packet) {
         exc_type, exc_data, thread_dispatch_qaddr, queue_vars_valid,
         associated_with_dispatch_queue, dispatch_queue_t, queue_name,
         queue_kind, queue_serial_number);
+    if (thread_sp)
+      PrefetchStackMemory(*thread_sp);
 
     return eStateStopped;
   } break;
@@ -2416,6 +2433,40 @@ StateType ProcessGDBRemote::SetThreadStopInfo(StringExtractor &stop_packet) {
   return eStateInvalid;
 }
 
+void ProcessGDBRemote::PrefetchStackMemory(Thread &thread) {
+  const uint64_t prefetch_size =
+      GetGlobalPluginProperties()->GetStackPrefetchSize();
+  if (prefetch_size == 0)
+    return;
+
+  // The stack pointer is usually one of the expedited registers of the stop
+  // reply, so this doesn't need a packet of its own.
+  RegisterContextSP reg_ctx_sp = thread.GetRegisterContext();
+  if (!reg_ctx_sp)
+    return;
+  const addr_t sp = reg_ctx_sp->GetSP();
+  if (sp == LLDB_INVALID_ADDRESS)
+    return;
+
+  // DoReadMemory clamps the size to what fits in one packet. A server that
+  // can't read all of it returns the bytes it could read, and a failed read
+  // only means that the frames are read as they are unwound, as without the
+  // prefetch.
+  DataBufferSP data_buffer_sp(new DataBufferHeap(prefetch_size, 0));
+  Status error;
+  const size_t bytes_read =
+      DoReadMemory(sp, data_buffer_sp->GetBytes(), prefetch_size, error);
+  if (bytes_read == 0)
+    return;
+  m_memory_cache.AddL1CacheData(sp, data_buffer_sp->GetBytes(), bytes_read);
+
+  Log *log(ProcessGDBRemoteLog::GetLogIfAllCategoriesSet(GDBR_LOG_MEMORY));
+  if (log)
+    log->Printf("ProcessGDBRemote::%s prefetched %zu bytes of stack at "
+                "0x%" PRIx64 " for thread 0x%4.4" PRIx64,
+                __FUNCTION__, bytes_read, sp, thread.GetID());
+}
+
 void ProcessGDBRemote::RefreshStateAfterStop() {
   std::lock_guard<std::recursive_mutex> guard(m_thread_list_real.GetMutex());
 
@@ -4833,7 +4884,7 @@ size_t ProcessGDBRemote::LoadModules(LoadedModuleInfoList &module_list) {
   // temp: todo!
   if (m_modules_loaded)
     return 1;
-  m_modules_loaded = true;
+  m_modules_loaded = true;
 
   // request a list of loaded libraries from GDBServer
   if (GetLoadedModuleList(module_list).Fail())
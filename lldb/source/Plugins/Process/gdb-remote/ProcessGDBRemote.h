@@ -353,6 +353,8 @@ protected:
 
   lldb::StateType SetThreadStopInfo(StringExtractor &stop_packet);
 
+  void PrefetchStackMemory(Thread &thread);
+
   bool
   GetThreadStopInfoFromJSON(ThreadGDBRemote *thread,
                             const StructuredData::ObjectSP &thread_infos_sp);
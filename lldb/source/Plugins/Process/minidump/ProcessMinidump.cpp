@@ -298,6 +298,11 @@ size_t ProcessMinidump::DoReadMemory(lldb::addr_t addr, void *buf, size_t size,
   return mem.size();
 }
 
+llvm::ArrayRef<uint8_t> ProcessMinidump::PeekMemory(lldb::addr_t addr,
+                                                    size_t size) {
+  return m_minidump_parser->GetMemory(addr, size);
+}
+
 ArchSpec ProcessMinidump::GetArchitecture() {
   if (!m_is_wow64) {
     return m_minidump_parser->GetArchitecture();
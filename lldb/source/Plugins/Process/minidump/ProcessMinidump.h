@@ -74,6 +74,8 @@ public:
   size_t DoReadMemory(lldb::addr_t addr, void *buf, size_t size,
                       Status &error) override;
 
+  llvm::ArrayRef<uint8_t> PeekMemory(lldb::addr_t addr, size_t size) override;
+
   ArchSpec GetArchitecture();
 
   Status GetMemoryRegionInfo(lldb::addr_t load_addr,
@@ -13,10 +13,17 @@
 #include "Plugins/SymbolFile/DWARF/LogChannelDWARF.h"
 #include "Plugins/SymbolFile/DWARF/SymbolFileDWARFDwo.h"
 #include "lldb/Core/Module.h"
+#include "lldb/Core/ModuleList.h"
 #include "lldb/Host/TaskPool.h"
 #include "lldb/Symbol/ObjectFile.h"
+#include "lldb/Utility/DataExtractor.h"
+#include "lldb/Utility/Log.h"
 #include "lldb/Utility/Stream.h"
 #include "lldb/Utility/Timer.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 
 using namespace lldb_private;
 using namespace lldb;
@@ -41,6 +48,16 @@ void ManualDWARFIndex::Index() {
   if (units_to_index.empty())
     return;
 
+  // Indexing reads every DIE of every unit, so reuse the index built the last
+  // time this module was loaded, if there is one.
+  std::string cache_path = GetCacheFilePath();
+  std::string cache_header;
+  if (!cache_path.empty()) {
+    cache_header = GetCacheHeader(units_to_index.size());
+    if (LoadFromCache(cache_path, cache_header))
+      return;
+  }
+
   std::vector<IndexSet> sets(units_to_index.size());
 
   // Keep memory down by clearing DIEs for any units if indexing
@@ -85,6 +102,146 @@ void ManualDWARFIndex::Index() {
                      [&]() { finalize_fn(&IndexSet::globals); },
                      [&]() { finalize_fn(&IndexSet::types); },
                      [&]() { finalize_fn(&IndexSet::namespaces); });
+
+  if (!cache_path.empty())
+    SaveToCache(cache_path, cache_header);
+}
+
+llvm::ArrayRef<NameToDIE ManualDWARFIndex::IndexSet::*>
+ManualDWARFIndex::GetCachedSets() {
+  static NameToDIE IndexSet::*const sets[] = {
+      &IndexSet::function_basenames,   &IndexSet::function_fullnames,
+      &IndexSet::function_methods,     &IndexSet::function_selectors,
+      &IndexSet::objc_class_selectors, &IndexSet::globals,
+      &IndexSet::types,                &IndexSet::namespaces};
+  return sets;
+}
+
+// Bump this whenever the contents of the index or its encoding change.
+static const uint32_t g_cache_version = 1;
+
+std::string ManualDWARFIndex::GetCacheFilePath() {
+  FileSpec cache_dir =
+      ModuleList::GetGlobalModuleListProperties().GetDWARFIndexCachePath();
+  if (!cache_dir)
+    return std::string();
+
+  // Without a UUID there is nothing to tell different builds apart with.
+  const UUID &uuid = m_module.GetUUID();
+  if (!uuid.IsValid())
+    return std::string();
+
+  llvm::SmallString<128> path(cache_dir.GetPath());
+  llvm::sys::path::append(path, uuid.GetAsString("") + ".dwarf-index");
+  return path.str();
+}
+
+std::string ManualDWARFIndex::GetCacheHeader(uint32_t num_units) {
+  using llvm::support::little;
+  using llvm::support::endian::write;
+  std::string header;
+  llvm::raw_string_ostream os(header);
+  os << "LLDBDWARFINDEX";
+  write<uint32_t>(os, g_cache_version, little);
+
+  llvm::ArrayRef<uint8_t> uuid = m_module.GetUUID().GetBytes();
+  write<uint32_t>(os, uuid.size(), little);
+  os << llvm::toStringRef(uuid);
+
+  // A rebuilt module normally has a new UUID, but not every linker computes
+  // it from the contents, so check the modification time as well.
+  const llvm::sys::TimePoint<> &mod_time = m_module.GetModificationTime();
+  write<uint64_t>(
+      os,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          mod_time.time_since_epoch())
+          .count(),
+      little);
+
+  write<uint32_t>(os, num_units, little);
+  std::vector<dw_offset_t> avoided(m_units_to_avoid.begin(),
+                                   m_units_to_avoid.end());
+  llvm::sort(avoided);
+  write<uint32_t>(os, avoided.size(), little);
+  for (dw_offset_t offset : avoided)
+    write<uint32_t>(os, offset, little);
+  return os.str();
+}
+
+bool ManualDWARFIndex::LoadFromCache(llvm::StringRef path,
+                                     llvm::StringRef header) {
+  static Timer::Category func_cat(LLVM_PRETTY_FUNCTION);
+  Timer scoped_timer(func_cat, "%s", path.str().c_str());
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer_or =
+      llvm::MemoryBuffer::getFile(path, -1, false);
+  if (!buffer_or)
+    return false;
+  llvm::StringRef contents = (*buffer_or)->getBuffer();
+  if (!contents.startswith(header))
+    return false;
+
+  DataExtractor data(contents.data(), contents.size(), eByteOrderLittle, 4);
+  lldb::offset_t offset = header.size();
+  bool valid = true;
+  for (NameToDIE IndexSet::*index : GetCachedSets()) {
+    if (!(m_set.*index).Decode(data, &offset)) {
+      valid = false;
+      break;
+    }
+  }
+  if (valid && offset == contents.size())
+    return true;
+
+  // Throw away whatever was read, and index the module from scratch.
+  m_set = IndexSet();
+  return false;
+}
+
+void ManualDWARFIndex::SaveToCache(llvm::StringRef path,
+                                   llvm::StringRef header) {
+  Log *log = LogChannelDWARF::GetLogIfAll(DWARF_LOG_LOOKUPS);
+
+  std::error_code ec =
+      llvm::sys::fs::create_directories(llvm::sys::path::parent_path(path));
+  if (ec) {
+    LLDB_LOG(log, "Unable to create the DWARF index cache directory: {0}",
+             ec.message());
+    return;
+  }
+
+  // Write to a temporary file and rename it, so that a debugger loading the
+  // same module never reads a partially written index.
+  int fd;
+  llvm::SmallString<128> temp_path;
+  ec = llvm::sys::fs::createUniqueFile(path + "-%%%%%%", fd, temp_path);
+  if (ec) {
+    LLDB_LOG(log, "Unable to create a DWARF index cache file: {0}",
+             ec.message());
+    return;
+  }
+
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    os << header;
+    for (NameToDIE IndexSet::*index : GetCachedSets())
+      (m_set.*index).Encode(os);
+    os.close();
+    if (os.has_error()) {
+      os.clear_error();
+      llvm::sys::fs::remove(temp_path);
+      LLDB_LOG(log, "Unable to write the DWARF index cache file {0}",
+               temp_path.str());
+      return;
+    }
+  }
+
+  ec = llvm::sys::fs::rename(temp_path, path);
+  if (ec) {
+    llvm::sys::fs::remove(temp_path);
+    LLDB_LOG(log, "Unable to rename the DWARF index cache file: {0}",
+             ec.message());
+  }
 }
 
 void ManualDWARFIndex::IndexUnit(DWARFUnit &unit, IndexSet &set) {
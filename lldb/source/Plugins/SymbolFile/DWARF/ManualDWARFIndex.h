@@ -57,6 +57,17 @@ private:
   void Index();
   void IndexUnit(DWARFUnit &unit, IndexSet &set);
 
+  /// The path of the file caching the index of this module, or an empty
+  /// string if it isn't cached.
+  std::string GetCacheFilePath();
+  /// The data the cache file starts with, which identifies the module and
+  /// the units that were indexed.
+  std::string GetCacheHeader(uint32_t num_units);
+  bool LoadFromCache(llvm::StringRef path, llvm::StringRef header);
+  /// The index sets in the order they are stored in the cache files.
+  static llvm::ArrayRef<NameToDIE IndexSet::*> GetCachedSets();
+  void SaveToCache(llvm::StringRef path, llvm::StringRef header);
+
   static void
   IndexUnitImpl(DWARFUnit &unit, const lldb::LanguageType cu_language,
                 const dw_offset_t cu_offset, IndexSet &set);
@@ -9,6 +9,7 @@
 #include "NameToDIE.h"
 #include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Utility/ConstString.h"
+#include "lldb/Utility/DataExtractor.h"
 #include "lldb/Utility/RegularExpression.h"
 #include "lldb/Utility/Stream.h"
 #include "lldb/Utility/StreamString.h"
@@ -17,6 +18,8 @@
 #include "DWARFDebugInfoEntry.h"
 #include "SymbolFileDWARF.h"
 
+#include "llvm/Support/EndianStream.h"
+
 using namespace lldb;
 using namespace lldb_private;
 
@@ -78,3 +81,42 @@ void NameToDIE::Append(const NameToDIE &other) {
                  other.m_map.GetValueAtIndexUnchecked(i));
   }
 }
+
+void NameToDIE::Encode(llvm::raw_ostream &os) const {
+  using llvm::support::little;
+  using llvm::support::endian::write;
+  const uint32_t size = m_map.GetSize();
+  write<uint32_t>(os, size, little);
+  for (uint32_t i = 0; i < size; ++i) {
+    llvm::StringRef name = m_map.GetCStringAtIndexUnchecked(i).GetStringRef();
+    const DIERef &die_ref = m_map.GetValueAtIndexUnchecked(i);
+    os << name << '\0';
+    write<uint8_t>(os, die_ref.section, little);
+    write<uint32_t>(os, die_ref.cu_offset, little);
+    write<uint32_t>(os, die_ref.die_offset, little);
+  }
+}
+
+bool NameToDIE::Decode(const DataExtractor &data, lldb::offset_t *offset_ptr) {
+  // Every entry takes at least a nul terminator and nine bytes.
+  const uint32_t size = data.GetU32(offset_ptr);
+  if (!data.ValidOffsetForDataOfSize(*offset_ptr, uint64_t(size) * 10))
+    return false;
+  for (uint32_t i = 0; i < size; ++i) {
+    const char *name = data.GetCStr(offset_ptr);
+    if (!name || !data.ValidOffsetForDataOfSize(*offset_ptr, 9))
+      return false;
+    uint8_t section = data.GetU8(offset_ptr);
+    if (section > DIERef::DebugTypes)
+      return false;
+    dw_offset_t cu_offset = data.GetU32(offset_ptr);
+    dw_offset_t die_offset = data.GetU32(offset_ptr);
+    m_map.Append(ConstString(name),
+                 DIERef(static_cast<DIERef::Section>(section), cu_offset,
+                        die_offset));
+  }
+  // The entries were sorted by the addresses of the names in the process
+  // that wrote them, so they have to be sorted again.
+  Finalize();
+  return true;
+}
@@ -16,6 +16,13 @@
 #include "lldb/Core/dwarf.h"
 #include "lldb/lldb-defines.h"
 
+namespace lldb_private {
+class DataExtractor;
+}
+namespace llvm {
+class raw_ostream;
+}
+
 class SymbolFileDWARF;
 
 class NameToDIE {
@@ -46,6 +53,14 @@ public:
                              const DIERef &die_ref)> const
               &callback) const;
 
+  /// Write the entries to \a os, to be read back by Decode.
+  void Encode(llvm::raw_ostream &os) const;
+
+  /// Append the entries written by Encode at \a *offset_ptr in \a data and
+  /// finalize the map. Returns false if the data is truncated or malformed.
+  bool Decode(const lldb_private::DataExtractor &data,
+              lldb::offset_t *offset_ptr);
+
 protected:
   lldb_private::UniqueCStringMap<DIERef> m_map;
 };
@@ -44,6 +44,7 @@ void LineTable::InsertLineEntry(lldb::addr_t file_addr, uint32_t line,
   //  s << "\n\nBefore:\n";
   //  Dump (&s, Address::DumpStyleFileAddress);
   m_entries.insert(pos, entry);
+  InvalidateFileIndexMap();
   //  s << "After:\n";
   //  Dump (&s, Address::DumpStyleFileAddress);
 }
@@ -98,6 +99,7 @@ void LineTable::InsertSequence(LineSequence *sequence) {
   if (seq->m_entries.empty())
     return;
   Entry &entry = seq->m_entries.front();
+  InvalidateFileIndexMap();
 
   // If the first entry address in this sequence is greater than or equal to
   // the address of the last item in our entry collection, just append.
@@ -270,67 +272,71 @@ bool LineTable::ConvertEntryAtIndexToLineEntry(uint32_t idx,
   return false;
 }
 
+void LineTable::InvalidateFileIndexMap() {
+  std::lock_guard<std::mutex> guard(m_file_idx_to_entries_mutex);
+  m_file_idx_to_entries.clear();
+  m_file_idx_to_entries_valid = false;
+}
+
+const std::vector<uint32_t> *
+LineTable::GetEntryIndexesForFileIndex(uint32_t file_idx) {
+  std::lock_guard<std::mutex> guard(m_file_idx_to_entries_mutex);
+  if (!m_file_idx_to_entries_valid) {
+    const size_t count = m_entries.size();
+    for (size_t idx = 0; idx < count; ++idx) {
+      // Skip line table rows that terminate the previous row
+      // (is_terminal_entry is non-zero)
+      if (m_entries[idx].is_terminal_entry)
+        continue;
+      m_file_idx_to_entries[m_entries[idx].file_idx].push_back(idx);
+    }
+    m_file_idx_to_entries_valid = true;
+  }
+  auto pos = m_file_idx_to_entries.find(file_idx);
+  if (pos == m_file_idx_to_entries.end())
+    return nullptr;
+  return &pos->second;
+}
+
 uint32_t LineTable::FindLineEntryIndexByFileIndex(
     uint32_t start_idx, const std::vector<uint32_t> &file_indexes,
     uint32_t line, bool exact, LineEntry *line_entry_ptr) {
-
-  const size_t count = m_entries.size();
-  std::vector<uint32_t>::const_iterator begin_pos = file_indexes.begin();
-  std::vector<uint32_t>::const_iterator end_pos = file_indexes.end();
-  size_t best_match = UINT32_MAX;
-
-  for (size_t idx = start_idx; idx < count; ++idx) {
-    // Skip line table rows that terminate the previous row (is_terminal_entry
-    // is non-zero)
-    if (m_entries[idx].is_terminal_entry)
-      continue;
-
-    if (find(begin_pos, end_pos, m_entries[idx].file_idx) == end_pos)
-      continue;
-
-    // Exact match always wins.  Otherwise try to find the closest line > the
-    // desired line.
-    // FIXME: Maybe want to find the line closest before and the line closest
-    // after and
-    // if they're not in the same function, don't return a match.
-
-    if (m_entries[idx].line < line) {
+  // An exact match has the smallest line any match can have, so the entry
+  // with the smallest line, and then the smallest index, among the matches
+  // in each of the files is the one a search in all of them would find.
+  uint32_t best_match = UINT32_MAX;
+  for (uint32_t file_idx : file_indexes) {
+    uint32_t idx = FindLineEntryIndexByFileIndex(start_idx, file_idx, line,
+                                                 exact, nullptr);
+    if (idx == UINT32_MAX)
       continue;
-    } else if (m_entries[idx].line == line) {
-      if (line_entry_ptr)
-        ConvertEntryAtIndexToLineEntry(idx, *line_entry_ptr);
-      return idx;
-    } else if (!exact) {
-      if (best_match == UINT32_MAX)
-        best_match = idx;
-      else if (m_entries[idx].line < m_entries[best_match].line)
-        best_match = idx;
-    }
+    if (best_match == UINT32_MAX ||
+        m_entries[idx].line < m_entries[best_match].line ||
+        (m_entries[idx].line == m_entries[best_match].line &&
+         idx < best_match))
+      best_match = idx;
   }
 
-  if (best_match != UINT32_MAX) {
-    if (line_entry_ptr)
-      ConvertEntryAtIndexToLineEntry(best_match, *line_entry_ptr);
-    return best_match;
-  }
-  return UINT32_MAX;
+  if (best_match != UINT32_MAX && line_entry_ptr)
+    ConvertEntryAtIndexToLineEntry(best_match, *line_entry_ptr);
+  return best_match;
 }
 
 uint32_t LineTable::FindLineEntryIndexByFileIndex(uint32_t start_idx,
                                                   uint32_t file_idx,
                                                   uint32_t line, bool exact,
                                                   LineEntry *line_entry_ptr) {
-  const size_t count = m_entries.size();
-  size_t best_match = UINT32_MAX;
+  const std::vector<uint32_t> *file_entries =
+      GetEntryIndexesForFileIndex(file_idx);
+  if (!file_entries)
+    return UINT32_MAX;
 
-  for (size_t idx = start_idx; idx < count; ++idx) {
-    // Skip line table rows that terminate the previous row (is_terminal_entry
-    // is non-zero)
-    if (m_entries[idx].is_terminal_entry)
-      continue;
+  size_t best_match = UINT32_MAX;
 
-    if (m_entries[idx].file_idx != file_idx)
-      continue;
+  for (auto pos = llvm::lower_bound(*file_entries, start_idx),
+            end = file_entries->end();
+       pos != end; ++pos) {
+    const uint32_t idx = *pos;
 
     // Exact match always wins.  Otherwise try to find the closest line > the
     // desired line.
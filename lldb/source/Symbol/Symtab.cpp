@@ -15,6 +15,7 @@
 #include "lldb/Core/RichManglingContext.h"
 #include "lldb/Core/STLUtils.h"
 #include "lldb/Core/Section.h"
+#include "lldb/Host/TaskPool.h"
 #include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Symbol/Symbol.h"
 #include "lldb/Symbol/SymbolContext.h"
@@ -259,102 +260,35 @@ void Symtab::InitNameIndexes() {
     Timer scoped_timer(func_cat, "%s", LLVM_PRETTY_FUNCTION);
     // Create the name index vector to be able to quickly search by name
     const size_t num_symbols = m_symbols.size();
-#if 1
     m_name_to_index.Reserve(num_symbols);
-#else
-    // TODO: benchmark this to see if we save any memory. Otherwise we
-    // will always keep the memory reserved in the vector unless we pull some
-    // STL swap magic and then recopy...
-    uint32_t actual_count = 0;
-    for (const_iterator pos = m_symbols.begin(), end = m_symbols.end();
-         pos != end; ++pos) {
-      const Mangled &mangled = pos->GetMangled();
-      if (mangled.GetMangledName())
-        ++actual_count;
-
-      if (mangled.GetDemangledName())
-        ++actual_count;
-    }
 
-    m_name_to_index.Reserve(actual_count);
-#endif
+    // Demangling dominates the time it takes to build the indexes, so the
+    // symbols are indexed in parallel, in shards that are large enough to
+    // make up for the cost of creating a demangler for each.
+    const size_t shard_size = 4096;
+    std::vector<NameIndexShard> shards((num_symbols + shard_size - 1) /
+                                       shard_size);
+    TaskMapOverInt(0, shards.size(), [&](size_t i) {
+      IndexSymbolNames(i * shard_size,
+                       std::min(num_symbols, (i + 1) * shard_size), shards[i]);
+    });
 
-    // The "const char *" in "class_contexts" and backlog::value_type::second
-    // must come from a ConstString::GetCString()
     std::set<const char *> class_contexts;
-    std::vector<std::pair<NameToIndexMap::Entry, const char *>> backlog;
-    backlog.reserve(num_symbols / 2);
-
-    // Instantiation of the demangler is expensive, so better use a single one
-    // for all entries during batch processing.
-    RichManglingContext rmc;
-    NameToIndexMap::Entry entry;
-
-    for (entry.value = 0; entry.value < num_symbols; ++entry.value) {
-      Symbol *symbol = &m_symbols[entry.value];
-
-      // Don't let trampolines get into the lookup by name map If we ever need
-      // the trampoline symbols to be searchable by name we can remove this and
-      // then possibly add a new bool to any of the Symtab functions that
-      // lookup symbols by name to indicate if they want trampolines.
-      if (symbol->IsTrampoline())
-        continue;
-
-      // If the symbol's name string matched a Mangled::ManglingScheme, it is
-      // stored in the mangled field.
-      Mangled &mangled = symbol->GetMangled();
-      entry.cstring = mangled.GetMangledName();
-      if (entry.cstring) {
-        m_name_to_index.Append(entry);
-
-        if (symbol->ContainsLinkerAnnotations()) {
-          // If the symbol has linker annotations, also add the version without
-          // the annotations.
-          entry.cstring = ConstString(m_objfile->StripLinkerSymbolAnnotations(
-                                        entry.cstring.GetStringRef()));
-          m_name_to_index.Append(entry);
-        }
-
-        const SymbolType type = symbol->GetType();
-        if (type == eSymbolTypeCode || type == eSymbolTypeResolver) {
-          if (mangled.DemangleWithRichManglingInfo(rmc, lldb_skip_name))
-            RegisterMangledNameEntry(entry, class_contexts, backlog, rmc);
-        }
-      }
-
-      // Symbol name strings that didn't match a Mangled::ManglingScheme, are
-      // stored in the demangled field.
-      entry.cstring = mangled.GetDemangledName(symbol->GetLanguage());
-      if (entry.cstring) {
-        m_name_to_index.Append(entry);
-
-        if (symbol->ContainsLinkerAnnotations()) {
-          // If the symbol has linker annotations, also add the version without
-          // the annotations.
-          entry.cstring = ConstString(m_objfile->StripLinkerSymbolAnnotations(
-                                        entry.cstring.GetStringRef()));
-          m_name_to_index.Append(entry);
-        }
-      }
-
-      // If the demangled name turns out to be an ObjC name, and is a category
-      // name, add the version without categories to the index too.
-      ObjCLanguage::MethodName objc_method(entry.cstring.GetStringRef(), true);
-      if (objc_method.IsValid(true)) {
-        entry.cstring = objc_method.GetSelector();
-        m_selector_to_index.Append(entry);
-
-        ConstString objc_method_no_category(
-            objc_method.GetFullNameWithoutCategory(true));
-        if (objc_method_no_category) {
-          entry.cstring = objc_method_no_category;
-          m_name_to_index.Append(entry);
-        }
-      }
+    for (NameIndexShard &shard : shards) {
+      class_contexts.insert(shard.class_contexts.begin(),
+                            shard.class_contexts.end());
+      m_name_to_index.Append(shard.name_to_index);
+      m_basename_to_index.Append(shard.basename_to_index);
+      m_method_to_index.Append(shard.method_to_index);
+      m_selector_to_index.Append(shard.selector_to_index);
     }
 
-    for (const auto &record : backlog) {
-      RegisterBacklogEntry(record.first, record.second, class_contexts);
+    // A method whose declaration context is only known from a later symbol,
+    // possibly in another shard, was put in the backlog.
+    for (const NameIndexShard &shard : shards) {
+      for (const auto &record : shard.backlog) {
+        RegisterBacklogEntry(record.first, record.second, class_contexts);
+      }
     }
 
     m_name_to_index.Sort();
@@ -368,9 +302,81 @@ void Symtab::InitNameIndexes() {
   }
 }
 
+void Symtab::IndexSymbolNames(uint32_t begin, uint32_t end,
+                              NameIndexShard &shard) {
+  shard.backlog.reserve((end - begin) / 2);
+
+  // Instantiation of the demangler is expensive, so better use a single one
+  // for all entries during batch processing.
+  RichManglingContext rmc;
+  NameToIndexMap::Entry entry;
+
+  for (entry.value = begin; entry.value < end; ++entry.value) {
+    Symbol *symbol = &m_symbols[entry.value];
+
+    // Don't let trampolines get into the lookup by name map If we ever need
+    // the trampoline symbols to be searchable by name we can remove this and
+    // then possibly add a new bool to any of the Symtab functions that
+    // lookup symbols by name to indicate if they want trampolines.
+    if (symbol->IsTrampoline())
+      continue;
+
+    // If the symbol's name string matched a Mangled::ManglingScheme, it is
+    // stored in the mangled field.
+    Mangled &mangled = symbol->GetMangled();
+    entry.cstring = mangled.GetMangledName();
+    if (entry.cstring) {
+      shard.name_to_index.Append(entry);
+
+      if (symbol->ContainsLinkerAnnotations()) {
+        // If the symbol has linker annotations, also add the version without
+        // the annotations.
+        entry.cstring = ConstString(m_objfile->StripLinkerSymbolAnnotations(
+                                      entry.cstring.GetStringRef()));
+        shard.name_to_index.Append(entry);
+      }
+
+      const SymbolType type = symbol->GetType();
+      if (type == eSymbolTypeCode || type == eSymbolTypeResolver) {
+        if (mangled.DemangleWithRichManglingInfo(rmc, lldb_skip_name))
+          RegisterMangledNameEntry(entry, shard, rmc);
+      }
+    }
+
+    // Symbol name strings that didn't match a Mangled::ManglingScheme, are
+    // stored in the demangled field.
+    entry.cstring = mangled.GetDemangledName(symbol->GetLanguage());
+    if (entry.cstring) {
+      shard.name_to_index.Append(entry);
+
+      if (symbol->ContainsLinkerAnnotations()) {
+        // If the symbol has linker annotations, also add the version without
+        // the annotations.
+        entry.cstring = ConstString(m_objfile->StripLinkerSymbolAnnotations(
+                                      entry.cstring.GetStringRef()));
+        shard.name_to_index.Append(entry);
+      }
+    }
+
+    // If the demangled name turns out to be an ObjC name, and is a category
+    // name, add the version without categories to the index too.
+    ObjCLanguage::MethodName objc_method(entry.cstring.GetStringRef(), true);
+    if (objc_method.IsValid(true)) {
+      entry.cstring = objc_method.GetSelector();
+      shard.selector_to_index.Append(entry);
+
+      ConstString objc_method_no_category(
+          objc_method.GetFullNameWithoutCategory(true));
+      if (objc_method_no_category) {
+        entry.cstring = objc_method_no_category;
+        shard.name_to_index.Append(entry);
+      }
+    }
+  }
+}
+
 void Symtab::RegisterMangledNameEntry(
-    NameToIndexMap::Entry &entry, std::set<const char *> &class_contexts,
-    std::vector<std::pair<NameToIndexMap::Entry, const char *>> &backlog,
+    NameToIndexMap::Entry &entry, NameIndexShard &shard,
     RichManglingContext &rmc) {
   // Only register functions that have a base name.
   rmc.ParseFunctionBaseName();
@@ -387,36 +393,36 @@ void Symtab::RegisterMangledNameEntry(
   // Register functions with no context.
   if (decl_context.empty()) {
     // This has to be a basename
-    m_basename_to_index.Append(entry);
+    shard.basename_to_index.Append(entry);
     // If there is no context (no namespaces or class scopes that come before
     // the function name) then this also could be a fullname.
-    m_name_to_index.Append(entry);
+    shard.name_to_index.Append(entry);
     return;
   }
 
   // Make sure we have a pool-string pointer and see if we already know the
   // context name.
   const char *decl_context_ccstr = ConstString(decl_context).GetCString();
-  auto it = class_contexts.find(decl_context_ccstr);
+  auto it = shard.class_contexts.find(decl_context_ccstr);
 
   // Register constructors and destructors. They are methods and create
   // declaration contexts.
   if (rmc.IsCtorOrDtor()) {
-    m_method_to_index.Append(entry);
-    if (it == class_contexts.end())
-      class_contexts.insert(it, decl_context_ccstr);
+    shard.method_to_index.Append(entry);
+    if (it == shard.class_contexts.end())
+      shard.class_contexts.insert(it, decl_context_ccstr);
     return;
   }
 
   // Register regular methods with a known declaration context.
-  if (it != class_contexts.end()) {
-    m_method_to_index.Append(entry);
+  if (it != shard.class_contexts.end()) {
+    shard.method_to_index.Append(entry);
     return;
   }
 
   // Regular methods in unknown declaration contexts are put to the backlog. We
   // will revisit them once we processed all remaining symbols.
-  backlog.push_back(std::make_pair(entry, decl_context_ccstr));
+  shard.backlog.push_back(std::make_pair(entry, decl_context_ccstr));
 }
 
 void Symtab::RegisterBacklogEntry(
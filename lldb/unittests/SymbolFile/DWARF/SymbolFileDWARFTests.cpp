@@ -18,6 +18,7 @@
 #include "Plugins/SymbolFile/DWARF/DWARFAbbreviationDeclaration.h"
 #include "Plugins/SymbolFile/DWARF/DWARFDataExtractor.h"
 #include "Plugins/SymbolFile/DWARF/DWARFDebugAbbrev.h"
+#include "Plugins/SymbolFile/DWARF/NameToDIE.h"
 #include "Plugins/SymbolFile/DWARF/SymbolFileDWARF.h"
 #include "Plugins/SymbolFile/PDB/SymbolFilePDB.h"
 #include "TestingSupport/TestUtilities.h"
@@ -32,6 +33,7 @@
 #include "lldb/Symbol/SymbolVendor.h"
 #include "lldb/Utility/ArchSpec.h"
 #include "lldb/Utility/DataEncoder.h"
+#include "lldb/Utility/DataExtractor.h"
 #include "lldb/Utility/FileSpec.h"
 #include "lldb/Utility/StreamString.h"
 
@@ -329,3 +331,38 @@ TEST_F(SymbolFileDWARFTests, TestAbbrevMissingTerminator) {
   EXPECT_EQ("abbreviation declaration attribute list not terminated with a "
             "null entry", llvm::toString(std::move(error)));
 }
+
+TEST_F(SymbolFileDWARFTests, TestNameToDIEEncodeDecode) {
+  // Test that a NameToDIE map survives being written and read back, and that
+  // truncated data is rejected.
+  NameToDIE map;
+  map.Insert(ConstString("foo"), DIERef(DIERef::DebugInfo, 0x10, 0x20));
+  map.Insert(ConstString("bar"), DIERef(DIERef::DebugTypes, 0x30, 0x40));
+  map.Insert(ConstString("foo"), DIERef(DIERef::DebugInfo, 0x10, 0x50));
+  map.Finalize();
+
+  std::string encoded;
+  llvm::raw_string_ostream os(encoded);
+  map.Encode(os);
+  os.flush();
+
+  DataExtractor data(encoded.data(), encoded.size(), eByteOrderLittle, 4);
+  lldb::offset_t offset = 0;
+  NameToDIE decoded;
+  ASSERT_TRUE(decoded.Decode(data, &offset));
+  EXPECT_EQ(encoded.size(), offset);
+
+  DIEArray foo;
+  EXPECT_EQ(2u, decoded.Find(ConstString("foo"), foo));
+  DIEArray bar;
+  ASSERT_EQ(1u, decoded.Find(ConstString("bar"), bar));
+  EXPECT_EQ(DIERef::DebugTypes, bar[0].section);
+  EXPECT_EQ(0x30u, bar[0].cu_offset);
+  EXPECT_EQ(0x40u, bar[0].die_offset);
+
+  DataExtractor truncated(encoded.data(), encoded.size() - 1, eByteOrderLittle,
+                          4);
+  offset = 0;
+  NameToDIE rejected;
+  EXPECT_FALSE(rejected.Decode(truncated, &offset));
+}
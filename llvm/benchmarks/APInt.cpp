@@ -0,0 +1,94 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include <vector>
+
+// Returns NumValues pseudorandom nonzero values of the given bit width.
+static std::vector<llvm::APInt> makeValues(unsigned BitWidth,
+                                           size_t NumValues) {
+  std::vector<llvm::APInt> Values;
+  uint64_t X = 1;
+  for (size_t I = 0; I < NumValues; ++I) {
+    llvm::SmallVector<uint64_t, 4> Words;
+    for (unsigned W = 0; W < (BitWidth + 63) / 64; ++W) {
+      X = X * 6364136223846793005ULL + 1442695040888963407ULL;
+      Words.push_back(X | 1);
+    }
+    Values.emplace_back(BitWidth, Words);
+  }
+  return Values;
+}
+
+// Widths up to 64 bits are stored inline; wider ones take the multi-word
+// slow paths that i128 and vector constants hit.
+#define APINT_BENCHMARK(Name)                                                  \
+  BENCHMARK(Name)->Arg(32)->Arg(64)->Arg(128)->Arg(256)
+
+static void BM_APIntAdd(benchmark::State &state) {
+  std::vector<llvm::APInt> V = makeValues(state.range(0), 256);
+  size_t I = 0;
+  for (auto _ : state) {
+    llvm::APInt R = V[I] + V[(I + 1) % V.size()];
+    benchmark::DoNotOptimize(R);
+    I = (I + 1) % V.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+APINT_BENCHMARK(BM_APIntAdd);
+
+static void BM_APIntMul(benchmark::State &state) {
+  std::vector<llvm::APInt> V = makeValues(state.range(0), 256);
+  size_t I = 0;
+  for (auto _ : state) {
+    llvm::APInt R = V[I] * V[(I + 1) % V.size()];
+    benchmark::DoNotOptimize(R);
+    I = (I + 1) % V.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+APINT_BENCHMARK(BM_APIntMul);
+
+static void BM_APIntUDiv(benchmark::State &state) {
+  std::vector<llvm::APInt> V = makeValues(state.range(0), 256);
+  size_t I = 0;
+  for (auto _ : state) {
+    llvm::APInt Divisor = V[(I + 1) % V.size()].lshr(state.range(0) / 2);
+    llvm::APInt R = V[I].udiv(Divisor | 1);
+    benchmark::DoNotOptimize(R);
+    I = (I + 1) % V.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+APINT_BENCHMARK(BM_APIntUDiv);
+
+// Constant folding compares and shifts far more often than it divides.
+static void BM_APIntCompareAndShift(benchmark::State &state) {
+  std::vector<llvm::APInt> V = makeValues(state.range(0), 256);
+  size_t I = 0;
+  for (auto _ : state) {
+    const llvm::APInt &A = V[I], &B = V[(I + 1) % V.size()];
+    bool Less = A.ult(B);
+    llvm::APInt R = Less ? A.shl(3) : B.lshr(5);
+    benchmark::DoNotOptimize(R);
+    I = (I + 1) % V.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+APINT_BENCHMARK(BM_APIntCompareAndShift);
+
+static void BM_APIntToString(benchmark::State &state) {
+  std::vector<llvm::APInt> V = makeValues(state.range(0), 256);
+  size_t I = 0;
+  for (auto _ : state) {
+    llvm::SmallString<80> S;
+    V[I].toStringUnsigned(S, 10);
+    benchmark::DoNotOptimize(S.data());
+    I = (I + 1) % V.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+APINT_BENCHMARK(BM_APIntToString);
+
+BENCHMARK_MAIN();
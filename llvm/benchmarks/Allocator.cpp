@@ -0,0 +1,81 @@
+#include "benchmark/benchmark.h"
+#include "llvm/Support/Allocator.h"
+#include <cstdlib>
+#include <vector>
+
+// Returns NumSizes allocation sizes with the skew of AST and IR node
+// allocation: mostly small, some medium, rarely large.
+static std::vector<size_t> makeSizes(size_t NumSizes) {
+  std::vector<size_t> Sizes;
+  uint64_t X = 1;
+  for (size_t I = 0; I < NumSizes; ++I) {
+    X = X * 6364136223846793005ULL + 1442695040888963407ULL;
+    unsigned R = X >> 56;
+    if (R < 200)
+      Sizes.push_back(16 + (X >> 40) % 48);
+    else if (R < 250)
+      Sizes.push_back(64 + (X >> 40) % 448);
+    else
+      Sizes.push_back(4096 + (X >> 40) % 8192);
+  }
+  return Sizes;
+}
+
+static void BM_BumpPtrAllocate(benchmark::State &state) {
+  std::vector<size_t> Sizes = makeSizes(state.range(0));
+  for (auto _ : state) {
+    llvm::BumpPtrAllocator Alloc;
+    for (size_t S : Sizes)
+      benchmark::DoNotOptimize(Alloc.Allocate(S, 8));
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * Sizes.size());
+}
+BENCHMARK(BM_BumpPtrAllocate)->RangeMultiplier(8)->Range(64, 1 << 18);
+
+// Reusing one allocator after Reset() keeps the first slab, as per-function
+// allocators in codegen do.
+static void BM_BumpPtrAllocateReset(benchmark::State &state) {
+  std::vector<size_t> Sizes = makeSizes(state.range(0));
+  llvm::BumpPtrAllocator Alloc;
+  for (auto _ : state) {
+    for (size_t S : Sizes)
+      benchmark::DoNotOptimize(Alloc.Allocate(S, 8));
+    Alloc.Reset();
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * Sizes.size());
+}
+BENCHMARK(BM_BumpPtrAllocateReset)->RangeMultiplier(8)->Range(64, 1 << 18);
+
+// The baseline: malloc and free every object.
+static void BM_Malloc(benchmark::State &state) {
+  std::vector<size_t> Sizes = makeSizes(state.range(0));
+  std::vector<void *> Ptrs(Sizes.size());
+  for (auto _ : state) {
+    for (size_t I = 0; I < Sizes.size(); ++I)
+      Ptrs[I] = std::malloc(Sizes[I]);
+    benchmark::DoNotOptimize(Ptrs.data());
+    for (void *P : Ptrs)
+      std::free(P);
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * Sizes.size());
+}
+BENCHMARK(BM_Malloc)->RangeMultiplier(8)->Range(64, 1 << 18);
+
+namespace {
+struct Object {
+  void *Fields[4];
+};
+} // namespace
+
+static void BM_SpecificBumpPtrAllocate(benchmark::State &state) {
+  const int64_t N = state.range(0);
+  for (auto _ : state) {
+    llvm::SpecificBumpPtrAllocator<Object> Alloc;
+    for (int64_t I = 0; I < N; ++I)
+      benchmark::DoNotOptimize(Alloc.Allocate());
+  }
+  state.SetItemsProcessed(state.iterations() * N);
+}
+BENCHMARK(BM_SpecificBumpPtrAllocate)->RangeMultiplier(8)->Range(64, 1 << 18);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,66 @@
+#include "benchmark/benchmark.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/ConcurrentStringMap.h"
+#include "llvm/Support/StringSaver.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Returns NumKeys distinct symbol-like names.
+static std::vector<std::string> makeKeys(size_t NumKeys) {
+  std::vector<std::string> Keys;
+  for (size_t I = 0; I < NumKeys; ++I)
+    Keys.push_back("_ZN4llvm12symbol_name_" + std::to_string(I * 7919) + "Ev");
+  return Keys;
+}
+
+static const std::vector<std::string> &getKeys() {
+  static const std::vector<std::string> Keys = makeKeys(1 << 16);
+  return Keys;
+}
+
+// The baseline: a UniqueStringSaver behind a single mutex.
+class LockedStringSaver {
+  llvm::BumpPtrAllocator Alloc;
+  llvm::UniqueStringSaver Saver{Alloc};
+  std::mutex Mu;
+
+public:
+  llvm::StringRef save(llvm::StringRef S) {
+    std::lock_guard<std::mutex> Lock(Mu);
+    return Saver.save(S);
+  }
+};
+
+// Each thread interns every key, so most calls after warm-up are lookups of
+// keys that another thread has already saved.
+template <typename SaverT> static void BM_Intern(benchmark::State &state) {
+  static SaverT *Saver;
+  if (state.thread_index == 0)
+    Saver = new SaverT();
+  const std::vector<std::string> &Keys = getKeys();
+  size_t I = state.thread_index * 4099;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(Saver->save(Keys[I++ % Keys.size()]).data());
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index == 0)
+    delete Saver;
+}
+BENCHMARK_TEMPLATE(BM_Intern, LockedStringSaver)->ThreadRange(1, 16);
+BENCHMARK_TEMPLATE(BM_Intern, llvm::ConcurrentUniqueStringSaver)
+    ->ThreadRange(1, 16);
+
+// Interns fresh sets of keys, so every call inserts.
+template <typename SaverT> static void BM_InternUnique(benchmark::State &state) {
+  const std::vector<std::string> &Keys = getKeys();
+  for (auto _ : state) {
+    SaverT Saver;
+    for (const std::string &K : Keys)
+      benchmark::DoNotOptimize(Saver.save(K).data());
+  }
+  state.SetItemsProcessed(state.iterations() * Keys.size());
+}
+BENCHMARK_TEMPLATE(BM_InternUnique, LockedStringSaver);
+BENCHMARK_TEMPLATE(BM_InternUnique, llvm::ConcurrentUniqueStringSaver);
+
+BENCHMARK_MAIN();
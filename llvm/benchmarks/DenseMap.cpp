@@ -0,0 +1,130 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/FlatDenseMap.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Returns NumKeys distinct keys shaped like heap pointers: 16-byte aligned
+// and clustered, as Value *, Type * and SDNode * keys are in practice.
+static std::vector<uintptr_t> makePointerKeys(size_t NumKeys) {
+  std::vector<uintptr_t> Keys;
+  uint64_t X = 1;
+  uintptr_t Base = 0x7f0000000000;
+  for (size_t I = 0; I < NumKeys; ++I) {
+    X = X * 6364136223846793005ULL + 1442695040888963407ULL;
+    // Mostly small strides within an allocation slab, with occasional jumps
+    // to a new slab.
+    Base += (X >> 60) == 0 ? ((X >> 32) & 0xfffff0) + 16
+                          : ((X >> 56) & 0xf0) + 16;
+    Keys.push_back(Base);
+  }
+  return Keys;
+}
+
+// Objects of the same size allocated back to back from one slab, e.g. the
+// instructions of a freshly built basic block.
+static std::vector<uintptr_t> makeSequentialKeys(size_t NumKeys) {
+  std::vector<uintptr_t> Keys;
+  for (size_t I = 0; I < NumKeys; ++I)
+    Keys.push_back(0x7f0000000000 + I * 48);
+  return Keys;
+}
+
+using PointerDenseMap = llvm::DenseMap<void *, unsigned>;
+using PointerFlatDenseMap = llvm::FlatDenseMap<void *, unsigned>;
+
+template <typename MapT, std::vector<uintptr_t> (*MakeKeys)(size_t)>
+static void BM_Insert(benchmark::State &state) {
+  std::vector<uintptr_t> Keys = MakeKeys(state.range(0));
+  for (auto _ : state) {
+    MapT Map;
+    for (uintptr_t K : Keys)
+      Map[reinterpret_cast<void *>(K)] = 0;
+    benchmark::DoNotOptimize(Map.size());
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * Keys.size());
+}
+BENCHMARK_TEMPLATE(BM_Insert, PointerDenseMap, makePointerKeys)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 18);
+BENCHMARK_TEMPLATE(BM_Insert, PointerDenseMap, makeSequentialKeys)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 18);
+BENCHMARK_TEMPLATE(BM_Insert, PointerFlatDenseMap, makePointerKeys)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 18);
+BENCHMARK_TEMPLATE(BM_Insert, PointerFlatDenseMap, makeSequentialKeys)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 18);
+
+// Reserving up front avoids every rehash; the gap to BM_Insert is the cost of
+// growing.
+template <typename MapT>
+static void BM_InsertReserved(benchmark::State &state) {
+  std::vector<uintptr_t> Keys = makePointerKeys(state.range(0));
+  for (auto _ : state) {
+    MapT Map;
+    Map.reserve(Keys.size());
+    for (uintptr_t K : Keys)
+      Map[reinterpret_cast<void *>(K)] = 0;
+    benchmark::DoNotOptimize(Map.size());
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * Keys.size());
+}
+BENCHMARK_TEMPLATE(BM_InsertReserved, PointerDenseMap)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 18);
+BENCHMARK_TEMPLATE(BM_InsertReserved, PointerFlatDenseMap)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 18);
+
+// Half of the lookups hit and half miss, as in typical "have we seen this
+// value already" queries.
+template <typename MapT> static void BM_Lookup(benchmark::State &state) {
+  std::vector<uintptr_t> Keys = makePointerKeys(state.range(0) * 2);
+  MapT Map;
+  for (size_t I = 0; I < Keys.size(); I += 2)
+    Map[reinterpret_cast<void *>(Keys[I])] = I;
+  size_t I = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Map.count(reinterpret_cast<void *>(Keys[I])));
+    if (++I == Keys.size())
+      I = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_Lookup, PointerDenseMap)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 18);
+BENCHMARK_TEMPLATE(BM_Lookup, PointerFlatDenseMap)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 18);
+BENCHMARK_TEMPLATE(BM_Lookup, std::unordered_map<void *, unsigned>)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 18);
+
+// Worklist-style use: insert, erase, and reinsert, which leaves tombstones
+// behind.
+template <typename MapT> static void BM_Churn(benchmark::State &state) {
+  std::vector<uintptr_t> Keys = makePointerKeys(state.range(0));
+  for (auto _ : state) {
+    MapT Map;
+    for (uintptr_t K : Keys)
+      Map[reinterpret_cast<void *>(K)] = 0;
+    for (size_t I = 0; I < Keys.size(); I += 2)
+      Map.erase(reinterpret_cast<void *>(Keys[I]));
+    for (size_t I = 0; I < Keys.size(); I += 2)
+      Map[reinterpret_cast<void *>(Keys[I])] = 0;
+    benchmark::DoNotOptimize(Map.size());
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * Keys.size() * 2);
+}
+BENCHMARK_TEMPLATE(BM_Churn, PointerDenseMap)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 18);
+BENCHMARK_TEMPLATE(BM_Churn, PointerFlatDenseMap)
+    ->RangeMultiplier(8)
+    ->Range(8, 1 << 18);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,81 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/FoldingSet.h"
+#include "llvm/Support/Allocator.h"
+#include <vector>
+
+namespace {
+// A uniqued node keyed on an opcode and a few operands, shaped like SCEVs,
+// SDNodes and clang types.
+struct Node : llvm::FoldingSetNode {
+  unsigned Opcode;
+  const Node *LHS, *RHS;
+
+  Node(unsigned Opcode, const Node *LHS, const Node *RHS)
+      : Opcode(Opcode), LHS(LHS), RHS(RHS) {}
+
+  static void Profile(llvm::FoldingSetNodeID &ID, unsigned Opcode,
+                      const Node *LHS, const Node *RHS) {
+    ID.AddInteger(Opcode);
+    ID.AddPointer(LHS);
+    ID.AddPointer(RHS);
+  }
+  void Profile(llvm::FoldingSetNodeID &ID) const {
+    Profile(ID, Opcode, LHS, RHS);
+  }
+};
+
+class Uniquer {
+  llvm::BumpPtrAllocator Alloc;
+  llvm::FoldingSet<Node> Nodes;
+
+public:
+  const Node *get(unsigned Opcode, const Node *LHS, const Node *RHS) {
+    llvm::FoldingSetNodeID ID;
+    Node::Profile(ID, Opcode, LHS, RHS);
+    void *InsertPos;
+    if (Node *N = Nodes.FindNodeOrInsertPos(ID, InsertPos))
+      return N;
+    Node *N = new (Alloc) Node(Opcode, LHS, RHS);
+    Nodes.InsertNode(N, InsertPos);
+    return N;
+  }
+};
+} // namespace
+
+// Builds an expression DAG where each new node refers to two recent ones.
+// Roughly a third of the requests find an existing node.
+static void BM_FoldingSetGetOrInsert(benchmark::State &state) {
+  const int64_t N = state.range(0);
+  for (auto _ : state) {
+    Uniquer U;
+    std::vector<const Node *> Recent(16, nullptr);
+    uint64_t X = 1;
+    for (int64_t I = 0; I < N; ++I) {
+      X = X * 6364136223846793005ULL + 1442695040888963407ULL;
+      const Node *LHS = Recent[(X >> 40) % 16];
+      const Node *RHS = Recent[(X >> 50) % 16];
+      const Node *New = U.get((X >> 60) % 3, LHS, RHS);
+      Recent[I % 16] = New;
+    }
+    benchmark::DoNotOptimize(Recent.data());
+  }
+  state.SetItemsProcessed(state.iterations() * N);
+}
+BENCHMARK(BM_FoldingSetGetOrInsert)->RangeMultiplier(8)->Range(64, 1 << 18);
+
+// Profiling alone: the FoldingSetNodeID is rebuilt for every query.
+static void BM_FoldingSetNodeIDHash(benchmark::State &state) {
+  unsigned I = 0;
+  for (auto _ : state) {
+    llvm::FoldingSetNodeID ID;
+    ID.AddInteger(I);
+    ID.AddPointer(&ID);
+    ID.AddInteger(uint64_t(I) << 32);
+    benchmark::DoNotOptimize(ID.ComputeHash());
+    ++I;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FoldingSetNodeIDHash);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,61 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DJB.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/xxhash.h"
+#include <string>
+
+// Returns a deterministic pseudorandom string of the given length.
+static std::string makeInput(size_t Len) {
+  std::string S(Len, '\0');
+  uint64_t X = 1;
+  for (char &C : S) {
+    X = X * 6364136223846793005ULL + 1442695040888963407ULL;
+    C = X >> 56;
+  }
+  return S;
+}
+
+template <uint64_t (*HashFn)(llvm::StringRef)>
+static void BM_Hash(benchmark::State &state) {
+  std::string Input = makeInput(state.range(0));
+  llvm::StringRef S(Input);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(HashFn(S));
+  state.SetBytesProcessed(int64_t(state.iterations()) * Input.size());
+}
+
+static uint64_t xxh3(llvm::StringRef S) { return llvm::xxh3_64bits(S); }
+static uint64_t xxh64(llvm::StringRef S) { return llvm::xxHash64(S); }
+static uint64_t hashValue(llvm::StringRef S) { return llvm::hash_value(S); }
+static uint64_t djb(llvm::StringRef S) { return llvm::djbHash(S); }
+
+static uint64_t md5(llvm::StringRef S) {
+  llvm::MD5 Hash;
+  llvm::MD5::MD5Result Result;
+  Hash.update(S);
+  Hash.final(Result);
+  return Result.low();
+}
+
+static uint64_t sha1(llvm::StringRef S) {
+  llvm::SHA1 Hash;
+  Hash.update(S);
+  return Hash.final().front();
+}
+
+// Short strings are typical of symbol names and merged string sections;
+// long ones of section contents and build IDs.
+#define HASH_BENCHMARK(Fn)                                                     \
+  BENCHMARK_TEMPLATE(BM_Hash, Fn)->RangeMultiplier(4)->Range(4, 1 << 20)
+
+HASH_BENCHMARK(xxh3);
+HASH_BENCHMARK(xxh64);
+HASH_BENCHMARK(hashValue);
+HASH_BENCHMARK(djb);
+HASH_BENCHMARK(md5);
+HASH_BENCHMARK(sha1);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,84 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/xxhash.h"
+#include <atomic>
+#include <string>
+#include <vector>
+
+using namespace llvm::parallel;
+
+// Returns N pseudorandom 64-bit values.
+static std::vector<uint64_t> makeValues(size_t N) {
+  std::vector<uint64_t> V(N);
+  uint64_t X = 1;
+  for (uint64_t &E : V) {
+    X = X * 6364136223846793005ULL + 1442695040888963407ULL;
+    E = X;
+  }
+  return V;
+}
+
+template <typename Policy> static void BM_Sort(benchmark::State &state) {
+  const std::vector<uint64_t> Values = makeValues(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<uint64_t> V = Values;
+    state.ResumeTiming();
+    sort(Policy(), V.begin(), V.end());
+    benchmark::DoNotOptimize(V.data());
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * Values.size());
+}
+BENCHMARK_TEMPLATE(BM_Sort, sequential_execution_policy)
+    ->RangeMultiplier(8)
+    ->Range(1 << 10, 1 << 22);
+#if LLVM_ENABLE_THREADS
+BENCHMARK_TEMPLATE(BM_Sort, parallel_execution_policy)
+    ->RangeMultiplier(8)
+    ->Range(1 << 10, 1 << 22);
+#endif
+
+// Hashes state.range(0) chunks of 4 KiB, like lld's parallel section
+// hashing and build-id computation. Small counts measure dispatch overhead.
+template <typename Policy> static void BM_ForEachN(benchmark::State &state) {
+  const size_t NumChunks = state.range(0);
+  std::string Data(NumChunks * 4096, 'x');
+  std::vector<uint64_t> Hashes(NumChunks);
+  for (auto _ : state) {
+    for_each_n(Policy(), size_t(0), NumChunks, [&](size_t I) {
+      Hashes[I] = llvm::xxHash64(llvm::StringRef(Data).substr(I * 4096, 4096));
+    });
+    benchmark::DoNotOptimize(Hashes.data());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * Data.size());
+}
+BENCHMARK_TEMPLATE(BM_ForEachN, sequential_execution_policy)
+    ->RangeMultiplier(8)
+    ->Range(1, 1 << 14);
+#if LLVM_ENABLE_THREADS
+BENCHMARK_TEMPLATE(BM_ForEachN, parallel_execution_policy)
+    ->RangeMultiplier(8)
+    ->Range(1, 1 << 14);
+#endif
+
+// Tiny tasks that contend on one counter bound the per-task overhead of the
+// parallel executor.
+template <typename Policy> static void BM_ForEachTiny(benchmark::State &state) {
+  std::vector<uint64_t> V = makeValues(state.range(0));
+  for (auto _ : state) {
+    std::atomic<uint64_t> Sum(0);
+    for_each(Policy(), V.begin(), V.end(),
+             [&](uint64_t X) { Sum.fetch_add(X, std::memory_order_relaxed); });
+    benchmark::DoNotOptimize(Sum.load());
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * V.size());
+}
+BENCHMARK_TEMPLATE(BM_ForEachTiny, sequential_execution_policy)
+    ->Range(1 << 10, 1 << 20);
+#if LLVM_ENABLE_THREADS
+BENCHMARK_TEMPLATE(BM_ForEachTiny, parallel_execution_policy)
+    ->Range(1 << 10, 1 << 20);
+#endif
+
+BENCHMARK_MAIN();
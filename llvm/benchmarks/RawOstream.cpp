@@ -0,0 +1,68 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/raw_ostream.h"
+#include <string>
+
+// Emits one line of textual assembly-like output, the common shape of
+// AsmPrinter, -print-after-all and diagnostic output.
+static void emitLine(llvm::raw_ostream &OS, unsigned I) {
+  OS << "\tmovq\t" << I * 8 << "(%rsp), %rax\t# spill slot " << I << '\n';
+}
+
+static void BM_SVectorOstream(benchmark::State &state) {
+  for (auto _ : state) {
+    llvm::SmallString<4096> Buf;
+    llvm::raw_svector_ostream OS(Buf);
+    for (unsigned I = 0; I < 1024; ++I)
+      emitLine(OS, I);
+    benchmark::DoNotOptimize(Buf.data());
+  }
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_SVectorOstream);
+
+static void BM_StringOstream(benchmark::State &state) {
+  for (auto _ : state) {
+    std::string Buf;
+    llvm::raw_string_ostream OS(Buf);
+    for (unsigned I = 0; I < 1024; ++I)
+      emitLine(OS, I);
+    OS.flush();
+    benchmark::DoNotOptimize(Buf.data());
+  }
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_StringOstream);
+
+// The cost of formatting alone, without a growing destination buffer.
+static void BM_NullOstream(benchmark::State &state) {
+  llvm::raw_null_ostream OS;
+  for (auto _ : state)
+    for (unsigned I = 0; I < 1024; ++I)
+      emitLine(OS, I);
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_NullOstream);
+
+static void BM_WriteHexAndFormat(benchmark::State &state) {
+  llvm::raw_null_ostream OS;
+  for (auto _ : state)
+    for (unsigned I = 0; I < 1024; ++I)
+      OS << llvm::format_hex(I * 2654435761u, 10) << ' '
+         << llvm::format("%5.2f", I / 7.0) << '\n';
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_WriteHexAndFormat);
+
+static void BM_Formatv(benchmark::State &state) {
+  llvm::raw_null_ostream OS;
+  for (auto _ : state)
+    for (unsigned I = 0; I < 1024; ++I)
+      OS << llvm::formatv("{0,8} {1:x} {2}\n", I, I * 2654435761u, "name");
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_Formatv);
+
+BENCHMARK_MAIN();
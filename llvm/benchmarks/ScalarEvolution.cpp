@@ -0,0 +1,104 @@
+#include "benchmark/benchmark.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+
+using namespace llvm;
+
+namespace {
+
+// A loop whose body computes a chain of Depth alternating adds and muls of
+// the induction variable, like fully unrolled rounds of a hash or a cipher.
+// The loop is entered only if N is positive.
+struct DeepChain {
+  LLVMContext Ctx;
+  Module M{"scev-benchmark", Ctx};
+  Function *F;
+  Value *N;
+  PHINode *IV;
+  Value *Last;
+
+  explicit DeepChain(unsigned Depth) {
+    IRBuilder<> B(Ctx);
+    Type *I64 = B.getInt64Ty();
+    F = Function::Create(FunctionType::get(I64, {I64, I64, I64}, false),
+                         GlobalValue::ExternalLinkage, "f", &M);
+    auto Args = F->arg_begin();
+    N = &*Args++;
+    Value *X = &*Args++;
+    Value *Y = &*Args++;
+
+    BasicBlock *Entry = BasicBlock::Create(Ctx, "entry", F);
+    BasicBlock *Loop = BasicBlock::Create(Ctx, "loop", F);
+    BasicBlock *Exit = BasicBlock::Create(Ctx, "exit", F);
+
+    B.SetInsertPoint(Entry);
+    B.CreateCondBr(B.CreateICmpSGT(N, B.getInt64(0)), Loop, Exit);
+
+    B.SetInsertPoint(Loop);
+    IV = B.CreatePHI(I64, 2);
+    IV->addIncoming(B.getInt64(0), Entry);
+    Last = IV;
+    for (unsigned I = 0; I < Depth; ++I)
+      Last = I % 2 ? B.CreateMul(Last, Y) : B.CreateAdd(Last, X);
+    Value *Next = B.CreateAdd(IV, B.getInt64(1), "", /*HasNUW=*/false,
+                              /*HasNSW=*/true);
+    IV->addIncoming(Next, Loop);
+    B.CreateCondBr(B.CreateICmpSLT(Next, N), Loop, Exit);
+
+    B.SetInsertPoint(Exit);
+    PHINode *Result = B.CreatePHI(I64, 2);
+    Result->addIncoming(B.getInt64(0), Entry);
+    Result->addIncoming(Last, Loop);
+    B.CreateRet(Result);
+  }
+};
+
+} // end anonymous namespace
+
+// Builds the SCEV of the end of the chain, and its range.
+static void BM_DeepChainSCEV(benchmark::State &State) {
+  DeepChain Chain(State.range(0));
+  TargetLibraryInfoImpl TLII;
+  TargetLibraryInfo TLI(TLII);
+  for (auto _ : State) {
+    AssumptionCache AC(*Chain.F);
+    DominatorTree DT(*Chain.F);
+    LoopInfo LI(DT);
+    ScalarEvolution SE(*Chain.F, TLI, AC, DT, LI);
+    const SCEV *S = SE.getSCEV(Chain.Last);
+    benchmark::DoNotOptimize(SE.getUnsignedRange(S));
+    benchmark::DoNotOptimize(SE.getSignedRange(S));
+  }
+}
+BENCHMARK(BM_DeepChainSCEV)->Arg(16)->Arg(256)->Arg(4096);
+
+// Asks the same loop entry questions about every link of the chain, as
+// IndVars and LSR do.
+static void BM_LoopEntryGuards(benchmark::State &State) {
+  DeepChain Chain(State.range(0));
+  TargetLibraryInfoImpl TLII;
+  TargetLibraryInfo TLI(TLII);
+  AssumptionCache AC(*Chain.F);
+  DominatorTree DT(*Chain.F);
+  LoopInfo LI(DT);
+  ScalarEvolution SE(*Chain.F, TLI, AC, DT, LI);
+  const Loop *L = LI.getLoopFor(Chain.IV->getParent());
+  const SCEV *N = SE.getSCEV(Chain.N);
+  const SCEV *Zero = SE.getZero(N->getType());
+  for (auto _ : State)
+    for (unsigned I = 0; I < State.range(0); ++I) {
+      benchmark::DoNotOptimize(
+          SE.isLoopEntryGuardedByCond(L, ICmpInst::ICMP_SGT, N, Zero));
+      benchmark::DoNotOptimize(
+          SE.isLoopEntryGuardedByCond(L, ICmpInst::ICMP_UGT, N, Zero));
+    }
+}
+BENCHMARK(BM_LoopEntryGuards)->Arg(16)->Arg(256);
+
+BENCHMARK_MAIN();
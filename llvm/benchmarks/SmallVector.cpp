@@ -0,0 +1,74 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/SmallVector.h"
+#include <string>
+#include <vector>
+
+// Appends state.range(0) pointers to a fresh vector. Sizes up to the inline
+// capacity never allocate.
+template <typename VectorT> static void BM_PushBack(benchmark::State &state) {
+  const int64_t N = state.range(0);
+  for (auto _ : state) {
+    VectorT V;
+    for (int64_t I = 0; I < N; ++I)
+      V.push_back(&V);
+    benchmark::DoNotOptimize(V.data());
+  }
+  state.SetItemsProcessed(state.iterations() * N);
+}
+BENCHMARK_TEMPLATE(BM_PushBack, llvm::SmallVector<void *, 8>)
+    ->RangeMultiplier(2)
+    ->Range(4, 1 << 10);
+BENCHMARK_TEMPLATE(BM_PushBack, llvm::SmallVector<void *, 0>)
+    ->RangeMultiplier(2)
+    ->Range(4, 1 << 10);
+BENCHMARK_TEMPLATE(BM_PushBack, std::vector<void *>)
+    ->RangeMultiplier(2)
+    ->Range(4, 1 << 10);
+
+// Growing a vector of non-trivially-copyable elements moves every element on
+// each reallocation.
+static void BM_PushBackString(benchmark::State &state) {
+  const int64_t N = state.range(0);
+  const std::string S = "a string too long for the small string buffer";
+  for (auto _ : state) {
+    llvm::SmallVector<std::string, 4> V;
+    for (int64_t I = 0; I < N; ++I)
+      V.push_back(S);
+    benchmark::DoNotOptimize(V.data());
+  }
+  state.SetItemsProcessed(state.iterations() * N);
+}
+BENCHMARK(BM_PushBackString)->RangeMultiplier(4)->Range(4, 1 << 10);
+
+// Operand lists and worklists are mostly filled in bulk and then traversed.
+static void BM_AppendAndIterate(benchmark::State &state) {
+  std::vector<unsigned> Source(state.range(0));
+  for (size_t I = 0; I < Source.size(); ++I)
+    Source[I] = I * 2654435761u;
+  for (auto _ : state) {
+    llvm::SmallVector<unsigned, 16> V;
+    V.append(Source.begin(), Source.end());
+    unsigned Sum = 0;
+    for (unsigned X : V)
+      Sum += X;
+    benchmark::DoNotOptimize(Sum);
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * Source.size());
+}
+BENCHMARK(BM_AppendAndIterate)->RangeMultiplier(4)->Range(4, 1 << 14);
+
+// Inserting at the front shifts every element, as when building a use list
+// in reverse.
+static void BM_InsertFront(benchmark::State &state) {
+  const int64_t N = state.range(0);
+  for (auto _ : state) {
+    llvm::SmallVector<unsigned, 16> V;
+    for (int64_t I = 0; I < N; ++I)
+      V.insert(V.begin(), I);
+    benchmark::DoNotOptimize(V.data());
+  }
+  state.SetItemsProcessed(state.iterations() * N);
+}
+BENCHMARK(BM_InsertFront)->RangeMultiplier(4)->Range(4, 1 << 10);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,72 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Returns NumKeys distinct names with the length distribution of a C++
+// program's symbol table: mostly short identifiers and some long mangled
+// names sharing common prefixes.
+static std::vector<std::string> makeSymbolNames(size_t NumKeys) {
+  static const char *const Prefixes[] = {"", "_ZN4llvm", "_ZNK5clang4Sema",
+                                         "_ZNSt6vectorIiSaIiEE", ".L.str"};
+  std::vector<std::string> Keys;
+  uint64_t X = 1;
+  for (size_t I = 0; I < NumKeys; ++I) {
+    X = X * 6364136223846793005ULL + 1442695040888963407ULL;
+    std::string Name = Prefixes[(X >> 33) % 5];
+    Name += "sym" + std::to_string(I);
+    // About one in eight names is a long template instantiation.
+    if ((X >> 60) < 2)
+      Name += "IJNS_8ArrayRefIPNS_5ValueEEEEEEvT_";
+    Keys.push_back(std::move(Name));
+  }
+  return Keys;
+}
+
+static void BM_StringMapInsert(benchmark::State &state) {
+  std::vector<std::string> Keys = makeSymbolNames(state.range(0));
+  for (auto _ : state) {
+    llvm::StringMap<unsigned> Map;
+    for (const std::string &K : Keys)
+      Map.try_emplace(K, 0);
+    benchmark::DoNotOptimize(Map.size());
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * Keys.size());
+}
+BENCHMARK(BM_StringMapInsert)->RangeMultiplier(8)->Range(8, 1 << 18);
+
+// Half of the lookups hit and half miss.
+static void BM_StringMapLookup(benchmark::State &state) {
+  std::vector<std::string> Keys = makeSymbolNames(state.range(0) * 2);
+  llvm::StringMap<unsigned> Map;
+  for (size_t I = 0; I < Keys.size(); I += 2)
+    Map[Keys[I]] = I;
+  size_t I = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Map.count(Keys[I]));
+    if (++I == Keys.size())
+      I = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StringMapLookup)->RangeMultiplier(8)->Range(8, 1 << 18);
+
+// The baseline for BM_StringMapLookup.
+static void BM_UnorderedStringMapLookup(benchmark::State &state) {
+  std::vector<std::string> Keys = makeSymbolNames(state.range(0) * 2);
+  std::unordered_map<std::string, unsigned> Map;
+  for (size_t I = 0; I < Keys.size(); I += 2)
+    Map[Keys[I]] = I;
+  size_t I = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Map.count(Keys[I]));
+    if (++I == Keys.size())
+      I = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UnorderedStringMapLookup)->RangeMultiplier(8)->Range(8, 1 << 18);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,657 @@
+//===- llvm/ADT/FlatDenseMap.h - Group-probed hash table --------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the FlatDenseMap class, an open-addressing hash table in
+// the style of Abseil's SwissTable.
+//
+// Next to the bucket array the map keeps one control byte per bucket, holding
+// either 7 bits of the key's hash or a marker for an empty or deleted bucket.
+// Lookups compare a whole group of 16 control bytes against the hash at once
+// (with SSE2 or NEON where available) and only touch the buckets whose control
+// byte matches, so probing does not drag keys and values through the cache and
+// keys need no empty or tombstone sentinel values.
+//
+// The interface follows DenseMap closely enough for most users to switch by
+// changing the type. Unlike DenseMap, KeyInfoT only needs to provide
+// getHashValue and isEqual; getEmptyKey and getTombstoneKey are never called.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_FLATDENSEMAP_H
+#define LLVM_ADT_FLATDENSEMAP_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/EpochTracker.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/MathExtras.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LLVM_FLATDENSEMAP_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define LLVM_FLATDENSEMAP_NEON 1
+#endif
+
+namespace llvm {
+
+namespace detail {
+
+/// Control byte values. Full buckets hold the low 7 bits of the hash, so they
+/// are the only values with the high bit clear.
+enum FlatDenseMapCtrl : int8_t {
+  FlatDenseMapEmpty = -128,  // 0b10000000
+  FlatDenseMapDeleted = -2,  // 0b11111110
+};
+
+/// A group of control bytes starting at an arbitrary bucket, matched all at
+/// once. Each match* function returns a mask with bit I set if control byte I
+/// of the group qualifies.
+struct FlatDenseMapGroup {
+  enum : unsigned { Width = 16 };
+
+#if defined(LLVM_FLATDENSEMAP_SSE2)
+  __m128i Ctrl;
+
+  explicit FlatDenseMapGroup(const int8_t *Pos)
+      : Ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(Pos))) {}
+
+  uint32_t match(int8_t H2) const {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(H2), Ctrl));
+  }
+  uint32_t matchEmpty() const { return match(FlatDenseMapEmpty); }
+  uint32_t matchFull() const { return ~_mm_movemask_epi8(Ctrl) & 0xffff; }
+#elif defined(LLVM_FLATDENSEMAP_NEON)
+  int8x16_t Ctrl;
+
+  explicit FlatDenseMapGroup(const int8_t *Pos) : Ctrl(vld1q_s8(Pos)) {}
+
+  static uint32_t toMask(uint8x16_t Bytes) {
+    static const uint8_t Bits[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                     1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t Masked = vandq_u8(Bytes, vld1q_u8(Bits));
+    return vaddv_u8(vget_low_u8(Masked)) |
+           (uint32_t(vaddv_u8(vget_high_u8(Masked))) << 8);
+  }
+  uint32_t match(int8_t H2) const {
+    return toMask(vceqq_s8(Ctrl, vdupq_n_s8(H2)));
+  }
+  uint32_t matchEmpty() const { return match(FlatDenseMapEmpty); }
+  uint32_t matchFull() const { return toMask(vcgeq_s8(Ctrl, vdupq_n_s8(0))); }
+#else
+  int8_t Ctrl[Width];
+
+  explicit FlatDenseMapGroup(const int8_t *Pos) {
+    std::memcpy(Ctrl, Pos, Width);
+  }
+
+  uint32_t match(int8_t H2) const {
+    uint32_t Mask = 0;
+    for (unsigned I = 0; I != Width; ++I)
+      Mask |= uint32_t(Ctrl[I] == H2) << I;
+    return Mask;
+  }
+  uint32_t matchEmpty() const { return match(FlatDenseMapEmpty); }
+  uint32_t matchFull() const {
+    uint32_t Mask = 0;
+    for (unsigned I = 0; I != Width; ++I)
+      Mask |= uint32_t(Ctrl[I] >= 0) << I;
+    return Mask;
+  }
+#endif
+
+  uint32_t matchEmptyOrDeleted() const { return ~matchFull() & 0xffff; }
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename BucketT,
+          bool IsConst>
+class FlatDenseMapIterator;
+
+} // end namespace detail
+
+template <typename KeyT, typename ValueT,
+          typename KeyInfoT = DenseMapInfo<KeyT>,
+          typename BucketT = llvm::detail::DenseMapPair<KeyT, ValueT>>
+class FlatDenseMap : public DebugEpochBase {
+  using Group = detail::FlatDenseMapGroup;
+
+  template <typename T>
+  using const_arg_type_t = typename const_pointer_or_const_ref<T>::type;
+
+  /// The control bytes, one per bucket followed by a copy of the first
+  /// Group::Width ones, so that a group can be loaded starting at any bucket
+  /// without wrapping around.
+  int8_t *Ctrl = nullptr;
+  BucketT *Buckets = nullptr;
+  /// The number of buckets, zero or a power of two no smaller than
+  /// Group::Width.
+  unsigned NumBuckets = 0;
+  unsigned NumEntries = 0;
+  /// The number of empty buckets that can still be filled before the load
+  /// factor requires a rehash. Deleted buckets do not count as empty.
+  unsigned GrowthLeft = 0;
+
+public:
+  using size_type = unsigned;
+  using key_type = KeyT;
+  using mapped_type = ValueT;
+  using value_type = BucketT;
+
+  using iterator =
+      detail::FlatDenseMapIterator<KeyT, ValueT, KeyInfoT, BucketT, false>;
+  using const_iterator =
+      detail::FlatDenseMapIterator<KeyT, ValueT, KeyInfoT, BucketT, true>;
+
+  explicit FlatDenseMap(unsigned NumInitEntries = 0) {
+    if (NumInitEntries)
+      init(getMinBucketsForEntries(NumInitEntries));
+  }
+
+  FlatDenseMap(const FlatDenseMap &Other) : DebugEpochBase() {
+    copyFrom(Other);
+  }
+
+  FlatDenseMap(FlatDenseMap &&Other) : DebugEpochBase() { swap(Other); }
+
+  template <typename InputIt> FlatDenseMap(const InputIt &I, const InputIt &E) {
+    init(getMinBucketsForEntries(std::distance(I, E)));
+    insert(I, E);
+  }
+
+  FlatDenseMap(std::initializer_list<std::pair<KeyT, ValueT>> Vals) {
+    init(getMinBucketsForEntries(Vals.size()));
+    for (const auto &V : Vals)
+      insert(V);
+  }
+
+  ~FlatDenseMap() {
+    destroyAll();
+    deallocate();
+  }
+
+  FlatDenseMap &operator=(const FlatDenseMap &Other) {
+    if (&Other != this) {
+      destroyAll();
+      deallocate();
+      copyFrom(Other);
+    }
+    return *this;
+  }
+
+  FlatDenseMap &operator=(FlatDenseMap &&Other) {
+    destroyAll();
+    deallocate();
+    Ctrl = nullptr;
+    Buckets = nullptr;
+    NumBuckets = NumEntries = GrowthLeft = 0;
+    swap(Other);
+    return *this;
+  }
+
+  void swap(FlatDenseMap &RHS) {
+    incrementEpoch();
+    RHS.incrementEpoch();
+    std::swap(Ctrl, RHS.Ctrl);
+    std::swap(Buckets, RHS.Buckets);
+    std::swap(NumBuckets, RHS.NumBuckets);
+    std::swap(NumEntries, RHS.NumEntries);
+    std::swap(GrowthLeft, RHS.GrowthLeft);
+  }
+
+  inline iterator begin() {
+    if (empty())
+      return end();
+    return iterator(Ctrl, Buckets, Ctrl + NumBuckets, *this);
+  }
+  inline iterator end() {
+    return iterator(Ctrl + NumBuckets, Buckets + NumBuckets,
+                    Ctrl + NumBuckets, *this, true);
+  }
+  inline const_iterator begin() const {
+    if (empty())
+      return end();
+    return const_iterator(Ctrl, Buckets, Ctrl + NumBuckets, *this);
+  }
+  inline const_iterator end() const {
+    return const_iterator(Ctrl + NumBuckets, Buckets + NumBuckets,
+                          Ctrl + NumBuckets, *this, true);
+  }
+
+  LLVM_NODISCARD bool empty() const { return NumEntries == 0; }
+  unsigned size() const { return NumEntries; }
+
+  /// Grow the map so that it can contain at least \p NumEntries items before
+  /// resizing again.
+  void reserve(size_type NumEntries) {
+    incrementEpoch();
+    unsigned MinBuckets = getMinBucketsForEntries(NumEntries);
+    if (MinBuckets > NumBuckets)
+      rehash(MinBuckets);
+  }
+
+  void clear() {
+    incrementEpoch();
+    if (NumEntries == 0 && GrowthLeft == getMaxLoad(NumBuckets))
+      return;
+    destroyAll();
+    resetCtrl();
+  }
+
+  /// Return 1 if the specified key is in the map, 0 otherwise.
+  size_type count(const_arg_type_t<KeyT> Val) const {
+    return findBucket(Val) ? 1 : 0;
+  }
+
+  iterator find(const_arg_type_t<KeyT> Val) {
+    if (BucketT *B = findBucket(Val))
+      return makeIterator(B);
+    return end();
+  }
+  const_iterator find(const_arg_type_t<KeyT> Val) const {
+    if (const BucketT *B = findBucket(Val))
+      return makeConstIterator(B);
+    return end();
+  }
+
+  /// Return the entry for the specified key, or a default constructed value
+  /// if no such entry exists.
+  ValueT lookup(const_arg_type_t<KeyT> Val) const {
+    if (const BucketT *B = findBucket(Val))
+      return B->getSecond();
+    return ValueT();
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // If the key is already in the map, it returns false and doesn't update the
+  // value.
+  std::pair<iterator, bool> insert(const std::pair<KeyT, ValueT> &KV) {
+    return try_emplace(KV.first, KV.second);
+  }
+
+  std::pair<iterator, bool> insert(std::pair<KeyT, ValueT> &&KV) {
+    return try_emplace(std::move(KV.first), std::move(KV.second));
+  }
+
+  /// Range insertion of pairs.
+  template <typename InputIt> void insert(InputIt I, InputIt E) {
+    for (; I != E; ++I)
+      insert(*I);
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // The value is constructed in-place if the key is not in the map, otherwise
+  // it is not moved.
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(KeyT &&Key, Ts &&... Args) {
+    std::pair<BucketT *, bool> Res = findOrPrepareInsert(Key);
+    if (Res.second) {
+      ::new (&Res.first->getFirst()) KeyT(std::move(Key));
+      ::new (&Res.first->getSecond()) ValueT(std::forward<Ts>(Args)...);
+    }
+    return std::make_pair(makeIterator(Res.first), Res.second);
+  }
+
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(const KeyT &Key, Ts &&... Args) {
+    std::pair<BucketT *, bool> Res = findOrPrepareInsert(Key);
+    if (Res.second) {
+      ::new (&Res.first->getFirst()) KeyT(Key);
+      ::new (&Res.first->getSecond()) ValueT(std::forward<Ts>(Args)...);
+    }
+    return std::make_pair(makeIterator(Res.first), Res.second);
+  }
+
+  ValueT &operator[](const KeyT &Key) {
+    return try_emplace(Key).first->second;
+  }
+
+  ValueT &operator[](KeyT &&Key) {
+    return try_emplace(std::move(Key)).first->second;
+  }
+
+  bool erase(const KeyT &Val) {
+    BucketT *B = findBucket(Val);
+    if (!B)
+      return false;
+    eraseBucket(B);
+    return true;
+  }
+
+  void erase(iterator I) { eraseBucket(&*I); }
+
+  /// Return the number of bytes of heap memory used by the map.
+  size_t getMemorySize() const {
+    return NumBuckets ? NumBuckets * sizeof(BucketT) + getCtrlSize(NumBuckets)
+                      : 0;
+  }
+
+private:
+  static unsigned getMaxLoad(unsigned NumBuckets) {
+    return NumBuckets - NumBuckets / 8;
+  }
+
+  static size_t getCtrlSize(unsigned NumBuckets) {
+    return NumBuckets + Group::Width;
+  }
+
+  static unsigned getMinBucketsForEntries(unsigned NumEntries) {
+    if (NumEntries == 0)
+      return 0;
+    // Keep the load factor at or below 7/8.
+    unsigned MinBuckets = NumEntries + (NumEntries + 6) / 7;
+    return std::max<unsigned>(Group::Width, NextPowerOf2(MinBuckets - 1));
+  }
+
+  /// Spread the bits of KeyInfoT's hash, which is often weak in the low bits
+  /// (e.g. for pointers), over a 64-bit value. The low 7 bits become the
+  /// control byte and the rest select the starting bucket.
+  template <typename LookupKeyT>
+  static uint64_t getHash(const LookupKeyT &Val) {
+    uint64_t H = uint64_t(KeyInfoT::getHashValue(Val)) * 0x9E3779B97F4A7C15ULL;
+    return H ^ (H >> 32);
+  }
+  static int8_t getH2(uint64_t Hash) { return Hash & 0x7f; }
+  static uint64_t getH1(uint64_t Hash) { return Hash >> 7; }
+
+  void setCtrl(unsigned I, int8_t C) {
+    Ctrl[I] = C;
+    if (I < Group::Width)
+      Ctrl[NumBuckets + I] = C;
+  }
+
+  template <typename LookupKeyT>
+  BucketT *findBucket(const LookupKeyT &Val) const {
+    if (NumEntries == 0)
+      return nullptr;
+    uint64_t Hash = getHash(Val);
+    int8_t H2 = getH2(Hash);
+    unsigned Mask = NumBuckets - 1;
+    unsigned Pos = getH1(Hash) & Mask;
+    for (unsigned Stride = Group::Width;; Stride += Group::Width) {
+      Group G(Ctrl + Pos);
+      for (uint32_t M = G.match(H2); M; M &= M - 1) {
+        BucketT *B = Buckets + ((Pos + countTrailingZeros(M)) & Mask);
+        if (LLVM_LIKELY(KeyInfoT::isEqual(Val, B->getFirst())))
+          return B;
+      }
+      if (G.matchEmpty())
+        return nullptr;
+      Pos = (Pos + Stride) & Mask;
+    }
+  }
+
+  /// Return the first empty or deleted bucket on the probe sequence of Hash.
+  unsigned findFirstNonFull(uint64_t Hash) const {
+    unsigned Mask = NumBuckets - 1;
+    unsigned Pos = getH1(Hash) & Mask;
+    for (unsigned Stride = Group::Width;; Stride += Group::Width) {
+      if (uint32_t M = Group(Ctrl + Pos).matchEmptyOrDeleted())
+        return (Pos + countTrailingZeros(M)) & Mask;
+      Pos = (Pos + Stride) & Mask;
+    }
+  }
+
+  /// Return the bucket holding Key and false, or a bucket that Key can be
+  /// constructed in and true. In the latter case the bucket is already
+  /// accounted for as full.
+  std::pair<BucketT *, bool> findOrPrepareInsert(const KeyT &Key) {
+    incrementEpoch();
+    if (BucketT *B = findBucket(Key))
+      return std::make_pair(B, false);
+
+    uint64_t Hash = getHash(Key);
+    unsigned I = NumBuckets ? findFirstNonFull(Hash) : 0;
+    if (NumBuckets == 0 ||
+        (GrowthLeft == 0 && Ctrl[I] == detail::FlatDenseMapEmpty)) {
+      growForInsert();
+      I = findFirstNonFull(Hash);
+    }
+    if (Ctrl[I] == detail::FlatDenseMapEmpty)
+      --GrowthLeft;
+    setCtrl(I, getH2(Hash));
+    ++NumEntries;
+    return std::make_pair(Buckets + I, true);
+  }
+
+  void growForInsert() {
+    // If a lot of the load is tombstones, clean them out in place instead of
+    // growing.
+    if (NumBuckets > Group::Width &&
+        uint64_t(NumEntries) * 32 <= uint64_t(NumBuckets) * 25)
+      rehash(NumBuckets);
+    else
+      rehash(std::max<unsigned>(Group::Width, NumBuckets * 2));
+  }
+
+  void eraseBucket(BucketT *B) {
+    incrementEpoch();
+    unsigned I = B - Buckets;
+    B->getSecond().~ValueT();
+    B->getFirst().~KeyT();
+    --NumEntries;
+
+    // A bucket can go back to empty if no window of Group::Width buckets that
+    // includes it was ever completely full, because then no probe sequence can
+    // have continued past it.
+    unsigned Mask = NumBuckets - 1;
+    uint32_t EmptyAfter = Group(Ctrl + I).matchEmpty();
+    uint32_t EmptyBefore =
+        Group(Ctrl + ((I - Group::Width) & Mask)).matchEmpty();
+    bool WasNeverFull =
+        EmptyAfter && EmptyBefore &&
+        countTrailingZeros(EmptyAfter) + countLeadingZeros(EmptyBefore) - 16 <
+            Group::Width;
+    if (WasNeverFull) {
+      setCtrl(I, detail::FlatDenseMapEmpty);
+      ++GrowthLeft;
+    } else {
+      setCtrl(I, detail::FlatDenseMapDeleted);
+    }
+  }
+
+  void allocate(unsigned Num) {
+    NumBuckets = Num;
+    Buckets = static_cast<BucketT *>(operator new(sizeof(BucketT) * Num));
+    Ctrl = static_cast<int8_t *>(operator new(getCtrlSize(Num)));
+  }
+
+  void deallocate() {
+    if (!NumBuckets)
+      return;
+    operator delete(Buckets);
+    operator delete(Ctrl);
+  }
+
+  void resetCtrl() {
+    if (!NumBuckets)
+      return;
+    std::memset(Ctrl, detail::FlatDenseMapEmpty, getCtrlSize(NumBuckets));
+    NumEntries = 0;
+    GrowthLeft = getMaxLoad(NumBuckets);
+  }
+
+  void init(unsigned Num) {
+    if (!Num)
+      return;
+    allocate(Num);
+    resetCtrl();
+  }
+
+  void destroyAll() {
+    if (std::is_trivially_destructible<BucketT>::value || NumEntries == 0)
+      return;
+    for (unsigned I = 0; I != NumBuckets; ++I) {
+      if (Ctrl[I] < 0)
+        continue;
+      Buckets[I].getSecond().~ValueT();
+      Buckets[I].getFirst().~KeyT();
+    }
+  }
+
+  void rehash(unsigned Num) {
+    int8_t *OldCtrl = Ctrl;
+    BucketT *OldBuckets = Buckets;
+    unsigned OldNumBuckets = NumBuckets;
+
+    init(Num);
+    for (unsigned I = 0; I != OldNumBuckets; ++I) {
+      if (OldCtrl[I] < 0)
+        continue;
+      BucketT &Old = OldBuckets[I];
+      uint64_t Hash = getHash(Old.getFirst());
+      unsigned New = findFirstNonFull(Hash);
+      setCtrl(New, getH2(Hash));
+      ::new (&Buckets[New].getFirst()) KeyT(std::move(Old.getFirst()));
+      ::new (&Buckets[New].getSecond()) ValueT(std::move(Old.getSecond()));
+      Old.getSecond().~ValueT();
+      Old.getFirst().~KeyT();
+      ++NumEntries;
+      --GrowthLeft;
+    }
+
+    if (OldNumBuckets) {
+      operator delete(OldBuckets);
+      operator delete(OldCtrl);
+    }
+  }
+
+  void copyFrom(const FlatDenseMap &Other) {
+    NumBuckets = NumEntries = GrowthLeft = 0;
+    Ctrl = nullptr;
+    Buckets = nullptr;
+    if (!Other.NumBuckets)
+      return;
+    allocate(Other.NumBuckets);
+    std::memcpy(Ctrl, Other.Ctrl, getCtrlSize(NumBuckets));
+    for (unsigned I = 0; I != NumBuckets; ++I) {
+      if (Ctrl[I] < 0)
+        continue;
+      ::new (&Buckets[I].getFirst()) KeyT(Other.Buckets[I].getFirst());
+      ::new (&Buckets[I].getSecond()) ValueT(Other.Buckets[I].getSecond());
+    }
+    NumEntries = Other.NumEntries;
+    GrowthLeft = Other.GrowthLeft;
+  }
+
+  iterator makeIterator(BucketT *B) {
+    return iterator(Ctrl + (B - Buckets), B, Ctrl + NumBuckets, *this, true);
+  }
+  const_iterator makeConstIterator(const BucketT *B) const {
+    return const_iterator(Ctrl + (B - Buckets), B, Ctrl + NumBuckets, *this,
+                          true);
+  }
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename BucketT>
+inline size_t capacity_in_bytes(
+    const FlatDenseMap<KeyT, ValueT, KeyInfoT, BucketT> &X) {
+  return X.getMemorySize();
+}
+
+namespace detail {
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename BucketT,
+          bool IsConst>
+class FlatDenseMapIterator : DebugEpochBase::HandleBase {
+  friend class FlatDenseMapIterator<KeyT, ValueT, KeyInfoT, BucketT, true>;
+  friend class FlatDenseMapIterator<KeyT, ValueT, KeyInfoT, BucketT, false>;
+
+  using ConstIterator =
+      FlatDenseMapIterator<KeyT, ValueT, KeyInfoT, BucketT, true>;
+
+public:
+  using difference_type = ptrdiff_t;
+  using value_type =
+      typename std::conditional<IsConst, const BucketT, BucketT>::type;
+  using pointer = value_type *;
+  using reference = value_type &;
+  using iterator_category = std::forward_iterator_tag;
+
+private:
+  const int8_t *Ctrl = nullptr;
+  pointer Ptr = nullptr;
+  const int8_t *End = nullptr;
+
+public:
+  FlatDenseMapIterator() = default;
+
+  FlatDenseMapIterator(const int8_t *Ctrl, pointer Pos, const int8_t *End,
+                       const DebugEpochBase &Epoch, bool NoAdvance = false)
+      : DebugEpochBase::HandleBase(&Epoch), Ctrl(Ctrl), Ptr(Pos), End(End) {
+    assert(isHandleInSync() && "invalid construction!");
+    if (!NoAdvance)
+      skipNonFull();
+  }
+
+  // Converting ctor from non-const iterators to const iterators. SFINAE'd out
+  // for const iterator destinations so it doesn't end up as a user defined copy
+  // constructor.
+  template <bool IsConstSrc,
+            typename = typename std::enable_if<!IsConstSrc && IsConst>::type>
+  FlatDenseMapIterator(
+      const FlatDenseMapIterator<KeyT, ValueT, KeyInfoT, BucketT, IsConstSrc>
+          &I)
+      : DebugEpochBase::HandleBase(I), Ctrl(I.Ctrl), Ptr(I.Ptr), End(I.End) {}
+
+  reference operator*() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    return *Ptr;
+  }
+  pointer operator->() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    return Ptr;
+  }
+
+  bool operator==(const ConstIterator &RHS) const {
+    assert((!Ptr || isHandleInSync()) && "handle not in sync!");
+    assert((!RHS.Ptr || RHS.isHandleInSync()) && "handle not in sync!");
+    assert(getEpochAddress() == RHS.getEpochAddress() &&
+           "comparing incomparable iterators!");
+    return Ptr == RHS.Ptr;
+  }
+  bool operator!=(const ConstIterator &RHS) const { return !(*this == RHS); }
+
+  inline FlatDenseMapIterator &operator++() { // Preincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    ++Ctrl;
+    ++Ptr;
+    skipNonFull();
+    return *this;
+  }
+  FlatDenseMapIterator operator++(int) { // Postincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    FlatDenseMapIterator Tmp = *this;
+    ++*this;
+    return Tmp;
+  }
+
+private:
+  void skipNonFull() {
+    while (Ctrl != End && *Ctrl < 0) {
+      ++Ctrl;
+      ++Ptr;
+    }
+  }
+};
+
+} // end namespace detail
+
+} // end namespace llvm
+
+#endif // LLVM_ADT_FLATDENSEMAP_H
@@ -58,6 +58,7 @@ namespace llvm {
 class AnalysisUsage;
 class BasicAAResult;
 class BasicBlock;
+class DecomposedGEPCache;
 class DominatorTree;
 class OrderedBasicBlock;
 class Value;
@@ -303,7 +304,17 @@ public:
   using IsCapturedCacheT = SmallDenseMap<const Value *, bool, 8>;
   IsCapturedCacheT IsCapturedCache;
 
-  AAQueryInfo() : AliasCache(), IsCapturedCache() {}
+  /// BasicAA's decompositions of GEPs into a base and offsets. A pointer is
+  /// decomposed again for every other pointer it is compared against, which
+  /// adds up over a batch of queries. So this is only used, and only
+  /// allocated, when \c CacheDecomposedGEPs is set, as \c BatchAAResults
+  /// does.
+  std::unique_ptr<DecomposedGEPCache> DecomposedGEPs;
+  bool CacheDecomposedGEPs = false;
+
+  // Out of line, as DecomposedGEPCache is only complete in BasicAA.
+  AAQueryInfo();
+  ~AAQueryInfo();
 };
 
 class BatchAAResults;
@@ -779,7 +790,9 @@ class BatchAAResults {
   AAQueryInfo AAQI;
 
 public:
-  BatchAAResults(AAResults &AAR) : AA(AAR), AAQI() {}
+  BatchAAResults(AAResults &AAR) : AA(AAR), AAQI() {
+    AAQI.CacheDecomposedGEPs = true;
+  }
   AliasResult alias(const MemoryLocation &LocA, const MemoryLocation &LocB) {
     return AA.alias(LocA, LocB, AAQI);
   }
@@ -53,6 +53,7 @@ class Value;
 /// to various other analyses and must be recomputed when those analyses are.
 class BasicAAResult : public AAResultBase<BasicAAResult> {
   friend AAResultBase<BasicAAResult>;
+  friend class DecomposedGEPCache;
 
   const DataLayout &DL;
   const Function &F;
@@ -172,6 +173,11 @@ private:
   static bool DecomposeGEPExpression(const Value *V, DecomposedGEP &Decomposed,
       const DataLayout &DL, AssumptionCache *AC, DominatorTree *DT);
 
+  /// Like DecomposeGEPExpression, but reuses the decomposition of \p V from
+  /// an earlier query of the batch \p AAQI belongs to.
+  bool decomposeGEPExpression(const Value *V, DecomposedGEP &Decomposed,
+                              AAQueryInfo &AAQI);
+
   static bool isGEPBaseAtNegativeOffset(const GEPOperator *GEPOp,
       const DecomposedGEP &DecompGEP, const DecomposedGEP &DecompObject,
       LocationSize ObjectAccessSize);
@@ -218,6 +224,16 @@ private:
                          const Value *O2 = nullptr);
 };
 
+/// The GEP decompositions cached in an AAQueryInfo, with whether the
+/// decomposition stopped at the search depth limit.
+class DecomposedGEPCache {
+  friend class BasicAAResult;
+
+  SmallDenseMap<const Value *,
+                std::pair<BasicAAResult::DecomposedGEP, bool>, 8>
+      Entries;
+};
+
 /// Analysis pass providing a never-invalidated alias analysis result.
 class BasicAA : public AnalysisInfoMixin<BasicAA> {
   friend AnalysisInfoMixin<BasicAA>;
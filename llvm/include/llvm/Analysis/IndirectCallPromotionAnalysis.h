@@ -26,13 +26,6 @@ private:
   // Allocate space to read the profile annotation.
   std::unique_ptr<InstrProfValueData[]> ValueDataArray;
 
-  // Count is the call count for the direct-call target.
-  // TotalCount is the total call count for the indirect-call callsite.
-  // RemainingCount is the TotalCount minus promoted-direct-call count.
-  // Return true we should promote this indirect-call target.
-  bool isPromotionProfitable(uint64_t Count, uint64_t TotalCount,
-                             uint64_t RemainingCount);
-
   // Returns the number of profitable candidates to promote for the
   // current ValueDataArray and the given \p Inst.
   uint32_t getProfitablePromotionCandidates(const Instruction *Inst,
@@ -47,6 +40,12 @@ private:
 public:
   ICallPromotionAnalysis();
 
+  /// Returns true if a direct-call target with call count \p Count should be
+  /// promoted at a callsite with total call count \p TotalCount, of which
+  /// \p RemainingCount calls are not yet covered by promoted targets.
+  static bool isPromotionProfitable(uint64_t Count, uint64_t TotalCount,
+                                    uint64_t RemainingCount);
+
   /// Returns reference to array of InstrProfValueData for the given
   /// instruction \p I.
   ///
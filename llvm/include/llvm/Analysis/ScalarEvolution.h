@@ -1195,6 +1195,19 @@ private:
   /// Memoized values for the GetMinTrailingZeros
   DenseMap<const SCEV *, uint32_t> MinTrailingZerosCache;
 
+  /// The predicates that isLoopEntryGuardedByCond was asked about, and those
+  /// of them it proved, as a bit per predicate.
+  struct LoopGuardResults {
+    uint16_t Queried = 0;
+    uint16_t Proved = 0;
+  };
+
+  /// Memoized results of isLoopEntryGuardedByCond, per loop and pair of
+  /// operands.
+  DenseMap<const Loop *,
+           DenseMap<std::pair<const SCEV *, const SCEV *>, LoopGuardResults>>
+      LoopEntryGuards;
+
   /// Return the Value set from which the SCEV expr is generated.
   SetVector<ValueOffsetPair> *getSCEVValues(const SCEV *S);
 
@@ -1645,6 +1658,11 @@ private:
   std::pair<BasicBlock *, BasicBlock *>
   getPredecessorWithUniqueSuccessorForBB(BasicBlock *BB);
 
+  /// Walk the conditions that dominate the entry of the loop for
+  /// isLoopEntryGuardedByCond, which memoizes the result.
+  bool isLoopEntryGuardedByCondImpl(const Loop *L, ICmpInst::Predicate Pred,
+                                    const SCEV *LHS, const SCEV *RHS);
+
   /// Test whether the condition described by Pred, LHS, and RHS is true
   /// whenever the given FoundCondValue value evaluates to true.
   bool isImpliedCond(ICmpInst::Predicate Pred, const SCEV *LHS, const SCEV *RHS,
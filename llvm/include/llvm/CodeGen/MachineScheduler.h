@@ -185,6 +185,10 @@ struct MachineSchedPolicy {
   // first.
   bool DisableLatencyHeuristic = false;
 
+  // Schedule a huge region cheaply: build its DAG with approximate memory
+  // dependencies and only use the register pressure heuristics.
+  bool FastRegion = false;
+
   MachineSchedPolicy() = default;
 };
 
@@ -215,6 +219,10 @@ public:
   /// This has to be enabled in combination with shouldTrackPressure().
   virtual bool shouldTrackLaneMasks() const { return false; }
 
+  /// Returns true if the DAG of the region may be built with approximate
+  /// memory dependencies, to save compile time.
+  virtual bool shouldApproximateMemDeps() const { return false; }
+
   // If this method returns true, handling of the scheduling regions
   // themselves (in case of a scheduling boundary in MBB) will be done
   // beginning with the topmost region of MBB.
@@ -944,6 +952,10 @@ public:
     return RegionPolicy.ShouldTrackLaneMasks;
   }
 
+  bool shouldApproximateMemDeps() const override {
+    return RegionPolicy.FastRegion;
+  }
+
   void initialize(ScheduleDAGMI *dag) override;
 
   SUnit *pickNode(bool &IsTopNode) override;
@@ -137,6 +137,12 @@ namespace llvm {
     /// Whether lane masks should get tracked.
     bool TrackLaneMasks = false;
 
+    /// Build memory dependencies without alias analysis, and reduce the
+    /// memory node maps early (see -dag-maps-approximate-region). The
+    /// dependencies stay conservative, but huge regions build in close to
+    /// linear time.
+    bool ApproximateMemDeps = false;
+
     // State specific to the current scheduling region.
     // ------------------------------------------------
 
@@ -167,6 +167,9 @@ struct DIDumpOptions {
   bool SummarizeTypes = false;
   bool Verbose = false;
   bool DisplayRawContents = false;
+  /// The number of threads the verifier may use for the checks that are
+  /// independent of each other.
+  unsigned VerifyThreads = 1;
 
   /// Return default option set for printing a single DIE without children.
   static DIDumpOptions getForSingleDIE() {
@@ -300,6 +300,11 @@ public:
   getLineTableForUnit(DWARFUnit *U,
                       std::function<void(Error)> RecoverableErrorCallback);
 
+  /// Free the parsed line table of a compile unit, if any. Pointers to it that
+  /// were previously returned by getLineTableForUnit are invalidated, and the
+  /// next call to getLineTableForUnit parses it again.
+  void clearLineTableForUnit(DWARFUnit *U);
+
   DataExtractor getStringExtractor() const {
     return DataExtractor(DObj->getStringSection(), false, 0);
   }
@@ -293,6 +293,8 @@ public:
   };
 
   const LineTable *getLineTable(uint32_t Offset) const;
+  /// Free the line table parsed at \p Offset, if any.
+  void clearLineTable(uint32_t Offset);
   Expected<const LineTable *> getOrParseLineTable(
       DWARFDataExtractor &DebugLineData, uint32_t Offset,
       const DWARFContext &Ctx, const DWARFUnit *U,
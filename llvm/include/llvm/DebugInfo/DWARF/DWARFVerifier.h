@@ -9,6 +9,7 @@
 #ifndef LLVM_DEBUGINFO_DWARF_DWARFVERIFIER_H
 #define LLVM_DEBUGINFO_DWARF_DWARFVERIFIER_H
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/DebugInfo/DIContext.h"
 #include "llvm/DebugInfo/DWARF/DWARFAcceleratorTable.h"
 #include "llvm/DebugInfo/DWARF/DWARFAddressRange.h"
@@ -105,6 +106,17 @@ private:
   raw_ostream &note() const;
   raw_ostream &dump(const DWARFDie &Die, unsigned indent = 0) const;
 
+  /// Runs \p Check for every index in [0, \p NumChecks), using up to
+  /// DumpOpts.VerifyThreads threads. Each check gets a verifier of its own,
+  /// whose output is printed in index order once all of them are done, so this
+  /// must only be used for checks that don't depend on the verifier's state
+  /// and that don't make DCtx parse anything.
+  ///
+  /// \returns The total number of errors reported by the checks.
+  unsigned
+  runIndependentChecks(size_t NumChecks,
+                       function_ref<unsigned(DWARFVerifier &, size_t)> Check);
+
   /// Verifies the abbreviations section.
   ///
   /// This function currently checks that:
@@ -10,6 +10,7 @@
 #define LLVM_DEBUGINFO_PDB_NATIVE_SYMBOLCACHE_H
 
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/DebugInfo/CodeView/TypeDeserializer.h"
 #include "llvm/DebugInfo/CodeView/TypeIndex.h"
 #include "llvm/DebugInfo/CodeView/TypeRecord.h"
@@ -52,6 +53,23 @@ class SymbolCache {
   /// Map from global symbol offset to SymIndexId.
   DenseMap<uint32_t, SymIndexId> GlobalOffsetToSymbolId;
 
+  /// A section contribution of a module, i.e. a range of a section of the
+  /// image that was produced by that module.
+  struct SectionContribEntry {
+    uint32_t ISect;
+    uint32_t Off;
+    uint32_t Size;
+    uint16_t Imod;
+  };
+
+  /// The section contributions of all the modules, sorted by section and
+  /// offset so that the module of an address can be found with a binary
+  /// search. Read from the DBI stream on first use.
+  std::vector<SectionContribEntry> SectionContribs;
+  bool SectionContribsRead = false;
+
+  void readSectionContribs();
+
   SymIndexId createSymbolPlaceholder() {
     SymIndexId Id = Cache.size();
     Cache.push_back(nullptr);
@@ -131,6 +149,11 @@ public:
   std::unique_ptr<PDBSymbolCompiland> getOrCreateCompiland(uint32_t Index);
   uint32_t getNumCompilands() const;
 
+  /// Returns the index of the module whose section contributions contain the
+  /// byte at \p Offset in section \p Sect (1-based), if there is one.
+  Optional<uint16_t> getModuleIndexForSectOffset(uint32_t Sect,
+                                                 uint32_t Offset);
+
   std::unique_ptr<PDBSymbol> getSymbolById(SymIndexId SymbolId) const;
 
   NativeRawSymbol &getNativeSymbolById(SymIndexId SymbolId) const;
@@ -42,6 +42,9 @@ public:
     std::string DefaultArch;
     std::vector<std::string> DsymHints;
     std::string FallbackDebugPath;
+    /// The amount of object file data the loaded modules may refer to before
+    /// the least recently used ones are unloaded, or 0 for no limit.
+    uint64_t MaxCacheSize = 0;
 
     Options(FunctionNameKind PrintFunctions = FunctionNameKind::LinkageName,
             bool UseSymbolTable = true, bool Demangle = true,
@@ -86,6 +89,10 @@ private:
   Expected<SymbolizableModule *>
   getOrCreateModuleInfo(const std::string &ModuleName, StringRef DWPName = "");
 
+  /// Unloads the least recently used modules, except for \p KeepModule,
+  /// until the cache fits into Opts.MaxCacheSize.
+  void pruneCache(const std::string &KeepModule);
+
   ObjectFile *lookUpDsymFile(const std::string &Path,
                              const MachOObjectFile *ExeObj,
                              const std::string &ArchName);
@@ -103,7 +110,23 @@ private:
   Expected<ObjectFile *> getOrCreateObject(const std::string &Path,
                                           const std::string &ArchName);
 
-  std::map<std::string, std::unique_ptr<SymbolizableModule>> Modules;
+  /// A loaded module, together with the bookkeeping for the cache size limit.
+  struct CachedModule {
+    std::unique_ptr<SymbolizableModule> Module;
+    /// The size of the object files the module was created from, which is
+    /// what we use to estimate how much memory its debug info takes.
+    uint64_t Size = 0;
+    /// The value of UseCounter when the module was last looked up.
+    uint64_t LastUse = 0;
+  };
+
+  std::map<std::string, CachedModule> Modules;
+
+  /// The sum of the sizes of the loaded modules.
+  uint64_t CacheSize = 0;
+
+  /// Incremented on every module lookup, to find the least recently used one.
+  uint64_t UseCounter = 0;
 
   /// Contains cached results of getOrCreateObjectPair().
   std::map<std::pair<std::string, std::string>, ObjectPair>
@@ -169,6 +169,9 @@ public:
     return addLazyIRModule(Main, std::move(M));
   }
 
+  /// Returns the speculator, or null if speculative compilation is disabled.
+  Speculator *getSpeculator() { return Spec.get(); }
+
 private:
 
   // Create a single-threaded LLLazyJIT instance.
@@ -177,6 +180,9 @@ private:
   std::unique_ptr<LazyCallThroughManager> LCTMgr;
   std::unique_ptr<IRTransformLayer> TransformLayer;
   std::unique_ptr<CompileOnDemandLayer> CODLayer;
+
+  // Destroyed first: waits for speculative lookups that use the layers above.
+  std::unique_ptr<Speculator> Spec;
 };
 
 class LLJITBuilderState {
@@ -188,6 +194,7 @@ public:
   Optional<JITTargetMachineBuilder> JTMB;
   CreateObjectLinkingLayerFunction CreateObjectLinkingLayer;
   unsigned NumCompileThreads = 0;
+  ObjectCache *ObjCache = nullptr;
 
   /// Called prior to JIT class construcion to fix up defaults.
   Error prepareForConstruction();
@@ -235,6 +242,16 @@ public:
     return impl();
   }
 
+  /// Set an ObjectCache for the IR compilers to query before compiling a
+  /// module, and to notify of each object they compile (see
+  /// PersistentObjectCache for a cache that persists across runs).
+  ///
+  /// The cache is not owned by the JIT and must outlive it.
+  SetterImpl &setObjectCache(ObjectCache *ObjCache) {
+    impl().ObjCache = ObjCache;
+    return impl();
+  }
+
   /// Create an instance of the JIT.
   Expected<std::unique_ptr<JITType>> create() {
     if (auto Err = impl().prepareForConstruction())
@@ -267,6 +284,7 @@ public:
   JITTargetAddress LazyCompileFailureAddr = 0;
   std::unique_ptr<LazyCallThroughManager> LCTMgr;
   IndirectStubsManagerBuilderFunction ISMBuilder;
+  bool SpeculateCompiles = false;
 
   Error prepareForConstruction();
 };
@@ -302,6 +320,20 @@ public:
     this->impl().ISMBuilder = std::move(ISMBuilder);
     return this->impl();
   }
+
+  /// Enable or disable speculative compilation.
+  ///
+  /// If enabled, the first call to a lazily compiled function also queues
+  /// background lookups of the functions it is most likely to call, so that
+  /// they are compiled before they are needed. This has no effect unless
+  /// setNumCompileThreads was called with a non-zero argument, and replaces
+  /// the NotifyLookup function of the lazy-callthrough manager.
+  ///
+  /// If this method is not called then speculative compilation is disabled.
+  SetterImpl &setSpeculateCompiles(bool SpeculateCompiles) {
+    this->impl().SpeculateCompiles = SpeculateCompiles;
+    return this->impl();
+  }
 };
 
 /// Constructs LLLazyJIT instances.
@@ -74,12 +74,24 @@ public:
         std::move(NotifyResolved));
   }
 
+  /// Called when a call-through is first executed, before it looks up the
+  /// symbol it calls through to.
+  using NotifyLookupFunction = std::function<void(
+      JITDylib &SourceJD, const SymbolStringPtr &SymbolName)>;
+
   // Return a free call-through trampoline and bind it to look up and call
   // through to the given symbol.
   Expected<JITTargetAddress> getCallThroughTrampoline(
       JITDylib &SourceJD, SymbolStringPtr SymbolName,
       std::shared_ptr<NotifyResolvedFunction> NotifyResolved);
 
+  /// Set the function to call when a call-through is executed, e.g. to start
+  /// compiling the likely callees of its target (see Speculator). This must
+  /// be set before any call-through is executed.
+  void setNotifyLookup(NotifyLookupFunction NotifyLookup) {
+    this->NotifyLookup = std::move(NotifyLookup);
+  }
+
 protected:
   LazyCallThroughManager(ExecutionSession &ES,
                          JITTargetAddress ErrorHandlerAddr,
@@ -104,6 +116,7 @@ private:
   std::unique_ptr<TrampolinePool> TP;
   ReexportsMap Reexports;
   NotifiersMap Notifiers;
+  NotifyLookupFunction NotifyLookup;
 };
 
 /// A lazy call-through manager that builds trampolines in the current process.
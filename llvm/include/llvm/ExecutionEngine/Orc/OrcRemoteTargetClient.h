@@ -110,41 +110,43 @@ public:
                                 uintptr_t RWDataSize,
                                 uint32_t RWDataAlign) override {
       Unmapped.push_back(ObjectAllocs());
-
-      LLVM_DEBUG(dbgs() << "Allocator " << Id << " reserved:\n");
-
-      if (CodeSize != 0) {
-        Unmapped.back().RemoteCodeAddr =
-            Client.reserveMem(Id, CodeSize, CodeAlign);
-
-        LLVM_DEBUG(
-            dbgs() << "  code: "
-                   << format("0x%016" PRIx64, Unmapped.back().RemoteCodeAddr)
-                   << " (" << CodeSize << " bytes, alignment " << CodeAlign
-                   << ")\n");
-      }
-
-      if (RODataSize != 0) {
-        Unmapped.back().RemoteRODataAddr =
-            Client.reserveMem(Id, RODataSize, RODataAlign);
-
-        LLVM_DEBUG(
-            dbgs() << "  ro-data: "
-                   << format("0x%016" PRIx64, Unmapped.back().RemoteRODataAddr)
-                   << " (" << RODataSize << " bytes, alignment " << RODataAlign
-                   << ")\n");
-      }
-
-      if (RWDataSize != 0) {
-        Unmapped.back().RemoteRWDataAddr =
-            Client.reserveMem(Id, RWDataSize, RWDataAlign);
-
-        LLVM_DEBUG(
-            dbgs() << "  rw-data: "
-                   << format("0x%016" PRIx64, Unmapped.back().RemoteRWDataAddr)
-                   << " (" << RWDataSize << " bytes, alignment " << RWDataAlign
-                   << ")\n");
-      }
+      auto &ObjAllocs = Unmapped.back();
+
+      // Reserve all non-empty segments in a single round trip.
+      std::vector<std::tuple<uint64_t, uint32_t>> Requests;
+      std::vector<JITTargetAddress *> RemoteAddrs;
+      auto AddRequest = [&](uintptr_t Size, uint32_t Align,
+                            JITTargetAddress &RemoteAddr) {
+        if (Size == 0)
+          return;
+        Requests.push_back(std::make_tuple(Size, Align));
+        RemoteAddrs.push_back(&RemoteAddr);
+      };
+      AddRequest(CodeSize, CodeAlign, ObjAllocs.RemoteCodeAddr);
+      AddRequest(RODataSize, RODataAlign, ObjAllocs.RemoteRODataAddr);
+      AddRequest(RWDataSize, RWDataAlign, ObjAllocs.RemoteRWDataAddr);
+
+      if (Requests.empty())
+        return;
+
+      auto Addrs = Client.reserveMemBlocks(Id, Requests);
+      for (unsigned I = 0; I != Addrs.size(); ++I)
+        *RemoteAddrs[I] = Addrs[I];
+
+      LLVM_DEBUG({
+        dbgs() << "Allocator " << Id << " reserved:\n";
+        auto PrintSegment = [](const char *Name, JITTargetAddress Addr,
+                               uintptr_t Size, uint32_t Align) {
+          if (Size != 0)
+            dbgs() << "  " << Name << ": " << format("0x%016" PRIx64, Addr)
+                   << " (" << Size << " bytes, alignment " << Align << ")\n";
+        };
+        PrintSegment("code", ObjAllocs.RemoteCodeAddr, CodeSize, CodeAlign);
+        PrintSegment("ro-data", ObjAllocs.RemoteRODataAddr, RODataSize,
+                     RODataAlign);
+        PrintSegment("rw-data", ObjAllocs.RemoteRWDataAddr, RWDataSize,
+                     RWDataAlign);
+      });
     }
 
     bool needsToReserveAllocationSpace() override { return true; }
@@ -179,33 +181,39 @@ public:
     bool finalizeMemory(std::string *ErrMsg = nullptr) override {
       LLVM_DEBUG(dbgs() << "Allocator " << Id << " finalizing:\n");
 
+      // Copy every section, set the segment protections and register the EH
+      // frames of all pending objects in a single round trip.
+      std::vector<DirectBufferWriter> Writes;
+      std::vector<std::tuple<JITTargetAddress, uint32_t>> Prots;
       for (auto &ObjAllocs : Unfinalized) {
-        if (copyAndProtect(ObjAllocs.CodeAllocs, ObjAllocs.RemoteCodeAddr,
-                           sys::Memory::MF_READ | sys::Memory::MF_EXEC))
-          return true;
-
-        if (copyAndProtect(ObjAllocs.RODataAllocs, ObjAllocs.RemoteRODataAddr,
-                           sys::Memory::MF_READ))
-          return true;
-
-        if (copyAndProtect(ObjAllocs.RWDataAllocs, ObjAllocs.RemoteRWDataAddr,
-                           sys::Memory::MF_READ | sys::Memory::MF_WRITE))
-          return true;
+        addSegment(Writes, Prots, ObjAllocs.CodeAllocs,
+                   ObjAllocs.RemoteCodeAddr,
+                   sys::Memory::MF_READ | sys::Memory::MF_EXEC);
+        addSegment(Writes, Prots, ObjAllocs.RODataAllocs,
+                   ObjAllocs.RemoteRODataAddr, sys::Memory::MF_READ);
+        addSegment(Writes, Prots, ObjAllocs.RWDataAllocs,
+                   ObjAllocs.RemoteRWDataAddr,
+                   sys::Memory::MF_READ | sys::Memory::MF_WRITE);
       }
-      Unfinalized.clear();
 
-      for (auto &EHFrame : UnfinalizedEHFrames) {
-        if (auto Err = Client.registerEHFrames(EHFrame.Addr, EHFrame.Size)) {
-          // FIXME: Replace this once finalizeMemory can return an Error.
-          handleAllErrors(std::move(Err), [&](ErrorInfoBase &EIB) {
-            if (ErrMsg) {
-              raw_string_ostream ErrOut(*ErrMsg);
-              EIB.log(ErrOut);
-            }
-          });
-          return false;
-        }
+      std::vector<std::tuple<JITTargetAddress, uint32_t>> EHFrames;
+      for (auto &EHFrame : UnfinalizedEHFrames)
+        EHFrames.push_back(std::make_tuple(
+            EHFrame.Addr, static_cast<uint32_t>(EHFrame.Size)));
+
+      if (auto Err = Client.finalizeMem(Id, Writes, Prots, EHFrames)) {
+        // FIXME: Replace this once finalizeMemory can return an Error.
+        handleAllErrors(std::move(Err), [&](ErrorInfoBase &EIB) {
+          if (ErrMsg) {
+            raw_string_ostream ErrOut(*ErrMsg);
+            EIB.log(ErrOut);
+          }
+        });
+        return true;
       }
+
+      // The local copies of the section contents are no longer needed.
+      Unfinalized.clear();
       RegisteredEHFrames = std::move(UnfinalizedEHFrames);
       UnfinalizedEHFrames = {};
 
@@ -283,11 +291,12 @@ public:
       }
     }
 
-    // Copies data for each alloc in the list, then set permissions on the
-    // segment.
-    bool copyAndProtect(const std::vector<Alloc> &Allocs,
-                        JITTargetAddress RemoteSegmentAddr,
-                        unsigned Permissions) {
+    // Queues a write for each alloc in the list, then the permissions for
+    // the segment.
+    void addSegment(std::vector<DirectBufferWriter> &Writes,
+                    std::vector<std::tuple<JITTargetAddress, uint32_t>> &Prots,
+                    const std::vector<Alloc> &Allocs,
+                    JITTargetAddress RemoteSegmentAddr, unsigned Permissions) {
       if (RemoteSegmentAddr) {
         assert(!Allocs.empty() && "No sections in allocated segment");
 
@@ -297,10 +306,9 @@ public:
                             << " -> "
                             << format("0x%016" PRIx64, Alloc.getRemoteAddress())
                             << " (" << Alloc.getSize() << " bytes)\n";);
-
-          if (Client.writeMem(Alloc.getRemoteAddress(), Alloc.getLocalAddress(),
-                              Alloc.getSize()))
-            return true;
+          Writes.push_back(DirectBufferWriter(Alloc.getLocalAddress(),
+                                              Alloc.getRemoteAddress(),
+                                              Alloc.getSize()));
         }
 
         LLVM_DEBUG(dbgs() << "  setting "
@@ -310,10 +318,8 @@ public:
                           << " permissions on block: "
                           << format("0x%016" PRIx64, RemoteSegmentAddr)
                           << "\n");
-        if (Client.setProtections(Id, RemoteSegmentAddr, Permissions))
-          return true;
+        Prots.push_back(std::make_tuple(RemoteSegmentAddr, Permissions));
       }
-      return false;
     }
 
     OrcRemoteTargetClient &Client;
@@ -577,6 +583,14 @@ public:
     return callB<utils::GetSymbolAddress>(Name);
   }
 
+  /// Search for several symbols in the remote process with a single call.
+  /// The result holds the address of each symbol (or zero, if it was not
+  /// found) in the same order as Names.
+  Expected<std::vector<JITTargetAddress>>
+  getSymbolAddresses(const std::vector<std::string> &Names) {
+    return callB<utils::GetSymbolAddresses>(Names);
+  }
+
   /// Get the triple for the remote target.
   const std::string &getTargetTriple() const { return RemoteTargetTriple; }
 
@@ -605,7 +619,7 @@ private:
   }
 
   void deregisterEHFrames(JITTargetAddress Addr, uint32_t Size) {
-    if (auto Err = callB<eh::RegisterEHFrames>(Addr, Size))
+    if (auto Err = callB<eh::DeregisterEHFrames>(Addr, Size))
       ES.reportError(std::move(Err));
   }
 
@@ -644,38 +658,25 @@ private:
     return callB<mem::ReadMem>(Src, Size);
   }
 
-  Error registerEHFrames(JITTargetAddress &RAddr, uint32_t Size) {
-    // FIXME: Duplicate error and report it via ReportError too?
-    return callB<eh::RegisterEHFrames>(RAddr, Size);
+  Error finalizeMem(
+      ResourceIdMgr::ResourceId Id,
+      const std::vector<DirectBufferWriter> &Writes,
+      const std::vector<std::tuple<JITTargetAddress, uint32_t>> &Prots,
+      const std::vector<std::tuple<JITTargetAddress, uint32_t>> &EHFrames) {
+    return callB<mem::FinalizeMem>(Id, Writes, Prots, EHFrames);
   }
 
-  JITTargetAddress reserveMem(ResourceIdMgr::ResourceId Id, uint64_t Size,
-                              uint32_t Align) {
-    if (auto AddrOrErr = callB<mem::ReserveMem>(Id, Size, Align))
-      return *AddrOrErr;
+  std::vector<JITTargetAddress> reserveMemBlocks(
+      ResourceIdMgr::ResourceId Id,
+      const std::vector<std::tuple<uint64_t, uint32_t>> &Requests) {
+    if (auto AddrsOrErr = callB<mem::ReserveMemBlocks>(Id, Requests))
+      return std::move(*AddrsOrErr);
     else {
-      ES.reportError(AddrOrErr.takeError());
-      return 0;
+      ES.reportError(AddrsOrErr.takeError());
+      return std::vector<JITTargetAddress>(Requests.size(), 0);
     }
   }
 
-  bool setProtections(ResourceIdMgr::ResourceId Id,
-                      JITTargetAddress RemoteSegAddr, unsigned ProtFlags) {
-    if (auto Err = callB<mem::SetProtections>(Id, RemoteSegAddr, ProtFlags)) {
-      ES.reportError(std::move(Err));
-      return true;
-    } else
-      return false;
-  }
-
-  bool writeMem(JITTargetAddress Addr, const char *Src, uint64_t Size) {
-    if (auto Err = callB<mem::WriteMem>(DirectBufferWriter(Src, Addr, Size))) {
-      ES.reportError(std::move(Err));
-      return true;
-    } else
-      return false;
-  }
-
   Error writePointer(JITTargetAddress Addr, JITTargetAddress PtrVal) {
     return callB<mem::WritePtr>(Addr, PtrVal);
   }
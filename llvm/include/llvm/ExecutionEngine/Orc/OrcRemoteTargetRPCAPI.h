@@ -274,6 +274,34 @@ namespace mem {
     static const char *getName() { return "WritePtr"; }
   };
 
+  /// Reserve several blocks of memory on the remote via the given allocator.
+  /// Each request is a (Size, Align) pair. The result holds the address of
+  /// each block, in request order.
+  class ReserveMemBlocks
+      : public rpc::Function<
+            ReserveMemBlocks,
+            std::vector<JITTargetAddress>(
+                ResourceIdMgr::ResourceId AllocID,
+                std::vector<std::tuple<uint64_t, uint32_t>> Requests)> {
+  public:
+    static const char *getName() { return "ReserveMemBlocks"; }
+  };
+
+  /// Finalize a batch of memory in one call: write the given blocks, then
+  /// apply the (Addr, ProtFlags) protections and register the (Addr, Size)
+  /// EH frames.
+  class FinalizeMem
+      : public rpc::Function<
+            FinalizeMem,
+            void(ResourceIdMgr::ResourceId AllocID,
+                 std::vector<remote::DirectBufferWriter> Writes,
+                 std::vector<std::tuple<JITTargetAddress, uint32_t>> Prots,
+                 std::vector<std::tuple<JITTargetAddress, uint32_t>>
+                     EHFrames)> {
+  public:
+    static const char *getName() { return "FinalizeMem"; }
+  };
+
 } // end namespace mem
 
 /// RPC functions for remote stub and trampoline management.
@@ -343,6 +371,15 @@ namespace utils {
     static const char *getName() { return "GetSymbolAddress"; }
   };
 
+  /// Get the addresses of several remote symbols, in request order.
+  class GetSymbolAddresses
+      : public rpc::Function<GetSymbolAddresses,
+                             std::vector<JITTargetAddress>(
+                                 std::vector<std::string> SymbolNames)> {
+  public:
+    static const char *getName() { return "GetSymbolAddresses"; }
+  };
+
   /// Request that the host execute a compile callback.
   class RequestCompile
       : public rpc::Function<
@@ -73,6 +73,8 @@ public:
     addHandler<mem::SetProtections>(*this, &ThisT::handleSetProtections);
     addHandler<mem::WriteMem>(*this, &ThisT::handleWriteMem);
     addHandler<mem::WritePtr>(*this, &ThisT::handleWritePtr);
+    addHandler<mem::ReserveMemBlocks>(*this, &ThisT::handleReserveMemBlocks);
+    addHandler<mem::FinalizeMem>(*this, &ThisT::handleFinalizeMem);
     addHandler<eh::RegisterEHFrames>(*this, &ThisT::handleRegisterEHFrames);
     addHandler<eh::DeregisterEHFrames>(*this, &ThisT::handleDeregisterEHFrames);
     addHandler<stubs::CreateIndirectStubsOwner>(
@@ -86,6 +88,8 @@ public:
     addHandler<stubs::EmitTrampolineBlock>(*this,
                                            &ThisT::handleEmitTrampolineBlock);
     addHandler<utils::GetSymbolAddress>(*this, &ThisT::handleGetSymbolAddress);
+    addHandler<utils::GetSymbolAddresses>(*this,
+                                          &ThisT::handleGetSymbolAddresses);
     addHandler<utils::GetRemoteInfo>(*this, &ThisT::handleGetRemoteInfo);
     addHandler<utils::TerminateSession>(*this, &ThisT::handleTerminateSession);
   }
@@ -331,6 +335,19 @@ private:
     return Addr;
   }
 
+  Expected<std::vector<JITTargetAddress>>
+  handleGetSymbolAddresses(const std::vector<std::string> &Names) {
+    std::vector<JITTargetAddress> Addrs;
+    Addrs.reserve(Names.size());
+    for (auto &Name : Names) {
+      if (auto AddrOrErr = handleGetSymbolAddress(Name))
+        Addrs.push_back(*AddrOrErr);
+      else
+        return AddrOrErr.takeError();
+    }
+    return Addrs;
+  }
+
   Expected<std::tuple<std::string, uint32_t, uint32_t, uint32_t, uint32_t>>
   handleGetRemoteInfo() {
     std::string ProcessTriple = sys::getProcessTriple();
@@ -394,6 +411,40 @@ private:
     return AllocAddr;
   }
 
+  Expected<std::vector<JITTargetAddress>>
+  handleReserveMemBlocks(ResourceIdMgr::ResourceId Id,
+                         std::vector<std::tuple<uint64_t, uint32_t>> Requests) {
+    std::vector<JITTargetAddress> Addrs;
+    Addrs.reserve(Requests.size());
+    for (auto &R : Requests) {
+      if (auto AddrOrErr = handleReserveMem(Id, std::get<0>(R), std::get<1>(R)))
+        Addrs.push_back(*AddrOrErr);
+      else
+        return AddrOrErr.takeError();
+    }
+    return Addrs;
+  }
+
+  Error handleFinalizeMem(
+      ResourceIdMgr::ResourceId Id, std::vector<DirectBufferWriter> Writes,
+      std::vector<std::tuple<JITTargetAddress, uint32_t>> Prots,
+      std::vector<std::tuple<JITTargetAddress, uint32_t>> EHFrames) {
+    // Like WriteMem, the block contents were copied into place while the
+    // arguments were deserialized.
+    LLVM_DEBUG({
+      for (auto &DBW : Writes)
+        dbgs() << "  Wrote " << DBW.getSize() << " bytes to "
+               << format("0x%016x", DBW.getDst()) << "\n";
+    });
+    for (auto &P : Prots)
+      if (auto Err = handleSetProtections(Id, std::get<0>(P), std::get<1>(P)))
+        return Err;
+    for (auto &F : EHFrames)
+      if (auto Err = handleRegisterEHFrames(std::get<0>(F), std::get<1>(F)))
+        return Err;
+    return Error::success();
+  }
+
   Error handleSetProtections(ResourceIdMgr::ResourceId Id,
                              JITTargetAddress Addr, uint32_t Flags) {
     auto I = Allocators.find(Id);
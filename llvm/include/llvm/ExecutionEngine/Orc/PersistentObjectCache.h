@@ -0,0 +1,94 @@
+//===- PersistentObjectCache.h - On-disk cache of JIT'd objects -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// An ObjectCache that stores the objects compiled by a JIT in a directory, so
+// that later runs of the same process can link them instead of compiling the
+// same IR again.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+#define LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/Error.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+namespace llvm {
+
+class TargetMachine;
+
+namespace orc {
+
+/// An ObjectCache backed by a directory.
+///
+/// Entries are keyed on the SHA1 of the module's bitcode together with the
+/// target configuration it is compiled for (triple, CPU, features, the
+/// TargetOptions that affect code generation, relocation and code model, and
+/// optimization level), so a cache directory can be shared between JITs with
+/// different configurations. Entries are written atomically and can be
+/// pruned with a CachePruningPolicy: a cache directory may be used by several
+/// processes at once.
+///
+/// The same instance can be shared by the compilers of a multi-threaded JIT.
+class PersistentObjectCache : public ObjectCache {
+public:
+  /// Creates a cache that stores its entries in CacheDir, creating the
+  /// directory if needed, for objects compiled with the TargetMachines built
+  /// by JTMB. CacheDir is pruned with Policy on creation, and again by each
+  /// call to prune.
+  static Expected<std::unique_ptr<PersistentObjectCache>>
+  Create(StringRef CacheDir, JITTargetMachineBuilder JTMB,
+         CachePruningPolicy Policy = CachePruningPolicy());
+
+  /// Returns a key that identifies the code generated by TM.
+  static std::string getTargetKey(const TargetMachine &TM);
+
+  std::unique_ptr<MemoryBuffer> getObject(const Module *M) override;
+
+  void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override;
+
+  /// Prunes the cache directory with the policy it was created with. Returns
+  /// true if pruning occurred.
+  bool prune();
+
+  /// The number of objects returned from, and added to, the cache so far.
+  unsigned getNumHits() const { return NumHits; }
+  unsigned getNumStores() const { return NumStores; }
+
+private:
+  PersistentObjectCache(std::string CacheDir, std::string TargetKey,
+                        CachePruningPolicy Policy)
+      : CacheDir(std::move(CacheDir)), TargetKey(std::move(TargetKey)),
+        Policy(std::move(Policy)) {}
+
+  std::string getModuleKey(const Module &M) const;
+  std::string getEntryPath(StringRef Key) const;
+
+  std::string CacheDir;
+  std::string TargetKey;
+  CachePruningPolicy Policy;
+
+  // Code generation may change the module, so the key computed by getObject
+  // is kept for notifyObjectCompiled.
+  std::mutex KeysMutex;
+  DenseMap<const Module *, std::string> PendingKeys;
+  std::atomic<unsigned> NumHits{0};
+  std::atomic<unsigned> NumStores{0};
+};
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
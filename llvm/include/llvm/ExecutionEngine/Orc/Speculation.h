@@ -0,0 +1,113 @@
+//===-- Speculation.h - Compile likely callees ahead of use -----*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Speculative compilation: when a lazily compiled function is first called,
+// look up the functions it is likely to call so that they are compiled in the
+// background before they are needed.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_SPECULATION_H
+#define LLVM_EXECUTIONENGINE_ORC_SPECULATION_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ExecutionEngine/Orc/Core.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+namespace llvm {
+
+class Module;
+
+namespace orc {
+
+/// Issues background lookups for the likely callees of functions as they are
+/// first called.
+///
+/// Clients register, per JITDylib, the ranked candidates of each function (see
+/// findLikelyCallees), then call speculateFor when a function is entered. The
+/// candidates are queued by priority and looked up at most MaxInFlight at a
+/// time, so speculation only makes progress in the background if the
+/// ExecutionSession dispatches materialization to other threads. Candidates
+/// that are requested on demand before their turn are dropped from the queue.
+class Speculator {
+public:
+  /// A likely callee and its priority: higher values are looked up first.
+  struct Candidate {
+    SymbolStringPtr Name;
+    uint64_t Priority;
+  };
+
+  using CandidateList = std::vector<Candidate>;
+  using CandidateMap = DenseMap<SymbolStringPtr, CandidateList>;
+
+  /// Returns, for each function defined and exported by M, up to
+  /// MaxCandidates of the exported functions of M that it calls directly.
+  /// Candidates are ranked by the callee's profile entry count if it has one,
+  /// otherwise by the number of call sites.
+  static CandidateMap findLikelyCallees(Module &M, MangleAndInterner &Mangle,
+                                        unsigned MaxCandidates = 8);
+
+  Speculator(ExecutionSession &ES, unsigned MaxInFlight);
+
+  /// Drops all queued lookups and waits for the ones in flight to complete.
+  ~Speculator();
+
+  /// Adds the candidates of the functions defined in JD.
+  void registerCandidates(JITDylib &JD, CandidateMap Candidates);
+
+  /// Notes that Name in JD is being requested, and queues lookups of its
+  /// candidates that have not been requested yet.
+  void speculateFor(JITDylib &JD, const SymbolStringPtr &Name);
+
+  /// Drops all queued lookups. Lookups already in flight are not affected.
+  void cancelPending();
+
+private:
+  struct PendingLookup {
+    uint64_t Priority;
+    uint64_t Seq;
+    JITDylib *JD;
+    SymbolStringPtr Name;
+
+    // Highest priority first, then first queued.
+    bool operator<(const PendingLookup &Other) const {
+      if (Priority != Other.Priority)
+        return Priority < Other.Priority;
+      return Seq > Other.Seq;
+    }
+  };
+
+  using SymbolKey = std::pair<JITDylib *, SymbolStringPtr>;
+
+  bool popNext(PendingLookup &Next);
+  void issueLookups();
+  void issueLookup(const PendingLookup &L);
+  void lookupComplete();
+
+  ExecutionSession &ES;
+  unsigned MaxInFlight;
+
+  std::mutex SpeculatorMutex;
+  std::condition_variable InFlightCV;
+  DenseMap<JITDylib *, CandidateMap> Candidates;
+  DenseSet<SymbolKey> Requested;
+  DenseSet<SymbolKey> Queued;
+  std::priority_queue<PendingLookup> Queue;
+  uint64_t NextSeq = 0;
+  unsigned InFlight = 0;
+};
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_SPECULATION_H
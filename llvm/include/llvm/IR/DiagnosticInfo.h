@@ -465,9 +465,11 @@ public:
   virtual bool isEnabled() const = 0;
 
   StringRef getPassName() const { return PassName; }
+  StringRef getRemarkName() const { return RemarkName; }
   std::string getMsg() const;
   Optional<uint64_t> getHotness() const { return Hotness; }
   void setHotness(Optional<uint64_t> H) { Hotness = H; }
+  ArrayRef<Argument> getArgs() const { return Args; }
 
   bool isVerbose() const { return IsVerbose; }
 
@@ -0,0 +1,82 @@
+//===- IRMemoryUsage.h - Account for the memory used by IR ------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// This file defines IRMemoryUsage, which estimates how much heap memory the
+/// IR of a module occupies, broken down by the kind of object: each
+/// Instruction subclass, operand lists, basic blocks, globals, value names and
+/// metadata attachments, plus the constants and uniqued metadata owned by the
+/// LLVMContext. It is meant to find out where memory goes in very large
+/// modules (e.g. after full LTO linking) and to measure changes to the size of
+/// IR objects.
+///
+/// The numbers are the sizes of the objects themselves and the memory
+/// allocated alongside them; they do not include malloc overhead or capacity
+/// reserved but not in use (e.g. for hung-off operands), so they are a lower
+/// bound.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_IR_IRMEMORYUSAGE_H
+#define LLVM_IR_IRMEMORYUSAGE_H
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/PassManager.h"
+#include <cstdint>
+
+namespace llvm {
+class Module;
+class raw_ostream;
+class User;
+
+class IRMemoryUsage {
+public:
+  struct Entry {
+    uint64_t Count = 0;
+    uint64_t Bytes = 0;
+  };
+
+  /// Account for the IR of \p M. The context-owned objects are included if
+  /// \p IncludeContext is true; they are shared by all modules in the context.
+  explicit IRMemoryUsage(const Module &M, bool IncludeContext = true);
+
+  /// Return the entry for objects of kind \p Kind, e.g. "LoadInst" or
+  /// "Use (co-allocated)", which is empty if there are none.
+  Entry lookup(StringRef Kind) const { return Entries.lookup(Kind); }
+
+  const StringMap<Entry> &getEntries() const { return Entries; }
+
+  uint64_t getTotalBytes() const;
+
+  /// Print a table of all entries, largest first.
+  void print(raw_ostream &OS) const;
+
+private:
+  void add(StringRef Kind, uint64_t Count, uint64_t Bytes);
+  void addOperands(const User &U);
+  void addModule(const Module &M);
+  void addContext(const Module &M);
+
+  StringMap<Entry> Entries;
+};
+
+/// Print the IRMemoryUsage of the module to the given stream.
+class IRMemoryUsagePrinterPass
+    : public PassInfoMixin<IRMemoryUsagePrinterPass> {
+  raw_ostream &OS;
+
+public:
+  explicit IRMemoryUsagePrinterPass(raw_ostream &OS) : OS(OS) {}
+
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &);
+};
+
+} // end namespace llvm
+
+#endif // LLVM_IR_IRMEMORYUSAGE_H
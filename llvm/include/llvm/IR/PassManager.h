@@ -1278,6 +1278,14 @@ using ModuleAnalysisManagerFunctionProxy =
 /// Note that although function passes can access module analyses, module
 /// analyses are not invalidated while the function passes are running, so they
 /// may be stale.  Function analyses will not be stale.
+///
+/// The functions are visited one at a time, on the calling thread. Even a pass
+/// that follows the rules above creates constants, types and metadata, which
+/// are uniqued in unsynchronized tables of the LLVMContext, and updates the
+/// use lists of the globals it references. So function passes can't run on
+/// several functions of a module in parallel. Parallelism requires a context
+/// per thread instead, see SplitModule() and splitCodeGen() for how code
+/// generation does it.
 template <typename FunctionPassT>
 class ModuleToFunctionPassAdaptor
     : public PassInfoMixin<ModuleToFunctionPassAdaptor<FunctionPassT>> {
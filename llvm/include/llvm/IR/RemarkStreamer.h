@@ -14,6 +14,8 @@
 #define LLVM_IR_REMARKSTREAMER_H
 
 #include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/Remarks/RemarkFormat.h"
+#include "llvm/Remarks/RemarkSerializer.h"
 #include "llvm/Remarks/RemarkStringTable.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/Regex.h"
@@ -35,13 +37,18 @@ class RemarkStreamer {
   /// The YAML streamer.
   yaml::Output YAMLOutput;
 
+  /// The serializer used for the formats that are not emitted through the
+  /// YAML streamer. The remarks are written as they are emitted.
+  std::unique_ptr<remarks::Serializer> Serializer;
+
   /// The string table containing all the unique strings used in the output.
   /// The table will be serialized in a section to be consumed after the
   /// compilation.
   remarks::StringTable StrTab;
 
 public:
-  RemarkStreamer(StringRef Filename, raw_ostream& OS);
+  RemarkStreamer(StringRef Filename, raw_ostream &OS,
+                 remarks::Format Format = remarks::Format::YAML);
   /// Return the filename that the remark diagnostics are emitted to.
   StringRef getFilename() const { return Filename; }
   /// Return stream that the remark diagnostics are emitted to.
@@ -14,7 +14,10 @@
 #ifndef LLVM_LTO_CACHING_H
 #define LLVM_LTO_CACHING_H
 
+#include "llvm/ADT/Optional.h"
 #include "llvm/LTO/LTO.h"
+#include "llvm/Support/Compression.h"
+#include <memory>
 #include <string>
 
 namespace llvm {
@@ -27,11 +30,46 @@ namespace lto {
 using AddBufferFn =
     std::function<void(unsigned Task, std::unique_ptr<MemoryBuffer> MB)>;
 
+/// A second cache tier behind a local cache, e.g. a cache that is shared by
+/// many build machines. The local cache looks entries up in it on a miss, and
+/// stores the entries it creates in it. Entries are opaque blobs; they are
+/// compressed if the local cache compresses its entries.
+///
+/// Implementations must be thread safe.
+class CacheTier {
+public:
+  virtual ~CacheTier() = default;
+
+  /// Returns the entry stored under \p Key, or nullptr if there is none.
+  virtual std::unique_ptr<MemoryBuffer> get(StringRef Key) = 0;
+
+  /// Stores \p Data under \p Key. As the tier is only an optimization,
+  /// failures are ignored.
+  virtual void put(StringRef Key, StringRef Data) = 0;
+};
+
+/// Returns a CacheTier that stores its entries as files in the directory
+/// \p Path, which is created if it doesn't exist, e.g. a directory on a
+/// network file system. It uses the same file names as localCache(), so it
+/// can be pruned with pruneCache().
+Expected<std::unique_ptr<CacheTier>> createDirectoryCacheTier(StringRef Path);
+
+struct LocalCacheOptions {
+  /// If set, new entries are compressed with this format, which must be
+  /// available. Compressed and uncompressed entries can be read either way.
+  Optional<compression::Format> Compression;
+
+  /// If set, entries that are missing from the local cache are looked up in
+  /// this tier, and new entries are also stored in it.
+  std::shared_ptr<CacheTier> SecondTier;
+};
+
 /// Create a local file system cache which uses the given cache directory and
 /// file callback. This function also creates the cache directory if it does not
 /// already exist.
-Expected<NativeObjectCache> localCache(StringRef CacheDirectoryPath,
-                                       AddBufferFn AddBuffer);
+Expected<NativeObjectCache>
+localCache(StringRef CacheDirectoryPath, AddBufferFn AddBuffer,
+           LocalCacheOptions Options = LocalCacheOptions());
 
 } // namespace lto
 } // namespace llvm
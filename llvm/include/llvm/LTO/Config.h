@@ -108,6 +108,19 @@ struct Config {
   /// Statistics output file path.
   std::string StatsFile;
 
+  /// If this field is set, the thin link reuses the import lists recorded in
+  /// this file by a previous link for the modules whose inputs did not change,
+  /// and records its own import lists in it.
+  std::string ThinLTOImportStateFile;
+
+  /// If this field is nonzero, code generation of a ThinLTO module whose
+  /// functions have at least twice this many IR instructions according to the
+  /// summary is split into partitions of about this size, but into no more
+  /// than ThinLTOSplitCodeGenMaxPartitions, which are code generated in
+  /// parallel. Only the in-process backend splits modules.
+  unsigned ThinLTOSplitCodeGenThreshold = 0;
+  unsigned ThinLTOSplitCodeGenMaxPartitions = 8;
+
   bool ShouldDiscardValueNames = true;
   DiagnosticHandlerFunction DiagHandler;
 
@@ -34,6 +34,7 @@ namespace llvm {
 class BitcodeModule;
 class Error;
 class LLVMContext;
+class MemoryBuffer;
 class MemoryBufferRef;
 class Module;
 class Target;
@@ -223,8 +224,13 @@ using ThinBackend = std::function<std::unique_ptr<ThinBackendProc>(
     StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
     AddStreamFn AddStream, NativeObjectCache Cache)>;
 
-/// This ThinBackend runs the individual backend jobs in-process.
-ThinBackend createInProcessThinBackend(unsigned ParallelismLevel);
+/// This ThinBackend runs the individual backend jobs in-process, on up to
+/// \p ParallelismLevel threads, starting with the modules that are estimated
+/// to be the largest. If \p MemoryBudget is nonzero, fewer jobs are run at
+/// once where needed to keep their estimated peak memory, derived from the
+/// instruction counts in the summary, under that many bytes.
+ThinBackend createInProcessThinBackend(unsigned ParallelismLevel,
+                                       uint64_t MemoryBudget = 0);
 
 /// This ThinBackend writes individual module indexes to files, instead of
 /// running the individual backend jobs. This backend is for distributed builds
@@ -246,6 +252,77 @@ ThinBackend createWriteIndexesThinBackend(std::string OldPrefix,
                                           raw_fd_ostream *LinkedObjectsFile,
                                           IndexWriteCallback OnWrite);
 
+/// A ThinLTO backend job that is run outside of the linker process by a
+/// ThinBackendExecutor.
+struct ThinBackendJob {
+  /// The task whose native object the job produces.
+  unsigned Task;
+  /// The identifier of the module to compile. Like with
+  /// createWriteIndexesThinBackend, this is the path of the bitcode file that
+  /// a worker reads.
+  std::string ModuleID;
+  /// The individual summary index for the module in bitcode format, i.e. the
+  /// contents of the ".thinlto.bc" file that createWriteIndexesThinBackend
+  /// would write for it.
+  std::string Index;
+  /// The identifiers of the modules that the job imports from.
+  std::vector<std::string> ImportedModules;
+  /// The key computed by computeLTOCacheKey for the job, or an empty string
+  /// if the module can't be cached. Jobs with equal keys produce the same
+  /// object, so executors can use the key to share results between links
+  /// and machines.
+  std::string CacheKey;
+};
+
+/// An interface for running ThinLTO backend jobs outside of the linker
+/// process, e.g. by sending them to remote build workers.
+class ThinBackendExecutor {
+public:
+  using DoneFn =
+      std::function<void(Expected<std::unique_ptr<MemoryBuffer>> Object)>;
+
+  virtual ~ThinBackendExecutor() = default;
+
+  /// Starts running \p Job. \p Done must be called exactly once with the
+  /// native object file or an error when the job finishes. It may be called
+  /// from any thread, and several calls may run at once.
+  virtual void execute(ThinBackendJob Job, DoneFn Done) = 0;
+
+  /// Blocks until all jobs have called their Done callback. Returns errors
+  /// that are not specific to a job.
+  virtual Error wait() = 0;
+};
+
+/// This ThinBackend hands the individual backend jobs to \p Executor, and
+/// adds the native objects it returns to the link. Jobs of modules that are
+/// in the native object cache are not executed.
+ThinBackend createExecutorThinBackend(
+    std::shared_ptr<ThinBackendExecutor> Executor);
+
+/// Returns an executor that runs an external program, e.g. a script that
+/// dispatches jobs to a build farm, once per job with at most
+/// \p Parallelism jobs at a time. The program is invoked as
+///
+///   <Program> <Args>... <module> <index> <imports> <output> <cache key>
+///
+/// where <module> is the module identifier, <index> and <imports> are
+/// temporary files holding the module's summary index and the list of
+/// modules it imports from, one per line, in the formats produced by
+/// createWriteIndexesThinBackend, and <output> is the path that the program
+/// must write the native object file to. <cache key> is empty if the module
+/// can't be cached.
+///
+/// As the jobs run in separate processes, a crashing job doesn't take the
+/// link down with it. A job that exits with a nonzero status or crashes is
+/// retried up to \p MaxRetries times before it is reported as an error. If
+/// \p StatsFile is set, the wall time, CPU time and peak memory usage of
+/// every attempt are written to it in JSON format when all jobs are done.
+std::unique_ptr<ThinBackendExecutor>
+createProcessThinBackendExecutor(std::string Program,
+                                 std::vector<std::string> Args,
+                                 unsigned Parallelism, unsigned MaxRetries = 0,
+                                 std::string StatsFile = "");
+
 /// This class implements a resolution-based interface to LLVM's LTO
 /// functionality. It supports regular LTO, parallel LTO code generation and
 /// ThinLTO. You can use it from a linker in the following way:
@@ -316,7 +393,8 @@ private:
     // This stores the information about a regular LTO module that we have added
     // to the link. It will either be linked immediately (for modules without
     // summaries) or after summary-based dead stripping (for modules with
-    // summaries).
+    // summaries). Until it is linked, the module's function bodies and
+    // metadata are not loaded.
     struct AddedModule {
       std::unique_ptr<Module> M;
       std::vector<GlobalValue *> Keep;
@@ -415,6 +493,11 @@ private:
 
   Error checkPartiallySplit();
 
+  /// Returns the number of partitions that code generation of each module in
+  /// ThinLTO.ModuleMap is split into, which is 1 for modules that are not
+  /// split.
+  std::vector<unsigned> getThinLTOCodeGenPartitions() const;
+
   mutable bool CalledGetMaxTasks = false;
 
   // Use Optional to distinguish false from not yet initialized.
@@ -39,12 +39,15 @@ Error backend(Config &C, AddStreamFn AddStream,
               unsigned ParallelCodeGenParallelismLevel,
               std::unique_ptr<Module> M, ModuleSummaryIndex &CombinedIndex);
 
-/// Runs a ThinLTO backend.
+/// Runs a ThinLTO backend. If \p ExtraTasks is not empty, code generation of
+/// the module is split into partitions that are written to \p Task and
+/// \p ExtraTasks and code generated in parallel.
 Error thinBackend(Config &C, unsigned Task, AddStreamFn AddStream, Module &M,
                   const ModuleSummaryIndex &CombinedIndex,
                   const FunctionImporter::ImportMapTy &ImportList,
                   const GVSummaryMapTy &DefinedGlobals,
-                  MapVector<StringRef, BitcodeModule> &ModuleMap);
+                  MapVector<StringRef, BitcodeModule> &ModuleMap,
+                  ArrayRef<unsigned> ExtraTasks = None);
 }
 }
 
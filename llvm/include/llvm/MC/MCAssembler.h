@@ -26,6 +26,7 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -154,6 +155,35 @@ private:
 
   VersionInfoType VersionInfo;
 
+public:
+  /// The worklist of the relaxation of a section.
+  struct SectionRelaxState {
+    /// A fragment which may still change size. Relaxing it only depends on
+    /// the sizes of the fragments with layout orders in [Lo, Hi].
+    struct Candidate {
+      MCFragment *F;
+      unsigned Lo, Hi;
+    };
+    /// The fragments which may still change size, in layout order.
+    std::vector<Candidate> Candidates;
+    /// The layout orders of the fragments whose size depends on their
+    /// offset, such as alignment.
+    std::vector<unsigned> OffsetDependent;
+    /// The layout orders of the fragments which changed size in the last
+    /// pass over the section.
+    std::vector<unsigned> Changed;
+    /// Set until the first pass, in which all candidates are looked at.
+    bool AllChanged = true;
+  };
+
+private:
+  /// The relaxation worklists, indexed by section layout order.
+  std::vector<SectionRelaxState> RelaxStates;
+
+  /// Serializes the code emitter when sections are relaxed concurrently, as
+  /// it may create expressions in the MCContext.
+  std::mutex EmitterMutex;
+
   /// Evaluate a fixup to a relocatable expression and the value which should be
   /// placed into the fixup.
   ///
@@ -190,6 +220,14 @@ private:
   /// if any offsets were adjusted.
   bool layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec);
 
+  /// Set up the relaxation worklists of all sections.
+  void initRelaxState(MCAsmLayout &Layout);
+
+  /// Relax the sections whose layout does not depend on other sections
+  /// concurrently, see -mc-parallel-relax. layoutOnce() still has to run
+  /// afterwards to converge the layout of the whole object.
+  void relaxIndependentSections(MCAsmLayout &Layout);
+
   bool relaxInstruction(MCAsmLayout &Layout, MCRelaxableFragment &IF);
 
   bool relaxPaddingFragment(MCAsmLayout &Layout, MCPaddingFragment &PF);
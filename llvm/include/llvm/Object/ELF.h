@@ -26,6 +26,7 @@
 #include <cstdint>
 #include <limits>
 #include <utility>
+#include <vector>
 
 namespace llvm {
 namespace object {
@@ -48,6 +49,35 @@ static inline Error createError(StringRef Err) {
   return make_error<StringError>(Err, object_error::parse_failed);
 }
 
+/// The symbols of a symbol table, decoded into one array per field. The
+/// fields of an Elf_Sym are stored in the byte order of the file and are
+/// converted on every access; clients that walk all the symbols of a large
+/// file, e.g. to build a symbol table of their own, can decode the table once
+/// with ELFFile::decodeSymbols and then iterate over these arrays instead.
+struct ELFSymbolArray {
+  /// The string table the name offsets refer to.
+  StringRef StrTab;
+  std::vector<uint32_t> NameOffsets;
+  std::vector<uint64_t> Values;
+  std::vector<uint64_t> Sizes;
+  std::vector<uint8_t> Infos;
+  std::vector<uint8_t> Others;
+  /// The st_shndx of each symbol, with SHN_XINDEX replaced by the index in
+  /// the SHT_SYMTAB_SHNDX section. The other reserved indices are kept.
+  std::vector<uint32_t> SectionIndexes;
+
+  size_t size() const { return Values.size(); }
+  bool empty() const { return Values.empty(); }
+
+  /// The name offsets are checked by decodeSymbols, so this cannot fail.
+  StringRef getName(size_t I) const {
+    return StringRef(StrTab.data() + NameOffsets[I]);
+  }
+  uint8_t getBinding(size_t I) const { return Infos[I] >> 4; }
+  uint8_t getType(size_t I) const { return Infos[I] & 0x0f; }
+  uint8_t getVisibility(size_t I) const { return Others[I] & 0x3; }
+};
+
 template <class ELFT>
 class ELFFile {
 public:
@@ -143,6 +173,10 @@ public:
     return getSectionContentsAsArray<Elf_Sym>(Sec);
   }
 
+  /// Decode all the symbols of the SHT_SYMTAB or SHT_DYNSYM section \p Sec,
+  /// looking up its string table and extended section index table once.
+  Expected<ELFSymbolArray> decodeSymbols(const Elf_Shdr &Sec) const;
+
   Expected<Elf_Rela_Range> relas(const Elf_Shdr *Sec) const {
     return getSectionContentsAsArray<Elf_Rela>(Sec);
   }
@@ -603,6 +637,67 @@ ELFFile<ELFT>::getStringTableForSymtab(const Elf_Shdr &Sec,
   return getStringTable(*SectionOrErr);
 }
 
+template <class ELFT>
+Expected<ELFSymbolArray>
+ELFFile<ELFT>::decodeSymbols(const Elf_Shdr &Sec) const {
+  auto SectionsOrErr = sections();
+  if (!SectionsOrErr)
+    return SectionsOrErr.takeError();
+  Elf_Shdr_Range Sections = *SectionsOrErr;
+
+  ELFSymbolArray Ret;
+  auto StrTabOrErr = getStringTableForSymtab(Sec, Sections);
+  if (!StrTabOrErr)
+    return StrTabOrErr.takeError();
+  Ret.StrTab = *StrTabOrErr;
+
+  auto SymsOrErr = symbols(&Sec);
+  if (!SymsOrErr)
+    return SymsOrErr.takeError();
+  Elf_Sym_Range Syms = *SymsOrErr;
+
+  ArrayRef<Elf_Word> ShndxTable;
+  uint32_t SecIndex = &Sec - Sections.begin();
+  for (const Elf_Shdr &S : Sections) {
+    if (S.sh_type != ELF::SHT_SYMTAB_SHNDX || S.sh_link != SecIndex)
+      continue;
+    auto ShndxOrErr = getSHNDXTable(S, Sections);
+    if (!ShndxOrErr)
+      return ShndxOrErr.takeError();
+    ShndxTable = *ShndxOrErr;
+    break;
+  }
+
+  size_t NumSyms = Syms.size();
+  Ret.NameOffsets.resize(NumSyms);
+  Ret.Values.resize(NumSyms);
+  Ret.Sizes.resize(NumSyms);
+  Ret.Infos.resize(NumSyms);
+  Ret.Others.resize(NumSyms);
+  Ret.SectionIndexes.resize(NumSyms);
+
+  for (size_t I = 0; I != NumSyms; ++I) {
+    const Elf_Sym &Sym = Syms[I];
+    uint32_t NameOffset = Sym.st_name;
+    if (NameOffset >= Ret.StrTab.size())
+      return createError("st_name is past the end of the string table");
+    uint32_t Shndx = Sym.st_shndx;
+    if (Shndx == ELF::SHN_XINDEX) {
+      if (I >= ShndxTable.size())
+        return createError("index past the end of the symbol table");
+      Shndx = ShndxTable[I];
+    }
+
+    Ret.NameOffsets[I] = NameOffset;
+    Ret.Values[I] = Sym.st_value;
+    Ret.Sizes[I] = Sym.st_size;
+    Ret.Infos[I] = Sym.st_info;
+    Ret.Others[I] = Sym.st_other;
+    Ret.SectionIndexes[I] = Shndx;
+  }
+  return std::move(Ret);
+}
+
 template <class ELFT>
 Expected<StringRef>
 ELFFile<ELFT>::getSectionName(const Elf_Shdr *Section) const {
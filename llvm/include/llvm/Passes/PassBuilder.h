@@ -21,6 +21,7 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Transforms/Instrumentation.h"
 #include "llvm/Transforms/Scalar/LoopPassManager.h"
+#include <memory>
 #include <vector>
 
 namespace llvm {
@@ -28,6 +29,7 @@ class StringRef;
 class AAManager;
 class TargetMachine;
 class ModuleSummaryIndex;
+class ReducedPipelinePolicy;
 
 /// A struct capturing PGO tunables.
 struct PGOOptions {
@@ -99,6 +101,24 @@ public:
   /// Tuning option to disable promotion to scalars in LICM with MemorySSA, if
   /// the number of access is too large.
   unsigned LicmMssaNoAccForPromotionCap;
+
+  /// Tuning option to skip the most expensive function passes (the later
+  /// InstCombine runs, GVN and the vectorizers) on functions with more IR
+  /// instructions than this, unless the profile says they are hot. 0 disables
+  /// it. Its default value is that of the flag:
+  /// `-reduced-pipeline-size-threshold`.
+  unsigned ReducedPipelineSizeThreshold;
+
+  /// Tuning option to skip the same passes on functions that the profile
+  /// summary says are cold. Its default value is that of the flag:
+  /// `-reduced-pipeline-for-cold`.
+  bool ReducedPipelineForColdFunctions;
+
+  /// Tuning option to skip the same passes on all functions that aren't hot,
+  /// once they took this many milliseconds in total for the module being
+  /// optimized. 0 disables it. Its default value is that of the flag:
+  /// `-reduced-pipeline-time-budget`.
+  unsigned ReducedPipelineTimeBudget;
 };
 
 /// This class provides access to building LLVM's passes.
@@ -112,6 +132,8 @@ class PassBuilder {
   PipelineTuningOptions PTO;
   Optional<PGOOptions> PGOOpt;
   PassInstrumentationCallbacks *PIC;
+  // Decides which functions get the reduced pipeline, set if PTO enables it.
+  std::shared_ptr<ReducedPipelinePolicy> ReducedPipeline;
 
 public:
   /// A struct to capture parsed pass pipeline names.
@@ -229,7 +251,9 @@ public:
                        PipelineTuningOptions PTO = PipelineTuningOptions(),
                        Optional<PGOOptions> PGOOpt = None,
                        PassInstrumentationCallbacks *PIC = nullptr)
-      : TM(TM), PTO(PTO), PGOOpt(PGOOpt), PIC(PIC) {}
+      : TM(TM), PTO(PTO), PGOOpt(PGOOpt), PIC(PIC) {
+    initReducedPipeline();
+  }
 
   /// Cross register the analysis managers through their proxies.
   ///
@@ -630,6 +654,8 @@ public:
   }
 
 private:
+  void initReducedPipeline();
+
   static Optional<std::vector<PipelineElement>>
   parsePipelineText(StringRef Text);
 
@@ -15,12 +15,15 @@
 #ifndef LLVM_PASSES_STANDARDINSTRUMENTATIONS_H
 #define LLVM_PASSES_STANDARDINSTRUMENTATIONS_H
 
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/PassInstrumentation.h"
 #include "llvm/IR/PassTimingInfo.h"
+#include "llvm/Support/Timer.h"
 
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace llvm {
 
@@ -53,11 +56,96 @@ private:
   bool StoreModuleDesc = false;
 };
 
+/// Instrumentation that records every run of a pass on an IR unit and writes
+/// the runs out as a report (-time-passes-report=<file>).
+///
+/// Unlike TimePassesHandler nothing is aggregated: running GVN on a function is
+/// one record holding the pass, the module, the function, the wall time, the
+/// number of instructions before and after the pass and the change in heap
+/// usage (only tracked with -track-memory). Loop and CGSCC passes are reported
+/// against the loop and the SCC they ran on.
+///
+/// Records are written either as one JSON object per line or as CSV
+/// (-time-passes-report-format). The report file is appended to, so that the
+/// backends of a ThinLTO link, each with their own instrumentation, end up in
+/// the same report.
+class PassReportInstrumentation {
+public:
+  enum class ReportFormat { JSON, CSV };
+
+  /// Enabled when -time-passes-report is given.
+  PassReportInstrumentation();
+  PassReportInstrumentation(bool Enabled, ReportFormat Format);
+
+  /// Destructor writes out the records that have not been written yet.
+  ~PassReportInstrumentation() { print(); }
+
+  PassReportInstrumentation(const PassReportInstrumentation &) = delete;
+  void operator=(const PassReportInstrumentation &) = delete;
+
+  void registerCallbacks(PassInstrumentationCallbacks &PIC);
+
+  /// Writes out the records collected so far, then drops them.
+  void print();
+
+  /// Set a custom output stream for subsequent reporting.
+  void setOutStream(raw_ostream &OutStream);
+
+private:
+  struct PassRun {
+    std::string PassID;
+    std::string ModuleID;
+    std::string IRName;
+    double WallTime = 0;
+    unsigned InstrsBefore = 0;
+    /// None if the pass invalidated the IR unit it ran on.
+    Optional<unsigned> InstrsAfter;
+    ssize_t MemUsed = 0;
+  };
+
+  bool runBeforePass(StringRef PassID, Any IR);
+  void runAfterPass(StringRef PassID, Any IR);
+  void runAfterPassInvalidated(StringRef PassID);
+  void finishRun(StringRef PassID, TimeRecord End,
+                 Optional<unsigned> InstrsAfter);
+
+  void printRuns(raw_ostream &OS, bool PrintHeader) const;
+
+  /// Runs that have started but not finished, innermost last.
+  SmallVector<std::pair<PassRun, TimeRecord>, 4> ActiveRuns;
+  /// Finished runs, in the order they finished.
+  std::vector<PassRun> Runs;
+
+  /// Custom output stream to print the report into. By default (== nullptr)
+  /// the report is appended to the -time-passes-report file.
+  raw_ostream *OutStream = nullptr;
+
+  bool Enabled;
+  ReportFormat Format;
+};
+
+/// Instrumentation that adds a -ftime-trace section for every pass and
+/// analysis run, with the function, SCC or loop it ran on as the detail.
+///
+/// The callbacks are only registered if the time trace profiler is enabled
+/// when registerCallbacks is called. Pass managers and adaptors are skipped,
+/// the sections of the passes they run already cover them.
+class TimeProfilingPassesHandler {
+public:
+  void registerCallbacks(PassInstrumentationCallbacks &PIC);
+
+private:
+  bool runBeforePass(StringRef PassID, Any IR);
+  void runAfterPass(StringRef PassID);
+};
+
 /// This class provides an interface to register all the standard pass
 /// instrumentations and manages their state (if any).
 class StandardInstrumentations {
   PrintIRInstrumentation PrintIR;
   TimePassesHandler TimePasses;
+  PassReportInstrumentation PassReport;
+  TimeProfilingPassesHandler TimeProfilingPasses;
 
 public:
   StandardInstrumentations() = default;
@@ -65,6 +153,7 @@ public:
   void registerCallbacks(PassInstrumentationCallbacks &PIC);
 
   TimePassesHandler &getTimePasses() { return TimePasses; }
+  PassReportInstrumentation &getPassReport() { return PassReport; }
 };
 } // namespace llvm
 
@@ -19,6 +19,7 @@
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/None.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/iterator.h"
@@ -508,6 +509,7 @@ public:
 class CoverageMapping {
   DenseMap<size_t, DenseSet<size_t>> RecordProvenance;
   std::vector<FunctionRecord> Functions;
+  DenseMap<size_t, SmallVector<unsigned, 0>> FilenameHash2RecordIndices;
   std::vector<std::pair<std::string, uint64_t>> FuncHashMismatches;
 
   CoverageMapping() = default;
@@ -516,6 +518,23 @@ class CoverageMapping {
   Error loadFunctionRecord(const CoverageMappingRecord &Record,
                            IndexedInstrProfReader &ProfileReader);
 
+  /// Add \p Function, unless a function with the same name and files has
+  /// already been added.
+  void addFunctionRecord(FunctionRecord Function);
+
+  /// Load the coverage mapping of a single object file, with a reader of its
+  /// own for the profile so that this can run on any thread.
+  static Expected<std::unique_ptr<CoverageMapping>>
+  loadObject(StringRef ObjectFilename, StringRef ProfileFilename,
+             StringRef Arch, ArrayRef<StringRef> SourceFiles);
+
+  /// Look up the indices for function records which are at least partially
+  /// defined in the specified file. This is guaranteed to return a superset of
+  /// such records: extra records not in the file may be included if there is
+  /// a hash collision on the filename. Clients must be robust to collisions.
+  ArrayRef<unsigned>
+  getImpreciseRecordIndicesForFilename(StringRef Filename) const;
+
 public:
   CoverageMapping(const CoverageMapping &) = delete;
   CoverageMapping &operator=(const CoverageMapping &) = delete;
@@ -527,9 +546,15 @@ public:
 
   /// Load the coverage mapping from the given object files and profile. If
   /// \p Arches is non-empty, it must specify an architecture for each object.
+  /// With more than one thread, the objects are decoded in parallel, and each
+  /// one only stays in memory until its function records have been added.
+  /// The result is the same as loading them one after the other. If
+  /// \p SourceFiles is non-empty, only the functions in at least one of these
+  /// files are loaded, and the mappings of the others aren't decoded.
   static Expected<std::unique_ptr<CoverageMapping>>
   load(ArrayRef<StringRef> ObjectFilenames, StringRef ProfileFilename,
-       ArrayRef<StringRef> Arches = None);
+       ArrayRef<StringRef> Arches = None, unsigned NumThreads = 1,
+       ArrayRef<StringRef> SourceFiles = None);
 
   /// The number of functions that couldn't have their profiles mapped.
   ///
@@ -15,7 +15,9 @@
 #define LLVM_PROFILEDATA_COVERAGE_COVERAGEMAPPINGREADER_H
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ProfileData/Coverage/CoverageMapping.h"
 #include "llvm/ProfileData/InstrProf.h"
 #include "llvm/Support/Error.h"
@@ -143,6 +145,8 @@ class RawCoverageMappingReader : public RawCoverageReader {
   std::vector<StringRef> &Filenames;
   std::vector<CounterExpression> &Expressions;
   std::vector<CounterMappingRegion> &MappingRegions;
+  /// The number of files the function is in, once they have been read.
+  Optional<size_t> NumFileIDs;
 
 public:
   RawCoverageMappingReader(StringRef MappingData,
@@ -160,6 +164,11 @@ public:
 
   Error read();
 
+  /// Read only the files the function is in, which come first in the mapping.
+  /// This is cheap compared to reading the whole mapping, which read() still
+  /// can do afterwards.
+  Error readFilenames();
+
 private:
   Error decodeCounter(unsigned Value, Counter &C);
   Error readCounter(Counter &C);
@@ -196,9 +205,17 @@ private:
   std::vector<StringRef> FunctionsFilenames;
   std::vector<CounterExpression> Expressions;
   std::vector<CounterMappingRegion> MappingRegions;
+  /// If not empty, the only files whose functions' records are read.
+  StringSet<> FileFilter;
+  /// The files of the last translation unit that was checked against
+  /// FileFilter, and whether any of them is in the filter.
+  ArrayRef<StringRef> LastFilteredTU;
+  bool LastFilteredTUMatches = false;
 
   BinaryCoverageReader() = default;
 
+  bool isInFileFilter(ArrayRef<StringRef> Files) const;
+
 public:
   BinaryCoverageReader(const BinaryCoverageReader &) = delete;
   BinaryCoverageReader &operator=(const BinaryCoverageReader &) = delete;
@@ -207,6 +224,12 @@ public:
   create(std::unique_ptr<MemoryBuffer> &ObjectBuffer,
          StringRef Arch);
 
+  /// Only return the records of functions in one of \p SourceFiles. The
+  /// records of other functions are skipped without decoding their mapping
+  /// regions: translation units without any of these files are skipped as a
+  /// whole, and of the others, only the files of each function are read.
+  void setFileFilter(ArrayRef<StringRef> SourceFiles);
+
   Error readNextRecord(CoverageMappingRecord &Record) override;
 };
 
@@ -78,6 +78,24 @@ inline StringRef getInstrProfValueRangeProfFuncName() {
   return INSTR_PROF_VALUE_RANGE_PROF_FUNC_STR;
 }
 
+/// Return the name of the thread local variable holding the offset of the
+/// calling thread's counter shard.
+inline StringRef getInstrProfCounterShardOffsetVarName() {
+  return INSTR_PROF_COUNTER_SHARD_OFFSET_VAR_STR;
+}
+
+/// Return the name of the profile runtime entry point that allocates the
+/// calling thread's counter shard.
+inline StringRef getInstrProfCounterShardFuncName() {
+  return INSTR_PROF_COUNTER_SHARD_FUNC_STR;
+}
+
+/// Return the name of the variable holding the offset of the counters updated
+/// by code compiled with runtime counter relocation.
+inline StringRef getInstrProfCounterBiasVarName() {
+  return INSTR_PROF_PROFILE_COUNTER_BIAS_VAR_STR;
+}
+
 /// Return the name prefix of variables containing instrumented function names.
 inline StringRef getInstrProfNameVarPrefix() { return "__profn_"; }
 
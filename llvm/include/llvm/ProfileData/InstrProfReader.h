@@ -15,6 +15,7 @@
 #define LLVM_PROFILEDATA_INSTRPROFREADER_H
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/IR/ProfileSummary.h"
 #include "llvm/ProfileData/InstrProf.h"
@@ -431,6 +432,9 @@ private:
   std::unique_ptr<ProfileSummary> Summary;
   /// Context sensitive profile summary data.
   std::unique_ptr<ProfileSummary> CS_Summary;
+  /// The records looked up by preloadRecords(), by function name. An empty
+  /// list means the function isn't in the profile.
+  StringMap<std::vector<NamedInstrProfRecord>> PreloadedRecords;
   // Index to the current record in the record array.
   unsigned RecordIndex;
 
@@ -468,6 +472,13 @@ public:
   Expected<InstrProfRecord> getInstrProfRecord(StringRef FuncName,
                                                uint64_t FuncHash);
 
+  /// Look up the records of the functions in \c FuncNames up front, so that
+  /// getInstrProfRecord() finds them without going back to the profile. This
+  /// lets a compiler touch only the parts of a large profile that the module
+  /// being compiled needs once, e.g. before it starts annotating functions.
+  /// Functions missing from the profile are not an error.
+  Error preloadRecords(ArrayRef<StringRef> FuncNames);
+
   /// Fill Counts with the profile data for the given function name.
   Error getFunctionCounts(StringRef FuncName, uint64_t FuncHash,
                           std::vector<uint64_t> &Counts);
@@ -74,6 +74,14 @@ public:
   /// Write the profile, returning the raw data. For testing.
   std::unique_ptr<MemoryBuffer> writeBuffer();
 
+  /// Return the records added so far, by function name and hash.
+  const StringMap<ProfilingData> &getProfileData() const {
+    return FunctionData;
+  }
+
+  /// Return the kind of the profiles added so far.
+  ProfKind getProfileKind() const { return ProfileKind; }
+
   /// Set the ProfileKind. Report error if mixing FE and IR level profiles.
   /// \c WithCS indicates if this is for contenxt sensitive instrumentation.
   Error setIsIRLevelProfile(bool IsIRLevel, bool WithCS) {
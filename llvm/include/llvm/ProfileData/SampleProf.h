@@ -49,7 +49,10 @@ enum class sampleprof_error {
   truncated_name_table,
   not_implemented,
   counter_overflow,
-  ostream_seek_unsupported
+  ostream_seek_unsupported,
+  compress_failed,
+  uncompress_failed,
+  zlib_unavailable
 };
 
 inline std::error_code make_error_code(sampleprof_error E) {
@@ -83,6 +86,7 @@ enum SampleProfileFormat {
   SPF_Text = 0x1,
   SPF_Compact_Binary = 0x2,
   SPF_GCC = 0x3,
+  SPF_Ext_Binary = 0x4,
   SPF_Binary = 0xff
 };
 
@@ -105,6 +109,35 @@ static inline StringRef getRepInFormat(StringRef Name,
 
 static inline uint64_t SPVersion() { return 103; }
 
+/// Section types of the extensible binary format. A reader skips sections of
+/// a type it doesn't know, so new kinds of metadata can be added without
+/// breaking older compilers.
+enum SecType {
+  SecInValid = 0,
+  SecProfSummary = 1,
+  SecNameTable = 2,
+  SecLBRProfile = 3,
+  SecFuncOffsetTable = 4,
+  // Marks the end of the known section types. New types go right before it.
+  SecLastPlaceHolder
+};
+
+enum SecFlags : uint64_t {
+  SecFlagInValid = 0,
+  /// The section payload is zlib compressed.
+  SecFlagCompress = (1 << 0)
+};
+
+/// An entry of the section header table of the extensible binary format.
+/// Offset is relative to the start of the profile, Size is the number of
+/// bytes the section occupies in the file.
+struct SecHdrTableEntry {
+  SecType Type;
+  uint64_t Flags;
+  uint64_t Offset;
+  uint64_t Size;
+};
+
 /// Represents the relative location of an instruction.
 ///
 /// Instruction locations are specified by the line offset from the
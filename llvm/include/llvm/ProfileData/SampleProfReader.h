@@ -203,11 +203,43 @@
 //          in the text format documentation above).
 //        FUNCTION BODY
 //          A FUNCTION BODY entry describing the inlined function.
+//
+// Extensible binary format
+// ------------------------
+//
+// The same encoding as the binary format, split into sections that are
+// located through a section header table:
+//
+// MAGIC (uint64_t)
+//    File identifier computed by function SPMagic(SPF_Ext_Binary).
+//
+// VERSION (uint32_t)
+//    File format version number computed by SPVersion()
+//
+// SECTION HEADER TABLE
+//    NUM_SECTIONS (uint64_t, fixed width)
+//    A list of NUM_SECTIONS entries, each of four fixed width uint64_t:
+//      TYPE (SecType), FLAGS (SecFlags), OFFSET (from the file start),
+//      SIZE (in the file).
+//
+// SECTIONS
+//    SecProfSummary holds a SUMMARY, SecNameTable a NAME TABLE and
+//    SecLBRProfile the FUNCTION BODY entries of the top-level functions.
+//    SecFuncOffsetTable maps name table indices to the offset of the
+//    function body within the payload of SecLBRProfile, which lets the
+//    reader decode only the functions a module defines.
+//
+//    A section with SecFlagCompress set holds the uncompressed size and the
+//    compressed size (ULEB128) followed by the zlib compressed payload.
+//    Sections of unknown type are skipped.
 //===----------------------------------------------------------------------===//
 
 #ifndef LLVM_PROFILEDATA_SAMPLEPROFREADER_H
 #define LLVM_PROFILEDATA_SAMPLEPROFREADER_H
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
@@ -218,6 +250,7 @@
 #include "llvm/IR/ProfileSummary.h"
 #include "llvm/ProfileData/GCOV.h"
 #include "llvm/ProfileData/SampleProf.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -422,22 +455,22 @@ protected:
   /// Points to the end of the buffer.
   const uint8_t *End = nullptr;
 
-private:
-  std::error_code readSummaryEntry(std::vector<ProfileSummaryEntry> &Entries);
-  virtual std::error_code verifySPMagic(uint64_t Magic) = 0;
-
   /// Read profile summary.
   std::error_code readSummary();
 
   /// Read the whole name table.
   virtual std::error_code readNameTable() = 0;
 
+private:
+  std::error_code readSummaryEntry(std::vector<ProfileSummaryEntry> &Entries);
+  virtual std::error_code verifySPMagic(uint64_t Magic) = 0;
+
   /// Read a string indirectly via the name table.
   virtual ErrorOr<StringRef> readStringFromTable() = 0;
 };
 
 class SampleProfileReaderRawBinary : public SampleProfileReaderBinary {
-private:
+protected:
   /// Function name table.
   std::vector<StringRef> NameTable;
   virtual std::error_code verifySPMagic(uint64_t Magic) override;
@@ -446,11 +479,61 @@ private:
   virtual ErrorOr<StringRef> readStringFromTable() override;
 
 public:
-  SampleProfileReaderRawBinary(std::unique_ptr<MemoryBuffer> B, LLVMContext &C)
-      : SampleProfileReaderBinary(std::move(B), C, SPF_Binary) {}
+  SampleProfileReaderRawBinary(std::unique_ptr<MemoryBuffer> B, LLVMContext &C,
+                               SampleProfileFormat Format = SPF_Binary)
+      : SampleProfileReaderBinary(std::move(B), C, Format) {}
+
+  /// \brief Return true if \p Buffer is in the format supported by this class.
+  static bool hasFormat(const MemoryBuffer &Buffer);
+};
+
+/// Reader for the extensible binary format, see SampleProfileWriterExtBinary
+/// for the layout. The function profiles are only decoded in read(), and when
+/// collectFuncsToUse() was called before, only those of the functions defined
+/// in the module are.
+class SampleProfileReaderExtBinary : public SampleProfileReaderRawBinary {
+private:
+  /// The section header table, in file order.
+  std::vector<SecHdrTableEntry> SecHdrTable;
+  /// The function profiles, i.e. the payload of the SecLBRProfile section
+  /// after uncompressing it.
+  const uint8_t *ProfileStart = nullptr;
+  const uint8_t *ProfileEnd = nullptr;
+  /// The table mapping from function name to the offset of its FunctionSample
+  /// towards ProfileStart.
+  DenseMap<StringRef, uint64_t> FuncOffsetTable;
+  /// The set containing the functions to use when compiling a module.
+  DenseSet<StringRef> FuncsToUse;
+  /// Whether FuncsToUse was populated by collectFuncsToUse().
+  bool UseFuncsToUse = false;
+  /// Owns the uncompressed copies of compressed sections. The name table
+  /// refers to them.
+  BumpPtrAllocator DecompressBufAllocator;
+
+  virtual std::error_code verifySPMagic(uint64_t Magic) override;
+  virtual std::error_code readHeader() override;
+  std::error_code readSecHdrTable();
+  std::error_code readOneSection(const SecHdrTableEntry &Entry);
+  std::error_code decompressSection(const uint8_t *SecStart, uint64_t SecSize,
+                                    const uint8_t *&DecompressBuf,
+                                    uint64_t &DecompressBufSize);
+  std::error_code readFuncOffsetTable();
+
+public:
+  SampleProfileReaderExtBinary(std::unique_ptr<MemoryBuffer> B, LLVMContext &C)
+      : SampleProfileReaderRawBinary(std::move(B), C, SPF_Ext_Binary) {}
 
   /// \brief Return true if \p Buffer is in the format supported by this class.
   static bool hasFormat(const MemoryBuffer &Buffer);
+
+  /// Read the function profiles, or only those of the functions to use.
+  std::error_code read() override;
+
+  /// Collect functions to be used when compiling Module \p M.
+  void collectFuncsToUse(const Module &M) override;
+
+  /// Return the section header table.
+  ArrayRef<SecHdrTableEntry> getSecHdrTable() const { return SecHdrTable; }
 };
 
 class SampleProfileReaderCompactBinary : public SampleProfileReaderBinary {
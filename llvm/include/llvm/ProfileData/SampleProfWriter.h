@@ -13,6 +13,8 @@
 #define LLVM_PROFILEDATA_SAMPLEPROFWRITER_H
 
 #include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/IR/ProfileSummary.h"
@@ -23,7 +25,9 @@
 #include <cstdint>
 #include <memory>
 #include <set>
+#include <string>
 #include <system_error>
+#include <vector>
 
 namespace llvm {
 namespace sampleprof {
@@ -45,6 +49,13 @@ public:
 
   raw_ostream &getOutputStream() { return *OutputStream; }
 
+  /// Compress every section of the profile. Only the extensible binary format
+  /// has sections; the other writers ignore this.
+  virtual void setToCompressAllSections() {}
+
+  /// Compress the section of type \p Type.
+  virtual void setToCompressSection(SecType Type) {}
+
   /// Profile writer factory.
   ///
   /// Create a new file writer based on the value of \p Format.
@@ -64,6 +75,10 @@ protected:
   virtual std::error_code
   writeHeader(const StringMap<FunctionSamples> &ProfileMap) = 0;
 
+  /// Write the function profiles in \p ProfileMap, hottest first.
+  std::error_code
+  writeFuncProfiles(const StringMap<FunctionSamples> &ProfileMap);
+
   /// Output stream where to emit the profile to.
   std::unique_ptr<raw_ostream> OutputStream;
 
@@ -118,10 +133,10 @@ protected:
 
   MapVector<StringRef, uint32_t> NameTable;
 
-private:
   void addName(StringRef FName);
   void addNames(const FunctionSamples &S);
 
+private:
   friend ErrorOr<std::unique_ptr<SampleProfileWriter>>
   SampleProfileWriter::create(std::unique_ptr<raw_ostream> &OS,
                               SampleProfileFormat Format);
@@ -135,6 +150,70 @@ protected:
   virtual std::error_code writeMagicIdent() override;
 };
 
+// ExtBinary is the binary format split into sections, which are located
+// through a section header table at the start of the profile:
+//
+//    Part1: Magic number and version, as in the binary format.
+//    Part2: Section header table, one (type, flags, offset, size) entry per
+//           section. It is reserved first and filled in at the end.
+//    Part3: The sections: SecProfSummary, SecNameTable, SecLBRProfile, which
+//           holds the function profiles, and SecFuncOffsetTable, which maps
+//           every function to the offset of its profile within
+//           SecLBRProfile.
+//
+// The function offset table lets the reader load only the functions defined
+// in the module being compiled. Every section can be zlib compressed on its
+// own, and readers skip types they don't know, so that new metadata can be
+// added in new sections.
+class SampleProfileWriterExtBinary : public SampleProfileWriterRawBinary {
+  using SampleProfileWriterRawBinary::SampleProfileWriterRawBinary;
+
+public:
+  virtual std::error_code write(const FunctionSamples &S) override;
+  virtual std::error_code
+  write(const StringMap<FunctionSamples> &ProfileMap) override;
+
+  void setToCompressAllSections() override;
+  void setToCompressSection(SecType Type) override;
+
+protected:
+  virtual std::error_code writeMagicIdent() override;
+  virtual std::error_code
+  writeHeader(const StringMap<FunctionSamples> &ProfileMap) override;
+
+private:
+  /// The sections in the order they are written, with the flags to write
+  /// them with. Offset and Size are unused here.
+  SmallVector<SecHdrTableEntry, 8> SectionLayout = {
+      {SecProfSummary, 0, 0, 0},
+      {SecNameTable, 0, 0, 0},
+      {SecLBRProfile, 0, 0, 0},
+      {SecFuncOffsetTable, 0, 0, 0}};
+  /// The section header table being built.
+  std::vector<SecHdrTableEntry> SecHdrTable;
+  /// The position of the profile in the output stream.
+  uint64_t FileStart = 0;
+  /// The position of the reserved section header table.
+  uint64_t SecHdrTableOffset = 0;
+  /// The position where the payload of SecLBRProfile starts, in the stream
+  /// it is written to.
+  uint64_t LBRProfileStart = 0;
+  /// The table mapping from function name to the offset of its FunctionSample
+  /// towards LBRProfileStart.
+  MapVector<StringRef, uint64_t> FuncOffsetTable;
+  /// A section to be compressed is written to LocalBufStream first.
+  std::string LocalBuf;
+  std::unique_ptr<raw_ostream> LocalBufStream =
+      llvm::make_unique<raw_string_ostream>(LocalBuf);
+
+  SecHdrTableEntry &getEntryInLayout(SecType Type);
+  uint64_t markSectionStart(SecType Type);
+  std::error_code addNewSection(SecType Type, uint64_t SectionStart);
+  std::error_code compressAndOutput();
+  std::error_code writeFuncOffsetTable();
+  std::error_code writeSecHdrTable();
+};
+
 // CompactBinary is a compact format of binary profile which both reduces
 // the profile size and the load time needed when compiling. It has two
 // major difference with Binary format.
@@ -16,6 +16,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Remarks/Remark.h"
+#include "llvm/Remarks/RemarkFormat.h"
 #include "llvm/Support/Error.h"
 #include <memory>
 
@@ -30,9 +31,14 @@ struct Parser {
   std::unique_ptr<ParserImpl> Impl;
 
   /// Create a parser parsing \p Buffer to Remark objects.
-  /// This constructor should be only used for parsing YAML remarks.
+  /// This constructor should be only used for parsing YAML or binary remarks.
+  /// The format is detected from the contents of the buffer.
   Parser(StringRef Buffer);
 
+  /// Create a parser parsing \p Buffer, which is in the format \p Format, to
+  /// Remark objects.
+  Parser(Format ParserFormat, StringRef Buffer);
+
   /// Create a parser parsing \p Buffer to Remark objects, using \p StrTabBuf as
   /// string table.
   /// This constructor should be only used for parsing YAML remarks.
@@ -0,0 +1,76 @@
+//===-- RemarkSerializer.h - Remark serialization interface -----*- C++/-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides an interface for serializing remarks to different formats.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_REMARKS_REMARK_SERIALIZER_H
+#define LLVM_REMARKS_REMARK_SERIALIZER_H
+
+#include "llvm/Remarks/Remark.h"
+#include "llvm/Remarks/RemarkStringTable.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace llvm {
+namespace remarks {
+
+/// This is the base class for a remark serializer.
+/// It includes support for using a string table while emitting.
+struct Serializer {
+  /// The open raw_ostream that the remark diagnostics are emitted to.
+  raw_ostream &OS;
+
+  Serializer(raw_ostream &OS) : OS(OS) {}
+  virtual ~Serializer() = default;
+
+  /// Emit a remark to the stream.
+  virtual void emit(const Remark &Remark) = 0;
+};
+
+/// Serialize the remarks to the binary remark format.
+///
+/// The output starts with BinaryMagic and BinaryVersion and is followed by a
+/// sequence of records, each starting with its ULEB128-encoded kind. All the
+/// strings go through a StringTable: the first time a string is used, a
+/// string record defining it is emitted, and remarks then refer to strings
+/// by their ID. This allows streaming the remarks to disk as they are
+/// produced, and parsing the output without a separate string table.
+struct BinarySerializer : public Serializer {
+  /// The kind of a record in the binary remark format.
+  enum RecordKind : uint8_t {
+    /// A string: ULEB128 size, followed by the bytes of the string.
+    RK_String = 1,
+    /// A remark: type, pass, name and function, flags, optional location
+    /// and hotness, and a list of arguments. See emit() for the layout.
+    RK_Remark = 2,
+  };
+
+  /// The flags of the optional fields of a remark record.
+  enum RemarkFlags : uint8_t { RF_HasLoc = 1 << 0, RF_HasHotness = 1 << 1 };
+
+  /// The string table used during emission.
+  StringTable StrTab;
+
+  BinarySerializer(raw_ostream &OS);
+
+  /// Emit a remark to the stream, preceded by the definitions of any strings
+  /// it uses for the first time.
+  void emit(const Remark &Remark) override;
+
+private:
+  /// Return the ID of \p Str, emitting its definition if it is new.
+  uint64_t getStringID(StringRef Str);
+  /// Emit the fields of a debug location whose file has the ID \p FileID.
+  void emitLoc(uint64_t FileID, const RemarkLocation &Loc);
+};
+
+} // end namespace remarks
+} // end namespace llvm
+
+#endif /* LLVM_REMARKS_REMARK_SERIALIZER_H */
@@ -32,6 +32,16 @@ bool isAvailable();
 Error compress(StringRef InputBuffer, SmallVectorImpl<char> &CompressedBuffer,
                int Level = DefaultCompression);
 
+/// Compresses \p InputBuffer into raw deflate data without a zlib header or
+/// trailer and appends it to \p CompressedBuffer. Unless \p IsLast is true,
+/// the output is flushed to a byte boundary and the deflate stream is left
+/// open, so that independently compressed shards can be concatenated to form
+/// a single stream. The caller is responsible for writing the zlib header and
+/// the Adler-32 checksum of the whole input.
+Error compressShard(StringRef InputBuffer,
+                    SmallVectorImpl<char> &CompressedBuffer, bool IsLast,
+                    int Level = DefaultCompression);
+
 Error uncompress(StringRef InputBuffer, char *UncompressedBuffer,
                  size_t &UncompressedSize);
 
@@ -41,8 +51,97 @@ Error uncompress(StringRef InputBuffer,
 
 uint32_t crc32(StringRef Buffer);
 
+uint32_t adler32(StringRef Buffer);
+
+/// Returns the Adler-32 checksum of two concatenated buffers given checksums
+/// of each and the size of the second buffer.
+uint32_t adler32Combine(uint32_t Adler1, uint32_t Adler2, size_t Size2);
+
 }  // End of namespace zlib
 
+namespace zstd {
+
+static constexpr int BestSpeedCompression = 1;
+static constexpr int DefaultCompression = 3;
+static constexpr int BestSizeCompression = 19;
+
+bool isAvailable();
+
+/// Compresses \p InputBuffer into a single zstd frame and stores it in
+/// \p CompressedBuffer. zstd frames can be concatenated, and a sequence of
+/// frames decompresses to the concatenation of their contents, so inputs may
+/// be split into shards and compressed independently.
+Error compress(StringRef InputBuffer, SmallVectorImpl<char> &CompressedBuffer,
+               int Level = DefaultCompression);
+
+/// Decompresses one or more concatenated zstd frames. On entry
+/// \p UncompressedSize is the size of \p UncompressedBuffer; on exit it is the
+/// number of bytes written.
+Error uncompress(StringRef InputBuffer, char *UncompressedBuffer,
+                 size_t &UncompressedSize);
+
+Error uncompress(StringRef InputBuffer,
+                 SmallVectorImpl<char> &UncompressedBuffer,
+                 size_t UncompressedSize);
+
+}  // End of namespace zstd
+
+namespace lz4 {
+
+/// Level 0 selects the fast compressor; levels from 1 to BestSizeCompression
+/// select the slower high-compression (LZ4HC) mode.
+static constexpr int DefaultCompression = 0;
+static constexpr int BestSizeCompression = 12;
+
+bool isAvailable();
+
+/// Compresses \p InputBuffer into a raw LZ4 block and stores it in
+/// \p CompressedBuffer. The block doesn't record the uncompressed size, so
+/// callers must store it themselves.
+Error compress(StringRef InputBuffer, SmallVectorImpl<char> &CompressedBuffer,
+               int Level = DefaultCompression);
+
+Error uncompress(StringRef InputBuffer, char *UncompressedBuffer,
+                 size_t &UncompressedSize);
+
+Error uncompress(StringRef InputBuffer,
+                 SmallVectorImpl<char> &UncompressedBuffer,
+                 size_t UncompressedSize);
+
+}  // End of namespace lz4
+
+/// A codec-agnostic interface to the compression libraries above, for clients
+/// that let the user choose the format.
+namespace compression {
+
+enum class Format { Zlib, Zstd, LZ4 };
+
+/// Returns the name of \p F as used on command lines, e.g. "zstd".
+const char *getName(Format F);
+
+/// Returns true if LLVM was built with support for \p F.
+bool isAvailable(Format F);
+
+/// Returns the level used by compress() when none is given.
+int getDefaultLevel(Format F);
+
+/// Compresses \p InputBuffer and stores the result in \p CompressedBuffer.
+/// None of the formats record the uncompressed size; callers must. These
+/// functions must only be called with formats for which isAvailable() is true.
+Error compress(Format F, StringRef InputBuffer,
+               SmallVectorImpl<char> &CompressedBuffer);
+Error compress(Format F, StringRef InputBuffer,
+               SmallVectorImpl<char> &CompressedBuffer, int Level);
+
+Error uncompress(Format F, StringRef InputBuffer, char *UncompressedBuffer,
+                 size_t &UncompressedSize);
+
+Error uncompress(Format F, StringRef InputBuffer,
+                 SmallVectorImpl<char> &UncompressedBuffer,
+                 size_t UncompressedSize);
+
+} // End of namespace compression
+
 } // End of namespace llvm
 
 #endif
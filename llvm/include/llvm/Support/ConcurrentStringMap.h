@@ -0,0 +1,177 @@
+//===- ConcurrentStringMap.h - Thread-safe string map -----------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// This file defines ConcurrentStringMap, a string map that many threads can
+/// insert into and look up at once, and ConcurrentUniqueStringSaver, a string
+/// interning pool built on top of it.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_CONCURRENTSTRINGMAP_H
+#define LLVM_SUPPORT_CONCURRENTSTRINGMAP_H
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/RWMutex.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/xxhash.h"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace llvm {
+
+/// A map from strings to values of type \p ValueTy that is safe to use from
+/// multiple threads at once.
+///
+/// Keys are distributed over a fixed number of shards by their hash. Each
+/// shard is a StringMap that allocates its entries from its own
+/// BumpPtrAllocator and is protected by its own reader/writer lock, so
+/// threads only contend when they touch the same shard, and lookups of a key
+/// that is already present never allocate or take an exclusive lock.
+///
+/// Entries are never moved or freed before the map is destroyed: a
+/// StringMapEntry returned by insert() or find(), and the key and value it
+/// holds, stay valid for the lifetime of the map. The map only synchronizes
+/// its own structure; threads that modify values of shared entries must
+/// synchronize those accesses themselves.
+///
+/// Nothing can be erased from the map.
+template <typename ValueTy> class ConcurrentStringMap {
+public:
+  typedef StringMapEntry<ValueTy> EntryTy;
+
+  /// Creates a map with \p NumShards shards, rounded up to a power of two. By
+  /// default, four shards are created for every hardware thread.
+  explicit ConcurrentStringMap(unsigned NumShards = 0) {
+    if (NumShards == 0)
+      NumShards = 4 * std::max(1u, hardware_concurrency());
+    NumShards = std::min<unsigned>(NextPowerOf2(NumShards - 1), 1u << 16);
+    ShardMask = NumShards - 1;
+    Shards = llvm::make_unique<Shard[]>(NumShards);
+  }
+  ConcurrentStringMap(const ConcurrentStringMap &) = delete;
+  ConcurrentStringMap &operator=(const ConcurrentStringMap &) = delete;
+
+  /// Returns the entry of \p Key, creating it with a value constructed from
+  /// \p Args if it doesn't exist yet. The bool is true if the entry was
+  /// created by this call. If several threads insert the same key at once,
+  /// exactly one of them creates the entry and all get the same pointer.
+  template <typename... ArgsTy>
+  std::pair<EntryTy *, bool> insert(StringRef Key, ArgsTy &&... Args) {
+    Shard &S = getShard(Key);
+    {
+      sys::ScopedReader Lock(S.Mutex);
+      auto It = S.Map.find(Key);
+      if (It != S.Map.end())
+        return {&*It, false};
+    }
+    sys::ScopedWriter Lock(S.Mutex);
+    auto Res = S.Map.try_emplace(Key, std::forward<ArgsTy>(Args)...);
+    return {&*Res.first, Res.second};
+  }
+
+  /// Returns the entry of \p Key or nullptr if it doesn't exist.
+  EntryTy *find(StringRef Key) const {
+    Shard &S = getShard(Key);
+    sys::ScopedReader Lock(S.Mutex);
+    auto It = S.Map.find(Key);
+    return It == S.Map.end() ? nullptr : &*It;
+  }
+
+  bool count(StringRef Key) const { return find(Key) != nullptr; }
+
+  /// Returns the number of entries. The result is only exact if no other
+  /// thread is inserting.
+  size_t size() const {
+    size_t Size = 0;
+    for (unsigned I = 0; I <= ShardMask; ++I) {
+      sys::ScopedReader Lock(Shards[I].Mutex);
+      Size += Shards[I].Map.size();
+    }
+    return Size;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  /// Returns the number of bytes allocated for keys and values.
+  size_t getBytesAllocated() const {
+    size_t Size = 0;
+    for (unsigned I = 0; I <= ShardMask; ++I) {
+      sys::ScopedReader Lock(Shards[I].Mutex);
+      Size += Shards[I].Map.getAllocator().getBytesAllocated();
+    }
+    return Size;
+  }
+
+  unsigned getNumShards() const { return ShardMask + 1; }
+
+  /// Calls \p Fn on every entry. The order is unspecified; sort the entries
+  /// if the result must be deterministic. Fn may not insert into the map.
+  template <typename FnT> void forEach(FnT Fn) const {
+    for (unsigned I = 0; I <= ShardMask; ++I) {
+      sys::ScopedReader Lock(Shards[I].Mutex);
+      for (auto &E : Shards[I].Map)
+        Fn(E);
+    }
+  }
+
+private:
+  struct Shard {
+    mutable sys::RWMutex Mutex;
+    StringMap<ValueTy, BumpPtrAllocator> Map;
+  };
+
+  // StringMap hashes keys with djbHash, so use an unrelated hash to pick the
+  // shard. Otherwise all keys in a shard would share their low hash bits and
+  // cluster in the shard's table.
+  Shard &getShard(StringRef Key) const {
+    return Shards[xxh3_64bits(Key) & ShardMask];
+  }
+
+  unsigned ShardMask;
+  std::unique_ptr<Shard[]> Shards;
+};
+
+/// Saves strings and returns a StringRef with a stable character pointer,
+/// like UniqueStringSaver, but is safe to use from multiple threads at once.
+/// Saving the same string yields the same StringRef, no matter which thread
+/// saved it first, so interned strings can be compared by their data pointer.
+class ConcurrentUniqueStringSaver final {
+  ConcurrentStringMap<char> Unique;
+
+public:
+  explicit ConcurrentUniqueStringSaver(unsigned NumShards = 0)
+      : Unique(NumShards) {}
+
+  // All returned strings are null-terminated: *save(S).end() == 0.
+  StringRef save(const char *S) { return save(StringRef(S)); }
+  StringRef save(StringRef S) { return Unique.insert(S).first->getKey(); }
+  StringRef save(const Twine &S) { return save(StringRef(S.str())); }
+  StringRef save(const std::string &S) { return save(StringRef(S)); }
+
+  /// Returns the saved copy of \p S, or an empty StringRef with a null data
+  /// pointer if \p S hasn't been saved.
+  StringRef lookup(StringRef S) const {
+    if (auto *E = Unique.find(S))
+      return E->getKey();
+    return StringRef();
+  }
+
+  size_t size() const { return Unique.size(); }
+};
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_CONCURRENTSTRINGMAP_H
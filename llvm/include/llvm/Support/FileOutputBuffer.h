@@ -32,6 +32,12 @@ public:
   enum {
     /// set the 'x' bit on the resulting file
     F_executable = 1,
+
+    /// Keep the buffer in memory instead of mapping the output file, and
+    /// write ranges passed to writeback() to the file in the background.
+    /// This is faster than a mapped file on file systems where writing
+    /// through a shared mapping is slow, e.g. network file systems.
+    F_async_writeback = 2,
   };
 
   /// Factory method to create an OutputBuffer object which manages a read/write
@@ -74,6 +80,13 @@ public:
   /// but keeps the memory mapping alive.
   virtual void discard() {}
 
+  /// Tells the buffer that [Offset, Offset + Size) holds its final contents
+  /// and won't be modified again. A buffer created with F_async_writeback
+  /// starts writing the range to its file in the background, so that
+  /// commit() only has to write the rest. Other buffers ignore this. It is
+  /// safe to call this from several threads at once.
+  virtual void writeback(size_t Offset, size_t Size) {}
+
 protected:
   FileOutputBuffer(StringRef Path) : FinalPath(Path) {}
 
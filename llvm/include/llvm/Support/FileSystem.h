@@ -1077,6 +1077,19 @@ openNativeFileForRead(const Twine &Name, OpenFlags Flags = OF_None,
 /// set to kInvalidFile.
 void closeFile(file_t &F);
 
+/// Writes all of \p Buf to the file \p FD at \p Offset without moving the
+/// file offset, like pwrite(2). Several threads may write to different parts
+/// of the same file at once.
+std::error_code writeFileSlice(int FD, ArrayRef<char> Buf, uint64_t Offset);
+
+/// Asks the OS to start reading the files in \p Paths into memory in the
+/// background, so that opening and mapping them later doesn't stall on I/O.
+/// This is meant for programs such as linkers that know up front which files
+/// they will read. Files that can't be opened are skipped. The files are
+/// opened in parallel because opening a file can itself be slow on network
+/// file systems.
+void prefetchFiles(ArrayRef<std::string> Paths);
+
 std::error_code getUniqueID(const Twine Path, UniqueID &Result);
 
 /// Get disk space usage information.
@@ -1100,6 +1113,16 @@ public:
     priv ///< May modify via data, but changes are lost on destruction.
   };
 
+  /// Hints about how a mapping is going to be accessed.
+  enum class advice {
+    normal,     ///< No particular access pattern.
+    sequential, ///< Read front to back. Read ahead aggressively.
+    random,     ///< Read in no particular order. Don't read ahead.
+    willneed,   ///< Needed soon. Start reading it in the background now.
+    dontneed,   ///< Not needed for a while. The pages may be dropped.
+    hugepage    ///< Back the mapping with huge pages if possible.
+  };
+
 private:
   /// Platform-specific mapping state.
   size_t Size;
@@ -1133,6 +1156,11 @@ public:
 
   /// \returns The minimum alignment offset must be.
   static int alignment();
+
+  /// Tells the OS how the mapping is going to be accessed. This is only a
+  /// hint: it doesn't change the contents of the mapping, and it does nothing
+  /// on systems that don't support the given advice.
+  std::error_code advise(advice A) const;
 };
 
 /// Return the path to the main executable, given the value of argv[0] from
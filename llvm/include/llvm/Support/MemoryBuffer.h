@@ -145,6 +145,11 @@ public:
   /// MemoryBuffer.
   virtual BufferKind getBufferKind() const = 0;
 
+  /// If the buffer is backed by a file mapping, tells the OS how it is going
+  /// to be accessed, e.g. to read the whole file ahead with
+  /// mapped_file_region::advice::willneed. Does nothing otherwise.
+  virtual void adviseIfMmap(sys::fs::mapped_file_region::advice A) const {}
+
   MemoryBufferRef getMemBufferRef() const;
 };
 
@@ -14,6 +14,7 @@
 #include "llvm/Support/MathExtras.h"
 
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>
 #include <functional>
 #include <mutex>
@@ -30,7 +31,16 @@ namespace llvm {
 
 namespace parallel {
 struct sequential_execution_policy {};
-struct parallel_execution_policy {};
+struct parallel_execution_policy {
+  constexpr explicit parallel_execution_policy(unsigned MaxThreads = 0)
+      : MaxThreads(MaxThreads) {}
+
+  /// The maximum number of threads, including the calling thread, that
+  /// for_each and for_each_n may run the callback on at once, or 0 for no
+  /// limit other than the size of the thread pool. Use this for call sites
+  /// that don't scale, e.g. ones bound by memory bandwidth or a lock.
+  unsigned MaxThreads;
+};
 
 template <typename T>
 struct is_execution_policy
@@ -84,6 +94,55 @@ public:
   void sync() const { L.sync(); }
 };
 
+// Calls ChunkFn for each chunk index in [0, NumChunks) on at most MaxThreads
+// threads. Each spawned task, like the calling thread, keeps taking the next
+// chunk until none are left.
+template <class FuncTy>
+void parallel_for_chunks(size_t NumChunks, unsigned MaxThreads,
+                         FuncTy ChunkFn) {
+  std::atomic<size_t> Next(0);
+  auto Worker = [&] {
+    for (size_t I = Next++; I < NumChunks; I = Next++)
+      ChunkFn(I);
+  };
+
+  TaskGroup TG;
+  for (size_t I = 1; I < MaxThreads && I < NumChunks; ++I)
+    TG.spawn(Worker);
+  Worker();
+}
+
+// The variants of parallel_for_each and parallel_for_each_n used when the
+// number of threads is bounded. Work is split into the same chunks as in the
+// unbounded versions.
+template <class IterTy, class FuncTy>
+void parallel_for_each_bounded(IterTy Begin, IterTy End, FuncTy Fn,
+                               unsigned MaxThreads) {
+  ptrdiff_t Size = std::distance(Begin, End);
+  ptrdiff_t TaskSize = std::max<ptrdiff_t>(Size / 1024, 1);
+  parallel_for_chunks((Size + TaskSize - 1) / TaskSize, MaxThreads,
+                      [&](size_t I) {
+                        IterTy B = Begin + I * TaskSize;
+                        std::for_each(B, B + std::min<ptrdiff_t>(TaskSize, End - B), Fn);
+                      });
+}
+
+template <class IndexTy, class FuncTy>
+void parallel_for_each_n_bounded(IndexTy Begin, IndexTy End, FuncTy Fn,
+                                 unsigned MaxThreads) {
+  if (End <= Begin)
+    return;
+  ptrdiff_t Size = End - Begin;
+  ptrdiff_t TaskSize = std::max<ptrdiff_t>(Size / 1024, 1);
+  parallel_for_chunks((Size + TaskSize - 1) / TaskSize, MaxThreads,
+                      [&](size_t I) {
+                        IndexTy B = Begin + I * TaskSize;
+                        IndexTy E = B + std::min<ptrdiff_t>(TaskSize, End - B);
+                        for (IndexTy J = B; J != E; ++J)
+                          Fn(J);
+                      });
+}
+
 #if defined(_MSC_VER)
 template <class RandomAccessIterator, class Comparator>
 void parallel_sort(RandomAccessIterator Start, RandomAccessIterator End,
@@ -234,13 +293,19 @@ void sort(parallel_execution_policy policy, RandomAccessIterator Start,
 template <class IterTy, class FuncTy>
 void for_each(parallel_execution_policy policy, IterTy Begin, IterTy End,
               FuncTy Fn) {
-  detail::parallel_for_each(Begin, End, Fn);
+  if (policy.MaxThreads)
+    detail::parallel_for_each_bounded(Begin, End, Fn, policy.MaxThreads);
+  else
+    detail::parallel_for_each(Begin, End, Fn);
 }
 
 template <class IndexTy, class FuncTy>
 void for_each_n(parallel_execution_policy policy, IndexTy Begin, IndexTy End,
                 FuncTy Fn) {
-  detail::parallel_for_each_n(Begin, End, Fn);
+  if (policy.MaxThreads)
+    detail::parallel_for_each_n_bounded(Begin, End, Fn, policy.MaxThreads);
+  else
+    detail::parallel_for_each_n(Begin, End, Fn);
 }
 #endif
 
@@ -0,0 +1,145 @@
+//===- PerThreadBumpPtrAllocator.h - Thread-safe bump allocation -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// This file defines PerThreadAllocator, a wrapper that gives every thread
+/// its own instance of an allocator such as BumpPtrAllocator or
+/// SpecificBumpPtrAllocator, so that it can be shared by threads that
+/// allocate concurrently without any locking on the allocation path.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_PERTHREADBUMPPTRALLOCATOR_H
+#define LLVM_SUPPORT_PERTHREADBUMPPTRALLOCATOR_H
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Compiler.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+
+namespace detail {
+/// Returns a process-wide unique ID for a PerThreadAllocator instance. IDs are
+/// never reused, so a thread's cached allocator can't be mistaken for one of
+/// a later instance at the same address.
+inline uint64_t getNextPerThreadAllocatorId() {
+  static std::atomic<uint64_t> NextId(0);
+  return ++NextId;
+}
+} // end namespace detail
+
+/// An allocator that can be used by many threads at once. Every thread that
+/// allocates from it gets its own \p AllocatorT, created on first use, and
+/// memory allocated by one thread is never handed out to another.
+///
+/// Each thread caches the allocator it used last, so allocating from the same
+/// instance over and over is lock-free. A lock is only taken the first time a
+/// thread uses an instance, or when a thread alternates between several
+/// instances of the same type.
+///
+/// Reset(), DestroyAll() and forEach() visit the allocators of all threads.
+/// No thread may allocate while they run.
+template <typename AllocatorT = BumpPtrAllocator>
+class PerThreadAllocator
+    : public AllocatorBase<PerThreadAllocator<AllocatorT>> {
+public:
+  PerThreadAllocator() : Id(detail::getNextPerThreadAllocatorId()) {}
+  PerThreadAllocator(const PerThreadAllocator &) = delete;
+  PerThreadAllocator &operator=(const PerThreadAllocator &) = delete;
+
+  /// Returns the calling thread's allocator.
+  AllocatorT &get() {
+    static LLVM_THREAD_LOCAL CacheEntry Cache;
+    if (Cache.Id != Id) {
+      Cache.Alloc = &getSlow();
+      Cache.Id = Id;
+    }
+    return *Cache.Alloc;
+  }
+
+  /// Allocates from the calling thread's allocator.
+  LLVM_ATTRIBUTE_RETURNS_NONNULL void *Allocate(size_t Size,
+                                                size_t Alignment) {
+    return get().Allocate(Size, Alignment);
+  }
+
+  // Pull in base class overloads.
+  using AllocatorBase<PerThreadAllocator>::Allocate;
+
+  void Deallocate(const void *Ptr, size_t Size) {}
+
+  // Pull in base class overloads.
+  using AllocatorBase<PerThreadAllocator>::Deallocate;
+
+  /// Calls \p Fn on the allocator of each thread that has used this one.
+  template <typename FnT> void forEach(FnT Fn) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    for (auto &P : Allocators)
+      Fn(*P.second);
+  }
+
+  /// Resets the allocators of all threads. Only for BumpPtrAllocator-like
+  /// allocators.
+  void Reset() {
+    forEach([](AllocatorT &Alloc) { Alloc.Reset(); });
+  }
+
+  /// Destroys the objects allocated by all threads. Only for
+  /// SpecificBumpPtrAllocator.
+  void DestroyAll() {
+    forEach([](AllocatorT &Alloc) { Alloc.DestroyAll(); });
+  }
+
+  /// Returns the number of bytes allocated by all threads. Only for
+  /// BumpPtrAllocator-like allocators.
+  size_t getBytesAllocated() {
+    size_t Size = 0;
+    forEach([&](AllocatorT &Alloc) { Size += Alloc.getBytesAllocated(); });
+    return Size;
+  }
+
+private:
+  struct CacheEntry {
+    uint64_t Id;
+    AllocatorT *Alloc;
+  };
+
+  AllocatorT &getSlow() {
+    std::thread::id Self = std::this_thread::get_id();
+    std::lock_guard<std::mutex> Lock(Mutex);
+    for (auto &P : Allocators)
+      if (P.first == Self)
+        return *P.second;
+    Allocators.emplace_back(Self, llvm::make_unique<AllocatorT>());
+    return *Allocators.back().second;
+  }
+
+  const uint64_t Id;
+  std::mutex Mutex;
+  std::vector<std::pair<std::thread::id, std::unique_ptr<AllocatorT>>>
+      Allocators;
+};
+
+/// A BumpPtrAllocator that is safe to use from multiple threads at once.
+typedef PerThreadAllocator<BumpPtrAllocator> PerThreadBumpPtrAllocator;
+
+/// A SpecificBumpPtrAllocator that is safe to use from multiple threads at
+/// once.
+template <typename T>
+using PerThreadSpecificBumpPtrAllocator =
+    PerThreadAllocator<SpecificBumpPtrAllocator<T>>;
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_PERTHREADBUMPPTRALLOCATOR_H
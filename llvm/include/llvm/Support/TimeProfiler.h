@@ -9,6 +9,7 @@
 #ifndef LLVM_SUPPORT_TIME_PROFILER_H
 #define LLVM_SUPPORT_TIME_PROFILER_H
 
+#include "llvm/Support/Error.h"
 #include "llvm/Support/raw_ostream.h"
 
 namespace llvm {
@@ -18,8 +19,16 @@ extern TimeTraceProfiler *TimeTraceProfilerInstance;
 
 /// Initialize the time trace profiler.
 /// This sets up the global \p TimeTraceProfilerInstance
-/// variable to be the profiler instance.
-void timeTraceProfilerInitialize();
+/// variable to be the profiler instance. \p ProcName is the process name
+/// shown in the trace viewer. Once initialized, time sections can be recorded
+/// from any thread; each thread gets its own track in the trace.
+void timeTraceProfilerInitialize(StringRef ProcName = "clang");
+
+/// Initialize the time trace profiler like above, but only record sections
+/// that take longer than \p TimeTraceGranularity microseconds instead of the
+/// -time-trace-granularity default.
+void timeTraceProfilerInitialize(unsigned TimeTraceGranularity,
+                                 StringRef ProcName);
 
 /// Cleanup the time trace profiler, if it was initialized.
 void timeTraceProfilerCleanup();
@@ -32,8 +41,14 @@ inline bool timeTraceProfilerEnabled() {
 /// Write profiling data to output file.
 /// Data produced is JSON, in Chrome "Trace Event" format, see
 /// https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU/preview
+/// All threads must have ended their time sections before this is called.
 void timeTraceProfilerWrite(raw_pwrite_stream &OS);
 
+/// Write profiling data to a file named \p PreferredFileName, or to
+/// \p FallbackFileName with a ".time-trace" suffix if it is empty.
+Error timeTraceProfilerWrite(StringRef PreferredFileName,
+                             StringRef FallbackFileName);
+
 /// Manually begin a time section, with the given \p Name and \p Detail.
 /// Profiler copies the string data, so the pointers can be given into
 /// temporaries. Time sections can be hierarchical; every Begin must have a
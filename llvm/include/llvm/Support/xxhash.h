@@ -44,6 +44,13 @@
 namespace llvm {
 uint64_t xxHash64(llvm::StringRef Data);
 uint64_t xxHash64(llvm::ArrayRef<uint8_t> Data);
+
+/// Computes the 64-bit XXH3 hash of \p Data with the default secret and a
+/// seed of 0. XXH3 is considerably faster than XXH64, in particular for short
+/// inputs, but the two produce different values, so hashes that are stored or
+/// compared across runs must keep using the function they were created with.
+uint64_t xxh3_64bits(llvm::ArrayRef<uint8_t> Data);
+uint64_t xxh3_64bits(llvm::StringRef Data);
 }
 
 #endif
@@ -13,6 +13,10 @@
 #ifndef LLVM_TABLEGEN_MAIN_H
 #define LLVM_TABLEGEN_MAIN_H
 
+#include "llvm/ADT/ArrayRef.h"
+#include <functional>
+#include <string>
+
 namespace llvm {
 
 class raw_ostream;
@@ -24,6 +28,20 @@ using TableGenMainFn = bool (raw_ostream &OS, RecordKeeper &Records);
 
 int TableGenMain(char *argv0, TableGenMainFn *MainFn);
 
+/// An output of a TableGen run besides the one written to -o.
+struct TableGenOutput {
+  std::string Filename;
+  std::function<bool(raw_ostream &OS, RecordKeeper &Records)> MainFn;
+};
+
+/// Like above, but parse the input once and also emit each of \p ExtraOutputs
+/// from the same records. All outputs, including the one for -o, are emitted
+/// on up to \p Threads threads (0 for one per hardware thread); with more than
+/// one the backends involved must only read the records. Every output file is
+/// listed as a target in the -d dependency file.
+int TableGenMain(char *argv0, TableGenMainFn *MainFn,
+                 ArrayRef<TableGenOutput> ExtraOutputs, unsigned Threads);
+
 } // end namespace llvm
 
 #endif // LLVM_TABLEGEN_MAIN_H
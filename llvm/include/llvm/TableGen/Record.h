@@ -27,6 +27,7 @@
 #include "llvm/Support/TrailingObjects.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -1417,7 +1418,7 @@ inline raw_ostream &operator<<(raw_ostream &OS, const RecordVal &RV) {
 }
 
 class Record {
-  static unsigned LastID;
+  static std::atomic<unsigned> LastID;
 
   Init *Name;
   // Location where record was instantiated, followed by the location of
@@ -1741,6 +1742,12 @@ public:
   void dump() const;
 };
 
+/// Allow several backends to run on the same records at once while \p Enable
+/// is set, by making the uniquing of Inits and RecTys thread-safe. The
+/// backends must only read the records; they may create new Inits and
+/// Records of their own.
+void setConcurrentRecordAccess(bool Enable);
+
 /// Sorting predicate to sort record pointers by name.
 struct LessRecord {
   bool operator()(const Record *Rec1, const Record *Rec2) const {
@@ -23,6 +23,7 @@
 #include <system_error>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 namespace llvm {
 
@@ -125,6 +126,41 @@ public:
   PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
 };
 
+/// The import lists computed by a thin link, along with what each of them was
+/// computed from, so that the next thin link of the same program only has to
+/// recompute the import lists of the modules whose inputs changed.
+///
+/// The import list of a module only depends on the summaries of the module
+/// itself and on the summaries of the GUIDs it consulted while computing it.
+/// The summaries of a module are identified by a digest of its module hash
+/// and of the flags that the thin link computes before importing, such as
+/// liveness. An import list is reused if the digest of its module is
+/// unchanged and if none of the GUIDs it consulted is defined by a module
+/// whose digest changed, before or after the change.
+class ThinLinkImportState {
+public:
+  struct ModuleState {
+    /// Digest of the module's summaries, 0 if the module has no hash.
+    uint64_t Digest = 0;
+    /// The GUIDs and original names of the module's summaries, sorted.
+    std::vector<GlobalValue::GUID> Defined;
+    /// The GUIDs consulted while computing the imports, sorted.
+    std::vector<GlobalValue::GUID> Consulted;
+    FunctionImporter::ImportMapTy ImportList;
+  };
+
+  /// Hash of the options that affect importing.
+  uint64_t OptionsHash = 0;
+  StringMap<ModuleState> Modules;
+
+  /// Reads a state written by writeToFile(). On error, the state is left
+  /// empty, which makes the next thin link recompute all import lists.
+  Error readFromFile(StringRef Path);
+
+  /// Atomically replaces the file at \p Path with this state.
+  Error writeToFile(StringRef Path) const;
+};
+
 /// Compute all the imports and exports for every module in the Index.
 ///
 /// \p ModuleToDefinedGVSummaries contains for each Module a map
@@ -137,11 +173,18 @@ public:
 /// \p ExportLists contains for each Module the set of globals (GUID) that will
 /// be imported by another module, or referenced by such a function. I.e. this
 /// is the set of globals that need to be promoted/renamed appropriately.
+///
+/// The modules are processed in parallel (see -import-threads); the result
+/// does not depend on the number of threads.
+///
+/// If \p State is set, the import lists it records are reused for the modules
+/// whose inputs did not change, and it is updated to record this thin link.
 void ComputeCrossModuleImport(
     const ModuleSummaryIndex &Index,
     const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
     StringMap<FunctionImporter::ImportMapTy> &ImportLists,
-    StringMap<FunctionImporter::ExportSetTy> &ExportLists);
+    StringMap<FunctionImporter::ExportSetTy> &ExportLists,
+    ThinLinkImportState *State = nullptr);
 
 /// Compute all the imports for the given module using the Index.
 ///
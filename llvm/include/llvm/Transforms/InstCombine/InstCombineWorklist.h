@@ -11,6 +11,7 @@
 
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/Support/Compiler.h"
@@ -26,6 +27,9 @@ namespace llvm {
 class InstCombineWorklist {
   SmallVector<Instruction*, 256> Worklist;
   DenseMap<Instruction*, unsigned> WorklistMap;
+  /// Instructions added one at a time, rather than as part of the initial
+  /// group, since the last call to takeAdded().
+  SmallPtrSet<Instruction *, 16> Added;
 
 public:
   InstCombineWorklist() = default;
@@ -41,6 +45,7 @@ public:
     if (WorklistMap.insert(std::make_pair(I, Worklist.size())).second) {
       LLVM_DEBUG(dbgs() << "IC: ADD: " << *I << '\n');
       Worklist.push_back(I);
+      Added.insert(I);
     }
   }
 
@@ -67,6 +72,7 @@ public:
 
   // Remove - remove I from the worklist if it exists.
   void Remove(Instruction *I) {
+    Added.erase(I);
     DenseMap<Instruction*, unsigned>::iterator It = WorklistMap.find(I);
     if (It == WorklistMap.end()) return; // Not in worklist.
 
@@ -92,6 +98,16 @@ public:
   }
 
 
+  /// takeAdded - Return the instructions added one at a time since the last
+  /// call, i.e. the ones a combine created or whose operands it changed, and
+  /// start over. Instructions that were erased since may still be in the set,
+  /// so it must only be used for lookups.
+  SmallPtrSet<Instruction *, 16> takeAdded() {
+    SmallPtrSet<Instruction *, 16> Result = std::move(Added);
+    Added.clear();
+    return Result;
+  }
+
   /// Zap - check that the worklist is empty and nuke the backing store for
   /// the map if it is large.
   void Zap() {
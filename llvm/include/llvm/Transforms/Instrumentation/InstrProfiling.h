@@ -67,6 +67,14 @@ private:
   // vector of counter load/store pairs to be register promoted.
   std::vector<LoadStorePair> PromotionCandidates;
 
+  // The offset added to the counter addresses in the function being lowered,
+  // when counters are sharded or relocated at runtime.
+  Value *CounterOffset = nullptr;
+
+  // The counter arrays used by the function being lowered, moved by
+  // CounterOffset.
+  DenseMap<GlobalVariable *, Value *> OffsetCounters;
+
   // The start value of precise value profile range for memory intrinsic sizes.
   int64_t MemOPSizeRangeStart;
   // The end value of precise value profile range for memory intrinsic sizes.
@@ -93,6 +101,17 @@ private:
   /// Replace instrprof_increment with an increment of the appropriate value.
   void lowerIncrement(InstrProfIncrementInst *Inc);
 
+  /// Load the calling thread's counter shard offset at the entry of \p F,
+  /// asking the runtime to allocate the shard if the thread has none yet.
+  void emitCounterShardOffset(Function *F);
+
+  /// Load the counter bias set by the runtime at the entry of \p F.
+  void emitCounterBias(Function *F);
+
+  /// Return the address of counter \p Index of \p Counters, moved by
+  /// CounterOffset.
+  Value *getOffsetCounterAddr(GlobalVariable *Counters, uint64_t Index);
+
   /// Force emitting of name vars for unused functions.
   void lowerCoverageData(GlobalVariable *CoverageNamesVar);
 
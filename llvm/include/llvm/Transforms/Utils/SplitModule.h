@@ -37,6 +37,14 @@ void SplitModule(
     function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
     bool PreserveLocals = false);
 
+/// Like the above, but for a module that the caller keeps ownership of. The
+/// partitions are cloned from \p M, which is modified if \p PreserveLocals is
+/// false.
+void SplitModule(
+    Module &M, unsigned N,
+    function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
+    bool PreserveLocals = false);
+
 } // end namespace llvm
 
 #endif // LLVM_TRANSFORMS_UTILS_SPLITMODULE_H
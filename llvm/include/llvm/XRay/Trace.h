@@ -13,14 +13,24 @@
 #define LLVM_XRAY_TRACE_H
 
 #include <cstdint>
+#include <memory>
+#include <utility>
 #include <vector>
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/DataExtractor.h"
 #include "llvm/Support/Error.h"
 #include "llvm/XRay/XRayRecord.h"
 
 namespace llvm {
+namespace sys {
+namespace fs {
+class mapped_file_region;
+} // namespace fs
+} // namespace sys
+
 namespace xray {
 
 /// A Trace object represents the records that have been loaded from XRay
@@ -74,6 +84,93 @@ Expected<Trace> loadTraceFile(StringRef Filename, bool Sort = false);
 /// DataExtractor.
 Expected<Trace> loadTrace(const DataExtractor &Extractor, bool Sort = false);
 
+/// A TraceStream provides incremental, per-thread access to the records of an
+/// XRay trace without materialising the whole trace in memory. For FDR mode
+/// logs, opening the stream only builds an index of where each thread's
+/// buffers live in the (memory mapped) file; the records of a thread are
+/// decoded, verified and expanded again every time they are requested. Other
+/// formats are loaded fully and partitioned by thread.
+///
+/// Records for distinct threads may be requested concurrently from different
+/// host threads.
+///
+/// Usage:
+///
+///   auto StreamOrErr = openTraceStream("xray-log.something.xray");
+///   if (!StreamOrErr)
+///     // Handle the error here.
+///   auto &TS = **StreamOrErr;
+///   for (size_t I = 0, N = TS.threads().size(); I != N; ++I)
+///     if (auto E = TS.forEachRecord(I, [](const XRayRecord &R) {
+///           // ... do something with R here.
+///           return Error::success();
+///         }))
+///       // Handle the error here.
+///
+class TraceStream {
+public:
+  /// A (process id, thread id) pair identifying a thread in the trace.
+  using ThreadKey = std::pair<uint64_t, int32_t>;
+  using RecordCallback = function_ref<Error(const XRayRecord &)>;
+
+  struct BlockLocation {
+    /// Offset in the data from which a record producer can be restarted: the
+    /// block itself for version 1 and 2 logs, and the enclosing buffer extents
+    /// record for version 3 and newer.
+    uint64_t Offset = 0;
+    /// Number of records to skip after restarting at Offset.
+    uint32_t Skip = 0;
+    uint64_t Seconds = 0;
+    uint32_t Nanos = 0;
+  };
+
+  ~TraceStream();
+
+  /// Provides access to the loaded XRay trace file header.
+  const XRayFileHeader &getFileHeader() const { return FileHeader; }
+
+  /// The threads found in the trace, in order of first appearance.
+  ArrayRef<ThreadKey> threads() const { return Threads; }
+
+  /// Invokes |Callback| on each record of the |ThreadIndex|-th thread, in the
+  /// same order loadTrace(...) would produce them without sorting. Stops at and
+  /// returns the first error, either from decoding the trace or returned by
+  /// |Callback|.
+  Error forEachRecord(size_t ThreadIndex, RecordCallback Callback) const;
+
+  /// Invokes |Callback| on each record of every thread, one thread at a time.
+  Error forEachRecord(RecordCallback Callback) const;
+
+private:
+  TraceStream() = default;
+
+  XRayFileHeader FileHeader;
+  std::unique_ptr<sys::fs::mapped_file_region> MappedFile;
+  StringRef Data;
+  bool IsLittleEndian = true;
+  std::vector<ThreadKey> Threads;
+
+  // FDR mode logs only store the locations of each thread's blocks, sorted by
+  // wallclock time.
+  std::vector<std::vector<BlockLocation>> Blocks;
+
+  // Everything else is kept in memory.
+  std::vector<std::vector<XRayRecord>> Records;
+
+  friend Expected<std::unique_ptr<TraceStream>>
+  openTraceStream(const DataExtractor &);
+  friend Expected<std::unique_ptr<TraceStream>> openTraceStream(StringRef);
+};
+
+/// Opens a TraceStream over the trace file at |Filename|, memory mapping it for
+/// the lifetime of the stream.
+Expected<std::unique_ptr<TraceStream>> openTraceStream(StringRef Filename);
+
+/// Opens a TraceStream over the data in |Extractor|, which must outlive the
+/// returned stream.
+Expected<std::unique_ptr<TraceStream>>
+openTraceStream(const DataExtractor &Extractor);
+
 } // namespace xray
 } // namespace llvm
 
@@ -60,6 +60,9 @@ using namespace llvm;
 static cl::opt<bool> DisableBasicAA("disable-basicaa", cl::Hidden,
                                     cl::init(false));
 
+AAQueryInfo::AAQueryInfo() : AliasCache(), IsCapturedCache() {}
+AAQueryInfo::~AAQueryInfo() = default;
+
 AAResults::AAResults(AAResults &&Arg)
     : TLI(Arg.TLI), AAs(std::move(Arg.AAs)), AADeps(std::move(Arg.AADeps)) {
   for (auto &AA : AAs)
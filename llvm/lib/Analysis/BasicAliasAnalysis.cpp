@@ -627,6 +627,28 @@ bool BasicAAResult::DecomposeGEPExpression(const Value *V,
   return true;
 }
 
+bool BasicAAResult::decomposeGEPExpression(const Value *V,
+                                           DecomposedGEP &Decomposed,
+                                           AAQueryInfo &AAQI) {
+  if (!AAQI.CacheDecomposedGEPs)
+    return DecomposeGEPExpression(V, Decomposed, DL, &AC, DT);
+
+  if (!AAQI.DecomposedGEPs)
+    AAQI.DecomposedGEPs = llvm::make_unique<DecomposedGEPCache>();
+  auto &Entries = AAQI.DecomposedGEPs->Entries;
+  auto Cached = Entries.find(V);
+  if (Cached != Entries.end()) {
+    Decomposed = Cached->second.first;
+    return Cached->second.second;
+  }
+
+  // The offsets the caller starts from are always zero, so the decomposition
+  // only depends on V.
+  bool MaxLookupReached = DecomposeGEPExpression(V, Decomposed, DL, &AC, DT);
+  Entries.try_emplace(V, Decomposed, MaxLookupReached);
+  return MaxLookupReached;
+}
+
 /// Returns whether the given pointer value points to memory that is local to
 /// the function, with global constants being considered local to all
 /// functions.
@@ -1296,10 +1318,8 @@ AliasResult BasicAAResult::aliasGEP(
   DecompGEP1.StructOffset = DecompGEP1.OtherOffset = APInt(MaxPointerSize, 0);
   DecompGEP2.StructOffset = DecompGEP2.OtherOffset = APInt(MaxPointerSize, 0);
 
-  bool GEP1MaxLookupReached =
-    DecomposeGEPExpression(GEP1, DecompGEP1, DL, &AC, DT);
-  bool GEP2MaxLookupReached =
-    DecomposeGEPExpression(V2, DecompGEP2, DL, &AC, DT);
+  bool GEP1MaxLookupReached = decomposeGEPExpression(GEP1, DecompGEP1, AAQI);
+  bool GEP2MaxLookupReached = decomposeGEPExpression(V2, DecompGEP2, AAQI);
 
   APInt GEP1BaseOffset = DecompGEP1.StructOffset + DecompGEP1.OtherOffset;
   APInt GEP2BaseOffset = DecompGEP2.StructOffset + DecompGEP2.OtherOffset;
@@ -145,6 +145,13 @@ STATISTIC(NumTripCountsNotComputed,
           "Number of loops without predictable loop counts");
 STATISTIC(NumBruteForceTripCountsComputed,
           "Number of loops with trip counts computed by force");
+STATISTIC(NumArithBudgetExceeded,
+          "Number of add and mul expressions not simplified, as they were "
+          "too deep or too big");
+STATISTIC(NumCastBudgetExceeded,
+          "Number of casts not simplified, as they were too deep");
+STATISTIC(NumLoopEntryGuardCacheHits,
+          "Number of loop entry guard queries answered from the cache");
 
 static cl::opt<unsigned>
 MaxBruteForceIterations("scalar-evolution-max-iterations", cl::ReallyHidden,
@@ -1280,6 +1287,7 @@ const SCEV *ScalarEvolution::getTruncateExpr(const SCEV *Op, Type *Ty,
     return getTruncateOrZeroExtend(SZ->getOperand(), Ty, Depth + 1);
 
   if (Depth > MaxCastDepth) {
+    ++NumCastBudgetExceeded;
     SCEV *S =
         new (SCEVAllocator) SCEVTruncateExpr(ID.Intern(SCEVAllocator), Op, Ty);
     UniqueSCEVs.InsertNode(S, IP);
@@ -1656,6 +1664,7 @@ ScalarEvolution::getZeroExtendExpr(const SCEV *Op, Type *Ty, unsigned Depth) {
   void *IP = nullptr;
   if (const SCEV *S = UniqueSCEVs.FindNodeOrInsertPos(ID, IP)) return S;
   if (Depth > MaxCastDepth) {
+    ++NumCastBudgetExceeded;
     SCEV *S = new (SCEVAllocator) SCEVZeroExtendExpr(ID.Intern(SCEVAllocator),
                                                      Op, Ty);
     UniqueSCEVs.InsertNode(S, IP);
@@ -1967,6 +1976,7 @@ ScalarEvolution::getSignExtendExpr(const SCEV *Op, Type *Ty, unsigned Depth) {
   if (const SCEV *S = UniqueSCEVs.FindNodeOrInsertPos(ID, IP)) return S;
   // Limit recursion depth.
   if (Depth > MaxCastDepth) {
+    ++NumCastBudgetExceeded;
     SCEV *S = new (SCEVAllocator) SCEVSignExtendExpr(ID.Intern(SCEVAllocator),
                                                      Op, Ty);
     UniqueSCEVs.InsertNode(S, IP);
@@ -2441,8 +2451,10 @@ const SCEV *ScalarEvolution::getAddExpr(SmallVectorImpl<const SCEV *> &Ops,
   }
 
   // Limit recursion calls depth.
-  if (Depth > MaxArithDepth || hasHugeExpression(Ops))
+  if (Depth > MaxArithDepth || hasHugeExpression(Ops)) {
+    ++NumArithBudgetExceeded;
     return getOrCreateAddExpr(Ops, Flags);
+  }
 
   // Okay, check to see if the same value occurs in the operand list more than
   // once.  If so, merge them together into an multiply expression.  Since we
@@ -2920,8 +2932,10 @@ const SCEV *ScalarEvolution::getMulExpr(SmallVectorImpl<const SCEV *> &Ops,
   Flags = StrengthenNoWrapFlags(this, scMulExpr, Ops, Flags);
 
   // Limit recursion calls depth.
-  if (Depth > MaxArithDepth || hasHugeExpression(Ops))
+  if (Depth > MaxArithDepth || hasHugeExpression(Ops)) {
+    ++NumArithBudgetExceeded;
     return getOrCreateMulExpr(Ops, Flags);
+  }
 
   // If there are any constants, fold them together.
   unsigned Idx = 0;
@@ -6744,6 +6758,7 @@ void ScalarEvolution::forgetAllLoops() {
   HasRecMap.clear();
   MinTrailingZerosCache.clear();
   PredicatedSCEVRewrites.clear();
+  LoopEntryGuards.clear();
 }
 
 void ScalarEvolution::forgetLoop(const Loop *L) {
@@ -6767,6 +6782,7 @@ void ScalarEvolution::forgetLoop(const Loop *L) {
 
     RemoveLoopFromBackedgeMap(BackedgeTakenCounts, CurrL);
     RemoveLoopFromBackedgeMap(PredicatedBackedgeTakenCounts, CurrL);
+    LoopEntryGuards.erase(CurrL);
 
     // Drop information about predicated SCEV rewrites for this loop.
     for (auto I = PredicatedSCEVRewrites.begin();
@@ -9511,6 +9527,33 @@ ScalarEvolution::isLoopEntryGuardedByCond(const Loop *L,
   if (isKnownViaNonRecursiveReasoning(Pred, LHS, RHS))
     return true;
 
+  // Walking the conditions that dominate the loop is expensive, and the same
+  // question is asked again and again by IndVars and LSR, so cache the answer.
+  // Nested queries can be cut short by the recursion guards of isImpliedCond,
+  // so only the outermost ones are cached.
+  if (!PendingLoopPredicates.empty() || !PendingMerges.empty() ||
+      WalkingBEDominatingConds || ProvingSplitPredicate)
+    return isLoopEntryGuardedByCondImpl(L, Pred, LHS, RHS);
+
+  unsigned PredBit = 1U << (Pred - ICmpInst::FIRST_ICMP_PREDICATE);
+  LoopGuardResults &Cached = LoopEntryGuards[L][{LHS, RHS}];
+  if (Cached.Queried & PredBit) {
+    ++NumLoopEntryGuardCacheHits;
+    return Cached.Proved & PredBit;
+  }
+  bool Proved = isLoopEntryGuardedByCondImpl(L, Pred, LHS, RHS);
+  // The reference may have been invalidated by nested queries.
+  LoopGuardResults &Result = LoopEntryGuards[L][{LHS, RHS}];
+  Result.Queried |= PredBit;
+  if (Proved)
+    Result.Proved |= PredBit;
+  return Proved;
+}
+
+bool ScalarEvolution::isLoopEntryGuardedByCondImpl(const Loop *L,
+                                                   ICmpInst::Predicate Pred,
+                                                   const SCEV *LHS,
+                                                   const SCEV *RHS) {
   // If we cannot prove strict comparison (e.g. a > b), maybe we can prove
   // the facts (a >= b && a != b) separately. A typical situation is when the
   // non-strict comparison is known from ranges and non-equality is known from
@@ -11324,6 +11367,7 @@ ScalarEvolution::ScalarEvolution(ScalarEvolution &&Arg)
       PendingPhiRanges(std::move(Arg.PendingPhiRanges)),
       PendingMerges(std::move(Arg.PendingMerges)),
       MinTrailingZerosCache(std::move(Arg.MinTrailingZerosCache)),
+      LoopEntryGuards(std::move(Arg.LoopEntryGuards)),
       BackedgeTakenCounts(std::move(Arg.BackedgeTakenCounts)),
       PredicatedBackedgeTakenCounts(
           std::move(Arg.PredicatedBackedgeTakenCounts)),
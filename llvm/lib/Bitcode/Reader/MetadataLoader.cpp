@@ -1382,12 +1382,23 @@ Error MetadataLoader::MetadataLoaderImpl::parseOneMetadata(
     // Ignore Record[0], which indicates whether this compile unit is
     // distinct.  It's always distinct.
     IsDistinct = true;
+
+    // When lazy-loading for ThinLTO importing, the enums, retained types,
+    // global variables and macros listed on the compile unit are never
+    // imported (see IRLinker::prepareCompileUnitsForImport). Don't load these
+    // lists: the nodes they contain are still loaded on demand if they are
+    // reachable from the imported IR.
+    auto getCUListOrNull = [&](unsigned ID) -> Metadata * {
+      if (IsImporting && !GlobalMetadataBitPosIndex.empty())
+        return nullptr;
+      return getMDOrNull(ID);
+    };
     auto *CU = DICompileUnit::getDistinct(
         Context, Record[1], getMDOrNull(Record[2]), getMDString(Record[3]),
         Record[4], getMDString(Record[5]), Record[6], getMDString(Record[7]),
-        Record[8], getMDOrNull(Record[9]), getMDOrNull(Record[10]),
-        getMDOrNull(Record[12]), getMDOrNull(Record[13]),
-        Record.size() <= 15 ? nullptr : getMDOrNull(Record[15]),
+        Record[8], getCUListOrNull(Record[9]), getCUListOrNull(Record[10]),
+        getCUListOrNull(Record[12]), getMDOrNull(Record[13]),
+        Record.size() <= 15 ? nullptr : getCUListOrNull(Record[15]),
         Record.size() <= 14 ? 0 : Record[14],
         Record.size() <= 16 ? true : Record[16],
         Record.size() <= 17 ? false : Record[17],
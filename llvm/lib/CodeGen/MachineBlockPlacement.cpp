@@ -78,6 +78,8 @@ STATISTIC(CondBranchTakenFreq,
           "Potential frequency of taking conditional branches");
 STATISTIC(UncondBranchTakenFreq,
           "Potential frequency of taking unconditional branches");
+STATISTIC(NumColdBlocksSunk,
+          "Number of never executed blocks moved to the end of the function");
 
 static cl::opt<unsigned> AlignAllBlock("align-all-blocks",
                                        cl::desc("Force the alignment of all "
@@ -181,6 +183,13 @@ static cl::opt<unsigned> TriangleChainCount(
     cl::init(2),
     cl::Hidden);
 
+// Move the blocks which the profile says never execute behind all the others.
+static cl::opt<bool> SinkColdBlocks(
+    "block-placement-sink-cold",
+    cl::desc("With profile data, place the blocks which are never executed "
+             "at the end of the function"),
+    cl::init(false), cl::Hidden);
+
 extern cl::opt<unsigned> StaticLikelyProb;
 extern cl::opt<unsigned> ProfileLikelyProb;
 
@@ -468,6 +477,7 @@ class MachineBlockPlacement : public MachineFunctionPass {
       BlockChain &LoopChain, const MachineLoop &L,
       const BlockFilterSet &LoopBlockSet);
   void buildCFGChains();
+  void sinkColdBlocks(BlockChain &FunctionChain);
   void optimizeBranches();
   void alignBlocks();
   /// Returns true if a block should be tail-duplicated to increase fallthrough
@@ -2420,6 +2430,8 @@ void MachineBlockPlacement::buildCFGChains() {
 
   BlockChain &FunctionChain = *BlockToChain[&F->front()];
   buildChain(&F->front(), FunctionChain);
+  if (SinkColdBlocks)
+    sinkColdBlocks(FunctionChain);
 
 #ifndef NDEBUG
   using FunctionBlockSetType = SmallPtrSet<MachineBasicBlock *, 16>;
@@ -2518,6 +2530,59 @@ void MachineBlockPlacement::buildCFGChains() {
   EHPadWorkList.clear();
 }
 
+/// Move the blocks with a zero profile count to the end of the function
+/// chain, keeping the order of both the hot and the cold blocks.
+///
+/// This gathers the code which never runs in the profile after the hot code,
+/// which matters most for functions that are hot overall.
+void MachineBlockPlacement::sinkColdBlocks(BlockChain &FunctionChain) {
+  const Function &Fn = F->getFunction();
+  Optional<Function::ProfileCount> EntryCount = Fn.getEntryCount();
+  // Funclets have to keep their own layout.
+  if (!Fn.hasProfileData() || !EntryCount || !EntryCount->getCount() ||
+      F->hasEHFunclets())
+    return;
+
+  // A block is cold when its count, EntryCount * Freq / EntryFreq, rounds to
+  // zero.
+  uint64_t Threshold = std::max<uint64_t>(
+      MBFI->getEntryFreq() / EntryCount->getCount(), 1);
+  auto IsCold = [&](MachineBasicBlock *BB) {
+    return MBFI->getBlockFreq(BB).getFrequency() < Threshold;
+  };
+
+  // Blocks which fall through without an analyzable branch were merged with
+  // their layout successor by buildCFGChains(). Those have to stay together,
+  // so move whole segments of such blocks.
+  SmallVector<MachineBasicBlock *, 16> Hot, Cold;
+  SmallVector<MachineBasicBlock *, 4> Segment;
+  SmallVector<MachineOperand, 4> Cond; // For AnalyzeBranch.
+  bool SegmentIsCold = true;
+  for (MachineBasicBlock *BB : FunctionChain) {
+    Segment.push_back(BB);
+    // The entry block has to stay in front.
+    SegmentIsCold &= BB != &F->front() && IsCold(BB);
+    Cond.clear();
+    MachineBasicBlock *TBB = nullptr, *FBB = nullptr; // For AnalyzeBranch.
+    if (TII->analyzeBranch(*BB, TBB, FBB, Cond) && BB->canFallThrough())
+      continue;
+    (SegmentIsCold ? Cold : Hot).append(Segment.begin(), Segment.end());
+    Segment.clear();
+    SegmentIsCold = true;
+  }
+  // The last block can not fall through, unless it is unanalyzable and falls
+  // off the end of the function.
+  Hot.append(Segment.begin(), Segment.end());
+
+  if (Cold.empty() || Hot.empty())
+    return;
+  LLVM_DEBUG(dbgs() << "Sinking " << Cold.size() << " cold blocks of "
+                    << F->getName() << "\n");
+  NumColdBlocksSunk += Cold.size();
+  auto It = std::copy(Hot.begin(), Hot.end(), FunctionChain.begin());
+  std::copy(Cold.begin(), Cold.end(), It);
+}
+
 void MachineBlockPlacement::optimizeBranches() {
   BlockChain &FunctionChain = *BlockToChain[&F->front()];
   SmallVector<MachineOperand, 4> Cond; // For AnalyzeBranch.
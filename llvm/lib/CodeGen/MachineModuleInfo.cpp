@@ -10,6 +10,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/CodeGen/MachineFunction.h"
@@ -36,6 +37,11 @@
 using namespace llvm;
 using namespace llvm::dwarf;
 
+#define DEBUG_TYPE "machine-module-info"
+
+STATISTIC(MaxLiveMachineFunctions,
+          "Maximum number of MachineFunctions alive at the same time");
+
 // Handle the Pass registration stuff necessary to use DataLayout's.
 INITIALIZE_PASS(MachineModuleInfo, "machinemoduleinfo",
                 "Machine Module Information", false, false)
@@ -280,6 +286,10 @@ MachineModuleInfo::getOrCreateMachineFunction(const Function &F) {
     MF = new MachineFunction(F, TM, STI, NextFnNum++, *this);
     // Update the set entry.
     I.first->second.reset(MF);
+    // With the usual pipeline every MachineFunction is freed after it has
+    // been emitted, so this stays at one unless a module pass, such as the
+    // outliner, needs all of them.
+    MaxLiveMachineFunctions.updateMax(MachineFunctions.size());
   } else {
     MF = I.first->second.get();
   }
@@ -106,9 +106,10 @@ const unsigned EmptyIdx = -1;
 /// Each node has either no children or at least two children, with the root
 /// being a exception in the empty tree.
 ///
-/// Children are represented as a map between unsigned integers and nodes. If
-/// a node N has a child M on unsigned integer k, then the mapping represented
-/// by N is a proper prefix of the mapping represented by M. Note that this,
+/// If a node N has a child M on unsigned integer k, then the mapping
+/// represented by N is a proper prefix of the mapping represented by M. The
+/// edges are kept in a single map owned by the \p SuffixTree, and the children
+/// of a node are threaded through a list for traversals. Note that this,
 /// although similar to a trie is somewhat different: each node stores a full
 /// substring of the full mapping rather than a single character state.
 ///
@@ -118,12 +119,12 @@ const unsigned EmptyIdx = -1;
 /// suffix in \p SuffixIdx.
 struct SuffixTreeNode {
 
-  /// The children of this node.
-  ///
-  /// A child existing on an unsigned integer implies that from the mapping
-  /// represented by the current node, there is a way to reach another
-  /// mapping by tacking that character on the end of the current string.
-  DenseMap<unsigned, SuffixTreeNode *> Children;
+  /// The first child of this node, or null for a leaf.
+  SuffixTreeNode *FirstChild = nullptr;
+
+  /// The previous and next children of this node's parent.
+  SuffixTreeNode *PrevSibling = nullptr;
+  SuffixTreeNode *NextSibling = nullptr;
 
   /// The start index of this node's substring in the main string.
   unsigned StartIdx = EmptyIdx;
@@ -249,6 +250,43 @@ private:
   /// The end index of each leaf in the tree.
   unsigned LeafEndIdx = -1;
 
+  /// The edges of the tree, keyed by their parent and their label.
+  ///
+  /// A child existing on an unsigned integer implies that from the mapping
+  /// represented by the parent, there is a way to reach another mapping by
+  /// tacking that character on the end of the current string. One map for the
+  /// whole tree is far smaller than a map per node: most nodes have only a few
+  /// children, and the leaves, about half of the nodes, have none.
+  DenseMap<std::pair<SuffixTreeNode *, unsigned>, SuffixTreeNode *> Edges;
+
+  /// Returns the child of \p Parent on \p Edge, or null if there is none.
+  SuffixTreeNode *getChild(SuffixTreeNode *Parent, unsigned Edge) const {
+    return Edges.lookup(std::make_pair(Parent, Edge));
+  }
+
+  /// Make \p N the child of \p Parent on \p Edge. If there already is one, \p
+  /// N takes its place in the list of children of \p Parent.
+  void setChild(SuffixTreeNode &Parent, unsigned Edge, SuffixTreeNode *N) {
+    SuffixTreeNode *&Child = Edges[std::make_pair(&Parent, Edge)];
+    if (!Child) {
+      N->PrevSibling = nullptr;
+      N->NextSibling = Parent.FirstChild;
+      if (Parent.FirstChild)
+        Parent.FirstChild->PrevSibling = N;
+      Parent.FirstChild = N;
+    } else {
+      N->PrevSibling = Child->PrevSibling;
+      N->NextSibling = Child->NextSibling;
+      if (N->PrevSibling)
+        N->PrevSibling->NextSibling = N;
+      else
+        Parent.FirstChild = N;
+      if (N->NextSibling)
+        N->NextSibling->PrevSibling = N;
+    }
+    Child = N;
+  }
+
   /// Helper struct which keeps track of the next insertion point in
   /// Ukkonen's algorithm.
   struct ActiveState {
@@ -280,7 +318,7 @@ private:
 
     SuffixTreeNode *N = new (NodeAllocator.Allocate())
         SuffixTreeNode(StartIdx, &LeafEndIdx, nullptr);
-    Parent.Children[Edge] = N;
+    setChild(Parent, Edge, N);
 
     return N;
   }
@@ -304,33 +342,38 @@ private:
     SuffixTreeNode *N = new (NodeAllocator.Allocate())
         SuffixTreeNode(StartIdx, E, Root);
     if (Parent)
-      Parent->Children[Edge] = N;
+      setChild(*Parent, Edge, N);
 
     return N;
   }
 
   /// Set the suffix indices of the leaves to the start indices of their
-  /// respective suffixes.
+  /// respective suffixes, and the concatenated lengths of all nodes.
   ///
-  /// \param[in] CurrNode The node currently being visited.
-  /// \param CurrNodeLen The concatenation of all node sizes from the root to
-  /// this node. Used to produce suffix indices.
-  void setSuffixIndices(SuffixTreeNode &CurrNode, unsigned CurrNodeLen) {
-
-    bool IsLeaf = CurrNode.Children.size() == 0 && !CurrNode.isRoot();
-
-    // Store the concatenation of lengths down from the root.
-    CurrNode.ConcatLen = CurrNodeLen;
-    // Traverse the tree depth-first.
-    for (auto &ChildPair : CurrNode.Children) {
-      assert(ChildPair.second && "Node had a null child!");
-      setSuffixIndices(*ChildPair.second,
-                       CurrNodeLen + ChildPair.second->size());
-    }
+  /// The tree is traversed depth-first with an explicit stack, as it can be as
+  /// deep as the string is long.
+  void setSuffixIndices() {
+    std::vector<SuffixTreeNode *> ToVisit;
+    Root->ConcatLen = 0;
+    ToVisit.push_back(Root);
+    while (!ToVisit.empty()) {
+      SuffixTreeNode *CurrNode = ToVisit.back();
+      ToVisit.pop_back();
+      unsigned CurrNodeLen = CurrNode->ConcatLen;
+
+      // Is this node a leaf? If it is, give it a suffix index.
+      if (!CurrNode->FirstChild && !CurrNode->isRoot()) {
+        CurrNode->SuffixIdx = Str.size() - CurrNodeLen;
+        continue;
+      }
 
-    // Is this node a leaf? If it is, give it a suffix index.
-    if (IsLeaf)
-      CurrNode.SuffixIdx = Str.size() - CurrNodeLen;
+      // Store the concatenation of lengths down from the root in the children.
+      for (SuffixTreeNode *Child = CurrNode->FirstChild; Child;
+           Child = Child->NextSibling) {
+        Child->ConcatLen = CurrNodeLen + Child->size();
+        ToVisit.push_back(Child);
+      }
+    }
   }
 
   /// Construct the suffix tree for the prefix of the input ending at
@@ -364,7 +407,8 @@ private:
       unsigned FirstChar = Str[Active.Idx];
 
       // Have we inserted anything starting with FirstChar at the current node?
-      if (Active.Node->Children.count(FirstChar) == 0) {
+      SuffixTreeNode *NextNode = getChild(Active.Node, FirstChar);
+      if (!NextNode) {
         // If not, then we can just insert a leaf and move too the next step.
         insertLeaf(*Active.Node, EndIdx, FirstChar);
 
@@ -377,8 +421,6 @@ private:
       } else {
         // There's a match with FirstChar, so look for the point in the tree to
         // insert a new node.
-        SuffixTreeNode *NextNode = Active.Node->Children[FirstChar];
-
         unsigned SubstringLen = NextNode->size();
 
         // Is the current suffix we're trying to insert longer than the size of
@@ -435,7 +477,7 @@ private:
         // Make the old node a child of the split node and update its start
         // index. This is the node n from the diagram.
         NextNode->StartIdx += Active.Len;
-        SplitNode->Children[Str[NextNode->StartIdx]] = NextNode;
+        setChild(*SplitNode, Str[NextNode->StartIdx], NextNode);
 
         // SplitNode is an internal node, update the suffix link.
         if (NeedsLink)
@@ -467,6 +509,9 @@ public:
   ///
   /// \param Str The string to construct the suffix tree for.
   SuffixTree(const std::vector<unsigned> &Str) : Str(Str) {
+    // There are Str.size() leaves and usually fewer internal nodes, each with
+    // an edge from its parent. Avoid rehashing the edges while building.
+    Edges.reserve(Str.size() + Str.size() / 2);
     Root = insertInternalNode(nullptr, EmptyIdx, EmptyIdx, 0);
     Active.Node = Root;
 
@@ -487,7 +532,7 @@ public:
 
     // Set the suffix indices of each leaf.
     assert(Root && "Root node can't be nullptr!");
-    setSuffixIndices(*Root, 0);
+    setSuffixIndices();
   }
 
 
@@ -532,15 +577,16 @@ public:
         // Iterate over each child, saving internal nodes for visiting, and
         // leaf nodes in LeafChildren. Internal nodes represent individual
         // strings, which may repeat.
-        for (auto &ChildPair : Curr->Children) {
+        for (SuffixTreeNode *Child = Curr->FirstChild; Child;
+             Child = Child->NextSibling) {
           // Save all of this node's children for processing.
-          if (!ChildPair.second->isLeaf())
-            ToVisit.push_back(ChildPair.second);
+          if (!Child->isLeaf())
+            ToVisit.push_back(Child);
 
           // It's not an internal node, so it must be a leaf. If we have a
           // long enough string, then save the leaf children.
           else if (Length >= MinLength)
-            LeafChildren.push_back(ChildPair.second);
+            LeafChildren.push_back(Child);
         }
 
         // The root never represents a repeated substring. If we're looking at
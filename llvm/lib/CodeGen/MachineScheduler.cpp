@@ -122,6 +122,11 @@ static cl::opt<bool> EnableMemOpCluster("misched-cluster", cl::Hidden,
                                         cl::desc("Enable memop clustering."),
                                         cl::init(true));
 
+static cl::opt<unsigned> FastRegionSize("misched-fast-region", cl::Hidden,
+  cl::desc("Number of instructions above which a region is scheduled "
+           "bottom-up with approximate memory dependencies and only the "
+           "register pressure heuristics (0 = never)"), cl::init(8000));
+
 static cl::opt<bool> VerifyScheduling("verify-misched", cl::Hidden,
   cl::desc("Verify machine instrs before and after machine scheduling"));
 
@@ -1252,6 +1257,8 @@ void ScheduleDAGMILive::schedule() {
 
 /// Build the DAG and setup three register pressure trackers.
 void ScheduleDAGMILive::buildDAGWithRegPressure() {
+  ApproximateMemDeps = SchedImpl->shouldApproximateMemDeps();
+
   if (!ShouldTrackPressure) {
     RPTracker.reset();
     RegionCriticalPSets.clear();
@@ -2757,6 +2764,10 @@ void GenericScheduler::initPolicy(MachineBasicBlock::iterator Begin,
   // compile-time optimizations have been implemented in that direction.
   RegionPolicy.OnlyBottomUp = true;
 
+  // The full DAG and heuristics cost too much compile time on huge regions,
+  // e.g. large straight-line code. Keep register pressure awareness there.
+  RegionPolicy.FastRegion = FastRegionSize && NumRegionInstrs > FastRegionSize;
+
   // Allow the subtarget to override default policy.
   MF.getSubtarget().overrideSchedPolicy(RegionPolicy, NumRegionInstrs);
 
@@ -2787,6 +2798,7 @@ void GenericScheduler::dumpPolicy() const {
          << " ShouldTrackPressure=" << RegionPolicy.ShouldTrackPressure
          << " OnlyTopDown=" << RegionPolicy.OnlyTopDown
          << " OnlyBottomUp=" << RegionPolicy.OnlyBottomUp
+         << " FastRegion=" << RegionPolicy.FastRegion
          << "\n";
 #endif
 }
@@ -3012,6 +3024,19 @@ void GenericScheduler::tryCandidate(SchedCandidate &Cand,
                                                DAG->MF))
     return;
 
+  // In fast regions, only the overall pressure and the source order are left.
+  if (RegionPolicy.FastRegion) {
+    if (DAG->isTrackingPressure() && tryPressure(TryCand.RPDelta.CurrentMax,
+                                                 Cand.RPDelta.CurrentMax,
+                                                 TryCand, Cand, RegMax, TRI,
+                                                 DAG->MF))
+      return;
+    if (Zone && ((Zone->isTop() && TryCand.SU->NodeNum < Cand.SU->NodeNum) ||
+                 (!Zone->isTop() && TryCand.SU->NodeNum > Cand.SU->NodeNum)))
+      TryCand.Reason = NodeOrder;
+    return;
+  }
+
   // We only compare a subset of features when comparing nodes between
   // Top and Bottom boundary. Some properties are simply incomparable, in many
   // other instances we should only override the other boundary if something
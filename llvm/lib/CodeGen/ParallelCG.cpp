@@ -49,14 +49,29 @@ std::unique_ptr<Module> llvm::splitCodeGen(
   }
 
   // Create ThreadPool in nested scope so that threads will be joined
-  // on destruction.
+  // on destruction. The last partition is code generated on this thread, so
+  // the pool needs one thread less than there are partitions.
   {
-    ThreadPool CodegenThreadPool(OSs.size());
+    ThreadPool CodegenThreadPool(OSs.size() - 1);
     int ThreadCount = 0;
+    std::unique_ptr<Module> LastPart;
 
     SplitModule(
         std::move(M), OSs.size(),
         [&](std::unique_ptr<Module> MPart) {
+          // The last partition is created after all others have been handed
+          // to the pool, so nothing else uses this context any more. Keep it
+          // to code generate it here directly instead of round-tripping it
+          // through bitcode.
+          if (ThreadCount == int(OSs.size()) - 1) {
+            if (!BCOSs.empty()) {
+              WriteBitcodeToFile(*MPart, *BCOSs[ThreadCount]);
+              BCOSs[ThreadCount]->flush();
+            }
+            LastPart = std::move(MPart);
+            return;
+          }
+
           // We want to clone the module in a new context to multi-thread the
           // codegen. We do it by serializing partition modules to bitcode
           // (while still on the main thread, in order to avoid data races) and
@@ -92,6 +107,12 @@ std::unique_ptr<Module> llvm::splitCodeGen(
               std::move(BC));
         },
         PreserveLocals);
+
+    // SplitModule has destroyed the original module by now, which frees the
+    // memory of the functions that the last partition doesn't define while
+    // the other partitions are being code generated.
+    if (LastPart)
+      codegen(LastPart.get(), *OSs.back(), TMFactory, FileType);
   }
 
   return {};
@@ -84,6 +84,8 @@ using namespace llvm;
 STATISTIC(NumGlobalSplits, "Number of split global live ranges");
 STATISTIC(NumLocalSplits,  "Number of split local live ranges");
 STATISTIC(NumEvicted,      "Number of interferences evicted");
+STATISTIC(NumSplitBudgetExceeded,
+          "Number of region splits that ran out of split candidates");
 
 static cl::opt<SplitEditor::ComplementSpillMode> SplitSpillMode(
     "split-spill-mode", cl::Hidden,
@@ -130,6 +132,20 @@ static cl::opt<unsigned>
                               "high compile time cost in global splitting."),
                      cl::init(5000));
 
+static cl::opt<unsigned> HugeFunctionVRegs(
+    "regalloc-huge-function-vregs", cl::Hidden,
+    cl::desc("Number of virtual registers above which a function is "
+             "allocated with compile time bounded live range splitting "
+             "(0 = never)"),
+    cl::init(50000));
+
+static cl::opt<unsigned> HugeFunctionSplitCandidates(
+    "regalloc-huge-function-split-candidates", cl::Hidden,
+    cl::desc("Maximum number of physical registers evaluated with spill "
+             "placement when region splitting a live range of a huge "
+             "function"),
+    cl::init(4));
+
 // FIXME: Find a good default for this flag and remove the flag.
 static cl::opt<unsigned>
 CSRFirstTimeCost("regalloc-csr-first-time-cost",
@@ -408,6 +424,11 @@ class RAGreedy : public MachineFunctionPass,
   /// by a split candidate when choosing the best split candidate.
   bool EnableAdvancedRASplitCost;
 
+  /// Maximum number of split candidates calculateRegionSplitCost runs spill
+  /// placement for. Only limited in huge functions, see
+  /// -regalloc-huge-function-vregs.
+  unsigned SplitCandidateBudget;
+
   /// Set of broken hints that may be reconciled later because of eviction.
   SmallSetVector<LiveInterval *, 8> SetOfBrokenHints;
 
@@ -1849,9 +1870,15 @@ unsigned RAGreedy::tryRegionSplit(LiveInterval &VirtReg, AllocationOrder &Order,
   }
 
   bool CanCauseEvictionChain = false;
-  unsigned BestCand =
-      calculateRegionSplitCost(VirtReg, Order, BestCost, NumCands,
-                               false /*IgnoreCSR*/, &CanCauseEvictionChain);
+  unsigned BestCand;
+  {
+    NamedRegionTimer T("region_split_cost", "Region Split Cost",
+                       TimerGroupName, TimerGroupDescription,
+                       TimePassesIsEnabled);
+    BestCand =
+        calculateRegionSplitCost(VirtReg, Order, BestCost, NumCands,
+                                 false /*IgnoreCSR*/, &CanCauseEvictionChain);
+  }
 
   // Split candidates with compact regions can cause a bad eviction sequence.
   // See splitCanCauseEvictionChain for detailed description of scenarios.
@@ -1875,11 +1902,21 @@ unsigned RAGreedy::calculateRegionSplitCost(LiveInterval &VirtReg,
                                             unsigned &NumCands, bool IgnoreCSR,
                                             bool *CanCauseEvictionChain) {
   unsigned BestCand = NoCand;
+  unsigned Budget = SplitCandidateBudget;
   Order.rewind();
   while (unsigned PhysReg = Order.next()) {
     if (IgnoreCSR && isUnusedCalleeSavedReg(PhysReg))
       continue;
 
+    // Spill placement is the expensive part, stop once the budget is used up
+    // and go with the best candidate so far.
+    if (!Budget) {
+      LLVM_DEBUG(dbgs() << "Split candidate budget exhausted.\n");
+      ++NumSplitBudgetExceeded;
+      break;
+    }
+    --Budget;
+
     // Discard bad candidates before we run out of interference cache cursors.
     // This will only affect register classes with a lot of registers (>32).
     if (NumCands == IntfCache.getMaxCursors()) {
@@ -3223,6 +3260,18 @@ bool RAGreedy::runOnMachineFunction(MachineFunction &mf) {
   EnableAdvancedRASplitCost = ConsiderLocalIntervalCost ||
                               MF->getSubtarget().enableAdvancedRASplitCost();
 
+  // Global splitting costs several spill placements per live range, which
+  // does not scale to functions with a huge number of virtual registers. Give
+  // those a small candidate budget and skip the local interval costs; split
+  // ranges that find no candidate in budget are split per block instead.
+  SplitCandidateBudget = ~0u;
+  if (HugeFunctionVRegs &&
+      mf.getRegInfo().getNumVirtRegs() > HugeFunctionVRegs) {
+    LLVM_DEBUG(dbgs() << "Huge function, limiting the global split budget\n");
+    SplitCandidateBudget = HugeFunctionSplitCandidates;
+    EnableAdvancedRASplitCost = false;
+  }
+
   if (VerifyEnabled)
     MF->verify(this, "Before greedy register allocator");
 
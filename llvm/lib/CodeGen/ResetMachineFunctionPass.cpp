@@ -20,7 +20,11 @@
 #include "llvm/CodeGen/StackProtector.h"
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
 using namespace llvm;
 
 #define DEBUG_TYPE "reset-machine-function"
@@ -28,6 +32,11 @@ using namespace llvm;
 STATISTIC(NumFunctionsReset, "Number of functions reset");
 STATISTIC(NumFunctionsVisited, "Number of functions visited");
 
+static cl::opt<bool> FallbackReport(
+    "global-isel-fallback-report", cl::Hidden, cl::init(false),
+    cl::desc("Print, for each module, how many functions GlobalISel failed "
+             "to select and which ones"));
+
 namespace {
   class ResetMachineFunction : public MachineFunctionPass {
     /// Tells whether or not this pass should emit a fallback
@@ -35,6 +44,10 @@ namespace {
     bool EmitFallbackDiag;
     /// Whether we should abort immediately instead of resetting the function.
     bool AbortOnFailedISel;
+    /// The number of functions visited in the current module, and the names of
+    /// those that were reset, for -global-isel-fallback-report.
+    unsigned NumVisited = 0;
+    std::vector<std::string> ResetFunctions;
 
   public:
     static char ID; // Pass identification, replacement for typeid
@@ -50,8 +63,23 @@ namespace {
       MachineFunctionPass::getAnalysisUsage(AU);
     }
 
+    bool doFinalization(Module &M) override {
+      if (FallbackReport && NumVisited) {
+        errs() << "GlobalISel fell back for " << ResetFunctions.size()
+               << " of " << NumVisited << " functions ("
+               << format("%.1f%%", 100.0 * ResetFunctions.size() / NumVisited)
+               << ") in '" << M.getModuleIdentifier() << "'\n";
+        for (const std::string &Name : ResetFunctions)
+          errs() << "  " << Name << '\n';
+      }
+      NumVisited = 0;
+      ResetFunctions.clear();
+      return false;
+    }
+
     bool runOnMachineFunction(MachineFunction &MF) override {
       ++NumFunctionsVisited;
+      ++NumVisited;
       // No matter what happened, whether we successfully selected the function
       // or not, nothing is going to use the vreg types after us. Make sure they
       // disappear.
@@ -64,6 +92,8 @@ namespace {
           report_fatal_error("Instruction selection failed");
         LLVM_DEBUG(dbgs() << "Resetting: " << MF.getName() << '\n');
         ++NumFunctionsReset;
+        if (FallbackReport)
+          ResetFunctions.push_back(MF.getName());
         MF.reset();
         if (EmitFallbackDiag) {
           const Function &F = MF.getFunction();
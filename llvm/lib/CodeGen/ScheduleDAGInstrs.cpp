@@ -88,6 +88,11 @@ static cl::opt<unsigned> ReductionSize(
     cl::desc("A huge scheduling region will have maps reduced by this many "
              "nodes at a time. Defaults to HugeRegion / 2."));
 
+static cl::opt<unsigned> ApproximateRegion(
+    "dag-maps-approximate-region", cl::Hidden, cl::init(64),
+    cl::desc("The limit used instead of -dag-maps-huge-region when the DAG "
+             "is built with approximate memory dependencies."));
+
 static unsigned getReductionSize() {
   // Always reduce a huge region with half of the elements, except
   // when user sets this number explicitly.
@@ -709,7 +714,11 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
   const TargetSubtargetInfo &ST = MF.getSubtarget();
   bool UseAA = EnableAASchedMI.getNumOccurrences() > 0 ? EnableAASchedMI
                                                        : ST.useAA();
-  AAForDep = UseAA ? AA : nullptr;
+  AAForDep = UseAA && !ApproximateMemDeps ? AA : nullptr;
+  unsigned MapLimit = ApproximateMemDeps ? unsigned(ApproximateRegion)
+                                         : unsigned(HugeRegion);
+  unsigned MapReduction =
+      ApproximateMemDeps ? MapLimit / 2 : getReductionSize();
 
   BarrierChain = nullptr;
 
@@ -950,14 +959,14 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
     }
 
     // Reduce maps if they grow huge.
-    if (Stores.size() + Loads.size() >= HugeRegion) {
+    if (Stores.size() + Loads.size() >= MapLimit) {
       LLVM_DEBUG(dbgs() << "Reducing Stores and Loads maps.\n";);
-      reduceHugeMemNodeMaps(Stores, Loads, getReductionSize());
+      reduceHugeMemNodeMaps(Stores, Loads, MapReduction);
     }
-    if (NonAliasStores.size() + NonAliasLoads.size() >= HugeRegion) {
+    if (NonAliasStores.size() + NonAliasLoads.size() >= MapLimit) {
       LLVM_DEBUG(
           dbgs() << "Reducing NonAliasStores and NonAliasLoads maps.\n";);
-      reduceHugeMemNodeMaps(NonAliasStores, NonAliasLoads, getReductionSize());
+      reduceHugeMemNodeMaps(NonAliasStores, NonAliasLoads, MapReduction);
     }
   }
 
@@ -84,6 +84,10 @@ STATISTIC(OpsNarrowed     , "Number of load/op/store narrowed");
 STATISTIC(LdStFP2Int      , "Number of fp load/store pairs transformed to int");
 STATISTIC(SlicedLoads, "Number of load sliced");
 STATISTIC(NumFPLogicOpsConv, "Number of logic ops converted to fp ops");
+STATISTIC(CombineAttempts, "Number of nodes visited by the DAG combiner");
+STATISTIC(NodesPruned, "Number of dead nodes pruned from the worklist");
+STATISTIC(NodesVisitLimited,
+          "Number of nodes not combined again after reaching the visit limit");
 
 static cl::opt<bool>
 CombinerGlobalAA("combiner-global-alias-analysis", cl::Hidden,
@@ -107,6 +111,14 @@ StressLoadSlicing("combiner-stress-load-slicing", cl::Hidden,
                   cl::desc("Bypass the profitability model of load slicing"),
                   cl::init(false));
 
+/// Hidden option to bound the number of times a single node is combined in one
+/// run of the combiner, so that two combines undoing each other's work cannot
+/// keep the worklist busy for ever. Zero means no limit.
+static cl::opt<unsigned>
+MaxNodeVisits("combiner-max-node-visits", cl::Hidden, cl::init(256),
+              cl::desc("Maximum number of times the DAG combiner visits a "
+                       "single node (0 = unlimited)"));
+
 static cl::opt<bool>
   MaySplitLoadIndex("combiner-split-load-index", cl::Hidden, cl::init(true),
                     cl::desc("DAG combiner may split indexing from loads"));
@@ -148,6 +160,10 @@ namespace {
     /// which have not yet been combined to the worklist.
     SmallPtrSet<SDNode *, 32> CombinedNodes;
 
+    /// Number of times each node has been combined in this run, see
+    /// -combiner-max-node-visits.
+    DenseMap<SDNode *, unsigned> VisitCounts;
+
     // AA - Used for DAG load/store alias analysis.
     AliasAnalysis *AA;
 
@@ -165,8 +181,8 @@ namespace {
       // Check any nodes added to the worklist to see if they are prunable.
       while (!PruningList.empty()) {
         auto *N = PruningList.pop_back_val();
-        if (N->use_empty())
-          recursivelyDeleteUnusedNodes(N);
+        if (N->use_empty() && recursivelyDeleteUnusedNodes(N))
+          ++NodesPruned;
       }
     }
 
@@ -232,6 +248,8 @@ namespace {
     void removeFromWorklist(SDNode *N) {
       CombinedNodes.erase(N);
       PruningList.remove(N);
+      // The node may be deleted and its memory reused by a new node.
+      VisitCounts.erase(N);
 
       auto It = WorklistMap.find(N);
       if (It == WorklistMap.end())
@@ -1502,6 +1520,16 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
         continue;
     }
 
+    // Stop combining a node that keeps being put back on the worklist; it has
+    // been legalized above, which is all later phases rely on.
+    unsigned &Visits = VisitCounts[N];
+    if (MaxNodeVisits && Visits >= MaxNodeVisits) {
+      ++NodesVisitLimited;
+      continue;
+    }
+    ++Visits;
+    ++CombineAttempts;
+
     LLVM_DEBUG(dbgs() << "\nCombining: "; N->dump(&DAG));
 
     // Add any operands of the new node which have not yet been combined to the
@@ -1015,6 +1015,11 @@ void SelectionDAG::init(MachineFunction &NewMF,
   LibInfo = LibraryInfo;
   Context = &MF->getFunction().getContext();
   DA = Divergence;
+
+  // The operand arrays are kept across the blocks of a function by clear(), and
+  // given back here, once for every function.
+  OperandRecycler.clear(OperandAllocator);
+  OperandAllocator.Reset();
 }
 
 SelectionDAG::~SelectionDAG() {
@@ -1075,9 +1080,9 @@ SDNode *SelectionDAG::FindNodeOrInsertPos(const FoldingSetNodeID &ID,
 }
 
 void SelectionDAG::clear() {
+  // Nodes and their operand arrays go back to the recyclers, to be reused by
+  // the DAG of the next block without allocating again.
   allnodes_clear();
-  OperandRecycler.clear(OperandAllocator);
-  OperandAllocator.Reset();
   CSEMap.clear();
 
   ExtendedValueTypeNodes.clear();
@@ -873,6 +873,18 @@ Expected<const DWARFDebugLine::LineTable *> DWARFContext::getLineTableForUnit(
                                    RecoverableErrorCallback);
 }
 
+void DWARFContext::clearLineTableForUnit(DWARFUnit *U) {
+  if (!Line)
+    return;
+
+  auto UnitDIE = U->getUnitDIE();
+  if (!UnitDIE)
+    return;
+
+  if (auto Offset = toSectionOffset(UnitDIE.find(DW_AT_stmt_list)))
+    Line->clearLineTable(*Offset + U->getLineTableOffset());
+}
+
 void DWARFContext::parseNormalUnits() {
   if (!NormalUnits.empty())
     return;
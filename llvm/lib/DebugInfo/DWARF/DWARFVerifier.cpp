@@ -16,6 +16,7 @@
 #include "llvm/DebugInfo/DWARF/DWARFSection.h"
 #include "llvm/Support/DJB.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <map>
@@ -1435,22 +1436,43 @@ unsigned DWARFVerifier::verifyDebugNames(const DWARFSection &AccelSection,
   // Don't attempt Entry validation if any of the previous checks found errors
   if (NumErrors > 0)
     return NumErrors;
+
+  // The remaining checks only read the debug info, and can look at the name
+  // indices and the compile units independently of each other, once all the
+  // data they need has been parsed.
+  std::vector<const DWARFDebugNames::NameIndex *> NameIndices;
   for (const auto &NI : AccelTable)
-    for (DWARFDebugNames::NameTableEntry NTE : NI)
-      NumErrors += verifyNameIndexEntries(NI, NTE);
+    NameIndices.push_back(&NI);
+  std::vector<std::pair<DWARFCompileUnit *, const DWARFDebugNames::NameIndex *>>
+      IndexedCUs;
+  for (const std::unique_ptr<DWARFUnit> &U : DCtx.compile_units()) {
+    U->getNumDIEs();
+    if (const DWARFDebugNames::NameIndex *NI =
+            AccelTable.getCUNameIndex(U->getOffset()))
+      IndexedCUs.emplace_back(cast<DWARFCompileUnit>(U.get()), NI);
+  }
+  DCtx.getDebugLoc();
+
+  NumErrors += runIndependentChecks(
+      NameIndices.size(), [&](DWARFVerifier &V, size_t I) {
+        unsigned NumErrors = 0;
+        for (DWARFDebugNames::NameTableEntry NTE : *NameIndices[I])
+          NumErrors += V.verifyNameIndexEntries(*NameIndices[I], NTE);
+        return NumErrors;
+      });
 
   if (NumErrors > 0)
     return NumErrors;
 
-  for (const std::unique_ptr<DWARFUnit> &U : DCtx.compile_units()) {
-    if (const DWARFDebugNames::NameIndex *NI =
-            AccelTable.getCUNameIndex(U->getOffset())) {
-      auto *CU = cast<DWARFCompileUnit>(U.get());
-      for (const DWARFDebugInfoEntry &Die : CU->dies())
-        NumErrors += verifyNameIndexCompleteness(DWARFDie(CU, &Die), *NI);
-    }
-  }
-  return NumErrors;
+  return runIndependentChecks(
+      IndexedCUs.size(), [&](DWARFVerifier &V, size_t I) {
+        unsigned NumErrors = 0;
+        DWARFCompileUnit *CU = IndexedCUs[I].first;
+        for (const DWARFDebugInfoEntry &Die : CU->dies())
+          NumErrors += V.verifyNameIndexCompleteness(DWARFDie(CU, &Die),
+                                                     *IndexedCUs[I].second);
+        return NumErrors;
+      });
 }
 
 bool DWARFVerifier::handleAccelTables() {
@@ -1475,6 +1497,33 @@ bool DWARFVerifier::handleAccelTables() {
   return NumErrors == 0;
 }
 
+unsigned DWARFVerifier::runIndependentChecks(
+    size_t NumChecks, function_ref<unsigned(DWARFVerifier &, size_t)> Check) {
+  unsigned NumErrors = 0;
+  if (DumpOpts.VerifyThreads <= 1 || NumChecks <= 1) {
+    for (size_t I = 0; I != NumChecks; ++I)
+      NumErrors += Check(*this, I);
+    return NumErrors;
+  }
+
+  std::vector<std::string> Outputs(NumChecks);
+  std::vector<unsigned> Errors(NumChecks);
+  ThreadPool Pool(std::min<size_t>(DumpOpts.VerifyThreads, NumChecks));
+  for (size_t I = 0; I != NumChecks; ++I)
+    Pool.async([&, I]() {
+      raw_string_ostream CheckOS(Outputs[I]);
+      DWARFVerifier V(CheckOS, DCtx, DumpOpts);
+      Errors[I] = Check(V, I);
+    });
+  Pool.wait();
+
+  for (size_t I = 0; I != NumChecks; ++I) {
+    OS << Outputs[I];
+    NumErrors += Errors[I];
+  }
+  return NumErrors;
+}
+
 raw_ostream &DWARFVerifier::error() const { return WithColor::error(OS); }
 
 raw_ostream &DWARFVerifier::warn() const { return WithColor::warning(OS); }
@@ -20,6 +20,7 @@
 #include "llvm/DebugInfo/PDB/Native/Hash.h"
 #include "llvm/Support/BinaryItemStream.h"
 #include "llvm/Support/BinaryStreamWriter.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/xxhash.h"
 #include <algorithm>
 #include <vector>
@@ -114,47 +115,93 @@ static bool isAsciiString(StringRef S) {
   return llvm::all_of(S, [](char C) { return unsigned(C) < 0x80; });
 }
 
-// See `caseInsensitiveComparePchPchCchCch` in gsi.cpp
-static bool gsiRecordLess(StringRef S1, StringRef S2) {
+// See `caseInsensitiveComparePchPchCchCch` in gsi.cpp. \p IsAscii tells
+// whether both strings are ascii.
+static int gsiRecordCmp(StringRef S1, StringRef S2, bool IsAscii) {
   size_t LS = S1.size();
   size_t RS = S2.size();
   // Shorter strings always compare less than longer strings.
   if (LS != RS)
-    return LS < RS;
+    return LS < RS ? -1 : 1;
 
   // If either string contains non ascii characters, memcmp them.
-  if (LLVM_UNLIKELY(!isAsciiString(S1) || !isAsciiString(S2)))
-    return memcmp(S1.data(), S2.data(), LS) < 0;
+  if (LLVM_UNLIKELY(!IsAscii))
+    return memcmp(S1.data(), S2.data(), LS);
 
   // Both strings are ascii, perform a case-insenstive comparison.
-  return S1.compare_lower(S2.data()) < 0;
+  return S1.compare_lower(S2.data());
 }
 
 void GSIHashStreamBuilder::finalizeBuckets(uint32_t RecordZeroOffset) {
-  std::array<std::vector<std::pair<StringRef, PSHashRecord>>, IPHR_HASH + 1>
-      TmpBuckets;
-  uint32_t SymOffset = RecordZeroOffset;
-  for (const CVSymbol &Sym : Records) {
+  struct HashedRecord {
+    StringRef Name;
     PSHashRecord HR;
-    // Add one when writing symbol offsets to disk. See GSI1::fixSymRecs.
-    HR.Off = SymOffset + 1;
-    HR.CRef = 1; // Always use a refcount of 1.
+    uint32_t BucketIdx;
+    bool IsAscii;
+  };
 
-    // Hash the name to figure out which bucket this goes into.
-    StringRef Name = getSymbolName(Sym);
-    size_t BucketIdx = hashStringV1(Name) % IPHR_HASH;
-    TmpBuckets[BucketIdx].push_back(std::make_pair(Name, HR));
-    SymOffset += Sym.length();
+  // Compute the offset of each record up front, so that finding the names and
+  // hashing them, which is most of the work, can be done in parallel.
+  std::vector<HashedRecord> Hashed(Records.size());
+  uint32_t SymOffset = RecordZeroOffset;
+  for (size_t I = 0, E = Records.size(); I != E; ++I) {
+    // Add one when writing symbol offsets to disk. See GSI1::fixSymRecs.
+    Hashed[I].HR.Off = SymOffset + 1;
+    Hashed[I].HR.CRef = 1; // Always use a refcount of 1.
+    SymOffset += Records[I].length();
   }
+  parallel::for_each_n(parallel::par, size_t(0), Records.size(),
+                       [&](size_t I) {
+                         // Hash the name to figure out which bucket this goes
+                         // into.
+                         StringRef Name = getSymbolName(Records[I]);
+                         Hashed[I].Name = Name;
+                         Hashed[I].IsAscii = isAsciiString(Name);
+                         Hashed[I].BucketIdx = hashStringV1(Name) % IPHR_HASH;
+                       });
+
+  // Group the records by bucket with a counting sort. BucketStarts[I] is the
+  // index in Sorted of the first record of bucket I; a bucket ends where the
+  // next one starts.
+  std::vector<uint32_t> BucketStarts(IPHR_HASH + 2, 0);
+  for (const HashedRecord &H : Hashed)
+    ++BucketStarts[H.BucketIdx + 2];
+  for (size_t BucketIdx = 2; BucketIdx < BucketStarts.size(); ++BucketIdx)
+    BucketStarts[BucketIdx] += BucketStarts[BucketIdx - 1];
+  std::vector<HashedRecord> Sorted(Hashed.size());
+  for (const HashedRecord &H : Hashed)
+    Sorted[BucketStarts[H.BucketIdx + 1]++] = H;
+
+  // Sort each bucket by memcmp of the symbol's name.  It's important that
+  // we use the same sorting algorithm as is used by the reference
+  // implementation to ensure that the search for a record within a bucket
+  // can properly early-out when it detects the record won't be found.  The
+  // algorithm used here corredsponds to the function
+  // caseInsensitiveComparePchPchCchCch in the reference implementation.
+  // Records that compare equal are kept in record order, so that the output
+  // does not depend on the sort.
+  parallel::for_each_n(
+      parallel::par, size_t(0), size_t(IPHR_HASH + 1), [&](size_t BucketIdx) {
+        llvm::sort(Sorted.begin() + BucketStarts[BucketIdx],
+                   Sorted.begin() + BucketStarts[BucketIdx + 1],
+                   [](const HashedRecord &Left, const HashedRecord &Right) {
+                     if (int Cmp = gsiRecordCmp(Left.Name, Right.Name,
+                                                Left.IsAscii && Right.IsAscii))
+                       return Cmp < 0;
+                     return Left.HR.Off < Right.HR.Off;
+                   });
+      });
 
   // Compute the three tables: the hash records in bucket and chain order, the
   // bucket presence bitmap, and the bucket chain start offsets.
   HashRecords.reserve(Records.size());
+  for (const HashedRecord &H : Sorted)
+    HashRecords.push_back(H.HR);
   for (ulittle32_t &Word : HashBitmap)
     Word = 0;
   for (size_t BucketIdx = 0; BucketIdx < IPHR_HASH + 1; ++BucketIdx) {
-    auto &Bucket = TmpBuckets[BucketIdx];
-    if (Bucket.empty())
+    uint32_t ChainStart = BucketStarts[BucketIdx];
+    if (ChainStart == BucketStarts[BucketIdx + 1])
       continue;
     HashBitmap[BucketIdx / 32] |= 1U << (BucketIdx % 32);
 
@@ -162,23 +209,7 @@ void GSIHashStreamBuilder::finalizeBuckets(uint32_t RecordZeroOffset) {
     // be if it were inflated to contain 32-bit pointers. On a 32-bit system,
     // each record would be 12 bytes. See HROffsetCalc in gsi.h.
     const int SizeOfHROffsetCalc = 12;
-    ulittle32_t ChainStartOff =
-        ulittle32_t(HashRecords.size() * SizeOfHROffsetCalc);
-    HashBuckets.push_back(ChainStartOff);
-
-    // Sort each bucket by memcmp of the symbol's name.  It's important that
-    // we use the same sorting algorithm as is used by the reference
-    // implementation to ensure that the search for a record within a bucket
-    // can properly early-out when it detects the record won't be found.  The
-    // algorithm used here corredsponds to the function
-    // caseInsensitiveComparePchPchCchCch in the reference implementation.
-    llvm::sort(Bucket, [](const std::pair<StringRef, PSHashRecord> &Left,
-                          const std::pair<StringRef, PSHashRecord> &Right) {
-      return gsiRecordLess(Left.first, Right.first);
-    });
-
-    for (const auto &Entry : Bucket)
-      HashRecords.push_back(Entry.second);
+    HashBuckets.push_back(ulittle32_t(ChainStart * SizeOfHROffsetCalc));
   }
 }
 
@@ -229,49 +260,56 @@ Error GSIStreamBuilder::finalizeMsfLayout() {
   return Error::success();
 }
 
-static bool comparePubSymByAddrAndName(
-    const std::pair<const CVSymbol *, const PublicSym32 *> &LS,
-    const std::pair<const CVSymbol *, const PublicSym32 *> &RS) {
-  if (LS.second->Segment != RS.second->Segment)
-    return LS.second->Segment < RS.second->Segment;
-  if (LS.second->Offset != RS.second->Offset)
-    return LS.second->Offset < RS.second->Offset;
-
-  return LS.second->Name < RS.second->Name;
+/// Compare the publics at \p L and \p R by address, then by name. Publics
+/// that compare equal are kept in record order.
+static bool comparePubSymByAddrAndName(ArrayRef<PublicSym32> Publics,
+                                       uint32_t L, uint32_t R) {
+  const PublicSym32 &LS = Publics[L];
+  const PublicSym32 &RS = Publics[R];
+  if (LS.Segment != RS.Segment)
+    return LS.Segment < RS.Segment;
+  if (LS.Offset != RS.Offset)
+    return LS.Offset < RS.Offset;
+  if (LS.Name != RS.Name)
+    return LS.Name < RS.Name;
+
+  return L < R;
 }
 
 /// Compute the address map. The address map is an array of symbol offsets
 /// sorted so that it can be binary searched by address.
 static std::vector<ulittle32_t> computeAddrMap(ArrayRef<CVSymbol> Records) {
-  // Make a vector of pointers to the symbols so we can sort it by address.
-  // Also gather the symbol offsets while we're at it.
-
-  std::vector<PublicSym32> DeserializedPublics;
-  std::vector<std::pair<const CVSymbol *, const PublicSym32 *>> PublicsByAddr;
+  // Gather the symbol offsets, then deserialize the symbols in parallel and
+  // sort their indices by address.
   std::vector<uint32_t> SymOffsets;
-  DeserializedPublics.reserve(Records.size());
-  PublicsByAddr.reserve(Records.size());
   SymOffsets.reserve(Records.size());
-
   uint32_t SymOffset = 0;
   for (const CVSymbol &Sym : Records) {
     assert(Sym.kind() == SymbolKind::S_PUB32);
-    DeserializedPublics.push_back(
-        cantFail(SymbolDeserializer::deserializeAs<PublicSym32>(Sym)));
-    PublicsByAddr.emplace_back(&Sym, &DeserializedPublics.back());
     SymOffsets.push_back(SymOffset);
     SymOffset += Sym.length();
   }
-  llvm::stable_sort(PublicsByAddr, comparePubSymByAddrAndName);
+
+  std::vector<PublicSym32> DeserializedPublics(Records.size());
+  std::vector<uint32_t> PublicsByAddr(Records.size());
+  parallel::for_each_n(parallel::par, size_t(0), Records.size(),
+                       [&](size_t I) {
+                         DeserializedPublics[I] = cantFail(
+                             SymbolDeserializer::deserializeAs<PublicSym32>(
+                                 Records[I]));
+                         PublicsByAddr[I] = I;
+                       });
+  parallel::sort(parallel::par, PublicsByAddr.begin(), PublicsByAddr.end(),
+                 [&](uint32_t L, uint32_t R) {
+                   return comparePubSymByAddrAndName(DeserializedPublics, L,
+                                                     R);
+                 });
 
   // Fill in the symbol offsets in the appropriate order.
   std::vector<ulittle32_t> AddrMap;
   AddrMap.reserve(Records.size());
-  for (auto &Sym : PublicsByAddr) {
-    ptrdiff_t Idx = std::distance(Records.data(), Sym.first);
-    assert(Idx >= 0 && size_t(Idx) < Records.size());
+  for (uint32_t Idx : PublicsByAddr)
     AddrMap.push_back(ulittle32_t(SymOffsets[Idx]));
-  }
   return AddrMap;
 }
 
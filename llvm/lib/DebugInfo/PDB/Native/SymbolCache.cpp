@@ -5,6 +5,7 @@
 #include "llvm/DebugInfo/CodeView/TypeRecordHelpers.h"
 #include "llvm/DebugInfo/PDB/Native/DbiStream.h"
 #include "llvm/DebugInfo/PDB/Native/GlobalsStream.h"
+#include "llvm/DebugInfo/PDB/Native/ISectionContribVisitor.h"
 #include "llvm/DebugInfo/PDB/Native/NativeCompilandSymbol.h"
 #include "llvm/DebugInfo/PDB/Native/NativeEnumGlobals.h"
 #include "llvm/DebugInfo/PDB/Native/NativeEnumTypes.h"
@@ -19,6 +20,7 @@
 #include "llvm/DebugInfo/PDB/Native/NativeTypeUDT.h"
 #include "llvm/DebugInfo/PDB/Native/NativeTypeVTShape.h"
 #include "llvm/DebugInfo/PDB/Native/PDBFile.h"
+#include "llvm/DebugInfo/PDB/Native/RawTypes.h"
 #include "llvm/DebugInfo/PDB/Native/SymbolStream.h"
 #include "llvm/DebugInfo/PDB/Native/TpiStream.h"
 #include "llvm/DebugInfo/PDB/PDBSymbol.h"
@@ -281,6 +283,56 @@ SymIndexId SymbolCache::getOrCreateGlobalSymbolByOffset(uint32_t Offset) {
   return Id;
 }
 
+namespace {
+// Collects the section contributions of the DBI stream, of either version.
+class SectionContribCollector : public ISectionContribVisitor {
+public:
+  std::vector<SectionContrib> Contribs;
+
+  void visit(const SectionContrib &C) override { Contribs.push_back(C); }
+  void visit(const SectionContrib2 &C) override {
+    Contribs.push_back(C.Base);
+  }
+};
+} // namespace
+
+void SymbolCache::readSectionContribs() {
+  SectionContribsRead = true;
+  if (!Dbi)
+    return;
+
+  SectionContribCollector Collector;
+  Dbi->visitSectionContributions(Collector);
+  for (const SectionContrib &C : Collector.Contribs)
+    if (C.Size > 0)
+      SectionContribs.push_back({C.ISect, uint32_t(C.Off), uint32_t(C.Size),
+                                 C.Imod});
+  llvm::sort(SectionContribs, [](const SectionContribEntry &L,
+                                 const SectionContribEntry &R) {
+    return std::tie(L.ISect, L.Off) < std::tie(R.ISect, R.Off);
+  });
+}
+
+Optional<uint16_t> SymbolCache::getModuleIndexForSectOffset(uint32_t Sect,
+                                                            uint32_t Offset) {
+  if (!SectionContribsRead)
+    readSectionContribs();
+
+  // Find the last contribution that starts at or before the offset.
+  auto It = llvm::upper_bound(
+      SectionContribs, std::make_pair(Sect, Offset),
+      [](const std::pair<uint32_t, uint32_t> &Addr,
+         const SectionContribEntry &C) {
+        return Addr < std::make_pair(C.ISect, C.Off);
+      });
+  if (It == SectionContribs.begin())
+    return None;
+  --It;
+  if (It->ISect != Sect || Offset - It->Off >= It->Size)
+    return None;
+  return It->Imod;
+}
+
 std::unique_ptr<PDBSymbolCompiland>
 SymbolCache::getOrCreateCompiland(uint32_t Index) {
   if (!Dbi)
@@ -140,6 +140,25 @@ void LLVMSymbolizer::flush() {
   BinaryForPath.clear();
   ObjectPairForPathArch.clear();
   Modules.clear();
+  CacheSize = 0;
+}
+
+void LLVMSymbolizer::pruneCache(const std::string &KeepModule) {
+  while (Opts.MaxCacheSize && CacheSize > Opts.MaxCacheSize) {
+    auto LRU = Modules.end();
+    for (auto I = Modules.begin(), E = Modules.end(); I != E; ++I) {
+      // Modules that failed to load take no space, and we don't want to
+      // report their errors again.
+      if (!I->second.Module || I->first == KeepModule)
+        continue;
+      if (LRU == Modules.end() || I->second.LastUse < LRU->second.LastUse)
+        LRU = I;
+    }
+    if (LRU == Modules.end())
+      return;
+    CacheSize -= LRU->second.Size;
+    Modules.erase(LRU);
+  }
 }
 
 namespace {
@@ -382,7 +401,8 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName,
                                       StringRef DWPName) {
   const auto &I = Modules.find(ModuleName);
   if (I != Modules.end()) {
-    return I->second.get();
+    I->second.LastUse = ++UseCounter;
+    return I->second.Module.get();
   }
   std::string BinaryName = ModuleName;
   std::string ArchName = Opts.DefaultArch;
@@ -398,8 +418,7 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName,
   auto ObjectsOrErr = getOrCreateObjectPair(BinaryName, ArchName);
   if (!ObjectsOrErr) {
     // Failed to find valid object file.
-    Modules.insert(
-        std::make_pair(ModuleName, std::unique_ptr<SymbolizableModule>()));
+    Modules.insert(std::make_pair(ModuleName, CachedModule()));
     return ObjectsOrErr.takeError();
   }
   ObjectPair Objects = ObjectsOrErr.get();
@@ -416,8 +435,7 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName,
       std::unique_ptr<IPDBSession> Session;
       if (auto Err = loadDataForEXE(PDB_ReaderType::DIA,
                                     Objects.first->getFileName(), Session)) {
-        Modules.insert(
-            std::make_pair(ModuleName, std::unique_ptr<SymbolizableModule>()));
+        Modules.insert(std::make_pair(ModuleName, CachedModule()));
         // Return along the PDB filename to provide more context
         return createFileError(PDBFileName, std::move(Err));
       }
@@ -430,15 +448,22 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName,
   assert(Context);
   auto InfoOrErr =
       SymbolizableObjectFile::create(Objects.first, std::move(Context));
-  std::unique_ptr<SymbolizableModule> SymMod;
-  if (InfoOrErr)
-    SymMod = std::move(InfoOrErr.get());
+  CachedModule Cached;
+  if (InfoOrErr) {
+    Cached.Module = std::move(InfoOrErr.get());
+    Cached.Size = Objects.first->getData().size();
+    if (Objects.second != Objects.first)
+      Cached.Size += Objects.second->getData().size();
+    Cached.LastUse = ++UseCounter;
+    CacheSize += Cached.Size;
+  }
   auto InsertResult =
-      Modules.insert(std::make_pair(ModuleName, std::move(SymMod)));
+      Modules.insert(std::make_pair(ModuleName, std::move(Cached)));
   assert(InsertResult.second);
   if (auto EC = InfoOrErr.getError())
     return errorCodeToError(EC);
-  return InsertResult.first->second.get();
+  pruneCache(ModuleName);
+  return InsertResult.first->second.Module.get();
 }
 
 namespace {
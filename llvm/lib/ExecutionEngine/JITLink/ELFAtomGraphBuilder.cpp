@@ -0,0 +1,424 @@
+//=---------- ELFAtomGraphBuilder.cpp - ELF AtomGraph builder -------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Generic ELF AtomGraph building code.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ELFAtomGraphBuilder.h"
+
+#define DEBUG_TYPE "jitlink"
+
+namespace llvm {
+namespace jitlink {
+
+// The linker appends a zero-length record to the contents of all .eh_frame
+// sections. __register_frame relies on it to find the end of the section.
+static const char EHFrameTerminator[4] = {0, 0, 0, 0};
+
+ELFAtomGraphBuilder::~ELFAtomGraphBuilder() {}
+
+Expected<std::unique_ptr<AtomGraph>> ELFAtomGraphBuilder::buildGraph() {
+  if (auto Err = parseSections())
+    return std::move(Err);
+
+  if (auto Err = addAtoms())
+    return std::move(Err);
+
+  if (auto Err = addRelocations())
+    return std::move(Err);
+
+  return std::move(G);
+}
+
+ELFAtomGraphBuilder::ELFAtomGraphBuilder(const object::ELFObjectFileBase &Obj)
+    : Obj(Obj),
+      G(llvm::make_unique<AtomGraph>(Obj.getFileName(), getPointerSize(Obj),
+                                     getEndianness(Obj))) {}
+
+Optional<JITTargetAddress>
+ELFAtomGraphBuilder::getSectionAddress(const object::SectionRef &S) {
+  if (auto *ES = getSection(S))
+    return ES->Address;
+  return None;
+}
+
+Expected<DefinedAtom &>
+ELFAtomGraphBuilder::findAtomInSection(const object::SectionRef &S,
+                                       JITTargetAddress Address) {
+  if (auto *ES = getSection(S))
+    if (auto *DA = getAtomInSection(*ES, Address))
+      return *DA;
+  return make_error<JITLinkError>("No atom at address " +
+                                  formatv("{0:x16}", Address));
+}
+
+Expected<std::pair<Atom *, int64_t>>
+ELFAtomGraphBuilder::getRelocationTarget(const object::RelocationRef &Rel,
+                                         int64_t Addend) {
+  auto SymI = Rel.getSymbol();
+  if (SymI == Obj.symbol_end())
+    return make_error<JITLinkError>("Relocation without a symbol at offset " +
+                                    formatv("{0:x8}", Rel.getOffset()));
+  object::ELFSymbolRef Sym(*SymI);
+
+  // Named atoms are targeted directly so that GOT entries, stubs and
+  // overriding definitions apply.
+  auto AtomI = SymbolAtoms.find(Sym.getRawDataRefImpl().p);
+  if (AtomI != SymbolAtoms.end()) {
+    Atom &A = *AtomI->second;
+    if (A.isDefined()) {
+      // Local symbols may share the atom of another symbol.
+      auto SymAddr = getSymbolAddress(Sym);
+      if (!SymAddr)
+        return SymAddr.takeError();
+      Addend += *SymAddr - A.getAddress();
+    }
+    return std::make_pair(&A, Addend);
+  }
+
+  // Otherwise this is a section-relative reference: find the atom covering
+  // the target address.
+  auto SecI = Sym.getSection();
+  if (!SecI)
+    return SecI.takeError();
+  auto *S = *SecI != Obj.section_end() ? getSection(**SecI) : nullptr;
+  if (!S)
+    return make_error<JITLinkError>("Relocation target is not in a linked "
+                                    "section");
+
+  JITTargetAddress TargetAddress = S->Address + Sym.getValue() + Addend;
+  DefinedAtom *DA = getAtomInSection(*S, TargetAddress);
+  // References to the end of a section belong to its last atom.
+  if (!DA && TargetAddress == S->Address + S->Size)
+    DA = getAtomInSection(*S, TargetAddress - 1);
+  if (!DA)
+    return make_error<JITLinkError>("Relocation target " +
+                                    formatv("{0:x16}", TargetAddress) +
+                                    " is outside of section " +
+                                    S->GenericSection->getName());
+  return std::make_pair(static_cast<Atom *>(DA),
+                        static_cast<int64_t>(TargetAddress - DA->getAddress()));
+}
+
+unsigned
+ELFAtomGraphBuilder::getPointerSize(const object::ELFObjectFileBase &Obj) {
+  return Obj.getBytesInAddress();
+}
+
+support::endianness
+ELFAtomGraphBuilder::getEndianness(const object::ELFObjectFileBase &Obj) {
+  return Obj.isLittleEndian() ? support::little : support::big;
+}
+
+Section &ELFAtomGraphBuilder::getCommonSection() {
+  if (!CommonSection) {
+    auto Prot = static_cast<sys::Memory::ProtectionFlags>(
+        sys::Memory::MF_READ | sys::Memory::MF_WRITE);
+    CommonSection = &G->createSection("<common>", 1, Prot, true);
+  }
+  return *CommonSection;
+}
+
+Error ELFAtomGraphBuilder::parseSections() {
+  // Relocatable objects put every section at address zero: lay the linked
+  // sections out one after another so that atoms have unique addresses.
+  JITTargetAddress NextAddress = 0;
+
+  for (auto &SecRef : Obj.sections()) {
+    object::ELFSectionRef ESecRef(SecRef);
+    uint64_t Flags = ESecRef.getFlags();
+    if (!(Flags & ELF::SHF_ALLOC))
+      continue;
+
+    StringRef Name;
+    if (auto EC = SecRef.getName(Name))
+      return errorCodeToError(EC);
+
+    if (Flags & ELF::SHF_TLS)
+      return make_error<JITLinkError>("Section " + Name +
+                                      " holds thread-local data, which is not "
+                                      "supported (use emulated TLS)");
+
+    uint64_t Align = std::max(SecRef.getAlignment(), uint64_t(1));
+    if (!isPowerOf2_64(Align) || Align > std::numeric_limits<uint32_t>::max())
+      return make_error<JITLinkError>("Section " + Name +
+                                      " has invalid alignment");
+
+    unsigned Prot = sys::Memory::MF_READ;
+    if (Flags & ELF::SHF_WRITE)
+      Prot |= sys::Memory::MF_WRITE;
+    if (Flags & ELF::SHF_EXECINSTR)
+      Prot |= sys::Memory::MF_EXEC;
+
+    bool IsZeroFill = ESecRef.getType() == ELF::SHT_NOBITS;
+
+    auto &GenericSection = G->createSection(
+        Name, Align, static_cast<sys::Memory::ProtectionFlags>(Prot),
+        IsZeroFill);
+
+    auto &ES = Sections[SecRef.getIndex()];
+    ES.GenericSection = &GenericSection;
+    ES.Address = alignTo(NextAddress, Align);
+    ES.Size = SecRef.getSize();
+    ES.Alignment = Align;
+    ES.IsZeroFill = IsZeroFill;
+
+    if (!IsZeroFill) {
+      Expected<StringRef> Content = SecRef.getContents();
+      if (!Content)
+        return Content.takeError();
+      if (Content->size() != ES.Size)
+        return make_error<JITLinkError>("Section content size does not match "
+                                        "declared size for " +
+                                        Name);
+      ES.Content = *Content;
+    }
+
+    LLVM_DEBUG({
+      dbgs() << "Adding section " << Name << ": "
+             << format("0x%016" PRIx64, ES.Address) << ", size: " << ES.Size
+             << ", align: " << Align << "\n";
+    });
+
+    NextAddress = ES.Address + ES.Size;
+    if (Name == ".eh_frame")
+      NextAddress += sizeof(EHFrameTerminator);
+  }
+
+  return Error::success();
+}
+
+ELFAtomGraphBuilder::ELFSection *
+ELFAtomGraphBuilder::getSection(const object::SectionRef &S) {
+  auto I = Sections.find(S.getIndex());
+  return I != Sections.end() ? &I->second : nullptr;
+}
+
+DefinedAtom *ELFAtomGraphBuilder::getAtomInSection(ELFSection &S,
+                                                   JITTargetAddress Address) {
+  // AtomGraph::getAtomByAddress can't be used on zero-fill atoms.
+  auto I = S.Atoms.upper_bound(Address);
+  if (I == S.Atoms.begin())
+    return nullptr;
+  --I;
+  if (Address >= I->second->getAddress() + I->second->getSize())
+    return nullptr;
+  return I->second;
+}
+
+Expected<JITTargetAddress>
+ELFAtomGraphBuilder::getSymbolAddress(const object::ELFSymbolRef &Sym) {
+  auto SecI = Sym.getSection();
+  if (!SecI)
+    return SecI.takeError();
+  if (*SecI != Obj.section_end())
+    if (auto *S = getSection(**SecI))
+      return S->Address + Sym.getValue();
+  return make_error<JITLinkError>("Symbol is not in a linked section");
+}
+
+Error ELFAtomGraphBuilder::addSymbolAtom(const object::ELFSymbolRef &Sym) {
+  // Skips the null, file and section symbols.
+  uint32_t Flags = Sym.getFlags();
+  if (Flags & object::SymbolRef::SF_FormatSpecific)
+    return Error::success();
+
+  auto Name = Sym.getName();
+  if (!Name)
+    return Name.takeError();
+
+  uint8_t Type = Sym.getELFType();
+  if (Type == ELF::STT_TLS)
+    return make_error<JITLinkError>("Thread-local symbol " + *Name +
+                                    " is not supported (use emulated TLS)");
+  if (Type == ELF::STT_GNU_IFUNC)
+    return make_error<JITLinkError>("Indirect function " + *Name +
+                                    " is not supported");
+
+  bool IsLocal = Sym.getBinding() == ELF::STB_LOCAL;
+  auto Key = Sym.getRawDataRefImpl().p;
+
+  if (Flags & object::SymbolRef::SF_Undefined) {
+    if (!DefinedNames.insert(*Name).second)
+      return make_error<JITLinkError>("Duplicate symbol within object: " +
+                                      *Name);
+    LLVM_DEBUG(dbgs() << "Adding undef atom \"" << *Name << "\"\n");
+    SymbolAtoms[Key] = &G->addExternalAtom(*Name);
+    return Error::success();
+  }
+
+  // A local symbol may reuse the name of another symbol. It gets an anonymous
+  // atom, and relocations against it are resolved by address.
+  bool IsAnonymous = IsLocal && (Name->empty() || DefinedNames.count(*Name));
+  if (!IsAnonymous && !DefinedNames.insert(*Name).second)
+    return make_error<JITLinkError>("Duplicate definition within object: " +
+                                    *Name);
+
+  if (Flags & object::SymbolRef::SF_Absolute) {
+    if (IsAnonymous)
+      return Error::success();
+    LLVM_DEBUG(dbgs() << "Adding absolute \"" << *Name << "\" addr: "
+                      << format("0x%016" PRIx64, Sym.getValue()) << "\n");
+    auto &A = G->addAbsoluteAtom(*Name, Sym.getValue());
+    A.setGlobal(!IsLocal);
+    A.setExported(Flags & object::SymbolRef::SF_Exported);
+    A.setWeak(Flags & object::SymbolRef::SF_Weak);
+    SymbolAtoms[Key] = &A;
+    return Error::success();
+  }
+
+  if (Flags & object::SymbolRef::SF_Common) {
+    LLVM_DEBUG(dbgs() << "Adding common \"" << *Name
+                      << "\" size: " << Sym.getSize() << "\n");
+    auto &A = G->addCommonAtom(getCommonSection(), *Name, 0,
+                               std::max(Sym.getAlignment(), 1U),
+                               Sym.getSize());
+    A.setGlobal(!IsLocal);
+    A.setExported(Flags & object::SymbolRef::SF_Exported);
+    SymbolAtoms[Key] = &A;
+    return Error::success();
+  }
+
+  auto SecI = Sym.getSection();
+  if (!SecI)
+    return SecI.takeError();
+  auto *S = getSection(**SecI);
+
+  // Symbols in sections that are not linked (e.g. debug info) are dropped.
+  if (!S) {
+    if (!IsLocal)
+      return make_error<JITLinkError>("Symbol " + *Name +
+                                      " is defined in a section that is not "
+                                      "linked");
+    return Error::success();
+  }
+
+  JITTargetAddress Addr = S->Address + Sym.getValue();
+  if (Addr >= S->Address + S->Size) {
+    // Local labels at the end of a section do not need an atom: relocations
+    // against them are resolved by address.
+    if (!IsLocal)
+      return make_error<JITLinkError>("Symbol " + *Name +
+                                      " points past the end of section " +
+                                      S->GenericSection->getName());
+    return Error::success();
+  }
+
+  auto AtomI = S->Atoms.find(Addr);
+  if (AtomI != S->Atoms.end()) {
+    // Global symbols are added first, so a local symbol may fall on an atom
+    // that already exists. Two global names for one address can't be
+    // represented.
+    if (!IsLocal)
+      return make_error<JITLinkError>("Symbol " + *Name + " aliases " +
+                                      AtomI->second->getName() +
+                                      ", which is not supported");
+    SymbolAtoms[Key] = AtomI->second;
+    return Error::success();
+  }
+
+  // Atoms keep the alignment of their offset, so the section layout is
+  // preserved when all its atoms are live.
+  uint32_t Alignment = MinAlign(Addr - S->Address, S->Alignment);
+
+  DefinedAtom *DA;
+  if (IsAnonymous) {
+    LLVM_DEBUG(dbgs() << "Adding anonymous atom for local \"" << *Name
+                      << "\"\n");
+    DA = &G->addAnonymousAtom(*S->GenericSection, Addr, Alignment);
+  } else {
+    LLVM_DEBUG(dbgs() << "Adding defined atom \"" << *Name << "\"\n");
+    DA = &G->addDefinedAtom(*S->GenericSection, *Name, Addr, Alignment);
+    DA->setGlobal(!IsLocal);
+    DA->setExported(Flags & object::SymbolRef::SF_Exported);
+    DA->setWeak(Flags & object::SymbolRef::SF_Weak);
+  }
+  DA->setCallable(Type == ELF::STT_FUNC);
+
+  LLVM_DEBUG({
+    dbgs() << "  addr: " << format("0x%016" PRIx64, Addr)
+           << ", align: " << Alignment
+           << ", section: " << S->GenericSection->getName() << "\n";
+  });
+
+  S->Atoms[Addr] = DA;
+  SymbolAtoms[Key] = DA;
+  return Error::success();
+}
+
+Error ELFAtomGraphBuilder::addAtoms() {
+  // Add global symbols first, so that local symbols can't take their names
+  // or atoms.
+  for (bool Locals : {false, true})
+    for (auto &Sym : Obj.symbols())
+      if ((Sym.getBinding() == ELF::STB_LOCAL) == Locals)
+        if (auto Err = addSymbolAtom(Sym))
+          return Err;
+
+  LLVM_DEBUG(dbgs() << "ELFAtomGraphBuilder setting atom content\n");
+
+  for (auto &KV : Sections) {
+    auto &S = KV.second;
+
+    // Skip empty sections.
+    if (S.Size == 0)
+      continue;
+
+    // If no symbol covers the start of the section, add an anonymous atom
+    // for it.
+    if (!S.Atoms.count(S.Address))
+      S.Atoms[S.Address] =
+          &G->addAnonymousAtom(*S.GenericSection, S.Address, S.Alignment);
+
+    // Iterate the atoms in reverse order and set up their contents.
+    JITTargetAddress End = S.Address + S.Size;
+    for (auto I = S.Atoms.rbegin(), E = S.Atoms.rend(); I != E; ++I) {
+      auto &A = *I->second;
+      if (S.IsZeroFill)
+        A.setZeroFill(End - I->first);
+      else
+        A.setContent(S.Content.substr(I->first - S.Address, End - I->first));
+      End = I->first;
+    }
+
+    // ELF sections are not split at symbol boundaries: the assembler may
+    // already have resolved references between atoms in the same section.
+    // Keep the atoms in their original order and live or dead as a group.
+    DefinedAtom *Prev = nullptr;
+    for (auto &KV : S.Atoms) {
+      if (Prev) {
+        Prev->setLayoutNext(*KV.second);
+        KV.second->addEdge(Edge::KeepAlive, 0, *Prev, 0);
+      }
+      Prev = KV.second;
+    }
+
+    if (S.GenericSection->getName() == ".eh_frame")
+      addEHFrameTerminator(S);
+  }
+
+  return Error::success();
+}
+
+void ELFAtomGraphBuilder::addEHFrameTerminator(ELFSection &S) {
+  // The section is registered as a whole, so all of its records are kept.
+  for (auto &KV : S.Atoms)
+    KV.second->setLive(true);
+
+  auto &LastAtom = *S.Atoms.rbegin()->second;
+  auto &Terminator =
+      G->addAnonymousAtom(*S.GenericSection, S.Address + S.Size, 1);
+  Terminator.setContent(
+      StringRef(EHFrameTerminator, sizeof(EHFrameTerminator)));
+  Terminator.setLive(true);
+  LastAtom.setLayoutNext(Terminator);
+}
+
+} // end namespace jitlink
+} // end namespace llvm
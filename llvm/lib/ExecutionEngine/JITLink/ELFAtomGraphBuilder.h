@@ -0,0 +1,99 @@
+//===------- ELFAtomGraphBuilder.h - ELF AtomGraph builder ------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Generic ELF AtomGraph building code.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LIB_EXECUTIONENGINE_JITLINK_ELFATOMGRAPHBUILDER_H
+#define LIB_EXECUTIONENGINE_JITLINK_ELFATOMGRAPHBUILDER_H
+
+#include "llvm/ExecutionEngine/JITLink/JITLink.h"
+
+#include "JITLinkGeneric.h"
+
+#include "llvm/Object/ELFObjectFile.h"
+
+namespace llvm {
+namespace jitlink {
+
+/// Builds an AtomGraph from a relocatable ELF object.
+///
+/// Sections in a relocatable object all start at address zero, so each
+/// allocatable section is assigned its own range of addresses in the graph.
+/// Non-allocatable sections (debug info, notes, etc.) are not linked.
+class ELFAtomGraphBuilder {
+public:
+  virtual ~ELFAtomGraphBuilder();
+  Expected<std::unique_ptr<AtomGraph>> buildGraph();
+
+protected:
+  ELFAtomGraphBuilder(const object::ELFObjectFileBase &Obj);
+
+  AtomGraph &getGraph() const { return *G; }
+
+  const object::ELFObjectFileBase &getObject() const { return Obj; }
+
+  virtual Error addRelocations() = 0;
+
+  /// Returns the graph address of the given section, or None if the section
+  /// is not part of the graph.
+  Optional<JITTargetAddress> getSectionAddress(const object::SectionRef &S);
+
+  /// Returns the atom of section S that covers the given address.
+  Expected<DefinedAtom &> findAtomInSection(const object::SectionRef &S,
+                                            JITTargetAddress Address);
+
+  /// Returns the target atom and edge addend for a relocation whose edge
+  /// should point at (the address of Rel's symbol) + Addend.
+  ///
+  /// Relocations against section symbols, and against local symbols that did
+  /// not get an atom of their own, are resolved to the atom that covers that
+  /// address.
+  Expected<std::pair<Atom *, int64_t>>
+  getRelocationTarget(const object::RelocationRef &Rel, int64_t Addend);
+
+private:
+  struct ELFSection {
+    Section *GenericSection = nullptr;
+    JITTargetAddress Address = 0;
+    uint64_t Size = 0;
+    uint32_t Alignment = 1;
+    StringRef Content;
+    bool IsZeroFill = false;
+    std::map<JITTargetAddress, DefinedAtom *> Atoms;
+  };
+
+  static unsigned getPointerSize(const object::ELFObjectFileBase &Obj);
+  static support::endianness
+  getEndianness(const object::ELFObjectFileBase &Obj);
+
+  Section &getCommonSection();
+
+  Error parseSections();
+  ELFSection *getSection(const object::SectionRef &S);
+  DefinedAtom *getAtomInSection(ELFSection &S, JITTargetAddress Address);
+  Expected<JITTargetAddress> getSymbolAddress(const object::ELFSymbolRef &Sym);
+  Error addSymbolAtom(const object::ELFSymbolRef &Sym);
+  Error addAtoms();
+  void addEHFrameTerminator(ELFSection &S);
+
+  const object::ELFObjectFileBase &Obj;
+  std::unique_ptr<AtomGraph> G;
+  // Keyed by section index. Entries are referred to by pointer while the
+  // graph is built, so use a node-based map.
+  std::map<unsigned, ELFSection> Sections;
+  DenseMap<uintptr_t, Atom *> SymbolAtoms;
+  DenseSet<StringRef> DefinedNames;
+  Section *CommonSection = nullptr;
+};
+
+} // end namespace jitlink
+} // end namespace llvm
+
+#endif // LIB_EXECUTIONENGINE_JITLINK_ELFATOMGRAPHBUILDER_H
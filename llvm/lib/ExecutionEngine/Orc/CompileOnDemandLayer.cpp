@@ -146,6 +146,12 @@ void CompileOnDemandLayer::emit(MaterializationResponsibility R,
       NonCallables[Name] = SymbolAliasMapEntry(Name, Flags);
   }
 
+  // The bodies are looked up in the implementation dylib, so that is where
+  // speculative lookups of likely callees must go too.
+  if (Spec)
+    Spec->registerCandidates(PDR.getImplDylib(),
+                             Speculator::findLikelyCallees(M, Mangle));
+
   // Create a partitioning materialization unit and lodge it with the
   // implementation dylib.
   if (auto Err = PDR.getImplDylib().define(
@@ -17,8 +17,9 @@ namespace {
   // A SimpleCompiler that owns its TargetMachine.
   class TMOwningSimpleCompiler : public llvm::orc::SimpleCompiler {
   public:
-    TMOwningSimpleCompiler(std::unique_ptr<llvm::TargetMachine> TM)
-      : llvm::orc::SimpleCompiler(*TM), TM(std::move(TM)) {}
+    TMOwningSimpleCompiler(std::unique_ptr<llvm::TargetMachine> TM,
+                           llvm::ObjectCache *ObjCache = nullptr)
+      : llvm::orc::SimpleCompiler(*TM, ObjCache), TM(std::move(TM)) {}
   private:
     // FIXME: shared because std::functions (and thus
     // IRCompileLayer::CompileFunction) are not moveable.
@@ -108,7 +109,8 @@ LLJIT::LLJIT(LLJITBuilderState &S, Error &Err)
 
     {
       auto TmpCompileLayer = llvm::make_unique<IRCompileLayer>(
-          *ES, *ObjLinkingLayer, ConcurrentIRCompiler(std::move(*S.JTMB)));
+          *ES, *ObjLinkingLayer,
+          ConcurrentIRCompiler(std::move(*S.JTMB), S.ObjCache));
 
       TmpCompileLayer->setCloneToNewContextOnEmit(true);
       CompileLayer = std::move(TmpCompileLayer);
@@ -135,7 +137,8 @@ LLJIT::LLJIT(LLJITBuilderState &S, Error &Err)
     DL = (*TM)->createDataLayout();
 
     CompileLayer = llvm::make_unique<IRCompileLayer>(
-        *ES, *ObjLinkingLayer, TMOwningSimpleCompiler(std::move(*TM)));
+        *ES, *ObjLinkingLayer,
+        TMOwningSimpleCompiler(std::move(*TM), S.ObjCache));
   }
 }
 
@@ -229,6 +232,17 @@ LLLazyJIT::LLLazyJIT(LLLazyJITBuilderState &S, Error &Err) : LLJIT(S, Err) {
 
   if (S.NumCompileThreads > 0)
     CODLayer->setCloneToNewContextOnEmit(true);
+
+  // Speculative lookups only run in the background if materialization is
+  // dispatched to the compile threads.
+  if (S.SpeculateCompiles && S.NumCompileThreads > 0) {
+    Spec = llvm::make_unique<Speculator>(*ES, S.NumCompileThreads);
+    CODLayer->setSpeculator(*Spec);
+    LCTMgr->setNotifyLookup(
+        [this](JITDylib &JD, const SymbolStringPtr &Name) {
+          Spec->speculateFor(JD, Name);
+        });
+  }
 }
 
 } // End namespace orc.
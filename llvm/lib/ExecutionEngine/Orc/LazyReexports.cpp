@@ -51,6 +51,9 @@ LazyCallThroughManager::callThroughToSymbol(JITTargetAddress TrampolineAddr) {
     SymbolName = I->second.second;
   }
 
+  if (NotifyLookup)
+    NotifyLookup(*SourceJD, SymbolName);
+
   auto LookupResult = ES.lookup(JITDylibSearchList({{SourceJD, true}}),
                                 {SymbolName}, NoDependenciesToRegister, true);
 
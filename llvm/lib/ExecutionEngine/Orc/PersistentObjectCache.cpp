@@ -0,0 +1,173 @@
+//===- PersistentObjectCache.cpp - On-disk cache of JIT'd objects ---------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+
+#define DEBUG_TYPE "orc"
+
+namespace llvm {
+namespace orc {
+
+Expected<std::unique_ptr<PersistentObjectCache>>
+PersistentObjectCache::Create(StringRef CacheDir, JITTargetMachineBuilder JTMB,
+                              CachePruningPolicy Policy) {
+  auto TM = JTMB.createTargetMachine();
+  if (!TM)
+    return TM.takeError();
+
+  if (auto EC = sys::fs::create_directories(CacheDir))
+    return errorCodeToError(EC);
+
+  std::unique_ptr<PersistentObjectCache> Cache(new PersistentObjectCache(
+      CacheDir, getTargetKey(**TM), std::move(Policy)));
+  Cache->prune();
+  return std::move(Cache);
+}
+
+std::string PersistentObjectCache::getTargetKey(const TargetMachine &TM) {
+  std::string Key;
+  raw_string_ostream KeyStream(Key);
+
+  // The parts of the configuration that affect code generation. Anything that
+  // is recorded in the module itself, such as function attributes, is covered
+  // by the module's bitcode.
+  const TargetOptions &Options = TM.Options;
+  KeyStream << LLVM_VERSION_STRING << '\0' << TM.getTargetTriple().str()
+            << '\0' << TM.getTargetCPU() << '\0'
+            << TM.getTargetFeatureString() << '\0'
+            << unsigned(TM.getRelocationModel()) << ','
+            << unsigned(TM.getCodeModel()) << ','
+            << unsigned(TM.getOptLevel()) << ','
+            << Options.UnsafeFPMath << Options.NoInfsFPMath
+            << Options.NoNaNsFPMath << Options.NoTrappingFPMath
+            << Options.NoSignedZerosFPMath
+            << Options.HonorSignDependentRoundingFPMathOption
+            << Options.NoZerosInBSS << Options.GuaranteedTailCallOpt
+            << Options.EnableFastISel << Options.EnableGlobalISel
+            << Options.UseInitArray << Options.RelaxELFRelocations
+            << Options.FunctionSections << Options.DataSections
+            << Options.UniqueSectionNames << Options.TrapUnreachable
+            << Options.NoTrapAfterNoreturn << Options.EmulatedTLS
+            << Options.ExplicitEmulatedTLS << Options.EnableIPRA << ','
+            << unsigned(Options.FloatABIType) << ','
+            << unsigned(Options.AllowFPOpFusion) << ','
+            << unsigned(Options.ThreadModel) << ','
+            << unsigned(Options.EABIVersion) << ','
+            << unsigned(Options.DebuggerTuning) << ','
+            << unsigned(Options.ExceptionModel) << ','
+            << Options.StackAlignmentOverride;
+
+  return KeyStream.str();
+}
+
+std::string PersistentObjectCache::getModuleKey(const Module &M) const {
+  SmallVector<char, 0> Bitcode;
+  {
+    raw_svector_ostream BCStream(Bitcode);
+    WriteBitcodeToFile(M, BCStream);
+  }
+
+  SHA1 Hasher;
+  Hasher.update(TargetKey);
+  Hasher.update(ArrayRef<uint8_t>{0});
+  Hasher.update(StringRef(Bitcode.data(), Bitcode.size()));
+  return toHex(Hasher.result());
+}
+
+std::string PersistentObjectCache::getEntryPath(StringRef Key) const {
+  // This choice of file name allows the cache to be pruned (see pruneCache()
+  // in include/llvm/Support/CachePruning.h).
+  SmallString<128> EntryPath;
+  sys::path::append(EntryPath, CacheDir, "llvmcache-" + Key);
+  return EntryPath.str();
+}
+
+std::unique_ptr<MemoryBuffer>
+PersistentObjectCache::getObject(const Module *M) {
+  std::string Key = getModuleKey(*M);
+  std::string EntryPath = getEntryPath(Key);
+
+  // Opening the entry updates its access time, which keeps it from expiring.
+  int FD;
+  if (!sys::fs::openFileForRead(EntryPath, FD, sys::fs::OF_UpdateAtime)) {
+    // Read the entry into memory rather than mapping it, as another process
+    // may prune or replace it while it is in use.
+    auto ObjOrErr = MemoryBuffer::getOpenFile(
+        FD, EntryPath, /*FileSize*/ -1, /*RequiresNullTerminator*/ false,
+        /*IsVolatile*/ true);
+    sys::Process::SafelyCloseFileDescriptor(FD);
+    if (ObjOrErr && (*ObjOrErr)->getBufferSize() != 0) {
+      std::lock_guard<std::mutex> Lock(KeysMutex);
+      PendingKeys.erase(M);
+      ++NumHits;
+      return std::move(*ObjOrErr);
+    }
+  }
+
+  // A miss: M will be compiled. An address may be reused by a later module,
+  // so any key left over from a failed compile is replaced.
+  std::lock_guard<std::mutex> Lock(KeysMutex);
+  PendingKeys[M] = std::move(Key);
+  return nullptr;
+}
+
+void PersistentObjectCache::notifyObjectCompiled(const Module *M,
+                                                 MemoryBufferRef Obj) {
+  std::string Key;
+  {
+    std::lock_guard<std::mutex> Lock(KeysMutex);
+    auto I = PendingKeys.find(M);
+    if (I == PendingKeys.end())
+      return;
+    Key = std::move(I->second);
+    PendingKeys.erase(I);
+  }
+
+  // Write the entry under a temporary name and rename it into place, so that
+  // other processes never see a partial object. Errors are ignored, as an
+  // entry that could not be stored is merely a future miss.
+  SmallString<128> TempPath;
+  sys::path::append(TempPath, CacheDir, "Orc-%%%%%%.tmp.o");
+  auto Temp = sys::fs::TempFile::create(
+      TempPath, sys::fs::owner_read | sys::fs::owner_write);
+  if (!Temp) {
+    consumeError(Temp.takeError());
+    return;
+  }
+  {
+    raw_fd_ostream OS(Temp->FD, /* ShouldClose */ false);
+    OS << Obj.getBuffer();
+    if (OS.has_error()) {
+      OS.clear_error();
+      consumeError(Temp->discard());
+      return;
+    }
+  }
+  if (auto Err = Temp->keep(getEntryPath(Key))) {
+    consumeError(std::move(Err));
+    consumeError(Temp->discard());
+    return;
+  }
+  ++NumStores;
+}
+
+bool PersistentObjectCache::prune() { return pruneCache(CacheDir, Policy); }
+
+} // end namespace orc
+} // end namespace llvm
@@ -0,0 +1,184 @@
+//===---------- Speculation.cpp - Compile likely callees ahead of use -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/Speculation.h"
+
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/Module.h"
+
+#define DEBUG_TYPE "orc"
+
+namespace llvm {
+namespace orc {
+
+Speculator::CandidateMap
+Speculator::findLikelyCallees(Module &M, MangleAndInterner &Mangle,
+                              unsigned MaxCandidates) {
+  CandidateMap Result;
+
+  for (auto &F : M.functions()) {
+    if (F.isDeclaration() || F.hasLocalLinkage())
+      continue;
+
+    // Count the call sites of each callee that has a symbol of its own in
+    // the JITDylib: local functions will be extracted with their callers.
+    DenseMap<const Function *, uint64_t> CallSites;
+    for (auto &BB : F)
+      for (auto &I : BB) {
+        ImmutableCallSite CS(&I);
+        if (!CS)
+          continue;
+        auto *Callee = dyn_cast_or_null<Function>(
+            CS.getCalledValue()->stripPointerCasts());
+        if (!Callee || Callee == &F || Callee->isDeclaration() ||
+            Callee->hasLocalLinkage() ||
+            Callee->hasAvailableExternallyLinkage())
+          continue;
+        ++CallSites[Callee];
+      }
+
+    CandidateList Candidates;
+    for (auto &KV : CallSites) {
+      uint64_t Priority = KV.second;
+      if (auto Count = KV.first->getEntryCount()) {
+        // Never called in the profiled runs: not worth compiling early.
+        if (Count.getCount() == 0)
+          continue;
+        Priority = Count.getCount();
+      }
+      Candidates.push_back({Mangle(KV.first->getName()), Priority});
+    }
+    if (Candidates.empty())
+      continue;
+
+    llvm::stable_sort(Candidates, [](const Candidate &LHS,
+                                     const Candidate &RHS) {
+      return LHS.Priority > RHS.Priority;
+    });
+    if (Candidates.size() > MaxCandidates)
+      Candidates.resize(MaxCandidates);
+    Result[Mangle(F.getName())] = std::move(Candidates);
+  }
+
+  return Result;
+}
+
+Speculator::Speculator(ExecutionSession &ES, unsigned MaxInFlight)
+    : ES(ES), MaxInFlight(MaxInFlight ? MaxInFlight : 1) {}
+
+Speculator::~Speculator() {
+  std::unique_lock<std::mutex> Lock(SpeculatorMutex);
+  Queue = std::priority_queue<PendingLookup>();
+  Queued.clear();
+  InFlightCV.wait(Lock, [this]() { return InFlight == 0; });
+}
+
+void Speculator::registerCandidates(JITDylib &JD, CandidateMap NewCandidates) {
+  std::lock_guard<std::mutex> Lock(SpeculatorMutex);
+  auto &JDCandidates = Candidates[&JD];
+  for (auto &KV : NewCandidates)
+    JDCandidates[KV.first] = std::move(KV.second);
+}
+
+void Speculator::speculateFor(JITDylib &JD, const SymbolStringPtr &Name) {
+  {
+    std::lock_guard<std::mutex> Lock(SpeculatorMutex);
+
+    // Name is being looked up on demand: a queued speculative lookup of it
+    // would be redundant.
+    Requested.insert(SymbolKey(&JD, Name));
+
+    auto JDI = Candidates.find(&JD);
+    if (JDI == Candidates.end())
+      return;
+    auto I = JDI->second.find(Name);
+    if (I == JDI->second.end())
+      return;
+
+    for (auto &C : I->second) {
+      SymbolKey Key(&JD, C.Name);
+      if (Requested.count(Key) || !Queued.insert(Key).second)
+        continue;
+      Queue.push({C.Priority, NextSeq++, &JD, C.Name});
+    }
+
+    // Each function only triggers speculation once.
+    JDI->second.erase(I);
+  }
+
+  issueLookups();
+}
+
+void Speculator::cancelPending() {
+  std::lock_guard<std::mutex> Lock(SpeculatorMutex);
+  Queue = std::priority_queue<PendingLookup>();
+  Queued.clear();
+}
+
+bool Speculator::popNext(PendingLookup &Next) {
+  while (!Queue.empty()) {
+    Next = Queue.top();
+    Queue.pop();
+    SymbolKey Key(Next.JD, Next.Name);
+    Queued.erase(Key);
+    if (Requested.insert(Key).second)
+      return true;
+  }
+  return false;
+}
+
+void Speculator::issueLookups() {
+  while (true) {
+    PendingLookup Next{0, 0, nullptr, SymbolStringPtr()};
+    {
+      std::lock_guard<std::mutex> Lock(SpeculatorMutex);
+      if (InFlight >= MaxInFlight || !popNext(Next))
+        return;
+      ++InFlight;
+    }
+    issueLookup(Next);
+  }
+}
+
+void Speculator::issueLookup(const PendingLookup &L) {
+  // Issue the lookup without holding the lock: if the symbol is already
+  // ready the callbacks run before lookup returns.
+  ES.lookup(JITDylibSearchList({{L.JD, true}}), {L.Name},
+            [this](Expected<SymbolMap> Result) {
+              // Failures are reported to whoever calls the function. A lookup
+              // that fails to resolve never becomes ready.
+              if (!Result) {
+                consumeError(Result.takeError());
+                lookupComplete();
+              }
+            },
+            [this](Error Err) {
+              consumeError(std::move(Err));
+              lookupComplete();
+            },
+            NoDependenciesToRegister);
+}
+
+void Speculator::lookupComplete() {
+  PendingLookup Next{0, 0, nullptr, SymbolStringPtr()};
+  {
+    std::lock_guard<std::mutex> Lock(SpeculatorMutex);
+    if (!popNext(Next)) {
+      // Once InFlight drops to zero the destructor may run: do not touch the
+      // speculator after releasing the lock.
+      --InFlight;
+      InFlightCV.notify_all();
+      return;
+    }
+  }
+  // Hand the completed lookup's slot over to the next one.
+  issueLookup(Next);
+}
+
+} // end namespace orc
+} // end namespace llvm
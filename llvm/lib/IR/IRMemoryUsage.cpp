@@ -0,0 +1,198 @@
+//===- IRMemoryUsage.cpp - Account for the memory used by IR --------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the IRMemoryUsage class and its printer pass.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/IR/IRMemoryUsage.h"
+#include "LLVMContextImpl.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/DebugInfoMetadata.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalAlias.h"
+#include "llvm/IR/GlobalIFunc.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <vector>
+
+using namespace llvm;
+
+/// Return the name and size of the concrete class of \p I.
+static std::pair<StringRef, size_t> getInstructionClass(const Instruction &I) {
+  switch (I.getOpcode()) {
+#define HANDLE_INST(N, OPC, CLASS)                                             \
+  case Instruction::OPC:                                                       \
+    return {#CLASS, sizeof(CLASS)};
+#include "llvm/IR/Instruction.def"
+  }
+  llvm_unreachable("Unknown instruction opcode");
+}
+
+/// The size of \p N including its co-allocated operands.
+static uint64_t getMDNodeSize(const MDNode &N, size_t ClassSize) {
+  return ClassSize + N.getNumOperands() * sizeof(MDOperand);
+}
+
+IRMemoryUsage::IRMemoryUsage(const Module &M, bool IncludeContext) {
+  addModule(M);
+  if (IncludeContext)
+    addContext(M);
+}
+
+void IRMemoryUsage::add(StringRef Kind, uint64_t Count, uint64_t Bytes) {
+  Entry &E = Entries[Kind];
+  E.Count += Count;
+  E.Bytes += Bytes;
+}
+
+void IRMemoryUsage::addOperands(const User &U) {
+  // Intrusive operands are allocated right in front of the User. Hung-off
+  // ones are allocated separately, followed by a tagged pointer back to the
+  // User (and, for PHIs, the incoming blocks), and the User is preceded by a
+  // pointer to them.
+  unsigned NumOps = U.getNumOperands();
+  const Use *Intrusive = reinterpret_cast<const Use *>(&U) - NumOps;
+  if (U.getOperandList() == Intrusive) {
+    add("Use (co-allocated)", NumOps, NumOps * sizeof(Use));
+    return;
+  }
+  uint64_t Bytes = sizeof(Use *) + NumOps * sizeof(Use);
+  if (U.getOperandList())
+    Bytes += sizeof(Use::UserRef);
+  if (isa<PHINode>(U))
+    Bytes += NumOps * sizeof(BasicBlock *);
+  add("Use (hung-off)", NumOps, Bytes);
+}
+
+void IRMemoryUsage::addModule(const Module &M) {
+  const LLVMContextImpl &Ctx = *M.getContext().pImpl;
+  SmallPtrSet<const DILocation *, 32> Locations;
+
+  auto AddName = [&](const Value &V) {
+    if (V.hasName())
+      add("ValueName", 1, sizeof(ValueName) + V.getName().size() + 1);
+  };
+
+  for (const GlobalVariable &GV : M.globals()) {
+    add("GlobalVariable", 1, sizeof(GlobalVariable));
+    addOperands(GV);
+    AddName(GV);
+  }
+  for (const GlobalAlias &GA : M.aliases()) {
+    add("GlobalAlias", 1, sizeof(GlobalAlias));
+    addOperands(GA);
+    AddName(GA);
+  }
+  for (const GlobalIFunc &GI : M.ifuncs()) {
+    add("GlobalIFunc", 1, sizeof(GlobalIFunc));
+    addOperands(GI);
+    AddName(GI);
+  }
+
+  for (const Function &F : M) {
+    add("Function", 1, sizeof(Function));
+    addOperands(F);
+    AddName(F);
+    if (!F.hasLazyArguments())
+      add("Argument", F.arg_size(), F.arg_size() * sizeof(Argument));
+    for (const Argument &A : F.args())
+      AddName(A);
+
+    for (const BasicBlock &BB : F) {
+      add("BasicBlock", 1, sizeof(BasicBlock));
+      AddName(BB);
+      for (const Instruction &I : BB) {
+        std::pair<StringRef, size_t> Class = getInstructionClass(I);
+        add(Class.first, 1, Class.second);
+        addOperands(I);
+        AddName(I);
+
+        if (const DILocation *Loc = I.getDebugLoc().get())
+          Locations.insert(Loc);
+        else
+          add("Instruction without DebugLoc", 1, 0);
+
+        if (I.hasMetadataOtherThanDebugLoc()) {
+          auto It = Ctx.InstructionMetadata.find(&I);
+          if (It != Ctx.InstructionMetadata.end())
+            add("Metadata attachment", It->second.size(),
+                It->second.size() *
+                    sizeof(std::pair<unsigned, TrackingMDNodeRef>));
+        }
+      }
+    }
+  }
+
+  for (const DILocation *Loc : Locations)
+    add("DILocation (referenced)", 1,
+        getMDNodeSize(*Loc, sizeof(DILocation)));
+}
+
+void IRMemoryUsage::addContext(const Module &M) {
+  const LLVMContextImpl &Ctx = *M.getContext().pImpl;
+
+  add("Context: ConstantInt", Ctx.IntConstants.size(),
+      Ctx.IntConstants.size() * sizeof(ConstantInt));
+  add("Context: ConstantFP", Ctx.FPConstants.size(),
+      Ctx.FPConstants.size() * sizeof(ConstantFP));
+  for (const auto &E : Ctx.MDStringCache)
+    add("Context: MDString", 1,
+        sizeof(StringMapEntry<MDString>) + E.getKeyLength() + 1);
+  add("Context: ValueAsMetadata", Ctx.ValuesAsMetadata.size(),
+      Ctx.ValuesAsMetadata.size() * sizeof(ValueAsMetadata));
+
+#define HANDLE_MDNODE_LEAF_UNIQUABLE(CLASS)                                    \
+  for (const CLASS *N : Ctx.CLASS##s)                                          \
+    add("Context: " #CLASS, 1, getMDNodeSize(*N, sizeof(CLASS)));
+#include "llvm/IR/Metadata.def"
+
+  for (const MDNode *N : Ctx.DistinctMDNodes)
+    add("Context: distinct MDNode", 1, getMDNodeSize(*N, sizeof(MDNode)));
+}
+
+uint64_t IRMemoryUsage::getTotalBytes() const {
+  uint64_t Total = 0;
+  for (const auto &E : Entries)
+    Total += E.second.Bytes;
+  return Total;
+}
+
+void IRMemoryUsage::print(raw_ostream &OS) const {
+  std::vector<std::pair<StringRef, Entry>> Sorted;
+  for (const auto &E : Entries)
+    Sorted.push_back({E.first(), E.second});
+  llvm::sort(Sorted, [](const std::pair<StringRef, Entry> &LHS,
+                        const std::pair<StringRef, Entry> &RHS) {
+    if (LHS.second.Bytes != RHS.second.Bytes)
+      return LHS.second.Bytes > RHS.second.Bytes;
+    return LHS.first < RHS.first;
+  });
+
+  OS << "===" << std::string(73, '-') << "===\n"
+     << "                             IR memory usage\n"
+     << "===" << std::string(73, '-') << "===\n"
+     << "       Count        Bytes  Kind\n";
+  for (const auto &E : Sorted)
+    OS << format("%12" PRIu64 " %12" PRIu64 "  ", E.second.Count,
+                 E.second.Bytes)
+       << E.first << '\n';
+  OS << std::string(12, ' ') << format(" %12" PRIu64 "  ", getTotalBytes())
+     << "Total\n";
+}
+
+PreservedAnalyses IRMemoryUsagePrinterPass::run(Module &M,
+                                                ModuleAnalysisManager &) {
+  IRMemoryUsage(M).print(OS);
+  return PreservedAnalyses::all();
+}
@@ -12,13 +12,19 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/IR/RemarkStreamer.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Function.h"
 
 using namespace llvm;
 
-RemarkStreamer::RemarkStreamer(StringRef Filename, raw_ostream &OS)
+RemarkStreamer::RemarkStreamer(StringRef Filename, raw_ostream &OS,
+                               remarks::Format Format)
     : Filename(Filename), OS(OS),
       YAMLOutput(OS, reinterpret_cast<void *>(this)), StrTab() {
   assert(!Filename.empty() && "This needs to be a real filename.");
+  assert(Format != remarks::Format::Unknown && "Unknown remark format.");
+  if (Format == remarks::Format::Binary)
+    Serializer = llvm::make_unique<remarks::BinarySerializer>(OS);
 }
 
 Error RemarkStreamer::setFilter(StringRef Filter) {
@@ -31,11 +37,62 @@ Error RemarkStreamer::setFilter(StringRef Filter) {
   return Error::success();
 }
 
+static remarks::Type toRemarkType(enum DiagnosticKind Kind) {
+  switch (Kind) {
+  default:
+    return remarks::Type::Unknown;
+  case DK_OptimizationRemark:
+  case DK_MachineOptimizationRemark:
+    return remarks::Type::Passed;
+  case DK_OptimizationRemarkMissed:
+  case DK_MachineOptimizationRemarkMissed:
+    return remarks::Type::Missed;
+  case DK_OptimizationRemarkAnalysis:
+  case DK_MachineOptimizationRemarkAnalysis:
+    return remarks::Type::Analysis;
+  case DK_OptimizationRemarkAnalysisFPCommute:
+    return remarks::Type::AnalysisFPCommute;
+  case DK_OptimizationRemarkAnalysisAliasing:
+    return remarks::Type::AnalysisAliasing;
+  case DK_OptimizationFailure:
+    return remarks::Type::Failure;
+  }
+}
+
+static Optional<remarks::RemarkLocation>
+toRemarkLocation(const DiagnosticLocation &DL) {
+  if (!DL.isValid())
+    return None;
+  return remarks::RemarkLocation{DL.getRelativePath(), DL.getLine(),
+                                 DL.getColumn()};
+}
+
 void RemarkStreamer::emit(const DiagnosticInfoOptimizationBase &Diag) {
   if (Optional<Regex> &Filter = PassFilter)
     if (!Filter->match(Diag.getPassName()))
       return;
 
+  if (Serializer) {
+    // The remark only references the strings of the diagnostic, which
+    // outlives the call to the serializer.
+    SmallVector<remarks::Argument, 8> Args;
+    for (const DiagnosticInfoOptimizationBase::Argument &Arg : Diag.getArgs())
+      Args.push_back(remarks::Argument{Arg.Key, Arg.Val,
+                                       toRemarkLocation(Arg.Loc)});
+
+    remarks::Remark R;
+    R.RemarkType = toRemarkType(static_cast<DiagnosticKind>(Diag.getKind()));
+    R.PassName = Diag.getPassName();
+    R.RemarkName = Diag.getRemarkName();
+    R.FunctionName =
+        GlobalValue::dropLLVMManglingEscape(Diag.getFunction().getName());
+    R.Loc = toRemarkLocation(Diag.getLocation());
+    R.Hotness = Diag.getHotness();
+    R.Args = Args;
+    Serializer->emit(R);
+    return;
+  }
+
   DiagnosticInfoOptimizationBase *DiagPtr =
       const_cast<DiagnosticInfoOptimizationBase *>(&Diag);
   YAMLOutput << DiagPtr;
@@ -12,10 +12,12 @@
 
 #include "llvm/LTO/Caching.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/SmallVectorMemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
@@ -27,8 +29,133 @@
 using namespace llvm;
 using namespace llvm::lto;
 
+// A compressed cache entry starts with this magic, followed by a byte for the
+// compression format and the uncompressed size as a 64-bit little-endian
+// integer. Object files never start with it.
+static const char CompressedMagic[] = {'\xff', 'L', 'L', 'c', 'z'};
+static const size_t CompressedHeaderSize = sizeof(CompressedMagic) + 1 + 8;
+
+// Returns the contents of a cache entry as it is stored, compressed with F if
+// set.
+static Error encodeEntry(Optional<compression::Format> F, StringRef Object,
+                         SmallVectorImpl<char> &Entry) {
+  if (!F) {
+    Entry.assign(Object.begin(), Object.end());
+    return Error::success();
+  }
+  SmallVector<char, 0> Compressed;
+  if (Error E = compression::compress(*F, Object, Compressed))
+    return E;
+  Entry.assign(CompressedMagic, CompressedMagic + sizeof(CompressedMagic));
+  Entry.push_back(uint8_t(*F));
+  char Size[8];
+  support::endian::write64le(Size, Object.size());
+  Entry.append(Size, Size + 8);
+  Entry.append(Compressed.begin(), Compressed.end());
+  return Error::success();
+}
+
+// Returns the object file in a cache entry, decompressing it if needed.
+static Expected<std::unique_ptr<MemoryBuffer>>
+decodeEntry(std::unique_ptr<MemoryBuffer> Entry) {
+  StringRef Buf = Entry->getBuffer();
+  if (!Buf.startswith(StringRef(CompressedMagic, sizeof(CompressedMagic))))
+    return std::move(Entry);
+
+  if (Buf.size() < CompressedHeaderSize ||
+      uint8_t(Buf[sizeof(CompressedMagic)]) > uint8_t(compression::Format::LZ4))
+    return make_error<StringError>("corrupt cache entry " +
+                                       Entry->getBufferIdentifier(),
+                                   inconvertibleErrorCode());
+  auto F = compression::Format(Buf[sizeof(CompressedMagic)]);
+  if (!compression::isAvailable(F))
+    return make_error<StringError>(
+        Twine("cache entry is compressed with ") + compression::getName(F) +
+            ", which is not available",
+        inconvertibleErrorCode());
+  size_t Size =
+      support::endian::read64le(Buf.data() + sizeof(CompressedMagic) + 1);
+
+  std::unique_ptr<WritableMemoryBuffer> Object =
+      WritableMemoryBuffer::getNewUninitMemBuffer(Size,
+                                                  Entry->getBufferIdentifier());
+  if (!Object)
+    return errorCodeToError(make_error_code(errc::not_enough_memory));
+  size_t ActualSize = Size;
+  if (Error E = compression::uncompress(F, Buf.drop_front(CompressedHeaderSize),
+                                        Object->getBufferStart(), ActualSize))
+    return std::move(E);
+  if (ActualSize != Size)
+    return make_error<StringError>("corrupt cache entry " +
+                                       Entry->getBufferIdentifier(),
+                                   inconvertibleErrorCode());
+  return std::move(Object);
+}
+
+// Atomically stores Data as the cache entry Key in Dir. Errors are ignored,
+// as an entry that couldn't be stored is merely a future cache miss.
+static void writeEntry(StringRef Dir, StringRef Key, StringRef Data) {
+  SmallString<64> TempFilenameModel;
+  sys::path::append(TempFilenameModel, Dir, "Thin-%%%%%%.tmp.o");
+  Expected<sys::fs::TempFile> Temp = sys::fs::TempFile::create(
+      TempFilenameModel, sys::fs::owner_read | sys::fs::owner_write);
+  if (!Temp) {
+    consumeError(Temp.takeError());
+    return;
+  }
+  {
+    raw_fd_ostream OS(Temp->FD, /* ShouldClose */ false);
+    OS << Data;
+    if (OS.has_error()) {
+      OS.clear_error();
+      consumeError(Temp->discard());
+      return;
+    }
+  }
+  SmallString<64> EntryPath;
+  sys::path::append(EntryPath, Dir, "llvmcache-" + Key);
+  if (Error E = Temp->keep(EntryPath)) {
+    consumeError(std::move(E));
+    consumeError(Temp->discard());
+  }
+}
+
+namespace {
+class DirectoryCacheTier : public CacheTier {
+  std::string Path;
+
+public:
+  DirectoryCacheTier(StringRef Path) : Path(Path) {}
+
+  std::unique_ptr<MemoryBuffer> get(StringRef Key) override {
+    SmallString<64> EntryPath;
+    sys::path::append(EntryPath, Path, "llvmcache-" + Key);
+    // Read the entry into memory rather than mapping it, as it may be
+    // removed or replaced by another machine while we are using it.
+    ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr = MemoryBuffer::getFile(
+        EntryPath, /*FileSize*/ -1, /*RequiresNullTerminator*/ false,
+        /*IsVolatile*/ true);
+    if (!MBOrErr)
+      return nullptr;
+    return std::move(*MBOrErr);
+  }
+
+  void put(StringRef Key, StringRef Data) override {
+    writeEntry(Path, Key, Data);
+  }
+};
+} // end anonymous namespace
+
+Expected<std::unique_ptr<CacheTier>>
+lto::createDirectoryCacheTier(StringRef Path) {
+  if (std::error_code EC = sys::fs::create_directories(Path))
+    return errorCodeToError(EC);
+  return llvm::make_unique<DirectoryCacheTier>(Path);
+}
+
 Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
-                                            AddBufferFn AddBuffer) {
+                                            AddBufferFn AddBuffer,
+                                            LocalCacheOptions Options) {
   if (std::error_code EC = sys::fs::create_directories(CacheDirectoryPath))
     return errorCodeToError(EC);
 
@@ -49,10 +176,19 @@ Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
                                     /*RequiresNullTerminator*/ false);
       close(FD);
       if (MBOrErr) {
-        AddBuffer(Task, std::move(*MBOrErr));
-        return AddStreamFn();
+        // An entry that can't be decoded is treated like a miss and
+        // replaced.
+        Expected<std::unique_ptr<MemoryBuffer>> ObjOrErr =
+            decodeEntry(std::move(*MBOrErr));
+        if (ObjOrErr) {
+          AddBuffer(Task, std::move(*ObjOrErr));
+          return AddStreamFn();
+        }
+        consumeError(ObjOrErr.takeError());
+        EC = errc::no_such_file_or_directory;
+      } else {
+        EC = MBOrErr.getError();
       }
-      EC = MBOrErr.getError();
     }
 
     // On Windows we can fail to open a cache file with a permission denied
@@ -65,6 +201,21 @@ Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
       report_fatal_error(Twine("Failed to open cache file ") + EntryPath +
                          ": " + EC.message() + "\n");
 
+    // Try the second tier, and copy the entry into the local cache on a hit.
+    if (Options.SecondTier) {
+      if (std::unique_ptr<MemoryBuffer> Entry = Options.SecondTier->get(Key)) {
+        StringRef Data = Entry->getBuffer();
+        writeEntry(CacheDirectoryPath, Key, Data);
+        Expected<std::unique_ptr<MemoryBuffer>> ObjOrErr =
+            decodeEntry(MemoryBuffer::getMemBufferCopy(Data, EntryPath));
+        if (ObjOrErr) {
+          AddBuffer(Task, std::move(*ObjOrErr));
+          return AddStreamFn();
+        }
+        consumeError(ObjOrErr.takeError());
+      }
+    }
+
     // This native object stream is responsible for commiting the resulting
     // file to the cache and calling AddBuffer to add it to the link.
     struct CacheStream : NativeObjectStream {
@@ -128,7 +279,52 @@ Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
       }
     };
 
+    // This native object stream collects the object in memory. When done, it
+    // adds the object to the link and stores it, compressed if requested, in
+    // the local cache and the second tier.
+    struct BufferedCacheStream : NativeObjectStream {
+      AddBufferFn AddBuffer;
+      LocalCacheOptions Options;
+      std::string CacheDirectoryPath;
+      std::string Key;
+      std::string EntryPath;
+      unsigned Task;
+      SmallVector<char, 0> Object;
+
+      BufferedCacheStream(AddBufferFn AddBuffer, LocalCacheOptions Options,
+                          std::string CacheDirectoryPath, std::string Key,
+                          std::string EntryPath, unsigned Task)
+          : NativeObjectStream(llvm::make_unique<raw_svector_ostream>(Object)),
+            AddBuffer(std::move(AddBuffer)), Options(std::move(Options)),
+            CacheDirectoryPath(std::move(CacheDirectoryPath)),
+            Key(std::move(Key)), EntryPath(std::move(EntryPath)), Task(Task) {}
+
+      ~BufferedCacheStream() {
+        OS.reset();
+
+        SmallVector<char, 0> Entry;
+        if (Error E = encodeEntry(Options.Compression,
+                                  StringRef(Object.data(), Object.size()),
+                                  Entry))
+          report_fatal_error(Twine("Failed to compress cache entry ") +
+                             EntryPath + ": " + toString(std::move(E)) + "\n");
+        StringRef Data(Entry.data(), Entry.size());
+        writeEntry(CacheDirectoryPath, Key, Data);
+        if (Options.SecondTier)
+          Options.SecondTier->put(Key, Data);
+
+        AddBuffer(Task, llvm::make_unique<SmallVectorMemoryBuffer>(
+                            std::move(Object), EntryPath));
+      }
+    };
+
+    std::string KeyStr = Key;
     return [=](size_t Task) -> std::unique_ptr<NativeObjectStream> {
+      if (Options.Compression || Options.SecondTier)
+        return llvm::make_unique<BufferedCacheStream>(
+            AddBuffer, Options, CacheDirectoryPath, KeyStr, EntryPath.str(),
+            Task);
+
       // Write to a temporary to avoid race condition
       SmallString<64> TempFilenameModel;
       sys::path::append(TempFilenameModel, CacheDirectoryPath, "Thin-%%%%%%.tmp.o");
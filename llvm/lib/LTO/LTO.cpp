@@ -29,10 +29,14 @@
 #include "llvm/LTO/SummaryBasedOptimizations.h"
 #include "llvm/Linker/IRMover.h"
 #include "llvm/Object/IRObjectFile.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/SHA1.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
@@ -47,6 +51,8 @@
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
 #include "llvm/Transforms/Utils/SplitModule.h"
 
+#include <condition_variable>
+#include <mutex>
 #include <set>
 
 using namespace llvm;
@@ -59,6 +65,11 @@ static cl::opt<bool>
     DumpThinCGSCCs("dump-thin-cg-sccs", cl::init(false), cl::Hidden,
                    cl::desc("Dump the SCCs in the ThinLTO index's callgraph"));
 
+static cl::opt<unsigned> ThinLTOBytesPerInst(
+    "thinlto-bytes-per-inst", cl::init(2048), cl::Hidden,
+    cl::desc("Estimated peak memory of a ThinLTO backend job per IR "
+             "instruction, used to enforce the memory budget"));
+
 /// Enable global value internalization in LTO.
 cl::opt<bool> EnableLTOInternalization(
     "enable-lto-internalization", cl::init(true), cl::Hidden,
@@ -660,10 +671,6 @@ LTO::addRegularLTO(BitcodeModule BM, ArrayRef<InputFile::Symbol> Syms,
   Module &M = **MOrErr;
   Mod.M = std::move(*MOrErr);
 
-  if (Error Err = M.materializeMetadata())
-    return std::move(Err);
-  UpgradeDebugInfo(M);
-
   ModuleSymbolTable SymTab;
   SymTab.addModule(&M);
 
@@ -765,6 +772,14 @@ LTO::addRegularLTO(BitcodeModule BM, ArrayRef<InputFile::Symbol> Syms,
 
 Error LTO::linkRegularLTO(RegularLTOState::AddedModule Mod,
                           bool LivenessFromIndex) {
+  // The metadata is only loaded now rather than in addRegularLTO. Modules with
+  // summaries are held until all inputs have been added, and their metadata,
+  // typically dominated by debug info, would otherwise all be in memory at
+  // once.
+  if (Error Err = Mod.M->materializeMetadata())
+    return Err;
+  UpgradeDebugInfo(*Mod.M);
+
   std::vector<GlobalValue *> Keep;
   for (GlobalValue *GV : Mod.Keep) {
     if (LivenessFromIndex && !ThinLTO.CombinedIndex.isGUIDLive(GV->getGUID()))
@@ -840,7 +855,34 @@ Error LTO::addThinLTO(BitcodeModule BM, ArrayRef<InputFile::Symbol> Syms,
 
 unsigned LTO::getMaxTasks() const {
   CalledGetMaxTasks = true;
-  return RegularLTO.ParallelCodeGenParallelismLevel + ThinLTO.ModuleMap.size();
+  unsigned NumTasks =
+      RegularLTO.ParallelCodeGenParallelismLevel + ThinLTO.ModuleMap.size();
+  for (unsigned NumParts : getThinLTOCodeGenPartitions())
+    NumTasks += NumParts - 1;
+  return NumTasks;
+}
+
+std::vector<unsigned> LTO::getThinLTOCodeGenPartitions() const {
+  std::vector<unsigned> NumParts(ThinLTO.ModuleMap.size(), 1);
+  if (!Conf.ThinLTOSplitCodeGenThreshold ||
+      Conf.ThinLTOSplitCodeGenMaxPartitions < 2)
+    return NumParts;
+
+  StringMap<uint64_t> NumInsts;
+  for (auto &I : ThinLTO.CombinedIndex)
+    for (auto &S : I.second.SummaryList)
+      if (auto *FS = dyn_cast<FunctionSummary>(S.get()))
+        NumInsts[FS->modulePath()] += FS->instCount();
+
+  unsigned I = 0;
+  for (auto &Mod : ThinLTO.ModuleMap) {
+    uint64_t N = NumInsts.lookup(Mod.first) / Conf.ThinLTOSplitCodeGenThreshold;
+    if (N >= 2)
+      NumParts[I] =
+          std::min<uint64_t>(N, Conf.ThinLTOSplitCodeGenMaxPartitions);
+    ++I;
+  }
+  return NumParts;
 }
 
 // If only some of the modules were split, we cannot correctly handle
@@ -1015,12 +1057,17 @@ public:
         ModuleToDefinedGVSummaries(ModuleToDefinedGVSummaries) {}
 
   virtual ~ThinBackendProc() {}
+  /// Starts the backend for a module. The module is written to \p Task. If
+  /// \p ExtraTasks is not empty, code generation of the module should be
+  /// split into partitions written to \p Task and \p ExtraTasks; backends that
+  /// can't split code generation ignore them.
   virtual Error start(
       unsigned Task, BitcodeModule BM,
       const FunctionImporter::ImportMapTy &ImportList,
       const FunctionImporter::ExportSetTy &ExportList,
       const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> &ResolvedODR,
-      MapVector<StringRef, BitcodeModule> &ModuleMap) = 0;
+      MapVector<StringRef, BitcodeModule> &ModuleMap,
+      ArrayRef<unsigned> ExtraTasks) = 0;
   virtual Error wait() = 0;
 };
 
@@ -1032,18 +1079,41 @@ class InProcessThinBackend : public ThinBackendProc {
   std::set<GlobalValue::GUID> CfiFunctionDefs;
   std::set<GlobalValue::GUID> CfiFunctionDecls;
 
+  // The arguments of a start() call. Jobs are queued by start() and run by
+  // wait(), so that they can be scheduled by their estimated size.
+  struct Job {
+    unsigned Task;
+    BitcodeModule BM;
+    const FunctionImporter::ImportMapTy *ImportList;
+    const FunctionImporter::ExportSetTy *ExportList;
+    const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> *ResolvedODR;
+    const GVSummaryMapTy *DefinedGlobals;
+    MapVector<StringRef, BitcodeModule> *ModuleMap;
+    std::vector<unsigned> ExtraTasks;
+    uint64_t Cost;
+  };
+  std::vector<Job> Jobs;
+
+  // The memory budget in bytes, or 0 if unlimited, and the estimated memory
+  // of the running jobs, guarded by CostMu.
+  uint64_t MemoryBudget;
+  uint64_t CostInFlight = 0;
+  std::mutex CostMu;
+  std::condition_variable CostCV;
+
   Optional<Error> Err;
   std::mutex ErrMu;
 
 public:
   InProcessThinBackend(
       Config &Conf, ModuleSummaryIndex &CombinedIndex,
-      unsigned ThinLTOParallelismLevel,
+      unsigned ThinLTOParallelismLevel, uint64_t MemoryBudget,
       const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
       AddStreamFn AddStream, NativeObjectCache Cache)
       : ThinBackendProc(Conf, CombinedIndex, ModuleToDefinedGVSummaries),
         BackendThreadPool(ThinLTOParallelismLevel),
-        AddStream(std::move(AddStream)), Cache(std::move(Cache)) {
+        AddStream(std::move(AddStream)), Cache(std::move(Cache)),
+        MemoryBudget(MemoryBudget) {
     for (auto &Name : CombinedIndex.cfiFunctionDefs())
       CfiFunctionDefs.insert(
           GlobalValue::getGUID(GlobalValue::dropLLVMManglingEscape(Name)));
@@ -1059,7 +1129,8 @@ public:
       const FunctionImporter::ExportSetTy &ExportList,
       const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> &ResolvedODR,
       const GVSummaryMapTy &DefinedGlobals,
-      MapVector<StringRef, BitcodeModule> &ModuleMap) {
+      MapVector<StringRef, BitcodeModule> &ModuleMap,
+      ArrayRef<unsigned> ExtraTasks) {
     auto RunThinBackend = [&](AddStreamFn AddStream) {
       LTOLLVMContext BackendContext(Conf);
       Expected<std::unique_ptr<Module>> MOrErr = BM.parseModule(BackendContext);
@@ -1067,7 +1138,7 @@ public:
         return MOrErr.takeError();
 
       return thinBackend(Conf, Task, AddStream, **MOrErr, CombinedIndex,
-                         ImportList, DefinedGlobals, ModuleMap);
+                         ImportList, DefinedGlobals, ModuleMap, ExtraTasks);
     };
 
     auto ModuleID = BM.getModuleIdentifier();
@@ -1084,10 +1155,34 @@ public:
     computeLTOCacheKey(Key, Conf, CombinedIndex, ModuleID, ImportList,
                        ExportList, ResolvedODR, DefinedGlobals, CfiFunctionDefs,
                        CfiFunctionDecls);
-    if (AddStreamFn CacheAddStream = Cache(Task, Key))
-      return RunThinBackend(CacheAddStream);
+    if (ExtraTasks.empty()) {
+      if (AddStreamFn CacheAddStream = Cache(Task, Key))
+        return RunThinBackend(CacheAddStream);
+      return Error::success();
+    }
 
-    return Error::success();
+    // Each partition is cached under its own key. If any of them is missing,
+    // the module is compiled again and the partitions that were found are
+    // discarded.
+    std::vector<std::pair<unsigned, AddStreamFn>> PartStreams;
+    bool AnyMissing = false;
+    for (unsigned I = 0, E = ExtraTasks.size() + 1; I != E; ++I) {
+      unsigned PartTask = I ? ExtraTasks[I - 1] : Task;
+      AddStreamFn PartStream = Cache(PartTask, getPartitionKey(Key, I, E));
+      AnyMissing |= bool(PartStream);
+      PartStreams.push_back({PartTask, std::move(PartStream)});
+    }
+    if (!AnyMissing)
+      return Error::success();
+
+    return RunThinBackend(
+        [&](unsigned PartTask) -> std::unique_ptr<NativeObjectStream> {
+          for (auto &P : PartStreams)
+            if (P.first == PartTask && P.second)
+              return P.second(PartTask);
+          return llvm::make_unique<NativeObjectStream>(
+              llvm::make_unique<raw_null_ostream>());
+        });
   }
 
   Error start(
@@ -1095,52 +1190,129 @@ public:
       const FunctionImporter::ImportMapTy &ImportList,
       const FunctionImporter::ExportSetTy &ExportList,
       const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> &ResolvedODR,
-      MapVector<StringRef, BitcodeModule> &ModuleMap) override {
+      MapVector<StringRef, BitcodeModule> &ModuleMap,
+      ArrayRef<unsigned> ExtraTasks) override {
     StringRef ModulePath = BM.getModuleIdentifier();
     assert(ModuleToDefinedGVSummaries.count(ModulePath));
     const GVSummaryMapTy &DefinedGlobals =
         ModuleToDefinedGVSummaries.find(ModulePath)->second;
-    BackendThreadPool.async(
-        [=](BitcodeModule BM, ModuleSummaryIndex &CombinedIndex,
-            const FunctionImporter::ImportMapTy &ImportList,
-            const FunctionImporter::ExportSetTy &ExportList,
-            const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes>
-                &ResolvedODR,
-            const GVSummaryMapTy &DefinedGlobals,
-            MapVector<StringRef, BitcodeModule> &ModuleMap) {
-          Error E = runThinLTOBackendThread(
-              AddStream, Cache, Task, BM, CombinedIndex, ImportList, ExportList,
-              ResolvedODR, DefinedGlobals, ModuleMap);
-          if (E) {
-            std::unique_lock<std::mutex> L(ErrMu);
-            if (Err)
-              Err = joinErrors(std::move(*Err), std::move(E));
-            else
-              Err = std::move(E);
-          }
-        },
-        BM, std::ref(CombinedIndex), std::ref(ImportList), std::ref(ExportList),
-        std::ref(ResolvedODR), std::ref(DefinedGlobals), std::ref(ModuleMap));
+    Jobs.push_back({Task, BM, &ImportList, &ExportList, &ResolvedODR,
+                    &DefinedGlobals, &ModuleMap, ExtraTasks,
+                    estimateCost(ImportList, DefinedGlobals)});
     return Error::success();
   }
 
   Error wait() override {
+    schedule();
     BackendThreadPool.wait();
     if (Err)
       return std::move(*Err);
     else
       return Error::success();
   }
+
+private:
+  // Returns the cache key of partition I of N of the module with the given
+  // cache key.
+  static std::string getPartitionKey(StringRef Key, unsigned I, unsigned N) {
+    SHA1 Hasher;
+    Hasher.update(Key);
+    uint8_t Data[8];
+    support::endian::write32le(Data, I);
+    support::endian::write32le(Data + 4, N);
+    Hasher.update(Data);
+    return toHex(Hasher.result());
+  }
+
+  // Estimates the peak memory that the backend needs for a module from the
+  // instruction counts of the functions it defines and imports.
+  uint64_t estimateCost(const FunctionImporter::ImportMapTy &ImportList,
+                        const GVSummaryMapTy &DefinedGlobals) {
+    uint64_t NumInsts = 0;
+    for (auto &DG : DefinedGlobals)
+      if (auto *FS = dyn_cast<FunctionSummary>(DG.second))
+        NumInsts += FS->instCount();
+    for (auto &Imports : ImportList)
+      for (GlobalValue::GUID GUID : Imports.second)
+        if (auto *FS = dyn_cast_or_null<FunctionSummary>(
+                CombinedIndex.findSummaryInModule(GUID, Imports.first())))
+          NumInsts += FS->instCount();
+    return (NumInsts + 1) * ThinLTOBytesPerInst;
+  }
+
+  // Runs the queued jobs, largest first, so that the biggest modules don't
+  // end up running alone at the end of the link. If there is a memory
+  // budget, a job is only started once it fits into the budget next to the
+  // running jobs, except that a job that is too large by itself runs alone.
+  // Smaller jobs are started ahead of a large one that has to wait.
+  void schedule() {
+    std::set<std::pair<uint64_t, unsigned>> Pending;
+    for (unsigned I = 0, E = Jobs.size(); I != E; ++I)
+      Pending.insert({Jobs[I].Cost, I});
+
+    while (!Pending.empty()) {
+      unsigned Next;
+      {
+        std::unique_lock<std::mutex> L(CostMu);
+        while (true) {
+          auto It = std::prev(Pending.end());
+          if (MemoryBudget && CostInFlight) {
+            // Find the largest job that fits, if any.
+            uint64_t Avail = MemoryBudget > CostInFlight
+                                 ? MemoryBudget - CostInFlight
+                                 : 0;
+            It = Pending.upper_bound({Avail, ~0U});
+            It = It == Pending.begin() ? Pending.end() : std::prev(It);
+          }
+          if (It != Pending.end()) {
+            Next = It->second;
+            Pending.erase(It);
+            break;
+          }
+#if LLVM_ENABLE_THREADS
+          CostCV.wait(L);
+#else
+          // Without threads, the pool only runs jobs from wait().
+          L.unlock();
+          BackendThreadPool.wait();
+          L.lock();
+#endif
+        }
+        CostInFlight += Jobs[Next].Cost;
+      }
+      BackendThreadPool.async([this, Next] { run(Jobs[Next]); });
+    }
+  }
+
+  void run(const Job &J) {
+    Error E = runThinLTOBackendThread(
+        AddStream, Cache, J.Task, J.BM, CombinedIndex, *J.ImportList,
+        *J.ExportList, *J.ResolvedODR, *J.DefinedGlobals, *J.ModuleMap,
+        J.ExtraTasks);
+    if (E) {
+      std::unique_lock<std::mutex> L(ErrMu);
+      if (Err)
+        Err = joinErrors(std::move(*Err), std::move(E));
+      else
+        Err = std::move(E);
+    }
+    {
+      std::lock_guard<std::mutex> L(CostMu);
+      CostInFlight -= J.Cost;
+    }
+    CostCV.notify_all();
+  }
 };
 } // end anonymous namespace
 
-ThinBackend lto::createInProcessThinBackend(unsigned ParallelismLevel) {
+ThinBackend lto::createInProcessThinBackend(unsigned ParallelismLevel,
+                                            uint64_t MemoryBudget) {
   return [=](Config &Conf, ModuleSummaryIndex &CombinedIndex,
              const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
              AddStreamFn AddStream, NativeObjectCache Cache) {
     return llvm::make_unique<InProcessThinBackend>(
-        Conf, CombinedIndex, ParallelismLevel, ModuleToDefinedGVSummaries,
-        AddStream, Cache);
+        Conf, CombinedIndex, ParallelismLevel, MemoryBudget,
+        ModuleToDefinedGVSummaries, AddStream, Cache);
   };
 }
 
@@ -1187,7 +1359,8 @@ public:
       const FunctionImporter::ImportMapTy &ImportList,
       const FunctionImporter::ExportSetTy &ExportList,
       const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> &ResolvedODR,
-      MapVector<StringRef, BitcodeModule> &ModuleMap) override {
+      MapVector<StringRef, BitcodeModule> &ModuleMap,
+      ArrayRef<unsigned> ExtraTasks) override {
     StringRef ModulePath = BM.getModuleIdentifier();
     std::string NewModulePath =
         getThinLTOOutputFile(ModulePath, OldPrefix, NewPrefix);
@@ -1234,6 +1407,299 @@ ThinBackend lto::createWriteIndexesThinBackend(
   };
 }
 
+namespace {
+class ExecutorThinBackend : public ThinBackendProc {
+  std::shared_ptr<ThinBackendExecutor> Executor;
+  AddStreamFn AddStream;
+  NativeObjectCache Cache;
+  std::set<GlobalValue::GUID> CfiFunctionDefs;
+  std::set<GlobalValue::GUID> CfiFunctionDecls;
+
+  Optional<Error> Err;
+  std::mutex ErrMu;
+
+public:
+  ExecutorThinBackend(
+      Config &Conf, ModuleSummaryIndex &CombinedIndex,
+      const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
+      std::shared_ptr<ThinBackendExecutor> Executor, AddStreamFn AddStream,
+      NativeObjectCache Cache)
+      : ThinBackendProc(Conf, CombinedIndex, ModuleToDefinedGVSummaries),
+        Executor(std::move(Executor)), AddStream(std::move(AddStream)),
+        Cache(std::move(Cache)) {
+    for (auto &Name : CombinedIndex.cfiFunctionDefs())
+      CfiFunctionDefs.insert(
+          GlobalValue::getGUID(GlobalValue::dropLLVMManglingEscape(Name)));
+    for (auto &Name : CombinedIndex.cfiFunctionDecls())
+      CfiFunctionDecls.insert(
+          GlobalValue::getGUID(GlobalValue::dropLLVMManglingEscape(Name)));
+  }
+
+  Error start(
+      unsigned Task, BitcodeModule BM,
+      const FunctionImporter::ImportMapTy &ImportList,
+      const FunctionImporter::ExportSetTy &ExportList,
+      const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> &ResolvedODR,
+      MapVector<StringRef, BitcodeModule> &ModuleMap,
+      ArrayRef<unsigned> ExtraTasks) override {
+    StringRef ModulePath = BM.getModuleIdentifier();
+    assert(ModuleToDefinedGVSummaries.count(ModulePath));
+    const GVSummaryMapTy &DefinedGlobals =
+        ModuleToDefinedGVSummaries.find(ModulePath)->second;
+
+    ThinBackendJob Job;
+    Job.Task = Task;
+    Job.ModuleID = ModulePath;
+
+    // Compute the cache key if the module has a hash, both to look the job up
+    // in the local cache and to let the executor cache results itself.
+    AddStreamFn OutputStream = AddStream;
+    if (CombinedIndex.modulePaths().count(ModulePath) &&
+        !all_of(CombinedIndex.getModuleHash(ModulePath),
+                [](uint32_t V) { return V == 0; })) {
+      SmallString<40> Key;
+      computeLTOCacheKey(Key, Conf, CombinedIndex, ModulePath, ImportList,
+                         ExportList, ResolvedODR, DefinedGlobals,
+                         CfiFunctionDefs, CfiFunctionDecls);
+      Job.CacheKey = Key.str();
+      if (Cache) {
+        OutputStream = Cache(Task, Key);
+        // On a cache hit, the cache has already added the object to the link.
+        if (!OutputStream)
+          return Error::success();
+      }
+    }
+
+    std::map<std::string, GVSummaryMapTy> ModuleToSummariesForIndex;
+    gatherImportedSummariesForModule(ModulePath, ModuleToDefinedGVSummaries,
+                                     ImportList, ModuleToSummariesForIndex);
+    {
+      raw_string_ostream OS(Job.Index);
+      WriteIndexToFile(CombinedIndex, OS, &ModuleToSummariesForIndex);
+    }
+    for (auto &I : ModuleToSummariesForIndex)
+      if (I.first != ModulePath)
+        Job.ImportedModules.push_back(I.first);
+
+    Executor->execute(
+        std::move(Job),
+        [=](Expected<std::unique_ptr<MemoryBuffer>> ObjOrErr) {
+          if (!ObjOrErr) {
+            std::unique_lock<std::mutex> L(ErrMu);
+            if (Err)
+              Err = joinErrors(std::move(*Err), ObjOrErr.takeError());
+            else
+              Err = ObjOrErr.takeError();
+            return;
+          }
+          std::unique_ptr<NativeObjectStream> Stream = OutputStream(Task);
+          *Stream->OS << (*ObjOrErr)->getBuffer();
+        });
+    return Error::success();
+  }
+
+  Error wait() override {
+    Error E = Executor->wait();
+    if (Err)
+      return joinErrors(std::move(*Err), std::move(E));
+    return E;
+  }
+};
+} // end anonymous namespace
+
+ThinBackend lto::createExecutorThinBackend(
+    std::shared_ptr<ThinBackendExecutor> Executor) {
+  return [=](Config &Conf, ModuleSummaryIndex &CombinedIndex,
+             const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
+             AddStreamFn AddStream, NativeObjectCache Cache) {
+    return llvm::make_unique<ExecutorThinBackend>(
+        Conf, CombinedIndex, ModuleToDefinedGVSummaries, Executor, AddStream,
+        Cache);
+  };
+}
+
+namespace {
+class ProcessThinBackendExecutor : public ThinBackendExecutor {
+  ErrorOr<std::string> Program;
+  std::vector<std::string> Args;
+  unsigned MaxRetries;
+  std::string StatsFile;
+  ThreadPool Pool;
+
+  /// The statistics of one attempt at running a job.
+  struct AttemptStats {
+    std::string ModuleID;
+    unsigned Task;
+    unsigned Attempt;
+    int ExitCode;
+    std::chrono::milliseconds WallTime;
+    Optional<sys::ProcessStatistics> ProcStat;
+  };
+  std::vector<AttemptStats> Stats;
+  std::mutex StatsMu;
+
+public:
+  ProcessThinBackendExecutor(StringRef Program, std::vector<std::string> Args,
+                             unsigned Parallelism, unsigned MaxRetries,
+                             std::string StatsFile)
+      : Program(sys::findProgramByName(Program)), Args(std::move(Args)),
+        MaxRetries(MaxRetries), StatsFile(std::move(StatsFile)),
+        Pool(Parallelism) {
+    if (!this->Program)
+      this->Program = Program.str();
+  }
+
+  void execute(ThinBackendJob Job, DoneFn Done) override {
+    Pool.async([=] { Done(run(Job)); });
+  }
+
+  Error wait() override {
+    Pool.wait();
+    if (StatsFile.empty())
+      return Error::success();
+    return writeStats();
+  }
+
+private:
+  Expected<std::unique_ptr<MemoryBuffer>> run(const ThinBackendJob &Job) {
+    SmallString<128> IndexPath, ImportsPath, OutputPath;
+    if (Error E = writeTempFile("thinlto.bc", Job.Index, IndexPath))
+      return std::move(E);
+    FileRemover IndexRemover(IndexPath);
+
+    std::string Imports;
+    for (const std::string &M : Job.ImportedModules)
+      Imports += M + "\n";
+    if (Error E = writeTempFile("imports", Imports, ImportsPath))
+      return std::move(E);
+    FileRemover ImportsRemover(ImportsPath);
+
+    if (std::error_code EC =
+            sys::fs::createTemporaryFile("thinlto", "o", OutputPath))
+      return errorCodeToError(EC);
+    FileRemover OutputRemover(OutputPath);
+
+    std::vector<StringRef> Argv = {*Program};
+    Argv.insert(Argv.end(), Args.begin(), Args.end());
+    Argv.insert(Argv.end(), {Job.ModuleID, IndexPath, ImportsPath, OutputPath,
+                             Job.CacheKey});
+
+    for (unsigned Attempt = 0;; ++Attempt) {
+      std::string ErrMsg;
+      bool ExecutionFailed;
+      Optional<sys::ProcessStatistics> ProcStat;
+      auto Start = std::chrono::steady_clock::now();
+      int Ret = sys::ExecuteAndWait(
+          *Program, Argv, /*Env=*/None, /*Redirects=*/{}, /*SecondsToWait=*/0,
+          /*MemoryLimit=*/0, &ErrMsg, &ExecutionFailed, &ProcStat);
+      auto WallTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - Start);
+      // Retrying is pointless if the program can't be started at all.
+      if (ExecutionFailed)
+        return make_error<StringError>("unable to execute " + *Program +
+                                           ": " + ErrMsg,
+                                       inconvertibleErrorCode());
+      {
+        std::lock_guard<std::mutex> Lock(StatsMu);
+        Stats.push_back(
+            {Job.ModuleID, Job.Task, Attempt, Ret, WallTime, ProcStat});
+      }
+
+      if (Ret == 0) {
+        // Read the object into memory, as the file is removed when we
+        // return.
+        ErrorOr<std::unique_ptr<MemoryBuffer>> ObjOrErr =
+            MemoryBuffer::getFile(OutputPath, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false,
+                                  /*IsVolatile=*/true);
+        if (!ObjOrErr)
+          return errorCodeToError(ObjOrErr.getError());
+        return std::move(*ObjOrErr);
+      }
+
+      if (Attempt == MaxRetries) {
+        std::string Msg = *Program + " failed for " + Job.ModuleID;
+        if (Ret == -2)
+          Msg += ": " + ErrMsg;
+        else
+          Msg += " with exit code " + std::to_string(Ret);
+        if (Attempt)
+          Msg += " after " + std::to_string(Attempt + 1) + " attempts";
+        return make_error<StringError>(Msg, inconvertibleErrorCode());
+      }
+    }
+  }
+
+  Error writeStats() {
+    std::error_code EC;
+    raw_fd_ostream OS(StatsFile, EC, sys::fs::OF_Text);
+    if (EC)
+      return errorCodeToError(EC);
+
+    // Jobs finish in any order, so sort the attempts to make the file
+    // deterministic apart from the measurements.
+    llvm::sort(Stats, [](const AttemptStats &A, const AttemptStats &B) {
+      return std::tie(A.Task, A.Attempt) < std::tie(B.Task, B.Attempt);
+    });
+    json::OStream J(OS, /*IndentSize=*/2);
+    J.object([&] {
+      J.attributeArray("jobs", [&] {
+        for (const AttemptStats &S : Stats) {
+          J.object([&] {
+            J.attribute("module", S.ModuleID);
+            J.attribute("task", int64_t(S.Task));
+            J.attribute("attempt", int64_t(S.Attempt));
+            J.attribute("exit_code", int64_t(S.ExitCode));
+            J.attribute("wall_time_ms", int64_t(S.WallTime.count()));
+            if (S.ProcStat) {
+              J.attribute("cpu_time_ms",
+                          int64_t(S.ProcStat->TotalTime.count() / 1000));
+              J.attribute("user_time_ms",
+                          int64_t(S.ProcStat->UserTime.count() / 1000));
+              J.attribute("peak_rss_kb", int64_t(S.ProcStat->PeakMemory));
+            }
+          });
+        }
+      });
+    });
+    OS << "\n";
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      return make_error<StringError>("unable to write " + StatsFile,
+                                     inconvertibleErrorCode());
+    }
+    return Error::success();
+  }
+
+  static Error writeTempFile(StringRef Suffix, StringRef Contents,
+                             SmallVectorImpl<char> &Path) {
+    int FD;
+    if (std::error_code EC =
+            sys::fs::createTemporaryFile("thinlto", Suffix, FD, Path))
+      return errorCodeToError(EC);
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Contents;
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      return make_error<StringError>("unable to write " + Twine(Path.data()),
+                                     inconvertibleErrorCode());
+    }
+    return Error::success();
+  }
+};
+} // end anonymous namespace
+
+std::unique_ptr<ThinBackendExecutor>
+lto::createProcessThinBackendExecutor(std::string Program,
+                                      std::vector<std::string> Args,
+                                      unsigned Parallelism, unsigned MaxRetries,
+                                      std::string StatsFile) {
+  return llvm::make_unique<ProcessThinBackendExecutor>(
+      Program, std::move(Args), Parallelism, MaxRetries, std::move(StatsFile));
+}
+
 Error LTO::runThinLTO(AddStreamFn AddStream, NativeObjectCache Cache,
                       const DenseSet<GlobalValue::GUID> &GUIDPreservedSymbols) {
   if (ThinLTO.ModuleMap.empty())
@@ -1271,9 +1737,22 @@ Error LTO::runThinLTO(AddStreamFn AddStream, NativeObjectCache Cache,
   if (DumpThinCGSCCs)
     ThinLTO.CombinedIndex.dumpSCCs(outs());
 
-  if (Conf.OptLevel > 0)
-    ComputeCrossModuleImport(ThinLTO.CombinedIndex, ModuleToDefinedGVSummaries,
-                             ImportLists, ExportLists);
+  if (Conf.OptLevel > 0) {
+    if (Conf.ThinLTOImportStateFile.empty()) {
+      ComputeCrossModuleImport(ThinLTO.CombinedIndex,
+                               ModuleToDefinedGVSummaries, ImportLists,
+                               ExportLists);
+    } else {
+      // A missing or unreadable state just means that nothing is reused.
+      ThinLinkImportState State;
+      consumeError(State.readFromFile(Conf.ThinLTOImportStateFile));
+      ComputeCrossModuleImport(ThinLTO.CombinedIndex,
+                               ModuleToDefinedGVSummaries, ImportLists,
+                               ExportLists, &State);
+      if (Error E = State.writeToFile(Conf.ThinLTOImportStateFile))
+        return E;
+    }
+  }
 
   // Figure out which symbols need to be internalized. This also needs to happen
   // at -O0 because summary-based DCE is implemented using internalization, and
@@ -1324,12 +1803,21 @@ Error LTO::runThinLTO(AddStreamFn AddStream, NativeObjectCache Cache,
                       AddStream, Cache);
 
   // Tasks 0 through ParallelCodeGenParallelismLevel-1 are reserved for combined
-  // module and parallel code generation partitions.
-  unsigned Task = RegularLTO.ParallelCodeGenParallelismLevel;
+  // module and parallel code generation partitions. They are followed by one
+  // task for each ThinLTO module and then by the tasks of the additional
+  // partitions of the modules whose code generation is split.
+  const unsigned ThinLTOFirstTask = RegularLTO.ParallelCodeGenParallelismLevel;
+  unsigned Task = ThinLTOFirstTask;
+  unsigned ExtraTask = Task + ThinLTO.ModuleMap.size();
+  std::vector<unsigned> NumParts = getThinLTOCodeGenPartitions();
   for (auto &Mod : ThinLTO.ModuleMap) {
+    std::vector<unsigned> ExtraTasks;
+    for (unsigned I = 1, E = NumParts[Task - ThinLTOFirstTask]; I < E; ++I)
+      ExtraTasks.push_back(ExtraTask++);
     if (Error E = BackendProc->start(Task, Mod.second, ImportLists[Mod.first],
                                      ExportLists[Mod.first],
-                                     ResolvedODR[Mod.first], ThinLTO.ModuleMap))
+                                     ResolvedODR[Mod.first], ThinLTO.ModuleMap,
+                                     ExtraTasks))
       return E;
     ++Task;
   }
@@ -27,6 +27,7 @@
 #include "llvm/MC/SubtargetFeature.h"
 #include "llvm/Object/ModuleSymbolTable.h"
 #include "llvm/Passes/PassBuilder.h"
+#include "llvm/Passes/StandardInstrumentations.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -41,6 +42,7 @@
 #include "llvm/Transforms/Scalar/LoopPassManager.h"
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
 #include "llvm/Transforms/Utils/SplitModule.h"
+#include <numeric>
 
 using namespace llvm;
 using namespace lto;
@@ -164,7 +166,13 @@ static void runNewPMPasses(Config &Conf, Module &Mod, TargetMachine *TM,
                         PGOOptions::IRUse, PGOOptions::CSIRUse);
   }
 
-  PassBuilder PB(TM, PipelineTuningOptions(), PGOOpt);
+  // Each backend reports its own pass runs; they are appended to the same
+  // -time-passes-report file.
+  PassInstrumentationCallbacks PIC;
+  PassReportInstrumentation PassReport;
+  PassReport.registerCallbacks(PIC);
+
+  PassBuilder PB(TM, PipelineTuningOptions(), PGOOpt, &PIC);
   AAManager AA;
 
   // Parse a custom AA pipeline if asked to.
@@ -222,7 +230,11 @@ static void runNewPMCustomPasses(Module &Mod, TargetMachine *TM,
                                  std::string PipelineDesc,
                                  std::string AAPipelineDesc,
                                  bool DisableVerify) {
-  PassBuilder PB(TM);
+  PassInstrumentationCallbacks PIC;
+  PassReportInstrumentation PassReport;
+  PassReport.registerCallbacks(PIC);
+
+  PassBuilder PB(TM, PipelineTuningOptions(), None, &PIC);
   AAManager AA;
 
   // Parse a custom AA pipeline if asked to.
@@ -344,15 +356,16 @@ void codegen(Config &Conf, TargetMachine *TM, AddStreamFn AddStream,
     DwoOut->keep();
 }
 
+// Splits Mod into one partition for each of Tasks and code generates the
+// partitions in parallel.
 void splitCodeGen(Config &C, TargetMachine *TM, AddStreamFn AddStream,
-                  unsigned ParallelCodeGenParallelismLevel,
-                  std::unique_ptr<Module> Mod) {
-  ThreadPool CodegenThreadPool(ParallelCodeGenParallelismLevel);
+                  ArrayRef<unsigned> Tasks, Module &Mod, bool PreserveLocals) {
+  ThreadPool CodegenThreadPool(Tasks.size());
   unsigned ThreadCount = 0;
   const Target *T = &TM->getTarget();
 
   SplitModule(
-      std::move(Mod), ParallelCodeGenParallelismLevel,
+      Mod, Tasks.size(),
       [&](std::unique_ptr<Module> MPart) {
         // We want to clone the module in a new context to multi-thread the
         // codegen. We do it by serializing partition modules to bitcode
@@ -378,13 +391,13 @@ void splitCodeGen(Config &C, TargetMachine *TM, AddStreamFn AddStream,
               std::unique_ptr<TargetMachine> TM =
                   createTargetMachine(C, T, *MPartInCtx);
 
-              codegen(C, TM.get(), AddStream, ThreadId, *MPartInCtx);
+              codegen(C, TM.get(), AddStream, Tasks[ThreadId], *MPartInCtx);
             },
             // Pass BC using std::move to ensure that it get moved rather than
             // copied into the thread's context.
             std::move(BC), ThreadCount++);
       },
-      false);
+      PreserveLocals);
 
   // Because the inner lambda (which runs in a worker thread) captures our local
   // variables, we need to wait for the worker threads to terminate before we
@@ -445,8 +458,10 @@ Error lto::backend(Config &C, AddStreamFn AddStream,
   if (ParallelCodeGenParallelismLevel == 1) {
     codegen(C, TM.get(), AddStream, 0, *Mod);
   } else {
-    splitCodeGen(C, TM.get(), AddStream, ParallelCodeGenParallelismLevel,
-                 std::move(Mod));
+    std::vector<unsigned> Tasks(ParallelCodeGenParallelismLevel);
+    std::iota(Tasks.begin(), Tasks.end(), 0);
+    splitCodeGen(C, TM.get(), AddStream, Tasks, *Mod,
+                 /*PreserveLocals=*/false);
   }
   return finalizeOptimizationRemarks(std::move(DiagnosticOutputFile));
 }
@@ -472,11 +487,30 @@ static void dropDeadSymbols(Module &Mod, const GVSummaryMapTy &DefinedGlobals,
   }
 }
 
+// Code generates a ThinLTO module, split into partitions for Task and
+// ExtraTasks if ExtraTasks is not empty.
+static void thinCodeGen(Config &Conf, TargetMachine *TM, AddStreamFn AddStream,
+                        unsigned Task, ArrayRef<unsigned> ExtraTasks,
+                        Module &Mod) {
+  if (ExtraTasks.empty()) {
+    codegen(Conf, TM, AddStream, Task, Mod);
+    return;
+  }
+
+  std::vector<unsigned> Tasks = {Task};
+  Tasks.insert(Tasks.end(), ExtraTasks.begin(), ExtraTasks.end());
+  // Other modules of the link may define locals with the same names, so the
+  // locals must stay in the partition of their users rather than being
+  // externalized.
+  splitCodeGen(Conf, TM, AddStream, Tasks, Mod, /*PreserveLocals=*/true);
+}
+
 Error lto::thinBackend(Config &Conf, unsigned Task, AddStreamFn AddStream,
                        Module &Mod, const ModuleSummaryIndex &CombinedIndex,
                        const FunctionImporter::ImportMapTy &ImportList,
                        const GVSummaryMapTy &DefinedGlobals,
-                       MapVector<StringRef, BitcodeModule> &ModuleMap) {
+                       MapVector<StringRef, BitcodeModule> &ModuleMap,
+                       ArrayRef<unsigned> ExtraTasks) {
   Expected<const Target *> TOrErr = initAndLookupTarget(Conf, Mod);
   if (!TOrErr)
     return TOrErr.takeError();
@@ -492,7 +526,7 @@ Error lto::thinBackend(Config &Conf, unsigned Task, AddStreamFn AddStream,
   auto DiagnosticOutputFile = std::move(*DiagFileOrErr);
 
   if (Conf.CodeGenOnly) {
-    codegen(Conf, TM.get(), AddStream, Task, Mod);
+    thinCodeGen(Conf, TM.get(), AddStream, Task, ExtraTasks, Mod);
     return finalizeOptimizationRemarks(std::move(DiagnosticOutputFile));
   }
 
@@ -536,6 +570,6 @@ Error lto::thinBackend(Config &Conf, unsigned Task, AddStreamFn AddStream,
            /*ExportSummary=*/nullptr, /*ImportSummary=*/&CombinedIndex))
     return finalizeOptimizationRemarks(std::move(DiagnosticOutputFile));
 
-  codegen(Conf, TM.get(), AddStream, Task, Mod);
+  thinCodeGen(Conf, TM.get(), AddStream, Task, ExtraTasks, Mod);
   return finalizeOptimizationRemarks(std::move(DiagnosticOutputFile));
 }
@@ -31,10 +31,12 @@
 #include "llvm/MC/MCSymbol.h"
 #include "llvm/MC/MCValue.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cassert>
 #include <cstdint>
@@ -67,6 +69,8 @@ STATISTIC(FragmentLayouts, "Number of fragment layouts");
 STATISTIC(ObjectBytes, "Number of emitted object file bytes");
 STATISTIC(RelaxationSteps, "Number of assembler layout and relaxation steps");
 STATISTIC(RelaxedInstructions, "Number of relaxed instructions");
+STATISTIC(ParallelRelaxedSections,
+          "Number of sections relaxed independently of the others");
 STATISTIC(PaddingFragmentsRelaxations,
           "Number of Padding Fragments relaxations");
 STATISTIC(PaddingFragmentsBytes,
@@ -75,6 +79,11 @@ STATISTIC(PaddingFragmentsBytes,
 } // end namespace stats
 } // end anonymous namespace
 
+static cl::opt<bool> ParallelRelax(
+    "mc-parallel-relax", cl::Hidden, cl::init(false),
+    cl::desc("Relax the sections whose layout only depends on their own "
+             "fragments concurrently, before relaxing the whole object"));
+
 // FIXME FIXME FIXME: There are number of places in this file where we convert
 // what is a 64-bit assembler value used for computation into a value in the
 // object file, which may truncate it. We should detect that truncation where
@@ -103,6 +112,7 @@ void MCAssembler::reset() {
   LinkerOptions.clear();
   FileNames.clear();
   ThumbFuncs.clear();
+  RelaxStates.clear();
   BundleAlignSize = 0;
   RelaxAll = false;
   SubsectionsViaSymbols = false;
@@ -781,10 +791,15 @@ void MCAssembler::layout(MCAsmLayout &Layout) {
       Frag.setLayoutOrder(FragmentIndex++);
   }
 
+  initRelaxState(Layout);
+  if (ParallelRelax)
+    relaxIndependentSections(Layout);
+
   // Layout until everything fits.
   while (layoutOnce(Layout))
     if (getContext().hadError())
       return;
+  RelaxStates.clear();
 
   DEBUG_WITH_TYPE("mc-dump", {
       errs() << "assembler backend - post-relaxation\n--\n";
@@ -920,7 +935,11 @@ bool MCAssembler::relaxInstruction(MCAsmLayout &Layout,
   SmallVector<MCFixup, 4> Fixups;
   SmallString<256> Code;
   raw_svector_ostream VecOS(Code);
-  getEmitter().encodeInstruction(Relaxed, VecOS, Fixups, *F.getSubtargetInfo());
+  {
+    std::lock_guard<std::mutex> Lock(EmitterMutex);
+    getEmitter().encodeInstruction(Relaxed, VecOS, Fixups,
+                                   *F.getSubtargetInfo());
+  }
 
   // Update the fragment.
   F.setInst(Relaxed);
@@ -1038,51 +1057,179 @@ bool MCAssembler::relaxCVDefRange(MCAsmLayout &Layout,
   return OldSize != F.getContents().size();
 }
 
+/// Returns true if \p Expr can be evaluated by looking at the layout of \p Sec
+/// only, and extends [\p Lo, \p Hi] to the layout orders of the fragments of
+/// \p Sec it refers to.
+static bool getLayoutRange(const MCExpr &Expr, const MCSection &Sec,
+                           unsigned &Lo, unsigned &Hi) {
+  switch (Expr.getKind()) {
+  case MCExpr::Constant:
+    return true;
+  case MCExpr::SymbolRef: {
+    const MCSymbol &Sym = cast<MCSymbolRefExpr>(Expr).getSymbol();
+    // Variables are evaluated, and their fragments cached, on first use.
+    if (Sym.isVariable())
+      return false;
+    if (!Sym.isInSection())
+      return Sym.isUndefined();
+    if (&Sym.getSection() != &Sec)
+      return false;
+    unsigned Order = Sym.getFragment()->getLayoutOrder();
+    Lo = std::min(Lo, Order);
+    Hi = std::max(Hi, Order);
+    return true;
+  }
+  case MCExpr::Unary:
+    return getLayoutRange(*cast<MCUnaryExpr>(Expr).getSubExpr(), Sec, Lo, Hi);
+  case MCExpr::Binary: {
+    const MCBinaryExpr &BE = cast<MCBinaryExpr>(Expr);
+    return getLayoutRange(*BE.getLHS(), Sec, Lo, Hi) &&
+           getLayoutRange(*BE.getRHS(), Sec, Lo, Hi);
+  }
+  case MCExpr::Target:
+    return false;
+  }
+  llvm_unreachable("Invalid expression kind!");
+}
+
+void MCAssembler::initRelaxState(MCAsmLayout &Layout) {
+  RelaxStates.clear();
+  RelaxStates.resize(Layout.getSectionOrder().size());
+  for (MCSection *Sec : Layout.getSectionOrder()) {
+    SectionRelaxState &State = RelaxStates[Sec->getLayoutOrder()];
+    for (MCFragment &F : *Sec) {
+      unsigned Order = F.getLayoutOrder();
+      switch (F.getKind()) {
+      default:
+        break;
+      case MCFragment::FT_Align:
+      case MCFragment::FT_Org:
+        State.OffsetDependent.push_back(Order);
+        break;
+      case MCFragment::FT_Padding:
+        State.OffsetDependent.push_back(Order);
+        State.Candidates.push_back({&F, 0, ~0u});
+        break;
+      case MCFragment::FT_Relaxable: {
+        auto &RF = cast<MCRelaxableFragment>(F);
+        if (!getBackend().mayNeedRelaxation(RF.getInst(),
+                                            *RF.getSubtargetInfo()))
+          break;
+        // The fixups only change when the fragments between the instruction
+        // and the symbols it refers to change size.
+        unsigned Lo = Order, Hi = Order;
+        for (const MCFixup &Fixup : RF.getFixups())
+          if (!getLayoutRange(*Fixup.getValue(), *Sec, Lo, Hi)) {
+            Lo = 0;
+            Hi = ~0u;
+            break;
+          }
+        State.Candidates.push_back({&F, Lo, Hi});
+        break;
+      }
+      case MCFragment::FT_Dwarf:
+      case MCFragment::FT_DwarfFrame:
+      case MCFragment::FT_LEB:
+      case MCFragment::FT_CVInlineLines:
+      case MCFragment::FT_CVDefRange:
+        State.Candidates.push_back({&F, 0, ~0u});
+        break;
+      }
+    }
+  }
+}
+
+/// Returns true if the size of a fragment in [\p C.Lo, \p C.Hi] may have
+/// changed since \p C was last looked at.
+static bool mayHaveChanged(const MCAssembler::SectionRelaxState &State,
+                           const MCAssembler::SectionRelaxState::Candidate &C) {
+  if (State.AllChanged || C.Hi == ~0u)
+    return true;
+  if (State.Changed.empty())
+    return false;
+  auto I = std::lower_bound(State.Changed.begin(), State.Changed.end(), C.Lo);
+  if (I != State.Changed.end() && *I <= C.Hi)
+    return true;
+  // Alignment and similar fragments after the first change may have moved,
+  // and with that changed size.
+  unsigned From = std::max(C.Lo, State.Changed.front() + 1);
+  auto J = std::lower_bound(State.OffsetDependent.begin(),
+                            State.OffsetDependent.end(), From);
+  return J != State.OffsetDependent.end() && *J <= C.Hi;
+}
+
 bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
+  SectionRelaxState &State = RelaxStates[Sec.getLayoutOrder()];
+  // Bundle padding depends on the offset of every fragment.
+  if (isBundlingEnabled())
+    State.AllChanged = true;
+
   // Holds the first fragment which needed relaxing during this layout. It will
   // remain NULL if none were relaxed.
   // When a fragment is relaxed, all the fragments following it should get
   // invalidated because their offset is going to change.
   MCFragment *FirstRelaxedFragment = nullptr;
-
-  // Attempt to relax all the fragments in the section.
-  for (MCSection::iterator I = Sec.begin(), IE = Sec.end(); I != IE; ++I) {
-    // Check if this is a fragment that needs relaxation.
+  SmallVector<unsigned, 16> Changed;
+
+  // Attempt to relax the fragments which may need it, unless nothing they
+  // depend on changed in the previous pass. Instructions are dropped from the
+  // worklist once they are relaxed to their final form.
+  unsigned NumKept = 0;
+  for (auto &C : State.Candidates) {
+    MCFragment *I = C.F;
+    bool Keep = true;
     bool RelaxedFrag = false;
-    switch(I->getKind()) {
-    default:
-      break;
-    case MCFragment::FT_Relaxable:
-      assert(!getRelaxAll() &&
-             "Did not expect a MCRelaxableFragment in RelaxAll mode");
-      RelaxedFrag = relaxInstruction(Layout, *cast<MCRelaxableFragment>(I));
-      break;
-    case MCFragment::FT_Dwarf:
-      RelaxedFrag = relaxDwarfLineAddr(Layout,
-                                       *cast<MCDwarfLineAddrFragment>(I));
-      break;
-    case MCFragment::FT_DwarfFrame:
-      RelaxedFrag =
-        relaxDwarfCallFrameFragment(Layout,
-                                    *cast<MCDwarfCallFrameFragment>(I));
-      break;
-    case MCFragment::FT_LEB:
-      RelaxedFrag = relaxLEB(Layout, *cast<MCLEBFragment>(I));
-      break;
-    case MCFragment::FT_Padding:
-      RelaxedFrag = relaxPaddingFragment(Layout, *cast<MCPaddingFragment>(I));
-      break;
-    case MCFragment::FT_CVInlineLines:
-      RelaxedFrag =
-          relaxCVInlineLineTable(Layout, *cast<MCCVInlineLineTableFragment>(I));
-      break;
-    case MCFragment::FT_CVDefRange:
-      RelaxedFrag = relaxCVDefRange(Layout, *cast<MCCVDefRangeFragment>(I));
-      break;
+    if (mayHaveChanged(State, C)) {
+      // Check if this is a fragment that needs relaxation.
+      switch(I->getKind()) {
+      default:
+        llvm_unreachable("Unexpected fragment on the relaxation worklist");
+      case MCFragment::FT_Relaxable: {
+        assert(!getRelaxAll() &&
+               "Did not expect a MCRelaxableFragment in RelaxAll mode");
+        auto &RF = *cast<MCRelaxableFragment>(I);
+        RelaxedFrag = relaxInstruction(Layout, RF);
+        Keep = !RelaxedFrag || getBackend().mayNeedRelaxation(
+                                   RF.getInst(), *RF.getSubtargetInfo());
+        break;
+      }
+      case MCFragment::FT_Dwarf:
+        RelaxedFrag = relaxDwarfLineAddr(Layout,
+                                         *cast<MCDwarfLineAddrFragment>(I));
+        break;
+      case MCFragment::FT_DwarfFrame:
+        RelaxedFrag =
+          relaxDwarfCallFrameFragment(Layout,
+                                      *cast<MCDwarfCallFrameFragment>(I));
+        break;
+      case MCFragment::FT_LEB:
+        RelaxedFrag = relaxLEB(Layout, *cast<MCLEBFragment>(I));
+        break;
+      case MCFragment::FT_Padding:
+        RelaxedFrag = relaxPaddingFragment(Layout,
+                                           *cast<MCPaddingFragment>(I));
+        break;
+      case MCFragment::FT_CVInlineLines:
+        RelaxedFrag = relaxCVInlineLineTable(
+            Layout, *cast<MCCVInlineLineTableFragment>(I));
+        break;
+      case MCFragment::FT_CVDefRange:
+        RelaxedFrag = relaxCVDefRange(Layout, *cast<MCCVDefRangeFragment>(I));
+        break;
+      }
     }
-    if (RelaxedFrag && !FirstRelaxedFragment)
-      FirstRelaxedFragment = &*I;
+    if (RelaxedFrag) {
+      Changed.push_back(I->getLayoutOrder());
+      if (!FirstRelaxedFragment)
+        FirstRelaxedFragment = I;
+    }
+    if (Keep)
+      State.Candidates[NumKept++] = C;
   }
+  State.Candidates.resize(NumKept);
+  State.Changed.assign(Changed.begin(), Changed.end());
+  State.AllChanged = false;
+
   if (FirstRelaxedFragment) {
     Layout.invalidateFragmentsFrom(FirstRelaxedFragment);
     return true;
@@ -1103,6 +1250,56 @@ bool MCAssembler::layoutOnce(MCAsmLayout &Layout) {
   return WasRelaxed;
 }
 
+/// Returns true if relaxing \p Sec never needs the layout of another section.
+/// Data fragment fixups are only evaluated by the object writer, so it is
+/// enough to look at the fragments that can be relaxed.
+static bool isIndependentSection(const MCSection &Sec) {
+  for (const MCFragment &F : Sec) {
+    switch (F.getKind()) {
+    case MCFragment::FT_Align:
+    case MCFragment::FT_Data:
+    case MCFragment::FT_CompactEncodedInst:
+    case MCFragment::FT_Dummy:
+      break;
+    case MCFragment::FT_Relaxable:
+      for (const MCFixup &Fixup : cast<MCRelaxableFragment>(F).getFixups()) {
+        unsigned Lo = ~0u, Hi = 0;
+        if (!getLayoutRange(*Fixup.getValue(), Sec, Lo, Hi))
+          return false;
+      }
+      break;
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+void MCAssembler::relaxIndependentSections(MCAsmLayout &Layout) {
+  // Bundling pads fragments based on the bundle state of the whole assembler.
+  if (isBundlingEnabled())
+    return;
+
+  SmallVector<MCSection *, 16> Independent;
+  for (MCSection *Sec : Layout.getSectionOrder())
+    if (isIndependentSection(*Sec))
+      Independent.push_back(Sec);
+  if (Independent.size() < 2)
+    return;
+  stats::ParallelRelaxedSections += Independent.size();
+
+  // Each task only lays out the fragments of its own section, and only looks
+  // up symbols defined there. The serial layout that follows resolves
+  // everything across sections.
+  ThreadPool Pool;
+  for (MCSection *Sec : Independent)
+    Pool.async([this, &Layout, Sec] {
+      while (layoutSectionOnce(Layout, *Sec))
+        ;
+    });
+  Pool.wait();
+}
+
 void MCAssembler::finishLayout(MCAsmLayout &Layout) {
   assert(getBackendPtr() && "Expected assembler backend");
   // The layout is done. Mark every fragment as valid.
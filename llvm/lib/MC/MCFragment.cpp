@@ -37,6 +37,12 @@ MCAsmLayout::MCAsmLayout(MCAssembler &Asm) : Assembler(Asm) {
   for (MCSection &Sec : Asm)
     if (Sec.isVirtualSection())
       SectionOrder.push_back(&Sec);
+
+  // Give every section its slot up front, so that laying out different
+  // sections never inserts into the map. This allows sections to be relaxed
+  // concurrently.
+  for (MCSection *Sec : SectionOrder)
+    LastValidFragment[Sec] = nullptr;
 }
 
 bool MCAsmLayout::isFragmentValid(const MCFragment *F) const {
@@ -12,6 +12,8 @@
 
 #include "llvm/Object/ArchiveWriter.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/BinaryFormat/Magic.h"
 #include "llvm/IR/LLVMContext.h"
@@ -23,6 +25,8 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -383,10 +387,57 @@ getSymbols(MemoryBufferRef Buf, raw_ostream &SymNames, bool &HasObject) {
   return Ret;
 }
 
+namespace {
+// The archive symbols of a single member, with name offsets relative to the
+// start of Names.
+struct MemberSymbols {
+  std::vector<unsigned> Offsets;
+  std::string Names;
+  bool HasObject = false;
+  Optional<Error> Err;
+};
+} // namespace
+
+/// Members of an existing archive that are written back unchanged still point
+/// into the old archive buffer. Map the start of each such member to the names
+/// its old symbol table lists for it, so these members need not be parsed
+/// again. Returns an empty map if the old archive has no usable symbol table.
+static DenseMap<const char *, std::vector<StringRef>>
+getOldArchiveSymbols(const MemoryBuffer *OldArchiveBuf) {
+  DenseMap<const char *, std::vector<StringRef>> Ret;
+  if (!OldArchiveBuf)
+    return Ret;
+
+  Error Err = Error::success();
+  object::Archive OldArchive(OldArchiveBuf->getMemBufferRef(), Err);
+  if (Err || OldArchive.isThin() || !OldArchive.hasSymbolTable()) {
+    consumeError(std::move(Err));
+    return Ret;
+  }
+
+  for (const object::Archive::Symbol &S : OldArchive.symbols()) {
+    Expected<object::Archive::Child> C = S.getMember();
+    if (!C) {
+      consumeError(C.takeError());
+      Ret.clear();
+      return Ret;
+    }
+    Expected<StringRef> Buf = C->getBuffer();
+    if (!Buf) {
+      consumeError(Buf.takeError());
+      Ret.clear();
+      return Ret;
+    }
+    Ret[Buf->data()].push_back(S.getName());
+  }
+  return Ret;
+}
+
 static Expected<std::vector<MemberData>>
 computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
                   object::Archive::Kind Kind, bool Thin, bool Deterministic,
-                  ArrayRef<NewArchiveMember> NewMembers) {
+                  ArrayRef<NewArchiveMember> NewMembers,
+                  const MemoryBuffer *OldArchiveBuf) {
   static char PaddingData[8] = {'\n', '\n', '\n', '\n', '\n', '\n', '\n', '\n'};
 
   // This ignores the symbol table, but we only need the value mod 8 and the
@@ -396,6 +447,51 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
   std::vector<MemberData> Ret;
   bool HasObject = false;
 
+  // Symbol extraction parses every member and dominates the cost of writing
+  // large archives, so do it up front and in parallel. Members carried over
+  // unchanged from the old archive reuse its symbol table instead. The
+  // results are merged below in member order, keeping the output identical
+  // to a serial computation.
+  DenseMap<const char *, std::vector<StringRef>> OldSymbols =
+      getOldArchiveSymbols(OldArchiveBuf);
+  std::vector<MemberSymbols> Symbols(NewMembers.size());
+  {
+    ThreadPool Pool(std::max<size_t>(
+        std::min<size_t>(NewMembers.size(), hardware_concurrency()), 1));
+    for (size_t I = 0, E = NewMembers.size(); I != E; ++I) {
+      MemoryBufferRef Buf = NewMembers[I].Buf->getMemBufferRef();
+      MemberSymbols &Result = Symbols[I];
+      auto It = OldSymbols.find(Buf.getBufferStart());
+      if (It != OldSymbols.end()) {
+        raw_string_ostream Names(Result.Names);
+        for (StringRef Name : It->second) {
+          Result.Offsets.push_back(Names.tell());
+          Names << Name << '\0';
+        }
+        Result.HasObject = true;
+        continue;
+      }
+      Pool.async([Buf, &Result] {
+        raw_string_ostream Names(Result.Names);
+        Expected<std::vector<unsigned>> Offsets =
+            getSymbols(Buf, Names, Result.HasObject);
+        if (!Offsets)
+          Result.Err = Offsets.takeError();
+        else
+          Result.Offsets = std::move(*Offsets);
+      });
+    }
+  }
+  for (MemberSymbols &Result : Symbols) {
+    if (!Result.Err)
+      continue;
+    Error E = std::move(*Result.Err);
+    for (MemberSymbols &Other : Symbols)
+      if (Other.Err)
+        consumeError(std::move(*Other.Err));
+    return std::move(E);
+  }
+
   // Deduplicate long member names in the string table and reuse earlier name
   // offsets. This especially saves space for COFF Import libraries where all
   // members have the same name.
@@ -451,7 +547,8 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
       Entry.second = Entry.second > 1 ? 1 : 0;
   }
 
-  for (const NewArchiveMember &M : NewMembers) {
+  for (size_t I = 0, E = NewMembers.size(); I != E; ++I) {
+    const NewArchiveMember &M = NewMembers[I];
     std::string Header;
     raw_string_ostream Out(Header);
 
@@ -477,13 +574,16 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
                       ModTime, Buf.getBufferSize() + MemberPadding);
     Out.flush();
 
-    Expected<std::vector<unsigned>> Symbols =
-        getSymbols(Buf, SymNames, HasObject);
-    if (auto E = Symbols.takeError())
-      return std::move(E);
+    MemberSymbols &Result = Symbols[I];
+    unsigned Base = SymNames.tell();
+    for (unsigned &Offset : Result.Offsets)
+      Offset += Base;
+    SymNames << Result.Names;
+    HasObject |= Result.HasObject;
 
     Pos += Header.size() + Data.size() + Padding.size();
-    Ret.push_back({std::move(*Symbols), std::move(Header), Data, Padding});
+    Ret.push_back(
+        {std::move(Result.Offsets), std::move(Header), Data, Padding});
   }
   // If there are no symbols, emit an empty symbol table, to satisfy Solaris
   // tools, older versions of which expect a symbol table in a non-empty
@@ -531,7 +631,8 @@ Error writeArchive(StringRef ArcName, ArrayRef<NewArchiveMember> NewMembers,
   raw_svector_ostream StringTable(StringTableBuf);
 
   Expected<std::vector<MemberData>> DataOrErr = computeMemberData(
-      StringTable, SymNames, Kind, Thin, Deterministic, NewMembers);
+      StringTable, SymNames, Kind, Thin, Deterministic, NewMembers,
+      OldArchiveBuf.get());
   if (Error E = DataOrErr.takeError())
     return E;
   std::vector<MemberData> &Data = *DataOrErr;
@@ -54,10 +54,12 @@
 #include "llvm/CodeGen/PreISelIntrinsicLowering.h"
 #include "llvm/CodeGen/UnreachableBlockElim.h"
 #include "llvm/IR/Dominators.h"
+#include "llvm/IR/IRMemoryUsage.h"
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/IR/SafepointIRVerifier.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/Regex.h"
@@ -172,6 +174,7 @@
 #include "llvm/Transforms/Vectorize/LoadStoreVectorizer.h"
 #include "llvm/Transforms/Vectorize/LoopVectorize.h"
 #include "llvm/Transforms/Vectorize/SLPVectorizer.h"
+#include <chrono>
 
 using namespace llvm;
 
@@ -207,6 +210,23 @@ static cl::opt<bool> EnableSyntheticCounts(
 static Regex DefaultAliasRegex(
     "^(default|thinlto-pre-link|thinlto|lto-pre-link|lto)<(O[0123sz])>$");
 
+static cl::opt<unsigned> ReducedPipelineSizeThreshold(
+    "reduced-pipeline-size-threshold", cl::init(0), cl::Hidden,
+    cl::desc("Skip the most expensive passes of the default pipelines on "
+             "functions that aren't hot and have more IR instructions than "
+             "this (default = 0, off)"));
+
+static cl::opt<bool> ReducedPipelineForCold(
+    "reduced-pipeline-for-cold", cl::init(false), cl::Hidden,
+    cl::desc("Skip the most expensive passes of the default pipelines on "
+             "functions that the profile says are cold (default = off)"));
+
+static cl::opt<unsigned> ReducedPipelineTimeBudget(
+    "reduced-pipeline-time-budget", cl::init(0), cl::Hidden,
+    cl::desc("Skip the most expensive passes of the default pipelines on "
+             "functions that aren't hot once they took this many "
+             "milliseconds for the module (default = 0, off)"));
+
 // This option is used in simplifying testing SampleFDO optimizations for
 // profile loading.
 static cl::opt<bool>
@@ -221,6 +241,118 @@ PipelineTuningOptions::PipelineTuningOptions() {
   ForgetAllSCEVInLoopUnroll = ForgetSCEVInLoopUnroll;
   LicmMssaOptCap = SetLicmMssaOptCap;
   LicmMssaNoAccForPromotionCap = SetLicmMssaNoAccForPromotionCap;
+  ReducedPipelineSizeThreshold = ::ReducedPipelineSizeThreshold;
+  ReducedPipelineForColdFunctions = ReducedPipelineForCold;
+  ReducedPipelineTimeBudget = ::ReducedPipelineTimeBudget;
+}
+
+#define DEBUG_TYPE "reduced-pipeline"
+
+STATISTIC(NumSkippedRuns,
+          "Number of expensive pass runs skipped by the reduced pipeline");
+
+/// Decides which functions aren't worth the most expensive passes of the
+/// default pipelines. Functions that the profile says are hot always get the
+/// full pipeline. The others get the reduced one if they are cold, huge, or
+/// once the expensive passes used up the compile time budget of the module.
+class llvm::ReducedPipelinePolicy {
+public:
+  ReducedPipelinePolicy(const PipelineTuningOptions &PTO)
+      : SizeThreshold(PTO.ReducedPipelineSizeThreshold),
+        ForColdFunctions(PTO.ReducedPipelineForColdFunctions),
+        TimeBudget(std::chrono::milliseconds(PTO.ReducedPipelineTimeBudget)) {}
+
+  bool isReduced(Function &F, FunctionAnalysisManager &AM) {
+    // The default pipelines require the profile summary before they run any
+    // function pass, so it is cached if there is a profile.
+    const ModuleAnalysisManager &MAM =
+        AM.getResult<ModuleAnalysisManagerFunctionProxy>(F).getManager();
+    ProfileSummaryInfo *PSI =
+        MAM.getCachedResult<ProfileSummaryAnalysis>(*F.getParent());
+    if (PSI && PSI->isFunctionEntryHot(&F))
+      return false;
+    if (ForColdFunctions && PSI && PSI->isFunctionEntryCold(&F))
+      return true;
+    if (SizeThreshold && F.getInstructionCount() > SizeThreshold)
+      return true;
+    return TimeBudget.count() && F.getParent() == CurrentModule &&
+           Spent >= TimeBudget;
+  }
+
+  /// Records the time that an expensive pass took on \p F.
+  void addTime(const Function &F, std::chrono::steady_clock::duration Time) {
+    if (F.getParent() != CurrentModule) {
+      CurrentModule = F.getParent();
+      Spent = std::chrono::steady_clock::duration::zero();
+    }
+    bool WasInBudget = Spent < TimeBudget;
+    Spent += Time;
+    LLVM_DEBUG(dbgs() << "Expensive pass took "
+                      << std::chrono::duration_cast<std::chrono::microseconds>(
+                             Time)
+                             .count()
+                      << "us on " << F.getName() << "\n");
+    if (TimeBudget.count() && WasInBudget && Spent >= TimeBudget)
+      LLVM_DEBUG(dbgs() << "Compile time budget of " << TimeBudget.count()
+                        << "ms used up at " << F.getName()
+                        << ", only hot functions get the full pipeline\n");
+  }
+
+private:
+  const unsigned SizeThreshold;
+  const bool ForColdFunctions;
+  const std::chrono::milliseconds TimeBudget;
+  // The time taken by the expensive passes on the current module.
+  const Module *CurrentModule = nullptr;
+  std::chrono::steady_clock::duration Spent =
+      std::chrono::steady_clock::duration::zero();
+};
+
+namespace {
+/// Runs an expensive function pass, unless the function gets the reduced
+/// pipeline.
+template <typename PassT>
+class FullPipelineOnlyPass
+    : public PassInfoMixin<FullPipelineOnlyPass<PassT>> {
+public:
+  FullPipelineOnlyPass(PassT Pass,
+                       std::shared_ptr<ReducedPipelinePolicy> Policy)
+      : Pass(std::move(Pass)), Policy(std::move(Policy)) {}
+
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM) {
+    if (Policy->isReduced(F, AM)) {
+      ++NumSkippedRuns;
+      return PreservedAnalyses::all();
+    }
+    auto Start = std::chrono::steady_clock::now();
+    PreservedAnalyses PA = Pass.run(F, AM);
+    Policy->addTime(F, std::chrono::steady_clock::now() - Start);
+    return PA;
+  }
+
+private:
+  PassT Pass;
+  std::shared_ptr<ReducedPipelinePolicy> Policy;
+};
+} // namespace
+
+#undef DEBUG_TYPE
+
+/// Adds a pass that the reduced pipeline skips.
+template <typename PassT>
+static void
+addExpensivePass(FunctionPassManager &FPM, PassT Pass,
+                 const std::shared_ptr<ReducedPipelinePolicy> &Policy) {
+  if (Policy)
+    FPM.addPass(FullPipelineOnlyPass<PassT>(std::move(Pass), Policy));
+  else
+    FPM.addPass(std::move(Pass));
+}
+
+void PassBuilder::initReducedPipeline() {
+  if (PTO.ReducedPipelineSizeThreshold || PTO.ReducedPipelineForColdFunctions ||
+      PTO.ReducedPipelineTimeBudget)
+    ReducedPipeline = std::make_shared<ReducedPipelinePolicy>(PTO);
 }
 
 extern cl::opt<bool> EnableHotColdSplit;
@@ -418,7 +550,10 @@ PassBuilder::buildFunctionSimplificationPipeline(OptimizationLevel Level,
 
   // For PGO use pipeline, try to optimize memory intrinsics such as memcpy
   // using the size value profile. Don't perform this when optimizing for size.
-  if (PGOOpt && PGOOpt->Action == PGOOptions::IRUse &&
+  // The ThinLTO backends get the size value profile of the functions they
+  // import from other modules, so run it there too.
+  if (((PGOOpt && PGOOpt->Action == PGOOptions::IRUse) ||
+       Phase == ThinLTOPhase::PostLink) &&
       !isOptimizingForSize(Level))
     FPM.addPass(PGOMemOPSizeOpt());
 
@@ -475,17 +610,17 @@ PassBuilder::buildFunctionSimplificationPipeline(OptimizationLevel Level,
   FPM.addPass(RequireAnalysisPass<OptimizationRemarkEmitterAnalysis, Function>());
   FPM.addPass(createFunctionToLoopPassAdaptor(std::move(LPM1), DebugLogging));
   FPM.addPass(SimplifyCFGPass());
-  FPM.addPass(InstCombinePass());
+  addExpensivePass(FPM, InstCombinePass(), ReducedPipeline);
   FPM.addPass(createFunctionToLoopPassAdaptor(std::move(LPM2), DebugLogging));
 
   // Eliminate redundancies.
   if (Level != O1) {
     // These passes add substantial compile time so skip them at O1.
-    FPM.addPass(MergedLoadStoreMotionPass());
+    addExpensivePass(FPM, MergedLoadStoreMotionPass(), ReducedPipeline);
     if (RunNewGVN)
-      FPM.addPass(NewGVNPass());
+      addExpensivePass(FPM, NewGVNPass(), ReducedPipeline);
     else
-      FPM.addPass(GVN());
+      addExpensivePass(FPM, GVN(), ReducedPipeline);
   }
 
   // Specially optimize memory movement as it doesn't look like dataflow in SSA.
@@ -503,7 +638,7 @@ PassBuilder::buildFunctionSimplificationPipeline(OptimizationLevel Level,
 
   // Run instcombine after redundancy and dead bit elimination to exploit
   // opportunities opened up by them.
-  FPM.addPass(InstCombinePass());
+  addExpensivePass(FPM, InstCombinePass(), ReducedPipeline);
   invokePeepholeEPCallbacks(FPM, Level);
 
   // Re-consider control flow based optimizations after redundancy elimination,
@@ -869,8 +1004,10 @@ ModulePassManager PassBuilder::buildModuleOptimizationPipeline(
   OptimizePM.addPass(LoopDistributePass());
 
   // Now run the core loop vectorizer.
-  OptimizePM.addPass(LoopVectorizePass(
-      LoopVectorizeOptions(!PTO.LoopInterleaving, !PTO.LoopVectorization)));
+  addExpensivePass(OptimizePM,
+                   LoopVectorizePass(LoopVectorizeOptions(
+                       !PTO.LoopInterleaving, !PTO.LoopVectorization)),
+                   ReducedPipeline);
 
   // Eliminate loads by forwarding stores from the previous iteration to loads
   // of the current iteration.
@@ -896,7 +1033,7 @@ ModulePassManager PassBuilder::buildModuleOptimizationPipeline(
 
   // Optimize parallel scalar instruction chains into SIMD instructions.
   if (PTO.SLPVectorization)
-    OptimizePM.addPass(SLPVectorizerPass());
+    addExpensivePass(OptimizePM, SLPVectorizerPass(), ReducedPipeline);
 
   OptimizePM.addPass(InstCombinePass());
 
@@ -21,12 +21,37 @@
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/PassInstrumentation.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
 
+static cl::opt<std::string> PassReportFile(
+    "time-passes-report", cl::Hidden, cl::value_desc("filename"),
+    cl::desc("Append the time, instruction counts and memory of every run of "
+             "a pass on a function, loop, SCC or module to the given file"));
+
+static cl::opt<PassReportInstrumentation::ReportFormat> PassReportFormat(
+    "time-passes-report-format", cl::Hidden,
+    cl::desc("Format of the -time-passes-report file"),
+    cl::init(PassReportInstrumentation::ReportFormat::JSON),
+    cl::values(clEnumValN(PassReportInstrumentation::ReportFormat::JSON,
+                          "json", "One JSON object per pass run and line"),
+               clEnumValN(PassReportInstrumentation::ReportFormat::CSV, "csv",
+                          "Comma-separated values, with a header line")));
+
+/// Serializes appends to the -time-passes-report file by the pipelines that
+/// run concurrently, e.g. in ThinLTO backends.
+static ManagedStatic<sys::SmartMutex<true>> PassReportFileLock;
+
 namespace {
 
 /// Extracting Module out of \p IR unit. Also fills a textual description
@@ -141,6 +166,86 @@ void unwrapAndPrint(Any IR, StringRef Banner, bool ForceModule = false) {
   llvm_unreachable("Unknown wrapped IR type");
 }
 
+/// What the pass report records about the IR unit a pass runs on.
+struct IRUnitDesc {
+  const Module *M;
+  std::string Name;
+  unsigned NumInstrs;
+};
+
+IRUnitDesc describeIRUnit(Any IR) {
+  if (any_isa<const Module *>(IR)) {
+    const Module *M = any_cast<const Module *>(IR);
+    unsigned NumInstrs = 0;
+    for (const Function &F : *M)
+      NumInstrs += F.getInstructionCount();
+    return {M, std::string(), NumInstrs};
+  }
+
+  if (any_isa<const Function *>(IR)) {
+    const Function *F = any_cast<const Function *>(IR);
+    return {F->getParent(), F->getName(), F->getInstructionCount()};
+  }
+
+  if (any_isa<const LazyCallGraph::SCC *>(IR)) {
+    const LazyCallGraph::SCC *C = any_cast<const LazyCallGraph::SCC *>(IR);
+    const Module *M = nullptr;
+    unsigned NumInstrs = 0;
+    for (const LazyCallGraph::Node &N : *C) {
+      M = N.getFunction().getParent();
+      NumInstrs += N.getFunction().getInstructionCount();
+    }
+    return {M, C->getName(), NumInstrs};
+  }
+
+  if (any_isa<const Loop *>(IR)) {
+    const Loop *L = any_cast<const Loop *>(IR);
+    const Function *F = L->getHeader()->getParent();
+    unsigned NumInstrs = 0;
+    for (const BasicBlock *BB : L->blocks())
+      NumInstrs += BB->size();
+    std::string LoopName;
+    raw_string_ostream ss(LoopName);
+    L->getHeader()->printAsOperand(ss, false);
+    return {F->getParent(),
+            formatv("{0} (loop: {1})", F->getName(), ss.str()).str(),
+            NumInstrs};
+  }
+  llvm_unreachable("Unknown wrapped IR type");
+}
+
+/// The name of the IR unit a pass runs on, used as the detail of its time
+/// trace section. Unlike describeIRUnit this does not count instructions.
+std::string getIRUnitName(Any IR) {
+  if (any_isa<const Module *>(IR))
+    return any_cast<const Module *>(IR)->getName();
+  if (any_isa<const Function *>(IR))
+    return any_cast<const Function *>(IR)->getName();
+  if (any_isa<const LazyCallGraph::SCC *>(IR))
+    return any_cast<const LazyCallGraph::SCC *>(IR)->getName();
+  if (any_isa<const Loop *>(IR))
+    return any_cast<const Loop *>(IR)->getName();
+  llvm_unreachable("Unknown wrapped IR type");
+}
+
+/// Names end up in the report as JSON strings, which must be valid UTF-8.
+json::Value toJSONString(StringRef S) {
+  if (LLVM_UNLIKELY(!json::isUTF8(S)))
+    return json::fixUTF8(S);
+  return S.str();
+}
+
+/// Quotes \p S as a CSV field, doubling the quotes it contains.
+void printCSVString(raw_ostream &OS, StringRef S) {
+  OS << '"';
+  for (char C : S) {
+    if (C == '"')
+      OS << '"';
+    OS << C;
+  }
+  OS << '"';
+}
+
 } // namespace
 
 PrintIRInstrumentation::~PrintIRInstrumentation() {
@@ -235,8 +340,171 @@ void PrintIRInstrumentation::registerCallbacks(
   }
 }
 
+PassReportInstrumentation::PassReportInstrumentation()
+    : PassReportInstrumentation(!PassReportFile.empty(), PassReportFormat) {}
+
+PassReportInstrumentation::PassReportInstrumentation(bool Enabled,
+                                                     ReportFormat Format)
+    : Enabled(Enabled), Format(Format) {}
+
+bool PassReportInstrumentation::runBeforePass(StringRef PassID, Any IR) {
+  if (PassID.startswith("PassManager<") || PassID.contains("PassAdaptor<"))
+    return true;
+
+  IRUnitDesc Desc = describeIRUnit(IR);
+  PassRun Run;
+  Run.PassID = PassID;
+  Run.ModuleID = Desc.M ? Desc.M->getModuleIdentifier() : std::string();
+  Run.IRName = std::move(Desc.Name);
+  Run.InstrsBefore = Desc.NumInstrs;
+  // Take the time last, so that counting instructions is not part of the run.
+  ActiveRuns.emplace_back(std::move(Run), TimeRecord::getCurrentTime(true));
+  return true;
+}
+
+void PassReportInstrumentation::finishRun(StringRef PassID, TimeRecord End,
+                                          Optional<unsigned> InstrsAfter) {
+  assert(!ActiveRuns.empty() && "pass finished without having started");
+  PassRun Run = std::move(ActiveRuns.back().first);
+  End -= ActiveRuns.back().second;
+  ActiveRuns.pop_back();
+  assert(Run.PassID == PassID && "pass runs are not properly nested");
+  (void)PassID;
+
+  Run.WallTime = End.getWallTime();
+  Run.MemUsed = End.getMemUsed();
+  Run.InstrsAfter = InstrsAfter;
+  Runs.push_back(std::move(Run));
+}
+
+void PassReportInstrumentation::runAfterPass(StringRef PassID, Any IR) {
+  if (PassID.startswith("PassManager<") || PassID.contains("PassAdaptor<"))
+    return;
+  // Take the time first, so that counting instructions is not part of the run.
+  TimeRecord End = TimeRecord::getCurrentTime(false);
+  finishRun(PassID, End, describeIRUnit(IR).NumInstrs);
+}
+
+void PassReportInstrumentation::runAfterPassInvalidated(StringRef PassID) {
+  if (PassID.startswith("PassManager<") || PassID.contains("PassAdaptor<"))
+    return;
+  finishRun(PassID, TimeRecord::getCurrentTime(false), None);
+}
+
+void PassReportInstrumentation::printRuns(raw_ostream &OS,
+                                          bool PrintHeader) const {
+  if (Format == ReportFormat::JSON) {
+    for (const PassRun &Run : Runs) {
+      json::Object Record{{"pass", toJSONString(Run.PassID)},
+                          {"module", toJSONString(Run.ModuleID)},
+                          {"ir", toJSONString(Run.IRName)},
+                          {"wall_time", Run.WallTime},
+                          {"instrs_before", Run.InstrsBefore},
+                          {"mem_used", static_cast<int64_t>(Run.MemUsed)}};
+      if (Run.InstrsAfter)
+        Record["instrs_after"] = *Run.InstrsAfter;
+      else
+        Record["instrs_after"] = nullptr;
+      OS << json::Value(std::move(Record)) << '\n';
+    }
+    return;
+  }
+
+  if (PrintHeader)
+    OS << "pass,module,ir,wall_time,instrs_before,instrs_after,mem_used\n";
+  for (const PassRun &Run : Runs) {
+    printCSVString(OS, Run.PassID);
+    OS << ',';
+    printCSVString(OS, Run.ModuleID);
+    OS << ',';
+    printCSVString(OS, Run.IRName);
+    OS << ',' << format("%.9f", Run.WallTime) << ',' << Run.InstrsBefore
+       << ',';
+    // An invalidated IR unit leaves the count empty.
+    if (Run.InstrsAfter)
+      OS << *Run.InstrsAfter;
+    OS << ',' << static_cast<int64_t>(Run.MemUsed) << '\n';
+  }
+}
+
+void PassReportInstrumentation::print() {
+  if (!Enabled || Runs.empty())
+    return;
+
+  if (OutStream) {
+    printRuns(*OutStream, /*PrintHeader=*/true);
+    Runs.clear();
+    return;
+  }
+
+  sys::SmartScopedLock<true> Lock(*PassReportFileLock);
+  // Only the first pipeline writing to the file prints the CSV header.
+  uint64_t Size = 0;
+  bool Empty = sys::fs::file_size(PassReportFile, Size) || Size == 0;
+  std::error_code EC;
+  raw_fd_ostream OS(PassReportFile, EC, sys::fs::OF_Append | sys::fs::OF_Text);
+  if (EC) {
+    errs() << "Error opening pass report file '" << PassReportFile
+           << "': " << EC.message() << "\n";
+    Runs.clear();
+    return;
+  }
+  printRuns(OS, Empty);
+  Runs.clear();
+}
+
+void PassReportInstrumentation::setOutStream(raw_ostream &Out) {
+  OutStream = &Out;
+}
+
+void PassReportInstrumentation::registerCallbacks(
+    PassInstrumentationCallbacks &PIC) {
+  if (!Enabled)
+    return;
+
+  PIC.registerBeforePassCallback(
+      [this](StringRef P, Any IR) { return this->runBeforePass(P, IR); });
+  PIC.registerAfterPassCallback(
+      [this](StringRef P, Any IR) { this->runAfterPass(P, IR); });
+  PIC.registerAfterPassInvalidatedCallback(
+      [this](StringRef P) { this->runAfterPassInvalidated(P); });
+}
+
+bool TimeProfilingPassesHandler::runBeforePass(StringRef PassID, Any IR) {
+  if (PassID.startswith("PassManager<") || PassID.contains("PassAdaptor<"))
+    return true;
+  timeTraceProfilerBegin(PassID, [&IR] { return getIRUnitName(IR); });
+  return true;
+}
+
+void TimeProfilingPassesHandler::runAfterPass(StringRef PassID) {
+  if (PassID.startswith("PassManager<") || PassID.contains("PassAdaptor<"))
+    return;
+  timeTraceProfilerEnd();
+}
+
+void TimeProfilingPassesHandler::registerCallbacks(
+    PassInstrumentationCallbacks &PIC) {
+  if (!timeTraceProfilerEnabled())
+    return;
+
+  PIC.registerBeforePassCallback(
+      [this](StringRef P, Any IR) { return this->runBeforePass(P, IR); });
+  PIC.registerAfterPassCallback(
+      [this](StringRef P, Any) { this->runAfterPass(P); });
+  PIC.registerAfterPassInvalidatedCallback(
+      [this](StringRef P) { this->runAfterPass(P); });
+  PIC.registerBeforeAnalysisCallback([](StringRef P, Any IR) {
+    timeTraceProfilerBegin(P, [&IR] { return getIRUnitName(IR); });
+  });
+  PIC.registerAfterAnalysisCallback(
+      [](StringRef, Any) { timeTraceProfilerEnd(); });
+}
+
 void StandardInstrumentations::registerCallbacks(
     PassInstrumentationCallbacks &PIC) {
   PrintIR.registerCallbacks(PIC);
   TimePasses.registerCallbacks(PIC);
+  PassReport.registerCallbacks(PIC);
+  TimeProfilingPasses.registerCallbacks(PIC);
 }
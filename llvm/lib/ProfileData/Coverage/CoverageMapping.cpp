@@ -27,10 +27,12 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <future>
 #include <iterator>
 #include <map>
 #include <memory>
@@ -242,14 +244,30 @@ Error CoverageMapping::loadFunctionRecord(
     Function.pushRegion(Region, *ExecutionCount);
   }
 
+  addFunctionRecord(std::move(Function));
+  return Error::success();
+}
+
+void CoverageMapping::addFunctionRecord(FunctionRecord Function) {
   // Don't create records for (filenames, function) pairs we've already seen.
-  auto FilenamesHash = hash_combine_range(Record.Filenames.begin(),
-                                          Record.Filenames.end());
-  if (!RecordProvenance[FilenamesHash].insert(hash_value(OrigFuncName)).second)
-    return Error::success();
+  auto FilenamesHash = hash_combine_range(Function.Filenames.begin(),
+                                          Function.Filenames.end());
+  if (!RecordProvenance[FilenamesHash].insert(hash_value(Function.Name)).second)
+    return;
+
+  // Remember which files the function is in, so that file queries don't have
+  // to look at every function.
+  unsigned RecordIndex = Functions.size();
+  SmallVector<size_t, 4> FilenameHashes;
+  for (const std::string &Filename : Function.Filenames) {
+    size_t FilenameHash = hash_value(Filename);
+    if (is_contained(FilenameHashes, FilenameHash))
+      continue;
+    FilenameHashes.push_back(FilenameHash);
+    FilenameHash2RecordIndices[FilenameHash].push_back(RecordIndex);
+  }
 
   Functions.push_back(std::move(Function));
-  return Error::success();
 }
 
 Expected<std::unique_ptr<CoverageMapping>> CoverageMapping::load(
@@ -270,9 +288,77 @@ Expected<std::unique_ptr<CoverageMapping>> CoverageMapping::load(
   return std::move(Coverage);
 }
 
+Expected<std::unique_ptr<CoverageMapping>>
+CoverageMapping::loadObject(StringRef ObjectFilename, StringRef ProfileFilename,
+                            StringRef Arch, ArrayRef<StringRef> SourceFiles) {
+  auto ProfileReaderOrErr = IndexedInstrProfReader::create(ProfileFilename);
+  if (Error E = ProfileReaderOrErr.takeError())
+    return std::move(E);
+  auto CovMappingBufOrErr = MemoryBuffer::getFileOrSTDIN(ObjectFilename);
+  if (std::error_code EC = CovMappingBufOrErr.getError())
+    return errorCodeToError(EC);
+  auto CoverageReaderOrErr =
+      BinaryCoverageReader::create(CovMappingBufOrErr.get(), Arch);
+  if (Error E = CoverageReaderOrErr.takeError())
+    return std::move(E);
+  CoverageReaderOrErr.get()->setFileFilter(SourceFiles);
+  std::unique_ptr<CoverageMappingReader> Reader =
+      std::move(CoverageReaderOrErr.get());
+  return load(Reader, *ProfileReaderOrErr.get());
+}
+
 Expected<std::unique_ptr<CoverageMapping>>
 CoverageMapping::load(ArrayRef<StringRef> ObjectFilenames,
-                      StringRef ProfileFilename, ArrayRef<StringRef> Arches) {
+                      StringRef ProfileFilename, ArrayRef<StringRef> Arches,
+                      unsigned NumThreads, ArrayRef<StringRef> SourceFiles) {
+  if (NumThreads > 1 && ObjectFilenames.size() > 1) {
+    // Decode every object in a task of its own, then add their function
+    // records in the order of the objects, so that the same records are kept
+    // as when loading serially.
+    std::vector<Optional<Expected<std::unique_ptr<CoverageMapping>>>> Objects(
+        ObjectFilenames.size());
+    std::vector<std::shared_future<void>> Done;
+    ThreadPool Pool(NumThreads);
+    for (const auto &File : llvm::enumerate(ObjectFilenames)) {
+      StringRef ObjectFilename = File.value();
+      StringRef Arch = Arches.empty() ? StringRef() : Arches[File.index()];
+      auto &Object = Objects[File.index()];
+      Done.push_back(Pool.async([&Object, ObjectFilename, ProfileFilename,
+                                 Arch, SourceFiles]() {
+        Object.emplace(
+            loadObject(ObjectFilename, ProfileFilename, Arch, SourceFiles));
+      }));
+    }
+
+    auto Coverage = std::unique_ptr<CoverageMapping>(new CoverageMapping());
+    Error Err = Error::success();
+    for (unsigned I = 0, E = Objects.size(); I < E; ++I) {
+      Done[I].wait();
+      Expected<std::unique_ptr<CoverageMapping>> &ObjectOrErr = *Objects[I];
+      if (!ObjectOrErr) {
+        // Report the first error, like the serial loading does.
+        if (Err)
+          consumeError(ObjectOrErr.takeError());
+        else
+          Err = ObjectOrErr.takeError();
+        continue;
+      }
+      std::unique_ptr<CoverageMapping> Object = std::move(ObjectOrErr.get());
+      Objects[I].reset();
+      if (Err)
+        continue;
+      for (FunctionRecord &Function : Object->Functions)
+        Coverage->addFunctionRecord(std::move(Function));
+      Coverage->FuncHashMismatches.insert(
+          Coverage->FuncHashMismatches.end(),
+          std::make_move_iterator(Object->FuncHashMismatches.begin()),
+          std::make_move_iterator(Object->FuncHashMismatches.end()));
+    }
+    if (Err)
+      return std::move(Err);
+    return std::move(Coverage);
+  }
+
   auto ProfileReaderOrErr = IndexedInstrProfReader::create(ProfileFilename);
   if (Error E = ProfileReaderOrErr.takeError())
     return std::move(E);
@@ -289,6 +375,7 @@ CoverageMapping::load(ArrayRef<StringRef> ObjectFilenames,
         BinaryCoverageReader::create(CovMappingBufOrErr.get(), Arch);
     if (Error E = CoverageReaderOrErr.takeError())
       return std::move(E);
+    CoverageReaderOrErr.get()->setFileFilter(SourceFiles);
     Readers.push_back(std::move(CoverageReaderOrErr.get()));
     Buffers.push_back(std::move(CovMappingBufOrErr.get()));
   }
@@ -600,11 +687,25 @@ static bool isExpansion(const CountedRegion &R, unsigned FileID) {
   return R.Kind == CounterMappingRegion::ExpansionRegion && R.FileID == FileID;
 }
 
+ArrayRef<unsigned> CoverageMapping::getImpreciseRecordIndicesForFilename(
+    StringRef Filename) const {
+  size_t FilenameHash = hash_value(Filename);
+  auto RecordIt = FilenameHash2RecordIndices.find(FilenameHash);
+  if (RecordIt == FilenameHash2RecordIndices.end())
+    return {};
+  return RecordIt->second;
+}
+
 CoverageData CoverageMapping::getCoverageForFile(StringRef Filename) const {
   CoverageData FileCoverage(Filename);
   std::vector<CountedRegion> Regions;
 
-  for (const auto &Function : Functions) {
+  // Look up the function records in the given file. Due to hash collisions on
+  // the filename, we may get back some records that are not in the file.
+  ArrayRef<unsigned> RecordIndices =
+      getImpreciseRecordIndicesForFilename(Filename);
+  for (unsigned RecordIndex : RecordIndices) {
+    const FunctionRecord &Function = Functions[RecordIndex];
     auto MainFileID = findMainViewFileID(Filename, Function);
     auto FileIDs = gatherFileIDs(Filename, Function);
     for (const auto &CR : Function.CountedRegions)
@@ -624,7 +725,12 @@ CoverageData CoverageMapping::getCoverageForFile(StringRef Filename) const {
 std::vector<InstantiationGroup>
 CoverageMapping::getInstantiationGroups(StringRef Filename) const {
   FunctionInstantiationSetCollector InstantiationSetCollector;
-  for (const auto &Function : Functions) {
+  // Look up the function records in the given file. Due to hash collisions on
+  // the filename, we may get back some records that are not in the file.
+  ArrayRef<unsigned> RecordIndices =
+      getImpreciseRecordIndicesForFilename(Filename);
+  for (unsigned RecordIndex : RecordIndices) {
+    const FunctionRecord &Function = Functions[RecordIndex];
     auto MainFileID = findMainViewFileID(Filename, Function);
     if (!MainFileID)
       continue;
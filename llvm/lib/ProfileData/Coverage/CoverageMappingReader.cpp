@@ -249,7 +249,7 @@ Error RawCoverageMappingReader::readMappingRegionsSubArray(
   return Error::success();
 }
 
-Error RawCoverageMappingReader::read() {
+Error RawCoverageMappingReader::readFilenames() {
   // Read the virtual file mapping.
   SmallVector<unsigned, 8> VirtualFileMapping;
   uint64_t NumFileMappings;
@@ -266,6 +266,14 @@ Error RawCoverageMappingReader::read() {
   for (auto I : VirtualFileMapping) {
     Filenames.push_back(TranslationUnitFilenames[I]);
   }
+  NumFileIDs = VirtualFileMapping.size();
+  return Error::success();
+}
+
+Error RawCoverageMappingReader::read() {
+  if (!NumFileIDs)
+    if (auto Err = readFilenames())
+      return Err;
 
   // Read the expressions.
   uint64_t NumExpressions;
@@ -285,10 +293,10 @@ Error RawCoverageMappingReader::read() {
   }
 
   // Read the mapping regions sub-arrays.
-  for (unsigned InferredFileID = 0, S = VirtualFileMapping.size();
-       InferredFileID < S; ++InferredFileID) {
+  for (unsigned InferredFileID = 0, S = *NumFileIDs; InferredFileID < S;
+       ++InferredFileID) {
     if (auto Err = readMappingRegionsSubArray(MappingRegions, InferredFileID,
-                                              VirtualFileMapping.size()))
+                                              *NumFileIDs))
       return Err;
   }
 
@@ -298,8 +306,8 @@ Error RawCoverageMappingReader::read() {
   // Perform multiple passes to correctly propagate the counters through
   // all the nested expansion regions.
   SmallVector<CounterMappingRegion *, 8> FileIDExpansionRegionMapping;
-  FileIDExpansionRegionMapping.resize(VirtualFileMapping.size(), nullptr);
-  for (unsigned Pass = 1, S = VirtualFileMapping.size(); Pass < S; ++Pass) {
+  FileIDExpansionRegionMapping.resize(*NumFileIDs, nullptr);
+  for (unsigned Pass = 1, S = *NumFileIDs; Pass < S; ++Pass) {
     for (auto &R : MappingRegions) {
       if (R.Kind != CounterMappingRegion::ExpansionRegion)
         continue;
@@ -743,27 +751,56 @@ BinaryCoverageReader::create(std::unique_ptr<MemoryBuffer> &ObjectBuffer,
   return std::move(Reader);
 }
 
+void BinaryCoverageReader::setFileFilter(ArrayRef<StringRef> SourceFiles) {
+  FileFilter.clear();
+  for (StringRef SourceFile : SourceFiles)
+    FileFilter.insert(SourceFile);
+  LastFilteredTU = None;
+}
+
+bool BinaryCoverageReader::isInFileFilter(ArrayRef<StringRef> Files) const {
+  return FileFilter.empty() || llvm::any_of(Files, [&](StringRef File) {
+           return FileFilter.count(File);
+         });
+}
+
 Error BinaryCoverageReader::readNextRecord(CoverageMappingRecord &Record) {
-  if (CurrentRecord >= MappingRecords.size())
-    return make_error<CoverageMapError>(coveragemap_error::eof);
-
-  FunctionsFilenames.clear();
-  Expressions.clear();
-  MappingRegions.clear();
-  auto &R = MappingRecords[CurrentRecord];
-  RawCoverageMappingReader Reader(
-      R.CoverageMapping,
-      makeArrayRef(Filenames).slice(R.FilenamesBegin, R.FilenamesSize),
-      FunctionsFilenames, Expressions, MappingRegions);
-  if (auto Err = Reader.read())
-    return Err;
+  for (; CurrentRecord < MappingRecords.size(); ++CurrentRecord) {
+    FunctionsFilenames.clear();
+    Expressions.clear();
+    MappingRegions.clear();
+    auto &R = MappingRecords[CurrentRecord];
+    ArrayRef<StringRef> TUFilenames =
+        makeArrayRef(Filenames).slice(R.FilenamesBegin, R.FilenamesSize);
+    RawCoverageMappingReader Reader(R.CoverageMapping, TUFilenames,
+                                    FunctionsFilenames, Expressions,
+                                    MappingRegions);
+    if (!FileFilter.empty()) {
+      // The records of a translation unit share its files, so only check
+      // them once for all of its functions.
+      if (TUFilenames.data() != LastFilteredTU.data() ||
+          TUFilenames.size() != LastFilteredTU.size()) {
+        LastFilteredTU = TUFilenames;
+        LastFilteredTUMatches = isInFileFilter(TUFilenames);
+      }
+      if (!LastFilteredTUMatches)
+        continue;
+      if (auto Err = Reader.readFilenames())
+        return Err;
+      if (!isInFileFilter(FunctionsFilenames))
+        continue;
+    }
+    if (auto Err = Reader.read())
+      return Err;
 
-  Record.FunctionName = R.FunctionName;
-  Record.FunctionHash = R.FunctionHash;
-  Record.Filenames = FunctionsFilenames;
-  Record.Expressions = Expressions;
-  Record.MappingRegions = MappingRegions;
+    Record.FunctionName = R.FunctionName;
+    Record.FunctionHash = R.FunctionHash;
+    Record.Filenames = FunctionsFilenames;
+    Record.Expressions = Expressions;
+    Record.MappingRegions = MappingRegions;
 
-  ++CurrentRecord;
-  return Error::success();
+    ++CurrentRecord;
+    return Error::success();
+  }
+  return make_error<CoverageMapError>(coveragemap_error::eof);
 }
@@ -618,7 +618,11 @@ void InstrProfValueSiteRecord::merge(InstrProfValueSiteRecord &Input,
       ++I;
       continue;
     }
-    ValueData.insert(I, *J);
+    bool Overflowed;
+    uint64_t Count = SaturatingMultiply(J->Count, Weight, &Overflowed);
+    if (Overflowed)
+      Warn(instrprof_error::counter_overflow);
+    ValueData.insert(I, {J->Value, Count});
   }
 }
 
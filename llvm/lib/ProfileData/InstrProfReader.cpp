@@ -38,9 +38,9 @@
 using namespace llvm;
 
 static Expected<std::unique_ptr<MemoryBuffer>>
-setupMemoryBuffer(const Twine &Path) {
+setupMemoryBuffer(const Twine &Path, bool RequiresNullTerminator = true) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
-      MemoryBuffer::getFileOrSTDIN(Path);
+      MemoryBuffer::getFileOrSTDIN(Path, -1, RequiresNullTerminator);
   if (std::error_code EC = BufferOrErr.getError())
     return errorCodeToError(EC);
   return std::move(BufferOrErr.get());
@@ -90,8 +90,13 @@ InstrProfReader::create(std::unique_ptr<MemoryBuffer> Buffer) {
 
 Expected<std::unique_ptr<IndexedInstrProfReader>>
 IndexedInstrProfReader::create(const Twine &Path, const Twine &RemappingPath) {
-  // Set up the buffer to read.
-  auto BufferOrError = setupMemoryBuffer(Path);
+  // Set up the buffer to read. The indexed format doesn't need a null
+  // terminator, and asking for one makes MemoryBuffer read the whole file
+  // rather than map it when its size is a multiple of the page size. Mapped,
+  // only the pages a compile looks up are read, and they are shared with the
+  // other compiles using the same profile.
+  auto BufferOrError =
+      setupMemoryBuffer(Path, /*RequiresNullTerminator=*/false);
   if (Error E = BufferOrError.takeError())
     return std::move(E);
 
@@ -862,8 +867,12 @@ Expected<InstrProfRecord>
 IndexedInstrProfReader::getInstrProfRecord(StringRef FuncName,
                                            uint64_t FuncHash) {
   ArrayRef<NamedInstrProfRecord> Data;
-  Error Err = Remapper->getRecords(FuncName, Data);
-  if (Err)
+  auto Preloaded = PreloadedRecords.find(FuncName);
+  if (Preloaded != PreloadedRecords.end()) {
+    if (Preloaded->second.empty())
+      return error(instrprof_error::unknown_function);
+    Data = Preloaded->second;
+  } else if (Error Err = Remapper->getRecords(FuncName, Data))
     return std::move(Err);
   // Found it. Look for counters with the right hash.
   for (unsigned I = 0, E = Data.size(); I < E; ++I) {
@@ -875,6 +884,31 @@ IndexedInstrProfReader::getInstrProfRecord(StringRef FuncName,
   return error(instrprof_error::hash_mismatch);
 }
 
+Error IndexedInstrProfReader::preloadRecords(ArrayRef<StringRef> FuncNames) {
+  for (StringRef FuncName : FuncNames) {
+    auto Inserted = PreloadedRecords.insert(
+        std::make_pair(FuncName, std::vector<NamedInstrProfRecord>()));
+    if (!Inserted.second)
+      continue;
+    ArrayRef<NamedInstrProfRecord> Data;
+    if (Error E = Remapper->getRecords(FuncName, Data)) {
+      // Remember that the function isn't in the profile, so that looking it up
+      // again doesn't go back to the profile either.
+      if (Error Unhandled = handleErrors(
+              std::move(E), [](std::unique_ptr<InstrProfError> Err) {
+                return Err->get() == instrprof_error::unknown_function
+                           ? Error::success()
+                           : Error(std::move(Err));
+              }))
+        return Unhandled;
+      continue;
+    }
+    // The records are in a buffer the next lookup reuses, so keep a copy.
+    Inserted.first->second.assign(Data.begin(), Data.end());
+  }
+  return Error::success();
+}
+
 Error IndexedInstrProfReader::getFunctionCounts(StringRef FuncName,
                                                 uint64_t FuncHash,
                                                 std::vector<uint64_t> &Counts) {
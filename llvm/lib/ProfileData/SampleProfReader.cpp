@@ -7,7 +7,8 @@
 //===----------------------------------------------------------------------===//
 //
 // This file implements the class that reads LLVM sample profiles. It
-// supports three file formats: text, binary and gcov.
+// supports three file formats: text, binary and gcov. The binary encoding
+// also comes in a compact and an extensible, sectioned flavor.
 //
 // The textual representation is useful for debugging and testing purposes. The
 // binary representation is more compact, resulting in smaller file sizes.
@@ -26,6 +27,8 @@
 #include "llvm/IR/ProfileSummary.h"
 #include "llvm/ProfileData/ProfileCommon.h"
 #include "llvm/ProfileData/SampleProf.h"
+#include "llvm/Support/Compression.h"
+#include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/LineIterator.h"
@@ -483,6 +486,27 @@ std::error_code SampleProfileReaderCompactBinary::read() {
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileReaderExtBinary::read() {
+  if (UseFuncsToUse && !FuncOffsetTable.empty()) {
+    for (auto Name : FuncsToUse) {
+      auto Iter = FuncOffsetTable.find(Name);
+      if (Iter == FuncOffsetTable.end())
+        continue;
+      if (Iter->second >= uint64_t(ProfileEnd - ProfileStart))
+        return sampleprof_error::malformed;
+      Data = ProfileStart + Iter->second;
+      End = ProfileEnd;
+      if (std::error_code EC = readFuncProfile())
+        return EC;
+    }
+    return sampleprof_error::success;
+  }
+
+  Data = ProfileStart;
+  End = ProfileEnd;
+  return SampleProfileReaderBinary::read();
+}
+
 std::error_code SampleProfileReaderRawBinary::verifySPMagic(uint64_t Magic) {
   if (Magic == SPMagic())
     return sampleprof_error::success;
@@ -511,6 +535,13 @@ std::error_code SampleProfileReaderRawBinary::readNameTable() {
   return sampleprof_error::success;
 }
 
+std::error_code
+SampleProfileReaderExtBinary::verifySPMagic(uint64_t Magic) {
+  if (Magic == SPMagic(SPF_Ext_Binary))
+    return sampleprof_error::success;
+  return sampleprof_error::bad_magic;
+}
+
 std::error_code SampleProfileReaderCompactBinary::readNameTable() {
   auto Size = readNumber<uint64_t>();
   if (std::error_code EC = Size.getError())
@@ -590,6 +621,164 @@ std::error_code SampleProfileReaderCompactBinary::readFuncOffsetTable() {
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileReaderExtBinary::readHeader() {
+  Data = reinterpret_cast<const uint8_t *>(Buffer->getBufferStart());
+  End = Data + Buffer->getBufferSize();
+
+  // Read and check the magic identifier.
+  auto Magic = readNumber<uint64_t>();
+  if (std::error_code EC = Magic.getError())
+    return EC;
+  else if (std::error_code EC = verifySPMagic(*Magic))
+    return EC;
+
+  // Read the version number.
+  auto Version = readNumber<uint64_t>();
+  if (std::error_code EC = Version.getError())
+    return EC;
+  else if (*Version != SPVersion())
+    return sampleprof_error::unsupported_version;
+
+  if (std::error_code EC = readSecHdrTable())
+    return EC;
+
+  for (const auto &Entry : SecHdrTable) {
+    if (std::error_code EC = readOneSection(Entry))
+      return EC;
+  }
+
+  // A profile without a summary section is not usable by the compiler.
+  if (!Summary)
+    return sampleprof_error::malformed;
+  return sampleprof_error::success;
+}
+
+std::error_code SampleProfileReaderExtBinary::readSecHdrTable() {
+  auto NumEntries = readUnencodedNumber<uint64_t>();
+  if (std::error_code EC = NumEntries.getError())
+    return EC;
+
+  for (uint64_t I = 0; I < *NumEntries; ++I) {
+    auto Type = readUnencodedNumber<uint64_t>();
+    if (std::error_code EC = Type.getError())
+      return EC;
+    auto Flags = readUnencodedNumber<uint64_t>();
+    if (std::error_code EC = Flags.getError())
+      return EC;
+    auto Offset = readUnencodedNumber<uint64_t>();
+    if (std::error_code EC = Offset.getError())
+      return EC;
+    auto Size = readUnencodedNumber<uint64_t>();
+    if (std::error_code EC = Size.getError())
+      return EC;
+
+    if (*Offset > Buffer->getBufferSize() ||
+        *Size > Buffer->getBufferSize() - *Offset)
+      return sampleprof_error::truncated;
+    SecHdrTable.push_back(
+        {static_cast<SecType>(*Type), *Flags, *Offset, *Size});
+  }
+  return sampleprof_error::success;
+}
+
+std::error_code SampleProfileReaderExtBinary::decompressSection(
+    const uint8_t *SecStart, uint64_t SecSize, const uint8_t *&DecompressBuf,
+    uint64_t &DecompressBufSize) {
+  Data = SecStart;
+  End = SecStart + SecSize;
+  auto DecompressSize = readNumber<uint64_t>();
+  if (std::error_code EC = DecompressSize.getError())
+    return EC;
+  DecompressBufSize = *DecompressSize;
+
+  auto CompressSize = readNumber<uint64_t>();
+  if (std::error_code EC = CompressSize.getError())
+    return EC;
+  if (*CompressSize > uint64_t(End - Data))
+    return sampleprof_error::truncated;
+
+  if (!zlib::isAvailable())
+    return sampleprof_error::zlib_unavailable;
+
+  StringRef CompressedStrings(reinterpret_cast<const char *>(Data),
+                              *CompressSize);
+  char *Buf = DecompressBufAllocator.Allocate<char>(DecompressBufSize);
+  size_t UCSize = DecompressBufSize;
+  if (Error E = zlib::uncompress(CompressedStrings, Buf, UCSize)) {
+    consumeError(std::move(E));
+    return sampleprof_error::uncompress_failed;
+  }
+  if (UCSize != DecompressBufSize)
+    return sampleprof_error::uncompress_failed;
+  DecompressBuf = reinterpret_cast<const uint8_t *>(Buf);
+  return sampleprof_error::success;
+}
+
+std::error_code
+SampleProfileReaderExtBinary::readOneSection(const SecHdrTableEntry &Entry) {
+  const uint8_t *SecStart =
+      reinterpret_cast<const uint8_t *>(Buffer->getBufferStart()) +
+      Entry.Offset;
+  uint64_t SecSize = Entry.Size;
+  if (Entry.Flags & SecFlagCompress) {
+    const uint8_t *DecompressBuf;
+    uint64_t DecompressBufSize;
+    if (std::error_code EC = decompressSection(SecStart, SecSize, DecompressBuf,
+                                               DecompressBufSize))
+      return EC;
+    SecStart = DecompressBuf;
+    SecSize = DecompressBufSize;
+  }
+  Data = SecStart;
+  End = SecStart + SecSize;
+
+  switch (Entry.Type) {
+  case SecProfSummary:
+    return readSummary();
+  case SecNameTable:
+    return readNameTable();
+  case SecLBRProfile:
+    // The function profiles are decoded on demand in read().
+    ProfileStart = SecStart;
+    ProfileEnd = SecStart + SecSize;
+    return sampleprof_error::success;
+  case SecFuncOffsetTable:
+    return readFuncOffsetTable();
+  default:
+    // Skip sections written by a newer producer.
+    return sampleprof_error::success;
+  }
+}
+
+std::error_code SampleProfileReaderExtBinary::readFuncOffsetTable() {
+  auto Size = readNumber<uint64_t>();
+  if (std::error_code EC = Size.getError())
+    return EC;
+
+  FuncOffsetTable.reserve(*Size);
+  for (uint64_t I = 0; I < *Size; ++I) {
+    auto FName(readStringFromTable());
+    if (std::error_code EC = FName.getError())
+      return EC;
+
+    auto Offset = readNumber<uint64_t>();
+    if (std::error_code EC = Offset.getError())
+      return EC;
+
+    FuncOffsetTable[*FName] = *Offset;
+  }
+  return sampleprof_error::success;
+}
+
+void SampleProfileReaderExtBinary::collectFuncsToUse(const Module &M) {
+  UseFuncsToUse = true;
+  FuncsToUse.clear();
+  for (auto &F : M) {
+    StringRef CanonName = FunctionSamples::getCanonicalFnName(F);
+    FuncsToUse.insert(CanonName);
+  }
+}
+
 void SampleProfileReaderCompactBinary::collectFuncsToUse(const Module &M) {
   FuncsToUse.clear();
   for (auto &F : M) {
@@ -661,6 +850,13 @@ bool SampleProfileReaderRawBinary::hasFormat(const MemoryBuffer &Buffer) {
   return Magic == SPMagic();
 }
 
+bool SampleProfileReaderExtBinary::hasFormat(const MemoryBuffer &Buffer) {
+  const uint8_t *Data =
+      reinterpret_cast<const uint8_t *>(Buffer.getBufferStart());
+  uint64_t Magic = decodeULEB128(Data);
+  return Magic == SPMagic(SPF_Ext_Binary);
+}
+
 bool SampleProfileReaderCompactBinary::hasFormat(const MemoryBuffer &Buffer) {
   const uint8_t *Data =
       reinterpret_cast<const uint8_t *>(Buffer.getBufferStart());
@@ -1010,6 +1206,8 @@ SampleProfileReader::create(std::unique_ptr<MemoryBuffer> &B, LLVMContext &C) {
   std::unique_ptr<SampleProfileReader> Reader;
   if (SampleProfileReaderRawBinary::hasFormat(*B))
     Reader.reset(new SampleProfileReaderRawBinary(std::move(B), C));
+  else if (SampleProfileReaderExtBinary::hasFormat(*B))
+    Reader.reset(new SampleProfileReaderExtBinary(std::move(B), C));
   else if (SampleProfileReaderCompactBinary::hasFormat(*B))
     Reader.reset(new SampleProfileReaderCompactBinary(std::move(B), C));
   else if (SampleProfileReaderGCC::hasFormat(*B))
@@ -18,11 +18,14 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ProfileData/SampleProfWriter.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ProfileData/ProfileCommon.h"
 #include "llvm/ProfileData/SampleProf.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/EndianStream.h"
+#include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/LEB128.h"
@@ -43,7 +46,11 @@ std::error_code
 SampleProfileWriter::write(const StringMap<FunctionSamples> &ProfileMap) {
   if (std::error_code EC = writeHeader(ProfileMap))
     return EC;
+  return writeFuncProfiles(ProfileMap);
+}
 
+std::error_code SampleProfileWriter::writeFuncProfiles(
+    const StringMap<FunctionSamples> &ProfileMap) {
   // Sort the ProfileMap by total samples.
   typedef std::pair<StringRef, const FunctionSamples *> NameFunctionSamples;
   std::vector<NameFunctionSamples> V;
@@ -64,6 +71,100 @@ SampleProfileWriter::write(const StringMap<FunctionSamples> &ProfileMap) {
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileWriterExtBinary::write(
+    const StringMap<FunctionSamples> &ProfileMap) {
+  if (std::error_code EC = writeHeader(ProfileMap))
+    return EC;
+
+  uint64_t SectionStart = markSectionStart(SecProfSummary);
+  if (std::error_code EC = writeSummary())
+    return EC;
+  if (std::error_code EC = addNewSection(SecProfSummary, SectionStart))
+    return EC;
+
+  SectionStart = markSectionStart(SecNameTable);
+  if (std::error_code EC = writeNameTable())
+    return EC;
+  if (std::error_code EC = addNewSection(SecNameTable, SectionStart))
+    return EC;
+
+  SectionStart = markSectionStart(SecLBRProfile);
+  LBRProfileStart = OutputStream->tell();
+  if (std::error_code EC = writeFuncProfiles(ProfileMap))
+    return EC;
+  if (std::error_code EC = addNewSection(SecLBRProfile, SectionStart))
+    return EC;
+
+  SectionStart = markSectionStart(SecFuncOffsetTable);
+  if (std::error_code EC = writeFuncOffsetTable())
+    return EC;
+  if (std::error_code EC = addNewSection(SecFuncOffsetTable, SectionStart))
+    return EC;
+
+  return writeSecHdrTable();
+}
+
+SecHdrTableEntry &SampleProfileWriterExtBinary::getEntryInLayout(SecType Type) {
+  auto It = llvm::find_if(SectionLayout, [Type](const SecHdrTableEntry &E) {
+    return E.Type == Type;
+  });
+  assert(It != SectionLayout.end() && "Section is not in the layout");
+  return *It;
+}
+
+void SampleProfileWriterExtBinary::setToCompressAllSections() {
+  for (auto &Entry : SectionLayout)
+    Entry.Flags |= SecFlagCompress;
+}
+
+void SampleProfileWriterExtBinary::setToCompressSection(SecType Type) {
+  getEntryInLayout(Type).Flags |= SecFlagCompress;
+}
+
+/// Return the position where section \p Type starts in the profile, and
+/// divert the output to LocalBufStream if the section is to be compressed.
+uint64_t SampleProfileWriterExtBinary::markSectionStart(SecType Type) {
+  uint64_t SectionStart = OutputStream->tell();
+  if (getEntryInLayout(Type).Flags & SecFlagCompress)
+    LocalBufStream.swap(OutputStream);
+  return SectionStart;
+}
+
+std::error_code SampleProfileWriterExtBinary::compressAndOutput() {
+  if (!zlib::isAvailable())
+    return sampleprof_error::zlib_unavailable;
+  std::string &UncompressedStrings =
+      static_cast<raw_string_ostream *>(LocalBufStream.get())->str();
+  auto &OS = *OutputStream;
+  SmallString<128> CompressedStrings;
+  if (Error E = zlib::compress(UncompressedStrings, CompressedStrings,
+                               zlib::BestSizeCompression)) {
+    consumeError(std::move(E));
+    return sampleprof_error::compress_failed;
+  }
+  encodeULEB128(UncompressedStrings.size(), OS);
+  encodeULEB128(CompressedStrings.size(), OS);
+  OS << CompressedStrings.str();
+  UncompressedStrings.clear();
+  return sampleprof_error::success;
+}
+
+/// Record section \p Type, which started at \p SectionStart, in the section
+/// header table, compressing it first if needed.
+std::error_code
+SampleProfileWriterExtBinary::addNewSection(SecType Type,
+                                            uint64_t SectionStart) {
+  const SecHdrTableEntry &Entry = getEntryInLayout(Type);
+  if (Entry.Flags & SecFlagCompress) {
+    LocalBufStream.swap(OutputStream);
+    if (std::error_code EC = compressAndOutput())
+      return EC;
+  }
+  SecHdrTable.push_back({Type, Entry.Flags, SectionStart - FileStart,
+                         OutputStream->tell() - SectionStart});
+  return sampleprof_error::success;
+}
+
 std::error_code SampleProfileWriterCompactBinary::write(
     const StringMap<FunctionSamples> &ProfileMap) {
   if (std::error_code EC = SampleProfileWriter::write(ProfileMap))
@@ -201,6 +302,41 @@ std::error_code SampleProfileWriterCompactBinary::writeFuncOffsetTable() {
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileWriterExtBinary::writeFuncOffsetTable() {
+  auto &OS = *OutputStream;
+
+  // Write out the table size.
+  encodeULEB128(FuncOffsetTable.size(), OS);
+
+  // Write out FuncOffsetTable.
+  for (auto Entry : FuncOffsetTable) {
+    if (std::error_code EC = writeNameIdx(Entry.first))
+      return EC;
+    encodeULEB128(Entry.second, OS);
+  }
+  return sampleprof_error::success;
+}
+
+std::error_code SampleProfileWriterExtBinary::writeSecHdrTable() {
+  auto &OS = *OutputStream;
+
+  // Fill the slot reserved by writeHeader with the section header table.
+  auto &OFS = static_cast<raw_fd_ostream &>(OS);
+  uint64_t End = OS.tell();
+  if (OFS.seek(SecHdrTableOffset) == (uint64_t)-1)
+    return sampleprof_error::ostream_seek_unsupported;
+  support::endian::Writer Writer(OS, support::little);
+  for (const auto &Entry : SecHdrTable) {
+    Writer.write(static_cast<uint64_t>(Entry.Type));
+    Writer.write(Entry.Flags);
+    Writer.write(Entry.Offset);
+    Writer.write(Entry.Size);
+  }
+  if (OFS.seek(End) == (uint64_t)-1)
+    return sampleprof_error::ostream_seek_unsupported;
+  return sampleprof_error::success;
+}
+
 std::error_code SampleProfileWriterCompactBinary::writeNameTable() {
   auto &OS = *OutputStream;
   std::set<StringRef> V;
@@ -222,6 +358,14 @@ std::error_code SampleProfileWriterRawBinary::writeMagicIdent() {
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileWriterExtBinary::writeMagicIdent() {
+  auto &OS = *OutputStream;
+  // Write file magic identifier.
+  encodeULEB128(SPMagic(SPF_Ext_Binary), OS);
+  encodeULEB128(SPVersion(), OS);
+  return sampleprof_error::success;
+}
+
 std::error_code SampleProfileWriterCompactBinary::writeMagicIdent() {
   auto &OS = *OutputStream;
   // Write file magic identifier.
@@ -248,6 +392,29 @@ std::error_code SampleProfileWriterBinary::writeHeader(
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileWriterExtBinary::writeHeader(
+    const StringMap<FunctionSamples> &ProfileMap) {
+  FileStart = OutputStream->tell();
+  writeMagicIdent();
+
+  computeSummary(ProfileMap);
+
+  // Generate the name table for all the functions referenced in the profile.
+  for (const auto &I : ProfileMap) {
+    addName(I.first());
+    addNames(I.second);
+  }
+
+  // Reserve the section header table. It is filled in by writeSecHdrTable
+  // once the sections are written.
+  support::endian::Writer Writer(*OutputStream, support::little);
+  Writer.write(static_cast<uint64_t>(SectionLayout.size()));
+  SecHdrTableOffset = OutputStream->tell();
+  for (unsigned I = 0; I < SectionLayout.size() * 4; ++I)
+    Writer.write(static_cast<uint64_t>(0));
+  return sampleprof_error::success;
+}
+
 std::error_code SampleProfileWriterCompactBinary::writeHeader(
     const StringMap<FunctionSamples> &ProfileMap) {
   support::endian::Writer Writer(*OutputStream, support::little);
@@ -329,6 +496,12 @@ std::error_code SampleProfileWriterBinary::write(const FunctionSamples &S) {
   return writeBody(S);
 }
 
+std::error_code
+SampleProfileWriterExtBinary::write(const FunctionSamples &S) {
+  FuncOffsetTable[S.getName()] = OutputStream->tell() - LBRProfileStart;
+  return SampleProfileWriterBinary::write(S);
+}
+
 std::error_code
 SampleProfileWriterCompactBinary::write(const FunctionSamples &S) {
   uint64_t Offset = OutputStream->tell();
@@ -349,7 +522,8 @@ ErrorOr<std::unique_ptr<SampleProfileWriter>>
 SampleProfileWriter::create(StringRef Filename, SampleProfileFormat Format) {
   std::error_code EC;
   std::unique_ptr<raw_ostream> OS;
-  if (Format == SPF_Binary || Format == SPF_Compact_Binary)
+  if (Format == SPF_Binary || Format == SPF_Compact_Binary ||
+      Format == SPF_Ext_Binary)
     OS.reset(new raw_fd_ostream(Filename, EC, sys::fs::F_None));
   else
     OS.reset(new raw_fd_ostream(Filename, EC, sys::fs::F_Text));
@@ -376,6 +550,8 @@ SampleProfileWriter::create(std::unique_ptr<raw_ostream> &OS,
     Writer.reset(new SampleProfileWriterRawBinary(OS));
   else if (Format == SPF_Compact_Binary)
     Writer.reset(new SampleProfileWriterCompactBinary(OS));
+  else if (Format == SPF_Ext_Binary)
+    Writer.reset(new SampleProfileWriterExtBinary(OS));
   else if (Format == SPF_Text)
     Writer.reset(new SampleProfileWriterText(OS));
   else if (Format == SPF_GCC)
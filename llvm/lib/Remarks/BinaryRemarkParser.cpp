@@ -0,0 +1,174 @@
+//===- BinaryRemarkParser.cpp ---------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides utility methods used by clients that want to use the
+// parser for binary remarks in LLVM.
+//
+//===----------------------------------------------------------------------===//
+
+#include "BinaryRemarkParser.h"
+#include "llvm/Remarks/RemarkFormat.h"
+#include "llvm/Remarks/RemarkSerializer.h"
+#include "llvm/Support/LEB128.h"
+
+using namespace llvm;
+using namespace llvm::remarks;
+
+Error BinaryParserImpl::error(const Twine &Message) {
+  // Stop parsing, in case the user calls getNext again.
+  Offset = Buf.size();
+  return createStringError(
+      std::make_error_code(std::errc::illegal_byte_sequence), "%s",
+      Message.str().c_str());
+}
+
+Error BinaryParserImpl::parseULEB128(uint64_t &Result) {
+  const uint8_t *Begin = Buf.bytes_begin() + Offset;
+  unsigned Size = 0;
+  const char *ErrMsg = nullptr;
+  Result = decodeULEB128(Begin, &Size, Buf.bytes_end(), &ErrMsg);
+  if (ErrMsg)
+    return error(Twine("malformed binary remarks: ") + ErrMsg);
+  Offset += Size;
+  return Error::success();
+}
+
+Error BinaryParserImpl::parseString(StringRef &Result) {
+  uint64_t ID;
+  if (Error E = parseULEB128(ID))
+    return E;
+  if (ID >= Strings.size())
+    return error("String with index " + Twine(ID) +
+                 " is out of bounds (size = " + Twine(Strings.size()) + ").");
+  Result = Strings[ID];
+  return Error::success();
+}
+
+Error BinaryParserImpl::parseLoc(RemarkLocation &Result) {
+  uint64_t Line, Column;
+  if (Error E = parseString(Result.SourceFilePath))
+    return E;
+  if (Error E = parseULEB128(Line))
+    return E;
+  if (Error E = parseULEB128(Column))
+    return E;
+  Result.SourceLine = Line;
+  Result.SourceColumn = Column;
+  return Error::success();
+}
+
+Error BinaryParserImpl::parseHeader() {
+  if (!Buf.startswith(BinaryMagic))
+    return error("malformed binary remarks: invalid magic number.");
+  Offset = BinaryMagic.size();
+
+  uint64_t Version;
+  if (Error E = parseULEB128(Version))
+    return E;
+  if (Version != BinaryVersion)
+    return error("unsupported binary remarks version " + Twine(Version) +
+                 " (expected " + Twine(BinaryVersion) + ").");
+
+  ParsedHeader = true;
+  return Error::success();
+}
+
+Error BinaryParserImpl::parseRemark() {
+  TheRemark = Remark();
+  TmpArgs.clear();
+
+  uint64_t RemarkType;
+  if (Error E = parseULEB128(RemarkType))
+    return E;
+  if (RemarkType > static_cast<uint64_t>(Type::LastTypeValue))
+    return error("unknown remark type " + Twine(RemarkType) + ".");
+  TheRemark.RemarkType = static_cast<Type>(RemarkType);
+
+  if (Error E = parseString(TheRemark.PassName))
+    return E;
+  if (Error E = parseString(TheRemark.RemarkName))
+    return E;
+  if (Error E = parseString(TheRemark.FunctionName))
+    return E;
+
+  uint64_t Flags;
+  if (Error E = parseULEB128(Flags))
+    return E;
+
+  if (Flags & BinarySerializer::RF_HasLoc) {
+    RemarkLocation Loc;
+    if (Error E = parseLoc(Loc))
+      return E;
+    TheRemark.Loc = Loc;
+  }
+
+  if (Flags & BinarySerializer::RF_HasHotness) {
+    uint64_t Hotness;
+    if (Error E = parseULEB128(Hotness))
+      return E;
+    TheRemark.Hotness = Hotness;
+  }
+
+  uint64_t NumArgs;
+  if (Error E = parseULEB128(NumArgs))
+    return E;
+  for (uint64_t I = 0; I != NumArgs; ++I) {
+    Argument Arg;
+    uint64_t HasLoc;
+    if (Error E = parseString(Arg.Key))
+      return E;
+    if (Error E = parseString(Arg.Val))
+      return E;
+    if (Error E = parseULEB128(HasLoc))
+      return E;
+    if (HasLoc) {
+      RemarkLocation Loc;
+      if (Error E = parseLoc(Loc))
+        return E;
+      Arg.Loc = Loc;
+    }
+    TmpArgs.push_back(Arg);
+  }
+  TheRemark.Args = TmpArgs;
+
+  return Error::success();
+}
+
+Expected<const Remark *> BinaryParserImpl::getNext() {
+  if (!ParsedHeader)
+    if (Error E = parseHeader())
+      return std::move(E);
+
+  while (Offset < Buf.size()) {
+    uint64_t Kind;
+    if (Error E = parseULEB128(Kind))
+      return std::move(E);
+
+    switch (Kind) {
+    case BinarySerializer::RK_String: {
+      uint64_t Size;
+      if (Error E = parseULEB128(Size))
+        return std::move(E);
+      if (Size > Buf.size() - Offset)
+        return error("malformed binary remarks: truncated string.");
+      Strings.push_back(Buf.substr(Offset, Size));
+      Offset += Size;
+      break;
+    }
+    case BinarySerializer::RK_Remark:
+      if (Error E = parseRemark())
+        return std::move(E);
+      return &TheRemark;
+    default:
+      return error("unknown binary remarks record kind " + Twine(Kind) + ".");
+    }
+  }
+
+  // We reached the end of the buffer.
+  return nullptr;
+}
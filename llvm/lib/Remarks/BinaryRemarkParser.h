@@ -0,0 +1,75 @@
+//===-- BinaryRemarkParser.h - Parser for binary remarks --------*- C++/-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides the impementation of the binary remark parser.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_REMARKS_BINARY_REMARK_PARSER_H
+#define LLVM_REMARKS_BINARY_REMARK_PARSER_H
+
+#include "RemarkParserImpl.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Remarks/Remark.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+#include <string>
+#include <vector>
+
+namespace llvm {
+namespace remarks {
+
+/// Parses remarks in the format emitted by BinarySerializer, one record at a
+/// time. All the strings of the parsed remarks point into the buffer.
+struct BinaryParserImpl : public ParserImpl {
+  /// The buffer being parsed.
+  StringRef Buf;
+  /// The position of the next record in the buffer.
+  size_t Offset = 0;
+  /// Set to `true` once the header was parsed successfully.
+  bool ParsedHeader = false;
+  /// The strings defined so far, indexed by their ID.
+  std::vector<StringRef> Strings;
+  /// Temporary parsing buffer for the arguments. Invalidated with every call
+  /// to `getNext`.
+  SmallVector<Argument, 8> TmpArgs;
+  /// The latest parsed remark.
+  Remark TheRemark;
+  /// Set to `true` if we had any errors during parsing.
+  bool HasErrors = false;
+  /// Storage for the error stream.
+  std::string ErrorString;
+  /// The error stream.
+  raw_string_ostream ErrorStream;
+
+  BinaryParserImpl(StringRef Buf)
+      : ParserImpl{ParserImpl::Kind::Binary}, Buf(Buf),
+        ErrorStream(ErrorString) {}
+
+  /// Parse up to the next remark record. Returns nullptr at the end of the
+  /// buffer.
+  Expected<const Remark *> getNext();
+
+  static bool classof(const ParserImpl *PI) {
+    return PI->ParserKind == ParserImpl::Kind::Binary;
+  }
+
+private:
+  Error parseHeader();
+  Error parseRemark();
+  Error parseULEB128(uint64_t &Result);
+  Error parseString(StringRef &Result);
+  Error parseLoc(RemarkLocation &Result);
+  Error error(const Twine &Message);
+};
+
+} // end namespace remarks
+} // end namespace llvm
+
+#endif /* LLVM_REMARKS_BINARY_REMARK_PARSER_H */
@@ -0,0 +1,95 @@
+//===- BinaryRemarkSerializer.cpp -----------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides the implementation of the binary remark serializer.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Remarks/RemarkSerializer.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Remarks/RemarkFormat.h"
+#include "llvm/Support/LEB128.h"
+#include <tuple>
+
+using namespace llvm;
+using namespace llvm::remarks;
+
+BinarySerializer::BinarySerializer(raw_ostream &OS) : Serializer(OS) {
+  OS << BinaryMagic;
+  encodeULEB128(BinaryVersion, OS);
+}
+
+uint64_t BinarySerializer::getStringID(StringRef Str) {
+  size_t NumStrings = StrTab.StrTab.size();
+  unsigned ID = StrTab.add(Str).first;
+  // If it's a new string, define it before it gets used.
+  if (StrTab.StrTab.size() != NumStrings) {
+    encodeULEB128(RK_String, OS);
+    encodeULEB128(Str.size(), OS);
+    OS << Str;
+  }
+  return ID;
+}
+
+void BinarySerializer::emitLoc(uint64_t FileID, const RemarkLocation &Loc) {
+  encodeULEB128(FileID, OS);
+  encodeULEB128(Loc.SourceLine, OS);
+  encodeULEB128(Loc.SourceColumn, OS);
+}
+
+void BinarySerializer::emit(const Remark &Remark) {
+  // Look up (and define, if needed) all the strings of the remark first: the
+  // string records can't be nested in the remark record.
+  uint64_t PassID = getStringID(Remark.PassName);
+  uint64_t NameID = getStringID(Remark.RemarkName);
+  uint64_t FunctionID = getStringID(Remark.FunctionName);
+  uint64_t FileID = Remark.Loc ? getStringID(Remark.Loc->SourceFilePath) : 0;
+
+  // (Key, Value, File) IDs for each argument.
+  SmallVector<std::tuple<uint64_t, uint64_t, uint64_t>, 8> ArgIDs;
+  for (const Argument &Arg : Remark.Args) {
+    uint64_t KeyID = getStringID(Arg.Key);
+    uint64_t ValID = getStringID(Arg.Val);
+    uint64_t ArgFileID = Arg.Loc ? getStringID(Arg.Loc->SourceFilePath) : 0;
+    ArgIDs.emplace_back(KeyID, ValID, ArgFileID);
+  }
+
+  // Layout of a remark record:
+  //   kind, type, pass, name, function, flags,
+  //   [file, line, column]   if RF_HasLoc,
+  //   [hotness]              if RF_HasHotness,
+  //   number of arguments, then for each argument:
+  //     key, value, has location, [file, line, column]
+  encodeULEB128(RK_Remark, OS);
+  encodeULEB128(static_cast<uint64_t>(Remark.RemarkType), OS);
+  encodeULEB128(PassID, OS);
+  encodeULEB128(NameID, OS);
+  encodeULEB128(FunctionID, OS);
+
+  uint8_t Flags = 0;
+  if (Remark.Loc)
+    Flags |= RF_HasLoc;
+  if (Remark.Hotness)
+    Flags |= RF_HasHotness;
+  encodeULEB128(Flags, OS);
+
+  if (Remark.Loc)
+    emitLoc(FileID, *Remark.Loc);
+  if (Remark.Hotness)
+    encodeULEB128(*Remark.Hotness, OS);
+
+  encodeULEB128(Remark.Args.size(), OS);
+  for (size_t I = 0, E = Remark.Args.size(); I != E; ++I) {
+    const Argument &Arg = Remark.Args[I];
+    encodeULEB128(std::get<0>(ArgIDs[I]), OS);
+    encodeULEB128(std::get<1>(ArgIDs[I]), OS);
+    encodeULEB128(Arg.Loc.hasValue(), OS);
+    if (Arg.Loc)
+      emitLoc(std::get<2>(ArgIDs[I]), *Arg.Loc);
+  }
+}
@@ -12,15 +12,34 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Remarks/RemarkParser.h"
+#include "BinaryRemarkParser.h"
 #include "YAMLRemarkParser.h"
 #include "llvm-c/Remarks.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Remarks/RemarkFormat.h"
 #include "llvm/Support/CBindingWrapping.h"
 
 using namespace llvm;
 using namespace llvm::remarks;
 
-Parser::Parser(StringRef Buf) : Impl(llvm::make_unique<YAMLParserImpl>(Buf)) {}
+static std::unique_ptr<ParserImpl> createParserImpl(Format ParserFormat,
+                                                    StringRef Buf) {
+  switch (ParserFormat) {
+  case Format::YAML:
+    return llvm::make_unique<YAMLParserImpl>(Buf);
+  case Format::Binary:
+    return llvm::make_unique<BinaryParserImpl>(Buf);
+  case Format::Unknown:
+    break;
+  }
+  llvm_unreachable("Unknown remark parser format.");
+}
+
+Parser::Parser(StringRef Buf)
+    : Impl(createParserImpl(detectFormat(Buf), Buf)) {}
+
+Parser::Parser(Format ParserFormat, StringRef Buf)
+    : Impl(createParserImpl(ParserFormat, Buf)) {}
 
 Parser::Parser(StringRef Buf, StringRef StrTabBuf)
     : Impl(llvm::make_unique<YAMLParserImpl>(Buf, StrTabBuf)) {}
@@ -56,6 +75,8 @@ static Expected<const Remark *> getNextYAML(YAMLParserImpl &Impl) {
 Expected<const Remark *> Parser::getNext() const {
   if (auto *Impl = dyn_cast<YAMLParserImpl>(this->Impl.get()))
     return getNextYAML(*Impl);
+  if (auto *Impl = dyn_cast<BinaryParserImpl>(this->Impl.get()))
+    return Impl->getNext();
   llvm_unreachable("Get next called with an unknown parsing implementation.");
 }
 
@@ -89,8 +110,15 @@ DEFINE_SIMPLE_CONVERSION_FUNCTIONS(remarks::Parser, LLVMRemarkParserRef)
 
 extern "C" LLVMRemarkParserRef LLVMRemarkParserCreateYAML(const void *Buf,
                                                           uint64_t Size) {
-  return wrap(
-      new remarks::Parser(StringRef(static_cast<const char *>(Buf), Size)));
+  return wrap(new remarks::Parser(
+      remarks::Format::YAML, StringRef(static_cast<const char *>(Buf), Size)));
+}
+
+extern "C" LLVMRemarkParserRef LLVMRemarkParserCreateBinary(const void *Buf,
+                                                            uint64_t Size) {
+  return wrap(new remarks::Parser(
+      remarks::Format::Binary,
+      StringRef(static_cast<const char *>(Buf), Size)));
 }
 
 static void handleYAMLError(remarks::YAMLParserImpl &Impl, Error E) {
@@ -113,7 +141,11 @@ LLVMRemarkParserGetNext(LLVMRemarkParserRef Parser) {
     // Error during parsing.
     if (auto *Impl = dyn_cast<remarks::YAMLParserImpl>(TheParser.Impl.get()))
       handleYAMLError(*Impl, RemarkOrErr.takeError());
-    else
+    else if (auto *Impl =
+                 dyn_cast<remarks::BinaryParserImpl>(TheParser.Impl.get())) {
+      logAllUnhandledErrors(RemarkOrErr.takeError(), Impl->ErrorStream);
+      Impl->HasErrors = true;
+    } else
       llvm_unreachable("unkown parser implementation.");
     return nullptr;
   }
@@ -128,6 +160,9 @@ extern "C" LLVMBool LLVMRemarkParserHasError(LLVMRemarkParserRef Parser) {
   if (auto *Impl =
           dyn_cast<remarks::YAMLParserImpl>(unwrap(Parser)->Impl.get()))
     return Impl->HasErrors;
+  if (auto *Impl =
+          dyn_cast<remarks::BinaryParserImpl>(unwrap(Parser)->Impl.get()))
+    return Impl->HasErrors;
   llvm_unreachable("unkown parser implementation.");
 }
 
@@ -136,6 +171,9 @@ LLVMRemarkParserGetErrorMessage(LLVMRemarkParserRef Parser) {
   if (auto *Impl =
           dyn_cast<remarks::YAMLParserImpl>(unwrap(Parser)->Impl.get()))
     return Impl->YAMLParser.ErrorStream.str().c_str();
+  if (auto *Impl =
+          dyn_cast<remarks::BinaryParserImpl>(unwrap(Parser)->Impl.get()))
+    return Impl->ErrorStream.str().c_str();
   llvm_unreachable("unkown parser implementation.");
 }
 
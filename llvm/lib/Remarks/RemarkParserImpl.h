@@ -17,7 +17,7 @@ namespace llvm {
 namespace remarks {
 /// This is used as a base for any parser implementation.
 struct ParserImpl {
-  enum class Kind { YAML };
+  enum class Kind { YAML, Binary };
 
   explicit ParserImpl(Kind TheParserKind) : ParserKind(TheParserKind) {}
   // Virtual destructor prevents mismatched deletes
@@ -13,6 +13,7 @@
 #include "llvm/Support/Compression.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
 #include "llvm/Config/config.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Error.h"
@@ -20,13 +21,25 @@
 #if LLVM_ENABLE_ZLIB == 1 && HAVE_ZLIB_H
 #include <zlib.h>
 #endif
+#if LLVM_ENABLE_ZSTD == 1
+#include <zstd.h>
+#endif
+#if LLVM_ENABLE_LZ4 == 1
+#include <climits>
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
 
 using namespace llvm;
 
-#if LLVM_ENABLE_ZLIB == 1 && HAVE_LIBZ
-static Error createError(StringRef Err) {
+#if (LLVM_ENABLE_ZLIB == 1 && HAVE_LIBZ) || LLVM_ENABLE_ZSTD == 1 ||          \
+    LLVM_ENABLE_LZ4 == 1
+static Error createError(const Twine &Err) {
   return make_error<StringError>(Err, inconvertibleErrorCode());
 }
+#endif
+
+#if LLVM_ENABLE_ZLIB == 1 && HAVE_LIBZ
 
 static StringRef convertZlibCodeToString(int Code) {
   switch (Code) {
@@ -60,6 +73,44 @@ Error zlib::compress(StringRef InputBuffer,
   return Res ? createError(convertZlibCodeToString(Res)) : Error::success();
 }
 
+Error zlib::compressShard(StringRef InputBuffer,
+                          SmallVectorImpl<char> &CompressedBuffer, bool IsLast,
+                          int Level) {
+  z_stream Stream = {};
+  // A negative window size tells zlib to emit raw deflate data.
+  int Res = ::deflateInit2(&Stream, Level, Z_DEFLATED, -MAX_WBITS, 8,
+                           Z_DEFAULT_STRATEGY);
+  if (Res != Z_OK)
+    return createError(convertZlibCodeToString(Res));
+
+  Stream.next_in = (Bytef *)InputBuffer.data();
+  Stream.avail_in = InputBuffer.size();
+
+  // deflateBound() doesn't count the empty block emitted by Z_SYNC_FLUSH, so
+  // leave room for it. We grow the buffer if that's still not enough.
+  size_t Pos = CompressedBuffer.size();
+  CompressedBuffer.resize(Pos + ::deflateBound(&Stream, InputBuffer.size()) +
+                          8);
+  int Flush = IsLast ? Z_FINISH : Z_SYNC_FLUSH;
+  for (;;) {
+    Stream.next_out = (Bytef *)CompressedBuffer.data() + Pos;
+    Stream.avail_out = CompressedBuffer.size() - Pos;
+    Res = ::deflate(&Stream, Flush);
+    Pos = (char *)Stream.next_out - CompressedBuffer.data();
+    if (Res == Z_STREAM_ERROR || Stream.avail_out != 0)
+      break;
+    CompressedBuffer.resize(CompressedBuffer.size() * 2);
+  }
+  ::deflateEnd(&Stream);
+
+  // Tell MemorySanitizer that zlib output buffer is fully initialized.
+  // This avoids a false report when running LLVM with uninstrumented ZLib.
+  __msan_unpoison(CompressedBuffer.data(), Pos);
+  CompressedBuffer.resize(Pos);
+  return Res == Z_STREAM_ERROR ? createError(convertZlibCodeToString(Res))
+                               : Error::success();
+}
+
 Error zlib::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
                        size_t &UncompressedSize) {
   int Res =
@@ -85,6 +136,14 @@ uint32_t zlib::crc32(StringRef Buffer) {
   return ::crc32(0, (const Bytef *)Buffer.data(), Buffer.size());
 }
 
+uint32_t zlib::adler32(StringRef Buffer) {
+  return ::adler32(1, (const Bytef *)Buffer.data(), Buffer.size());
+}
+
+uint32_t zlib::adler32Combine(uint32_t Adler1, uint32_t Adler2, size_t Size2) {
+  return ::adler32_combine(Adler1, Adler2, Size2);
+}
+
 #else
 bool zlib::isAvailable() { return false; }
 Error zlib::compress(StringRef InputBuffer,
@@ -100,7 +159,223 @@ Error zlib::uncompress(StringRef InputBuffer,
                        size_t UncompressedSize) {
   llvm_unreachable("zlib::uncompress is unavailable");
 }
+Error zlib::compressShard(StringRef InputBuffer,
+                          SmallVectorImpl<char> &CompressedBuffer, bool IsLast,
+                          int Level) {
+  llvm_unreachable("zlib::compressShard is unavailable");
+}
 uint32_t zlib::crc32(StringRef Buffer) {
   llvm_unreachable("zlib::crc32 is unavailable");
 }
+uint32_t zlib::adler32(StringRef Buffer) {
+  llvm_unreachable("zlib::adler32 is unavailable");
+}
+uint32_t zlib::adler32Combine(uint32_t Adler1, uint32_t Adler2, size_t Size2) {
+  llvm_unreachable("zlib::adler32Combine is unavailable");
+}
 #endif
+
+#if LLVM_ENABLE_ZSTD == 1
+bool zstd::isAvailable() { return true; }
+
+Error zstd::compress(StringRef InputBuffer,
+                     SmallVectorImpl<char> &CompressedBuffer, int Level) {
+  size_t CompressedSize = ::ZSTD_compressBound(InputBuffer.size());
+  CompressedBuffer.reserve(CompressedSize);
+  size_t Res = ::ZSTD_compress(CompressedBuffer.data(), CompressedSize,
+                               InputBuffer.data(), InputBuffer.size(), Level);
+  if (::ZSTD_isError(Res))
+    return createError(Twine("zstd error: ") + ::ZSTD_getErrorName(Res));
+  // Tell MemorySanitizer that zstd output buffer is fully initialized.
+  __msan_unpoison(CompressedBuffer.data(), Res);
+  CompressedBuffer.set_size(Res);
+  return Error::success();
+}
+
+Error zstd::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
+                       size_t &UncompressedSize) {
+  size_t Res = ::ZSTD_decompress(UncompressedBuffer, UncompressedSize,
+                                 InputBuffer.data(), InputBuffer.size());
+  if (::ZSTD_isError(Res))
+    return createError(Twine("zstd error: ") + ::ZSTD_getErrorName(Res));
+  // Tell MemorySanitizer that zstd output buffer is fully initialized.
+  __msan_unpoison(UncompressedBuffer, Res);
+  UncompressedSize = Res;
+  return Error::success();
+}
+
+Error zstd::uncompress(StringRef InputBuffer,
+                       SmallVectorImpl<char> &UncompressedBuffer,
+                       size_t UncompressedSize) {
+  UncompressedBuffer.resize(UncompressedSize);
+  Error E =
+      uncompress(InputBuffer, UncompressedBuffer.data(), UncompressedSize);
+  UncompressedBuffer.resize(UncompressedSize);
+  return E;
+}
+
+#else
+bool zstd::isAvailable() { return false; }
+Error zstd::compress(StringRef InputBuffer,
+                     SmallVectorImpl<char> &CompressedBuffer, int Level) {
+  llvm_unreachable("zstd::compress is unavailable");
+}
+Error zstd::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
+                       size_t &UncompressedSize) {
+  llvm_unreachable("zstd::uncompress is unavailable");
+}
+Error zstd::uncompress(StringRef InputBuffer,
+                       SmallVectorImpl<char> &UncompressedBuffer,
+                       size_t UncompressedSize) {
+  llvm_unreachable("zstd::uncompress is unavailable");
+}
+#endif
+
+#if LLVM_ENABLE_LZ4 == 1
+bool lz4::isAvailable() { return true; }
+
+Error lz4::compress(StringRef InputBuffer,
+                    SmallVectorImpl<char> &CompressedBuffer, int Level) {
+  if (InputBuffer.size() > LZ4_MAX_INPUT_SIZE)
+    return createError("lz4 error: input is too large");
+  int CompressedSize = ::LZ4_compressBound(InputBuffer.size());
+  CompressedBuffer.reserve(CompressedSize);
+  int Res;
+  if (Level > 0)
+    Res = ::LZ4_compress_HC(InputBuffer.data(), CompressedBuffer.data(),
+                            InputBuffer.size(), CompressedSize, Level);
+  else
+    Res = ::LZ4_compress_default(InputBuffer.data(), CompressedBuffer.data(),
+                                 InputBuffer.size(), CompressedSize);
+  if (Res <= 0)
+    return createError("lz4 error: compression failed");
+  // Tell MemorySanitizer that lz4 output buffer is fully initialized.
+  __msan_unpoison(CompressedBuffer.data(), Res);
+  CompressedBuffer.set_size(Res);
+  return Error::success();
+}
+
+Error lz4::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
+                      size_t &UncompressedSize) {
+  if (InputBuffer.size() > (size_t)INT_MAX ||
+      UncompressedSize > (size_t)INT_MAX)
+    return createError("lz4 error: input is too large");
+  int Res = ::LZ4_decompress_safe(InputBuffer.data(), UncompressedBuffer,
+                                  InputBuffer.size(), UncompressedSize);
+  if (Res < 0)
+    return createError("lz4 error: corrupted input");
+  // Tell MemorySanitizer that lz4 output buffer is fully initialized.
+  __msan_unpoison(UncompressedBuffer, Res);
+  UncompressedSize = Res;
+  return Error::success();
+}
+
+Error lz4::uncompress(StringRef InputBuffer,
+                      SmallVectorImpl<char> &UncompressedBuffer,
+                      size_t UncompressedSize) {
+  UncompressedBuffer.resize(UncompressedSize);
+  Error E =
+      uncompress(InputBuffer, UncompressedBuffer.data(), UncompressedSize);
+  UncompressedBuffer.resize(UncompressedSize);
+  return E;
+}
+
+#else
+bool lz4::isAvailable() { return false; }
+Error lz4::compress(StringRef InputBuffer,
+                    SmallVectorImpl<char> &CompressedBuffer, int Level) {
+  llvm_unreachable("lz4::compress is unavailable");
+}
+Error lz4::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
+                      size_t &UncompressedSize) {
+  llvm_unreachable("lz4::uncompress is unavailable");
+}
+Error lz4::uncompress(StringRef InputBuffer,
+                      SmallVectorImpl<char> &UncompressedBuffer,
+                      size_t UncompressedSize) {
+  llvm_unreachable("lz4::uncompress is unavailable");
+}
+#endif
+
+const char *compression::getName(Format F) {
+  switch (F) {
+  case Format::Zlib:
+    return "zlib";
+  case Format::Zstd:
+    return "zstd";
+  case Format::LZ4:
+    return "lz4";
+  }
+  llvm_unreachable("unknown compression format");
+}
+
+bool compression::isAvailable(Format F) {
+  switch (F) {
+  case Format::Zlib:
+    return zlib::isAvailable();
+  case Format::Zstd:
+    return zstd::isAvailable();
+  case Format::LZ4:
+    return lz4::isAvailable();
+  }
+  llvm_unreachable("unknown compression format");
+}
+
+int compression::getDefaultLevel(Format F) {
+  switch (F) {
+  case Format::Zlib:
+    return zlib::DefaultCompression;
+  case Format::Zstd:
+    return zstd::DefaultCompression;
+  case Format::LZ4:
+    return lz4::DefaultCompression;
+  }
+  llvm_unreachable("unknown compression format");
+}
+
+Error compression::compress(Format F, StringRef InputBuffer,
+                            SmallVectorImpl<char> &CompressedBuffer) {
+  return compress(F, InputBuffer, CompressedBuffer, getDefaultLevel(F));
+}
+
+Error compression::compress(Format F, StringRef InputBuffer,
+                            SmallVectorImpl<char> &CompressedBuffer,
+                            int Level) {
+  switch (F) {
+  case Format::Zlib:
+    return zlib::compress(InputBuffer, CompressedBuffer, Level);
+  case Format::Zstd:
+    return zstd::compress(InputBuffer, CompressedBuffer, Level);
+  case Format::LZ4:
+    return lz4::compress(InputBuffer, CompressedBuffer, Level);
+  }
+  llvm_unreachable("unknown compression format");
+}
+
+Error compression::uncompress(Format F, StringRef InputBuffer,
+                              char *UncompressedBuffer,
+                              size_t &UncompressedSize) {
+  switch (F) {
+  case Format::Zlib:
+    return zlib::uncompress(InputBuffer, UncompressedBuffer, UncompressedSize);
+  case Format::Zstd:
+    return zstd::uncompress(InputBuffer, UncompressedBuffer, UncompressedSize);
+  case Format::LZ4:
+    return lz4::uncompress(InputBuffer, UncompressedBuffer, UncompressedSize);
+  }
+  llvm_unreachable("unknown compression format");
+}
+
+Error compression::uncompress(Format F, StringRef InputBuffer,
+                              SmallVectorImpl<char> &UncompressedBuffer,
+                              size_t UncompressedSize) {
+  switch (F) {
+  case Format::Zlib:
+    return zlib::uncompress(InputBuffer, UncompressedBuffer, UncompressedSize);
+  case Format::Zstd:
+    return zstd::uncompress(InputBuffer, UncompressedBuffer, UncompressedSize);
+  case Format::LZ4:
+    return lz4::uncompress(InputBuffer, UncompressedBuffer, UncompressedSize);
+  }
+  llvm_unreachable("unknown compression format");
+}
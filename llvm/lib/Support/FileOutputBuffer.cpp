@@ -16,6 +16,9 @@
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/Memory.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include <algorithm>
+#include <mutex>
 #include <system_error>
 
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
@@ -112,6 +115,97 @@ private:
   size_t BufferSize;
   unsigned Mode;
 };
+
+// A FileOutputBuffer which keeps data in memory like InMemoryBuffer, but
+// writes it to a temporary file that replaces the output file on commit(),
+// like OnDiskBuffer. Ranges passed to writeback() are written to the file
+// with pwrite() on a thread pool while the user keeps filling in the rest
+// of the buffer. commit() writes whatever is left and renames the file.
+class AsyncWritebackBuffer : public FileOutputBuffer {
+public:
+  AsyncWritebackBuffer(StringRef Path, fs::TempFile Temp, MemoryBlock Buf,
+                       std::size_t BufSize)
+      : FileOutputBuffer(Path), Buffer(Buf), BufferSize(BufSize),
+        Temp(std::move(Temp)) {}
+
+  uint8_t *getBufferStart() const override { return (uint8_t *)Buffer.base(); }
+
+  uint8_t *getBufferEnd() const override {
+    return (uint8_t *)Buffer.base() + BufferSize;
+  }
+
+  size_t getBufferSize() const override { return BufferSize; }
+
+  void writeback(size_t Offset, size_t Size) override {
+    assert(Offset + Size <= BufferSize && "range out of bounds");
+    if (Size == 0)
+      return;
+    {
+      std::lock_guard<std::mutex> Lock(Mu);
+      Written.emplace_back(Offset, Offset + Size);
+    }
+    writeAsync(Offset, Offset + Size);
+  }
+
+  Error commit() override {
+    Pool.wait();
+
+    // Write the parts of the buffer that were never passed to writeback().
+    llvm::sort(Written);
+    size_t Pos = 0;
+    for (const std::pair<size_t, size_t> &R : Written) {
+      if (Pos < R.first)
+        writeAsync(Pos, R.first);
+      Pos = std::max(Pos, R.second);
+    }
+    if (Pos < BufferSize)
+      writeAsync(Pos, BufferSize);
+    Pool.wait();
+
+    if (EC)
+      return errorCodeToError(EC);
+    return Temp.keep(FinalPath);
+  }
+
+  ~AsyncWritebackBuffer() override {
+    Pool.wait();
+    consumeError(Temp.discard());
+  }
+
+  void discard() override {
+    Pool.wait();
+    consumeError(Temp.discard());
+  }
+
+private:
+  void writeAsync(size_t Begin, size_t End) {
+    // Split large ranges so that several threads write them at once.
+    const size_t ChunkSize = 4 * 1024 * 1024;
+    for (size_t I = Begin; I < End; I += ChunkSize) {
+      size_t Size = std::min(ChunkSize, End - I);
+      Pool.async([=] {
+        ArrayRef<char> Chunk((const char *)Buffer.base() + I, Size);
+        if (std::error_code E = fs::writeFileSlice(Temp.FD, Chunk, I)) {
+          std::lock_guard<std::mutex> Lock(Mu);
+          if (!EC)
+            EC = E;
+        }
+      });
+    }
+  }
+
+  OwningMemoryBlock Buffer;
+  size_t BufferSize;
+  fs::TempFile Temp;
+
+  // The ranges passed to writeback() and the first write error, guarded by
+  // Mu.
+  std::mutex Mu;
+  std::vector<std::pair<size_t, size_t>> Written;
+  std::error_code EC;
+
+  ThreadPool Pool;
+};
 } // namespace
 
 static Expected<std::unique_ptr<InMemoryBuffer>>
@@ -160,6 +254,25 @@ createOnDiskBuffer(StringRef Path, size_t Size, unsigned Mode) {
                                          std::move(MappedFile));
 }
 
+static Expected<std::unique_ptr<FileOutputBuffer>>
+createAsyncWritebackBuffer(StringRef Path, size_t Size, unsigned Mode) {
+  Expected<fs::TempFile> FileOrErr =
+      fs::TempFile::create(Path + ".tmp%%%%%%%", Mode);
+  if (!FileOrErr)
+    return FileOrErr.takeError();
+  fs::TempFile File = std::move(*FileOrErr);
+
+  std::error_code EC;
+  MemoryBlock MB = Memory::allocateMappedMemory(
+      Size, nullptr, sys::Memory::MF_READ | sys::Memory::MF_WRITE, EC);
+  if (EC) {
+    consumeError(File.discard());
+    return errorCodeToError(EC);
+  }
+  return llvm::make_unique<AsyncWritebackBuffer>(Path, std::move(File), MB,
+                                                 Size);
+}
+
 // Create an instance of FileOutputBuffer.
 Expected<std::unique_ptr<FileOutputBuffer>>
 FileOutputBuffer::create(StringRef Path, size_t Size, unsigned Flags) {
@@ -188,6 +301,8 @@ FileOutputBuffer::create(StringRef Path, size_t Size, unsigned Flags) {
   case fs::file_type::regular_file:
   case fs::file_type::file_not_found:
   case fs::file_type::status_error:
+    if (Flags & F_async_writeback)
+      return createAsyncWritebackBuffer(Path, Size, Mode);
     return createOnDiskBuffer(Path, Size, Mode);
   default:
     return createInMemoryBuffer(Path, Size, Mode);
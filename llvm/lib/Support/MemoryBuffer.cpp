@@ -204,6 +204,11 @@ public:
   MemoryBuffer::BufferKind getBufferKind() const override {
     return MemoryBuffer::MemoryBuffer_MMap;
   }
+
+  void adviseIfMmap(sys::fs::mapped_file_region::advice A) const override {
+    // This is only a hint, so errors don't matter.
+    MFR.advise(A);
+  }
 };
 }
 
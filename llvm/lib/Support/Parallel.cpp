@@ -14,8 +14,10 @@
 #include "llvm/Support/Threading.h"
 
 #include <atomic>
-#include <stack>
+#include <deque>
+#include <memory>
 #include <thread>
+#include <vector>
 
 namespace llvm {
 namespace parallel {
@@ -60,19 +62,29 @@ Executor *Executor::getDefaultExecutor() {
 }
 
 #else
-/// An implementation of an Executor that runs closures on a thread pool
-///   in filo order.
+/// An implementation of an Executor that runs closures on a thread pool.
+///
+/// Every worker has its own task deque. A worker pushes the tasks it spawns
+/// to the back of its own deque and pops from there too, so nested tasks run
+/// in filo order on the thread that created them. An idle worker steals from
+/// the front of another worker's deque. This keeps workers from contending on
+/// a single shared queue when many fine-grained tasks are spawned. Tasks
+/// added from threads outside the pool are spread over the deques in
+/// round-robin order.
 class ThreadPoolExecutor : public Executor {
 public:
   explicit ThreadPoolExecutor(unsigned ThreadCount = hardware_concurrency())
       : Done(ThreadCount) {
+    for (unsigned I = 0; I < ThreadCount; ++I)
+      Queues.emplace_back(new TaskQueue);
+
     // Spawn all but one of the threads in another thread as spawning threads
     // can take a while.
     std::thread([&, ThreadCount] {
-      for (size_t i = 1; i < ThreadCount; ++i) {
-        std::thread([=] { work(); }).detach();
+      for (unsigned I = 1; I < ThreadCount; ++I) {
+        std::thread([=] { work(I); }).detach();
       }
-      work();
+      work(0);
     }).detach();
   }
 
@@ -85,34 +97,94 @@ public:
   }
 
   void add(std::function<void()> F) override {
-    std::unique_lock<std::mutex> Lock(Mutex);
-    WorkStack.push(F);
-    Lock.unlock();
-    Cond.notify_one();
+    unsigned I = WorkerIndex;
+    if (I >= Queues.size())
+      I = NextQueue++ % Queues.size();
+
+    // Count the task before it becomes visible so that Pending never
+    // underflows when a worker takes it right away.
+    ++Pending;
+    TaskQueue &Q = *Queues[I];
+    {
+      std::lock_guard<std::mutex> Lock(Q.Mutex);
+      Q.Tasks.push_back(std::move(F));
+    }
+
+    // Wake up a sleeping worker. Workers increment Idle before they check
+    // Pending, and we check Idle after incrementing Pending, so at least one
+    // of the two sides sees the other and the wakeup can't be lost.
+    if (Idle > 0) {
+      { std::lock_guard<std::mutex> Lock(Mutex); }
+      Cond.notify_one();
+    }
   }
 
 private:
-  void work() {
-    while (true) {
+  struct TaskQueue {
+    std::mutex Mutex;
+    std::deque<std::function<void()>> Tasks;
+  };
+
+  // Takes a task from worker I's own deque, or steals one from another
+  // worker. Returns false if no task was found.
+  bool getTask(unsigned I, std::function<void()> &Task) {
+    {
+      TaskQueue &Q = *Queues[I];
+      std::lock_guard<std::mutex> Lock(Q.Mutex);
+      if (!Q.Tasks.empty()) {
+        Task = std::move(Q.Tasks.back());
+        Q.Tasks.pop_back();
+        return true;
+      }
+    }
+
+    for (size_t J = 1, E = Queues.size(); J < E; ++J) {
+      TaskQueue &Q = *Queues[(I + J) % E];
+      std::lock_guard<std::mutex> Lock(Q.Mutex);
+      if (!Q.Tasks.empty()) {
+        Task = std::move(Q.Tasks.front());
+        Q.Tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void work(unsigned I) {
+    WorkerIndex = I;
+    std::function<void()> Task;
+    while (!Stop) {
+      if (getTask(I, Task)) {
+        --Pending;
+        Task();
+        continue;
+      }
+
+      // Nothing to run. Sleep until a task is added. If Pending is nonzero,
+      // someone else took the task we were about to find, so just retry.
       std::unique_lock<std::mutex> Lock(Mutex);
-      Cond.wait(Lock, [&] { return Stop || !WorkStack.empty(); });
-      if (Stop)
-        break;
-      auto Task = WorkStack.top();
-      WorkStack.pop();
-      Lock.unlock();
-      Task();
+      ++Idle;
+      Cond.wait(Lock, [&] { return Stop || Pending > 0; });
+      --Idle;
     }
     Done.dec();
   }
 
+  // The index of the pool worker running on this thread, or -1.
+  static LLVM_THREAD_LOCAL unsigned WorkerIndex;
+
   std::atomic<bool> Stop{false};
-  std::stack<std::function<void()>> WorkStack;
+  std::vector<std::unique_ptr<TaskQueue>> Queues;
+  std::atomic<unsigned> NextQueue{0};
+  std::atomic<unsigned> Pending{0};
+  std::atomic<unsigned> Idle{0};
   std::mutex Mutex;
   std::condition_variable Cond;
   parallel::detail::Latch Done;
 };
 
+LLVM_THREAD_LOCAL unsigned ThreadPoolExecutor::WorkerIndex = -1;
+
 Executor *Executor::getDefaultExecutor() {
   static ThreadPoolExecutor exec;
   return &exec;
@@ -126,8 +198,15 @@ static std::atomic<int> TaskGroupInstances;
 // lock if all threads in the default executor are blocked. To prevent the dead
 // lock, only allow the first TaskGroup to run tasks parallelly. In the scenario
 // of nested parallel_for_each(), only the outermost one runs parallelly.
+//
+// The outermost TaskGroup must wait for its tasks before it stops counting as
+// an instance. Otherwise tasks that are still running would see no live
+// TaskGroup and spawn parallel tasks of their own.
 TaskGroup::TaskGroup() : Parallel(TaskGroupInstances++ == 0) {}
-TaskGroup::~TaskGroup() { --TaskGroupInstances; }
+TaskGroup::~TaskGroup() {
+  L.sync();
+  --TaskGroupInstances;
+}
 
 void TaskGroup::spawn(std::function<void()> F) {
   if (Parallel) {
@@ -17,6 +17,7 @@
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Signals.h"
 #include <cctype>
@@ -1119,6 +1120,19 @@ ErrorOr<perms> getPermissions(const Twine &Path) {
 namespace llvm {
 namespace sys {
 namespace fs {
+void prefetchFiles(ArrayRef<std::string> Paths) {
+  parallel::for_each(parallel::par, Paths.begin(), Paths.end(),
+                     [](const std::string &Path) {
+                       Expected<file_t> F = openNativeFileForRead(Path);
+                       if (!F) {
+                         consumeError(F.takeError());
+                         return;
+                       }
+                       prefetchOpenFile(*F);
+                       closeFile(*F);
+                     });
+}
+
 TempFile::TempFile(StringRef Name, int FD) : TmpName(Name), FD(FD) {}
 TempFile::TempFile(TempFile &&Other) { *this = std::move(Other); }
 TempFile &TempFile::operator=(TempFile &&Other) {
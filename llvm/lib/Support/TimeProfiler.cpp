@@ -15,8 +15,11 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/JSON.h"
+#include "llvm/Support/Threading.h"
+#include <atomic>
 #include <cassert>
 #include <chrono>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -49,68 +52,114 @@ struct Entry {
         Detail(std::move(Dt)){};
 };
 
+// The sections recorded by one thread. Only the owning thread touches an
+// instance until the profile is written, so no locking is needed to record.
+struct ThreadEntries {
+  ThreadEntries(uint64_t Tid) : Tid(Tid) {}
+
+  uint64_t Tid;
+  SmallVector<Entry, 16> Stack;
+  SmallVector<Entry, 128> Entries;
+  StringMap<CountAndDurationType> CountAndTotalPerName;
+};
+
+// Every profiler gets a distinct generation number so that threads can tell
+// whether their cached ThreadEntries belong to the current profiler.
+static std::atomic<uint64_t> NextGeneration(0);
+static LLVM_THREAD_LOCAL ThreadEntries *CurrentThreadEntries;
+static LLVM_THREAD_LOCAL uint64_t CurrentThreadGeneration;
+
 struct TimeTraceProfiler {
-  TimeTraceProfiler() {
+  TimeTraceProfiler(unsigned TimeTraceGranularity, StringRef ProcName)
+      : ProcName(ProcName), Generation(++NextGeneration),
+        TimeTraceGranularity(TimeTraceGranularity) {
     StartTime = steady_clock::now();
   }
 
+  // Returns the calling thread's buffer, creating it on first use.
+  ThreadEntries &getThreadEntries() {
+    if (CurrentThreadGeneration != Generation) {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      Threads.push_back(llvm::make_unique<ThreadEntries>(get_threadid()));
+      CurrentThreadEntries = Threads.back().get();
+      CurrentThreadGeneration = Generation;
+    }
+    return *CurrentThreadEntries;
+  }
+
   void begin(std::string Name, llvm::function_ref<std::string()> Detail) {
-    Stack.emplace_back(steady_clock::now(), DurationType{}, std::move(Name),
-                       Detail());
+    getThreadEntries().Stack.emplace_back(steady_clock::now(), DurationType{},
+                                          std::move(Name), Detail());
   }
 
   void end() {
-    assert(!Stack.empty() && "Must call begin() first");
-    auto &E = Stack.back();
+    ThreadEntries &T = getThreadEntries();
+    assert(!T.Stack.empty() && "Must call begin() first");
+    auto &E = T.Stack.back();
     E.Duration = steady_clock::now() - E.Start;
 
     // Only include sections longer than TimeTraceGranularity msec.
     if (duration_cast<microseconds>(E.Duration).count() > TimeTraceGranularity)
-      Entries.emplace_back(E);
+      T.Entries.emplace_back(E);
 
     // Track total time taken by each "name", but only the topmost levels of
     // them; e.g. if there's a template instantiation that instantiates other
     // templates from within, we only want to add the topmost one. "topmost"
     // happens to be the ones that don't have any currently open entries above
     // itself.
-    if (std::find_if(++Stack.rbegin(), Stack.rend(), [&](const Entry &Val) {
-          return Val.Name == E.Name;
-        }) == Stack.rend()) {
-      auto &CountAndTotal = CountAndTotalPerName[E.Name];
+    if (std::find_if(++T.Stack.rbegin(), T.Stack.rend(),
+                     [&](const Entry &Val) { return Val.Name == E.Name; }) ==
+        T.Stack.rend()) {
+      auto &CountAndTotal = T.CountAndTotalPerName[E.Name];
       CountAndTotal.first++;
       CountAndTotal.second += E.Duration;
     }
 
-    Stack.pop_back();
+    T.Stack.pop_back();
   }
 
+  // Writes the sections of all threads. Other threads must have ended all
+  // their sections by now and must not begin new ones while this runs.
   void Write(raw_pwrite_stream &OS) {
-    assert(Stack.empty() &&
-           "All profiler sections should be ended when calling Write");
+    std::lock_guard<std::mutex> Lock(Mutex);
     json::OStream J(OS);
     J.objectBegin();
     J.attributeBegin("traceEvents");
     J.arrayBegin();
 
-    // Emit all events for the main flame graph.
-    for (const auto &E : Entries) {
-      auto StartUs = duration_cast<microseconds>(E.Start - StartTime).count();
-      auto DurUs = duration_cast<microseconds>(E.Duration).count();
+    // Emit all events for the main flame graph, one track per thread.
+    uint64_t MaxTid = 0;
+    StringMap<CountAndDurationType> CountAndTotalPerName;
+    for (const std::unique_ptr<ThreadEntries> &T : Threads) {
+      assert(T->Stack.empty() &&
+             "All profiler sections should be ended when calling Write");
+      MaxTid = std::max(MaxTid, T->Tid);
 
-      J.object([&]{
-        J.attribute("pid", 1);
-        J.attribute("tid", 0);
-        J.attribute("ph", "X");
-        J.attribute("ts", StartUs);
-        J.attribute("dur", DurUs);
-        J.attribute("name", E.Name);
-        J.attributeObject("args", [&] { J.attribute("detail", E.Detail); });
-      });
+      for (const auto &E : T->Entries) {
+        auto StartUs = duration_cast<microseconds>(E.Start - StartTime).count();
+        auto DurUs = duration_cast<microseconds>(E.Duration).count();
+
+        J.object([&]{
+          J.attribute("pid", 1);
+          J.attribute("tid", int64_t(T->Tid));
+          J.attribute("ph", "X");
+          J.attribute("ts", StartUs);
+          J.attribute("dur", DurUs);
+          J.attribute("name", E.Name);
+          J.attributeObject("args", [&] { J.attribute("detail", E.Detail); });
+        });
+      }
+
+      for (const auto &E : T->CountAndTotalPerName) {
+        auto &CountAndTotal = CountAndTotalPerName[E.getKey()];
+        CountAndTotal.first += E.getValue().first;
+        CountAndTotal.second += E.getValue().second;
+      }
     }
 
     // Emit totals by section name as additional "thread" events, sorted from
-    // longest one.
-    int Tid = 1;
+    // longest one. Their thread IDs are above those of all real threads.
+    uint64_t Tid = MaxTid + 1;
     std::vector<NameAndCountAndDurationType> SortedTotals;
     SortedTotals.reserve(CountAndTotalPerName.size());
     for (const auto &E : CountAndTotalPerName)
@@ -127,7 +176,7 @@ struct TimeTraceProfiler {
 
       J.object([&]{
         J.attribute("pid", 1);
-        J.attribute("tid", Tid);
+        J.attribute("tid", int64_t(Tid));
         J.attribute("ph", "X");
         J.attribute("ts", 0);
         J.attribute("dur", DurUs);
@@ -149,7 +198,7 @@ struct TimeTraceProfiler {
       J.attribute("ts", 0);
       J.attribute("ph", "M");
       J.attribute("name", "process_name");
-      J.attributeObject("args", [&] { J.attribute("name", "clang"); });
+      J.attributeObject("args", [&] { J.attribute("name", ProcName); });
     });
 
     J.arrayEnd();
@@ -157,16 +206,25 @@ struct TimeTraceProfiler {
     J.objectEnd();
   }
 
-  SmallVector<Entry, 16> Stack;
-  SmallVector<Entry, 128> Entries;
-  StringMap<CountAndDurationType> CountAndTotalPerName;
+  std::mutex Mutex;
+  std::vector<std::unique_ptr<ThreadEntries>> Threads;
   time_point<steady_clock> StartTime;
+  std::string ProcName;
+  uint64_t Generation;
+  // Minimum duration, in microseconds, of the sections that are recorded.
+  unsigned TimeTraceGranularity;
 };
 
-void timeTraceProfilerInitialize() {
+void timeTraceProfilerInitialize(StringRef ProcName) {
+  timeTraceProfilerInitialize(TimeTraceGranularity, ProcName);
+}
+
+void timeTraceProfilerInitialize(unsigned TimeTraceGranularity,
+                                 StringRef ProcName) {
   assert(TimeTraceProfilerInstance == nullptr &&
          "Profiler should not be initialized");
-  TimeTraceProfilerInstance = new TimeTraceProfiler();
+  TimeTraceProfilerInstance =
+      new TimeTraceProfiler(TimeTraceGranularity, ProcName);
 }
 
 void timeTraceProfilerCleanup() {
@@ -180,6 +238,25 @@ void timeTraceProfilerWrite(raw_pwrite_stream &OS) {
   TimeTraceProfilerInstance->Write(OS);
 }
 
+Error timeTraceProfilerWrite(StringRef PreferredFileName,
+                             StringRef FallbackFileName) {
+  assert(TimeTraceProfilerInstance != nullptr &&
+         "Profiler object can't be null");
+
+  std::string Path = PreferredFileName;
+  if (Path.empty())
+    Path = (FallbackFileName + ".time-trace").str();
+
+  std::error_code EC;
+  raw_fd_ostream OS(Path, EC, sys::fs::OF_Text);
+  if (EC)
+    return createStringError(EC, "could not open %s: %s", Path.c_str(),
+                             EC.message().c_str());
+
+  TimeTraceProfilerInstance->Write(OS);
+  return Error::success();
+}
+
 void timeTraceProfilerBegin(StringRef Name, StringRef Detail) {
   if (TimeTraceProfilerInstance != nullptr)
     TimeTraceProfilerInstance->begin(Name, [&]() { return Detail; });
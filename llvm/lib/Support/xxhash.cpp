@@ -35,12 +35,36 @@
 /* based on revision d2df04efcbef7d7f6886d345861e5dfda4edacc1 Removed
  * everything but a simple interface for computing XXh64. */
 
+/* The XXH3 implementation is based on xxHash v0.8.1. Only the 64-bit variant
+ * with the default secret and a seed of 0 is provided. */
+
 #include "llvm/Support/xxhash.h"
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/MathExtras.h"
 
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LLVM_XXH3_SSE2 1
+#endif
+
+// AVX2 is not part of the x86-64 baseline, so the AVX2 kernel is compiled
+// with a target attribute and selected at run time.
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__AVX2__) &&         \
+    (!defined(__clang__) || __clang_major__ >= 4)
+#include <immintrin.h>
+#define LLVM_XXH3_AVX2 1
+#define LLVM_XXH3_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define LLVM_XXH3_AVX2 1
+#define LLVM_XXH3_TARGET_AVX2
+#endif
+
 using namespace llvm;
 using namespace support;
 
@@ -136,3 +160,357 @@ uint64_t llvm::xxHash64(StringRef Data) {
 uint64_t llvm::xxHash64(ArrayRef<uint8_t> Data) {
   return xxHash64({(const char *)Data.data(), Data.size()});
 }
+
+static const uint32_t PRIME32_1 = 0x9E3779B1U;
+static const uint32_t PRIME32_2 = 0x85EBCA77U;
+static const uint32_t PRIME32_3 = 0xC2B2AE3DU;
+
+static const uint64_t PRIME_MX1 = 0x165667919E3779F9ULL;
+static const uint64_t PRIME_MX2 = 0x9FB21C651E98DF25ULL;
+
+// The default secret. Pseudorandom data taken from FARSH.
+static const size_t SecretSize = 192;
+alignas(64) static const uint8_t Secret[SecretSize] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c,
+    0xf7, 0x21, 0xad, 0x1c, 0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb,
+    0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e,
+    0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6,
+    0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb,
+    0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97,
+    0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7,
+    0xc7, 0x0b, 0x4f, 0x1d, 0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31,
+    0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, 0xea, 0xc5, 0xac, 0x83,
+    0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26,
+    0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc,
+    0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f,
+    0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+// Multiplies two 64-bit values into a 128-bit product and folds it by XORing
+// its halves.
+static uint64_t mul128Fold64(uint64_t LHS, uint64_t RHS) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t Product = (__uint128_t)LHS * RHS;
+  return uint64_t(Product) ^ uint64_t(Product >> 64);
+#else
+  uint64_t LoLo = (LHS & 0xFFFFFFFF) * (RHS & 0xFFFFFFFF);
+  uint64_t HiLo = (LHS >> 32) * (RHS & 0xFFFFFFFF);
+  uint64_t LoHi = (LHS & 0xFFFFFFFF) * (RHS >> 32);
+  uint64_t HiHi = (LHS >> 32) * (RHS >> 32);
+  uint64_t Cross = (LoLo >> 32) + (HiLo & 0xFFFFFFFF) + LoHi;
+  uint64_t Upper = (HiLo >> 32) + (Cross >> 32) + HiHi;
+  uint64_t Lower = (Cross << 32) | (LoLo & 0xFFFFFFFF);
+  return Upper ^ Lower;
+#endif
+}
+
+static uint64_t xxh64Avalanche(uint64_t Hash) {
+  Hash ^= Hash >> 33;
+  Hash *= PRIME64_2;
+  Hash ^= Hash >> 29;
+  Hash *= PRIME64_3;
+  Hash ^= Hash >> 32;
+  return Hash;
+}
+
+static uint64_t xxh3Avalanche(uint64_t Hash) {
+  Hash ^= Hash >> 37;
+  Hash *= PRIME_MX1;
+  Hash ^= Hash >> 32;
+  return Hash;
+}
+
+static uint64_t rrmxmx(uint64_t Hash, uint64_t Len) {
+  Hash ^= rotl64(Hash, 49) ^ rotl64(Hash, 24);
+  Hash *= PRIME_MX2;
+  Hash ^= (Hash >> 35) + Len;
+  Hash *= PRIME_MX2;
+  Hash ^= Hash >> 28;
+  return Hash;
+}
+
+static uint64_t hashLen1To3(const uint8_t *P, size_t Len) {
+  uint32_t C1 = P[0];
+  uint32_t C2 = P[Len >> 1];
+  uint32_t C3 = P[Len - 1];
+  uint32_t Combined = (C1 << 16) | (C2 << 24) | C3 | ((uint32_t)Len << 8);
+  uint64_t Bitflip =
+      endian::read32le(Secret) ^ endian::read32le(Secret + 4);
+  return xxh64Avalanche(uint64_t(Combined) ^ Bitflip);
+}
+
+static uint64_t hashLen4To8(const uint8_t *P, size_t Len) {
+  uint32_t In1 = endian::read32le(P);
+  uint32_t In2 = endian::read32le(P + Len - 4);
+  uint64_t Bitflip =
+      endian::read64le(Secret + 8) ^ endian::read64le(Secret + 16);
+  uint64_t In64 = In2 + (uint64_t(In1) << 32);
+  return rrmxmx(In64 ^ Bitflip, Len);
+}
+
+static uint64_t hashLen9To16(const uint8_t *P, size_t Len) {
+  uint64_t Bitflip1 =
+      endian::read64le(Secret + 24) ^ endian::read64le(Secret + 32);
+  uint64_t Bitflip2 =
+      endian::read64le(Secret + 40) ^ endian::read64le(Secret + 48);
+  uint64_t InLo = endian::read64le(P) ^ Bitflip1;
+  uint64_t InHi = endian::read64le(P + Len - 8) ^ Bitflip2;
+  uint64_t Acc = Len + ByteSwap_64(InLo) + InHi + mul128Fold64(InLo, InHi);
+  return xxh3Avalanche(Acc);
+}
+
+static uint64_t hashLen0To16(const uint8_t *P, size_t Len) {
+  if (LLVM_LIKELY(Len > 8))
+    return hashLen9To16(P, Len);
+  if (LLVM_LIKELY(Len >= 4))
+    return hashLen4To8(P, Len);
+  if (Len)
+    return hashLen1To3(P, Len);
+  return xxh64Avalanche(endian::read64le(Secret + 56) ^
+                        endian::read64le(Secret + 64));
+}
+
+static uint64_t mix16B(const uint8_t *P, const uint8_t *S) {
+  return mul128Fold64(endian::read64le(P) ^ endian::read64le(S),
+                      endian::read64le(P + 8) ^ endian::read64le(S + 8));
+}
+
+static uint64_t hashLen17To128(const uint8_t *P, size_t Len) {
+  uint64_t Acc = Len * PRIME64_1;
+  if (Len > 32) {
+    if (Len > 64) {
+      if (Len > 96) {
+        Acc += mix16B(P + 48, Secret + 96);
+        Acc += mix16B(P + Len - 64, Secret + 112);
+      }
+      Acc += mix16B(P + 32, Secret + 64);
+      Acc += mix16B(P + Len - 48, Secret + 80);
+    }
+    Acc += mix16B(P + 16, Secret + 32);
+    Acc += mix16B(P + Len - 32, Secret + 48);
+  }
+  Acc += mix16B(P, Secret);
+  Acc += mix16B(P + Len - 16, Secret + 16);
+  return xxh3Avalanche(Acc);
+}
+
+static const size_t MidSizeMax = 240;
+static const size_t MidSizeStartOffset = 3;
+static const size_t MidSizeLastOffset = 17;
+static const size_t SecretSizeMin = 136;
+
+LLVM_ATTRIBUTE_NOINLINE static uint64_t hashLen129To240(const uint8_t *P,
+                                                        size_t Len) {
+  uint64_t Acc = Len * PRIME64_1;
+  unsigned NumRounds = Len / 16;
+  for (unsigned I = 0; I < 8; ++I)
+    Acc += mix16B(P + 16 * I, Secret + 16 * I);
+  Acc = xxh3Avalanche(Acc);
+
+  uint64_t AccEnd =
+      mix16B(P + Len - 16, Secret + SecretSizeMin - MidSizeLastOffset);
+  for (unsigned I = 8; I < NumRounds; ++I)
+    AccEnd += mix16B(P + 16 * I, Secret + 16 * (I - 8) + MidSizeStartOffset);
+  return xxh3Avalanche(Acc + AccEnd);
+}
+
+// Inputs longer than MidSizeMax are processed in 64-byte stripes that are
+// accumulated into eight 64-bit lanes. This is the part worth vectorizing.
+static const size_t StripeLen = 64;
+static const size_t SecretConsumeRate = 8;
+static const size_t AccNB = StripeLen / sizeof(uint64_t);
+static const size_t SecretLastAccStart = 7;
+static const size_t SecretMergeAccsStart = 11;
+
+#ifndef LLVM_XXH3_SSE2
+static void accumulate512Scalar(uint64_t *Acc, const uint8_t *P,
+                                const uint8_t *S) {
+  for (size_t I = 0; I < AccNB; ++I) {
+    uint64_t Data = endian::read64le(P + 8 * I);
+    uint64_t Key = Data ^ endian::read64le(S + 8 * I);
+    Acc[I ^ 1] += Data;
+    Acc[I] += uint32_t(Key) * (Key >> 32);
+  }
+}
+
+static void scrambleAccScalar(uint64_t *Acc, const uint8_t *S) {
+  for (size_t I = 0; I < AccNB; ++I) {
+    uint64_t A = Acc[I];
+    A ^= A >> 47;
+    A ^= endian::read64le(S + 8 * I);
+    A *= PRIME32_1;
+    Acc[I] = A;
+  }
+}
+#else
+static void accumulate512SSE2(uint64_t *Acc, const uint8_t *P,
+                              const uint8_t *S) {
+  __m128i *XAcc = (__m128i *)Acc;
+  for (size_t I = 0; I < StripeLen / sizeof(__m128i); ++I) {
+    __m128i Data = _mm_loadu_si128((const __m128i *)P + I);
+    __m128i Key = _mm_loadu_si128((const __m128i *)S + I);
+    __m128i DataKey = _mm_xor_si128(Data, Key);
+    // Multiply the low and high 32 bits of each 64-bit lane.
+    __m128i DataKeyHi = _mm_shuffle_epi32(DataKey, _MM_SHUFFLE(0, 3, 0, 1));
+    __m128i Product = _mm_mul_epu32(DataKey, DataKeyHi);
+    // Add the input to the accumulator with its 64-bit lanes swapped.
+    __m128i DataSwap = _mm_shuffle_epi32(Data, _MM_SHUFFLE(1, 0, 3, 2));
+    __m128i Sum = _mm_add_epi64(XAcc[I], DataSwap);
+    XAcc[I] = _mm_add_epi64(Product, Sum);
+  }
+}
+
+static void scrambleAccSSE2(uint64_t *Acc, const uint8_t *S) {
+  __m128i *XAcc = (__m128i *)Acc;
+  const __m128i Prime32 = _mm_set1_epi32((int)PRIME32_1);
+  for (size_t I = 0; I < StripeLen / sizeof(__m128i); ++I) {
+    __m128i A = XAcc[I];
+    A = _mm_xor_si128(A, _mm_srli_epi64(A, 47));
+    __m128i DataKey =
+        _mm_xor_si128(A, _mm_loadu_si128((const __m128i *)S + I));
+    // A 64x32-bit multiply made of two 32x32-bit ones.
+    __m128i DataKeyHi = _mm_shuffle_epi32(DataKey, _MM_SHUFFLE(0, 3, 0, 1));
+    __m128i ProdLo = _mm_mul_epu32(DataKey, Prime32);
+    __m128i ProdHi = _mm_mul_epu32(DataKeyHi, Prime32);
+    XAcc[I] = _mm_add_epi64(ProdLo, _mm_slli_epi64(ProdHi, 32));
+  }
+}
+#endif
+
+#ifdef LLVM_XXH3_AVX2
+LLVM_XXH3_TARGET_AVX2 static void
+accumulate512AVX2(uint64_t *Acc, const uint8_t *P, const uint8_t *S) {
+  __m256i *XAcc = (__m256i *)Acc;
+  for (size_t I = 0; I < StripeLen / sizeof(__m256i); ++I) {
+    __m256i Data = _mm256_loadu_si256((const __m256i *)P + I);
+    __m256i Key = _mm256_loadu_si256((const __m256i *)S + I);
+    __m256i DataKey = _mm256_xor_si256(Data, Key);
+    __m256i DataKeyHi =
+        _mm256_shuffle_epi32(DataKey, _MM_SHUFFLE(0, 3, 0, 1));
+    __m256i Product = _mm256_mul_epu32(DataKey, DataKeyHi);
+    __m256i DataSwap = _mm256_shuffle_epi32(Data, _MM_SHUFFLE(1, 0, 3, 2));
+    __m256i Sum = _mm256_add_epi64(XAcc[I], DataSwap);
+    XAcc[I] = _mm256_add_epi64(Product, Sum);
+  }
+}
+
+LLVM_XXH3_TARGET_AVX2 static void scrambleAccAVX2(uint64_t *Acc,
+                                                  const uint8_t *S) {
+  __m256i *XAcc = (__m256i *)Acc;
+  const __m256i Prime32 = _mm256_set1_epi32((int)PRIME32_1);
+  for (size_t I = 0; I < StripeLen / sizeof(__m256i); ++I) {
+    __m256i A = XAcc[I];
+    A = _mm256_xor_si256(A, _mm256_srli_epi64(A, 47));
+    __m256i DataKey =
+        _mm256_xor_si256(A, _mm256_loadu_si256((const __m256i *)S + I));
+    __m256i DataKeyHi =
+        _mm256_shuffle_epi32(DataKey, _MM_SHUFFLE(0, 3, 0, 1));
+    __m256i ProdLo = _mm256_mul_epu32(DataKey, Prime32);
+    __m256i ProdHi = _mm256_mul_epu32(DataKeyHi, Prime32);
+    XAcc[I] = _mm256_add_epi64(ProdLo, _mm256_slli_epi64(ProdHi, 32));
+  }
+}
+#endif
+
+static uint64_t mergeAccs(const uint64_t *Acc, const uint8_t *S,
+                          uint64_t Start) {
+  uint64_t Result = Start;
+  for (size_t I = 0; I < 4; ++I)
+    Result += mul128Fold64(Acc[2 * I] ^ endian::read64le(S + 16 * I),
+                           Acc[2 * I + 1] ^ endian::read64le(S + 16 * I + 8));
+  return xxh3Avalanche(Result);
+}
+
+typedef void AccumulateFn(uint64_t *Acc, const uint8_t *P, const uint8_t *S,
+                          size_t NumStripes);
+typedef void ScrambleAccFn(uint64_t *Acc, const uint8_t *S);
+
+// Accumulates \p NumStripes consecutive stripes. Each kernel gets its own
+// copy so that the 512-bit step is inlined into the loop.
+template <void (*Accumulate512)(uint64_t *, const uint8_t *, const uint8_t *)>
+static void accumulate(uint64_t *Acc, const uint8_t *P, const uint8_t *S,
+                       size_t NumStripes) {
+  for (size_t I = 0; I < NumStripes; ++I)
+    Accumulate512(Acc, P + I * StripeLen, S + I * SecretConsumeRate);
+}
+
+#ifdef LLVM_XXH3_AVX2
+// A template instance wouldn't inherit the target attribute, so this one is
+// spelled out.
+LLVM_XXH3_TARGET_AVX2 static void accumulateAVX2(uint64_t *Acc,
+                                                 const uint8_t *P,
+                                                 const uint8_t *S,
+                                                 size_t NumStripes) {
+  for (size_t I = 0; I < NumStripes; ++I)
+    accumulate512AVX2(Acc, P + I * StripeLen, S + I * SecretConsumeRate);
+}
+#endif
+
+// The main loop for inputs longer than MidSizeMax.
+static uint64_t hashLongImpl(const uint8_t *P, size_t Len,
+                             AccumulateFn *Accumulate,
+                             ScrambleAccFn *ScrambleAcc) {
+  alignas(32) uint64_t Acc[AccNB] = {PRIME32_3, PRIME64_1, PRIME64_2,
+                                     PRIME64_3, PRIME64_4, PRIME32_2,
+                                     PRIME64_5, PRIME32_1};
+  const size_t StripesPerBlock = (SecretSize - StripeLen) / SecretConsumeRate;
+  const size_t BlockLen = StripeLen * StripesPerBlock;
+  const size_t NumBlocks = (Len - 1) / BlockLen;
+
+  for (size_t N = 0; N < NumBlocks; ++N) {
+    Accumulate(Acc, P + N * BlockLen, Secret, StripesPerBlock);
+    ScrambleAcc(Acc, Secret + SecretSize - StripeLen);
+  }
+
+  // The last partial block, then the last stripe, which may overlap it.
+  const size_t NumStripes = ((Len - 1) - BlockLen * NumBlocks) / StripeLen;
+  Accumulate(Acc, P + NumBlocks * BlockLen, Secret, NumStripes);
+  Accumulate(Acc, P + Len - StripeLen,
+             Secret + SecretSize - StripeLen - SecretLastAccStart, 1);
+
+  return mergeAccs(Acc, Secret + SecretMergeAccsStart, Len * PRIME64_1);
+}
+
+#ifdef LLVM_XXH3_AVX2
+static bool hasAVX2() {
+#ifdef __AVX2__
+  return true;
+#else
+  static const bool Result = __builtin_cpu_supports("avx2");
+  return Result;
+#endif
+}
+#endif
+
+LLVM_ATTRIBUTE_NOINLINE static uint64_t hashLong(const uint8_t *P,
+                                                 size_t Len) {
+#ifdef LLVM_XXH3_AVX2
+  if (hasAVX2())
+    return hashLongImpl(P, Len, accumulateAVX2, scrambleAccAVX2);
+#endif
+#ifdef LLVM_XXH3_SSE2
+  return hashLongImpl(P, Len, accumulate<accumulate512SSE2>, scrambleAccSSE2);
+#else
+  return hashLongImpl(P, Len, accumulate<accumulate512Scalar>,
+                      scrambleAccScalar);
+#endif
+}
+
+uint64_t llvm::xxh3_64bits(ArrayRef<uint8_t> Data) {
+  const uint8_t *P = Data.data();
+  size_t Len = Data.size();
+  if (Len <= 16)
+    return hashLen0To16(P, Len);
+  if (Len <= 128)
+    return hashLen17To128(P, Len);
+  if (Len <= MidSizeMax)
+    return hashLen129To240(P, Len);
+  return hashLong(P, Len);
+}
+
+uint64_t llvm::xxh3_64bits(StringRef Data) {
+  return xxh3_64bits(makeArrayRef(Data.bytes_begin(), Data.size()));
+}
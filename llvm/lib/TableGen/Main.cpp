@@ -16,16 +16,20 @@
 
 #include "llvm/TableGen/Main.h"
 #include "TGParser.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/TableGen/Error.h"
 #include "llvm/TableGen/Record.h"
 #include <algorithm>
 #include <cstdio>
 #include <system_error>
+#include <vector>
 using namespace llvm;
 
 static cl::opt<std::string>
@@ -59,7 +63,8 @@ static int reportError(const char *ProgName, Twine Msg) {
 ///
 /// This functionality is really only for the benefit of the build system.
 /// It is similar to GCC's `-M*` family of options.
-static int createDependencyFile(const TGParser &Parser, const char *argv0) {
+static int createDependencyFile(const TGParser &Parser, const char *argv0,
+                                ArrayRef<TableGenOutput> ExtraOutputs) {
   if (OutputFilename == "-")
     return reportError(argv0, "the option -d must be used together with -o\n");
 
@@ -68,7 +73,10 @@ static int createDependencyFile(const TGParser &Parser, const char *argv0) {
   if (EC)
     return reportError(argv0, "error opening " + DependFilename + ":" +
                                   EC.message() + "\n");
-  DepOut.os() << OutputFilename << ":";
+  DepOut.os() << OutputFilename;
+  for (const TableGenOutput &Output : ExtraOutputs)
+    DepOut.os() << ' ' << Output.Filename;
+  DepOut.os() << ":";
   for (const auto &Dep : Parser.getDependencies()) {
     DepOut.os() << ' ' << Dep.first;
   }
@@ -77,7 +85,38 @@ static int createDependencyFile(const TGParser &Parser, const char *argv0) {
   return 0;
 }
 
+/// Write \p Contents to \p Filename.
+static int writeOutputFile(const char *argv0, StringRef Filename,
+                           StringRef Contents) {
+  // Only updates the real output file if there are any differences.
+  // This prevents recompilation of all the files depending on it if there
+  // aren't any.
+  if (auto ExistingOrErr = MemoryBuffer::getFile(Filename))
+    if (std::move(ExistingOrErr.get())->getBuffer() == Contents)
+      return 0;
+
+  std::error_code EC;
+  ToolOutputFile OutFile(Filename, EC, sys::fs::F_Text);
+  if (EC)
+    return reportError(argv0, "error opening " + Filename + ":" +
+                                  EC.message() + "\n");
+  OutFile.os() << Contents;
+
+  if (ErrorsPrinted > 0)
+    return reportError(argv0, Twine(ErrorsPrinted) + " errors.\n");
+
+  // Declare success.
+  OutFile.keep();
+  return 0;
+}
+
 int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn) {
+  return TableGenMain(argv0, MainFn, None, 1);
+}
+
+int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn,
+                       ArrayRef<TableGenOutput> ExtraOutputs,
+                       unsigned Threads) {
   RecordKeeper Records;
 
   // Parse the input file.
@@ -99,10 +138,29 @@ int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn) {
   if (Parser.ParseFile())
     return 1;
 
-  // Write output to memory.
-  std::string OutString;
-  raw_string_ostream Out(OutString);
-  if (MainFn(Out, Records))
+  // Write output to memory. Outputs[0] is the one for -o.
+  std::vector<std::string> Outputs(ExtraOutputs.size() + 1);
+  std::vector<char> Failed(Outputs.size());
+  auto Emit = [&](size_t I) {
+    raw_string_ostream Out(Outputs[I]);
+    Failed[I] = I == 0 ? MainFn(Out, Records)
+                       : ExtraOutputs[I - 1].MainFn(Out, Records);
+    Out.flush();
+  };
+  if (Threads == 0)
+    Threads = hardware_concurrency();
+  if (Threads <= 1 || ExtraOutputs.empty()) {
+    for (size_t I = 0, E = Outputs.size(); I != E; ++I)
+      Emit(I);
+  } else {
+    setConcurrentRecordAccess(true);
+    ThreadPool Pool(std::min<size_t>(Threads, Outputs.size()));
+    for (size_t I = 0, E = Outputs.size(); I != E; ++I)
+      Pool.async(Emit, I);
+    Pool.wait();
+    setConcurrentRecordAccess(false);
+  }
+  if (llvm::is_contained(Failed, true))
     return 1;
 
   // Always write the depfile, even if the main output hasn't changed.
@@ -110,28 +168,15 @@ int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn) {
   // the early exit below and someone deleted the .inc.d file but not the .inc
   // file, tablegen would never write the depfile.
   if (!DependFilename.empty()) {
-    if (int Ret = createDependencyFile(Parser, argv0))
+    if (int Ret = createDependencyFile(Parser, argv0, ExtraOutputs))
       return Ret;
   }
 
-  // Only updates the real output file if there are any differences.
-  // This prevents recompilation of all the files depending on it if there
-  // aren't any.
-  if (auto ExistingOrErr = MemoryBuffer::getFile(OutputFilename))
-    if (std::move(ExistingOrErr.get())->getBuffer() == Out.str())
-      return 0;
-
-  std::error_code EC;
-  ToolOutputFile OutFile(OutputFilename, EC, sys::fs::F_Text);
-  if (EC)
-    return reportError(argv0, "error opening " + OutputFilename + ":" +
-                                  EC.message() + "\n");
-  OutFile.os() << Out.str();
-
-  if (ErrorsPrinted > 0)
-    return reportError(argv0, Twine(ErrorsPrinted) + " errors.\n");
-
-  // Declare success.
-  OutFile.keep();
+  if (int Ret = writeOutputFile(argv0, OutputFilename, Outputs[0]))
+    return Ret;
+  for (size_t I = 0, E = ExtraOutputs.size(); I != E; ++I)
+    if (int Ret =
+            writeOutputFile(argv0, ExtraOutputs[I].Filename, Outputs[I + 1]))
+      return Ret;
   return 0;
 }
@@ -33,6 +33,7 @@
 #include <cstdint>
 #include <memory>
 #include <map>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -43,6 +44,32 @@ using namespace llvm;
 
 static BumpPtrAllocator Allocator;
 
+/// Set while several backends read the same records at once. The uniquing
+/// pools below, the types and DefInits created on demand and Allocator are
+/// then only used under PoolMutex; parsing is single-threaded and does not
+/// pay for the locking.
+static bool ConcurrentAccess = false;
+static std::recursive_mutex PoolMutex;
+
+namespace {
+/// Locks PoolMutex while the records may be accessed from several threads.
+class PoolLock {
+  bool Locked;
+
+public:
+  PoolLock() : Locked(ConcurrentAccess) {
+    if (Locked)
+      PoolMutex.lock();
+  }
+  ~PoolLock() {
+    if (Locked)
+      PoolMutex.unlock();
+  }
+};
+} // end anonymous namespace
+
+void llvm::setConcurrentRecordAccess(bool Enable) { ConcurrentAccess = Enable; }
+
 STATISTIC(CodeInitsConstructed,
           "The total number of unique CodeInits constructed");
 
@@ -61,6 +88,7 @@ LLVM_DUMP_METHOD void RecTy::dump() const { print(errs()); }
 #endif
 
 ListRecTy *RecTy::getListTy() {
+  PoolLock Lock;
   if (!ListTy)
     ListTy = new(Allocator) ListRecTy(this);
   return ListTy;
@@ -82,6 +110,7 @@ bool BitRecTy::typeIsConvertibleTo(const RecTy *RHS) const{
 }
 
 BitsRecTy *BitsRecTy::get(unsigned Sz) {
+  PoolLock Lock;
   static std::vector<BitsRecTy*> Shared;
   if (Sz >= Shared.size())
     Shared.resize(Sz + 1);
@@ -160,6 +189,7 @@ RecordRecTy *RecordRecTy::get(ArrayRef<Record *> UnsortedClasses) {
     return &AnyRecord;
   }
 
+  PoolLock Lock;
   FoldingSet<RecordRecTy> &ThePool =
       UnsortedClasses[0]->getRecords().RecordTypePool;
 
@@ -340,6 +370,7 @@ ProfileBitsInit(FoldingSetNodeID &ID, ArrayRef<Init *> Range) {
 }
 
 BitsInit *BitsInit::get(ArrayRef<Init *> Range) {
+  PoolLock Lock;
   static FoldingSet<BitsInit> ThePool;
 
   FoldingSetNodeID ID;
@@ -458,6 +489,7 @@ Init *BitsInit::resolveReferences(Resolver &R) const {
 }
 
 IntInit *IntInit::get(int64_t V) {
+  PoolLock Lock;
   static std::map<int64_t, IntInit*> ThePool;
 
   IntInit *&I = ThePool[V];
@@ -515,6 +547,7 @@ IntInit::convertInitializerBitRange(ArrayRef<unsigned> Bits) const {
 }
 
 CodeInit *CodeInit::get(StringRef V, const SMLoc &Loc) {
+  PoolLock Lock;
   static StringSet<BumpPtrAllocator &> ThePool(Allocator);
 
   CodeInitsConstructed++;
@@ -531,6 +564,7 @@ CodeInit *CodeInit::get(StringRef V, const SMLoc &Loc) {
 }
 
 StringInit *StringInit::get(StringRef V) {
+  PoolLock Lock;
   static StringMap<StringInit*, BumpPtrAllocator &> ThePool(Allocator);
 
   auto &Entry = *ThePool.insert(std::make_pair(V, nullptr)).first;
@@ -568,6 +602,7 @@ static void ProfileListInit(FoldingSetNodeID &ID,
 }
 
 ListInit *ListInit::get(ArrayRef<Init *> Range, RecTy *EltTy) {
+  PoolLock Lock;
   static FoldingSet<ListInit> ThePool;
 
   FoldingSetNodeID ID;
@@ -691,6 +726,7 @@ ProfileUnOpInit(FoldingSetNodeID &ID, unsigned Opcode, Init *Op, RecTy *Type) {
 }
 
 UnOpInit *UnOpInit::get(UnaryOp Opc, Init *LHS, RecTy *Type) {
+  PoolLock Lock;
   static FoldingSet<UnOpInit> ThePool;
 
   FoldingSetNodeID ID;
@@ -824,6 +860,7 @@ ProfileBinOpInit(FoldingSetNodeID &ID, unsigned Opcode, Init *LHS, Init *RHS,
 
 BinOpInit *BinOpInit::get(BinaryOp Opc, Init *LHS,
                           Init *RHS, RecTy *Type) {
+  PoolLock Lock;
   static FoldingSet<BinOpInit> ThePool;
 
   FoldingSetNodeID ID;
@@ -1053,6 +1090,7 @@ ProfileTernOpInit(FoldingSetNodeID &ID, unsigned Opcode, Init *LHS, Init *MHS,
 
 TernOpInit *TernOpInit::get(TernaryOp Opc, Init *LHS, Init *MHS, Init *RHS,
                             RecTy *Type) {
+  PoolLock Lock;
   static FoldingSet<TernOpInit> ThePool;
 
   FoldingSetNodeID ID;
@@ -1271,6 +1309,7 @@ static void ProfileFoldOpInit(FoldingSetNodeID &ID, Init *A, Init *B,
 
 FoldOpInit *FoldOpInit::get(Init *Start, Init *List, Init *A, Init *B,
                             Init *Expr, RecTy *Type) {
+  PoolLock Lock;
   static FoldingSet<FoldOpInit> ThePool;
 
   FoldingSetNodeID ID;
@@ -1336,6 +1375,7 @@ static void ProfileIsAOpInit(FoldingSetNodeID &ID, RecTy *CheckType,
 }
 
 IsAOpInit *IsAOpInit::get(RecTy *CheckType, Init *Expr) {
+  PoolLock Lock;
   static FoldingSet<IsAOpInit> ThePool;
 
   FoldingSetNodeID ID;
@@ -1470,6 +1510,7 @@ VarInit *VarInit::get(StringRef VN, RecTy *T) {
 
 VarInit *VarInit::get(Init *VN, RecTy *T) {
   using Key = std::pair<RecTy *, Init *>;
+  PoolLock Lock;
   static DenseMap<Key, VarInit*> ThePool;
 
   Key TheKey(std::make_pair(T, VN));
@@ -1499,6 +1540,7 @@ Init *VarInit::resolveReferences(Resolver &R) const {
 
 VarBitInit *VarBitInit::get(TypedInit *T, unsigned B) {
   using Key = std::pair<TypedInit *, unsigned>;
+  PoolLock Lock;
   static DenseMap<Key, VarBitInit*> ThePool;
 
   Key TheKey(std::make_pair(T, B));
@@ -1524,6 +1566,7 @@ Init *VarBitInit::resolveReferences(Resolver &R) const {
 VarListElementInit *VarListElementInit::get(TypedInit *T,
                                             unsigned E) {
   using Key = std::pair<TypedInit *, unsigned>;
+  PoolLock Lock;
   static DenseMap<Key, VarListElementInit*> ThePool;
 
   Key TheKey(std::make_pair(T, E));
@@ -1591,6 +1634,7 @@ static void ProfileVarDefInit(FoldingSetNodeID &ID,
 }
 
 VarDefInit *VarDefInit::get(Record *Class, ArrayRef<Init *> Args) {
+  PoolLock Lock;
   static FoldingSet<VarDefInit> ThePool;
 
   FoldingSetNodeID ID;
@@ -1706,6 +1750,7 @@ std::string VarDefInit::getAsString() const {
 
 FieldInit *FieldInit::get(Init *R, StringInit *FN) {
   using Key = std::pair<Init *, StringInit *>;
+  PoolLock Lock;
   static DenseMap<Key, FieldInit*> ThePool;
 
   Key TheKey(std::make_pair(R, FN));
@@ -1772,6 +1817,7 @@ CondOpInit::get(ArrayRef<Init *> CondRange,
   assert(CondRange.size() == ValRange.size() &&
          "Number of conditions and values must match!");
 
+  PoolLock Lock;
   static FoldingSet<CondOpInit> ThePool;
   FoldingSetNodeID ID;
   ProfileCondOpInit(ID, CondRange, ValRange, Ty);
@@ -1893,6 +1939,7 @@ static void ProfileDagInit(FoldingSetNodeID &ID, Init *V, StringInit *VN,
 DagInit *
 DagInit::get(Init *V, StringInit *VN, ArrayRef<Init *> ArgRange,
              ArrayRef<StringInit *> NameRange) {
+  PoolLock Lock;
   static FoldingSet<DagInit> ThePool;
 
   FoldingSetNodeID ID;
@@ -2022,7 +2069,7 @@ void RecordVal::print(raw_ostream &OS, bool PrintSem) const {
   if (PrintSem) OS << ";\n";
 }
 
-unsigned Record::LastID = 0;
+std::atomic<unsigned> Record::LastID(0);
 
 void Record::checkName() {
   // Ensure the record name has string type.
@@ -2039,6 +2086,7 @@ RecordRecTy *Record::getType() {
 }
 
 DefInit *Record::getDefInit() {
+  PoolLock Lock;
   if (!TheInit)
     TheInit = new(Allocator) DefInit(this);
   return TheInit;
@@ -2077,6 +2125,10 @@ void Record::resolveReferences(Resolver &R, const RecordVal *SkipVal) {
       continue;
     if (Init *V = Value.getValue()) {
       Init *VR = V->resolveReferences(R);
+      // Most values do not reference anything that changes. They were cast
+      // to the type of the field when they were set, so leave them alone.
+      if (VR == V)
+        continue;
       if (Value.setValue(VR)) {
         std::string Type;
         if (TypedInit *VRT = dyn_cast<TypedInit>(VR))
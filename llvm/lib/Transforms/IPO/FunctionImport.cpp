@@ -35,14 +35,20 @@
 #include "llvm/Object/ModuleSymbolTable.h"
 #include "llvm/Object/SymbolicFile.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/BinaryStreamReader.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
 #include "llvm/Transforms/IPO/Internalize.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
@@ -67,6 +73,10 @@ STATISTIC(NumImportedCriticalFunctionsThinLink,
           "Number of critical functions thin link decided to import");
 STATISTIC(NumImportedGlobalVarsThinLink,
           "Number of global variables thin link decided to import");
+STATISTIC(NumImportsOverBudgetThinLink,
+          "Number of function imports dropped to honor -import-global-budget");
+STATISTIC(NumReusedImportListsThinLink,
+          "Number of import lists reused from the previous thin link");
 STATISTIC(NumImportedFunctions, "Number of functions imported in backend");
 STATISTIC(NumImportedGlobalVars,
           "Number of global variables imported in backend");
@@ -112,6 +122,17 @@ static cl::opt<float> ImportColdMultiplier(
     "import-cold-multiplier", cl::init(0), cl::Hidden, cl::value_desc("N"),
     cl::desc("Multiply the `import-instr-limit` threshold for cold callsites"));
 
+static cl::opt<unsigned> ImportThreads(
+    "import-threads", cl::init(0), cl::Hidden, cl::value_desc("N"),
+    cl::desc("Compute the imports of N modules at once in the thin link "
+             "(default 0 = hardware concurrency)"));
+
+static cl::opt<unsigned long long> ImportGlobalBudget(
+    "import-global-budget", cl::init(0), cl::Hidden, cl::value_desc("N"),
+    cl::desc("Import at most N instructions in total into all modules of the "
+             "thin link, preferring imports along hot call chains "
+             "(default 0 = unlimited)"));
+
 static cl::opt<bool> PrintImports("print-imports", cl::init(false), cl::Hidden,
                                   cl::desc("Print imported functions"));
 
@@ -282,13 +303,16 @@ updateValueInfoForIndirectCalls(const ModuleSummaryIndex &Index, ValueInfo VI) {
 static void computeImportForReferencedGlobals(
     const FunctionSummary &Summary, const GVSummaryMapTy &DefinedGVSummaries,
     FunctionImporter::ImportMapTy &ImportList,
-    StringMap<FunctionImporter::ExportSetTy> *ExportLists) {
+    StringMap<FunctionImporter::ExportSetTy> *ExportLists,
+    DenseSet<GlobalValue::GUID> *Consulted) {
   for (auto &VI : Summary.refs()) {
     if (DefinedGVSummaries.count(VI.getGUID())) {
       LLVM_DEBUG(
           dbgs() << "Ref ignored! Target already in destination module.\n");
       continue;
     }
+    if (Consulted)
+      Consulted->insert(VI.getGUID());
 
     LLVM_DEBUG(dbgs() << " ref -> " << VI << "\n");
 
@@ -343,16 +367,20 @@ getFailureName(FunctionImporter::ImportFailureReason Reason) {
 
 /// Compute the list of functions to import for a given caller. Mark these
 /// imported functions and the symbols they reference in their source module as
-/// exported from their source module.
+/// exported from their source module. If \p Consulted is set, record in it the
+/// GUIDs of all summaries that the decisions depended on.
 static void computeImportForFunction(
     const FunctionSummary &Summary, const ModuleSummaryIndex &Index,
     const unsigned Threshold, const GVSummaryMapTy &DefinedGVSummaries,
     SmallVectorImpl<EdgeInfo> &Worklist,
     FunctionImporter::ImportMapTy &ImportList,
     StringMap<FunctionImporter::ExportSetTy> *ExportLists,
-    FunctionImporter::ImportThresholdsTy &ImportThresholds) {
+    FunctionImporter::ImportThresholdsTy &ImportThresholds,
+    DenseSet<GlobalValue::GUID> *Consulted) {
   computeImportForReferencedGlobals(Summary, DefinedGVSummaries, ImportList,
-                                    ExportLists);
+                                    ExportLists, Consulted);
+  // Only maintained when -import-cutoff is used, which forces imports to be
+  // computed on a single thread.
   static int ImportCount = 0;
   for (auto &Edge : Summary.calls()) {
     ValueInfo VI = Edge.first;
@@ -365,6 +393,8 @@ static void computeImportForFunction(
       continue;
     }
 
+    if (Consulted)
+      Consulted->insert(VI.getGUID());
     VI = updateValueInfoForIndirectCalls(Index, VI);
     if (!VI)
       continue;
@@ -373,6 +403,8 @@ static void computeImportForFunction(
       LLVM_DEBUG(dbgs() << "ignored! Target already in destination module.\n");
       continue;
     }
+    if (Consulted)
+      Consulted->insert(VI.getGUID());
 
     auto GetBonusMultiplier = [](CalleeInfo::HotnessType Hotness) -> float {
       if (Hotness == CalleeInfo::HotnessType::Hot)
@@ -512,7 +544,8 @@ static void computeImportForFunction(
 
     const auto AdjThreshold = GetAdjustedThreshold(Threshold, IsHotCallsite);
 
-    ImportCount++;
+    if (ImportCutoff >= 0)
+      ImportCount++;
 
     // Insert the newly imported function to the worklist.
     Worklist.emplace_back(ResolvedCalleeSummary, AdjThreshold, VI.getGUID());
@@ -521,11 +554,16 @@ static void computeImportForFunction(
 
 /// Given the list of globals defined in a module, compute the list of imports
 /// as well as the list of "exports", i.e. the list of symbols referenced from
-/// another module (that may require promotion).
+/// another module (that may require promotion). If \p ThresholdsOut is set,
+/// it receives the thresholds and summaries of all callees considered. If
+/// \p Consulted is set, it receives the GUIDs the result depends on besides
+/// those defined in the module.
 static void ComputeImportForModule(
     const GVSummaryMapTy &DefinedGVSummaries, const ModuleSummaryIndex &Index,
     StringRef ModName, FunctionImporter::ImportMapTy &ImportList,
-    StringMap<FunctionImporter::ExportSetTy> *ExportLists = nullptr) {
+    StringMap<FunctionImporter::ExportSetTy> *ExportLists = nullptr,
+    FunctionImporter::ImportThresholdsTy *ThresholdsOut = nullptr,
+    DenseSet<GlobalValue::GUID> *Consulted = nullptr) {
   // Worklist contains the list of function imported in this module, for which
   // we will analyse the callees and may import further down the callgraph.
   SmallVector<EdgeInfo, 128> Worklist;
@@ -551,7 +589,7 @@ static void ComputeImportForModule(
     LLVM_DEBUG(dbgs() << "Initialize import for " << VI << "\n");
     computeImportForFunction(*FuncSummary, Index, ImportInstrLimit,
                              DefinedGVSummaries, Worklist, ImportList,
-                             ExportLists, ImportThresholds);
+                             ExportLists, ImportThresholds, Consulted);
   }
 
   // Process the newly imported functions and add callees to the worklist.
@@ -562,7 +600,7 @@ static void ComputeImportForModule(
 
     computeImportForFunction(*Summary, Index, Threshold, DefinedGVSummaries,
                              Worklist, ImportList, ExportLists,
-                             ImportThresholds);
+                             ImportThresholds, Consulted);
   }
 
   // Print stats about functions considered but rejected for importing
@@ -588,6 +626,9 @@ static void ComputeImportForModule(
              << ", Attempts = " << FailureInfo->Attempts << "\n";
     }
   }
+
+  if (ThresholdsOut)
+    *ThresholdsOut = std::move(ImportThresholds);
 }
 
 #ifndef NDEBUG
@@ -614,20 +655,291 @@ static unsigned numGlobalVarSummaries(const ModuleSummaryIndex &Index,
 }
 #endif
 
+// Imports are computed for each module independently, only reading the Index,
+// so they can be computed in parallel unless the output would interleave or
+// -import-cutoff needs a global order.
+static unsigned getImportThreads() {
+  if (ImportCutoff >= 0 || PrintImportFailures)
+    return 1;
+#ifndef NDEBUG
+  if (DebugFlag)
+    return 1;
+#endif
+  return ImportThreads ? ImportThreads : hardware_concurrency();
+}
+
+namespace {
+/// A function import into a module that -import-global-budget may drop.
+struct ImportCandidate {
+  unsigned Threshold;
+  unsigned InstCount;
+  StringRef ModName;
+  GlobalValue::GUID GUID;
+  const FunctionSummary *Summary;
+};
+} // anonymous namespace
+
+/// Trims \p ImportLists so that at most ImportGlobalBudget instructions are
+/// imported in total, and computes \p ExportLists from the imports that are
+/// left. The threshold a callee was considered with grows with the hotness of
+/// the call chain that reaches it, so imports are kept in order of decreasing
+/// threshold, and then of increasing size.
+static void applyGlobalImportBudget(
+    ArrayRef<StringRef> ModNames,
+    ArrayRef<FunctionImporter::ImportThresholdsTy> Thresholds,
+    StringMap<FunctionImporter::ImportMapTy> &ImportLists,
+    StringMap<FunctionImporter::ExportSetTy> &ExportLists) {
+  std::vector<ImportCandidate> Candidates;
+  for (unsigned I = 0, E = ModNames.size(); I != E; ++I)
+    for (auto &T : Thresholds[I])
+      if (const GlobalValueSummary *S = std::get<1>(T.second)) {
+        auto *FS = cast<FunctionSummary>(S);
+        Candidates.push_back(
+            {std::get<0>(T.second), FS->instCount(), ModNames[I], T.first, FS});
+      }
+  llvm::sort(Candidates,
+             [](const ImportCandidate &A, const ImportCandidate &B) {
+               if (A.Threshold != B.Threshold)
+                 return A.Threshold > B.Threshold;
+               return std::tie(A.InstCount, A.ModName, A.GUID) <
+                      std::tie(B.InstCount, B.ModName, B.GUID);
+             });
+
+  uint64_t Used = 0;
+  for (const ImportCandidate &C : Candidates) {
+    if (Used + C.InstCount <= ImportGlobalBudget) {
+      Used += C.InstCount;
+      continue;
+    }
+    FunctionImporter::ImportMapTy &ImportList = ImportLists[C.ModName];
+    auto It = ImportList.find(C.Summary->modulePath());
+    It->second.erase(C.GUID);
+    if (It->second.empty())
+      ImportList.erase(It);
+    NumImportsOverBudgetThinLink++;
+  }
+
+  // Export everything that is still imported and, for functions, everything
+  // they reference, exactly like computeImportForFunction does.
+  for (unsigned I = 0, E = ModNames.size(); I != E; ++I) {
+    for (auto &Src : ImportLists[ModNames[I]]) {
+      FunctionImporter::ExportSetTy &ExportList = ExportLists[Src.first()];
+      for (GlobalValue::GUID GUID : Src.second) {
+        ExportList.insert(GUID);
+        auto T = Thresholds[I].find(GUID);
+        if (T == Thresholds[I].end() || !std::get<1>(T->second))
+          continue;
+        auto *FS = cast<FunctionSummary>(std::get<1>(T->second));
+        for (auto &Edge : FS->calls())
+          ExportList.insert(Edge.first.getGUID());
+        for (auto &Ref : FS->refs())
+          ExportList.insert(Ref.getGUID());
+      }
+    }
+  }
+}
+
+/// Adds to \p ExportLists what importing \p ImportList requires the source
+/// modules to export, like computeImportForFunction does.
+static void
+addExportsForImportList(const ModuleSummaryIndex &Index,
+                        const FunctionImporter::ImportMapTy &ImportList,
+                        StringMap<FunctionImporter::ExportSetTy> &ExportLists) {
+  for (auto &Src : ImportList) {
+    FunctionImporter::ExportSetTy &ExportList = ExportLists[Src.first()];
+    for (GlobalValue::GUID GUID : Src.second) {
+      ExportList.insert(GUID);
+      GlobalValueSummary *S = Index.findSummaryInModule(GUID, Src.first());
+      auto *FS = S ? dyn_cast<FunctionSummary>(S->getBaseObject()) : nullptr;
+      if (!FS)
+        continue;
+      for (auto &Edge : FS->calls())
+        ExportList.insert(Edge.first.getGUID());
+      for (auto &Ref : FS->refs())
+        ExportList.insert(Ref.getGUID());
+    }
+  }
+}
+
+/// Returns a hash of the options that affect the import lists.
+static uint64_t getImportOptionsHash(const ModuleSummaryIndex &Index) {
+  SmallString<128> Options;
+  raw_svector_ostream OS(Options);
+  OS << ImportInstrLimit << ' ' << ImportInstrFactor << ' '
+     << ImportHotInstrFactor << ' ' << ImportHotMultiplier << ' '
+     << ImportCriticalMultiplier << ' ' << ImportColdMultiplier << ' '
+     << ImportCutoff << ' ' << ImportGlobalBudget << ' '
+     << Index.withGlobalValueDeadStripping();
+  return xxHash64(Options);
+}
+
+/// Returns the digest of the summaries of \p ModPath (see ThinLinkImportState)
+/// and collects the GUIDs it defines into \p Defined.
+static uint64_t getModuleDigest(const ModuleSummaryIndex &Index,
+                                StringRef ModPath,
+                                const GVSummaryMapTy &DefinedGVSummaries,
+                                std::vector<GlobalValue::GUID> &Defined) {
+  for (auto &GVSummary : DefinedGVSummaries) {
+    Defined.push_back(GVSummary.first);
+    if (GlobalValue::GUID OriginalName = GVSummary.second->getOriginalName())
+      Defined.push_back(OriginalName);
+  }
+  llvm::sort(Defined);
+  Defined.erase(std::unique(Defined.begin(), Defined.end()), Defined.end());
+
+  auto It = Index.modulePaths().find(ModPath);
+  if (It == Index.modulePaths().end())
+    return 0;
+  const ModuleHash &Hash = It->second.second;
+  if (llvm::all_of(Hash, [](uint32_t W) { return W == 0; }))
+    return 0;
+
+  std::vector<std::pair<GlobalValue::GUID, const GlobalValueSummary *>>
+      Summaries(DefinedGVSummaries.begin(), DefinedGVSummaries.end());
+  llvm::sort(Summaries, less_first());
+  SmallVector<uint64_t, 64> Words(Hash.begin(), Hash.end());
+  for (auto &GVSummary : Summaries) {
+    const GlobalValueSummary *S = GVSummary.second;
+    uint64_t Flags = S->linkage() | S->notEligibleToImport() << 8 |
+                     S->isLive() << 9 | S->isDSOLocal() << 10 |
+                     S->canAutoHide() << 11;
+    if (auto *GVS = dyn_cast<GlobalVarSummary>(S))
+      Flags |= uint64_t(GVS->varflags().ReadOnly) << 12;
+    Words.push_back(GVSummary.first);
+    Words.push_back(Flags);
+  }
+  uint64_t Digest = xxHash64(StringRef(
+      reinterpret_cast<const char *>(Words.data()), Words.size() * 8));
+  return Digest ? Digest : 1;
+}
+
 /// Compute all the import and export for every module using the Index.
 void llvm::ComputeCrossModuleImport(
     const ModuleSummaryIndex &Index,
     const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
     StringMap<FunctionImporter::ImportMapTy> &ImportLists,
-    StringMap<FunctionImporter::ExportSetTy> &ExportLists) {
+    StringMap<FunctionImporter::ExportSetTy> &ExportLists,
+    ThinLinkImportState *State) {
+  // Create the entries of ImportLists up front so that the workers below only
+  // touch their own entry.
+  std::vector<StringRef> ModNames;
+  std::vector<const GVSummaryMapTy *> DefinedGVSummaries;
+  std::vector<FunctionImporter::ImportMapTy *> ModImportLists;
+  for (auto &DefinedGVSummary : ModuleToDefinedGVSummaries) {
+    ModNames.push_back(DefinedGVSummary.first());
+    DefinedGVSummaries.push_back(&DefinedGVSummary.second);
+    ModImportLists.push_back(&ImportLists[DefinedGVSummary.first()]);
+  }
+
+  unsigned NumThreads = std::min<size_t>(getImportThreads(), ModNames.size());
+  auto ForEachModule = [&](std::function<void(unsigned)> Fn) {
+    if (NumThreads <= 1) {
+      for (unsigned I = 0, E = ModNames.size(); I != E; ++I)
+        Fn(I);
+      return;
+    }
+    ThreadPool Pool(NumThreads);
+    for (unsigned I = 0, E = ModNames.size(); I != E; ++I)
+      Pool.async(Fn, I);
+    Pool.wait();
+  };
+
+  // With a previous state, find the modules whose import lists can be reused.
+  // The budget and the cutoff depend on all modules, so they prevent reuse.
+  bool UseBudget = ImportGlobalBudget != 0;
+  std::vector<uint64_t> Digests;
+  std::vector<std::vector<GlobalValue::GUID>> Defined;
+  std::vector<std::vector<GlobalValue::GUID>> Consulted;
+  std::vector<ThinLinkImportState::ModuleState *> Reused(ModNames.size());
+  if (State) {
+    Digests.resize(ModNames.size());
+    Defined.resize(ModNames.size());
+    Consulted.resize(ModNames.size());
+    ForEachModule([&](unsigned I) {
+      Digests[I] = getModuleDigest(Index, ModNames[I], *DefinedGVSummaries[I],
+                                   Defined[I]);
+    });
+
+    uint64_t OptionsHash = getImportOptionsHash(Index);
+    if (State->OptionsHash != OptionsHash || UseBudget || ImportCutoff >= 0)
+      State->Modules.clear();
+    State->OptionsHash = OptionsHash;
+
+    // Collect the GUIDs defined, before or after, by the changed modules.
+    DenseSet<GlobalValue::GUID> ChangedGUIDs;
+    StringSet<> Current;
+    for (unsigned I = 0, E = ModNames.size(); I != E; ++I) {
+      Current.insert(ModNames[I]);
+      auto Prev = State->Modules.find(ModNames[I]);
+      if (Prev != State->Modules.end() && Digests[I] &&
+          Prev->second.Digest == Digests[I]) {
+        Reused[I] = &Prev->second;
+        continue;
+      }
+      ChangedGUIDs.insert(Defined[I].begin(), Defined[I].end());
+      if (Prev != State->Modules.end())
+        ChangedGUIDs.insert(Prev->second.Defined.begin(),
+                            Prev->second.Defined.end());
+    }
+    for (auto &Prev : State->Modules)
+      if (!Current.count(Prev.first()))
+        ChangedGUIDs.insert(Prev.second.Defined.begin(),
+                            Prev.second.Defined.end());
+
+    for (ThinLinkImportState::ModuleState *&Prev : Reused)
+      if (Prev && llvm::any_of(Prev->Consulted, [&](GlobalValue::GUID G) {
+            return ChangedGUIDs.count(G);
+          }))
+        Prev = nullptr;
+  }
+
   // For each module that has function defined, compute the import/export lists.
-  for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries) {
-    auto &ImportList = ImportLists[DefinedGVSummaries.first()];
-    LLVM_DEBUG(dbgs() << "Computing import for Module '"
-                      << DefinedGVSummaries.first() << "'\n");
-    ComputeImportForModule(DefinedGVSummaries.second, Index,
-                           DefinedGVSummaries.first(), ImportList,
-                           &ExportLists);
+  // Each module gets its own export lists, which are merged afterwards; set
+  // union doesn't depend on the order in which the modules finished. With a
+  // global budget, the export lists are computed once the imports are final.
+  std::vector<StringMap<FunctionImporter::ExportSetTy>> ModExportLists(
+      UseBudget ? 0 : ModNames.size());
+  std::vector<FunctionImporter::ImportThresholdsTy> Thresholds(
+      UseBudget ? ModNames.size() : 0);
+  ForEachModule([&](unsigned I) {
+    if (Reused[I]) {
+      NumReusedImportListsThinLink++;
+      *ModImportLists[I] = std::move(Reused[I]->ImportList);
+      Consulted[I] = std::move(Reused[I]->Consulted);
+      addExportsForImportList(Index, *ModImportLists[I], ModExportLists[I]);
+      return;
+    }
+    LLVM_DEBUG(dbgs() << "Computing import for Module '" << ModNames[I]
+                      << "'\n");
+    DenseSet<GlobalValue::GUID> ModConsulted;
+    ComputeImportForModule(*DefinedGVSummaries[I], Index, ModNames[I],
+                           *ModImportLists[I],
+                           UseBudget ? nullptr : &ModExportLists[I],
+                           UseBudget ? &Thresholds[I] : nullptr,
+                           State ? &ModConsulted : nullptr);
+    if (State) {
+      Consulted[I].assign(ModConsulted.begin(), ModConsulted.end());
+      llvm::sort(Consulted[I]);
+    }
+  });
+
+  if (UseBudget) {
+    applyGlobalImportBudget(ModNames, Thresholds, ImportLists, ExportLists);
+  } else {
+    for (StringMap<FunctionImporter::ExportSetTy> &ModExports : ModExportLists)
+      for (auto &ELI : ModExports)
+        ExportLists[ELI.first()].insert(ELI.second.begin(), ELI.second.end());
+  }
+
+  if (State) {
+    State->Modules.clear();
+    for (unsigned I = 0, E = ModNames.size(); I != E; ++I) {
+      ThinLinkImportState::ModuleState &MS = State->Modules[ModNames[I]];
+      MS.Digest = Digests[I];
+      MS.Defined = std::move(Defined[I]);
+      MS.Consulted = std::move(Consulted[I]);
+      MS.ImportList = *ModImportLists[I];
+    }
   }
 
   // When computing imports we added all GUIDs referenced by anything
@@ -669,6 +981,157 @@ void llvm::ComputeCrossModuleImport(
 #endif
 }
 
+// The state file starts with this magic and version, followed by the options
+// hash and the modules. Strings are stored as their length followed by their
+// bytes, and GUID lists as their length followed by the GUIDs. All integers
+// are little-endian.
+static const char ThinLinkImportStateMagic[] = {'T', 'L', 'I', 'S'};
+static const uint32_t ThinLinkImportStateVersion = 1;
+
+static Error readString(BinaryStreamReader &R, StringRef &S) {
+  uint32_t Size;
+  if (Error E = R.readInteger(Size))
+    return E;
+  return R.readFixedString(S, Size);
+}
+
+static Error readGUIDs(BinaryStreamReader &R,
+                       std::vector<GlobalValue::GUID> &GUIDs) {
+  uint32_t Size;
+  if (Error E = R.readInteger(Size))
+    return E;
+  ArrayRef<support::ulittle64_t> Array;
+  if (Error E = R.readArray(Array, Size))
+    return E;
+  GUIDs.assign(Array.begin(), Array.end());
+  return Error::success();
+}
+
+static Error readThinLinkImportState(StringRef Buf,
+                                     ThinLinkImportState &State) {
+  BinaryStreamReader R(Buf, support::little);
+  StringRef Magic;
+  uint32_t Version, NumModules;
+  if (Error E = R.readFixedString(Magic, sizeof(ThinLinkImportStateMagic)))
+    return E;
+  if (Magic != StringRef(ThinLinkImportStateMagic,
+                         sizeof(ThinLinkImportStateMagic)))
+    return make_error<StringError>("not a thin link import state file",
+                                   inconvertibleErrorCode());
+  if (Error E = R.readInteger(Version))
+    return E;
+  if (Version != ThinLinkImportStateVersion)
+    return make_error<StringError>("unsupported thin link import state version",
+                                   inconvertibleErrorCode());
+  if (Error E = R.readInteger(State.OptionsHash))
+    return E;
+  if (Error E = R.readInteger(NumModules))
+    return E;
+
+  for (uint32_t I = 0; I != NumModules; ++I) {
+    StringRef ModName;
+    if (Error E = readString(R, ModName))
+      return E;
+    ThinLinkImportState::ModuleState &MS = State.Modules[ModName];
+    if (Error E = R.readInteger(MS.Digest))
+      return E;
+    if (Error E = readGUIDs(R, MS.Defined))
+      return E;
+    if (Error E = readGUIDs(R, MS.Consulted))
+      return E;
+    uint32_t NumSources;
+    if (Error E = R.readInteger(NumSources))
+      return E;
+    for (uint32_t J = 0; J != NumSources; ++J) {
+      StringRef SrcName;
+      std::vector<GlobalValue::GUID> GUIDs;
+      if (Error E = readString(R, SrcName))
+        return E;
+      if (Error E = readGUIDs(R, GUIDs))
+        return E;
+      MS.ImportList[SrcName].insert(GUIDs.begin(), GUIDs.end());
+    }
+  }
+  return Error::success();
+}
+
+Error ThinLinkImportState::readFromFile(StringRef Path) {
+  OptionsHash = 0;
+  Modules.clear();
+  ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+      MemoryBuffer::getFile(Path, /*FileSize*/ -1,
+                            /*RequiresNullTerminator*/ false);
+  if (!MBOrErr)
+    return errorCodeToError(MBOrErr.getError());
+  if (Error E = readThinLinkImportState((*MBOrErr)->getBuffer(), *this)) {
+    OptionsHash = 0;
+    Modules.clear();
+    return E;
+  }
+  return Error::success();
+}
+
+Error ThinLinkImportState::writeToFile(StringRef Path) const {
+  Expected<sys::fs::TempFile> Temp =
+      sys::fs::TempFile::create(Path + ".tmp%%%%%%");
+  if (!Temp)
+    return Temp.takeError();
+
+  {
+    raw_fd_ostream OS(Temp->FD, /*ShouldClose*/ false);
+    support::endian::Writer W(OS, support::little);
+    auto WriteString = [&](StringRef S) {
+      W.write<uint32_t>(S.size());
+      OS << S;
+    };
+    auto WriteGUIDs = [&](ArrayRef<GlobalValue::GUID> GUIDs) {
+      W.write<uint32_t>(GUIDs.size());
+      for (GlobalValue::GUID G : GUIDs)
+        W.write<uint64_t>(G);
+    };
+
+    // Write everything in sorted order so that the file only depends on the
+    // state.
+    OS.write(ThinLinkImportStateMagic, sizeof(ThinLinkImportStateMagic));
+    W.write<uint32_t>(ThinLinkImportStateVersion);
+    W.write<uint64_t>(OptionsHash);
+    W.write<uint32_t>(Modules.size());
+    std::vector<StringRef> ModNames;
+    for (auto &MS : Modules)
+      ModNames.push_back(MS.first());
+    llvm::sort(ModNames);
+    for (StringRef ModName : ModNames) {
+      const ModuleState &MS = Modules.find(ModName)->second;
+      WriteString(ModName);
+      W.write<uint64_t>(MS.Digest);
+      WriteGUIDs(MS.Defined);
+      WriteGUIDs(MS.Consulted);
+      std::vector<StringRef> SrcNames;
+      for (auto &Src : MS.ImportList)
+        SrcNames.push_back(Src.first());
+      llvm::sort(SrcNames);
+      W.write<uint32_t>(SrcNames.size());
+      for (StringRef SrcName : SrcNames) {
+        const FunctionImporter::FunctionsToImportTy &Set =
+            MS.ImportList.find(SrcName)->second;
+        std::vector<GlobalValue::GUID> GUIDs(Set.begin(), Set.end());
+        llvm::sort(GUIDs);
+        WriteString(SrcName);
+        WriteGUIDs(GUIDs);
+      }
+    }
+
+    OS.flush();
+    if (OS.has_error()) {
+      std::error_code EC = OS.error();
+      OS.clear_error();
+      consumeError(Temp->discard());
+      return errorCodeToError(EC);
+    }
+  }
+  return Temp->keep(Path);
+}
+
 #ifndef NDEBUG
 static void dumpImportListForModule(const ModuleSummaryIndex &Index,
                                     StringRef ModulePath,
@@ -118,6 +118,8 @@ STATISTIC(NumSunkInst , "Number of instructions sunk");
 STATISTIC(NumExpand,    "Number of expansions");
 STATISTIC(NumFactor   , "Number of factorizations");
 STATISTIC(NumReassoc  , "Number of reassociations");
+STATISTIC(NumIterationLimitHit, "Number of functions on which the iteration "
+                                "limit was hit before reaching a fixpoint");
 DEBUG_COUNTER(VisitCounter, "instcombine-visit",
               "Controls which instructions are visited");
 
@@ -129,6 +131,16 @@ static cl::opt<bool>
 EnableExpensiveCombines("expensive-combines",
                         cl::desc("Enable expensive instruction combines"));
 
+static cl::opt<unsigned> MaxIterations(
+    "instcombine-max-iterations", cl::Hidden, cl::init(1000),
+    cl::desc("Maximum number of times instcombine reruns over a function "
+             "before giving up on reaching a fixpoint"));
+
+static cl::opt<bool> IncrementalReiteration(
+    "instcombine-incremental-reiteration", cl::Hidden, cl::init(true),
+    cl::desc("Only revisit the instructions that the previous iteration "
+             "changed when rerunning instcombine over a function"));
+
 static cl::opt<unsigned>
 MaxArraySize("instcombine-maxarray-size", cl::init(1024),
              cl::desc("Maximum array size considered when doing a combine"));
@@ -3316,10 +3328,15 @@ bool InstCombiner::run() {
 /// them to the worklist (this significantly speeds up instcombine on code where
 /// many instructions are dead or constant).  Additionally, if we find a branch
 /// whose condition is a known constant, we only visit the reachable successors.
-static bool AddReachableCodeToWorklist(BasicBlock *BB, const DataLayout &DL,
-                                       SmallPtrSetImpl<BasicBlock *> &Visited,
-                                       InstCombineWorklist &ICWorklist,
-                                       const TargetLibraryInfo *TLI) {
+///
+/// If \p Revisit is given, only the instructions in it are added to the
+/// worklist; all reachable instructions are still constant folded and DCE'd.
+static bool
+AddReachableCodeToWorklist(BasicBlock *BB, const DataLayout &DL,
+                           SmallPtrSetImpl<BasicBlock *> &Visited,
+                           InstCombineWorklist &ICWorklist,
+                           const TargetLibraryInfo *TLI,
+                           const SmallPtrSetImpl<Instruction *> *Revisit) {
   bool MadeIRChange = false;
   SmallVector<BasicBlock*, 256> Worklist;
   Worklist.push_back(BB);
@@ -3385,7 +3402,7 @@ static bool AddReachableCodeToWorklist(BasicBlock *BB, const DataLayout &DL,
 
       // Skip processing debug intrinsics in InstCombine. Processing these call instructions
       // consumes non-trivial amount of time and provides no value for the optimization.
-      if (!isa<DbgInfoIntrinsic>(Inst))
+      if (!isa<DbgInfoIntrinsic>(Inst) && (!Revisit || Revisit->count(Inst)))
         InstrsForInstCombineWorklist.push_back(Inst);
     }
 
@@ -3425,9 +3442,13 @@ static bool AddReachableCodeToWorklist(BasicBlock *BB, const DataLayout &DL,
 ///
 /// This also does basic constant propagation and other forward fixing to make
 /// the combiner itself run much faster.
-static bool prepareICWorklistFromFunction(Function &F, const DataLayout &DL,
-                                          TargetLibraryInfo *TLI,
-                                          InstCombineWorklist &ICWorklist) {
+///
+/// If \p Revisit is given, only the instructions in it are added to the
+/// worklist.
+static bool prepareICWorklistFromFunction(
+    Function &F, const DataLayout &DL, TargetLibraryInfo *TLI,
+    InstCombineWorklist &ICWorklist,
+    const SmallPtrSetImpl<Instruction *> *Revisit = nullptr) {
   bool MadeIRChange = false;
 
   // Do a depth-first traversal of the function, populate the worklist with
@@ -3435,7 +3456,8 @@ static bool prepareICWorklistFromFunction(Function &F, const DataLayout &DL,
   // track of which blocks we visit.
   SmallPtrSet<BasicBlock *, 32> Visited;
   MadeIRChange |=
-      AddReachableCodeToWorklist(&F.front(), DL, Visited, ICWorklist, TLI);
+      AddReachableCodeToWorklist(&F.front(), DL, Visited, ICWorklist, TLI,
+                                 Revisit);
 
   // Do a quick scan over the function.  If we find any blocks that are
   // unreachable, remove any instructions inside of them.  This prevents
@@ -3478,13 +3500,31 @@ static bool combineInstructionsOverFunction(
     MadeIRChange = LowerDbgDeclare(F);
 
   // Iterate while there is work to do.
-  int Iteration = 0;
+  // Every instruction is visited by the first iteration, and those that no
+  // combine touched are unlikely to combine any differently the next time
+  // around. So unless -instcombine-incremental-reiteration=false, the
+  // following iterations only revisit the instructions the previous one added
+  // to the worklist: the ones it created and the users of the values it
+  // changed. They still constant fold and DCE the whole function.
+  SmallPtrSet<Instruction *, 16> Revisit;
+  unsigned Iteration = 0;
   while (true) {
     ++Iteration;
+    if (Iteration > MaxIterations) {
+      LLVM_DEBUG(dbgs() << "\n\nINSTCOMBINE ITERATION LIMIT " << MaxIterations
+                        << " reached on " << F.getName()
+                        << ", stopping before reaching a fixpoint\n");
+      ++NumIterationLimitHit;
+      break;
+    }
     LLVM_DEBUG(dbgs() << "\n\nINSTCOMBINE ITERATION #" << Iteration << " on "
                       << F.getName() << "\n");
 
-    MadeIRChange |= prepareICWorklistFromFunction(F, DL, &TLI, Worklist);
+    bool RevisitAll = Iteration == 1 || !IncrementalReiteration;
+    MadeIRChange |= prepareICWorklistFromFunction(
+        F, DL, &TLI, Worklist, RevisitAll ? nullptr : &Revisit);
+    // Only what this iteration adds is revisited by the next one.
+    Worklist.takeAdded();
 
     InstCombiner IC(Worklist, Builder, F.hasMinSize(), ExpensiveCombines, AA,
                     AC, TLI, DT, ORE, BFI, PSI, DL, LI);
@@ -3492,6 +3532,7 @@ static bool combineInstructionsOverFunction(
 
     if (!IC.run())
       break;
+    Revisit = Worklist.takeAdded();
   }
 
   return MadeIRChange || Iteration > 1;
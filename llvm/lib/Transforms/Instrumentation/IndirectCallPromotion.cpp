@@ -80,6 +80,15 @@ static cl::opt<unsigned>
     ICPCSSkip("icp-csskip", cl::init(0), cl::Hidden, cl::ZeroOrMore,
               cl::desc("Skip Callsite up to this number for this compilation"));
 
+// If the option is set to true, a profiled target that cannot be promoted at a
+// callsite, e.g. because it is defined in another module and was not imported,
+// is left on the indirect path, and the colder targets after it are still
+// considered for promotion instead of giving up on the callsite.
+static cl::opt<bool> ICPSkipUnavailableTargets(
+    "icp-skip-unavailable-targets", cl::init(false), cl::Hidden,
+    cl::desc("Keep promoting the colder targets of a callsite after a target "
+             "that cannot be promoted"));
+
 // Set if the pass is called in LTO optimization. The difference for LTO mode
 // is the pass won't prefix the source module name to the internal linkage
 // symbols.
@@ -179,12 +188,15 @@ private:
 
   OptimizationRemarkEmitter &ORE;
 
-  // A struct that records the direct target and it's call count.
+  // A struct that records the direct target, its call count and its index
+  // in the value profile data of the callsite.
   struct PromotionCandidate {
     Function *TargetFunction;
     uint64_t Count;
+    uint32_t Index;
 
-    PromotionCandidate(Function *F, uint64_t C) : TargetFunction(F), Count(C) {}
+    PromotionCandidate(Function *F, uint64_t C, uint32_t I)
+        : TargetFunction(F), Count(C), Index(I) {}
   };
 
   // Check if the indirect-call call site should be promoted. Return the number
@@ -215,7 +227,9 @@ public:
 } // end anonymous namespace
 
 // Indirect-call promotion heuristic. The direct targets are sorted based on
-// the count. Stop at the first target that is not promoted.
+// the count. Stop at the first target that is not promoted, unless
+// -icp-skip-unavailable-targets is given, in which case only the targets that
+// cannot be found or promoted are skipped.
 std::vector<ICallPromotionFunc::PromotionCandidate>
 ICallPromotionFunc::getPromotionCandidatesForCallSite(
     Instruction *Inst, const ArrayRef<InstrProfValueData> &ValueDataRef,
@@ -231,6 +245,11 @@ ICallPromotionFunc::getPromotionCandidatesForCallSite(
     return Ret;
   }
 
+  // The profitability of the candidates was computed assuming that all the
+  // hotter targets are promoted. Once a target is skipped, its calls stay on
+  // the indirect path and have to be accounted for again.
+  const uint64_t OrigTotalCount = TotalCount;
+  bool SkippedTarget = false;
   for (uint32_t I = 0; I < NumCandidates; I++) {
     uint64_t Count = ValueDataRef[I].Count;
     assert(Count <= TotalCount);
@@ -238,6 +257,12 @@ ICallPromotionFunc::getPromotionCandidatesForCallSite(
     LLVM_DEBUG(dbgs() << " Candidate " << I << " Count=" << Count
                       << "  Target_func: " << Target << "\n");
 
+    if (SkippedTarget && !ICallPromotionAnalysis::isPromotionProfitable(
+                             Count, OrigTotalCount, TotalCount)) {
+      LLVM_DEBUG(dbgs() << " Not promote: Cold target.\n");
+      break;
+    }
+
     if (ICPInvokeOnly && isa<CallInst>(Inst)) {
       LLVM_DEBUG(dbgs() << " Not promote: User options.\n");
       ORE.emit([&]() {
@@ -271,6 +296,10 @@ ICallPromotionFunc::getPromotionCandidatesForCallSite(
                << "Cannot promote indirect call: target with md5sum "
                << ore::NV("target md5sum", Target) << " not found";
       });
+      if (ICPSkipUnavailableTargets) {
+        SkippedTarget = true;
+        continue;
+      }
       break;
     }
 
@@ -284,10 +313,14 @@ ICallPromotionFunc::getPromotionCandidatesForCallSite(
                << NV("TargetFunction", TargetFunction) << " with count of "
                << NV("Count", Count) << ": " << Reason;
       });
+      if (ICPSkipUnavailableTargets) {
+        SkippedTarget = true;
+        continue;
+      }
       break;
     }
 
-    Ret.push_back(PromotionCandidate(TargetFunction, Count));
+    Ret.push_back(PromotionCandidate(TargetFunction, Count, I));
     TotalCount -= Count;
   }
   return Ret;
@@ -371,8 +404,18 @@ bool ICallPromotionFunc::processFunction(ProfileSummaryInfo *PSI) {
     // If all promoted, we don't need the MD.prof metadata.
     if (TotalCount == 0 || NumPromoted == NumVals)
       continue;
-    // Otherwise we need update with the un-promoted records back.
-    annotateValueSite(*M, *I, ICallProfDataRef.slice(NumPromoted), TotalCount,
+    // Otherwise we need update with the un-promoted records back. These are
+    // not necessarily a suffix of the records if some target was skipped.
+    SmallVector<InstrProfValueData, 4> RemainingRecords;
+    auto PromotedI = PromotionCandidates.begin();
+    for (uint32_t J = 0; J < NumVals; ++J) {
+      if (PromotedI != PromotionCandidates.end() && PromotedI->Index == J) {
+        ++PromotedI;
+        continue;
+      }
+      RemainingRecords.push_back(ICallProfDataRef[J]);
+    }
+    annotateValueSite(*M, *I, RemainingRecords, TotalCount,
                       IPVK_IndirectCallTarget, NumCandidates);
   }
   return Changed;
@@ -32,9 +32,11 @@
 #include "llvm/IR/GlobalValue.h"
 #include "llvm/IR/GlobalVariable.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Type.h"
 #include "llvm/Pass.h"
@@ -102,6 +104,19 @@ cl::opt<bool> AtomicCounterUpdateAll(
     cl::desc("Make all profile counter updates atomic (for testing only)"),
     cl::init(false));
 
+cl::opt<bool> ShardedCounterUpdate(
+    "instrprof-sharded-counters", cl::ZeroOrMore,
+    cl::desc("Let every thread update its own copy of the profile counters, "
+             "which the runtime sums up when writing the profile"),
+    cl::init(false));
+
+cl::opt<bool> RuntimeCounterRelocation(
+    "runtime-counter-relocation", cl::ZeroOrMore,
+    cl::desc("Update the profile counters at an offset set by the runtime, so "
+             "that they can be mapped onto the profile file in continuous "
+             "mode (takes precedence over -instrprof-sharded-counters)"),
+    cl::init(false));
+
 cl::opt<bool> AtomicCounterUpdatePromoted(
     "atomic-counter-update-promoted", cl::ZeroOrMore,
     cl::desc("Do counter update using atomic fetch add "
@@ -402,6 +417,18 @@ static InstrProfIncrementInst *castToIncrementInst(Instruction *Instr) {
 bool InstrProfiling::lowerIntrinsics(Function *F) {
   bool MadeChange = false;
   PromotionCandidates.clear();
+  CounterOffset = nullptr;
+  OffsetCounters.clear();
+  if ((RuntimeCounterRelocation || ShardedCounterUpdate) &&
+      llvm::any_of(instructions(F), [](Instruction &I) {
+        return castToIncrementInst(&I) != nullptr;
+      })) {
+    if (RuntimeCounterRelocation)
+      emitCounterBias(F);
+    else
+      emitCounterShardOffset(F);
+  }
+
   for (BasicBlock &BB : *F) {
     for (auto I = BB.begin(), E = BB.end(); I != E;) {
       auto Instr = I++;
@@ -623,13 +650,105 @@ void InstrProfiling::lowerValueProfileInst(InstrProfValueProfileInst *Ind) {
   Ind->eraseFromParent();
 }
 
+void InstrProfiling::emitCounterShardOffset(Function *F) {
+  LLVMContext &Ctx = M->getContext();
+  Type *Int64Ty = Type::getInt64Ty(Ctx);
+
+  auto *OffsetVar = M->getNamedGlobal(getInstrProfCounterShardOffsetVarName());
+  if (!OffsetVar)
+    OffsetVar = new GlobalVariable(
+        *M, Int64Ty, false, GlobalValue::ExternalLinkage, nullptr,
+        getInstrProfCounterShardOffsetVarName(), nullptr,
+        GlobalValue::GeneralDynamicTLSModel);
+  FunctionCallee AcquireShard = M->getOrInsertFunction(
+      getInstrProfCounterShardFuncName(),
+      AttributeList().addAttribute(Ctx, AttributeList::FunctionIndex,
+                                   Attribute::NoUnwind),
+      Int64Ty);
+
+  // Keep the static allocas in the entry block.
+  BasicBlock &Entry = F->getEntryBlock();
+  BasicBlock::iterator IP = Entry.getFirstInsertionPt();
+  while (isa<AllocaInst>(IP))
+    ++IP;
+
+  // The runtime is only called the first time a thread runs instrumented
+  // code.
+  IRBuilder<> Builder(&Entry, IP);
+  LoadInst *Offset = Builder.CreateLoad(Int64Ty, OffsetVar, "pgoshard");
+  Value *HasNoShard = Builder.CreateICmpEQ(Offset, Builder.getInt64(0));
+  MDBuilder MDB(Ctx);
+  Instruction *ThenTerm = SplitBlockAndInsertIfThen(
+      HasNoShard, &*IP, /*Unreachable=*/false,
+      MDB.createBranchWeights(1, (1U << 20) - 1));
+  Builder.SetInsertPoint(ThenTerm);
+  CallInst *NewOffset = Builder.CreateCall(AcquireShard);
+
+  BasicBlock *Tail = ThenTerm->getSuccessor(0);
+  Builder.SetInsertPoint(Tail, Tail->begin());
+  PHINode *PN = Builder.CreatePHI(Int64Ty, 2, "pgoshard");
+  PN->addIncoming(Offset, Offset->getParent());
+  PN->addIncoming(NewOffset, ThenTerm->getParent());
+  CounterOffset = PN;
+}
+
+void InstrProfiling::emitCounterBias(Function *F) {
+  Type *Int64Ty = Type::getInt64Ty(M->getContext());
+
+  // Every module carries a definition, so that the runtime can tell from a
+  // weak reference whether the counters can be relocated at all.
+  auto *BiasVar = M->getNamedGlobal(getInstrProfCounterBiasVarName());
+  if (!BiasVar) {
+    BiasVar = new GlobalVariable(
+        *M, Int64Ty, false, GlobalValue::LinkOnceODRLinkage,
+        Constant::getNullValue(Int64Ty), getInstrProfCounterBiasVarName());
+    BiasVar->setVisibility(GlobalValue::HiddenVisibility);
+    if (TT.supportsCOMDAT())
+      BiasVar->setComdat(M->getOrInsertComdat(BiasVar->getName()));
+  }
+
+  BasicBlock &Entry = F->getEntryBlock();
+  BasicBlock::iterator IP = Entry.getFirstInsertionPt();
+  while (isa<AllocaInst>(IP))
+    ++IP;
+  IRBuilder<> Builder(&Entry, IP);
+  CounterOffset = Builder.CreateLoad(Int64Ty, BiasVar, "pgobias");
+}
+
+Value *InstrProfiling::getOffsetCounterAddr(GlobalVariable *Counters,
+                                            uint64_t Index) {
+  // Compute the addresses next to the offset, so that they dominate every use
+  // and counter promotion can still sink the updates out of loops.
+  auto *Offset = cast<Instruction>(CounterOffset);
+  IRBuilder<> Builder(Offset->getParent(),
+                      isa<PHINode>(Offset)
+                          ? Offset->getParent()->getFirstInsertionPt()
+                          : std::next(Offset->getIterator()));
+  Value *&Moved = OffsetCounters[Counters];
+  if (!Moved) {
+    Type *IntPtrTy = M->getDataLayout().getIntPtrType(Counters->getType());
+    Value *Start = Builder.CreatePtrToInt(Counters, IntPtrTy);
+    Value *Off = Builder.CreateZExtOrTrunc(Offset, IntPtrTy);
+    Moved = Builder.CreateIntToPtr(Builder.CreateAdd(Start, Off),
+                                   Counters->getType(),
+                                   RuntimeCounterRelocation ? "pgobias.cnts"
+                                                            : "pgoshard.cnts");
+  }
+  Builder.SetInsertPoint(cast<Instruction>(Moved)->getNextNode());
+  return Builder.CreateConstInBoundsGEP2_64(Counters->getValueType(), Moved, 0,
+                                            Index);
+}
+
 void InstrProfiling::lowerIncrement(InstrProfIncrementInst *Inc) {
   GlobalVariable *Counters = getOrCreateRegionCounters(Inc);
 
   IRBuilder<> Builder(Inc);
   uint64_t Index = Inc->getIndex()->getZExtValue();
-  Value *Addr = Builder.CreateConstInBoundsGEP2_64(Counters->getValueType(),
-                                                   Counters, 0, Index);
+  Value *Addr =
+      CounterOffset
+          ? getOffsetCounterAddr(Counters, Index)
+          : Builder.CreateConstInBoundsGEP2_64(Counters->getValueType(),
+                                               Counters, 0, Index);
 
   if (Options.Atomic || AtomicCounterUpdateAll) {
     Builder.CreateAtomicRMW(AtomicRMWInst::Add, Addr, Inc->getStep(),
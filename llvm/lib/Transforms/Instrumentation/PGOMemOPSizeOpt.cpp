@@ -11,6 +11,8 @@
 // value profile metadata is available, a single memory intrinsic is expanded
 // to a sequence of guarded specialized versions that are called with the
 // hottest size(s), for later expansion into more optimal inline sequences.
+// Optionally, hot ranges of sizes that fit in a register twice are expanded
+// inline right away.
 //
 //===----------------------------------------------------------------------===//
 
@@ -22,6 +24,7 @@
 #include "llvm/Analysis/DomTreeUpdater.h"
 #include "llvm/Analysis/GlobalsModRef.h"
 #include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/IR/DerivedTypes.h"
@@ -47,6 +50,7 @@
 #include "llvm/Transforms/Instrumentation.h"
 #include "llvm/Transforms/Instrumentation/PGOInstrumentation.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <vector>
@@ -90,6 +94,13 @@ static cl::opt<bool>
                     cl::desc("Scale the memop size counts using the basic "
                              " block count value"));
 
+// Expand size ranges inline, when no single size in them is hot enough.
+static cl::opt<bool>
+    MemOPExpandRanges("pgo-memop-expand-ranges", cl::init(false), cl::Hidden,
+                      cl::desc("Expand memcpy and memset calls inline for "
+                               "hot ranges of sizes from the size value "
+                               "profile"));
+
 // This option sets the rangge of precise profile memop sizes.
 extern cl::opt<std::string> MemOPSizeRange;
 
@@ -112,6 +123,7 @@ private:
   void getAnalysisUsage(AnalysisUsage &AU) const override {
     AU.addRequired<BlockFrequencyInfoWrapperPass>();
     AU.addRequired<OptimizationRemarkEmitterWrapperPass>();
+    AU.addRequired<TargetTransformInfoWrapperPass>();
     AU.addPreserved<GlobalsAAWrapperPass>();
     AU.addPreserved<DominatorTreeWrapperPass>();
   }
@@ -123,6 +135,7 @@ INITIALIZE_PASS_BEGIN(PGOMemOPSizeOptLegacyPass, "pgo-memop-opt",
                       "Optimize memory intrinsic using its size value profile",
                       false, false)
 INITIALIZE_PASS_DEPENDENCY(BlockFrequencyInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(TargetTransformInfoWrapperPass)
 INITIALIZE_PASS_END(PGOMemOPSizeOptLegacyPass, "pgo-memop-opt",
                     "Optimize memory intrinsic using its size value profile",
                     false, false)
@@ -135,8 +148,9 @@ namespace {
 class MemOPSizeOpt : public InstVisitor<MemOPSizeOpt> {
 public:
   MemOPSizeOpt(Function &Func, BlockFrequencyInfo &BFI,
-               OptimizationRemarkEmitter &ORE, DominatorTree *DT)
-      : Func(Func), BFI(BFI), ORE(ORE), DT(DT), Changed(false) {
+               OptimizationRemarkEmitter &ORE, DominatorTree *DT,
+               const TargetTransformInfo &TTI)
+      : Func(Func), BFI(BFI), ORE(ORE), DT(DT), TTI(TTI), Changed(false) {
     ValueDataArray =
         llvm::make_unique<InstrProfValueData[]>(MemOPMaxVersion + 2);
     // Get the MemOPSize range information from option MemOPSizeRange,
@@ -173,6 +187,7 @@ private:
   BlockFrequencyInfo &BFI;
   OptimizationRemarkEmitter &ORE;
   DominatorTree *DT;
+  const TargetTransformInfo &TTI;
   bool Changed;
   std::vector<MemIntrinsic *> WorkList;
   // Start of the previse range.
@@ -183,6 +198,9 @@ private:
   std::unique_ptr<InstrProfValueData[]> ValueDataArray;
   bool perform(MemIntrinsic *MI);
 
+  // Return the widest access that a range of sizes may be expanded with.
+  uint64_t getMaxRangeWidth(const MemIntrinsic *MI) const;
+
   // This kind shows which group the value falls in. For PreciseValue, we have
   // the profile count for that value. LargeGroup groups the values that are in
   // range [LargeValue, +inf). NonLargeGroup groups the rest of values.
@@ -219,6 +237,59 @@ static bool isProfitable(uint64_t Count, uint64_t TotalCount) {
   return true;
 }
 
+// Copy or set [0, Size) for a Size in [Width, 2 * Width) with two accesses of
+// Width bytes, at the start and at the end.
+static void expandMemOpRange(IRBuilder<> &IRB, MemIntrinsic *MI,
+                             uint64_t Width) {
+  Type *Ty = Width <= 8 ? static_cast<Type *>(IRB.getIntNTy(Width * 8))
+                        : VectorType::get(IRB.getInt8Ty(), Width);
+  Value *Size = MI->getLength();
+  Value *TailOffset =
+      IRB.CreateSub(Size, ConstantInt::get(Size->getType(), Width));
+  auto getHeadAndTail = [&](Value *Ptr) {
+    unsigned AS = Ptr->getType()->getPointerAddressSpace();
+    Value *Head = IRB.CreatePointerCast(Ptr, IRB.getInt8PtrTy(AS));
+    Value *Tail = IRB.CreateInBoundsGEP(IRB.getInt8Ty(), Head, TailOffset);
+    return std::make_pair(IRB.CreatePointerCast(Head, Ty->getPointerTo(AS)),
+                          IRB.CreatePointerCast(Tail, Ty->getPointerTo(AS)));
+  };
+
+  Value *HeadVal, *TailVal;
+  if (auto *MTI = dyn_cast<MemTransferInst>(MI)) {
+    auto Src = getHeadAndTail(MTI->getRawSource());
+    HeadVal = IRB.CreateAlignedLoad(Ty, Src.first,
+                                    std::max(MTI->getSourceAlignment(), 1U));
+    TailVal = IRB.CreateAlignedLoad(Ty, Src.second, 1);
+  } else {
+    Value *Byte = cast<MemSetInst>(MI)->getValue();
+    if (Ty->isVectorTy())
+      HeadVal = IRB.CreateVectorSplat(Width, Byte);
+    else
+      HeadVal = IRB.CreateMul(
+          IRB.CreateZExt(Byte, Ty),
+          ConstantInt::get(Ty, APInt::getSplat(Width * 8, APInt(8, 1))));
+    TailVal = HeadVal;
+  }
+  auto Dst = getHeadAndTail(MI->getRawDest());
+  IRB.CreateAlignedStore(HeadVal, Dst.first,
+                         std::max(MI->getDestAlignment(), 1U));
+  IRB.CreateAlignedStore(TailVal, Dst.second, 1);
+}
+
+uint64_t MemOPSizeOpt::getMaxRangeWidth(const MemIntrinsic *MI) const {
+  if (!MemOPExpandRanges || MI->isVolatile())
+    return 0;
+  if (!isa<MemCpyInst>(MI) && !isa<MemSetInst>(MI))
+    return 0;
+  if (!isa<IntegerType>(MI->getLength()->getType()))
+    return 0;
+  // Don't access more bytes at once than fit in a register, or the accesses
+  // would be split again.
+  unsigned RegisterBits = std::max(TTI.getRegisterBitWidth(/*Vector=*/true),
+                                   TTI.getRegisterBitWidth(/*Vector=*/false));
+  return PowerOf2Floor(RegisterBits / 8);
+}
+
 static inline uint64_t getScaledCount(uint64_t Count, uint64_t Num,
                                       uint64_t Denom) {
   if (!MemOPScaleCount)
@@ -272,19 +343,25 @@ bool MemOPSizeOpt::perform(MemIntrinsic *MI) {
   uint64_t SavedRemainCount = SavedTotalCount;
   SmallVector<uint64_t, 16> SizeIds;
   SmallVector<uint64_t, 16> CaseCounts;
+  // The values that don't get a version, to annotate the default case with.
+  SmallVector<InstrProfValueData, 16> RemainVDs;
   uint64_t MaxCount = 0;
   unsigned Version = 0;
   // Default case is in the front -- save the slot here.
   CaseCounts.push_back(0);
-  for (auto &VD : VDs) {
+  unsigned I = 0;
+  for (unsigned E = VDs.size(); I < E; ++I) {
+    const InstrProfValueData &VD = VDs[I];
     int64_t V = VD.Value;
     uint64_t C = VD.Count;
     if (MemOPScaleCount)
       C = getScaledCount(C, ActualCount, SavedTotalCount);
 
     // Only care precise value here.
-    if (getMemOPSizeKind(V) != PreciseValue)
+    if (getMemOPSizeKind(V) != PreciseValue) {
+      RemainVDs.push_back(VD);
       continue;
+    }
 
     // ValueCounts are sorted on the count. Break at the first un-profitable
     // value.
@@ -301,8 +378,72 @@ bool MemOPSizeOpt::perform(MemIntrinsic *MI) {
     assert(SavedRemainCount >= VD.Count);
     SavedRemainCount -= VD.Count;
 
-    if (++Version > MemOPMaxVersion && MemOPMaxVersion != 0)
+    if (++Version > MemOPMaxVersion && MemOPMaxVersion != 0) {
+      ++I;
       break;
+    }
+  }
+  RemainVDs.append(VDs.begin() + I, VDs.end());
+
+  // Sizes that aren't hot enough for a version of their own may be together
+  // with the other sizes of their range [Width, 2 * Width). Any size in such
+  // a range is copied or set inline with two accesses of Width bytes, one at
+  // the start and one at the end, which overlap unless the size is Width.
+  struct SizeRange {
+    uint64_t Width;
+    uint64_t Count = 0;
+    uint64_t SavedCount = 0;
+    // The profiled sizes in the range with their (scaled) counts.
+    SmallVector<std::pair<uint64_t, uint64_t>, 4> SizeCounts;
+
+    SizeRange(uint64_t Width) : Width(Width) {}
+  };
+  SmallVector<SizeRange, 4> Ranges;
+  if (uint64_t MaxRangeWidth = getMaxRangeWidth(MI)) {
+    for (const InstrProfValueData &VD : RemainVDs) {
+      int64_t V = VD.Value;
+      if (getMemOPSizeKind(V) != PreciseValue || V <= 0)
+        continue;
+      uint64_t Width = PowerOf2Floor(V);
+      if (Width > MaxRangeWidth)
+        continue;
+      auto Range = find_if(Ranges, [Width](const SizeRange &R) {
+        return R.Width == Width;
+      });
+      if (Range == Ranges.end())
+        Range = Ranges.insert(Ranges.end(), SizeRange(Width));
+      uint64_t C = VD.Count;
+      if (MemOPScaleCount)
+        C = getScaledCount(C, ActualCount, SavedTotalCount);
+      Range->Count += C;
+      Range->SavedCount += VD.Count;
+      Range->SizeCounts.push_back({uint64_t(V), C});
+    }
+    std::stable_sort(Ranges.begin(), Ranges.end(),
+                     [](const SizeRange &L, const SizeRange &R) {
+                       return L.Count > R.Count;
+                     });
+
+    unsigned NumRanges = 0;
+    for (const SizeRange &Range : Ranges) {
+      if (Version > MemOPMaxVersion && MemOPMaxVersion != 0)
+        break;
+      if (!isProfitable(Range.Count, RemainCount))
+        break;
+      if (Range.Count > MaxCount)
+        MaxCount = Range.Count;
+      RemainCount -= Range.Count;
+      assert(SavedRemainCount >= Range.SavedCount);
+      SavedRemainCount -= Range.SavedCount;
+      llvm::erase_if(RemainVDs, [&Range](const InstrProfValueData &VD) {
+        return any_of(Range.SizeCounts, [&VD](std::pair<uint64_t, uint64_t> P) {
+          return P.first == VD.Value;
+        });
+      });
+      ++NumRanges;
+      ++Version;
+    }
+    Ranges.erase(Ranges.begin() + NumRanges, Ranges.end());
   }
 
   if (Version == 0)
@@ -328,6 +469,10 @@ bool MemOPSizeOpt::perform(MemIntrinsic *MI) {
   //      mem_op(..., s2);
   //      goto merge_bb;
   //   ...
+  //   case w ... 2w-1:
+  //      <w byte accesses at offset 0 and at offset size - w>
+  //      goto merge_bb;
+  //   ...
   //   default:
   //      mem_op(..., size);
   //      goto merge_bb;
@@ -358,16 +503,16 @@ bool MemOPSizeOpt::perform(MemIntrinsic *MI) {
   // Clear the value profile data.
   MI->setMetadata(LLVMContext::MD_prof, nullptr);
   // If all promoted, we don't need the MD.prof metadata.
-  if (SavedRemainCount > 0 || Version != NumVals)
+  if (SavedRemainCount > 0 || !RemainVDs.empty())
     // Otherwise we need update with the un-promoted records back.
-    annotateValueSite(*Func.getParent(), *MI, VDs.slice(Version),
-                      SavedRemainCount, IPVK_MemOPSize, NumVals);
+    annotateValueSite(*Func.getParent(), *MI, RemainVDs, SavedRemainCount,
+                      IPVK_MemOPSize, NumVals);
 
   LLVM_DEBUG(dbgs() << "\n\n== Basic Block After==\n");
 
   std::vector<DominatorTree::UpdateType> Updates;
   if (DT)
-    Updates.reserve(2 * SizeIds.size());
+    Updates.reserve(2 * (SizeIds.size() + Ranges.size()));
 
   for (uint64_t SizeId : SizeIds) {
     BasicBlock *CaseBB = BasicBlock::Create(
@@ -389,6 +534,33 @@ bool MemOPSizeOpt::perform(MemIntrinsic *MI) {
     }
     LLVM_DEBUG(dbgs() << *CaseBB << "\n");
   }
+
+  for (const SizeRange &Range : Ranges) {
+    uint64_t Width = Range.Width;
+    BasicBlock *RangeBB = BasicBlock::Create(
+        Ctx, Twine("MemOP.Range.") + Twine(Width) + "." + Twine(2 * Width - 1),
+        &Func, DefaultBB);
+    IRBuilder<> IRBRange(RangeBB);
+    IRBRange.SetCurrentDebugLocation(MI->getDebugLoc());
+    expandMemOpRange(IRBRange, MI, Width);
+    IRBRange.CreateBr(MergeBB);
+    auto *SizeType = cast<IntegerType>(SizeVar->getType());
+    for (uint64_t Size = Width; Size < 2 * Width; ++Size) {
+      if (is_contained(SizeIds, Size))
+        continue;
+      uint64_t C = 0;
+      for (auto &SizeCount : Range.SizeCounts)
+        if (SizeCount.first == Size)
+          C = SizeCount.second;
+      SI->addCase(ConstantInt::get(SizeType, Size), RangeBB);
+      CaseCounts.push_back(C);
+    }
+    if (DT) {
+      Updates.push_back({DominatorTree::Insert, RangeBB, MergeBB});
+      Updates.push_back({DominatorTree::Insert, BB, RangeBB});
+    }
+    LLVM_DEBUG(dbgs() << *RangeBB << "\n");
+  }
   DTU.applyUpdates(Updates);
   Updates.clear();
 
@@ -413,13 +585,14 @@ bool MemOPSizeOpt::perform(MemIntrinsic *MI) {
 
 static bool PGOMemOPSizeOptImpl(Function &F, BlockFrequencyInfo &BFI,
                                 OptimizationRemarkEmitter &ORE,
-                                DominatorTree *DT) {
+                                DominatorTree *DT,
+                                const TargetTransformInfo &TTI) {
   if (DisableMemOPOPT)
     return false;
 
   if (F.hasFnAttribute(Attribute::OptimizeForSize))
     return false;
-  MemOPSizeOpt MemOPSizeOpt(F, BFI, ORE, DT);
+  MemOPSizeOpt MemOPSizeOpt(F, BFI, ORE, DT, TTI);
   MemOPSizeOpt.perform();
   return MemOPSizeOpt.isChanged();
 }
@@ -430,7 +603,8 @@ bool PGOMemOPSizeOptLegacyPass::runOnFunction(Function &F) {
   auto &ORE = getAnalysis<OptimizationRemarkEmitterWrapperPass>().getORE();
   auto *DTWP = getAnalysisIfAvailable<DominatorTreeWrapperPass>();
   DominatorTree *DT = DTWP ? &DTWP->getDomTree() : nullptr;
-  return PGOMemOPSizeOptImpl(F, BFI, ORE, DT);
+  auto &TTI = getAnalysis<TargetTransformInfoWrapperPass>().getTTI(F);
+  return PGOMemOPSizeOptImpl(F, BFI, ORE, DT, TTI);
 }
 
 namespace llvm {
@@ -441,7 +615,8 @@ PreservedAnalyses PGOMemOPSizeOpt::run(Function &F,
   auto &BFI = FAM.getResult<BlockFrequencyAnalysis>(F);
   auto &ORE = FAM.getResult<OptimizationRemarkEmitterAnalysis>(F);
   auto *DT = FAM.getCachedResult<DominatorTreeAnalysis>(F);
-  bool Changed = PGOMemOPSizeOptImpl(F, BFI, ORE, DT);
+  auto &TTI = FAM.getResult<TargetIRAnalysis>(F);
+  bool Changed = PGOMemOPSizeOptImpl(F, BFI, ORE, DT, TTI);
   if (!Changed)
     return PreservedAnalyses::all();
   auto PA = PreservedAnalyses();
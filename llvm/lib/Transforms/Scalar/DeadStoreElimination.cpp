@@ -9,8 +9,8 @@
 // This file implements a trivial dead store elimination that only considers
 // basic-block local redundant stores.
 //
-// FIXME: This should eventually be extended to be a post-dominator tree
-// traversal.  Doing so would be pretty trivial.
+// With -enable-dse-memoryssa, it walks MemorySSA instead of querying MemDep,
+// and also removes the stores that are overwritten in a post-dominating block.
 //
 //===----------------------------------------------------------------------===//
 
@@ -28,7 +28,10 @@
 #include "llvm/Analysis/MemoryBuiltins.h"
 #include "llvm/Analysis/MemoryDependenceAnalysis.h"
 #include "llvm/Analysis/MemoryLocation.h"
+#include "llvm/Analysis/MemorySSA.h"
+#include "llvm/Analysis/MemorySSAUpdater.h"
 #include "llvm/Analysis/OrderedBasicBlock.h"
+#include "llvm/Analysis/PostDominators.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/Argument.h"
@@ -74,6 +77,7 @@ STATISTIC(NumFastStores, "Number of stores deleted");
 STATISTIC(NumFastOther, "Number of other instrs removed");
 STATISTIC(NumCompletePartials, "Number of stores dead by later partials");
 STATISTIC(NumModifiedStores, "Number of stores modified");
+STATISTIC(NumCrossBlockStores, "Number of stores killed in another block");
 
 static cl::opt<bool>
 EnablePartialOverwriteTracking("enable-dse-partial-overwrite-tracking",
@@ -85,6 +89,16 @@ EnablePartialStoreMerging("enable-dse-partial-store-merging",
   cl::init(true), cl::Hidden,
   cl::desc("Enable partial store merging in DSE"));
 
+static cl::opt<bool>
+EnableMemorySSA("enable-dse-memoryssa", cl::init(false), cl::Hidden,
+  cl::desc("Use MemorySSA instead of MemDep in DSE, which also removes "
+           "stores that are killed in a later block"));
+
+static cl::opt<unsigned>
+MemorySSAScanLimit("dse-memoryssa-scanlimit", cl::init(100), cl::Hidden,
+  cl::desc("The number of memory accesses that MemorySSA backed DSE looks at "
+           "for each store"));
+
 //===----------------------------------------------------------------------===//
 // Helper functions
 //===----------------------------------------------------------------------===//
@@ -1322,15 +1336,285 @@ static bool eliminateDeadStores(Function &F, AliasAnalysis *AA,
   return MadeChange;
 }
 
+//===----------------------------------------------------------------------===//
+// MemorySSA backed DSE
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// Eliminates the stores that are completely overwritten on every path before
+/// they are read, walking MemorySSA instead of querying MemDep, so the killing
+/// store can be in another block than the dead one.
+struct DSEState {
+  Function &F;
+  AliasAnalysis &AA;
+  MemorySSA &MSSA;
+  PostDominatorTree &PDT;
+  const TargetLibraryInfo &TLI;
+  const DataLayout &DL;
+  MemorySSAUpdater Updater;
+
+  /// The instructions deleted so far. They are never dereferenced, nothing
+  /// allocates new instructions while this is alive.
+  SmallPtrSet<const Instruction *, 32> Deleted;
+
+  /// Whether some call may unwind out of the function, after which a store to
+  /// memory that the caller can see is observable without ever reaching the
+  /// store that kills it.
+  bool MayUnwind = false;
+
+  DSEState(Function &F, AliasAnalysis &AA, MemorySSA &MSSA,
+           PostDominatorTree &PDT, const TargetLibraryInfo &TLI)
+      : F(F), AA(AA), MSSA(MSSA), PDT(PDT), TLI(TLI),
+        DL(F.getParent()->getDataLayout()), Updater(&MSSA) {}
+
+  bool run();
+
+private:
+  bool eliminateNoopStore(MemoryDef *Def);
+  bool isKilledBy(MemoryDef *DeadDef, MemoryDef *KillingDef,
+                  const MemoryLocation &KillingLoc);
+  bool isReadBefore(MemoryDef *DeadDef, const MemoryLocation &DeadLoc,
+                    MemoryDef *KillingDef);
+  void deleteDeadInstruction(Instruction *I);
+};
+
+} // end anonymous namespace
+
+/// Removes a store of the value that was loaded from the same pointer, or of
+/// zero to a calloc'ed object, with no write to it in between.
+bool DSEState::eliminateNoopStore(MemoryDef *Def) {
+  StoreInst *SI = dyn_cast<StoreInst>(Def->getMemoryInst());
+  if (!SI || !isRemovable(SI))
+    return false;
+
+  MemorySSAWalker *Walker = MSSA.getWalker();
+  if (LoadInst *DepLoad = dyn_cast<LoadInst>(SI->getValueOperand())) {
+    if (SI->getPointerOperand() == DepLoad->getPointerOperand()) {
+      // The load dominates the store, so if nothing between them writes the
+      // location, both see the same clobber.
+      MemoryUseOrDef *LoadAccess = MSSA.getMemoryAccess(DepLoad);
+      if (LoadAccess->getDefiningAccess() == Def->getDefiningAccess() ||
+          Walker->getClobberingMemoryAccess(LoadAccess) ==
+              Walker->getClobberingMemoryAccess(Def)) {
+        LLVM_DEBUG(
+            dbgs() << "DSE: Remove Store Of Load from same pointer:\n  LOAD: "
+                   << *DepLoad << "\n  STORE: " << *SI << '\n');
+        deleteDeadInstruction(SI);
+        ++NumRedundantStores;
+        return true;
+      }
+    }
+  }
+
+  Constant *StoredConstant = dyn_cast<Constant>(SI->getValueOperand());
+  if (StoredConstant && StoredConstant->isNullValue()) {
+    Instruction *UnderlyingPointer =
+        dyn_cast<Instruction>(GetUnderlyingObject(SI->getPointerOperand(), DL));
+    if (UnderlyingPointer && isCallocLikeFn(UnderlyingPointer, &TLI) &&
+        Walker->getClobberingMemoryAccess(Def) ==
+            MSSA.getMemoryAccess(UnderlyingPointer)) {
+      LLVM_DEBUG(
+          dbgs() << "DSE: Remove null store to the calloc'ed object:\n  DEAD: "
+                 << *SI << "\n  OBJECT: " << *UnderlyingPointer << '\n');
+      deleteDeadInstruction(SI);
+      ++NumRedundantStores;
+      return true;
+    }
+  }
+  return false;
+}
+
+/// Returns true if something reads \p DeadLoc after \p DeadDef, before it is
+/// overwritten by \p KillingDef. The uses of a MemoryDef include every access
+/// that may observe it, so this follows them through later MemoryDefs and
+/// MemoryPhis, stopping at \p KillingDef. Returns true as well if there are
+/// more uses than the scan limit.
+bool DSEState::isReadBefore(MemoryDef *DeadDef, const MemoryLocation &DeadLoc,
+                            MemoryDef *KillingDef) {
+  SmallVector<MemoryAccess *, 16> WorkList;
+  SmallPtrSet<MemoryAccess *, 16> Visited;
+  auto PushMemUses = [&WorkList, &Visited](MemoryAccess *Acc) {
+    for (Use &U : Acc->uses()) {
+      auto *UseAccess = cast<MemoryAccess>(U.getUser());
+      if (Visited.insert(UseAccess).second)
+        WorkList.push_back(UseAccess);
+    }
+  };
+  PushMemUses(DeadDef);
+
+  while (!WorkList.empty()) {
+    if (Visited.size() > MemorySSAScanLimit)
+      return true;
+    MemoryAccess *UseAccess = WorkList.pop_back_val();
+    if (UseAccess == KillingDef)
+      continue;
+    if (isa<MemoryPhi>(UseAccess)) {
+      PushMemUses(UseAccess);
+      continue;
+    }
+
+    Instruction *UseInst = cast<MemoryUseOrDef>(UseAccess)->getMemoryInst();
+    if (isRefSet(AA.getModRefInfo(UseInst, DeadLoc)))
+      return true;
+    if (isa<MemoryDef>(UseAccess))
+      PushMemUses(UseAccess);
+  }
+  return false;
+}
+
+/// Returns true if the write of \p DeadDef is dead because \p KillingDef,
+/// which \p DeadDef reaches, completely overwrites it on every path before it
+/// is read.
+bool DSEState::isKilledBy(MemoryDef *DeadDef, MemoryDef *KillingDef,
+                          const MemoryLocation &KillingLoc) {
+  Instruction *DeadI = DeadDef->getMemoryInst();
+  Instruction *KillingI = KillingDef->getMemoryInst();
+  if (!hasAnalyzableMemoryWrite(DeadI, TLI) || !isRemovable(DeadI))
+    return false;
+
+  MemoryLocation DeadLoc = getLocForWrite(DeadI);
+  if (!DeadLoc.Ptr)
+    return false;
+
+  // Only an alloca is dead once the function unwinds.
+  if (MayUnwind &&
+      !isa<AllocaInst>(GetUnderlyingObject(DeadLoc.Ptr, DL)))
+    return false;
+
+  // Records of partial overwrites are only valid for a single killing store,
+  // as the killing stores are not checked against each other's paths.
+  InstOverlapIntervalsTy IOL;
+  int64_t DeadOffset = 0, KillingOffset = 0;
+  if (isOverwrite(KillingLoc, DeadLoc, DL, TLI, DeadOffset, KillingOffset,
+                  DeadI, IOL, AA, &F) != OW_Complete)
+    return false;
+
+  if (isPossibleSelfRead(KillingI, KillingLoc, DeadI, TLI, AA))
+    return false;
+
+  // DeadDef reaches KillingDef without crossing a MemoryPhi, so DeadI either
+  // dominates KillingI or comes before it in the same block.
+  BasicBlock *DeadBB = DeadI->getParent();
+  BasicBlock *KillingBB = KillingI->getParent();
+  if (DeadBB != KillingBB && !PDT.dominates(KillingBB, DeadBB))
+    return false;
+
+  return !isReadBefore(DeadDef, DeadLoc, KillingDef);
+}
+
+void DSEState::deleteDeadInstruction(Instruction *I) {
+  SmallVector<Instruction *, 32> NowDeadInsts;
+
+  NowDeadInsts.push_back(I);
+  --NumFastOther;
+
+  do {
+    Instruction *DeadInst = NowDeadInsts.pop_back_val();
+    ++NumFastOther;
+
+    // Try to preserve debug information attached to the dead instruction.
+    salvageDebugInfo(*DeadInst);
+
+    if (MemoryAccess *MA = MSSA.getMemoryAccess(DeadInst))
+      Updater.removeMemoryAccess(MA);
+
+    for (unsigned op = 0, e = DeadInst->getNumOperands(); op != e; ++op) {
+      Value *Op = DeadInst->getOperand(op);
+      DeadInst->setOperand(op, nullptr);
+
+      // If this operand just became dead, add it to the NowDeadInsts list.
+      if (!Op->use_empty()) continue;
+
+      if (Instruction *OpI = dyn_cast<Instruction>(Op))
+        if (isInstructionTriviallyDead(OpI, &TLI))
+          NowDeadInsts.push_back(OpI);
+    }
+
+    Deleted.insert(DeadInst);
+    DeadInst->eraseFromParent();
+  } while (!NowDeadInsts.empty());
+}
+
+bool DSEState::run() {
+  SmallVector<Instruction *, 64> Writes;
+  for (BasicBlock &BB : F)
+    for (Instruction &I : BB) {
+      MayUnwind |= I.mayThrow();
+      if (isa_and_nonnull<MemoryDef>(MSSA.getMemoryAccess(&I)) &&
+          hasAnalyzableMemoryWrite(&I, TLI))
+        Writes.push_back(&I);
+    }
+
+  bool MadeChange = false;
+  for (Instruction *KillingI : Writes) {
+    if (Deleted.count(KillingI))
+      continue;
+    auto *KillingDef = cast<MemoryDef>(MSSA.getMemoryAccess(KillingI));
+    if (eliminateNoopStore(KillingDef)) {
+      MadeChange = true;
+      continue;
+    }
+
+    // Volatile and atomic stores still write the memory, but as they are not
+    // removable themselves, they are not used to remove others either.
+    MemoryLocation KillingLoc = getLocForWrite(KillingI);
+    if (!KillingLoc.Ptr || !isRemovable(KillingI))
+      continue;
+
+    // Walk up the MemoryDefs that reach KillingDef. Stopping at a MemoryPhi
+    // keeps every candidate on all the paths to the killing store.
+    MemoryAccess *Current = KillingDef->getDefiningAccess();
+    for (unsigned Steps = 0; Steps != MemorySSAScanLimit; ++Steps) {
+      auto *DeadDef = dyn_cast<MemoryDef>(Current);
+      if (!DeadDef || MSSA.isLiveOnEntryDef(DeadDef))
+        break;
+      Current = DeadDef->getDefiningAccess();
+
+      Instruction *DeadI = DeadDef->getMemoryInst();
+      if (!isKilledBy(DeadDef, KillingDef, KillingLoc))
+        continue;
+
+      LLVM_DEBUG(dbgs() << "DSE: Remove Dead Store:\n  DEAD: " << *DeadI
+                        << "\n  KILLER: " << *KillingI << '\n');
+      if (DeadI->getParent() != KillingI->getParent())
+        ++NumCrossBlockStores;
+      deleteDeadInstruction(DeadI);
+      ++NumFastStores;
+      MadeChange = true;
+    }
+  }
+  return MadeChange;
+}
+
+static bool eliminateDeadStoresMemorySSA(Function &F, AliasAnalysis &AA,
+                                         MemorySSA &MSSA,
+                                         PostDominatorTree &PDT,
+                                         const TargetLibraryInfo &TLI) {
+  return DSEState(F, AA, MSSA, PDT, TLI).run();
+}
+
 //===----------------------------------------------------------------------===//
 // DSE Pass
 //===----------------------------------------------------------------------===//
 PreservedAnalyses DSEPass::run(Function &F, FunctionAnalysisManager &AM) {
   AliasAnalysis *AA = &AM.getResult<AAManager>(F);
-  DominatorTree *DT = &AM.getResult<DominatorTreeAnalysis>(F);
-  MemoryDependenceResults *MD = &AM.getResult<MemoryDependenceAnalysis>(F);
   const TargetLibraryInfo *TLI = &AM.getResult<TargetLibraryAnalysis>(F);
 
+  if (EnableMemorySSA) {
+    MemorySSA &MSSA = AM.getResult<MemorySSAAnalysis>(F).getMSSA();
+    PostDominatorTree &PDT = AM.getResult<PostDominatorTreeAnalysis>(F);
+    if (!eliminateDeadStoresMemorySSA(F, *AA, MSSA, PDT, *TLI))
+      return PreservedAnalyses::all();
+
+    PreservedAnalyses PA;
+    PA.preserveSet<CFGAnalyses>();
+    PA.preserve<GlobalsAA>();
+    PA.preserve<MemorySSAAnalysis>();
+    return PA;
+  }
+
+  DominatorTree *DT = &AM.getResult<DominatorTreeAnalysis>(F);
+  MemoryDependenceResults *MD = &AM.getResult<MemoryDependenceAnalysis>(F);
   if (!eliminateDeadStores(F, AA, MD, DT, TLI))
     return PreservedAnalyses::all();
 
@@ -1356,25 +1640,39 @@ public:
     if (skipFunction(F))
       return false;
 
-    DominatorTree *DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
     AliasAnalysis *AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
-    MemoryDependenceResults *MD =
-        &getAnalysis<MemoryDependenceWrapperPass>().getMemDep();
     const TargetLibraryInfo *TLI =
         &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI();
 
+    if (EnableMemorySSA) {
+      MemorySSA &MSSA = getAnalysis<MemorySSAWrapperPass>().getMSSA();
+      PostDominatorTree &PDT =
+          getAnalysis<PostDominatorTreeWrapperPass>().getPostDomTree();
+      return eliminateDeadStoresMemorySSA(F, *AA, MSSA, PDT, *TLI);
+    }
+
+    DominatorTree *DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+    MemoryDependenceResults *MD =
+        &getAnalysis<MemoryDependenceWrapperPass>().getMemDep();
     return eliminateDeadStores(F, AA, MD, DT, TLI);
   }
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
     AU.setPreservesCFG();
-    AU.addRequired<DominatorTreeWrapperPass>();
     AU.addRequired<AAResultsWrapperPass>();
-    AU.addRequired<MemoryDependenceWrapperPass>();
     AU.addRequired<TargetLibraryInfoWrapperPass>();
-    AU.addPreserved<DominatorTreeWrapperPass>();
     AU.addPreserved<GlobalsAAWrapperPass>();
-    AU.addPreserved<MemoryDependenceWrapperPass>();
+    AU.addPreserved<DominatorTreeWrapperPass>();
+    if (EnableMemorySSA) {
+      AU.addRequired<MemorySSAWrapperPass>();
+      AU.addRequired<PostDominatorTreeWrapperPass>();
+      AU.addPreserved<MemorySSAWrapperPass>();
+      AU.addPreserved<PostDominatorTreeWrapperPass>();
+    } else {
+      AU.addRequired<DominatorTreeWrapperPass>();
+      AU.addRequired<MemoryDependenceWrapperPass>();
+      AU.addPreserved<MemoryDependenceWrapperPass>();
+    }
   }
 };
 
@@ -1388,6 +1686,8 @@ INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(GlobalsAAWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(MemoryDependenceWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(MemorySSAWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(PostDominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
 INITIALIZE_PASS_END(DSELegacyPass, "dse", "Dead Store Elimination", false,
                     false)
@@ -4996,6 +4996,24 @@ unsigned LoopVectorizationCostModel::selectInterleaveCount(bool OptForSize,
       MaxInterleaveCount = ForceTargetMaxVectorInterleaveFactor;
   }
 
+  // The scalar remainder runs up to VF * IC - 1 iterations. If the trip count
+  // is known or estimated from profile data, limit the interleave count so
+  // that the vector loop runs at least once, rather than leaving a loop of
+  // medium trip count entirely to the remainder.
+  unsigned BestKnownTC = TC;
+  if (!BestKnownTC)
+    if (Optional<unsigned> EstimatedTC = getLoopEstimatedTripCount(TheLoop))
+      BestKnownTC = *EstimatedTC;
+  if (BestKnownTC) {
+    unsigned TCInterleaveCount = PowerOf2Floor(std::max(1U, BestKnownTC / VF));
+    if (TCInterleaveCount < MaxInterleaveCount) {
+      LLVM_DEBUG(dbgs() << "LV: Limiting interleave count to "
+                        << TCInterleaveCount << " for a trip count of "
+                        << BestKnownTC << ".\n");
+      MaxInterleaveCount = TCInterleaveCount;
+    }
+  }
+
   // If we did not calculate the cost for VF (because the user selected the VF)
   // then we calculate the cost of VF here.
   if (LoopCost == 0)
@@ -6122,7 +6140,9 @@ static unsigned determineVPlanVF(const unsigned WidestVectorRegBits,
                                  LoopVectorizationCostModel &CM) {
   unsigned WidestType;
   std::tie(std::ignore, WidestType) = CM.getSmallestAndWidestTypes();
-  return WidestVectorRegBits / WidestType;
+  // Types like i24 do not evenly divide the register, and VFs must be powers
+  // of two.
+  return PowerOf2Floor(WidestVectorRegBits / WidestType);
 }
 
 VectorizationFactor
@@ -6146,6 +6166,14 @@ LoopVectorizationPlanner::planInVPlanNativePath(bool OptForSize,
                           << "overriding computed VF.\n");
         VF = 4;
       }
+
+      // Without vector registers that hold at least two elements of the
+      // widest type there is nothing to gain.
+      if (VF < 2) {
+        LLVM_DEBUG(dbgs() << "LV: Not vectorizing. Computed VF " << VF
+                          << " is too small for the outer loop.\n");
+        return VectorizationFactor::Disabled();
+      }
     }
     assert(EnableVPlanNativePath && "VPlan-native path is not enabled.");
     assert(isPowerOf2_32(VF) && "VF needs to be a power of two");
@@ -7207,6 +7235,15 @@ static bool processLoopInVPlanNativePath(
   LLVM_DEBUG(dbgs() << "Vectorizing outer loop in \""
                     << L->getHeader()->getParent()->getName() << "\"\n");
   LVP.executePlan(LB, DT);
+  ++LoopsVectorized;
+
+  // Report the vectorization decision.
+  ORE->emit([&]() {
+    return OptimizationRemark(LV_NAME, "Vectorized", L->getStartLoc(),
+                              L->getHeader())
+           << "vectorized outer loop (vectorization width: "
+           << ore::NV("VectorizationFactor", VF.Width) << ")";
+  });
 
   // Mark the loop as already vectorized to avoid vectorizing again.
   Hints.setAlreadyVectorized();
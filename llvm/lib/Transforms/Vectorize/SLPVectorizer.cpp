@@ -589,7 +589,7 @@ public:
   /// the stored value. Otherwise, the size is the width of the largest loaded
   /// value reaching V. This method is used by the vectorizer to calculate
   /// vectorization factors.
-  unsigned getVectorElementSize(Value *V) const;
+  unsigned getVectorElementSize(Value *V);
 
   /// Compute the minimum type sizes required to represent the entries in a
   /// vectorizable tree.
@@ -1817,6 +1817,11 @@ private:
   /// value must be signed-extended, rather than zero-extended, back to its
   /// original width.
   MapVector<Value *, std::pair<uint64_t, bool>> MinBWs;
+
+  /// Cache for getVectorElementSize(), for every instruction visited when
+  /// computing it. The expressions feeding the seeds of a large block overlap
+  /// a lot, and walking them again for every seed is quadratic.
+  DenseMap<Value *, unsigned> InstrElementSize;
 };
 
 } // end namespace slpvectorizer
@@ -4627,20 +4632,26 @@ void BoUpSLP::scheduleBlock(BlockScheduling *BS) {
   BS->ScheduleStart = nullptr;
 }
 
-unsigned BoUpSLP::getVectorElementSize(Value *V) const {
+unsigned BoUpSLP::getVectorElementSize(Value *V) {
   // If V is a store, just return the width of the stored value without
   // traversing the expression tree. This is the common case.
   if (auto *Store = dyn_cast<StoreInst>(V))
     return DL->getTypeSizeInBits(Store->getValueOperand()->getType());
 
+  auto Cached = InstrElementSize.find(V);
+  if (Cached != InstrElementSize.end())
+    return Cached->second;
+
   // If V is not a store, we can traverse the expression tree to find loads
   // that feed it. The type of the loaded value may indicate a more suitable
   // width than V's type. We want to base the vector element size on the width
   // of memory operations where possible.
   SmallVector<Instruction *, 16> Worklist;
   SmallPtrSet<Instruction *, 16> Visited;
-  if (auto *I = dyn_cast<Instruction>(V))
+  if (auto *I = dyn_cast<Instruction>(V)) {
     Worklist.push_back(I);
+    Visited.insert(I);
+  }
 
   // Traverse the expression tree in bottom-up order looking for loads. If we
   // encounter an instruction we don't yet handle, we give up.
@@ -4648,7 +4659,6 @@ unsigned BoUpSLP::getVectorElementSize(Value *V) const {
   auto FoundUnknownInst = false;
   while (!Worklist.empty() && !FoundUnknownInst) {
     auto *I = Worklist.pop_back_val();
-    Visited.insert(I);
 
     // We should only be looking at scalar instructions here. If the current
     // instruction has a vector type, give up.
@@ -4663,12 +4673,15 @@ unsigned BoUpSLP::getVectorElementSize(Value *V) const {
 
     // Otherwise, we need to visit the operands of the instruction. We only
     // handle the interesting cases from buildTree here. If an operand is an
-    // instruction we haven't yet visited, we add it to the worklist.
+    // instruction we haven't yet visited, we add it to the worklist. Only PHIs
+    // lead out of the block of the instruction: buildTree does not look any
+    // further either, and it keeps the walk from covering the whole function.
     else if (isa<PHINode>(I) || isa<CastInst>(I) || isa<GetElementPtrInst>(I) ||
              isa<CmpInst>(I) || isa<SelectInst>(I) || isa<BinaryOperator>(I)) {
       for (Use &U : I->operands())
         if (auto *J = dyn_cast<Instruction>(U.get()))
-          if (!Visited.count(J))
+          if ((isa<PHINode>(I) || J->getParent() == I->getParent()) &&
+              Visited.insert(J).second)
             Worklist.push_back(J);
     }
 
@@ -4680,9 +4693,13 @@ unsigned BoUpSLP::getVectorElementSize(Value *V) const {
   // If we didn't encounter a memory access in the expression tree, or if we
   // gave up for some reason, just return the width of V.
   if (!MaxWidth || FoundUnknownInst)
-    return DL->getTypeSizeInBits(V->getType());
+    return InstrElementSize[V] = DL->getTypeSizeInBits(V->getType());
 
-  // Otherwise, return the maximum width we found.
+  // Otherwise, return the maximum width we found. It is only a heuristic for
+  // choosing the vectorization factor, so the instructions visited on the way
+  // can share it: their expression trees are part of the one of V.
+  for (Instruction *I : Visited)
+    InstrElementSize[I] = MaxWidth;
   return MaxWidth;
 }
 
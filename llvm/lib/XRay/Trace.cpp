@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include "llvm/XRay/Trace.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/DataExtractor.h"
 #include "llvm/Support/Error.h"
@@ -22,6 +23,7 @@
 #include "llvm/XRay/FDRTraceExpander.h"
 #include "llvm/XRay/FileHeaderReader.h"
 #include "llvm/XRay/YAMLXRayRecord.h"
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -340,6 +342,135 @@ Error loadFDRLog(StringRef Data, bool IsLittleEndian,
   return Error::success();
 }
 
+// Metadata records are always 16 bytes long, which lets us recover the offset
+// at which the record a producer just returned began.
+constexpr uint64_t kMetadataRecordSize = 16;
+
+// DataExtractor offsets are only 32 bits wide, so we only ever decode windows
+// of a trace up to this size, and move the window forward once we've read past
+// kRebaseThreshold bytes into it.
+constexpr uint64_t kMaxWindowSize = std::numeric_limits<uint32_t>::max();
+constexpr uint64_t kRebaseThreshold = uint64_t(1) << 31;
+
+// Builds an index of the blocks in an FDR mode log, grouped by thread, without
+// keeping any of the records around. The blocks are delimited the same way
+// the BlockIndexer does, but we only remember where a producer may be
+// restarted to get at each of them again, along with their wallclock time.
+using BlockLocations = std::vector<TraceStream::BlockLocation>;
+
+Error indexFDRLog(StringRef Data, bool IsLittleEndian,
+                  XRayFileHeader &FileHeader,
+                  std::vector<TraceStream::ThreadKey> &Threads,
+                  std::vector<BlockLocations> &Blocks) {
+  if (Data.size() < 32)
+    return createStringError(std::make_error_code(std::errc::invalid_argument),
+                             "Not enough bytes for an XRay FDR log.");
+  DataExtractor HeaderDE(Data, IsLittleEndian, 8);
+
+  uint32_t HeaderOffset = 0;
+  auto FileHeaderOrError = readBinaryFormatHeader(HeaderDE, HeaderOffset);
+  if (!FileHeaderOrError)
+    return FileHeaderOrError.takeError();
+  FileHeader = std::move(FileHeaderOrError.get());
+
+  DenseMap<TraceStream::ThreadKey, size_t> ThreadIndices;
+  TraceStream::ThreadKey CurrentKey{0, 0};
+  TraceStream::BlockLocation Current;
+  Current.Offset = HeaderOffset;
+  bool CurrentHasRecords = false;
+  auto Flush = [&] {
+    auto It = ThreadIndices.insert({CurrentKey, Threads.size()});
+    if (It.second) {
+      Threads.push_back(CurrentKey);
+      Blocks.emplace_back();
+    }
+    Blocks[It.first->second].push_back(Current);
+  };
+
+  // A fresh producer can be started at the beginning of the records, and then
+  // at every buffer extents record (version 3 and newer) or at every new
+  // buffer record (older versions). We count how many records we've seen since
+  // the latest such restart point.
+  uint64_t RestartOffset = HeaderOffset;
+  uint32_t SinceRestart = 0;
+
+  uint64_t Base = HeaderOffset;
+  uint32_t Skip = 0;
+  while (Base < Data.size()) {
+    StringRef Window = Data.substr(Base, kMaxWindowSize);
+    DataExtractor DE(Window, IsLittleEndian, 8);
+    uint32_t OffsetPtr = 0;
+    FileBasedRecordProducer P(FileHeader, DE, OffsetPtr);
+    bool Rebase = false;
+    for (uint32_t I = 0; DE.isValidOffsetForDataOfSize(OffsetPtr, 1); ++I) {
+      auto R = P.produce();
+      if (!R)
+        return R.takeError();
+      if (I < Skip)
+        continue;
+
+      uint64_t RecordOffset = Base + OffsetPtr - kMetadataRecordSize;
+      Record *Rec = R->get();
+      ++SinceRestart;
+      if (isa<BufferExtents>(Rec)) {
+        if (FileHeader.Version >= 3) {
+          RestartOffset = RecordOffset;
+          SinceRestart = 1;
+        }
+      } else if (auto *NB = dyn_cast<NewBufferRecord>(Rec)) {
+        if (CurrentHasRecords)
+          Flush();
+        if (FileHeader.Version < 3) {
+          RestartOffset = RecordOffset;
+          SinceRestart = 1;
+        }
+        CurrentKey = {0, NB->tid()};
+        Current = {};
+        Current.Offset = RestartOffset;
+        Current.Skip = SinceRestart - 1;
+        CurrentHasRecords = true;
+      } else if (auto *W = dyn_cast<WallclockRecord>(Rec)) {
+        Current.Seconds = W->seconds();
+        Current.Nanos = W->nanos();
+        CurrentHasRecords = true;
+      } else if (auto *PR = dyn_cast<PIDRecord>(Rec)) {
+        CurrentKey.first = PR->pid();
+        CurrentHasRecords = true;
+      } else {
+        CurrentHasRecords = true;
+      }
+
+      if (OffsetPtr > kRebaseThreshold && RestartOffset > Base) {
+        Rebase = true;
+        break;
+      }
+    }
+
+    if (!Rebase) {
+      if (Base + Window.size() == Data.size())
+        break;
+      // We ran out of window before reaching the end of the data.
+      if (RestartOffset == Base)
+        return createStringError(
+            std::make_error_code(std::errc::executable_format_error),
+            "Buffer at offset %" PRIu64 " is too large.", RestartOffset);
+    }
+    Base = RestartOffset;
+    Skip = SinceRestart;
+  }
+  if (CurrentHasRecords)
+    Flush();
+
+  // Order each thread's blocks by wallclock time, like loadFDRLog(...).
+  for (auto &ThreadBlocks : Blocks)
+    llvm::stable_sort(ThreadBlocks, [](const TraceStream::BlockLocation &L,
+                                       const TraceStream::BlockLocation &R) {
+      return std::make_pair(L.Seconds, L.Nanos) <
+             std::make_pair(R.Seconds, R.Nanos);
+    });
+  return Error::success();
+}
+
 Error loadYAMLLog(StringRef Data, XRayFileHeader &FileHeader,
                   std::vector<XRayRecord> &Records) {
   YAMLXRayTrace Trace;
@@ -467,3 +598,149 @@ Expected<Trace> llvm::xray::loadTrace(const DataExtractor &DE, bool Sort) {
 
   return std::move(T);
 }
+
+TraceStream::~TraceStream() = default;
+
+Error TraceStream::forEachRecord(size_t ThreadIndex,
+                                 RecordCallback Callback) const {
+  assert(ThreadIndex < Threads.size() && "Thread index out of range!");
+  if (Blocks.empty()) {
+    for (const auto &R : Records[ThreadIndex])
+      if (auto E = Callback(R))
+        return E;
+    return Error::success();
+  }
+
+  // The expander hands us records through a function_ref which can't fail, so
+  // we stash the first error from the callback and stop at the next record.
+  Error CallbackError = Error::success();
+  auto Adder = [&](const XRayRecord &R) {
+    if (CallbackError)
+      return;
+    CallbackError = Callback(R);
+  };
+  TraceExpander Expander(Adder, FileHeader.Version);
+  for (const auto &B : Blocks[ThreadIndex]) {
+    StringRef Window = Data.substr(B.Offset, kMaxWindowSize);
+    DataExtractor DE(Window, IsLittleEndian, 8);
+    uint32_t OffsetPtr = 0;
+    FileBasedRecordProducer P(FileHeader, DE, OffsetPtr);
+    BlockVerifier Verifier;
+    bool BlockHasRecords = false;
+    for (uint32_t I = 0; DE.isValidOffsetForDataOfSize(OffsetPtr, 1); ++I) {
+      auto R = P.produce();
+      if (!R)
+        return joinErrors(std::move(CallbackError), R.takeError());
+      if (I < B.Skip || isa<BufferExtents>(R->get()))
+        continue;
+
+      // The next block starts at the next new buffer record.
+      if (isa<NewBufferRecord>(R->get()) && BlockHasRecords)
+        break;
+      BlockHasRecords = true;
+
+      if (auto E = (*R)->apply(Verifier))
+        return joinErrors(std::move(CallbackError), std::move(E));
+      if (auto E = (*R)->apply(Expander))
+        return joinErrors(std::move(CallbackError), std::move(E));
+      if (CallbackError)
+        return CallbackError;
+    }
+    if (auto E = Verifier.verify())
+      return joinErrors(std::move(CallbackError), std::move(E));
+  }
+  if (auto E = Expander.flush())
+    return joinErrors(std::move(CallbackError), std::move(E));
+  return CallbackError;
+}
+
+Error TraceStream::forEachRecord(RecordCallback Callback) const {
+  for (size_t I = 0, E = Threads.size(); I != E; ++I)
+    if (auto Err = forEachRecord(I, Callback))
+      return Err;
+  return Error::success();
+}
+
+Expected<std::unique_ptr<TraceStream>>
+llvm::xray::openTraceStream(StringRef Filename) {
+  int Fd;
+  if (auto EC = sys::fs::openFileForRead(Filename, Fd)) {
+    return make_error<StringError>(
+        Twine("Cannot read log from '") + Filename + "'", EC);
+  }
+
+  uint64_t FileSize;
+  if (auto EC = sys::fs::file_size(Filename, FileSize)) {
+    sys::fs::closeFile(Fd);
+    return make_error<StringError>(
+        Twine("Cannot read log from '") + Filename + "'", EC);
+  }
+  if (FileSize < 4) {
+    sys::fs::closeFile(Fd);
+    return make_error<StringError>(
+        Twine("File '") + Filename + "' too small for XRay.",
+        std::make_error_code(std::errc::executable_format_error));
+  }
+
+  // The mapping outlives the file descriptor, and stays with the stream.
+  std::error_code EC;
+  auto MappedFile = llvm::make_unique<sys::fs::mapped_file_region>(
+      Fd, sys::fs::mapped_file_region::mapmode::readonly, FileSize, 0, EC);
+  sys::fs::closeFile(Fd);
+  if (EC) {
+    return make_error<StringError>(
+        Twine("Cannot read log from '") + Filename + "'", EC);
+  }
+  auto Data = StringRef(MappedFile->data(), MappedFile->size());
+
+  // TODO: Lift the endianness and implementation selection here.
+  DataExtractor LittleEndianDE(Data, true, 8);
+  auto StreamOrError = openTraceStream(LittleEndianDE);
+  if (!StreamOrError) {
+    consumeError(StreamOrError.takeError());
+    DataExtractor BigEndianDE(Data, false, 8);
+    StreamOrError = openTraceStream(BigEndianDE);
+  }
+  if (StreamOrError)
+    (*StreamOrError)->MappedFile = std::move(MappedFile);
+  return StreamOrError;
+}
+
+Expected<std::unique_ptr<TraceStream>>
+llvm::xray::openTraceStream(const DataExtractor &DE) {
+  std::unique_ptr<TraceStream> TS(new TraceStream());
+  TS->Data = DE.getData();
+  TS->IsLittleEndian = DE.isLittleEndian();
+
+  // See loadTrace(...) for how we detect the file type. Only FDR mode logs can
+  // be streamed, everything else is loaded in full.
+  DataExtractor HeaderExtractor(DE.getData(), DE.isLittleEndian(), 8);
+  uint32_t OffsetPtr = 0;
+  uint16_t Version = HeaderExtractor.getU16(&OffsetPtr);
+  uint16_t Type = HeaderExtractor.getU16(&OffsetPtr);
+
+  enum BinaryFormatType { FLIGHT_DATA_RECORDER_FORMAT = 1 };
+
+  if (Type == FLIGHT_DATA_RECORDER_FORMAT && Version >= 1 && Version <= 5) {
+    if (auto E = indexFDRLog(TS->Data, TS->IsLittleEndian, TS->FileHeader,
+                             TS->Threads, TS->Blocks))
+      return std::move(E);
+    return std::move(TS);
+  }
+
+  auto TraceOrError = loadTrace(DE);
+  if (!TraceOrError)
+    return TraceOrError.takeError();
+  TS->FileHeader = TraceOrError->getFileHeader();
+  DenseMap<TraceStream::ThreadKey, size_t> ThreadIndices;
+  for (const auto &R : *TraceOrError) {
+    auto It = ThreadIndices.insert(
+        {{R.PId, static_cast<int32_t>(R.TId)}, TS->Threads.size()});
+    if (It.second) {
+      TS->Threads.push_back(It.first->first);
+      TS->Records.emplace_back();
+    }
+    TS->Records[It.first->second].push_back(R);
+  }
+  return std::move(TS);
+}
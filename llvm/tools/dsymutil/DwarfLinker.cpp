@@ -2674,6 +2674,27 @@ bool DwarfLinker::link(const DebugMap &Map) {
   if (MaxDwarfVersion == 0)
     MaxDwarfVersion = 3;
 
+  // The analyze and clone steps below have to see the objects in order: the
+  // ODR uniquing in analyzeContextInfo and the offsets assigned by the cloner
+  // depend on it. Extracting the DIEs of an object only touches its own
+  // DWARFContext though, so when we have threads to spare we do it for all
+  // the objects upfront and in parallel, which takes most of the parsing out
+  // of the serial part of the link. This keeps the debug info of every object
+  // in memory until it is cloned, which the multi-threaded link can already
+  // end up doing when analyze runs ahead of clone.
+  if (Options.Threads > 1 && NumObjects > 1) {
+    ThreadPool ParsePool(std::min<unsigned>(Options.Threads, NumObjects));
+    for (LinkContext &LinkContext : ObjectContexts) {
+      if (!LinkContext.ObjectFile || !LinkContext.DwarfContext)
+        continue;
+      ParsePool.async([&LinkContext]() {
+        for (const auto &CU : LinkContext.DwarfContext->compile_units())
+          CU->getNumDIEs();
+      });
+    }
+    ParsePool.wait();
+  }
+
   // At this point we know how much data we have emitted. We use this value to
   // compare canonical DIE offsets in analyzeContextInfo to see if a definition
   // is already emitted, without being affected by canonical die offsets set
@@ -28,6 +28,7 @@
 #include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
 #include "llvm/ExecutionEngine/Orc/LLJIT.h"
 #include "llvm/ExecutionEngine/Orc/OrcRemoteTargetClient.h"
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
 #include "llvm/ExecutionEngine/OrcMCJITReplacement.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/IR/IRBuilder.h"
@@ -113,6 +114,12 @@ namespace {
                "rather than individual functions"),
       cl::init(false));
 
+  cl::opt<bool> SpeculateCompiles(
+      "speculate-compiles",
+      cl::desc("Compile the likely callees of each function in the background "
+               "when it is first called (requires -compile-threads)"),
+      cl::init(false));
+
   cl::list<std::string>
       JITDylibs("jd",
                 cl::desc("Specifies the JITDylib to be used for any subsequent "
@@ -782,9 +789,20 @@ int runOrcLazyJIT(const char *ProgName) {
                         ? Optional<CodeModel::Model>(CMModel)
                         : None);
 
+  // Objects are cached across runs, keyed on the module and target. The cache
+  // must outlive the JIT.
+  std::unique_ptr<orc::PersistentObjectCache> ObjCache;
+  if (EnableCacheManager) {
+    ObjCache = ExitOnErr(orc::PersistentObjectCache::Create(
+        ObjectCacheDir.empty() ? std::string(".") : ObjectCacheDir,
+        *Builder.getJITTargetMachineBuilder()));
+    Builder.setObjectCache(ObjCache.get());
+  }
+
   Builder.setLazyCompileFailureAddr(
       pointerToJITTargetAddress(exitOnLazyCallThroughFailure));
   Builder.setNumCompileThreads(LazyJITCompileThreads);
+  Builder.setSpeculateCompiles(SpeculateCompiles);
 
   auto J = ExitOnErr(Builder.create());
 
@@ -351,8 +351,25 @@ std::unique_ptr<CoverageMapping> CodeCoverageTool::load() {
     if (modifiedTimeGT(ObjectFilename, PGOFilename))
       warning("profile data may be out of date - object is newer",
               ObjectFilename);
+
+  // If NumThreads is not specified, auto-detect a good default.
+  auto NumThreads = ViewOpts.NumThreads;
+  if (NumThreads == 0)
+    NumThreads =
+        std::max(1U, std::min(llvm::heavyweight_hardware_concurrency(),
+                              unsigned(ObjectFilenames.size())));
+
+  // Only the functions in the given source files are going to be shown, so
+  // don't decode the others. This isn't possible with path remapping, which
+  // needs all of the files to find out what the source files are called in
+  // the coverage data.
+  std::vector<StringRef> FilteredSourceFiles;
+  if (!PathRemapping)
+    FilteredSourceFiles.assign(SourceFiles.begin(), SourceFiles.end());
+
   auto CoverageOrErr =
-      CoverageMapping::load(ObjectFilenames, PGOFilename, CoverageArches);
+      CoverageMapping::load(ObjectFilenames, PGOFilename, CoverageArches,
+                            NumThreads, FilteredSourceFiles);
   if (Error E = CoverageOrErr.takeError()) {
     error("Failed to load coverage: " + toString(std::move(E)),
           join(ObjectFilenames.begin(), ObjectFilenames.end(), ", "));
@@ -647,7 +664,8 @@ int CodeCoverageTool::run(Command Cmd, int argc, const char **argv) {
 
   cl::opt<unsigned> NumThreads(
       "num-threads", cl::init(0),
-      cl::desc("Number of merge threads to use (default: autodetect)"));
+      cl::desc("Number of threads to load the coverage data and to render "
+               "files with (default: autodetect)"));
   cl::alias NumThreadsA("j", cl::desc("Alias for --num-threads"),
                         cl::aliasopt(NumThreads));
 
@@ -4,6 +4,8 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/MC/MCSection.h"
 #include "llvm/MC/MCStreamer.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/StringSaver.h"
 #include <cassert>
 
 namespace llvm {
@@ -32,23 +34,31 @@ class DWPStringPool {
 
   MCStreamer &Out;
   MCSection *Sec;
+  // The pool keeps its own copy of the strings, so that the input files don't
+  // have to outlive it.
+  BumpPtrAllocator Alloc;
+  StringSaver Saver;
   DenseMap<const char *, uint32_t, CStrDenseMapInfo> Pool;
   uint32_t Offset = 0;
 
 public:
-  DWPStringPool(MCStreamer &Out, MCSection *Sec) : Out(Out), Sec(Sec) {}
+  DWPStringPool(MCStreamer &Out, MCSection *Sec)
+      : Out(Out), Sec(Sec), Saver(Alloc) {}
 
   uint32_t getOffset(const char *Str, unsigned Length) {
     assert(strlen(Str) + 1 == Length && "Ensure length hint is correct");
 
-    auto Pair = Pool.insert(std::make_pair(Str, Offset));
-    if (Pair.second) {
-      Out.SwitchSection(Sec);
-      Out.EmitBytes(StringRef(Str, Length));
-      Offset += Length;
-    }
+    auto I = Pool.find(Str);
+    if (I != Pool.end())
+      return I->second;
 
-    return Pair.first->second;
+    StringRef Saved = Saver.save(StringRef(Str, Length - 1));
+    Pool.insert(std::make_pair(Saved.data(), Offset));
+    Out.SwitchSection(Sec);
+    Out.EmitBytes(StringRef(Saved.data(), Length));
+    uint32_t StrOffset = Offset;
+    Offset += Length;
+    return StrOffset;
   }
 };
 }
@@ -9,6 +9,7 @@
 #include "Analysis.h"
 #include "BenchmarkResult.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/Support/FormatVariadic.h"
 #include <limits>
@@ -250,6 +251,29 @@ Analysis::makePointsPerSchedClass() const {
   return Entries;
 }
 
+std::vector<Analysis::SchedClassCluster> Analysis::makeSchedClassClusters(
+    const ResolvedSchedClassAndPoints &RSCAndPoints) const {
+  std::vector<SchedClassCluster> SchedClassClusters;
+  for (const size_t PointId : RSCAndPoints.PointIds) {
+    const auto &ClusterId = Clustering_.getClusterIdForPoint(PointId);
+    if (!ClusterId.isValid())
+      continue; // Ignore noise and errors. FIXME: take noise into account ?
+    if (ClusterId.isUnstable() ^ AnalysisDisplayUnstableOpcodes_)
+      continue; // Either display stable or unstable clusters only.
+    auto SchedClassClusterIt =
+        std::find_if(SchedClassClusters.begin(), SchedClassClusters.end(),
+                     [ClusterId](const SchedClassCluster &C) {
+                       return C.id() == ClusterId;
+                     });
+    if (SchedClassClusterIt == SchedClassClusters.end()) {
+      SchedClassClusters.emplace_back();
+      SchedClassClusterIt = std::prev(SchedClassClusters.end());
+    }
+    SchedClassClusterIt->addPoint(PointId, Clustering_);
+  }
+  return SchedClassClusters;
+}
+
 // Uops repeat the same opcode over again. Just show this opcode and show the
 // whole snippet only on hover.
 static void writeUopsSnippetHtml(llvm::raw_ostream &OS,
@@ -514,25 +538,8 @@ llvm::Error Analysis::run<Analysis::PrintSchedClassInconsistencies>(
   for (const auto &RSCAndPoints : makePointsPerSchedClass()) {
     if (!RSCAndPoints.RSC.SCDesc)
       continue;
-    // Bucket sched class points into sched class clusters.
-    std::vector<SchedClassCluster> SchedClassClusters;
-    for (const size_t PointId : RSCAndPoints.PointIds) {
-      const auto &ClusterId = Clustering_.getClusterIdForPoint(PointId);
-      if (!ClusterId.isValid())
-        continue; // Ignore noise and errors. FIXME: take noise into account ?
-      if (ClusterId.isUnstable() ^ AnalysisDisplayUnstableOpcodes_)
-        continue; // Either display stable or unstable clusters only.
-      auto SchedClassClusterIt =
-          std::find_if(SchedClassClusters.begin(), SchedClassClusters.end(),
-                       [ClusterId](const SchedClassCluster &C) {
-                         return C.id() == ClusterId;
-                       });
-      if (SchedClassClusterIt == SchedClassClusters.end()) {
-        SchedClassClusters.emplace_back();
-        SchedClassClusterIt = std::prev(SchedClassClusters.end());
-      }
-      SchedClassClusterIt->addPoint(PointId, Clustering_);
-    }
+    const std::vector<SchedClassCluster> SchedClassClusters =
+        makeSchedClassClusters(RSCAndPoints);
 
     // Print any scheduling class that has at least one cluster that does not
     // match the checked-in data.
@@ -563,5 +570,113 @@ llvm::Error Analysis::run<Analysis::PrintSchedClassInconsistencies>(
   return llvm::Error::success();
 }
 
+// Returns `Name` with all characters that are not valid in a TableGen
+// identifier replaced by underscores.
+static std::string makeTdIdentifier(llvm::StringRef Name) {
+  std::string Result;
+  for (const char C : Name)
+    Result.push_back(llvm::isAlnum(C) ? C : '_');
+  return Result;
+}
+
+void Analysis::printSchedClassCorrectionTd(const SchedClassCluster &Cluster,
+                                           const ResolvedSchedClass &RSC,
+                                           llvm::raw_ostream &OS) const {
+  const auto &Points = Clustering_.getPoints();
+  const InstructionBenchmark::ModeE Mode = Points[0].Mode;
+  const auto &SM = SubtargetInfo_->getSchedModel();
+  const auto &Stats = Cluster.getCentroid().getStats();
+#if !defined(NDEBUG) || defined(LLVM_ENABLE_DUMP)
+  const std::string SchedClassName = RSC.SCDesc->Name;
+#else
+  const std::string SchedClassName =
+      ("SchedClass" + llvm::Twine(RSC.SchedClassId)).str();
+#endif
+
+  // Describe the measurements that do not match the model.
+  OS << "// Sched class " << SchedClassName << ", cluster "
+     << Cluster.id().getId() << ":\n";
+  if (RSC.WasVariant)
+    OS << "//   (resolved from a variant sched class)\n";
+  const std::vector<BenchmarkMeasure> SchedClassPoint =
+      RSC.getAsPoint(Mode, *SubtargetInfo_, Stats);
+  for (size_t I = 0, E = Stats.size(); I < E; ++I) {
+    OS << "//   " << Stats[I].key() << ": measured "
+       << llvm::formatv("{0:F}", Stats[I].avg());
+    if (I < SchedClassPoint.size())
+      OS << ", model "
+         << llvm::formatv("{0:F}", SchedClassPoint[I].PerInstructionValue);
+    OS << "\n";
+  }
+  if (Mode == InstructionBenchmark::InverseThroughput) {
+    OS << "//   inverse throughput does not map to a SchedWriteRes, no "
+          "correction proposed.\n\n";
+    return;
+  }
+
+  // The opcodes of the cluster, in a stable order.
+  std::vector<llvm::StringRef> Opcodes;
+  for (const size_t PointId : Cluster.getPointIds())
+    Opcodes.push_back(
+        InstrInfo_->getName(Points[PointId].keyInstruction().getOpcode()));
+  llvm::sort(Opcodes);
+  Opcodes.erase(std::unique(Opcodes.begin(), Opcodes.end()), Opcodes.end());
+
+  const ProposedSchedWriteRes Proposal =
+      RSC.proposeCorrection(Mode, *SubtargetInfo_, Stats);
+  const std::string WriteName = makeTdIdentifier(SchedClassName) +
+                                "_Cluster" +
+                                std::to_string(Cluster.id().getId());
+  OS << "def " << WriteName << " : SchedWriteRes<[";
+  bool First = true;
+  for (const auto &Resource : Proposal.Resources) {
+    OS << (First ? "" : ", ") << SM.getProcResource(Resource.first)->Name;
+    First = false;
+  }
+  OS << "]> {\n";
+  OS << "  let Latency = " << Proposal.Latency << ";\n";
+  OS << "  let NumMicroOps = " << Proposal.NumMicroOps << ";\n";
+  if (!Proposal.Resources.empty()) {
+    OS << "  let ResourceCycles = [";
+    First = true;
+    for (const auto &Resource : Proposal.Resources) {
+      OS << (First ? "" : ", ") << Resource.second;
+      First = false;
+    }
+    OS << "];\n";
+  }
+  OS << "}\n";
+  OS << "def : InstRW<[" << WriteName << "], (instrs "
+     << llvm::join(Opcodes, ", ") << ")>;\n\n";
+}
+
+template <>
+llvm::Error Analysis::run<Analysis::PrintSchedClassCorrections>(
+    llvm::raw_ostream &OS) const {
+  if (Clustering_.getPoints().empty())
+    return llvm::Error::success();
+
+  const auto &FirstPoint = Clustering_.getPoints()[0];
+  OS << "// Scheduling model corrections proposed by llvm-exegesis.\n";
+  OS << "// Triple: " << FirstPoint.LLVMTriple << "\n";
+  OS << "// Cpu: " << FirstPoint.CpuName << "\n\n";
+
+  for (const auto &RSCAndPoints : makePointsPerSchedClass()) {
+    if (!RSCAndPoints.RSC.SCDesc || !RSCAndPoints.RSC.SCDesc->isValid())
+      continue;
+    for (const SchedClassCluster &Cluster :
+         makeSchedClassClusters(RSCAndPoints)) {
+      // Only propose corrections for clusters that do not match the model.
+      if (!Cluster.getCentroid().validate(FirstPoint.Mode) ||
+          Cluster.measurementsMatch(*SubtargetInfo_, RSCAndPoints.RSC,
+                                    Clustering_,
+                                    AnalysisInconsistencyEpsilonSquared_))
+        continue;
+      printSchedClassCorrectionTd(Cluster, RSCAndPoints.RSC, OS);
+    }
+  }
+  return llvm::Error::success();
+}
+
 } // namespace exegesis
 } // namespace llvm
@@ -11,6 +11,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/Support/FormatVariadic.h"
+#include <cmath>
 #include <limits>
 #include <unordered_set>
 #include <vector>
@@ -239,6 +240,53 @@ ResolvedSchedClass::resolveSchedClassId(
   return std::make_pair(SchedClassId, WasVariant);
 }
 
+std::vector<std::pair<uint16_t, unsigned>>
+proposeProcResUsage(const llvm::MCSchedModel &SM,
+                    llvm::ArrayRef<std::pair<uint16_t, float>> UnitPressure) {
+  // Pressure below this value is considered to be measurement noise.
+  static constexpr const float kMinPressure = 0.1f;
+  const auto toCycles = [](float Pressure) -> unsigned {
+    return std::max<long>(1, std::lround(Pressure));
+  };
+
+  llvm::SmallVector<std::pair<uint16_t, float>, 8> Used;
+  float TotalPressure = 0.0f;
+  for (const auto &Pressure : UnitPressure) {
+    if (Pressure.second < kMinPressure)
+      continue;
+    Used.push_back(Pressure);
+    TotalPressure += Pressure.second;
+  }
+
+  if (Used.size() > 1) {
+    // Find a ProcResGroup made of exactly the used units.
+    for (unsigned I = 1, E = SM.getNumProcResourceKinds(); I < E; ++I) {
+      const llvm::MCProcResourceDesc *const ProcResDesc =
+          SM.getProcResource(I);
+      if (ProcResDesc->SubUnitsIdxBegin == nullptr ||
+          ProcResDesc->NumUnits != Used.size())
+        continue;
+      const bool IsExactGroup = llvm::all_of(
+          llvm::make_range(ProcResDesc->SubUnitsIdxBegin,
+                           ProcResDesc->SubUnitsIdxBegin +
+                               ProcResDesc->NumUnits),
+          [&Used](const unsigned SubResIdx) {
+            return llvm::any_of(
+                Used, [SubResIdx](const std::pair<uint16_t, float> &U) {
+                  return U.first == SubResIdx;
+                });
+          });
+      if (IsExactGroup)
+        return {{static_cast<uint16_t>(I), toCycles(TotalPressure)}};
+    }
+  }
+
+  std::vector<std::pair<uint16_t, unsigned>> Result;
+  for (const auto &U : Used)
+    Result.emplace_back(U.first, toCycles(U.second));
+  return Result;
+}
+
 // Returns a ProxResIdx by id or name.
 static unsigned findProcResIdx(const llvm::MCSubtargetInfo &STI,
                                const llvm::StringRef NameOrId) {
@@ -315,5 +363,37 @@ std::vector<BenchmarkMeasure> ResolvedSchedClass::getAsPoint(
   return SchedClassPoint;
 }
 
+ProposedSchedWriteRes ResolvedSchedClass::proposeCorrection(
+    InstructionBenchmark::ModeE Mode, const llvm::MCSubtargetInfo &STI,
+    ArrayRef<PerInstructionStats> Representative) const {
+  // Start from the model data.
+  ProposedSchedWriteRes Result;
+  for (unsigned I = 0; I < SCDesc->NumWriteLatencyEntries; ++I)
+    Result.Latency = std::max<unsigned>(
+        Result.Latency, STI.getWriteLatencyEntry(SCDesc, I)->Cycles);
+  Result.NumMicroOps = SCDesc->NumMicroOps;
+  for (const llvm::MCWriteProcResEntry &WPR : NonRedundantWriteProcRes)
+    Result.Resources.emplace_back(WPR.ProcResourceIdx, WPR.Cycles);
+
+  if (Mode == InstructionBenchmark::Latency) {
+    assert(Representative.size() == 1 && "Latency is a single measure.");
+    Result.Latency = std::lround(Representative[0].avg());
+  } else if (Mode == InstructionBenchmark::Uops) {
+    llvm::SmallVector<std::pair<uint16_t, float>, 8> UnitPressure;
+    for (const PerInstructionStats &Stats : Representative) {
+      if (Stats.key() == "NumMicroOps") {
+        Result.NumMicroOps = std::lround(Stats.avg());
+        continue;
+      }
+      if (uint16_t ProcResIdx = findProcResIdx(STI, Stats.key()))
+        UnitPressure.emplace_back(ProcResIdx, Stats.avg());
+    }
+    Result.Resources = proposeProcResUsage(STI.getSchedModel(), UnitPressure);
+  }
+  // Inverse throughput does not map directly to a SchedWriteRes field, keep
+  // the model data.
+  return Result;
+}
+
 } // namespace exegesis
 } // namespace llvm
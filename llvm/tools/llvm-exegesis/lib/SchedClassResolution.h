@@ -35,6 +35,24 @@ std::vector<std::pair<uint16_t, float>> computeIdealizedProcResPressure(
     const llvm::MCSchedModel &SM,
     llvm::SmallVector<llvm::MCWriteProcResEntry, 8> WPRS);
 
+// Proposes the ProcRes usage of an instruction given the measured pressure on
+// each ProcRes unit. This is the inverse of computeIdealizedProcResPressure:
+// units with a non-negligible pressure are merged into the ProcResGroup that
+// they exactly form, if there is one, and are used individually otherwise.
+// Returns a list of (ProcResIdx, cycles).
+std::vector<std::pair<uint16_t, unsigned>>
+proposeProcResUsage(const llvm::MCSchedModel &SM,
+                    llvm::ArrayRef<std::pair<uint16_t, float>> UnitPressure);
+
+// Scheduling data proposed for a sched class, in the form of a TableGen
+// SchedWriteRes.
+struct ProposedSchedWriteRes {
+  unsigned Latency = 0;
+  unsigned NumMicroOps = 0;
+  // A list of (ProcResIdx, cycles).
+  std::vector<std::pair<uint16_t, unsigned>> Resources;
+};
+
 // An llvm::MCSchedClassDesc augmented with some additional data.
 struct ResolvedSchedClass {
   ResolvedSchedClass(const llvm::MCSubtargetInfo &STI,
@@ -49,6 +67,13 @@ struct ResolvedSchedClass {
   getAsPoint(InstructionBenchmark::ModeE Mode, const llvm::MCSubtargetInfo &STI,
              ArrayRef<PerInstructionStats> Representative) const;
 
+  // Returns the scheduling data of the sched class, with the values that are
+  // measured in `Mode` replaced by the `Representative` measurements.
+  ProposedSchedWriteRes
+  proposeCorrection(InstructionBenchmark::ModeE Mode,
+                    const llvm::MCSubtargetInfo &STI,
+                    ArrayRef<PerInstructionStats> Representative) const;
+
   const unsigned SchedClassId;
   const llvm::MCSchedClassDesc *const SCDesc;
   const bool WasVariant; // Whether the original class was variant.
@@ -30,13 +30,21 @@
 #include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Errno.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
 #include <string>
+#ifdef __linux__
+#include <sched.h>
+#endif
 
 namespace llvm {
 namespace exegesis {
@@ -85,6 +93,18 @@ static cl::opt<unsigned>
                    cl::desc("number of time to repeat the asm snippet"),
                    cl::cat(BenchmarkOptions), cl::init(10000));
 
+static cl::list<unsigned> BenchmarkCpus(
+    "benchmark-cpus",
+    cl::desc("comma-separated list of cpus to run benchmarks on; one "
+             "benchmarking thread is started and pinned to each cpu"),
+    cl::CommaSeparated, cl::cat(BenchmarkOptions));
+
+static cl::opt<bool> ResumeBenchmarks(
+    "resume",
+    cl::desc("append results to --benchmarks-file instead of overwriting it, "
+             "and skip opcodes that it already has results for"),
+    cl::cat(BenchmarkOptions), cl::init(false));
+
 static cl::opt<bool> IgnoreInvalidSchedClass(
     "ignore-invalid-sched-class",
     cl::desc("ignore instructions that do not define a sched class"),
@@ -123,6 +143,11 @@ static cl::opt<std::string>
     AnalysisInconsistenciesOutputFile("analysis-inconsistencies-output-file",
                                       cl::desc(""), cl::cat(AnalysisOptions),
                                       cl::init(""));
+static cl::opt<std::string> AnalysisCorrectionsOutputFile(
+    "analysis-corrections-output-file",
+    cl::desc("file to write TableGen scheduling data proposed for the "
+             "inconsistent sched classes to"),
+    cl::cat(AnalysisOptions), cl::init(""));
 
 static cl::opt<bool> AnalysisDisplayUnstableOpcodes(
     "analysis-display-unstable-clusters",
@@ -355,6 +380,82 @@ readSnippets(const LLVMState &State, llvm::StringRef Filename) {
   return std::vector<BenchmarkCode>{std::move(Result)};
 }
 
+// Restricts the calling thread to run on `Cpu` only.
+static void pinCurrentThreadToCpu(unsigned Cpu) {
+#ifdef __linux__
+  cpu_set_t CpuSet;
+  CPU_ZERO(&CpuSet);
+  CPU_SET(Cpu, &CpuSet);
+  if (sched_setaffinity(0, sizeof(CpuSet), &CpuSet) != 0)
+    llvm::report_fatal_error(llvm::Twine("cannot pin benchmark thread to cpu ")
+                                 .concat(llvm::Twine(Cpu))
+                                 .concat(": ")
+                                 .concat(llvm::sys::StrError()));
+#else
+  llvm::report_fatal_error("--benchmark-cpus is only supported on Linux");
+#endif
+}
+
+// Returns the opcodes that `BenchmarkFile` already has results for in the
+// current mode, or {} if it does not exist yet.
+static std::set<unsigned> getAlreadyBenchmarkedOpcodes(const LLVMState &State) {
+  if (BenchmarkFile == "-" || !llvm::sys::fs::exists(BenchmarkFile))
+    return {};
+  std::set<unsigned> Result;
+  for (const InstructionBenchmark &Point :
+       ExitOnErr(InstructionBenchmark::readYamls(State, BenchmarkFile)))
+    if (Point.Mode == BenchmarkMode && !Point.Key.Instructions.empty())
+      Result.insert(Point.keyInstruction().getOpcode());
+  return Result;
+}
+
+// Runs all `Configurations` and writes the results to `OS`. If
+// `--benchmark-cpus` is set, configurations are shared between one thread per
+// cpu, each with its own LLVMState and BenchmarkRunner.
+static void runConfigurations(const LLVMState &State,
+                              llvm::ArrayRef<BenchmarkCode> Configurations,
+                              llvm::raw_ostream &OS) {
+  const auto CreateRunner = [](const LLVMState &RunnerState) {
+    std::unique_ptr<BenchmarkRunner> Runner =
+        RunnerState.getExegesisTarget().createBenchmarkRunner(BenchmarkMode,
+                                                              RunnerState);
+    if (!Runner) {
+      llvm::report_fatal_error("cannot create benchmark runner");
+    }
+    return Runner;
+  };
+
+  if (BenchmarkCpus.empty()) {
+    const std::unique_ptr<BenchmarkRunner> Runner = CreateRunner(State);
+    for (const BenchmarkCode &Conf : Configurations) {
+      InstructionBenchmark Result =
+          Runner->runConfiguration(Conf, NumRepetitions, DumpObjectToDisk);
+      ExitOnErr(Result.writeYamlTo(State, OS));
+    }
+    return;
+  }
+
+  // Threads pick the next configuration to run from a shared counter, and
+  // results are written out as soon as they are available.
+  std::atomic<size_t> NextConf(0);
+  std::mutex OSMutex;
+  llvm::ThreadPool Pool(BenchmarkCpus.size());
+  for (const unsigned Cpu : BenchmarkCpus) {
+    Pool.async([&, Cpu]() {
+      pinCurrentThreadToCpu(Cpu);
+      const LLVMState ThreadState(CpuName);
+      const std::unique_ptr<BenchmarkRunner> Runner = CreateRunner(ThreadState);
+      for (size_t I = NextConf++; I < Configurations.size(); I = NextConf++) {
+        InstructionBenchmark Result = Runner->runConfiguration(
+            Configurations[I], NumRepetitions, DumpObjectToDisk);
+        std::lock_guard<std::mutex> Lock(OSMutex);
+        ExitOnErr(Result.writeYamlTo(ThreadState, OS));
+      }
+    });
+  }
+  Pool.wait();
+}
+
 void benchmarkMain() {
 #ifndef HAVE_LIBPFM
   llvm::report_fatal_error(
@@ -372,9 +473,22 @@ void benchmarkMain() {
   const LLVMState State(CpuName);
   const auto Opcodes = getOpcodesOrDie(State.getInstrInfo());
 
+  // Write to standard output if file is not set.
+  if (BenchmarkFile.empty())
+    BenchmarkFile = "-";
+
+  if (ResumeBenchmarks && Opcodes.empty())
+    llvm::report_fatal_error(
+        "--resume requires 'opcode-index' or 'opcode-name'");
+  const std::set<unsigned> SkippedOpcodes =
+      ResumeBenchmarks ? getAlreadyBenchmarkedOpcodes(State)
+                       : std::set<unsigned>();
+
   std::vector<BenchmarkCode> Configurations;
   if (!Opcodes.empty()) {
     for (const unsigned Opcode : Opcodes) {
+      if (SkippedOpcodes.count(Opcode))
+        continue;
       // Ignore instructions without a sched class if
       // -ignore-invalid-sched-class is passed.
       if (IgnoreInvalidSchedClass &&
@@ -397,24 +511,21 @@ void benchmarkMain() {
     Configurations = ExitOnErr(readSnippets(State, SnippetsFile));
   }
 
-  const std::unique_ptr<BenchmarkRunner> Runner =
-      State.getExegesisTarget().createBenchmarkRunner(BenchmarkMode, State);
-  if (!Runner) {
-    llvm::report_fatal_error("cannot create benchmark runner");
-  }
-
   if (NumRepetitions == 0)
     llvm::report_fatal_error("--num-repetitions must be greater than zero");
 
-  // Write to standard output if file is not set.
-  if (BenchmarkFile.empty())
-    BenchmarkFile = "-";
-
-  for (const BenchmarkCode &Conf : Configurations) {
-    InstructionBenchmark Result =
-        Runner->runConfiguration(Conf, NumRepetitions, DumpObjectToDisk);
-    ExitOnErr(Result.writeYaml(State, BenchmarkFile));
+  // The output file is opened once so that results from all configurations
+  // end up in it as a sequence of YAML documents.
+  std::unique_ptr<llvm::raw_fd_ostream> FileOS;
+  if (BenchmarkFile != "-") {
+    std::error_code ErrorCode;
+    FileOS = llvm::make_unique<llvm::raw_fd_ostream>(
+        BenchmarkFile, ErrorCode,
+        ResumeBenchmarks ? llvm::sys::fs::F_Append : llvm::sys::fs::F_Text);
+    if (ErrorCode)
+      llvm::report_fatal_error("cannot open out file: " + BenchmarkFile);
   }
+  runConfigurations(State, Configurations, FileOS ? *FileOS : llvm::outs());
   exegesis::pfm::pfmTerminate();
 }
 
@@ -444,10 +555,12 @@ static void analysisMain() {
     llvm::report_fatal_error("--benchmarks-file must be set.");
 
   if (AnalysisClustersOutputFile.empty() &&
-      AnalysisInconsistenciesOutputFile.empty()) {
+      AnalysisInconsistenciesOutputFile.empty() &&
+      AnalysisCorrectionsOutputFile.empty()) {
     llvm::report_fatal_error(
-        "At least one of --analysis-clusters-output-file and "
-        "--analysis-inconsistencies-output-file must be specified.");
+        "At least one of --analysis-clusters-output-file, "
+        "--analysis-inconsistencies-output-file and "
+        "--analysis-corrections-output-file must be specified.");
   }
 
   llvm::InitializeNativeTarget();
@@ -488,6 +601,8 @@ static void analysisMain() {
   maybeRunAnalysis<Analysis::PrintSchedClassInconsistencies>(
       Analyzer, "sched class consistency analysis",
       AnalysisInconsistenciesOutputFile);
+  maybeRunAnalysis<Analysis::PrintSchedClassCorrections>(
+      Analyzer, "sched class corrections", AnalysisCorrectionsOutputFile);
 }
 
 } // namespace exegesis
@@ -9,10 +9,12 @@
 // This utility is a simple driver that allows static performance analysis on
 // machine code similarly to how IACA (Intel Architecture Code Analyzer) works.
 //
-//   llvm-mca [options] <file-name>
+//   llvm-mca [options] <file-name>...
 //      -march <type>
 //      -mcpu <cpu>
 //      -o <file>
+//      -j <threads>
+//      -json
 //
 // The target defaults to the host target.
 // The cpu defaults to the 'native' host cpu.
@@ -45,28 +47,43 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/WithColor.h"
+#include <atomic>
 
 using namespace llvm;
 
 static cl::OptionCategory ToolOptions("Tool Options");
 static cl::OptionCategory ViewOptions("View Options");
 
-static cl::opt<std::string> InputFilename(cl::Positional,
-                                          cl::desc("<input file>"),
-                                          cl::cat(ToolOptions), cl::init("-"));
+static cl::list<std::string> InputFilenames(cl::Positional,
+                                            cl::desc("<input files>"),
+                                            cl::ZeroOrMore,
+                                            cl::cat(ToolOptions));
 
 static cl::opt<std::string> OutputFilename("o", cl::desc("Output filename"),
                                            cl::init("-"), cl::cat(ToolOptions),
                                            cl::value_desc("filename"));
 
+static cl::opt<unsigned>
+    NumThreads("num-threads",
+               cl::desc("Number of threads used to simulate code regions in "
+                        "parallel (0 = number of hardware threads)"),
+               cl::cat(ToolOptions), cl::init(1));
+
+static cl::alias NumThreadsA("j", cl::desc("Alias for --num-threads"),
+                             cl::aliasopt(NumThreads));
+
 static cl::opt<std::string>
     ArchName("march",
              cl::desc("Target architecture. "
@@ -188,6 +205,12 @@ static cl::opt<bool>
                    cl::desc("Print all views including hardware statistics"),
                    cl::cat(ViewOptions), cl::init(false));
 
+static cl::opt<bool>
+    PrintJSON("json",
+              cl::desc("Print the summary of every code region as JSON "
+                       "instead of the textual views"),
+              cl::cat(ViewOptions), cl::init(false));
+
 static cl::opt<bool> EnableBottleneckAnalysis(
     "bottleneck-analysis",
     cl::desc("Enable bottleneck analysis (disabled by default)"),
@@ -253,16 +276,230 @@ static void processViewOptions() {
 }
 
 // Returns true on success.
-static bool runPipeline(mca::Pipeline &P) {
+static bool runPipeline(mca::Pipeline &P, raw_ostream &ErrOS) {
   // Handle pipeline errors here.
   Expected<unsigned> Cycles = P.run();
   if (!Cycles) {
-    WithColor::error() << toString(Cycles.takeError());
+    WithColor::error(ErrOS) << toString(Cycles.takeError());
     return false;
   }
   return true;
 }
 
+namespace {
+
+/// An input file, together with the MC state that must outlive the analysis
+/// of its code regions.
+struct InputFile {
+  std::string Name;
+  SourceMgr SrcMgr;
+  MCObjectFileInfo MOFI;
+  std::unique_ptr<MCContext> Ctx;
+  std::unique_ptr<mca::AsmCodeRegionGenerator> CRG;
+  const mca::CodeRegions *Regions = nullptr;
+  unsigned AssemblerDialect = 0;
+};
+
+/// A non-empty code region scheduled for analysis.
+struct RegionJob {
+  const InputFile *File;
+  const mca::CodeRegion *Region;
+  // Position of the region in its input file.
+  unsigned Index;
+  // Index printed in the region header, or -1 if no header is printed.
+  int HeaderIdx;
+};
+
+/// The outcome of the analysis of a single code region. Reports and
+/// diagnostics are buffered so that they can be printed in input order once
+/// all the regions have been simulated.
+struct RegionResult {
+  std::string Report;
+  std::string Errors;
+  json::Value JSON = nullptr;
+  bool Failed = false;
+};
+
+/// Simulates code regions one at a time.
+///
+/// InstrBuilder and mca::Context cache state across regions and are not
+/// thread-safe, so every worker thread owns its own RegionAnalyzer. The target
+/// description objects are only ever read, and are shared between workers.
+class RegionAnalyzer {
+  const Target &TheTarget;
+  const MCAsmInfo &MAI;
+  const MCRegisterInfo &MRI;
+  const MCSubtargetInfo &STI;
+  const MCInstrInfo &MCII;
+  const mca::PipelineOptions &PO;
+  mca::InstrBuilder IB;
+  mca::Context MCA;
+  DenseMap<unsigned, std::unique_ptr<MCInstPrinter>> Printers;
+
+  MCInstPrinter &getInstPrinter(unsigned AssemblerDialect);
+
+public:
+  RegionAnalyzer(const Target &T, const MCAsmInfo &AI,
+                 const MCRegisterInfo &RI, const MCSubtargetInfo &SI,
+                 const MCInstrInfo &II, const MCInstrAnalysis *IA,
+                 const mca::PipelineOptions &Opts)
+      : TheTarget(T), MAI(AI), MRI(RI), STI(SI), MCII(II), PO(Opts),
+        IB(SI, II, RI, IA), MCA(RI, SI) {}
+
+  void analyze(const RegionJob &Job, RegionResult &Result);
+};
+
+} // end of anonymous namespace
+
+MCInstPrinter &RegionAnalyzer::getInstPrinter(unsigned AssemblerDialect) {
+  std::unique_ptr<MCInstPrinter> &IP = Printers[AssemblerDialect];
+  if (!IP)
+    IP.reset(TheTarget.createMCInstPrinter(Triple(TripleName),
+                                           AssemblerDialect, MAI, MCII, MRI));
+  assert(IP && "Instruction printer was validated by the driver!");
+  return *IP;
+}
+
+void RegionAnalyzer::analyze(const RegionJob &Job, RegionResult &Result) {
+  raw_string_ostream OS(Result.Report);
+  raw_string_ostream ErrOS(Result.Errors);
+  MCInstPrinter &IP = getInstPrinter(Job.File->AssemblerDialect);
+  const mca::CodeRegion &Region = *Job.Region;
+
+  // Don't print the header of this region if it is the default region, and
+  // it doesn't have an end location.
+  if (!PrintJSON && Job.HeaderIdx >= 0) {
+    OS << "\n[" << Job.HeaderIdx << "] Code Region";
+    StringRef Desc = Region.getDescription();
+    if (!Desc.empty())
+      OS << " - " << Desc;
+    OS << "\n\n";
+  }
+
+  // Lower the MCInst sequence into an mca::Instruction sequence.
+  ArrayRef<MCInst> Insts = Region.getInstructions();
+  std::vector<std::unique_ptr<mca::Instruction>> LoweredSequence;
+  for (const MCInst &MCI : Insts) {
+    Expected<std::unique_ptr<mca::Instruction>> Inst =
+        IB.createInstruction(MCI);
+    if (!Inst) {
+      if (auto NewE = handleErrors(
+              Inst.takeError(),
+              [&](const mca::InstructionError<MCInst> &IE) {
+                std::string InstructionStr;
+                raw_string_ostream SS(InstructionStr);
+                WithColor::error(ErrOS) << IE.Message << '\n';
+                IP.printInst(&IE.Inst, SS, "", STI);
+                SS.flush();
+                WithColor::note(ErrOS)
+                    << "instruction: " << InstructionStr << '\n';
+              })) {
+        // Default case.
+        WithColor::error(ErrOS) << toString(std::move(NewE));
+      }
+      Result.Failed = true;
+      return;
+    }
+
+    LoweredSequence.emplace_back(std::move(Inst.get()));
+  }
+
+  mca::SourceMgr S(LoweredSequence, PrintInstructionTables ? 1 : Iterations);
+  const MCSchedModel &SM = STI.getSchedModel();
+
+  if (PrintInstructionTables) {
+    //  Create a pipeline, stages, and a printer.
+    auto P = llvm::make_unique<mca::Pipeline>();
+    P->appendStage(llvm::make_unique<mca::EntryStage>(S));
+    P->appendStage(llvm::make_unique<mca::InstructionTables>(SM));
+    mca::PipelinePrinter Printer(*P);
+
+    // Create the views for this pipeline, execute, and emit a report.
+    if (PrintInstructionInfoView) {
+      Printer.addView(
+          llvm::make_unique<mca::InstructionInfoView>(STI, MCII, Insts, IP));
+    }
+    Printer.addView(
+        llvm::make_unique<mca::ResourcePressureView>(STI, IP, Insts));
+
+    if (!runPipeline(*P, ErrOS)) {
+      Result.Failed = true;
+      return;
+    }
+
+    Printer.printReport(OS);
+    return;
+  }
+
+  // Create a basic pipeline simulating an out-of-order backend.
+  auto P = MCA.createDefaultPipeline(PO, IB, S);
+  mca::PipelinePrinter Printer(*P);
+
+  if (PrintJSON) {
+    // Only the summary view is emitted in JSON form.
+    auto SV = llvm::make_unique<mca::SummaryView>(SM, Insts, DispatchWidth);
+    const mca::SummaryView &Summary = *SV;
+    Printer.addView(std::move(SV));
+
+    if (!runPipeline(*P, ErrOS)) {
+      Result.Failed = true;
+      return;
+    }
+
+    Result.JSON = json::Object({{"File", Job.File->Name},
+                                {"Region", Job.Index},
+                                {"Description", Region.getDescription()},
+                                {"Summary", Summary.toJSON()}});
+    IB.clear();
+    return;
+  }
+
+  if (PrintSummaryView)
+    Printer.addView(
+        llvm::make_unique<mca::SummaryView>(SM, Insts, DispatchWidth));
+
+  if (EnableBottleneckAnalysis)
+    Printer.addView(llvm::make_unique<mca::BottleneckAnalysis>(SM));
+
+  if (PrintInstructionInfoView)
+    Printer.addView(
+        llvm::make_unique<mca::InstructionInfoView>(STI, MCII, Insts, IP));
+
+  if (PrintDispatchStats)
+    Printer.addView(llvm::make_unique<mca::DispatchStatistics>());
+
+  if (PrintSchedulerStats)
+    Printer.addView(llvm::make_unique<mca::SchedulerStatistics>(STI));
+
+  if (PrintRetireStats)
+    Printer.addView(llvm::make_unique<mca::RetireControlUnitStatistics>(SM));
+
+  if (PrintRegisterFileStats)
+    Printer.addView(llvm::make_unique<mca::RegisterFileStatistics>(STI));
+
+  if (PrintResourcePressureView)
+    Printer.addView(
+        llvm::make_unique<mca::ResourcePressureView>(STI, IP, Insts));
+
+  if (PrintTimelineView) {
+    unsigned TimelineIterations =
+        TimelineMaxIterations ? TimelineMaxIterations : 10;
+    Printer.addView(llvm::make_unique<mca::TimelineView>(
+        STI, IP, Insts, std::min(TimelineIterations, S.getNumIterations()),
+        TimelineMaxCycles));
+  }
+
+  if (!runPipeline(*P, ErrOS)) {
+    Result.Failed = true;
+    return;
+  }
+
+  Printer.printReport(OS);
+
+  // Clear the InstrBuilder internal state in preparation for another round.
+  IB.clear();
+}
+
 int main(int argc, char **argv) {
   InitLLVM X(argc, argv);
 
@@ -292,20 +529,32 @@ int main(int argc, char **argv) {
   // For safety, reconstruct the Triple object.
   Triple TheTriple(TripleName);
 
-  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferPtr =
-      MemoryBuffer::getFileOrSTDIN(InputFilename);
-  if (std::error_code EC = BufferPtr.getError()) {
-    WithColor::error() << InputFilename << ": " << EC.message() << '\n';
+  if (PrintJSON && PrintInstructionTables) {
+    WithColor::error() << "-json is not compatible with -instruction-tables.\n";
     return 1;
   }
 
-  // Apply overrides to llvm-mca specific options.
-  processViewOptions();
+  if (InputFilenames.empty())
+    InputFilenames.push_back("-");
 
-  SourceMgr SrcMgr;
+  std::vector<std::unique_ptr<InputFile>> Inputs;
+  for (const std::string &InputFilename : InputFilenames) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufferPtr =
+        MemoryBuffer::getFileOrSTDIN(InputFilename);
+    if (std::error_code EC = BufferPtr.getError()) {
+      WithColor::error() << InputFilename << ": " << EC.message() << '\n';
+      return 1;
+    }
 
-  // Tell SrcMgr about this buffer, which is what the parser will pick up.
-  SrcMgr.AddNewSourceBuffer(std::move(*BufferPtr), SMLoc());
+    // Tell SrcMgr about this buffer, which is what the parser will pick up.
+    auto Input = llvm::make_unique<InputFile>();
+    Input->Name = InputFilename;
+    Input->SrcMgr.AddNewSourceBuffer(std::move(*BufferPtr), SMLoc());
+    Inputs.emplace_back(std::move(Input));
+  }
+
+  // Apply overrides to llvm-mca specific options.
+  processViewOptions();
 
   std::unique_ptr<MCRegisterInfo> MRI(TheTarget->createMCRegInfo(TripleName));
   assert(MRI && "Unable to create target register info!");
@@ -313,12 +562,6 @@ int main(int argc, char **argv) {
   std::unique_ptr<MCAsmInfo> MAI(TheTarget->createMCAsmInfo(*MRI, TripleName));
   assert(MAI && "Unable to create target asm info!");
 
-  MCObjectFileInfo MOFI;
-  MCContext Ctx(MAI.get(), MRI.get(), &MOFI, &SrcMgr);
-  MOFI.InitMCObjectFileInfo(TheTriple, /* PIC= */ false, Ctx);
-
-  std::unique_ptr<buffer_ostream> BOS;
-
   std::unique_ptr<MCInstrInfo> MCII(TheTarget->createMCInstrInfo());
 
   std::unique_ptr<MCInstrAnalysis> MCIA(
@@ -351,28 +594,39 @@ int main(int argc, char **argv) {
     return 1;
   }
 
-  // Parse the input and create CodeRegions that llvm-mca can analyze.
-  mca::AsmCodeRegionGenerator CRG(*TheTarget, SrcMgr, Ctx, *MAI, *STI, *MCII);
-  Expected<const mca::CodeRegions &> RegionsOrErr = CRG.parseCodeRegions();
-  if (!RegionsOrErr) {
-    if (auto Err =
-            handleErrors(RegionsOrErr.takeError(), [](const StringError &E) {
-              WithColor::error() << E.getMessage() << '\n';
-            })) {
-      // Default case.
-      WithColor::error() << toString(std::move(Err)) << '\n';
+  // Parse the inputs and create CodeRegions that llvm-mca can analyze. MC
+  // contexts are not thread-safe, so this is done serially.
+  for (std::unique_ptr<InputFile> &Input : Inputs) {
+    Input->Ctx = llvm::make_unique<MCContext>(MAI.get(), MRI.get(),
+                                              &Input->MOFI, &Input->SrcMgr);
+    Input->MOFI.InitMCObjectFileInfo(TheTriple, /* PIC= */ false, *Input->Ctx);
+
+    Input->CRG = llvm::make_unique<mca::AsmCodeRegionGenerator>(
+        *TheTarget, Input->SrcMgr, *Input->Ctx, *MAI, *STI, *MCII);
+    Expected<const mca::CodeRegions &> RegionsOrErr =
+        Input->CRG->parseCodeRegions();
+    if (!RegionsOrErr) {
+      if (auto Err =
+              handleErrors(RegionsOrErr.takeError(), [](const StringError &E) {
+                WithColor::error() << E.getMessage() << '\n';
+              })) {
+        // Default case.
+        WithColor::error() << toString(std::move(Err)) << '\n';
+      }
+      return 1;
     }
-    return 1;
-  }
-  const mca::CodeRegions &Regions = *RegionsOrErr;
+    const mca::CodeRegions &Regions = *RegionsOrErr;
 
-  // Early exit if errors were found by the code region parsing logic.
-  if (!Regions.isValid())
-    return 1;
+    // Early exit if errors were found by the code region parsing logic.
+    if (!Regions.isValid())
+      return 1;
 
-  if (Regions.empty()) {
-    WithColor::error() << "no assembly instructions found.\n";
-    return 1;
+    if (Regions.empty()) {
+      WithColor::error() << "no assembly instructions found.\n";
+      return 1;
+    }
+
+    Input->Regions = &Regions;
   }
 
   // Now initialize the output file.
@@ -382,150 +636,92 @@ int main(int argc, char **argv) {
     return 1;
   }
 
-  unsigned AssemblerDialect = CRG.getAssemblerDialect();
-  if (OutputAsmVariant >= 0)
-    AssemblerDialect = static_cast<unsigned>(OutputAsmVariant);
-  std::unique_ptr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
-      Triple(TripleName), AssemblerDialect, *MAI, *MCII, *MRI));
-  if (!IP) {
-    WithColor::error()
-        << "unable to create instruction printer for target triple '"
-        << TheTriple.normalize() << "' with assembly variant "
-        << AssemblerDialect << ".\n";
-    return 1;
+  for (std::unique_ptr<InputFile> &Input : Inputs) {
+    unsigned AssemblerDialect = Input->CRG->getAssemblerDialect();
+    if (OutputAsmVariant >= 0)
+      AssemblerDialect = static_cast<unsigned>(OutputAsmVariant);
+    std::unique_ptr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
+        Triple(TripleName), AssemblerDialect, *MAI, *MCII, *MRI));
+    if (!IP) {
+      WithColor::error()
+          << "unable to create instruction printer for target triple '"
+          << TheTriple.normalize() << "' with assembly variant "
+          << AssemblerDialect << ".\n";
+      return 1;
+    }
+    Input->AssemblerDialect = AssemblerDialect;
   }
 
   std::unique_ptr<ToolOutputFile> TOF = std::move(*OF);
 
-  const MCSchedModel &SM = STI->getSchedModel();
-
-  // Create an instruction builder.
-  mca::InstrBuilder IB(*STI, *MCII, *MRI, MCIA.get());
-
-  // Create a context to control ownership of the pipeline hardware.
-  mca::Context MCA(*MRI, *STI);
-
   mca::PipelineOptions PO(MicroOpQueue, DecoderThroughput, DispatchWidth,
                           RegisterFileSize, LoadQueueSize, StoreQueueSize,
                           AssumeNoAlias, EnableBottleneckAnalysis);
 
-  // Number each region in the sequence.
-  unsigned RegionIdx = 0;
-
-  for (const std::unique_ptr<mca::CodeRegion> &Region : Regions) {
-    // Skip empty code regions.
-    if (Region->empty())
-      continue;
-
-    // Don't print the header of this region if it is the default region, and
-    // it doesn't have an end location.
-    if (Region->startLoc().isValid() || Region->endLoc().isValid()) {
-      TOF->os() << "\n[" << RegionIdx++ << "] Code Region";
-      StringRef Desc = Region->getDescription();
-      if (!Desc.empty())
-        TOF->os() << " - " << Desc;
-      TOF->os() << "\n\n";
+  // Collect the regions to analyze, numbering each region of a file in
+  // sequence.
+  std::vector<RegionJob> Jobs;
+  for (const std::unique_ptr<InputFile> &Input : Inputs) {
+    unsigned Index = 0;
+    int HeaderIdx = 0;
+    for (const std::unique_ptr<mca::CodeRegion> &Region : *Input->Regions) {
+      // Skip empty code regions.
+      if (Region->empty())
+        continue;
+
+      bool HasHeader =
+          Region->startLoc().isValid() || Region->endLoc().isValid();
+      Jobs.push_back({Input.get(), Region.get(), Index++,
+                      HasHeader ? HeaderIdx++ : -1});
     }
+  }
 
-    // Lower the MCInst sequence into an mca::Instruction sequence.
-    ArrayRef<MCInst> Insts = Region->getInstructions();
-    std::vector<std::unique_ptr<mca::Instruction>> LoweredSequence;
-    for (const MCInst &MCI : Insts) {
-      Expected<std::unique_ptr<mca::Instruction>> Inst =
-          IB.createInstruction(MCI);
-      if (!Inst) {
-        if (auto NewE = handleErrors(
-                Inst.takeError(),
-                [&IP, &STI](const mca::InstructionError<MCInst> &IE) {
-                  std::string InstructionStr;
-                  raw_string_ostream SS(InstructionStr);
-                  WithColor::error() << IE.Message << '\n';
-                  IP->printInst(&IE.Inst, SS, "", *STI);
-                  SS.flush();
-                  WithColor::note()
-                      << "instruction: " << InstructionStr << '\n';
-                })) {
-          // Default case.
-          WithColor::error() << toString(std::move(NewE));
-        }
-        return 1;
-      }
-
-      LoweredSequence.emplace_back(std::move(Inst.get()));
-    }
-
-    mca::SourceMgr S(LoweredSequence, PrintInstructionTables ? 1 : Iterations);
-
-    if (PrintInstructionTables) {
-      //  Create a pipeline, stages, and a printer.
-      auto P = llvm::make_unique<mca::Pipeline>();
-      P->appendStage(llvm::make_unique<mca::EntryStage>(S));
-      P->appendStage(llvm::make_unique<mca::InstructionTables>(SM));
-      mca::PipelinePrinter Printer(*P);
-
-      // Create the views for this pipeline, execute, and emit a report.
-      if (PrintInstructionInfoView) {
-        Printer.addView(llvm::make_unique<mca::InstructionInfoView>(
-            *STI, *MCII, Insts, *IP));
-      }
-      Printer.addView(
-          llvm::make_unique<mca::ResourcePressureView>(*STI, *IP, Insts));
-
-      if (!runPipeline(*P))
-        return 1;
-
-      Printer.printReport(TOF->os());
-      continue;
+  // Simulate the regions. Workers claim regions in input order, and stop
+  // claiming new ones as soon as one of them fails.
+  std::vector<RegionResult> Results(Jobs.size());
+  std::atomic<unsigned> NextJob(0);
+  std::atomic<bool> AnyFailed(false);
+  auto RunWorker = [&]() {
+    RegionAnalyzer RA(*TheTarget, *MAI, *MRI, *STI, *MCII, MCIA.get(), PO);
+    for (unsigned I = NextJob++; I < Jobs.size() && !AnyFailed; I = NextJob++) {
+      RA.analyze(Jobs[I], Results[I]);
+      if (Results[I].Failed)
+        AnyFailed = true;
     }
+  };
+
+  unsigned NumWorkers =
+      NumThreads ? NumThreads : llvm::heavyweight_hardware_concurrency();
+  NumWorkers = std::min<size_t>(NumWorkers, Jobs.size());
+  if (NumWorkers <= 1) {
+    RunWorker();
+  } else {
+    ThreadPool Pool(NumWorkers);
+    for (unsigned I = 0; I < NumWorkers; ++I)
+      Pool.async(RunWorker);
+    Pool.wait();
+  }
 
-    // Create a basic pipeline simulating an out-of-order backend.
-    auto P = MCA.createDefaultPipeline(PO, IB, S);
-    mca::PipelinePrinter Printer(*P);
-
-    if (PrintSummaryView)
-      Printer.addView(
-          llvm::make_unique<mca::SummaryView>(SM, Insts, DispatchWidth));
-
-    if (EnableBottleneckAnalysis)
-      Printer.addView(llvm::make_unique<mca::BottleneckAnalysis>(SM));
-
-    if (PrintInstructionInfoView)
-      Printer.addView(
-          llvm::make_unique<mca::InstructionInfoView>(*STI, *MCII, Insts, *IP));
-
-    if (PrintDispatchStats)
-      Printer.addView(llvm::make_unique<mca::DispatchStatistics>());
-
-    if (PrintSchedulerStats)
-      Printer.addView(llvm::make_unique<mca::SchedulerStatistics>(*STI));
-
-    if (PrintRetireStats)
-      Printer.addView(llvm::make_unique<mca::RetireControlUnitStatistics>(SM));
-
-    if (PrintRegisterFileStats)
-      Printer.addView(llvm::make_unique<mca::RegisterFileStatistics>(*STI));
-
-    if (PrintResourcePressureView)
-      Printer.addView(
-          llvm::make_unique<mca::ResourcePressureView>(*STI, *IP, Insts));
-
-    if (PrintTimelineView) {
-      unsigned TimelineIterations =
-          TimelineMaxIterations ? TimelineMaxIterations : 10;
-      Printer.addView(llvm::make_unique<mca::TimelineView>(
-          *STI, *IP, Insts, std::min(TimelineIterations, S.getNumIterations()),
-          TimelineMaxCycles));
+  // Print the results in input order, up to the first failing region.
+  json::Array JSONResults;
+  const InputFile *LastFile = nullptr;
+  for (unsigned I = 0, E = Jobs.size(); I < E; ++I) {
+    RegionResult &Result = Results[I];
+    if (!PrintJSON && Inputs.size() > 1 && Jobs[I].File != LastFile) {
+      LastFile = Jobs[I].File;
+      TOF->os() << "\nFile: " << LastFile->Name << '\n';
     }
-
-    if (!runPipeline(*P))
+    TOF->os() << Result.Report;
+    errs() << Result.Errors;
+    if (Result.Failed)
       return 1;
-
-    Printer.printReport(TOF->os());
-
-    // Clear the InstrBuilder internal state in preparation for another round.
-    IB.clear();
+    if (PrintJSON)
+      JSONResults.push_back(std::move(Result.JSON));
   }
 
+  if (PrintJSON)
+    TOF->os() << formatv("{0:2}", json::Value(std::move(JSONResults))) << '\n';
+
   TOF->keep();
   return 0;
 }
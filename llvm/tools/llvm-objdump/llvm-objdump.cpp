@@ -58,11 +58,15 @@
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cctype>
+#include <condition_variable>
 #include <cstring>
+#include <mutex>
 #include <system_error>
 #include <unordered_map>
 #include <utility>
@@ -239,6 +243,12 @@ cl::opt<bool> NoLeadingAddr("no-leading-addr",
                             cl::desc("Print no leading address"),
                             cl::cat(ObjdumpCat));
 
+static cl::opt<unsigned>
+    NumThreads("num-threads",
+               cl::desc("Number of threads to disassemble with, 0 for all "
+                        "hardware threads (default: 1)"),
+               cl::init(1), cl::cat(ObjdumpCat));
+
 static cl::opt<bool> RawClangAST(
     "raw-clang-ast",
     cl::desc("Dump the raw binary contents of the clang AST section"),
@@ -605,14 +615,14 @@ static bool isArmElf(const ObjectFile *Obj) {
 }
 
 static void printRelocation(const RelocationRef &Rel, uint64_t Address,
-                            uint8_t AddrSize) {
+                            uint8_t AddrSize, raw_ostream &OS) {
   StringRef Fmt =
       AddrSize > 4 ? "\t\t%016" PRIx64 ":  " : "\t\t\t%08" PRIx64 ":  ";
   SmallString<16> Name;
   SmallString<32> Val;
   Rel.getTypeName(Name);
   error(getRelocationValueString(Rel, Val));
-  outs() << format(Fmt.data(), Address) << Name << "\t" << Val << "\n";
+  OS << format(Fmt.data(), Address) << Name << "\t" << Val << "\n";
 }
 
 class PrettyPrinter {
@@ -697,7 +707,7 @@ public:
     auto PrintReloc = [&]() -> void {
       while ((RelCur != RelEnd) && (RelCur->getOffset() <= Address.Address)) {
         if (RelCur->getOffset() == Address.Address) {
-          printRelocation(*RelCur, Address.Address, 4);
+          printRelocation(*RelCur, Address.Address, 4, OS);
           return;
         }
         ++RelCur;
@@ -950,30 +960,31 @@ static bool shouldAdjustVA(const SectionRef &Section) {
 static uint64_t
 dumpARMELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
                const ObjectFile *Obj, ArrayRef<uint8_t> Bytes,
-               const std::vector<uint64_t> &TextMappingSymsAddr) {
+               const std::vector<uint64_t> &TextMappingSymsAddr,
+               raw_ostream &OS) {
   support::endianness Endian =
       Obj->isLittleEndian() ? support::little : support::big;
   while (Index < End) {
-    outs() << format("%8" PRIx64 ":", SectionAddr + Index);
-    outs() << "\t";
+    OS << format("%8" PRIx64 ":", SectionAddr + Index);
+    OS << "\t";
     if (Index + 4 <= End) {
-      dumpBytes(Bytes.slice(Index, 4), outs());
-      outs() << "\t.word\t"
-             << format_hex(
-                    support::endian::read32(Bytes.data() + Index, Endian), 10);
+      dumpBytes(Bytes.slice(Index, 4), OS);
+      OS << "\t.word\t"
+         << format_hex(
+                support::endian::read32(Bytes.data() + Index, Endian), 10);
       Index += 4;
     } else if (Index + 2 <= End) {
-      dumpBytes(Bytes.slice(Index, 2), outs());
-      outs() << "\t\t.short\t"
-             << format_hex(
-                    support::endian::read16(Bytes.data() + Index, Endian), 6);
+      dumpBytes(Bytes.slice(Index, 2), OS);
+      OS << "\t\t.short\t"
+         << format_hex(
+                support::endian::read16(Bytes.data() + Index, Endian), 6);
       Index += 2;
     } else {
-      dumpBytes(Bytes.slice(Index, 1), outs());
-      outs() << "\t\t.byte\t" << format_hex(Bytes[0], 4);
+      dumpBytes(Bytes.slice(Index, 1), OS);
+      OS << "\t\t.byte\t" << format_hex(Bytes[0], 4);
       ++Index;
     }
-    outs() << "\n";
+    OS << "\n";
     if (std::binary_search(TextMappingSymsAddr.begin(),
                            TextMappingSymsAddr.end(), Index))
       break;
@@ -982,7 +993,7 @@ dumpARMELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
 }
 
 static void dumpELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
-                        ArrayRef<uint8_t> Bytes) {
+                        ArrayRef<uint8_t> Bytes, raw_ostream &OS) {
   // print out data up to 8 bytes at a time in hex and ascii
   uint8_t AsciiData[9] = {'\0'};
   uint8_t Byte;
@@ -990,11 +1001,11 @@ static void dumpELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
 
   for (; Index < End; ++Index) {
     if (NumBytes == 0) {
-      outs() << format("%8" PRIx64 ":", SectionAddr + Index);
-      outs() << "\t";
+      OS << format("%8" PRIx64 ":", SectionAddr + Index);
+      OS << "\t";
     }
     Byte = Bytes.slice(Index)[0];
-    outs() << format(" %02x", Byte);
+    OS << format(" %02x", Byte);
     AsciiData[NumBytes] = isPrint(Byte) ? Byte : '.';
 
     uint8_t IndentOffset = 0;
@@ -1009,27 +1020,437 @@ static void dumpELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
     }
     if (NumBytes == 8) {
       AsciiData[8] = '\0';
-      outs() << std::string(IndentOffset, ' ') << "         ";
-      outs() << reinterpret_cast<char *>(AsciiData);
-      outs() << '\n';
+      OS << std::string(IndentOffset, ' ') << "         ";
+      OS << reinterpret_cast<char *>(AsciiData);
+      OS << '\n';
       NumBytes = 0;
     }
   }
 }
 
-static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
-                              MCContext &Ctx, MCDisassembler *DisAsm,
-                              const MCInstrAnalysis *MIA, MCInstPrinter *IP,
-                              const MCSubtargetInfo *STI, PrettyPrinter &PIP,
-                              SourcePrinter &SP, bool InlineRelocs) {
+namespace {
+// The objects that are not safe to share between threads disassembling at
+// the same time: an MCContext and the disassembler and instruction printer
+// created with it.
+struct DisassemblerState {
+  const Target *TheTarget;
+  MCObjectFileInfo MOFI;
+  std::unique_ptr<MCContext> Ctx;
+  std::unique_ptr<MCDisassembler> DisAsm;
+  std::unique_ptr<MCInstPrinter> IP;
+};
+
+// The symbol tables of an object file. They are complete before any section
+// is disassembled, and only read from then on.
+struct ObjectSymbols {
+  std::map<SectionRef, SectionSymbolsTy> AllSymbols;
+  SectionSymbolsTy AbsoluteSymbols;
+  std::vector<std::pair<uint64_t, SectionRef>> SectionAddresses;
+};
+
+// A section to be disassembled, with what is computed about it up front.
+struct SectionInfo {
+  SectionRef Section;
+  StringRef SegmentName;
+  StringRef SectionName;
+  ArrayRef<uint8_t> Bytes;
+  uint64_t VMAAdjustment;
+  SectionSymbolsTy *Symbols;
+  std::vector<uint64_t> DataMappingSymsAddr;
+  std::vector<uint64_t> TextMappingSymsAddr;
+  std::vector<RelocationRef> Rels;
+};
+
+// A range of the symbols of a section, which is disassembled as a unit.
+struct DisassemblyChunk {
+  SectionInfo *Sec;
+  unsigned SymBegin;
+  unsigned SymEnd;
+};
+} // namespace
+
+// With --num-threads, the sections are split into chunks of symbols that
+// span at least this many bytes, which are disassembled in parallel.
+static const uint64_t DisassemblyChunkSize = 64 * 1024;
+
+static void printSectionHeader(const SectionInfo &SI, raw_ostream &OS) {
+  OS << "\nDisassembly of section ";
+  if (!SI.SegmentName.empty())
+    OS << SI.SegmentName << ",";
+  OS << SI.SectionName << ":\n";
+}
+
+// Disassembles the symbols of a chunk to OS. OnFirstSymbol is called before
+// the first symbol of the chunk that is printed, if there is one.
+static void disassembleChunk(const ObjectFile *Obj,
+                             const DisassemblyChunk &Chunk,
+                             const ObjectSymbols &Syms, DisassemblerState &DS,
+                             const MCInstrAnalysis *MIA,
+                             const MCSubtargetInfo *STI, PrettyPrinter &PIP,
+                             SourcePrinter &SP, raw_ostream &OS,
+                             function_ref<void()> OnFirstSymbol) {
+  SectionInfo &SecInfo = *Chunk.Sec;
+  const SectionRef &Section = SecInfo.Section;
+  SectionSymbolsTy &Symbols = *SecInfo.Symbols;
+  ArrayRef<uint8_t> Bytes = SecInfo.Bytes;
+  MCDisassembler *DisAsm = DS.DisAsm.get();
+  uint64_t SectionAddr = Section.getAddress();
+  uint64_t SectSize = Section.getSize();
+
+  if (Obj->isELF() && Obj->getArch() == Triple::amdgcn) {
+    // AMDGPU disassembler uses symbolizer for printing labels
+    std::unique_ptr<MCRelocationInfo> RelInfo(
+        DS.TheTarget->createMCRelocationInfo(TripleName, *DS.Ctx));
+    if (RelInfo) {
+      std::unique_ptr<MCSymbolizer> Symbolizer(
+          DS.TheTarget->createMCSymbolizer(TripleName, nullptr, nullptr,
+                                           &Symbols, DS.Ctx.get(),
+                                           std::move(RelInfo)));
+      DisAsm->setSymbolizer(std::move(Symbolizer));
+    }
+  }
+
+  SmallString<40> Comments;
+  raw_svector_ostream CommentStream(Comments);
+
+  uint64_t Size;
+  uint64_t Index;
+  bool PrintedSymbol = false;
+  std::vector<RelocationRef> &Rels = SecInfo.Rels;
+  std::vector<RelocationRef>::const_iterator RelCur = Rels.begin();
+  std::vector<RelocationRef>::const_iterator RelEnd = Rels.end();
+  // A chunk other than the first of its section starts with the relocations
+  // at or after its first symbol.
+  if (Chunk.SymBegin != 0 &&
+      std::get<0>(Symbols[Chunk.SymBegin]) >= SectionAddr) {
+    uint64_t ChunkStart = std::get<0>(Symbols[Chunk.SymBegin]) - SectionAddr;
+    RelCur = llvm::lower_bound(Rels, ChunkStart,
+                               [](const RelocationRef &R, uint64_t Offset) {
+                                 return R.getOffset() < Offset;
+                               });
+  }
+  // Disassemble symbol by symbol.
+  for (unsigned SI = Chunk.SymBegin, SE = Symbols.size(); SI != Chunk.SymEnd;
+       ++SI) {
+    // Skip if --disassemble-functions is not empty and the symbol is not in
+    // the list.
+    if (!DisasmFuncsSet.empty() &&
+        !DisasmFuncsSet.count(std::get<1>(Symbols[SI])))
+      continue;
+
+    uint64_t Start = std::get<0>(Symbols[SI]);
+    if (Start < SectionAddr || StopAddress <= Start)
+      continue;
+
+    // The end is the section end, the beginning of the next symbol, or
+    // --stop-address.
+    uint64_t End = std::min<uint64_t>(SectionAddr + SectSize, StopAddress);
+    if (SI + 1 < SE)
+      End = std::min(End, std::get<0>(Symbols[SI + 1]));
+    if (Start >= End || End <= StartAddress)
+      continue;
+    Start -= SectionAddr;
+    End -= SectionAddr;
+
+    if (!PrintedSymbol) {
+      PrintedSymbol = true;
+      OnFirstSymbol();
+    }
+
+    if (Obj->isELF() && Obj->getArch() == Triple::amdgcn) {
+      if (std::get<2>(Symbols[SI]) == ELF::STT_AMDGPU_HSA_KERNEL) {
+        // skip amd_kernel_code_t at the begining of kernel symbol (256 bytes)
+        Start += 256;
+      }
+      if (SI == SE - 1 ||
+          std::get<2>(Symbols[SI + 1]) == ELF::STT_AMDGPU_HSA_KERNEL) {
+        // cut trailing zeroes at the end of kernel
+        // cut up to 256 bytes
+        const uint64_t EndAlign = 256;
+        const auto Limit = End - (std::min)(EndAlign, End - Start);
+        while (End > Limit &&
+          *reinterpret_cast<const support::ulittle32_t*>(&Bytes[End - 4]) == 0)
+          End -= 4;
+      }
+    }
+
+    OS << '\n';
+    if (!NoLeadingAddr)
+      OS << format("%016" PRIx64 " ",
+                   SectionAddr + Start + SecInfo.VMAAdjustment);
+
+    StringRef SymbolName = std::get<1>(Symbols[SI]);
+    if (Demangle)
+      OS << demangle(SymbolName) << ":\n";
+    else
+      OS << SymbolName << ":\n";
+
+    // Don't print raw contents of a virtual section. A virtual section
+    // doesn't have any contents in the file.
+    if (Section.isVirtual()) {
+      OS << "...\n";
+      continue;
+    }
+
+#ifndef NDEBUG
+    raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
+#else
+    raw_ostream &DebugOut = nulls();
+#endif
+
+    // Some targets (like WebAssembly) have a special prelude at the start
+    // of each symbol.
+    DisAsm->onSymbolStart(SymbolName, Size, Bytes.slice(Start, End - Start),
+                          SectionAddr + Start, DebugOut, CommentStream);
+    Start += Size;
+
+    Index = Start;
+    if (SectionAddr < StartAddress)
+      Index = std::max<uint64_t>(Index, StartAddress - SectionAddr);
+
+    // If there is a data symbol inside an ELF text section and we are
+    // only disassembling text (applicable all architectures), we are in a
+    // situation where we must print the data and not disassemble it.
+    if (Obj->isELF() && std::get<2>(Symbols[SI]) == ELF::STT_OBJECT &&
+        !DisassembleAll && Section.isText()) {
+      dumpELFData(SectionAddr, Index, End, Bytes, OS);
+      Index = End;
+    }
+
+    bool CheckARMELFData = isArmElf(Obj) &&
+                           std::get<2>(Symbols[SI]) != ELF::STT_OBJECT &&
+                           !DisassembleAll;
+    while (Index < End) {
+      // AArch64 ELF binaries can interleave data and text in the same
+      // section. We rely on the markers introduced to understand what we
+      // need to dump. If the data marker is within a function, it is
+      // denoted as a word/short etc.
+      if (CheckARMELFData &&
+          std::binary_search(SecInfo.DataMappingSymsAddr.begin(),
+                             SecInfo.DataMappingSymsAddr.end(), Index)) {
+        Index = dumpARMELFData(SectionAddr, Index, End, Obj, Bytes,
+                               SecInfo.TextMappingSymsAddr, OS);
+        continue;
+      }
+
+      // When -z or --disassemble-zeroes are given we always dissasemble
+      // them. Otherwise we might want to skip zero bytes we see.
+      if (!DisassembleZeroes) {
+        uint64_t MaxOffset = End - Index;
+        // For -reloc: print zero blocks patched by relocations, so that
+        // relocations can be shown in the dump.
+        if (RelCur != RelEnd)
+          MaxOffset = RelCur->getOffset() - Index;
+
+        if (size_t N =
+                countSkippableZeroBytes(Bytes.slice(Index, MaxOffset))) {
+          OS << "\t\t..." << '\n';
+          Index += N;
+          continue;
+        }
+      }
+
+      // Disassemble a real instruction or a data when disassemble all is
+      // provided
+      MCInst Inst;
+      bool Disassembled = DisAsm->getInstruction(
+          Inst, Size, Bytes.slice(Index), SectionAddr + Index, DebugOut,
+          CommentStream);
+      if (Size == 0)
+        Size = 1;
+
+      PIP.printInst(*DS.IP, Disassembled ? &Inst : nullptr,
+                    Bytes.slice(Index, Size),
+                    {SectionAddr + Index + SecInfo.VMAAdjustment,
+                     Section.getIndex()},
+                    OS, "", *STI, &SP, &Rels);
+      OS << CommentStream.str();
+      Comments.clear();
+
+      // Try to resolve the target of a call, tail call, etc. to a specific
+      // symbol.
+      if (MIA && (MIA->isCall(Inst) || MIA->isUnconditionalBranch(Inst) ||
+                  MIA->isConditionalBranch(Inst))) {
+        uint64_t Target;
+        if (MIA->evaluateBranch(Inst, SectionAddr + Index, Size, Target)) {
+          // In a relocatable object, the target's section must reside in
+          // the same section as the call instruction or it is accessed
+          // through a relocation.
+          //
+          // In a non-relocatable object, the target may be in any section.
+          //
+          // N.B. We don't walk the relocations in the relocatable case yet.
+          const SectionSymbolsTy *TargetSectionSymbols = &Symbols;
+          if (!Obj->isRelocatableObject()) {
+            auto It = llvm::bsearch(
+                Syms.SectionAddresses,
+                [=](const std::pair<uint64_t, SectionRef> &RHS) {
+                  return Target < RHS.first;
+                });
+            if (It != Syms.SectionAddresses.begin()) {
+              --It;
+              // Every section has an entry in AllSymbols.
+              TargetSectionSymbols = &Syms.AllSymbols.find(It->second)->second;
+            } else {
+              TargetSectionSymbols = &Syms.AbsoluteSymbols;
+            }
+          }
+
+          // Find the last symbol in the section whose offset is less than
+          // or equal to the target. If there isn't a section that contains
+          // the target, find the nearest preceding absolute symbol.
+          auto TargetSym = llvm::bsearch(
+              *TargetSectionSymbols,
+              [=](const std::tuple<uint64_t, StringRef, uint8_t> &RHS) {
+                return Target < std::get<0>(RHS);
+              });
+          if (TargetSym == TargetSectionSymbols->begin()) {
+            TargetSectionSymbols = &Syms.AbsoluteSymbols;
+            TargetSym = llvm::bsearch(
+                Syms.AbsoluteSymbols,
+                [=](const std::tuple<uint64_t, StringRef, uint8_t> &RHS) {
+                  return Target < std::get<0>(RHS);
+                });
+          }
+          if (TargetSym != TargetSectionSymbols->begin()) {
+            --TargetSym;
+            uint64_t TargetAddress = std::get<0>(*TargetSym);
+            StringRef TargetName = std::get<1>(*TargetSym);
+            OS << " <" << TargetName;
+            uint64_t Disp = Target - TargetAddress;
+            if (Disp)
+              OS << "+0x" << Twine::utohexstr(Disp);
+            OS << '>';
+          }
+        }
+      }
+      OS << "\n";
+
+      // Hexagon does this in pretty printer
+      if (Obj->getArch() != Triple::hexagon) {
+        // Print relocation for instruction.
+        while (RelCur != RelEnd) {
+          uint64_t Offset = RelCur->getOffset();
+          // If this relocation is hidden, skip it.
+          if (getHidden(*RelCur) || SectionAddr + Offset < StartAddress) {
+            ++RelCur;
+            continue;
+          }
+
+          // Stop when RelCur's offset is past the current instruction.
+          if (Offset >= Index + Size)
+            break;
+
+          // When --adjust-vma is used, update the address printed.
+          if (RelCur->getSymbol() != Obj->symbol_end()) {
+            Expected<section_iterator> SymSI =
+                RelCur->getSymbol()->getSection();
+            if (SymSI && *SymSI != Obj->section_end() &&
+                shouldAdjustVA(**SymSI))
+              Offset += AdjustVMA;
+          }
+
+          printRelocation(*RelCur, SectionAddr + Offset,
+                          Obj->getBytesInAddress(), OS);
+          ++RelCur;
+        }
+      }
+
+      Index += Size;
+    }
+  }
+}
+
+// Disassembles the chunks on one thread per disassembler state and prints
+// their output in order. A chunk is only started when it is at most a few
+// chunks ahead of the one being printed, to bound the buffered output.
+static void disassembleChunksInParallel(
+    const ObjectFile *Obj, ArrayRef<DisassemblyChunk> Chunks,
+    const ObjectSymbols &Syms,
+    ArrayRef<std::unique_ptr<DisassemblerState>> States,
+    const MCInstrAnalysis *MIA, const MCSubtargetInfo *STI, PrettyPrinter &PIP,
+    SourcePrinter &SP) {
+  struct ChunkOutput {
+    std::string Text;
+    bool PrintedSymbol = false;
+    bool Done = false;
+  };
+  std::vector<ChunkOutput> Outputs(Chunks.size());
+  std::mutex Mutex;
+  std::condition_variable Cond;
+  size_t NextChunk = 0;
+  size_t NextToPrint = 0;
+  size_t MaxAhead = 4 * States.size();
+
+  ThreadPool Pool(States.size());
+  for (const std::unique_ptr<DisassemblerState> &DS : States) {
+    DisassemblerState *State = DS.get();
+    Pool.async([&, State] {
+      while (true) {
+        size_t I;
+        {
+          std::unique_lock<std::mutex> Lock(Mutex);
+          Cond.wait(Lock, [&] {
+            return NextChunk == Chunks.size() ||
+                   NextChunk < NextToPrint + MaxAhead;
+          });
+          if (NextChunk == Chunks.size())
+            return;
+          I = NextChunk++;
+        }
+
+        std::string Text;
+        raw_string_ostream OS(Text);
+        bool PrintedSymbol = false;
+        disassembleChunk(Obj, Chunks[I], Syms, *State, MIA, STI, PIP, SP, OS,
+                         [&] { PrintedSymbol = true; });
+        OS.flush();
+
+        {
+          std::lock_guard<std::mutex> Lock(Mutex);
+          Outputs[I].Text = std::move(Text);
+          Outputs[I].PrintedSymbol = PrintedSymbol;
+          Outputs[I].Done = true;
+        }
+        Cond.notify_all();
+      }
+    });
+  }
+
+  const SectionInfo *PrintedSection = nullptr;
+  for (size_t I = 0, E = Chunks.size(); I != E; ++I) {
+    ChunkOutput Output;
+    {
+      std::unique_lock<std::mutex> Lock(Mutex);
+      Cond.wait(Lock, [&] { return Outputs[I].Done; });
+      Output = std::move(Outputs[I]);
+      NextToPrint = I + 1;
+    }
+    Cond.notify_all();
+
+    if (Output.PrintedSymbol && PrintedSection != Chunks[I].Sec) {
+      PrintedSection = Chunks[I].Sec;
+      printSectionHeader(*PrintedSection, outs());
+    }
+    outs() << Output.Text;
+  }
+  Pool.wait();
+}
+
+static void
+disassembleObject(const ObjectFile *Obj,
+                  ArrayRef<std::unique_ptr<DisassemblerState>> States,
+                  const MCInstrAnalysis *MIA, const MCSubtargetInfo *STI,
+                  PrettyPrinter &PIP, SourcePrinter &SP, bool InlineRelocs) {
   std::map<SectionRef, std::vector<RelocationRef>> RelocMap;
   if (InlineRelocs)
     RelocMap = getRelocsMap(*Obj);
 
   // Create a mapping from virtual address to symbol name.  This is used to
   // pretty print the symbols while disassembling.
-  std::map<SectionRef, SectionSymbolsTy> AllSymbols;
-  SectionSymbolsTy AbsoluteSymbols;
+  ObjectSymbols Syms;
+  std::map<SectionRef, SectionSymbolsTy> &AllSymbols = Syms.AllSymbols;
+  SectionSymbolsTy &AbsoluteSymbols = Syms.AbsoluteSymbols;
   const StringRef FileName = Obj->getFileName();
   for (const SymbolRef &Symbol : Obj->symbols()) {
     uint64_t Address = unwrapOrError(Symbol.getAddress(), FileName);
@@ -1059,9 +1480,14 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
   addPltEntries(Obj, AllSymbols, Saver);
 
   // Create a mapping from virtual address to section.
-  std::vector<std::pair<uint64_t, SectionRef>> SectionAddresses;
-  for (SectionRef Sec : Obj->sections())
+  std::vector<std::pair<uint64_t, SectionRef>> &SectionAddresses =
+      Syms.SectionAddresses;
+  for (SectionRef Sec : Obj->sections()) {
     SectionAddresses.emplace_back(Sec.getAddress(), Sec);
+    // Give every section an entry, so that looking up the symbols of a
+    // section doesn't modify the map.
+    AllSymbols[Sec];
+  }
   array_pod_sort(SectionAddresses.begin(), SectionAddresses.end());
 
   // Linked executables (.exe and .dll files) typically don't include a real
@@ -1094,6 +1520,9 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
     array_pod_sort(SecSyms.second.begin(), SecSyms.second.end());
   array_pod_sort(AbsoluteSymbols.begin(), AbsoluteSymbols.end());
 
+  // Collect the sections to disassemble. This finishes the symbol tables, so
+  // that they are not modified by the disassembly of any section.
+  std::vector<SectionInfo> Sections;
   for (const SectionRef &Section : ToolSectionFilter(*Obj)) {
     if (!DisassembleAll && (!Section.isText() || Section.isVirtual()))
       continue;
@@ -1103,303 +1532,108 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
     if (!SectSize)
       continue;
 
+    SectionInfo SecInfo;
+    SecInfo.Section = Section;
+
     // Get the list of all the symbols in this section.
     SectionSymbolsTy &Symbols = AllSymbols[Section];
-    std::vector<uint64_t> DataMappingSymsAddr;
-    std::vector<uint64_t> TextMappingSymsAddr;
+    SecInfo.Symbols = &Symbols;
     if (isArmElf(Obj)) {
       for (const auto &Symb : Symbols) {
         uint64_t Address = std::get<0>(Symb);
         StringRef Name = std::get<1>(Symb);
         if (Name.startswith("$d"))
-          DataMappingSymsAddr.push_back(Address - SectionAddr);
+          SecInfo.DataMappingSymsAddr.push_back(Address - SectionAddr);
         if (Name.startswith("$x"))
-          TextMappingSymsAddr.push_back(Address - SectionAddr);
+          SecInfo.TextMappingSymsAddr.push_back(Address - SectionAddr);
         if (Name.startswith("$a"))
-          TextMappingSymsAddr.push_back(Address - SectionAddr);
+          SecInfo.TextMappingSymsAddr.push_back(Address - SectionAddr);
         if (Name.startswith("$t"))
-          TextMappingSymsAddr.push_back(Address - SectionAddr);
+          SecInfo.TextMappingSymsAddr.push_back(Address - SectionAddr);
       }
     }
 
-    llvm::sort(DataMappingSymsAddr);
-    llvm::sort(TextMappingSymsAddr);
+    llvm::sort(SecInfo.DataMappingSymsAddr);
+    llvm::sort(SecInfo.TextMappingSymsAddr);
 
-    if (Obj->isELF() && Obj->getArch() == Triple::amdgcn) {
-      // AMDGPU disassembler uses symbolizer for printing labels
-      std::unique_ptr<MCRelocationInfo> RelInfo(
-        TheTarget->createMCRelocationInfo(TripleName, Ctx));
-      if (RelInfo) {
-        std::unique_ptr<MCSymbolizer> Symbolizer(
-          TheTarget->createMCSymbolizer(
-            TripleName, nullptr, nullptr, &Symbols, &Ctx, std::move(RelInfo)));
-        DisAsm->setSymbolizer(std::move(Symbolizer));
-      }
-    }
-
-    StringRef SegmentName = "";
     if (const MachOObjectFile *MachO = dyn_cast<const MachOObjectFile>(Obj)) {
       DataRefImpl DR = Section.getRawDataRefImpl();
-      SegmentName = MachO->getSectionFinalSegmentName(DR);
+      SecInfo.SegmentName = MachO->getSectionFinalSegmentName(DR);
     }
-    StringRef SectionName;
-    error(Section.getName(SectionName));
+    error(Section.getName(SecInfo.SectionName));
 
     // If the section has no symbol at the start, just insert a dummy one.
     if (Symbols.empty() || std::get<0>(Symbols[0]) != 0) {
-      Symbols.insert(
-          Symbols.begin(),
-          std::make_tuple(SectionAddr, SectionName,
-                          Section.isText() ? ELF::STT_FUNC : ELF::STT_OBJECT));
+      Symbols.insert(Symbols.begin(),
+                     std::make_tuple(SectionAddr, SecInfo.SectionName,
+                                     Section.isText() ? ELF::STT_FUNC
+                                                      : ELF::STT_OBJECT));
     }
 
-    SmallString<40> Comments;
-    raw_svector_ostream CommentStream(Comments);
-
-    ArrayRef<uint8_t> Bytes = arrayRefFromStringRef(
+    SecInfo.Bytes = arrayRefFromStringRef(
         unwrapOrError(Section.getContents(), Obj->getFileName()));
 
-    uint64_t VMAAdjustment = 0;
+    SecInfo.VMAAdjustment = 0;
     if (shouldAdjustVA(Section))
-      VMAAdjustment = AdjustVMA;
-
-    uint64_t Size;
-    uint64_t Index;
-    bool PrintedSection = false;
-    std::vector<RelocationRef> Rels = RelocMap[Section];
-    std::vector<RelocationRef>::const_iterator RelCur = Rels.begin();
-    std::vector<RelocationRef>::const_iterator RelEnd = Rels.end();
-    // Disassemble symbol by symbol.
-    for (unsigned SI = 0, SE = Symbols.size(); SI != SE; ++SI) {
-      // Skip if --disassemble-functions is not empty and the symbol is not in
-      // the list.
-      if (!DisasmFuncsSet.empty() &&
-          !DisasmFuncsSet.count(std::get<1>(Symbols[SI])))
-        continue;
+      SecInfo.VMAAdjustment = AdjustVMA;
 
-      uint64_t Start = std::get<0>(Symbols[SI]);
-      if (Start < SectionAddr || StopAddress <= Start)
-        continue;
+    auto RelocsIt = RelocMap.find(Section);
+    if (RelocsIt != RelocMap.end())
+      SecInfo.Rels = RelocsIt->second;
 
-      // The end is the section end, the beginning of the next symbol, or
-      // --stop-address.
-      uint64_t End = std::min<uint64_t>(SectionAddr + SectSize, StopAddress);
-      if (SI + 1 < SE)
-        End = std::min(End, std::get<0>(Symbols[SI + 1]));
-      if (Start >= End || End <= StartAddress)
-        continue;
-      Start -= SectionAddr;
-      End -= SectionAddr;
-
-      if (!PrintedSection) {
-        PrintedSection = true;
-        outs() << "\nDisassembly of section ";
-        if (!SegmentName.empty())
-          outs() << SegmentName << ",";
-        outs() << SectionName << ":\n";
-      }
-
-      if (Obj->isELF() && Obj->getArch() == Triple::amdgcn) {
-        if (std::get<2>(Symbols[SI]) == ELF::STT_AMDGPU_HSA_KERNEL) {
-          // skip amd_kernel_code_t at the begining of kernel symbol (256 bytes)
-          Start += 256;
-        }
-        if (SI == SE - 1 ||
-            std::get<2>(Symbols[SI + 1]) == ELF::STT_AMDGPU_HSA_KERNEL) {
-          // cut trailing zeroes at the end of kernel
-          // cut up to 256 bytes
-          const uint64_t EndAlign = 256;
-          const auto Limit = End - (std::min)(EndAlign, End - Start);
-          while (End > Limit &&
-            *reinterpret_cast<const support::ulittle32_t*>(&Bytes[End - 4]) == 0)
-            End -= 4;
-        }
-      }
-
-      outs() << '\n';
-      if (!NoLeadingAddr)
-        outs() << format("%016" PRIx64 " ",
-                         SectionAddr + Start + VMAAdjustment);
+    Sections.push_back(std::move(SecInfo));
+  }
 
-      StringRef SymbolName = std::get<1>(Symbols[SI]);
-      if (Demangle)
-        outs() << demangle(SymbolName) << ":\n";
-      else
-        outs() << SymbolName << ":\n";
+  if (States.size() == 1) {
+    for (SectionInfo &SecInfo : Sections)
+      disassembleChunk(Obj, {&SecInfo, 0, unsigned(SecInfo.Symbols->size())},
+                       Syms, *States[0], MIA, STI, PIP, SP, outs(),
+                       [&] { printSectionHeader(SecInfo, outs()); });
+    return;
+  }
 
-      // Don't print raw contents of a virtual section. A virtual section
-      // doesn't have any contents in the file.
-      if (Section.isVirtual()) {
-        outs() << "...\n";
+  std::vector<DisassemblyChunk> Chunks;
+  for (SectionInfo &SecInfo : Sections) {
+    const SectionSymbolsTy &Symbols = *SecInfo.Symbols;
+    unsigned Begin = 0;
+    for (unsigned I = 1, E = Symbols.size(); I <= E; ++I) {
+      if (I != E && std::get<0>(Symbols[I]) - std::get<0>(Symbols[Begin]) <
+                        DisassemblyChunkSize)
         continue;
-      }
-
-#ifndef NDEBUG
-      raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
-#else
-      raw_ostream &DebugOut = nulls();
-#endif
-
-      // Some targets (like WebAssembly) have a special prelude at the start
-      // of each symbol.
-      DisAsm->onSymbolStart(SymbolName, Size, Bytes.slice(Start, End - Start),
-                            SectionAddr + Start, DebugOut, CommentStream);
-      Start += Size;
-
-      Index = Start;
-      if (SectionAddr < StartAddress)
-        Index = std::max<uint64_t>(Index, StartAddress - SectionAddr);
-
-      // If there is a data symbol inside an ELF text section and we are
-      // only disassembling text (applicable all architectures), we are in a
-      // situation where we must print the data and not disassemble it.
-      if (Obj->isELF() && std::get<2>(Symbols[SI]) == ELF::STT_OBJECT &&
-          !DisassembleAll && Section.isText()) {
-        dumpELFData(SectionAddr, Index, End, Bytes);
-        Index = End;
-      }
-
-      bool CheckARMELFData = isArmElf(Obj) &&
-                             std::get<2>(Symbols[SI]) != ELF::STT_OBJECT &&
-                             !DisassembleAll;
-      while (Index < End) {
-        // AArch64 ELF binaries can interleave data and text in the same
-        // section. We rely on the markers introduced to understand what we
-        // need to dump. If the data marker is within a function, it is
-        // denoted as a word/short etc.
-        if (CheckARMELFData &&
-            std::binary_search(DataMappingSymsAddr.begin(),
-                               DataMappingSymsAddr.end(), Index)) {
-          Index = dumpARMELFData(SectionAddr, Index, End, Obj, Bytes,
-                                 TextMappingSymsAddr);
-          continue;
-        }
-
-        // When -z or --disassemble-zeroes are given we always dissasemble
-        // them. Otherwise we might want to skip zero bytes we see.
-        if (!DisassembleZeroes) {
-          uint64_t MaxOffset = End - Index;
-          // For -reloc: print zero blocks patched by relocations, so that
-          // relocations can be shown in the dump.
-          if (RelCur != RelEnd)
-            MaxOffset = RelCur->getOffset() - Index;
-
-          if (size_t N =
-                  countSkippableZeroBytes(Bytes.slice(Index, MaxOffset))) {
-            outs() << "\t\t..." << '\n';
-            Index += N;
-            continue;
-          }
-        }
-
-        // Disassemble a real instruction or a data when disassemble all is
-        // provided
-        MCInst Inst;
-        bool Disassembled = DisAsm->getInstruction(
-            Inst, Size, Bytes.slice(Index), SectionAddr + Index, DebugOut,
-            CommentStream);
-        if (Size == 0)
-          Size = 1;
-
-        PIP.printInst(
-            *IP, Disassembled ? &Inst : nullptr, Bytes.slice(Index, Size),
-            {SectionAddr + Index + VMAAdjustment, Section.getIndex()}, outs(),
-            "", *STI, &SP, &Rels);
-        outs() << CommentStream.str();
-        Comments.clear();
-
-        // Try to resolve the target of a call, tail call, etc. to a specific
-        // symbol.
-        if (MIA && (MIA->isCall(Inst) || MIA->isUnconditionalBranch(Inst) ||
-                    MIA->isConditionalBranch(Inst))) {
-          uint64_t Target;
-          if (MIA->evaluateBranch(Inst, SectionAddr + Index, Size, Target)) {
-            // In a relocatable object, the target's section must reside in
-            // the same section as the call instruction or it is accessed
-            // through a relocation.
-            //
-            // In a non-relocatable object, the target may be in any section.
-            //
-            // N.B. We don't walk the relocations in the relocatable case yet.
-            auto *TargetSectionSymbols = &Symbols;
-            if (!Obj->isRelocatableObject()) {
-              auto It = llvm::bsearch(
-                  SectionAddresses,
-                  [=](const std::pair<uint64_t, SectionRef> &RHS) {
-                    return Target < RHS.first;
-                  });
-              if (It != SectionAddresses.begin()) {
-                --It;
-                TargetSectionSymbols = &AllSymbols[It->second];
-              } else {
-                TargetSectionSymbols = &AbsoluteSymbols;
-              }
-            }
+      Chunks.push_back({&SecInfo, Begin, I});
+      Begin = I;
+    }
+  }
+  disassembleChunksInParallel(Obj, Chunks, Syms, States, MIA, STI, PIP, SP);
+}
 
-            // Find the last symbol in the section whose offset is less than
-            // or equal to the target. If there isn't a section that contains
-            // the target, find the nearest preceding absolute symbol.
-            auto TargetSym = llvm::bsearch(
-                *TargetSectionSymbols,
-                [=](const std::tuple<uint64_t, StringRef, uint8_t> &RHS) {
-                  return Target < std::get<0>(RHS);
-                });
-            if (TargetSym == TargetSectionSymbols->begin()) {
-              TargetSectionSymbols = &AbsoluteSymbols;
-              TargetSym = llvm::bsearch(
-                  AbsoluteSymbols,
-                  [=](const std::tuple<uint64_t, StringRef, uint8_t> &RHS) {
-                    return Target < std::get<0>(RHS);
-                  });
-            }
-            if (TargetSym != TargetSectionSymbols->begin()) {
-              --TargetSym;
-              uint64_t TargetAddress = std::get<0>(*TargetSym);
-              StringRef TargetName = std::get<1>(*TargetSym);
-              outs() << " <" << TargetName;
-              uint64_t Disp = Target - TargetAddress;
-              if (Disp)
-                outs() << "+0x" << Twine::utohexstr(Disp);
-              outs() << '>';
-            }
-          }
-        }
-        outs() << "\n";
-
-        // Hexagon does this in pretty printer
-        if (Obj->getArch() != Triple::hexagon) {
-          // Print relocation for instruction.
-          while (RelCur != RelEnd) {
-            uint64_t Offset = RelCur->getOffset();
-            // If this relocation is hidden, skip it.
-            if (getHidden(*RelCur) || SectionAddr + Offset < StartAddress) {
-              ++RelCur;
-              continue;
-            }
+static std::unique_ptr<DisassemblerState>
+createDisassemblerState(const Target *TheTarget, const ObjectFile *Obj,
+                        const MCAsmInfo &AsmInfo, const MCRegisterInfo &MRI,
+                        const MCInstrInfo &MII, const MCSubtargetInfo &STI) {
+  auto DS = llvm::make_unique<DisassemblerState>();
+  DS->TheTarget = TheTarget;
+  DS->Ctx = llvm::make_unique<MCContext>(&AsmInfo, &MRI, &DS->MOFI);
+  // FIXME: for now initialize MCObjectFileInfo with default values
+  DS->MOFI.InitMCObjectFileInfo(Triple(TripleName), false, *DS->Ctx);
 
-            // Stop when RelCur's offset is past the current instruction.
-            if (Offset >= Index + Size)
-              break;
-
-            // When --adjust-vma is used, update the address printed.
-            if (RelCur->getSymbol() != Obj->symbol_end()) {
-              Expected<section_iterator> SymSI =
-                  RelCur->getSymbol()->getSection();
-              if (SymSI && *SymSI != Obj->section_end() &&
-                  shouldAdjustVA(**SymSI))
-                Offset += AdjustVMA;
-            }
+  DS->DisAsm.reset(TheTarget->createMCDisassembler(STI, *DS->Ctx));
+  if (!DS->DisAsm)
+    report_error(Obj->getFileName(),
+                 "no disassembler for target " + TripleName);
 
-            printRelocation(*RelCur, SectionAddr + Offset,
-                            Obj->getBytesInAddress());
-            ++RelCur;
-          }
-        }
+  int AsmPrinterVariant = AsmInfo.getAssemblerDialect();
+  DS->IP.reset(TheTarget->createMCInstPrinter(
+      Triple(TripleName), AsmPrinterVariant, AsmInfo, MII, MRI));
+  if (!DS->IP)
+    report_error(Obj->getFileName(),
+                 "no instruction printer for target " + TripleName);
+  DS->IP->setPrintImmHex(PrintImmHex);
 
-        Index += Size;
-      }
-    }
-  }
+  for (StringRef Opt : DisassemblerOptions)
+    if (!DS->IP->applyTargetSpecificCLOption(Opt))
+      error("Unrecognized disassembler option: " + Opt);
+  return DS;
 }
 
 static void disassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
@@ -1435,37 +1669,25 @@ static void disassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
   if (!MII)
     report_error(Obj->getFileName(),
                  "no instruction info for target " + TripleName);
-  MCObjectFileInfo MOFI;
-  MCContext Ctx(AsmInfo.get(), MRI.get(), &MOFI);
-  // FIXME: for now initialize MCObjectFileInfo with default values
-  MOFI.InitMCObjectFileInfo(Triple(TripleName), false, Ctx);
 
-  std::unique_ptr<MCDisassembler> DisAsm(
-      TheTarget->createMCDisassembler(*STI, Ctx));
-  if (!DisAsm)
-    report_error(Obj->getFileName(),
-                 "no disassembler for target " + TripleName);
+  // The source printer keeps track of the last line it printed, so source
+  // interleaving needs the instructions in order and is never parallel.
+  unsigned NumStates = 1;
+  if (!PrintSource && !PrintLines)
+    NumStates = NumThreads ? NumThreads : hardware_concurrency();
+
+  std::vector<std::unique_ptr<DisassemblerState>> States;
+  for (unsigned I = 0; I != NumStates; ++I)
+    States.push_back(
+        createDisassemblerState(TheTarget, Obj, *AsmInfo, *MRI, *MII, *STI));
 
   std::unique_ptr<const MCInstrAnalysis> MIA(
       TheTarget->createMCInstrAnalysis(MII.get()));
 
-  int AsmPrinterVariant = AsmInfo->getAssemblerDialect();
-  std::unique_ptr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
-      Triple(TripleName), AsmPrinterVariant, *AsmInfo, *MII, *MRI));
-  if (!IP)
-    report_error(Obj->getFileName(),
-                 "no instruction printer for target " + TripleName);
-  IP->setPrintImmHex(PrintImmHex);
-
   PrettyPrinter &PIP = selectPrettyPrinter(Triple(TripleName));
   SourcePrinter SP(Obj, TheTarget->getName());
 
-  for (StringRef Opt : DisassemblerOptions)
-    if (!IP->applyTargetSpecificCLOption(Opt))
-      error("Unrecognized disassembler option: " + Opt);
-
-  disassembleObject(TheTarget, Obj, Ctx, DisAsm.get(), MIA.get(), IP.get(),
-                    STI.get(), PIP, SP, InlineRelocs);
+  disassembleObject(Obj, States, MIA.get(), STI.get(), PIP, SP, InlineRelocs);
 }
 
 void printRelocations(const ObjectFile *Obj) {
@@ -20,6 +20,8 @@
 #include "llvm/ProfileData/SampleProfReader.h"
 #include "llvm/ProfileData/SampleProfWriter.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compression.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
@@ -38,7 +40,8 @@ enum ProfileFormat {
   PF_Text,
   PF_Compact_Binary,
   PF_GCC,
-  PF_Binary
+  PF_Binary,
+  PF_Ext_Binary
 };
 
 static void warn(Twine Message, std::string Whence = "",
@@ -287,6 +290,20 @@ static void loadInput(const WeightedFile &Input, SymbolRemapper *Remapper,
   }
 }
 
+/// Report the hard error \p E, deferred while merging \p Whence.
+static void handleDeferredError(Error E, const std::string &Whence) {
+  if (!E)
+    return;
+  if (!E.isA<InstrProfError>())
+    exitWithError(std::move(E), Whence);
+
+  instrprof_error IPE = InstrProfError::take(std::move(E));
+  if (isFatalError(IPE))
+    exitWithError(make_error<InstrProfError>(IPE), Whence);
+  else
+    warn(toString(make_error<InstrProfError>(IPE)), Whence);
+}
+
 /// Merge the \p Src writer context into \p Dst.
 static void mergeWriterContexts(WriterContext *Dst, WriterContext *Src) {
   // If we've already seen a hard error, continuing with the merge would
@@ -305,11 +322,271 @@ static void mergeWriterContexts(WriterContext *Dst, WriterContext *Src) {
   });
 }
 
+static void writeInstrProfile(raw_fd_ostream &Output,
+                              ProfileFormat OutputFormat,
+                              InstrProfWriter &Writer) {
+  if (OutputFormat == PF_Text) {
+    if (Error E = Writer.writeText(Output))
+      exitWithError(std::move(E));
+  } else {
+    Writer.write(Output);
+  }
+}
+
+// With -merge-run-size, the inputs are merged in batches, each of which is
+// written to a temporary file as a run of records sorted by the MD5 hash of the
+// function name. The runs are then merged with a single k-way merge, which
+// keeps only one record per run in memory. Runs are only read back by the
+// process that wrote them, so they use the host byte order. Every field is 8
+// bytes, and each record is:
+//   NameHash, NameSize, Name (padded to 8 bytes), Hash, NumCounts,
+//   Counts[NumCounts], ValueDataSize, ValueData (a serialized ValueProfData,
+//   if ValueDataSize isn't 0).
+
+/// Write the records of \p Writer as a sorted run to \p FD.
+static std::error_code writeMergeRun(const InstrProfWriter &Writer, int FD) {
+  using RecordRef =
+      std::tuple<uint64_t, StringRef, uint64_t, const InstrProfRecord *>;
+  std::vector<RecordRef> Records;
+  for (const auto &Func : Writer.getProfileData())
+    for (const auto &Record : Func.getValue())
+      Records.emplace_back(MD5Hash(Func.getKey()), Func.getKey(), Record.first,
+                           &Record.second);
+  llvm::sort(Records, [](const RecordRef &L, const RecordRef &R) {
+    return std::tie(std::get<0>(L), std::get<1>(L), std::get<2>(L)) <
+           std::tie(std::get<0>(R), std::get<1>(R), std::get<2>(R));
+  });
+
+  raw_fd_ostream OS(FD, /*shouldClose=*/true);
+  support::endian::Writer W(OS, support::native);
+  for (const RecordRef &R : Records) {
+    StringRef Name = std::get<1>(R);
+    const InstrProfRecord &Record = *std::get<3>(R);
+    W.write<uint64_t>(std::get<0>(R));
+    W.write<uint64_t>(Name.size());
+    OS << Name;
+    OS.write_zeros(alignTo(Name.size(), sizeof(uint64_t)) - Name.size());
+    W.write<uint64_t>(std::get<2>(R));
+    W.write<uint64_t>(Record.Counts.size());
+    for (uint64_t Count : Record.Counts)
+      W.write<uint64_t>(Count);
+    if (!Record.getNumValueKinds()) {
+      W.write<uint64_t>(0);
+      continue;
+    }
+    std::unique_ptr<ValueProfData> ValueData =
+        ValueProfData::serializeFrom(Record);
+    W.write<uint64_t>(ValueData->getSize());
+    OS.write(reinterpret_cast<const char *>(ValueData.get()),
+             ValueData->getSize());
+  }
+  OS.close();
+  std::error_code EC = OS.error();
+  OS.clear_error();
+  return EC;
+}
+
+namespace {
+/// Reads a run written by writeMergeRun back, one record at a time.
+class MergeRunReader {
+  std::unique_ptr<MemoryBuffer> Buffer;
+  const char *Next;
+  /// The position of the run among the runs, which orders the records of the
+  /// same function like the inputs.
+  size_t Index;
+
+  bool readField(uint64_t &Field) {
+    if (Buffer->getBufferEnd() - Next < (ptrdiff_t)sizeof(uint64_t))
+      return false;
+    Field = support::endian::read<uint64_t, support::native, support::aligned>(
+        Next);
+    Next += sizeof(uint64_t);
+    return true;
+  }
+
+public:
+  /// The current record, and the MD5 hash of its name.
+  uint64_t NameHash = 0;
+  NamedInstrProfRecord Record;
+
+  MergeRunReader(std::unique_ptr<MemoryBuffer> Buffer, size_t Index)
+      : Buffer(std::move(Buffer)), Next(this->Buffer->getBufferStart()),
+        Index(Index) {}
+
+  StringRef getPath() const { return Buffer->getBufferIdentifier(); }
+
+  /// Read the next record. Returns false at the end of the run.
+  Expected<bool> readNext() {
+    const char *End = Buffer->getBufferEnd();
+    if (Next == End)
+      return false;
+
+    uint64_t NameSize, NumCounts, ValueDataSize;
+    if (!readField(NameHash) || !readField(NameSize) ||
+        (uint64_t)(End - Next) < alignTo(NameSize, sizeof(uint64_t)))
+      return make_error<InstrProfError>(instrprof_error::malformed);
+    Record.Name = StringRef(Next, NameSize);
+    Next += alignTo(NameSize, sizeof(uint64_t));
+    if (!readField(Record.Hash) || !readField(NumCounts) ||
+        (uint64_t)(End - Next) / sizeof(uint64_t) < NumCounts)
+      return make_error<InstrProfError>(instrprof_error::malformed);
+    Record.Counts.resize(NumCounts);
+    for (uint64_t &Count : Record.Counts)
+      readField(Count);
+    if (!readField(ValueDataSize) || (uint64_t)(End - Next) < ValueDataSize)
+      return make_error<InstrProfError>(instrprof_error::malformed);
+
+    Record.clearValueData();
+    if (ValueDataSize) {
+      Expected<std::unique_ptr<ValueProfData>> ValueData =
+          ValueProfData::getValueProfData(
+              reinterpret_cast<const unsigned char *>(Next),
+              reinterpret_cast<const unsigned char *>(End),
+              getHostEndianness());
+      if (!ValueData)
+        return ValueData.takeError();
+      ValueData.get()->deserializeTo(Record, nullptr);
+      Next += ValueDataSize;
+    }
+    return true;
+  }
+
+  /// Order the runs by their current record.
+  bool operator<(const MergeRunReader &RHS) const {
+    return std::tie(NameHash, Record.Name, Record.Hash, Index) <
+           std::tie(RHS.NameHash, RHS.Record.Name, RHS.Record.Hash, RHS.Index);
+  }
+};
+
+/// A batch of inputs merged into a run.
+struct MergeRun {
+  SmallString<128> Path;
+  std::error_code EC;
+  InstrProfWriter::ProfKind Kind = InstrProfWriter::PF_Unknown;
+  /// The context the batch was loaded into, kept only if it has an error.
+  std::unique_ptr<WriterContext> FailedContext;
+};
+} // namespace
+
+/// Load the inputs \p Batch and write them out as the sorted run \p Run.
+static void buildMergeRun(ArrayRef<WeightedFile> Batch,
+                          SymbolRemapper *Remapper, bool OutputSparse,
+                          std::mutex &ErrorLock,
+                          SmallSet<instrprof_error, 4> &WriterErrorCodes,
+                          MergeRun *Run) {
+  auto WC = llvm::make_unique<WriterContext>(OutputSparse, ErrorLock,
+                                             WriterErrorCodes);
+  for (const auto &Input : Batch)
+    loadInput(Input, Remapper, WC.get());
+
+  int FD;
+  Run->EC = sys::fs::createTemporaryFile("llvm-profdata", "run", FD, Run->Path);
+  if (!Run->EC)
+    Run->EC = writeMergeRun(WC->Writer, FD);
+  Run->Kind = WC->Writer.getProfileKind();
+  if (WC->Err)
+    Run->FailedContext = std::move(WC);
+}
+
+/// Merge \p Inputs into \p Writer in runs of \p RunSize inputs.
+static void mergeInstrProfileInRuns(const WeightedFileVector &Inputs,
+                                    SymbolRemapper *Remapper,
+                                    bool OutputSparse, unsigned NumThreads,
+                                    unsigned RunSize, InstrProfWriter &Writer) {
+  std::mutex ErrorLock;
+  SmallSet<instrprof_error, 4> WriterErrorCodes;
+
+  // Each thread only holds the batch it is merging.
+  std::vector<MergeRun> Runs((Inputs.size() + RunSize - 1) / RunSize);
+  ThreadPool Pool(NumThreads);
+  for (size_t I = 0; I < Runs.size(); ++I) {
+    ArrayRef<WeightedFile> Batch = makeArrayRef(Inputs).slice(
+        I * RunSize, std::min<size_t>(RunSize, Inputs.size() - I * RunSize));
+    Pool.async(buildMergeRun, Batch, Remapper, OutputSparse,
+               std::ref(ErrorLock), std::ref(WriterErrorCodes), &Runs[I]);
+  }
+  Pool.wait();
+
+  std::vector<std::unique_ptr<MergeRunReader>> Readers;
+  for (MergeRun &Run : Runs) {
+    if (Run.EC)
+      exitWithErrorCode(Run.EC, Run.Path);
+    if (Run.FailedContext)
+      handleDeferredError(std::move(Run.FailedContext->Err),
+                          Run.FailedContext->ErrWhence);
+    if (Run.Kind != InstrProfWriter::PF_Unknown) {
+      if (Error E = Writer.setIsIRLevelProfile(
+              Run.Kind != InstrProfWriter::PF_FE,
+              Run.Kind == InstrProfWriter::PF_IRLevelWithCS)) {
+        consumeError(std::move(E));
+        exitWithError(
+            "Merge IR generated profile with Clang generated profile.");
+      }
+    }
+
+    auto BufOrErr = MemoryBuffer::getFile(Run.Path, /*FileSize=*/-1,
+                                          /*RequiresNullTerminator=*/false);
+    if (!BufOrErr)
+      exitWithErrorCode(BufOrErr.getError(), Run.Path);
+    Readers.push_back(
+        llvm::make_unique<MergeRunReader>(std::move(*BufOrErr), Readers.size()));
+  }
+
+  // Keep the readers in a min-heap by their current record, and merge the
+  // records of the same function as they come out.
+  auto Later = [](const MergeRunReader *L, const MergeRunReader *R) {
+    return *R < *L;
+  };
+  std::vector<MergeRunReader *> Heap;
+  auto Advance = [&](MergeRunReader *Reader) {
+    Expected<bool> HasNext = Reader->readNext();
+    if (!HasNext)
+      exitWithError(HasNext.takeError(), Reader->getPath());
+    if (*HasNext) {
+      Heap.push_back(Reader);
+      std::push_heap(Heap.begin(), Heap.end(), Later);
+    }
+  };
+  auto Pop = [&]() {
+    std::pop_heap(Heap.begin(), Heap.end(), Later);
+    MergeRunReader *Reader = Heap.back();
+    Heap.pop_back();
+    return Reader;
+  };
+  for (auto &Reader : Readers)
+    Advance(Reader.get());
+
+  while (!Heap.empty()) {
+    MergeRunReader *Reader = Pop();
+    uint64_t NameHash = Reader->NameHash;
+    NamedInstrProfRecord Merged = std::move(Reader->Record);
+    auto Warn = [&](instrprof_error IPE) {
+      bool FirstTime = WriterErrorCodes.insert(IPE).second;
+      handleMergeWriterError(make_error<InstrProfError>(IPE), "", Merged.Name,
+                             FirstTime);
+    };
+    Advance(Reader);
+    while (!Heap.empty() && Heap.front()->NameHash == NameHash &&
+           Heap.front()->Record.Name == Merged.Name &&
+           Heap.front()->Record.Hash == Merged.Hash) {
+      Reader = Pop();
+      Merged.merge(Reader->Record, 1, Warn);
+      Advance(Reader);
+    }
+    Writer.addRecord(std::move(Merged), [&](Error E) {
+      Warn(InstrProfError::take(std::move(E)));
+    });
+  }
+
+  for (MergeRun &Run : Runs)
+    sys::fs::remove(Run.Path);
+}
+
 static void mergeInstrProfile(const WeightedFileVector &Inputs,
                               SymbolRemapper *Remapper,
                               StringRef OutputFilename,
                               ProfileFormat OutputFormat, bool OutputSparse,
-                              unsigned NumThreads) {
+                              unsigned NumThreads, unsigned RunSize) {
   if (OutputFilename.compare("-") == 0)
     exitWithError("Cannot write indexed profdata format to stdout.");
 
@@ -322,6 +599,17 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
   if (EC)
     exitWithErrorCode(EC, OutputFilename);
 
+  if (RunSize) {
+    if (NumThreads == 0)
+      NumThreads = std::min<size_t>(hardware_concurrency(),
+                                    (Inputs.size() + RunSize - 1) / RunSize);
+    InstrProfWriter Writer(OutputSparse);
+    mergeInstrProfileInRuns(Inputs, Remapper, OutputSparse, NumThreads, RunSize,
+                            Writer);
+    writeInstrProfile(Output, OutputFormat, Writer);
+    return;
+  }
+
   std::mutex ErrorLock;
   SmallSet<instrprof_error, 4> WriterErrorCodes;
 
@@ -370,27 +658,10 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
   }
 
   // Handle deferred hard errors encountered during merging.
-  for (std::unique_ptr<WriterContext> &WC : Contexts) {
-    if (!WC->Err)
-      continue;
-    if (!WC->Err.isA<InstrProfError>())
-      exitWithError(std::move(WC->Err), WC->ErrWhence);
-
-    instrprof_error IPE = InstrProfError::take(std::move(WC->Err));
-    if (isFatalError(IPE))
-      exitWithError(make_error<InstrProfError>(IPE), WC->ErrWhence);
-    else
-      warn(toString(make_error<InstrProfError>(IPE)),
-           WC->ErrWhence);
-  }
+  for (std::unique_ptr<WriterContext> &WC : Contexts)
+    handleDeferredError(std::move(WC->Err), WC->ErrWhence);
 
-  InstrProfWriter &Writer = Contexts[0]->Writer;
-  if (OutputFormat == PF_Text) {
-    if (Error E = Writer.writeText(Output))
-      exitWithError(std::move(E));
-  } else {
-    Writer.write(Output);
-  }
+  writeInstrProfile(Output, OutputFormat, Contexts[0]->Writer);
 }
 
 /// Make a copy of the given function samples with all symbol names remapped
@@ -426,12 +697,13 @@ remapSamples(const sampleprof::FunctionSamples &Samples,
 
 static sampleprof::SampleProfileFormat FormatMap[] = {
     sampleprof::SPF_None, sampleprof::SPF_Text, sampleprof::SPF_Compact_Binary,
-    sampleprof::SPF_GCC, sampleprof::SPF_Binary};
+    sampleprof::SPF_GCC, sampleprof::SPF_Binary, sampleprof::SPF_Ext_Binary};
 
 static void mergeSampleProfile(const WeightedFileVector &Inputs,
                                SymbolRemapper *Remapper,
                                StringRef OutputFilename,
-                               ProfileFormat OutputFormat) {
+                               ProfileFormat OutputFormat,
+                               bool CompressAllSections) {
   using namespace sampleprof;
   auto WriterOrErr =
       SampleProfileWriter::create(OutputFilename, FormatMap[OutputFormat]);
@@ -439,6 +711,15 @@ static void mergeSampleProfile(const WeightedFileVector &Inputs,
     exitWithErrorCode(EC, OutputFilename);
 
   auto Writer = std::move(WriterOrErr.get());
+  if (CompressAllSections) {
+    if (OutputFormat != PF_Ext_Binary)
+      warn("-compress-all-sections is ignored. Specify -extbinary to enable "
+           "it");
+    else if (!zlib::isAvailable())
+      exitWithError("Cannot compress the sections, zlib is not available");
+    else
+      Writer->setToCompressAllSections();
+  }
   StringMap<FunctionSamples> ProfileMap;
   SmallVector<std::unique_ptr<sampleprof::SampleProfileReader>, 5> Readers;
   LLVMContext Context;
@@ -473,7 +754,8 @@ static void mergeSampleProfile(const WeightedFileVector &Inputs,
       }
     }
   }
-  Writer->write(ProfileMap);
+  if (std::error_code EC = Writer->write(ProfileMap))
+    exitWithErrorCode(EC, OutputFilename);
 }
 
 static WeightedFile parseWeightedFile(const StringRef &WeightedFilename) {
@@ -586,6 +868,8 @@ static int merge_main(int argc, const char *argv[]) {
       cl::values(clEnumValN(PF_Binary, "binary", "Binary encoding (default)"),
                  clEnumValN(PF_Compact_Binary, "compbinary",
                             "Compact binary encoding"),
+                 clEnumValN(PF_Ext_Binary, "extbinary",
+                            "Extensible binary encoding"),
                  clEnumValN(PF_Text, "text", "Text encoding"),
                  clEnumValN(PF_GCC, "gcc",
                             "GCC encoding (only meaningful for -sample)")));
@@ -596,6 +880,16 @@ static int merge_main(int argc, const char *argv[]) {
       cl::desc("Number of merge threads to use (default: autodetect)"));
   cl::alias NumThreadsA("j", cl::desc("Alias for --num-threads"),
                         cl::aliasopt(NumThreads));
+  cl::opt<unsigned> MergeRunSize(
+      "merge-run-size", cl::init(0),
+      cl::desc("Merge this many inputs at a time into sorted temporary files, "
+               "which are then merged in a single pass, so that memory use "
+               "doesn't grow with the number of inputs (default: 0, merge "
+               "everything in memory; only meaningful for -instr)"));
+  cl::opt<bool> CompressAllSections(
+      "compress-all-sections", cl::init(false), cl::Hidden,
+      cl::desc("Compress all sections when writing the profile (only "
+               "meaningful for -extbinary)"));
 
   cl::ParseCommandLineOptions(argc, argv, "LLVM profile data merger\n");
 
@@ -626,10 +920,10 @@ static int merge_main(int argc, const char *argv[]) {
 
   if (ProfileKind == instr)
     mergeInstrProfile(WeightedInputs, Remapper.get(), OutputFilename,
-                      OutputFormat, OutputSparse, NumThreads);
+                      OutputFormat, OutputSparse, NumThreads, MergeRunSize);
   else
     mergeSampleProfile(WeightedInputs, Remapper.get(), OutputFilename,
-                       OutputFormat);
+                       OutputFormat, CompressAllSections);
 
   return 0;
 }
@@ -133,6 +133,11 @@ static cl::opt<int> ClPrintSourceContextLines(
 static cl::opt<bool> ClVerbose("verbose", cl::init(false),
                                cl::desc("Print verbose line info"));
 
+static cl::opt<uint64_t> ClCacheSize(
+    "cache-size", cl::init(0), cl::value_desc("bytes"),
+    cl::desc("Unload the least recently used object files once the loaded "
+             "ones exceed this size (0 = unlimited)"));
+
 // -adjust-vma
 static cl::opt<uint64_t>
     ClAdjustVMA("adjust-vma", cl::init(0), cl::value_desc("offset"),
@@ -272,6 +277,7 @@ int main(int argc, char **argv) {
   LLVMSymbolizer::Options Opts(ClPrintFunctions, ClUseSymbolTable, ClDemangle,
                                ClUseRelativeAddress, ClDefaultArch,
                                ClFallbackDebugPath);
+  Opts.MaxCacheSize = ClCacheSize;
 
   for (const auto &hint : ClDsymHint) {
     if (sys::path::extension(hint) == ".dSYM") {
@@ -11,7 +11,9 @@
 //===----------------------------------------------------------------------===//
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <mutex>
 #include <numeric>
 #include <system_error>
 #include <utility>
@@ -20,6 +22,8 @@
 #include "xray-registry.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/XRay/InstrumentationMap.h"
 #include "llvm/XRay/Trace.h"
 
@@ -119,6 +123,14 @@ static cl::opt<std::string>
 static cl::alias AccountInstrMap2("m", cl::aliasopt(AccountInstrMap),
                                   cl::desc("Alias for -instr_map"),
                                   cl::sub(Account));
+static cl::opt<unsigned>
+    AccountThreads("threads",
+                   cl::desc("number of threads to account the trace with; 0 "
+                            "uses all available hardware threads"),
+                   cl::value_desc("N"), cl::sub(Account), cl::init(0));
+static cl::alias AccountThreads2("j", cl::aliasopt(AccountThreads),
+                                 cl::desc("Alias for -threads"),
+                                 cl::sub(Account));
 
 namespace {
 
@@ -218,6 +230,36 @@ bool LatencyAccountant::accountRecord(const XRayRecord &Record) {
   return true;
 }
 
+void LatencyAccountant::merge(LatencyAccountant &&Other) {
+  auto MergeMinMax = [](std::pair<uint64_t, uint64_t> &MM,
+                        const std::pair<uint64_t, uint64_t> &Other) {
+    if (MM.first == 0 || MM.second == 0)
+      MM = Other;
+    else if (Other.first != 0 && Other.second != 0)
+      MM = std::make_pair(std::min(MM.first, Other.first),
+                          std::max(MM.second, Other.second));
+  };
+
+  for (auto &FT : Other.FunctionLatencies) {
+    auto &Timings = FunctionLatencies[FT.first];
+    if (Timings.empty())
+      Timings = std::move(FT.second);
+    else
+      Timings.insert(Timings.end(), FT.second.begin(), FT.second.end());
+  }
+  for (const auto &MM : Other.PerThreadMinMaxTSC)
+    MergeMinMax(PerThreadMinMaxTSC[MM.first], MM.second);
+  for (const auto &MM : Other.PerCPUMinMaxTSC)
+    MergeMinMax(PerCPUMinMaxTSC[MM.first], MM.second);
+  for (auto &TS : Other.PerThreadFunctionStack) {
+    auto &Stack = PerThreadFunctionStack[TS.first];
+    Stack.insert(Stack.end(), TS.second.begin(), TS.second.end());
+  }
+  if (CurrentMaxTSC == 0)
+    CurrentMaxTSC = Other.CurrentMaxTSC;
+  Other.FunctionLatencies.clear();
+}
+
 namespace {
 
 // We consolidate the data into a struct which we can output in various forms.
@@ -432,49 +474,111 @@ static CommandRegistration Unused(&Account, []() -> Error {
   symbolize::LLVMSymbolizer Symbolizer(Opts);
   llvm::xray::FuncIdConversionHelper FuncIdHelper(AccountInstrMap, Symbolizer,
                                                   FunctionAddresses);
-  xray::LatencyAccountant FCA(FuncIdHelper, AccountDeduceSiblingCalls);
-  auto TraceOrErr = loadTraceFile(AccountInput);
-  if (!TraceOrErr)
+  auto StreamOrErr = openTraceStream(AccountInput);
+  if (!StreamOrErr)
     return joinErrors(
         make_error<StringError>(
             Twine("Failed loading input file '") + AccountInput + "'",
             std::make_error_code(std::errc::executable_format_error)),
-        TraceOrErr.takeError());
-
-  auto &T = *TraceOrErr;
-  for (const auto &Record : T) {
-    if (FCA.accountRecord(Record))
-      continue;
-    errs()
-        << "Error processing record: "
-        << llvm::formatv(
-               R"({{type: {0}; cpu: {1}; record-type: {2}; function-id: {3}; tsc: {4}; thread-id: {5}; process-id: {6}}})",
-               Record.RecordType, Record.CPU, Record.Type, Record.FuncId,
-               Record.TSC, Record.TId, Record.PId)
-        << '\n';
-    for (const auto &ThreadStack : FCA.getPerThreadFunctionStack()) {
-      errs() << "Thread ID: " << ThreadStack.first << "\n";
-      if (ThreadStack.second.empty()) {
+        StreamOrErr.takeError());
+  auto &TS = **StreamOrErr;
+
+  // Function call stacks never span threads, so we account every thread in
+  // the trace independently on a pool of workers and merge the results once
+  // they're done. Records that fail to account are only reported from here,
+  // in thread order, as the symbolizer isn't thread-safe.
+  struct AccountingFailure {
+    XRayRecord Record;
+    xray::LatencyAccountant::FunctionStack Stack;
+  };
+  size_t NumThreads = TS.threads().size();
+  std::vector<xray::LatencyAccountant> Accountants;
+  Accountants.reserve(NumThreads);
+  for (size_t I = 0; I != NumThreads; ++I)
+    Accountants.emplace_back(FuncIdHelper, AccountDeduceSiblingCalls);
+  std::vector<std::vector<AccountingFailure>> Failures(NumThreads);
+  std::atomic<bool> Failed(false);
+  std::mutex ErrMutex;
+  Error Err = Error::success();
+  {
+    unsigned NumWorkers =
+        AccountThreads ? AccountThreads : hardware_concurrency();
+    ThreadPool Pool(std::max<size_t>(1, std::min<size_t>(NumWorkers,
+                                                         NumThreads)));
+    for (size_t I = 0; I != NumThreads; ++I)
+      Pool.async([&, I] {
+        auto &A = Accountants[I];
+        auto E = TS.forEachRecord(I, [&](const XRayRecord &Record) -> Error {
+          // Stop early once some other thread failed, unless keeping going.
+          if (!AccountKeepGoing && Failed)
+            return make_error<StringError>(
+                "Accounting cancelled.",
+                std::make_error_code(std::errc::operation_canceled));
+          if (A.accountRecord(Record))
+            return Error::success();
+          AccountingFailure F{Record, {}};
+          if (const auto *Stack = A.getThreadFunctionStack(Record.TId))
+            F.Stack = *Stack;
+          Failures[I].push_back(std::move(F));
+          if (AccountKeepGoing)
+            return Error::success();
+          Failed = true;
+          return make_error<StringError>(
+              "Failed accounting record.",
+              std::make_error_code(std::errc::executable_format_error));
+        });
+        if (E) {
+          std::lock_guard<std::mutex> Lock(ErrMutex);
+          Err = joinErrors(std::move(Err), std::move(E));
+        }
+      });
+    Pool.wait();
+  }
+
+  for (const auto &ThreadFailures : Failures)
+    for (const auto &F : ThreadFailures) {
+      const auto &Record = F.Record;
+      errs()
+          << "Error processing record: "
+          << llvm::formatv(
+                 R"({{type: {0}; cpu: {1}; record-type: {2}; function-id: {3}; tsc: {4}; thread-id: {5}; process-id: {6}}})",
+                 Record.RecordType, Record.CPU, Record.Type, Record.FuncId,
+                 Record.TSC, Record.TId, Record.PId)
+          << '\n';
+      errs() << "Thread ID: " << Record.TId << "\n";
+      if (F.Stack.empty()) {
         errs() << "  (empty stack)\n";
         continue;
       }
-      auto Level = ThreadStack.second.size();
-      for (const auto &Entry : llvm::reverse(ThreadStack.second))
+      auto Level = F.Stack.size();
+      for (const auto &Entry : llvm::reverse(F.Stack))
         errs() << "  #" << Level-- << "\t"
                << FuncIdHelper.SymbolOrNumber(Entry.first) << '\n';
     }
-    if (!AccountKeepGoing)
-      return make_error<StringError>(
-          Twine("Failed accounting function calls in file '") + AccountInput +
-              "'.",
-          std::make_error_code(std::errc::executable_format_error));
+  if (Failed) {
+    consumeError(std::move(Err));
+    return make_error<StringError>(
+        Twine("Failed accounting function calls in file '") + AccountInput +
+            "'.",
+        std::make_error_code(std::errc::executable_format_error));
   }
+  if (Err)
+    return joinErrors(
+        make_error<StringError>(
+            Twine("Failed loading input file '") + AccountInput + "'",
+            std::make_error_code(std::errc::executable_format_error)),
+        std::move(Err));
+
+  xray::LatencyAccountant FCA(FuncIdHelper, AccountDeduceSiblingCalls);
+  for (auto &A : Accountants)
+    FCA.merge(std::move(A));
+
   switch (AccountOutputFormat) {
   case AccountOutputFormats::TEXT:
-    FCA.exportStatsAsText(OS, T.getFileHeader());
+    FCA.exportStatsAsText(OS, TS.getFileHeader());
     break;
   case AccountOutputFormats::CSV:
-    FCA.exportStatsAsCSV(OS, T.getFileHeader());
+    FCA.exportStatsAsCSV(OS, TS.getFileHeader());
     break;
   }
 
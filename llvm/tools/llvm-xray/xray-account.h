@@ -77,6 +77,10 @@ public:
   ///
   bool accountRecord(const XRayRecord &Record);
 
+  /// Folds the latencies and TSC ranges accounted by |Other| into this
+  /// accountant. This lets us account disjoint sets of threads in parallel.
+  void merge(LatencyAccountant &&Other);
+
   const FunctionStack *getThreadFunctionStack(llvm::sys::procid_t TId) const {
     auto I = PerThreadFunctionStack.find(TId);
     if (I == PerThreadFunctionStack.end())
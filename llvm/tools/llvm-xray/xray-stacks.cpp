@@ -728,29 +728,46 @@ static CommandRegistration Unused(&Stack, []() -> Error {
   // TODO: Someday, support output to files instead of just directly to
   // standard output.
   for (const auto &Filename : StackInputs) {
-    auto TraceOrErr = loadTraceFile(Filename);
-    if (!TraceOrErr) {
+    // We stream the records in one thread at a time, so that we never hold
+    // more than one thread's worth of decoded records in memory.
+    auto StreamOrErr = openTraceStream(Filename);
+    if (!StreamOrErr) {
       if (!StackKeepGoing)
         return joinErrors(
             make_error<StringError>(
                 Twine("Failed loading input file '") + Filename + "'",
                 std::make_error_code(std::errc::invalid_argument)),
-            TraceOrErr.takeError());
-      logAllUnhandledErrors(TraceOrErr.takeError(), errs());
+            StreamOrErr.takeError());
+      logAllUnhandledErrors(StreamOrErr.takeError(), errs());
       continue;
     }
-    auto &T = *TraceOrErr;
+    auto &TS = **StreamOrErr;
     StackTrie::AccountRecordState AccountRecordState =
         StackTrie::AccountRecordState::CreateInitialState();
-    for (const auto &Record : T) {
+    bool AccountingFailed = false;
+    auto E = TS.forEachRecord([&](const XRayRecord &Record) -> Error {
       auto error = ST.accountRecord(Record, &AccountRecordState);
       if (error != StackTrie::AccountRecordStatus::OK) {
-        if (!StackKeepGoing)
+        if (!StackKeepGoing) {
+          AccountingFailed = true;
           return make_error<StringError>(
               CreateErrorMessage(error, Record, FuncIdHelper),
               make_error_code(errc::illegal_byte_sequence));
+        }
         errs() << CreateErrorMessage(error, Record, FuncIdHelper);
       }
+      return Error::success();
+    });
+    if (E) {
+      if (AccountingFailed)
+        return E;
+      if (!StackKeepGoing)
+        return joinErrors(
+            make_error<StringError>(
+                Twine("Failed loading input file '") + Filename + "'",
+                std::make_error_code(std::errc::invalid_argument)),
+            std::move(E));
+      logAllUnhandledErrors(std::move(E), errs());
     }
   }
   if (ST.isEmpty()) {
@@ -0,0 +1,183 @@
+//===- llvm/unittest/ADT/FlatDenseMapTest.cpp - FlatDenseMap unit tests ---===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/FlatDenseMap.h"
+#include "gtest/gtest.h"
+#include <map>
+#include <memory>
+#include <string>
+
+using namespace llvm;
+
+namespace {
+
+TEST(FlatDenseMapTest, EmptyMap) {
+  FlatDenseMap<int, int> M;
+  EXPECT_TRUE(M.empty());
+  EXPECT_EQ(0u, M.size());
+  EXPECT_EQ(0u, M.count(1));
+  EXPECT_TRUE(M.find(1) == M.end());
+  EXPECT_TRUE(M.begin() == M.end());
+  EXPECT_EQ(0, M.lookup(1));
+  EXPECT_FALSE(M.erase(1));
+  EXPECT_EQ(0u, M.getMemorySize());
+}
+
+TEST(FlatDenseMapTest, InsertFindErase) {
+  FlatDenseMap<int, int> M;
+  EXPECT_TRUE(M.insert({1, 10}).second);
+  EXPECT_FALSE(M.insert({1, 20}).second);
+  EXPECT_EQ(1u, M.size());
+  EXPECT_EQ(10, M.lookup(1));
+  EXPECT_EQ(10, M.find(1)->second);
+
+  M[2] = 30;
+  EXPECT_EQ(2u, M.size());
+  EXPECT_EQ(30, M[2]);
+
+  auto R = M.try_emplace(3, 40);
+  EXPECT_TRUE(R.second);
+  EXPECT_EQ(3, R.first->first);
+  EXPECT_EQ(40, R.first->second);
+
+  EXPECT_TRUE(M.erase(1));
+  EXPECT_FALSE(M.erase(1));
+  EXPECT_EQ(0u, M.count(1));
+  M.erase(M.find(2));
+  EXPECT_EQ(1u, M.size());
+  EXPECT_EQ(1u, M.count(3));
+}
+
+// Grow through several rehashes while interleaving erasures, and compare
+// against std::map throughout.
+TEST(FlatDenseMapTest, MatchesStdMap) {
+  FlatDenseMap<int *, unsigned> M;
+  std::map<int *, unsigned> Expected;
+  std::unique_ptr<int[]> Storage(new int[4096]);
+  uint64_t X = 1;
+  for (unsigned I = 0; I < 20000; ++I) {
+    X = X * 6364136223846793005ULL + 1442695040888963407ULL;
+    int *Key = &Storage[(X >> 33) % 4096];
+    if ((X >> 62) == 0) {
+      EXPECT_EQ(Expected.erase(Key) != 0, M.erase(Key));
+    } else {
+      M[Key] = I;
+      Expected[Key] = I;
+    }
+    ASSERT_EQ(Expected.size(), M.size());
+  }
+  for (const auto &KV : Expected)
+    EXPECT_EQ(KV.second, M.lookup(KV.first));
+  unsigned NumVisited = 0;
+  for (const auto &KV : M) {
+    EXPECT_EQ(Expected[KV.first], KV.second);
+    ++NumVisited;
+  }
+  EXPECT_EQ(Expected.size(), NumVisited);
+}
+
+struct CollidingInfo {
+  static unsigned getHashValue(unsigned) { return 42; }
+  static bool isEqual(unsigned LHS, unsigned RHS) { return LHS == RHS; }
+};
+
+// Every key has the same hash, so every lookup has to probe past full groups.
+TEST(FlatDenseMapTest, CollidingHashes) {
+  FlatDenseMap<unsigned, unsigned, CollidingInfo> M;
+  for (unsigned I = 0; I < 100; ++I)
+    M[I] = I * 2;
+  for (unsigned I = 0; I < 100; I += 2)
+    EXPECT_TRUE(M.erase(I));
+  for (unsigned I = 0; I < 100; ++I)
+    EXPECT_EQ(I % 2, M.count(I));
+  for (unsigned I = 100; I < 150; ++I)
+    M[I] = I * 2;
+  EXPECT_EQ(100u, M.size());
+  for (unsigned I = 0; I < 150; ++I) {
+    bool Present = I >= 100 || I % 2;
+    EXPECT_EQ(Present, M.count(I) == 1);
+    EXPECT_EQ(Present ? I * 2 : 0, M.lookup(I));
+  }
+}
+
+// Erasing and reinserting keeps the table from growing without bound.
+TEST(FlatDenseMapTest, ChurnDoesNotGrow) {
+  FlatDenseMap<unsigned, unsigned> M;
+  for (unsigned I = 0; I < 64; ++I)
+    M[I] = I;
+  size_t Size = M.getMemorySize();
+  for (unsigned I = 64; I < 100000; ++I) {
+    M.erase(I - 64);
+    M[I] = I;
+  }
+  EXPECT_EQ(64u, M.size());
+  EXPECT_EQ(Size, M.getMemorySize());
+}
+
+TEST(FlatDenseMapTest, Reserve) {
+  FlatDenseMap<unsigned, unsigned> M;
+  M.reserve(1000);
+  size_t Size = M.getMemorySize();
+  for (unsigned I = 0; I < 1000; ++I)
+    M[I] = I;
+  EXPECT_EQ(Size, M.getMemorySize());
+}
+
+TEST(FlatDenseMapTest, CopyAndMove) {
+  FlatDenseMap<unsigned, std::string> M;
+  for (unsigned I = 0; I < 100; ++I)
+    M[I] = std::to_string(I);
+
+  FlatDenseMap<unsigned, std::string> Copy(M);
+  EXPECT_EQ(100u, Copy.size());
+  EXPECT_EQ("42", Copy.lookup(42));
+
+  FlatDenseMap<unsigned, std::string> Moved(std::move(Copy));
+  EXPECT_EQ(100u, Moved.size());
+  EXPECT_TRUE(Copy.empty());
+
+  Copy = Moved;
+  EXPECT_EQ(100u, Copy.size());
+  Moved = std::move(Copy);
+  EXPECT_EQ("99", Moved.lookup(99));
+
+  Moved.clear();
+  EXPECT_TRUE(Moved.empty());
+  EXPECT_TRUE(Moved.begin() == Moved.end());
+  EXPECT_EQ(0u, Moved.count(42));
+}
+
+// Values are constructed and destroyed exactly once.
+TEST(FlatDenseMapTest, ValueLifetime) {
+  auto Shared = std::make_shared<int>(0);
+  {
+    FlatDenseMap<unsigned, std::shared_ptr<int>> M;
+    for (unsigned I = 0; I < 1000; ++I)
+      M[I] = Shared;
+    for (unsigned I = 0; I < 1000; I += 3)
+      M.erase(I);
+    EXPECT_EQ(long(M.size() + 1), Shared.use_count());
+    FlatDenseMap<unsigned, std::shared_ptr<int>> Copy(M);
+    EXPECT_EQ(long(2 * M.size() + 1), Shared.use_count());
+  }
+  EXPECT_EQ(1, Shared.use_count());
+}
+
+TEST(FlatDenseMapTest, ConstIterator) {
+  FlatDenseMap<int, int> M = {{1, 2}, {3, 4}};
+  const FlatDenseMap<int, int> &CM = M;
+  FlatDenseMap<int, int>::const_iterator I = M.find(1);
+  EXPECT_TRUE(I == CM.find(1));
+  EXPECT_EQ(2, I->second);
+  int Sum = 0;
+  for (const auto &KV : CM)
+    Sum += KV.first + KV.second;
+  EXPECT_EQ(10, Sum);
+}
+
+} // namespace
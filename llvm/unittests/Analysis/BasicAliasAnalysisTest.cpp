@@ -129,3 +129,39 @@ TEST_F(BasicAATest, AliasInstWithFullObjectOfImpreciseSize) {
                 AAQI),
             AliasResult::MayAlias);
 }
+
+// Check that a GEP decomposed for one query of a batch gives the same answers
+// when the decomposition is reused by the following queries.
+TEST_F(BasicAATest, BatchReusesDecomposedGEPs) {
+  F = Function::Create(
+      FunctionType::get(B.getVoidTy(), {B.getInt64Ty()}, false),
+      GlobalValue::ExternalLinkage, "F", &M);
+
+  BasicBlock *Entry(BasicBlock::Create(C, "", F));
+  B.SetInsertPoint(Entry);
+
+  Value *Index = F->arg_begin();
+  AllocaInst *Array = B.CreateAlloca(B.getInt32Ty(), B.getInt32(8));
+  Value *AtIndex = B.CreateGEP(B.getInt32Ty(), Array, Index);
+  Value *AfterIndex = B.CreateGEP(B.getInt32Ty(), AtIndex, B.getInt64(1));
+  Value *AtZero = B.CreateGEP(B.getInt32Ty(), Array, B.getInt64(0));
+
+  auto &AllAnalyses = setupAnalyses();
+  BasicAAResult &BasicAA = AllAnalyses.BAA;
+  AAQueryInfo &BatchAAQI = AllAnalyses.AAQI;
+  BatchAAQI.CacheDecomposedGEPs = true;
+  auto Loc = [](Value *Ptr) {
+    return MemoryLocation(Ptr, LocationSize::precise(4));
+  };
+
+  // The second query reuses the decomposition of AtIndex.
+  ASSERT_EQ(BasicAA.alias(Loc(AtIndex), Loc(AfterIndex), BatchAAQI),
+            AliasResult::NoAlias);
+  ASSERT_TRUE(BatchAAQI.DecomposedGEPs);
+  AAQueryInfo AAQI;
+  ASSERT_EQ(BasicAA.alias(Loc(AtIndex), Loc(AtZero), BatchAAQI),
+            BasicAA.alias(Loc(AtIndex), Loc(AtZero), AAQI));
+  ASSERT_EQ(BasicAA.alias(Loc(AfterIndex), Loc(AtZero), BatchAAQI),
+            BasicAA.alias(Loc(AfterIndex), Loc(AtZero), AAQI));
+  ASSERT_FALSE(AAQI.DecomposedGEPs);
+}
@@ -11,6 +11,7 @@
 #include "llvm/AsmParser/Parser.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
@@ -190,4 +191,65 @@ TEST(BitReaderTest, MaterializeFunctionsForBlockAddrInFunctionAfter) {
   EXPECT_FALSE(verifyModule(*M, &dbgs()));
 }
 
+// Tests that the lists of the compile unit that are never imported are not
+// loaded when lazy-loading metadata for ThinLTO importing.
+TEST(BitReaderTest, LazyLoadMetadataForImportSkipsCompileUnitLists) {
+  // Retain enough types for the writer to emit a metadata index, which
+  // enables lazy-loading.
+  std::string Assembly = "define void @f() !dbg !3 {\n"
+                         "  ret void\n"
+                         "}\n"
+                         "!llvm.dbg.cu = !{!0}\n"
+                         "!llvm.module.flags = !{!2}\n"
+                         "!0 = distinct !DICompileUnit(language: DW_LANG_C99, "
+                         "file: !1, emissionKind: FullDebug, "
+                         "retainedTypes: !4)\n"
+                         "!1 = !DIFile(filename: \"t.c\", directory: \"/\")\n"
+                         "!2 = !{i32 2, !\"Debug Info Version\", i32 3}\n"
+                         "!3 = distinct !DISubprogram(name: \"f\", scope: !1, "
+                         "file: !1, unit: !0, spFlags: DISPFlagDefinition)\n";
+  const unsigned NumTypes = 32;
+  std::string Types;
+  Assembly += "!4 = !{";
+  for (unsigned I = 0; I < NumTypes; ++I) {
+    Assembly += (I ? ", !" : "!") + std::to_string(5 + I);
+    Types += "!" + std::to_string(5 + I) + " = !DIBasicType(name: \"t" +
+             std::to_string(I) + "\", size: 32, encoding: DW_ATE_signed)\n";
+  }
+  Assembly += "}\n" + Types;
+
+  SmallString<1024> Mem;
+  {
+    LLVMContext Context;
+    writeModuleToBuffer(parseAssembly(Context, Assembly.c_str()), Mem);
+  }
+
+  auto getCompileUnit = [](Module &M) {
+    return cast<DICompileUnit>(
+        M.getNamedMetadata("llvm.dbg.cu")->getOperand(0));
+  };
+
+  for (bool IsImporting : {false, true}) {
+    LLVMContext Context;
+    Expected<std::unique_ptr<Module>> ModuleOrErr =
+        getLazyBitcodeModule(MemoryBufferRef(Mem.str(), "test"), Context,
+                             /*ShouldLazyLoadMetadata=*/true, IsImporting);
+    ASSERT_TRUE(!!ModuleOrErr);
+    Module &M = **ModuleOrErr;
+    ASSERT_FALSE(M.materializeMetadata());
+
+    DICompileUnit *CU = getCompileUnit(M);
+    if (IsImporting)
+      EXPECT_EQ(nullptr, CU->getRawRetainedTypes());
+    else
+      EXPECT_EQ(NumTypes, CU->getRetainedTypes().size());
+
+    // Function-level debug info is still loaded on demand.
+    Function *F = M.getFunction("f");
+    ASSERT_FALSE(F->materialize());
+    ASSERT_NE(nullptr, F->getSubprogram());
+    EXPECT_EQ(CU, F->getSubprogram()->getUnit());
+  }
+}
+
 } // end namespace
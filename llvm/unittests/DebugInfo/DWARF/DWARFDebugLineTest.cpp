@@ -281,6 +281,19 @@ TEST_P(DebugLineParameterisedFixture, GetOrParseLineTableValidTable) {
   EXPECT_FALSE(Recoverable);
   EXPECT_EQ(Expected2, *ExpectedLineTable4);
 
+  // Check that clearing a table only drops that one, and that it is parsed
+  // again when it is requested the next time.
+  Line.clearLineTable(0);
+  EXPECT_EQ(Line.getLineTable(0), nullptr);
+  EXPECT_EQ(Line.getLineTable(SecondOffset), Expected2);
+  Recoverable = Error::success();
+  auto ExpectedLineTable5 = Line.getOrParseLineTable(
+      LineData, 0, *Context, nullptr, RecordRecoverable);
+  ASSERT_TRUE(ExpectedLineTable5.operator bool());
+  EXPECT_FALSE(Recoverable);
+  checkDefaultPrologue(Version, Format, (*ExpectedLineTable5)->Prologue, 16);
+  EXPECT_EQ((*ExpectedLineTable5)->Sequences.size(), 1u);
+
   // TODO: Add tests that show that the body of the programs have been read
   // correctly.
 }
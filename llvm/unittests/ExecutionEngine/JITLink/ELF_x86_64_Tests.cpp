@@ -0,0 +1,258 @@
+//===----------- ELF_x86_64.cpp - Tests for JITLink ELF/x86-64 ------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "JITLinkTestCommon.h"
+
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ExecutionEngine/JITLink/ELF_x86_64.h"
+#include "llvm/Testing/Support/Error.h"
+
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::jitlink;
+using namespace llvm::jitlink::ELF_x86_64_Edges;
+
+namespace {
+
+class JITLinkTest_ELF_x86_64 : public JITLinkTestCommon,
+                               public testing::Test {
+public:
+  using BasicVerifyGraphFunction =
+      std::function<void(AtomGraph &, const MCDisassembler &)>;
+
+  void runBasicVerifyGraphTest(StringRef AsmSrc, StringRef Triple,
+                               StringMap<JITEvaluatedSymbol> Externals,
+                               bool PIC, bool LargeCodeModel,
+                               MCTargetOptions Options,
+                               BasicVerifyGraphFunction RunGraphTest) {
+    auto TR = getTestResources(AsmSrc, Triple, PIC, LargeCodeModel,
+                               std::move(Options));
+    if (!TR) {
+      dbgs() << "Skipping JITLInk unit test: " << toString(TR.takeError())
+             << "\n";
+      return;
+    }
+
+    auto JTCtx = llvm::make_unique<TestJITLinkContext>(
+        **TR, [&](AtomGraph &G) { RunGraphTest(G, (*TR)->getDisassembler()); });
+
+    JTCtx->externals() = std::move(Externals);
+
+    jitLink_ELF_x86_64(std::move(JTCtx));
+  }
+
+protected:
+  // Atoms within an ELF section are chained together by layout and keep-alive
+  // edges, so only count the relocations.
+  static size_t relocationCount(DefinedAtom &A) {
+    return countEdgesMatching(A,
+                              [](const Edge &E) { return E.isRelocation(); });
+  }
+
+  static Edge &relocation(DefinedAtom &A) {
+    return *std::find_if(A.edges().begin(), A.edges().end(),
+                         [](const Edge &E) { return E.isRelocation(); });
+  }
+
+  static void verifyIsPointerTo(AtomGraph &G, DefinedAtom &A, Atom &Target) {
+    EXPECT_EQ(A.edges_size(), 1U) << "Incorrect number of edges for pointer";
+    if (A.edges_size() != 1U)
+      return;
+    auto &E = *A.edges().begin();
+    EXPECT_EQ(E.getKind(), Pointer64)
+        << "Expected pointer to have a pointer64 relocation";
+    EXPECT_EQ(&E.getTarget(), &Target) << "Expected edge to point at target";
+    EXPECT_THAT_EXPECTED(readInt<uint64_t>(G, A), HasValue(Target.getAddress()))
+        << "Pointer does not point to target";
+  }
+
+  static void verifyGOTLoad(AtomGraph &G, DefinedAtom &A, Edge &E,
+                            Atom &Target) {
+    EXPECT_EQ(E.getAddend(), 0U) << "Expected GOT load to have a zero addend";
+    EXPECT_TRUE(E.getTarget().isDefined())
+        << "GOT entry should be a defined atom";
+    if (!E.getTarget().isDefined())
+      return;
+
+    verifyIsPointerTo(G, static_cast<DefinedAtom &>(E.getTarget()), Target);
+  }
+
+  static void verifyCall(const MCDisassembler &Dis, AtomGraph &G,
+                         DefinedAtom &Caller, Edge &E, Atom &Callee) {
+    EXPECT_EQ(E.getKind(), Branch32) << "Edge is not a Branch32";
+    EXPECT_EQ(E.getAddend(), 0U) << "Expected no addend on stub call";
+    EXPECT_EQ(&E.getTarget(), &Callee)
+        << "Edge does not point at expected callee";
+
+    JITTargetAddress FixupAddress = Caller.getAddress() + E.getOffset();
+    uint64_t PCRelDelta = Callee.getAddress() - (FixupAddress + 4);
+
+    EXPECT_THAT_EXPECTED(
+        decodeImmediateOperand(Dis, Caller, 0, E.getOffset() - 1),
+        HasValue(PCRelDelta));
+  }
+
+  static void verifyIndirectCall(const MCDisassembler &Dis, AtomGraph &G,
+                                 DefinedAtom &Caller, Edge &E, Atom &Callee) {
+    EXPECT_EQ(E.getKind(), PCRel32) << "Edge is not a PCRel32";
+    EXPECT_EQ(E.getAddend(), 0) << "Expected no addend on stub cal";
+    EXPECT_TRUE(E.getTarget().isDefined()) << "Target is not a defined atom";
+    if (!E.getTarget().isDefined())
+      return;
+    verifyIsPointerTo(G, static_cast<DefinedAtom &>(E.getTarget()), Callee);
+
+    JITTargetAddress FixupAddress = Caller.getAddress() + E.getOffset();
+    uint64_t PCRelDelta = E.getTarget().getAddress() - (FixupAddress + 4);
+
+    EXPECT_THAT_EXPECTED(
+        decodeImmediateOperand(Dis, Caller, 3, E.getOffset() - 2),
+        HasValue(PCRelDelta));
+  }
+
+  static void verifyCallViaStub(const MCDisassembler &Dis, AtomGraph &G,
+                                DefinedAtom &Caller, Edge &E, Atom &Callee) {
+    verifyCall(Dis, G, Caller, E, E.getTarget());
+
+    if (!E.getTarget().isDefined()) {
+      ADD_FAILURE() << "Edge target is not a stub";
+      return;
+    }
+
+    auto &StubAtom = static_cast<DefinedAtom &>(E.getTarget());
+    EXPECT_EQ(StubAtom.edges_size(), 1U)
+        << "Expected one edge from stub to target";
+
+    auto &StubEdge = *StubAtom.edges().begin();
+
+    verifyIndirectCall(Dis, G, static_cast<DefinedAtom &>(StubAtom), StubEdge,
+                       Callee);
+  }
+};
+
+} // end anonymous namespace
+
+TEST_F(JITLinkTest_ELF_x86_64, BasicRelocations) {
+  runBasicVerifyGraphTest(
+      R"(
+            .text
+            .globl  bar
+            .p2align        4, 0x90
+            .type   bar,@function
+    bar:
+            callq   baz@PLT
+
+            .globl  foo
+            .p2align        4, 0x90
+            .type   foo,@function
+    foo:
+            callq   bar@PLT
+    foo.1:
+            movq    y@GOTPCREL(%rip), %rcx
+    foo.2:
+            movq    p(%rip), %rdx
+    foo.3:
+            callq   local_fn
+            retq
+
+            .p2align        4, 0x90
+            .type   local_fn,@function
+    local_fn:
+            retq
+
+            .data
+            .globl  x
+            .p2align        2
+    x:
+            .long   42
+
+            .globl  p
+            .p2align        3
+    p:
+            .quad   x)",
+      "x86_64-unknown-linux",
+      {{"y", JITEvaluatedSymbol(0xdeadbeef, JITSymbolFlags::Exported)},
+       {"baz", JITEvaluatedSymbol(0xcafef00d, JITSymbolFlags::Exported)}},
+      true, false, MCTargetOptions(),
+      [](AtomGraph &G, const MCDisassembler &Dis) {
+        // Name the atoms in the asm above.
+        auto &Baz = atom(G, "baz");
+        auto &Y = atom(G, "y");
+
+        auto &Bar = definedAtom(G, "bar");
+        auto &Foo = definedAtom(G, "foo");
+        auto &Foo_1 = definedAtom(G, "foo.1");
+        auto &Foo_2 = definedAtom(G, "foo.2");
+        auto &Foo_3 = definedAtom(G, "foo.3");
+        auto &LocalFn = definedAtom(G, "local_fn");
+        auto &X = definedAtom(G, "x");
+        auto &P = definedAtom(G, "p");
+
+        // Check R_X86_64_64 reloc for p
+        {
+          EXPECT_EQ(relocationCount(P), 1U)
+              << "Unexpected number of relocations";
+          EXPECT_EQ(relocation(P).getKind(), Pointer64)
+              << "Unexpected edge kind for p";
+          EXPECT_THAT_EXPECTED(readInt<uint64_t>(G, P),
+                               HasValue(X.getAddress()))
+              << "Pointer64 relocation did not apply correctly";
+        }
+
+        // Check that bar is a call-via-stub to baz.
+        {
+          EXPECT_EQ(relocationCount(Bar), 1U)
+              << "Incorrect number of edges for bar";
+          EXPECT_EQ(relocation(Bar).getKind(), Branch32)
+              << "Unexpected edge kind for bar";
+          verifyCallViaStub(Dis, G, Bar, relocation(Bar), Baz);
+        }
+
+        // Check that foo is a direct call to bar.
+        {
+          EXPECT_EQ(relocationCount(Foo), 1U)
+              << "Incorrect number of edges for foo";
+          EXPECT_EQ(relocation(Foo).getKind(), Branch32);
+          verifyCall(Dis, G, Foo, relocation(Foo), Bar);
+        }
+
+        // Check GOT load in foo.1
+        {
+          EXPECT_EQ(relocationCount(Foo_1), 1U)
+              << "Incorrect number of edges for foo.1";
+          EXPECT_EQ(relocation(Foo_1).getKind(), PCRel32);
+          verifyGOTLoad(G, Foo_1, relocation(Foo_1), Y);
+        }
+
+        // Check PCRel ref to p in foo.2
+        {
+          EXPECT_EQ(relocationCount(Foo_2), 1U)
+              << "Incorrect number of edges for foo.2";
+          EXPECT_EQ(relocation(Foo_2).getKind(), PCRel32);
+
+          JITTargetAddress FixupAddress =
+              Foo_2.getAddress() + relocation(Foo_2).getOffset();
+          uint64_t PCRelDelta = P.getAddress() - (FixupAddress + 4);
+
+          EXPECT_THAT_EXPECTED(decodeImmediateOperand(Dis, Foo_2, 4, 0),
+                               HasValue(PCRelDelta))
+              << "PCRel load does not reference expected target";
+        }
+
+        // Check that the assembler-resolved call to local_fn in foo.3 still
+        // reaches it, i.e. that the layout of .text was preserved.
+        {
+          EXPECT_EQ(relocationCount(Foo_3), 0U)
+              << "Unexpected relocation for a local call";
+          uint64_t PCRelDelta = LocalFn.getAddress() - (Foo_3.getAddress() + 5);
+          EXPECT_THAT_EXPECTED(decodeImmediateOperand(Dis, Foo_3, 0, 0),
+                               HasValue(PCRelDelta))
+              << "Local call does not reference expected target";
+        }
+      });
+}
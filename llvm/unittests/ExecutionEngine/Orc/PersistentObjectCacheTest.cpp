@@ -0,0 +1,118 @@
+//===- PersistentObjectCacheTest.cpp - Tests for PersistentObjectCache ----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+#include "OrcTestCommon.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/Support/FileSystem.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+class PersistentObjectCacheTest : public testing::Test {
+protected:
+  void SetUp() override {
+    OrcNativeTarget::initialize();
+    auto JTMBOrErr = JITTargetMachineBuilder::detectHost();
+    if (!JTMBOrErr) {
+      consumeError(JTMBOrErr.takeError());
+      return;
+    }
+    // Bail out if the host target isn't built.
+    if (auto TM = JTMBOrErr->createTargetMachine())
+      JTMB.emplace(std::move(*JTMBOrErr));
+    else
+      consumeError(TM.takeError());
+
+    ASSERT_FALSE(sys::fs::createUniqueDirectory("orc-cache-test", CacheDir));
+  }
+
+  void TearDown() override {
+    if (!CacheDir.empty())
+      sys::fs::remove_directories(CacheDir);
+  }
+
+  std::unique_ptr<Module> createModule(StringRef FnName) {
+    auto M = llvm::make_unique<Module>("test", Context);
+    auto *F = Function::Create(
+        FunctionType::get(Type::getInt32Ty(Context), false),
+        GlobalValue::ExternalLinkage, FnName, M.get());
+    IRBuilder<> B(BasicBlock::Create(Context, "entry", F));
+    B.CreateRet(B.getInt32(42));
+    return M;
+  }
+
+  std::unique_ptr<PersistentObjectCache>
+  createCache(JITTargetMachineBuilder B) {
+    return cantFail(PersistentObjectCache::Create(CacheDir, std::move(B)));
+  }
+
+  LLVMContext Context;
+  Optional<JITTargetMachineBuilder> JTMB;
+  SmallString<128> CacheDir;
+};
+
+TEST_F(PersistentObjectCacheTest, HitsAcrossInstances) {
+  if (!JTMB)
+    return;
+
+  auto M = createModule("foo");
+  StringRef Obj = "fake object";
+  {
+    auto Cache = createCache(*JTMB);
+    EXPECT_EQ(Cache->getObject(M.get()), nullptr) << "Cache should be empty";
+    Cache->notifyObjectCompiled(M.get(), MemoryBufferRef(Obj, "foo"));
+    EXPECT_EQ(Cache->getNumStores(), 1U);
+  }
+
+  // A new cache for the same directory, as in a later run of the JIT.
+  auto Cache = createCache(*JTMB);
+  auto Cached = Cache->getObject(M.get());
+  ASSERT_NE(Cached, nullptr) << "Object should be found in the new instance";
+  EXPECT_EQ(Cached->getBuffer(), Obj);
+  EXPECT_EQ(Cache->getNumHits(), 1U);
+
+  auto Other = createModule("bar");
+  EXPECT_EQ(Cache->getObject(Other.get()), nullptr)
+      << "A different module should miss";
+}
+
+TEST_F(PersistentObjectCacheTest, KeyedOnTarget) {
+  if (!JTMB)
+    return;
+
+  auto M = createModule("foo");
+  StringRef Obj = "fake object";
+  {
+    auto Cache = createCache(*JTMB);
+    EXPECT_EQ(Cache->getObject(M.get()), nullptr);
+    Cache->notifyObjectCompiled(M.get(), MemoryBufferRef(Obj, "foo"));
+  }
+
+  auto OptJTMB = *JTMB;
+  OptJTMB.setCodeGenOptLevel(CodeGenOpt::Aggressive);
+  auto Cache = createCache(std::move(OptJTMB));
+  EXPECT_EQ(Cache->getObject(M.get()), nullptr)
+      << "Objects compiled for a different configuration should miss";
+}
+
+TEST_F(PersistentObjectCacheTest, IgnoresUnrequestedObjects) {
+  if (!JTMB)
+    return;
+
+  // notifyObjectCompiled without a preceding miss has no key to store under.
+  auto M = createModule("foo");
+  auto Cache = createCache(*JTMB);
+  Cache->notifyObjectCompiled(M.get(), MemoryBufferRef("fake object", "foo"));
+  EXPECT_EQ(Cache->getNumStores(), 0U);
+  EXPECT_EQ(Cache->getObject(M.get()), nullptr);
+}
+
+} // namespace
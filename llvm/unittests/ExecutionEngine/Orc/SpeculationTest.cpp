@@ -0,0 +1,133 @@
+#include "OrcTestCommon.h"
+#include "llvm/ExecutionEngine/Orc/Speculation.h"
+#include "llvm/IR/IRBuilder.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+class SpeculationTest : public CoreAPIsBasedStandardTest {
+protected:
+  // Defines Name in JD. If Hold is null the symbol is emitted as soon as it
+  // is materialized, otherwise its responsibility is stored there.
+  void define(const SymbolStringPtr &Name, JITEvaluatedSymbol Sym,
+              std::vector<SymbolStringPtr> &Order,
+              std::shared_ptr<MaterializationResponsibility> *Hold = nullptr) {
+    cantFail(JD.define(llvm::make_unique<SimpleMaterializationUnit>(
+        SymbolFlagsMap({{Name, Sym.getFlags()}}),
+        [Name, Sym, &Order, Hold](MaterializationResponsibility R) {
+          Order.push_back(Name);
+          if (Hold) {
+            *Hold = std::make_shared<MaterializationResponsibility>(
+                std::move(R));
+            return;
+          }
+          R.resolve({{Name, Sym}});
+          R.emit();
+        })));
+  }
+};
+
+TEST_F(SpeculationTest, LooksUpCandidatesByPriority) {
+  std::vector<SymbolStringPtr> Order;
+  define(Bar, BarSym, Order);
+  define(Baz, BazSym, Order);
+  define(Qux, QuxSym, Order);
+
+  Speculator S(ES, 1);
+  Speculator::CandidateMap Candidates;
+  Candidates[Foo] = {{Baz, 1}, {Bar, 10}, {Qux, 5}};
+  S.registerCandidates(JD, std::move(Candidates));
+
+  S.speculateFor(JD, Foo);
+  EXPECT_EQ(Order, std::vector<SymbolStringPtr>({Bar, Qux, Baz}))
+      << "Candidates should be looked up highest priority first";
+
+  // A function only triggers speculation once.
+  S.speculateFor(JD, Foo);
+  EXPECT_EQ(Order.size(), 3U) << "Candidates should be looked up once";
+}
+
+TEST_F(SpeculationTest, DemandCancelsQueuedLookup) {
+  std::vector<SymbolStringPtr> Order;
+  std::shared_ptr<MaterializationResponsibility> BarR;
+  define(Bar, BarSym, Order, &BarR);
+  define(Baz, BazSym, Order);
+
+  Speculator S(ES, 1);
+  Speculator::CandidateMap Candidates;
+  Candidates[Foo] = {{Bar, 2}, {Baz, 1}};
+  S.registerCandidates(JD, std::move(Candidates));
+
+  // Bar is in flight, Baz waits for it.
+  S.speculateFor(JD, Foo);
+  EXPECT_EQ(Order, std::vector<SymbolStringPtr>({Bar}));
+
+  // Baz is requested on demand before its turn: the speculative lookup is
+  // dropped.
+  S.speculateFor(JD, Baz);
+  BarR->resolve({{Bar, BarSym}});
+  BarR->emit();
+  EXPECT_EQ(Order, std::vector<SymbolStringPtr>({Bar}))
+      << "Speculator should not look up symbols requested on demand";
+}
+
+TEST_F(SpeculationTest, CancelPending) {
+  std::vector<SymbolStringPtr> Order;
+  std::shared_ptr<MaterializationResponsibility> BarR;
+  define(Bar, BarSym, Order, &BarR);
+  define(Baz, BazSym, Order);
+
+  Speculator S(ES, 1);
+  Speculator::CandidateMap Candidates;
+  Candidates[Foo] = {{Bar, 2}, {Baz, 1}};
+  S.registerCandidates(JD, std::move(Candidates));
+
+  S.speculateFor(JD, Foo);
+  S.cancelPending();
+  BarR->resolve({{Bar, BarSym}});
+  BarR->emit();
+  EXPECT_EQ(Order, std::vector<SymbolStringPtr>({Bar}))
+      << "Cancelled lookups should not be issued";
+}
+
+TEST_F(SpeculationTest, FindLikelyCallees) {
+  LLVMContext Context;
+  Module M("test", Context);
+  M.setDataLayout("");
+  auto *FTy = FunctionType::get(Type::getVoidTy(Context), false);
+
+  auto Create = [&](GlobalValue::LinkageTypes Linkage, StringRef Name) {
+    return Function::Create(FTy, Linkage, Name, &M);
+  };
+  auto *FooFn = Create(GlobalValue::ExternalLinkage, "foo");
+  auto *BarFn = Create(GlobalValue::ExternalLinkage, "bar");
+  auto *BazFn = Create(GlobalValue::ExternalLinkage, "baz");
+  auto *ColdFn = Create(GlobalValue::ExternalLinkage, "cold");
+  auto *LocalFn = Create(GlobalValue::InternalLinkage, "local");
+  auto *DeclFn = Create(GlobalValue::ExternalLinkage, "decl");
+  for (auto *F : {BarFn, BazFn, ColdFn, LocalFn})
+    ReturnInst::Create(Context, BasicBlock::Create(Context, "entry", F));
+  ColdFn->setEntryCount(0);
+
+  IRBuilder<> B(BasicBlock::Create(Context, "entry", FooFn));
+  B.CreateCall(BarFn);
+  B.CreateCall(BazFn);
+  B.CreateCall(BazFn);
+  B.CreateCall(ColdFn);
+  B.CreateCall(LocalFn);
+  B.CreateCall(DeclFn);
+  B.CreateRetVoid();
+
+  MangleAndInterner Mangle(ES, M.getDataLayout());
+  auto Candidates = Speculator::findLikelyCallees(M, Mangle);
+
+  EXPECT_EQ(Candidates.size(), 1U) << "Only foo calls other functions";
+  auto &FooCandidates = Candidates[Mangle("foo")];
+  ASSERT_EQ(FooCandidates.size(), 2U)
+      << "Cold, local and undefined callees should be skipped";
+  EXPECT_EQ(FooCandidates[0].Name, Mangle("baz"));
+  EXPECT_EQ(FooCandidates[0].Priority, 2U);
+  EXPECT_EQ(FooCandidates[1].Name, Mangle("bar"));
+  EXPECT_EQ(FooCandidates[1].Priority, 1U);
+}
@@ -0,0 +1,72 @@
+//===- llvm/unittest/IR/IRMemoryUsageTest.cpp - IRMemoryUsage tests -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/IR/IRMemoryUsage.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Use.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+using namespace llvm;
+
+namespace {
+
+TEST(IRMemoryUsageTest, CountsModuleObjects) {
+  LLVMContext C;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(
+      "@g = global i32 0\n"
+      "define i32 @f(i1 %c, i32* %p) {\n"
+      "entry:\n"
+      "  %v = load i32, i32* %p\n"
+      "  br i1 %c, label %a, label %b\n"
+      "a:\n"
+      "  br label %b\n"
+      "b:\n"
+      "  %phi = phi i32 [ %v, %entry ], [ 1, %a ]\n"
+      "  ret i32 %phi\n"
+      "}\n",
+      Err, C);
+  ASSERT_TRUE(M);
+
+  IRMemoryUsage Usage(*M);
+  EXPECT_EQ(1u, Usage.lookup("GlobalVariable").Count);
+  EXPECT_EQ(1u, Usage.lookup("Function").Count);
+  EXPECT_EQ(2u, Usage.lookup("Argument").Count);
+  EXPECT_EQ(3u, Usage.lookup("BasicBlock").Count);
+  EXPECT_EQ(1u, Usage.lookup("LoadInst").Count);
+  EXPECT_EQ(2u, Usage.lookup("BranchInst").Count);
+  EXPECT_EQ(1u, Usage.lookup("PHINode").Count);
+  EXPECT_EQ(1u, Usage.lookup("ReturnInst").Count);
+  EXPECT_EQ(5u, Usage.lookup("Instruction without DebugLoc").Count);
+
+  // The PHI's two operands are hung off; everything else, including the
+  // global's initializer, is co-allocated.
+  EXPECT_EQ(2u, Usage.lookup("Use (hung-off)").Count);
+  EXPECT_EQ(7u, Usage.lookup("Use (co-allocated)").Count);
+  EXPECT_EQ(7u * sizeof(Use), Usage.lookup("Use (co-allocated)").Bytes);
+
+  // @g, @f, %c, %p, %entry, %a, %b, %v and %phi.
+  EXPECT_EQ(9u, Usage.lookup("ValueName").Count);
+  EXPECT_EQ(0u, Usage.lookup("StoreInst").Count);
+
+  IRMemoryUsage ModuleOnly(*M, /*IncludeContext=*/false);
+  EXPECT_EQ(0u, ModuleOnly.lookup("Context: ConstantInt").Count);
+  EXPECT_LT(ModuleOnly.getTotalBytes(), Usage.getTotalBytes());
+
+  std::string S;
+  raw_string_ostream OS(S);
+  Usage.print(OS);
+  EXPECT_NE(std::string::npos, OS.str().find("LoadInst"));
+  EXPECT_NE(std::string::npos, OS.str().find("Total"));
+}
+
+} // end anonymous namespace
@@ -8,12 +8,15 @@
 
 #include <gtest/gtest.h>
 #include <llvm/ADT/SmallString.h>
+#include "llvm/AsmParser/Parser.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/PassInstrumentation.h>
 #include <llvm/IR/PassManager.h>
 #include <llvm/IR/PassTimingInfo.h>
+#include "llvm/Passes/StandardInstrumentations.h"
+#include "llvm/Support/SourceMgr.h"
 #include <llvm/Support/raw_ostream.h>
 
 using namespace llvm;
@@ -166,4 +169,96 @@ TEST(TimePassesTest, CustomOut) {
   EXPECT_TRUE(TimePassesStr.str().contains("Pass2"));
 }
 
+static std::unique_ptr<Module> parseReportTestModule(LLVMContext &Context) {
+  SMDiagnostic Err;
+  return parseAssemblyString("define i32 @f(i32 %x) {\n"
+                             "  %y = add i32 %x, 1\n"
+                             "  ret i32 %y\n"
+                             "}\n",
+                             Err, Context);
+}
+
+// Removes the add from @f, so that there is one instruction less.
+static void simplifyReportTestFunction(Function &F) {
+  Instruction &Add = F.getEntryBlock().front();
+  Add.replaceAllUsesWith(&*F.arg_begin());
+  Add.eraseFromParent();
+}
+
+TEST(TimePassesTest, PassReportCSV) {
+  PassInstrumentationCallbacks PIC;
+  PassInstrumentation PI(&PIC);
+
+  LLVMContext Context;
+  std::unique_ptr<Module> M = parseReportTestModule(Context);
+  ASSERT_TRUE(M);
+  Function &F = *M->getFunction("f");
+  MyPass1 Pass1;
+
+  SmallString<0> ReportStr;
+  raw_svector_ostream ReportStream(ReportStr);
+  PassReportInstrumentation Report(
+      true, PassReportInstrumentation::ReportFormat::CSV);
+  Report.setOutStream(ReportStream);
+  Report.registerCallbacks(PIC);
+
+  PI.runBeforePass(Pass1, F);
+  simplifyReportTestFunction(F);
+  PI.runAfterPass(Pass1, F);
+  Report.print();
+
+  StringRef Header, Line;
+  std::tie(Header, Line) = ReportStr.str().split('\n');
+  EXPECT_EQ(Header,
+            "pass,module,ir,wall_time,instrs_before,instrs_after,mem_used");
+  EXPECT_TRUE(Line.contains("MyPass1\",\"<string>\",\"f\","));
+  EXPECT_TRUE(Line.endswith(",2,1,0\n"));
+
+  // Printed records are dropped.
+  ReportStr.clear();
+  Report.print();
+  EXPECT_TRUE(ReportStr.empty());
+}
+
+TEST(TimePassesTest, PassReportJSON) {
+  PassInstrumentationCallbacks PIC;
+  PassInstrumentation PI(&PIC);
+
+  LLVMContext Context;
+  std::unique_ptr<Module> M = parseReportTestModule(Context);
+  ASSERT_TRUE(M);
+  Function &F = *M->getFunction("f");
+  MyPass1 Pass1;
+  MyPass2 Pass2;
+
+  SmallString<0> ReportStr;
+  raw_svector_ostream ReportStream(ReportStr);
+  {
+    PassReportInstrumentation Report(
+        true, PassReportInstrumentation::ReportFormat::JSON);
+    Report.setOutStream(ReportStream);
+    Report.registerCallbacks(PIC);
+
+    // A module pass that runs a function pass and then invalidates the
+    // module. The report is written by the destructor.
+    PI.runBeforePass(Pass1, *M);
+    PI.runBeforePass(Pass2, F);
+    simplifyReportTestFunction(F);
+    PI.runAfterPass(Pass2, F);
+    PI.runAfterPassInvalidated<Module>(Pass1);
+  }
+
+  SmallVector<StringRef, 3> Lines;
+  ReportStr.str().split(Lines, '\n', -1, /*KeepEmpty=*/false);
+  ASSERT_EQ(Lines.size(), 2u);
+  // The runs are reported in the order they finished.
+  EXPECT_TRUE(Lines[0].contains("MyPass2"));
+  EXPECT_TRUE(Lines[0].contains("\"ir\":\"f\""));
+  EXPECT_TRUE(Lines[0].contains("\"instrs_before\":2"));
+  EXPECT_TRUE(Lines[0].contains("\"instrs_after\":1"));
+  EXPECT_TRUE(Lines[1].contains("MyPass1"));
+  EXPECT_TRUE(Lines[1].contains("\"ir\":\"\""));
+  EXPECT_TRUE(Lines[1].contains("\"instrs_after\":null"));
+}
+
 } // end anonymous namespace
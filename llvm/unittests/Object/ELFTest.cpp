@@ -0,0 +1,124 @@
+//===- ELFTest.cpp - Tests for ELF.h --------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Object/ELF.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gtest/gtest.h"
+#include <cstring>
+
+using namespace llvm;
+using namespace llvm::object;
+
+namespace {
+
+using Elf_Ehdr = ELF64LE::Ehdr;
+using Elf_Shdr = ELF64LE::Shdr;
+using Elf_Sym = ELF64LE::Sym;
+using Elf_Word = ELF64LE::Word;
+
+// An object file with a symbol table of three symbols, the last of which has
+// its section index in a SHT_SYMTAB_SHNDX section. The ELFFile is created on
+// the object itself, so its section headers can be passed to it directly.
+struct TestObject {
+  Elf_Ehdr Ehdr;
+  char StrTab[16];
+  Elf_Sym Syms[3];
+  Elf_Word Shndx[4];
+  Elf_Shdr Shdrs[4];
+
+  TestObject() {
+    std::memset(this, 0, sizeof(*this));
+    std::memcpy(Ehdr.e_ident, ELF::ElfMagic, strlen(ELF::ElfMagic));
+    Ehdr.e_ident[ELF::EI_CLASS] = ELF::ELFCLASS64;
+    Ehdr.e_ident[ELF::EI_DATA] = ELF::ELFDATA2LSB;
+    Ehdr.e_ident[ELF::EI_VERSION] = ELF::EV_CURRENT;
+    Ehdr.e_type = ELF::ET_REL;
+    Ehdr.e_machine = ELF::EM_X86_64;
+    Ehdr.e_version = ELF::EV_CURRENT;
+    Ehdr.e_ehsize = sizeof(Elf_Ehdr);
+    Ehdr.e_shoff = offsetof(TestObject, Shdrs);
+    Ehdr.e_shentsize = sizeof(Elf_Shdr);
+    Ehdr.e_shnum = 4;
+
+    std::memcpy(StrTab, "\0foo\0bar", 9);
+
+    Syms[1].st_name = 1;
+    Syms[1].setBindingAndType(ELF::STB_GLOBAL, ELF::STT_FUNC);
+    Syms[1].st_shndx = 1;
+    Syms[1].st_value = 0x1000;
+    Syms[1].st_size = 16;
+    Syms[2].st_name = 5;
+    Syms[2].setBindingAndType(ELF::STB_LOCAL, ELF::STT_OBJECT);
+    Syms[2].setVisibility(ELF::STV_HIDDEN);
+    Syms[2].st_shndx = ELF::SHN_XINDEX;
+    Syms[2].st_value = 0x2000;
+    Syms[2].st_size = 8;
+    Shndx[2] = 70000;
+
+    Shdrs[1].sh_type = ELF::SHT_STRTAB;
+    Shdrs[1].sh_offset = offsetof(TestObject, StrTab);
+    Shdrs[1].sh_size = 9;
+    Shdrs[2].sh_type = ELF::SHT_SYMTAB;
+    Shdrs[2].sh_offset = offsetof(TestObject, Syms);
+    Shdrs[2].sh_size = sizeof(Syms);
+    Shdrs[2].sh_entsize = sizeof(Elf_Sym);
+    Shdrs[2].sh_link = 1;
+    Shdrs[3].sh_type = ELF::SHT_SYMTAB_SHNDX;
+    Shdrs[3].sh_offset = offsetof(TestObject, Shndx);
+    Shdrs[3].sh_size = 3 * sizeof(Elf_Word);
+    Shdrs[3].sh_entsize = sizeof(Elf_Word);
+    Shdrs[3].sh_link = 2;
+  }
+
+  StringRef data() const {
+    return StringRef(reinterpret_cast<const char *>(this), sizeof(*this));
+  }
+};
+
+TEST(ELFTest, DecodeSymbols) {
+  TestObject Obj;
+  Expected<ELF64LEFile> File = ELF64LEFile::create(Obj.data());
+  ASSERT_THAT_EXPECTED(File, Succeeded());
+
+  Expected<ELFSymbolArray> Syms = File->decodeSymbols(Obj.Shdrs[2]);
+  ASSERT_THAT_EXPECTED(Syms, Succeeded());
+  ASSERT_EQ(3u, Syms->size());
+
+  EXPECT_EQ("", Syms->getName(0));
+  EXPECT_EQ(0u, Syms->SectionIndexes[0]);
+
+  EXPECT_EQ("foo", Syms->getName(1));
+  EXPECT_EQ(ELF::STB_GLOBAL, Syms->getBinding(1));
+  EXPECT_EQ(ELF::STT_FUNC, Syms->getType(1));
+  EXPECT_EQ(ELF::STV_DEFAULT, Syms->getVisibility(1));
+  EXPECT_EQ(0x1000u, Syms->Values[1]);
+  EXPECT_EQ(16u, Syms->Sizes[1]);
+  EXPECT_EQ(1u, Syms->SectionIndexes[1]);
+
+  EXPECT_EQ("bar", Syms->getName(2));
+  EXPECT_EQ(ELF::STB_LOCAL, Syms->getBinding(2));
+  EXPECT_EQ(ELF::STT_OBJECT, Syms->getType(2));
+  EXPECT_EQ(ELF::STV_HIDDEN, Syms->getVisibility(2));
+  EXPECT_EQ(0x2000u, Syms->Values[2]);
+  EXPECT_EQ(8u, Syms->Sizes[2]);
+  EXPECT_EQ(70000u, Syms->SectionIndexes[2]);
+}
+
+TEST(ELFTest, DecodeSymbolsBadName) {
+  TestObject Obj;
+  Obj.Syms[2].st_name = 9;
+  Expected<ELF64LEFile> File = ELF64LEFile::create(Obj.data());
+  ASSERT_THAT_EXPECTED(File, Succeeded());
+
+  Expected<ELFSymbolArray> Syms = File->decodeSymbols(Obj.Shdrs[2]);
+  ASSERT_FALSE(bool(Syms));
+  EXPECT_EQ("st_name is past the end of the string table",
+            toString(Syms.takeError()));
+}
+
+} // end anonymous namespace
@@ -280,6 +280,34 @@ TEST_P(CoverageMappingTest, basic_write_read) {
   }
 }
 
+TEST_P(CoverageMappingTest, read_filenames_before_regions) {
+  startFunction("func", 0x1234);
+  addCMR(Counter::getCounter(0), "foo", 1, 1, 4, 1);
+  addExpansionCMR("foo", "bar", 2, 1, 2, 5);
+  addCMR(Counter::getCounter(1), "bar", 1, 1, 3, 1);
+
+  std::string Coverage = writeCoverageRegions(InputFunctions.back());
+  SmallVector<StringRef, 8> TUFilenames(Files.size());
+  for (const auto &E : Files)
+    TUFilenames[E.getValue()] = E.getKey();
+  std::vector<StringRef> Filenames;
+  std::vector<CounterExpression> Expressions;
+  std::vector<CounterMappingRegion> Regions;
+  RawCoverageMappingReader Reader(Coverage, TUFilenames, Filenames,
+                                  Expressions, Regions);
+  EXPECT_THAT_ERROR(Reader.readFilenames(), Succeeded());
+  ASSERT_EQ(2u, Filenames.size());
+  ASSERT_EQ("foo", Filenames[0]);
+  ASSERT_EQ("bar", Filenames[1]);
+  ASSERT_TRUE(Regions.empty());
+
+  EXPECT_THAT_ERROR(Reader.read(), Succeeded());
+  ASSERT_EQ(2u, Filenames.size());
+  ASSERT_EQ(3u, Regions.size());
+  ASSERT_EQ(CounterMappingRegion::ExpansionRegion, Regions[1].Kind);
+  ASSERT_EQ(Counter::getCounter(1), Regions[1].Count);
+}
+
 TEST_P(CoverageMappingTest, correct_deserialize_for_more_than_two_files) {
   const char *FileNames[] = {"bar", "baz", "foo"};
   static const unsigned N = array_lengthof(FileNames);
@@ -112,6 +112,35 @@ TEST_P(MaybeSparseInstrProfTest, get_instr_prof_record) {
   ASSERT_TRUE(ErrorEquals(instrprof_error::unknown_function, R.takeError()));
 }
 
+TEST_P(MaybeSparseInstrProfTest, preload_records) {
+  Writer.addRecord({"foo", 0x1234, {1, 2}}, Err);
+  Writer.addRecord({"foo", 0x1235, {3, 4}}, Err);
+  Writer.addRecord({"baz", 0x1234, {5}}, Err);
+  auto Profile = Writer.writeBuffer();
+  readProfile(std::move(Profile));
+
+  EXPECT_THAT_ERROR(Reader->preloadRecords({"foo", "bar", "foo"}),
+                    Succeeded());
+
+  Expected<InstrProfRecord> R = Reader->getInstrProfRecord("foo", 0x1235);
+  EXPECT_THAT_ERROR(R.takeError(), Succeeded());
+  ASSERT_EQ(2U, R->Counts.size());
+  ASSERT_EQ(3U, R->Counts[0]);
+  ASSERT_EQ(4U, R->Counts[1]);
+
+  R = Reader->getInstrProfRecord("foo", 0x5678);
+  ASSERT_TRUE(ErrorEquals(instrprof_error::hash_mismatch, R.takeError()));
+
+  R = Reader->getInstrProfRecord("bar", 0x1234);
+  ASSERT_TRUE(ErrorEquals(instrprof_error::unknown_function, R.takeError()));
+
+  // Functions that weren't preloaded are still looked up in the profile.
+  R = Reader->getInstrProfRecord("baz", 0x1234);
+  EXPECT_THAT_ERROR(R.takeError(), Succeeded());
+  ASSERT_EQ(1U, R->Counts.size());
+  ASSERT_EQ(5U, R->Counts[0]);
+}
+
 TEST_P(MaybeSparseInstrProfTest, get_function_counts) {
   Writer.addRecord({"foo", 0x1234, {1, 2}}, Err);
   Writer.addRecord({"foo", 0x1235, {3, 4}}, Err);
@@ -411,6 +440,36 @@ TEST_P(MaybeSparseInstrProfTest, get_icall_data_read_write_with_weight) {
   ASSERT_EQ(StringRef((const char *)VD[2].Value, 7), StringRef("callee1"));
 }
 
+TEST_P(MaybeSparseInstrProfTest, get_icall_data_merge_with_weight) {
+  NamedInstrProfRecord Record1("caller", 0x1234, {1, 2});
+  Record1.reserveSites(IPVK_IndirectCallTarget, 1);
+  InstrProfValueData VD0[] = {{(uint64_t)callee1, 1}};
+  Record1.addValueData(IPVK_IndirectCallTarget, 0, VD0, 1, nullptr);
+
+  // The targets that are new to the merged record are scaled as well.
+  NamedInstrProfRecord Record2("caller", 0x1234, {1, 2});
+  Record2.reserveSites(IPVK_IndirectCallTarget, 1);
+  InstrProfValueData VD1[] = {{(uint64_t)callee1, 1}, {(uint64_t)callee2, 2}};
+  Record2.addValueData(IPVK_IndirectCallTarget, 0, VD1, 2, nullptr);
+
+  Writer.addRecord(std::move(Record1), Err);
+  Writer.addRecord(std::move(Record2), 10, Err);
+  Writer.addRecord({"callee1", 0x1235, {3, 4}}, Err);
+  Writer.addRecord({"callee2", 0x1235, {3, 4}}, Err);
+  auto Profile = Writer.writeBuffer();
+  readProfile(std::move(Profile));
+
+  Expected<InstrProfRecord> R = Reader->getInstrProfRecord("caller", 0x1234);
+  EXPECT_THAT_ERROR(R.takeError(), Succeeded());
+  ASSERT_EQ(2U, R->getNumValueDataForSite(IPVK_IndirectCallTarget, 0));
+  std::unique_ptr<InstrProfValueData[]> VD =
+      R->getValueForSite(IPVK_IndirectCallTarget, 0);
+  ASSERT_EQ(StringRef((const char *)VD[0].Value, 7), StringRef("callee2"));
+  ASSERT_EQ(20U, VD[0].Count);
+  ASSERT_EQ(StringRef((const char *)VD[1].Value, 7), StringRef("callee1"));
+  ASSERT_EQ(11U, VD[1].Count);
+}
+
 TEST_P(MaybeSparseInstrProfTest, get_icall_data_read_write_big_endian) {
   NamedInstrProfRecord Record1("caller", 0x1234, {1, 2});
 
@@ -804,6 +863,32 @@ TEST_P(MaybeSparseInstrProfTest, get_max_function_count) {
   ASSERT_EQ(1ULL << 63, Reader->getMaximumFunctionCount(/* IsCS */ false));
 }
 
+TEST_P(MaybeSparseInstrProfTest, get_cs_max_function_count) {
+  uint64_t CSHash = 0x1234;
+  NamedInstrProfRecord::setCSFlagInHash(CSHash);
+  ASSERT_THAT_ERROR(Writer.setIsIRLevelProfile(true, true), Succeeded());
+  Writer.addRecord({"foo", 0x1234, {1ULL << 31, 2}}, Err);
+  Writer.addRecord({"foo", CSHash, {1ULL << 40, 3}}, Err);
+  Writer.addRecord({"bar", CSHash, {5}}, Err);
+  auto Profile = Writer.writeBuffer();
+  readProfile(std::move(Profile));
+
+  ASSERT_TRUE(Reader->isIRLevelProfile());
+  ASSERT_TRUE(Reader->hasCSIRLevelProfile());
+  ASSERT_EQ(1ULL << 31, Reader->getMaximumFunctionCount(/* IsCS */ false));
+  ASSERT_EQ(1ULL << 40, Reader->getMaximumFunctionCount(/* IsCS */ true));
+  ASSERT_EQ(2U, Reader->getSummary(/* IsCS */ false).getNumCounts());
+  ASSERT_EQ(3U, Reader->getSummary(/* IsCS */ true).getNumCounts());
+
+  // The context sensitive records are kept apart from the others.
+  Expected<InstrProfRecord> R = Reader->getInstrProfRecord("foo", CSHash);
+  EXPECT_THAT_ERROR(R.takeError(), Succeeded());
+  ASSERT_EQ(2U, R->Counts.size());
+  ASSERT_EQ(1ULL << 40, R->Counts[0]);
+  R = Reader->getInstrProfRecord("bar", 0x1234);
+  ASSERT_TRUE(ErrorEquals(instrprof_error::hash_mismatch, R.takeError()));
+}
+
 TEST_P(MaybeSparseInstrProfTest, get_weighted_function_counts) {
   Writer.addRecord({"foo", 0x1234, {1, 2}}, 3, Err);
   Writer.addRecord({"foo", 0x1235, {3, 4}}, 5, Err);
@@ -15,6 +15,7 @@
 #include "llvm/ProfileData/SampleProfReader.h"
 #include "llvm/ProfileData/SampleProfWriter.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
@@ -57,11 +58,14 @@ struct SampleProfTest : ::testing::Test {
     Reader->collectFuncsToUse(M);
   }
 
-  void testRoundTrip(SampleProfileFormat Format, bool Remap) {
+  void testRoundTrip(SampleProfileFormat Format, bool Remap,
+                     bool Compress = false) {
     SmallVector<char, 128> ProfilePath;
     ASSERT_TRUE(NoError(llvm::sys::fs::createTemporaryFile("profile", "", ProfilePath)));
     StringRef Profile(ProfilePath.data(), ProfilePath.size());
     createWriter(Format, Profile);
+    if (Compress)
+      Writer->setToCompressAllSections();
 
     StringRef FooName("_Z3fooi");
     FunctionSamples FooSamples;
@@ -285,6 +289,16 @@ TEST_F(SampleProfTest, roundtrip_compact_binary_profile) {
   testRoundTrip(SampleProfileFormat::SPF_Compact_Binary, false);
 }
 
+TEST_F(SampleProfTest, roundtrip_ext_binary_profile) {
+  testRoundTrip(SampleProfileFormat::SPF_Ext_Binary, false);
+}
+
+TEST_F(SampleProfTest, roundtrip_compressed_ext_binary_profile) {
+  if (!zlib::isAvailable())
+    return;
+  testRoundTrip(SampleProfileFormat::SPF_Ext_Binary, false, true);
+}
+
 TEST_F(SampleProfTest, remap_text_profile) {
   testRoundTrip(SampleProfileFormat::SPF_Text, true);
 }
@@ -293,6 +307,45 @@ TEST_F(SampleProfTest, remap_raw_binary_profile) {
   testRoundTrip(SampleProfileFormat::SPF_Binary, true);
 }
 
+TEST_F(SampleProfTest, remap_ext_binary_profile) {
+  testRoundTrip(SampleProfileFormat::SPF_Ext_Binary, true);
+}
+
+// Only the profiles of the functions in the module are loaded from an
+// extensible binary profile.
+TEST_F(SampleProfTest, ext_binary_load_funcs_to_use) {
+  SmallVector<char, 128> ProfilePath;
+  ASSERT_TRUE(NoError(
+      llvm::sys::fs::createTemporaryFile("profile", "", ProfilePath)));
+  StringRef Profile(ProfilePath.data(), ProfilePath.size());
+  createWriter(SampleProfileFormat::SPF_Ext_Binary, Profile);
+
+  StringMap<FunctionSamples> Profiles;
+  addFunctionSamples(&Profiles, "foo", 20301, 1437);
+  addFunctionSamples(&Profiles, "bar", 7711, 610);
+  addFunctionSamples(&Profiles, "baz", 600, 60);
+  ASSERT_TRUE(NoError(Writer->write(Profiles)));
+  Writer->getOutputStream().flush();
+
+  Module M("my_module", Context);
+  FunctionType *FnType =
+      FunctionType::get(Type::getVoidTy(Context), {}, false);
+  M.getOrInsertFunction("bar", FnType);
+  M.getOrInsertFunction("qux", FnType);
+
+  readProfile(M, Profile);
+  ASSERT_TRUE(NoError(Reader->read()));
+  ASSERT_EQ(1u, Reader->getProfiles().size());
+  FunctionSamples *BarSamples = Reader->getSamplesFor("bar");
+  ASSERT_TRUE(BarSamples != nullptr);
+  ASSERT_EQ(7711u, BarSamples->getTotalSamples());
+  ASSERT_EQ(610u, BarSamples->getHeadSamples());
+  ASSERT_TRUE(Reader->getSamplesFor("foo") == nullptr);
+
+  // The summary still covers the whole profile.
+  ASSERT_EQ(3u, Reader->getSummary().getNumFunctions());
+}
+
 TEST_F(SampleProfTest, sample_overflow_saturation) {
   const uint64_t Max = std::numeric_limits<uint64_t>::max();
   sampleprof_error Result;
@@ -0,0 +1,172 @@
+//===- unittest/Remarks/BinaryRemarksTest.cpp - Binary remark tests -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm-c/Remarks.h"
+#include "llvm/Remarks/Remark.h"
+#include "llvm/Remarks/RemarkParser.h"
+#include "llvm/Remarks/RemarkSerializer.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+static remarks::Remark makeRemark(ArrayRef<remarks::Argument> Args) {
+  remarks::Remark R;
+  R.RemarkType = remarks::Type::Missed;
+  R.PassName = "inline";
+  R.RemarkName = "NoDefinition";
+  R.FunctionName = "foo";
+  R.Loc = remarks::RemarkLocation{"file.c", 3, 12};
+  R.Hotness = 4;
+  R.Args = Args;
+  return R;
+}
+
+static std::string serialize(ArrayRef<remarks::Remark> Remarks) {
+  std::string Buf;
+  raw_string_ostream OS(Buf);
+  remarks::BinarySerializer S(OS);
+  for (const remarks::Remark &R : Remarks)
+    S.emit(R);
+  return OS.str();
+}
+
+static bool parseExpectError(StringRef Buf, const char *Error) {
+  remarks::Parser Parser(remarks::Format::Binary, Buf);
+  Expected<const remarks::Remark *> Remark = Parser.getNext();
+  EXPECT_FALSE(Remark); // Expect an error here.
+
+  std::string ErrorStr;
+  raw_string_ostream Stream(ErrorStr);
+  handleAllErrors(Remark.takeError(),
+                  [&](const ErrorInfoBase &EIB) { EIB.log(Stream); });
+  return StringRef(Stream.str()).contains(Error);
+}
+
+TEST(BinaryRemarks, RoundTrip) {
+  remarks::Argument Args[] = {
+      {"Callee", "bar", None},
+      {"String", " will not be inlined into ", None},
+      {"Caller", "foo", remarks::RemarkLocation{"file.c", 2, 0}}};
+  remarks::Remark R1 = makeRemark(Args);
+  remarks::Remark R2;
+  R2.RemarkType = remarks::Type::Passed;
+  R2.PassName = "inline";
+  R2.RemarkName = "Inlined";
+  R2.FunctionName = "bar";
+
+  std::string Buf = serialize({R1, R2});
+
+  // The format is detected from the magic number.
+  remarks::Parser Parser(Buf);
+  Expected<const remarks::Remark *> RemarkOrErr = Parser.getNext();
+  ASSERT_FALSE(errorToBool(RemarkOrErr.takeError()));
+  ASSERT_NE(*RemarkOrErr, nullptr);
+
+  const remarks::Remark &P1 = **RemarkOrErr;
+  EXPECT_EQ(P1.RemarkType, remarks::Type::Missed);
+  EXPECT_EQ(P1.PassName, "inline");
+  EXPECT_EQ(P1.RemarkName, "NoDefinition");
+  EXPECT_EQ(P1.FunctionName, "foo");
+  ASSERT_TRUE(P1.Loc);
+  EXPECT_EQ(P1.Loc->SourceFilePath, "file.c");
+  EXPECT_EQ(P1.Loc->SourceLine, 3U);
+  EXPECT_EQ(P1.Loc->SourceColumn, 12U);
+  ASSERT_TRUE(P1.Hotness);
+  EXPECT_EQ(*P1.Hotness, 4U);
+  ASSERT_EQ(P1.Args.size(), 3U);
+  EXPECT_EQ(P1.Args[0].Key, "Callee");
+  EXPECT_EQ(P1.Args[0].Val, "bar");
+  EXPECT_FALSE(P1.Args[0].Loc);
+  EXPECT_EQ(P1.Args[1].Val, " will not be inlined into ");
+  EXPECT_EQ(P1.Args[2].Key, "Caller");
+  ASSERT_TRUE(P1.Args[2].Loc);
+  EXPECT_EQ(P1.Args[2].Loc->SourceFilePath, "file.c");
+  EXPECT_EQ(P1.Args[2].Loc->SourceLine, 2U);
+  EXPECT_EQ(P1.Args[2].Loc->SourceColumn, 0U);
+
+  RemarkOrErr = Parser.getNext();
+  ASSERT_FALSE(errorToBool(RemarkOrErr.takeError()));
+  ASSERT_NE(*RemarkOrErr, nullptr);
+
+  const remarks::Remark &P2 = **RemarkOrErr;
+  EXPECT_EQ(P2.RemarkType, remarks::Type::Passed);
+  EXPECT_EQ(P2.RemarkName, "Inlined");
+  EXPECT_EQ(P2.FunctionName, "bar");
+  EXPECT_FALSE(P2.Loc);
+  EXPECT_FALSE(P2.Hotness);
+  EXPECT_TRUE(P2.Args.empty());
+
+  RemarkOrErr = Parser.getNext();
+  EXPECT_FALSE(errorToBool(RemarkOrErr.takeError()));
+  EXPECT_EQ(*RemarkOrErr, nullptr);
+}
+
+TEST(BinaryRemarks, StringsAreEmittedOnce) {
+  remarks::Remark R = makeRemark({});
+  std::string One = serialize({R});
+  std::string Two = serialize({R, R});
+
+  // The second remark only refers to the strings defined for the first one.
+  size_t HeaderSize = serialize({}).size();
+  EXPECT_LT(Two.size() - One.size(), One.size() - HeaderSize);
+  EXPECT_EQ(StringRef(Two).count("NoDefinition"), 1U);
+}
+
+TEST(BinaryRemarks, ParsingEmpty) {
+  remarks::Parser Parser(serialize({}));
+  Expected<const remarks::Remark *> Remark = Parser.getNext();
+  EXPECT_FALSE(errorToBool(Remark.takeError()));
+  EXPECT_EQ(*Remark, nullptr);
+}
+
+TEST(BinaryRemarks, ParsingBadMagic) {
+  EXPECT_TRUE(parseExpectError("REMARKS", "invalid magic number."));
+}
+
+TEST(BinaryRemarks, ParsingTruncated) {
+  std::string Buf = serialize({makeRemark({})});
+  Buf.pop_back();
+  EXPECT_TRUE(parseExpectError(Buf, "malformed binary remarks"));
+}
+
+TEST(BinaryRemarks, ParsingBadStringIndex) {
+  // A remark record referring to strings that were never defined.
+  std::string Buf = serialize({});
+  Buf += remarks::BinarySerializer::RK_Remark;
+  Buf += static_cast<char>(remarks::Type::Passed);
+  Buf += 50;
+  EXPECT_TRUE(parseExpectError(
+      Buf, "String with index 50 is out of bounds (size = 0)."));
+}
+
+TEST(BinaryRemarks, ContentsCAPI) {
+  remarks::Argument Args[] = {{"Callee", "bar", None}};
+  std::string Buf = serialize({makeRemark(Args)});
+
+  LLVMRemarkParserRef Parser =
+      LLVMRemarkParserCreateBinary(Buf.data(), Buf.size());
+  LLVMRemarkEntryRef Remark = LLVMRemarkParserGetNext(Parser);
+  ASSERT_TRUE(Remark != nullptr);
+  EXPECT_EQ(LLVMRemarkEntryGetType(Remark), LLVMRemarkTypeMissed);
+  LLVMRemarkStringRef PassName = LLVMRemarkEntryGetPassName(Remark);
+  EXPECT_EQ(StringRef(LLVMRemarkStringGetData(PassName),
+                      LLVMRemarkStringGetLen(PassName)),
+            "inline");
+  EXPECT_EQ(LLVMRemarkEntryGetNumArgs(Remark), 1U);
+  EXPECT_EQ(LLVMRemarkParserGetNext(Parser), nullptr);
+  EXPECT_FALSE(LLVMRemarkParserHasError(Parser));
+  LLVMRemarkParserDispose(Parser);
+
+  // Errors are reported through the C API as well.
+  Parser = LLVMRemarkParserCreateBinary("junk", 4);
+  EXPECT_EQ(LLVMRemarkParserGetNext(Parser), nullptr);
+  EXPECT_TRUE(LLVMRemarkParserHasError(Parser));
+  EXPECT_TRUE(StringRef(LLVMRemarkParserGetErrorMessage(Parser))
+                  .contains("invalid magic number."));
+  LLVMRemarkParserDispose(Parser);
+}
@@ -65,6 +65,35 @@ TEST(CompressionTest, Zlib) {
   TestZlibCompression(BinaryDataStr, zlib::DefaultCompression);
 }
 
+TEST(CompressionTest, ZlibShards) {
+  std::string Input;
+  for (size_t I = 0; I < 100000; ++I)
+    Input += 'a' + I * 7 % 13;
+
+  // Compress Input in three pieces and glue them together into a zlib stream.
+  SmallString<32> Compressed("\x78\x01");
+  uint32_t Checksum = 1;
+  const size_t ShardSize = 40000;
+  for (size_t I = 0; I < Input.size(); I += ShardSize) {
+    StringRef Shard = StringRef(Input).substr(I, ShardSize);
+    Error E = zlib::compressShard(Shard, Compressed,
+                                  I + ShardSize >= Input.size());
+    EXPECT_FALSE(E);
+    consumeError(std::move(E));
+    Checksum =
+        zlib::adler32Combine(Checksum, zlib::adler32(Shard), Shard.size());
+  }
+  EXPECT_EQ(zlib::adler32(Input), Checksum);
+  for (int I = 3; I >= 0; --I)
+    Compressed.push_back(Checksum >> (I * 8));
+
+  SmallString<32> Uncompressed;
+  Error E = zlib::uncompress(Compressed, Uncompressed, Input.size());
+  EXPECT_FALSE(E);
+  consumeError(std::move(E));
+  EXPECT_EQ(Input, Uncompressed);
+}
+
 TEST(CompressionTest, ZlibCRC32) {
   EXPECT_EQ(
       0x414FA339U,
@@ -73,4 +102,90 @@ TEST(CompressionTest, ZlibCRC32) {
 
 #endif
 
+void TestCompression(compression::Format F, StringRef Input, int Level) {
+  SmallString<32> Compressed;
+  SmallString<32> Uncompressed;
+
+  Error E = compression::compress(F, Input, Compressed, Level);
+  EXPECT_FALSE(E);
+  consumeError(std::move(E));
+
+  E = compression::uncompress(F, Compressed, Uncompressed, Input.size());
+  EXPECT_FALSE(E);
+  consumeError(std::move(E));
+  EXPECT_EQ(Input, Uncompressed);
+
+  if (Input.size() > 0) {
+    // Uncompression fails if expected length is too short.
+    E = compression::uncompress(F, Compressed, Uncompressed, Input.size() - 1);
+    EXPECT_TRUE(bool(E));
+    consumeError(std::move(E));
+  }
+}
+
+void TestFormat(compression::Format F, ArrayRef<int> Levels) {
+  const size_t kSize = 1024;
+  char BinaryData[kSize];
+  for (size_t i = 0; i < kSize; ++i)
+    BinaryData[i] = i & 255;
+  StringRef BinaryDataStr(BinaryData, kSize);
+
+  TestCompression(F, "", compression::getDefaultLevel(F));
+  for (int Level : Levels) {
+    TestCompression(F, "hello, world!", Level);
+    TestCompression(F, BinaryDataStr, Level);
+  }
+}
+
+TEST(CompressionTest, Zstd) {
+  if (!zstd::isAvailable())
+    return;
+  TestFormat(compression::Format::Zstd,
+             {zstd::BestSpeedCompression, zstd::DefaultCompression,
+              zstd::BestSizeCompression});
+}
+
+TEST(CompressionTest, ZstdFrames) {
+  if (!zstd::isAvailable())
+    return;
+  std::string Input;
+  for (size_t I = 0; I < 100000; ++I)
+    Input += 'a' + I * 7 % 13;
+
+  // Independently compressed frames decompress to the concatenated input.
+  SmallString<32> Compressed;
+  const size_t ShardSize = 40000;
+  for (size_t I = 0; I < Input.size(); I += ShardSize) {
+    SmallString<32> Frame;
+    Error E = zstd::compress(StringRef(Input).substr(I, ShardSize), Frame);
+    EXPECT_FALSE(E);
+    consumeError(std::move(E));
+    Compressed += Frame;
+  }
+
+  SmallString<32> Uncompressed;
+  Error E = zstd::uncompress(Compressed, Uncompressed, Input.size());
+  EXPECT_FALSE(E);
+  consumeError(std::move(E));
+  EXPECT_EQ(Input, Uncompressed);
+}
+
+TEST(CompressionTest, LZ4) {
+  if (!lz4::isAvailable())
+    return;
+  TestFormat(compression::Format::LZ4,
+             {lz4::DefaultCompression, lz4::BestSizeCompression});
+}
+
+TEST(CompressionTest, Formats) {
+  EXPECT_STREQ("zlib", compression::getName(compression::Format::Zlib));
+  EXPECT_STREQ("zstd", compression::getName(compression::Format::Zstd));
+  EXPECT_STREQ("lz4", compression::getName(compression::Format::LZ4));
+  EXPECT_EQ(zlib::isAvailable(),
+            compression::isAvailable(compression::Format::Zlib));
+  if (zlib::isAvailable())
+    TestFormat(compression::Format::Zlib,
+               {zlib::NoCompression, zlib::BestSizeCompression});
+}
+
 }
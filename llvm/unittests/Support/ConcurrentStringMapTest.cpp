@@ -0,0 +1,104 @@
+//===- ConcurrentStringMapTest.cpp - ConcurrentStringMap tests ------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/ConcurrentStringMap.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+TEST(ConcurrentStringMapTest, Basics) {
+  ConcurrentStringMap<int> Map(3);
+  EXPECT_EQ(4U, Map.getNumShards());
+  EXPECT_TRUE(Map.empty());
+  EXPECT_EQ(nullptr, Map.find("foo"));
+
+  auto R1 = Map.insert("foo", 1);
+  EXPECT_TRUE(R1.second);
+  EXPECT_EQ("foo", R1.first->getKey());
+  EXPECT_EQ(1, R1.first->getValue());
+
+  // Inserting an existing key returns the existing entry unchanged.
+  auto R2 = Map.insert("foo", 2);
+  EXPECT_FALSE(R2.second);
+  EXPECT_EQ(R1.first, R2.first);
+  EXPECT_EQ(1, R2.first->getValue());
+
+  EXPECT_TRUE(Map.insert("").second);
+  EXPECT_TRUE(Map.count(""));
+  EXPECT_EQ(R1.first, Map.find("foo"));
+  EXPECT_EQ(2U, Map.size());
+}
+
+TEST(ConcurrentStringMapTest, StablePointers) {
+  ConcurrentStringMap<int> Map(1);
+  auto *First = Map.insert("first").first;
+  const char *Key = First->getKeyData();
+  for (int I = 0; I < 10000; ++I)
+    Map.insert(std::to_string(I), I);
+  EXPECT_EQ(First, Map.find("first"));
+  EXPECT_EQ(Key, Map.find("first")->getKeyData());
+
+  int Sum = 0;
+  Map.forEach([&](StringMapEntry<int> &E) { Sum += E.getValue(); });
+  EXPECT_EQ(9999 * 10000 / 2, Sum);
+}
+
+TEST(ConcurrentStringMapTest, Threads) {
+  // Every thread inserts the same keys. Exactly one insertion of each key
+  // must succeed, and all threads must see the same entries.
+  const int NumThreads = 4;
+  const int NumKeys = 5000;
+  ConcurrentStringMap<std::atomic<int>> Map;
+  std::vector<std::vector<StringMapEntry<std::atomic<int>> *>> Entries(
+      NumThreads);
+  std::atomic<int> Created(0);
+
+  std::vector<std::thread> Threads;
+  for (int T = 0; T < NumThreads; ++T)
+    Threads.emplace_back([&, T] {
+      for (int I = 0; I < NumKeys; ++I) {
+        auto R = Map.insert(std::to_string(I), 0);
+        R.first->getValue()++;
+        Created += R.second;
+        Entries[T].push_back(R.first);
+      }
+    });
+  for (std::thread &T : Threads)
+    T.join();
+
+  EXPECT_EQ(NumKeys, Created);
+  EXPECT_EQ(size_t(NumKeys), Map.size());
+  for (int I = 0; I < NumKeys; ++I) {
+    auto *E = Map.find(std::to_string(I));
+    EXPECT_EQ(NumThreads, E->getValue());
+    for (int T = 0; T < NumThreads; ++T)
+      EXPECT_EQ(E, Entries[T][I]);
+  }
+}
+
+TEST(ConcurrentStringMapTest, UniqueStringSaver) {
+  ConcurrentUniqueStringSaver Saver;
+  std::string Str = "hello";
+  StringRef S1 = Saver.save(Str);
+  Str = "world";
+  StringRef S2 = Saver.save(Twine("hel") + "lo");
+  EXPECT_EQ("hello", S1);
+  EXPECT_EQ(S1.data(), S2.data());
+  EXPECT_EQ('\0', *S1.end());
+  EXPECT_EQ(S1.data(), Saver.lookup("hello").data());
+  EXPECT_EQ(nullptr, Saver.lookup("world").data());
+  EXPECT_EQ(1U, Saver.size());
+}
+
+} // end anonymous namespace
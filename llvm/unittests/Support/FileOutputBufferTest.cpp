@@ -121,4 +121,60 @@ TEST(FileOutputBuffer, Test) {
   // Clean up.
   ASSERT_NO_ERROR(fs::remove(TestDirectory.str()));
 }
+
+TEST(FileOutputBuffer, AsyncWriteback) {
+  SmallString<128> TestDirectory;
+  ASSERT_NO_ERROR(
+      fs::createUniqueDirectory("FileOutputBuffer-async", TestDirectory));
+
+  // Verify commit case. Some ranges are written back, overlapping each other,
+  // and the rest is left for commit().
+  SmallString<128> File1(TestDirectory);
+  File1.append("/file1");
+  const size_t Size = 10 * 1024 * 1024 + 123;
+  std::string Data(Size, '\0');
+  for (size_t I = 0; I < Size; ++I)
+    Data[I] = I * 7 % 251;
+  {
+    Expected<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
+        FileOutputBuffer::create(File1, Size,
+                                 FileOutputBuffer::F_async_writeback);
+    ASSERT_NO_ERROR(errorToErrorCode(BufferOrErr.takeError()));
+    std::unique_ptr<FileOutputBuffer> &Buffer = *BufferOrErr;
+    ASSERT_EQ(Size, Buffer->getBufferSize());
+    uint8_t *Buf = Buffer->getBufferStart();
+    memcpy(Buf + 100, &Data[100], 6000000);
+    Buffer->writeback(100, 6000000);
+    memcpy(Buf + 5000000, &Data[5000000], 4000000);
+    Buffer->writeback(5000000, 4000000);
+    Buffer->writeback(0, 0);
+    memcpy(Buf, &Data[0], 100);
+    memcpy(Buf + 9000000, &Data[9000000], Size - 9000000);
+    ASSERT_NO_ERROR(errorToErrorCode(Buffer->commit()));
+  }
+  ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+      MemoryBuffer::getFile(File1);
+  ASSERT_TRUE(bool(MBOrErr));
+  EXPECT_TRUE((*MBOrErr)->getBuffer() == Data);
+  MBOrErr->reset();
+  ASSERT_NO_ERROR(fs::remove(File1.str()));
+
+  // Verify abort case.
+  SmallString<128> File2(TestDirectory);
+  File2.append("/file2");
+  {
+    Expected<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
+        FileOutputBuffer::create(File2, 8192,
+                                 FileOutputBuffer::F_async_writeback);
+    ASSERT_NO_ERROR(errorToErrorCode(BufferOrErr.takeError()));
+    std::unique_ptr<FileOutputBuffer> &Buffer = *BufferOrErr;
+    memcpy(Buffer->getBufferStart(), "AABBCCDDEEFFGGHHIIJJ", 20);
+    Buffer->writeback(0, 20);
+    // Do *not* commit buffer.
+  }
+  ASSERT_EQ(fs::access(Twine(File2), fs::AccessMode::Exist),
+            errc::no_such_file_or_directory);
+
+  ASSERT_NO_ERROR(fs::remove(TestDirectory.str()));
+}
 } // anonymous namespace
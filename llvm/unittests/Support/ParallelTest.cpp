@@ -14,7 +14,9 @@
 #include "llvm/Support/Parallel.h"
 #include "gtest/gtest.h"
 #include <array>
+#include <atomic>
 #include <random>
+#include <vector>
 
 uint32_t array[1024 * 1024];
 
@@ -49,4 +51,36 @@ TEST(Parallel, parallel_for) {
   ASSERT_EQ(range[2049], 1u);
 }
 
+TEST(Parallel, parallel_for_max_threads) {
+  std::atomic<unsigned> Running(0), MaxRunning(0);
+  std::vector<std::atomic<unsigned>> Visits(4099);
+  for_each_n(parallel::parallel_execution_policy(2), 0, 4099, [&](size_t I) {
+    unsigned N = ++Running;
+    unsigned Max = MaxRunning;
+    while (N > Max && !MaxRunning.compare_exchange_weak(Max, N))
+      ;
+    ++Visits[I];
+    --Running;
+  });
+  EXPECT_LE(MaxRunning, 2u);
+  for (std::atomic<unsigned> &V : Visits)
+    EXPECT_EQ(V, 1u);
+
+  std::vector<uint32_t> Range(3000, 1);
+  for_each(parallel::parallel_execution_policy(3), Range.begin(), Range.end(),
+           [](uint32_t &V) { ++V; });
+  EXPECT_TRUE(
+      std::all_of(Range.begin(), Range.end(), [](uint32_t V) { return V == 2; }));
+}
+
+TEST(Parallel, nested_for_each) {
+  // Tasks spawned from pool threads go to the spawning worker's own queue and
+  // may be stolen by others; make sure all of them still run.
+  std::atomic<unsigned> Count(0);
+  for_each_n(parallel::par, 0, 64, [&](size_t) {
+    for_each_n(parallel::par, 0, 64, [&](size_t) { ++Count; });
+  });
+  EXPECT_EQ(Count, 64u * 64u);
+}
+
 #endif
@@ -1103,6 +1103,16 @@ TEST_F(FileSystemTest, FileMapping) {
     // Verify content
     EXPECT_EQ(StringRef(mfr.const_data()), Val);
 
+    // Advice is only a hint and must not change the contents.
+    for (auto A : {fs::mapped_file_region::advice::sequential,
+                   fs::mapped_file_region::advice::random,
+                   fs::mapped_file_region::advice::willneed,
+                   fs::mapped_file_region::advice::dontneed,
+                   fs::mapped_file_region::advice::hugepage,
+                   fs::mapped_file_region::advice::normal})
+      ASSERT_NO_ERROR(mfr.advise(A));
+    EXPECT_EQ(StringRef(mfr.const_data()), Val);
+
     // Unmap temp file
     fs::mapped_file_region m(FD, fs::mapped_file_region::readonly, Size, 0, EC);
     ASSERT_NO_ERROR(EC);
@@ -1111,6 +1121,18 @@ TEST_F(FileSystemTest, FileMapping) {
   ASSERT_NO_ERROR(fs::remove(TempPath));
 }
 
+TEST_F(FileSystemTest, PrefetchFiles) {
+  SmallString<64> TempPath;
+  ASSERT_NO_ERROR(fs::createTemporaryFile("prefix", "temp", TempPath));
+
+  // Missing files are skipped.
+  std::vector<std::string> Paths = {TempPath.str(),
+                                    (TempPath + ".none").str()};
+  fs::prefetchFiles(Paths);
+  fs::prefetchFiles({});
+  ASSERT_NO_ERROR(fs::remove(TempPath));
+}
+
 TEST(Support, NormalizePath) {
   using TestTuple = std::tuple<const char *, const char *, const char *>;
   std::vector<TestTuple> Tests;
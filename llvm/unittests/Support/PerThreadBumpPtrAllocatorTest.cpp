@@ -0,0 +1,99 @@
+//===- PerThreadBumpPtrAllocatorTest.cpp - PerThreadAllocator tests -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/PerThreadBumpPtrAllocator.h"
+#include "gtest/gtest.h"
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+TEST(PerThreadBumpPtrAllocatorTest, Basics) {
+  PerThreadBumpPtrAllocator Alloc;
+  int *A = Alloc.Allocate<int>();
+  int *B = Alloc.Allocate<int>(10);
+  *A = 1;
+  B[9] = 2;
+  EXPECT_EQ(1, *A);
+  EXPECT_EQ(2, B[9]);
+  EXPECT_EQ(&Alloc.get(), &Alloc.get());
+  EXPECT_EQ(11 * sizeof(int), Alloc.getBytesAllocated());
+
+  Alloc.Reset();
+  EXPECT_EQ(0U, Alloc.getBytesAllocated());
+}
+
+TEST(PerThreadBumpPtrAllocatorTest, MultipleInstances) {
+  // Alternating between instances must not mix up their allocators.
+  PerThreadBumpPtrAllocator Alloc1;
+  PerThreadBumpPtrAllocator Alloc2;
+  for (int I = 0; I < 10; ++I) {
+    Alloc1.Allocate(1, 1);
+    Alloc2.Allocate(2, 1);
+  }
+  EXPECT_EQ(10U, Alloc1.getBytesAllocated());
+  EXPECT_EQ(20U, Alloc2.getBytesAllocated());
+  EXPECT_NE(&Alloc1.get(), &Alloc2.get());
+}
+
+TEST(PerThreadBumpPtrAllocatorTest, Threads) {
+  const unsigned NumThreads = 4;
+  const unsigned NumAllocs = 1000;
+  PerThreadBumpPtrAllocator Alloc;
+  std::vector<std::vector<unsigned *>> Ptrs(NumThreads);
+  std::vector<BumpPtrAllocator *> Allocators(NumThreads);
+
+  std::vector<std::thread> Threads;
+  for (unsigned T = 0; T < NumThreads; ++T)
+    Threads.emplace_back([&, T] {
+      Allocators[T] = &Alloc.get();
+      for (unsigned I = 0; I < NumAllocs; ++I) {
+        unsigned *P = Alloc.Allocate<unsigned>();
+        *P = T * NumAllocs + I;
+        Ptrs[T].push_back(P);
+      }
+    });
+  for (std::thread &T : Threads)
+    T.join();
+
+  // Every thread used its own allocator and no memory was handed out twice.
+  std::set<BumpPtrAllocator *> Unique(Allocators.begin(), Allocators.end());
+  EXPECT_EQ(NumThreads, Unique.size());
+  for (unsigned T = 0; T < NumThreads; ++T)
+    for (unsigned I = 0; I < NumAllocs; ++I)
+      EXPECT_EQ(T * NumAllocs + I, *Ptrs[T][I]);
+  EXPECT_EQ(NumThreads * NumAllocs * sizeof(unsigned),
+            Alloc.getBytesAllocated());
+}
+
+struct Counted {
+  static int Live;
+  Counted() { ++Live; }
+  ~Counted() { --Live; }
+};
+int Counted::Live = 0;
+
+TEST(PerThreadBumpPtrAllocatorTest, DestroyAll) {
+  PerThreadSpecificBumpPtrAllocator<Counted> Alloc;
+  std::vector<std::thread> Threads;
+  for (unsigned T = 0; T < 2; ++T)
+    Threads.emplace_back([&] {
+      for (unsigned I = 0; I < 100; ++I)
+        new (Alloc.get().Allocate()) Counted();
+    });
+  for (std::thread &T : Threads)
+    T.join();
+  EXPECT_EQ(200, Counted::Live);
+  Alloc.DestroyAll();
+  EXPECT_EQ(0, Counted::Live);
+}
+
+} // end anonymous namespace
@@ -0,0 +1,110 @@
+//===- unittests/TimeProfilerTest.cpp - Time trace profiler tests ---------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/JSON.h"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <thread>
+
+using namespace llvm;
+
+namespace {
+
+// Sleep long enough for a section to pass the default granularity.
+void sleepPastGranularity() {
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+}
+
+// Returns the thread ID of the first complete event named Name, or -1.
+int64_t findEventTid(const json::Array &Events, StringRef Name) {
+  for (const json::Value &V : Events) {
+    const json::Object *O = V.getAsObject();
+    if (!O || O->getString("ph") != StringRef("X") ||
+        O->getString("name") != Name)
+      continue;
+    if (Optional<int64_t> Tid = O->getInteger("tid"))
+      return *Tid;
+  }
+  return -1;
+}
+
+std::string writeProfile() {
+  SmallString<1024> Buf;
+  raw_svector_ostream OS(Buf);
+  timeTraceProfilerWrite(OS);
+  return Buf.str();
+}
+
+TEST(TimeProfiler, ProcessName) {
+  timeTraceProfilerInitialize("test-proc");
+  std::string Out = writeProfile();
+  timeTraceProfilerCleanup();
+  EXPECT_NE(Out.find("\"test-proc\""), std::string::npos);
+}
+
+TEST(TimeProfiler, Granularity) {
+  // A zero granularity records sections shorter than the default one.
+  timeTraceProfilerInitialize(0, "test");
+  {
+    TimeTraceScope Scope("Short", StringRef(""));
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  std::string Out = writeProfile();
+  timeTraceProfilerCleanup();
+  EXPECT_NE(Out.find("\"Short\""), std::string::npos);
+
+  // Sections below a (very coarse) granularity are dropped.
+  timeTraceProfilerInitialize(60 * 1000 * 1000, "test");
+  {
+    TimeTraceScope Scope("Long", StringRef(""));
+    sleepPastGranularity();
+  }
+  Out = writeProfile();
+  timeTraceProfilerCleanup();
+  EXPECT_EQ(Out.find("\"Long\""), std::string::npos);
+}
+
+#if LLVM_ENABLE_THREADS
+TEST(TimeProfiler, MultipleThreads) {
+  timeTraceProfilerInitialize("test");
+  {
+    TimeTraceScope Scope("Main", StringRef(""));
+    std::thread Worker([] {
+      TimeTraceScope Scope("Worker", StringRef(""));
+      sleepPastGranularity();
+    });
+    Worker.join();
+    sleepPastGranularity();
+  }
+  std::string Out = writeProfile();
+  timeTraceProfilerCleanup();
+
+  Expected<json::Value> Parsed = json::parse(Out);
+  ASSERT_TRUE(bool(Parsed)) << toString(Parsed.takeError());
+  const json::Array *Events =
+      Parsed->getAsObject()->getArray("traceEvents");
+  ASSERT_NE(Events, nullptr);
+
+  int64_t MainTid = findEventTid(*Events, "Main");
+  int64_t WorkerTid = findEventTid(*Events, "Worker");
+  EXPECT_NE(MainTid, -1);
+  EXPECT_NE(WorkerTid, -1);
+  EXPECT_NE(MainTid, WorkerTid);
+
+  // Totals are kept on their own tracks, apart from the real threads.
+  int64_t TotalTid = findEventTid(*Events, "Total Worker");
+  EXPECT_NE(TotalTid, -1);
+  EXPECT_NE(TotalTid, MainTid);
+  EXPECT_NE(TotalTid, WorkerTid);
+}
+#endif
+
+} // end anonymous namespace
@@ -17,3 +17,30 @@ TEST(xxhashTest, Basic) {
   EXPECT_EQ(0x69196c1b3af0bff9U,
             xxHash64("0123456789abcdefghijklmnopqrstuvwxyz"));
 }
+
+TEST(xxhashTest, xxh3) {
+  EXPECT_EQ(0xab6e5f64077e7d8aU, xxh3_64bits("foo"));
+  EXPECT_EQ(0xd463c860a032d362U, xxh3_64bits("bar"));
+  EXPECT_EQ(0xffb92a87c6306d55U,
+            xxh3_64bits("0123456789abcdefghijklmnopqrstuvwxyz"));
+
+  // Cover each of the length classes and both sides of their boundaries.
+  uint8_t Data[4096];
+  for (size_t I = 0; I < sizeof(Data); ++I)
+    Data[I] = I * 7 + 3;
+  struct {
+    size_t Len;
+    uint64_t Hash;
+  } Tests[] = {
+      {0, 0x2d06800538d394c2U},    {1, 0x13e608bc156defedU},
+      {3, 0xa9088dda485b481cU},    {4, 0x6d9253b16c8b1ed3U},
+      {8, 0x60539db630471163U},    {9, 0xfeff668361d723a8U},
+      {16, 0xb8c859b0f030b585U},   {17, 0x714a04408e79b80fU},
+      {128, 0x67425a03650261bfU},  {129, 0xc664bf3311c6abc4U},
+      {240, 0x64556dc6b462a6cfU},  {241, 0x8beadd3a8874fe17U},
+      {1024, 0x9b81661c641c72b1U}, {2055, 0xc55f78e8afa271b7U},
+      {4096, 0xd7428746842be37eU},
+  };
+  for (const auto &T : Tests)
+    EXPECT_EQ(T.Hash, xxh3_64bits(makeArrayRef(Data, T.Len))) << T.Len;
+}
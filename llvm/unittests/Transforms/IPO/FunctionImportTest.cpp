@@ -0,0 +1,81 @@
+//===- FunctionImportTest.cpp - Unit tests for function importing ---------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO/FunctionImport.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/Process.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+TEST(FunctionImport, ThinLinkImportStateRoundTrip) {
+  SmallString<128> Path;
+  ASSERT_FALSE(sys::fs::createTemporaryFile("import-state", "bin", Path));
+  FileRemover Cleanup(Path);
+
+  ThinLinkImportState State;
+  State.OptionsHash = 42;
+  ThinLinkImportState::ModuleState &A = State.Modules["a.o"];
+  A.Digest = 1;
+  A.Defined = {1, 2};
+  A.Consulted = {3, 4, 5};
+  A.ImportList["b.o"] = {3, 4};
+  ThinLinkImportState::ModuleState &B = State.Modules["b.o"];
+  B.Digest = 2;
+  B.Defined = {3, 4};
+  ASSERT_FALSE(errorToBool(State.writeToFile(Path)));
+
+  ThinLinkImportState Read;
+  ASSERT_FALSE(errorToBool(Read.readFromFile(Path)));
+  EXPECT_EQ(42u, Read.OptionsHash);
+  ASSERT_EQ(2u, Read.Modules.size());
+  const ThinLinkImportState::ModuleState &ReadA = Read.Modules["a.o"];
+  EXPECT_EQ(1u, ReadA.Digest);
+  EXPECT_EQ(A.Defined, ReadA.Defined);
+  EXPECT_EQ(A.Consulted, ReadA.Consulted);
+  ASSERT_EQ(1u, ReadA.ImportList.size());
+  EXPECT_EQ(A.ImportList["b.o"], ReadA.ImportList.lookup("b.o"));
+  const ThinLinkImportState::ModuleState &ReadB = Read.Modules["b.o"];
+  EXPECT_EQ(2u, ReadB.Digest);
+  EXPECT_EQ(B.Defined, ReadB.Defined);
+  EXPECT_TRUE(ReadB.Consulted.empty());
+  EXPECT_TRUE(ReadB.ImportList.empty());
+}
+
+TEST(FunctionImport, ThinLinkImportStateInvalid) {
+  SmallString<128> Path;
+  ASSERT_FALSE(sys::fs::createTemporaryFile("import-state", "bin", Path));
+  FileRemover Cleanup(Path);
+
+  ThinLinkImportState State;
+  State.OptionsHash = 42;
+  State.Modules["a.o"].Defined = {1, 2, 3};
+  ASSERT_FALSE(errorToBool(State.writeToFile(Path)));
+
+  // Truncate the file in the middle of the GUIDs.
+  uint64_t Size;
+  ASSERT_FALSE(sys::fs::file_size(Path, Size));
+  int FD;
+  ASSERT_FALSE(sys::fs::openFileForWrite(Path, FD, sys::fs::CD_OpenExisting));
+  ASSERT_FALSE(sys::fs::resize_file(FD, Size - 4));
+  ASSERT_FALSE(sys::Process::SafelyCloseFileDescriptor(FD));
+
+  // A state that can't be read is empty, so that nothing is reused.
+  ThinLinkImportState Read;
+  EXPECT_TRUE(errorToBool(Read.readFromFile(Path)));
+  EXPECT_EQ(0u, Read.OptionsHash);
+  EXPECT_TRUE(Read.Modules.empty());
+
+  EXPECT_TRUE(errorToBool(Read.readFromFile((Path + ".missing").str())));
+}
+
+} // end anonymous namespace
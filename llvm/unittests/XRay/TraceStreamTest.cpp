@@ -0,0 +1,179 @@
+//===- llvm/unittest/XRay/TraceStreamTest.cpp -------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Test the incremental, per-thread trace reading API.
+//
+//===----------------------------------------------------------------------===//
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/XRay/FDRLogBuilder.h"
+#include "llvm/XRay/FDRRecords.h"
+#include "llvm/XRay/FDRTraceWriter.h"
+#include "llvm/XRay/Trace.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <cstring>
+#include <string>
+
+namespace llvm {
+namespace xray {
+namespace {
+
+using testing::ElementsAre;
+using testing::Eq;
+using testing::Field;
+using testing::SizeIs;
+
+XRayFileHeader makeHeader(uint16_t Version) {
+  XRayFileHeader H;
+  H.Version = Version;
+  H.Type = 1;
+  H.ConstantTSC = true;
+  H.NonstopTSC = true;
+  H.CycleFrequency = 3e9;
+  return H;
+}
+
+std::vector<XRayRecord> streamThread(const TraceStream &TS, size_t I) {
+  std::vector<XRayRecord> Records;
+  if (auto E = TS.forEachRecord(I, [&](const XRayRecord &R) {
+        Records.push_back(R);
+        return Error::success();
+      }))
+    ADD_FAILURE() << toString(std::move(E));
+  return Records;
+}
+
+// Writes out a version 3 log where thread 1's buffers appear out of wallclock
+// order, interleaved with a buffer from thread 2.
+std::string writeVersion3Log() {
+  std::string Data;
+  raw_string_ostream OS(Data);
+  FDRTraceWriter Writer(OS, makeHeader(3));
+  auto L = LogBuilder()
+               .add<BufferExtents>(80)
+               .add<NewBufferRecord>(1)
+               .add<WallclockRecord>(2, 0)
+               .add<PIDRecord>(1)
+               .add<NewCPUIDRecord>(1, 200)
+               .add<FunctionRecord>(RecordTypes::ENTER, 2, 1)
+               .add<FunctionRecord>(RecordTypes::EXIT, 2, 100)
+               .add<BufferExtents>(80)
+               .add<NewBufferRecord>(2)
+               .add<WallclockRecord>(1, 0)
+               .add<PIDRecord>(1)
+               .add<NewCPUIDRecord>(2, 50)
+               .add<FunctionRecord>(RecordTypes::ENTER, 3, 1)
+               .add<FunctionRecord>(RecordTypes::EXIT, 3, 100)
+               .add<BufferExtents>(80)
+               .add<NewBufferRecord>(1)
+               .add<WallclockRecord>(1, 0)
+               .add<PIDRecord>(1)
+               .add<NewCPUIDRecord>(1, 100)
+               .add<FunctionRecord>(RecordTypes::ENTER, 1, 1)
+               .add<FunctionRecord>(RecordTypes::EXIT, 1, 10)
+               .consume();
+  for (auto &P : L)
+    if (auto E = P->apply(Writer))
+      ADD_FAILURE() << toString(std::move(E));
+  OS.flush();
+  return Data;
+}
+
+TEST(TraceStreamTest, StreamsVersion3ThreadsInWallclockOrder) {
+  auto Data = writeVersion3Log();
+  DataExtractor DE(Data, sys::IsLittleEndianHost, 8);
+  auto StreamOrErr = openTraceStream(DE);
+  if (!StreamOrErr)
+    FAIL() << StreamOrErr.takeError();
+  auto &TS = **StreamOrErr;
+
+  EXPECT_THAT(TS.getFileHeader().Version, Eq(3));
+  ASSERT_THAT(TS.threads(), ElementsAre(std::make_pair(uint64_t{1}, 1),
+                                        std::make_pair(uint64_t{1}, 2)));
+  EXPECT_THAT(streamThread(TS, 0),
+              ElementsAre(Field(&XRayRecord::FuncId, Eq(1)),
+                          Field(&XRayRecord::FuncId, Eq(1)),
+                          Field(&XRayRecord::FuncId, Eq(2)),
+                          Field(&XRayRecord::FuncId, Eq(2))));
+  EXPECT_THAT(streamThread(TS, 1),
+              ElementsAre(Field(&XRayRecord::FuncId, Eq(3)),
+                          Field(&XRayRecord::FuncId, Eq(3))));
+}
+
+// Streaming a thread must yield the same records as loading the whole trace.
+TEST(TraceStreamTest, MatchesLoadTraceVersion1) {
+  std::string Data;
+  raw_string_ostream OS(Data);
+  auto H = makeHeader(1);
+  constexpr uint64_t BufferSize = 4096;
+  std::memcpy(H.FreeFormData, reinterpret_cast<const char *>(&BufferSize),
+              sizeof(BufferSize));
+  FDRTraceWriter Writer(OS, H);
+  for (int32_t TId : {1, 2}) {
+    auto L = LogBuilder()
+                 .add<NewBufferRecord>(TId)
+                 .add<WallclockRecord>(1, 1)
+                 .add<NewCPUIDRecord>(1, 2)
+                 .add<FunctionRecord>(RecordTypes::ENTER, TId, 1)
+                 .add<FunctionRecord>(RecordTypes::EXIT, TId, 100)
+                 .add<EndBufferRecord>()
+                 .consume();
+    for (auto &P : L)
+      ASSERT_FALSE(errorToBool(P->apply(Writer)));
+    // Pad the buffer with 4016 (4096 - 80) bytes of zeros.
+    OS.write_zeros(4016);
+  }
+  OS.flush();
+
+  DataExtractor DE(Data, sys::IsLittleEndianHost, 8);
+  auto TraceOrErr = loadTrace(DE);
+  if (!TraceOrErr)
+    FAIL() << TraceOrErr.takeError();
+  auto StreamOrErr = openTraceStream(DE);
+  if (!StreamOrErr)
+    FAIL() << StreamOrErr.takeError();
+  auto &TS = **StreamOrErr;
+
+  ASSERT_THAT(TS.threads(), SizeIs(2u));
+  for (size_t I = 0; I != 2; ++I) {
+    std::vector<XRayRecord> Expected;
+    for (const auto &R : *TraceOrErr)
+      if (R.TId == static_cast<uint32_t>(TS.threads()[I].second))
+        Expected.push_back(R);
+    auto Streamed = streamThread(TS, I);
+    ASSERT_THAT(Streamed, SizeIs(Expected.size()));
+    for (size_t J = 0; J != Expected.size(); ++J) {
+      EXPECT_THAT(Streamed[J].Type, Eq(Expected[J].Type));
+      EXPECT_THAT(Streamed[J].FuncId, Eq(Expected[J].FuncId));
+      EXPECT_THAT(Streamed[J].TSC, Eq(Expected[J].TSC));
+      EXPECT_THAT(Streamed[J].CPU, Eq(Expected[J].CPU));
+    }
+  }
+}
+
+TEST(TraceStreamTest, CallbackErrorStopsStream) {
+  auto Data = writeVersion3Log();
+  DataExtractor DE(Data, sys::IsLittleEndianHost, 8);
+  auto StreamOrErr = openTraceStream(DE);
+  if (!StreamOrErr)
+    FAIL() << StreamOrErr.takeError();
+  auto &TS = **StreamOrErr;
+
+  size_t Seen = 0;
+  auto E = TS.forEachRecord([&](const XRayRecord &) -> Error {
+    ++Seen;
+    return createStringError(std::make_error_code(std::errc::invalid_argument),
+                             "stop");
+  });
+  EXPECT_TRUE(errorToBool(std::move(E)));
+  EXPECT_THAT(Seen, Eq(1u));
+}
+
+} // namespace
+} // namespace xray
+} // namespace llvm
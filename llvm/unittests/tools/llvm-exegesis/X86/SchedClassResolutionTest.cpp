@@ -108,6 +108,40 @@ TEST_F(SchedClassResolutionTest,
                                    Pair(P5Idx, 1.0), Pair(P6Idx, 1.0)));
 }
 
+TEST_F(SchedClassResolutionTest, ProposeProcResUsage_2P0) {
+  const auto Usage =
+      proposeProcResUsage(STI->getSchedModel(), {{P0Idx, 2.0}});
+  EXPECT_THAT(Usage, UnorderedElementsAre(Pair(P0Idx, 2u)));
+}
+
+TEST_F(SchedClassResolutionTest, ProposeProcResUsage_1P05) {
+  const auto Usage = proposeProcResUsage(STI->getSchedModel(),
+                                         {{P0Idx, 0.5}, {P5Idx, 0.5}});
+  EXPECT_THAT(Usage, UnorderedElementsAre(Pair(P05Idx, 1u)));
+}
+
+TEST_F(SchedClassResolutionTest, ProposeProcResUsage_IgnoresNoise) {
+  const auto Usage = proposeProcResUsage(
+      STI->getSchedModel(),
+      {{P0Idx, 1.0}, {P1Idx, 0.02}, {P5Idx, 1.0}, {P6Idx, 0.01}});
+  EXPECT_THAT(Usage, UnorderedElementsAre(Pair(P05Idx, 2u)));
+}
+
+TEST_F(SchedClassResolutionTest, ProposeProcResUsage_NoMatchingGroup) {
+  // There is no ProcResGroup for {P0, P1, P6} in the haswell model.
+  const auto Usage = proposeProcResUsage(
+      STI->getSchedModel(), {{P0Idx, 1.0}, {P1Idx, 1.0}, {P6Idx, 1.0}});
+  EXPECT_THAT(Usage, UnorderedElementsAre(Pair(P0Idx, 1u), Pair(P1Idx, 1u),
+                                          Pair(P6Idx, 1u)));
+}
+
+TEST_F(SchedClassResolutionTest, ProposeProcResUsage_0156) {
+  const auto Usage = proposeProcResUsage(
+      STI->getSchedModel(),
+      {{P0Idx, 0.75}, {P1Idx, 0.75}, {P5Idx, 0.75}, {P6Idx, 0.75}});
+  EXPECT_THAT(Usage, UnorderedElementsAre(Pair(P0156Idx, 3u)));
+}
+
 } // namespace
 } // namespace exegesis
 } // namespace llvm
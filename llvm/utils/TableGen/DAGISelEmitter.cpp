@@ -13,6 +13,7 @@
 #include "CodeGenDAGPatterns.h"
 #include "DAGISelMatcher.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/TableGen/Record.h"
 #include "llvm/TableGen/TableGenBackend.h"
 using namespace llvm;
@@ -163,27 +164,44 @@ void DAGISelEmitter::run(raw_ostream &OS) {
 
   // Convert each variant of each pattern into a Matcher.
   std::vector<Matcher*> PatternMatchers;
-  for (unsigned i = 0, e = Patterns.size(); i != e; ++i) {
-    for (unsigned Variant = 0; ; ++Variant) {
-      if (Matcher *M = ConvertPatternToMatcher(*Patterns[i], Variant, CGP))
-        PatternMatchers.push_back(M);
-      else
-        break;
+  {
+    NamedRegionTimer T("Convert to matchers",
+                       "Time spent converting patterns to matchers",
+                       "DAGISelEmitter", "DAGISelEmitter", TimeRegions);
+    for (unsigned i = 0, e = Patterns.size(); i != e; ++i) {
+      for (unsigned Variant = 0; ; ++Variant) {
+        if (Matcher *M = ConvertPatternToMatcher(*Patterns[i], Variant, CGP))
+          PatternMatchers.push_back(M);
+        else
+          break;
+      }
     }
   }
 
   std::unique_ptr<Matcher> TheMatcher =
     llvm::make_unique<ScopeMatcher>(PatternMatchers);
 
-  OptimizeMatcher(TheMatcher, CGP);
+  {
+    NamedRegionTimer T("Optimize matchers", "Time spent optimizing matchers",
+                       "DAGISelEmitter", "DAGISelEmitter", TimeRegions);
+    OptimizeMatcher(TheMatcher, CGP);
+  }
   //Matcher->dump();
+  NamedRegionTimer T("Emit matcher table", "Time spent emitting matcher table",
+                     "DAGISelEmitter", "DAGISelEmitter", TimeRegions);
   EmitMatcherTable(TheMatcher.get(), CGP, OS);
 }
 
 namespace llvm {
 
 void EmitDAGISel(RecordKeeper &RK, raw_ostream &OS) {
-  DAGISelEmitter(RK).run(OS);
+  std::unique_ptr<DAGISelEmitter> Emitter;
+  {
+    NamedRegionTimer T("Parse patterns", "Time spent parsing patterns",
+                       "DAGISelEmitter", "DAGISelEmitter", TimeRegions);
+    Emitter = llvm::make_unique<DAGISelEmitter>(RK);
+  }
+  Emitter->run(OS);
 }
 
 } // End llvm namespace
@@ -0,0 +1,391 @@
+//===- GICombinerEmitter.cpp - Generate a combiner ------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file Generate a combiner implementation for GlobalISel from a declarative
+/// syntax. See include/llvm/Target/GlobalISel/Combine.td.
+///
+/// For each GICombinerHelper named with -combiners, this emits a class with a
+/// tryCombineAll() that tries the rules of the helper in order on an
+/// instruction, skipping those whose opcodes do not match and those disabled
+/// on the command line.
+///
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/TableGen/Error.h"
+#include "llvm/TableGen/Record.h"
+#include "llvm/TableGen/TableGenBackend.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "gicombiner-emitter"
+
+STATISTIC(NumCombineRulesEmitted, "Number of combine rules emitted");
+
+cl::OptionCategory
+    GICombinerEmitterCat("Options for -gen-global-isel-combiner");
+static cl::list<std::string>
+    SelectedCombiners("combiners", cl::desc("Emit the specified combiners"),
+                      cl::cat(GICombinerEmitterCat), cl::CommaSeparated);
+
+namespace {
+
+/// A combine rule, as parsed from its GICombineRule record.
+class CombineRule {
+public:
+  CombineRule(unsigned ID, const Record &TheDef) : ID(ID), TheDef(TheDef) {}
+
+  /// Parses the defs, match and apply of the rule. Reports an error and
+  /// returns false if they are malformed.
+  bool parse();
+
+  unsigned getID() const { return ID; }
+  StringRef getName() const { return TheDef.getName(); }
+  const Record &getDef() const { return TheDef; }
+  ArrayRef<const Record *> getMatchOpcodes() const { return MatchOpcodes; }
+
+  /// Returns the code block of the match or apply with the ${name} references
+  /// replaced by the code for the named def.
+  std::string expandMatchCode() const { return expandCode(*MatchCode); }
+  std::string expandApplyCode() const { return expandCode(*ApplyCode); }
+
+  /// The type and the local variable of each GIDefMatchData.
+  std::vector<std::pair<std::string, std::string>> getMatchDataDecls() const;
+
+private:
+  std::string expandCode(const CodeInit &Code) const;
+
+  /// The index of the rule within its combiner, used for disabling it.
+  unsigned ID;
+  const Record &TheDef;
+  /// The name of the root def.
+  StringRef RootName;
+  /// The other defs, by name: the record of their GIDefMatchData.
+  StringMap<const Record *> MatchDatas;
+  /// The opcodes that the root must have, all of them if empty.
+  std::vector<const Record *> MatchOpcodes;
+  const CodeInit *MatchCode = nullptr;
+  const CodeInit *ApplyCode = nullptr;
+};
+
+} // end anonymous namespace
+
+/// Returns the trailing code block of \p D, whose operator must be
+/// \p Operator, after checking that its other arguments are records.
+static const CodeInit *getCodeBlock(const Record &TheDef, const DagInit &D,
+                                    StringRef Operator) {
+  const DefInit *OpDef = dyn_cast<DefInit>(D.getOperator());
+  if (!OpDef || OpDef->getDef()->getName() != Operator) {
+    PrintError(TheDef.getLoc(), "Expected the operator to be '" + Operator +
+                                    "'");
+    return nullptr;
+  }
+  const CodeInit *Code =
+      D.getNumArgs() ? dyn_cast<CodeInit>(D.getArg(D.getNumArgs() - 1))
+                     : nullptr;
+  if (!Code)
+    PrintError(TheDef.getLoc(),
+               "Expected '" + Operator + "' to end with a code block");
+  return Code;
+}
+
+bool CombineRule::parse() {
+  const DagInit *Defs = TheDef.getValueAsDag("Defs");
+  const DefInit *DefsOp = dyn_cast<DefInit>(Defs->getOperator());
+  if (!DefsOp || DefsOp->getDef()->getName() != "defs") {
+    PrintError(TheDef.getLoc(), "Expected the operator of Defs to be 'defs'");
+    return false;
+  }
+  for (unsigned I = 0, E = Defs->getNumArgs(); I != E; ++I) {
+    const DefInit *Kind = dyn_cast<DefInit>(Defs->getArg(I));
+    StringRef Name = Defs->getArgNameStr(I);
+    if (!Kind || !Kind->getDef()->isSubClassOf("GIDefKind") || Name.empty()) {
+      PrintError(TheDef.getLoc(),
+                 "Expected the defs to be named GIDefKinds, like root:$name");
+      return false;
+    }
+    const Record *KindDef = Kind->getDef();
+    if (KindDef->getName() == "root") {
+      if (!RootName.empty()) {
+        PrintError(TheDef.getLoc(), "Expected a single root");
+        return false;
+      }
+      RootName = Name;
+    } else if (KindDef->isSubClassOf("GIDefMatchData")) {
+      if (!MatchDatas.try_emplace(Name, KindDef).second) {
+        PrintError(TheDef.getLoc(), "Def '" + Name + "' is declared twice");
+        return false;
+      }
+    } else {
+      PrintError(TheDef.getLoc(),
+                 "Unsupported def kind '" + KindDef->getName() + "'");
+      return false;
+    }
+  }
+  if (RootName.empty()) {
+    PrintError(TheDef.getLoc(), "Combine rules must have a root");
+    return false;
+  }
+
+  const DagInit *Match = TheDef.getValueAsDag("Match");
+  MatchCode = getCodeBlock(TheDef, *Match, "match");
+  if (!MatchCode)
+    return false;
+  for (unsigned I = 0, E = Match->getNumArgs() - 1; I != E; ++I) {
+    const DefInit *Opcode = dyn_cast<DefInit>(Match->getArg(I));
+    if (!Opcode || !Opcode->getDef()->isSubClassOf("Instruction")) {
+      PrintError(TheDef.getLoc(),
+                 "Expected the match to begin with the opcodes of the root");
+      return false;
+    }
+    MatchOpcodes.push_back(Opcode->getDef());
+  }
+
+  const DagInit *Apply = TheDef.getValueAsDag("Apply");
+  ApplyCode = getCodeBlock(TheDef, *Apply, "apply");
+  if (!ApplyCode)
+    return false;
+  if (Apply->getNumArgs() != 1) {
+    PrintError(TheDef.getLoc(), "Expected the apply to be a code block");
+    return false;
+  }
+  return true;
+}
+
+std::vector<std::pair<std::string, std::string>>
+CombineRule::getMatchDataDecls() const {
+  std::vector<std::pair<std::string, std::string>> Decls;
+  for (const auto &MatchData : MatchDatas)
+    Decls.emplace_back(MatchData.second->getValueAsString("Type"),
+                       "MatchData" + MatchData.first().str());
+  // StringMap is unordered, keep the output stable.
+  llvm::sort(Decls);
+  return Decls;
+}
+
+std::string CombineRule::expandCode(const CodeInit &Code) const {
+  StringRef Input = Code.getValue();
+  std::string Result;
+  while (!Input.empty()) {
+    size_t Pos = Input.find("${");
+    Result += Input.substr(0, Pos);
+    if (Pos == StringRef::npos)
+      break;
+    Input = Input.substr(Pos + 2);
+    size_t End = Input.find('}');
+    if (End == StringRef::npos)
+      PrintFatalError(TheDef.getLoc(), "Unterminated ${ in a code block");
+    StringRef Name = Input.substr(0, End);
+    Input = Input.substr(End + 1);
+    if (Name == RootName)
+      Result += "MI";
+    else if (MatchDatas.count(Name))
+      Result += "MatchData" + Name.str();
+    else
+      PrintFatalError(TheDef.getLoc(),
+                      "Code block refers to unknown def '" + Name + "'");
+  }
+  return StringRef(Result).trim();
+}
+
+namespace {
+
+class GICombinerEmitter {
+  StringRef Name;
+  const Record &Combiner;
+  std::vector<std::unique_ptr<CombineRule>> Rules;
+
+public:
+  GICombinerEmitter(StringRef Name, const Record &Combiner)
+      : Name(Name), Combiner(Combiner) {}
+
+  /// Flattens the groups of the combiner into its list of rules, and parses
+  /// them. Returns false on errors.
+  bool gatherRules();
+
+  void run(raw_ostream &OS);
+
+private:
+  bool gatherRules(const std::vector<Record *> &RuleOrGroups,
+                   SmallPtrSetImpl<const Record *> &Seen);
+  StringRef getClassName() const {
+    return Combiner.getValueAsString("Classname");
+  }
+  void emitHeader(raw_ostream &OS);
+  void emitRuleConfig(raw_ostream &OS);
+  void emitTryCombineAll(raw_ostream &OS);
+};
+
+} // end anonymous namespace
+
+bool GICombinerEmitter::gatherRules(const std::vector<Record *> &RuleOrGroups,
+                                    SmallPtrSetImpl<const Record *> &Seen) {
+  for (const Record *R : RuleOrGroups) {
+    if (R->isSubClassOf("GICombineGroup")) {
+      if (!gatherRules(R->getValueAsListOfDefs("Rules"), Seen))
+        return false;
+      continue;
+    }
+    if (!R->isSubClassOf("GICombineRule")) {
+      PrintError(R->getLoc(), "Expected a GICombineRule or a GICombineGroup");
+      return false;
+    }
+    // A rule may be in several of the groups that a combiner picks, it is only
+    // tried at its first position.
+    if (!Seen.insert(R).second)
+      continue;
+    Rules.push_back(llvm::make_unique<CombineRule>(Rules.size(), *R));
+    if (!Rules.back()->parse())
+      return false;
+  }
+  return true;
+}
+
+bool GICombinerEmitter::gatherRules() {
+  SmallPtrSet<const Record *, 32> Seen;
+  return gatherRules(Combiner.getValueAsListOfDefs("Rules"), Seen);
+}
+
+void GICombinerEmitter::emitHeader(raw_ostream &OS) {
+  StringRef ClassName = getClassName();
+  OS << "#ifdef " << Name.upper() << "_GENCOMBINERHELPER_H\n"
+     << "class " << ClassName << "RuleConfig {\n"
+     << "  BitVector DisabledRules;\n\n"
+     << "public:\n"
+     << "  " << ClassName << "RuleConfig();\n"
+     << "  /// Disables the rule of the given name, or all of them for \"*\".\n"
+     << "  /// Returns false if there is no such rule.\n"
+     << "  bool setRuleDisabled(StringRef RuleName);\n"
+     << "  bool isRuleDisabled(unsigned RuleID) const {\n"
+     << "    return DisabledRules.test(RuleID);\n"
+     << "  }\n"
+     << "};\n\n"
+     << "class " << ClassName << " {\n"
+     << "  const " << ClassName << "RuleConfig *RuleConfig;\n\n"
+     << "public:\n"
+     << "  " << ClassName << "(const " << ClassName
+     << "RuleConfig &RuleConfig) : RuleConfig(&RuleConfig) {}\n\n"
+     << "  bool tryCombineAll(GISelChangeObserver &Observer, MachineInstr &MI,\n"
+     << "                     MachineIRBuilder &B, CombinerHelper &Helper) "
+        "const;\n"
+     << "};\n"
+     << "#endif // ifdef " << Name.upper() << "_GENCOMBINERHELPER_H\n\n";
+}
+
+void GICombinerEmitter::emitRuleConfig(raw_ostream &OS) {
+  StringRef ClassName = getClassName();
+  bool HasOption = !Combiner.isValueUnset("DisableRuleOption");
+  if (HasOption)
+    OS << "static cl::list<std::string> " << ClassName << "DisableOption(\n"
+       << "    \"" << Combiner.getValueAsString("DisableRuleOption") << "\",\n"
+       << "    cl::desc(\"Disable one or more combiner rules temporarily in "
+       << "the " << ClassName << " pass\"),\n"
+       << "    cl::CommaSeparated, cl::Hidden);\n\n";
+
+  OS << ClassName << "RuleConfig::" << ClassName << "RuleConfig()\n"
+     << "    : DisabledRules(" << Rules.size() << ") {\n";
+  if (HasOption)
+    OS << "  for (const std::string &RuleName : " << ClassName
+       << "DisableOption)\n"
+       << "    if (!setRuleDisabled(RuleName))\n"
+       << "      report_fatal_error(\"Invalid rule identifier: \" + "
+          "RuleName);\n";
+  OS << "}\n\n";
+
+  OS << "bool " << ClassName
+     << "RuleConfig::setRuleDisabled(StringRef RuleName) {\n"
+     << "  if (RuleName == \"*\") {\n"
+     << "    DisabledRules.set();\n"
+     << "    return true;\n"
+     << "  }\n"
+     << "  int RuleID = StringSwitch<int>(RuleName)\n";
+  for (const auto &Rule : Rules)
+    OS << "      .Case(\"" << Rule->getName() << "\", " << Rule->getID()
+       << ")\n";
+  OS << "      .Default(-1);\n"
+     << "  if (RuleID < 0)\n"
+     << "    return false;\n"
+     << "  DisabledRules.set(RuleID);\n"
+     << "  return true;\n"
+     << "}\n\n";
+}
+
+void GICombinerEmitter::emitTryCombineAll(raw_ostream &OS) {
+  OS << "bool " << getClassName()
+     << "::tryCombineAll(GISelChangeObserver &Observer, MachineInstr &MI,\n"
+     << "    MachineIRBuilder &B, CombinerHelper &Helper) const {\n"
+     << "  (void)Observer;\n"
+     << "  (void)B;\n"
+     << "  unsigned Opcode = MI.getOpcode();\n"
+     << "  (void)Opcode;\n\n";
+
+  for (const auto &Rule : Rules) {
+    OS << "  // Rule: " << Rule->getName() << "\n"
+       << "  if (!RuleConfig->isRuleDisabled(" << Rule->getID() << ")";
+    ArrayRef<const Record *> Opcodes = Rule->getMatchOpcodes();
+    if (!Opcodes.empty()) {
+      OS << " &&\n      (";
+      for (const Record *Opcode : Opcodes) {
+        if (Opcode != Opcodes.front())
+          OS << " ||\n       ";
+        OS << "Opcode == " << Opcode->getValueAsString("Namespace")
+           << "::" << Opcode->getName();
+      }
+      OS << ")";
+    }
+    OS << ") {\n";
+    for (const auto &Decl : Rule->getMatchDataDecls())
+      OS << "    " << Decl.first << " " << Decl.second << ";\n";
+    OS << "    auto Match = [&]() -> bool {\n"
+       << "      " << Rule->expandMatchCode() << "\n"
+       << "    };\n"
+       << "    if (Match()) {\n"
+       << "      " << Rule->expandApplyCode() << "\n"
+       << "      return true;\n"
+       << "    }\n"
+       << "  }\n\n";
+    ++NumCombineRulesEmitted;
+  }
+
+  OS << "  return false;\n"
+     << "}\n";
+}
+
+void GICombinerEmitter::run(raw_ostream &OS) {
+  emitHeader(OS);
+  OS << "#ifdef " << Name.upper() << "_GENCOMBINERHELPER_CPP\n";
+  emitRuleConfig(OS);
+  emitTryCombineAll(OS);
+  OS << "#endif // ifdef " << Name.upper() << "_GENCOMBINERHELPER_CPP\n";
+}
+
+namespace llvm {
+
+void EmitGICombiner(RecordKeeper &RK, raw_ostream &OS) {
+  emitSourceFileHeader("Global Combiner", OS);
+
+  if (SelectedCombiners.empty())
+    PrintFatalError("No combiners selected with -combiners");
+  for (const std::string &Combiner : SelectedCombiners) {
+    Record *CombinerDef = RK.getDef(Combiner);
+    if (!CombinerDef || !CombinerDef->isSubClassOf("GICombinerHelper"))
+      PrintFatalError("Could not find GICombinerHelper '" + Combiner + "'");
+    GICombinerEmitter Emitter(Combiner, *CombinerDef);
+    if (!Emitter.gatherRules())
+      PrintFatalError(CombinerDef->getLoc(),
+                      "Failed to parse the rules of the combiner");
+    Emitter.run(OS);
+  }
+}
+
+} // end namespace llvm
@@ -40,6 +40,7 @@
 #include "llvm/Support/LowLevelTypeImpl.h"
 #include "llvm/Support/MachineValueType.h"
 #include "llvm/Support/ScopedPrinter.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/TableGen/Error.h"
 #include "llvm/TableGen/Record.h"
 #include "llvm/TableGen/TableGenBackend.h"
@@ -4290,6 +4291,9 @@ void GlobalISelEmitter::run(raw_ostream &OS) {
   emitSourceFileHeader(("Global Instruction Selector for the " +
                        Target.getName() + " target").str(), OS);
   std::vector<RuleMatcher> Rules;
+  Optional<NamedRegionTimer> ImportTimer;
+  ImportTimer.emplace("Import patterns", "Time spent importing patterns",
+                      "GlobalISelEmitter", "GlobalISelEmitter", TimeRegions);
   // Look through the SelectionDAG patterns we found, possibly emitting some.
   for (const PatternToMatch &Pat : CGP.ptms()) {
     ++NumPatternTotal;
@@ -4318,6 +4322,7 @@ void GlobalISelEmitter::run(raw_ostream &OS) {
     }
     Rules.push_back(std::move(MatcherOrErr.get()));
   }
+  ImportTimer.reset();
 
   // Comparison function to order records by name.
   auto orderByName = [](const Record *A, const Record *B) {
@@ -4559,8 +4564,12 @@ void GlobalISelEmitter::run(raw_ostream &OS) {
      << "  return false;\n"
      << "}\n\n";
 
+  Optional<NamedRegionTimer> BuildTimer;
+  BuildTimer.emplace("Build match table", "Time spent building match table",
+                     "GlobalISelEmitter", "GlobalISelEmitter", TimeRegions);
   const MatchTable Table =
       buildMatchTable(Rules, OptimizeMatchTable, GenerateCoverage);
+  BuildTimer.reset();
   OS << "const int64_t *" << Target.getName()
      << "InstructionSelector::getMatchTable() const {\n";
   Table.emitDeclaration(OS);
@@ -4885,6 +4894,12 @@ unsigned OperandMatcher::getInsnVarID() const { return Insn.getInsnVarID(); }
 
 namespace llvm {
 void EmitGlobalISel(RecordKeeper &RK, raw_ostream &OS) {
-  GlobalISelEmitter(RK).run(OS);
+  std::unique_ptr<GlobalISelEmitter> Emitter;
+  {
+    NamedRegionTimer T("Parse patterns", "Time spent parsing patterns",
+                       "GlobalISelEmitter", "GlobalISelEmitter", TimeRegions);
+    Emitter = llvm::make_unique<GlobalISelEmitter>(RK);
+  }
+  Emitter->run(OS);
 }
 } // End llvm namespace
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "TableGenBackends.h" // Declares all backends.
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/PrettyStackTrace.h"
@@ -49,6 +50,7 @@ enum ActionType {
   GenAttributes,
   GenSearchableTables,
   GenGlobalISel,
+  GenGICombiner,
   GenX86EVEX2VEXTables,
   GenX86FoldTables,
   GenRegisterBank,
@@ -118,6 +120,8 @@ namespace {
                                "Generate generic binary-searchable table"),
                     clEnumValN(GenGlobalISel, "gen-global-isel",
                                "Generate GlobalISel selector"),
+                    clEnumValN(GenGICombiner, "gen-global-isel-combiner",
+                               "Generate GlobalISel combiner"),
                     clEnumValN(GenX86EVEX2VEXTables, "gen-x86-EVEX2VEX-tables",
                                "Generate X86 EVEX to VEX compress tables"),
                     clEnumValN(GenX86FoldTables, "gen-x86-fold-tables",
@@ -137,8 +141,21 @@ cl::opt<bool, true>
                    cl::desc("Time regions of tablegens execution"),
                    cl::location(TimeRegions));
 
-bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
-  switch (Action) {
+cl::list<std::string>
+    ExtraOutputs("emit", cl::value_desc("action=filename"),
+                 cl::desc("Also perform <action> (e.g. gen-dag-isel) on the "
+                          "parsed records and write the output to "
+                          "<filename>. May be given several times"));
+
+cl::opt<unsigned>
+    NumThreads("num-threads", cl::init(1),
+               cl::desc("Number of threads to emit the -o and -emit outputs "
+                        "on (0 = one per hardware thread)"));
+cl::alias NumThreadsA("j", cl::desc("Alias for -num-threads"),
+                      cl::aliasopt(NumThreads));
+
+bool emitAction(ActionType A, raw_ostream &OS, RecordKeeper &Records) {
+  switch (A) {
   case PrintRecords:
     OS << Records;           // No argument, dump all contents
     break;
@@ -235,6 +252,9 @@ bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
   case GenGlobalISel:
     EmitGlobalISel(Records, OS);
     break;
+  case GenGICombiner:
+    EmitGICombiner(Records, OS);
+    break;
   case GenRegisterBank:
     EmitRegisterBank(Records, OS);
     break;
@@ -251,7 +271,17 @@ bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
 
   return false;
 }
+
+bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
+  return emitAction(Action, OS, Records);
+}
+
+/// These backends rewrite the instruction encodings in the records, so they
+/// cannot share the records with other backends.
+bool rewritesRecords(ActionType A) {
+  return A == GenEmitter || A == GenDisassembler;
 }
+} // end anonymous namespace
 
 int main(int argc, char **argv) {
   sys::PrintStackTraceOnErrorSignal(argv[0]);
@@ -260,7 +290,40 @@ int main(int argc, char **argv) {
 
   llvm_shutdown_obj Y;
 
-  return TableGenMain(argv[0], &LLVMTableGenMain);
+  if (ExtraOutputs.empty())
+    return TableGenMain(argv[0], &LLVMTableGenMain);
+
+  std::vector<ActionType> Actions = {Action};
+  std::vector<TableGenOutput> Outputs;
+  for (StringRef Arg : ExtraOutputs) {
+    std::pair<StringRef, StringRef> NameAndFile = Arg.split('=');
+    ActionType A;
+    if (NameAndFile.second.empty()) {
+      ExtraOutputs.error("expected <action>=<filename>, got '" + Arg + "'");
+      return 1;
+    }
+    if (Action.getParser().parse(ExtraOutputs, NameAndFile.first, "", A))
+      return 1;
+    if (is_contained(Actions, A)) {
+      ExtraOutputs.error("'" + NameAndFile.first + "' is emitted twice");
+      return 1;
+    }
+    Actions.push_back(A);
+    Outputs.push_back({NameAndFile.second, [A](raw_ostream &OS,
+                                               RecordKeeper &Records) {
+                         return emitAction(A, OS, Records);
+                       }});
+  }
+  if (any_of(Actions, rewritesRecords)) {
+    ExtraOutputs.error("-gen-emitter and -gen-disassembler cannot be combined "
+                       "with other backends");
+    return 1;
+  }
+
+  // The region timers are shared by the backends, so only time them one at a
+  // time.
+  unsigned Threads = TimeRegions ? 1 : NumThreads;
+  return TableGenMain(argv[0], &LLVMTableGenMain, Outputs, Threads);
 }
 
 #ifdef __has_feature
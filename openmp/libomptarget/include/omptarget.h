@@ -109,6 +109,13 @@ struct __tgt_target_table {
       *EntriesEnd; // End of the table with all the entries (non inclusive)
 };
 
+/// This struct holds the queue (e.g. a CUDA stream) the transfers and the
+/// launch of one target region are issued on. The target RTL picks a queue on
+/// first use and is done with it once the queue has been synchronized.
+struct __tgt_async_info {
+  void *Queue; // Queue of the target RTL, NULL until first used
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
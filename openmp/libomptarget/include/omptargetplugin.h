@@ -84,6 +84,37 @@ int32_t __tgt_rtl_run_target_team_region(int32_t ID, void *Entry, void **Args,
                                          int32_t NumTeams, int32_t ThreadLimit,
                                          uint64_t loop_tripcount);
 
+// Asynchronous versions of __tgt_rtl_data_submit, __tgt_rtl_data_retrieve,
+// __tgt_rtl_run_target_region and __tgt_rtl_run_target_team_region. They are
+// optional; unless an RTL provides all of them and __tgt_rtl_synchronize,
+// libomptarget uses the synchronous functions. Operations issued with the same
+// AsyncInfo are executed in order, but none of them has necessarily completed,
+// and the host memory they read or write may not be touched, until
+// __tgt_rtl_synchronize returns for that AsyncInfo. In case of success return
+// zero. Otherwise, return an error code.
+int32_t __tgt_rtl_data_submit_async(int32_t ID, void *TargetPtr, void *HostPtr,
+                                    int64_t Size,
+                                    __tgt_async_info *AsyncInfo);
+
+int32_t __tgt_rtl_data_retrieve_async(int32_t ID, void *HostPtr,
+                                      void *TargetPtr, int64_t Size,
+                                      __tgt_async_info *AsyncInfo);
+
+int32_t __tgt_rtl_run_target_region_async(int32_t ID, void *Entry,
+                                          void **Args, ptrdiff_t *Offsets,
+                                          int32_t NumArgs,
+                                          __tgt_async_info *AsyncInfo);
+
+int32_t __tgt_rtl_run_target_team_region_async(
+    int32_t ID, void *Entry, void **Args, ptrdiff_t *Offsets, int32_t NumArgs,
+    int32_t NumTeams, int32_t ThreadLimit, uint64_t loop_tripcount,
+    __tgt_async_info *AsyncInfo);
+
+// Wait until all operations issued with AsyncInfo have completed. Errors of
+// any of them, e.g. a failing kernel, are reported here. In case of success
+// return zero. Otherwise, return an error code.
+int32_t __tgt_rtl_synchronize(int32_t ID, __tgt_async_info *AsyncInfo);
+
 #ifdef __cplusplus
 }
 #endif
@@ -10,10 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cuda.h>
 #include <list>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -98,6 +100,11 @@ public:
   std::vector<CUmodule> Modules;
   std::vector<CUcontext> Contexts;
 
+  // Streams target regions are issued on, handed out in turn, so that regions
+  // launched by different host threads can overlap.
+  std::vector<std::vector<CUstream>> Streams;
+  std::unique_ptr<std::atomic<unsigned>[]> NextStream;
+
   // Device properties
   std::vector<int> ThreadsPerBlock;
   std::vector<int> BlocksPerGrid;
@@ -110,12 +117,14 @@ public:
   // OpenMP Environment properties
   int EnvNumTeams;
   int EnvTeamLimit;
+  int EnvNumStreams;
 
   //static int EnvNumThreads;
   static const int HardTeamLimit = 1<<16; // 64k
   static const int HardThreadLimit = 1024;
   static const int DefaultNumTeams = 128;
   static const int DefaultNumThreads = 128;
+  static const int DefaultNumStreams = 32;
 
   // Record entry point associated with device
   void addOffloadEntry(int32_t device_id, __tgt_offload_entry entry) {
@@ -162,6 +171,16 @@ public:
     return &E.Table;
   }
 
+  // Return the stream of AsyncInfo, picking one if it has none yet
+  CUstream getStream(int32_t device_id, __tgt_async_info *AsyncInfo) {
+    assert(AsyncInfo && "AsyncInfo is nullptr");
+    if (!AsyncInfo->Queue) {
+      std::vector<CUstream> &S = Streams[device_id];
+      AsyncInfo->Queue = S[NextStream[device_id]++ % S.size()];
+    }
+    return (CUstream)AsyncInfo->Queue;
+  }
+
   // Clear entries table for a device
   void clearOffloadEntriesTable(int32_t device_id) {
     assert(device_id < (int32_t)FuncGblEntries.size() &&
@@ -204,6 +223,8 @@ public:
 
     FuncGblEntries.resize(NumberOfDevices);
     Contexts.resize(NumberOfDevices);
+    Streams.resize(NumberOfDevices);
+    NextStream.reset(new std::atomic<unsigned>[NumberOfDevices]());
     ThreadsPerBlock.resize(NumberOfDevices);
     BlocksPerGrid.resize(NumberOfDevices);
     WarpSize.resize(NumberOfDevices);
@@ -227,6 +248,14 @@ public:
     } else {
       EnvNumTeams = -1;
     }
+    envStr = getenv("LIBOMPTARGET_NUM_STREAMS");
+    if (envStr) {
+      // LIBOMPTARGET_NUM_STREAMS has been set
+      EnvNumStreams = std::stoi(envStr);
+      DP("Parsed LIBOMPTARGET_NUM_STREAMS=%d\n", EnvNumStreams);
+    } else {
+      EnvNumStreams = -1;
+    }
   }
 
   ~RTLDeviceInfoTy() {
@@ -240,6 +269,19 @@ public:
         }
       }
 
+    // Destroy streams
+    for (size_t i = 0; i < Streams.size(); ++i) {
+      if (Streams[i].empty() || cuCtxSetCurrent(Contexts[i]) != CUDA_SUCCESS)
+        continue;
+      for (auto &stream : Streams[i]) {
+        CUresult err = cuStreamDestroy(stream);
+        if (err != CUDA_SUCCESS) {
+          DP("Error when destroying CUDA stream\n");
+          CUDA_ERR_STRING(err);
+        }
+      }
+    }
+
     // Destroy contexts
     for (auto &ctx : Contexts)
       if (ctx) {
@@ -284,6 +326,26 @@ int32_t __tgt_rtl_init_device(int32_t device_id) {
     return OFFLOAD_FAIL;
   }
 
+  // Create the streams. They synchronize with the default stream, which the
+  // synchronous transfers still use.
+  int numStreams = DeviceInfo.EnvNumStreams > 0
+                       ? DeviceInfo.EnvNumStreams
+                       : RTLDeviceInfoTy::DefaultNumStreams;
+  std::vector<CUstream> &streams = DeviceInfo.Streams[device_id];
+  streams.resize(numStreams);
+  for (int i = 0; i < numStreams; ++i) {
+    err = cuStreamCreate(&streams[i], CU_STREAM_DEFAULT);
+    if (err != CUDA_SUCCESS) {
+      DP("Error when creating a CUDA stream\n");
+      CUDA_ERR_STRING(err);
+      while (i > 0)
+        cuStreamDestroy(streams[--i]);
+      streams.clear();
+      return OFFLOAD_FAIL;
+    }
+  }
+  DP("Created %d CUDA streams\n", numStreams);
+
   // Query attributes to determine number of threads/block and blocks/grid.
   int maxGridDimX;
   err = cuDeviceGetAttribute(&maxGridDimX, CU_DEVICE_ATTRIBUTE_MAX_GRID_DIM_X,
@@ -588,6 +650,28 @@ int32_t __tgt_rtl_data_submit(int32_t device_id, void *tgt_ptr, void *hst_ptr,
   return OFFLOAD_SUCCESS;
 }
 
+int32_t __tgt_rtl_data_submit_async(int32_t device_id, void *tgt_ptr,
+    void *hst_ptr, int64_t size, __tgt_async_info *async_info) {
+  // Set the context we are using.
+  CUresult err = cuCtxSetCurrent(DeviceInfo.Contexts[device_id]);
+  if (err != CUDA_SUCCESS) {
+    DP("Error when setting CUDA context\n");
+    CUDA_ERR_STRING(err);
+    return OFFLOAD_FAIL;
+  }
+
+  CUstream stream = DeviceInfo.getStream(device_id, async_info);
+  err = cuMemcpyHtoDAsync((CUdeviceptr)tgt_ptr, hst_ptr, size, stream);
+  if (err != CUDA_SUCCESS) {
+    DP("Error when copying data from host to device. Pointers: host = " DPxMOD
+       ", device = " DPxMOD ", size = %" PRId64 "\n", DPxPTR(hst_ptr),
+       DPxPTR(tgt_ptr), size);
+    CUDA_ERR_STRING(err);
+    return OFFLOAD_FAIL;
+  }
+  return OFFLOAD_SUCCESS;
+}
+
 int32_t __tgt_rtl_data_retrieve(int32_t device_id, void *hst_ptr, void *tgt_ptr,
     int64_t size) {
   // Set the context we are using.
@@ -609,6 +693,28 @@ int32_t __tgt_rtl_data_retrieve(int32_t device_id, void *hst_ptr, void *tgt_ptr,
   return OFFLOAD_SUCCESS;
 }
 
+int32_t __tgt_rtl_data_retrieve_async(int32_t device_id, void *hst_ptr,
+    void *tgt_ptr, int64_t size, __tgt_async_info *async_info) {
+  // Set the context we are using.
+  CUresult err = cuCtxSetCurrent(DeviceInfo.Contexts[device_id]);
+  if (err != CUDA_SUCCESS) {
+    DP("Error when setting CUDA context\n");
+    CUDA_ERR_STRING(err);
+    return OFFLOAD_FAIL;
+  }
+
+  CUstream stream = DeviceInfo.getStream(device_id, async_info);
+  err = cuMemcpyDtoHAsync(hst_ptr, (CUdeviceptr)tgt_ptr, size, stream);
+  if (err != CUDA_SUCCESS) {
+    DP("Error when copying data from device to host. Pointers: host = " DPxMOD
+        ", device = " DPxMOD ", size = %" PRId64 "\n", DPxPTR(hst_ptr),
+        DPxPTR(tgt_ptr), size);
+    CUDA_ERR_STRING(err);
+    return OFFLOAD_FAIL;
+  }
+  return OFFLOAD_SUCCESS;
+}
+
 int32_t __tgt_rtl_data_delete(int32_t device_id, void *tgt_ptr) {
   // Set the context we are using.
   CUresult err = cuCtxSetCurrent(DeviceInfo.Contexts[device_id]);
@@ -627,9 +733,10 @@ int32_t __tgt_rtl_data_delete(int32_t device_id, void *tgt_ptr) {
   return OFFLOAD_SUCCESS;
 }
 
-int32_t __tgt_rtl_run_target_team_region(int32_t device_id, void *tgt_entry_ptr,
-    void **tgt_args, ptrdiff_t *tgt_offsets, int32_t arg_num, int32_t team_num,
-    int32_t thread_limit, uint64_t loop_tripcount) {
+int32_t __tgt_rtl_run_target_team_region_async(int32_t device_id,
+    void *tgt_entry_ptr, void **tgt_args, ptrdiff_t *tgt_offsets,
+    int32_t arg_num, int32_t team_num, int32_t thread_limit,
+    uint64_t loop_tripcount, __tgt_async_info *async_info) {
   // Set the context we are using.
   CUresult err = cuCtxSetCurrent(DeviceInfo.Contexts[device_id]);
   if (err != CUDA_SUCCESS) {
@@ -725,8 +832,12 @@ int32_t __tgt_rtl_run_target_team_region(int32_t device_id, void *tgt_entry_ptr,
   DP("Launch kernel with %d blocks and %d threads\n", cudaBlocksPerGrid,
      cudaThreadsPerBlock);
 
+  // The kernel arguments are copied by cuLaunchKernel, so args and ptrs may
+  // go away before the kernel runs.
+  CUstream stream = DeviceInfo.getStream(device_id, async_info);
   err = cuLaunchKernel(KernelInfo->Func, cudaBlocksPerGrid, 1, 1,
-      cudaThreadsPerBlock, 1, 1, 0 /*bytes of shared memory*/, 0, &args[0], 0);
+      cudaThreadsPerBlock, 1, 1, 0 /*bytes of shared memory*/, stream,
+      &args[0], 0);
   if (err != CUDA_SUCCESS) {
     DP("Device kernel launch failed!\n");
     CUDA_ERR_STRING(err);
@@ -736,16 +847,36 @@ int32_t __tgt_rtl_run_target_team_region(int32_t device_id, void *tgt_entry_ptr,
   DP("Launch of entry point at " DPxMOD " successful!\n",
       DPxPTR(tgt_entry_ptr));
 
-  CUresult sync_err = cuCtxSynchronize();
-  if (sync_err != CUDA_SUCCESS) {
+  return OFFLOAD_SUCCESS;
+}
+
+int32_t __tgt_rtl_run_target_team_region(int32_t device_id, void *tgt_entry_ptr,
+    void **tgt_args, ptrdiff_t *tgt_offsets, int32_t arg_num, int32_t team_num,
+    int32_t thread_limit, uint64_t loop_tripcount) {
+  __tgt_async_info async_info = {};
+  int32_t rc = __tgt_rtl_run_target_team_region_async(device_id, tgt_entry_ptr,
+      tgt_args, tgt_offsets, arg_num, team_num, thread_limit, loop_tripcount,
+      &async_info);
+  if (rc != OFFLOAD_SUCCESS)
+    return rc;
+
+  rc = __tgt_rtl_synchronize(device_id, &async_info);
+  if (rc != OFFLOAD_SUCCESS) {
     DP("Kernel execution error at " DPxMOD "!\n", DPxPTR(tgt_entry_ptr));
-    CUDA_ERR_STRING(sync_err);
-    return OFFLOAD_FAIL;
   } else {
     DP("Kernel execution at " DPxMOD " successful!\n", DPxPTR(tgt_entry_ptr));
   }
+  return rc;
+}
 
-  return OFFLOAD_SUCCESS;
+int32_t __tgt_rtl_run_target_region_async(int32_t device_id,
+    void *tgt_entry_ptr, void **tgt_args, ptrdiff_t *tgt_offsets,
+    int32_t arg_num, __tgt_async_info *async_info) {
+  // use one team and the default number of threads.
+  const int32_t team_num = 1;
+  const int32_t thread_limit = 0;
+  return __tgt_rtl_run_target_team_region_async(device_id, tgt_entry_ptr,
+      tgt_args, tgt_offsets, arg_num, team_num, thread_limit, 0, async_info);
 }
 
 int32_t __tgt_rtl_run_target_region(int32_t device_id, void *tgt_entry_ptr,
@@ -757,6 +888,24 @@ int32_t __tgt_rtl_run_target_region(int32_t device_id, void *tgt_entry_ptr,
       tgt_offsets, arg_num, team_num, thread_limit, 0);
 }
 
+int32_t __tgt_rtl_synchronize(int32_t device_id,
+    __tgt_async_info *async_info) {
+  assert(async_info && "async_info is nullptr");
+  // Nothing was issued with it.
+  if (!async_info->Queue)
+    return OFFLOAD_SUCCESS;
+
+  CUstream stream = (CUstream)async_info->Queue;
+  async_info->Queue = nullptr;
+  CUresult err = cuStreamSynchronize(stream);
+  if (err != CUDA_SUCCESS) {
+    DP("Error when synchronizing CUDA stream " DPxMOD "\n", DPxPTR(stream));
+    CUDA_ERR_STRING(err);
+    return OFFLOAD_FAIL;
+  }
+  return OFFLOAD_SUCCESS;
+}
+
 #ifdef __cplusplus
 }
 #endif
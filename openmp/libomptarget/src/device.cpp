@@ -21,6 +21,9 @@
 /// Map between Device ID (i.e. openmp device id) and its DeviceTy.
 DevicesTy Devices;
 
+int64_t DevicePoolLimit = (int64_t)1 << 30;
+int64_t DevicePoolMaxBlock = (int64_t)1 << 28;
+
 int DeviceTy::associatePtr(void *HstPtrBegin, void *TgtPtrBegin, int64_t Size) {
   DataMapMtx.lock();
 
@@ -185,7 +188,7 @@ void *DeviceTy::getOrAllocTgtPtr(void *HstPtrBegin, void *HstPtrBase,
   } else if (Size) {
     // If it is not contained and Size > 0 we should create a new entry for it.
     IsNew = true;
-    uintptr_t tp = (uintptr_t)RTL->data_alloc(RTLDeviceID, Size, HstPtrBegin);
+    uintptr_t tp = (uintptr_t)allocData(Size, HstPtrBegin);
     DP("Creating new map entry: HstBase=" DPxMOD ", HstBegin=" DPxMOD ", "
         "HstEnd=" DPxMOD ", TgtBegin=" DPxMOD "\n", DPxPTR(HstPtrBase),
         DPxPTR(HstPtrBegin), DPxPTR((uintptr_t)HstPtrBegin + Size), DPxPTR(tp));
@@ -256,7 +259,7 @@ int DeviceTy::deallocTgtPtr(void *HstPtrBegin, int64_t Size, bool ForceDelete) {
       assert(HT.RefCount == 0 && "did not expect a negative ref count");
       DP("Deleting tgt data " DPxMOD " of size %ld\n",
           DPxPTR(HT.TgtPtrBegin), Size);
-      RTL->data_delete(RTLDeviceID, (void *)HT.TgtPtrBegin);
+      deleteData((void *)HT.TgtPtrBegin);
       DP("Removing%s mapping with HstPtrBegin=" DPxMOD ", TgtPtrBegin=" DPxMOD
           ", Size=%ld\n", (ForceDelete ? " (forced)" : ""),
           DPxPTR(HT.HstPtrBegin), DPxPTR(HT.TgtPtrBegin), Size);
@@ -273,6 +276,89 @@ int DeviceTy::deallocTgtPtr(void *HstPtrBegin, int64_t Size, bool ForceDelete) {
   return rc;
 }
 
+// Blocks are never smaller than this.
+static const int64_t MinPoolBlock = 256;
+
+// Round Size up to its size class. Each power of two is split in quarters, so
+// that less than a fifth of a block goes unused.
+static int64_t getSizeClass(int64_t Size) {
+  if (Size <= MinPoolBlock)
+    return MinPoolBlock;
+  int Log2 = 63 - __builtin_clzll((uint64_t)Size - 1);
+  int64_t Quarter = (int64_t)1 << (Log2 - 2);
+  return (Size + Quarter - 1) & ~(Quarter - 1);
+}
+
+// Used by getOrAllocTgtPtr and target for (first-)private arrays.
+// Return a free block of the size class of Size if there is one, otherwise
+// new device memory. If the device is out of memory, give the free blocks
+// back to the RTL and try again.
+void *DeviceTy::allocData(int64_t Size, void *HstPtr) {
+  int64_t Class = getSizeClass(Size);
+  if (DevicePoolLimit <= 0 || Class > DevicePoolMaxBlock)
+    return RTL->data_alloc(RTLDeviceID, Size, HstPtr);
+
+  PoolMtx.lock();
+  auto It = FreeBlocks.find(Class);
+  if (It != FreeBlocks.end() && !It->second.empty()) {
+    void *TgtPtr = It->second.back();
+    It->second.pop_back();
+    FreeBytes -= Class;
+    PoolMtx.unlock();
+    DP("Reusing %" PRId64 " bytes of device memory at " DPxMOD " for %" PRId64
+        " bytes\n", Class, DPxPTR(TgtPtr), Size);
+    return TgtPtr;
+  }
+  PoolMtx.unlock();
+
+  void *TgtPtr = RTL->data_alloc(RTLDeviceID, Class, HstPtr);
+  if (!TgtPtr) {
+    std::map<int64_t, std::vector<void *>> Blocks;
+    PoolMtx.lock();
+    DP("Device allocation failed, releasing %" PRId64 " bytes of free device "
+        "memory\n", FreeBytes);
+    Blocks.swap(FreeBlocks);
+    for (auto &B : Blocks)
+      for (void *Ptr : B.second)
+        BlockSizes.erase(Ptr);
+    FreeBytes = 0;
+    PoolMtx.unlock();
+    for (auto &B : Blocks)
+      for (void *Ptr : B.second)
+        RTL->data_delete(RTLDeviceID, Ptr);
+    TgtPtr = RTL->data_alloc(RTLDeviceID, Class, HstPtr);
+    if (!TgtPtr)
+      return NULL;
+  }
+  PoolMtx.lock();
+  BlockSizes[TgtPtr] = Class;
+  PoolMtx.unlock();
+  return TgtPtr;
+}
+
+// Keep a block from allocData for reuse unless that makes the device hold on
+// to more than DevicePoolLimit bytes.
+int32_t DeviceTy::deleteData(void *TgtPtr) {
+  PoolMtx.lock();
+  auto It = BlockSizes.find(TgtPtr);
+  if (It == BlockSizes.end()) {
+    PoolMtx.unlock();
+    return RTL->data_delete(RTLDeviceID, TgtPtr);
+  }
+  int64_t Class = It->second;
+  if (FreeBytes + Class > DevicePoolLimit) {
+    BlockSizes.erase(It);
+    PoolMtx.unlock();
+    return RTL->data_delete(RTLDeviceID, TgtPtr);
+  }
+  FreeBlocks[Class].push_back(TgtPtr);
+  FreeBytes += Class;
+  PoolMtx.unlock();
+  DP("Keeping %" PRId64 " bytes of device memory at " DPxMOD " for reuse\n",
+      Class, DPxPTR(TgtPtr));
+  return OFFLOAD_SUCCESS;
+}
+
 /// Init device, should not be called directly.
 void DeviceTy::init() {
   int32_t rc = RTL->init_device(RTLDeviceID);
@@ -307,19 +393,28 @@ __tgt_target_table *DeviceTy::load_binary(void *Img) {
 
 // Submit data to device.
 int32_t DeviceTy::data_submit(void *TgtPtrBegin, void *HstPtrBegin,
-    int64_t Size) {
+    int64_t Size, __tgt_async_info *AsyncInfo) {
+  if (AsyncInfo && RTL->synchronize)
+    return RTL->data_submit_async(RTLDeviceID, TgtPtrBegin, HstPtrBegin, Size,
+        AsyncInfo);
   return RTL->data_submit(RTLDeviceID, TgtPtrBegin, HstPtrBegin, Size);
 }
 
 // Retrieve data from device.
 int32_t DeviceTy::data_retrieve(void *HstPtrBegin, void *TgtPtrBegin,
-    int64_t Size) {
+    int64_t Size, __tgt_async_info *AsyncInfo) {
+  if (AsyncInfo && RTL->synchronize)
+    return RTL->data_retrieve_async(RTLDeviceID, HstPtrBegin, TgtPtrBegin,
+        Size, AsyncInfo);
   return RTL->data_retrieve(RTLDeviceID, HstPtrBegin, TgtPtrBegin, Size);
 }
 
 // Run region on device
 int32_t DeviceTy::run_region(void *TgtEntryPtr, void **TgtVarsPtr,
-    ptrdiff_t *TgtOffsets, int32_t TgtVarsSize) {
+    ptrdiff_t *TgtOffsets, int32_t TgtVarsSize, __tgt_async_info *AsyncInfo) {
+  if (AsyncInfo && RTL->synchronize)
+    return RTL->run_region_async(RTLDeviceID, TgtEntryPtr, TgtVarsPtr,
+        TgtOffsets, TgtVarsSize, AsyncInfo);
   return RTL->run_region(RTLDeviceID, TgtEntryPtr, TgtVarsPtr, TgtOffsets,
       TgtVarsSize);
 }
@@ -327,11 +422,23 @@ int32_t DeviceTy::run_region(void *TgtEntryPtr, void **TgtVarsPtr,
 // Run team region on device.
 int32_t DeviceTy::run_team_region(void *TgtEntryPtr, void **TgtVarsPtr,
     ptrdiff_t *TgtOffsets, int32_t TgtVarsSize, int32_t NumTeams,
-    int32_t ThreadLimit, uint64_t LoopTripCount) {
+    int32_t ThreadLimit, uint64_t LoopTripCount,
+    __tgt_async_info *AsyncInfo) {
+  if (AsyncInfo && RTL->synchronize)
+    return RTL->run_team_region_async(RTLDeviceID, TgtEntryPtr, TgtVarsPtr,
+        TgtOffsets, TgtVarsSize, NumTeams, ThreadLimit, LoopTripCount,
+        AsyncInfo);
   return RTL->run_team_region(RTLDeviceID, TgtEntryPtr, TgtVarsPtr, TgtOffsets,
       TgtVarsSize, NumTeams, ThreadLimit, LoopTripCount);
 }
 
+// Wait for the operations issued with AsyncInfo.
+int32_t DeviceTy::synchronize(__tgt_async_info *AsyncInfo) {
+  if (RTL->synchronize)
+    return RTL->synchronize(RTLDeviceID, AsyncInfo);
+  return OFFLOAD_SUCCESS;
+}
+
 /// Check whether a device has an associated RTL and initialize it if it's not
 /// already initialized.
 bool device_is_ready(int device_num) {
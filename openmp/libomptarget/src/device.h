@@ -24,6 +24,7 @@
 struct RTLInfoTy;
 struct __tgt_bin_desc;
 struct __tgt_target_table;
+struct __tgt_async_info;
 
 #define INF_REF_CNT (LONG_MAX>>1) // leave room for additions/subtractions
 #define CONSIDERED_INF(x) (x > (INF_REF_CNT>>1))
@@ -94,7 +95,13 @@ struct DeviceTy {
 
   ShadowPtrListTy ShadowPtrMap;
 
-  std::mutex DataMapMtx, PendingGlobalsMtx, ShadowMtx;
+  // Device memory of deleted data kept for reuse, by size class, and the
+  // size class of every block currently handed out or kept.
+  std::map<int64_t, std::vector<void *>> FreeBlocks;
+  std::map<void *, int64_t> BlockSizes;
+  int64_t FreeBytes;
+
+  std::mutex DataMapMtx, PendingGlobalsMtx, ShadowMtx, PoolMtx;
 
   uint64_t loopTripCnt;
 
@@ -103,8 +110,9 @@ struct DeviceTy {
   DeviceTy(RTLInfoTy *RTL)
       : DeviceID(-1), RTL(RTL), RTLDeviceID(-1), IsInit(false), InitFlag(),
         HasPendingGlobals(false), HostDataToTargetMap(),
-        PendingCtorsDtors(), ShadowPtrMap(), DataMapMtx(), PendingGlobalsMtx(),
-        ShadowMtx(), loopTripCnt(0), RTLRequiresFlags(0) {}
+        PendingCtorsDtors(), ShadowPtrMap(), FreeBlocks(), BlockSizes(),
+        FreeBytes(0), DataMapMtx(), PendingGlobalsMtx(), ShadowMtx(),
+        PoolMtx(), loopTripCnt(0), RTLRequiresFlags(0) {}
 
   // The existence of mutexes makes DeviceTy non-copyable. We need to
   // provide a copy constructor and an assignment operator explicitly.
@@ -113,8 +121,9 @@ struct DeviceTy {
         IsInit(d.IsInit), InitFlag(), HasPendingGlobals(d.HasPendingGlobals),
         HostDataToTargetMap(d.HostDataToTargetMap),
         PendingCtorsDtors(d.PendingCtorsDtors), ShadowPtrMap(d.ShadowPtrMap),
-        DataMapMtx(), PendingGlobalsMtx(),
-        ShadowMtx(), loopTripCnt(d.loopTripCnt),
+        FreeBlocks(d.FreeBlocks), BlockSizes(d.BlockSizes),
+        FreeBytes(d.FreeBytes), DataMapMtx(), PendingGlobalsMtx(),
+        ShadowMtx(), PoolMtx(), loopTripCnt(d.loopTripCnt),
         RTLRequiresFlags(d.RTLRequiresFlags) {}
 
   DeviceTy& operator=(const DeviceTy &d) {
@@ -126,6 +135,9 @@ struct DeviceTy {
     HostDataToTargetMap = d.HostDataToTargetMap;
     PendingCtorsDtors = d.PendingCtorsDtors;
     ShadowPtrMap = d.ShadowPtrMap;
+    FreeBlocks = d.FreeBlocks;
+    BlockSizes = d.BlockSizes;
+    FreeBytes = d.FreeBytes;
     loopTripCnt = d.loopTripCnt;
     RTLRequiresFlags = d.RTLRequiresFlags;
 
@@ -141,20 +153,33 @@ struct DeviceTy {
       bool UpdateRefCount);
   int deallocTgtPtr(void *TgtPtrBegin, int64_t Size, bool ForceDelete);
   int associatePtr(void *HstPtrBegin, void *TgtPtrBegin, int64_t Size);
+
+  // Allocate and delete device memory for mapped and private data, reusing
+  // blocks of deleted data.
+  void *allocData(int64_t Size, void *HstPtr);
+  int32_t deleteData(void *TgtPtr);
   int disassociatePtr(void *HstPtrBegin);
 
   // calls to RTL
   int32_t initOnce();
   __tgt_target_table *load_binary(void *Img);
 
-  int32_t data_submit(void *TgtPtrBegin, void *HstPtrBegin, int64_t Size);
-  int32_t data_retrieve(void *HstPtrBegin, void *TgtPtrBegin, int64_t Size);
+  // With an AsyncInfo these only issue the operation if the RTL supports it;
+  // synchronize() has to be called before the host uses the results.
+  int32_t data_submit(void *TgtPtrBegin, void *HstPtrBegin, int64_t Size,
+      __tgt_async_info *AsyncInfo = nullptr);
+  int32_t data_retrieve(void *HstPtrBegin, void *TgtPtrBegin, int64_t Size,
+      __tgt_async_info *AsyncInfo = nullptr);
 
   int32_t run_region(void *TgtEntryPtr, void **TgtVarsPtr,
-      ptrdiff_t *TgtOffsets, int32_t TgtVarsSize);
+      ptrdiff_t *TgtOffsets, int32_t TgtVarsSize,
+      __tgt_async_info *AsyncInfo = nullptr);
   int32_t run_team_region(void *TgtEntryPtr, void **TgtVarsPtr,
       ptrdiff_t *TgtOffsets, int32_t TgtVarsSize, int32_t NumTeams,
-      int32_t ThreadLimit, uint64_t LoopTripCount);
+      int32_t ThreadLimit, uint64_t LoopTripCount,
+      __tgt_async_info *AsyncInfo = nullptr);
+
+  int32_t synchronize(__tgt_async_info *AsyncInfo);
 
 private:
   // Call to RTL
@@ -165,6 +190,11 @@ private:
 typedef std::vector<DeviceTy> DevicesTy;
 extern DevicesTy Devices;
 
+/// Most memory a device keeps for reuse (LIBOMPTARGET_POOL_LIMIT), and the
+/// largest block it keeps (LIBOMPTARGET_POOL_MAX_BLOCK), in bytes.
+extern int64_t DevicePoolLimit;
+extern int64_t DevicePoolMaxBlock;
+
 extern bool device_is_ready(int device_num);
 
 #endif
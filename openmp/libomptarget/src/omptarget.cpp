@@ -211,7 +211,8 @@ static int32_t member_of(int64_t type) {
 
 /// Internal function to do the mapping and transfer the data to the device
 int target_data_begin(DeviceTy &Device, int32_t arg_num,
-    void **args_base, void **args, int64_t *arg_sizes, int64_t *arg_types) {
+    void **args_base, void **args, int64_t *arg_sizes, int64_t *arg_types,
+    __tgt_async_info *AsyncInfo) {
   // process each input.
   for (int32_t i = 0; i < arg_num; ++i) {
     // Ignore private variables and arrays - there is no mapping for them.
@@ -304,7 +305,8 @@ int target_data_begin(DeviceTy &Device, int32_t arg_num,
       if (copy) {
         DP("Moving %" PRId64 " bytes (hst:" DPxMOD ") -> (tgt:" DPxMOD ")\n",
             data_size, DPxPTR(HstPtrBegin), DPxPTR(TgtPtrBegin));
-        int rt = Device.data_submit(TgtPtrBegin, HstPtrBegin, data_size);
+        int rt = Device.data_submit(TgtPtrBegin, HstPtrBegin, data_size,
+            AsyncInfo);
         if (rt != OFFLOAD_SUCCESS) {
           DP("Copying data to device failed.\n");
           return OFFLOAD_FAIL;
@@ -317,17 +319,18 @@ int target_data_begin(DeviceTy &Device, int32_t arg_num,
           DPxPTR(Pointer_TgtPtrBegin), DPxPTR(TgtPtrBegin));
       uint64_t Delta = (uint64_t)HstPtrBegin - (uint64_t)HstPtrBase;
       void *TgtPtrBase = (void *)((uint64_t)TgtPtrBegin - Delta);
-      int rt = Device.data_submit(Pointer_TgtPtrBegin, &TgtPtrBase,
-          sizeof(void *));
+      // create shadow pointers for this entry; the copy is made from the
+      // shadow entry, which outlives an asynchronous transfer.
+      Device.ShadowMtx.lock();
+      ShadowPtrValTy &Shadow = Device.ShadowPtrMap[Pointer_HstPtrBegin];
+      Shadow = {HstPtrBase, Pointer_TgtPtrBegin, TgtPtrBase};
+      int rt = Device.data_submit(Pointer_TgtPtrBegin, &Shadow.TgtPtrVal,
+          sizeof(void *), AsyncInfo);
+      Device.ShadowMtx.unlock();
       if (rt != OFFLOAD_SUCCESS) {
         DP("Copying data to device failed.\n");
         return OFFLOAD_FAIL;
       }
-      // create shadow pointers for this entry
-      Device.ShadowMtx.lock();
-      Device.ShadowPtrMap[Pointer_HstPtrBegin] = {HstPtrBase,
-          Pointer_TgtPtrBegin, TgtPtrBase};
-      Device.ShadowMtx.unlock();
     }
   }
 
@@ -610,11 +613,16 @@ int target(int64_t device_id, void *host_ptr, int32_t arg_num,
   TrlTblMtx.unlock();
   assert(TargetTable && "Global data has not been mapped\n");
 
+  // The transfers to the device and the launch are issued without waiting
+  // for each other, and waited for together before the data is moved back.
+  __tgt_async_info AsyncInfo = {};
+
   // Move data to device.
   int rc = target_data_begin(Device, arg_num, args_base, args, arg_sizes,
-      arg_types);
+      arg_types, &AsyncInfo);
   if (rc != OFFLOAD_SUCCESS) {
     DP("Call to target_data_begin failed, abort target.\n");
+    Device.synchronize(&AsyncInfo);
     return OFFLOAD_FAIL;
   }
 
@@ -624,6 +632,9 @@ int target(int64_t device_id, void *host_ptr, int32_t arg_num,
   // List of (first-)private arrays allocated for this target region
   std::vector<void *> fpArrays;
   std::vector<int> tgtArgsPositions(arg_num, -1);
+  // Device addresses of lambda captures, kept until the copies are done
+  std::vector<void *> LambdaPtrs;
+  LambdaPtrs.reserve(arg_num);
 
   for (int32_t i = 0; i < arg_num; ++i) {
     if (!(arg_types[i] & OMP_TGT_MAPTYPE_TARGET_PARAM)) {
@@ -655,10 +666,12 @@ int target(int64_t device_id, void *host_ptr, int32_t arg_num,
         }
         DP("Update lambda reference (" DPxMOD ") -> [" DPxMOD "]\n",
            DPxPTR(Pointer_TgtPtrBegin), DPxPTR(TgtPtrBegin));
-        int rt = Device.data_submit(TgtPtrBegin, &Pointer_TgtPtrBegin,
-                                    sizeof(void *));
+        LambdaPtrs.push_back(Pointer_TgtPtrBegin);
+        int rt = Device.data_submit(TgtPtrBegin, &LambdaPtrs.back(),
+                                    sizeof(void *), &AsyncInfo);
         if (rt != OFFLOAD_SUCCESS) {
           DP("Copying data to device failed.\n");
+          Device.synchronize(&AsyncInfo);
           return OFFLOAD_FAIL;
         }
       }
@@ -676,13 +689,13 @@ int target(int64_t device_id, void *host_ptr, int32_t arg_num,
       TgtBaseOffset = 0;
     } else if (arg_types[i] & OMP_TGT_MAPTYPE_PRIVATE) {
       // Allocate memory for (first-)private array
-      TgtPtrBegin = Device.RTL->data_alloc(Device.RTLDeviceID,
-          arg_sizes[i], HstPtrBegin);
+      TgtPtrBegin = Device.allocData(arg_sizes[i], HstPtrBegin);
       if (!TgtPtrBegin) {
         DP ("Data allocation for %sprivate array " DPxMOD " failed, "
             "abort target.\n",
             (arg_types[i] & OMP_TGT_MAPTYPE_TO ? "first-" : ""),
             DPxPTR(HstPtrBegin));
+        Device.synchronize(&AsyncInfo);
         return OFFLOAD_FAIL;
       }
       fpArrays.push_back(TgtPtrBegin);
@@ -697,9 +710,11 @@ int target(int64_t device_id, void *host_ptr, int32_t arg_num,
 #endif
       // If first-private, copy data from host
       if (arg_types[i] & OMP_TGT_MAPTYPE_TO) {
-        int rt = Device.data_submit(TgtPtrBegin, HstPtrBegin, arg_sizes[i]);
+        int rt = Device.data_submit(TgtPtrBegin, HstPtrBegin, arg_sizes[i],
+            &AsyncInfo);
         if (rt != OFFLOAD_SUCCESS) {
           DP ("Copying data to device failed, failed.\n");
+          Device.synchronize(&AsyncInfo);
           return OFFLOAD_FAIL;
         }
       }
@@ -739,19 +754,21 @@ int target(int64_t device_id, void *host_ptr, int32_t arg_num,
   if (IsTeamConstruct) {
     rc = Device.run_team_region(TargetTable->EntriesBegin[TM->Index].addr,
         &tgt_args[0], &tgt_offsets[0], tgt_args.size(), team_num,
-        thread_limit, ltc);
+        thread_limit, ltc, &AsyncInfo);
   } else {
     rc = Device.run_region(TargetTable->EntriesBegin[TM->Index].addr,
-        &tgt_args[0], &tgt_offsets[0], tgt_args.size());
+        &tgt_args[0], &tgt_offsets[0], tgt_args.size(), &AsyncInfo);
   }
-  if (rc != OFFLOAD_SUCCESS) {
+  // Kernel failures are only reported once the region has completed.
+  int rs = Device.synchronize(&AsyncInfo);
+  if (rc != OFFLOAD_SUCCESS || rs != OFFLOAD_SUCCESS) {
     DP ("Executing target region abort target.\n");
     return OFFLOAD_FAIL;
   }
 
   // Deallocate (first-)private arrays
   for (auto it : fpArrays) {
-    int rt = Device.RTL->data_delete(Device.RTLDeviceID, it);
+    int rt = Device.deleteData(it);
     if (rt != OFFLOAD_SUCCESS) {
       DP("Deallocation of (first-)private arrays failed.\n");
       return OFFLOAD_FAIL;
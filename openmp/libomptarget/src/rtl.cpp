@@ -44,6 +44,16 @@ void RTLsTy::LoadRTLs() {
   }
 #endif // OMPTARGET_DEBUG
 
+  // Limits of the device memory kept for reuse
+  if (char *envStr = getenv("LIBOMPTARGET_POOL_LIMIT")) {
+    DevicePoolLimit = std::stoll(envStr);
+    DP("Parsed LIBOMPTARGET_POOL_LIMIT=%" PRId64 "\n", DevicePoolLimit);
+  }
+  if (char *envStr = getenv("LIBOMPTARGET_POOL_MAX_BLOCK")) {
+    DevicePoolMaxBlock = std::stoll(envStr);
+    DP("Parsed LIBOMPTARGET_POOL_MAX_BLOCK=%" PRId64 "\n", DevicePoolMaxBlock);
+  }
+
   // Parse environment variable OMP_TARGET_OFFLOAD (if set)
   TargetOffloadPolicy = (kmp_target_offload_kind_t) __kmpc_get_target_offload();
   if (TargetOffloadPolicy == tgt_disabled) {
@@ -107,6 +117,22 @@ void RTLsTy::LoadRTLs() {
               dynlib_handle, "__tgt_rtl_run_target_team_region")))
       continue;
 
+    // Optional functions
+    *((void**) &R.data_submit_async) = dlsym(
+        dynlib_handle, "__tgt_rtl_data_submit_async");
+    *((void**) &R.data_retrieve_async) = dlsym(
+        dynlib_handle, "__tgt_rtl_data_retrieve_async");
+    *((void**) &R.run_region_async) = dlsym(
+        dynlib_handle, "__tgt_rtl_run_target_region_async");
+    *((void**) &R.run_team_region_async) = dlsym(
+        dynlib_handle, "__tgt_rtl_run_target_team_region_async");
+    *((void**) &R.synchronize) = dlsym(dynlib_handle, "__tgt_rtl_synchronize");
+    if (!R.data_submit_async || !R.data_retrieve_async ||
+        !R.run_region_async || !R.run_team_region_async) {
+      // Without the complete interface everything is synchronous.
+      R.synchronize = 0;
+    }
+
     // No devices are supported by this RTL?
     if (!(R.NumberOfDevices = R.number_of_devices())) {
       DP("No devices supported in this RTL\n");
@@ -22,6 +22,7 @@
 // Forward declarations.
 struct DeviceTy;
 struct __tgt_bin_desc;
+struct __tgt_async_info;
 
 struct RTLInfoTy {
   typedef int32_t(is_valid_binary_ty)(void *);
@@ -36,6 +37,17 @@ struct RTLInfoTy {
                                  int32_t);
   typedef int32_t(run_team_region_ty)(int32_t, void *, void **, ptrdiff_t *,
                                       int32_t, int32_t, int32_t, uint64_t);
+  typedef int32_t(data_submit_async_ty)(int32_t, void *, void *, int64_t,
+                                        __tgt_async_info *);
+  typedef int32_t(data_retrieve_async_ty)(int32_t, void *, void *, int64_t,
+                                          __tgt_async_info *);
+  typedef int32_t(run_region_async_ty)(int32_t, void *, void **, ptrdiff_t *,
+                                       int32_t, __tgt_async_info *);
+  typedef int32_t(run_team_region_async_ty)(int32_t, void *, void **,
+                                            ptrdiff_t *, int32_t, int32_t,
+                                            int32_t, uint64_t,
+                                            __tgt_async_info *);
+  typedef int32_t(synchronize_ty)(int32_t, __tgt_async_info *);
 
   int32_t Idx;                     // RTL index, index is the number of devices
                                    // of other RTLs that were registered before,
@@ -61,6 +73,13 @@ struct RTLInfoTy {
   run_region_ty *run_region;
   run_team_region_ty *run_team_region;
 
+  // Optional functions implemented in the RTL, either all or none of them.
+  data_submit_async_ty *data_submit_async;
+  data_retrieve_async_ty *data_retrieve_async;
+  run_region_async_ty *run_region_async;
+  run_team_region_async_ty *run_team_region_async;
+  synchronize_ty *synchronize;
+
   // Are there images associated with this RTL.
   bool isUsed;
 
@@ -78,8 +97,9 @@ struct RTLInfoTy {
 #endif
         is_valid_binary(0), number_of_devices(0), init_device(0),
         load_binary(0), data_alloc(0), data_submit(0), data_retrieve(0),
-        data_delete(0), run_region(0), run_team_region(0), isUsed(false),
-        Mtx() {}
+        data_delete(0), run_region(0), run_team_region(0),
+        data_submit_async(0), data_retrieve_async(0), run_region_async(0),
+        run_team_region_async(0), synchronize(0), isUsed(false), Mtx() {}
 
   RTLInfoTy(const RTLInfoTy &r) : Mtx() {
     Idx = r.Idx;
@@ -98,6 +118,11 @@ struct RTLInfoTy {
     data_delete = r.data_delete;
     run_region = r.run_region;
     run_team_region = r.run_team_region;
+    data_submit_async = r.data_submit_async;
+    data_retrieve_async = r.data_retrieve_async;
+    run_region_async = r.run_region_async;
+    run_team_region_async = r.run_team_region_async;
+    synchronize = r.synchronize;
     isUsed = r.isUsed;
   }
 };
@@ -967,6 +967,7 @@ extern omp_allocator_handle_t __kmp_def_allocator;
 #endif
 
 extern int __kmp_memkind_available;
+extern size_t __kmp_huge_page_alloc_min;
 
 typedef omp_memspace_handle_t kmp_memspace_t; // placeholder
 
@@ -978,6 +979,8 @@ typedef struct kmp_allocator_t {
   kmp_allocator_t *fb_data;
   kmp_uint64 pool_size;
   kmp_uint64 pool_used;
+  omp_alloctrait_value_t partition;
+  int pinned;
 } kmp_allocator_t;
 
 extern omp_allocator_handle_t __kmpc_init_allocator(int gtid,
@@ -1837,6 +1840,8 @@ typedef enum kmp_bar_pat { /* Barrier communication patterns */
                                2, /* Hypercube-embedded tree with min branching
                                      factor 2^n */
                            bp_hierarchical_bar = 3, /* Machine hierarchy tree */
+                           bp_dissem_bar =
+                               4, /* Dissemination rounds (gather only) */
                            bp_last_bar /* Placeholder to mark the end */
 } kmp_bar_pat_e;
 
@@ -1933,6 +1938,23 @@ union KMP_ALIGN_CACHE kmp_barrier_team_union {
 
 typedef union kmp_barrier_team_union kmp_balign_team_t;
 
+/* Dissemination barrier needs one flag per partner, each in its own line */
+union KMP_ALIGN_CACHE kmp_dissem_flag_union {
+  double b_align; /* use worst case alignment */
+  char b_pad[CACHE_LINE];
+  volatile kmp_uint64 df_flag; /* STATE => partner reached this round */
+};
+
+typedef union kmp_dissem_flag_union kmp_dissem_flag_t;
+
+// Rounds a dissemination barrier takes for a team of nproc threads
+static inline int __kmp_dissem_barrier_rounds(int nproc) {
+  int rounds = 0;
+  while ((1 << rounds) < nproc)
+    ++rounds;
+  return rounds;
+}
+
 /* Padding for Linux* OS pthreads condition variables and mutexes used to signal
    threads when a condition changes.  This is to workaround an NPTL bug where
    padding was added to pthread_cond_t which caused the initialization routine
@@ -2113,6 +2135,7 @@ typedef enum kmp_tasking_mode {
 extern kmp_tasking_mode_t
     __kmp_tasking_mode; /* determines how/when to execute tasks */
 extern int __kmp_task_stealing_constraint;
+extern int __kmp_task_stealing_locality;
 #if OMP_40_ENABLED
 extern kmp_int32 __kmp_default_device; // Set via OMP_DEFAULT_DEVICE if
 // specified, defaults to 0 otherwise
@@ -2735,6 +2758,7 @@ typedef struct KMP_ALIGN_CACHE kmp_base_team {
   KMP_ALIGN_CACHE kmp_info_t **t_threads;
   kmp_taskdata_t
       *t_implicit_task_taskdata; // Taskdata for the thread's implicit task
+  kmp_dissem_flag_t *t_dissem_flags; // dissemination plain barrier rounds
   int t_level; // nested parallel level
 
   KMP_ALIGN_CACHE int t_max_argc;
@@ -3428,6 +3452,7 @@ extern void __kmp_affinity_set_init_mask(
 #if OMP_40_ENABLED
 extern void __kmp_affinity_set_place(int gtid);
 #endif
+extern int __kmp_affinity_place_domain(int place);
 extern void __kmp_affinity_determine_capable(const char *env_var);
 extern int __kmp_aux_set_affinity(void **mask);
 extern int __kmp_aux_get_affinity(void **mask);
@@ -4082,6 +4082,53 @@ static int __kmp_affinity_max_proc_per_core(const AddrUnsPair *address2os,
 static AddrUnsPair *address2os = NULL;
 static int *procarr = NULL;
 static int __kmp_aff_depth = 0;
+// Package of every OS proc in each place, or -1 where a place spans packages.
+static int *place_domains = NULL;
+
+// Record which package each entry of __kmp_affinity_masks lies in, so that
+// the task scheduler can prefer stealing from threads near the thief.
+static void __kmp_affinity_find_place_domains(AddrUnsPair *address2os,
+                                              int numAddrs, int depth) {
+  KMP_DEBUG_ASSERT(place_domains == NULL);
+  // A flat map has no packages to speak of.
+  if (depth <= 1 || __kmp_affinity_num_masks == 0)
+    return;
+  unsigned maxOsId = 0;
+  for (int i = 0; i < numAddrs; i++) {
+    if (address2os[i].second > maxOsId)
+      maxOsId = address2os[i].second;
+  }
+  int *osId2Pkg = (int *)__kmp_allocate(sizeof(int) * (maxOsId + 1));
+  for (unsigned i = 0; i <= maxOsId; i++)
+    osId2Pkg[i] = -1;
+  for (int i = 0; i < numAddrs; i++)
+    osId2Pkg[address2os[i].second] = address2os[i].first.labels[0];
+
+  place_domains = (int *)__kmp_allocate(sizeof(int) * __kmp_affinity_num_masks);
+  for (unsigned j = 0; j < __kmp_affinity_num_masks; j++) {
+    kmp_affin_mask_t *mask = KMP_CPU_INDEX(__kmp_affinity_masks, j);
+    int domain = -2; // no procs seen yet
+    int osId;
+    KMP_CPU_SET_ITERATE(osId, mask) {
+      int pkg = (unsigned)osId <= maxOsId ? osId2Pkg[osId] : -1;
+      if (domain == -2)
+        domain = pkg;
+      else if (domain != pkg)
+        domain = -1;
+    }
+    place_domains[j] = domain < 0 ? -1 : domain;
+  }
+  __kmp_free(osId2Pkg);
+}
+
+// Returns the package that all procs in the given place belong to, or -1 if
+// the place is not bound to a single package.
+int __kmp_affinity_place_domain(int place) {
+  if (place_domains == NULL || place < 0 ||
+      (unsigned)place >= __kmp_affinity_num_masks)
+    return -1;
+  return place_domains[place];
+}
 
 #if KMP_USE_HIER_SCHED
 #define KMP_EXIT_AFF_NONE                                                      \
@@ -4654,6 +4701,7 @@ static void __kmp_aux_affinity_initialize(void) {
   }
 
   KMP_CPU_FREE_ARRAY(osId2Mask, maxIndex + 1);
+  __kmp_affinity_find_place_domains(address2os, __kmp_avail_proc, depth);
   machine_hierarchy.init(address2os, __kmp_avail_proc);
 }
 #undef KMP_EXIT_AFF_NONE
@@ -4706,6 +4754,10 @@ void __kmp_affinity_uninitialize(void) {
     __kmp_free(procarr);
     procarr = NULL;
   }
+  if (place_domains != NULL) {
+    __kmp_free(place_domains);
+    place_domains = NULL;
+  }
 #if KMP_USE_HWLOC
   if (__kmp_hwloc_topology != NULL) {
     hwloc_topology_destroy(__kmp_hwloc_topology);
@@ -14,6 +14,12 @@
 #include "kmp_io.h"
 #include "kmp_wrapper_malloc.h"
 
+#if OMP_50_ENABLED && KMP_OS_LINUX
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 // Disable bget when it is not used
 #if KMP_USE_BGET
 
@@ -1240,6 +1246,8 @@ static void **mk_hbw_preferred;
 static void **mk_hugetlb;
 static void **mk_hbw_hugetlb;
 static void **mk_hbw_preferred_hugetlb;
+// size of explicit huge pages, 0 if none are configured
+static size_t huge_page_size;
 
 #if KMP_OS_UNIX && KMP_DYNAMIC_LIB
 static inline void chk_kind(void ***pkind) {
@@ -1250,7 +1258,31 @@ static inline void chk_kind(void ***pkind) {
 }
 #endif
 
+#if KMP_OS_LINUX
+// Explicit huge pages can only be used if this is non-zero, and mappings of
+// them must be multiples of it.
+static size_t __kmp_find_huge_page_size() {
+  size_t size = 0;
+  FILE *f = fopen("/proc/meminfo", "r");
+  if (f == NULL)
+    return 0;
+  char line[128];
+  unsigned long kb;
+  while (fgets(line, sizeof(line), f) != NULL) {
+    if (KMP_SSCANF(line, "Hugepagesize: %lu kB", &kb) == 1) {
+      size = (size_t)kb * 1024;
+      break;
+    }
+  }
+  fclose(f);
+  return size;
+}
+#endif
+
 void __kmp_init_memkind() {
+#if KMP_OS_LINUX
+  huge_page_size = __kmp_find_huge_page_size();
+#endif
 // as of 2018-07-31 memkind does not support Windows*, exclude it for now
 #if KMP_OS_UNIX && KMP_DYNAMIC_LIB
   // use of statically linked memkind is problematic, as it depends on libnuma
@@ -1351,7 +1383,9 @@ omp_allocator_handle_t __kmpc_init_allocator(int gtid, omp_memspace_handle_t ms,
     switch (traits[i].key) {
     case OMP_ATK_THREADMODEL:
     case OMP_ATK_ACCESS:
+      break;
     case OMP_ATK_PINNED:
+      al->pinned = (traits[i].value == OMP_ATV_TRUE);
       break;
     case OMP_ATK_ALIGNMENT:
       al->alignment = traits[i].value;
@@ -1370,7 +1404,12 @@ omp_allocator_handle_t __kmpc_init_allocator(int gtid, omp_memspace_handle_t ms,
       al->fb_data = RCAST(kmp_allocator_t *, traits[i].value);
       break;
     case OMP_ATK_PARTITION:
-      al->memkind = RCAST(void **, traits[i].value);
+      al->partition = (omp_alloctrait_value_t)traits[i].value;
+      KMP_DEBUG_ASSERT(
+          al->partition == OMP_ATV_ENVIRONMENT ||
+          al->partition == OMP_ATV_NEAREST ||
+          al->partition == OMP_ATV_BLOCKED ||
+          al->partition == OMP_ATV_INTERLEAVED);
       break;
     default:
       KMP_ASSERT2(0, "Unexpected allocator trait");
@@ -1388,7 +1427,7 @@ omp_allocator_handle_t __kmpc_init_allocator(int gtid, omp_memspace_handle_t ms,
   if (__kmp_memkind_available) {
     // Let's use memkind library if available
     if (ms == omp_high_bw_mem_space) {
-      if (al->memkind == (void *)OMP_ATV_INTERLEAVED && mk_hbw_interleave) {
+      if (al->partition == OMP_ATV_INTERLEAVED && mk_hbw_interleave) {
         al->memkind = mk_hbw_interleave;
       } else if (mk_hbw_preferred) {
         // AC: do not try to use MEMKIND_HBW for now, because memkind library
@@ -1403,7 +1442,7 @@ omp_allocator_handle_t __kmpc_init_allocator(int gtid, omp_memspace_handle_t ms,
         return omp_null_allocator;
       }
     } else {
-      if (al->memkind == (void *)OMP_ATV_INTERLEAVED && mk_interleave) {
+      if (al->partition == OMP_ATV_INTERLEAVED && mk_interleave) {
         al->memkind = mk_interleave;
       } else {
         al->memkind = mk_default;
@@ -1439,9 +1478,117 @@ typedef struct kmp_mem_desc { // Memory block descriptor
   size_t size_a; // Size of allocated memory block (initial+descriptor+align)
   void *ptr_align; // Pointer to aligned memory, returned
   kmp_allocator_t *allocator; // allocator
+  void **memkind; // kind the block came from, NULL if not from memkind
+  size_t size_mapped; // length of the mapping if mmap'ed, 0 otherwise
 } kmp_mem_desc_t;
 static int alignment = sizeof(void *); // let's align to pointer size
 
+#if KMP_OS_LINUX
+// Memory policies for mbind(2); <numaif.h> belongs to libnuma, which the
+// runtime does not depend on.
+#define KMP_MPOL_PREFERRED 1
+#define KMP_MPOL_INTERLEAVE 3
+#define KMP_MPOL_MAX_NODES 1024
+
+// Maps memory for the traits malloc cannot provide: huge pages, a placement
+// policy set before the pages are first touched, and pinning.  Returns NULL
+// if the memory could not be mapped or pinned.
+static void *__kmp_map_block(size_t size, bool huge,
+                             omp_alloctrait_value_t partition, bool pinned,
+                             size_t *size_mapped) {
+  void *ptr = MAP_FAILED;
+  if (huge && huge_page_size > 0) {
+    // Explicit huge pages come from the pool reserved by the administrator.
+    *size_mapped = (size + huge_page_size - 1) & ~(huge_page_size - 1);
+    ptr = mmap(NULL, *size_mapped, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  }
+  if (ptr == MAP_FAILED) {
+    *size_mapped = size;
+    ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+               -1, 0);
+    if (ptr == MAP_FAILED)
+      return NULL;
+#ifdef MADV_HUGEPAGE
+    if (huge) // settle for transparent huge pages
+      madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+  }
+  // If the policy cannot be set, the memory keeps the default placement.
+  if (partition == OMP_ATV_INTERLEAVED) {
+    // Nodes the process may not use are ignored by the kernel.
+    unsigned long nodes[KMP_MPOL_MAX_NODES / (CHAR_BIT * sizeof(long))];
+    memset(nodes, 0xff, sizeof(nodes));
+    syscall(SYS_mbind, ptr, *size_mapped, KMP_MPOL_INTERLEAVE, nodes,
+            KMP_MPOL_MAX_NODES + 1, 0);
+  } else if (partition == OMP_ATV_NEAREST) {
+    // Preferring no node in particular means the node of the touching thread.
+    syscall(SYS_mbind, ptr, *size_mapped, KMP_MPOL_PREFERRED, NULL, 0, 0);
+  }
+  if (pinned && mlock(ptr, *size_mapped) != 0) {
+    munmap(ptr, *size_mapped);
+    return NULL;
+  }
+  return ptr;
+}
+#endif
+
+// Gets size bytes from the memory allocator al describes, without checking
+// its pool size or falling back.  Records in desc how to free them.
+static void *__kmp_alloc_block(int gtid, kmp_allocator_t *al, size_t size,
+                               kmp_mem_desc_t *desc) {
+  omp_allocator_handle_t oal = (omp_allocator_handle_t)al;
+  bool predefined = oal < kmp_max_mem_alloc;
+  bool hbw = predefined ? oal == omp_high_bw_mem_alloc
+                        : al->memspace == omp_high_bw_mem_space;
+  bool huge = __kmp_huge_page_alloc_min > 0 &&
+              size >= __kmp_huge_page_alloc_min;
+  bool pinned = !predefined && al->pinned;
+  omp_alloctrait_value_t partition =
+      predefined ? OMP_ATV_DEFAULT : al->partition;
+  desc->memkind = NULL;
+  desc->size_mapped = 0;
+
+  if (__kmp_memkind_available) {
+    void **kind;
+    if (predefined)
+      kind = hbw && mk_hbw_preferred ? mk_hbw_preferred : mk_default;
+    else
+      kind = al->memkind;
+    void **huge_kind = NULL;
+    if (huge && kind == mk_default)
+      huge_kind = mk_hugetlb;
+    else if (huge && kind == mk_hbw_preferred)
+      huge_kind = mk_hbw_preferred_hugetlb;
+    if (huge_kind) {
+      void *ptr = kmp_mk_alloc(*huge_kind, size);
+      if (ptr != NULL) {
+        desc->memkind = huge_kind;
+        return ptr;
+      }
+    }
+#if KMP_OS_LINUX
+    // memkind can neither pin its memory nor fall back to transparent huge
+    // pages, so map ordinary memory ourselves for those.
+    if (!(kind == mk_default && (pinned || huge)))
+#endif
+    {
+      desc->memkind = kind;
+      return kmp_mk_alloc(*kind, size);
+    }
+  } else if (hbw) {
+    // cannot detect HBW memory presence without memkind library
+    return NULL;
+  }
+#if KMP_OS_LINUX
+  if (pinned || huge || partition == OMP_ATV_INTERLEAVED ||
+      partition == OMP_ATV_NEAREST) {
+    return __kmp_map_block(size, huge, partition, pinned, &desc->size_mapped);
+  }
+#endif
+  return __kmp_thread_malloc(__kmp_thread_from_gtid(gtid), size);
+}
+
 void *__kmpc_alloc(int gtid, size_t size, omp_allocator_handle_t allocator) {
   void *ptr = NULL;
   kmp_allocator_t *al;
@@ -1463,80 +1610,28 @@ void *__kmpc_alloc(int gtid, size_t size, omp_allocator_handle_t allocator) {
   }
   desc.size_a = size + sz_desc + align;
 
-  if (__kmp_memkind_available) {
-    if (allocator < kmp_max_mem_alloc) {
-      // pre-defined allocator
-      if (allocator == omp_high_bw_mem_alloc && mk_hbw_preferred) {
-        ptr = kmp_mk_alloc(*mk_hbw_preferred, desc.size_a);
-      } else {
-        ptr = kmp_mk_alloc(*mk_default, desc.size_a);
-      }
-    } else if (al->pool_size > 0) {
+  if (allocator < kmp_max_mem_alloc) {
+    // pre-defined allocator
+    ptr = __kmp_alloc_block(gtid, al, desc.size_a, &desc);
+  } else {
+    if (al->pool_size > 0) {
       // custom allocator with pool size requested
       kmp_uint64 used =
           KMP_TEST_THEN_ADD64((kmp_int64 *)&al->pool_used, desc.size_a);
-      if (used + desc.size_a > al->pool_size) {
-        // not enough space, need to go fallback path
-        KMP_TEST_THEN_ADD64((kmp_int64 *)&al->pool_used, -desc.size_a);
-        if (al->fb == OMP_ATV_DEFAULT_MEM_FB) {
-          al = (kmp_allocator_t *)omp_default_mem_alloc;
-          ptr = kmp_mk_alloc(*mk_default, desc.size_a);
-        } else if (al->fb == OMP_ATV_ABORT_FB) {
-          KMP_ASSERT(0); // abort fallback requested
-        } else if (al->fb == OMP_ATV_ALLOCATOR_FB) {
-          KMP_ASSERT(al != al->fb_data);
-          al = al->fb_data;
-          return __kmpc_alloc(gtid, size, (omp_allocator_handle_t)al);
-        } // else ptr == NULL;
-      } else {
+      if (used + desc.size_a <= al->pool_size) {
         // pool has enough space
-        ptr = kmp_mk_alloc(*al->memkind, desc.size_a);
-        if (ptr == NULL) {
-          if (al->fb == OMP_ATV_DEFAULT_MEM_FB) {
-            al = (kmp_allocator_t *)omp_default_mem_alloc;
-            ptr = kmp_mk_alloc(*mk_default, desc.size_a);
-          } else if (al->fb == OMP_ATV_ABORT_FB) {
-            KMP_ASSERT(0); // abort fallback requested
-          } else if (al->fb == OMP_ATV_ALLOCATOR_FB) {
-            KMP_ASSERT(al != al->fb_data);
-            al = al->fb_data;
-            return __kmpc_alloc(gtid, size, (omp_allocator_handle_t)al);
-          }
-        }
+        ptr = __kmp_alloc_block(gtid, al, desc.size_a, &desc);
       }
+      if (ptr == NULL) // give the space back before going fallback path
+        KMP_TEST_THEN_ADD64((kmp_int64 *)&al->pool_used, -desc.size_a);
     } else {
       // custom allocator, pool size not requested
-      ptr = kmp_mk_alloc(*al->memkind, desc.size_a);
-      if (ptr == NULL) {
-        if (al->fb == OMP_ATV_DEFAULT_MEM_FB) {
-          al = (kmp_allocator_t *)omp_default_mem_alloc;
-          ptr = kmp_mk_alloc(*mk_default, desc.size_a);
-        } else if (al->fb == OMP_ATV_ABORT_FB) {
-          KMP_ASSERT(0); // abort fallback requested
-        } else if (al->fb == OMP_ATV_ALLOCATOR_FB) {
-          KMP_ASSERT(al != al->fb_data);
-          al = al->fb_data;
-          return __kmpc_alloc(gtid, size, (omp_allocator_handle_t)al);
-        }
-      }
+      ptr = __kmp_alloc_block(gtid, al, desc.size_a, &desc);
     }
-  } else if (allocator < kmp_max_mem_alloc) {
-    // pre-defined allocator
-    if (allocator == omp_high_bw_mem_alloc) {
-      // ptr = NULL;
-    } else {
-      ptr = __kmp_thread_malloc(__kmp_thread_from_gtid(gtid), desc.size_a);
-    }
-  } else if (al->pool_size > 0) {
-    // custom allocator with pool size requested
-    kmp_uint64 used =
-        KMP_TEST_THEN_ADD64((kmp_int64 *)&al->pool_used, desc.size_a);
-    if (used + desc.size_a > al->pool_size) {
-      // not enough space, need to go fallback path
-      KMP_TEST_THEN_ADD64((kmp_int64 *)&al->pool_used, -desc.size_a);
+    if (ptr == NULL) {
       if (al->fb == OMP_ATV_DEFAULT_MEM_FB) {
         al = (kmp_allocator_t *)omp_default_mem_alloc;
-        ptr = __kmp_thread_malloc(__kmp_thread_from_gtid(gtid), desc.size_a);
+        ptr = __kmp_alloc_block(gtid, al, desc.size_a, &desc);
       } else if (al->fb == OMP_ATV_ABORT_FB) {
         KMP_ASSERT(0); // abort fallback requested
       } else if (al->fb == OMP_ATV_ALLOCATOR_FB) {
@@ -1544,19 +1639,7 @@ void *__kmpc_alloc(int gtid, size_t size, omp_allocator_handle_t allocator) {
         al = al->fb_data;
         return __kmpc_alloc(gtid, size, (omp_allocator_handle_t)al);
       } // else ptr == NULL;
-    } else {
-      // pool has enough space
-      ptr = __kmp_thread_malloc(__kmp_thread_from_gtid(gtid), desc.size_a);
-      if (ptr == NULL && al->fb == OMP_ATV_ABORT_FB) {
-        KMP_ASSERT(0); // abort fallback requested
-      } // no sense to look for another fallback because of same internal alloc
     }
-  } else {
-    // custom allocator, pool size not requested
-    ptr = __kmp_thread_malloc(__kmp_thread_from_gtid(gtid), desc.size_a);
-    if (ptr == NULL && al->fb == OMP_ATV_ABORT_FB) {
-      KMP_ASSERT(0); // abort fallback requested
-    } // no sense to look for another fallback because of same internal alloc
   }
   KE_TRACE(10, ("__kmpc_alloc: T#%d %p=alloc(%d)\n", gtid, ptr, desc.size_a));
   if (ptr == NULL)
@@ -1600,30 +1683,21 @@ void __kmpc_free(int gtid, void *ptr, const omp_allocator_handle_t allocator) {
   oal = (omp_allocator_handle_t)al; // cast to void* for comparisons
   KMP_DEBUG_ASSERT(al);
 
-  if (__kmp_memkind_available) {
-    if (oal < kmp_max_mem_alloc) {
-      // pre-defined allocator
-      if (oal == omp_high_bw_mem_alloc && mk_hbw_preferred) {
-        kmp_mk_free(*mk_hbw_preferred, desc.ptr_alloc);
-      } else {
-        kmp_mk_free(*mk_default, desc.ptr_alloc);
-      }
-    } else {
-      if (al->pool_size > 0) { // custom allocator with pool size requested
-        kmp_uint64 used =
-            KMP_TEST_THEN_ADD64((kmp_int64 *)&al->pool_used, -desc.size_a);
-        (void)used; // to suppress compiler warning
-        KMP_DEBUG_ASSERT(used >= desc.size_a);
-      }
-      kmp_mk_free(*al->memkind, desc.ptr_alloc);
-    }
+  if (oal > kmp_max_mem_alloc && al->pool_size > 0) {
+    // custom allocator with pool size requested
+    kmp_uint64 used =
+        KMP_TEST_THEN_ADD64((kmp_int64 *)&al->pool_used, -desc.size_a);
+    (void)used; // to suppress compiler warning
+    KMP_DEBUG_ASSERT(used >= desc.size_a);
+  }
+#if KMP_OS_LINUX
+  if (desc.size_mapped > 0) {
+    munmap(desc.ptr_alloc, desc.size_mapped);
+  } else
+#endif
+  if (desc.memkind != NULL) {
+    kmp_mk_free(*desc.memkind, desc.ptr_alloc);
   } else {
-    if (oal > kmp_max_mem_alloc && al->pool_size > 0) {
-      kmp_uint64 used =
-          KMP_TEST_THEN_ADD64((kmp_int64 *)&al->pool_used, -desc.size_a);
-      (void)used; // to suppress compiler warning
-      KMP_DEBUG_ASSERT(used >= desc.size_a);
-    }
     __kmp_thread_free(__kmp_thread_from_gtid(gtid), desc.ptr_alloc);
   }
   KE_TRACE(10, ("__kmpc_free: T#%d freed %p (%p)\n", gtid, desc.ptr_alloc,
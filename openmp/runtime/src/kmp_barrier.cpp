@@ -1253,6 +1253,94 @@ static void __kmp_hierarchical_barrier_release(
                 gtid, team->t.t_id, tid, bt));
 }
 
+// Dissemination Barrier
+
+/* In round k every thread signals the thread 2^k places after it and waits for
+   the one 2^k places before it, so that after ceil(log2(nproc)) rounds each of
+   them knows the whole team has arrived, without any thread waiting on more
+   than one flag per round.  The team keeps two sets of flags and alternates
+   between them: a thread may enter the next barrier while a slower one is
+   still in its last rounds, but it cannot leave that barrier before the
+   slower one has. It has no reduction tree, so barriers that reduce (and
+   the fork/join barrier, whose team may go away while workers are still
+   signalling) use the hyper barrier instead. */
+static void __kmp_dissem_barrier_gather(
+    enum barrier_type bt, kmp_info_t *this_thr, int gtid, int tid,
+    void (*reduce)(void *, void *) USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
+  KMP_TIME_DEVELOPER_PARTITIONED_BLOCK(KMP_dissem_gather);
+  kmp_team_t *team = this_thr->th.th_team;
+  if (bt != bs_plain_barrier || reduce != NULL ||
+      team->t.t_dissem_flags == NULL) {
+    KMP_ASSERT(__kmp_barrier_gather_branch_bits[bt]);
+    __kmp_hyper_barrier_gather(bt, this_thr, gtid, tid,
+                               reduce USE_ITT_BUILD_ARG(itt_sync_obj));
+    return;
+  }
+  kmp_bstate_t *thr_bar = &this_thr->th.th_bar[bt].bb;
+  kmp_info_t **other_threads = team->t.t_threads;
+  kmp_uint32 num_threads = this_thr->th.th_team_nproc;
+  int rounds = __kmp_dissem_barrier_rounds(team->t.t_max_nproc);
+  kmp_uint64 parity =
+      (team->t.t_bar[bt].b_arrived / KMP_BARRIER_STATE_BUMP) & 1;
+  kmp_dissem_flag_t *flags = team->t.t_dissem_flags;
+  kmp_dissem_flag_t *my_flags = &flags[(tid * 2 + parity) * rounds];
+  kmp_uint32 offset;
+  int round;
+
+  KA_TRACE(
+      20,
+      ("__kmp_dissem_barrier_gather: T#%d(%d:%d) enter for barrier type %d\n",
+       gtid, team->t.t_id, tid, bt));
+  KMP_DEBUG_ASSERT(this_thr == other_threads[this_thr->th.th_info.ds.ds_tid]);
+
+#if USE_ITT_BUILD && USE_ITT_NOTIFY
+  // Barrier imbalance - save arrive time to the thread
+  if (__kmp_forkjoin_frames_mode == 3 || __kmp_forkjoin_frames_mode == 2) {
+    this_thr->th.th_bar_arrive_time = this_thr->th.th_bar_min_time =
+        __itt_get_timestamp();
+  }
+#endif
+  // Nobody waits on b_arrived here, but keep it in step with the team's in
+  // case a reduction takes the hyper barrier next time.
+  thr_bar->b_arrived += KMP_BARRIER_STATE_BUMP;
+
+  for (round = 0, offset = 1; offset < num_threads; ++round, offset <<= 1) {
+    kmp_uint32 to_tid = (tid + offset) % num_threads;
+    kmp_info_t *to_thr = other_threads[to_tid];
+    kmp_dissem_flag_t *to_flag =
+        &flags[(to_tid * 2 + parity) * rounds + round];
+    KA_TRACE(20, ("__kmp_dissem_barrier_gather: T#%d(%d:%d) round %d "
+                  "releasing T#%d(%d:%d) flag(%p)\n",
+                  gtid, team->t.t_id, tid, round,
+                  __kmp_gtid_from_tid(to_tid, team), team->t.t_id, to_tid,
+                  &to_flag->df_flag));
+    ANNOTATE_BARRIER_BEGIN(to_thr);
+    kmp_flag_64 p_flag(&to_flag->df_flag, to_thr);
+    p_flag.release();
+
+    KA_TRACE(20, ("__kmp_dissem_barrier_gather: T#%d(%d:%d) round %d wait "
+                  "flag(%p) == %u\n",
+                  gtid, team->t.t_id, tid, round, &my_flags[round].df_flag,
+                  KMP_BARRIER_STATE_BUMP));
+    kmp_flag_64 c_flag(&my_flags[round].df_flag, KMP_BARRIER_STATE_BUMP);
+    c_flag.wait(this_thr, FALSE USE_ITT_BUILD_ARG(itt_sync_obj));
+    ANNOTATE_BARRIER_END(this_thr);
+    TCW_8(my_flags[round].df_flag, KMP_INIT_BARRIER_STATE);
+  }
+
+  if (KMP_MASTER_TID(tid)) {
+    // Everybody has arrived; tell the team
+    team->t.t_bar[bt].b_arrived += KMP_BARRIER_STATE_BUMP;
+    KA_TRACE(20, ("__kmp_dissem_barrier_gather: T#%d(%d:%d) set team %d "
+                  "arrived(%p) = %llu\n",
+                  gtid, team->t.t_id, tid, team->t.t_id,
+                  &team->t.t_bar[bt].b_arrived, team->t.t_bar[bt].b_arrived));
+  }
+  KA_TRACE(
+      20, ("__kmp_dissem_barrier_gather: T#%d(%d:%d) exit for barrier type %d\n",
+           gtid, team->t.t_id, tid, bt));
+}
+
 // End of Barrier Algorithms
 
 // type traits for cancellable value
@@ -1398,6 +1486,11 @@ static int __kmp_barrier_template(enum barrier_type bt, int gtid, int is_split,
             bt, this_thr, gtid, tid, reduce USE_ITT_BUILD_ARG(itt_sync_obj));
         break;
       }
+      case bp_dissem_bar: {
+        __kmp_dissem_barrier_gather(bt, this_thr, gtid, tid,
+                                    reduce USE_ITT_BUILD_ARG(itt_sync_obj));
+        break;
+      }
       case bp_tree_bar: {
         // don't set branch bits to 0; use linear
         KMP_ASSERT(__kmp_barrier_gather_branch_bits[bt]);
@@ -1502,6 +1595,7 @@ static int __kmp_barrier_template(enum barrier_type bt, int gtid, int is_split,
             bt, this_thr, gtid, tid, FALSE USE_ITT_BUILD_ARG(itt_sync_obj));
       } else {
         switch (__kmp_barrier_release_pattern[bt]) {
+        case bp_dissem_bar: // only gathers plain barriers; release like hyper
         case bp_hyper_bar: {
           KMP_ASSERT(__kmp_barrier_release_branch_bits[bt]);
           __kmp_hyper_barrier_release(bt, this_thr, gtid, tid,
@@ -1639,6 +1733,7 @@ void __kmp_end_split_barrier(enum barrier_type bt, int gtid) {
   if (!team->t.t_serialized) {
     if (KMP_MASTER_GTID(gtid)) {
       switch (__kmp_barrier_release_pattern[bt]) {
+      case bp_dissem_bar: // only gathers plain barriers; release like hyper
       case bp_hyper_bar: {
         KMP_ASSERT(__kmp_barrier_release_branch_bits[bt]);
         __kmp_hyper_barrier_release(bt, this_thr, gtid, tid,
@@ -1785,6 +1880,7 @@ void __kmp_join_barrier(int gtid) {
 #endif /* USE_ITT_BUILD */
 
   switch (__kmp_barrier_gather_pattern[bs_forkjoin_barrier]) {
+  case bp_dissem_bar: // only gathers plain barriers
   case bp_hyper_bar: {
     KMP_ASSERT(__kmp_barrier_gather_branch_bits[bs_forkjoin_barrier]);
     __kmp_hyper_barrier_gather(bs_forkjoin_barrier, this_thr, gtid, tid,
@@ -1980,6 +2076,7 @@ void __kmp_fork_barrier(int gtid, int tid) {
   } // master
 
   switch (__kmp_barrier_release_pattern[bs_forkjoin_barrier]) {
+  case bp_dissem_bar: // only gathers plain barriers; release like hyper
   case bp_hyper_bar: {
     KMP_ASSERT(__kmp_barrier_release_branch_bits[bs_forkjoin_barrier]);
     __kmp_hyper_barrier_release(bs_forkjoin_barrier, this_thr, gtid, tid,
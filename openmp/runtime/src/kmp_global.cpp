@@ -107,8 +107,8 @@ char const *__kmp_barrier_type_name[bs_last_barrier] = {"plain", "forkjoin"
                                                         "reduction"
 #endif // KMP_FAST_REDUCTION_BARRIER
 };
-char const *__kmp_barrier_pattern_name[bp_last_bar] = {"linear", "tree",
-                                                       "hyper", "hierarchical"};
+char const *__kmp_barrier_pattern_name[bp_last_bar] = {
+    "linear", "tree", "hyper", "hierarchical", "dissemination"};
 
 int __kmp_allThreadsSpecified = 0;
 size_t __kmp_align_alloc = CACHE_LINE;
@@ -300,6 +300,7 @@ kmp_uint64 __kmp_taskloop_min_tasks = 0;
 
 #if OMP_50_ENABLED
 int __kmp_memkind_available = 0;
+size_t __kmp_huge_page_alloc_min = 0; // huge pages for omp_alloc are off
 omp_allocator_handle_t const omp_null_allocator = NULL;
 omp_allocator_handle_t const omp_default_mem_alloc =
     (omp_allocator_handle_t const)1;
@@ -341,6 +342,8 @@ omp_memspace_handle_t const omp_low_lat_mem_space =
 KMP_BUILD_ASSERT(sizeof(kmp_tasking_flags_t) == 4);
 
 int __kmp_task_stealing_constraint = 1; /* Constrain task stealing by default */
+int __kmp_task_stealing_locality =
+    FALSE; /* Steal from threads in the same package first */
 
 #ifdef DEBUG_SUSPEND
 int __kmp_suspend_count = 0;
@@ -3121,6 +3121,14 @@ static void __kmp_allocate_team_arrays(kmp_team_t *team, int max_nth) {
       (kmp_disp_t *)__kmp_allocate(sizeof(kmp_disp_t) * max_nth);
   team->t.t_implicit_task_taskdata =
       (kmp_taskdata_t *)__kmp_allocate(sizeof(kmp_taskdata_t) * max_nth);
+  team->t.t_dissem_flags = NULL;
+  if (__kmp_barrier_gather_pattern[bs_plain_barrier] == bp_dissem_bar &&
+      max_nth > 1) {
+    // two sets of flags per thread, see __kmp_dissem_barrier_gather
+    team->t.t_dissem_flags = (kmp_dissem_flag_t *)__kmp_allocate(
+        sizeof(kmp_dissem_flag_t) * 2 * max_nth *
+        __kmp_dissem_barrier_rounds(max_nth));
+  }
   team->t.t_max_nproc = max_nth;
 
   /* setup dispatch buffers */
@@ -3148,10 +3156,13 @@ static void __kmp_free_team_arrays(kmp_team_t *team) {
   __kmp_free(team->t.t_disp_buffer);
   __kmp_free(team->t.t_dispatch);
   __kmp_free(team->t.t_implicit_task_taskdata);
+  if (team->t.t_dissem_flags != NULL)
+    __kmp_free(team->t.t_dissem_flags);
   team->t.t_threads = NULL;
   team->t.t_disp_buffer = NULL;
   team->t.t_dispatch = NULL;
   team->t.t_implicit_task_taskdata = 0;
+  team->t.t_dissem_flags = NULL;
 }
 
 static void __kmp_reallocate_team_arrays(kmp_team_t *team, int max_nth) {
@@ -3160,6 +3171,8 @@ static void __kmp_reallocate_team_arrays(kmp_team_t *team, int max_nth) {
   __kmp_free(team->t.t_disp_buffer);
   __kmp_free(team->t.t_dispatch);
   __kmp_free(team->t.t_implicit_task_taskdata);
+  if (team->t.t_dissem_flags != NULL)
+    __kmp_free(team->t.t_dissem_flags);
   __kmp_allocate_team_arrays(team, max_nth);
 
   KMP_MEMCPY(team->t.t_threads, oldThreads,
@@ -1197,6 +1197,18 @@ static void __kmp_stg_print_task_stealing(kmp_str_buf_t *buffer,
   __kmp_stg_print_int(buffer, name, __kmp_task_stealing_constraint);
 } // __kmp_stg_print_task_stealing
 
+static void __kmp_stg_parse_task_stealing_locality(char const *name,
+                                                   char const *value,
+                                                   void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_task_stealing_locality);
+} // __kmp_stg_parse_task_stealing_locality
+
+static void __kmp_stg_print_task_stealing_locality(kmp_str_buf_t *buffer,
+                                                   char const *name,
+                                                   void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_task_stealing_locality);
+} // __kmp_stg_print_task_stealing_locality
+
 static void __kmp_stg_parse_max_active_levels(char const *name,
                                               char const *value, void *data) {
   kmp_uint64 tmp_dflt = 0;
@@ -3470,6 +3482,20 @@ static void __kmp_stg_print_allocator(kmp_str_buf_t *buffer, char const *name,
   }
 }
 
+// KMP_HUGE_PAGE_ALLOC_MIN sets the size from which omp_alloc uses huge pages
+static void __kmp_stg_parse_huge_page_alloc_min(char const *name,
+                                                char const *value,
+                                                void *data) {
+  __kmp_stg_parse_size(name, value, 0, KMP_SIZE_T_MAX, NULL,
+                       &__kmp_huge_page_alloc_min, 1);
+} // __kmp_stg_parse_huge_page_alloc_min
+
+static void __kmp_stg_print_huge_page_alloc_min(kmp_str_buf_t *buffer,
+                                                char const *name,
+                                                void *data) {
+  __kmp_stg_print_size(buffer, name, __kmp_huge_page_alloc_min);
+} // __kmp_stg_print_huge_page_alloc_min
+
 #endif /* OMP_50_ENABLED */
 
 // -----------------------------------------------------------------------------
@@ -4791,6 +4817,8 @@ static kmp_setting_t __kmp_stg_table[] = {
      0},
     {"KMP_TASK_STEALING_CONSTRAINT", __kmp_stg_parse_task_stealing,
      __kmp_stg_print_task_stealing, NULL, 0, 0},
+    {"KMP_TASK_STEALING_LOCALITY", __kmp_stg_parse_task_stealing_locality,
+     __kmp_stg_print_task_stealing_locality, NULL, 0, 0},
     {"OMP_MAX_ACTIVE_LEVELS", __kmp_stg_parse_max_active_levels,
      __kmp_stg_print_max_active_levels, NULL, 0, 0},
 #if OMP_40_ENABLED
@@ -5000,6 +5028,8 @@ static kmp_setting_t __kmp_stg_table[] = {
 #if OMP_50_ENABLED
     {"OMP_ALLOCATOR", __kmp_stg_parse_allocator, __kmp_stg_print_allocator,
      NULL, 0, 0},
+    {"KMP_HUGE_PAGE_ALLOC_MIN", __kmp_stg_parse_huge_page_alloc_min,
+     __kmp_stg_print_huge_page_alloc_min, NULL, 0, 0},
 #endif
 
 #if OMP_50_ENABLED && OMPT_SUPPORT
@@ -2818,6 +2818,44 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
   return task;
 }
 
+#if KMP_AFFINITY_SUPPORTED && OMP_40_ENABLED
+// __kmp_task_locality: Returns the package the thread is bound to, or -1 if it
+// is not bound within a single package.
+static inline int __kmp_task_locality(kmp_info_t *thread) {
+  return __kmp_affinity_place_domain(thread->th.th_current_place);
+}
+#endif
+
+// __kmp_find_local_victim: With KMP_TASK_STEALING_LOCALITY, look for a thread
+// in the same package as the thief that has tasks queued, starting from a
+// random team member.  Stealing from it keeps the task's data in memory local
+// to the package.  Returns the victim's tid, or -1 if there is none.
+static kmp_int32 __kmp_find_local_victim(kmp_info_t *thread, kmp_int32 tid,
+                                         kmp_thread_data_t *threads_data,
+                                         kmp_int32 nthreads) {
+#if KMP_AFFINITY_SUPPORTED && OMP_40_ENABLED
+  if (!__kmp_task_stealing_locality)
+    return -1;
+  int locality = __kmp_task_locality(thread);
+  if (locality < 0)
+    return -1;
+  kmp_int32 victim_tid = __kmp_get_random(thread) % nthreads;
+  for (kmp_int32 i = 0; i < nthreads; ++i) {
+    if (victim_tid != tid &&
+        TCR_4(threads_data[victim_tid].td.td_deque_ntasks) != 0 &&
+        __kmp_task_locality(threads_data[victim_tid].td.td_thr) == locality) {
+      KA_TRACE(20, ("__kmp_find_local_victim: T#%d found victim tid %d in "
+                    "package %d\n",
+                    __kmp_gtid_from_thread(thread), victim_tid, locality));
+      return victim_tid;
+    }
+    if (++victim_tid == nthreads)
+      victim_tid = 0;
+  }
+#endif
+  return -1;
+}
+
 // __kmp_execute_tasks_template: Choose and execute tasks until either the
 // condition is statisfied (return true) or there are none left (return false).
 //
@@ -2877,6 +2915,17 @@ static inline int __kmp_execute_tasks_template(
         // Try to steal from the last place I stole from successfully.
         if (victim_tid == -2) { // haven't stolen anything yet
           victim_tid = threads_data[tid].td.td_deque_last_stolen;
+#if KMP_AFFINITY_SUPPORTED && OMP_40_ENABLED
+          // Don't keep stealing from another package while this one has work.
+          if (victim_tid != -1 && __kmp_task_stealing_locality &&
+              __kmp_task_locality(threads_data[victim_tid].td.td_thr) !=
+                  __kmp_task_locality(thread)) {
+            kmp_int32 local_tid =
+                __kmp_find_local_victim(thread, tid, threads_data, nthreads);
+            if (local_tid != -1)
+              victim_tid = local_tid;
+          }
+#endif
           if (victim_tid !=
               -1) // if we have a last stolen from victim, get the thread
             other_thread = threads_data[victim_tid].td.td_thr;
@@ -2884,8 +2933,15 @@ static inline int __kmp_execute_tasks_template(
         if (victim_tid != -1) { // found last victim
           asleep = 0;
         } else if (!new_victim) { // no recent steals and we haven't already
-          // used a new victim; select a random thread
-          do { // Find a different thread to steal work from.
+          // used a new victim; prefer a thread in our package that has tasks,
+          // otherwise select a random thread
+          victim_tid =
+              __kmp_find_local_victim(thread, tid, threads_data, nthreads);
+          if (victim_tid != -1) {
+            other_thread = threads_data[victim_tid].td.td_thr;
+            asleep = 0;
+          }
+          while (asleep) { // Find a different thread to steal work from.
             // Pick a random thread. Initial plan was to cycle through all the
             // threads, and only return if we tried to steal from every thread,
             // and failed.  Arch says that's not such a great idea.
@@ -2918,7 +2974,7 @@ static inline int __kmp_execute_tasks_template(
               // that the victim's queue is empty.  Try stealing from a
               // different thread.
             }
-          } while (asleep);
+          }
         }
 
         if (!asleep) {
@@ -268,7 +268,11 @@ ompt_try_start_tool(unsigned int omp_version, const char *runtime_version) {
     }
     __kmp_str_free(&libs);
   }
-  return ret;
+  if (ret)
+    return ret;
+
+  // Fall back to the built-in profiler if it is requested
+  return ompt_profile_start_tool(omp_version, runtime_version);
 }
 
 void ompt_pre_init() {
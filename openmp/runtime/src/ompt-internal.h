@@ -106,6 +106,9 @@ void ompt_pre_init(void);
 void ompt_post_init(void);
 void ompt_fini(void);
 
+ompt_start_tool_result_t *ompt_profile_start_tool(unsigned int omp_version,
+                                                  const char *runtime_version);
+
 #define OMPT_GET_RETURN_ADDRESS(level) __builtin_return_address(level)
 #define OMPT_GET_FRAME_ADDRESS(level) __builtin_frame_address(level)
 
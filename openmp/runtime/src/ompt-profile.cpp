@@ -0,0 +1,531 @@
+/*
+ * ompt-profile.cpp -- built-in OMPT tool reporting per-region statistics
+ */
+
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// When KMP_OMPT_PROFILE names an output file (or "stdout" or "stderr") and no
+// other tool attaches, the runtime starts this tool. It keeps a few timestamps
+// per thread and region instance and, at the end of each parallel region,
+// folds them into one record per parallel or worksharing construct, keyed by
+// its return address. The records are written as JSON at shutdown.
+//
+// For every thread of a parallel region instance, work is the time between
+// the start of its implicit task and the moment it reaches the join barrier,
+// less the time spent waiting in barriers inside the region. Imbalance is the
+// difference between the largest and the mean work of the instance; barrier
+// wait adds the in-region waits and the time each thread waited at the join
+// barrier. Tasks executed while waiting at a barrier are also counted as
+// barrier wait.
+
+//******************************************************************************
+// include files
+//******************************************************************************
+
+#include "kmp.h"
+#include "ompt-specific.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//******************************************************************************
+// macros
+//******************************************************************************
+
+// Nesting depth of implicit tasks tracked per thread
+#define KMP_PROF_MAX_DEPTH 16
+#define KMP_PROF_NUM_BUCKETS 256
+
+// Value stored in the task data of explicit tasks
+#define KMP_PROF_EXPLICIT_TASK 1
+
+// Record kind of parallel regions, worksharing constructs use their ompt_work_t
+#define KMP_PROF_PARALLEL 0
+
+//******************************************************************************
+// types
+//******************************************************************************
+
+// Aggregated statistics of one construct
+typedef struct kmp_prof_record {
+  struct kmp_prof_record *next;
+  const void *codeptr;
+  int kind;
+  kmp_uint64 count;
+  kmp_uint64 threads;
+  kmp_uint64 iterations;
+  kmp_uint64 tasks;
+  double time;
+  double work;
+  double imbalance;
+  double barrier;
+  double task_time;
+} kmp_prof_record_t;
+
+// One execution of a worksharing construct by the threads of an instance
+typedef struct {
+  const void *codeptr;
+  int kind;
+  kmp_uint64 threads;
+  kmp_uint64 iterations;
+  double sum;
+  double max;
+} kmp_prof_work_t;
+
+struct kmp_prof_parallel;
+
+// State of one implicit task, only written by the thread executing it
+typedef struct KMP_ALIGN_CACHE kmp_prof_slot {
+  struct kmp_prof_parallel *parallel;
+  double begin;
+  double wait_begin; // non-zero while waiting in a barrier
+  double wait;
+  double task_time;
+  kmp_uint64 tasks;
+  const void *work_codeptr;
+  int work_kind;
+  int work_seq;
+  kmp_uint64 work_iterations;
+  double work_begin;
+} kmp_prof_slot_t;
+
+// State of one parallel region instance, reached through its parallel_data
+typedef struct kmp_prof_parallel {
+  const void *codeptr;
+  double begin;
+  int nslots;
+  kmp_prof_slot_t *slots;
+  kmp_bootstrap_lock_t lock;
+  int nwork;
+  int work_size;
+  kmp_prof_work_t *work;
+} kmp_prof_parallel_t;
+
+// Per-thread state, reached through thread_data
+typedef struct {
+  int depth;
+  kmp_prof_slot_t *stack[KMP_PROF_MAX_DEPTH];
+  double task_begin; // non-zero while executing an explicit task
+} kmp_prof_thread_t;
+
+//******************************************************************************
+// global variables
+//******************************************************************************
+
+static const char *__kmp_prof_file = NULL;
+static kmp_prof_record_t *__kmp_prof_records[KMP_PROF_NUM_BUCKETS];
+static kmp_bootstrap_lock_t __kmp_prof_lock =
+    KMP_BOOTSTRAP_LOCK_INITIALIZER(__kmp_prof_lock);
+
+//******************************************************************************
+// private operations
+//******************************************************************************
+
+static inline double __kmp_prof_now() {
+  double t;
+  __kmp_elapsed(&t);
+  return t;
+}
+
+static inline kmp_prof_thread_t *__kmp_prof_get_thread() {
+  ompt_data_t *thread_data = __ompt_get_thread_data_internal();
+  return thread_data ? (kmp_prof_thread_t *)thread_data->ptr : NULL;
+}
+
+// Returns the slot of the implicit task the calling thread is executing
+static inline kmp_prof_slot_t *__kmp_prof_get_slot(kmp_prof_thread_t *thr) {
+  if (!thr || thr->depth == 0 || thr->depth > KMP_PROF_MAX_DEPTH)
+    return NULL;
+  return thr->stack[thr->depth - 1];
+}
+
+static const char *__kmp_prof_kind_name(int kind) {
+  switch (kind) {
+  case KMP_PROF_PARALLEL:
+    return "parallel";
+  case ompt_work_loop:
+    return "loop";
+  case ompt_work_sections:
+    return "sections";
+  case ompt_work_single_executor:
+  case ompt_work_single_other:
+    return "single";
+  case ompt_work_workshare:
+    return "workshare";
+  case ompt_work_distribute:
+    return "distribute";
+  case ompt_work_taskloop:
+    return "taskloop";
+  }
+  return "unknown";
+}
+
+// Must be called with __kmp_prof_lock held
+static kmp_prof_record_t *__kmp_prof_get_record(const void *codeptr,
+                                                int kind) {
+  size_t bucket = (((kmp_uintptr_t)codeptr >> 4) ^ kind) % KMP_PROF_NUM_BUCKETS;
+  kmp_prof_record_t *rec;
+  for (rec = __kmp_prof_records[bucket]; rec; rec = rec->next)
+    if (rec->codeptr == codeptr && rec->kind == kind)
+      return rec;
+  rec = (kmp_prof_record_t *)__kmp_allocate(sizeof(kmp_prof_record_t));
+  rec->codeptr = codeptr;
+  rec->kind = kind;
+  rec->next = __kmp_prof_records[bucket];
+  __kmp_prof_records[bucket] = rec;
+  return rec;
+}
+
+//******************************************************************************
+// callbacks
+//******************************************************************************
+
+static void __kmp_prof_thread_begin(ompt_thread_t thread_type,
+                                    ompt_data_t *thread_data) {
+  thread_data->ptr = __kmp_allocate(sizeof(kmp_prof_thread_t));
+}
+
+static void __kmp_prof_thread_end(ompt_data_t *thread_data) {
+  if (thread_data->ptr) {
+    __kmp_free(thread_data->ptr);
+    thread_data->ptr = NULL;
+  }
+}
+
+static void __kmp_prof_parallel_begin(ompt_data_t *encountering_task_data,
+                                      const ompt_frame_t *encountering_frame,
+                                      ompt_data_t *parallel_data,
+                                      unsigned int requested_parallelism,
+                                      int flags, const void *codeptr_ra) {
+  kmp_prof_parallel_t *par =
+      (kmp_prof_parallel_t *)__kmp_allocate(sizeof(kmp_prof_parallel_t));
+  par->codeptr = codeptr_ra;
+  par->nslots = requested_parallelism ? requested_parallelism : 1;
+  par->slots = (kmp_prof_slot_t *)__kmp_allocate(par->nslots *
+                                                 sizeof(kmp_prof_slot_t));
+  __kmp_init_bootstrap_lock(&par->lock);
+  par->begin = __kmp_prof_now();
+  parallel_data->ptr = par;
+}
+
+static void __kmp_prof_parallel_end(ompt_data_t *parallel_data,
+                                    ompt_data_t *encountering_task_data,
+                                    int flags, const void *codeptr_ra) {
+  kmp_prof_parallel_t *par = (kmp_prof_parallel_t *)parallel_data->ptr;
+  if (!par)
+    return;
+  parallel_data->ptr = NULL;
+
+  // All threads of the team have reached the join barrier, so their slots
+  // are no longer written.
+  double now = __kmp_prof_now();
+  kmp_uint64 nthreads = 0, tasks = 0;
+  double work = 0, work_max = 0, barrier = 0, task_time = 0;
+  for (int i = 0; i < par->nslots; ++i) {
+    kmp_prof_slot_t *slot = &par->slots[i];
+    if (!slot->parallel)
+      continue;
+    double stop = slot->wait_begin ? slot->wait_begin : now;
+    double busy = stop - slot->begin - slot->wait;
+    if (busy < 0)
+      busy = 0;
+    ++nthreads;
+    work += busy;
+    if (busy > work_max)
+      work_max = busy;
+    barrier += slot->wait + (now - stop);
+    task_time += slot->task_time;
+    tasks += slot->tasks;
+  }
+
+  __kmp_acquire_bootstrap_lock(&__kmp_prof_lock);
+  kmp_prof_record_t *rec =
+      __kmp_prof_get_record(par->codeptr, KMP_PROF_PARALLEL);
+  rec->count++;
+  rec->threads += nthreads;
+  rec->time += now - par->begin;
+  rec->work += work;
+  if (nthreads)
+    rec->imbalance += work_max - work / nthreads;
+  rec->barrier += barrier;
+  rec->tasks += tasks;
+  rec->task_time += task_time;
+  for (int i = 0; i < par->nwork; ++i) {
+    kmp_prof_work_t *w = &par->work[i];
+    if (!w->threads)
+      continue;
+    rec = __kmp_prof_get_record(w->codeptr, w->kind);
+    rec->count++;
+    rec->threads += w->threads;
+    rec->iterations += w->iterations;
+    rec->time += w->max;
+    rec->work += w->sum;
+    rec->imbalance += w->max - w->sum / w->threads;
+  }
+  __kmp_release_bootstrap_lock(&__kmp_prof_lock);
+
+  __kmp_destroy_bootstrap_lock(&par->lock);
+  if (par->work)
+    __kmp_free(par->work);
+  __kmp_free(par->slots);
+  __kmp_free(par);
+}
+
+static void __kmp_prof_implicit_task(ompt_scope_endpoint_t endpoint,
+                                     ompt_data_t *parallel_data,
+                                     ompt_data_t *task_data,
+                                     unsigned int actual_parallelism,
+                                     unsigned int index, int flags) {
+  kmp_prof_thread_t *thr = __kmp_prof_get_thread();
+  if (!thr)
+    return;
+  if (endpoint == ompt_scope_end) {
+    // Workers report the end of their implicit task only when they are
+    // released for the next region, after the slot has been freed.
+    if (thr->depth > 0)
+      thr->depth--;
+    return;
+  }
+
+  kmp_prof_slot_t *slot = NULL;
+  kmp_prof_parallel_t *par =
+      parallel_data ? (kmp_prof_parallel_t *)parallel_data->ptr : NULL;
+  if (par && index < (unsigned int)par->nslots) {
+    slot = &par->slots[index];
+    slot->parallel = par;
+    slot->begin = __kmp_prof_now();
+  }
+  // A worker thread starts outside of any implicit task, even if the end of
+  // its previous one was not reported.
+  if (index != 0)
+    thr->depth = 0;
+  if (thr->depth < KMP_PROF_MAX_DEPTH)
+    thr->stack[thr->depth] = slot;
+  thr->depth++;
+}
+
+static void __kmp_prof_work(ompt_work_t wstype, ompt_scope_endpoint_t endpoint,
+                            ompt_data_t *parallel_data,
+                            ompt_data_t *task_data, uint64_t count,
+                            const void *codeptr_ra) {
+  kmp_prof_slot_t *slot = __kmp_prof_get_slot(__kmp_prof_get_thread());
+  if (!slot)
+    return;
+  if (endpoint == ompt_scope_begin) {
+    slot->work_codeptr = codeptr_ra;
+    slot->work_kind =
+        wstype == ompt_work_single_other ? ompt_work_single_executor : wstype;
+    slot->work_iterations = count;
+    slot->work_begin = __kmp_prof_now();
+    return;
+  }
+
+  double elapsed = __kmp_prof_now() - slot->work_begin;
+  kmp_prof_parallel_t *par = slot->parallel;
+  // The threads of a team encounter the worksharing constructs in the same
+  // order, the n-th construct of every thread is the same execution.
+  int seq = slot->work_seq++;
+  __kmp_acquire_bootstrap_lock(&par->lock);
+  if (seq >= par->work_size) {
+    int size = par->work_size ? 2 * par->work_size : 4;
+    while (size <= seq)
+      size *= 2;
+    kmp_prof_work_t *work =
+        (kmp_prof_work_t *)__kmp_allocate(size * sizeof(kmp_prof_work_t));
+    if (par->work) {
+      KMP_MEMCPY(work, par->work, par->nwork * sizeof(kmp_prof_work_t));
+      __kmp_free(par->work);
+    }
+    par->work = work;
+    par->work_size = size;
+  }
+  if (seq >= par->nwork)
+    par->nwork = seq + 1;
+  kmp_prof_work_t *w = &par->work[seq];
+  if (!w->threads) {
+    w->codeptr = slot->work_codeptr;
+    w->kind = slot->work_kind;
+  }
+  if (w->codeptr == slot->work_codeptr) {
+    w->threads++;
+    w->iterations += slot->work_iterations;
+    w->sum += elapsed;
+    if (elapsed > w->max)
+      w->max = elapsed;
+  }
+  __kmp_release_bootstrap_lock(&par->lock);
+}
+
+static void __kmp_prof_sync_region_wait(ompt_sync_region_t kind,
+                                        ompt_scope_endpoint_t endpoint,
+                                        ompt_data_t *parallel_data,
+                                        ompt_data_t *task_data,
+                                        const void *codeptr_ra) {
+  if (kind == ompt_sync_region_taskwait || kind == ompt_sync_region_taskgroup)
+    return;
+  // The end of the join barrier is reported without parallel_data, after
+  // parallel_end has consumed the slot.
+  if (!parallel_data)
+    return;
+  kmp_prof_slot_t *slot = __kmp_prof_get_slot(__kmp_prof_get_thread());
+  if (!slot)
+    return;
+  if (endpoint == ompt_scope_begin) {
+    slot->wait_begin = __kmp_prof_now();
+  } else if (slot->wait_begin) {
+    slot->wait += __kmp_prof_now() - slot->wait_begin;
+    slot->wait_begin = 0;
+  }
+}
+
+static void __kmp_prof_task_create(ompt_data_t *encountering_task_data,
+                                   const ompt_frame_t *encountering_frame,
+                                   ompt_data_t *new_task_data, int flags,
+                                   int has_dependences,
+                                   const void *codeptr_ra) {
+  if (flags & ompt_task_explicit)
+    new_task_data->value = KMP_PROF_EXPLICIT_TASK;
+}
+
+static void __kmp_prof_task_schedule(ompt_data_t *prior_task_data,
+                                     ompt_task_status_t prior_task_status,
+                                     ompt_data_t *next_task_data) {
+  kmp_prof_thread_t *thr = __kmp_prof_get_thread();
+  if (!thr)
+    return;
+  double now = __kmp_prof_now();
+  kmp_prof_slot_t *slot = __kmp_prof_get_slot(thr);
+  if (slot && thr->task_begin) {
+    slot->task_time += now - thr->task_begin;
+    if (prior_task_status == ompt_task_complete)
+      slot->tasks++;
+  }
+  thr->task_begin =
+      (next_task_data && next_task_data->value == KMP_PROF_EXPLICIT_TASK)
+          ? now
+          : 0;
+}
+
+//******************************************************************************
+// output
+//******************************************************************************
+
+static int __kmp_prof_compare(const void *a, const void *b) {
+  const kmp_prof_record_t *ra = *(const kmp_prof_record_t *const *)a;
+  const kmp_prof_record_t *rb = *(const kmp_prof_record_t *const *)b;
+  return ra->time < rb->time ? 1 : ra->time > rb->time ? -1 : 0;
+}
+
+static void __kmp_prof_print_list(FILE *f, const char *name,
+                                  kmp_prof_record_t **recs, int n,
+                                  bool parallel, bool last) {
+  fprintf(f, "  \"%s\": [", name);
+  bool first = true;
+  for (int i = 0; i < n; ++i) {
+    kmp_prof_record_t *rec = recs[i];
+    if ((rec->kind == KMP_PROF_PARALLEL) != parallel)
+      continue;
+    fprintf(f, "%s\n    {\"codeptr_ra\": \"%p\", \"kind\": \"%s\", "
+               "\"count\": %llu, \"threads\": %.2f, \"time\": %.6f, "
+               "\"work\": %.6f, \"imbalance\": %.6f",
+            first ? "" : ",", rec->codeptr, __kmp_prof_kind_name(rec->kind),
+            (unsigned long long)rec->count,
+            rec->count ? (double)rec->threads / rec->count : 0.0, rec->time,
+            rec->work, rec->imbalance);
+    if (parallel)
+      fprintf(f, ", \"barrier_wait\": %.6f, \"tasks\": %llu, "
+                 "\"task_time\": %.6f}",
+              rec->barrier, (unsigned long long)rec->tasks, rec->task_time);
+    else
+      fprintf(f, ", \"iterations\": %llu}",
+              (unsigned long long)rec->iterations);
+    first = false;
+  }
+  fprintf(f, "%s]%s\n", first ? "" : "\n  ", last ? "" : ",");
+}
+
+static void __kmp_prof_write() {
+  int n = 0;
+  for (int b = 0; b < KMP_PROF_NUM_BUCKETS; ++b)
+    for (kmp_prof_record_t *rec = __kmp_prof_records[b]; rec; rec = rec->next)
+      ++n;
+  kmp_prof_record_t **recs = (kmp_prof_record_t **)__kmp_allocate(
+      (n ? n : 1) * sizeof(kmp_prof_record_t *));
+  n = 0;
+  for (int b = 0; b < KMP_PROF_NUM_BUCKETS; ++b)
+    for (kmp_prof_record_t *rec = __kmp_prof_records[b]; rec; rec = rec->next)
+      recs[n++] = rec;
+  qsort(recs, n, sizeof(kmp_prof_record_t *), __kmp_prof_compare);
+
+  FILE *f;
+  if (!strcmp(__kmp_prof_file, "stdout"))
+    f = stdout;
+  else if (!strcmp(__kmp_prof_file, "stderr"))
+    f = stderr;
+  else
+    f = fopen(__kmp_prof_file, "w");
+  if (f) {
+    fprintf(f, "{\n");
+    __kmp_prof_print_list(f, "parallel", recs, n, true, false);
+    __kmp_prof_print_list(f, "worksharing", recs, n, false, true);
+    fprintf(f, "}\n");
+    if (f == stdout || f == stderr)
+      fflush(f);
+    else
+      fclose(f);
+  } else {
+    fprintf(stderr, "Warning: KMP_OMPT_PROFILE: cannot open \"%s\".\n",
+            __kmp_prof_file);
+  }
+
+  for (int i = 0; i < n; ++i)
+    __kmp_free(recs[i]);
+  __kmp_free(recs);
+  memset(__kmp_prof_records, 0, sizeof(__kmp_prof_records));
+}
+
+//******************************************************************************
+// tool interface
+//******************************************************************************
+
+#define KMP_PROF_SET_CALLBACK(event, callback)                                 \
+  set_callback(ompt_callback_##event, (ompt_callback_t)(callback))
+
+static int __kmp_prof_initialize(ompt_function_lookup_t lookup,
+                                 int initial_device_num,
+                                 ompt_data_t *tool_data) {
+  ompt_set_callback_t set_callback =
+      (ompt_set_callback_t)lookup("ompt_set_callback");
+  if (!set_callback)
+    return 0;
+  KMP_PROF_SET_CALLBACK(thread_begin, __kmp_prof_thread_begin);
+  KMP_PROF_SET_CALLBACK(thread_end, __kmp_prof_thread_end);
+  KMP_PROF_SET_CALLBACK(parallel_begin, __kmp_prof_parallel_begin);
+  KMP_PROF_SET_CALLBACK(parallel_end, __kmp_prof_parallel_end);
+  KMP_PROF_SET_CALLBACK(implicit_task, __kmp_prof_implicit_task);
+  KMP_PROF_SET_CALLBACK(work, __kmp_prof_work);
+  KMP_PROF_SET_CALLBACK(sync_region_wait, __kmp_prof_sync_region_wait);
+  KMP_PROF_SET_CALLBACK(task_create, __kmp_prof_task_create);
+  KMP_PROF_SET_CALLBACK(task_schedule, __kmp_prof_task_schedule);
+  return 1;
+}
+
+static void __kmp_prof_finalize(ompt_data_t *tool_data) { __kmp_prof_write(); }
+
+ompt_start_tool_result_t *ompt_profile_start_tool(unsigned int omp_version,
+                                                  const char *runtime_version) {
+  static ompt_start_tool_result_t result = {&__kmp_prof_initialize,
+                                            &__kmp_prof_finalize, {0}};
+  const char *file = getenv("KMP_OMPT_PROFILE");
+  if (!file || !*file)
+    return NULL;
+  __kmp_prof_file = file;
+  return &result;
+}
@@ -0,0 +1,52 @@
+// RUN: %libomp-compile-and-run
+// RUN: env KMP_HUGE_PAGE_ALLOC_MIN=1M %libomp-run
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <omp.h>
+
+// Allocators with pinned memory, a partition policy, or (with
+// KMP_HUGE_PAGE_ALLOC_MIN) huge pages should still hand out usable memory.
+static int check(omp_allocator_handle_t a, size_t size, size_t align) {
+  char *p = (char *)omp_alloc(size, a);
+  if (p == NULL || (uintptr_t)p % align != 0) {
+    printf("failed: %p for %d bytes\n", p, (int)size);
+    return 1;
+  }
+  memset(p, 1, size);
+  omp_free(p, a);
+  return 0;
+}
+
+int main() {
+  omp_alloctrait_t at[3];
+  omp_allocator_handle_t pinned, interleaved, nearest;
+  int err = 0;
+  at[0].key = OMP_ATK_PINNED;
+  at[0].value = OMP_ATV_TRUE;
+  at[1].key = OMP_ATK_FALLBACK;
+  at[1].value = OMP_ATV_DEFAULT_MEM_FB;
+  pinned = omp_init_allocator(omp_default_mem_space, 2, at);
+  at[0].key = OMP_ATK_PARTITION;
+  at[0].value = OMP_ATV_INTERLEAVED;
+  at[2].key = OMP_ATK_ALIGNMENT;
+  at[2].value = 64;
+  interleaved = omp_init_allocator(omp_default_mem_space, 3, at);
+  at[0].value = OMP_ATV_NEAREST;
+  nearest = omp_init_allocator(omp_default_mem_space, 3, at);
+  #pragma omp parallel num_threads(2) reduction(+:err)
+  {
+    err += check(pinned, 4096, sizeof(void *));
+    err += check(interleaved, 100, 64);
+    err += check(interleaved, 4 * 1024 * 1024, 64);
+    err += check(nearest, 4 * 1024 * 1024, 64);
+    err += check(omp_default_mem_alloc, 4 * 1024 * 1024, sizeof(void *));
+  }
+  omp_destroy_allocator(pinned);
+  omp_destroy_allocator(interleaved);
+  omp_destroy_allocator(nearest);
+  if (err == 0)
+    printf("passed\n");
+  return err != 0;
+}
@@ -0,0 +1,52 @@
+// RUN: %libomp-compile
+// RUN: env KMP_PLAIN_BARRIER_PATTERN=dissemination,hyper %libomp-run
+// RUN: env KMP_PLAIN_BARRIER_PATTERN=dissemination,hyper KMP_BLOCKTIME=0 %libomp-run
+#include <stdio.h>
+#include "omp_testsuite.h"
+
+/*
+ * The dissemination gather is used for plain barriers; barriers that reduce
+ * fall back to the hyper barrier.  Mix both, with team sizes that are not
+ * powers of two, and check that no thread gets past a barrier early.
+ */
+
+#define NBARRIERS 1000
+
+static int test_dissemination(int nthreads) {
+  int counts[NBARRIERS + 1] = {0};
+  int errors = 0;
+  int sum;
+  #pragma omp parallel num_threads(nthreads) reduction(+:errors)
+  {
+    int i;
+    for (i = 0; i < NBARRIERS; i++) {
+      #pragma omp atomic
+      counts[i]++;
+      #pragma omp barrier
+      if (counts[i] != omp_get_num_threads())
+        errors++;
+      if (i % 100 == 0) {
+        #pragma omp single
+        sum = 0;
+        #pragma omp for reduction(+:sum)
+        for (int j = 0; j < 100; j++)
+          sum += j;
+        if (sum != 4950)
+          errors++;
+      }
+    }
+  }
+  return errors == 0;
+}
+
+int main() {
+  int n, num_failed = 0;
+  omp_set_dynamic(0);
+  for (n = 1; n <= 7; n++) {
+    if (!test_dissemination(n)) {
+      printf("failed with %d threads\n", n);
+      num_failed++;
+    }
+  }
+  return num_failed;
+}
@@ -0,0 +1,48 @@
+// RUN: %libomp-compile && env KMP_OMPT_PROFILE=stdout %libomp-run | FileCheck %s
+// REQUIRES: ompt
+
+// Without a tool attached, KMP_OMPT_PROFILE starts the built-in profiler,
+// which prints one JSON record per parallel and worksharing construct.
+
+#include <stdio.h>
+#include <omp.h>
+
+int main() {
+  int r, i;
+  int sum = 0;
+
+  for (r = 0; r < 3; r++) {
+    #pragma omp parallel num_threads(4)
+    {
+      #pragma omp for schedule(static) reduction(+:sum)
+      for (i = 0; i < 100; i++)
+        sum += i;
+    }
+  }
+
+  #pragma omp parallel num_threads(4)
+  {
+    #pragma omp single
+    {
+      for (i = 0; i < 10; i++) {
+        #pragma omp task
+        {
+          #pragma omp atomic
+          sum++;
+        }
+      }
+    }
+  }
+
+  printf("sum = %d\n", sum);
+
+  // CHECK: sum = 14860
+  // CHECK: "parallel": [
+  // CHECK-DAG: "kind": "parallel", "count": 3, "threads": 4.00,
+  // CHECK-DAG: "kind": "parallel", "count": 1, "threads": 4.00, {{.*}}"tasks": 10,
+  // CHECK: "worksharing": [
+  // CHECK-DAG: "kind": "loop", "count": 3, "threads": 4.00,
+  // CHECK-DAG: "kind": "single", "count": 1, "threads": 4.00,
+
+  return 0;
+}
@@ -0,0 +1,60 @@
+// RUN: %libomp-compile
+// RUN: env KMP_TASK_STEALING_LOCALITY=1 %libomp-run
+// RUN: env KMP_TASK_STEALING_LOCALITY=1 OMP_PROC_BIND=close OMP_PLACES=cores %libomp-run
+// RUN: env KMP_TASK_STEALING_LOCALITY=1 KMP_AFFINITY=compact %libomp-run
+// REQUIRES: openmp-4.0
+#include <stdio.h>
+#include <omp.h>
+
+/*
+ * With KMP_TASK_STEALING_LOCALITY, idle threads steal from threads bound to
+ * the same package first.  Check that every task still runs exactly once,
+ * both when one thread creates all the tasks and when tasks create tasks.
+ */
+
+#define NTASKS 10000
+
+static int fib(int n) {
+  int x, y;
+  if (n < 2)
+    return n;
+  #pragma omp task shared(x)
+  x = fib(n - 1);
+  #pragma omp task shared(y)
+  y = fib(n - 2);
+  #pragma omp taskwait
+  return x + y;
+}
+
+int main() {
+  int count = 0;
+  int result = 0;
+
+  #pragma omp parallel
+  {
+    #pragma omp single
+    {
+      int i;
+      for (i = 0; i < NTASKS; i++) {
+        #pragma omp task
+        {
+          #pragma omp atomic
+          count++;
+        }
+      }
+    }
+  }
+
+  #pragma omp parallel
+  {
+    #pragma omp single
+    result = fib(20);
+  }
+
+  if (count != NTASKS || result != 6765) {
+    printf("failed: %d tasks, fib(20) = %d\n", count, result);
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
@@ -108,4 +108,157 @@ Program &Program::operator=(Program &&That) noexcept = default;
 Kernel::Kernel(Kernel &&) noexcept = default;
 Kernel &Kernel::operator=(Kernel &&That) noexcept = default;
 
+MemoryPool::~MemoryPool() {
+  Status S = trim();
+  if (S.isError())
+    logWarning("error trimming memory pool: " + S.getMessage());
+}
+
+Expected<MemoryPool::Block *>
+MemoryPool::acquire(bool IsHost, ptrdiff_t ByteCount, Stream &Stream) {
+  if (ByteCount == 0)
+    return nullptr;
+  void *StreamHandle = ThePlatform->getStreamHandle(Stream);
+
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    // Take the smallest ready block that is big enough but does not waste
+    // more than half of itself.
+    auto Best = CachedBlocks.end();
+    for (auto I = CachedBlocks.begin(), E = CachedBlocks.end(); I != E; ++I) {
+      Block &B = **I;
+      if (B.IsHost != IsHost || B.ByteCount < ByteCount ||
+          B.ByteCount > 2 * ByteCount)
+        continue;
+      if (Best != E && (*Best)->ByteCount <= B.ByteCount)
+        continue;
+      bool IsReady = (!IsHost && B.StreamHandle == StreamHandle) ||
+                     !B.ReleaseEvent || B.ReleaseEvent->isDone();
+      if (IsReady)
+        Best = I;
+    }
+    if (Best != CachedBlocks.end()) {
+      Block *B = Best->release();
+      CachedBlocks.erase(Best);
+      B->StreamHandle = StreamHandle;
+      ++Stats.Reuses;
+      Stats.BytesCached -= B->ByteCount;
+      Stats.BytesInUse += B->ByteCount;
+      return B;
+    }
+  }
+
+  Expected<void *> MaybeMemory = allocate(IsHost, ByteCount);
+  if (MaybeMemory.isError()) {
+    // The cached blocks may be what is using up the memory, so give them back
+    // and try again.
+    Status TrimStatus = trim();
+    if (TrimStatus.isError())
+      return TrimStatus;
+    Expected<void *> MaybeRetriedMemory = allocate(IsHost, ByteCount);
+    if (MaybeRetriedMemory.isError())
+      return MaybeRetriedMemory.getError();
+    return addBlock(MaybeRetriedMemory.getValue(), IsHost, ByteCount,
+                    StreamHandle);
+  }
+  return addBlock(MaybeMemory.getValue(), IsHost, ByteCount, StreamHandle);
+}
+
+Expected<void *> MemoryPool::allocate(bool IsHost, ptrdiff_t ByteCount) {
+  return IsHost ? ThePlatform->rawMallocRegisteredH(ByteCount)
+                : ThePlatform->rawMallocD(ByteCount, TheDeviceIndex);
+}
+
+MemoryPool::Block *MemoryPool::addBlock(void *Memory, bool IsHost,
+                                        ptrdiff_t ByteCount,
+                                        void *StreamHandle) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  ++Stats.PlatformAllocations;
+  Stats.BytesInUse += ByteCount;
+  return new Block{Memory, ByteCount, IsHost, StreamHandle, nullptr};
+}
+
+void MemoryPool::release(Block *B) {
+  std::unique_ptr<Block> Owned(B);
+  // Mark the point on the stream after which the block is no longer in use.
+  Status S;
+  if (!B->ReleaseEvent) {
+    Expected<Event> MaybeEvent = ThePlatform->createEvent(TheDeviceIndex);
+    if (MaybeEvent.isError())
+      S = MaybeEvent.getError();
+    else
+      B->ReleaseEvent.reset(new Event(MaybeEvent.takeValue()));
+  }
+  if (!S.isError())
+    S = ThePlatform->enqueueEvent(
+        ThePlatform->getEventHandle(*B->ReleaseEvent), B->StreamHandle);
+  if (S.isError()) {
+    // Without an event there is no telling when the block can be reused.
+    logWarning("error recording memory pool release event: " + S.getMessage());
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      Stats.BytesInUse -= B->ByteCount;
+    }
+    destroy(std::move(Owned));
+    return;
+  }
+
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Stats.BytesInUse -= B->ByteCount;
+  Stats.BytesCached += B->ByteCount;
+  CachedBlocks.push_back(std::move(Owned));
+}
+
+void MemoryPool::destroy(std::unique_ptr<Block> B) {
+  // The work on the stream may still be using the block.
+  Status S = ThePlatform->streamSync(B->StreamHandle);
+  if (S.isError())
+    logWarning("error waiting for memory pool block: " + S.getMessage());
+  HandleDestructor Destructor =
+      B->IsHost ? ThePlatform->getFreeHostMemoryHandleDestructor()
+                : ThePlatform->getDeviceMemoryHandleDestructor();
+  Destructor(B->Memory);
+}
+
+Status MemoryPool::trim() {
+  std::vector<std::unique_ptr<Block>> Blocks;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Blocks.swap(CachedBlocks);
+    Stats.BytesCached = 0;
+  }
+  Status Result;
+  for (std::unique_ptr<Block> &B : Blocks) {
+    Status S = B->ReleaseEvent->sync();
+    if (S.isError() && !Result.isError())
+      Result = S;
+    HandleDestructor Destructor =
+        B->IsHost ? ThePlatform->getFreeHostMemoryHandleDestructor()
+                  : ThePlatform->getDeviceMemoryHandleDestructor();
+    Destructor(B->Memory);
+  }
+  return Result;
+}
+
+MemoryPool::Statistics MemoryPool::getStatistics() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return Stats;
+}
+
+Status
+enqueueBatches(Span<Stream> Streams, ptrdiff_t BatchCount,
+               const std::function<void(Stream &, ptrdiff_t)> &EnqueueBatch) {
+  if (Streams.empty())
+    return BatchCount ? Status("no streams to enqueue batches on") : Status();
+  for (ptrdiff_t I = 0; I < BatchCount; ++I)
+    EnqueueBatch(Streams[I % Streams.size()], I);
+  Status Result;
+  for (Stream &S : Streams) {
+    Status SyncStatus = S.sync();
+    if (SyncStatus.isError() && !Result.isError())
+      Result = SyncStatus;
+  }
+  return Result;
+}
+
 } // namespace acxxel
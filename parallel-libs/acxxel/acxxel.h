@@ -72,6 +72,16 @@
 /// Device memory allocated with acxxel::Platform::mallocD is automatically
 /// freed when it goes out of scope.
 ///
+/// \subsubsection MemoryPools Stream-ordered memory pools
+///
+/// Code that processes many batches of data can allocate the buffers for each
+/// batch from an acxxel::MemoryPool, which reuses released device and staging
+/// memory instead of going back to the platform every time. The
+/// acxxel::enqueueBatches function spreads batches over several streams so that
+/// the copies of one batch overlap with the kernels of others:
+///
+/// \snippet examples/overlap_example.cu Example pipelined saxpy
+///
 /// \subsubsection NiceErrorHandling Error handling
 ///
 /// Operations that would normally return values return acxxel::Expected obects
@@ -105,8 +115,10 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #if defined(__clang__) || defined(__GNUC__)
 #define ACXXEL_WARN_UNUSED_RESULT __attribute__((warn_unused_result))
@@ -127,6 +139,7 @@ struct CUstream_st; // NOLINT
 namespace acxxel {
 
 class Event;
+class MemoryPool;
 class Platform;
 class Stream;
 
@@ -140,6 +153,10 @@ template <typename T> class AsyncHostMemorySpan;
 
 template <typename T> class OwnedAsyncHostMemory;
 
+template <typename T> class PooledDeviceMemory;
+
+template <typename T> class PooledAsyncHostMemory;
+
 /// Function type used to destroy opaque handles given out by the platform.
 using HandleDestructor = void (*)(void *);
 
@@ -585,6 +602,7 @@ protected:
   friend class Stream;
   friend class Event;
   friend class Program;
+  friend class MemoryPool;
   template <typename T> friend class DeviceMemorySpan;
 
   void *getStreamHandle(Stream &Stream) { return Stream.TheHandle.get(); }
@@ -1110,6 +1128,13 @@ public:
         TheHandle(static_cast<value_type *>(Memory.handle())),
         TheSize(Memory.size()), TheOffset(0), TheSpanHandle(nullptr) {}
 
+  // Intentionally implicit.
+  template <typename OtherElementType>
+  DeviceMemorySpan(PooledDeviceMemory<OtherElementType> &Memory)
+      : ThePlatform(Memory.ThePlatform),
+        TheHandle(static_cast<value_type *>(Memory.handle())),
+        TheSize(Memory.size()), TheOffset(0), TheSpanHandle(nullptr) {}
+
   ~DeviceMemorySpan() {
     if (TheSpanHandle) {
       ThePlatform->rawDestroyDeviceMemorySpanHandle(
@@ -1185,6 +1210,7 @@ public:
 private:
   template <typename T> friend class DeviceMemory;
   template <typename T> friend class DeviceMemorySpan;
+  template <typename T> friend class PooledDeviceMemory;
   friend class Platform;
 
   DeviceMemorySpan(Platform *ThePlatform, pointer AHandle, index_type Size,
@@ -1332,6 +1358,11 @@ public:
   AsyncHostMemorySpan(OwnedAsyncHostMemory<OtherElementType> &Owned)
       : TheSpan(Owned.get(), Owned.TheElementCount) {}
 
+  // Intentionally implicit.
+  template <typename OtherElementType>
+  AsyncHostMemorySpan(PooledAsyncHostMemory<OtherElementType> &Pooled)
+      : TheSpan(Pooled.get(), Pooled.size()) {}
+
   // Intentionally implicit.
   template <typename OtherElementType>
   AsyncHostMemorySpan(AsyncHostMemorySpan<OtherElementType> &ASpan)
@@ -1377,6 +1408,271 @@ private:
   Span<ElementType> TheSpan;
 };
 
+/// A cache of device and pinned host memory with stream-ordered reuse.
+///
+/// Allocating device or pinned host memory from the platform is expensive and
+/// often synchronizes the device, so code that allocates its buffers for each
+/// batch of work can spend much of its time in the driver. A MemoryPool keeps
+/// the blocks released by its allocations and hands them out again.
+///
+/// Allocations are made for a Stream, and the memory may be used by the work
+/// enqueued on that Stream after the allocation. When the memory is released,
+/// its block is reused:
+///   * for device memory, right away by another allocation for the same
+///     Stream, because the work using the block is ordered before any work
+///     enqueued later on that Stream, and by allocations for other Streams
+///     once that work is complete;
+///   * for pinned host memory, only once that work is complete, because the
+///     host writes to staging memory right away rather than in stream order.
+///
+/// Memory must be released before the Stream it was allocated for is
+/// destroyed, and the MemoryPool must outlive all memory allocated from it.
+class MemoryPool {
+public:
+  /// Counters describing the use of a MemoryPool.
+  struct Statistics {
+    /// The number of blocks allocated from the platform.
+    ptrdiff_t PlatformAllocations = 0;
+    /// The number of allocations served with a cached block.
+    ptrdiff_t Reuses = 0;
+    /// The number of bytes in blocks that are currently allocated.
+    ptrdiff_t BytesInUse = 0;
+    /// The number of bytes in cached blocks.
+    ptrdiff_t BytesCached = 0;
+  };
+
+  explicit MemoryPool(Platform *APlatform, int DeviceIndex = 0)
+      : ThePlatform(APlatform), TheDeviceIndex(DeviceIndex) {}
+  MemoryPool(const MemoryPool &) = delete;
+  MemoryPool &operator=(const MemoryPool &) = delete;
+  ~MemoryPool();
+
+  /// Allocates device memory for use on the given Stream.
+  ///
+  /// \warning This function only allocates space in device memory, it does not
+  /// call the constructor of T.
+  template <typename T>
+  Expected<PooledDeviceMemory<T>> mallocD(ptrdiff_t ElementCount,
+                                          Stream &Stream);
+
+  /// Allocates pinned host memory for staging copies on the given Stream.
+  ///
+  /// \warning This function does not call the constructor of T.
+  template <typename T>
+  Expected<PooledAsyncHostMemory<T>> mallocH(ptrdiff_t ElementCount,
+                                             Stream &Stream);
+
+  /// Waits for any work using the cached blocks and returns them to the
+  /// platform.
+  Status trim();
+
+  Statistics getStatistics();
+
+private:
+  template <typename T> friend class PooledDeviceMemory;
+  template <typename T> friend class PooledAsyncHostMemory;
+
+  struct Block {
+    void *Memory;
+    ptrdiff_t ByteCount;
+    bool IsHost;
+    // The platform handle of the stream the block was last allocated for.
+    void *StreamHandle;
+    // Enqueued on that stream when the block is released.
+    std::unique_ptr<Event> ReleaseEvent;
+  };
+
+  // Returns null for an empty allocation.
+  Expected<Block *> acquire(bool IsHost, ptrdiff_t ByteCount, Stream &Stream);
+  Expected<void *> allocate(bool IsHost, ptrdiff_t ByteCount);
+  Block *addBlock(void *Memory, bool IsHost, ptrdiff_t ByteCount,
+                  void *StreamHandle);
+  void release(Block *B);
+  void destroy(std::unique_ptr<Block> B);
+
+  Platform *ThePlatform;
+  int TheDeviceIndex;
+
+  // Guards the members below, since memory may be released from a stream
+  // callback.
+  std::mutex Mutex;
+  std::vector<std::unique_ptr<Block>> CachedBlocks;
+  Statistics Stats;
+};
+
+/// Device memory allocated from a MemoryPool.
+///
+/// Like DeviceMemory, but the memory is returned to the pool, rather than
+/// freed, when it goes out of scope.
+template <typename ElementType> class PooledDeviceMemory {
+public:
+  using element_type = ElementType;
+  using index_type = std::ptrdiff_t;
+  using value_type = typename std::remove_const<element_type>::type;
+
+  PooledDeviceMemory(const PooledDeviceMemory &) = delete;
+  PooledDeviceMemory &operator=(const PooledDeviceMemory &) = delete;
+  PooledDeviceMemory(PooledDeviceMemory &&That) noexcept
+      : ThePool(That.ThePool), ThePlatform(That.ThePlatform),
+        TheBlock(That.TheBlock), TheSize(That.TheSize) {
+    That.TheBlock = nullptr;
+  }
+  PooledDeviceMemory &operator=(PooledDeviceMemory &&That) noexcept {
+    if (this != &That) {
+      reset();
+      ThePool = That.ThePool;
+      ThePlatform = That.ThePlatform;
+      TheBlock = That.TheBlock;
+      TheSize = That.TheSize;
+      That.TheBlock = nullptr;
+    }
+    return *this;
+  }
+  ~PooledDeviceMemory() { reset(); }
+
+  /// Gets the raw base handle for the underlying platform implementation.
+  void *handle() const { return TheBlock ? TheBlock->Memory : nullptr; }
+
+  index_type length() const { return TheSize; }
+  index_type size() const { return TheSize; }
+  index_type byte_size() const { // NOLINT
+    return TheSize * sizeof(element_type);
+  }
+  bool empty() const { return TheSize == 0; }
+
+  // These conversion operators are useful for making triple-chevron kernel
+  // launches more concise.
+  operator element_type *() { return static_cast<element_type *>(handle()); }
+  operator const element_type *() const {
+    return static_cast<const element_type *>(handle());
+  }
+
+  /// Converts a const object to a DeviceMemorySpan of const elements.
+  DeviceMemorySpan<const element_type> asSpan() const {
+    return DeviceMemorySpan<const element_type>(
+        ThePlatform, static_cast<const element_type *>(handle()), TheSize, 0);
+  }
+
+  /// Converts an object to a DeviceMemorySpan.
+  DeviceMemorySpan<element_type> asSpan() {
+    return DeviceMemorySpan<element_type>(
+        ThePlatform, static_cast<element_type *>(handle()), TheSize, 0);
+  }
+
+private:
+  friend class MemoryPool;
+  template <typename T> friend class DeviceMemorySpan;
+
+  PooledDeviceMemory(MemoryPool *APool, Platform *APlatform,
+                     MemoryPool::Block *ABlock, index_type ElementCount)
+      : ThePool(APool), ThePlatform(APlatform), TheBlock(ABlock),
+        TheSize(ElementCount) {}
+
+  void reset() {
+    if (TheBlock)
+      ThePool->release(TheBlock);
+    TheBlock = nullptr;
+  }
+
+  MemoryPool *ThePool;
+  Platform *ThePlatform;
+  MemoryPool::Block *TheBlock;
+  index_type TheSize;
+};
+
+/// Pinned host memory allocated from a MemoryPool.
+///
+/// Like OwnedAsyncHostMemory, but the memory is returned to the pool, rather
+/// than freed, when it goes out of scope, and the elements are neither
+/// constructed nor destroyed.
+template <typename ElementType> class PooledAsyncHostMemory {
+public:
+  PooledAsyncHostMemory(const PooledAsyncHostMemory &) = delete;
+  PooledAsyncHostMemory &operator=(const PooledAsyncHostMemory &) = delete;
+  PooledAsyncHostMemory(PooledAsyncHostMemory &&That) noexcept
+      : ThePool(That.ThePool), TheBlock(That.TheBlock),
+        TheElementCount(That.TheElementCount) {
+    That.TheBlock = nullptr;
+  }
+  PooledAsyncHostMemory &operator=(PooledAsyncHostMemory &&That) noexcept {
+    if (this != &That) {
+      reset();
+      ThePool = That.ThePool;
+      TheBlock = That.TheBlock;
+      TheElementCount = That.TheElementCount;
+      That.TheBlock = nullptr;
+    }
+    return *this;
+  }
+  ~PooledAsyncHostMemory() { reset(); }
+
+  ElementType *get() const {
+    return TheBlock ? static_cast<ElementType *>(TheBlock->Memory) : nullptr;
+  }
+  ElementType *data() const { return get(); }
+  ptrdiff_t size() const { return TheElementCount; }
+
+  ElementType &operator[](ptrdiff_t I) const {
+    assert(I >= 0 && I < TheElementCount);
+    return get()[I];
+  }
+
+private:
+  friend class MemoryPool;
+
+  PooledAsyncHostMemory(MemoryPool *APool, MemoryPool::Block *ABlock,
+                        ptrdiff_t ElementCount)
+      : ThePool(APool), TheBlock(ABlock), TheElementCount(ElementCount) {}
+
+  void reset() {
+    if (TheBlock)
+      ThePool->release(TheBlock);
+    TheBlock = nullptr;
+  }
+
+  MemoryPool *ThePool;
+  MemoryPool::Block *TheBlock;
+  ptrdiff_t TheElementCount;
+};
+
+template <typename T>
+Expected<PooledDeviceMemory<T>> MemoryPool::mallocD(ptrdiff_t ElementCount,
+                                                    Stream &Stream) {
+  Expected<Block *> MaybeBlock =
+      acquire(/*IsHost=*/false, ElementCount * sizeof(T), Stream);
+  if (MaybeBlock.isError())
+    return MaybeBlock.getError();
+  return PooledDeviceMemory<T>(this, ThePlatform, MaybeBlock.getValue(),
+                               ElementCount);
+}
+
+template <typename T>
+Expected<PooledAsyncHostMemory<T>> MemoryPool::mallocH(ptrdiff_t ElementCount,
+                                                       Stream &Stream) {
+  Expected<Block *> MaybeBlock =
+      acquire(/*IsHost=*/true, ElementCount * sizeof(T), Stream);
+  if (MaybeBlock.isError())
+    return MaybeBlock.getError();
+  return PooledAsyncHostMemory<T>(this, MaybeBlock.getValue(), ElementCount);
+}
+
+/// Enqueues batches of work round-robin on several streams and waits for all
+/// of them to finish.
+///
+/// EnqueueBatch is called on the host for each batch index from 0 to
+/// BatchCount - 1, together with the Stream for that batch, and should enqueue
+/// all the work of the batch on that Stream, for example a copy to the device,
+/// a kernel launch and a copy back. Because consecutive batches go to
+/// different streams, the copies of one batch can overlap with the kernels of
+/// the others. If the buffers of a batch are allocated from a MemoryPool for
+/// the batch's Stream, later batches on the same Stream reuse them without
+/// allocating.
+///
+/// Returns the first error reported by any of the streams.
+Status
+enqueueBatches(Span<Stream> Streams, ptrdiff_t BatchCount,
+               const std::function<void(Stream &, ptrdiff_t)> &EnqueueBatch);
+
 } // namespace acxxel
 
 #endif // ACXXEL_ACXXEL_H
@@ -0,0 +1,132 @@
+//===--- overlap_example.cu - Overlapping copies and kernels with Acxxel --===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file is an example of overlapping memory copies with kernel execution
+/// by splitting work into batches over several streams, using a MemoryPool for
+/// the per-batch buffers. It times the same saxpy done on one stream with
+/// buffers allocated for each batch and pipelined over several streams.
+///
+//===----------------------------------------------------------------------===//
+
+#include "acxxel.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+constexpr int BatchCount = 32;
+constexpr int BatchSize = 1 << 19;
+constexpr int StreamCount = 4;
+constexpr int ThreadsPerBlock = 256;
+
+__global__ void saxpyKernel(float A, float *X, float *Y, int N) {
+  int I = (blockDim.x * blockIdx.x) + threadIdx.x;
+  if (I < N)
+    X[I] = A * X[I] + Y[I];
+}
+
+void check(const acxxel::Status &Status, const char *What) {
+  if (Status.isError()) {
+    std::fprintf(stderr, "Error %s: %s\n", What, Status.getMessage().c_str());
+    std::exit(EXIT_FAILURE);
+  }
+}
+
+/// Enqueues one batch: copy X and Y in, run saxpy, copy X back out.
+template <typename DeviceArray>
+void enqueueSaxpy(acxxel::Stream &Stream, float A,
+                  acxxel::AsyncHostMemorySpan<float> X,
+                  acxxel::AsyncHostMemorySpan<const float> Y,
+                  DeviceArray &DeviceX, DeviceArray &DeviceY) {
+  Stream.asyncCopyHToD(X, DeviceX).asyncCopyHToD(Y, DeviceY);
+  saxpyKernel<<<(BatchSize + ThreadsPerBlock - 1) / ThreadsPerBlock,
+                ThreadsPerBlock, 0, Stream>>>(A, DeviceX, DeviceY, BatchSize);
+  Stream.asyncCopyDToH(DeviceX, X);
+}
+
+/// Processes the batches one after another on one stream, allocating the
+/// device buffers for each batch.
+void serialSaxpy(acxxel::Platform *CUDA, float A,
+                 acxxel::OwnedAsyncHostMemory<float> &X,
+                 acxxel::OwnedAsyncHostMemory<float> &Y) {
+  acxxel::Stream Stream = CUDA->createStream().takeValue();
+  acxxel::AsyncHostMemorySpan<float> XSpan(X);
+  acxxel::AsyncHostMemorySpan<const float> YSpan(Y);
+  for (int Batch = 0; Batch < BatchCount; ++Batch) {
+    auto DeviceX = CUDA->mallocD<float>(BatchSize).takeValue();
+    auto DeviceY = CUDA->mallocD<float>(BatchSize).takeValue();
+    enqueueSaxpy(Stream, A, XSpan.subspan(Batch * BatchSize, BatchSize),
+                 YSpan.subspan(Batch * BatchSize, BatchSize), DeviceX,
+                 DeviceY);
+    check(Stream.sync(), "running serial saxpy");
+  }
+}
+
+/// [Example pipelined saxpy]
+/// Processes the batches round-robin over several streams with pooled device
+/// buffers, so the copies for one batch overlap with the kernels of others.
+void pipelinedSaxpy(acxxel::Platform *CUDA, float A,
+                    acxxel::OwnedAsyncHostMemory<float> &X,
+                    acxxel::OwnedAsyncHostMemory<float> &Y) {
+  std::vector<acxxel::Stream> Streams;
+  for (int I = 0; I < StreamCount; ++I)
+    Streams.push_back(CUDA->createStream().takeValue());
+  acxxel::MemoryPool Pool(CUDA);
+  acxxel::AsyncHostMemorySpan<float> XSpan(X);
+  acxxel::AsyncHostMemorySpan<const float> YSpan(Y);
+  check(acxxel::enqueueBatches(
+            Streams, BatchCount,
+            [&](acxxel::Stream &Stream, ptrdiff_t Batch) {
+              // These buffers go back to the pool at the end of the batch and
+              // are reused by the next batch on the same stream.
+              auto DeviceX = Pool.mallocD<float>(BatchSize, Stream).takeValue();
+              auto DeviceY = Pool.mallocD<float>(BatchSize, Stream).takeValue();
+              enqueueSaxpy(Stream, A,
+                           XSpan.subspan(Batch * BatchSize, BatchSize),
+                           YSpan.subspan(Batch * BatchSize, BatchSize),
+                           DeviceX, DeviceY);
+            }),
+        "running pipelined saxpy");
+}
+/// [Example pipelined saxpy]
+
+template <typename F>
+void timeSaxpy(const char *Name, acxxel::Platform *CUDA, F &&SaxpyFunction) {
+  constexpr int Size = BatchCount * BatchSize;
+  auto X = CUDA->newAsyncHostMem<float>(Size).takeValue();
+  auto Y = CUDA->newAsyncHostMem<float>(Size).takeValue();
+  for (int I = 0; I < Size; ++I) {
+    X[I] = I % 1024;
+    Y[I] = 1.f;
+  }
+
+  acxxel::Stream Stream = CUDA->createStream().takeValue();
+  acxxel::Event Start = CUDA->createEvent().takeValue();
+  acxxel::Event End = CUDA->createEvent().takeValue();
+  check(Stream.enqueueEvent(Start).sync(), "recording start event");
+  SaxpyFunction(CUDA, 2.f, X, Y);
+  check(Stream.enqueueEvent(End).sync(), "recording end event");
+  float Seconds = End.getSecondsSince(Start).takeValue();
+
+  for (int I = 0; I < Size; ++I)
+    if (X[I] != 2.f * (I % 1024) + 1.f) {
+      std::fprintf(stderr, "%s: result mismatch at index %d\n", Name, I);
+      std::exit(EXIT_FAILURE);
+    }
+  std::printf("%-10s %8.3f ms\n", Name, Seconds * 1000);
+}
+
+} // namespace
+
+int main() {
+  acxxel::Platform *CUDA = acxxel::getCUDAPlatform().getValue();
+  timeSaxpy("serial", CUDA, serialSaxpy);
+  timeSaxpy("pipelined", CUDA, pipelinedSaxpy);
+}
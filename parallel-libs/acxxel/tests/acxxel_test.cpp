@@ -11,9 +11,11 @@
 #include "gtest/gtest.h"
 
 #include <chrono>
+#include <cstring>
 #include <condition_variable>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 namespace {
 
@@ -401,6 +403,113 @@ TEST_P(AcxxelTest, WaitForEventsInAStream) {
   EXPECT_FALSE(Stream1.sync().isError());
 }
 
+TEST_P(AcxxelTest, MemoryPoolReuseOnSameStream) {
+  acxxel::Platform *Platform = GetParam()().takeValue();
+  acxxel::Stream Stream = Platform->createStream().takeValue();
+  acxxel::MemoryPool Pool(Platform);
+  for (int I = 0; I < 5; ++I) {
+    acxxel::PooledDeviceMemory<int> X =
+        Pool.mallocD<int>(100, Stream).takeValue();
+    EXPECT_EQ(100, X.size());
+    EXPECT_EQ(100 * static_cast<ptrdiff_t>(sizeof(int)), X.byte_size());
+    EXPECT_FALSE(Stream.asyncMemsetD(X, 0).takeStatus().isError());
+  }
+  acxxel::MemoryPool::Statistics Stats = Pool.getStatistics();
+  EXPECT_EQ(1, Stats.PlatformAllocations);
+  EXPECT_EQ(4, Stats.Reuses);
+  EXPECT_EQ(0, Stats.BytesInUse);
+  EXPECT_EQ(100 * static_cast<ptrdiff_t>(sizeof(int)), Stats.BytesCached);
+  EXPECT_FALSE(Stream.sync().isError());
+}
+
+TEST_P(AcxxelTest, MemoryPoolCopyHostAndDevice) {
+  acxxel::Platform *Platform = GetParam()().takeValue();
+  acxxel::Stream Stream = Platform->createStream().takeValue();
+  acxxel::MemoryPool Pool(Platform);
+  size_t Length = 3;
+  acxxel::PooledAsyncHostMemory<int> A =
+      Pool.mallocH<int>(Length, Stream).takeValue();
+  for (size_t I = 0; I < Length; ++I)
+    A[I] = I;
+  acxxel::PooledAsyncHostMemory<int> B =
+      Pool.mallocH<int>(Length, Stream).takeValue();
+  acxxel::PooledDeviceMemory<int> X =
+      Pool.mallocD<int>(Length, Stream).takeValue();
+  EXPECT_FALSE(Stream.asyncCopyHToD(A, X).takeStatus().isError());
+  EXPECT_FALSE(Stream.asyncCopyDToH(X, B).takeStatus().isError());
+  EXPECT_FALSE(Stream.sync().isError());
+  for (size_t I = 0; I < Length; ++I)
+    EXPECT_EQ(A[I], B[I]);
+}
+
+TEST_P(AcxxelTest, MemoryPoolHostReuseAfterSync) {
+  acxxel::Platform *Platform = GetParam()().takeValue();
+  acxxel::Stream Stream = Platform->createStream().takeValue();
+  acxxel::MemoryPool Pool(Platform);
+  {
+    acxxel::PooledAsyncHostMemory<int> A =
+        Pool.mallocH<int>(10, Stream).takeValue();
+  }
+  // Staging memory is only reused once the work using it is done.
+  EXPECT_FALSE(Stream.sync().isError());
+  {
+    acxxel::PooledAsyncHostMemory<int> A =
+        Pool.mallocH<int>(8, Stream).takeValue();
+  }
+  acxxel::MemoryPool::Statistics Stats = Pool.getStatistics();
+  EXPECT_EQ(1, Stats.PlatformAllocations);
+  EXPECT_EQ(1, Stats.Reuses);
+  EXPECT_FALSE(Stream.sync().isError());
+}
+
+TEST_P(AcxxelTest, MemoryPoolTrim) {
+  acxxel::Platform *Platform = GetParam()().takeValue();
+  acxxel::Stream Stream = Platform->createStream().takeValue();
+  acxxel::MemoryPool Pool(Platform);
+  {
+    acxxel::PooledDeviceMemory<int> X =
+        Pool.mallocD<int>(10, Stream).takeValue();
+  }
+  EXPECT_GT(Pool.getStatistics().BytesCached, 0);
+  EXPECT_FALSE(Pool.trim().isError());
+  EXPECT_EQ(0, Pool.getStatistics().BytesCached);
+  {
+    acxxel::PooledDeviceMemory<int> X =
+        Pool.mallocD<int>(10, Stream).takeValue();
+  }
+  EXPECT_EQ(2, Pool.getStatistics().PlatformAllocations);
+}
+
+TEST_P(AcxxelTest, EnqueueBatches) {
+  acxxel::Platform *Platform = GetParam()().takeValue();
+  std::vector<acxxel::Stream> Streams;
+  for (int I = 0; I < 3; ++I)
+    Streams.push_back(Platform->createStream().takeValue());
+  acxxel::MemoryPool Pool(Platform);
+  const ptrdiff_t BatchCount = 7;
+  const size_t Length = 4;
+  std::vector<acxxel::OwnedAsyncHostMemory<int>> Results;
+  for (ptrdiff_t Batch = 0; Batch < BatchCount; ++Batch)
+    Results.push_back(Platform->newAsyncHostMem<int>(Length).takeValue());
+  EXPECT_FALSE(
+      acxxel::enqueueBatches(
+          Streams, BatchCount,
+          [&](acxxel::Stream &Stream, ptrdiff_t Batch) {
+            acxxel::PooledDeviceMemory<int> X =
+                Pool.mallocD<int>(Length, Stream).takeValue();
+            Stream.asyncMemsetD(X, static_cast<char>(Batch))
+                .asyncCopyDToH(X, Results[Batch]);
+          })
+          .isError());
+  for (ptrdiff_t Batch = 0; Batch < BatchCount; ++Batch) {
+    int Expected;
+    std::memset(&Expected, static_cast<char>(Batch), sizeof(Expected));
+    for (size_t I = 0; I < Length; ++I)
+      EXPECT_EQ(Expected, Results[Batch][I]);
+  }
+  EXPECT_LE(Pool.getStatistics().PlatformAllocations, 3);
+}
+
 #if defined(ACXXEL_ENABLE_CUDA) || defined(ACXXEL_ENABLE_OPENCL)
 INSTANTIATE_TEST_CASE_P(BothPlatformTest, AcxxelTest,
                         ::testing::Values(
@@ -201,6 +201,13 @@ private:
   using DetectionContextMapTy = DenseMap<BBPair, DetectionContext>;
   mutable DetectionContextMapTy DetectionContextMap;
 
+  /// Number of basic blocks checked so far while detecting scops in this
+  /// function, charged against -polly-detect-max-blocks.
+  mutable unsigned NumBlocksChecked = 0;
+
+  /// Return whether the scop detection budget of this function is used up.
+  bool isDetectionBudgetExhausted() const;
+
   /// Remove cached results for @p R.
   void removeCachedResults(const Region &R);
 
@@ -97,6 +97,7 @@ enum class RejectReasonKind {
   UnknownInst,
   Entry,
   Unprofitable,
+  DetectionBudget,
   LastOther
 };
 
@@ -827,6 +828,30 @@ public:
   //@}
 };
 
+//===----------------------------------------------------------------------===//
+/// Report regions that were not checked because the per-function scop
+/// detection budget was exhausted.
+class ReportDetectionBudget : public ReportOther {
+  Region *R;
+
+public:
+  ReportDetectionBudget(Region *R);
+
+  /// @name LLVM-RTTI interface
+  //@{
+  static bool classof(const RejectReason *RR);
+  //@}
+
+  /// @name RejectReason interface
+  //@{
+  std::string getRemarkName() const override;
+  const Value *getRemarkBB() const override;
+  std::string getMessage() const override;
+  std::string getEndUserMessage() const override;
+  const DebugLoc &getDebugLoc() const override;
+  //@}
+};
+
 //===----------------------------------------------------------------------===//
 /// Captures errors with non-simple memory accesses.
 class ReportNonSimpleMemoryAccess : public ReportOther {
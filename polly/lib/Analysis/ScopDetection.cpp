@@ -219,6 +219,13 @@ static cl::opt<bool, true> XPollyInvariantLoadHoisting(
     cl::location(PollyInvariantLoadHoisting), cl::Hidden, cl::ZeroOrMore,
     cl::init(false), cl::cat(PollyCategory));
 
+static cl::opt<unsigned> MaxBlocksChecked(
+    "polly-detect-max-blocks",
+    cl::desc("Maximal number of basic blocks scop detection checks per "
+             "function before rejecting the remaining regions (0 means no "
+             "bound)"),
+    cl::Hidden, cl::init(0), cl::ZeroOrMore, cl::cat(PollyCategory));
+
 /// The minimal trip count under which loops are considered unprofitable.
 static const unsigned MIN_LOOP_TRIP_COUNT = 8;
 
@@ -259,6 +266,10 @@ STATISTIC(NumProfScopsDepthLarger,
           "Number of scops with maximal loop depth 6 and larger "
           "(profitable scops only)");
 STATISTIC(MaxNumLoopsInScop, "Maximal number of loops in scops");
+STATISTIC(NumBlocksCheckedOverall,
+          "Number of basic blocks checked by scop detection");
+STATISTIC(NumDetectionBudgetExhausted,
+          "Number of functions that exhausted the scop detection budget");
 STATISTIC(MaxNumLoopsInProfScop,
           "Maximal number of loops in scops (profitable scops only)");
 
@@ -347,6 +358,13 @@ ScopDetection::ScopDetection(Function &F, const DominatorTree &DT,
 
   findScops(*TopRegion);
 
+  NumBlocksCheckedOverall += NumBlocksChecked;
+  if (isDetectionBudgetExhausted()) {
+    LLVM_DEBUG(dbgs() << "Scop detection budget exhausted in function "
+                      << F.getName() << "\n");
+    NumDetectionBudgetExhausted++;
+  }
+
   NumScopRegions += ValidRegions.size();
 
   // Prune non-profitable regions.
@@ -1481,6 +1499,11 @@ void ScopDetection::findScops(Region &R) {
     return;
   }
 
+  // Every further check would be rejected immediately, so do not bother
+  // walking into the subregions.
+  if (isDetectionBudgetExhausted())
+    return;
+
   for (auto &SubRegion : R)
     findScops(*SubRegion);
 
@@ -1539,6 +1562,17 @@ bool ScopDetection::allBlocksValid(DetectionContext &Context) const {
   }
 
   for (BasicBlock *BB : CurRegion.blocks()) {
+    // Region expansion re-checks the same blocks over and over again, which
+    // can get expensive on large functions. Reject the region once the
+    // per-function budget is used up. The budget is not charged while
+    // verifying, as that would make already detected scops invalid.
+    if (!Context.Verifying) {
+      NumBlocksChecked++;
+      if (isDetectionBudgetExhausted())
+        return invalid<ReportDetectionBudget>(Context, /*Assert=*/true,
+                                              &CurRegion);
+    }
+
     bool IsErrorBlock = isErrorBlock(*BB, CurRegion, LI, DT);
 
     // Also check exception blocks (and possibly register them as non-affine
@@ -1561,6 +1595,10 @@ bool ScopDetection::allBlocksValid(DetectionContext &Context) const {
   return true;
 }
 
+bool ScopDetection::isDetectionBudgetExhausted() const {
+  return MaxBlocksChecked > 0 && NumBlocksChecked > MaxBlocksChecked;
+}
+
 bool ScopDetection::hasSufficientCompute(DetectionContext &Context,
                                          int NumLoops) const {
   int InstCount = 0;
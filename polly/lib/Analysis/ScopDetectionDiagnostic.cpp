@@ -82,6 +82,7 @@ Statistic RejectStatistics[] = {
     SCOP_STAT(UnknownInst, "Unknown Instructions"),
     SCOP_STAT(Entry, "Contains entry block"),
     SCOP_STAT(Unprofitable, "Assumed to be unprofitable"),
+    SCOP_STAT(DetectionBudget, "Scop detection budget exhausted"),
     SCOP_STAT(LastOther, ""),
 };
 
@@ -803,4 +804,34 @@ const DebugLoc &ReportUnprofitable::getDebugLoc() const {
 bool ReportUnprofitable::classof(const RejectReason *RR) {
   return RR->getKind() == RejectReasonKind::Unprofitable;
 }
+
+//===----------------------------------------------------------------------===//
+// ReportDetectionBudget.
+
+ReportDetectionBudget::ReportDetectionBudget(Region *R)
+    : ReportOther(RejectReasonKind::DetectionBudget), R(R) {}
+
+std::string ReportDetectionBudget::getRemarkName() const {
+  return "DetectionBudget";
+}
+
+const Value *ReportDetectionBudget::getRemarkBB() const {
+  return R->getEntry();
+}
+
+std::string ReportDetectionBudget::getMessage() const {
+  return "Scop detection budget exhausted before checking region!";
+}
+
+std::string ReportDetectionBudget::getEndUserMessage() const {
+  return "Function too large to be analyzed within the scop detection budget";
+}
+
+const DebugLoc &ReportDetectionBudget::getDebugLoc() const {
+  return R->getEntry()->getTerminator()->getDebugLoc();
+}
+
+bool ReportDetectionBudget::classof(const RejectReason *RR) {
+  return RR->getKind() == RejectReasonKind::DetectionBudget;
+}
 } // namespace polly
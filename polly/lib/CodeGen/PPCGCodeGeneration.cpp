@@ -24,6 +24,7 @@
 #include "polly/ScopInfo.h"
 #include "polly/Support/SCEVValidator.h"
 #include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Verifier.h"
@@ -114,6 +115,17 @@ static cl::opt<int>
                cl::desc("Minimal number of compute statements to run on GPU."),
                cl::Hidden, cl::init(10 * 512 * 512));
 
+static cl::opt<int> MinComputePerByte(
+    "polly-acc-mincompute-per-byte",
+    cl::desc("Minimal number of compute statements per byte copied between "
+             "host and device to run on GPU (0 disables the check)."),
+    cl::Hidden, cl::init(1), cl::ZeroOrMore, cl::cat(PollyCategory));
+
+STATISTIC(ScopsOffloaded, "Number of scops code generated for the GPU");
+STATISTIC(KernelsGenerated, "Number of GPU kernels generated");
+STATISTIC(TransfersToDevice, "Number of host to device transfers generated");
+STATISTIC(TransfersFromDevice, "Number of device to host transfers generated");
+
 extern bool polly::PerfMonitoring;
 
 /// Return  a unique name for a Scop, which is the scop region with the
@@ -1196,10 +1208,13 @@ void GPUNodeBuilder::createDataTransfer(__isl_take isl_ast_node *TransferStmt,
                   Offset, Builder.getInt64(ScopArray->getElemSizeInBytes())));
   }
 
-  if (Direction == HOST_TO_DEVICE)
+  if (Direction == HOST_TO_DEVICE) {
     createCallCopyFromHostToDevice(HostPtr, DevPtr, Size);
-  else
+    TransfersToDevice++;
+  } else {
     createCallCopyFromDeviceToHost(DevPtr, HostPtr, Size);
+    TransfersFromDevice++;
+  }
 
   isl_id_free(Id);
   isl_ast_expr_free(Arg);
@@ -1775,6 +1790,7 @@ void GPUNodeBuilder::createKernel(__isl_take isl_ast_node *KernelStmt) {
   ppcg_kernel *Kernel = (ppcg_kernel *)isl_id_get_user(Id);
   isl_id_free(Id);
   isl_ast_node_free(KernelStmt);
+  KernelsGenerated++;
 
   if (Kernel->n_grid > 1)
     DeepestParallel =
@@ -3391,6 +3407,62 @@ public:
     return isl_ast_expr_ge(Iterations, MinComputeExpr);
   }
 
+  /// Approximate the number of bytes copied between host and device.
+  ///
+  /// PPCG keeps arrays resident on the device across all kernels of a scop,
+  /// such that each array that requires a device allocation is transferred
+  /// at most once in each direction.
+  ///
+  /// @param Prog  The GPU program whose arrays are transferred.
+  /// @param Build The isl ast build object to use for creating the ast
+  ///              expression.
+  /// @returns An approximation of the number of bytes transferred in one
+  ///          direction.
+  __isl_give isl_ast_expr *
+  getNumberOfTransferredBytes(gpu_prog *Prog, __isl_keep isl_ast_build *Build) {
+    isl_val *Zero = isl_val_int_from_si(S->getIslCtx().get(), 0);
+    isl_ast_expr *Bytes = isl_ast_expr_from_val(Zero);
+
+    for (int i = 0; i < Prog->n_array; i++) {
+      gpu_array_info *Array = &Prog->array[i];
+      if (!gpu_array_requires_device_allocation(Array))
+        continue;
+
+      auto *Elements = approxPointsInSet(isl_set_copy(Array->extent), Build);
+      isl_val *ElemSize =
+          isl_val_int_from_si(S->getIslCtx().get(), Array->size);
+      auto *ArrayBytes =
+          isl_ast_expr_mul(Elements, isl_ast_expr_from_val(ElemSize));
+      Bytes = isl_ast_expr_add(Bytes, ArrayBytes);
+    }
+    return Bytes;
+  }
+
+  /// Create a check that ensures the compute in scop amortizes the transfers.
+  ///
+  /// Offloading only pays off if the work done on the device outweighs the
+  /// cost of copying its data over the (comparably slow) host-device link.
+  ///
+  /// @param S     The scop for which to ensure sufficient compute.
+  /// @param Prog  The GPU program generated for @p S.
+  /// @param Build The isl ast build object to use for creating the ast
+  ///              expression.
+  /// @returns An expression that evaluates to TRUE in case the compute per
+  ///          transferred byte reaches -polly-acc-mincompute-per-byte and to
+  ///          FALSE, otherwise. Returns nullptr if the check is disabled.
+  __isl_give isl_ast_expr *createProfitableTransferCheck(
+      Scop &S, gpu_prog *Prog, __isl_keep isl_ast_build *Build) {
+    if (MinComputePerByte <= 0)
+      return nullptr;
+
+    auto Iterations = getNumberOfIterations(S, Build);
+    auto Bytes = getNumberOfTransferredBytes(Prog, Build);
+    auto *RatioVal =
+        isl_val_int_from_si(S.getIslCtx().get(), MinComputePerByte);
+    auto *MinCompute = isl_ast_expr_mul(isl_ast_expr_from_val(RatioVal), Bytes);
+    return isl_ast_expr_ge(Iterations, MinCompute);
+  }
+
   /// Check if the basic block contains a function we cannot codegen for GPU
   /// kernels.
   ///
@@ -3476,6 +3548,9 @@ public:
     isl_ast_expr *Condition = IslAst::buildRunCondition(*S, Build);
     isl_ast_expr *SufficientCompute = createSufficientComputeCheck(*S, Build);
     Condition = isl_ast_expr_and(Condition, SufficientCompute);
+    if (isl_ast_expr *ProfitableTransfer =
+            createProfitableTransferCheck(*S, Prog, Build))
+      Condition = isl_ast_expr_and(Condition, ProfitableTransfer);
     isl_ast_build_free(Build);
 
     // preload invariant loads. Note: This should happen before the RTC
@@ -3573,6 +3648,7 @@ public:
     if (PPCGGen->tree) {
       generateCode(isl_ast_node_copy(PPCGGen->tree), PPCGProg);
       CurrentScop.markAsToBeSkipped();
+      ScopsOffloaded++;
     } else {
       LLVM_DEBUG(dbgs() << getUniqueScopName(S)
                         << " has empty PPCGGen->tree. Bailing out.\n");